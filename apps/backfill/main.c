@@ -0,0 +1,341 @@
+/**
+ * @file
+ * @brief command line tool that backfills the Log_Buffer of Trend Log
+ * objects in other devices on the network, using ReadRange requests by
+ * sequence number, and prints the records to the console.  The cursor
+ * of each log can be kept in a file so that the next run only reads
+ * the records that are new since the last run.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#define PRINT_ENABLED 1
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h> /* for time */
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bactext.h"
+#include "bacnet/npdu.h"
+#include "bacnet/apdu.h"
+#include "bacnet/version.h"
+/* some demo stuff needed */
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/client/bac-backfill.h"
+#include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/datalink/dlenv.h"
+#include "bacport.h"
+
+#if BACNET_SVC_SERVER
+#error "App requires server-only features disabled! Set BACNET_SVC_SERVER=0"
+#endif
+
+/* buffer used for receive */
+static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+/* file where the cursors are kept between runs */
+static const char *Cursor_Filename;
+static bool Error_Detected = false;
+
+static void Init_Service_Handlers(void)
+{
+    Device_Init(NULL);
+    /* we need to handle who-is
+       to support dynamic device binding to us */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    /* set the handler for all the services we don't implement
+       It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    /* we must implement read property - it's required! */
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    /* i-am, readrange-ack, and readrange errors */
+    bacnet_backfill_init();
+}
+
+/**
+ * @brief Print one record of a log
+ * @param cursor [in] the log, with the sequence number of this record
+ * @param record [in] the decoded record
+ */
+static void Print_Record(
+    const BACNET_BACKFILL_CURSOR *cursor, const BACNET_LOG_RECORD *record)
+{
+    const BACNET_DATE_TIME *stamp = &record->timestamp;
+
+    printf(
+        "%lu,%lu,%lu,%04u/%02u/%02u %02u:%02u:%02u.%02u,",
+        (unsigned long)cursor->device_id,
+        (unsigned long)cursor->object_instance,
+        (unsigned long)cursor->sequence, (unsigned)stamp->date.year,
+        (unsigned)stamp->date.month, (unsigned)stamp->date.day,
+        (unsigned)stamp->time.hour, (unsigned)stamp->time.min,
+        (unsigned)stamp->time.sec, (unsigned)stamp->time.hundredths);
+    switch (record->tag) {
+        case BACNET_LOG_DATUM_STATUS:
+            printf("status=%u", (unsigned)record->log_datum.log_status);
+            break;
+        case BACNET_LOG_DATUM_BOOLEAN:
+            printf("%s", record->log_datum.boolean_value ? "true" : "false");
+            break;
+        case BACNET_LOG_DATUM_REAL:
+            printf("%f", (double)record->log_datum.real_value);
+            break;
+        case BACNET_LOG_DATUM_ENUMERATED:
+            printf("%lu", (unsigned long)record->log_datum.enumerated_value);
+            break;
+        case BACNET_LOG_DATUM_UNSIGNED:
+            printf("%lu", (unsigned long)record->log_datum.unsigned_value);
+            break;
+        case BACNET_LOG_DATUM_SIGNED:
+            printf("%ld", (long)record->log_datum.integer_value);
+            break;
+        case BACNET_LOG_DATUM_NULL:
+            printf("null");
+            break;
+        case BACNET_LOG_DATUM_FAILURE:
+            printf(
+                "%s: %s",
+                bactext_error_class_name(
+                    (int)record->log_datum.failure.error_class),
+                bactext_error_code_name(
+                    (int)record->log_datum.failure.error_code));
+            break;
+        case BACNET_LOG_DATUM_TIME_CHANGE:
+            printf("time-change=%f", (double)record->log_datum.time_change);
+            break;
+        default:
+            printf("datum=%u", (unsigned)record->tag);
+            break;
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Save the cursor of every log, so the next run resumes from it
+ */
+static void Cursor_Save(void)
+{
+    BACNET_BACKFILL_CURSOR cursor;
+    FILE *pFile;
+    unsigned i;
+
+    if (!Cursor_Filename) {
+        return;
+    }
+    pFile = fopen(Cursor_Filename, "w");
+    if (!pFile) {
+        fprintf(stderr, "Unable to write %s\n", Cursor_Filename);
+        return;
+    }
+    for (i = 0; bacnet_backfill_cursor(i, &cursor); i++) {
+        fprintf(
+            pFile, "%lu %lu %lu\n", (unsigned long)cursor.device_id,
+            (unsigned long)cursor.object_instance,
+            (unsigned long)cursor.sequence);
+    }
+    fclose(pFile);
+}
+
+/**
+ * @brief Load the cursors saved by an earlier run into the logs that
+ *  were given on the command line
+ */
+static void Cursor_Load(void)
+{
+    BACNET_BACKFILL_CURSOR cursor = { 0 };
+    unsigned long device_id, object_instance, sequence;
+    FILE *pFile;
+    unsigned i;
+
+    if (!Cursor_Filename) {
+        return;
+    }
+    pFile = fopen(Cursor_Filename, "r");
+    if (!pFile) {
+        return;
+    }
+    while (fscanf(pFile, "%lu %lu %lu", &device_id, &object_instance,
+                  &sequence) == 3) {
+        for (i = 0; bacnet_backfill_cursor(i, &cursor); i++) {
+            if ((cursor.device_id == device_id) &&
+                (cursor.object_instance == object_instance)) {
+                cursor.sequence = sequence;
+                bacnet_backfill_add(&cursor);
+                break;
+            }
+        }
+    }
+    fclose(pFile);
+}
+
+/**
+ * @brief Save the cursors after each ReadRange-ACK
+ * @param cursor [in] the log, with the sequence number of its next record
+ * @param caught_up [in] true if the log has no more records to read
+ */
+static void Cursor_Changed(const BACNET_BACKFILL_CURSOR *cursor, bool caught_up)
+{
+    (void)cursor;
+    (void)caught_up;
+    Cursor_Save();
+}
+
+/**
+ * @brief Print a request that failed
+ * @param cursor [in] the log
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+static void Print_Error(
+    const BACNET_BACKFILL_CURSOR *cursor,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    fprintf(
+        stderr, "Device %lu Trend Log %lu: %s: %s\n",
+        (unsigned long)cursor->device_id,
+        (unsigned long)cursor->object_instance,
+        bactext_error_class_name((int)error_class),
+        bactext_error_code_name((int)error_code));
+    Error_Detected = true;
+}
+
+static void print_usage(const char *filename)
+{
+    printf(
+        "Usage: %s device-instance log-instance "
+        "[device-instance log-instance ...]\n",
+        filename);
+    printf("       [--cursor filename][--window count]\n");
+    printf("       [--version][--help]\n");
+}
+
+static void print_help(const char *filename)
+{
+    printf("Read the new records of Trend Log objects in BACnet devices\n"
+           "and print them as device,log,sequence,timestamp,value.\n");
+    printf("\n");
+    printf("device-instance:\n"
+           "BACnet Device Object Instance number of the device that\n"
+           "has the Trend Log.\n");
+    printf("\n");
+    printf("log-instance:\n"
+           "Object instance number of the Trend Log in that device.\n");
+    printf("\n");
+    printf("--cursor filename:\n"
+           "File with the sequence number of the next record of each log.\n"
+           "It is read at start and written as records arrive, so the\n"
+           "next run starts after the last record that was printed.\n");
+    printf("\n");
+    printf("--window count:\n"
+           "Number of ReadRange requests in progress at once, 1..%u.\n",
+           (unsigned)BACNET_BACKFILL_WINDOW_MAX);
+    printf("\n");
+    printf("Example:\n"
+           "To read Trend Log 1 and 2 in Device 123 and Trend Log 1 in\n"
+           "Device 456, and resume from the last run, use:\n");
+    printf("%s 123 1 123 2 456 1 --cursor logs.txt\n", filename);
+}
+
+int main(int argc, char *argv[])
+{
+    BACNET_BACKFILL_CURSOR cursor = { 0 };
+    BACNET_ADDRESS src = { 0 }; /* address where message came from */
+    uint16_t pdu_len = 0;
+    unsigned timeout = 100; /* milliseconds */
+    time_t last_seconds = 0;
+    time_t current_seconds = 0;
+    int argi = 0;
+    const char *filename = NULL;
+
+    filename = filename_remove_path(argv[0]);
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--help") == 0) {
+            print_usage(filename);
+            print_help(filename);
+            return 0;
+        }
+        if (strcmp(argv[argi], "--version") == 0) {
+            printf("%s %s\n", filename, BACNET_VERSION_TEXT);
+            printf("Copyright (C) 2026 by Steve Karg and others.\n"
+                   "This is free software; see the source for copying "
+                   "conditions.\n"
+                   "There is NO warranty; not even for MERCHANTABILITY or\n"
+                   "FITNESS FOR A PARTICULAR PURPOSE.\n");
+            return 0;
+        }
+    }
+    /* setup my info */
+    Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
+    address_init();
+    Init_Service_Handlers();
+    /* decode the command line parameters */
+    cursor.object_type = OBJECT_TRENDLOG;
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--cursor") == 0) {
+            if (++argi < argc) {
+                Cursor_Filename = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--window") == 0) {
+            if (++argi < argc) {
+                bacnet_backfill_window_set(strtoul(argv[argi], NULL, 0));
+            }
+        } else if ((argi + 1) < argc) {
+            cursor.device_id = strtoul(argv[argi], NULL, 0);
+            cursor.object_instance = strtoul(argv[++argi], NULL, 0);
+            if (!bacnet_backfill_add(&cursor)) {
+                fprintf(
+                    stderr, "device-instance=%lu log-instance=%lu invalid\n",
+                    (unsigned long)cursor.device_id,
+                    (unsigned long)cursor.object_instance);
+                return 1;
+            }
+        }
+    }
+    if (bacnet_backfill_count() == 0) {
+        print_usage(filename);
+        return 0;
+    }
+    Cursor_Load();
+    bacnet_backfill_record_callback_set(Print_Record);
+    bacnet_backfill_cursor_callback_set(Cursor_Changed);
+    bacnet_backfill_error_callback_set(Print_Error);
+    dlenv_init();
+    atexit(datalink_cleanup);
+    last_seconds = time(NULL);
+    /* loop until every log has no more records, or failed */
+    for (;;) {
+        current_seconds = time(NULL);
+        /* at least one second has passed */
+        if (current_seconds != last_seconds) {
+            tsm_timer_milliseconds(
+                (uint16_t)((current_seconds - last_seconds) * 1000));
+            datalink_maintenance_timer(current_seconds - last_seconds);
+        }
+        bacnet_backfill_task();
+        if (bacnet_backfill_idle()) {
+            break;
+        }
+        /* returns 0 bytes on timeout */
+        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
+        /* process */
+        if (pdu_len) {
+            npdu_handler(&src, &Rx_Buf[0], pdu_len);
+        }
+        /* keep track of time for next check */
+        last_seconds = current_seconds;
+    }
+    Cursor_Save();
+    if (Error_Detected) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,933 @@
+/**
+ * @file
+ * @brief command line tool that measures the throughput of the BACnet
+ * codec: tag and application data encoding and decoding, and the
+ * ReadPropertyMultiple-ACK, COV notification, ReadRange-ACK, and I-Am
+ * services with representative payloads, and the change-of-value scan
+ * of many analog points.  Each benchmark reports the time and the number
+ * of encoded or decoded bytes, or of evaluated points, per operation.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacapp.h"
+#include "bacnet/bacdcode.h"
+#include "bacnet/baclog.h"
+#include "bacnet/cov.h"
+#include "bacnet/datetime.h"
+#include "bacnet/iam.h"
+#include "bacnet/npdu.h"
+#include "bacnet/readrange.h"
+#include "bacnet/rpm.h"
+#include "bacnet/version.h"
+#include "bacnet/basic/object/ai.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/sys/platform.h"
+
+/* number of properties in the RPM ALL payload */
+#define BENCH_RPM_PROPERTIES 24
+/* number of log records in the ReadRange payload */
+#define BENCH_TREND_RECORDS 40
+/* number of devices answering in the I-Am storm payload */
+#define BENCH_IAM_DEVICES 100
+/* number of analog points in the change-of-value scan */
+#define BENCH_COV_POINTS 10240
+/* minimum run time of each benchmark when no iterations are given */
+#define BENCH_MIN_NANOSECONDS 200000000ULL
+
+/* one benchmark: returns the bytes encoded or decoded, or negative
+   if the codec failed, which stops the benchmark */
+struct bench_case {
+    const char *name;
+    int (*run)(void);
+};
+
+/* the encoded payloads, which the decoding benchmarks read */
+static uint8_t Tag_Buffer[MAX_APDU];
+static int Tag_Buffer_Len;
+static uint8_t Value_Buffer[MAX_APDU];
+static int Value_Buffer_Len;
+static uint8_t RPM_Buffer[MAX_APDU];
+static int RPM_Buffer_Len;
+static uint8_t COV_Buffer[MAX_APDU];
+static int COV_Buffer_Len;
+static uint8_t RR_Buffer[MAX_APDU];
+static int RR_Buffer_Len;
+static uint8_t IAM_Buffer[BENCH_IAM_DEVICES][MAX_NPDU + 16];
+static int IAM_Buffer_Len[BENCH_IAM_DEVICES];
+/* scratch buffer for the encoding benchmarks */
+static uint8_t Encode_Buffer[MAX_APDU];
+/* the payload data */
+static BACNET_UNSIGNED_INTEGER Tag_Values[] = { 0,      1,        127,
+                                                255,    256,      65535,
+                                                65536,  16777215, 16777216,
+                                                85000,  4194303,  UINT32_MAX };
+static BACNET_APPLICATION_DATA_VALUE Values[9];
+static struct rpm_property {
+    BACNET_PROPERTY_ID property;
+    BACNET_APPLICATION_DATA_VALUE value;
+} RPM_Properties[BENCH_RPM_PROPERTIES];
+static BACNET_PROPERTY_VALUE COV_Values[2];
+static BACNET_LOG_RECORD Trend_Records[BENCH_TREND_RECORDS];
+/* the analog points of the change-of-value scan */
+static DENSE_VALUE_TABLE COV_Points;
+static uint32_t COV_Points_Bitmap[(BENCH_COV_POINTS + 31) / 32];
+static unsigned COV_Points_Round;
+
+/**
+ * @brief Get a monotonic time stamp
+ * @return time stamp in nanoseconds
+ */
+static uint64_t bench_nanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((count.QuadPart * 1000000000.0) / frequency.QuadPart);
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Fill in the status flags of an application value
+ * @param value - value to fill in
+ */
+static void bench_status_flags_value(BACNET_APPLICATION_DATA_VALUE *value)
+{
+    value->tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value->type.Bit_String);
+    bitstring_set_bit(&value->type.Bit_String, STATUS_FLAG_IN_ALARM, false);
+    bitstring_set_bit(&value->type.Bit_String, STATUS_FLAG_FAULT, false);
+    bitstring_set_bit(&value->type.Bit_String, STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(
+        &value->type.Bit_String, STATUS_FLAG_OUT_OF_SERVICE, false);
+}
+
+/**
+ * @brief Create the application values, one of each common datatype
+ */
+static void bench_values_init(void)
+{
+    memset(Values, 0, sizeof(Values));
+    Values[0].tag = BACNET_APPLICATION_TAG_REAL;
+    Values[0].type.Real = 72.5f;
+    Values[1].tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    Values[1].type.Unsigned_Int = 1476;
+    Values[2].tag = BACNET_APPLICATION_TAG_SIGNED_INT;
+    Values[2].type.Signed_Int = -40;
+    Values[3].tag = BACNET_APPLICATION_TAG_ENUMERATED;
+    Values[3].type.Enumerated = UNITS_DEGREES_FAHRENHEIT;
+    Values[4].tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    Values[4].type.Boolean = true;
+    Values[5].tag = BACNET_APPLICATION_TAG_CHARACTER_STRING;
+    characterstring_init_ansi(
+        &Values[5].type.Character_String, "Zone Temperature Sensor 101");
+    bench_status_flags_value(&Values[6]);
+    Values[7].tag = BACNET_APPLICATION_TAG_DATE;
+    datetime_set_date(&Values[7].type.Date, 2024, 6, 15);
+    Values[8].tag = BACNET_APPLICATION_TAG_OBJECT_ID;
+    Values[8].type.Object_Id.type = OBJECT_ANALOG_INPUT;
+    Values[8].type.Object_Id.instance = 101;
+}
+
+/**
+ * @brief Add a property value to the RPM ALL payload
+ * @param index - position in the payload
+ * @param property - property identifier
+ * @param tag - application tag of the value
+ * @return the value to fill in
+ */
+static BACNET_APPLICATION_DATA_VALUE *
+bench_rpm_property(unsigned index, BACNET_PROPERTY_ID property, uint8_t tag)
+{
+    RPM_Properties[index].property = property;
+    RPM_Properties[index].value.tag = tag;
+
+    return &RPM_Properties[index].value;
+}
+
+/**
+ * @brief Create the RPM ALL payload, which resembles the properties of
+ *  an analog input with intrinsic reporting
+ */
+static void bench_rpm_init(void)
+{
+    BACNET_APPLICATION_DATA_VALUE *value;
+    unsigned i = 0;
+
+    memset(RPM_Properties, 0, sizeof(RPM_Properties));
+    value = bench_rpm_property(
+        i++, PROP_OBJECT_IDENTIFIER, BACNET_APPLICATION_TAG_OBJECT_ID);
+    value->type.Object_Id.type = OBJECT_ANALOG_INPUT;
+    value->type.Object_Id.instance = 101;
+    value = bench_rpm_property(
+        i++, PROP_OBJECT_NAME, BACNET_APPLICATION_TAG_CHARACTER_STRING);
+    characterstring_init_ansi(&value->type.Character_String, "ZN-T-101");
+    value = bench_rpm_property(
+        i++, PROP_OBJECT_TYPE, BACNET_APPLICATION_TAG_ENUMERATED);
+    value->type.Enumerated = OBJECT_ANALOG_INPUT;
+    value = bench_rpm_property(
+        i++, PROP_PRESENT_VALUE, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 72.5f;
+    value = bench_rpm_property(
+        i++, PROP_DESCRIPTION, BACNET_APPLICATION_TAG_CHARACTER_STRING);
+    characterstring_init_ansi(
+        &value->type.Character_String, "Zone Temperature Sensor 101");
+    value = bench_rpm_property(
+        i++, PROP_DEVICE_TYPE, BACNET_APPLICATION_TAG_CHARACTER_STRING);
+    characterstring_init_ansi(&value->type.Character_String, "10K Type II");
+    value = bench_rpm_property(
+        i++, PROP_STATUS_FLAGS, BACNET_APPLICATION_TAG_BIT_STRING);
+    bench_status_flags_value(value);
+    value = bench_rpm_property(
+        i++, PROP_EVENT_STATE, BACNET_APPLICATION_TAG_ENUMERATED);
+    value->type.Enumerated = EVENT_STATE_NORMAL;
+    value = bench_rpm_property(
+        i++, PROP_RELIABILITY, BACNET_APPLICATION_TAG_ENUMERATED);
+    value->type.Enumerated = RELIABILITY_NO_FAULT_DETECTED;
+    value = bench_rpm_property(
+        i++, PROP_OUT_OF_SERVICE, BACNET_APPLICATION_TAG_BOOLEAN);
+    value->type.Boolean = false;
+    value =
+        bench_rpm_property(i++, PROP_UNITS, BACNET_APPLICATION_TAG_ENUMERATED);
+    value->type.Enumerated = UNITS_DEGREES_FAHRENHEIT;
+    value = bench_rpm_property(
+        i++, PROP_MIN_PRES_VALUE, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = -40.0f;
+    value = bench_rpm_property(
+        i++, PROP_MAX_PRES_VALUE, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 250.0f;
+    value =
+        bench_rpm_property(i++, PROP_RESOLUTION, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 0.1f;
+    value = bench_rpm_property(
+        i++, PROP_COV_INCREMENT, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 0.5f;
+    value = bench_rpm_property(
+        i++, PROP_TIME_DELAY, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+    value->type.Unsigned_Int = 30;
+    value = bench_rpm_property(
+        i++, PROP_NOTIFICATION_CLASS, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+    value->type.Unsigned_Int = 1;
+    value =
+        bench_rpm_property(i++, PROP_HIGH_LIMIT, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 85.0f;
+    value =
+        bench_rpm_property(i++, PROP_LOW_LIMIT, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 55.0f;
+    value = bench_rpm_property(i++, PROP_DEADBAND, BACNET_APPLICATION_TAG_REAL);
+    value->type.Real = 1.0f;
+    value = bench_rpm_property(
+        i++, PROP_LIMIT_ENABLE, BACNET_APPLICATION_TAG_BIT_STRING);
+    bitstring_init(&value->type.Bit_String);
+    bitstring_set_bit(&value->type.Bit_String, 0, true);
+    bitstring_set_bit(&value->type.Bit_String, 1, true);
+    value = bench_rpm_property(
+        i++, PROP_EVENT_ENABLE, BACNET_APPLICATION_TAG_BIT_STRING);
+    bitstring_init(&value->type.Bit_String);
+    bitstring_set_bit(&value->type.Bit_String, 0, true);
+    bitstring_set_bit(&value->type.Bit_String, 1, true);
+    bitstring_set_bit(&value->type.Bit_String, 2, true);
+    value = bench_rpm_property(
+        i++, PROP_ACKED_TRANSITIONS, BACNET_APPLICATION_TAG_BIT_STRING);
+    bitstring_init(&value->type.Bit_String);
+    bitstring_set_bit(&value->type.Bit_String, 0, true);
+    bitstring_set_bit(&value->type.Bit_String, 1, true);
+    bitstring_set_bit(&value->type.Bit_String, 2, true);
+    value = bench_rpm_property(
+        i++, PROP_NOTIFY_TYPE, BACNET_APPLICATION_TAG_ENUMERATED);
+    value->type.Enumerated = NOTIFY_ALARM;
+}
+
+/**
+ * @brief Create the COV notification payload: a present-value and
+ *  status-flags change of an analog input
+ */
+static void bench_cov_init(void)
+{
+    memset(COV_Values, 0, sizeof(COV_Values));
+    cov_property_value_list_link(COV_Values, ARRAY_SIZE(COV_Values));
+    cov_value_list_encode_real(COV_Values, 72.5f, false, false, false, false);
+}
+
+/**
+ * @brief Create the ReadRange payload: trend log records of a REAL
+ *  value logged every 15 minutes
+ */
+static void bench_trend_init(void)
+{
+    unsigned i;
+
+    memset(Trend_Records, 0, sizeof(Trend_Records));
+    for (i = 0; i < BENCH_TREND_RECORDS; i++) {
+        datetime_set_values(
+            &Trend_Records[i].timestamp, 2024, 6, 15, (i / 4) % 24,
+            (i % 4) * 15, 0, 0);
+        Trend_Records[i].tag = BACNET_LOG_DATUM_REAL;
+        Trend_Records[i].log_datum.real_value = 68.0f + (float)i / 8.0f;
+        /* bit 7 includes the optional status flags */
+        Trend_Records[i].status_flags = 0x80;
+    }
+}
+
+/**
+ * @brief Encode the unsigned tag payload
+ * @return number of bytes encoded
+ */
+static int bench_tag_encode(void)
+{
+    int apdu_len = 0;
+    unsigned i;
+
+    for (i = 0; i < ARRAY_SIZE(Tag_Values); i++) {
+        apdu_len += encode_application_unsigned(
+            &Encode_Buffer[apdu_len], Tag_Values[i]);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the unsigned tag payload
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_tag_decode(void)
+{
+    BACNET_UNSIGNED_INTEGER value = 0;
+    int apdu_len = 0;
+    int len;
+    unsigned i;
+
+    for (i = 0; i < ARRAY_SIZE(Tag_Values); i++) {
+        len = bacnet_unsigned_application_decode(
+            &Tag_Buffer[apdu_len], Tag_Buffer_Len - apdu_len, &value);
+        if ((len <= 0) || (value != Tag_Values[i])) {
+            return -1;
+        }
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the application data payload
+ * @return number of bytes encoded
+ */
+static int bench_bacapp_encode(void)
+{
+    int apdu_len = 0;
+    unsigned i;
+
+    for (i = 0; i < ARRAY_SIZE(Values); i++) {
+        apdu_len += bacapp_encode_application_data(
+            &Encode_Buffer[apdu_len], &Values[i]);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the application data payload
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_bacapp_decode(void)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    int apdu_len = 0;
+    int len;
+    unsigned i;
+
+    for (i = 0; i < ARRAY_SIZE(Values); i++) {
+        len = bacapp_decode_application_data(
+            &Value_Buffer[apdu_len], Value_Buffer_Len - apdu_len, &value);
+        if ((len <= 0) || (value.tag != Values[i].tag)) {
+            return -1;
+        }
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the application data payload with the decode cursor
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_cursor_decode(void)
+{
+    BACNET_DECODE_CURSOR cursor;
+    BACNET_APPLICATION_DATA_VIEW value;
+    int apdu_len = 0;
+    int len;
+    unsigned i = 0;
+
+    bacnet_decode_cursor_init(&cursor, Value_Buffer, Value_Buffer_Len);
+    while ((len = bacnet_decode_cursor_next(&cursor, &value)) > 0) {
+        if ((i >= ARRAY_SIZE(Values)) ||
+            (value.tag.number != Values[i].tag)) {
+            return -1;
+        }
+        apdu_len += len;
+        i++;
+    }
+    if ((len < 0) || (i != ARRAY_SIZE(Values))) {
+        return -1;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the RPM ALL payload as a ReadPropertyMultiple-ACK
+ * @return number of bytes encoded
+ */
+static int bench_rpm_ack_encode(void)
+{
+    BACNET_RPM_DATA rpmdata = { 0 };
+    uint8_t *apdu = Encode_Buffer;
+    int apdu_len = 0;
+    int len;
+    unsigned i;
+
+    rpmdata.object_type = OBJECT_ANALOG_INPUT;
+    rpmdata.object_instance = 101;
+    apdu_len += rpm_ack_encode_apdu_init(&apdu[apdu_len], 1);
+    apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
+    for (i = 0; i < ARRAY_SIZE(RPM_Properties); i++) {
+        apdu_len += rpm_ack_encode_apdu_object_property(
+            &apdu[apdu_len], RPM_Properties[i].property, BACNET_ARRAY_ALL);
+        /* the value is encoded in place, between the opening and closing
+           tags that the property value encoder adds */
+        len = bacapp_encode_application_data(
+            &apdu[apdu_len + 1], &RPM_Properties[i].value);
+        apdu_len += rpm_ack_encode_apdu_object_property_value(
+            &apdu[apdu_len], &apdu[apdu_len + 1], len);
+    }
+    apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the ReadPropertyMultiple-ACK of the RPM ALL payload
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_rpm_ack_decode(void)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    BACNET_PROPERTY_ID property = PROP_ALL;
+    BACNET_ARRAY_INDEX array_index = BACNET_ARRAY_ALL;
+    uint32_t object_instance = 0;
+    const uint8_t *apdu = &RPM_Buffer[3];
+    unsigned apdu_size = RPM_Buffer_Len - 3;
+    unsigned apdu_len = 0;
+    unsigned count = 0;
+    int len;
+
+    len = rpm_ack_decode_object_id(
+        apdu, apdu_size, &object_type, &object_instance);
+    if (len <= 0) {
+        return -1;
+    }
+    apdu_len += len;
+    while (!bacnet_is_closing_tag_number(
+        &apdu[apdu_len], apdu_size - apdu_len, 1, &len)) {
+        len = rpm_ack_decode_object_property(
+            &apdu[apdu_len], apdu_size - apdu_len, &property, &array_index);
+        if (len <= 0) {
+            return -1;
+        }
+        apdu_len += len;
+        if (!bacnet_is_opening_tag_number(
+                &apdu[apdu_len], apdu_size - apdu_len, 4, &len)) {
+            return -1;
+        }
+        apdu_len += len;
+        len = bacapp_decode_application_data(
+            &apdu[apdu_len], apdu_size - apdu_len, &value);
+        if (len <= 0) {
+            return -1;
+        }
+        apdu_len += len;
+        if (!bacnet_is_closing_tag_number(
+                &apdu[apdu_len], apdu_size - apdu_len, 4, &len)) {
+            return -1;
+        }
+        apdu_len += len;
+        count++;
+    }
+    apdu_len += len;
+    if (count != ARRAY_SIZE(RPM_Properties)) {
+        return -1;
+    }
+
+    return (int)apdu_len + 3;
+}
+
+/**
+ * @brief Encode the COV notification payload
+ * @return number of bytes encoded
+ */
+static int bench_cov_encode(void)
+{
+    BACNET_COV_DATA data = { 0 };
+
+    data.subscriberProcessIdentifier = 1;
+    data.initiatingDeviceIdentifier = 260001;
+    data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    data.monitoredObjectIdentifier.instance = 101;
+    data.timeRemaining = 300;
+    data.listOfValues = COV_Values;
+
+    return ucov_notify_encode_apdu(Encode_Buffer, sizeof(Encode_Buffer), &data);
+}
+
+/**
+ * @brief Decode the COV notification payload
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_cov_decode(void)
+{
+    BACNET_PROPERTY_VALUE values[ARRAY_SIZE(COV_Values)];
+    BACNET_COV_DATA data = { 0 };
+    int len;
+
+    cov_data_value_list_link(&data, values, ARRAY_SIZE(values));
+    len = cov_notify_decode_service_request(
+        &COV_Buffer[2], COV_Buffer_Len - 2, &data);
+    if ((len <= 0) || (data.monitoredObjectIdentifier.instance != 101)) {
+        return -1;
+    }
+
+    return len + 2;
+}
+
+/**
+ * @brief Encode the trend log records payload as a ReadRange-ACK
+ * @return number of bytes encoded, or negative on error
+ */
+static int bench_rr_ack_encode(void)
+{
+    static uint8_t item_data[MAX_APDU];
+    BACNET_READ_RANGE_DATA data = { 0 };
+    int item_len = 0;
+    int len;
+    unsigned i;
+
+    for (i = 0; i < BENCH_TREND_RECORDS; i++) {
+        len = bacnet_log_record_encode(
+            &item_data[item_len], sizeof(item_data) - item_len,
+            &Trend_Records[i]);
+        if (len <= 0) {
+            return -1;
+        }
+        item_len += len;
+    }
+    data.object_type = OBJECT_TRENDLOG;
+    data.object_instance = 1;
+    data.object_property = PROP_LOG_BUFFER;
+    data.array_index = BACNET_ARRAY_ALL;
+    data.RequestType = RR_BY_SEQUENCE;
+    data.ItemCount = BENCH_TREND_RECORDS;
+    data.FirstSequence = 1;
+    bitstring_init(&data.ResultFlags);
+    bitstring_set_bit(&data.ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
+    bitstring_set_bit(&data.ResultFlags, RESULT_FLAG_LAST_ITEM, true);
+    bitstring_set_bit(&data.ResultFlags, RESULT_FLAG_MORE_ITEMS, false);
+    data.application_data = item_data;
+    data.application_data_len = item_len;
+
+    return rr_ack_encode_apdu(Encode_Buffer, 1, &data);
+}
+
+/**
+ * @brief Decode the ReadRange-ACK and its trend log records
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_rr_ack_decode(void)
+{
+    BACNET_READ_RANGE_DATA data = { 0 };
+    BACNET_LOG_RECORD record;
+    int item_len = 0;
+    int len;
+    unsigned count = 0;
+
+    len = rr_ack_decode_service_request(
+        &RR_Buffer[3], RR_Buffer_Len - 3, &data);
+    if (len <= 0) {
+        return -1;
+    }
+    while (item_len < data.application_data_len) {
+        len = bacnet_log_record_decode(
+            &data.application_data[item_len],
+            data.application_data_len - item_len, &record);
+        if (len <= 0) {
+            return -1;
+        }
+        item_len += len;
+        count++;
+    }
+    if (count != data.ItemCount) {
+        return -1;
+    }
+
+    return RR_Buffer_Len;
+}
+
+/**
+ * @brief Encode the I-Am storm payload: a broadcast NPDU and I-Am APDU
+ *  from each device
+ * @return number of bytes encoded
+ */
+static int bench_iam_encode(void)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data;
+    int pdu_len = 0;
+    int len;
+    unsigned i;
+
+    dest.net = BACNET_BROADCAST_NETWORK;
+    for (i = 0; i < BENCH_IAM_DEVICES; i++) {
+        npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+        len = npdu_encode_pdu(Encode_Buffer, &dest, NULL, &npdu_data);
+        len += iam_encode_apdu(
+            &Encode_Buffer[len], 260000 + i, MAX_APDU, SEGMENTATION_NONE,
+            BACNET_VENDOR_ID);
+        pdu_len += len;
+    }
+
+    return pdu_len;
+}
+
+/**
+ * @brief Decode the I-Am storm payload, as a device binding each
+ *  device would
+ * @return number of bytes decoded, or negative on error
+ */
+static int bench_iam_decode(void)
+{
+    BACNET_ADDRESS dest, src;
+    BACNET_NPDU_DATA npdu_data;
+    uint32_t device_id = 0;
+    unsigned max_apdu = 0;
+    int segmentation = 0;
+    uint16_t vendor_id = 0;
+    int pdu_len = 0;
+    int len, apdu_len;
+    unsigned i;
+
+    for (i = 0; i < BENCH_IAM_DEVICES; i++) {
+        len = bacnet_npdu_decode(
+            IAM_Buffer[i], IAM_Buffer_Len[i], &dest, &src, &npdu_data);
+        if ((len <= 0) ||
+            (IAM_Buffer[i][len + 1] != SERVICE_UNCONFIRMED_I_AM)) {
+            return -1;
+        }
+        apdu_len = bacnet_iam_request_decode(
+            &IAM_Buffer[i][len + 2], IAM_Buffer_Len[i] - len - 2, &device_id,
+            &max_apdu, &segmentation, &vendor_id);
+        if ((apdu_len <= 0) || (device_id != 260000 + i)) {
+            return -1;
+        }
+        pdu_len += IAM_Buffer_Len[i];
+    }
+
+    return pdu_len;
+}
+
+/**
+ * @brief Poll the COV flag of each Analog Input object, one instance
+ *  at a time, as the COV task does for each subscription
+ * @return number of points evaluated
+ */
+static int bench_cov_poll(void)
+{
+    uint32_t instance;
+
+    for (instance = 1; instance <= BENCH_COV_POINTS; instance++) {
+        if (Analog_Input_Change_Of_Value(instance)) {
+            Analog_Input_Change_Of_Value_Clear(instance);
+        }
+    }
+
+    return BENCH_COV_POINTS;
+}
+
+/**
+ * @brief Evaluate the COV increment of every point at once, after one
+ *  in eight of the present values has moved past its increment
+ * @return number of points evaluated
+ */
+static int bench_cov_bulk(void)
+{
+    uint32_t slot, word, limit;
+
+    for (slot = COV_Points_Round % 8; slot < BENCH_COV_POINTS; slot += 8) {
+        COV_Points.Present_Value[slot] += 1.0f;
+    }
+    COV_Points_Round++;
+    limit = dense_value_cov_evaluate(
+        &COV_Points, COV_Points_Bitmap, ARRAY_SIZE(COV_Points_Bitmap));
+    if (limit != BENCH_COV_POINTS) {
+        return -1;
+    }
+    /* clear the COV flag of the changed points, as the COV task does */
+    for (word = 0; word < ARRAY_SIZE(COV_Points_Bitmap); word++) {
+        for (slot = word * 32; COV_Points_Bitmap[word]; slot++) {
+            if (COV_Points_Bitmap[word] & 1U) {
+                COV_Points.Flags[slot] &= ~DENSE_VALUE_FLAG_CHANGED;
+            }
+            COV_Points_Bitmap[word] >>= 1;
+        }
+    }
+
+    return BENCH_COV_POINTS;
+}
+
+/**
+ * @brief Create the analog points of the change-of-value scan
+ * @return true if every point was created
+ */
+static bool bench_cov_points_init(void)
+{
+    uint32_t instance, slot;
+
+    Analog_Input_Init();
+    dense_value_table_init(&COV_Points);
+    for (instance = 1; instance <= BENCH_COV_POINTS; instance++) {
+        if (Analog_Input_Create(instance) != instance) {
+            return false;
+        }
+        Analog_Input_COV_Increment_Set(instance, 0.5f);
+        slot = dense_value_slot_alloc(&COV_Points, instance);
+        if (slot == DENSE_VALUE_SLOT_NONE) {
+            return false;
+        }
+        COV_Points.COV_Increment[slot] = 0.5f;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Create the payloads, and encode them for the decoding benchmarks
+ * @return true if every payload was encoded
+ */
+static bool bench_init(void)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data;
+    int len;
+    unsigned i;
+
+    bench_values_init();
+    bench_rpm_init();
+    bench_cov_init();
+    bench_trend_init();
+    Tag_Buffer_Len = bench_tag_encode();
+    memcpy(Tag_Buffer, Encode_Buffer, Tag_Buffer_Len);
+    Value_Buffer_Len = bench_bacapp_encode();
+    memcpy(Value_Buffer, Encode_Buffer, Value_Buffer_Len);
+    RPM_Buffer_Len = bench_rpm_ack_encode();
+    memcpy(RPM_Buffer, Encode_Buffer, RPM_Buffer_Len);
+    COV_Buffer_Len = bench_cov_encode();
+    memcpy(COV_Buffer, Encode_Buffer, COV_Buffer_Len);
+    RR_Buffer_Len = bench_rr_ack_encode();
+    if (RR_Buffer_Len <= 0) {
+        return false;
+    }
+    memcpy(RR_Buffer, Encode_Buffer, RR_Buffer_Len);
+    dest.net = BACNET_BROADCAST_NETWORK;
+    for (i = 0; i < BENCH_IAM_DEVICES; i++) {
+        npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+        len = npdu_encode_pdu(IAM_Buffer[i], &dest, NULL, &npdu_data);
+        len += iam_encode_apdu(
+            &IAM_Buffer[i][len], 260000 + i, MAX_APDU, SEGMENTATION_NONE,
+            BACNET_VENDOR_ID);
+        IAM_Buffer_Len[i] = len;
+    }
+
+    return (Tag_Buffer_Len > 0) && (Value_Buffer_Len > 0) &&
+        (RPM_Buffer_Len > 0) && (COV_Buffer_Len > 0) &&
+        bench_cov_points_init();
+}
+
+static struct bench_case Bench_Cases[] = {
+    { "tag-unsigned-encode", bench_tag_encode },
+    { "tag-unsigned-decode", bench_tag_decode },
+    { "bacapp-encode", bench_bacapp_encode },
+    { "bacapp-decode", bench_bacapp_decode },
+    { "bacapp-cursor-decode", bench_cursor_decode },
+    { "rpm-all-ack-encode", bench_rpm_ack_encode },
+    { "rpm-all-ack-decode", bench_rpm_ack_decode },
+    { "cov-notify-encode", bench_cov_encode },
+    { "cov-notify-decode", bench_cov_decode },
+    { "readrange-trend-ack-encode", bench_rr_ack_encode },
+    { "readrange-trend-ack-decode", bench_rr_ack_decode },
+    { "iam-storm-encode", bench_iam_encode },
+    { "iam-storm-decode", bench_iam_decode },
+    { "cov-poll-ai-10k", bench_cov_poll },
+    { "cov-bulk-10k", bench_cov_bulk },
+};
+
+/**
+ * @brief Run one benchmark and print its results
+ * @param bench - benchmark to run
+ * @param iterations - number of operations, or zero to repeat the
+ *  operations for the minimum run time
+ * @return true if the benchmark ran without a codec failure
+ */
+static bool bench_run(const struct bench_case *bench, unsigned long iterations)
+{
+    unsigned long count = iterations ? iterations : 1000;
+    unsigned long i;
+    uint64_t start, elapsed;
+    int len = 0;
+
+    /* warm up, and check that the codec works with this payload */
+    len = bench->run();
+    if (len <= 0) {
+        printf("%-28s failed\n", bench->name);
+        return false;
+    }
+    for (;;) {
+        start = bench_nanoseconds();
+        for (i = 0; i < count; i++) {
+            if (bench->run() <= 0) {
+                printf("%-28s failed\n", bench->name);
+                return false;
+            }
+        }
+        elapsed = bench_nanoseconds() - start;
+        if (iterations || (elapsed >= BENCH_MIN_NANOSECONDS) ||
+            (count > (ULONG_MAX / 2))) {
+            break;
+        }
+        count *= 2;
+    }
+    printf(
+        "%-28s %12lu %12.1f ns/op %8d bytes/op\n", bench->name, count,
+        (double)elapsed / (double)count, len);
+
+    return true;
+}
+
+static void print_usage(const char *filename)
+{
+    printf("Usage: %s [--iterations count] [benchmark-name ...]\n", filename);
+    printf("       [--list][--version][--help]\n");
+}
+
+static void print_help(const char *filename)
+{
+    printf(
+        "Measure the time to encode and decode representative BACnet\n"
+        "payloads, and to scan 10240 analog points for COV, and print\n"
+        "the nanoseconds and bytes, or points, per operation.\n");
+    printf("\n");
+    printf(
+        "--iterations count:\n"
+        "Number of operations for each benchmark. The default repeats\n"
+        "the operations for at least 200 milliseconds.\n");
+    printf("\n");
+    printf(
+        "--list:\n"
+        "Print the benchmark names and exit.\n");
+    printf("\n");
+    printf(
+        "benchmark-name:\n"
+        "Run only the benchmarks whose names contain this text.\n");
+    printf("\n");
+    printf(
+        "Example:\n"
+        "%s --iterations 100000 rpm\n",
+        filename);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = NULL;
+    const char *filters[16] = { NULL };
+    unsigned filter_count = 0;
+    unsigned long iterations = 0;
+    bool selected = false;
+    bool failed = false;
+    unsigned i, f;
+    int argi;
+
+    filename = filename_remove_path(argv[0]);
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--help") == 0) {
+            print_usage(filename);
+            print_help(filename);
+            return 0;
+        }
+        if (strcmp(argv[argi], "--version") == 0) {
+            printf("%s %s\n", filename, BACNET_VERSION_TEXT);
+            printf("Copyright (C) 2025 by Steve Karg and others.\n"
+                   "This is free software; see the source for copying "
+                   "conditions.\n"
+                   "There is NO warranty; not even for MERCHANTABILITY or\n"
+                   "FITNESS FOR A PARTICULAR PURPOSE.\n");
+            return 0;
+        }
+        if (strcmp(argv[argi], "--list") == 0) {
+            for (i = 0; i < ARRAY_SIZE(Bench_Cases); i++) {
+                printf("%s\n", Bench_Cases[i].name);
+            }
+            return 0;
+        }
+        if (strcmp(argv[argi], "--iterations") == 0) {
+            if (++argi < argc) {
+                iterations = strtoul(argv[argi], NULL, 0);
+            }
+            if (iterations == 0) {
+                fprintf(stderr, "iterations must be greater than zero\n");
+                return 1;
+            }
+        } else if (filter_count < ARRAY_SIZE(filters)) {
+            filters[filter_count] = argv[argi];
+            filter_count++;
+        }
+    }
+    if (!bench_init()) {
+        fprintf(stderr, "unable to encode the benchmark payloads\n");
+        return 1;
+    }
+    for (i = 0; i < ARRAY_SIZE(Bench_Cases); i++) {
+        selected = (filter_count == 0);
+        for (f = 0; f < filter_count; f++) {
+            if (strstr(Bench_Cases[i].name, filters[f])) {
+                selected = true;
+            }
+        }
+        if (selected && !bench_run(&Bench_Cases[i], iterations)) {
+            failed = true;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -31,10 +31,13 @@
 #include "bacnet/version.h"
 /* some demo stuff needed */
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/client/bac-discover.h"
+#include "bacnet/basic/client/bac-rw.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/filename.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/datalink/bip.h"
@@ -159,6 +162,14 @@ static bool ShowValues = false;
 static bool ShowDeviceObjectOnly = false;
 /* read required and optional properties when RPM ALL does not work */
 static bool Optional_Properties = false;
+/* directory for the EPICS of every device, or NULL for one device */
+static const char *Discover_Directory = NULL;
+/* number of requests in progress at once for every device */
+static unsigned Discover_Window = 8;
+/* number of objects written to the EPICS file of each device */
+static OS_Keylist Discover_Devices = NULL;
+/* number of devices with all their objects written */
+static unsigned Discover_Complete_Count = 0;
 
 #if !defined(PRINT_ERRORS)
 #define PRINT_ERRORS 1
@@ -906,6 +917,10 @@ static void print_usage(const char *filename)
         "Usage: %s [-v] [-d] [-p sport] [-t target_mac [-n dnet]]"
         " device-instance\n",
         filename);
+    printf(
+        "       %s [-v] [-p sport] [-t target_mac [-n dnet]]"
+        " --discover directory [--window N]\n",
+        filename);
     printf("       [--version][--help]\n");
 }
 
@@ -929,6 +944,11 @@ static void print_help(const char *filename)
     printf("    Use \"7F:00:00:01:BA:C0\" for loopback testing \n");
     printf("-n: specify target's DNET if not local BACnet network  \n");
     printf("    or on routed Virtual Network \n");
+    printf("--discover: discover every device on the network, and write\n");
+    printf("    the objects of each device to directory/epics-N.tpi\n");
+    printf("    as they are read, for many devices at once.\n");
+    printf("--window: number of requests in progress at once.\n");
+    printf("    Default is 8.\n");
     printf("\n");
     printf("To generate output directly to a .tpi file for VTS:\n");
     printf("$ bacepics 4194302 > epics-4194302.tpi \n");
@@ -964,6 +984,18 @@ static int CheckCommandLineArgs(int argc, char *argv[])
     }
     for (i = 1; i < argc; i++) {
         char *anArg = argv[i];
+        if (strcmp(anArg, "--discover") == 0) {
+            if (++i < argc) {
+                Discover_Directory = argv[i];
+            }
+            continue;
+        }
+        if (strcmp(anArg, "--window") == 0) {
+            if (++i < argc) {
+                Discover_Window = (unsigned)strtol(argv[i], NULL, 0);
+            }
+            continue;
+        }
         if (anArg[0] == '-') {
             switch (anArg[1]) {
                 case 'o':
@@ -1044,7 +1076,7 @@ static int CheckCommandLineArgs(int argc, char *argv[])
             bFoundTarget = true;
         }
     }
-    if (!bFoundTarget) {
+    if (!bFoundTarget && !Discover_Directory) {
         fprintf(stdout, "Error: Must provide a device-instance \n\n");
         print_usage(filename);
         exit(0);
@@ -1322,6 +1354,258 @@ static void StartNextObject(
     rpm_property->propertyArrayIndex = BACNET_ARRAY_ALL;
 }
 
+/**
+ * @brief Determine if a property value is shown as '?' in an EPICS
+ * @param property_id [in] The property identifier
+ * @return true if the value is shown only with -v
+ */
+static bool Discover_Value_Hidden(uint32_t property_id)
+{
+    switch (property_id) {
+        case PROP_DEVICE_ADDRESS_BINDING:
+        case PROP_DAYLIGHT_SAVINGS_STATUS:
+        case PROP_LOCAL_TIME:
+        case PROP_LOCAL_DATE:
+        case PROP_PRESENT_VALUE:
+        case PROP_PRIORITY_ARRAY:
+        case PROP_RELIABILITY:
+        case PROP_UTC_OFFSET:
+        case PROP_DATABASE_REVISION:
+            return !ShowValues;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Write a discovered property of an object to an EPICS file
+ * @param device_id [in] The device ID of the data
+ * @param device_index [in] The index of the device
+ * @param object_index [in] The index of the object
+ * @param property_index [in] The index of the property
+ * @param rp_data [in] The contents of the device object property
+ * @param context [in] The EPICS file
+ * @return true to continue with the next property
+ */
+static bool Discover_Property_Print(
+    uint32_t device_id,
+    unsigned device_index,
+    unsigned object_index,
+    unsigned property_index,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    void *context)
+{
+    FILE *file = context;
+    BACNET_OBJECT_PROPERTY_VALUE object_value = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    uint8_t *apdu = rp_data->application_data;
+    int apdu_len = rp_data->application_data_len;
+    int len;
+    bool array = false;
+
+    (void)device_id;
+    (void)device_index;
+    (void)object_index;
+    (void)property_index;
+    if (bactext_property_name_proprietary(rp_data->object_property)) {
+        fprintf(
+            file, "    -- proprietary %lu: ",
+            (unsigned long)rp_data->object_property);
+    } else {
+        fprintf(
+            file, "    %s: ", bactext_property_name(rp_data->object_property));
+    }
+    if (Discover_Value_Hidden(rp_data->object_property)) {
+        fprintf(file, "?");
+    } else if (apdu_len <= 0) {
+        fprintf(file, "{}");
+    } else {
+        object_value.object_type = rp_data->object_type;
+        object_value.object_instance = rp_data->object_instance;
+        object_value.object_property = rp_data->object_property;
+        object_value.array_index = BACNET_ARRAY_ALL;
+        object_value.value = &value;
+        while (apdu_len > 0) {
+            len = bacapp_decode_known_property(
+                apdu, apdu_len, &value, rp_data->object_type,
+                rp_data->object_property);
+            if (len <= 0) {
+                fprintf(file, "?");
+                break;
+            }
+            if (!array && (len < apdu_len)) {
+                array = true;
+                fprintf(file, "{ ");
+            }
+            bacapp_print_value(file, &object_value);
+            apdu += len;
+            apdu_len -= len;
+            if (apdu_len > 0) {
+                fprintf(file, ", ");
+            }
+        }
+        if (array) {
+            fprintf(file, " }");
+        }
+    }
+    if (property_list_writable_member(
+            rp_data->object_type, rp_data->object_property)) {
+        fprintf(file, " Writable");
+    }
+    fprintf(file, "\n");
+
+    return true;
+}
+
+/**
+ * @brief Append a discovered object to the EPICS file of its device
+ * @param device_id [in] The device ID of the object
+ * @param object_type [in] The object type of the object
+ * @param object_instance [in] The object instance of the object
+ */
+static void Discover_Object_Print(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    char pathname[256];
+    unsigned *count;
+    FILE *file;
+
+    count = Keylist_Data(Discover_Devices, device_id);
+    if (!count) {
+        count = calloc(1, sizeof(unsigned));
+        if (!count) {
+            return;
+        }
+        if (Keylist_Data_Add(Discover_Devices, device_id, count) < 0) {
+            free(count);
+            return;
+        }
+    }
+    snprintf(
+        pathname, sizeof(pathname), "%s/epics-%lu.tpi", Discover_Directory,
+        (unsigned long)device_id);
+    file = fopen(pathname, (*count == 0) ? "w" : "a");
+    if (!file) {
+        fprintf(stderr, "%s: unable to open!\n", pathname);
+        return;
+    }
+    if (*count == 0) {
+        fprintf(file, "List of Objects in Test Device:\n");
+        fprintf(file, "{\n");
+    } else {
+        fprintf(file, ",\n");
+    }
+    fprintf(file, "  {\n");
+    bacnet_discover_device_object_property_iterate(
+        device_id, object_type, object_instance, Discover_Property_Print,
+        file);
+    fprintf(file, "  }");
+    fclose(file);
+    (*count)++;
+}
+
+/**
+ * @brief Close the EPICS file of a device with all its objects written
+ * @param device_id [in] The device ID of the device
+ */
+static void Discover_Device_Print(uint32_t device_id)
+{
+    char pathname[256];
+    const unsigned *count;
+    FILE *file;
+
+    Discover_Complete_Count++;
+    count = Keylist_Data(Discover_Devices, device_id);
+    if (!count || (*count == 0)) {
+        return;
+    }
+    snprintf(
+        pathname, sizeof(pathname), "%s/epics-%lu.tpi", Discover_Directory,
+        (unsigned long)device_id);
+    file = fopen(pathname, "a");
+    if (!file) {
+        fprintf(stderr, "%s: unable to open!\n", pathname);
+        return;
+    }
+    fprintf(file, "\n}\n");
+    fprintf(
+        file, "End of BACnet Protocol Implementation Conformance Statement\n");
+    fprintf(file, "\n");
+    fclose(file);
+    fprintf(stdout, "%s: %u objects\n", pathname, *count);
+}
+
+/**
+ * @brief Generate the EPICS objects of every device on the network, using
+ *  the discovery of many devices at once with a bounded number of requests
+ *  in progress, and writing each object as soon as it has been read.
+ * @return 0 on success
+ */
+static int Discover_EPICS(void)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint16_t pdu_len = 0;
+    struct mstimer tsm_timer = { 0 };
+    struct mstimer maintenance_timer = { 0 };
+    struct mstimer settle_timer = { 0 };
+    unsigned long settle_milliseconds;
+    int device_count = 0, count;
+    unsigned *object_count;
+
+    Discover_Devices = Keylist_Create();
+    if (Provided_Targ_MAC) {
+        bacnet_discover_dest_set(&Target_Address);
+    }
+    /* discover each device once */
+    bacnet_discover_seconds_set(24UL * 60UL * 60UL);
+    bacnet_discover_init();
+    bacnet_read_write_window_set(Discover_Window);
+    bacnet_discover_object_complete_callback_set(Discover_Object_Print);
+    bacnet_discover_device_complete_callback_set(Discover_Device_Print);
+    /* wait for the I-Am replies after the devices are complete */
+    settle_milliseconds = (unsigned long)apdu_timeout() * apdu_retries();
+    mstimer_set(&settle_timer, settle_milliseconds);
+    mstimer_set(&tsm_timer, 50);
+    mstimer_set(&maintenance_timer, 1000);
+    for (;;) {
+        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, 5);
+        if (pdu_len) {
+            npdu_handler(&src, &Rx_Buf[0], pdu_len);
+        }
+        if (mstimer_expired(&tsm_timer)) {
+            mstimer_reset(&tsm_timer);
+            tsm_timer_milliseconds(mstimer_interval(&tsm_timer));
+        }
+        if (mstimer_expired(&maintenance_timer)) {
+            mstimer_reset(&maintenance_timer);
+            datalink_maintenance_timer(1);
+        }
+        bacnet_discover_task();
+        count = bacnet_discover_device_count();
+        if (count != device_count) {
+            device_count = count;
+            mstimer_restart(&settle_timer);
+        }
+        if (mstimer_expired(&settle_timer) &&
+            (Discover_Complete_Count >= (unsigned)device_count)) {
+            break;
+        }
+    }
+    do {
+        object_count = Keylist_Data_Pop(Discover_Devices);
+        free(object_count);
+    } while (object_count);
+    Keylist_Delete(Discover_Devices);
+    bacnet_discover_cleanup();
+    fprintf(stdout, "%d devices\n", device_count);
+
+    return 0;
+}
+
 /** Main function of the bacepics program.
  *
  * @see Device_Set_Object_Instance_Number, Keylist_Create, address_init,
@@ -1392,6 +1676,9 @@ int main(int argc, char *argv[])
         bip_set_port(0xBAC0);
     }
 #endif
+    if (Discover_Directory) {
+        return Discover_EPICS();
+    }
     /* try to bind with the target device */
     found = address_bind_request(
         Target_Device_Object_Instance, &max_apdu, &Target_Address);
@@ -0,0 +1,830 @@
+/**
+ * @file
+ * @brief command line tool that measures the throughput and latency of a
+ * BACnet server.  It drives a configurable mix of ReadProperty,
+ * ReadPropertyMultiple, WriteProperty, and SubscribeCOV requests at one
+ * device, with many invoke IDs in flight at once, and reports the
+ * requests per second and the latency percentiles of each service.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#define PRINT_ENABLED 1
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bactext.h"
+#include "bacnet/bacerror.h"
+#include "bacnet/iam.h"
+#include "bacnet/npdu.h"
+#include "bacnet/apdu.h"
+#include "bacnet/rpm.h"
+#include "bacnet/whois.h"
+#include "bacnet/version.h"
+/* some demo stuff needed */
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/datalink/dlenv.h"
+#include "bacport.h"
+
+#if BACNET_SVC_SERVER
+#error "App requires server-only features disabled! Set BACNET_SVC_SERVER=0"
+#endif
+
+/* the services of the load mix */
+enum load_service {
+    LOAD_SERVICE_RP = 0,
+    LOAD_SERVICE_RPM,
+    LOAD_SERVICE_WP,
+    LOAD_SERVICE_COV,
+    LOAD_SERVICE_MAX
+};
+
+/* the outcomes of a request */
+enum load_outcome {
+    LOAD_OUTCOME_ACK = 0,
+    LOAD_OUTCOME_ERROR,
+    LOAD_OUTCOME_REJECT,
+    LOAD_OUTCOME_ABORT,
+    LOAD_OUTCOME_TIMEOUT,
+    LOAD_OUTCOME_MAX
+};
+
+/* the counters and latencies of one service */
+struct load_statistics {
+    unsigned weight;
+    int credit;
+    unsigned long sent;
+    unsigned long outcome[LOAD_OUTCOME_MAX];
+    /* latencies of the acknowledged requests, in microseconds */
+    uint32_t *latency;
+    unsigned long latency_count;
+    unsigned long latency_size;
+};
+
+/* a request in flight, by invoke ID */
+struct load_request {
+    bool active;
+    enum load_service service;
+    uint64_t sent_ns;
+};
+
+static const char *Load_Service_Name[LOAD_SERVICE_MAX] = {
+    "ReadProperty", "ReadPropertyMultiple", "WriteProperty", "SubscribeCOV"
+};
+static struct load_statistics Load_Statistics[LOAD_SERVICE_MAX];
+static struct load_request Load_Request[256];
+static unsigned Load_Active;
+
+/* buffer used for receive */
+static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+/* buffer used to encode the ReadPropertyMultiple requests */
+static uint8_t Tx_Buf[MAX_PDU] = { 0 };
+
+/* global variables used in this file */
+static uint32_t Target_Device_Object_Instance = BACNET_MAX_INSTANCE;
+static BACNET_ADDRESS Target_Address;
+static BACNET_OBJECT_TYPE Target_Object_Type = OBJECT_ANALOG_VALUE;
+static uint32_t Target_Object_Instance = 1;
+
+/**
+ * @brief Get a monotonic time stamp
+ * @return time stamp in nanoseconds
+ */
+static uint64_t load_nanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((count.QuadPart * 1000000000.0) / frequency.QuadPart);
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Record the latency of an acknowledged request
+ * @param stats - the counters of the service
+ * @param microseconds - latency of the request
+ */
+static void
+load_latency_add(struct load_statistics *stats, uint32_t microseconds)
+{
+    uint32_t *latency;
+    unsigned long size;
+
+    if (stats->latency_count >= stats->latency_size) {
+        size = stats->latency_size ? stats->latency_size * 2 : 1024;
+        latency = realloc(stats->latency, size * sizeof(uint32_t));
+        if (!latency) {
+            return;
+        }
+        stats->latency = latency;
+        stats->latency_size = size;
+    }
+    stats->latency[stats->latency_count] = microseconds;
+    stats->latency_count++;
+}
+
+/**
+ * @brief Complete a request in flight
+ * @param src - source address of the reply, or NULL for a timeout
+ * @param invoke_id - invoke ID of the request
+ * @param outcome - the outcome of the request
+ */
+static void
+load_complete(BACNET_ADDRESS *src, uint8_t invoke_id, enum load_outcome outcome)
+{
+    struct load_request *request = &Load_Request[invoke_id];
+    struct load_statistics *stats;
+    uint64_t elapsed;
+
+    if (!request->active) {
+        return;
+    }
+    if (src && !address_match(&Target_Address, src)) {
+        return;
+    }
+    stats = &Load_Statistics[request->service];
+    stats->outcome[outcome]++;
+    if (outcome == LOAD_OUTCOME_ACK) {
+        elapsed = (load_nanoseconds() - request->sent_ns) / 1000;
+        load_latency_add(
+            stats, (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed);
+    }
+    request->active = false;
+    Load_Active--;
+}
+
+static void My_Complex_Ack_Handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
+{
+    (void)service_request;
+    (void)service_len;
+    load_complete(src, service_data->invoke_id, LOAD_OUTCOME_ACK);
+}
+
+static void My_Simple_Ack_Handler(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    load_complete(src, invoke_id, LOAD_OUTCOME_ACK);
+}
+
+static void MyErrorHandler(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    (void)error_class;
+    (void)error_code;
+    load_complete(src, invoke_id, LOAD_OUTCOME_ERROR);
+}
+
+static void MyAbortHandler(
+    BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t abort_reason, bool server)
+{
+    (void)abort_reason;
+    (void)server;
+    load_complete(src, invoke_id, LOAD_OUTCOME_ABORT);
+}
+
+static void
+MyRejectHandler(BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason)
+{
+    (void)reject_reason;
+    load_complete(src, invoke_id, LOAD_OUTCOME_REJECT);
+}
+
+static void Init_Service_Handlers(void)
+{
+    Device_Init(NULL);
+    /* we need to handle who-is
+       to support dynamic device binding to us */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    /* handle i-am to support binding to other devices */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_bind);
+    /* set the handler for all the services we don't implement
+       It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    /* we must implement read property - it's required! */
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    /* handle the data coming back from confirmed requests */
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, My_Complex_Ack_Handler);
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, My_Complex_Ack_Handler);
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_WRITE_PROPERTY, My_Simple_Ack_Handler);
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV, My_Simple_Ack_Handler);
+    /* handle any errors coming back */
+    apdu_set_error_handler(SERVICE_CONFIRMED_READ_PROPERTY, MyErrorHandler);
+    apdu_set_error_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, MyErrorHandler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_WRITE_PROPERTY, MyErrorHandler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV, MyErrorHandler);
+    apdu_set_abort_handler(MyAbortHandler);
+    apdu_set_reject_handler(MyRejectHandler);
+}
+
+/**
+ * @brief Pick the service of the next request.  The services are
+ *  interleaved in proportion to their weights, without randomness,
+ *  so two runs with the same mix send the same sequence.
+ * @return the service of the next request
+ */
+static enum load_service load_service_next(void)
+{
+    enum load_service service = LOAD_SERVICE_RP;
+    int total = 0;
+    int i;
+
+    for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+        Load_Statistics[i].credit += (int)Load_Statistics[i].weight;
+        total += (int)Load_Statistics[i].weight;
+        if (Load_Statistics[i].credit > Load_Statistics[service].credit) {
+            service = (enum load_service)i;
+        }
+    }
+    Load_Statistics[service].credit -= total;
+
+    return service;
+}
+
+/**
+ * @brief Send one request of a service to the target object
+ * @param service - the service of the request
+ * @return invoke ID of the request, or 0 if it was not sent
+ */
+static uint8_t load_request_send(enum load_service service)
+{
+    BACNET_READ_ACCESS_DATA rpm_data = { 0 };
+    BACNET_PROPERTY_REFERENCE rpm_property[3] = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    static float present_value;
+    uint8_t invoke_id = 0;
+
+    switch (service) {
+        case LOAD_SERVICE_RP:
+            invoke_id = Send_Read_Property_Request(
+                Target_Device_Object_Instance, Target_Object_Type,
+                Target_Object_Instance, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+            break;
+        case LOAD_SERVICE_RPM:
+            rpm_property[0].propertyIdentifier = PROP_PRESENT_VALUE;
+            rpm_property[0].propertyArrayIndex = BACNET_ARRAY_ALL;
+            rpm_property[0].next = &rpm_property[1];
+            rpm_property[1].propertyIdentifier = PROP_STATUS_FLAGS;
+            rpm_property[1].propertyArrayIndex = BACNET_ARRAY_ALL;
+            rpm_property[1].next = &rpm_property[2];
+            rpm_property[2].propertyIdentifier = PROP_OBJECT_NAME;
+            rpm_property[2].propertyArrayIndex = BACNET_ARRAY_ALL;
+            rpm_data.object_type = Target_Object_Type;
+            rpm_data.object_instance = Target_Object_Instance;
+            rpm_data.listOfProperties = &rpm_property[0];
+            invoke_id = Send_Read_Property_Multiple_Request(
+                &Tx_Buf[0], sizeof(Tx_Buf), Target_Device_Object_Instance,
+                &rpm_data);
+            break;
+        case LOAD_SERVICE_WP:
+            /* a changing value, so that COV subscribers are notified */
+            present_value = (present_value >= 100.0f) ? 0.0f
+                                                       : present_value + 1.0f;
+            value.tag = BACNET_APPLICATION_TAG_REAL;
+            value.type.Real = present_value;
+            invoke_id = Send_Write_Property_Request(
+                Target_Device_Object_Instance, Target_Object_Type,
+                Target_Object_Instance, PROP_PRESENT_VALUE, &value,
+                BACNET_MAX_PRIORITY, BACNET_ARRAY_ALL);
+            break;
+        case LOAD_SERVICE_COV:
+            cov_data.subscriberProcessIdentifier = 1;
+            cov_data.monitoredObjectIdentifier.type = Target_Object_Type;
+            cov_data.monitoredObjectIdentifier.instance =
+                Target_Object_Instance;
+            cov_data.cancellationRequest = false;
+            cov_data.issueConfirmedNotifications = false;
+            cov_data.lifetime = 60;
+            invoke_id = Send_COV_Subscribe(
+                Target_Device_Object_Instance, &cov_data);
+            break;
+        default:
+            break;
+    }
+
+    return invoke_id;
+}
+
+/**
+ * @brief Parse the weights of the load mix
+ * @param mix - a list like rp=70,rpm=20,wp=10,cov=0
+ * @return true if the mix is valid and has a service with some weight
+ */
+static bool load_mix_parse(char *mix)
+{
+    static const char *keyword[LOAD_SERVICE_MAX] = { "rp", "rpm", "wp",
+                                                     "cov" };
+    unsigned long weight = 0;
+    unsigned total = 0;
+    char *token;
+    char *value;
+    int i;
+
+    for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+        Load_Statistics[i].weight = 0;
+    }
+    for (token = strtok(mix, ","); token; token = strtok(NULL, ",")) {
+        value = strchr(token, '=');
+        if (!value) {
+            return false;
+        }
+        *value = 0;
+        value++;
+        if (!bacnet_strtoul(value, &weight) || (weight > 1000)) {
+            return false;
+        }
+        for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+            if (strcmp(token, keyword[i]) == 0) {
+                Load_Statistics[i].weight = (unsigned)weight;
+                break;
+            }
+        }
+        if (i == LOAD_SERVICE_MAX) {
+            return false;
+        }
+    }
+    for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+        total += Load_Statistics[i].weight;
+    }
+
+    return total > 0;
+}
+
+static int load_latency_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Get a percentile of the sorted latencies, by nearest rank
+ * @param stats - the counters of the service, with sorted latencies
+ * @param permille - the percentile, in tenths of a percent
+ * @return the latency, in microseconds
+ */
+static uint32_t
+load_percentile(const struct load_statistics *stats, unsigned permille)
+{
+    unsigned long rank;
+
+    if (stats->latency_count == 0) {
+        return 0;
+    }
+    rank = (stats->latency_count * permille + 999) / 1000;
+    if (rank > 0) {
+        rank--;
+    }
+
+    return stats->latency[rank];
+}
+
+/**
+ * @brief Print the report of the run
+ * @param elapsed_ns - duration of the run
+ * @param json - true to print a JSON object, false for a table
+ */
+static void load_report(uint64_t elapsed_ns, bool json)
+{
+    struct load_statistics *stats;
+    unsigned long completed = 0;
+    double seconds = (double)elapsed_ns / 1000000000.0;
+    int i, j;
+
+    for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+        stats = &Load_Statistics[i];
+        for (j = 0; j < LOAD_OUTCOME_MAX; j++) {
+            completed += stats->outcome[j];
+        }
+        if (stats->latency_count) {
+            qsort(
+                stats->latency, stats->latency_count, sizeof(uint32_t),
+                load_latency_compare);
+        }
+    }
+    if (seconds <= 0.0) {
+        seconds = 1.0e-9;
+    }
+    if (json) {
+        printf(
+            "{\"seconds\":%.3f,\"completed\":%lu,\"requests-per-second\":%.1f,"
+            "\"services\":[",
+            seconds, completed, completed / seconds);
+    } else {
+        printf(
+            "%lu requests in %.3f s: %.1f requests/s\n", completed, seconds,
+            completed / seconds);
+        printf(
+            "%-22s %8s %8s %8s %8s %8s %8s %6s %6s %6s %6s\n", "service",
+            "acked", "min-us", "p50-us", "p99-us", "p99.9-us", "max-us",
+            "error", "reject", "abort", "tmout");
+    }
+    for (i = 0, j = 0; i < LOAD_SERVICE_MAX; i++) {
+        stats = &Load_Statistics[i];
+        if (stats->sent == 0) {
+            continue;
+        }
+        if (json) {
+            printf(
+                "%s{\"service\":\"%s\",\"sent\":%lu,\"acked\":%lu,"
+                "\"error\":%lu,\"reject\":%lu,\"abort\":%lu,\"timeout\":%lu,"
+                "\"min-us\":%lu,\"p50-us\":%lu,\"p99-us\":%lu,"
+                "\"p99.9-us\":%lu,\"max-us\":%lu}",
+                j ? "," : "", Load_Service_Name[i], stats->sent,
+                stats->outcome[LOAD_OUTCOME_ACK],
+                stats->outcome[LOAD_OUTCOME_ERROR],
+                stats->outcome[LOAD_OUTCOME_REJECT],
+                stats->outcome[LOAD_OUTCOME_ABORT],
+                stats->outcome[LOAD_OUTCOME_TIMEOUT],
+                (unsigned long)load_percentile(stats, 0),
+                (unsigned long)load_percentile(stats, 500),
+                (unsigned long)load_percentile(stats, 990),
+                (unsigned long)load_percentile(stats, 999),
+                (unsigned long)load_percentile(stats, 1000));
+        } else {
+            printf(
+                "%-22s %8lu %8lu %8lu %8lu %8lu %8lu %6lu %6lu %6lu %6lu\n",
+                Load_Service_Name[i], stats->outcome[LOAD_OUTCOME_ACK],
+                (unsigned long)load_percentile(stats, 0),
+                (unsigned long)load_percentile(stats, 500),
+                (unsigned long)load_percentile(stats, 990),
+                (unsigned long)load_percentile(stats, 999),
+                (unsigned long)load_percentile(stats, 1000),
+                stats->outcome[LOAD_OUTCOME_ERROR],
+                stats->outcome[LOAD_OUTCOME_REJECT],
+                stats->outcome[LOAD_OUTCOME_ABORT],
+                stats->outcome[LOAD_OUTCOME_TIMEOUT]);
+        }
+        j++;
+    }
+    if (json) {
+        printf("]}\n");
+    }
+}
+
+static void cleanup(void)
+{
+    int i;
+
+    for (i = 0; i < LOAD_SERVICE_MAX; i++) {
+        free(Load_Statistics[i].latency);
+        Load_Statistics[i].latency = NULL;
+    }
+}
+
+static void target_address_add(
+    long dnet, const BACNET_MAC_ADDRESS *mac, const BACNET_MAC_ADDRESS *adr)
+{
+    BACNET_ADDRESS dest = { 0 };
+
+    if (adr->len && mac->len) {
+        memcpy(&dest.mac[0], &mac->adr[0], mac->len);
+        dest.mac_len = mac->len;
+        memcpy(&dest.adr[0], &adr->adr[0], adr->len);
+        dest.len = adr->len;
+        if ((dnet >= 0) && (dnet <= UINT16_MAX)) {
+            dest.net = dnet;
+        } else {
+            dest.net = BACNET_BROADCAST_NETWORK;
+        }
+    } else if (mac->len) {
+        memcpy(&dest.mac[0], &mac->adr[0], mac->len);
+        dest.mac_len = mac->len;
+        dest.len = 0;
+        if ((dnet >= 0) && (dnet <= UINT16_MAX)) {
+            dest.net = dnet;
+        } else {
+            dest.net = 0;
+        }
+    } else {
+        if ((dnet >= 0) && (dnet <= UINT16_MAX)) {
+            dest.net = dnet;
+        } else {
+            dest.net = BACNET_BROADCAST_NETWORK;
+        }
+        dest.mac_len = 0;
+        dest.len = 0;
+    }
+    address_add(Target_Device_Object_Instance, MAX_APDU, &dest);
+}
+
+static void print_usage(const char *filename)
+{
+    printf("Usage: %s device-instance\n", filename);
+    printf("       [--mix rp=N,rpm=N,wp=N,cov=N][--window N]\n");
+    printf("       [--count N][--duration S][--object type instance]\n");
+    printf("       [--dnet][--dadr][--mac][--json]\n");
+    printf("       [--version][--help]\n");
+}
+
+static void print_help(const char *filename)
+{
+    printf("Measure the throughput and latency of a BACnet device\n"
+           "by sending it a mix of confirmed requests, with many\n"
+           "requests in flight at once.\n");
+    printf("\n");
+    printf("--mix rp=N,rpm=N,wp=N,cov=N\n"
+           "Relative weights of the ReadProperty, ReadPropertyMultiple,\n"
+           "WriteProperty, and SubscribeCOV requests.  ReadProperty reads\n"
+           "the Present_Value, ReadPropertyMultiple reads the Present_Value,\n"
+           "Status_Flags, and Object_Name, WriteProperty writes a REAL\n"
+           "Present_Value at priority 16, and SubscribeCOV subscribes for\n"
+           "unconfirmed notifications.  Default is rp=100.\n");
+    printf("\n");
+    printf("--window N\n"
+           "Number of requests in flight at once.  Default is 8.\n");
+    printf("\n");
+    printf("--count N\n"
+           "Number of requests to send.  Default is 1000.\n");
+    printf("\n");
+    printf("--duration S\n"
+           "Send requests for S seconds instead of a count.\n");
+    printf("\n");
+    printf("--object type instance\n"
+           "Object of the requests.  Default is analog-value 1.\n");
+    printf("\n");
+    printf("--json\n"
+           "Print the report as a JSON object.\n");
+    printf("\n");
+    printf("--mac A\n"
+           "Optional BACnet mac address."
+           "Valid ranges are from 00 to FF (hex) for MS/TP or ARCNET,\n"
+           "or an IP string with optional port number like 10.1.2.3:47808\n"
+           "or an Ethernet MAC in hex like 00:21:70:7e:32:bb\n");
+    printf("\n");
+    printf("--dnet N\n"
+           "Optional BACnet network number N for directed requests.\n"
+           "Valid range is from 0 to 65535 where 0 is the local connection\n"
+           "and 65535 is network broadcast.\n");
+    printf("\n");
+    printf("--dadr A\n"
+           "Optional BACnet mac address on the destination BACnet network "
+           "number.\n"
+           "Valid ranges are from 00 to FF (hex) for MS/TP or ARCNET,\n"
+           "or an IP string with optional port number like 10.1.2.3:47808\n"
+           "or an Ethernet MAC in hex like 00:21:70:7e:32:bb\n");
+    printf("\n");
+    printf("device-instance:\n"
+           "BACnet Device Object Instance number that you are\n"
+           "trying to communicate to.  This number will be used\n"
+           "to try and bind with the device using Who-Is and\n"
+           "I-Am services.\n");
+    printf("\n");
+    printf(
+        "Example:\n"
+        "To send 10000 requests, mostly reads, with 32 in flight\n"
+        "to Device 123, use the following command:\n"
+        "%s 123 --count 10000 --window 32 --mix rp=70,rpm=20,wp=10\n",
+        filename);
+}
+
+int main(int argc, char *argv[])
+{
+    BACNET_ADDRESS src = { 0 }; /* address where message came from */
+    uint16_t pdu_len = 0;
+    unsigned max_apdu = 0;
+    struct mstimer tsm_timer = { 0 };
+    struct mstimer maintenance_timer = { 0 };
+    struct mstimer bind_timer = { 0 };
+    enum load_service service = LOAD_SERVICE_RP;
+    uint64_t start_ns = 0, stop_ns = 0;
+    uint64_t duration_ns = 0;
+    unsigned long request_count = 1000;
+    unsigned long sent_count = 0;
+    unsigned long value = 0;
+    unsigned window = 8;
+    unsigned i = 0;
+    uint32_t object_type = 0;
+    uint8_t invoke_id = 0;
+    bool found = false;
+    bool sending = true;
+    bool json = false;
+    int argi = 0;
+    long dnet = -1;
+    BACNET_MAC_ADDRESS mac = { 0 };
+    BACNET_MAC_ADDRESS adr = { 0 };
+    bool specific_address = false;
+    unsigned int target_args = 0;
+    const char *filename = NULL;
+
+    filename = filename_remove_path(argv[0]);
+    Load_Statistics[LOAD_SERVICE_RP].weight = 100;
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--help") == 0) {
+            print_usage(filename);
+            print_help(filename);
+            return 0;
+        }
+        if (strcmp(argv[argi], "--version") == 0) {
+            printf("%s %s\n", filename, BACNET_VERSION_TEXT);
+            printf("Copyright (C) 2014 by Steve Karg and others.\n"
+                   "This is free software; see the source for copying "
+                   "conditions.\n"
+                   "There is NO warranty; not even for MERCHANTABILITY or\n"
+                   "FITNESS FOR A PARTICULAR PURPOSE.\n");
+            return 0;
+        }
+        if (strcmp(argv[argi], "--mix") == 0) {
+            if ((++argi >= argc) || !load_mix_parse(argv[argi])) {
+                fprintf(stderr, "mix invalid\n");
+                return 1;
+            }
+        } else if (strcmp(argv[argi], "--window") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0)) {
+                fprintf(stderr, "window invalid\n");
+                return 1;
+            }
+            window = (value > MAX_TSM_TRANSACTIONS) ? MAX_TSM_TRANSACTIONS
+                                                     : (unsigned)value;
+        } else if (strcmp(argv[argi], "--count") == 0) {
+            if ((++argi >= argc) ||
+                !bacnet_strtoul(argv[argi], &request_count)) {
+                fprintf(stderr, "count invalid\n");
+                return 1;
+            }
+        } else if (strcmp(argv[argi], "--duration") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0)) {
+                fprintf(stderr, "duration invalid\n");
+                return 1;
+            }
+            duration_ns = (uint64_t)value * 1000000000ULL;
+        } else if (strcmp(argv[argi], "--object") == 0) {
+            if ((argi + 2 >= argc) ||
+                !bactext_object_type_strtol(argv[argi + 1], &object_type) ||
+                (object_type >= MAX_BACNET_OBJECT_TYPE) ||
+                !bacnet_strtoul(argv[argi + 2], &value) ||
+                (value > BACNET_MAX_INSTANCE)) {
+                fprintf(stderr, "object invalid\n");
+                return 1;
+            }
+            Target_Object_Type = (BACNET_OBJECT_TYPE)object_type;
+            Target_Object_Instance = (uint32_t)value;
+            argi += 2;
+        } else if (strcmp(argv[argi], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[argi], "--mac") == 0) {
+            if (++argi < argc) {
+                if (bacnet_address_mac_from_ascii(&mac, argv[argi])) {
+                    specific_address = true;
+                }
+            }
+        } else if (strcmp(argv[argi], "--dnet") == 0) {
+            if (++argi < argc) {
+                if (!bacnet_strtol(argv[argi], &dnet)) {
+                    fprintf(stderr, "dnet=%s invalid\n", argv[argi]);
+                    return 1;
+                }
+                if ((dnet >= 0) && (dnet <= UINT16_MAX)) {
+                    specific_address = true;
+                }
+            }
+        } else if (strcmp(argv[argi], "--dadr") == 0) {
+            if (++argi < argc) {
+                if (bacnet_address_mac_from_ascii(&adr, argv[argi])) {
+                    specific_address = true;
+                }
+            }
+        } else {
+            if (target_args == 0) {
+                Target_Device_Object_Instance = strtol(argv[argi], NULL, 0);
+                if (Target_Device_Object_Instance > BACNET_MAX_INSTANCE) {
+                    fprintf(
+                        stderr, "device-instance=%u - not greater than %u\n",
+                        Target_Device_Object_Instance, BACNET_MAX_INSTANCE);
+                    return 1;
+                }
+                target_args++;
+            } else {
+                print_usage(filename);
+                return 1;
+            }
+        }
+    }
+    if (target_args == 0) {
+        print_usage(filename);
+        return 1;
+    }
+    /* setup my info */
+    Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
+    address_init();
+    if (specific_address) {
+        target_address_add(dnet, &mac, &adr);
+    }
+    Init_Service_Handlers();
+    dlenv_init();
+    atexit(datalink_cleanup);
+    atexit(cleanup);
+    /* try to bind with the device */
+    found = address_bind_request(
+        Target_Device_Object_Instance, &max_apdu, &Target_Address);
+    if (!found) {
+        Send_WhoIs(
+            Target_Device_Object_Instance, Target_Device_Object_Instance);
+    }
+    mstimer_set(&bind_timer, apdu_timeout() * apdu_retries());
+    mstimer_set(&tsm_timer, 50);
+    mstimer_set(&maintenance_timer, 1000);
+    for (;;) {
+        if (!found) {
+            found = address_bind_request(
+                Target_Device_Object_Instance, &max_apdu, &Target_Address);
+            if (!found && mstimer_expired(&bind_timer)) {
+                fprintf(stderr, "Error: APDU Timeout!\n");
+                return 1;
+            }
+        }
+        if (found && (start_ns == 0)) {
+            start_ns = load_nanoseconds();
+        }
+        if (found && sending) {
+            if (duration_ns) {
+                sending = (load_nanoseconds() - start_ns) < duration_ns;
+            } else {
+                sending = sent_count < request_count;
+            }
+        }
+        /* keep the window full */
+        while (found && sending && (Load_Active < window)) {
+            service = load_service_next();
+            invoke_id = load_request_send(service);
+            if (invoke_id == 0) {
+                break;
+            }
+            Load_Request[invoke_id].active = true;
+            Load_Request[invoke_id].service = service;
+            Load_Request[invoke_id].sent_ns = load_nanoseconds();
+            Load_Active++;
+            Load_Statistics[service].sent++;
+            sent_count++;
+            if (!duration_ns && (sent_count >= request_count)) {
+                sending = false;
+            }
+        }
+        if (found && !sending && (Load_Active == 0)) {
+            break;
+        }
+        /* returns 0 bytes on timeout */
+        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, 1);
+        if (pdu_len) {
+            npdu_handler(&src, &Rx_Buf[0], pdu_len);
+        }
+        if (mstimer_expired(&tsm_timer)) {
+            mstimer_reset(&tsm_timer);
+            tsm_timer_milliseconds(mstimer_interval(&tsm_timer));
+            /* requests without a reply after their retries */
+            for (i = 1; i < 256; i++) {
+                invoke_id = (uint8_t)i;
+                if (Load_Request[invoke_id].active &&
+                    tsm_invoke_id_failed(invoke_id)) {
+                    load_complete(NULL, invoke_id, LOAD_OUTCOME_TIMEOUT);
+                    tsm_free_invoke_id(invoke_id);
+                }
+            }
+        }
+        if (mstimer_expired(&maintenance_timer)) {
+            mstimer_reset(&maintenance_timer);
+            datalink_maintenance_timer(1);
+        }
+    }
+    stop_ns = load_nanoseconds();
+    load_report(stop_ns - start_ns, json);
+
+    return 0;
+}
@@ -49,20 +49,52 @@
 #endif
 
 #define MSTP_HEADER_MAX (2 + 1 + 1 + 1 + 2 + 1)
+/* pcap packet header: seconds, microseconds, and two lengths */
+#define PCAP_PACKET_HEADER_LEN (4 + 4 + 4 + 4)
+/* pcapng enhanced packet block, without the packet data */
+#define PCAPNG_EPB_HEADER_LEN (4 + 4 + 4 + 4 + 4 + 4 + 4)
+#define PCAPNG_EPB_TRAILER_LEN (4)
+/* largest record written for one frame, with room for padding */
+#define MSTPCAP_RECORD_MAX                                       \
+    (PCAPNG_EPB_HEADER_LEN + MSTP_HEADER_MAX + DLMSTP_MPDU_MAX + \
+     2 + 3 + PCAPNG_EPB_TRAILER_LEN)
 
-/* local port data - shared with RS-485 */
-static struct mstp_port_struct_t MSTP_Port;
-/* track the receive state to know when there is a broken packet */
-static MSTP_RECEIVE_STATE MSTP_Receive_State = MSTP_RECEIVE_STATE_IDLE;
-/* buffers needed by mstp port struct */
-static uint8_t RxBuffer[DLMSTP_MPDU_MAX];
-static uint8_t TxBuffer[DLMSTP_MPDU_MAX];
+/* serial ports that the Linux RS-485 driver can open at once */
+#if defined(__linux__)
+#define MSTPCAP_MULTIPORT 1
+#endif
+#ifndef MSTPCAP_PORT_MAX
+#define MSTPCAP_PORT_MAX 8
+#endif
+/* buffer of the capture file, written to the disk in large blocks */
+#ifndef MSTPCAP_FILE_BUFFER_SIZE
+#define MSTPCAP_FILE_BUFFER_SIZE (256UL * 1024UL)
+#endif
+
+/* a captured RS-485 port - its index is the pcapng interface ID */
+struct mstpcap_port {
+    /* local port data - shared with RS-485 */
+    struct mstp_port_struct_t mstp_port;
+    /* track the receive state to know when there is a broken packet */
+    MSTP_RECEIVE_STATE receive_state;
+    /* placed to track silence on the wire */
+    struct mstimer silence_timer;
+    /* buffers needed by mstp port struct */
+    uint8_t rx_buffer[DLMSTP_MPDU_MAX];
+    uint8_t tx_buffer[DLMSTP_MPDU_MAX];
+    /* serial interface name */
+    char *name;
+};
+static struct mstpcap_port Capture_Port[MSTPCAP_PORT_MAX];
+static unsigned Capture_Port_Count = 1;
 /* method to tell main loop to exit from CTRL-C or other signals */
 static volatile bool Exit_Requested;
 /* flag to indicate Wireshark is running the show - no stdout or stderr */
 static bool Wireshark_Capture;
-/* placed to track silence on the wire */
-static struct mstimer Silence_Timer;
+/* flag to write pcapng instead of pcap */
+static bool Capture_Pcapng;
+/* number of packets in each capture file */
+static uint32_t File_Packet_Limit = 65535;
 
 /* statistics derived from monitoring the network for each node */
 struct mstp_statistics {
@@ -395,14 +427,17 @@ static void packet_statistics_clear(void)
 
 static uint32_t Timer_Silence(void *pArg)
 {
-    (void)pArg;
-    return mstimer_elapsed(&Silence_Timer);
+    /* the MS/TP port is the first member of the capture port */
+    struct mstpcap_port *port = (struct mstpcap_port *)pArg;
+
+    return mstimer_elapsed(&port->silence_timer);
 }
 
 static void Timer_Silence_Reset(void *pArg)
 {
-    (void)pArg;
-    mstimer_set(&Silence_Timer, 0);
+    struct mstpcap_port *port = (struct mstpcap_port *)pArg;
+
+    mstimer_set(&port->silence_timer, 0);
 }
 
 /* functions used by the MS/TP state machine to put or get data */
@@ -447,6 +482,10 @@ uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
 
 static char Capture_Filename[64] = "mstp_20090123091200.cap";
 static FILE *File_Handle = NULL; /* stream pointer */
+/* names of the ring files, oldest first once the ring is full */
+static char (*Ring_Filename)[64];
+static unsigned Ring_File_Count;
+static unsigned File_Sequence;
 #if defined(_WIN32)
 static HANDLE Pipe_Handle = INVALID_HANDLE_VALUE; /* pipe handle */
 static void named_pipe_create(const char *pipe_name)
@@ -562,12 +601,18 @@ static size_t data_write_header(const void *ptr, size_t size, size_t nitems)
 }
 #endif
 
+/**
+ * @brief Close the capture file, and open the next one.  In a ring of
+ *  files, the oldest file of a full ring is removed first, so that the
+ *  capture never uses more than the given number of files.
+ */
 static void filename_create_new(void)
 {
     BACNET_DATE bdate;
     BACNET_TIME btime;
     char *filename = &Capture_Filename[0];
     size_t filename_size = sizeof(Capture_Filename);
+    const char *extension = Capture_Pcapng ? "pcapng" : "cap";
 
     if (Wireshark_Capture) {
         return;
@@ -577,12 +622,29 @@ static void filename_create_new(void)
     }
     File_Handle = NULL;
     datetime_local(&bdate, &btime, NULL, NULL);
-    snprintf(
-        filename, filename_size, "mstp_%04d%02d%02d%02d%02d%02d.cap",
-        (int)bdate.year, (int)bdate.month, (int)bdate.day, (int)btime.hour,
-        (int)btime.min, (int)btime.sec);
+    if (Ring_Filename) {
+        filename = Ring_Filename[File_Sequence % Ring_File_Count];
+        filename_size = sizeof(Ring_Filename[0]);
+        if (filename[0]) {
+            (void)remove(filename);
+        }
+        snprintf(
+            filename, filename_size,
+            "mstp_%05u_%04d%02d%02d%02d%02d%02d.%s",
+            File_Sequence % 100000U, (int)bdate.year, (int)bdate.month,
+            (int)bdate.day, (int)btime.hour, (int)btime.min, (int)btime.sec,
+            extension);
+    } else {
+        snprintf(
+            filename, filename_size, "mstp_%04d%02d%02d%02d%02d%02d.%s",
+            (int)bdate.year, (int)bdate.month, (int)bdate.day,
+            (int)btime.hour, (int)btime.min, (int)btime.sec, extension);
+    }
+    File_Sequence++;
     File_Handle = fopen(filename, "wb");
     if (File_Handle) {
+        /* the packets are written to the disk in large blocks */
+        (void)setvbuf(File_Handle, NULL, _IOFBF, MSTPCAP_FILE_BUFFER_SIZE);
         fprintf(stdout, "mstpcap: saving capture to %s\n", filename);
     } else {
         fprintf(
@@ -591,7 +653,69 @@ static void filename_create_new(void)
     }
 }
 
-/* write packet to file in libpcap format */
+/**
+ * @brief Store a value in host byte order, as pcap and pcapng files
+ *  are read in the byte order of the writer
+ * @param buffer - where to store the value
+ * @param value - the value
+ * @return number of bytes stored
+ */
+static size_t record_encode_u32(uint8_t *buffer, uint32_t value)
+{
+    memcpy(buffer, &value, sizeof(value));
+
+    return sizeof(value);
+}
+
+static size_t record_encode_u16(uint8_t *buffer, uint16_t value)
+{
+    memcpy(buffer, &value, sizeof(value));
+
+    return sizeof(value);
+}
+
+/**
+ * @brief Encode a pcapng Interface Description Block for a captured port
+ * @param buffer - where to encode the block, at least 28 bytes more than
+ *  the interface name
+ * @param name - interface name, or NULL
+ * @return number of bytes encoded
+ */
+static size_t pcapng_idb_encode(uint8_t *buffer, const char *name)
+{
+    size_t len = 0;
+    size_t name_len = 0;
+    size_t option_len = 0;
+
+    if (name) {
+        name_len = strlen(name);
+        if (name_len > 255) {
+            name_len = 255;
+        }
+        /* if_name option, padded to 32 bits, and opt_endofopt */
+        option_len = 4 + ((name_len + 3) & ~3U) + 4;
+    }
+    len += record_encode_u32(&buffer[len], 0x00000001);
+    len += record_encode_u32(&buffer[len], 20 + option_len);
+    len += record_encode_u16(&buffer[len], DLT_BACNET_MS_TP);
+    len += record_encode_u16(&buffer[len], 0);
+    /* max length of captured packets, in octets */
+    len += record_encode_u32(&buffer[len], 65535);
+    if (name) {
+        len += record_encode_u16(&buffer[len], 2);
+        len += record_encode_u16(&buffer[len], name_len);
+        memset(&buffer[len], 0, (name_len + 3) & ~3U);
+        memcpy(&buffer[len], name, name_len);
+        len += (name_len + 3) & ~3U;
+        len += record_encode_u32(&buffer[len], 0);
+    }
+    len += record_encode_u32(&buffer[len], 20 + option_len);
+
+    return len;
+}
+
+/* write the file header in libpcap format, or the pcapng section header
+   and one interface description for each captured port */
 static void write_global_header(void)
 {
     uint32_t magic_number = 0xa1b2c3d4; /* magic number */
@@ -601,38 +725,66 @@ static void write_global_header(void)
     uint32_t sigfigs = 0; /* accuracy of timestamps */
     uint32_t snaplen = 65535; /* max length of captured packets, in octets */
     uint32_t network = DLT_BACNET_MS_TP; /* data link type - BACNET_MS_TP */
+    uint8_t block[28 + 256];
+    size_t len;
+    unsigned i;
 
-    /* create a new file. */
-    (void)data_write_header(&magic_number, sizeof(magic_number), 1);
-    (void)data_write_header(&version_major, sizeof(version_major), 1);
-    (void)data_write_header(&version_minor, sizeof(version_minor), 1);
-    (void)data_write_header(&thiszone, sizeof(thiszone), 1);
-    (void)data_write_header(&sigfigs, sizeof(sigfigs), 1);
-    (void)data_write_header(&snaplen, sizeof(snaplen), 1);
-    (void)data_write_header(&network, sizeof(network), 1);
-    fflush(File_Handle);
+    if (Capture_Pcapng) {
+        /* section header block with an unspecified section length */
+        len = record_encode_u32(&block[0], 0x0A0D0D0A);
+        len += record_encode_u32(&block[len], 28);
+        len += record_encode_u32(&block[len], 0x1A2B3C4D);
+        len += record_encode_u16(&block[len], 1);
+        len += record_encode_u16(&block[len], 0);
+        len += record_encode_u32(&block[len], 0xFFFFFFFF);
+        len += record_encode_u32(&block[len], 0xFFFFFFFF);
+        len += record_encode_u32(&block[len], 28);
+        (void)data_write_header(block, len, 1);
+        for (i = 0; i < Capture_Port_Count; i++) {
+            len = pcapng_idb_encode(block, Capture_Port[i].name);
+            (void)data_write_header(block, len, 1);
+        }
+    } else {
+        /* create a new file. */
+        (void)data_write_header(&magic_number, sizeof(magic_number), 1);
+        (void)data_write_header(&version_major, sizeof(version_major), 1);
+        (void)data_write_header(&version_minor, sizeof(version_minor), 1);
+        (void)data_write_header(&thiszone, sizeof(thiszone), 1);
+        (void)data_write_header(&sigfigs, sizeof(sigfigs), 1);
+        (void)data_write_header(&snaplen, sizeof(snaplen), 1);
+        (void)data_write_header(&network, sizeof(network), 1);
+    }
+    if (File_Handle) {
+        fflush(File_Handle);
+    }
 }
 
+/**
+ * @brief Write a received frame as one pcap packet record, or as one
+ *  pcapng enhanced packet block with the interface ID of its port.
+ *  The record is assembled in memory so it takes a single write.
+ * @param port - the port that received the frame
+ * @param header_len - number of header bytes received
+ */
 static void
-write_received_packet(struct mstp_port_struct_t *mstp_port, size_t header_len)
+write_received_packet(struct mstpcap_port *port, size_t header_len)
 {
-    uint32_t ts_sec = 0; /* timestamp seconds */
-    uint32_t ts_usec = 0; /* timestamp microseconds */
+    struct mstp_port_struct_t *mstp_port = &port->mstp_port;
+    uint8_t record[MSTPCAP_RECORD_MAX];
     uint32_t incl_len = 0; /* number of octets of packet saved in file */
-    uint32_t orig_len = 0; /* actual length of packet */
     uint32_t data_crc_len = 2;
-    uint8_t header[MSTP_HEADER_MAX] = { 0 }; /* MS/TP header */
+    uint8_t *header; /* MS/TP header */
     struct timeval tv;
+    uint64_t timestamp;
     size_t max_data = 0;
+    size_t offset;
+    size_t len;
+    size_t pad_len = 0;
 
     gettimeofday(&tv, NULL);
-    ts_sec = tv.tv_sec;
-    ts_usec = tv.tv_usec;
-    if (mstp_port->ReceivedValidFrame) {
+    if (mstp_port->ReceivedValidFrame && (port == &Capture_Port[0])) {
         packet_statistics(&tv, mstp_port);
     }
-    (void)data_write(&ts_sec, sizeof(ts_sec), 1);
-    (void)data_write(&ts_usec, sizeof(ts_usec), 1);
     if (mstp_port->ReceivedInvalidFrame) {
         if (mstp_port->Index) {
             max_data = min(mstp_port->InputBufferSize, mstp_port->Index);
@@ -642,28 +794,33 @@ write_received_packet(struct mstp_port_struct_t *mstp_port, size_t header_len)
                     so only 1 for checksum */
                 data_crc_len = 1;
             }
-            incl_len = orig_len = header_len + max_data + data_crc_len;
+            incl_len = header_len + max_data + data_crc_len;
         } else {
             /* header only */
-            incl_len = orig_len = header_len;
+            incl_len = header_len;
         }
     } else {
         if (mstp_port->DataLength) {
             max_data = min(mstp_port->InputBufferSize, mstp_port->DataLength);
-            incl_len = orig_len = header_len + max_data + data_crc_len;
+            incl_len = header_len + max_data + data_crc_len;
         } else {
             /* header only - or at least some bytes of the header */
-            incl_len = orig_len = header_len;
+            incl_len = header_len;
         }
     }
-    (void)data_write(&incl_len, sizeof(incl_len), 1);
-    (void)data_write(&orig_len, sizeof(orig_len), 1);
+    if (Capture_Pcapng) {
+        offset = PCAPNG_EPB_HEADER_LEN;
+    } else {
+        offset = PCAP_PACKET_HEADER_LEN;
+    }
+    header = &record[offset];
     if (header_len == 1) {
         header[0] = mstp_port->DataRegister;
     } else if (header_len == 2) {
         header[0] = 0x55;
         header[1] = mstp_port->DataRegister;
     } else {
+        memset(header, 0, header_len);
         header[0] = 0x55;
         header[1] = 0xFF;
         header[2] = mstp_port->FrameType;
@@ -673,12 +830,37 @@ write_received_packet(struct mstp_port_struct_t *mstp_port, size_t header_len)
         header[6] = LO_BYTE(mstp_port->DataLength);
         header[7] = mstp_port->HeaderCRCActual;
     }
-    (void)data_write(header, header_len, 1);
+    len = offset + header_len;
     if (max_data) {
-        (void)data_write(mstp_port->InputBuffer, max_data, 1);
-        (void)data_write((char *)&mstp_port->DataCRCActualMSB, 1, 1);
-        (void)data_write((char *)&mstp_port->DataCRCActualLSB, 1, 1);
+        memcpy(&record[len], mstp_port->InputBuffer, max_data);
+        len += max_data;
+        record[len++] = mstp_port->DataCRCActualMSB;
+        if (data_crc_len > 1) {
+            record[len++] = mstp_port->DataCRCActualLSB;
+        }
     }
+    if (Capture_Pcapng) {
+        /* packet data is padded to 32 bits */
+        pad_len = (4 - (incl_len & 3U)) & 3U;
+        memset(&record[len], 0, pad_len);
+        len += pad_len + PCAPNG_EPB_TRAILER_LEN;
+        timestamp = ((uint64_t)tv.tv_sec * 1000000ULL) + tv.tv_usec;
+        offset = record_encode_u32(&record[0], 0x00000006);
+        offset += record_encode_u32(&record[offset], len);
+        offset += record_encode_u32(
+            &record[offset], (uint32_t)(port - &Capture_Port[0]));
+        offset += record_encode_u32(&record[offset], timestamp >> 32);
+        offset += record_encode_u32(&record[offset], timestamp & 0xFFFFFFFF);
+        offset += record_encode_u32(&record[offset], incl_len);
+        offset += record_encode_u32(&record[offset], incl_len);
+        (void)record_encode_u32(&record[len - PCAPNG_EPB_TRAILER_LEN], len);
+    } else {
+        offset = record_encode_u32(&record[0], tv.tv_sec);
+        offset += record_encode_u32(&record[offset], tv.tv_usec);
+        offset += record_encode_u32(&record[offset], incl_len);
+        offset += record_encode_u32(&record[offset], incl_len);
+    }
+    (void)data_write(record, len, 1);
 }
 
 /* read header from file in libpcap format */
@@ -884,6 +1066,15 @@ static void cleanup(void)
         fclose(File_Handle); /* stream pointer */
     }
     File_Handle = NULL;
+#if defined(MSTPCAP_MULTIPORT)
+    {
+        unsigned i;
+
+        for (i = 1; i < Capture_Port_Count; i++) {
+            RS485_Port_Close(&Capture_Port[i].mstp_port);
+        }
+    }
+#endif
 }
 
 #if defined(_WIN32)
@@ -930,6 +1121,10 @@ static void print_usage(const char *filename)
     printf(" [--extcap-interface port]\n");
     printf(" [--extcap-interfaces][--extcap-dlts][--extcap-config]\n");
     printf(" [--capture][--baud baud][--fifo pipe]\n");
+    printf(" [--pcapng][--ring files][--file-packets count]\n");
+#if defined(MSTPCAP_MULTIPORT)
+    printf(" [--port port]\n");
+#endif
     printf(" [--version][--help]\n");
 }
 
@@ -962,6 +1157,19 @@ static void print_help(const char *filename)
            "    Supported values: any file name\n"
 #endif
            "    Use that name as the interface name in Wireshark.\n");
+    printf("[--pcapng] - write pcapng files instead of pcap files.\n"
+           "[--ring files] - keep only the newest number of files,\n"
+           "    removing the oldest file when a new file is created.\n"
+           "[--file-packets count] - packets in each file.\n"
+           "    Defaults to 65535.\n");
+#if defined(MSTPCAP_MULTIPORT)
+    printf(
+        "[--port port] - capture another serial interface at the same\n"
+        "    baud rate, up to %u interfaces.  The packets of each\n"
+        "    interface have their own interface ID in a pcapng file.\n"
+        "    Statistics are kept for the first interface.\n",
+        (unsigned)MSTPCAP_PORT_MAX);
+#endif
     printf("\n");
     printf(
         "%s [--extcap-interfaces][--extcap-dlts][--extcap-config]\n"
@@ -988,32 +1196,151 @@ static void mstp_structure_init(struct mstp_port_struct_t *mstp_port)
         mstp_port->ReceivedValidFrame = false;
         mstp_port->ReceivedValidFrameNotForUs = false;
         mstp_port->receive_state = MSTP_RECEIVE_STATE_IDLE;
-        mstp_port->SilenceTimerReset(NULL);
+        mstp_port->SilenceTimerReset((void *)mstp_port);
     }
 }
 
+/**
+ * @brief Initialize the MS/TP receive data of a capture port
+ * @param port - the capture port
+ */
+static void capture_port_init(struct mstpcap_port *port)
+{
+    struct mstp_port_struct_t *mstp_port = &port->mstp_port;
+
+    mstp_port->InputBuffer = &port->rx_buffer[0];
+    mstp_port->InputBufferSize = sizeof(port->rx_buffer);
+    mstp_port->OutputBuffer = &port->tx_buffer[0];
+    mstp_port->OutputBufferSize = sizeof(port->tx_buffer);
+    mstp_port->This_Station = MSTP_BROADCAST_ADDRESS;
+    mstp_port->Nmax_info_frames = 1;
+    mstp_port->Nmax_master = 127;
+    mstp_port->SilenceTimer = Timer_Silence;
+    mstp_port->SilenceTimerReset = Timer_Silence_Reset;
+    port->receive_state = MSTP_RECEIVE_STATE_IDLE;
+    MSTP_Init(mstp_port);
+}
+
+/**
+ * @brief Move the received bytes of the capture ports into their
+ *  state machines.  With several ports, one select() waits on all of
+ *  them, so a quiet port never delays the bytes of a busy one.
+ */
+static void capture_ports_receive(void)
+{
+#if defined(MSTPCAP_MULTIPORT)
+    struct mstp_port_struct_t *mstp_port;
+    struct timeval waiter;
+    fd_set input;
+    int max_handle = -1;
+    int handle;
+    unsigned i;
+
+    if (Capture_Port_Count > 1) {
+        waiter.tv_sec = 0;
+        waiter.tv_usec = 5000;
+        FD_ZERO(&input);
+        for (i = 0; i < Capture_Port_Count; i++) {
+            mstp_port = &Capture_Port[i].mstp_port;
+            if (RS485_Receive_Pending(mstp_port)) {
+                /* bytes are waiting already, so only poll the others */
+                waiter.tv_usec = 0;
+            }
+            handle = RS485_Port_Handle(mstp_port);
+            FD_SET(handle, &input);
+            max_handle = max(max_handle, handle);
+        }
+        if (select(max_handle + 1, &input, NULL, NULL, &waiter) < 0) {
+            FD_ZERO(&input);
+        }
+        for (i = 0; i < Capture_Port_Count; i++) {
+            mstp_port = &Capture_Port[i].mstp_port;
+            if (RS485_Receive_Pending(mstp_port) ||
+                FD_ISSET(RS485_Port_Handle(mstp_port), &input)) {
+                RS485_Check_UART_Data(mstp_port);
+            }
+        }
+        return;
+    }
+#endif
+    RS485_Check_UART_Data(&Capture_Port[0].mstp_port);
+}
+
+/**
+ * @brief Packetize the received bytes of a capture port, and write the
+ *  complete, broken, or invalid frames to the capture
+ * @param port - the capture port
+ * @return number of packets written
+ */
+static uint32_t capture_port_task(struct mstpcap_port *port)
+{
+    struct mstp_port_struct_t *mstp_port = &port->mstp_port;
+    uint32_t packet_count = 0;
+    uint32_t header_len = 0;
+
+    MSTP_Receive_Frame_FSM(mstp_port);
+    /* process the data portion of the frame */
+    if (mstp_port->ReceivedValidFrame ||
+        mstp_port->ReceivedValidFrameNotForUs) {
+        write_received_packet(port, MSTP_HEADER_MAX);
+        mstp_structure_init(mstp_port);
+        packet_count++;
+    } else if (mstp_port->ReceivedInvalidFrame) {
+        if (port->receive_state == MSTP_RECEIVE_STATE_HEADER) {
+            mstp_port->Index = 0;
+        }
+        write_received_packet(port, MSTP_HEADER_MAX);
+        mstp_structure_init(mstp_port);
+        Invalid_Frame_Count++;
+        packet_count++;
+    } else if (mstp_port->receive_state == MSTP_RECEIVE_STATE_IDLE) {
+        if (port->receive_state == MSTP_RECEIVE_STATE_IDLE) {
+            if ((mstp_port->EventCount == 1) &&
+                (mstp_port->DataRegister == 0xFF)) {
+                /* 0xFF padding at end of message is allowed */
+                mstp_structure_init(mstp_port);
+            } else if (mstp_port->EventCount > 1) {
+                write_received_packet(port, 1);
+                mstp_structure_init(mstp_port);
+                Invalid_Frame_Count++;
+            }
+        } else {
+            /* invalid byte or timeout */
+            if (port->receive_state == MSTP_RECEIVE_STATE_PREAMBLE) {
+                if (mstp_port->EventCount) {
+                    header_len = 1;
+                } else {
+                    header_len = 2;
+                }
+            } else {
+                header_len = 3 + mstp_port->Index;
+            }
+            write_received_packet(port, header_len);
+            mstp_structure_init(mstp_port);
+            Invalid_Frame_Count++;
+        }
+    }
+    /* track the packetizer state */
+    port->receive_state = mstp_port->receive_state;
+
+    return packet_count;
+}
+
 /* simple test to packetize the data and print it */
 int main(int argc, char *argv[])
 {
     struct mstp_port_struct_t *mstp_port;
+    struct mstimer status_timer;
     long my_baud = 38400;
     uint32_t packet_count = 0;
-    uint32_t header_len = 0;
+    unsigned long value = 0;
     int argi = 0;
+    unsigned i = 0;
     const char *filename = NULL;
 
-    MSTP_Port.InputBuffer = &RxBuffer[0];
-    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
-    MSTP_Port.OutputBuffer = &TxBuffer[0];
-    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
-    MSTP_Port.This_Station = MSTP_BROADCAST_ADDRESS;
-    MSTP_Port.Nmax_info_frames = 1;
-    MSTP_Port.Nmax_master = 127;
-    MSTP_Port.SilenceTimer = Timer_Silence;
-    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    capture_port_init(&Capture_Port[0]);
     /* mimic our pointer in the state machine */
-    mstp_port = &MSTP_Port;
-    MSTP_Init(mstp_port);
+    mstp_port = &Capture_Port[0].mstp_port;
     packet_statistics_clear();
     /* decode any command line parameters */
     filename = filename_remove_path(argv[0]);
@@ -1137,6 +1464,55 @@ int main(int argc, char *argv[])
             }
             named_pipe_create(argv[argi]);
         }
+        if (strcmp(argv[argi], "--pcapng") == 0) {
+            Capture_Pcapng = true;
+        }
+        if (strcmp(argv[argi], "--ring") == 0) {
+            argi++;
+            if (argi >= argc) {
+                printf("A number of files must be provided.\n");
+                return 1;
+            }
+            value = strtoul(argv[argi], NULL, 0);
+            if (value > 0) {
+                free(Ring_Filename);
+                Ring_Filename = calloc(value, sizeof(Ring_Filename[0]));
+                if (!Ring_Filename) {
+                    printf("Unable to keep %lu files.\n", value);
+                    return 1;
+                }
+                Ring_File_Count = value;
+            }
+        }
+        if (strcmp(argv[argi], "--file-packets") == 0) {
+            argi++;
+            if (argi >= argc) {
+                printf("A number of packets must be provided.\n");
+                return 1;
+            }
+            value = strtoul(argv[argi], NULL, 0);
+            if ((value > 0) && (value <= UINT32_MAX)) {
+                File_Packet_Limit = value;
+            }
+        }
+#if defined(MSTPCAP_MULTIPORT)
+        if (strcmp(argv[argi], "--port") == 0) {
+            argi++;
+            if (argi >= argc) {
+                printf("An interface must be provided.\n");
+                return 1;
+            }
+            if (Capture_Port_Count >= MSTPCAP_PORT_MAX) {
+                printf("Only %u interfaces can be captured.\n",
+                    (unsigned)MSTPCAP_PORT_MAX);
+                return 1;
+            }
+            Capture_Port[Capture_Port_Count].name = argv[argi];
+            Capture_Port_Count++;
+            /* only pcapng has an interface ID for each packet */
+            Capture_Pcapng = true;
+        }
+#endif
     }
     if (Exit_Requested) {
         return 0;
@@ -1148,10 +1524,24 @@ int main(int argc, char *argv[])
     atexit(cleanup);
     RS485_Initialize();
     mstimer_init();
+    Capture_Port[0].name = (char *)RS485_Interface();
+#if defined(MSTPCAP_MULTIPORT)
+    for (i = 1; i < Capture_Port_Count; i++) {
+        capture_port_init(&Capture_Port[i]);
+        if (!RS485_Port_Open(
+                &Capture_Port[i].mstp_port, Capture_Port[i].name,
+                RS485_Get_Baud_Rate())) {
+            Capture_Port_Count = i;
+            return 1;
+        }
+    }
+#endif
     if (!Wireshark_Capture) {
-        fprintf(
-            stdout, "mstpcap: Using %s for capture at %ld bps.\n",
-            RS485_Interface(), (long)RS485_Get_Baud_Rate());
+        for (i = 0; i < Capture_Port_Count; i++) {
+            fprintf(
+                stdout, "mstpcap: Using %s for capture at %ld bps.\n",
+                Capture_Port[i].name, (long)RS485_Get_Baud_Rate());
+        }
     }
 #if defined(_WIN32)
     SetConsoleMode(GetStdHandle(STD_INPUT_HANDLE), ENABLE_PROCESSED_INPUT);
@@ -1161,59 +1551,22 @@ int main(int argc, char *argv[])
 #endif
     filename_create_new();
     write_global_header();
+    mstimer_set(&status_timer, 1000);
     /* run forever */
     for (;;) {
-        RS485_Check_UART_Data(mstp_port);
-        MSTP_Receive_Frame_FSM(mstp_port);
-        /* process the data portion of the frame */
-        if (mstp_port->ReceivedValidFrame ||
-            mstp_port->ReceivedValidFrameNotForUs) {
-            write_received_packet(mstp_port, MSTP_HEADER_MAX);
-            mstp_structure_init(mstp_port);
-            packet_count++;
-        } else if (mstp_port->ReceivedInvalidFrame) {
-            if (MSTP_Receive_State == MSTP_RECEIVE_STATE_HEADER) {
-                mstp_port->Index = 0;
-            }
-            write_received_packet(mstp_port, MSTP_HEADER_MAX);
-            mstp_structure_init(mstp_port);
-            Invalid_Frame_Count++;
-            packet_count++;
-        } else if (mstp_port->receive_state == MSTP_RECEIVE_STATE_IDLE) {
-            if (MSTP_Receive_State == MSTP_RECEIVE_STATE_IDLE) {
-                if ((mstp_port->EventCount == 1) &&
-                    (mstp_port->DataRegister == 0xFF)) {
-                    /* 0xFF padding at end of message is allowed */
-                    mstp_structure_init(mstp_port);
-                } else if (mstp_port->EventCount > 1) {
-                    write_received_packet(mstp_port, 1);
-                    mstp_structure_init(mstp_port);
-                    Invalid_Frame_Count++;
-                }
-            } else {
-                /* invalid byte or timeout */
-                if (MSTP_Receive_State == MSTP_RECEIVE_STATE_PREAMBLE) {
-                    if (mstp_port->EventCount) {
-                        header_len = 1;
-                    } else {
-                        header_len = 2;
-                    }
-                } else {
-                    header_len = 3 + mstp_port->Index;
-                }
-                write_received_packet(mstp_port, header_len);
-                mstp_structure_init(mstp_port);
-                Invalid_Frame_Count++;
-            }
+        capture_ports_receive();
+        for (i = 0; i < Capture_Port_Count; i++) {
+            packet_count += capture_port_task(&Capture_Port[i]);
         }
         if (!Wireshark_Capture) {
-            if (!(packet_count % 100)) {
+            if (mstimer_expired(&status_timer)) {
+                mstimer_reset(&status_timer);
                 fprintf(
                     stdout, "\r%u packets, %u invalid frames",
                     (unsigned)packet_count, (unsigned)Invalid_Frame_Count);
                 fflush(stdout);
             }
-            if (packet_count >= 65535) {
+            if (packet_count >= File_Packet_Limit) {
                 packet_statistics_print();
                 packet_statistics_clear();
                 filename_create_new();
@@ -1224,8 +1577,6 @@ int main(int argc, char *argv[])
         if (Exit_Requested) {
             break;
         }
-        /* track the packetizer state */
-        MSTP_Receive_State = mstp_port->receive_state;
     }
     /* tell signal interrupts we are done */
     Exit_Requested = false;
@@ -353,6 +353,7 @@ int main(int argc, char *argv[])
             /* address cache */
             seconds = mstimer_interval(&BACnet_Address_Timer) / 1000;
             address_cache_timer(seconds);
+            npdu_route_cache_timer(seconds);
         }
         /* output/input */
         if (mstimer_expired(&BACnet_Object_Timer)) {
@@ -14,6 +14,7 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/bacstr.h"
 #include "bacnet/bactext.h"
 #include "bacnet/iam.h"
 #include "bacnet/arf.h"
@@ -45,9 +46,52 @@ static BACNET_ADDRESS Target_Address;
 static char *Local_File_Name = NULL;
 static int Target_File_Start_Position;
 static unsigned int Target_File_Requested_Octet_Count;
-static bool End_Of_File_Detected = false;
 static bool Error_Detected = false;
-static uint8_t Request_Invoke_ID = 0;
+/* the end of the file, once a read reaches it */
+static int End_Of_File_Position = -1;
+/* number of octets stored locally */
+static int Octets_Received;
+
+/* number of AtomicReadFile requests that may be outstanding at once */
+#ifndef READFILE_WINDOW_MAX
+#define READFILE_WINDOW_MAX 16
+#endif
+#if (READFILE_WINDOW_MAX > MAX_TSM_TRANSACTIONS)
+#undef READFILE_WINDOW_MAX
+#define READFILE_WINDOW_MAX MAX_TSM_TRANSACTIONS
+#endif
+struct read_request {
+    uint8_t invoke_id;
+    int start_position;
+    unsigned octet_count;
+    /* the reason the request failed, or empty */
+    char error[80];
+};
+static struct read_request Read_Request[READFILE_WINDOW_MAX];
+static unsigned Read_Window = 1;
+
+/**
+ * @brief Find the outstanding request of an invoke ID from the target
+ * @param src - address the reply came from
+ * @param invoke_id - invoke ID of the reply
+ * @return the request, or NULL if there is none
+ */
+static struct read_request *
+read_request_find(const BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    unsigned i;
+
+    if ((invoke_id == 0) || !address_match(&Target_Address, src)) {
+        return NULL;
+    }
+    for (i = 0; i < Read_Window; i++) {
+        if (Read_Request[i].invoke_id == invoke_id) {
+            return &Read_Request[i];
+        }
+    }
+
+    return NULL;
+}
 
 static void Atomic_Read_File_Error_Handler(
     BACNET_ADDRESS *src,
@@ -55,37 +99,38 @@ static void Atomic_Read_File_Error_Handler(
     BACNET_ERROR_CLASS error_class,
     BACNET_ERROR_CODE error_code)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        printf(
-            "BACnet Error: %s: %s\n",
+    struct read_request *request = read_request_find(src, invoke_id);
+
+    if (request) {
+        snprintf(
+            request->error, sizeof(request->error), "BACnet Error: %s: %s",
             bactext_error_class_name((int)error_class),
             bactext_error_code_name((int)error_code));
-        Error_Detected = true;
     }
 }
 
 static void MyAbortHandler(
     BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t abort_reason, bool server)
 {
+    struct read_request *request = read_request_find(src, invoke_id);
+
     (void)server;
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        printf(
-            "BACnet Abort: %s\n", bactext_abort_reason_name((int)abort_reason));
-        Error_Detected = true;
+    if (request) {
+        snprintf(
+            request->error, sizeof(request->error), "BACnet Abort: %s",
+            bactext_abort_reason_name((int)abort_reason));
     }
 }
 
 static void
 MyRejectHandler(BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        printf(
-            "BACnet Reject: %s\n",
+    struct read_request *request = read_request_find(src, invoke_id);
+
+    if (request) {
+        snprintf(
+            request->error, sizeof(request->error), "BACnet Reject: %s",
             bactext_reject_reason_name((int)reject_reason));
-        Error_Detected = true;
     }
 }
 
@@ -102,17 +147,17 @@ static void AtomicReadFileAckHandler(
     size_t octets_written = 0;
     size_t octet_count = 0;
     uint8_t *octet_buffer = NULL;
+    struct read_request *request;
 
-    if (address_match(&Target_Address, src) &&
-        (service_data->invoke_id == Request_Invoke_ID)) {
+    request = read_request_find(src, service_data->invoke_id);
+    if (request) {
         len =
             arf_ack_decode_service_request(service_request, service_len, &data);
         if ((len > 0) && (data.access == FILE_STREAM_ACCESS)) {
-            if (data.type.stream.fileStartPosition == 0) {
-                pFile = fopen(Local_File_Name, "wb");
-            } else {
-                pFile = fopen(Local_File_Name, "rb+");
-            }
+            /* the local file was created before the first request,
+               so the blocks are written where they belong whatever
+               order their replies arrive in */
+            pFile = fopen(Local_File_Name, "rb+");
             if (pFile) {
                 octet_count = octetstring_length(&data.fileData[0]);
                 if (octet_count == 0) {
@@ -136,11 +181,16 @@ static void AtomicReadFileAckHandler(
                                 "Unable to write data to file \"%s\".\n",
                                 Local_File_Name);
                         } else {
-                            Target_File_Start_Position =
-                                data.type.stream.fileStartPosition +
-                                octets_written;
-                            printf(
-                                "\r%d bytes", (int)Target_File_Start_Position);
+                            Octets_Received += (int)octets_written;
+                            printf("\r%d bytes", Octets_Received);
+                            if (octet_count < request->octet_count) {
+                                /* a short read: ask for the rest
+                                   of the block again */
+                                request->start_position += (int)octet_count;
+                                request->octet_count -= (unsigned)octet_count;
+                            } else {
+                                request->octet_count = 0;
+                            }
                         }
                         fflush(pFile);
                     } else {
@@ -152,8 +202,12 @@ static void AtomicReadFileAckHandler(
                 fclose(pFile);
             }
             if (data.endOfFile) {
-                End_Of_File_Detected = true;
-                printf("\n");
+                request->octet_count = 0;
+                len = data.type.stream.fileStartPosition + (int)octet_count;
+                if ((End_Of_File_Position < 0) ||
+                    (len < End_Of_File_Position)) {
+                    End_Of_File_Position = len;
+                }
             }
         } else {
             fprintf(stderr, "Decode error! %d bytes decoded.\n", len);
@@ -161,7 +215,7 @@ static void AtomicReadFileAckHandler(
     } else {
         fprintf(
             stderr, "Address & Invoke ID mismatch! Invoke ID=%d\n",
-            Request_Invoke_ID);
+            service_data->invoke_id);
     }
 }
 
@@ -214,7 +268,7 @@ static void Init_Service_Handlers(void)
 static void print_usage(const char *filename)
 {
     printf("Usage: %s device-instance file-instance local-name\n", filename);
-    printf("       [--version][--help]\n");
+    printf("       [--window N][--resume][--version][--help]\n");
 }
 
 static void print_help(const char *filename)
@@ -237,6 +291,16 @@ static void print_help(const char *filename)
     printf("local-name:\n"
            "The name of the file that will be stored locally.\n");
     printf("\n");
+    printf("--window N:\n"
+           "Number of AtomicReadFile requests that are outstanding at\n"
+           "once, each for the next block of the file, from 1 to %u.\n"
+           "Default is 1.\n",
+           (unsigned)READFILE_WINDOW_MAX);
+    printf("\n");
+    printf("--resume:\n"
+           "Keep the local file and continue reading from its end,\n"
+           "after an earlier read was interrupted.\n");
+    printf("\n");
     printf(
         "Example:\n"
         "If you want read File 2 from Device 123 and save it to temp.txt,\n"
@@ -245,6 +309,112 @@ static void print_help(const char *filename)
         filename);
 }
 
+/**
+ * @brief Send the requests of the window, and retire the completed ones
+ * @return true while the file is being read, false when it is done
+ */
+static bool read_requests_process(void)
+{
+    struct read_request *request;
+    bool busy = false;
+    unsigned i, j;
+
+    for (i = 0; i < Read_Window; i++) {
+        request = &Read_Request[i];
+        if (request->invoke_id != 0) {
+            /* has the invoke id expired or returned? */
+            if (tsm_invoke_id_failed(request->invoke_id)) {
+                fprintf(stderr, "\rError: TSM Timeout!\n");
+                tsm_free_invoke_id(request->invoke_id);
+                request->invoke_id = 0;
+                Error_Detected = true;
+                return false;
+            }
+            if (!tsm_invoke_id_free(request->invoke_id)) {
+                busy = true;
+                continue;
+            }
+            request->invoke_id = 0;
+        }
+        if ((End_Of_File_Position >= 0) &&
+            (request->start_position >= End_Of_File_Position)) {
+            /* a block past the end of the file is not needed */
+            request->octet_count = 0;
+            request->error[0] = 0;
+        }
+        if (request->error[0]) {
+            /* a block past the end of the file may fail before the
+               reply with the end of the file arrives */
+            for (j = 0; j < Read_Window; j++) {
+                if ((Read_Request[j].invoke_id != 0) &&
+                    (Read_Request[j].start_position <
+                     request->start_position)) {
+                    break;
+                }
+            }
+            if (j < Read_Window) {
+                busy = true;
+                continue;
+            }
+            printf("%s\n", request->error);
+            Error_Detected = true;
+            return false;
+        }
+        if (request->octet_count == 0) {
+            if (End_Of_File_Position >= 0) {
+                continue;
+            }
+            /* take the next block of the file */
+            request->start_position = Target_File_Start_Position;
+            request->octet_count = Target_File_Requested_Octet_Count;
+            Target_File_Start_Position += (int)request->octet_count;
+        }
+        /* we'll read the file in chunks
+           less than max_apdu to keep unsegmented */
+        request->invoke_id = Send_Atomic_Read_File_Stream(
+            Target_Device_Object_Instance, Target_File_Object_Instance,
+            request->start_position, request->octet_count);
+        busy = true;
+    }
+
+    return busy;
+}
+
+/**
+ * @brief Create the local file, or find its end to resume reading
+ * @param resume - true to keep the local file
+ * @return true if the local file is ready
+ */
+static bool local_file_init(bool resume)
+{
+    FILE *pFile = NULL;
+    long size = 0;
+
+    if (resume) {
+        pFile = fopen(Local_File_Name, "rb");
+        if (pFile) {
+            if (fseek(pFile, 0, SEEK_END) == 0) {
+                size = ftell(pFile);
+            }
+            fclose(pFile);
+            if (size > 0) {
+                Target_File_Start_Position = (int)size;
+                Octets_Received = (int)size;
+                return true;
+            }
+        }
+    }
+    pFile = fopen(Local_File_Name, "wb");
+    if (!pFile) {
+        fprintf(
+            stderr, "Unable to create file \"%s\".\n", Local_File_Name);
+        return false;
+    }
+    fclose(pFile);
+
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     BACNET_ADDRESS src = { 0 }; /* address where message came from */
@@ -255,10 +425,12 @@ int main(int argc, char *argv[])
     time_t last_seconds = 0;
     time_t current_seconds = 0;
     time_t timeout_seconds = 0;
-    uint8_t invoke_id = 0;
     bool found = false;
+    bool resume = false;
     uint16_t my_max_apdu = 0;
+    unsigned long value = 0;
     int argi = 0;
+    unsigned target_args = 0;
     const char *filename = NULL;
 
     /* print help if requested */
@@ -278,15 +450,31 @@ int main(int argc, char *argv[])
                    "FITNESS FOR A PARTICULAR PURPOSE.\n");
             return 0;
         }
+        if (strcmp(argv[argi], "--window") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0) || (value > READFILE_WINDOW_MAX)) {
+                fprintf(stderr, "window invalid\n");
+                return 1;
+            }
+            Read_Window = (unsigned)value;
+        } else if (strcmp(argv[argi], "--resume") == 0) {
+            resume = true;
+        } else {
+            /* decode the command line parameters */
+            if (target_args == 0) {
+                Target_Device_Object_Instance = strtol(argv[argi], NULL, 0);
+            } else if (target_args == 1) {
+                Target_File_Object_Instance = strtol(argv[argi], NULL, 0);
+            } else if (target_args == 2) {
+                Local_File_Name = argv[argi];
+            }
+            target_args++;
+        }
     }
-    if (argc < 4) {
+    if (target_args < 3) {
         print_usage(filename);
         return 0;
     }
-    /* decode the command line parameters */
-    Target_Device_Object_Instance = strtol(argv[1], NULL, 0);
-    Target_File_Object_Instance = strtol(argv[2], NULL, 0);
-    Local_File_Name = argv[3];
     if (Target_Device_Object_Instance > BACNET_MAX_INSTANCE) {
         fprintf(
             stderr, "device-instance=%u - not greater than %u\n",
@@ -299,6 +487,9 @@ int main(int argc, char *argv[])
             Target_File_Object_Instance, BACNET_MAX_INSTANCE);
         return 1;
     }
+    if (!local_file_init(resume)) {
+        return 1;
+    }
     /* setup my info */
     Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
     address_init();
@@ -357,25 +548,11 @@ int main(int argc, char *argv[])
             } else {
                 Target_File_Requested_Octet_Count = my_max_apdu / 2;
             }
-            /* has the previous invoke id expired or returned?
-               note: invoke ID = 0 is invalid, so it will be idle */
-            if ((invoke_id == 0) || tsm_invoke_id_free(invoke_id)) {
-                if (End_Of_File_Detected || Error_Detected) {
-                    break;
+            /* the ACK will store each block where it belongs */
+            if (!read_requests_process()) {
+                if (!Error_Detected) {
+                    printf("\n");
                 }
-                /* the ACK will increment the start position if OK */
-                /* we'll read the file in chunks
-                   less than max_apdu to keep unsegmented */
-                invoke_id = Send_Atomic_Read_File_Stream(
-                    Target_Device_Object_Instance, Target_File_Object_Instance,
-                    Target_File_Start_Position,
-                    Target_File_Requested_Octet_Count);
-                Request_Invoke_ID = invoke_id;
-            } else if (tsm_invoke_id_failed(invoke_id)) {
-                fprintf(stderr, "\rError: TSM Timeout!\n");
-                tsm_free_invoke_id(invoke_id);
-                /* try again or abort? */
-                Error_Detected = true;
                 break;
             }
         } else {
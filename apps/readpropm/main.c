@@ -22,6 +22,7 @@
 #include "bacnet/bactext.h"
 #include "bacnet/bacerror.h"
 #include "bacnet/iam.h"
+#include "bacnet/bacjson.h"
 #include "bacnet/arf.h"
 #include "bacnet/npdu.h"
 #include "bacnet/apdu.h"
@@ -30,8 +31,10 @@
 #include "bacnet/version.h"
 /* some demo stuff needed */
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/client/bac-rw.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/datalink/datalink.h"
@@ -53,6 +56,10 @@ static uint8_t Request_Invoke_ID = 0;
 static BACNET_ADDRESS Target_Address;
 /* needed for return value of main application */
 static bool Error_Detected = false;
+/* bulk mode file of device object property targets, or NULL */
+static const char *Bulk_Pathname = NULL;
+/* number of requests in progress at once in bulk mode */
+static unsigned Bulk_Window = 8;
 
 static void MyErrorHandler(
     BACNET_ADDRESS *src,
@@ -237,6 +244,171 @@ static void target_address_add(
     address_add(Target_Device_Object_Instance, MAX_APDU, &dest);
 }
 
+/**
+ * @brief JSON writer sink that prints to stdout
+ * @param context [in] not used
+ * @param data [in] JSON text
+ * @param length [in] number of bytes of JSON text
+ * @return true if the text was printed
+ */
+static bool bulk_json_sink(void *context, const char *data, size_t length)
+{
+    (void)context;
+    return fwrite(data, 1, length, stdout) == length;
+}
+
+/**
+ * @brief Print a value or error of a bulk read as a JSON line
+ * @param device_id [in] device instance number where data originated
+ * @param rp_data [in] the object property of the read
+ * @param value [in] the decoded value, or NULL for an error
+ */
+static void bulk_value_print(
+    uint32_t device_id,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    BACNET_JSON_WRITER writer = { 0 };
+
+    bacjson_writer_init(&writer, bulk_json_sink, NULL);
+    bacjson_write(&writer, "{\"device\":");
+    bacjson_write_unsigned(&writer, device_id);
+    bacjson_write(&writer, ",\"object-type\":\"");
+    bacjson_write(&writer, bactext_object_type_name(rp_data->object_type));
+    bacjson_write(&writer, "\",\"object-instance\":");
+    bacjson_write_unsigned(&writer, rp_data->object_instance);
+    bacjson_write(&writer, ",\"property\":\"");
+    bacjson_write(&writer, bactext_property_name(rp_data->object_property));
+    bacjson_write(&writer, "\"");
+    if (rp_data->array_index != BACNET_ARRAY_ALL) {
+        bacjson_write(&writer, ",\"index\":");
+        bacjson_write_unsigned(&writer, rp_data->array_index);
+    }
+    if (value) {
+        bacjson_write(&writer, ",\"value\":");
+        bacjson_write_value(
+            &writer, rp_data->object_type, rp_data->object_property, value);
+    } else {
+        Error_Detected = true;
+        bacjson_write(&writer, ",\"error-class\":\"");
+        bacjson_write(&writer, bactext_error_class_name(rp_data->error_class));
+        bacjson_write(&writer, "\",\"error-code\":\"");
+        bacjson_write(&writer, bactext_error_code_name(rp_data->error_code));
+        bacjson_write(&writer, "\"");
+    }
+    bacjson_write(&writer, "}\n");
+    fflush(stdout);
+}
+
+/**
+ * @brief Queue the read of one line of the bulk file
+ * @param line [in] device-instance,object-type,object-instance,property
+ *  with an optional ,index
+ * @param line_number [in] line number in the file for errors
+ */
+static void bulk_line_queue(char *line, unsigned long line_number)
+{
+    char *token[5] = { NULL };
+    unsigned count = 0;
+    uint32_t object_type = 0, property_id = 0;
+    unsigned long device_id = 0, object_instance = 0;
+    unsigned long array_index = BACNET_ARRAY_ALL;
+    bool status;
+
+    line[strcspn(line, "\r\n")] = 0;
+    if ((line[0] == 0) || (line[0] == '#')) {
+        return;
+    }
+    token[0] = strtok(line, ",");
+    while (token[count] && (count < 4)) {
+        count++;
+        token[count] = strtok(NULL, ",");
+    }
+    status = (count >= 4) && bacnet_strtoul(token[0], &device_id) &&
+        (device_id <= BACNET_MAX_INSTANCE) &&
+        bactext_object_type_strtol(token[1], &object_type) &&
+        (object_type < MAX_BACNET_OBJECT_TYPE) &&
+        bacnet_strtoul(token[2], &object_instance) &&
+        (object_instance <= BACNET_MAX_INSTANCE) &&
+        bactext_property_strtol(token[3], &property_id) &&
+        (property_id <= MAX_BACNET_PROPERTY_ID);
+    if (status && token[4]) {
+        status = bacnet_strtoul(token[4], &array_index);
+    }
+    if (status) {
+        status = bacnet_read_property_queue(
+            device_id, object_type, object_instance, property_id,
+            array_index);
+    }
+    if (!status) {
+        fprintf(stderr, "line %lu: invalid target!\n", line_number);
+        Error_Detected = true;
+    }
+}
+
+/**
+ * @brief Read every target in the bulk file, with the reads of many devices
+ *  in progress at once, and print each value as a JSON line
+ * @return 0 if every read succeeded
+ */
+static int bulk_read(void)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint16_t pdu_len = 0;
+    struct mstimer tsm_timer = { 0 };
+    struct mstimer maintenance_timer = { 0 };
+    char line[256];
+    unsigned long line_number = 0;
+    FILE *file;
+    bool more = true;
+
+    if (strcmp(Bulk_Pathname, "-") == 0) {
+        file = stdin;
+    } else {
+        file = fopen(Bulk_Pathname, "r");
+        if (!file) {
+            fprintf(stderr, "%s: unable to open!\n", Bulk_Pathname);
+            return 1;
+        }
+    }
+    bacnet_read_write_init();
+    bacnet_read_write_window_set(Bulk_Window);
+    bacnet_read_write_value_callback_set(bulk_value_print);
+    mstimer_set(&tsm_timer, 50);
+    mstimer_set(&maintenance_timer, 1000);
+    for (;;) {
+        while (more && !bacnet_read_write_busy()) {
+            if (fgets(line, sizeof(line), file)) {
+                line_number++;
+                bulk_line_queue(line, line_number);
+            } else {
+                more = false;
+            }
+        }
+        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, 5);
+        if (pdu_len) {
+            npdu_handler(&src, &Rx_Buf[0], pdu_len);
+        }
+        if (mstimer_expired(&tsm_timer)) {
+            mstimer_reset(&tsm_timer);
+            tsm_timer_milliseconds(mstimer_interval(&tsm_timer));
+        }
+        if (mstimer_expired(&maintenance_timer)) {
+            mstimer_reset(&maintenance_timer);
+            datalink_maintenance_timer(1);
+        }
+        bacnet_read_write_task();
+        if (!more && bacnet_read_write_idle()) {
+            break;
+        }
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+
+    return Error_Detected ? 1 : 0;
+}
+
 static void print_usage(const char *filename)
 {
     printf(
@@ -244,6 +416,7 @@ static void print_usage(const char *filename)
         "property[index][,property[index]] [object-type ...]\n",
         filename);
     printf("       [--dnet][--dadr][--mac]\n");
+    printf("       %s --bulk file [--window N]\n", filename);
     printf("       [--version][--help]\n");
 }
 
@@ -270,6 +443,17 @@ static void print_help(const char *filename)
            "or an IP string with optional port number like 10.1.2.3:47808\n"
            "or an Ethernet MAC in hex like 00:21:70:7e:32:bb\n");
     printf("\n");
+    printf("--bulk file\n"
+           "Read every device object property target in the file, one per\n"
+           "line as device-instance,object-type,object-instance,property\n"
+           "with an optional ,index - or - to read them from stdin.\n"
+           "The reads of each device are packed into ReadPropertyMultiple\n"
+           "requests, and each value or error is printed as a JSON line.\n");
+    printf("\n");
+    printf("--window N\n"
+           "Number of requests in progress at once in bulk mode.\n"
+           "Default is 8.\n");
+    printf("\n");
     printf("device-instance:\n"
            "BACnet Device Object Instance number that you are\n"
            "trying to communicate to.  This number will be used\n"
@@ -382,7 +566,15 @@ int main(int argc, char *argv[])
                    "FITNESS FOR A PARTICULAR PURPOSE.\n");
             return 0;
         }
-        if (strcmp(argv[argi], "--mac") == 0) {
+        if (strcmp(argv[argi], "--bulk") == 0) {
+            if (++argi < argc) {
+                Bulk_Pathname = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--window") == 0) {
+            if (++argi < argc) {
+                Bulk_Window = (unsigned)strtol(argv[argi], NULL, 0);
+            }
+        } else if (strcmp(argv[argi], "--mac") == 0) {
             if (++argi < argc) {
                 if (bacnet_address_mac_from_ascii(&mac, argv[argi])) {
                     specific_address = true;
@@ -498,7 +690,7 @@ int main(int argc, char *argv[])
             }
         }
     }
-    if (!Read_Access_Data) {
+    if (!Read_Access_Data && !Bulk_Pathname) {
         print_usage(filename);
         return 1;
     } else if (tag_value_arg != 0) {
@@ -525,6 +717,9 @@ int main(int argc, char *argv[])
     setlocale(LC_ALL, "");
 #endif
     atexit(datalink_cleanup);
+    if (Bulk_Pathname) {
+        return bulk_read();
+    }
     /* configure the timeout values */
     last_seconds = time(NULL);
     timeout_seconds = (apdu_timeout() / 1000) * apdu_retries();
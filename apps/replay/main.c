@@ -0,0 +1,831 @@
+/**
+ * @file
+ * @brief command line tool that replays a packet capture into the stack
+ * for offline performance testing.  The NPDUs of a libpcap capture of
+ * BACnet/IP, BACnet/Ethernet, or MS/TP traffic are fed to npdu_handler()
+ * of an in-process server as fast as possible, while the stack timers
+ * run on a virtual clock taken from the capture time stamps.  The
+ * datalink is never opened, so the replies are encoded and dropped.
+ * The report gives the processing time of each service.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/apdu.h"
+#include "bacnet/bactext.h"
+#include "bacnet/dcc.h"
+#include "bacnet/npdu.h"
+#include "bacnet/version.h"
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/datalink/bvlc.h"
+#include "bacnet/datalink/crc.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/datalink/mstpdef.h"
+
+/* libpcap data link types */
+#define DLT_EN10MB (1)
+#define DLT_RAW (101)
+#define DLT_LINUX_SLL (113)
+#define DLT_BACNET_MS_TP (165)
+#define DLT_IPV4 (228)
+
+/* the classes of the processing time report: the confirmed requests
+   and the unconfirmed requests by service, the other PDUs by PDU type,
+   and the network layer messages */
+#define REPLAY_CLASS_UNCONFIRMED MAX_BACNET_CONFIRMED_SERVICE
+#define REPLAY_CLASS_PDU_TYPE \
+    (REPLAY_CLASS_UNCONFIRMED + MAX_BACNET_UNCONFIRMED_SERVICE)
+#define REPLAY_CLASS_NETWORK (REPLAY_CLASS_PDU_TYPE + 16)
+#define REPLAY_CLASS_MAX (REPLAY_CLASS_NETWORK + 1)
+
+/* a recorded NPDU */
+struct replay_packet {
+    /* capture time stamp, in microseconds */
+    uint64_t timestamp;
+    BACNET_ADDRESS src;
+    /* offset of the NPDU in the packet data */
+    size_t offset;
+    uint16_t length;
+    uint16_t class_id;
+};
+
+/* the processing time of one class */
+struct replay_statistics {
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+static struct replay_packet *Packet;
+static size_t Packet_Count;
+static size_t Packet_Size;
+static uint8_t *Packet_Data;
+static size_t Packet_Data_Length;
+static size_t Packet_Data_Size;
+static struct replay_statistics Replay_Statistics[REPLAY_CLASS_MAX];
+static struct replay_statistics Timer_Statistics;
+/* buffer for the NPDU that is handled, since a handler may modify it */
+static uint8_t Rx_Buf[MAX_MPDU];
+
+static const char *PDU_Type_Name[16] = {
+    "Confirmed-Request", "Unconfirmed-Request", "Simple-ACK", "Complex-ACK",
+    "Segment-ACK",       "Error",               "Reject",     "Abort",
+    "PDU-Type-8",        "PDU-Type-9",          "PDU-Type-10", "PDU-Type-11",
+    "PDU-Type-12",       "PDU-Type-13",         "PDU-Type-14", "PDU-Type-15"
+};
+
+/**
+ * @brief Get a monotonic time stamp
+ * @return time stamp in nanoseconds
+ */
+static uint64_t replay_nanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((count.QuadPart * 1000000000.0) / frequency.QuadPart);
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Get the report class of an NPDU
+ * @param npdu - the NPDU
+ * @param npdu_len - number of bytes of the NPDU
+ * @return the class, or REPLAY_CLASS_MAX if the NPDU is invalid
+ */
+static uint16_t replay_class(const uint8_t *npdu, uint16_t npdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    const uint8_t *apdu;
+    uint16_t apdu_len;
+    uint8_t service = 0;
+    int offset;
+
+    if ((npdu_len < 2) || (npdu[0] != BACNET_PROTOCOL_VERSION)) {
+        return REPLAY_CLASS_MAX;
+    }
+    offset = bacnet_npdu_decode(npdu, npdu_len, &dest, &src, &npdu_data);
+    if (offset <= 0) {
+        return REPLAY_CLASS_MAX;
+    }
+    if (npdu_data.network_layer_message) {
+        return REPLAY_CLASS_NETWORK;
+    }
+    if (offset >= npdu_len) {
+        return REPLAY_CLASS_MAX;
+    }
+    apdu = &npdu[offset];
+    apdu_len = npdu_len - offset;
+    switch (apdu[0] & 0xF0) {
+        case PDU_TYPE_CONFIRMED_SERVICE_REQUEST:
+            /* a segmented request has a sequence number and window */
+            offset = (apdu[0] & 0x08) ? 5 : 3;
+            if (apdu_len > offset) {
+                service = apdu[offset];
+                if (service < MAX_BACNET_CONFIRMED_SERVICE) {
+                    return service;
+                }
+            }
+            break;
+        case PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST:
+            if (apdu_len > 1) {
+                service = apdu[1];
+                if (service < MAX_BACNET_UNCONFIRMED_SERVICE) {
+                    return REPLAY_CLASS_UNCONFIRMED + service;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    return REPLAY_CLASS_PDU_TYPE + (apdu[0] >> 4);
+}
+
+/**
+ * @brief Get the name of a report class
+ * @param class_id - the class
+ * @return the name
+ */
+static const char *replay_class_name(unsigned class_id)
+{
+    if (class_id < REPLAY_CLASS_UNCONFIRMED) {
+        return bactext_confirmed_service_name(class_id);
+    } else if (class_id < REPLAY_CLASS_PDU_TYPE) {
+        return bactext_unconfirmed_service_name(
+            class_id - REPLAY_CLASS_UNCONFIRMED);
+    } else if (class_id < REPLAY_CLASS_NETWORK) {
+        return PDU_Type_Name[class_id - REPLAY_CLASS_PDU_TYPE];
+    }
+
+    return "Network-Layer-Message";
+}
+
+/**
+ * @brief Add a recorded NPDU to the replay
+ * @param timestamp - capture time stamp, in microseconds
+ * @param src - the BACnet source address of the NPDU
+ * @param npdu - the NPDU
+ * @param npdu_len - number of bytes of the NPDU
+ * @return true if the NPDU was added
+ */
+static bool replay_packet_add(
+    uint64_t timestamp,
+    const BACNET_ADDRESS *src,
+    const uint8_t *npdu,
+    size_t npdu_len)
+{
+    struct replay_packet *packet;
+    uint8_t *data;
+    uint16_t class_id;
+    size_t size;
+
+    if ((npdu_len == 0) || (npdu_len > MAX_MPDU)) {
+        return false;
+    }
+    class_id = replay_class(npdu, (uint16_t)npdu_len);
+    if (class_id >= REPLAY_CLASS_MAX) {
+        return false;
+    }
+    if (Packet_Count >= Packet_Size) {
+        size = Packet_Size ? Packet_Size * 2 : 1024;
+        packet = realloc(Packet, size * sizeof(struct replay_packet));
+        if (!packet) {
+            return false;
+        }
+        Packet = packet;
+        Packet_Size = size;
+    }
+    if ((Packet_Data_Length + npdu_len) > Packet_Data_Size) {
+        size = Packet_Data_Size ? Packet_Data_Size * 2 : 65536;
+        while (size < (Packet_Data_Length + npdu_len)) {
+            size *= 2;
+        }
+        data = realloc(Packet_Data, size);
+        if (!data) {
+            return false;
+        }
+        Packet_Data = data;
+        Packet_Data_Size = size;
+    }
+    memcpy(&Packet_Data[Packet_Data_Length], npdu, npdu_len);
+    packet = &Packet[Packet_Count];
+    packet->timestamp = timestamp;
+    packet->src = *src;
+    packet->offset = Packet_Data_Length;
+    packet->length = (uint16_t)npdu_len;
+    packet->class_id = class_id;
+    Packet_Data_Length += npdu_len;
+    Packet_Count++;
+
+    return true;
+}
+
+/**
+ * @brief Add the NPDU of a BACnet/IP datagram
+ * @param timestamp - capture time stamp, in microseconds
+ * @param ip - the IPv4 source address
+ * @param port - the UDP source port
+ * @param bvlc - the UDP payload
+ * @param bvlc_len - number of bytes of the UDP payload
+ * @return true if an NPDU was added
+ */
+static bool replay_bip_add(
+    uint64_t timestamp,
+    const uint8_t *ip,
+    uint16_t port,
+    const uint8_t *bvlc,
+    size_t bvlc_len)
+{
+    BACNET_ADDRESS src = { 0 };
+    size_t offset = 4;
+
+    if ((bvlc_len < 4) || (bvlc[0] != BVLL_TYPE_BACNET_IP) ||
+        ((((size_t)bvlc[2] << 8) | bvlc[3]) != bvlc_len)) {
+        return false;
+    }
+    memcpy(&src.mac[0], ip, 4);
+    src.mac[4] = (uint8_t)(port >> 8);
+    src.mac[5] = (uint8_t)(port & 0xFF);
+    switch (bvlc[1]) {
+        case BVLC_ORIGINAL_UNICAST_NPDU:
+        case BVLC_ORIGINAL_BROADCAST_NPDU:
+            break;
+        case BVLC_FORWARDED_NPDU:
+            /* the NPDU came from the original source */
+            if (bvlc_len < 10) {
+                return false;
+            }
+            memcpy(&src.mac[0], &bvlc[4], 6);
+            offset = 10;
+            break;
+        default:
+            return false;
+    }
+    src.mac_len = 6;
+
+    return replay_packet_add(
+        timestamp, &src, &bvlc[offset], bvlc_len - offset);
+}
+
+/**
+ * @brief Add the NPDU of an IPv4 packet
+ * @param timestamp - capture time stamp, in microseconds
+ * @param ip - the IPv4 packet
+ * @param ip_len - number of bytes of the IPv4 packet
+ * @return true if an NPDU was added
+ */
+static bool
+replay_ipv4_add(uint64_t timestamp, const uint8_t *ip, size_t ip_len)
+{
+    size_t header_len, total_len, udp_len;
+    const uint8_t *udp;
+
+    if ((ip_len < 20) || ((ip[0] >> 4) != 4)) {
+        return false;
+    }
+    header_len = (ip[0] & 0x0F) * 4;
+    total_len = ((size_t)ip[2] << 8) | ip[3];
+    /* UDP, and not a fragment */
+    if ((ip[9] != 17) || (header_len < 20) || (total_len > ip_len) ||
+        (total_len < (header_len + 8)) || (((ip[6] & 0x1F) | ip[7]) != 0) ||
+        (ip[6] & 0x20)) {
+        return false;
+    }
+    udp = &ip[header_len];
+    udp_len = ((size_t)udp[4] << 8) | udp[5];
+    if ((udp_len < 8) || (udp_len > (total_len - header_len))) {
+        return false;
+    }
+
+    return replay_bip_add(
+        timestamp, &ip[12], (uint16_t)((udp[0] << 8) | udp[1]), &udp[8],
+        udp_len - 8);
+}
+
+/**
+ * @brief Add the NPDU of an Ethernet frame, either BACnet/IP or
+ *  BACnet/Ethernet with an 802.2 LLC header
+ * @param timestamp - capture time stamp, in microseconds
+ * @param frame - the frame, from the destination MAC
+ * @param frame_len - number of bytes of the frame
+ * @return true if an NPDU was added
+ */
+static bool
+replay_ethernet_add(uint64_t timestamp, const uint8_t *frame, size_t frame_len)
+{
+    BACNET_ADDRESS src = { 0 };
+    size_t offset = 12;
+    uint16_t type;
+
+    if (frame_len < 14) {
+        return false;
+    }
+    type = (uint16_t)((frame[offset] << 8) | frame[offset + 1]);
+    if ((type == 0x8100) && (frame_len >= 18)) {
+        /* skip the VLAN tag */
+        offset += 4;
+        type = (uint16_t)((frame[offset] << 8) | frame[offset + 1]);
+    }
+    offset += 2;
+    if (type == 0x0800) {
+        return replay_ipv4_add(timestamp, &frame[offset], frame_len - offset);
+    }
+    if ((type <= 1500) && ((offset + 3) <= frame_len) &&
+        (frame[offset] == 0x82) && (frame[offset + 1] == 0x82) &&
+        (frame[offset + 2] == 0x03)) {
+        memcpy(&src.mac[0], &frame[6], 6);
+        src.mac_len = 6;
+        offset += 3;
+        if ((offset + type - 3) < frame_len) {
+            /* drop the padding of a short frame */
+            frame_len = offset + type - 3;
+        }
+        return replay_packet_add(
+            timestamp, &src, &frame[offset], frame_len - offset);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Add the NPDU of a Linux cooked capture packet
+ * @param timestamp - capture time stamp, in microseconds
+ * @param packet - the packet, from the SLL header
+ * @param packet_len - number of bytes of the packet
+ * @return true if an NPDU was added
+ */
+static bool
+replay_sll_add(uint64_t timestamp, const uint8_t *packet, size_t packet_len)
+{
+    if ((packet_len < 16) || (packet[14] != 0x08) || (packet[15] != 0x00)) {
+        return false;
+    }
+
+    return replay_ipv4_add(timestamp, &packet[16], packet_len - 16);
+}
+
+/**
+ * @brief Add the NPDU of an MS/TP data frame
+ * @param timestamp - capture time stamp, in microseconds
+ * @param frame - the frame, from the preamble
+ * @param frame_len - number of bytes of the frame
+ * @return true if an NPDU was added
+ */
+static bool
+replay_mstp_add(uint64_t timestamp, const uint8_t *frame, size_t frame_len)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t crc8 = 0xFF;
+    uint16_t crc16 = 0xFFFF;
+    size_t data_len;
+    size_t i;
+
+    if ((frame_len < 8) || (frame[0] != 0x55) || (frame[1] != 0xFF)) {
+        return false;
+    }
+    if ((frame[2] != FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY) &&
+        (frame[2] != FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY)) {
+        return false;
+    }
+    for (i = 2; i < 8; i++) {
+        crc8 = CRC_Calc_Header(frame[i], crc8);
+    }
+    data_len = ((size_t)frame[5] << 8) | frame[6];
+    if ((crc8 != 0x55) || (data_len == 0) || (frame_len < (8 + data_len + 2))) {
+        return false;
+    }
+    for (i = 8; i < (8 + data_len + 2); i++) {
+        crc16 = CRC_Calc_Data(frame[i], crc16);
+    }
+    if (crc16 != 0xF0B8) {
+        return false;
+    }
+    src.mac[0] = frame[4];
+    src.mac_len = 1;
+
+    return replay_packet_add(timestamp, &src, &frame[8], data_len);
+}
+
+/**
+ * @brief Get a 16-bit or 32-bit value of the capture file
+ * @param data - the value in the file
+ * @param size - number of bytes of the value
+ * @param swapped - true if the file byte order differs from the host
+ * @return the value
+ */
+static uint32_t
+replay_pcap_value(const uint8_t *data, size_t size, bool swapped)
+{
+    uint32_t value = 0;
+    uint16_t value16 = 0;
+
+    if (size == 2) {
+        memcpy(&value16, data, 2);
+        if (swapped) {
+            value16 = (uint16_t)((value16 >> 8) | (value16 << 8));
+        }
+        return value16;
+    }
+    memcpy(&value, data, 4);
+    if (swapped) {
+        value = ((value >> 24) & 0xFF) | ((value >> 8) & 0xFF00) |
+            ((value << 8) & 0xFF0000) | ((value << 24) & 0xFF000000);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Load the NPDUs of a libpcap capture file
+ * @param pathname - the capture file
+ * @return number of packets in the file, or -1 on error
+ */
+static long replay_pcap_load(const char *pathname)
+{
+    static uint8_t packet[65536];
+    uint8_t header[24];
+    uint32_t magic, network;
+    uint32_t incl_len, orig_len;
+    uint64_t timestamp;
+    bool swapped = false;
+    bool nanoseconds = false;
+    long count = 0;
+    FILE *file;
+
+    file = fopen(pathname, "rb");
+    if (!file) {
+        fprintf(stderr, "%s: unable to open!\n", pathname);
+        return -1;
+    }
+    if (fread(header, sizeof(header), 1, file) != 1) {
+        fprintf(stderr, "%s: not a pcap file!\n", pathname);
+        fclose(file);
+        return -1;
+    }
+    magic = replay_pcap_value(&header[0], 4, false);
+    if ((magic == 0xd4c3b2a1) || (magic == 0x4d3cb2a1)) {
+        swapped = true;
+        magic = replay_pcap_value(&header[0], 4, true);
+    }
+    if (magic == 0xa1b23c4d) {
+        nanoseconds = true;
+    } else if (magic != 0xa1b2c3d4) {
+        fprintf(
+            stderr,
+            "%s: not a pcap file! Convert a pcapng file with\n"
+            "editcap -F pcap in.pcapng out.pcap\n",
+            pathname);
+        fclose(file);
+        return -1;
+    }
+    network = replay_pcap_value(&header[20], 4, swapped) & 0xFFFF;
+    if ((network != DLT_EN10MB) && (network != DLT_RAW) &&
+        (network != DLT_LINUX_SLL) && (network != DLT_BACNET_MS_TP) &&
+        (network != DLT_IPV4)) {
+        fprintf(
+            stderr, "%s: data link type %lu is not supported!\n", pathname,
+            (unsigned long)network);
+        fclose(file);
+        return -1;
+    }
+    while (fread(header, 16, 1, file) == 1) {
+        timestamp = replay_pcap_value(&header[0], 4, swapped);
+        timestamp *= 1000000ULL;
+        if (nanoseconds) {
+            timestamp += replay_pcap_value(&header[4], 4, swapped) / 1000;
+        } else {
+            timestamp += replay_pcap_value(&header[4], 4, swapped);
+        }
+        incl_len = replay_pcap_value(&header[8], 4, swapped);
+        orig_len = replay_pcap_value(&header[12], 4, swapped);
+        if ((incl_len > sizeof(packet)) ||
+            (fread(packet, 1, incl_len, file) != incl_len)) {
+            fprintf(stderr, "%s: truncated packet!\n", pathname);
+            break;
+        }
+        count++;
+        if (incl_len < orig_len) {
+            /* the NPDU was cut by the snap length */
+            continue;
+        }
+        switch (network) {
+            case DLT_EN10MB:
+                replay_ethernet_add(timestamp, packet, incl_len);
+                break;
+            case DLT_RAW:
+            case DLT_IPV4:
+                replay_ipv4_add(timestamp, packet, incl_len);
+                break;
+            case DLT_LINUX_SLL:
+                replay_sll_add(timestamp, packet, incl_len);
+                break;
+            case DLT_BACNET_MS_TP:
+                replay_mstp_add(timestamp, packet, incl_len);
+                break;
+            default:
+                break;
+        }
+    }
+    fclose(file);
+
+    return count;
+}
+
+/**
+ * @brief Run the stack timers for the elapsed virtual time
+ * @param elapsed_ms - virtual milliseconds since the previous call
+ */
+static void replay_timer_task(uint32_t elapsed_ms)
+{
+    static uint32_t milliseconds;
+    uint32_t seconds;
+
+    tsm_timer_milliseconds(elapsed_ms);
+    Device_Timer((uint16_t)((elapsed_ms > UINT16_MAX) ? UINT16_MAX
+                                                      : elapsed_ms));
+    milliseconds += elapsed_ms;
+    if (milliseconds >= 1000) {
+        seconds = milliseconds / 1000;
+        milliseconds -= seconds * 1000;
+        dcc_timer_seconds(seconds);
+        handler_cov_timer_seconds(seconds);
+        address_cache_timer(
+            (uint16_t)((seconds > UINT16_MAX) ? UINT16_MAX : seconds));
+    }
+    handler_cov_task();
+}
+
+/**
+ * @brief Feed the recorded NPDUs to the stack once
+ * @return wall time of the pass, in nanoseconds
+ */
+static uint64_t replay_pass(void)
+{
+    struct replay_packet *packet;
+    struct replay_statistics *stats;
+    uint64_t virtual_ms = 0, timer_ms = 0;
+    uint64_t start, begin, elapsed;
+    uint32_t elapsed_ms;
+    size_t i;
+
+    start = replay_nanoseconds();
+    for (i = 0; i < Packet_Count; i++) {
+        packet = &Packet[i];
+        /* the virtual clock follows the capture time stamps */
+        virtual_ms = (packet->timestamp - Packet[0].timestamp) / 1000;
+        if (virtual_ms > timer_ms) {
+            elapsed_ms = (uint32_t)(virtual_ms - timer_ms);
+            timer_ms = virtual_ms;
+            begin = replay_nanoseconds();
+            replay_timer_task(elapsed_ms);
+            elapsed = replay_nanoseconds() - begin;
+            Timer_Statistics.count++;
+            Timer_Statistics.total_ns += elapsed;
+            if (elapsed > Timer_Statistics.max_ns) {
+                Timer_Statistics.max_ns = elapsed;
+            }
+        }
+        memcpy(Rx_Buf, &Packet_Data[packet->offset], packet->length);
+        begin = replay_nanoseconds();
+        npdu_handler(&packet->src, Rx_Buf, packet->length);
+        elapsed = replay_nanoseconds() - begin;
+        stats = &Replay_Statistics[packet->class_id];
+        stats->count++;
+        stats->total_ns += elapsed;
+        if (elapsed > stats->max_ns) {
+            stats->max_ns = elapsed;
+        }
+    }
+
+    return replay_nanoseconds() - start;
+}
+
+/**
+ * @brief Print one line of the report
+ * @param name - name of the class
+ * @param stats - processing time of the class
+ * @param total_ns - processing time of every class
+ */
+static void replay_report_line(
+    const char *name,
+    const struct replay_statistics *stats,
+    uint64_t total_ns)
+{
+    printf(
+        "%-32s %10lu %10.2f %10.2f %10.1f %6.1f%%\n", name, stats->count,
+        (double)stats->total_ns / stats->count / 1000.0,
+        (double)stats->max_ns / 1000.0, (double)stats->total_ns / 1000000.0,
+        total_ns ? (100.0 * stats->total_ns) / total_ns : 0.0);
+}
+
+/**
+ * @brief Print the processing time report
+ * @param elapsed_ns - wall time of the replay
+ */
+static void replay_report(uint64_t elapsed_ns)
+{
+    unsigned long count = 0;
+    uint64_t total_ns = Timer_Statistics.total_ns;
+    unsigned i;
+
+    for (i = 0; i < REPLAY_CLASS_MAX; i++) {
+        count += Replay_Statistics[i].count;
+        total_ns += Replay_Statistics[i].total_ns;
+    }
+    printf(
+        "%lu NPDUs in %.3f s: %.1f NPDUs/s\n", count,
+        (double)elapsed_ns / 1000000000.0,
+        elapsed_ns ? (count * 1000000000.0) / elapsed_ns : 0.0);
+    printf(
+        "%-32s %10s %10s %10s %10s %7s\n", "service", "count", "mean-us",
+        "max-us", "total-ms", "share");
+    for (i = 0; i < REPLAY_CLASS_MAX; i++) {
+        if (Replay_Statistics[i].count) {
+            replay_report_line(
+                replay_class_name(i), &Replay_Statistics[i], total_ns);
+        }
+    }
+    if (Timer_Statistics.count) {
+        replay_report_line("Timers", &Timer_Statistics, total_ns);
+    }
+}
+
+static void Init_Service_Handlers(void)
+{
+    Device_Init(NULL);
+    /* we need to handle who-is to support dynamic device binding */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_IS, handler_who_is);
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_WHO_HAS, handler_who_has);
+    /* set the handler for all the services we don't implement */
+    /* It is required to send the proper reject message... */
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    /* Set the handlers for any confirmed services that we support. */
+    /* We must implement read property - it's required! */
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, handler_read_property_multiple);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_WRITE_PROPERTY, handler_write_property);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE, handler_write_property_multiple);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_RANGE, handler_read_range);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_REINITIALIZE_DEVICE, handler_reinitialize_device);
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_UTC_TIME_SYNCHRONIZATION, handler_timesync_utc);
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_TIME_SYNCHRONIZATION, handler_timesync);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV, handler_cov_subscribe);
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_COV_NOTIFICATION, handler_ucov_notification);
+    /* handle communication so we can shutup when asked */
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_DEVICE_COMMUNICATION_CONTROL,
+        handler_device_communication_control);
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_PRIVATE_TRANSFER,
+        handler_unconfirmed_private_transfer);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_CREATE_OBJECT, handler_create_object);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_DELETE_OBJECT, handler_delete_object);
+    /* the replies of the devices in the capture */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_add);
+}
+
+static void print_usage(const char *filename)
+{
+    printf("Usage: %s file [device-instance][--loop N]\n", filename);
+    printf("       [--version][--help]\n");
+}
+
+static void print_help(const char *filename)
+{
+    printf("Replay the BACnet NPDUs of a packet capture into the\n"
+           "BACnet stack as fast as possible, and print the\n"
+           "processing time of each service.\n");
+    printf("\n");
+    printf("file:\n"
+           "A libpcap capture of BACnet/IP, BACnet/Ethernet, or MS/TP\n"
+           "traffic, for example from Wireshark or mstpcap.  A pcapng\n"
+           "capture can be converted with editcap -F pcap.\n");
+    printf("\n");
+    printf("device-instance:\n"
+           "Device Object Instance number of the replay device.\n"
+           "Use the instance of the device in the capture so that\n"
+           "its requests are answered.\n");
+    printf("\n");
+    printf("--loop N\n"
+           "Replay the capture N times.  Default is 1.\n");
+    printf("\n");
+    printf(
+        "Example:\n"
+        "To replay site.pcap 10 times as Device 123:\n"
+        "%s site.pcap 123 --loop 10\n",
+        filename);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = NULL;
+    const char *pathname = NULL;
+    unsigned long loop = 1;
+    unsigned long value = 0;
+    uint64_t elapsed_ns = 0;
+    unsigned int target_args = 0;
+    long count;
+    int argi;
+
+    filename = filename_remove_path(argv[0]);
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--help") == 0) {
+            print_usage(filename);
+            print_help(filename);
+            return 0;
+        }
+        if (strcmp(argv[argi], "--version") == 0) {
+            printf("%s %s\n", filename, BACNET_VERSION_TEXT);
+            printf("Copyright (C) 2014 by Steve Karg and others.\n"
+                   "This is free software; see the source for copying "
+                   "conditions.\n"
+                   "There is NO warranty; not even for MERCHANTABILITY or\n"
+                   "FITNESS FOR A PARTICULAR PURPOSE.\n");
+            return 0;
+        }
+        if (strcmp(argv[argi], "--loop") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &loop) ||
+                (loop == 0)) {
+                fprintf(stderr, "loop invalid\n");
+                return 1;
+            }
+        } else if (target_args == 0) {
+            pathname = argv[argi];
+            target_args++;
+        } else if (target_args == 1) {
+            if (!bacnet_strtoul(argv[argi], &value) ||
+                (value > BACNET_MAX_INSTANCE)) {
+                fprintf(
+                    stderr, "device-instance=%s - not greater than %u\n",
+                    argv[argi], BACNET_MAX_INSTANCE);
+                return 1;
+            }
+            Device_Set_Object_Instance_Number((uint32_t)value);
+            target_args++;
+        } else {
+            print_usage(filename);
+            return 1;
+        }
+    }
+    if (!pathname) {
+        print_usage(filename);
+        return 1;
+    }
+    address_init();
+    Init_Service_Handlers();
+    count = replay_pcap_load(pathname);
+    if (count < 0) {
+        return 1;
+    }
+    printf(
+        "%s: %lu of %ld packets are BACnet NPDUs\n", pathname,
+        (unsigned long)Packet_Count, count);
+    if (Packet_Count > 0) {
+        for (value = 0; value < loop; value++) {
+            elapsed_ns += replay_pass();
+        }
+        replay_report(elapsed_ns);
+    }
+    free(Packet);
+    free(Packet_Data);
+
+    return 0;
+}
@@ -1141,6 +1141,7 @@ int main(int argc, char *argv[])
 {
     BACNET_ADDRESS src = { 0 }; /* address where message came from */
     uint16_t pdu_len = 0;
+    uint16_t pdu_offset = 0;
     time_t last_seconds = 0;
     time_t current_seconds = 0;
     uint32_t elapsed_seconds = 0;
@@ -1165,12 +1166,13 @@ int main(int argc, char *argv[])
         /* input */
         current_seconds = time(NULL);
         /* returns 0 bytes on timeout */
-        pdu_len =
-            bip_receive(&src, &BIP_Rx_Buffer[0], sizeof(BIP_Rx_Buffer), 5);
-        /* process */
+        pdu_len = bip_receive_npdu(
+            &src, &BIP_Rx_Buffer[0], sizeof(BIP_Rx_Buffer), 5, &pdu_offset);
+        /* process the NPDU in place */
         if (pdu_len) {
             debug_printf("BACnet/IP Received packet\n");
-            my_routing_npdu_handler(BIP_Net, &src, &BIP_Rx_Buffer[0], pdu_len);
+            my_routing_npdu_handler(
+                BIP_Net, &src, &BIP_Rx_Buffer[pdu_offset], pdu_len);
         }
         /* returns 0 bytes on timeout */
         pdu_len =
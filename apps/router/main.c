@@ -33,6 +33,14 @@
 #include "network_layer.h"
 #include "ipmodule.h"
 #include "mstpmodule.h"
+#if defined(BACDL_SHM)
+#include "shmmodule.h"
+#endif
+#include "readcache.h"
+#include "whoisproxy.h"
+#if defined(BACNET_LOCK_STATISTICS)
+#include "bacnet/basic/sys/lockstat.h"
+#endif
 
 #define KEY_ESC 27
 
@@ -118,6 +126,16 @@ int main(int argc, char *argv[])
                             break;
                         }
                     } else {
+                        /* a read answered from the cache comes back as
+                           the reply of the device, and a read that waits
+                           for the same pending read is not routed */
+                        if (!read_cache_process(bacmsg)) {
+                            free(msg_data);
+                            break;
+                        }
+                        /* a Who-Is answered by the proxy is kept off the
+                           MS/TP trunks it answered for */
+                        who_is_proxy_process(bacmsg);
                         buff_len = process_msg(bacmsg, msg_data, &buff);
                     }
 
@@ -138,13 +156,18 @@ int main(int argc, char *argv[])
 
                         if (is_network_msg(bacmsg)) {
                             msg_data->ref_count = 1;
-                            send_to_msgbox(msg_src, &msg_storage);
+                            if (!send_to_msgbox(msg_src, &msg_storage)) {
+                                free_data(msg_data);
+                            }
                         } else if (
                             msg_data->dest.net != BACNET_BROADCAST_NETWORK) {
                             msg_data->ref_count = 1;
                             port =
                                 find_dnet(msg_data->dest.net, &msg_data->dest);
-                            send_to_msgbox(port->port_id, &msg_storage);
+                            if (who_is_proxy_skip(port) ||
+                                !send_to_msgbox(port->port_id, &msg_storage)) {
+                                free_data(msg_data);
+                            }
                         } else {
                             port = head;
                             msg_data->ref_count = port_count - 1;
@@ -154,7 +177,11 @@ int main(int argc, char *argv[])
                                     port = port->next;
                                     continue;
                                 }
-                                send_to_msgbox(port->port_id, &msg_storage);
+                                if (who_is_proxy_skip(port) ||
+                                    !send_to_msgbox(
+                                        port->port_id, &msg_storage)) {
+                                    check_data(msg_data);
+                                }
                                 port = port->next;
                             }
                         }
@@ -198,6 +225,18 @@ void print_help(void)
            "-p, --parity <None|Even|Odd>\n\tspecify MSTP port parity\n"
            "-d, --databits <5|6|7|8>\n\tspecify MSTP port databits\n"
            "-s, --stopbits <1|2>\n\tspecify MSTP port stopbits\n");
+#if defined(BACDL_SHM)
+    printf("\nshm device:\n"
+           "-D shm <name[:mac]>\n\tattach to the shared-memory network "
+           "<name> of this host,\n\tas the first free MAC or as <mac>\n");
+#endif
+    printf("\noptions, before the devices:\n"
+           "-C, --cache <ttl>[,<property>=<ttl>...]\n\tanswer repeated "
+           "reads of MS/TP devices from a cache,\n\tkeeping replies for "
+           "ttl seconds, or for the ttl of a property\n"
+           "-W, --who-is-proxy <ttl>\n\tanswer Who-Is for MS/TP devices "
+           "from their I-Am,\n\tforgetting devices not heard from for ttl "
+           "seconds\n");
 }
 
 bool read_config(const char *filepath)
@@ -205,6 +244,8 @@ bool read_config(const char *filepath)
     config_t cfg;
     config_setting_t *setting;
     ROUTER_PORT *current = head;
+    const char *cache_spec = NULL;
+    int who_is_proxy_ttl = 0;
     int result, fd;
 
     config_init(&cfg);
@@ -246,6 +287,14 @@ bool read_config(const char *filepath)
             }
 
             port_count++;
+            /* scheduling of the port thread */
+            thread_sched_init(&current->sched, "ROUTER", 0);
+            if (config_setting_lookup_int(port, "priority", (int *)&param)) {
+                current->sched.priority = param;
+            }
+            if (config_setting_lookup_int(port, "cpu", (int *)&param)) {
+                current->sched.cpu = param;
+            }
             config_setting_lookup_string(port, "device_type", &dev_type);
             printf("dev_type = %s\r\n", dev_type);
             if (strcmp(dev_type, "bip") == 0) {
@@ -380,6 +429,27 @@ bool read_config(const char *filepath)
                     current->route_info.net = get_next_free_dnet();
                 }
 
+#if defined(BACDL_SHM)
+            } else if (strcmp(dev_type, "shm") == 0) {
+                current->type = SHM;
+
+                result = config_setting_lookup_string(port, "device", &iface);
+                if (result) {
+                    current->iface =
+                        (char *)calloc(strlen(iface) + 1, sizeof(char));
+                    strcpy(current->iface, iface);
+                } else {
+                    current->iface = "bacnet";
+                }
+                result =
+                    config_setting_lookup_int(port, "network", (int *)&param);
+                if (result) {
+                    current->route_info.net = param;
+                } else {
+                    current->route_info.net = get_next_free_dnet();
+                }
+
+#endif
             } else {
                 PRINT(ERROR, "Error: %s unsuported\n", dev_type);
                 return false;
@@ -390,6 +460,17 @@ bool read_config(const char *filepath)
         return false;
     }
 
+    if (config_lookup_string(&cfg, "cache", &cache_spec) &&
+        !read_cache_configure(cache_spec)) {
+        config_destroy(&cfg);
+        return false;
+    }
+    if (config_lookup_int(&cfg, "who_is_proxy", &who_is_proxy_ttl) &&
+        !who_is_proxy_configure(who_is_proxy_ttl)) {
+        config_destroy(&cfg);
+        return false;
+    }
+
     config_destroy(&cfg);
     printf("cmd file parse success\r\n");
     return true;
@@ -397,11 +478,16 @@ bool read_config(const char *filepath)
 
 bool parse_cmd(int argc, char *argv[])
 {
-    const char *optString = "hc:D:";
+    const char *optString = "hc:C:W:D:";
     const char *bipString = "p:n:D:";
     const char *mstpString = "m:b:p:d:s:n:D:";
+#if defined(BACDL_SHM)
+    const char *shmString = "n:D:";
+#endif
     const struct option Options[] = {
         { "config", required_argument, NULL, 'c' },
+        { "cache", required_argument, NULL, 'C' },
+        { "who-is-proxy", required_argument, NULL, 'W' },
         { "device", required_argument, NULL, 'D' },
         { "network", required_argument, NULL, 'n' },
         { "port", required_argument, NULL, 'P' },
@@ -434,6 +520,18 @@ bool parse_cmd(int argc, char *argv[])
             case 'c':
                 return read_config(optarg);
                 break;
+            case 'C':
+                if (!read_cache_configure(optarg)) {
+                    return false;
+                }
+                opt = getopt_long(argc, argv, optString, Options, &index);
+                break;
+            case 'W':
+                if (!who_is_proxy_configure(atoi(optarg))) {
+                    return false;
+                }
+                opt = getopt_long(argc, argv, optString, Options, &index);
+                break;
             case 'D':
 
                 /* create new list node to store port information */
@@ -450,6 +548,7 @@ bool parse_cmd(int argc, char *argv[])
                 }
 
                 port_count++;
+                thread_sched_init(&current->sched, "ROUTER", 0);
                 if (strcmp(optarg, "bip") == 0) {
                     current->type = BIP;
 
@@ -616,6 +715,35 @@ bool parse_cmd(int argc, char *argv[])
                             argc, argv, mstpString, Options, &index);
                     }
                     opt = dev_opt;
+#if defined(BACDL_SHM)
+                } else if (strcmp(optarg, "shm") == 0) {
+                    current->type = SHM;
+
+                    if (optind < argc && argv[optind][0] != '-') {
+                        current->iface = argv[optind];
+                    } else {
+                        current->iface = "bacnet";
+                    }
+                    current->route_info.net = get_next_free_dnet();
+
+                    dev_opt =
+                        getopt_long(argc, argv, shmString, Options, &index);
+                    while (dev_opt != -1 && dev_opt != 'D') {
+                        switch (dev_opt) {
+                            case 'n':
+                                result = atoi(optarg);
+                                if (result) {
+                                    current->route_info.net = (uint16_t)result;
+                                }
+                                break;
+                            default:
+                                break;
+                        }
+                        dev_opt =
+                            getopt_long(argc, argv, shmString, Options, &index);
+                    }
+                    opt = dev_opt;
+#endif
                 } else {
                     PRINT(ERROR, "Error: %s unknown\n", optarg);
                     return false;
@@ -641,12 +769,18 @@ void init_port_threads(ROUTER_PORT *port_list)
             case MSTP:
                 port->func = &dl_mstp_thread;
                 break;
+#if defined(BACDL_SHM)
+            case SHM:
+                port->func = &dl_shm_thread;
+                break;
+#endif
             default:
                 break;
         }
         port->state = INIT;
         thread = (pthread_t *)malloc(sizeof(pthread_t));
-        pthread_create(thread, NULL, port->func, port);
+        thread_sched_create(
+            thread, NULL, &port->sched, "Router port", port->func, port);
 
         pthread_detach(*thread); /* for proper thread termination */
 
@@ -692,11 +826,51 @@ bool init_router(void)
     return true;
 }
 
+#if defined(BACNET_LOCK_STATISTICS)
+/**
+ * @brief Print the waits for the locks, and the depths of the message
+ *  boxes, at exit
+ */
+static void print_lock_statistics(void)
+{
+    const LOCKSTAT_LOCK *lock;
+    const LOCKSTAT_QUEUE *queue;
+    unsigned long mean;
+
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        mean = 0;
+        if (lock->contended) {
+            mean = (unsigned long)(lock->wait_total / lock->contended);
+        }
+        fprintf(
+            stderr,
+            "%s: acquisitions=%lu contended=%lu wait-mean=%luus "
+            "wait-max=%luus\n",
+            lock->name, (unsigned long)lock->acquisitions,
+            (unsigned long)lock->contended, mean,
+            (unsigned long)lock->wait_max);
+    }
+    for (queue = lockstat_queues(); queue; queue = queue->next) {
+        mean = 0;
+        if (queue->samples) {
+            mean = (unsigned long)(queue->depth_total / queue->samples);
+        }
+        fprintf(
+            stderr, "%s: samples=%lu depth-mean=%lu depth-max=%lu\n",
+            queue->name, (unsigned long)queue->samples, mean,
+            (unsigned long)queue->depth_max);
+    }
+}
+#endif
+
 void cleanup(void)
 {
     ROUTER_PORT *port;
     BACMSG msg;
 
+#if defined(BACNET_LOCK_STATISTICS)
+    print_lock_statistics();
+#endif
     if (head == NULL) {
         return;
     }
@@ -727,6 +901,8 @@ void cleanup(void)
         }
     }
 
+    read_cache_cleanup();
+    who_is_proxy_cleanup();
     pthread_mutex_destroy(&msg_lock);
 }
 
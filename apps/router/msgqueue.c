@@ -13,9 +13,215 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include "msgqueue.h"
+#include "lockstat-mutex.h"
+#if MSGBOX_RING
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#endif
 
 pthread_mutex_t msg_lock = PTHREAD_MUTEX_INITIALIZER;
+#if defined(BACNET_LOCK_STATISTICS)
+static LOCKSTAT_LOCK Msg_Lock_Stats = LOCKSTAT_LOCK_INIT("router-msg");
+#endif
 
+#if MSGBOX_RING
+/* A bounded multi-producer ring: every cell carries a sequence number
+   which tells a producer that the cell is free, and the consumer that the
+   message in it is complete, so neither side takes a lock. Only the
+   thread that owns a message box receives from it. */
+struct msgbox_cell {
+    unsigned long sequence;
+    BACMSG msg;
+};
+
+struct msgbox {
+    int used;
+    /* wakes the owner when it waits for a message */
+    bool has_event_fd;
+    int event_fd;
+    int waiting;
+    unsigned long enqueue_pos;
+    unsigned long dequeue_pos;
+    struct msgbox_cell cell[MSGBOX_RING_SIZE];
+};
+
+static struct msgbox Msgbox[MSGBOX_MAX];
+static pthread_mutex_t Msgbox_Lock = PTHREAD_MUTEX_INITIALIZER;
+#if defined(BACNET_LOCK_STATISTICS)
+static LOCKSTAT_LOCK Msgbox_Lock_Stats = LOCKSTAT_LOCK_INIT("router-msgbox");
+/* depth of each message box, sampled by its owner */
+static LOCKSTAT_QUEUE Msgbox_Stats[MSGBOX_MAX];
+static char Msgbox_Stats_Name[MSGBOX_MAX][16];
+#endif
+
+static struct msgbox *msgbox_get(MSGBOX_ID id)
+{
+    if ((id < 0) || (id >= MSGBOX_MAX)) {
+        return NULL;
+    }
+    if (!__atomic_load_n(&Msgbox[id].used, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    return &Msgbox[id];
+}
+
+MSGBOX_ID create_msgbox(void)
+{
+    MSGBOX_ID msgboxid = INVALID_MSGBOX_ID;
+    struct msgbox *box;
+    unsigned long i;
+    int id;
+
+    LOCKSTAT_MUTEX_LOCK(&Msgbox_Lock, &Msgbox_Lock_Stats);
+    for (id = 0; id < MSGBOX_MAX; id++) {
+        box = &Msgbox[id];
+        if (box->used) {
+            continue;
+        }
+        /* the eventfd is kept when the box is deleted, since a port
+           may still post to it while it shuts down */
+        if (!box->has_event_fd) {
+            box->event_fd = eventfd(0, EFD_CLOEXEC);
+            if (box->event_fd < 0) {
+                break;
+            }
+            box->has_event_fd = true;
+        }
+        box->waiting = 0;
+        box->enqueue_pos = 0;
+        box->dequeue_pos = 0;
+        for (i = 0; i < MSGBOX_RING_SIZE; i++) {
+            box->cell[i].sequence = i;
+        }
+#if defined(BACNET_LOCK_STATISTICS)
+        snprintf(
+            Msgbox_Stats_Name[id], sizeof(Msgbox_Stats_Name[id]),
+            "msgbox-%d", id);
+        Msgbox_Stats[id].name = Msgbox_Stats_Name[id];
+#endif
+        __atomic_store_n(&box->used, 1, __ATOMIC_RELEASE);
+        msgboxid = id;
+        break;
+    }
+    pthread_mutex_unlock(&Msgbox_Lock);
+
+    return msgboxid;
+}
+
+bool send_to_msgbox(MSGBOX_ID dest, BACMSG *msg)
+{
+    struct msgbox *box;
+    struct msgbox_cell *cell;
+    unsigned long pos;
+    unsigned long sequence;
+    long diff;
+    uint64_t one = 1;
+
+    box = msgbox_get(dest);
+    if (!box) {
+        return false;
+    }
+    pos = __atomic_load_n(&box->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        cell = &box->cell[pos & (MSGBOX_RING_SIZE - 1)];
+        sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        diff = (long)(sequence - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(
+                    &box->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* full: dropped, like a datalink which runs out of buffers */
+            return false;
+        } else {
+            pos = __atomic_load_n(&box->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->msg = *msg;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    /* pairs with the fence in recv_from_msgbox(): either the owner sees
+       the message, or this thread sees that the owner waits */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&box->waiting, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n(&box->waiting, 0, __ATOMIC_RELAXED)) {
+        if (write(box->event_fd, &one, sizeof(one)) < 0) {
+            /* only fails if the eventfd counter would overflow */
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Take the next message from a ring message box
+ * @param box - message box owned by the calling thread
+ * @param msg - storage for the message
+ * @return true if a message was taken
+ */
+static bool msgbox_dequeue(struct msgbox *box, BACMSG *msg)
+{
+    struct msgbox_cell *cell;
+    unsigned long pos = box->dequeue_pos;
+
+    cell = &box->cell[pos & (MSGBOX_RING_SIZE - 1)];
+    if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != (pos + 1)) {
+        return false;
+    }
+    *msg = cell->msg;
+    LOCKSTAT_QUEUE_SAMPLE(
+        &Msgbox_Stats[box - Msgbox],
+        (uint32_t)(__atomic_load_n(&box->enqueue_pos, __ATOMIC_RELAXED) -
+                   pos));
+    box->dequeue_pos = pos + 1;
+    __atomic_store_n(
+        &cell->sequence, pos + MSGBOX_RING_SIZE, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+BACMSG *recv_from_msgbox(MSGBOX_ID src, BACMSG *msg, int flags)
+{
+    struct msgbox *box;
+    uint64_t count;
+
+    box = msgbox_get(src);
+    if (!box) {
+        return NULL;
+    }
+    for (;;) {
+        if (msgbox_dequeue(box, msg)) {
+            return msg;
+        }
+        if (flags & IPC_NOWAIT) {
+            return NULL;
+        }
+        __atomic_store_n(&box->waiting, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (msgbox_dequeue(box, msg)) {
+            __atomic_store_n(&box->waiting, 0, __ATOMIC_RELAXED);
+            return msg;
+        }
+        if ((read(box->event_fd, &count, sizeof(count)) < 0) &&
+            (errno != EINTR)) {
+            return NULL;
+        }
+    }
+}
+
+void del_msgbox(MSGBOX_ID msgboxid)
+{
+    if ((msgboxid < 0) || (msgboxid >= MSGBOX_MAX)) {
+        return;
+    }
+    LOCKSTAT_MUTEX_LOCK(&Msgbox_Lock, &Msgbox_Lock_Stats);
+    __atomic_store_n(&Msgbox[msgboxid].used, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&Msgbox_Lock);
+}
+#else
 MSGBOX_ID create_msgbox(void)
 {
     MSGBOX_ID msgboxid;
@@ -59,6 +265,7 @@ void del_msgbox(MSGBOX_ID msgboxid)
         msgctl(msgboxid, IPC_RMID, NULL);
     }
 }
+#endif
 
 void free_data(MSG_DATA *data)
 {
@@ -75,7 +282,7 @@ void free_data(MSG_DATA *data)
 void check_data(MSG_DATA *data)
 {
     /* lock and decrement messages reference count */
-    pthread_mutex_lock(&msg_lock);
+    LOCKSTAT_MUTEX_LOCK(&msg_lock, &Msg_Lock_Stats);
     if (--data->ref_count == 0) {
         free_data(data);
     }
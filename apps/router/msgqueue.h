@@ -23,6 +23,27 @@
 
 extern pthread_mutex_t msg_lock;
 
+/* Pass messages through in-process ring queues instead of SysV message
+   queues, which cost two system calls and a kernel copy per message. */
+#ifndef MSGBOX_RING
+#if defined(__linux__)
+#define MSGBOX_RING 1
+#else
+#define MSGBOX_RING 0
+#endif
+#endif
+
+#if MSGBOX_RING
+/* number of message boxes: one per router port, plus the router's own */
+#ifndef MSGBOX_MAX
+#define MSGBOX_MAX 32
+#endif
+/* number of messages in a message box - must be a power of two */
+#ifndef MSGBOX_RING_SIZE
+#define MSGBOX_RING_SIZE 1024
+#endif
+#endif
+
 #define INVALID_MSGBOX_ID -1
 
 typedef int MSGBOX_ID;
@@ -63,7 +63,13 @@ void *dl_mstp_thread(void *pArgs)
     dlmstp_set_mac_address(&mstp_port, port->route_info.mac[0]);
     dlmstp_set_max_info_frames(&mstp_port, port->params.mstp_params.max_frames);
     dlmstp_set_max_master(&mstp_port, port->params.mstp_params.max_master);
-    if (!dlmstp_init(&mstp_port, port->iface)) {
+    /* the state machines of every MS/TP port run from one shared thread,
+       which is scheduled like the port that starts it */
+    if ((port->sched.priority > 0) || (port->sched.cpu >= 0)) {
+        dlmstp_port_thread_set(port->sched.priority, port->sched.cpu);
+    }
+    if (!dlmstp_port_open(&mstp_port, port->iface) ||
+        !dlmstp_port_attach(&mstp_port)) {
         printf("MSTP %s init failed. Stop.\n", port->iface);
     }
     mstp_port.Treply_timeout = 260;
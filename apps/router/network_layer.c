@@ -76,8 +76,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                     &data->pdu[apdu_offset + 2 * i],
                     &net); /* decode received NET values */
                 add_dnet(
-                    &srcport->route_info, net,
-                    data->src); /* and update routing table */
+                    srcport, net, data->src); /* and update routing table */
             }
             break;
         }
@@ -117,7 +116,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                         &data->pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
-                        &srcport->route_info, net,
+                        srcport, net,
                         data->src); /* and update routing table */
                     if (data->pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
@@ -144,7 +143,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                         &data->pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
-                        &srcport->route_info, net,
+                        srcport, net,
                         data->src); /* and update routing table */
                     if (data->pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
@@ -156,10 +155,36 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             }
             break;
 
+        case NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK:
+        case NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK: {
+            bool busy = (npdu_data.network_message_type ==
+                         NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK);
+            DNET *dnet;
+
+            PRINT(INFO, "Recieved Router-Busy/Available-To-Network message\n");
+            net_count = apdu_len / 2;
+            if (net_count == 0) {
+                /* every network reached through the sending router */
+                dnet = srcport->route_info.dnets;
+                while (dnet != NULL) {
+                    if (dnet->mac_len == data->src.len &&
+                        !memcmp(dnet->mac, data->src.adr, dnet->mac_len)) {
+                        dnet->busy = busy;
+                    }
+                    dnet = dnet->next;
+                }
+            }
+            for (i = 0; i < net_count; i++) {
+                decode_unsigned16(&data->pdu[apdu_offset + 2 * i], &net);
+                dnet = find_dnet_entry(net);
+                if (dnet && dnet->port == srcport) {
+                    dnet->busy = busy;
+                }
+            }
+            break;
+        }
         case NETWORK_MESSAGE_INVALID:
         case NETWORK_MESSAGE_I_COULD_BE_ROUTER_TO_NETWORK:
-        case NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK:
-        case NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK:
         case NETWORK_MESSAGE_ESTABLISH_CONNECTION_TO_NETWORK:
         case NETWORK_MESSAGE_DISCONNECT_CONNECTION_TO_NETWORK:
             /* hell if I know what to do with these messages */
@@ -337,7 +362,9 @@ void send_network_message(
             port = port->next;
             continue;
         }
-        send_to_msgbox(port->port_id, &msg);
+        if (!send_to_msgbox(port->port_id, &msg)) {
+            check_data(data);
+        }
         port = port->next;
     }
 }
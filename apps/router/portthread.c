@@ -27,6 +27,42 @@ ROUTER_PORT *find_snet(MSGBOX_ID id)
     return NULL;
 }
 
+/* index of the networks reached through other routers */
+static DNET *Dnet_Hash[DNET_HASH_SIZE];
+
+static DNET **dnet_hash_bucket(uint16_t net)
+{
+    return &Dnet_Hash[net & (DNET_HASH_SIZE - 1)];
+}
+
+static void dnet_hash_unlink(DNET *dnet)
+{
+    DNET **link = dnet_hash_bucket(dnet->net);
+
+    while (*link) {
+        if (*link == dnet) {
+            *link = dnet->hash_next;
+            break;
+        }
+        link = &(*link)->hash_next;
+    }
+    dnet->hash_next = NULL;
+}
+
+DNET *find_dnet_entry(uint16_t net)
+{
+    DNET *dnet = *dnet_hash_bucket(net);
+
+    while (dnet != NULL) {
+        if (dnet->net == net) {
+            return dnet;
+        }
+        dnet = dnet->hash_next;
+    }
+
+    return NULL;
+}
+
 ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
 {
     ROUTER_PORT *port = head;
@@ -37,60 +73,67 @@ ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
         return port;
     }
 
+    /* check if DNET is directly connected to the router */
     while (port != NULL) {
-        /* check if DNET is directly connected to the router */
         if (net == port->route_info.net) {
             return port;
-
-            /* else search router ports DNET list */
-        } else if (port->route_info.dnets) {
-            dnet = port->route_info.dnets;
-            while (dnet != NULL) {
-                if (net == dnet->net) {
-                    if (addr) {
-                        memmove(&addr->len, &dnet->mac_len, 1);
-                        memmove(&addr->adr[0], &dnet->mac[0], MAX_MAC_LEN);
-                    }
-                    return port;
-                }
-                dnet = dnet->next;
-            }
         }
         port = port->next;
     }
 
+    /* else look up the networks learned from other routers */
+    dnet = find_dnet_entry(net);
+    if (dnet) {
+        if (addr) {
+            memmove(&addr->len, &dnet->mac_len, 1);
+            memmove(&addr->adr[0], &dnet->mac[0], MAX_MAC_LEN);
+        }
+        return dnet->port;
+    }
+
     return NULL;
 }
 
-void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr)
+void add_dnet(ROUTER_PORT *port, uint16_t net, BACNET_ADDRESS addr)
 {
-    DNET *dnet = route_info->dnets;
-    DNET *tmp;
-
-    if (dnet == NULL) {
-        route_info->dnets = (DNET *)malloc(sizeof(DNET));
-        memmove(&route_info->dnets->mac_len, &addr.len, 1);
-        memmove(&route_info->dnets->mac[0], &addr.adr[0], MAX_MAC_LEN);
-        route_info->dnets->net = net;
-        route_info->dnets->state = true;
-        route_info->dnets->next = NULL;
-    } else {
-        while (dnet != NULL) {
-            if (dnet->net == net) { /* make sure NETs are not repeated */
-                return;
-            }
-            tmp = dnet;
-            dnet = dnet->next;
-        }
+    RT_ENTRY *route_info = &port->route_info;
+    DNET *dnet;
+    DNET **link;
 
+    dnet = find_dnet_entry(net);
+    if (dnet) {
+        if (dnet->port == port) { /* make sure NETs are not repeated */
+            return;
+        }
+        /* the network moved to another router port */
+        link = &dnet->port->route_info.dnets;
+        while (*link != dnet) {
+            link = &(*link)->next;
+        }
+        *link = dnet->next;
+    } else {
         dnet = (DNET *)malloc(sizeof(DNET));
-        memmove(&dnet->mac_len, &addr.len, 1);
-        memmove(&dnet->mac[0], &addr.adr[0], MAX_MAC_LEN);
+        if (!dnet) {
+            return;
+        }
         dnet->net = net;
-        dnet->state = true;
-        dnet->next = NULL;
-        tmp->next = dnet;
+        link = dnet_hash_bucket(net);
+        dnet->hash_next = *link;
+        *link = dnet;
+    }
+    memmove(&dnet->mac_len, &addr.len, 1);
+    memmove(&dnet->mac[0], &addr.adr[0], MAX_MAC_LEN);
+    dnet->state = true;
+    dnet->busy = false;
+    dnet->port = port;
+    dnet->next = NULL;
+
+    /* append, to keep the order of I-Am-Router-To-Network */
+    link = &route_info->dnets;
+    while (*link != NULL) {
+        link = &(*link)->next;
     }
+    *link = dnet;
 }
 
 void cleanup_dnets(DNET *dnets)
@@ -98,6 +141,7 @@ void cleanup_dnets(DNET *dnets)
     DNET *dnet = dnets;
     while (dnet != NULL) {
         dnet = dnet->next;
+        dnet_hash_unlink(dnets);
         free(dnets);
         dnets = dnet;
     }
@@ -18,6 +18,8 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/npdu.h"
+/* port specific */
+#include "thread-sched.h"
 /* router utils */
 #include "msgqueue.h"
 
@@ -34,7 +36,7 @@
 #define PRINT(...)
 #endif
 
-typedef enum { BIP = 1, MSTP = 2 } DL_TYPE;
+typedef enum { BIP = 1, MSTP = 2, SHM = 3 } DL_TYPE;
 
 typedef enum { INIT, INIT_FAILED, RUNNING, FINISHED } PORT_STATE;
 
@@ -58,13 +60,23 @@ typedef union _port_params {
     } mstp_params;
 } PORT_PARAMS;
 
+/* number of buckets in the DNET index - must be a power of two */
+#ifndef DNET_HASH_SIZE
+#define DNET_HASH_SIZE 256
+#endif
+
+struct _port;
+
 /* list node for reacheble networks */
 typedef struct _dnet {
     uint8_t mac[MAX_MAC_LEN];
     uint8_t mac_len;
     uint16_t net;
     bool state; /* enabled or disabled */
+    bool busy; /* Router-Busy-To-Network received from the next router */
+    struct _port *port; /* router port the network is reached through */
     struct _dnet *next;
+    struct _dnet *hash_next; /* next node in the DNET index bucket */
 } DNET;
 
 /* information for routing table */
@@ -84,6 +96,7 @@ typedef struct _port {
     PORT_FUNC func;
     RT_ENTRY route_info;
     PORT_PARAMS params;
+    THREAD_SCHED sched; /* scheduling of the port thread */
     struct _port *next; /* pointer to next list node */
 } ROUTER_PORT;
 
@@ -96,8 +109,11 @@ ROUTER_PORT *find_snet(MSGBOX_ID id);
 /* get sending router port */
 ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr);
 
+/* get the routing table entry of a network reached through another router */
+DNET *find_dnet_entry(uint16_t net);
+
 /* add reacheble network for specified router port */
-void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr);
+void add_dnet(ROUTER_PORT *port, uint16_t net, BACNET_ADDRESS addr);
 
 void cleanup_dnets(DNET *dnets);
 
@@ -0,0 +1,926 @@
+/**
+ * @file
+ * @brief Read-through cache of ReadProperty and ReadPropertyMultiple
+ *  replies from the devices on the MS/TP networks of the router
+ *
+ * A confirmed ReadProperty or ReadPropertyMultiple request for a device
+ * on a directly connected MS/TP network is remembered until the device
+ * replies, and an unsegmented ComplexACK is kept for the time to live of
+ * the properties that were read.  The same request from any client is
+ * then answered from the cache, so it never crosses the trunk.
+ *
+ * A WriteProperty forwarded to a device, or a COV notification from it,
+ * drops the cached replies of that object.  Any other request that
+ * changes a device drops all of its cached replies.
+ *
+ * A read that is the same as one already forwarded to the device, from
+ * another client or with another invoke ID, is not forwarded: it waits
+ * for the reply of the first read, which is then sent to each waiting
+ * client with its own invoke ID.  A reply that is segmented or too long
+ * for a waiting client sends that client's request on to the device.
+ * This works for reads that are not cached, too.
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacenum.h"
+#include "bacnet/bactext.h"
+#include "bacnet/basic/sys/bits.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "portthread.h"
+#include "readcache.h"
+
+/* a request of a client and the reply of a device */
+typedef struct read_cache_entry {
+    bool used;
+    /* device: directly connected MS/TP network and MAC address */
+    uint16_t net;
+    uint8_t mac;
+    uint8_t service;
+    /* object that was read, or OBJECT_NONE for many objects */
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    uint8_t request[READ_CACHE_REQUEST_MAX];
+    uint16_t request_len;
+    /* reply after the invoke ID: service choice and service data */
+    uint8_t *ack;
+    uint16_t ack_len;
+    unsigned long expires;
+    unsigned long last_used;
+} READ_CACHE_ENTRY;
+
+/* a read of another client that waits for the reply of a pending read */
+typedef struct read_cache_waiter {
+    BACNET_ADDRESS client;
+    uint8_t invoke_id;
+    int max_apdu;
+    /* the request as received, to forward it if the reply does not fit */
+    MSGBOX_ID origin;
+    MSG_DATA *request;
+} READ_CACHE_WAITER;
+
+/* a read forwarded to a device, waiting for its reply */
+typedef struct read_cache_pending {
+    bool used;
+    /* the device changed since the read was forwarded: the reply is not
+       cached, and no more reads wait for it */
+    bool stale;
+    READ_CACHE_ENTRY key;
+    BACNET_ADDRESS client;
+    uint8_t invoke_id;
+    unsigned long ttl;
+    unsigned long started;
+    READ_CACHE_WAITER waiter[READ_CACHE_WAITER_MAX];
+    unsigned waiters;
+} READ_CACHE_PENDING;
+
+typedef struct read_cache_property_ttl {
+    uint32_t property;
+    unsigned long ttl;
+} READ_CACHE_PROPERTY_TTL;
+
+/* pending reads without a reply are dropped after this many milliseconds */
+#define READ_CACHE_PENDING_TIMEOUT 10000UL
+
+static bool Enabled;
+static unsigned long Default_TTL;
+static READ_CACHE_PROPERTY_TTL Property_TTL[READ_CACHE_PROPERTY_MAX];
+static unsigned Property_TTL_Count;
+static READ_CACHE_ENTRY Entries[READ_CACHE_SIZE];
+static READ_CACHE_PENDING Pending[READ_CACHE_PENDING_MAX];
+
+/**
+ * @brief Check if a time of mstimer_now() has been reached
+ */
+static bool time_reached(unsigned long now, unsigned long when)
+{
+    return (long)(now - when) >= 0;
+}
+
+/**
+ * @brief Get the time to live of the replies that read a property
+ * @param property - property identifier
+ * @return time to live in milliseconds
+ */
+static unsigned long read_cache_ttl(uint32_t property)
+{
+    unsigned i;
+
+    for (i = 0; i < Property_TTL_Count; i++) {
+        if (Property_TTL[i].property == property) {
+            return Property_TTL[i].ttl;
+        }
+    }
+
+    return Default_TTL;
+}
+
+/**
+ * @brief Parse a time in seconds, with an optional fraction
+ * @param str - text of the time
+ * @param ttl - time to live in milliseconds
+ * @return true if the text is a time
+ */
+static bool read_cache_ttl_parse(const char *str, unsigned long *ttl)
+{
+    char *end = NULL;
+    double seconds;
+
+    seconds = strtod(str, &end);
+    if ((end == str) || ((*end != 0) && (*end != ',')) || (seconds < 0.0)) {
+        return false;
+    }
+    *ttl = (unsigned long)(seconds * 1000.0);
+
+    return true;
+}
+
+/**
+ * @brief Enable the cache and set its times to live
+ * @param spec - default time to live in seconds, then optional property
+ *  names or numbers with a time to live of their own, such as
+ *  "5,present-value=1,object-name=3600"; a time of 0 is not cached
+ * @return true if the specification was valid
+ */
+bool read_cache_configure(const char *spec)
+{
+    const char *item;
+    char name[64];
+    uint32_t property = 0;
+    size_t len;
+
+    Property_TTL_Count = 0;
+    Enabled = read_cache_ttl_parse(spec, &Default_TTL);
+    item = strchr(spec, ',');
+    while (Enabled && item) {
+        item++;
+        len = strcspn(item, "=,");
+        if ((item[len] != '=') || (len >= sizeof(name)) ||
+            (Property_TTL_Count >= READ_CACHE_PROPERTY_MAX)) {
+            Enabled = false;
+            break;
+        }
+        memcpy(name, item, len);
+        name[len] = 0;
+        if (!bactext_property_strtol(name, &property) ||
+            !read_cache_ttl_parse(
+                &item[len + 1], &Property_TTL[Property_TTL_Count].ttl)) {
+            Enabled = false;
+            break;
+        }
+        Property_TTL[Property_TTL_Count].property = property;
+        Property_TTL_Count++;
+        item = strchr(item, ',');
+    }
+    if (!Enabled) {
+        PRINT(ERROR, "Error: Invalid read cache %s\n", spec);
+    }
+
+    return Enabled;
+}
+
+/**
+ * @brief Check if the read cache is enabled
+ * @return true if enabled
+ */
+bool read_cache_enabled(void)
+{
+    return Enabled;
+}
+
+/**
+ * @brief Drop a cached reply
+ */
+static void read_cache_entry_free(READ_CACHE_ENTRY *entry)
+{
+    free(entry->ack);
+    entry->ack = NULL;
+    entry->ack_len = 0;
+    entry->used = false;
+}
+
+/**
+ * @brief Drop a pending read, and the requests that wait for its reply
+ */
+static void read_cache_pending_free(READ_CACHE_PENDING *pending)
+{
+    unsigned i;
+
+    for (i = 0; i < pending->waiters; i++) {
+        free_data(pending->waiter[i].request);
+    }
+    pending->waiters = 0;
+    pending->used = false;
+}
+
+/**
+ * @brief Check if two keys are the same request of the same device
+ */
+static bool
+read_cache_key_same(const READ_CACHE_ENTRY *a, const READ_CACHE_ENTRY *b)
+{
+    return (a->net == b->net) && (a->mac == b->mac) &&
+        (a->service == b->service) && (a->request_len == b->request_len) &&
+        (memcmp(a->request, b->request, a->request_len) == 0);
+}
+
+/**
+ * @brief Check if a key reads an object of a device
+ * @param key - request of a device
+ * @param net - network of the device
+ * @param mac - MAC address of the device
+ * @param object_type - object, or OBJECT_NONE for any object
+ * @param object_instance - instance of the object
+ */
+static bool read_cache_key_object(
+    const READ_CACHE_ENTRY *key,
+    uint16_t net,
+    uint8_t mac,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    if ((key->net != net) || (key->mac != mac)) {
+        return false;
+    }
+    if ((object_type == OBJECT_NONE) || (key->object_type == OBJECT_NONE)) {
+        return true;
+    }
+
+    return (key->object_type == object_type) &&
+        (key->object_instance == object_instance);
+}
+
+/**
+ * @brief Drop the cached replies and the pending reads of an object
+ * @param net - network of the device
+ * @param mac - MAC address of the device
+ * @param object_type - object, or OBJECT_NONE for every object
+ * @param object_instance - instance of the object
+ */
+static void read_cache_invalidate(
+    uint16_t net,
+    uint8_t mac,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_SIZE; i++) {
+        if (Entries[i].used &&
+            read_cache_key_object(
+                &Entries[i], net, mac, object_type, object_instance)) {
+            read_cache_entry_free(&Entries[i]);
+        }
+    }
+    /* a reply already on its way may be older than the change, but it
+       still answers the reads that were made before the change */
+    for (i = 0; i < READ_CACHE_PENDING_MAX; i++) {
+        if (Pending[i].used &&
+            read_cache_key_object(
+                &Pending[i].key, net, mac, object_type, object_instance)) {
+            Pending[i].stale = true;
+        }
+    }
+}
+
+/**
+ * @brief Get the object and the time to live of a ReadProperty request
+ * @return true if the request could be decoded
+ */
+static bool read_property_key(READ_CACHE_ENTRY *key, unsigned long *ttl)
+{
+    uint32_t property = 0;
+    int len;
+
+    len = bacnet_object_id_context_decode(
+        key->request, key->request_len, 0, &key->object_type,
+        &key->object_instance);
+    if (len <= 0) {
+        return false;
+    }
+    len = bacnet_enumerated_context_decode(
+        &key->request[len], key->request_len - len, 1, &property);
+    if (len <= 0) {
+        return false;
+    }
+    *ttl = read_cache_ttl(property);
+
+    return true;
+}
+
+/**
+ * @brief Get the shortest time to live of the properties of a
+ *  ReadPropertyMultiple request, which can read many objects
+ * @return true if the request could be decoded
+ */
+static bool read_property_multiple_key(
+    READ_CACHE_ENTRY *key, unsigned long *ttl)
+{
+    BACNET_TAG tag = { 0 };
+    uint32_t property = 0;
+    unsigned long property_ttl;
+    unsigned depth = 0;
+    uint16_t offset = 0;
+    int len;
+
+    key->object_type = OBJECT_NONE;
+    key->object_instance = 0;
+    *ttl = Default_TTL;
+    while (offset < key->request_len) {
+        len = bacnet_tag_decode(
+            &key->request[offset], key->request_len - offset, &tag);
+        if (len <= 0) {
+            return false;
+        }
+        if (tag.opening) {
+            depth++;
+        } else if (tag.closing) {
+            if (depth == 0) {
+                return false;
+            }
+            depth--;
+        } else if ((depth == 1) && tag.context && (tag.number == 0)) {
+            /* propertyIdentifier of a list of property references */
+            len = bacnet_enumerated_context_decode(
+                &key->request[offset], key->request_len - offset, 0,
+                &property);
+            if (len <= 0) {
+                return false;
+            }
+            property_ttl = read_cache_ttl(property);
+            if (property_ttl < *ttl) {
+                *ttl = property_ttl;
+            }
+            offset += len;
+            continue;
+        } else {
+            len += tag.len_value_type;
+        }
+        offset += len;
+    }
+
+    return (depth == 0) && (offset == key->request_len);
+}
+
+/**
+ * @brief Find a free or the least recently used entry for a reply
+ */
+static READ_CACHE_ENTRY *read_cache_entry_slot(const READ_CACHE_ENTRY *key)
+{
+    READ_CACHE_ENTRY *slot = NULL;
+    unsigned long now = mstimer_now();
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_SIZE; i++) {
+        if (!Entries[i].used) {
+            if (!slot || slot->used) {
+                slot = &Entries[i];
+            }
+        } else if (read_cache_key_same(&Entries[i], key)) {
+            return &Entries[i];
+        } else if (time_reached(now, Entries[i].expires)) {
+            read_cache_entry_free(&Entries[i]);
+            if (!slot || slot->used) {
+                slot = &Entries[i];
+            }
+        } else if (
+            !slot ||
+            (slot->used &&
+             ((long)(Entries[i].last_used - slot->last_used) < 0))) {
+            slot = &Entries[i];
+        }
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Find the fresh cached reply of a request
+ */
+static READ_CACHE_ENTRY *read_cache_find(const READ_CACHE_ENTRY *key)
+{
+    unsigned long now = mstimer_now();
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_SIZE; i++) {
+        if (Entries[i].used && read_cache_key_same(&Entries[i], key)) {
+            if (time_reached(now, Entries[i].expires)) {
+                read_cache_entry_free(&Entries[i]);
+                return NULL;
+            }
+            Entries[i].last_used = now;
+            return &Entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Remember a read forwarded to a device until it replies
+ */
+static void read_cache_pending_add(
+    const READ_CACHE_ENTRY *key,
+    const BACNET_ADDRESS *client,
+    uint8_t invoke_id,
+    unsigned long ttl)
+{
+    READ_CACHE_PENDING *slot = NULL;
+    unsigned long now = mstimer_now();
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_PENDING_MAX; i++) {
+        if (!Pending[i].used ||
+            time_reached(
+                now, Pending[i].started + READ_CACHE_PENDING_TIMEOUT)) {
+            slot = &Pending[i];
+            break;
+        }
+    }
+    if (slot) {
+        /* the clients of a read without a reply have given up on it */
+        read_cache_pending_free(slot);
+        slot->used = true;
+        slot->stale = false;
+        slot->key = *key;
+        slot->client = *client;
+        slot->invoke_id = invoke_id;
+        slot->ttl = ttl;
+        slot->started = now;
+    }
+}
+
+/**
+ * @brief Check if two addresses are the same client
+ */
+static bool
+read_cache_client_same(const BACNET_ADDRESS *a, const BACNET_ADDRESS *b)
+{
+    return (a->net == b->net) && (a->len == b->len) &&
+        (memcmp(a->adr, b->adr, a->len) == 0);
+}
+
+/**
+ * @brief Find the pending read of the same request that a new read can
+ *  wait for
+ */
+static READ_CACHE_PENDING *read_cache_pending_find(const READ_CACHE_ENTRY *key)
+{
+    unsigned long now = mstimer_now();
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_PENDING_MAX; i++) {
+        if (Pending[i].used && !Pending[i].stale &&
+            !time_reached(
+                now, Pending[i].started + READ_CACHE_PENDING_TIMEOUT) &&
+            read_cache_key_same(&Pending[i].key, key)) {
+            return &Pending[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Let a read wait for the reply of the same pending read
+ * @param pending - read forwarded to the device
+ * @param msg - message of the read, which the pending read takes
+ * @param client - address of the client that sent the read
+ * @param invoke_id - invoke ID of the read
+ * @param max_apdu - longest APDU that the client accepts
+ * @return true if the read waits, and is not to be forwarded
+ */
+static bool read_cache_pending_wait(
+    READ_CACHE_PENDING *pending,
+    BACMSG *msg,
+    const BACNET_ADDRESS *client,
+    uint8_t invoke_id,
+    int max_apdu)
+{
+    READ_CACHE_WAITER *waiter;
+    unsigned i;
+
+    for (i = 0; i < pending->waiters; i++) {
+        waiter = &pending->waiter[i];
+        if ((waiter->invoke_id == invoke_id) &&
+            read_cache_client_same(&waiter->client, client)) {
+            /* a retry of a read that already waits */
+            free_data((MSG_DATA *)msg->data);
+            msg->data = NULL;
+            return true;
+        }
+    }
+    if (pending->waiters >= READ_CACHE_WAITER_MAX) {
+        return false;
+    }
+    waiter = &pending->waiter[pending->waiters];
+    waiter->client = *client;
+    waiter->invoke_id = invoke_id;
+    waiter->max_apdu = max_apdu;
+    waiter->origin = msg->origin;
+    waiter->request = (MSG_DATA *)msg->data;
+    msg->data = NULL;
+    pending->waiters++;
+
+    return true;
+}
+
+/**
+ * @brief Make a reply of a device to a client, as if the device sent it
+ *  from its port
+ * @param mac - MAC address of the device
+ * @param client - address of the client
+ * @param pdu_type - first octet of the reply APDU
+ * @param invoke_id - invoke ID of the request of the client
+ * @param apdu - rest of the reply APDU, after the invoke ID
+ * @param apdu_len - number of octets in the rest of the reply APDU
+ * @return message data of the reply, or NULL if out of memory
+ */
+static MSG_DATA *read_cache_reply_data(
+    uint8_t mac,
+    const BACNET_ADDRESS *client,
+    uint8_t pdu_type,
+    uint8_t invoke_id,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t npdu[MAX_NPDU];
+    MSG_DATA *data;
+    int npdu_len;
+
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    npdu_len =
+        npdu_encode_pdu(npdu, (BACNET_ADDRESS *)client, NULL, &npdu_data);
+    data = (MSG_DATA *)calloc(1, sizeof(MSG_DATA));
+    if (!data) {
+        return NULL;
+    }
+    data->pdu_len = npdu_len + 2 + apdu_len;
+    data->pdu = (uint8_t *)malloc(data->pdu_len);
+    if (!data->pdu) {
+        free(data);
+        return NULL;
+    }
+    memcpy(data->pdu, npdu, npdu_len);
+    data->pdu[npdu_len] = pdu_type;
+    data->pdu[npdu_len + 1] = invoke_id;
+    memcpy(&data->pdu[npdu_len + 2], apdu, apdu_len);
+    data->src.mac_len = 1;
+    data->src.mac[0] = mac;
+    data->src.len = 1;
+    data->src.adr[0] = mac;
+
+    return data;
+}
+
+/**
+ * @brief Replace a request with the cached reply of the device, as if the
+ *  device sent it from its port
+ * @param msg - request message, which becomes the reply message
+ * @param entry - cached reply
+ * @param client - address of the client that sent the request
+ * @param invoke_id - invoke ID of the request
+ * @param device_port - router port of the device
+ * @return true if the reply replaced the request
+ */
+static bool read_cache_reply(
+    BACMSG *msg,
+    const READ_CACHE_ENTRY *entry,
+    const BACNET_ADDRESS *client,
+    uint8_t invoke_id,
+    const ROUTER_PORT *device_port)
+{
+    MSG_DATA *data;
+
+    data = read_cache_reply_data(
+        entry->mac, client, PDU_TYPE_COMPLEX_ACK, invoke_id, entry->ack,
+        entry->ack_len);
+    if (!data) {
+        return false;
+    }
+    free_data((MSG_DATA *)msg->data);
+    msg->data = data;
+    msg->origin = device_port->port_id;
+
+    return true;
+}
+
+/**
+ * @brief Send the reply of a pending read to the clients that wait for it,
+ *  or their own requests to the device when the reply does not fit them
+ * @param pending - read that got its reply
+ * @param device_port - router port of the device
+ * @param apdu - reply APDU of the device
+ * @param apdu_len - number of octets in the reply APDU
+ */
+static void read_cache_pending_reply(
+    READ_CACHE_PENDING *pending,
+    MSGBOX_ID device_port,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    READ_CACHE_WAITER *waiter;
+    BACMSG msg = { 0 };
+    bool segmented;
+    unsigned i;
+
+    segmented =
+        ((apdu[0] & 0xF0) == PDU_TYPE_COMPLEX_ACK) && (apdu[0] & BIT(3));
+    msg.type = DATA;
+    for (i = 0; i < pending->waiters; i++) {
+        waiter = &pending->waiter[i];
+        if (segmented || (apdu_len > waiter->max_apdu)) {
+            /* the router does not split a reply: the device does it */
+            msg.origin = waiter->origin;
+            msg.data = waiter->request;
+        } else {
+            free_data(waiter->request);
+            msg.origin = device_port;
+            msg.data = read_cache_reply_data(
+                pending->key.mac, &waiter->client, apdu[0], waiter->invoke_id,
+                &apdu[2], apdu_len - 2);
+            if (!msg.data) {
+                continue;
+            }
+        }
+        /* the main loop routes it like a message from the port */
+        if (!send_to_msgbox(head->main_id, &msg)) {
+            free_data((MSG_DATA *)msg.data);
+        }
+    }
+    pending->waiters = 0;
+}
+
+/**
+ * @brief Handle a confirmed request for a device on an MS/TP network
+ * @return true if the read waits for the reply of the same pending read,
+ *  and is not to be routed
+ */
+static bool read_cache_request(
+    BACMSG *msg,
+    const BACNET_ADDRESS *client,
+    const BACNET_ADDRESS *device,
+    const ROUTER_PORT *device_port,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    READ_CACHE_ENTRY key = { 0 };
+    READ_CACHE_ENTRY *entry;
+    READ_CACHE_PENDING *pending;
+    unsigned long ttl = 0;
+    uint8_t invoke_id;
+    int max_apdu;
+
+    /* segmented requests have a longer header, and are not cached */
+    if ((apdu_len < 4) || (apdu[0] & BIT(3))) {
+        return false;
+    }
+    max_apdu = decode_max_apdu(apdu[1]);
+    invoke_id = apdu[2];
+    key.net = device->net;
+    key.mac = device->adr[0];
+    key.service = apdu[3];
+    key.object_type = OBJECT_NONE;
+    switch (key.service) {
+        case SERVICE_CONFIRMED_READ_PROPERTY:
+        case SERVICE_CONFIRMED_READ_PROP_MULTIPLE:
+            break;
+        case SERVICE_CONFIRMED_WRITE_PROPERTY:
+            if (bacnet_object_id_context_decode(
+                    &apdu[4], apdu_len - 4, 0, &key.object_type,
+                    &key.object_instance) <= 0) {
+                key.object_type = OBJECT_NONE;
+            }
+            read_cache_invalidate(
+                key.net, key.mac, key.object_type, key.object_instance);
+            return false;
+        case SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE:
+        case SERVICE_CONFIRMED_ADD_LIST_ELEMENT:
+        case SERVICE_CONFIRMED_REMOVE_LIST_ELEMENT:
+        case SERVICE_CONFIRMED_CREATE_OBJECT:
+        case SERVICE_CONFIRMED_DELETE_OBJECT:
+        case SERVICE_CONFIRMED_DEVICE_COMMUNICATION_CONTROL:
+        case SERVICE_CONFIRMED_REINITIALIZE_DEVICE:
+            read_cache_invalidate(key.net, key.mac, OBJECT_NONE, 0);
+            return false;
+        default:
+            return false;
+    }
+    if ((apdu_len - 4) > READ_CACHE_REQUEST_MAX) {
+        return false;
+    }
+    key.request_len = apdu_len - 4;
+    memcpy(key.request, &apdu[4], key.request_len);
+    entry = read_cache_find(&key);
+    if (entry && ((entry->ack_len + 2) <= max_apdu)) {
+        PRINT(DEBUG, "Read served from the cache\n");
+        read_cache_reply(msg, entry, client, invoke_id, device_port);
+        return false;
+    }
+    if (key.service == SERVICE_CONFIRMED_READ_PROPERTY) {
+        if (!read_property_key(&key, &ttl)) {
+            return false;
+        }
+    } else if (!read_property_multiple_key(&key, &ttl)) {
+        return false;
+    }
+    pending = read_cache_pending_find(&key);
+    if (pending && (pending->invoke_id == invoke_id) &&
+        read_cache_client_same(&pending->client, client)) {
+        /* a retry of the pending read itself */
+        return false;
+    }
+    if (pending &&
+        read_cache_pending_wait(pending, msg, client, invoke_id, max_apdu)) {
+        PRINT(DEBUG, "Read waits for the same pending read\n");
+        return true;
+    }
+    read_cache_pending_add(&key, client, invoke_id, ttl);
+
+    return false;
+}
+
+/**
+ * @brief Handle a reply or a notification from a device on an MS/TP network
+ */
+static void read_cache_device_message(
+    MSGBOX_ID device_port,
+    uint16_t net,
+    uint8_t mac,
+    const BACNET_ADDRESS *client,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    READ_CACHE_PENDING *pending = NULL;
+    READ_CACHE_ENTRY *entry;
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t object_instance = 0;
+    BACNET_UNSIGNED_INTEGER pid = 0;
+    uint16_t offset;
+    uint8_t *ack;
+    uint8_t pdu_type;
+    int len;
+    unsigned i;
+
+    if (apdu_len < 2) {
+        return;
+    }
+    pdu_type = apdu[0] & 0xF0;
+    if (((pdu_type == PDU_TYPE_CONFIRMED_SERVICE_REQUEST) &&
+         (apdu_len >= 4) && !(apdu[0] & BIT(3)) &&
+         (apdu[3] == SERVICE_CONFIRMED_COV_NOTIFICATION)) ||
+        ((pdu_type == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) &&
+         (apdu[1] == SERVICE_UNCONFIRMED_COV_NOTIFICATION))) {
+        /* subscriberProcessIdentifier, initiatingDeviceIdentifier,
+           monitoredObjectIdentifier */
+        offset = (pdu_type == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) ? 2 : 4;
+        len = bacnet_unsigned_context_decode(
+            &apdu[offset], apdu_len - offset, 0, &pid);
+        if (len > 0) {
+            offset += len;
+            len = bacnet_object_id_context_decode(
+                &apdu[offset], apdu_len - offset, 1, &object_type,
+                &object_instance);
+        }
+        if (len > 0) {
+            offset += len;
+            len = bacnet_object_id_context_decode(
+                &apdu[offset], apdu_len - offset, 2, &object_type,
+                &object_instance);
+        }
+        if (len <= 0) {
+            object_type = OBJECT_NONE;
+        }
+        read_cache_invalidate(net, mac, object_type, object_instance);
+        return;
+    }
+    if ((pdu_type != PDU_TYPE_COMPLEX_ACK) &&
+        (pdu_type != PDU_TYPE_SIMPLE_ACK) && (pdu_type != PDU_TYPE_ERROR) &&
+        (pdu_type != PDU_TYPE_REJECT) && (pdu_type != PDU_TYPE_ABORT)) {
+        return;
+    }
+    for (i = 0; i < READ_CACHE_PENDING_MAX; i++) {
+        if (Pending[i].used && (Pending[i].key.net == net) &&
+            (Pending[i].key.mac == mac) && (Pending[i].invoke_id == apdu[1]) &&
+            read_cache_client_same(&Pending[i].client, client)) {
+            pending = &Pending[i];
+            break;
+        }
+    }
+    if (!pending) {
+        return;
+    }
+    read_cache_pending_reply(pending, device_port, apdu, apdu_len);
+    pending->used = false;
+    /* only unsegmented replies are cached */
+    if ((apdu[0] != PDU_TYPE_COMPLEX_ACK) || (apdu_len < 3) ||
+        (apdu[2] != pending->key.service) || pending->stale ||
+        (pending->ttl == 0)) {
+        return;
+    }
+    ack = (uint8_t *)malloc(apdu_len - 2);
+    if (!ack) {
+        return;
+    }
+    entry = read_cache_entry_slot(&pending->key);
+    if (!entry) {
+        free(ack);
+        return;
+    }
+    read_cache_entry_free(entry);
+    *entry = pending->key;
+    entry->used = true;
+    entry->ack = ack;
+    entry->ack_len = apdu_len - 2;
+    memcpy(entry->ack, &apdu[2], entry->ack_len);
+    entry->last_used = mstimer_now();
+    entry->expires = pending->started + pending->ttl;
+}
+
+/**
+ * @brief Look at an APDU routed by the router: remember the reads of the
+ *  devices on MS/TP networks and their replies, drop the replies that
+ *  changes make stale, answer a read from the cache when it can, and let
+ *  a read wait for the same read that is already pending
+ * @param msg - message received from a router port; a read answered
+ *  from the cache is replaced with the reply, as if it was received
+ *  from the port of the device
+ * @return false if the read waits for a pending read: the cache took its
+ *  data, and the message is not routed; true to route the message
+ */
+bool read_cache_process(BACMSG *msg)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_ADDRESS client = { 0 };
+    const MSG_DATA *data = (const MSG_DATA *)msg->data;
+    ROUTER_PORT *srcport;
+    ROUTER_PORT *destport;
+    int apdu_offset;
+
+    if (!Enabled || !data || !data->pdu) {
+        return true;
+    }
+    apdu_offset = bacnet_npdu_decode(
+        data->pdu, data->pdu_len, &dest, &src, &npdu_data);
+    if ((apdu_offset <= 0) || (apdu_offset >= data->pdu_len) ||
+        npdu_data.network_layer_message) {
+        return true;
+    }
+    srcport = find_snet(msg->origin);
+    if (!srcport) {
+        return true;
+    }
+    if ((srcport->type == MSTP) && (data->src.len == 1)) {
+        read_cache_device_message(
+            msg->origin, srcport->route_info.net, data->src.adr[0], &dest,
+            &data->pdu[apdu_offset], data->pdu_len - apdu_offset);
+        return true;
+    }
+    if (((data->pdu[apdu_offset] & 0xF0) !=
+         PDU_TYPE_CONFIRMED_SERVICE_REQUEST) ||
+        (dest.len != 1) || (dest.net == 0) ||
+        (dest.net == BACNET_BROADCAST_NETWORK)) {
+        return true;
+    }
+    destport = find_dnet(dest.net, NULL);
+    if (!destport || (destport->type != MSTP) ||
+        (destport->route_info.net != dest.net)) {
+        return true;
+    }
+    /* the client as the device sees it, in the request that is routed */
+    if ((src.net > 0) && (src.net < BACNET_BROADCAST_NETWORK) &&
+        (src.net != srcport->route_info.net)) {
+        client = src;
+    } else {
+        client = data->src;
+        client.net = srcport->route_info.net;
+    }
+
+    return !read_cache_request(
+        msg, &client, &dest, destport, &data->pdu[apdu_offset],
+        data->pdu_len - apdu_offset);
+}
+
+/**
+ * @brief Drop every cached reply and pending read
+ */
+void read_cache_cleanup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < READ_CACHE_SIZE; i++) {
+        read_cache_entry_free(&Entries[i]);
+    }
+    for (i = 0; i < READ_CACHE_PENDING_MAX; i++) {
+        read_cache_pending_free(&Pending[i]);
+    }
+    memset(Pending, 0, sizeof(Pending));
+}
@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @brief Read-through cache of ReadProperty and ReadPropertyMultiple
+ *  replies from the devices on the MS/TP networks of the router
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef READCACHE_H
+#define READCACHE_H
+
+#include <stdbool.h>
+#include "msgqueue.h"
+
+/* number of cached replies */
+#ifndef READ_CACHE_SIZE
+#define READ_CACHE_SIZE 256
+#endif
+/* longest request service data that is cached, in octets */
+#ifndef READ_CACHE_REQUEST_MAX
+#define READ_CACHE_REQUEST_MAX 64
+#endif
+/* number of reads that can wait for their reply at once */
+#ifndef READ_CACHE_PENDING_MAX
+#define READ_CACHE_PENDING_MAX 64
+#endif
+/* number of reads of other clients that can wait for one pending read */
+#ifndef READ_CACHE_WAITER_MAX
+#define READ_CACHE_WAITER_MAX 8
+#endif
+/* number of properties with a time to live of their own */
+#ifndef READ_CACHE_PROPERTY_MAX
+#define READ_CACHE_PROPERTY_MAX 32
+#endif
+
+bool read_cache_configure(const char *spec);
+
+bool read_cache_enabled(void);
+
+bool read_cache_process(BACMSG *msg);
+
+void read_cache_cleanup(void);
+
+#endif /* end of READCACHE_H */
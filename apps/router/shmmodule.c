@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Datalink shared-memory module, which routes to a virtual
+ *  network of the BACnet processes on this host
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include "shmmodule.h"
+#include "bacnet/datalink/dlshm.h"
+
+void *dl_shm_thread(void *pArgs)
+{
+    ROUTER_PORT *port = (ROUTER_PORT *)pArgs;
+    DLSHM_PORT shm_port = { 0 };
+    BACMSG msg_storage, *bacmsg = NULL;
+    MSG_DATA *msg_data;
+    BACNET_ADDRESS address = { 0 };
+    uint8_t *buff;
+    uint16_t pdu_len;
+    uint8_t shutdown = 0;
+
+    /* initialize router port */
+    if (!dlshm_port_open(&shm_port, port->iface)) {
+        PRINT(ERROR, "Error: Failed to attach to %s\n", port->iface);
+        port->state = INIT_FAILED;
+        return NULL;
+    }
+    port->route_info.mac[0] = shm_port.node;
+    port->route_info.mac_len = 1;
+
+    buff = (uint8_t *)malloc(DLSHM_MPDU_MAX);
+    if (buff == NULL) {
+        dlshm_port_close(&shm_port);
+        port->state = INIT_FAILED;
+        return NULL;
+    }
+
+    port->port_id = create_msgbox();
+    if (port->port_id == INVALID_MSGBOX_ID) {
+        PRINT(ERROR, "Error: Failed to create message box");
+        free(buff);
+        dlshm_port_close(&shm_port);
+        port->state = INIT_FAILED;
+        return NULL;
+    }
+
+    PRINT(INFO, "Shared memory: %s MAC %u\n", port->iface, shm_port.node);
+    port->state = RUNNING;
+
+    while (!shutdown) {
+        /* check for incoming messages */
+        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, IPC_NOWAIT);
+
+        if (bacmsg) {
+            switch (bacmsg->type) {
+                case DATA:
+                    msg_data = (MSG_DATA *)bacmsg->data;
+                    memset(&address, 0, sizeof(address));
+                    address.net = msg_data->dest.net;
+                    address.mac_len = msg_data->dest.len;
+                    memmove(
+                        &address.mac[0], &msg_data->dest.adr[0], MAX_MAC_LEN);
+
+                    dlshm_port_send_pdu(
+                        &shm_port, &address, msg_data->pdu, msg_data->pdu_len);
+
+                    check_data(msg_data);
+
+                    break;
+                case SERVICE:
+                    switch (bacmsg->subtype) {
+                        case SHUTDOWN:
+                            del_msgbox(port->port_id);
+                            shutdown = 1;
+                            break;
+                        default:
+                            break;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        } else {
+            pdu_len = dlshm_port_receive(
+                &shm_port, &address, buff, DLSHM_MPDU_MAX, 5);
+            if (pdu_len > 0) {
+                msg_data = (MSG_DATA *)malloc(sizeof(MSG_DATA));
+                memmove(&msg_data->src, &address, sizeof(BACNET_ADDRESS));
+                msg_data->src.len = address.mac_len;
+                memmove(&msg_data->src.adr[0], &address.mac[0], MAX_MAC_LEN);
+                msg_data->pdu = (uint8_t *)malloc(pdu_len);
+                memmove(msg_data->pdu, buff, pdu_len);
+                msg_data->pdu_len = pdu_len;
+
+                msg_storage.type = DATA;
+                msg_storage.subtype = (MSGSUBTYPE)0;
+                msg_storage.origin = port->port_id;
+                msg_storage.data = msg_data;
+
+                if (!send_to_msgbox(port->main_id, &msg_storage)) {
+                    free_data(msg_data);
+                }
+            }
+        }
+    }
+
+    /* cleanup procedure */
+    free(buff);
+    dlshm_port_close(&shm_port);
+    port->state = FINISHED;
+
+    return NULL;
+}
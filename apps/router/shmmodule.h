@@ -0,0 +1,16 @@
+/**
+ * @file
+ * @brief Datalink shared-memory module
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef SHMMODULE_H
+#define SHMMODULE_H
+
+#include "portthread.h"
+
+void *dl_shm_thread(void *pArgs);
+
+#endif /* end of SHMMODULE_H */
@@ -0,0 +1,392 @@
+/**
+ * @file
+ * @brief Who-Is proxy that answers for the devices on the MS/TP networks
+ *  of the router from the I-Am messages they sent
+ *
+ * The proxy learns the I-Am of every device on a directly connected MS/TP
+ * network.  A Who-Is from another network, global or for an MS/TP
+ * network, is answered with an I-Am on behalf of each device that the
+ * proxy knows, with the MS/TP network and MAC address of the device as
+ * the source, and is kept off the trunk when the trunk has nothing new
+ * to tell:
+ *
+ * - a Who-Is for one device that the proxy knows;
+ * - any Who-Is within the time to live of the last Who-Is for every
+ *   device that was forwarded onto the trunk, since all of the devices
+ *   answered that one.
+ *
+ * Any other Who-Is is forwarded onto the trunk, and the devices answer it
+ * themselves.  A device that the proxy has not heard from for the time to
+ * live is forgotten.
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacenum.h"
+#include "bacnet/iam.h"
+#include "bacnet/whois.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "whoisproxy.h"
+
+/* longest I-Am service data */
+#define WHO_IS_PROXY_I_AM_MAX 24
+
+/* a device on an MS/TP network, and its I-Am */
+typedef struct who_is_proxy_device {
+    bool used;
+    uint16_t net;
+    uint8_t mac;
+    uint32_t device_id;
+    uint8_t i_am[WHO_IS_PROXY_I_AM_MAX];
+    uint8_t i_am_len;
+    unsigned long learned;
+} WHO_IS_PROXY_DEVICE;
+
+/* an MS/TP network, and its last Who-Is for every device */
+typedef struct who_is_proxy_network {
+    uint16_t net;
+    bool swept;
+    unsigned long swept_time;
+} WHO_IS_PROXY_NETWORK;
+
+static bool Enabled;
+static unsigned long TTL;
+static WHO_IS_PROXY_DEVICE Devices[WHO_IS_PROXY_SIZE];
+static WHO_IS_PROXY_NETWORK Networks[WHO_IS_PROXY_NETWORK_MAX];
+static unsigned Network_Count;
+/* MS/TP networks that the message in process is kept off */
+static uint16_t Skip_Net[WHO_IS_PROXY_NETWORK_MAX];
+static unsigned Skip_Count;
+
+/**
+ * @brief Check if a time of mstimer_now() is older than the time to live
+ */
+static bool who_is_proxy_stale(unsigned long now, unsigned long when)
+{
+    return (now - when) >= TTL;
+}
+
+/**
+ * @brief Enable the proxy
+ * @param seconds - time to live of a device that is not heard from, and
+ *  of the answers to a Who-Is for every device
+ * @return true if the time is valid
+ */
+bool who_is_proxy_configure(int seconds)
+{
+    Enabled = (seconds > 0);
+    if (Enabled) {
+        TTL = (unsigned long)seconds * 1000UL;
+    } else {
+        PRINT(ERROR, "Error: Invalid Who-Is proxy time %d\n", seconds);
+    }
+
+    return Enabled;
+}
+
+/**
+ * @brief Check if the Who-Is proxy is enabled
+ * @return true if enabled
+ */
+bool who_is_proxy_enabled(void)
+{
+    return Enabled;
+}
+
+/**
+ * @brief Find an MS/TP network, or add it
+ * @return the network, or NULL if there are too many
+ */
+static WHO_IS_PROXY_NETWORK *who_is_proxy_network(uint16_t net)
+{
+    unsigned i;
+
+    for (i = 0; i < Network_Count; i++) {
+        if (Networks[i].net == net) {
+            return &Networks[i];
+        }
+    }
+    if (Network_Count >= WHO_IS_PROXY_NETWORK_MAX) {
+        return NULL;
+    }
+    Networks[Network_Count].net = net;
+    Networks[Network_Count].swept = false;
+
+    return &Networks[Network_Count++];
+}
+
+/**
+ * @brief Remember the I-Am of a device on an MS/TP network
+ * @param net - network of the device
+ * @param mac - MAC address of the device
+ * @param service - I-Am service data
+ * @param service_len - number of octets of service data
+ */
+static void who_is_proxy_learn(
+    uint16_t net, uint8_t mac, const uint8_t *service, uint16_t service_len)
+{
+    WHO_IS_PROXY_DEVICE *slot = NULL;
+    uint32_t device_id = 0;
+    unsigned long now = mstimer_now();
+    unsigned i;
+    int len;
+
+    len = iam_decode_service_request(service, &device_id, NULL, NULL, NULL);
+    if ((len <= 0) || (len > service_len) || (len > WHO_IS_PROXY_I_AM_MAX)) {
+        return;
+    }
+    for (i = 0; i < WHO_IS_PROXY_SIZE; i++) {
+        if (Devices[i].used && (Devices[i].net == net) &&
+            ((Devices[i].device_id == device_id) || (Devices[i].mac == mac))) {
+            /* the device, or another device that took its address */
+            if (slot) {
+                Devices[i].used = false;
+            } else {
+                slot = &Devices[i];
+            }
+        }
+    }
+    if (!slot) {
+        /* a free or forgotten entry, else the one heard from least lately */
+        slot = &Devices[0];
+        for (i = 0; i < WHO_IS_PROXY_SIZE; i++) {
+            if (!Devices[i].used ||
+                who_is_proxy_stale(now, Devices[i].learned)) {
+                slot = &Devices[i];
+                break;
+            }
+            if ((long)(Devices[i].learned - slot->learned) < 0) {
+                slot = &Devices[i];
+            }
+        }
+    }
+    slot->used = true;
+    slot->net = net;
+    slot->mac = mac;
+    slot->device_id = device_id;
+    memcpy(slot->i_am, service, len);
+    slot->i_am_len = len;
+    slot->learned = now;
+}
+
+/**
+ * @brief Send an I-Am on behalf of a device to the network of a client,
+ *  routed as if the device sent it
+ * @param device - device on an MS/TP network
+ * @param net - network of the client that sent the Who-Is
+ */
+static void who_is_proxy_i_am(const WHO_IS_PROXY_DEVICE *device, uint16_t net)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t npdu[MAX_NPDU];
+    ROUTER_PORT *port;
+    BACMSG msg = { 0 };
+    MSG_DATA *data;
+    int npdu_len;
+
+    data = (MSG_DATA *)calloc(1, sizeof(MSG_DATA));
+    if (!data) {
+        return;
+    }
+    data->dest.net = net;
+    port = find_dnet(net, &data->dest);
+    if (!port) {
+        free(data);
+        return;
+    }
+    src.net = device->net;
+    src.len = 1;
+    src.adr[0] = device->mac;
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    if (port->route_info.net != net) {
+        /* a remote broadcast through the next router */
+        dest.net = net;
+        npdu_len = npdu_encode_pdu(npdu, &dest, &src, &npdu_data);
+    } else {
+        npdu_len = npdu_encode_pdu(npdu, NULL, &src, &npdu_data);
+    }
+    data->pdu_len = npdu_len + 2 + device->i_am_len;
+    data->pdu = (uint8_t *)malloc(data->pdu_len);
+    if (!data->pdu) {
+        free(data);
+        return;
+    }
+    memcpy(data->pdu, npdu, npdu_len);
+    data->pdu[npdu_len] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+    data->pdu[npdu_len + 1] = SERVICE_UNCONFIRMED_I_AM;
+    memcpy(&data->pdu[npdu_len + 2], device->i_am, device->i_am_len);
+    data->ref_count = 1;
+    msg.type = DATA;
+    msg.origin = head->main_id;
+    msg.data = data;
+    if (!send_to_msgbox(port->port_id, &msg)) {
+        free_data(data);
+    }
+}
+
+/**
+ * @brief Answer a Who-Is for the devices of an MS/TP network, if the
+ *  trunk has nothing new to tell
+ * @param net - MS/TP network
+ * @param low_limit - lowest device instance, or -1 for every device
+ * @param high_limit - highest device instance, or -1 for every device
+ * @param client_net - network of the client that sent the Who-Is
+ */
+static void who_is_proxy_answer(
+    uint16_t net, int32_t low_limit, int32_t high_limit, uint16_t client_net)
+{
+    WHO_IS_PROXY_NETWORK *network;
+    WHO_IS_PROXY_DEVICE *device = NULL;
+    unsigned long now = mstimer_now();
+    bool answer;
+    unsigned i;
+
+    network = who_is_proxy_network(net);
+    if (!network) {
+        return;
+    }
+    answer = network->swept && !who_is_proxy_stale(now, network->swept_time);
+    if (!answer && (low_limit >= 0) && (low_limit == high_limit)) {
+        for (i = 0; i < WHO_IS_PROXY_SIZE; i++) {
+            if (Devices[i].used && (Devices[i].net == net) &&
+                (Devices[i].device_id == (uint32_t)low_limit) &&
+                !who_is_proxy_stale(now, Devices[i].learned)) {
+                device = &Devices[i];
+                break;
+            }
+        }
+        answer = (device != NULL);
+    }
+    if (!answer) {
+        /* every device answers it, for the time to live */
+        if (low_limit < 0) {
+            network->swept = true;
+            network->swept_time = now;
+        }
+        return;
+    }
+    for (i = 0; i < WHO_IS_PROXY_SIZE; i++) {
+        device = &Devices[i];
+        if (device->used && (device->net == net) &&
+            !who_is_proxy_stale(now, device->learned) &&
+            ((low_limit < 0) ||
+             ((device->device_id >= (uint32_t)low_limit) &&
+              (device->device_id <= (uint32_t)high_limit)))) {
+            who_is_proxy_i_am(device, client_net);
+        }
+    }
+    Skip_Net[Skip_Count++] = net;
+}
+
+/**
+ * @brief Look at an APDU routed by the router: learn the I-Am of the
+ *  devices on MS/TP networks, and answer a Who-Is for them from another
+ *  network when it can
+ * @param msg - message received from a router port
+ */
+void who_is_proxy_process(BACMSG *msg)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    const MSG_DATA *data = (const MSG_DATA *)msg->data;
+    const uint8_t *apdu;
+    ROUTER_PORT *srcport;
+    ROUTER_PORT *port;
+    int32_t low_limit = -1;
+    int32_t high_limit = -1;
+    uint16_t client_net;
+    int apdu_offset;
+    int apdu_len;
+
+    Skip_Count = 0;
+    if (!Enabled || !data || !data->pdu) {
+        return;
+    }
+    apdu_offset = bacnet_npdu_decode(
+        data->pdu, data->pdu_len, &dest, &src, &npdu_data);
+    if ((apdu_offset <= 0) || ((apdu_offset + 2) > data->pdu_len) ||
+        npdu_data.network_layer_message) {
+        return;
+    }
+    apdu = &data->pdu[apdu_offset];
+    apdu_len = data->pdu_len - apdu_offset;
+    if (apdu[0] != PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) {
+        return;
+    }
+    srcport = find_snet(msg->origin);
+    if (!srcport) {
+        return;
+    }
+    if (srcport->type == MSTP) {
+        if ((apdu[1] == SERVICE_UNCONFIRMED_I_AM) && (data->src.len == 1) &&
+            ((src.net == 0) || (src.net == srcport->route_info.net))) {
+            who_is_proxy_learn(
+                srcport->route_info.net, data->src.adr[0], &apdu[2],
+                apdu_len - 2);
+        }
+        return;
+    }
+    if ((apdu[1] != SERVICE_UNCONFIRMED_WHO_IS) ||
+        (whois_decode_service_request(
+             &apdu[2], apdu_len - 2, &low_limit, &high_limit) < 0)) {
+        return;
+    }
+    /* the client as the devices see it */
+    if ((src.net > 0) && (src.net < BACNET_BROADCAST_NETWORK) &&
+        (src.net != srcport->route_info.net)) {
+        client_net = src.net;
+    } else {
+        client_net = srcport->route_info.net;
+    }
+    if (dest.net == BACNET_BROADCAST_NETWORK) {
+        for (port = head; port; port = port->next) {
+            if ((port->type == MSTP) && (port != srcport)) {
+                who_is_proxy_answer(
+                    port->route_info.net, low_limit, high_limit, client_net);
+            }
+        }
+    } else if ((dest.net > 0) && (dest.len == 0)) {
+        port = find_dnet(dest.net, NULL);
+        if (port && (port->type == MSTP) &&
+            (port->route_info.net == dest.net)) {
+            who_is_proxy_answer(dest.net, low_limit, high_limit, client_net);
+        }
+    }
+}
+
+/**
+ * @brief Check if the message in process is kept off a router port,
+ *  because the proxy answered for the devices behind it
+ * @param port - router port that the message would be sent to
+ * @return true if the message is not sent to the port
+ */
+bool who_is_proxy_skip(const ROUTER_PORT *port)
+{
+    unsigned i;
+
+    for (i = 0; i < Skip_Count; i++) {
+        if (Skip_Net[i] == port->route_info.net) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Forget every device and network
+ */
+void who_is_proxy_cleanup(void)
+{
+    memset(Devices, 0, sizeof(Devices));
+    Network_Count = 0;
+    Skip_Count = 0;
+}
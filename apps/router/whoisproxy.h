@@ -0,0 +1,36 @@
+/**
+ * @file
+ * @brief Who-Is proxy that answers for the devices on the MS/TP networks
+ *  of the router from the I-Am messages they sent
+ *
+ * @section LICENSE
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef WHOISPROXY_H
+#define WHOISPROXY_H
+
+#include <stdbool.h>
+#include "msgqueue.h"
+#include "portthread.h"
+
+/* number of devices that the proxy knows */
+#ifndef WHO_IS_PROXY_SIZE
+#define WHO_IS_PROXY_SIZE 512
+#endif
+/* number of MS/TP networks that the proxy answers for */
+#ifndef WHO_IS_PROXY_NETWORK_MAX
+#define WHO_IS_PROXY_NETWORK_MAX 16
+#endif
+
+bool who_is_proxy_configure(int seconds);
+
+bool who_is_proxy_enabled(void);
+
+void who_is_proxy_process(BACMSG *msg);
+
+bool who_is_proxy_skip(const ROUTER_PORT *port);
+
+void who_is_proxy_cleanup(void);
+
+#endif /* end of WHOISPROXY_H */
@@ -0,0 +1,852 @@
+/**
+ * @file
+ * @brief command line tool that measures how many BACnet/SC nodes and
+ * messages per second a hub sustains.  It connects many simulated nodes
+ * to the hub from one process, each with its own UUID and VMAC, sends
+ * unicast and broadcast traffic between them at configured rates, and
+ * reports the throughput, the latency percentiles, and the connect and
+ * reconnect times of the nodes.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacstr.h"
+#include "bacnet/version.h"
+#include "bacnet/basic/sys/filename.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/datalink/bsc/bvlc-sc.h"
+#include "bacnet/datalink/bsc/bsc-event.h"
+#include "bacnet/datalink/bsc/bsc-socket.h"
+#include "bacnet/datalink/bsc/bsc-hub-connector.h"
+#include "bacnet/datalink/bsc/websocket.h"
+#include "bacport.h"
+
+#ifndef BACDL_BSC
+#error "BACDL_BSC must be defined"
+#endif
+
+/* one simulated node uses one hub connector */
+#define SCBENCH_NODES_MAX BSC_CONF_HUB_CONNECTORS_NUM
+
+/* the NPDU of a benchmark message: version and control octets, then
+   the magic, the kind of message, the sequence number, and the time
+   it was sent */
+#define SCBENCH_MAGIC "SCBM"
+#define SCBENCH_MAGIC_LEN 4
+#define SCBENCH_OFFSET_MAGIC 2
+#define SCBENCH_OFFSET_KIND (SCBENCH_OFFSET_MAGIC + SCBENCH_MAGIC_LEN)
+#define SCBENCH_OFFSET_SEQUENCE (SCBENCH_OFFSET_KIND + 1)
+#define SCBENCH_OFFSET_SENT (SCBENCH_OFFSET_SEQUENCE + 4)
+#define SCBENCH_NPDU_MIN (SCBENCH_OFFSET_SENT + 8)
+
+/* the kinds of traffic */
+enum scbench_kind {
+    SCBENCH_KIND_UNICAST = 0,
+    SCBENCH_KIND_BROADCAST,
+    SCBENCH_KIND_MAX
+};
+
+/* the counters and latencies of one kind of traffic */
+struct scbench_statistics {
+    unsigned long sent;
+    unsigned long busy;
+    unsigned long received;
+    /* latencies, in microseconds */
+    uint32_t *latency;
+    unsigned long latency_count;
+    unsigned long latency_size;
+};
+
+/* a simulated node */
+struct scbench_node {
+    BSC_HUB_CONNECTOR_HANDLE h;
+    BACNET_SC_UUID uuid;
+    BACNET_SC_VMAC_ADDRESS vmac;
+    bool connected;
+    bool stopped;
+    uint64_t start_ns;
+    uint32_t sequence;
+};
+
+static const char *SCBench_Kind_Name[SCBENCH_KIND_MAX] = { "unicast",
+                                                          "broadcast" };
+static struct scbench_statistics SCBench_Statistics[SCBENCH_KIND_MAX];
+/* connect times of the nodes, in microseconds */
+static struct scbench_statistics SCBench_Connect;
+static struct scbench_statistics SCBench_Reconnect;
+static struct scbench_statistics *SCBench_Connecting = &SCBench_Connect;
+static struct scbench_node SCBench_Node[SCBENCH_NODES_MAX];
+static unsigned SCBench_Nodes = 1;
+static unsigned SCBench_Connected;
+static unsigned long SCBench_Duplicated_VMAC;
+
+/* settings of the hub connectors */
+static uint8_t *SCBench_CA_Cert;
+static size_t SCBench_CA_Cert_Size;
+static uint8_t *SCBench_Cert;
+static size_t SCBench_Cert_Size;
+static uint8_t *SCBench_Key;
+static size_t SCBench_Key_Size;
+static char *SCBench_Primary_URL;
+static char *SCBench_Failover_URL;
+static unsigned SCBench_Connect_Timeout_s = 10;
+static unsigned SCBench_Heartbeat_Timeout_s = 300;
+static unsigned SCBench_Disconnect_Timeout_s = 10;
+static unsigned SCBench_Reconnect_Timeout_s = 2;
+
+/**
+ * @brief Get a monotonic time stamp
+ * @return time stamp in nanoseconds
+ */
+static uint64_t scbench_nanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((count.QuadPart * 1000000000.0) / frequency.QuadPart);
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Wait for a millisecond
+ */
+static void scbench_sleep(void)
+{
+#if defined(_WIN32)
+    Sleep(1);
+#else
+    struct timespec delay = { 0, 1000000L };
+
+    nanosleep(&delay, NULL);
+#endif
+}
+
+/**
+ * @brief Record a latency
+ * @param stats - the counters of the traffic
+ * @param start_ns - time stamp of the start
+ */
+static void
+scbench_latency_add(struct scbench_statistics *stats, uint64_t start_ns)
+{
+    uint64_t elapsed = (scbench_nanoseconds() - start_ns) / 1000;
+    uint32_t *latency;
+    unsigned long size;
+
+    if (stats->latency_count >= stats->latency_size) {
+        size = stats->latency_size ? stats->latency_size * 2 : 1024;
+        latency = realloc(stats->latency, size * sizeof(uint32_t));
+        if (!latency) {
+            return;
+        }
+        stats->latency = latency;
+        stats->latency_size = size;
+    }
+    stats->latency[stats->latency_count] =
+        (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+    stats->latency_count++;
+}
+
+/**
+ * @brief Count a received benchmark message
+ * @param npdu - the NPDU of the message
+ * @param npdu_len - length of the NPDU
+ */
+static void scbench_received(const uint8_t *npdu, size_t npdu_len)
+{
+    struct scbench_statistics *stats;
+    uint64_t sent_ns;
+    uint8_t kind;
+
+    if ((npdu_len < SCBENCH_NPDU_MIN) ||
+        (memcmp(
+             &npdu[SCBENCH_OFFSET_MAGIC], SCBENCH_MAGIC, SCBENCH_MAGIC_LEN) !=
+         0)) {
+        return;
+    }
+    kind = npdu[SCBENCH_OFFSET_KIND];
+    if (kind >= SCBENCH_KIND_MAX) {
+        return;
+    }
+    memcpy(&sent_ns, &npdu[SCBENCH_OFFSET_SENT], sizeof(sent_ns));
+    stats = &SCBench_Statistics[kind];
+    stats->received++;
+    scbench_latency_add(stats, sent_ns);
+}
+
+/**
+ * @brief Handle an event of the hub connector of a node.  It is called
+ *  from the websocket thread with the dispatch lock held.
+ */
+static void scbench_hub_connector_event(
+    BSC_HUB_CONNECTOR_EVENT ev,
+    BSC_HUB_CONNECTOR_HANDLE h,
+    void *user_arg,
+    uint8_t *pdu,
+    size_t pdu_len,
+    BVLC_SC_DECODED_MESSAGE *decoded_pdu)
+{
+    struct scbench_node *node = (struct scbench_node *)user_arg;
+
+    (void)h;
+    (void)pdu;
+    (void)pdu_len;
+    if ((ev == BSC_HUBC_EVENT_CONNECTED_PRIMARY) ||
+        (ev == BSC_HUBC_EVENT_CONNECTED_FAILOVER)) {
+        if (!node->connected) {
+            node->connected = true;
+            SCBench_Connected++;
+            scbench_latency_add(SCBench_Connecting, node->start_ns);
+        }
+    } else if (ev == BSC_HUBC_EVENT_ERROR_DUPLICATED_VMAC) {
+        SCBench_Duplicated_VMAC++;
+    } else if (ev == BSC_HUBC_EVENT_STOPPED) {
+        node->stopped = true;
+    } else if (ev == BSC_HUBC_EVENT_RECEIVED) {
+        if (decoded_pdu &&
+            (decoded_pdu->hdr.bvlc_function == BVLC_SC_ENCAPSULATED_NPDU)) {
+            scbench_received(
+                decoded_pdu->payload.encapsulated_npdu.npdu,
+                decoded_pdu->payload.encapsulated_npdu.npdu_len);
+        }
+    }
+}
+
+/**
+ * @brief Start the hub connectors of all the nodes
+ * @return true if all of them started
+ */
+static bool scbench_nodes_start(void)
+{
+    struct scbench_node *node;
+    BSC_SC_RET ret;
+    unsigned i;
+
+    bws_dispatch_lock();
+    SCBench_Connected = 0;
+    for (i = 0; i < SCBench_Nodes; i++) {
+        node = &SCBench_Node[i];
+        node->connected = false;
+        node->stopped = false;
+        node->start_ns = scbench_nanoseconds();
+        ret = bsc_hub_connector_start(
+            SCBench_CA_Cert, SCBench_CA_Cert_Size, SCBench_Cert,
+            SCBench_Cert_Size, SCBench_Key, SCBench_Key_Size, &node->uuid,
+            &node->vmac, BVLC_SC_NPDU_SIZE, BVLC_SC_NPDU_SIZE,
+            SCBench_Connect_Timeout_s, SCBench_Heartbeat_Timeout_s,
+            SCBench_Disconnect_Timeout_s, SCBench_Primary_URL,
+            SCBench_Failover_URL, SCBench_Reconnect_Timeout_s,
+            scbench_hub_connector_event, node, &node->h);
+        if (ret != BSC_SC_SUCCESS) {
+            fprintf(
+                stderr, "node %u: hub connector failed to start (%d)\n", i,
+                (int)ret);
+            node->h = NULL;
+            bws_dispatch_unlock();
+            return false;
+        }
+    }
+    bws_dispatch_unlock();
+
+    return true;
+}
+
+/**
+ * @brief Stop the hub connectors of all the nodes
+ */
+static void scbench_nodes_stop(void)
+{
+    unsigned i;
+
+    for (i = 0; i < SCBench_Nodes; i++) {
+        if (SCBench_Node[i].h) {
+            bsc_hub_connector_stop(SCBench_Node[i].h);
+        }
+    }
+}
+
+/**
+ * @brief Run the timers of the sockets and hub connectors once a second
+ * @param timer - the timer of the maintenance
+ */
+static void scbench_maintenance(struct mstimer *timer)
+{
+    if (mstimer_expired(timer)) {
+        mstimer_reset(timer);
+        bsc_socket_maintenance_timer(1);
+        bsc_hub_connector_maintenance_timer(1);
+    }
+}
+
+/**
+ * @brief Wait until all the nodes are connected, or stopped
+ * @param timeout_ms - how long to wait
+ * @param stopped - true to wait for stopped nodes
+ * @return true if all the nodes got there in time
+ */
+static bool scbench_nodes_wait(unsigned long timeout_ms, bool stopped)
+{
+    struct mstimer maintenance_timer = { 0 };
+    uint64_t start_ns = scbench_nanoseconds();
+    bool done = false;
+    unsigned i;
+
+    mstimer_set(&maintenance_timer, 1000);
+    while (!done) {
+        bws_dispatch_lock();
+        if (stopped) {
+            done = true;
+            for (i = 0; i < SCBench_Nodes; i++) {
+                if (SCBench_Node[i].h && !SCBench_Node[i].stopped) {
+                    done = false;
+                    break;
+                }
+            }
+        } else {
+            done = SCBench_Connected >= SCBench_Nodes;
+        }
+        bws_dispatch_unlock();
+        if (done) {
+            break;
+        }
+        if ((scbench_nanoseconds() - start_ns) / 1000000 > timeout_ms) {
+            return false;
+        }
+        scbench_maintenance(&maintenance_timer);
+        scbench_sleep();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send a benchmark message from a node
+ * @param index - index of the sending node
+ * @param kind - the kind of message
+ * @param npdu_len - length of the NPDU
+ */
+static void
+scbench_send(unsigned index, enum scbench_kind kind, size_t npdu_len)
+{
+    static uint8_t npdu[BVLC_SC_NPDU_SIZE];
+    static uint8_t pdu[BVLC_SC_NPDU_SIZE + 64];
+    struct scbench_statistics *stats = &SCBench_Statistics[kind];
+    struct scbench_node *node = &SCBench_Node[index];
+    BACNET_SC_VMAC_ADDRESS dest;
+    uint64_t sent_ns;
+    unsigned peer;
+    size_t len;
+    BSC_SC_RET ret;
+
+    if (kind == SCBENCH_KIND_BROADCAST) {
+        memset(dest.address, 0xFF, sizeof(dest.address));
+    } else {
+        peer = index;
+        if (SCBench_Nodes > 1) {
+            peer = (index + 1 + (unsigned)rand() % (SCBench_Nodes - 1)) %
+                SCBench_Nodes;
+        }
+        dest = SCBench_Node[peer].vmac;
+    }
+    memset(npdu, 0, npdu_len);
+    npdu[0] = BACNET_PROTOCOL_VERSION;
+    memcpy(&npdu[SCBENCH_OFFSET_MAGIC], SCBENCH_MAGIC, SCBENCH_MAGIC_LEN);
+    npdu[SCBENCH_OFFSET_KIND] = (uint8_t)kind;
+    memcpy(
+        &npdu[SCBENCH_OFFSET_SEQUENCE], &node->sequence,
+        sizeof(node->sequence));
+    node->sequence++;
+    sent_ns = scbench_nanoseconds();
+    memcpy(&npdu[SCBENCH_OFFSET_SENT], &sent_ns, sizeof(sent_ns));
+    len = bvlc_sc_encode_encapsulated_npdu(
+        pdu, sizeof(pdu), bsc_get_next_message_id(), NULL, &dest, npdu,
+        npdu_len);
+    if (len == 0) {
+        return;
+    }
+    ret = bsc_hub_connector_send(node->h, pdu, len);
+    bws_dispatch_lock();
+    if (ret == BSC_SC_SUCCESS) {
+        stats->sent++;
+    } else {
+        stats->busy++;
+    }
+    bws_dispatch_unlock();
+}
+
+static int scbench_latency_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Get a percentile of the sorted latencies, by nearest rank
+ * @param stats - the counters, with sorted latencies
+ * @param permille - the percentile, in tenths of a percent
+ * @return the latency, in microseconds
+ */
+static unsigned long
+scbench_percentile(const struct scbench_statistics *stats, unsigned permille)
+{
+    unsigned long rank;
+
+    if (stats->latency_count == 0) {
+        return 0;
+    }
+    rank = (stats->latency_count * permille + 999) / 1000;
+    if (rank > 0) {
+        rank--;
+    }
+
+    return stats->latency[rank];
+}
+
+/**
+ * @brief Sort the latencies of a statistics
+ * @param stats - the counters
+ */
+static void scbench_sort(struct scbench_statistics *stats)
+{
+    if (stats->latency_count) {
+        qsort(
+            stats->latency, stats->latency_count, sizeof(uint32_t),
+            scbench_latency_compare);
+    }
+}
+
+/**
+ * @brief Print the connect times of the nodes
+ * @param name - name of the connect round
+ * @param stats - the connect times
+ * @param json - true to print a JSON member, false for a table row
+ */
+static void scbench_report_connect(
+    const char *name, struct scbench_statistics *stats, bool json)
+{
+    scbench_sort(stats);
+    if (json) {
+        printf(
+            ",\"%s\":{\"nodes\":%lu,\"p50-ms\":%.1f,\"p99-ms\":%.1f,"
+            "\"max-ms\":%.1f}",
+            name, stats->latency_count,
+            scbench_percentile(stats, 500) / 1000.0,
+            scbench_percentile(stats, 990) / 1000.0,
+            scbench_percentile(stats, 1000) / 1000.0);
+    } else {
+        printf(
+            "%-10s %8lu nodes %10.1f %10.1f %10.1f\n", name,
+            stats->latency_count, scbench_percentile(stats, 500) / 1000.0,
+            scbench_percentile(stats, 990) / 1000.0,
+            scbench_percentile(stats, 1000) / 1000.0);
+    }
+}
+
+/**
+ * @brief Print the report of the run
+ * @param elapsed_ns - duration of the traffic
+ * @param reconnect - true if the nodes were reconnected
+ * @param json - true to print a JSON object, false for a table
+ */
+static void scbench_report(uint64_t elapsed_ns, bool reconnect, bool json)
+{
+    struct scbench_statistics *stats;
+    double seconds = (double)elapsed_ns / 1000000000.0;
+    unsigned long expected;
+    int i, j;
+
+    if (seconds <= 0.0) {
+        seconds = 1.0e-9;
+    }
+    if (json) {
+        printf(
+            "{\"nodes\":%u,\"seconds\":%.3f,\"duplicated-vmac\":%lu",
+            SCBench_Nodes, seconds, SCBench_Duplicated_VMAC);
+    } else {
+        printf(
+            "%u nodes, %.3f s of traffic, %lu duplicated VMAC\n",
+            SCBench_Nodes, seconds, SCBench_Duplicated_VMAC);
+        printf(
+            "%-10s %14s %10s %10s %10s\n", "connect", "", "p50-ms", "p99-ms",
+            "max-ms");
+    }
+    scbench_report_connect("connect", &SCBench_Connect, json);
+    if (reconnect) {
+        scbench_report_connect("reconnect", &SCBench_Reconnect, json);
+    }
+    if (json) {
+        printf(",\"traffic\":[");
+    } else {
+        printf(
+            "%-10s %9s %7s %9s %9s %10s %8s %8s %8s %8s %8s\n", "traffic",
+            "sent", "busy", "received", "lost", "msgs/s", "min-us", "p50-us",
+            "p99-us", "p99.9-us", "max-us");
+    }
+    for (i = 0, j = 0; i < SCBENCH_KIND_MAX; i++) {
+        stats = &SCBench_Statistics[i];
+        if ((stats->sent == 0) && (stats->busy == 0)) {
+            continue;
+        }
+        scbench_sort(stats);
+        expected = stats->sent;
+        if (i == SCBENCH_KIND_BROADCAST) {
+            /* the hub sends a broadcast to all the other nodes */
+            expected = stats->sent * (SCBench_Nodes - 1);
+        }
+        if (json) {
+            printf(
+                "%s{\"traffic\":\"%s\",\"sent\":%lu,\"busy\":%lu,"
+                "\"received\":%lu,\"lost\":%lu,\"messages-per-second\":%.1f,"
+                "\"min-us\":%lu,\"p50-us\":%lu,\"p99-us\":%lu,"
+                "\"p99.9-us\":%lu,\"max-us\":%lu}",
+                j ? "," : "", SCBench_Kind_Name[i], stats->sent, stats->busy,
+                stats->received,
+                (expected > stats->received) ? expected - stats->received : 0,
+                stats->received / seconds, scbench_percentile(stats, 0),
+                scbench_percentile(stats, 500), scbench_percentile(stats, 990),
+                scbench_percentile(stats, 999),
+                scbench_percentile(stats, 1000));
+        } else {
+            printf(
+                "%-10s %9lu %7lu %9lu %9lu %10.1f %8lu %8lu %8lu %8lu %8lu\n",
+                SCBench_Kind_Name[i], stats->sent, stats->busy,
+                stats->received,
+                (expected > stats->received) ? expected - stats->received : 0,
+                stats->received / seconds, scbench_percentile(stats, 0),
+                scbench_percentile(stats, 500), scbench_percentile(stats, 990),
+                scbench_percentile(stats, 999),
+                scbench_percentile(stats, 1000));
+        }
+        j++;
+    }
+    if (json) {
+        printf("]}\n");
+    }
+}
+
+/**
+ * @brief Read a whole file
+ * @param pathname - name of the file
+ * @param size - size of the data, plus one for a key
+ * @param terminate - true to add a terminating zero to the size
+ * @return the data, which the caller frees, or NULL
+ */
+static uint8_t *
+scbench_file_read(const char *pathname, size_t *size, bool terminate)
+{
+    FILE *f;
+    uint8_t *data = NULL;
+    long len;
+
+    if (!pathname) {
+        return NULL;
+    }
+    f = fopen(pathname, "rb");
+    if (!f) {
+        return NULL;
+    }
+    if ((fseek(f, 0, SEEK_END) == 0) && ((len = ftell(f)) > 0) &&
+        (fseek(f, 0, SEEK_SET) == 0)) {
+        data = calloc(1, (size_t)len + 1);
+        if (data && (fread(data, 1, (size_t)len, f) == (size_t)len)) {
+            *size = (size_t)len + (terminate ? 1 : 0);
+        } else {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(f);
+
+    return data;
+}
+
+static void cleanup(void)
+{
+    int i;
+
+    for (i = 0; i < SCBENCH_KIND_MAX; i++) {
+        free(SCBench_Statistics[i].latency);
+        SCBench_Statistics[i].latency = NULL;
+    }
+    free(SCBench_Connect.latency);
+    SCBench_Connect.latency = NULL;
+    free(SCBench_Reconnect.latency);
+    SCBench_Reconnect.latency = NULL;
+    free(SCBench_CA_Cert);
+    SCBench_CA_Cert = NULL;
+    free(SCBench_Cert);
+    SCBench_Cert = NULL;
+    free(SCBench_Key);
+    SCBench_Key = NULL;
+}
+
+static void print_usage(const char *filename)
+{
+    printf("Usage: %s [--nodes N][--rate N][--broadcast-rate N]\n", filename);
+    printf("       [--size N][--duration S][--connect-timeout S]\n");
+    printf("       [--reconnect][--hub URL][--failover URL]\n");
+    printf("       [--ca FILE][--cert FILE][--key FILE][--json]\n");
+    printf("       [--version][--help]\n");
+}
+
+static void print_help(const char *filename)
+{
+    printf("Measure how many BACnet/SC nodes and messages per second\n"
+           "a hub sustains.  The simulated nodes connect to the hub from\n"
+           "this process, each with its own UUID and VMAC, and send\n"
+           "traffic to each other through the hub.\n");
+    printf("\n");
+    printf("--nodes N\n"
+           "Number of simulated nodes, up to %u.  Default is 1.\n",
+           (unsigned)SCBENCH_NODES_MAX);
+    printf("\n");
+    printf("--rate N\n"
+           "Unicast messages per second, from all the nodes together,\n"
+           "each to a random other node.  Default is 100.\n");
+    printf("\n");
+    printf("--broadcast-rate N\n"
+           "Broadcast messages per second, from all the nodes together.\n"
+           "Default is 0.\n");
+    printf("\n");
+    printf("--size N\n"
+           "NPDU length of the messages, from %u to %u.  Default is 64.\n",
+           (unsigned)SCBENCH_NPDU_MIN, (unsigned)BVLC_SC_NPDU_SIZE);
+    printf("\n");
+    printf("--duration S\n"
+           "Send traffic for S seconds.  Default is 10.\n");
+    printf("\n");
+    printf("--connect-timeout S\n"
+           "Time for all the nodes to connect.  Default is 60.\n");
+    printf("\n");
+    printf("--reconnect\n"
+           "After the traffic, stop all the nodes and connect them again,\n"
+           "and report the reconnect times.\n");
+    printf("\n");
+    printf("--json\n"
+           "Print the report as a JSON object.\n");
+    printf("\n");
+    printf("The hub URLs and the certificate files are taken from the\n"
+           "options, or else from the environment variables:\n"
+           "- BACNET_SC_PRIMARY_HUB_URI\n"
+           "- BACNET_SC_FAILOVER_HUB_URI\n"
+           "- BACNET_SC_ISSUER_1_CERTIFICATE_FILE\n"
+           "- BACNET_SC_OPERATIONAL_CERTIFICATE_FILE\n"
+           "- BACNET_SC_OPERATIONAL_CERTIFICATE_PRIVATE_KEY_FILE\n"
+           "For additional information see file bin/bsc-client.sh\n");
+    printf("\n");
+    printf(
+        "Example:\n"
+        "To connect 50 nodes, and send 5000 unicast and 10 broadcast\n"
+        "messages per second for 30 seconds, use the following command:\n"
+        "%s --nodes 50 --rate 5000 --broadcast-rate 10 --duration 30\n",
+        filename);
+}
+
+int main(int argc, char *argv[])
+{
+    struct mstimer maintenance_timer = { 0 };
+    uint64_t start_ns = 0, now_ns = 0, stop_ns = 0;
+    uint64_t duration_ns = 10ULL * 1000000000ULL;
+    unsigned long connect_timeout_ms = 60000;
+    unsigned long rate[SCBENCH_KIND_MAX] = { 100, 0 };
+    unsigned long due = 0;
+    unsigned long count[SCBENCH_KIND_MAX] = { 0 };
+    unsigned long value = 0;
+    unsigned long received = 0, last_received = 0;
+    size_t npdu_len = 64;
+    unsigned sender = 0;
+    bool reconnect = false;
+    bool json = false;
+    const char *ca_file = getenv("BACNET_SC_ISSUER_1_CERTIFICATE_FILE");
+    const char *cert_file = getenv("BACNET_SC_OPERATIONAL_CERTIFICATE_FILE");
+    const char *key_file =
+        getenv("BACNET_SC_OPERATIONAL_CERTIFICATE_PRIVATE_KEY_FILE");
+    const char *filename = NULL;
+    int argi = 0;
+    int i = 0;
+
+    filename = filename_remove_path(argv[0]);
+    SCBench_Primary_URL = getenv("BACNET_SC_PRIMARY_HUB_URI");
+    SCBench_Failover_URL = getenv("BACNET_SC_FAILOVER_HUB_URI");
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--help") == 0) {
+            print_usage(filename);
+            print_help(filename);
+            return 0;
+        }
+        if (strcmp(argv[argi], "--version") == 0) {
+            printf("%s %s\n", filename, BACNET_VERSION_TEXT);
+            printf("Copyright (C) 2022 by Steve Karg and others.\n"
+                   "This is free software; see the source for copying "
+                   "conditions.\n"
+                   "There is NO warranty; not even for MERCHANTABILITY or\n"
+                   "FITNESS FOR A PARTICULAR PURPOSE.\n");
+            return 0;
+        }
+        if (strcmp(argv[argi], "--nodes") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0) || (value > SCBENCH_NODES_MAX)) {
+                fprintf(stderr, "nodes invalid\n");
+                return 1;
+            }
+            SCBench_Nodes = (unsigned)value;
+        } else if (strcmp(argv[argi], "--rate") == 0) {
+            if ((++argi >= argc) ||
+                !bacnet_strtoul(argv[argi], &rate[SCBENCH_KIND_UNICAST])) {
+                fprintf(stderr, "rate invalid\n");
+                return 1;
+            }
+        } else if (strcmp(argv[argi], "--broadcast-rate") == 0) {
+            if ((++argi >= argc) ||
+                !bacnet_strtoul(argv[argi], &rate[SCBENCH_KIND_BROADCAST])) {
+                fprintf(stderr, "broadcast-rate invalid\n");
+                return 1;
+            }
+        } else if (strcmp(argv[argi], "--size") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value < SCBENCH_NPDU_MIN) || (value > BVLC_SC_NPDU_SIZE)) {
+                fprintf(stderr, "size invalid\n");
+                return 1;
+            }
+            npdu_len = (size_t)value;
+        } else if (strcmp(argv[argi], "--duration") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0)) {
+                fprintf(stderr, "duration invalid\n");
+                return 1;
+            }
+            duration_ns = (uint64_t)value * 1000000000ULL;
+        } else if (strcmp(argv[argi], "--connect-timeout") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0)) {
+                fprintf(stderr, "connect-timeout invalid\n");
+                return 1;
+            }
+            connect_timeout_ms = value * 1000UL;
+        } else if (strcmp(argv[argi], "--reconnect") == 0) {
+            reconnect = true;
+        } else if (strcmp(argv[argi], "--hub") == 0) {
+            if (++argi < argc) {
+                SCBench_Primary_URL = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--failover") == 0) {
+            if (++argi < argc) {
+                SCBench_Failover_URL = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--ca") == 0) {
+            if (++argi < argc) {
+                ca_file = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--cert") == 0) {
+            if (++argi < argc) {
+                cert_file = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--key") == 0) {
+            if (++argi < argc) {
+                key_file = argv[argi];
+            }
+        } else if (strcmp(argv[argi], "--json") == 0) {
+            json = true;
+        } else {
+            print_usage(filename);
+            return 1;
+        }
+    }
+    if (!SCBench_Primary_URL || (SCBench_Primary_URL[0] == 0)) {
+        fprintf(stderr, "hub URL is missing\n");
+        return 1;
+    }
+    if (SCBench_Failover_URL && (SCBench_Failover_URL[0] == 0)) {
+        SCBench_Failover_URL = NULL;
+    }
+    atexit(cleanup);
+    SCBench_CA_Cert = scbench_file_read(ca_file, &SCBench_CA_Cert_Size, false);
+    SCBench_Cert = scbench_file_read(cert_file, &SCBench_Cert_Size, false);
+    SCBench_Key = scbench_file_read(key_file, &SCBench_Key_Size, true);
+    if (!SCBench_CA_Cert || !SCBench_Cert || !SCBench_Key) {
+        fprintf(stderr, "certificate or key file can not be read\n");
+        return 1;
+    }
+    for (sender = 0; sender < SCBench_Nodes; sender++) {
+        bsc_generate_random_uuid(&SCBench_Node[sender].uuid);
+        bsc_generate_random_vmac(&SCBench_Node[sender].vmac);
+    }
+    /* connect all the nodes */
+    if (!scbench_nodes_start() ||
+        !scbench_nodes_wait(connect_timeout_ms, false)) {
+        fprintf(
+            stderr, "%u of %u nodes connected in time\n", SCBench_Connected,
+            SCBench_Nodes);
+        scbench_nodes_stop();
+        scbench_nodes_wait(connect_timeout_ms, true);
+        return 1;
+    }
+    /* send the traffic at the configured rates */
+    mstimer_set(&maintenance_timer, 1000);
+    sender = 0;
+    start_ns = scbench_nanoseconds();
+    do {
+        now_ns = scbench_nanoseconds();
+        for (i = 0; i < SCBENCH_KIND_MAX; i++) {
+            due = (unsigned long)(((now_ns - start_ns) / 1000000ULL) *
+                                  rate[i] / 1000ULL);
+            while (count[i] < due) {
+                scbench_send(sender, (enum scbench_kind)i, npdu_len);
+                sender = (sender + 1) % SCBench_Nodes;
+                count[i]++;
+            }
+        }
+        scbench_maintenance(&maintenance_timer);
+        scbench_sleep();
+    } while ((now_ns - start_ns) < duration_ns);
+    stop_ns = now_ns;
+    /* wait for the messages in flight */
+    do {
+        last_received = received;
+        for (i = 0; i < 100; i++) {
+            scbench_maintenance(&maintenance_timer);
+            scbench_sleep();
+        }
+        bws_dispatch_lock();
+        received = SCBench_Statistics[SCBENCH_KIND_UNICAST].received +
+            SCBench_Statistics[SCBENCH_KIND_BROADCAST].received;
+        bws_dispatch_unlock();
+    } while (received != last_received);
+    scbench_nodes_stop();
+    scbench_nodes_wait(connect_timeout_ms, true);
+    if (reconnect) {
+        SCBench_Connecting = &SCBench_Reconnect;
+        if (!scbench_nodes_start() ||
+            !scbench_nodes_wait(connect_timeout_ms, false)) {
+            fprintf(
+                stderr, "%u of %u nodes reconnected in time\n",
+                SCBench_Connected, SCBench_Nodes);
+        }
+        scbench_nodes_stop();
+        scbench_nodes_wait(connect_timeout_ms, true);
+    }
+    scbench_report(stop_ns - start_ns, reconnect, json);
+
+    return 0;
+}
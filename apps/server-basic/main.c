@@ -28,6 +28,10 @@
 #include "bacnet/datalink/dlenv.h"
 
 static const char *Device_Name = "BACnet Smart Sensor (B-SS)";
+/* longest sleep of the BACnet task while idle, in milliseconds */
+#ifndef BACNET_TASK_TIMEOUT
+#define BACNET_TASK_TIMEOUT 1000
+#endif
 #define SENSOR_ID 1
 
 /* table of default point names and units */
@@ -171,6 +175,8 @@ int main(int argc, char *argv[])
     bacnet_basic_task_callback_set(BACnet_Object_Task, NULL);
     bacnet_basic_store_callback_set(BACnet_Basic_Store);
     bacnet_basic_init();
+    /* sleep until a packet arrives or the next timed event is due */
+    bacnet_basic_task_timeout_set(BACNET_TASK_TIMEOUT);
     if (bacnet_port_init()) {
         /* OS based apps use DLENV for environment variables */
         dlenv_init();
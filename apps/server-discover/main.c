@@ -54,6 +54,8 @@ static struct mstimer BACnet_TSM_Timer;
 static struct mstimer BACnet_Print_Timer;
 /* flag to determine if devices or both devices and objects are printed */
 static bool Print_Summary = false;
+/* file name of the discovery snapshot, or NULL if none */
+static const char *Snapshot_Pathname = NULL;
 
 /**
  * @brief Print the list of discovered devices and their objects
@@ -169,6 +171,19 @@ static void bacnet_server_init(void)
     mstimer_set(&BACnet_TSM_Timer, 50);
 }
 
+/**
+ * @brief Save the discovery snapshot, if there is one
+ */
+static void snapshot_save(void)
+{
+    if (Snapshot_Pathname) {
+        if (!bacnet_discover_save(Snapshot_Pathname)) {
+            debug_fprintf(
+                stderr, "%s: unable to save snapshot!\n", Snapshot_Pathname);
+        }
+    }
+}
+
 /**
  * @brief Print the usage information for this application
  */
@@ -176,6 +191,7 @@ static void print_usage(const char *filename)
 {
     printf("Usage: %s [--dnet][--dadr][--mac]\n", filename);
     printf("       [--discover-seconds][--print-seconds][--print-summary]\n");
+    printf("       [--snapshot file]\n");
     printf("       [--version][--help]\n");
 }
 
@@ -191,6 +207,10 @@ static void print_help(const char *filename)
            "Number of seconds to wait before printing list of devices.\n");
     printf("--print-summary:\n"
            "Print only the list of devices.\n");
+    printf("--snapshot file:\n"
+           "Load the discovered devices from the file at start, and save\n"
+           "them to the file each time they are printed.  Devices are only\n"
+           "read again if their Database_Revision or object-list changed.\n");
     printf("\n");
     printf("--dnet N\n"
            "Optional BACnet network number N for directed requests.\n"
@@ -260,6 +280,10 @@ int main(int argc, char *argv[])
             }
         } else if (strcmp(argv[argi], "--print-summary") == 0) {
             Print_Summary = true;
+        } else if (strcmp(argv[argi], "--snapshot") == 0) {
+            if (++argi < argc) {
+                Snapshot_Pathname = argv[argi];
+            }
         } else if (strcmp(argv[argi], "--dnet") == 0) {
             if (++argi < argc) {
                 long_value = strtol(argv[argi], NULL, 0);
@@ -315,6 +339,12 @@ int main(int argc, char *argv[])
     bacnet_discover_seconds_set(discover_seconds);
     bacnet_discover_init();
     atexit(bacnet_discover_cleanup);
+    if (Snapshot_Pathname) {
+        if (!bacnet_discover_load(Snapshot_Pathname)) {
+            debug_fprintf(
+                stderr, "%s: unable to load snapshot.\n", Snapshot_Pathname);
+        }
+    }
     mstimer_set(&BACnet_Print_Timer, print_seconds * 1000UL);
     /* loop forever */
     for (;;) {
@@ -323,6 +353,7 @@ int main(int argc, char *argv[])
         if (mstimer_expired(&BACnet_Print_Timer)) {
             mstimer_reset(&BACnet_Print_Timer);
             print_discovered_devices();
+            snapshot_save();
         }
     }
 
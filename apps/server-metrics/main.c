@@ -0,0 +1,353 @@
+/**
+ * @file
+ * @brief BACnet Stack sample server that exports the stack counters for
+ *  a monitoring system, over HTTP in the Prometheus text format, and as
+ *  periodic JSON snapshots written to a file
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/version.h"
+/* some demo stuff needed */
+#include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/server/bacnet_basic.h"
+#include "bacnet/basic/server/bacnet_metrics.h"
+#include "bacnet/basic/server/bacnet_port.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/object/ai.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/datalink/dlenv.h"
+
+/* default TCP port of the HTTP endpoint */
+#ifndef METRICS_HTTP_PORT
+#define METRICS_HTTP_PORT 9464
+#endif
+/* default seconds between the JSON snapshots */
+#ifndef METRICS_JSON_SECONDS
+#define METRICS_JSON_SECONDS 10
+#endif
+/* longest sleep of the BACnet task while idle, in milliseconds */
+#ifndef BACNET_TASK_TIMEOUT
+#define BACNET_TASK_TIMEOUT 1000
+#endif
+
+static const char *Device_Name = "BACnet Metrics Server";
+#define SENSOR_ID 1
+
+/* listening socket of the HTTP endpoint, or -1 */
+static int HTTP_Socket = -1;
+/* file of the JSON snapshots, or NULL */
+static const char *JSON_Pathname;
+static struct mstimer JSON_Timer;
+/* timer for Sensor Update Interval */
+static struct mstimer Sensor_Update_Timer;
+
+/**
+ * @brief BACnet Project Initialization Handler
+ * @param context [in] The context to pass to the callback function
+ * @note This is called from the BACnet task
+ */
+static void BACnet_Object_Table_Init(void *context)
+{
+    (void)context;
+    Analog_Input_Create(SENSOR_ID);
+    Analog_Input_Name_Set(SENSOR_ID, "Indoor Air Temperature");
+    Analog_Input_Present_Value_Set(SENSOR_ID, 25.0f);
+    Analog_Input_Units_Set(SENSOR_ID, UNITS_DEGREES_CELSIUS);
+    /* start the seconds cyclic timer */
+    mstimer_set(&Sensor_Update_Timer, 1000);
+    srand(0);
+}
+
+/**
+ * @brief BACnet Project Task Handler
+ * @param context [in] The context to pass to the callback function
+ * @note This is called from the BACnet task
+ */
+static void BACnet_Object_Task(void *context)
+{
+    float temperature = 0.0f, change = 0.0f;
+
+    (void)context;
+    if (mstimer_expired(&Sensor_Update_Timer)) {
+        mstimer_reset(&Sensor_Update_Timer);
+        /* simulate a sensor reading, so COV subscribers see changes */
+        if (Analog_Input_Out_Of_Service(SENSOR_ID)) {
+            return;
+        }
+        temperature = Analog_Input_Present_Value(SENSOR_ID);
+        change = -1.0f + 2.0f * ((float)rand()) / RAND_MAX;
+        temperature += change;
+        Analog_Input_Present_Value_Set(SENSOR_ID, temperature);
+    }
+}
+
+/**
+ * @brief Format the metrics into a buffer from the heap
+ * @param json - true for a JSON snapshot, false for Prometheus text
+ * @param length - filled with the length of the text
+ * @return the text, to be freed by the caller, or NULL
+ */
+static char *Metrics_Text(bool json, size_t *length)
+{
+    uint64_t timestamp = (uint64_t)time(NULL);
+    char *text;
+    size_t len;
+
+    if (json) {
+        len = bacnet_metrics_json(NULL, 0, timestamp);
+    } else {
+        len = bacnet_metrics_prometheus(NULL, 0);
+    }
+    text = malloc(len + 1);
+    if (text) {
+        if (json) {
+            len = bacnet_metrics_json(text, len + 1, timestamp);
+        } else {
+            len = bacnet_metrics_prometheus(text, len + 1);
+        }
+        *length = len;
+    }
+
+    return text;
+}
+
+/**
+ * @brief Send all of the data on a socket
+ * @param fd - the socket
+ * @param data - the data
+ * @param length - number of bytes of the data
+ */
+static void HTTP_Send(int fd, const char *data, size_t length)
+{
+    ssize_t sent;
+
+    while (length > 0) {
+        sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            break;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+/**
+ * @brief Open the listening socket of the HTTP endpoint
+ * @param port - TCP port
+ * @return true if the socket is listening
+ */
+static bool HTTP_Init(uint16_t port)
+{
+    struct sockaddr_in address = { 0 };
+    int value = 1;
+    int fd;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if ((bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) ||
+        (listen(fd, 4) < 0) ||
+        (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) < 0)) {
+        close(fd);
+        return false;
+    }
+    HTTP_Socket = fd;
+
+    return true;
+}
+
+/**
+ * @brief Answer a waiting HTTP request, if any: GET /metrics is answered
+ *  with the Prometheus text, and GET /metrics.json with a JSON snapshot
+ */
+static void HTTP_Task(void)
+{
+    struct timeval timeout = { 0, 200000 };
+    char request[512];
+    const char *content_type = NULL;
+    char header[160];
+    char *text = NULL;
+    size_t length = 0;
+    ssize_t received;
+    int header_len;
+    int fd;
+
+    if (HTTP_Socket < 0) {
+        return;
+    }
+    fd = accept(HTTP_Socket, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    /* a scraper sends its whole request at once */
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    received = recv(fd, request, sizeof(request) - 1, 0);
+    if (received > 0) {
+        request[received] = 0;
+        if (strncmp(request, "GET /metrics.json ", 18) == 0) {
+            content_type = "application/json";
+            text = Metrics_Text(true, &length);
+        } else if (strncmp(request, "GET /metrics ", 13) == 0) {
+            content_type = "text/plain; version=0.0.4";
+            text = Metrics_Text(false, &length);
+        }
+        if (text) {
+            header_len = snprintf(
+                header, sizeof(header),
+                "HTTP/1.0 200 OK\r\nContent-Type: %s\r\n"
+                "Content-Length: %lu\r\nConnection: close\r\n\r\n",
+                content_type, (unsigned long)length);
+            HTTP_Send(fd, header, (size_t)header_len);
+            HTTP_Send(fd, text, length);
+            free(text);
+        } else {
+            header_len = snprintf(
+                header, sizeof(header),
+                "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n"
+                "Connection: close\r\n\r\n");
+            HTTP_Send(fd, header, (size_t)header_len);
+        }
+    }
+    close(fd);
+}
+
+/**
+ * @brief Write a JSON snapshot when its period expires.  The snapshot is
+ *  written to a temporary file that is then renamed, so a reader never
+ *  sees a partial snapshot.
+ */
+static void JSON_Task(void)
+{
+    char pathname[256];
+    char *text;
+    size_t length = 0;
+    FILE *file;
+
+    if (!JSON_Pathname || !mstimer_expired(&JSON_Timer)) {
+        return;
+    }
+    mstimer_reset(&JSON_Timer);
+    text = Metrics_Text(true, &length);
+    if (!text) {
+        return;
+    }
+    snprintf(pathname, sizeof(pathname), "%s.tmp", JSON_Pathname);
+    file = fopen(pathname, "w");
+    if (file) {
+        if ((fwrite(text, 1, length, file) == length) && (fclose(file) == 0)) {
+            if (rename(pathname, JSON_Pathname) != 0) {
+                debug_fprintf(
+                    stderr, "Metrics: unable to write %s: %s\n",
+                    JSON_Pathname, strerror(errno));
+            }
+        } else {
+            (void)remove(pathname);
+        }
+    }
+    free(text);
+}
+
+/**
+ * @brief Configure the exporter from the environment
+ */
+static void Metrics_Init(void)
+{
+    unsigned long seconds = METRICS_JSON_SECONDS;
+    unsigned long port = METRICS_HTTP_PORT;
+    const char *pEnv;
+
+    pEnv = getenv("BACNET_METRICS_PORT");
+    if (pEnv) {
+        port = strtoul(pEnv, NULL, 0);
+    }
+    if ((port > 0) && (port <= UINT16_MAX)) {
+        if (HTTP_Init((uint16_t)port)) {
+            debug_printf_stdout(
+                "Metrics: http://0.0.0.0:%lu/metrics\n", port);
+        } else {
+            debug_fprintf(
+                stderr, "Metrics: unable to listen on TCP port %lu: %s\n",
+                port, strerror(errno));
+        }
+    }
+    JSON_Pathname = getenv("BACNET_METRICS_JSON");
+    if (JSON_Pathname) {
+        pEnv = getenv("BACNET_METRICS_JSON_SECONDS");
+        if (pEnv) {
+            seconds = strtoul(pEnv, NULL, 0);
+        }
+        if (seconds == 0) {
+            seconds = METRICS_JSON_SECONDS;
+        }
+        mstimer_set(&JSON_Timer, seconds * 1000UL);
+        debug_printf_stdout(
+            "Metrics: %s every %lus\n", JSON_Pathname, seconds);
+    }
+}
+
+/** Main function of the metrics server demo.
+ *
+ * The exporter is configured from the environment:
+ * BACNET_METRICS_PORT - TCP port of the HTTP endpoint, or 0 for none.
+ * BACNET_METRICS_JSON - file of the JSON snapshots, if any.
+ * BACNET_METRICS_JSON_SECONDS - seconds between the JSON snapshots.
+ *
+ * @param argc [in] Arg count.
+ * @param argv [in] Takes one argument: the Device Instance #.
+ * @return 0 on success.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        /* allow the device ID to be set */
+        Device_Set_Object_Instance_Number(strtol(argv[1], NULL, 0));
+    }
+    if (argc > 2) {
+        /* allow the device name to be set */
+        Device_Name = argv[2];
+    }
+    Device_Object_Name_ANSI_Init(Device_Name);
+    debug_printf_stdout("BACnet Device: %s\n", Device_Name);
+    debug_printf_stdout("BACnet Stack Version %s\n", BACNET_VERSION_TEXT);
+    debug_printf_stdout("BACnet Stack Max APDU: %d\n", MAX_APDU);
+    bacnet_basic_init_callback_set(BACnet_Object_Table_Init, NULL);
+    bacnet_basic_task_callback_set(BACnet_Object_Task, NULL);
+    bacnet_basic_init();
+    /* sleep until a packet arrives or the next timed event is due */
+    bacnet_basic_task_timeout_set(BACNET_TASK_TIMEOUT);
+    if (bacnet_port_init()) {
+        /* OS based apps use DLENV for environment variables */
+        dlenv_init();
+        atexit(datalink_cleanup);
+    }
+    Metrics_Init();
+    debug_printf_stdout("Server: initialized\n");
+    for (;;) {
+        bacnet_basic_task();
+        bacnet_port_task();
+        HTTP_Task();
+        JSON_Task();
+    }
+
+    return 0;
+}
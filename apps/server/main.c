@@ -34,6 +34,8 @@
 #include "bacnet/datetime.h"
 /* include the device object */
 #include "bacnet/basic/object/device.h"
+#include "bacnet/basic/object/ai.h"
+#include "bacnet/basic/object/bi.h"
 /* objects that have tasks inside them */
 #if (BACNET_PROTOCOL_REVISION >= 14)
 #include "bacnet/basic/object/lo.h"
@@ -55,12 +57,26 @@
 #if defined(BAC_UCI)
 #include "bacnet/basic/ucix/ucix.h"
 #endif /* defined(BAC_UCI) */
+#if defined(BACNET_EVENT_LOOP)
+#include "event-loop.h"
+#endif
+#if defined(BACNET_APDU_WORKERS)
+#include "apdu-workers.h"
+#endif
+#if defined(BACNET_APDU_STATISTICS)
+#include <time.h>
+#endif
 
 /* (Doxygen note: The next two lines pull all the following Javadoc
  *  into the ServerDemo module.) */
 /** @addtogroup ServerDemo */
 /*@{*/
 
+/* longest wait for a packet while idle, in milliseconds */
+#ifndef SERVER_IDLE_TIMEOUT
+#define SERVER_IDLE_TIMEOUT 1000
+#endif
+
 /* current version of the BACnet stack */
 static const char *BACnet_Version = BACNET_VERSION_TEXT;
 /* task timer for various BACnet timeouts */
@@ -75,8 +91,13 @@ static struct mstimer BACnet_Notification_Timer;
 #endif
 /* task timer for objects */
 static struct mstimer BACnet_Object_Timer;
+#if defined(BACNET_BIP_BATCH)
+/* packets received in place by the datalink */
+static BACNET_DATALINK_PACKET Rx_Packets[16];
+#else
 /** Buffer used for receiving */
 static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+#endif
 
 /* configure an example structured view object subordinate list */
 #if (BACNET_PROTOCOL_REVISION >= 4)
@@ -155,6 +176,19 @@ static void Structured_View_Update(void)
     Structured_View_Node_Type_Set(instance, BACNET_NODE_ROOM);
 }
 
+/**
+ * @brief Report the change-of-value of an object to the COV subscriptions
+ *  and to the Trend Logs that log the object on change
+ * @param object_type - the object type that changed
+ * @param object_instance - the object instance that changed
+ */
+static void
+Server_Object_Changed(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    handler_cov_object_changed(object_type, object_instance);
+    Trend_Log_Object_Changed(object_type, object_instance);
+}
+
 /** Initialize the handlers we will utilize.
  * @see Device_Init, apdu_set_unconfirmed_handler, apdu_set_confirmed_handler
  */
@@ -164,6 +198,8 @@ static void Init_Service_Handlers(void)
     unsigned int i = 0;
 
     Device_Init(NULL);
+    Analog_Input_Change_Of_Value_Callback_Set(Server_Object_Changed);
+    Binary_Input_Change_Of_Value_Callback_Set(Server_Object_Changed);
     /* create some dynamically created objects as examples */
     object_data.object_instance = BACNET_MAX_INSTANCE;
     for (i = 0; i <= BACNET_OBJECT_TYPE_RESERVED_MIN; i++) {
@@ -209,6 +245,9 @@ static void Init_Service_Handlers(void)
         SERVICE_UNCONFIRMED_YOU_ARE, handler_you_are_json_print);
     apdu_set_confirmed_handler(
         SERVICE_CONFIRMED_SUBSCRIBE_COV, handler_cov_subscribe);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY,
+        handler_cov_subscribe_property);
     apdu_set_unconfirmed_handler(
         SERVICE_UNCONFIRMED_COV_NOTIFICATION, handler_ucov_notification);
     /* handle communication so we can shutup when asked */
@@ -252,7 +291,8 @@ static void Init_Service_Handlers(void)
 static void print_usage(const char *filename)
 {
     printf("Usage: %s [device-instance [device-name]]\n", filename);
-    printf("       [--version][--help]\n");
+    printf("       [--snapshot file][--journal file][--address-cache file]\n"
+           "       [--version][--help]\n");
 }
 
 static void print_help(const char *filename)
@@ -272,14 +312,394 @@ static void print_help(const char *filename)
         "To simulate Device 123 named Fred, use following command:\n"
         "%s 123 Fred\n",
         filename);
+    printf(
+        "--snapshot file:\n"
+        "Restore the objects from the snapshot file at startup,\n"
+        "and save them to the snapshot file when they change.\n"
+        "--journal file:\n"
+        "With --snapshot, restore the writes kept in the journal file\n"
+        "at startup, and append the writes to the journal file instead\n"
+        "of saving the snapshot after each change.\n"
+        "--address-cache file:\n"
+        "Restore the device address bindings from the file at startup,\n"
+        "and save them to the file every minute when they change.\n");
+}
+
+/**
+ * @brief Lock the objects from the APDU worker threads, if any, while
+ *  this thread handles an NPDU or runs a task
+ */
+static void Server_Lock(void)
+{
+#if defined(BACNET_APDU_WORKERS)
+    apdu_workers_lock();
+#endif
+}
+
+/**
+ * @brief Unlock the objects after Server_Lock()
+ */
+static void Server_Unlock(void)
+{
+#if defined(BACNET_APDU_WORKERS)
+    apdu_workers_unlock();
+#endif
+}
+
+/**
+ * @brief Process an NPDU, or queue it for the APDU worker threads
+ * @param src - source address of the NPDU
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes of the NPDU
+ */
+static void
+Server_NPDU_Handler(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
+{
+#if defined(BACNET_APDU_WORKERS)
+    if (apdu_workers_dispatch(src, pdu, pdu_len)) {
+        return;
+    }
+#endif
+    Server_Lock();
+    npdu_handler(src, pdu, pdu_len);
+    Server_Unlock();
+}
+
+/**
+ * @brief Receive and process the NPDUs from the datalink
+ * @param timeout - number of milliseconds to wait for a packet
+ */
+static void Server_Receive(unsigned timeout)
+{
+#if defined(BACNET_BIP_BATCH)
+    unsigned packet_count = 0;
+    unsigned packet_index = 0;
+
+    packet_count =
+        datalink_receive_many(&Rx_Packets[0], ARRAY_SIZE(Rx_Packets), timeout);
+    for (packet_index = 0; packet_index < packet_count; packet_index++) {
+        Server_NPDU_Handler(
+            &Rx_Packets[packet_index].src, Rx_Packets[packet_index].pdu,
+            Rx_Packets[packet_index].pdu_len);
+    }
+#else
+    BACNET_ADDRESS src = { 0 }; /* address where message came from */
+    uint16_t pdu_len = 0;
+
+    pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
+    if (pdu_len) {
+        Server_NPDU_Handler(&src, &Rx_Buf[0], pdu_len);
+    }
+#endif
+}
+
+/**
+ * @brief Shorten a receive timeout to the time left on a task timer
+ * @param timer - the task timer
+ * @param timeout - the receive timeout so far, in milliseconds
+ * @return the shorter of the timeout and the time left on the timer
+ */
+static unsigned long Server_Timer_Timeout(
+    const struct mstimer *timer, unsigned long timeout)
+{
+    unsigned long remaining = 0;
+
+    if (!mstimer_expired(timer)) {
+        remaining = mstimer_remaining(timer);
+    }
+    if (remaining < timeout) {
+        timeout = remaining;
+    }
+
+    return timeout;
+}
+
+/**
+ * @brief Get the time to wait for a packet: until the next task timer is
+ *  due, or not at all while the COV task has work to finish
+ * @return receive timeout in milliseconds
+ */
+static unsigned Server_Receive_Timeout(void)
+{
+    unsigned long timeout = SERVER_IDLE_TIMEOUT;
+
+    if (handler_cov_busy()) {
+        return 0;
+    }
+    timeout = Server_Timer_Timeout(&BACnet_Task_Timer, timeout);
+    if (tsm_transaction_idle_count() < MAX_TSM_TRANSACTIONS) {
+        /* the TSM timer only matters while a transaction is active */
+        timeout = Server_Timer_Timeout(&BACnet_TSM_Timer, timeout);
+    }
+    timeout = Server_Timer_Timeout(&BACnet_Address_Timer, timeout);
+#if defined(INTRINSIC_REPORTING)
+    timeout = Server_Timer_Timeout(&BACnet_Notification_Timer, timeout);
+#endif
+    timeout = Server_Timer_Timeout(&BACnet_Object_Timer, timeout);
+
+    return (unsigned)timeout;
+}
+
+/**
+ * @brief Broadcast an I-Am when the device instance changes
+ */
+static void Server_Device_Task(void)
+{
+    static uint32_t device_id = 0xFFFFFFFF;
+
+    Server_Lock();
+    if (device_id != Device_Object_Instance_Number()) {
+        device_id = Device_Object_Instance_Number();
+        /* update structured view with this device instance */
+        Structured_View_Update();
+        if (Device_Object_Instance_Number() != BACNET_MAX_INSTANCE) {
+            /* broadcast an I-Am on startup */
+            Send_I_Am(&Handler_Transmit_Buffer[0]);
+        }
+    }
+    Server_Unlock();
+}
+
+/**
+ * @brief The 1 second tasks
+ * @param elapsed_milliseconds - time since the previous call
+ */
+static void Server_Seconds_Task(uint32_t elapsed_milliseconds)
+{
+    uint32_t elapsed_seconds = elapsed_milliseconds / 1000;
+#if defined(BACNET_TIME_MASTER)
+    BACNET_DATE_TIME bdatetime;
+#endif
+
+    Server_Lock();
+    dcc_timer_seconds(elapsed_seconds);
+    datalink_maintenance_timer(elapsed_seconds);
+    dlenv_maintenance_timer(elapsed_seconds);
+    handler_cov_timer_seconds(elapsed_seconds);
+    trend_log_timer(elapsed_seconds);
+#if defined(INTRINSIC_REPORTING)
+    Device_local_reporting();
+#endif
+#if defined(BACNET_TIME_MASTER)
+    Device_getCurrentDateTime(&bdatetime);
+    handler_timesync_task(&bdatetime);
+#endif
+    Server_Unlock();
+}
+
+/**
+ * @brief The TSM timeout task, and the delayed I-Am response of Who-Is
+ * @param elapsed_milliseconds - time since the previous call
+ */
+static void Server_TSM_Task(uint32_t elapsed_milliseconds)
+{
+    Server_Lock();
+    tsm_timer_milliseconds(elapsed_milliseconds);
+    handler_who_is_timer_milliseconds(elapsed_milliseconds);
+    Server_Unlock();
+}
+
+/**
+ * @brief The address binding timeout task
+ * @param elapsed_milliseconds - time since the previous call
+ */
+static void Server_Address_Task(uint32_t elapsed_milliseconds)
+{
+    Server_Lock();
+    address_cache_timer(elapsed_milliseconds / 1000);
+    npdu_route_cache_timer(elapsed_milliseconds / 1000);
+    Server_Unlock();
+}
+
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief The notification recipient task
+ * @param elapsed_milliseconds - time since the previous call
+ */
+static void Server_Notification_Task(uint32_t elapsed_milliseconds)
+{
+    (void)elapsed_milliseconds;
+    Server_Lock();
+    Notification_Class_find_recipient();
+    Server_Unlock();
+}
+#endif
+
+/**
+ * @brief The object timer task
+ * @param elapsed_milliseconds - time since the previous call
+ */
+static void Server_Object_Task(uint32_t elapsed_milliseconds)
+{
+    Server_Lock();
+    Device_Timer(elapsed_milliseconds);
+    Device_Snapshot_Timer(elapsed_milliseconds);
+    Server_Unlock();
+}
+
+/**
+ * @brief The change of value task
+ */
+static void Server_COV_Task(void)
+{
+    Server_Lock();
+    handler_cov_task();
+    Server_Unlock();
+}
+
+#if defined(BACNET_APDU_WORKERS)
+/**
+ * @brief Get the number of APDU worker threads from the environment
+ * @return the BACNET_APDU_WORKERS variable, or 0 for one per processor
+ */
+static unsigned Server_APDU_Workers(void)
+{
+    const char *pEnv = getenv("BACNET_APDU_WORKERS");
+
+    if (pEnv) {
+        return (unsigned)strtoul(pEnv, NULL, 0);
+    }
+
+    return 0;
+}
+#endif
+
+#if defined(BACNET_APDU_STATISTICS)
+/**
+ * @brief The clock for the APDU handler times
+ * @return the processor time of the server in microseconds
+ */
+static uint32_t Server_APDU_Clock(void)
+{
+    return (uint32_t)((unsigned long long)clock() * 1000000ULL /
+                      CLOCKS_PER_SEC);
 }
 
+/**
+ * @brief Print the statistics of one service, if it was requested
+ * @param name - name of the service
+ * @param stats - statistics of the service
+ */
+static void Server_APDU_Statistics_Print(
+    const char *name, const APDU_SERVICE_STATISTICS *stats)
+{
+    unsigned long mean = 0;
+
+    if (stats->requests == 0) {
+        return;
+    }
+    if (stats->handled) {
+        mean = (unsigned long)(stats->time_total / stats->handled);
+    }
+    fprintf(
+        stderr,
+        "%s: requests=%lu dropped=%lu time-mean=%luus time-max=%luus "
+        "replies=%lu octets-max=%lu errors=%lu rejects=%lu aborts=%lu\n",
+        name, (unsigned long)stats->requests, (unsigned long)stats->dcc_drops,
+        mean, (unsigned long)stats->time_max, (unsigned long)stats->replies,
+        (unsigned long)stats->reply_octets_max, (unsigned long)stats->errors,
+        (unsigned long)stats->rejects, (unsigned long)stats->aborts);
+}
+
+/**
+ * @brief Print the APDU handler statistics of the services at exit
+ */
+static void Server_APDU_Statistics(void)
+{
+    APDU_SERVICE_STATISTICS stats;
+    unsigned i;
+
+    for (i = 0; i < MAX_BACNET_CONFIRMED_SERVICE; i++) {
+        if (apdu_statistics_confirmed(i, &stats)) {
+            Server_APDU_Statistics_Print(
+                bactext_confirmed_service_name(i), &stats);
+        }
+    }
+    for (i = 0; i < MAX_BACNET_UNCONFIRMED_SERVICE; i++) {
+        if (apdu_statistics_unconfirmed(i, &stats)) {
+            Server_APDU_Statistics_Print(
+                bactext_unconfirmed_service_name(i), &stats);
+        }
+    }
+}
+
+/**
+ * @brief Exit on a signal, so the statistics are printed
+ * @param signo - the signal number
+ */
+static void Server_APDU_Statistics_Signal(int signo)
+{
+    (void)signo;
+    exit(0);
+}
+#endif
+
+#if defined(BACNET_EVENT_LOOP)
+/**
+ * @brief Receive from a datalink socket that is ready to read
+ * @param fd - the datalink socket
+ */
+static void Server_Datalink_Event(int fd)
+{
+    (void)fd;
+    /* the socket is ready, so the datalink select does not wait */
+    Server_Receive(0);
+}
+
+/**
+ * @brief Add the datalink sockets and the cyclic timers to the event loop
+ * @return true if the event loop can run, or false to poll the datalink
+ */
+static bool Server_Event_Loop_Init(void)
+{
+    bool status = false;
+
+    if (!event_loop_init()) {
+        return false;
+    }
+#if defined(BACDL_BIP)
+    if (event_loop_fd_add(bip_get_socket(), Server_Datalink_Event)) {
+        status = true;
+        if (bip_get_broadcast_socket() != bip_get_socket()) {
+            event_loop_fd_add(
+                bip_get_broadcast_socket(), Server_Datalink_Event);
+        }
+    }
+#endif
+#if defined(BACDL_BIP6)
+    if (event_loop_fd_add(bip6_get_socket(), Server_Datalink_Event)) {
+        status = true;
+    }
+#endif
+    if (!status) {
+        /* no datalink socket to wait on */
+        event_loop_cleanup();
+        return false;
+    }
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Task_Timer), Server_Seconds_Task);
+    event_loop_timer_add(mstimer_interval(&BACnet_TSM_Timer), Server_TSM_Task);
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Address_Timer), Server_Address_Task);
+#if defined(INTRINSIC_REPORTING)
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Notification_Timer),
+        Server_Notification_Task);
+#endif
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Object_Timer), Server_Object_Task);
+
+    return true;
+}
+#endif
+
 /** Main function of server demo.
  *
  * @see Device_Set_Object_Instance_Number, dlenv_init, Send_I_Am,
  *      datalink_receive, npdu_handler,
  *      dcc_timer_seconds, datalink_maintenance_timer,
- *      handler_cov_task, tsm_timer_milliseconds
+ *      handler_cov_task, tsm_timer_milliseconds,
+ *      handler_who_is_timer_milliseconds
  *
  * @param argc [in] Arg count.
  * @param argv [in] Takes one argument: the Device Instance #.
@@ -287,22 +707,16 @@ static void print_help(const char *filename)
  */
 int main(int argc, char *argv[])
 {
-    BACNET_ADDRESS src = { 0 }; /* address where message came from */
-    uint16_t pdu_len = 0;
-    unsigned timeout = 1; /* milliseconds */
-    uint32_t elapsed_milliseconds = 0;
-    uint32_t elapsed_seconds = 0;
     BACNET_CHARACTER_STRING DeviceName;
-    uint32_t device_id = 0xFFFFFFFF;
-#if defined(BACNET_TIME_MASTER)
-    BACNET_DATE_TIME bdatetime;
-#endif
 #if defined(BAC_UCI)
     int uciId = 0;
     struct uci_context *ctx;
 #endif
     int argi = 0;
     const char *filename = NULL;
+    const char *snapshot_pathname = NULL;
+    const char *journal_pathname = NULL;
+    const char *address_cache_pathname = NULL;
 
     filename = filename_remove_path(argv[0]);
     for (argi = 1; argi < argc; argi++) {
@@ -320,6 +734,21 @@ int main(int argc, char *argv[])
                    "FITNESS FOR A PARTICULAR PURPOSE.\n");
             return 0;
         }
+        if (strcmp(argv[argi], "--snapshot") == 0) {
+            if (++argi < argc) {
+                snapshot_pathname = argv[argi];
+            }
+        }
+        if (strcmp(argv[argi], "--journal") == 0) {
+            if (++argi < argc) {
+                journal_pathname = argv[argi];
+            }
+        }
+        if (strcmp(argv[argi], "--address-cache") == 0) {
+            if (++argi < argc) {
+                address_cache_pathname = argv[argi];
+            }
+        }
     }
 #if defined(BAC_UCI)
     ctx = ucix_init("bacnet_dev");
@@ -332,7 +761,7 @@ int main(int argc, char *argv[])
     } else {
 #endif /* defined(BAC_UCI) */
         /* allow the device ID to be set */
-        if (argc > 1) {
+        if ((argc > 1) && (argv[1][0] != '-')) {
             Device_Set_Object_Instance_Number(strtol(argv[1], NULL, 0));
         }
 
@@ -350,6 +779,14 @@ int main(int argc, char *argv[])
     /* load any static address bindings to show up
        in our device bindings list */
     address_init();
+    if (address_cache_pathname) {
+        if (address_cache_restore(address_cache_pathname)) {
+            printf(
+                "BACnet Address Cache: %s restored\n",
+                address_cache_pathname);
+        }
+        address_cache_snapshot_set(address_cache_pathname, 60);
+    }
     Init_Service_Handlers();
     /* initialize timesync callback function. */
     handler_timesync_set_callback_set(&datetime_timesync);
@@ -365,18 +802,42 @@ int main(int argc, char *argv[])
         Device_Object_Name_ANSI_Init(uciname);
     } else {
 #endif /* defined(BAC_UCI) */
-        if (argc > 2) {
+        if ((argc > 2) && (argv[1][0] != '-') && (argv[2][0] != '-')) {
             Device_Object_Name_ANSI_Init(argv[2]);
         }
 #if defined(BAC_UCI)
     }
     ucix_cleanup(ctx);
 #endif /* defined(BAC_UCI) */
+    if (snapshot_pathname) {
+        if (Device_Snapshot_Load(snapshot_pathname)) {
+            printf("BACnet Snapshot: %s restored\n", snapshot_pathname);
+        }
+        if (journal_pathname &&
+            Device_Snapshot_Journal_Load(journal_pathname)) {
+            printf("BACnet Journal: %s restored\n", journal_pathname);
+        }
+        Device_Snapshot_Pathname_Set(snapshot_pathname);
+        Device_Snapshot_Journal_Set(journal_pathname);
+        Device_Write_Property_Store_Callback_Set(
+            Device_Snapshot_Write_Property_Store);
+    }
     if (Device_Object_Name(Device_Object_Instance_Number(), &DeviceName)) {
         printf("BACnet Device Name: %s\n", DeviceName.value);
     }
     dlenv_init();
     atexit(datalink_cleanup);
+#if defined(BACNET_APDU_STATISTICS)
+    apdu_statistics_clock_set(Server_APDU_Clock);
+    atexit(Server_APDU_Statistics);
+    signal(SIGINT, Server_APDU_Statistics_Signal);
+    signal(SIGTERM, Server_APDU_Statistics_Signal);
+#endif
+#if defined(BACNET_APDU_WORKERS)
+    if (apdu_workers_init(Server_APDU_Workers())) {
+        atexit(apdu_workers_cleanup);
+    }
+#endif
 #if BACNET_PROTOCOL_REVISION >= 22
     if (Device_Object_Instance_Number() == BACNET_MAX_INSTANCE) {
         apdu_set_unconfirmed_handler(
@@ -388,66 +849,46 @@ int main(int argc, char *argv[])
             Device_Vendor_Identifier(), Device_Model_Name(),
             Device_Serial_Number());
     }
+#endif
+#if defined(BACNET_EVENT_LOOP)
+    if (Server_Event_Loop_Init()) {
+        /* wait for the datalink or the next timer, with no polling */
+        for (;;) {
+            Server_Device_Task();
+            event_loop_run_once(-1);
+            Server_COV_Task();
+        }
+    }
 #endif
     /* loop forever */
     for (;;) {
-        if (device_id != Device_Object_Instance_Number()) {
-            device_id = Device_Object_Instance_Number();
-            /* update structured view with this device instance */
-            Structured_View_Update();
-            if (Device_Object_Instance_Number() != BACNET_MAX_INSTANCE) {
-                /* broadcast an I-Am on startup */
-                Send_I_Am(&Handler_Transmit_Buffer[0]);
-            }
-        }
+        Server_Device_Task();
         /* input */
-        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
-
-        /* process */
-        if (pdu_len) {
-            npdu_handler(&src, &Rx_Buf[0], pdu_len);
-        }
+        Server_Receive(Server_Receive_Timeout());
         if (mstimer_expired(&BACnet_Task_Timer)) {
             mstimer_reset(&BACnet_Task_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Task_Timer);
-            elapsed_seconds = elapsed_milliseconds / 1000;
-            /* 1 second tasks */
-            dcc_timer_seconds(elapsed_seconds);
-            datalink_maintenance_timer(elapsed_seconds);
-            dlenv_maintenance_timer(elapsed_seconds);
-            handler_cov_timer_seconds(elapsed_seconds);
-            trend_log_timer(elapsed_seconds);
-#if defined(INTRINSIC_REPORTING)
-            Device_local_reporting();
-#endif
-#if defined(BACNET_TIME_MASTER)
-            Device_getCurrentDateTime(&bdatetime);
-            handler_timesync_task(&bdatetime);
-#endif
+            Server_Seconds_Task(mstimer_interval(&BACnet_Task_Timer));
         }
         if (mstimer_expired(&BACnet_TSM_Timer)) {
             mstimer_reset(&BACnet_TSM_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_TSM_Timer);
-            tsm_timer_milliseconds(elapsed_milliseconds);
+            Server_TSM_Task(mstimer_interval(&BACnet_TSM_Timer));
         }
         if (mstimer_expired(&BACnet_Address_Timer)) {
             mstimer_reset(&BACnet_Address_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Address_Timer);
-            elapsed_seconds = elapsed_milliseconds / 1000;
-            address_cache_timer(elapsed_seconds);
+            Server_Address_Task(mstimer_interval(&BACnet_Address_Timer));
         }
-        handler_cov_task();
+        Server_COV_Task();
 #if defined(INTRINSIC_REPORTING)
         if (mstimer_expired(&BACnet_Notification_Timer)) {
             mstimer_reset(&BACnet_Notification_Timer);
-            Notification_Class_find_recipient();
+            Server_Notification_Task(
+                mstimer_interval(&BACnet_Notification_Timer));
         }
 #endif
         /* output */
         if (mstimer_expired(&BACnet_Object_Timer)) {
             mstimer_reset(&BACnet_Object_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Object_Timer);
-            Device_Timer(elapsed_milliseconds);
+            Server_Object_Task(mstimer_interval(&BACnet_Object_Timer));
         }
     }
 
@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -35,6 +36,10 @@
 
 /* buffer used for receive */
 static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+#if defined(BACNET_BIP_BATCH)
+/* packets received at once in collection mode */
+static BACNET_DATALINK_PACKET Rx_Packets[16];
+#endif
 
 /* global variables used in this file */
 static int32_t Target_Object_Instance_Min = -1;
@@ -45,60 +50,148 @@ static bool BACnet_Debug_Enabled;
 
 #define BAC_ADDRESS_MULT 1
 
+/* socket receive buffer for collection mode, so that the I-Am replies
+   of thousands of devices answering together are not dropped */
+#ifndef WHOIS_COLLECT_RCVBUF
+#define WHOIS_COLLECT_RCVBUF (8UL * 1024UL * 1024UL)
+#endif
+
+/* output format of the devices found */
+enum print_format { PRINT_FORMAT_TEXT, PRINT_FORMAT_JSON, PRINT_FORMAT_CSV };
+static enum print_format Print_Format = PRINT_FORMAT_TEXT;
+/* collection mode: large receive buffer, batched receive, sorted dump */
+static bool Collect_Mode;
+
 struct address_entry {
-    struct address_entry *next;
     uint8_t Flags;
     uint32_t device_id;
     unsigned max_apdu;
+    int segmentation;
+    uint16_t vendor_id;
     BACNET_ADDRESS address;
+    /* next entry index+1 with the same device hash, or 0 */
+    unsigned next;
 };
 
+/* the responders, in the order they answered, with a hash index by
+   device instance to find the duplicates */
 static struct address_table {
-    struct address_entry *first;
-    struct address_entry *last;
+    struct address_entry *entry;
+    unsigned count;
+    unsigned size;
+    unsigned *bucket;
+    /* number of buckets - a power of two */
+    unsigned bucket_count;
 } Address_Table = { 0 };
 
-static struct address_entry *alloc_address_entry(void)
+static unsigned address_table_hash(uint32_t device_id)
 {
-    struct address_entry *rval;
-    rval = (struct address_entry *)calloc(1, sizeof(struct address_entry));
-    if (Address_Table.first == 0) {
-        Address_Table.first = Address_Table.last = rval;
-    } else {
-        Address_Table.last->next = rval;
-        Address_Table.last = rval;
+    return (device_id * 2654435761UL) & (Address_Table.bucket_count - 1);
+}
+
+/**
+ * @brief Double the size of the address table and its hash index
+ * @return true if the table has room for another entry
+ */
+static bool address_table_grow(void)
+{
+    struct address_entry *entry;
+    unsigned *bucket;
+    unsigned size, i, hash;
+
+    size = Address_Table.size ? Address_Table.size * 2 : 256;
+    entry = realloc(Address_Table.entry, size * sizeof(*entry));
+    if (!entry) {
+        return false;
+    }
+    Address_Table.entry = entry;
+    bucket = calloc(size, sizeof(*bucket));
+    if (!bucket) {
+        return false;
     }
-    return rval;
+    free(Address_Table.bucket);
+    Address_Table.bucket = bucket;
+    Address_Table.bucket_count = size;
+    Address_Table.size = size;
+    for (i = 0; i < Address_Table.count; i++) {
+        hash = address_table_hash(Address_Table.entry[i].device_id);
+        Address_Table.entry[i].next = Address_Table.bucket[hash];
+        Address_Table.bucket[hash] = i + 1;
+    }
+
+    return true;
 }
 
 static void address_table_add(
-    uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
+    uint32_t device_id,
+    unsigned max_apdu,
+    int segmentation,
+    uint16_t vendor_id,
+    const BACNET_ADDRESS *src)
 {
     struct address_entry *pMatch;
+    unsigned link, hash;
     uint8_t flags = 0;
 
-    pMatch = Address_Table.first;
-    while (pMatch) {
-        if (pMatch->device_id == device_id) {
-            if (bacnet_address_same(&pMatch->address, src)) {
-                return;
+    if (Address_Table.bucket_count) {
+        link = Address_Table.bucket[address_table_hash(device_id)];
+        while (link) {
+            pMatch = &Address_Table.entry[link - 1];
+            if (pMatch->device_id == device_id) {
+                if (bacnet_address_same(&pMatch->address, src)) {
+                    return;
+                }
+                flags |= BAC_ADDRESS_MULT;
+                pMatch->Flags |= BAC_ADDRESS_MULT;
             }
-            flags |= BAC_ADDRESS_MULT;
-            pMatch->Flags |= BAC_ADDRESS_MULT;
+            link = pMatch->next;
         }
-        pMatch = pMatch->next;
     }
-
-    pMatch = alloc_address_entry();
-
+    if ((Address_Table.count == Address_Table.size) && !address_table_grow()) {
+        return;
+    }
+    pMatch = &Address_Table.entry[Address_Table.count];
     pMatch->Flags = flags;
     pMatch->device_id = device_id;
     pMatch->max_apdu = max_apdu;
+    pMatch->segmentation = segmentation;
+    pMatch->vendor_id = vendor_id;
     pMatch->address = *src;
+    hash = address_table_hash(device_id);
+    pMatch->next = Address_Table.bucket[hash];
+    Address_Table.count++;
+    Address_Table.bucket[hash] = Address_Table.count;
 
     return;
 }
 
+/**
+ * @brief Order the responders by device instance, then by address
+ */
+static int address_entry_compare(const void *a, const void *b)
+{
+    const struct address_entry *entry_a = a;
+    const struct address_entry *entry_b = b;
+    int diff;
+
+    if (entry_a->device_id != entry_b->device_id) {
+        return (entry_a->device_id < entry_b->device_id) ? -1 : 1;
+    }
+    if (entry_a->address.net != entry_b->address.net) {
+        return (entry_a->address.net < entry_b->address.net) ? -1 : 1;
+    }
+    diff = memcmp(
+        entry_a->address.mac, entry_b->address.mac,
+        sizeof(entry_a->address.mac));
+    if (diff == 0) {
+        diff = memcmp(
+            entry_a->address.adr, entry_b->address.adr,
+            sizeof(entry_a->address.adr));
+    }
+
+    return diff;
+}
+
 static void my_i_am_handler(
     uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src)
 {
@@ -134,7 +227,7 @@ static void my_i_am_handler(
                 fprintf(stderr, "\n");
             }
         }
-        address_table_add(device_id, max_apdu, src);
+        address_table_add(device_id, max_apdu, segmentation, vendor_id, src);
     } else {
         if (BACnet_Debug_Enabled) {
             fprintf(stderr, ", but unable to decode it.\n");
@@ -213,6 +306,7 @@ static void print_address_cache(void)
     unsigned dup_addresses = 0;
     struct address_entry *addr;
     uint8_t local_sadr = 0;
+    unsigned i;
 
     /*  NOTE: this string format is parsed by src/address.c,
        so these must be compatible. */
@@ -222,8 +316,8 @@ static void print_address_cache(void)
         "SADR (hex)", "APDU");
     printf(";-------- -------------------- ----- -------------------- ----\n");
 
-    addr = Address_Table.first;
-    while (addr) {
+    for (i = 0; i < Address_Table.count; i++) {
+        addr = &Address_Table.entry[i];
         bacnet_address_copy(&address, &addr->address);
         total_addresses++;
         if (addr->Flags & BAC_ADDRESS_MULT) {
@@ -242,8 +336,6 @@ static void print_address_cache(void)
         }
         printf(" %-4u ", (unsigned)addr->max_apdu);
         printf("\n");
-
-        addr = addr->next;
     }
     printf(";\n; Total Devices: %u\n", total_addresses);
     if (dup_addresses) {
@@ -251,11 +343,92 @@ static void print_address_cache(void)
     }
 }
 
+/**
+ * @brief Print a MAC address as hex bytes separated by colons
+ * @param addr - MAC address
+ * @param len - number of bytes in the MAC address
+ */
+static void print_hex_address(const uint8_t *addr, int len)
+{
+    int j;
+
+    for (j = 0; j < len; j++) {
+        printf("%s%02X", j ? ":" : "", addr[j]);
+    }
+}
+
+static void print_address_cache_json(void)
+{
+    const struct address_entry *addr;
+    unsigned i;
+
+    printf("[");
+    for (i = 0; i < Address_Table.count; i++) {
+        addr = &Address_Table.entry[i];
+        printf("%s\n  {\"device\": %lu, \"mac\": \"", i ? "," : "",
+            (unsigned long)addr->device_id);
+        print_hex_address(addr->address.mac, addr->address.mac_len);
+        printf("\", \"snet\": %u, \"sadr\": \"", (unsigned)addr->address.net);
+        print_hex_address(addr->address.adr, addr->address.len);
+        printf(
+            "\", \"max_apdu\": %u, \"segmentation\": %d, "
+            "\"vendor\": %u, \"duplicate\": %s}",
+            addr->max_apdu, addr->segmentation, (unsigned)addr->vendor_id,
+            (addr->Flags & BAC_ADDRESS_MULT) ? "true" : "false");
+    }
+    printf("\n]\n");
+}
+
+static void print_address_cache_csv(void)
+{
+    const struct address_entry *addr;
+    unsigned i;
+
+    printf("device,mac,snet,sadr,max_apdu,segmentation,vendor,duplicate\n");
+    for (i = 0; i < Address_Table.count; i++) {
+        addr = &Address_Table.entry[i];
+        printf("%lu,", (unsigned long)addr->device_id);
+        print_hex_address(addr->address.mac, addr->address.mac_len);
+        printf(",%u,", (unsigned)addr->address.net);
+        print_hex_address(addr->address.adr, addr->address.len);
+        printf(
+            ",%u,%d,%u,%d\n", addr->max_apdu, addr->segmentation,
+            (unsigned)addr->vendor_id,
+            (addr->Flags & BAC_ADDRESS_MULT) ? 1 : 0);
+    }
+}
+
+/**
+ * @brief Print the devices found in the chosen format.  In collection
+ *  mode, they are sorted by device instance and printed in one block.
+ */
+static void print_devices(void)
+{
+    if (Collect_Mode && (Address_Table.count > 1)) {
+        qsort(
+            Address_Table.entry, Address_Table.count,
+            sizeof(Address_Table.entry[0]), address_entry_compare);
+    }
+    switch (Print_Format) {
+        case PRINT_FORMAT_JSON:
+            print_address_cache_json();
+            break;
+        case PRINT_FORMAT_CSV:
+            print_address_cache_csv();
+            break;
+        default:
+            print_address_cache();
+            break;
+    }
+    fflush(stdout);
+}
+
 static void print_usage(const char *filename)
 {
     printf("Usage: %s", filename);
     printf(" [device-instance-min [device-instance-max]]\n");
     printf("       [--dnet][--dadr][--mac]\n");
+    printf("       [--collect][--format text|json|csv]\n");
     printf("       [--version][--help]\n");
 }
 
@@ -304,6 +477,15 @@ static void print_help(const char *filename)
            "Wait M milliseconds for responses after sending\n"
            "Default delay is 100ms.\n");
     printf("\n");
+    printf("--collect\n"
+           "Collection mode for a site-wide census: enlarge the socket\n"
+           "receive buffer, receive the I-Am replies in batches, and\n"
+           "print the devices sorted by device instance at the end.\n");
+    printf("\n");
+    printf("--format F\n"
+           "Print the devices found as text, json, or csv.\n"
+           "Default format is text.\n");
+    printf("\n");
     printf("Example:\n");
     printf(
         "Send a WhoIs request to DNET 123:\n"
@@ -333,12 +515,46 @@ static void print_help(const char *filename)
         "Send a WhoIs request to all devices:\n"
         "%s\n",
         filename);
+    printf(
+        "Collect every device on the site as CSV:\n"
+        "%s --collect --format csv\n",
+        filename);
 }
 
-int main(int argc, char *argv[])
+/**
+ * @brief Receive and process the NPDUs from the datalink
+ * @param timeout - number of milliseconds to wait for a packet
+ */
+static void whois_receive(unsigned timeout)
 {
     BACNET_ADDRESS src = { 0 }; /* address where message came from */
     uint16_t pdu_len = 0;
+#if defined(BACNET_BIP_BATCH)
+    unsigned packet_count = 0;
+    unsigned packet_index = 0;
+
+    if (Collect_Mode) {
+        packet_count = datalink_receive_many(
+            &Rx_Packets[0], ARRAY_SIZE(Rx_Packets), timeout);
+        for (packet_index = 0; packet_index < packet_count; packet_index++) {
+            npdu_handler(
+                &Rx_Packets[packet_index].src, Rx_Packets[packet_index].pdu,
+                Rx_Packets[packet_index].pdu_len);
+        }
+        return;
+    }
+#endif
+    /* returns 0 bytes on timeout */
+    pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
+    /* process */
+    if (pdu_len) {
+        npdu_handler(&src, &Rx_Buf[0], pdu_len);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static char stdout_buffer[64 * 1024];
     unsigned timeout_milliseconds = 0;
     unsigned delay_milliseconds = 100;
     struct mstimer apdu_timer = { 0 };
@@ -414,6 +630,21 @@ int main(int argc, char *argv[])
             if (++argi < argc) {
                 delay_milliseconds = strtol(argv[argi], NULL, 0);
             }
+        } else if (strcmp(argv[argi], "--collect") == 0) {
+            Collect_Mode = true;
+        } else if (strcmp(argv[argi], "--format") == 0) {
+            if (++argi < argc) {
+                if (strcmp(argv[argi], "json") == 0) {
+                    Print_Format = PRINT_FORMAT_JSON;
+                } else if (strcmp(argv[argi], "csv") == 0) {
+                    Print_Format = PRINT_FORMAT_CSV;
+                } else if (strcmp(argv[argi], "text") == 0) {
+                    Print_Format = PRINT_FORMAT_TEXT;
+                } else {
+                    fprintf(stderr, "format=%s invalid\n", argv[argi]);
+                    return 1;
+                }
+            }
         } else {
             if (target_args == 0) {
                 Target_Object_Instance_Min = Target_Object_Instance_Max =
@@ -472,12 +703,27 @@ int main(int argc, char *argv[])
             Target_Object_Instance_Max, BACNET_MAX_INSTANCE);
         return 1;
     }
+    if (Collect_Mode) {
+        /* the devices are printed in one block at the end */
+        setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+    }
     /* setup my info */
     Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
     init_service_handlers();
     address_init();
     dlenv_init();
     atexit(datalink_cleanup);
+#if defined(BACDL_BIP) && defined(BACNET_BIP_BATCH)
+    if (Collect_Mode) {
+        if (bip_receive_buffer_set(WHOIS_COLLECT_RCVBUF) <
+            WHOIS_COLLECT_RCVBUF) {
+            fprintf(
+                stderr,
+                "Receive buffer limited by the system - "
+                "raise net.core.rmem_max to avoid dropped replies.\n");
+        }
+    }
+#endif
     if (timeout_milliseconds == 0) {
         timeout_milliseconds = apdu_timeout() * apdu_retries();
     }
@@ -491,13 +737,7 @@ int main(int argc, char *argv[])
     }
     /* loop forever */
     for (;;) {
-        /* returns 0 bytes on timeout */
-        pdu_len =
-            datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, delay_milliseconds);
-        /* process */
-        if (pdu_len) {
-            npdu_handler(&src, &Rx_Buf[0], pdu_len);
-        }
+        whois_receive(delay_milliseconds);
         if (Error_Detected) {
             break;
         }
@@ -518,7 +758,7 @@ int main(int argc, char *argv[])
             mstimer_reset(&apdu_timer);
         }
     }
-    print_address_cache();
+    print_devices();
 
     return 0;
 }
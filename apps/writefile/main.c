@@ -15,6 +15,7 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/bacstr.h"
 #include "bacnet/bactext.h"
 #include "bacnet/iam.h"
 #include "bacnet/awf.h"
@@ -43,7 +44,39 @@ static BACNET_ADDRESS Target_Address;
 static char *Local_File_Name = NULL;
 static bool End_Of_File_Detected = false;
 static bool Error_Detected = false;
-static uint8_t Current_Invoke_ID = 0;
+
+/* number of AtomicWriteFile requests that may be outstanding at once */
+#ifndef WRITEFILE_WINDOW_MAX
+#define WRITEFILE_WINDOW_MAX 16
+#endif
+#if (WRITEFILE_WINDOW_MAX > MAX_TSM_TRANSACTIONS)
+#undef WRITEFILE_WINDOW_MAX
+#define WRITEFILE_WINDOW_MAX MAX_TSM_TRANSACTIONS
+#endif
+static uint8_t Write_Invoke_ID[WRITEFILE_WINDOW_MAX];
+static unsigned Write_Window = 1;
+
+/**
+ * @brief Determine if a reply is for one of the outstanding requests
+ * @param src - address the reply came from
+ * @param invoke_id - invoke ID of the reply
+ * @return true if the reply is for an outstanding request
+ */
+static bool write_request_match(const BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    unsigned i;
+
+    if ((invoke_id == 0) || !address_match(&Target_Address, src)) {
+        return false;
+    }
+    for (i = 0; i < Write_Window; i++) {
+        if (Write_Invoke_ID[i] == invoke_id) {
+            return true;
+        }
+    }
+
+    return false;
+}
 
 static void Atomic_Write_File_Error_Handler(
     BACNET_ADDRESS *src,
@@ -51,8 +84,7 @@ static void Atomic_Write_File_Error_Handler(
     BACNET_ERROR_CLASS error_class,
     BACNET_ERROR_CODE error_code)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Current_Invoke_ID)) {
+    if (write_request_match(src, invoke_id)) {
         printf("\r\nBACnet Error!\r\n");
         printf("Error Class: %s\r\n", bactext_error_class_name(error_class));
         printf("Error Code: %s\r\n", bactext_error_code_name(error_code));
@@ -64,8 +96,7 @@ static void MyAbortHandler(
     BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t abort_reason, bool server)
 {
     (void)server;
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Current_Invoke_ID)) {
+    if (write_request_match(src, invoke_id)) {
         printf(
             "BACnet Abort: %s\r\n",
             bactext_abort_reason_name((int)abort_reason));
@@ -76,8 +107,7 @@ static void MyAbortHandler(
 static void
 MyRejectHandler(BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Current_Invoke_ID)) {
+    if (write_request_match(src, invoke_id)) {
         printf(
             "BACnet Reject: %s\r\n",
             bactext_reject_reason_name((int)reject_reason));
@@ -142,24 +172,61 @@ int main(int argc, char *argv[])
     unsigned requestedOctetCount = 0;
     uint8_t invoke_id = 0;
     bool found = false;
+    bool busy = false;
     uint16_t my_max_apdu = 0;
     FILE *pFile = NULL;
     static BACNET_OCTET_STRING fileData;
     size_t len = 0;
     bool pad_byte = false;
+    unsigned long value = 0;
+    unsigned target_args = 0;
+    unsigned i = 0;
+    int argi = 0;
 
-    if (argc < 4) {
+    for (argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--window") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value == 0) || (value > WRITEFILE_WINDOW_MAX)) {
+                fprintf(stderr, "window invalid\r\n");
+                return 1;
+            }
+            Write_Window = (unsigned)value;
+        } else if (strcmp(argv[argi], "--offset") == 0) {
+            if ((++argi >= argc) || !bacnet_strtoul(argv[argi], &value) ||
+                (value > INT32_MAX)) {
+                fprintf(stderr, "offset invalid\r\n");
+                return 1;
+            }
+            fileStartPosition = (int)value;
+        } else {
+            /* decode the command line parameters */
+            if (target_args == 0) {
+                Target_Device_Object_Instance = strtol(argv[argi], NULL, 0);
+            } else if (target_args == 1) {
+                Target_File_Object_Instance = strtol(argv[argi], NULL, 0);
+            } else if (target_args == 2) {
+                Local_File_Name = argv[argi];
+            } else if (target_args == 3) {
+                Target_File_Requested_Octet_Count =
+                    strtol(argv[argi], NULL, 0);
+            } else if (target_args == 4) {
+                Target_File_Requested_Octet_Pad_Byte =
+                    strtol(argv[argi], NULL, 0);
+                pad_byte = true;
+            }
+            target_args++;
+        }
+    }
+    if (target_args < 3) {
         /* FIXME: what about access method - record or stream? */
         printf(
             "%s device-instance file-instance local-name [octet count] [pad "
-            "value]\r\n",
-            filename_remove_path(argv[0]));
+            "value]\r\n"
+            "[--window N] requests outstanding at once, from 1 to %u\r\n"
+            "[--offset N] start at octet N, to resume a transfer\r\n",
+            filename_remove_path(argv[0]), (unsigned)WRITEFILE_WINDOW_MAX);
         return 0;
     }
-    /* decode the command line parameters */
-    Target_Device_Object_Instance = strtol(argv[1], NULL, 0);
-    Target_File_Object_Instance = strtol(argv[2], NULL, 0);
-    Local_File_Name = argv[3];
     if (Target_Device_Object_Instance > BACNET_MAX_INSTANCE) {
         fprintf(
             stderr, "device-instance=%u - not greater than %u\r\n",
@@ -172,12 +239,8 @@ int main(int argc, char *argv[])
             Target_File_Object_Instance, BACNET_MAX_INSTANCE);
         return 1;
     }
-    if (argc > 4) {
-        Target_File_Requested_Octet_Count = strtol(argv[4], NULL, 0);
-    }
-    if (argc > 5) {
-        Target_File_Requested_Octet_Pad_Byte = strtol(argv[5], NULL, 0);
-        pad_byte = true;
+    if (Target_File_Requested_Octet_Count > MAX_OCTET_STRING_BYTES) {
+        Target_File_Requested_Octet_Count = MAX_OCTET_STRING_BYTES;
     }
     /* setup my info */
     Device_Set_Object_Instance_Number(BACNET_MAX_INSTANCE);
@@ -241,49 +304,74 @@ int main(int argc, char *argv[])
                     requestedOctetCount = my_max_apdu / 2;
                 }
             }
-            /* has the previous invoke id expired or returned?
-               note: invoke ID = 0 is invalid, so it will be idle */
-            if ((invoke_id == 0) || tsm_invoke_id_free(invoke_id)) {
-                if (End_Of_File_Detected || Error_Detected) {
-                    printf("\r\n");
-                    break;
-                }
+            busy = false;
+            for (i = 0; i < Write_Window; i++) {
+                /* has the previous invoke id expired or returned?
+                   note: invoke ID = 0 is invalid, so it will be idle */
+                invoke_id = Write_Invoke_ID[i];
                 if (invoke_id != 0) {
-                    fileStartPosition += requestedOctetCount;
+                    if (tsm_invoke_id_failed(invoke_id)) {
+                        fprintf(stderr, "\rError: TSM Timeout!\r\n");
+                        tsm_free_invoke_id(invoke_id);
+                        Write_Invoke_ID[i] = 0;
+                        Error_Detected = true;
+                        /* try again or abort? */
+                        break;
+                    }
+                    if (!tsm_invoke_id_free(invoke_id)) {
+                        busy = true;
+                        continue;
+                    }
+                    Write_Invoke_ID[i] = 0;
+                }
+                if (End_Of_File_Detected || Error_Detected) {
+                    continue;
                 }
                 /* we'll read the file in chunks
                    less than max_apdu to keep unsegmented */
                 pFile = fopen(Local_File_Name, "rb");
-                if (pFile) {
-                    (void)fseek(pFile, fileStartPosition, SEEK_SET);
-                    len = fread(
-                        octetstring_value(&fileData), 1, requestedOctetCount,
-                        pFile);
-                    if (len < requestedOctetCount) {
-                        End_Of_File_Detected = true;
-                        if (pad_byte) {
-                            memset(
-                                octetstring_value(&fileData) + len + 1,
-                                (int)Target_File_Requested_Octet_Pad_Byte,
-                                requestedOctetCount - len);
-                            len = requestedOctetCount;
-                        }
-                    }
-                    octetstring_truncate(&fileData, len);
-                    fclose(pFile);
-                } else {
+                if (!pFile) {
+                    fprintf(
+                        stderr, "\rUnable to read file \"%s\".\r\n",
+                        Local_File_Name);
+                    Error_Detected = true;
+                    break;
+                }
+                (void)fseek(pFile, fileStartPosition, SEEK_SET);
+                len = fread(
+                    octetstring_value(&fileData), 1, requestedOctetCount,
+                    pFile);
+                fclose(pFile);
+                if ((len < requestedOctetCount) && pad_byte) {
+                    memset(
+                        octetstring_value(&fileData) + len,
+                        (int)Target_File_Requested_Octet_Pad_Byte,
+                        requestedOctetCount - len);
+                    len = requestedOctetCount;
                     End_Of_File_Detected = true;
                 }
-                printf("\rSending %d bytes", (int)(fileStartPosition + len));
+                octetstring_truncate(&fileData, len);
                 invoke_id = Send_Atomic_Write_File_Stream(
                     Target_Device_Object_Instance, Target_File_Object_Instance,
                     fileStartPosition, &fileData);
-                Current_Invoke_ID = invoke_id;
-            } else if (tsm_invoke_id_failed(invoke_id)) {
-                fprintf(stderr, "\rError: TSM Timeout!\r\n");
-                tsm_free_invoke_id(invoke_id);
-                Error_Detected = true;
-                /* try again or abort? */
+                if (invoke_id == 0) {
+                    /* no free invoke ID: send this block again later */
+                    End_Of_File_Detected = false;
+                    busy = true;
+                    break;
+                }
+                Write_Invoke_ID[i] = invoke_id;
+                busy = true;
+                /* the blocks at the following offsets go out in the other
+                   requests of the window, before this one is confirmed */
+                fileStartPosition += (int)len;
+                if (len < requestedOctetCount) {
+                    End_Of_File_Detected = true;
+                }
+                printf("\rSending %d bytes", fileStartPosition);
+            }
+            if (Error_Detected || !busy) {
+                printf("\r\n");
                 break;
             }
         } else {
@@ -285,17 +285,23 @@ int bip_send_mpdu(
 }
 
 /**
- * BACnet/IP Datalink Receive handler.
+ * BACnet/IP Datalink Receive handler that leaves the NPDU in place
+ * after the BVLC header, so it can be decoded without a copy.
  *
  * @param src - returns the source address
- * @param npdu - returns the NPDU buffer
- * @param max_npdu -maximum size of the NPDU buffer
+ * @param mtu - returns the received BVLC message
+ * @param max_mtu - maximum size of the BVLC message buffer
  * @param timeout - number of milliseconds to wait for a packet
+ * @param npdu_offset - returns the offset of the NPDU in the mtu buffer
  *
- * @return Number of bytes received, or 0 if none or timeout.
+ * @return Number of NPDU bytes received, or 0 if none or timeout.
  */
-uint16_t bip_receive(
-    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+uint16_t bip_receive_npdu(
+    BACNET_ADDRESS *src,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    unsigned timeout,
+    uint16_t *npdu_offset)
 {
     uint16_t npdu_len = 0; /* return value */
     fd_set read_fds;
@@ -306,7 +312,6 @@ uint16_t bip_receive(
     socklen_t sin_len = sizeof(sin);
     int received_bytes = 0;
     int offset = 0;
-    uint16_t i = 0;
     int socket;
 
     /* Make sure the socket is open */
@@ -335,7 +340,7 @@ uint16_t bip_receive(
         socket =
             FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
         received_bytes = recvfrom(
-            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
+            socket, (char *)&mtu[0], max_mtu, 0, (struct sockaddr *)&sin,
             &sin_len);
     } else {
         return 0;
@@ -349,20 +354,9 @@ uint16_t bip_receive(
         return 0;
     }
     /* the signature of a BACnet/IPv packet */
-    if (npdu[0] != BVLL_TYPE_BACNET_IP) {
+    if (mtu[0] != BVLL_TYPE_BACNET_IP) {
         return 0;
     }
-    /* Erase up to 16 bytes after the received bytes as safety margin to
-     * ensure that the decoding functions will run into a 'safe field'
-     * of zero, if for any reason they would overrun, when parsing the
-     * message. */
-    max = (int)max_npdu - received_bytes;
-    if (max > 0) {
-        if (max > 16) {
-            max = 16;
-        }
-        memset(&npdu[received_bytes], 0, max);
-    }
     /* Data link layer addressing between B/IPv4 nodes consists of a 32-bit
        IPv4 address followed by a two-octet UDP port number (both of which
        shall be transmitted with the most significant octet first). This
@@ -374,31 +368,47 @@ uint16_t bip_receive(
         "Received MPDU->", &sin.sin_addr, sin.sin_port, received_bytes);
     /* pass the packet into the BBMD handler */
     if (socket == BIP_Socket) {
-        offset = bvlc_handler(&addr, src, npdu, received_bytes);
+        offset = bvlc_handler(&addr, src, mtu, received_bytes);
     } else {
-        offset = bvlc_broadcast_handler(&addr, src, npdu, received_bytes);
+        offset = bvlc_broadcast_handler(&addr, src, mtu, received_bytes);
     }
     if (offset > 0) {
         npdu_len = received_bytes - offset;
         debug_print_ipv4(
             "Received NPDU->", &sin.sin_addr, sin.sin_port, npdu_len);
-        if (npdu_len <= max_npdu) {
-            /* shift the buffer to return a valid NPDU */
-            for (i = 0; i < npdu_len; i++) {
-                npdu[i] = npdu[offset + i];
-            }
-        } else {
-            if (BIP_Debug) {
-                fprintf(stderr, "BIP: NPDU dropped!\n");
-                fflush(stderr);
-            }
-            npdu_len = 0;
+        if (npdu_offset) {
+            *npdu_offset = (uint16_t)offset;
         }
     }
 
     return npdu_len;
 }
 
+/**
+ * BACnet/IP Datalink Receive handler.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    uint16_t npdu_len = 0;
+    uint16_t offset = 0;
+
+    npdu_len = bip_receive_npdu(src, npdu, max_npdu, timeout, &offset);
+    if ((npdu_len > 0) && (offset > 0)) {
+        /* shift the buffer to return a valid NPDU */
+        memmove(&npdu[0], &npdu[offset], npdu_len);
+    }
+
+    return npdu_len;
+}
+
 /**
  * The common send function for BACnet/IP application layer
  *
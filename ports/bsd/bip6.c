@@ -389,6 +389,15 @@ uint16_t bip6_receive(
     return npdu_len;
 }
 
+/**
+ * @brief Return the active BACnet/IPv6 socket.
+ * @return The active BACnet/IPv6 socket, or -1 if uninitialized.
+ */
+int bip6_get_socket(void)
+{
+    return BIP6_Socket;
+}
+
 /** Cleanup and close out the BACnet/IP services by closing the socket.
  * @ingroup DLBIP6
  */
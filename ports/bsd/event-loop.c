@@ -0,0 +1,249 @@
+/**
+ * @file
+ * @brief A kqueue event loop for the BSD and macOS ports.
+ *
+ * The datalink receive functions each hide a select() with a timeout, and
+ * the applications poll their mstimers between the receive calls, so the
+ * timeout adds to the response latency.  This module waits in one
+ * kevent() for any registered datalink socket or serial port file
+ * descriptor, and for the EVFILT_TIMER cyclic stack timers, and
+ * dispatches the callback of each source that is ready.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include "bacnet/basic/sys/debug.h"
+#include "event-loop.h"
+
+/* one file descriptor or timer in the event loop */
+struct event_loop_source {
+    bool used;
+    bool timer;
+    /* file descriptor, or -1 for a timer */
+    int fd;
+    uint32_t interval_milliseconds;
+    event_loop_fd_callback fd_callback;
+    event_loop_timer_callback timer_callback;
+};
+
+static struct event_loop_source Event_Loop_Source[EVENT_LOOP_SOURCES_MAX];
+static int Event_Loop_Kqueue = -1;
+
+/**
+ * @brief Find an unused event source
+ * @return the unused event source, or NULL if the table is full
+ */
+static struct event_loop_source *event_loop_source_alloc(void)
+{
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        if (!Event_Loop_Source[i].used) {
+            return &Event_Loop_Source[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Initialize the event loop
+ * @return true if the event loop is ready
+ */
+bool event_loop_init(void)
+{
+    unsigned i;
+
+    if (Event_Loop_Kqueue >= 0) {
+        return true;
+    }
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        Event_Loop_Source[i].used = false;
+        Event_Loop_Source[i].fd = -1;
+    }
+    Event_Loop_Kqueue = kqueue();
+    if (Event_Loop_Kqueue < 0) {
+        debug_perror("event-loop: kqueue");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the event loop, which removes its file descriptors and
+ *  timers.  The datalink file descriptors are owned by the datalink and
+ *  are left open.
+ */
+void event_loop_cleanup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        Event_Loop_Source[i].used = false;
+        Event_Loop_Source[i].fd = -1;
+    }
+    if (Event_Loop_Kqueue >= 0) {
+        close(Event_Loop_Kqueue);
+        Event_Loop_Kqueue = -1;
+    }
+}
+
+/**
+ * @brief Add a file descriptor, such as a datalink socket or a serial
+ *  port, to the loop
+ * @param fd - the file descriptor to wait on for reading
+ * @param callback - called when the file descriptor is ready to read
+ * @return true if the file descriptor was added
+ */
+bool event_loop_fd_add(int fd, event_loop_fd_callback callback)
+{
+    struct event_loop_source *source;
+    struct kevent change;
+
+    if ((Event_Loop_Kqueue < 0) || (fd < 0) || !callback) {
+        return false;
+    }
+    source = event_loop_source_alloc();
+    if (!source) {
+        return false;
+    }
+    EV_SET(&change, fd, EVFILT_READ, EV_ADD | EV_ENABLE, 0, 0, source);
+    if (kevent(Event_Loop_Kqueue, &change, 1, NULL, 0, NULL) < 0) {
+        debug_perror("event-loop: kevent EVFILT_READ");
+        return false;
+    }
+    source->used = true;
+    source->timer = false;
+    source->fd = fd;
+    source->interval_milliseconds = 0;
+    source->fd_callback = callback;
+    source->timer_callback = NULL;
+
+    return true;
+}
+
+/**
+ * @brief Remove a file descriptor from the loop, such as before the
+ *  datalink closes it
+ * @param fd - the file descriptor that was added
+ * @return true if the file descriptor was found and removed
+ */
+bool event_loop_fd_remove(int fd)
+{
+    struct kevent change;
+    unsigned i;
+
+    if ((Event_Loop_Kqueue < 0) || (fd < 0)) {
+        return false;
+    }
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        if (Event_Loop_Source[i].used && !Event_Loop_Source[i].timer &&
+            (Event_Loop_Source[i].fd == fd)) {
+            EV_SET(&change, fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+            (void)kevent(Event_Loop_Kqueue, &change, 1, NULL, 0, NULL);
+            Event_Loop_Source[i].used = false;
+            Event_Loop_Source[i].fd = -1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Add a cyclic timer, such as the TSM or COV timer, to the loop
+ * @param interval_milliseconds - the period of the timer
+ * @param callback - called with the elapsed time when the timer expires
+ * @return true if the timer was added
+ */
+bool event_loop_timer_add(
+    uint32_t interval_milliseconds, event_loop_timer_callback callback)
+{
+    struct event_loop_source *source;
+    struct kevent change;
+
+    if ((Event_Loop_Kqueue < 0) || (interval_milliseconds == 0) ||
+        !callback) {
+        return false;
+    }
+    source = event_loop_source_alloc();
+    if (!source) {
+        return false;
+    }
+    /* the timer is identified by its place in the table, and its data
+       is the period in milliseconds, which is the default unit */
+    EV_SET(
+        &change, (uintptr_t)(source - &Event_Loop_Source[0]), EVFILT_TIMER,
+        EV_ADD | EV_ENABLE, 0, interval_milliseconds, source);
+    if (kevent(Event_Loop_Kqueue, &change, 1, NULL, 0, NULL) < 0) {
+        debug_perror("event-loop: kevent EVFILT_TIMER");
+        return false;
+    }
+    source->used = true;
+    source->timer = true;
+    source->fd = -1;
+    source->interval_milliseconds = interval_milliseconds;
+    source->fd_callback = NULL;
+    source->timer_callback = callback;
+
+    return true;
+}
+
+/**
+ * @brief Wait for the registered sources, and call the callback of each
+ *  source that is ready.  An expired timer reports the time for all of
+ *  its expirations since the previous callback.
+ * @param timeout_milliseconds - time to wait, or -1 to wait until a
+ *  file descriptor is ready or a timer expires
+ * @return number of callbacks, or -1 on error
+ */
+int event_loop_run_once(int timeout_milliseconds)
+{
+    struct kevent events[EVENT_LOOP_SOURCES_MAX];
+    struct event_loop_source *source;
+    struct timespec timeout = { 0 };
+    struct timespec *ptimeout = NULL;
+    int count;
+    int i;
+
+    if (Event_Loop_Kqueue < 0) {
+        return -1;
+    }
+    if (timeout_milliseconds >= 0) {
+        timeout.tv_sec = timeout_milliseconds / 1000;
+        timeout.tv_nsec = (timeout_milliseconds % 1000) * 1000000L;
+        ptimeout = &timeout;
+    }
+    count = kevent(
+        Event_Loop_Kqueue, NULL, 0, events, EVENT_LOOP_SOURCES_MAX, ptimeout);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        debug_perror("event-loop: kevent");
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        source = (struct event_loop_source *)events[i].udata;
+        if (!source || !source->used) {
+            /* removed by an earlier callback */
+            continue;
+        }
+        if (events[i].filter == EVFILT_TIMER) {
+            /* the data is the number of expirations */
+            source->timer_callback(
+                (uint32_t)events[i].data * source->interval_milliseconds);
+        } else if (events[i].filter == EVFILT_READ) {
+            source->fd_callback(source->fd);
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief A kqueue event loop for the BSD and macOS ports, which waits
+ *  on datalink file descriptors and cyclic stack timers at the same time.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_PORT_BSD_EVENT_LOOP_H
+#define BACNET_PORT_BSD_EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* maximum number of file descriptors and timers in the event loop */
+#ifndef EVENT_LOOP_SOURCES_MAX
+#define EVENT_LOOP_SOURCES_MAX 16
+#endif
+
+/**
+ * @brief Callback for a file descriptor that is ready to read
+ * @param fd - the file descriptor that is ready to read
+ */
+typedef void (*event_loop_fd_callback)(int fd);
+
+/**
+ * @brief Callback for a cyclic timer that has expired
+ * @param elapsed_milliseconds - the time since the previous callback
+ */
+typedef void (*event_loop_timer_callback)(uint32_t elapsed_milliseconds);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool event_loop_init(void);
+BACNET_STACK_EXPORT
+void event_loop_cleanup(void);
+
+BACNET_STACK_EXPORT
+bool event_loop_fd_add(int fd, event_loop_fd_callback callback);
+BACNET_STACK_EXPORT
+bool event_loop_fd_remove(int fd);
+BACNET_STACK_EXPORT
+bool event_loop_timer_add(
+    uint32_t interval_milliseconds, event_loop_timer_callback callback);
+
+BACNET_STACK_EXPORT
+int event_loop_run_once(int timeout_milliseconds);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
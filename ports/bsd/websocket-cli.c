@@ -51,8 +51,26 @@ typedef struct {
     size_t fragment_buffer_len;
     char err_desc[BSC_WEBSOCKET_ERR_DESC_STR_MAX_LEN];
     BACNET_ERROR_CODE err_code;
+    /* host and port of the peer, to save its TLS session */
+    char host[BSC_WSURL_MAX_LEN];
+    uint16_t port;
 } BSC_WEBSOCKET_CONNECTION;
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+/* TLS sessions of the recently connected peers.  Each connection has its
+   own lws context, so a session is kept here between the connections, and
+   a reconnect to the same hub resumes it instead of a full handshake. */
+typedef struct {
+    char host[BSC_WSURL_MAX_LEN];
+    uint16_t port;
+    uint8_t *blob;
+    size_t blob_len;
+} BSC_WEBSOCKET_TLS_SESSION;
+
+static BSC_WEBSOCKET_TLS_SESSION
+    bws_cli_tls_session[BSC_CLIENT_WEBSOCKETS_MAX_NUM];
+#endif
+
 /* Some forward function declarations */
 
 static int bws_cli_websocket_event(
@@ -129,6 +147,106 @@ static BSC_WEBSOCKET_HANDLE bws_cli_find_connnection(struct lws *ws)
     return BSC_WEBSOCKET_INVALID_HANDLE;
 }
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+static BSC_WEBSOCKET_TLS_SESSION *
+bws_cli_tls_session_find(const char *host, uint16_t port, bool alloc)
+{
+    BSC_WEBSOCKET_TLS_SESSION *free_session = NULL;
+    int i;
+
+    for (i = 0; i < BSC_CLIENT_WEBSOCKETS_MAX_NUM; i++) {
+        if ((bws_cli_tls_session[i].port == port) &&
+            (strcmp(bws_cli_tls_session[i].host, host) == 0)) {
+            return &bws_cli_tls_session[i];
+        }
+        if (!free_session && !bws_cli_tls_session[i].blob) {
+            free_session = &bws_cli_tls_session[i];
+        }
+    }
+    if (!alloc) {
+        return NULL;
+    }
+    if (!free_session) {
+        /* replace the oldest session */
+        free(bws_cli_tls_session[0].blob);
+        memmove(
+            &bws_cli_tls_session[0], &bws_cli_tls_session[1],
+            sizeof(bws_cli_tls_session[0]) *
+                (BSC_CLIENT_WEBSOCKETS_MAX_NUM - 1));
+        free_session = &bws_cli_tls_session[BSC_CLIENT_WEBSOCKETS_MAX_NUM - 1];
+    }
+    memset(free_session, 0, sizeof(*free_session));
+    snprintf(free_session->host, sizeof(free_session->host), "%s", host);
+    free_session->port = port;
+
+    return free_session;
+}
+
+static int bws_cli_tls_session_save_cb(
+    struct lws_context *cx, struct lws_tls_session_dump *info)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session = info->opaque;
+    uint8_t *blob;
+
+    (void)cx;
+    blob = malloc(info->blob_len);
+    if (!blob) {
+        return 1;
+    }
+    memcpy(blob, info->blob, info->blob_len);
+    free(session->blob);
+    session->blob = blob;
+    session->blob_len = info->blob_len;
+
+    return 0;
+}
+
+static int bws_cli_tls_session_load_cb(
+    struct lws_context *cx, struct lws_tls_session_dump *info)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session = info->opaque;
+
+    (void)cx;
+    /* libwebsockets frees the blob after loading it */
+    info->blob = malloc(session->blob_len);
+    if (!info->blob) {
+        return 1;
+    }
+    memcpy(info->blob, session->blob, session->blob_len);
+    info->blob_len = session->blob_len;
+
+    return 0;
+}
+
+/* keep the TLS session of an established connection for the next one */
+static void bws_cli_tls_session_save(BSC_WEBSOCKET_HANDLE h, struct lws *wsi)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session;
+
+    session = bws_cli_tls_session_find(
+        bws_cli_conn[h].host, bws_cli_conn[h].port, true);
+    (void)lws_tls_session_dump_save(
+        lws_get_vhost(wsi), bws_cli_conn[h].host, bws_cli_conn[h].port,
+        bws_cli_tls_session_save_cb, session);
+}
+
+/* offer the TLS session of the last connection to the same peer */
+static void bws_cli_tls_session_load(BSC_WEBSOCKET_HANDLE h)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session;
+    struct lws_vhost *vhost;
+
+    session = bws_cli_tls_session_find(
+        bws_cli_conn[h].host, bws_cli_conn[h].port, false);
+    vhost = lws_get_vhost_by_name(bws_cli_conn[h].ctx, "default");
+    if (session && session->blob && vhost) {
+        (void)lws_tls_session_dump_load(
+            vhost, bws_cli_conn[h].host, bws_cli_conn[h].port,
+            bws_cli_tls_session_load_cb, session);
+    }
+}
+#endif
+
 static void bws_set_err_desc(BSC_WEBSOCKET_HANDLE h, char *err_desc)
 {
     size_t len;
@@ -239,6 +357,9 @@ static int bws_cli_websocket_event(
 
             DEBUG_PRINTF("bws_cli_websocket_event() connection established\n");
             bws_cli_conn[h].state = BSC_WEBSOCKET_STATE_CONNECTED;
+#if defined(LWS_WITH_TLS_SESSIONS)
+            bws_cli_tls_session_save(h, wsi);
+#endif
             dispatch_func = bws_cli_conn[h].dispatch_func;
             user_param = bws_cli_conn[h].user_param;
             pthread_mutex_unlock(&bws_cli_mutex);
@@ -579,6 +700,8 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     bws_cli_conn[h].fragment_buffer_size = 0;
     bws_cli_conn[h].dispatch_func = dispatch_func;
     bws_cli_conn[h].user_param = dispatch_func_user_param;
+    snprintf(bws_cli_conn[h].host, sizeof(bws_cli_conn[h].host), "%s", addr);
+    bws_cli_conn[h].port = (uint16_t)port;
     info.port = CONTEXT_PORT_NO_LISTEN;
     if (proto == BSC_WEBSOCKET_HUB_PROTOCOL) {
         info.protocols = bws_cli_hub_protocol;
@@ -615,6 +738,9 @@ BSC_WEBSOCKET_RET bws_cli_connect(
         return BSC_WEBSOCKET_NO_RESOURCES;
     }
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+    bws_cli_tls_session_load(h);
+#endif
     bws_cli_conn[h].ws = NULL;
     cinfo.context = bws_cli_conn[h].ctx;
     cinfo.address = addr;
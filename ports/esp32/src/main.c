@@ -17,6 +17,7 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/object/ai.h"
 #include "bacnet/basic/object/bo.h"
+#include "bacnet/basic/sys/ringbuf_atomic.h"
 
 #include "esp_log.h"
 #include "esp_wifi.h"
@@ -47,16 +48,43 @@ wifi_config_t wifi_config = {
 // GPIO 5 has a Led on Sparkfun ESP32 board
 #define BACNET_LED 5
 
+// The datalink task receives on the core that runs Wi-Fi and lwIP, and
+// the BACnet task runs the handlers and the objects on the other core.
+#if defined(CONFIG_FREERTOS_UNICORE)
+#define BACNET_APP_CORE 0
+#else
+#define BACNET_APP_CORE 1
+#endif
+#define BACNET_DATALINK_CORE 0
+#define BACNET_APP_PRIORITY 20
+#define BACNET_DATALINK_PRIORITY 21
+
+// number of received NPDUs waiting for the BACnet task - a power of two
+#ifndef BACNET_RX_QUEUE_SIZE
+#define BACNET_RX_QUEUE_SIZE 4
+#endif
+
 uint8_t Handler_Transmit_Buffer[MAX_PDU] = { 0 };
 
-/** Static receive buffer, initialized with zeros by the C Library Startup Code. */
+/* A received NPDU passed from the datalink task to the BACnet task */
+struct bacnet_rx_frame {
+    BACNET_ADDRESS src;
+    uint16_t pdu_len;
+    uint8_t pdu[MAX_MPDU + 16 /* Add a little safety margin to the buffer,
+                               * so that in the rare case, the message
+                               * would be filled up to MAX_MPDU and some
+                               * decoding functions would overrun, these
+                               * decoding functions will just end up in
+                               * a safe field of static zeros. */];
+};
 
-uint8_t Rx_Buf[MAX_MPDU + 16 /* Add a little safety margin to the buffer,
-                              * so that in the rare case, the message
-                              * would be filled up to MAX_MPDU and some
-                              * decoding functions would overrun, these
-                              * decoding functions will just end up in
-                              * a safe field of static zeros. */] = { 0 };
+/** Lock-free queue of received NPDUs, initialized with zeros by the C
+    Library Startup Code. The datalink task receives into the queue and
+    the BACnet task handles the NPDUs in place, without copies. */
+static uint32_t Rx_Queue_Buffer[RINGBUF_ATOMIC_BUFFER_SIZE(
+    sizeof(struct bacnet_rx_frame), BACNET_RX_QUEUE_SIZE) / sizeof(uint32_t)];
+static RING_BUFFER_ATOMIC Rx_Queue;
+static TaskHandle_t BACnet_Task_Handle;
 
 EventGroupHandle_t wifi_event_group;
 const static int CONNECTED_BIT = BIT0;
@@ -150,12 +178,53 @@ void setup()
     wifi_init_station();
 }
 
-/* Bacnet Task */
-void BACnetTask(void *pvParameters)
+/* Datalink Task: receives the NPDUs and queues them for the BACnet task */
+void DatalinkTask(void *pvParameters)
 {
+    struct bacnet_rx_frame *frame = NULL;
     uint16_t pdu_len = 0;
-    BACNET_ADDRESS src = { 0 };
-    unsigned timeout = 1;
+    unsigned timeout = 100;
+    uint32_t tickcount = xTaskGetTickCount();
+
+    for (;;) {
+        // do nothing if not connected to wifi
+        xEventGroupWaitBits(
+            wifi_event_group, CONNECTED_BIT, false, true, portMAX_DELAY);
+        {
+            uint32_t newtick = xTaskGetTickCount();
+
+            // the BVLC state is only used from this task
+            if ((newtick < tickcount) ||
+                ((newtick - tickcount) >= configTICK_RATE_HZ)) {
+                tickcount = newtick;
+                bvlc_maintenance_timer(1);
+            }
+            // receive in place, into the next element of the queue,
+            // which stays reserved until an NPDU fills it
+            if (!frame) {
+                frame = Ringbuf_Atomic_Data_Peek(&Rx_Queue);
+            }
+            if (!frame) {
+                // the BACnet task is behind: the NPDUs wait in lwIP
+                vTaskDelay(1);
+                continue;
+            }
+            pdu_len = datalink_receive(
+                &frame->src, &frame->pdu[0], MAX_MPDU, timeout);
+            if (pdu_len) {
+                frame->pdu_len = pdu_len;
+                Ringbuf_Atomic_Data_Put(&Rx_Queue, frame);
+                frame = NULL;
+                xTaskNotifyGive(BACnet_Task_Handle);
+            }
+        }
+    }
+}
+
+/* Bacnet Task: handles the NPDUs, and runs the timers and the objects */
+void BACnetTask(void *pvParameters)
+{
+    struct bacnet_rx_frame *frame = NULL;
 
     // Init Bacnet objets dictionnary
     Device_Init(NULL);
@@ -165,10 +234,15 @@ void BACnetTask(void *pvParameters)
 
     uint32_t tickcount = xTaskGetTickCount();
 
-    for (;;) {
-        vTaskDelay(
-            10 / portTICK_PERIOD_MS); // could be remove to speed the code
+    xTaskCreatePinnedToCore(DatalinkTask, /* Function to implement the task */
+        "DatalinkTask", /* Name of the task */
+        4096, /* Stack size in words */
+        NULL, /* Task input parameter */
+        BACNET_DATALINK_PRIORITY, /* Priority of the task */
+        NULL, /* Task handle. */
+        BACNET_DATALINK_CORE); /* Core where the task runs */
 
+    for (;;) {
         // do nothing if not connected to wifi
         xEventGroupWaitBits(
             wifi_event_group, CONNECTED_BIT, false, true, portMAX_DELAY);
@@ -181,7 +255,6 @@ void BACnetTask(void *pvParameters)
                 ((newtick - tickcount) >= configTICK_RATE_HZ)) {
                 tickcount = newtick;
                 dcc_timer_seconds(1);
-                bvlc_maintenance_timer(1);
                 handler_cov_timer_seconds(1);
                 tsm_timer_milliseconds(1000);
 
@@ -190,14 +263,18 @@ void BACnetTask(void *pvParameters)
                 Analog_Input_Present_Value_Set(1, hall_sens_read());
             }
 
-            pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
-            if (pdu_len) {
-                npdu_handler(&src, &Rx_Buf[0], pdu_len);
+            frame = Ringbuf_Atomic_Peek(&Rx_Queue);
+            if (frame) {
+                npdu_handler(&frame->src, &frame->pdu[0], frame->pdu_len);
+                Ringbuf_Atomic_Pop(&Rx_Queue, NULL);
 
                 if (Binary_Output_Present_Value(0) == BINARY_ACTIVE)
                     gpio_set_level(BACNET_LED, 1);
                 else
                     gpio_set_level(BACNET_LED, 0);
+            } else {
+                // wait for an NPDU from the datalink task, or the timers
+                ulTaskNotifyTake(pdTRUE, 10 / portTICK_PERIOD_MS);
             }
 
             handler_cov_task();
@@ -207,12 +284,17 @@ void BACnetTask(void *pvParameters)
 /* Entry point */
 void app_main()
 {
+    // one producer, the datalink task, and one consumer, the BACnet task
+    Ringbuf_Atomic_Initialize(&Rx_Queue, Rx_Queue_Buffer,
+        sizeof(Rx_Queue_Buffer), sizeof(struct bacnet_rx_frame),
+        BACNET_RX_QUEUE_SIZE, false);
     // Cannot run BACnet code here, the default stack size is to small : 4096
     // byte
-    xTaskCreate(BACnetTask, /* Function to implement the task */
+    xTaskCreatePinnedToCore(BACnetTask, /* Function to implement the task */
         "BACnetTask", /* Name of the task */
         10000, /* Stack size in words */
         NULL, /* Task input parameter */
-        20, /* Priority of the task */
-        NULL); /* Task handle. */
+        BACNET_APP_PRIORITY, /* Priority of the task */
+        &BACnet_Task_Handle, /* Task handle. */
+        BACNET_APP_CORE); /* Core where the task runs */
 }
@@ -0,0 +1,305 @@
+/**
+ * @file
+ * @brief A pool of worker threads for the Linux ports, which runs the
+ *  ReadProperty and ReadPropertyMultiple requests off the receive thread.
+ *
+ * The receive thread runs every service inline, so a device that is
+ * polled by many clients answers one request at a time.  This module lets
+ * the receive thread classify each NPDU: a local, unsegmented ReadProperty
+ * or ReadPropertyMultiple request is copied to a queue and answered by one
+ * of the worker threads, and any other NPDU is handled inline as before.
+ *
+ * The object database is guarded by a reader/writer lock.  The workers
+ * hold it for reading while they answer a request, and the receive thread
+ * holds it for writing while it handles any other NPDU or runs the stack
+ * tasks.  Each thread encodes its replies in its own thread local
+ * Handler_Transmit_Buffer.  The object reads fill lazy caches, so the
+ * Device object serializes them through its read lock callback, while
+ * the decoding, the reply framing, and the datalink sends run in parallel.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/apdu.h"
+#include "bacnet/dcc.h"
+#include "bacnet/npdu.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/service/h_apdu.h"
+#include "bacnet/basic/service/h_rp.h"
+#include "bacnet/basic/service/h_rpm.h"
+#include "bacnet/basic/sys/debug.h"
+#include "apdu-workers.h"
+
+/* a confirmed request that waits for a worker */
+struct apdu_workers_job {
+    BACNET_ADDRESS src;
+    BACNET_CONFIRMED_SERVICE_DATA service_data;
+    uint8_t service_choice;
+    uint16_t service_request_len;
+    uint8_t service_request[MAX_APDU];
+};
+
+static struct apdu_workers_job Job_Queue[APDU_WORKERS_QUEUE_SIZE];
+static unsigned Job_Head;
+static unsigned Job_Count;
+static pthread_mutex_t Job_Mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Job_Ready = PTHREAD_COND_INITIALIZER;
+/* the object database - read by the workers, written by the receiver */
+static pthread_rwlock_t Database_Lock;
+/* serializes the object reads of the workers */
+static pthread_mutex_t Read_Mutex;
+static pthread_t Worker_Thread[APDU_WORKERS_MAX];
+static unsigned Worker_Count;
+static bool Workers_Running;
+static unsigned long Workers_Dispatched;
+
+/**
+ * @brief Lock or unlock the object reads, from the Device object
+ * @param lock - true to lock, false to unlock
+ */
+static void apdu_workers_read_lock(bool lock)
+{
+    if (lock) {
+        pthread_mutex_lock(&Read_Mutex);
+    } else {
+        pthread_mutex_unlock(&Read_Mutex);
+    }
+}
+
+/**
+ * @brief Answer the queued requests until the pool is stopped
+ * @param arg - not used
+ * @return NULL
+ */
+static void *apdu_workers_thread(void *arg)
+{
+    struct apdu_workers_job job;
+    uint8_t *service_request;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&Job_Mutex);
+        while (Workers_Running && (Job_Count == 0)) {
+            pthread_cond_wait(&Job_Ready, &Job_Mutex);
+        }
+        if (!Workers_Running) {
+            pthread_mutex_unlock(&Job_Mutex);
+            break;
+        }
+        job = Job_Queue[Job_Head];
+        Job_Head = (Job_Head + 1) % APDU_WORKERS_QUEUE_SIZE;
+        Job_Count--;
+        pthread_mutex_unlock(&Job_Mutex);
+        service_request = job.service_request_len ? job.service_request : NULL;
+        pthread_rwlock_rdlock(&Database_Lock);
+        if (job.service_choice == SERVICE_CONFIRMED_READ_PROPERTY) {
+            handler_read_property(
+                service_request, job.service_request_len, &job.src,
+                &job.service_data);
+        } else {
+            handler_read_property_multiple(
+                service_request, job.service_request_len, &job.src,
+                &job.service_data);
+        }
+        pthread_rwlock_unlock(&Database_Lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Start the worker threads
+ * @param count - number of worker threads, or 0 for one per processor
+ * @return true if at least one worker thread is running
+ */
+bool apdu_workers_init(unsigned count)
+{
+    pthread_rwlockattr_t rwlock_attr;
+    pthread_mutexattr_t mutex_attr;
+    long processors;
+
+    if (Workers_Running) {
+        return true;
+    }
+#if defined(BACNET_BIP_BATCH) || defined(BACNET_DATALINK_TX_SCHEDULER) || \
+    defined(BACNET_DATALINK_STATISTICS)
+    /* the datalink send queues and counters are not thread safe */
+    debug_fprintf(stderr, "APDU workers: not used with this datalink.\n");
+    return false;
+#endif
+    if (count == 0) {
+        processors = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (processors > 0) ? (unsigned)processors : 1;
+    }
+    if (count > APDU_WORKERS_MAX) {
+        count = APDU_WORKERS_MAX;
+    }
+    /* prefer the receive thread, so a stream of reads cannot starve it */
+    pthread_rwlockattr_init(&rwlock_attr);
+    pthread_rwlockattr_setkind_np(
+        &rwlock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&Database_Lock, &rwlock_attr);
+    pthread_rwlockattr_destroy(&rwlock_attr);
+    /* an object read can read the property lists of its object */
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&Read_Mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    Job_Head = 0;
+    Job_Count = 0;
+    Workers_Running = true;
+    for (Worker_Count = 0; Worker_Count < count; Worker_Count++) {
+        if (pthread_create(
+                &Worker_Thread[Worker_Count], NULL, apdu_workers_thread,
+                NULL) != 0) {
+            break;
+        }
+    }
+    if (Worker_Count == 0) {
+        Workers_Running = false;
+        pthread_rwlock_destroy(&Database_Lock);
+        pthread_mutex_destroy(&Read_Mutex);
+        return false;
+    }
+    Device_Read_Lock_Callback_Set(apdu_workers_read_lock);
+
+    return true;
+}
+
+/**
+ * @brief Stop the worker threads, and drop the requests that are waiting
+ */
+void apdu_workers_cleanup(void)
+{
+    unsigned i;
+
+    if (!Workers_Running) {
+        return;
+    }
+    pthread_mutex_lock(&Job_Mutex);
+    Workers_Running = false;
+    Job_Count = 0;
+    pthread_cond_broadcast(&Job_Ready);
+    pthread_mutex_unlock(&Job_Mutex);
+    for (i = 0; i < Worker_Count; i++) {
+        pthread_join(Worker_Thread[i], NULL);
+    }
+    Worker_Count = 0;
+    Device_Read_Lock_Callback_Set(NULL);
+    pthread_rwlock_destroy(&Database_Lock);
+    pthread_mutex_destroy(&Read_Mutex);
+}
+
+/**
+ * @brief Queue an NPDU for the workers if it is a request that they
+ *  answer: a local, unsegmented ReadProperty or ReadPropertyMultiple
+ *  request.  Any other NPDU is left for npdu_handler(), which is called
+ *  between apdu_workers_lock() and apdu_workers_unlock().
+ * @param src - source address of the NPDU
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes of the NPDU
+ * @return true if the NPDU was queued for the workers
+ */
+bool apdu_workers_dispatch(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
+{
+    BACNET_ADDRESS source;
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    struct apdu_workers_job *job;
+    uint8_t service_choice = 0;
+    uint8_t *service_request = NULL;
+    uint16_t service_request_len = 0;
+    int apdu_offset;
+
+    if (!Workers_Running || !src || !pdu || (pdu_len < 1) ||
+        (pdu[0] != BACNET_PROTOCOL_VERSION)) {
+        return false;
+    }
+    source = *src;
+    apdu_offset = bacnet_npdu_decode(pdu, pdu_len, &dest, &source, &npdu_data);
+    if (npdu_data.network_layer_message || (apdu_offset <= 0) ||
+        (apdu_offset >= pdu_len) || (dest.net != 0) ||
+        ((pdu[apdu_offset] & 0xF0) != PDU_TYPE_CONFIRMED_SERVICE_REQUEST)) {
+        return false;
+    }
+    if (apdu_decode_confirmed_service_request(
+            &pdu[apdu_offset], pdu_len - apdu_offset, &service_data,
+            &service_choice, &service_request, &service_request_len) == 0) {
+        return false;
+    }
+    if ((service_choice != SERVICE_CONFIRMED_READ_PROPERTY) &&
+        (service_choice != SERVICE_CONFIRMED_READ_PROP_MULTIPLE)) {
+        return false;
+    }
+    if (service_data.segmented_message || dcc_communication_disabled()) {
+        return false;
+    }
+#if BACNET_SEGMENTATION_ENABLED
+    if (service_data.segmented_response_accepted) {
+        /* a segmented reply uses the shared TSM and segment buffer */
+        return false;
+    }
+#endif
+    /* the priority that npdu_handler() would give the reply */
+    service_data.priority = npdu_data.data_expecting_reply
+        ? npdu_data.priority
+        : MESSAGE_PRIORITY_NORMAL;
+    pthread_mutex_lock(&Job_Mutex);
+    if (Job_Count >= APDU_WORKERS_QUEUE_SIZE) {
+        pthread_mutex_unlock(&Job_Mutex);
+        return false;
+    }
+    job = &Job_Queue[(Job_Head + Job_Count) % APDU_WORKERS_QUEUE_SIZE];
+    job->src = source;
+    job->service_data = service_data;
+    job->service_choice = service_choice;
+    job->service_request_len = service_request_len;
+    if (service_request_len) {
+        memcpy(job->service_request, service_request, service_request_len);
+    }
+    Job_Count++;
+    pthread_cond_signal(&Job_Ready);
+    pthread_mutex_unlock(&Job_Mutex);
+    Workers_Dispatched++;
+
+    return true;
+}
+
+/**
+ * @brief Lock the object database for writing, while the receive thread
+ *  handles an NPDU or runs the stack tasks
+ */
+void apdu_workers_lock(void)
+{
+    if (Workers_Running) {
+        pthread_rwlock_wrlock(&Database_Lock);
+    }
+}
+
+/**
+ * @brief Unlock the object database after apdu_workers_lock()
+ */
+void apdu_workers_unlock(void)
+{
+    if (Workers_Running) {
+        pthread_rwlock_unlock(&Database_Lock);
+    }
+}
+
+/**
+ * @brief Get the number of requests that were queued for the workers
+ * @return number of requests
+ */
+unsigned long apdu_workers_dispatched(void)
+{
+    return Workers_Dispatched;
+}
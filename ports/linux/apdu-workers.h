@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief A pool of worker threads for the Linux ports, which runs the
+ *  ReadProperty and ReadPropertyMultiple requests off the receive thread.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_PORT_LINUX_APDU_WORKERS_H
+#define BACNET_PORT_LINUX_APDU_WORKERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* maximum number of worker threads */
+#ifndef APDU_WORKERS_MAX
+#define APDU_WORKERS_MAX 8
+#endif
+
+/* number of requests that can wait for a worker */
+#ifndef APDU_WORKERS_QUEUE_SIZE
+#define APDU_WORKERS_QUEUE_SIZE 32
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool apdu_workers_init(unsigned count);
+BACNET_STACK_EXPORT
+void apdu_workers_cleanup(void);
+
+BACNET_STACK_EXPORT
+bool apdu_workers_dispatch(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len);
+
+BACNET_STACK_EXPORT
+void apdu_workers_lock(void);
+BACNET_STACK_EXPORT
+void apdu_workers_unlock(void);
+
+BACNET_STACK_EXPORT
+unsigned long apdu_workers_dispatched(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -5,6 +5,10 @@
  * @date 2005
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#if defined(BACNET_BIP_BATCH) && !defined(_GNU_SOURCE)
+/* for recvmmsg() and sendmmsg() */
+#define _GNU_SOURCE
+#endif
 #include <asm/types.h>
 #include <netinet/ether.h>
 #include <netinet/in.h>
@@ -27,7 +31,9 @@
 #include "bacnet/bacdcode.h"
 #include "bacnet/bacint.h"
 #include "bacnet/datalink/bip.h"
+#include "bacnet/datalink/dlstats.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/trace.h"
 #include "bacnet/basic/bbmd/h_bbmd.h"
 #include "bacport.h"
 
@@ -55,6 +61,26 @@ static bool BIP_Debug = false;
 /* interface name */
 static char BIP_Interface_Name[IF_NAMESIZE] = { 0 };
 
+#if defined(BACNET_BIP_BATCH)
+/* number of datagrams received or sent with one system call */
+#ifndef BIP_BATCH_SIZE
+#define BIP_BATCH_SIZE 16
+#endif
+/* ring of received datagrams */
+static uint8_t BIP_Rx_Ring[BIP_BATCH_SIZE][BIP_MPDU_MAX];
+static struct sockaddr_in BIP_Rx_Source[BIP_BATCH_SIZE];
+static struct iovec BIP_Rx_Iov[BIP_BATCH_SIZE];
+static struct mmsghdr BIP_Rx_Msg[BIP_BATCH_SIZE];
+/* queue of datagrams waiting to be sent */
+static uint8_t BIP_Tx_Ring[BIP_BATCH_SIZE][BIP_MPDU_MAX];
+static struct sockaddr_in BIP_Tx_Dest[BIP_BATCH_SIZE];
+static struct iovec BIP_Tx_Iov[BIP_BATCH_SIZE];
+static struct mmsghdr BIP_Tx_Msg[BIP_BATCH_SIZE];
+static unsigned BIP_Tx_Count;
+/* true when datagrams are queued until bip_send_flush() */
+static bool BIP_Tx_Batch;
+#endif
+
 /**
  * @brief Print the IPv4 address with debug info
  * @param str - debug info string
@@ -67,10 +93,10 @@ static void debug_print_ipv4(
     const unsigned int count)
 {
     if (BIP_Debug) {
-        debug_fprintf(
-            stderr, "BIP: %s %s:%hu (%u bytes)\n", str, inet_ntoa(*addr),
+        debug_log(
+            DEBUG_CATEGORY_DATALINK, DEBUG_LEVEL_DEBUG,
+            "BIP: %s %s:%hu (%u bytes)\n", str, inet_ntoa(*addr),
             ntohs(port), count);
-        fflush(stderr);
     }
 }
 
@@ -297,6 +323,7 @@ int bip_send_mpdu(
     const BACNET_IP_ADDRESS *dest, const uint8_t *mtu, uint16_t mtu_len)
 {
     struct sockaddr_in bip_dest = { 0 };
+    int bytes_sent;
 
     /* assumes that the driver has already been initialized */
     if (BIP_Socket < 0) {
@@ -310,43 +337,50 @@ int bip_send_mpdu(
     bip_dest.sin_family = AF_INET;
     memcpy(&bip_dest.sin_addr.s_addr, &dest->address[0], 4);
     bip_dest.sin_port = htons(dest->port);
+#if defined(BACNET_BIP_BATCH)
+    if (BIP_Tx_Batch && (mtu_len <= BIP_MPDU_MAX)) {
+        if (BIP_Tx_Count >= BIP_BATCH_SIZE) {
+            bip_send_flush();
+        }
+        memcpy(&BIP_Tx_Ring[BIP_Tx_Count][0], mtu, mtu_len);
+        BIP_Tx_Dest[BIP_Tx_Count] = bip_dest;
+        BIP_Tx_Iov[BIP_Tx_Count].iov_len = mtu_len;
+        BIP_Tx_Count++;
+        DLSTATS_SEND(PORT_TYPE_BIP, mtu_len);
+        DLSTATS_QUEUE_DEPTH(PORT_TYPE_BIP, BIP_Tx_Count);
+        BACNET_TRACE1(bip_send, mtu_len);
+        debug_print_ipv4(
+            "Queued MPDU->", &bip_dest.sin_addr, bip_dest.sin_port, mtu_len);
+        return mtu_len;
+    }
+#endif
     /* Send the packet */
     debug_print_ipv4(
         "Sending MPDU->", &bip_dest.sin_addr, bip_dest.sin_port, mtu_len);
-    return sendto(
+    bytes_sent = sendto(
         BIP_Socket, (const char *)mtu, mtu_len, 0, (struct sockaddr *)&bip_dest,
         sizeof(struct sockaddr));
+    if (bytes_sent > 0) {
+        DLSTATS_SEND(PORT_TYPE_BIP, bytes_sent);
+        BACNET_TRACE1(bip_send, bytes_sent);
+    } else {
+        DLSTATS_DROP(PORT_TYPE_BIP);
+    }
+
+    return bytes_sent;
 }
 
 /**
- * BACnet/IP Datalink Receive handler.
- *
- * @param src - returns the source address
- * @param npdu - returns the NPDU buffer
- * @param max_npdu -maximum size of the NPDU buffer
+ * @brief Wait for a datagram on either of the BACnet/IP sockets
  * @param timeout - number of milliseconds to wait for a packet
- *
- * @return Number of bytes received, or 0 if none or timeout.
+ * @param read_fds - returns the sockets that are ready to read
+ * @return true if a socket is ready to read
  */
-uint16_t bip_receive(
-    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+static bool bip_wait(unsigned timeout, fd_set *read_fds)
 {
-    uint16_t npdu_len = 0; /* return value */
-    fd_set read_fds;
     int max = 0;
     struct timeval select_timeout;
-    struct sockaddr_in sin = { 0 };
-    BACNET_IP_ADDRESS addr = { 0 };
-    socklen_t sin_len = sizeof(sin);
-    int received_bytes = 0;
-    int offset = 0;
-    uint16_t i = 0;
-    int socket;
 
-    /* Make sure the socket is open */
-    if (BIP_Socket < 0) {
-        return 0;
-    }
     /* we could just use a non-blocking socket, but that consumes all
        the CPU time.  We can use a timeout; it is only supported as
        a select. */
@@ -358,76 +392,388 @@ uint16_t bip_receive(
         select_timeout.tv_sec = 0;
         select_timeout.tv_usec = 1000 * timeout;
     }
-    FD_ZERO(&read_fds);
-    FD_SET(BIP_Socket, &read_fds);
-    FD_SET(BIP_Broadcast_Socket, &read_fds);
+    FD_ZERO(read_fds);
+    FD_SET(BIP_Socket, read_fds);
+    FD_SET(BIP_Broadcast_Socket, read_fds);
 
     max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
 
     /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        socket =
-            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
-        received_bytes = recvfrom(
-            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
-            &sin_len);
-    } else {
-        return 0;
-    }
-    /* See if there is a problem */
-    if (received_bytes < 0) {
-        return 0;
-    }
-    /* no problem, just no bytes */
-    if (received_bytes == 0) {
+    return (select(max + 1, read_fds, NULL, NULL, &select_timeout) > 0);
+}
+
+/**
+ * @brief Pass a received datagram into the BBMD handler
+ * @param socket - the socket that received the datagram
+ * @param sin - the source of the datagram
+ * @param src - returns the source address
+ * @param mtu - the received BVLC message
+ * @param received_bytes - number of bytes in the BVLC message
+ * @return offset of the NPDU in the mtu buffer, or 0 if there is no NPDU
+ */
+static int bip_mpdu_handler(
+    int socket,
+    const struct sockaddr_in *sin,
+    BACNET_ADDRESS *src,
+    uint8_t *mtu,
+    int received_bytes)
+{
+    BACNET_IP_ADDRESS addr = { 0 };
+    int offset = 0;
+
+    /* See if there is a problem, or just no bytes */
+    if (received_bytes <= 0) {
         return 0;
     }
+    DLSTATS_RECEIVE(PORT_TYPE_BIP, received_bytes);
+    BACNET_TRACE1(bip_receive, received_bytes);
     /* the signature of a BACnet/IPv packet */
-    if (npdu[0] != BVLL_TYPE_BACNET_IP) {
+    if (mtu[0] != BVLL_TYPE_BACNET_IP) {
+        DLSTATS_DECODE_ERROR(PORT_TYPE_BIP);
         return 0;
     }
-    /* Erase up to 16 bytes after the received bytes as safety margin to
-     * ensure that the decoding functions will run into a 'safe field'
-     * of zero, if for any reason they would overrun, when parsing the
-     * message. */
-    max = (int)max_npdu - received_bytes;
-    if (max > 0) {
-        if (max > 16) {
-            max = 16;
-        }
-        memset(&npdu[received_bytes], 0, max);
-    }
     /* Data link layer addressing between B/IPv4 nodes consists of a 32-bit
        IPv4 address followed by a two-octet UDP port number (both of which
        shall be transmitted with the most significant octet first). This
        address shall be referred to as a B/IPv4 address.
     */
-    memcpy(&addr.address[0], &sin.sin_addr.s_addr, 4);
-    addr.port = ntohs(sin.sin_port);
+    memcpy(&addr.address[0], &sin->sin_addr.s_addr, 4);
+    addr.port = ntohs(sin->sin_port);
     debug_print_ipv4(
-        "Received MPDU->", &sin.sin_addr, sin.sin_port, received_bytes);
+        "Received MPDU->", &sin->sin_addr, sin->sin_port, received_bytes);
     /* pass the packet into the BBMD handler */
     if (socket == BIP_Socket) {
-        offset = bvlc_handler(&addr, src, npdu, received_bytes);
+        offset = bvlc_handler(&addr, src, mtu, received_bytes);
     } else {
-        offset = bvlc_broadcast_handler(&addr, src, npdu, received_bytes);
+        offset = bvlc_broadcast_handler(&addr, src, mtu, received_bytes);
     }
     if (offset > 0) {
-        npdu_len = received_bytes - offset;
         debug_print_ipv4(
-            "Received NPDU->", &sin.sin_addr, sin.sin_port, npdu_len);
-        if (npdu_len <= max_npdu) {
-            /* shift the buffer to return a valid NPDU */
-            for (i = 0; i < npdu_len; i++) {
-                npdu[i] = npdu[offset + i];
+            "Received NPDU->", &sin->sin_addr, sin->sin_port,
+            received_bytes - offset);
+    } else {
+        offset = 0;
+    }
+
+    return offset;
+}
+
+/**
+ * BACnet/IP Datalink Receive handler that leaves the NPDU in place
+ * after the BVLC header, so it can be decoded without a copy.
+ *
+ * @param src - returns the source address
+ * @param mtu - returns the received BVLC message
+ * @param max_mtu - maximum size of the BVLC message buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ * @param npdu_offset - returns the offset of the NPDU in the mtu buffer
+ *
+ * @return Number of NPDU bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive_npdu(
+    BACNET_ADDRESS *src,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    unsigned timeout,
+    uint16_t *npdu_offset)
+{
+    uint16_t npdu_len = 0; /* return value */
+    fd_set read_fds;
+    struct sockaddr_in sin = { 0 };
+    socklen_t sin_len = sizeof(sin);
+    int received_bytes = 0;
+    int offset = 0;
+    int socket;
+
+    /* Make sure the socket is open */
+    if (BIP_Socket < 0) {
+        return 0;
+    }
+#if defined(BACNET_BIP_BATCH)
+    bip_send_flush();
+#endif
+    if (!bip_wait(timeout, &read_fds)) {
+        return 0;
+    }
+    socket =
+        FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
+    received_bytes = recvfrom(
+        socket, (char *)&mtu[0], max_mtu, 0, (struct sockaddr *)&sin,
+        &sin_len);
+    offset = bip_mpdu_handler(socket, &sin, src, mtu, received_bytes);
+    if (offset > 0) {
+        npdu_len = received_bytes - offset;
+        if (npdu_offset) {
+            *npdu_offset = (uint16_t)offset;
+        }
+    }
+
+    return npdu_len;
+}
+
+#if defined(BACNET_BIP_BATCH)
+/**
+ * @brief Receive a batch of datagrams from one socket with recvmmsg()
+ * @param socket - the socket that is ready to read
+ * @param packets - returns the received NPDUs
+ * @param count - number of packets already returned
+ * @param max_packets - maximum number of packets to return
+ * @return number of packets returned
+ */
+static unsigned bip_receive_batch(
+    int socket,
+    BACNET_DATALINK_PACKET *packets,
+    unsigned count,
+    unsigned max_packets)
+{
+    unsigned first = count;
+    unsigned i;
+    int received;
+    int offset;
+
+    if (max_packets > BIP_BATCH_SIZE) {
+        max_packets = BIP_BATCH_SIZE;
+    }
+    if (count >= max_packets) {
+        return count;
+    }
+    for (i = first; i < max_packets; i++) {
+        BIP_Rx_Iov[i].iov_base = &BIP_Rx_Ring[i][0];
+        BIP_Rx_Iov[i].iov_len = sizeof(BIP_Rx_Ring[i]);
+        memset(&BIP_Rx_Msg[i], 0, sizeof(BIP_Rx_Msg[i]));
+        BIP_Rx_Msg[i].msg_hdr.msg_iov = &BIP_Rx_Iov[i];
+        BIP_Rx_Msg[i].msg_hdr.msg_iovlen = 1;
+        BIP_Rx_Msg[i].msg_hdr.msg_name = &BIP_Rx_Source[i];
+        BIP_Rx_Msg[i].msg_hdr.msg_namelen = sizeof(BIP_Rx_Source[i]);
+    }
+    received = recvmmsg(
+        socket, &BIP_Rx_Msg[first], max_packets - first, MSG_DONTWAIT, NULL);
+    for (i = first; (received > 0) && (i < (first + (unsigned)received));
+         i++) {
+        offset = bip_mpdu_handler(
+            socket, &BIP_Rx_Source[i], &packets[count].src, &BIP_Rx_Ring[i][0],
+            (int)BIP_Rx_Msg[i].msg_len);
+        if (offset > 0) {
+            packets[count].pdu = &BIP_Rx_Ring[i][offset];
+            packets[count].pdu_len =
+                (uint16_t)(BIP_Rx_Msg[i].msg_len - offset);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * BACnet/IP Datalink Receive handler for many datagrams at once.
+ * The queued datagrams are sent first, then the ready sockets are read
+ * with one recvmmsg() each.  The NPDUs are returned in place in the
+ * receive ring, and stay valid until the next call.
+ *
+ * @param packets - returns the source address and NPDU of each packet
+ * @param max_packets - maximum number of packets to return
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of packets returned, or 0 if none or timeout.
+ */
+unsigned bip_receive_many(
+    BACNET_DATALINK_PACKET *packets, unsigned max_packets, unsigned timeout)
+{
+    fd_set read_fds;
+    unsigned count = 0;
+
+    /* Make sure the socket is open */
+    if ((BIP_Socket < 0) || !packets) {
+        return 0;
+    }
+    bip_send_flush();
+    if (!bip_wait(timeout, &read_fds)) {
+        return 0;
+    }
+    if (FD_ISSET(BIP_Socket, &read_fds)) {
+        count = bip_receive_batch(BIP_Socket, packets, count, max_packets);
+    }
+    if ((BIP_Broadcast_Socket != BIP_Socket) &&
+        FD_ISSET(BIP_Broadcast_Socket, &read_fds)) {
+        count = bip_receive_batch(
+            BIP_Broadcast_Socket, packets, count, max_packets);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Send the queued datagrams with sendmmsg()
+ */
+void bip_send_flush(void)
+{
+    unsigned i;
+    unsigned sent = 0;
+    int len;
+
+    for (i = 0; i < BIP_Tx_Count; i++) {
+        BIP_Tx_Iov[i].iov_base = &BIP_Tx_Ring[i][0];
+        memset(&BIP_Tx_Msg[i], 0, sizeof(BIP_Tx_Msg[i]));
+        BIP_Tx_Msg[i].msg_hdr.msg_iov = &BIP_Tx_Iov[i];
+        BIP_Tx_Msg[i].msg_hdr.msg_iovlen = 1;
+        BIP_Tx_Msg[i].msg_hdr.msg_name = &BIP_Tx_Dest[i];
+        BIP_Tx_Msg[i].msg_hdr.msg_namelen = sizeof(BIP_Tx_Dest[i]);
+    }
+    while ((BIP_Socket >= 0) && (sent < BIP_Tx_Count)) {
+        len = sendmmsg(BIP_Socket, &BIP_Tx_Msg[sent], BIP_Tx_Count - sent, 0);
+        if (len <= 0) {
+            if (BIP_Debug) {
+                debug_fprintf(stderr, "BIP: sendmmsg failed!\n");
+                fflush(stderr);
             }
-        } else {
+            break;
+        }
+        sent += (unsigned)len;
+    }
+    for (i = sent; i < BIP_Tx_Count; i++) {
+        DLSTATS_DROP(PORT_TYPE_BIP);
+    }
+    BIP_Tx_Count = 0;
+    DLSTATS_QUEUE_DEPTH(PORT_TYPE_BIP, 0);
+}
+
+/**
+ * @brief Enable or disable the queueing of sent datagrams.  When enabled,
+ *  datagrams are sent by bip_send_flush(), when the queue is full, and
+ *  before each receive.
+ * @param enable - true to queue the sent datagrams
+ */
+void bip_send_batch_set(bool enable)
+{
+    if (!enable) {
+        bip_send_flush();
+    }
+    BIP_Tx_Batch = enable;
+}
+
+/**
+ * @brief Set the size of the kernel receive buffer of the sockets, so
+ *  that a burst of datagrams, such as the I-Am replies to a global
+ *  Who-Is, is queued instead of dropped while it is being processed.
+ * @param size - requested number of bytes of the receive buffer
+ * @return the number of bytes granted, which the kernel may limit
+ *  to net.core.rmem_max, or 0 if the driver is not initialized
+ */
+unsigned bip_receive_buffer_set(unsigned size)
+{
+    int sockopt = (int)size;
+    socklen_t sockopt_len = sizeof(sockopt);
+
+    if (BIP_Socket < 0) {
+        return 0;
+    }
+    (void)setsockopt(
+        BIP_Socket, SOL_SOCKET, SO_RCVBUF, &sockopt, sizeof(sockopt));
+    if ((BIP_Broadcast_Socket >= 0) && (BIP_Broadcast_Socket != BIP_Socket)) {
+        (void)setsockopt(
+            BIP_Broadcast_Socket, SOL_SOCKET, SO_RCVBUF, &sockopt,
+            sizeof(sockopt));
+    }
+    sockopt = 0;
+    if (getsockopt(
+            BIP_Socket, SOL_SOCKET, SO_RCVBUF, &sockopt, &sockopt_len) < 0) {
+        return 0;
+    }
+    /* the kernel doubles the size for its bookkeeping */
+    sockopt /= 2;
+
+    return (sockopt > 0) ? (unsigned)sockopt : 0;
+}
+
+/**
+ * @brief Send one MPDU to many destinations with sendmmsg(), such as
+ *  a BBMD Forwarded-NPDU to each BDT and FDT entry.  The MPDU is shared
+ *  by all of the messages and is not copied.
+ * @param dest - the destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ * @return number of datagrams sent, or -1 if the driver is not initialized
+ */
+int bip_send_mpdu_many(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    struct sockaddr_in bip_dest[BIP_BATCH_SIZE];
+    struct mmsghdr msg[BIP_BATCH_SIZE];
+    struct iovec iov;
+    unsigned sent = 0;
+    unsigned count;
+    unsigned i;
+    int len;
+
+    if (BIP_Socket < 0) {
+        return BIP_Socket;
+    }
+    /* keep the queued datagrams in order */
+    bip_send_flush();
+    iov.iov_base = (void *)mtu;
+    iov.iov_len = mtu_len;
+    while (sent < dest_count) {
+        count = dest_count - sent;
+        if (count > BIP_BATCH_SIZE) {
+            count = BIP_BATCH_SIZE;
+        }
+        for (i = 0; i < count; i++) {
+            memset(&bip_dest[i], 0, sizeof(bip_dest[i]));
+            bip_dest[i].sin_family = AF_INET;
+            memcpy(
+                &bip_dest[i].sin_addr.s_addr, &dest[sent + i].address[0], 4);
+            bip_dest[i].sin_port = htons(dest[sent + i].port);
+            memset(&msg[i], 0, sizeof(msg[i]));
+            msg[i].msg_hdr.msg_iov = &iov;
+            msg[i].msg_hdr.msg_iovlen = 1;
+            msg[i].msg_hdr.msg_name = &bip_dest[i];
+            msg[i].msg_hdr.msg_namelen = sizeof(bip_dest[i]);
+        }
+        len = sendmmsg(BIP_Socket, &msg[0], count, 0);
+        if (len <= 0) {
             if (BIP_Debug) {
-                debug_fprintf(stderr, "BIP: NPDU dropped!\n");
+                debug_fprintf(stderr, "BIP: sendmmsg failed!\n");
                 fflush(stderr);
             }
-            npdu_len = 0;
+            break;
         }
+        for (i = 0; i < (unsigned)len; i++) {
+            DLSTATS_SEND(PORT_TYPE_BIP, mtu_len);
+        }
+        sent += (unsigned)len;
+    }
+    for (i = sent; i < dest_count; i++) {
+        DLSTATS_DROP(PORT_TYPE_BIP);
+    }
+
+    return (int)sent;
+}
+#endif
+
+/**
+ * BACnet/IP Datalink Receive handler.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    uint16_t npdu_len = 0;
+    uint16_t offset = 0;
+
+    npdu_len = bip_receive_npdu(src, npdu, max_npdu, timeout, &offset);
+    if ((npdu_len > 0) && (offset > 0)) {
+        /* shift the buffer to return a valid NPDU */
+        memmove(&npdu[0], &npdu[offset], npdu_len);
     }
 
     return npdu_len;
@@ -994,6 +1340,9 @@ bool bip_valid(void)
  */
 void bip_cleanup(void)
 {
+#if defined(BACNET_BIP_BATCH)
+    bip_send_flush();
+#endif
     if (BIP_Socket != -1) {
         close(BIP_Socket);
     }
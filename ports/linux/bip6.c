@@ -5,6 +5,10 @@
  * @date 2016
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#if defined(BACNET_BIP_BATCH) && !defined(_GNU_SOURCE)
+/* for sendmmsg() */
+#define _GNU_SOURCE
+#endif
 #include <ifaddrs.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,6 +18,7 @@
 #include "bacnet/bacdcode.h"
 #include "bacnet/config.h"
 #include "bacnet/datalink/bip6.h"
+#include "bacnet/datalink/dlstats.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/bbmd6/h_bbmd6.h"
@@ -227,6 +232,33 @@ bool bip6_get_broadcast_addr(BACNET_IP6_ADDRESS *addr)
     return bvlc6_address_copy(addr, &BIP6_Broadcast_Addr);
 }
 
+/**
+ * @brief Load a socket address from a BACnet/IPv6 address
+ * @param bvlc_dest - socket address to load
+ * @param dest - BACnet/IPv6 address
+ */
+static void bip6_sockaddr_set(
+    struct sockaddr_in6 *bvlc_dest, const BACNET_IP6_ADDRESS *dest)
+{
+    uint16_t addr16[8];
+
+    memset(bvlc_dest, 0, sizeof(*bvlc_dest));
+    bvlc_dest->sin6_family = AF_INET6;
+    bvlc6_address_get(
+        dest, &addr16[0], &addr16[1], &addr16[2], &addr16[3], &addr16[4],
+        &addr16[5], &addr16[6], &addr16[7]);
+    bvlc_dest->sin6_addr.s6_addr16[0] = htons(addr16[0]);
+    bvlc_dest->sin6_addr.s6_addr16[1] = htons(addr16[1]);
+    bvlc_dest->sin6_addr.s6_addr16[2] = htons(addr16[2]);
+    bvlc_dest->sin6_addr.s6_addr16[3] = htons(addr16[3]);
+    bvlc_dest->sin6_addr.s6_addr16[4] = htons(addr16[4]);
+    bvlc_dest->sin6_addr.s6_addr16[5] = htons(addr16[5]);
+    bvlc_dest->sin6_addr.s6_addr16[6] = htons(addr16[6]);
+    bvlc_dest->sin6_addr.s6_addr16[7] = htons(addr16[7]);
+    bvlc_dest->sin6_port = htons(dest->port);
+    bvlc_dest->sin6_scope_id = BIP6_Socket_Scope_Id;
+}
+
 /**
  * The send function for BACnet/IPv6 driver layer
  *
@@ -242,34 +274,89 @@ int bip6_send_mpdu(
     const BACNET_IP6_ADDRESS *dest, const uint8_t *mtu, uint16_t mtu_len)
 {
     struct sockaddr_in6 bvlc_dest = { 0 };
-    uint16_t addr16[8];
+    int bytes_sent;
 
     /* assumes that the driver has already been initialized */
     if (BIP6_Socket < 0) {
         return 0;
     }
     /* load destination IP address */
-    bvlc_dest.sin6_family = AF_INET6;
-    bvlc6_address_get(
-        dest, &addr16[0], &addr16[1], &addr16[2], &addr16[3], &addr16[4],
-        &addr16[5], &addr16[6], &addr16[7]);
-    bvlc_dest.sin6_addr.s6_addr16[0] = htons(addr16[0]);
-    bvlc_dest.sin6_addr.s6_addr16[1] = htons(addr16[1]);
-    bvlc_dest.sin6_addr.s6_addr16[2] = htons(addr16[2]);
-    bvlc_dest.sin6_addr.s6_addr16[3] = htons(addr16[3]);
-    bvlc_dest.sin6_addr.s6_addr16[4] = htons(addr16[4]);
-    bvlc_dest.sin6_addr.s6_addr16[5] = htons(addr16[5]);
-    bvlc_dest.sin6_addr.s6_addr16[6] = htons(addr16[6]);
-    bvlc_dest.sin6_addr.s6_addr16[7] = htons(addr16[7]);
-    bvlc_dest.sin6_port = htons(dest->port);
-    bvlc_dest.sin6_scope_id = BIP6_Socket_Scope_Id;
+    bip6_sockaddr_set(&bvlc_dest, dest);
     debug_print_ipv6("Sending MPDU->", &bvlc_dest.sin6_addr);
     /* Send the packet */
-    return sendto(
+    bytes_sent = sendto(
         BIP6_Socket, (const char *)mtu, mtu_len, 0,
         (struct sockaddr *)&bvlc_dest, sizeof(bvlc_dest));
+    if (bytes_sent > 0) {
+        DLSTATS_SEND(PORT_TYPE_BIP6, bytes_sent);
+    } else {
+        DLSTATS_DROP(PORT_TYPE_BIP6);
+    }
+
+    return bytes_sent;
 }
 
+#if defined(BACNET_BIP_BATCH)
+/**
+ * @brief Send one MPDU to many destinations with sendmmsg(), such as
+ *  a BBMD Forwarded-NPDU to each BDT and FDT entry.  The MPDU is shared
+ *  by all of the messages and is not copied.
+ * @param dest - the destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ * @return number of datagrams sent, or 0 if the driver is not initialized
+ */
+int bip6_send_mpdu_many(
+    const BACNET_IP6_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    struct sockaddr_in6 bvlc_dest[BIP6_BATCH_SIZE];
+    struct mmsghdr msg[BIP6_BATCH_SIZE];
+    struct iovec iov;
+    unsigned sent = 0;
+    unsigned count;
+    unsigned i;
+    int len;
+
+    if (BIP6_Socket < 0) {
+        return 0;
+    }
+    iov.iov_base = (void *)mtu;
+    iov.iov_len = mtu_len;
+    while (sent < dest_count) {
+        count = dest_count - sent;
+        if (count > BIP6_BATCH_SIZE) {
+            count = BIP6_BATCH_SIZE;
+        }
+        for (i = 0; i < count; i++) {
+            bip6_sockaddr_set(&bvlc_dest[i], &dest[sent + i]);
+            memset(&msg[i], 0, sizeof(msg[i]));
+            msg[i].msg_hdr.msg_iov = &iov;
+            msg[i].msg_hdr.msg_iovlen = 1;
+            msg[i].msg_hdr.msg_name = &bvlc_dest[i];
+            msg[i].msg_hdr.msg_namelen = sizeof(bvlc_dest[i]);
+        }
+        len = sendmmsg(BIP6_Socket, &msg[0], count, 0);
+        if (len <= 0) {
+            debug_printf("BIP6: sendmmsg failed!\n");
+            break;
+        }
+        for (i = 0; i < (unsigned)len; i++) {
+            DLSTATS_SEND(PORT_TYPE_BIP6, mtu_len);
+        }
+        sent += (unsigned)len;
+    }
+    for (i = sent; i < dest_count; i++) {
+        DLSTATS_DROP(PORT_TYPE_BIP6);
+    }
+
+    return (int)sent;
+}
+#endif
+
 /**
  * The common send function for BACnet/IPv6 application layer
  *
@@ -349,8 +436,10 @@ uint16_t bip6_receive(
     if (received_bytes == 0) {
         return 0;
     }
+    DLSTATS_RECEIVE(PORT_TYPE_BIP6, received_bytes);
     /* the signature of a BACnet/IPv6 packet */
     if (npdu[0] != BVLL_TYPE_BACNET_IP6) {
+        DLSTATS_DECODE_ERROR(PORT_TYPE_BIP6);
         return 0;
     }
     /* pass the packet into the BBMD handler */
@@ -378,6 +467,15 @@ uint16_t bip6_receive(
     return npdu_len;
 }
 
+/**
+ * @brief Return the active BACnet/IPv6 socket.
+ * @return The active BACnet/IPv6 socket, or -1 if uninitialized.
+ */
+int bip6_get_socket(void)
+{
+    return BIP6_Socket;
+}
+
 /** Cleanup and close out the BACnet/IP services by closing the socket.
  * @ingroup DLBIP6
  */
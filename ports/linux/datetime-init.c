@@ -20,6 +20,11 @@
 #include "bacnet/datetime.h"
 
 static int32_t Time_Offset; /* Time offset in ms */
+/* local time of the last second that was converted, since the local time
+   only changes once per second and converting it is costly */
+static time_t Local_Time_Seconds;
+static struct tm Local_Time;
+static bool Local_Time_Valid;
 
 /**
  * @brief Calculate the time offset from the system clock.
@@ -92,7 +97,15 @@ bool datetime_local(
         to = Time_Offset;
         tv.tv_sec += (int)to / 1000;
         tv.tv_usec += (to % 1000) * 1000;
-        tblock = (struct tm *)localtime((const time_t *)&tv.tv_sec);
+        if (Local_Time_Valid && (Local_Time_Seconds == tv.tv_sec)) {
+            tblock = &Local_Time;
+        } else {
+            /* localtime_r() need not set the timezone global */
+            tzset();
+            tblock = localtime_r(&tv.tv_sec, &Local_Time);
+            Local_Time_Valid = (tblock != NULL);
+            Local_Time_Seconds = tv.tv_sec;
+        }
     }
     if (tblock) {
         status = true;
@@ -12,6 +12,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/time.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -20,29 +23,38 @@
 #include "bacnet/npdu.h"
 #include "bacnet/datalink/mstp.h"
 #include "bacnet/datalink/dlmstp.h"
-#include "bacnet/basic/sys/ringbuf.h"
+#include "bacnet/datalink/dlstats.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/trace.h"
 /* OS Specific include */
 #include "bacport.h"
 /* port specific */
+#include "lockstat-mutex.h"
 #include "rs485.h"
-
+#include "thread-sched.h"
+
+/* single-producer, single-consumer queue of fixed size packets.
+   The producer only writes the tail and the consumer only writes the head,
+   so the MS/TP thread never waits on a lock held by the application. */
+struct dlmstp_queue {
+    uint8_t *buffer;
+    size_t element_size;
+    unsigned element_count; /* power of 2 */
+    unsigned head; /* next packet to take, written by the consumer */
+    unsigned tail; /* next packet to fill, written by the producer */
+};
 /* packet queues */
 #ifndef MSTP_RECEIVE_PACKET_COUNT
 #define MSTP_RECEIVE_PACKET_COUNT 8
 #endif
+#if (MSTP_RECEIVE_PACKET_COUNT & (MSTP_RECEIVE_PACKET_COUNT - 1))
+#error "MSTP_RECEIVE_PACKET_COUNT must be a power of 2"
+#endif
 static DLMSTP_PACKET Receive_Buffer[MSTP_RECEIVE_PACKET_COUNT];
-static RING_BUFFER Receive_Queue;
+static struct dlmstp_queue Receive_Queue;
 /* mechanism to wait for a packet */
-static pthread_cond_t Receive_Packet_Flag;
-static pthread_mutex_t Receive_Packet_Mutex;
-static pthread_cond_t Received_Frame_Flag;
-static pthread_mutex_t Received_Frame_Mutex;
-static pthread_cond_t Master_Done_Flag;
-static pthread_mutex_t Master_Done_Mutex;
-static pthread_mutex_t Ring_Buffer_Mutex;
-static pthread_mutex_t Thread_Mutex;
+static int Receive_Event_Fd = -1;
 static pthread_t hThread;
 static struct timespec Clock_Get_Time_Start;
 static bool Thread_Run;
@@ -53,17 +65,30 @@ static uint8_t TxBuffer[DLMSTP_MPDU_MAX];
 static uint8_t RxBuffer[DLMSTP_MPDU_MAX];
 /* data structure for MS/TP PDU Queue */
 struct mstp_pdu_packet {
+    /* true once sent out of order as a reply; written by the consumer */
+    bool sent;
     bool data_expecting_reply;
     uint8_t destination_mac;
     uint16_t length;
     uint8_t buffer[DLMSTP_MPDU_MAX];
 };
-/* count must be a power of 2 for ringbuf library */
+/* count must be a power of 2 for the queue index arithmetic */
 #ifndef MSTP_PDU_PACKET_COUNT
 #define MSTP_PDU_PACKET_COUNT 8
 #endif
+#if (MSTP_PDU_PACKET_COUNT & (MSTP_PDU_PACKET_COUNT - 1))
+#error "MSTP_PDU_PACKET_COUNT must be a power of 2"
+#endif
 static struct mstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
-static RING_BUFFER PDU_Queue;
+static struct dlmstp_queue PDU_Queue;
+#if defined(BACNET_LOCK_STATISTICS)
+/* depths of the queues, sampled by their producers */
+static LOCKSTAT_QUEUE Receive_Queue_Stats = LOCKSTAT_QUEUE_INIT("mstp-receive");
+static LOCKSTAT_QUEUE PDU_Queue_Stats = LOCKSTAT_QUEUE_INIT("mstp-transmit");
+#endif
+/* reply made in the MS/TP thread to the DATA_EXPECTING_REPLY frame */
+static dlmstp_hook_reply_cb Reply_Callback;
+static struct mstp_pdu_packet Fast_Reply;
 /* local timer for tracking silence on the wire */
 static struct mstimer Silence_Timer;
 /* local timer for tracking the last valid frame on the wire */
@@ -74,29 +99,180 @@ static dlmstp_hook_frame_rx_complete_cb Valid_Frame_Rx_Callback;
 static dlmstp_hook_frame_rx_complete_cb Valid_Frame_Not_For_Us_Rx_Callback;
 static dlmstp_hook_frame_rx_complete_cb Invalid_Frame_Rx_Callback;
 static DLMSTP_STATISTICS DLMSTP_Statistics;
+static struct mstp_port_statistics MSTP_Statistics;
+/* the stations that receive extended frames */
+static struct mstp_extended_frame_peers MSTP_Extended_Frame_Peers;
+#if defined(BACNET_MSTP_POLL_BACKOFF)
+/* poll the empty addresses of a sparse trunk less often */
+static struct mstp_poll_schedule MSTP_Poll_Schedule;
+#endif
 static bool DLMSTP_Initialized;
 
+/**
+ * @brief Initialize a single-producer, single-consumer queue
+ * @param queue - the queue to initialize
+ * @param buffer - storage for element_count elements
+ * @param element_size - size of one element
+ * @param element_count - number of elements, which is a power of 2
+ */
+static void dlmstp_queue_init(
+    struct dlmstp_queue *queue,
+    uint8_t *buffer,
+    size_t element_size,
+    unsigned element_count)
+{
+    queue->buffer = buffer;
+    queue->element_size = element_size;
+    queue->element_count = element_count;
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+/**
+ * @brief Get an element of the queue by its free running index
+ * @param queue - the queue
+ * @param index - the free running index
+ * @return the element
+ */
+static void *dlmstp_queue_element(struct dlmstp_queue *queue, unsigned index)
+{
+    return &queue->buffer
+                [(index & (queue->element_count - 1)) * queue->element_size];
+}
+
+/**
+ * @brief Producer: get the next free element to fill
+ * @param queue - the queue
+ * @return the free element, or NULL if the queue is full
+ */
+static void *dlmstp_queue_put_peek(struct dlmstp_queue *queue)
+{
+    unsigned head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    unsigned tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+
+    if ((tail - head) >= queue->element_count) {
+        return NULL;
+    }
+
+    return dlmstp_queue_element(queue, tail);
+}
+
+/**
+ * @brief Producer: publish the element from dlmstp_queue_put_peek()
+ * @param queue - the queue
+ */
+static void dlmstp_queue_put(struct dlmstp_queue *queue)
+{
+    unsigned tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Consumer: get the number of published elements, and the free
+ *  running index of the oldest of them
+ * @param queue - the queue
+ * @param head - the index of the oldest element
+ * @return number of published elements
+ */
+static unsigned dlmstp_queue_count(struct dlmstp_queue *queue, unsigned *head)
+{
+    unsigned tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    *head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+
+    return tail - *head;
+}
+
+/**
+ * @brief Consumer: get the oldest published element
+ * @param queue - the queue
+ * @return the oldest element, or NULL if the queue is empty
+ */
+static void *dlmstp_queue_peek(struct dlmstp_queue *queue)
+{
+    unsigned head;
+
+    if (dlmstp_queue_count(queue, &head) == 0) {
+        return NULL;
+    }
+
+    return dlmstp_queue_element(queue, head);
+}
+
+/**
+ * @brief Consumer: release the oldest element back to the producer
+ * @param queue - the queue
+ */
+static void dlmstp_queue_pop(struct dlmstp_queue *queue)
+{
+    unsigned head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Number of PDUs in the transmit queue, for the traffic counters
+ * @return number of PDUs in the transmit queue
+ */
+static inline unsigned dlmstp_pdu_queue_depth(void)
+{
+    unsigned head;
+
+    return dlmstp_queue_count(&PDU_Queue, &head);
+}
+
+/**
+ * @brief Number of PDUs in the receive queue, for the queue statistics
+ * @return number of PDUs in the receive queue
+ */
+static inline unsigned dlmstp_receive_queue_depth(void)
+{
+    unsigned head;
+
+    return dlmstp_queue_count(&Receive_Queue, &head);
+}
+
+/**
+ * @brief Consumer: release the PDUs at the head of the queue that were
+ *  already sent out of order as replies
+ */
+static void dlmstp_pdu_queue_release_sent(void)
+{
+    struct mstp_pdu_packet *pkt;
+
+    for (pkt = dlmstp_queue_peek(&PDU_Queue); pkt && pkt->sent;
+         pkt = dlmstp_queue_peek(&PDU_Queue)) {
+        dlmstp_queue_pop(&PDU_Queue);
+    }
+}
+
+/**
+ * @brief Check if the MS/TP thread should keep running
+ * @return true if the thread should keep running
+ */
+static bool dlmstp_thread_running(void)
+{
+    return __atomic_load_n(&Thread_Run, __ATOMIC_ACQUIRE);
+}
+
 /**
  * @brief Cleanup the MS/TP datalink
  */
 void dlmstp_cleanup(void)
 {
-    pthread_mutex_lock(&Thread_Mutex);
-    Thread_Run = false;
-    pthread_mutex_unlock(&Thread_Mutex);
+    __atomic_store_n(&Thread_Run, false, __ATOMIC_RELEASE);
     pthread_join(hThread, NULL);
-    pthread_cond_destroy(&Received_Frame_Flag);
-    pthread_cond_destroy(&Receive_Packet_Flag);
-    pthread_cond_destroy(&Master_Done_Flag);
-    pthread_mutex_destroy(&Received_Frame_Mutex);
-    pthread_mutex_destroy(&Receive_Packet_Mutex);
-    pthread_mutex_destroy(&Master_Done_Mutex);
-    pthread_mutex_destroy(&Ring_Buffer_Mutex);
+    if (Receive_Event_Fd >= 0) {
+        close(Receive_Event_Fd);
+        Receive_Event_Fd = -1;
+    }
     DLMSTP_Initialized = false;
 }
 
 /**
- * @brief send an PDU via MSTP
+ * @brief send an PDU via MSTP.  The PDU queue has a single producer,
+ *  so only one application thread sends through this datalink.
  * @param dest - BACnet destination address
  * @param npdu_data - network layer information
  * @param pdu - PDU data to send
@@ -112,9 +288,19 @@ int dlmstp_send_pdu(
     int bytes_sent = 0;
     struct mstp_pdu_packet *pkt;
     unsigned i = 0;
-    pthread_mutex_lock(&Ring_Buffer_Mutex);
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Data_Peek(&PDU_Queue);
+
+    if ((pdu_len > MSTP_FRAME_NPDU_MAX) && dest && dest->mac_len &&
+        !MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, dest->mac[0])) {
+        /* a legacy station would discard the extended frame */
+        DLSTATS_DROP(PORT_TYPE_MSTP);
+        return 0;
+    }
+    pkt = (struct mstp_pdu_packet *)dlmstp_queue_put_peek(&PDU_Queue);
+    if (pkt && (pdu_len > sizeof(pkt->buffer))) {
+        return 0;
+    }
     if (pkt) {
+        pkt->sent = false;
         pkt->data_expecting_reply = npdu_data->data_expecting_reply;
         for (i = 0; i < pdu_len; i++) {
             pkt->buffer[i] = pdu[i];
@@ -126,13 +312,16 @@ int dlmstp_send_pdu(
             /* mac_len = 0 is a broadcast address */
             pkt->destination_mac = MSTP_BROADCAST_ADDRESS;
         }
-        if (Ringbuf_Data_Put(&PDU_Queue, (uint8_t *)pkt)) {
-            bytes_sent = pdu_len;
-        }
+        dlmstp_queue_put(&PDU_Queue);
+        LOCKSTAT_QUEUE_SAMPLE(&PDU_Queue_Stats, dlmstp_pdu_queue_depth());
+        bytes_sent = pdu_len;
+        DLSTATS_SEND(PORT_TYPE_MSTP, pdu_len);
+        BACNET_TRACE1(dlmstp_send, pdu_len);
+        DLSTATS_QUEUE_DEPTH(PORT_TYPE_MSTP, dlmstp_pdu_queue_depth());
     }
-    pthread_mutex_unlock(&Ring_Buffer_Mutex);
     if (!pkt) {
         debug_printf("DLMSTP: PDU Queue Full!\n");
+        DLSTATS_DROP(PORT_TYPE_MSTP);
     }
 
     return bytes_sent;
@@ -151,12 +340,11 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
     struct mstp_pdu_packet *pkt;
 
     (void)timeout;
-    pthread_mutex_lock(&Ring_Buffer_Mutex);
-    if (Ringbuf_Empty(&PDU_Queue)) {
-        pthread_mutex_unlock(&Ring_Buffer_Mutex);
+    dlmstp_pdu_queue_release_sent();
+    pkt = (struct mstp_pdu_packet *)dlmstp_queue_peek(&PDU_Queue);
+    if (!pkt) {
         return 0;
     }
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&PDU_Queue);
     if (pkt->data_expecting_reply) {
         frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
     } else {
@@ -167,8 +355,8 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
         &mstp_port->OutputBuffer[0], /* <-- loading this */
         mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
         mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
-    (void)Ringbuf_Pop(&PDU_Queue, NULL);
-    pthread_mutex_unlock(&Ring_Buffer_Mutex);
+    dlmstp_queue_pop(&PDU_Queue);
+    DLSTATS_QUEUE_DEPTH(PORT_TYPE_MSTP, dlmstp_pdu_queue_depth());
 
     return pdu_len;
 }
@@ -232,13 +420,29 @@ uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
     uint16_t pdu_len = 0;
     bool matched = false;
     uint8_t frame_type = 0;
-    struct mstp_pdu_packet *pkt;
+    struct mstp_pdu_packet *pkt = NULL;
+    unsigned head, count, i;
     (void)timeout;
 
-    pthread_mutex_lock(&Ring_Buffer_Mutex);
-    for (pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&PDU_Queue); pkt;
-         pkt = (struct mstp_pdu_packet *)Ringbuf_Peek_Next(
-             &PDU_Queue, (uint8_t *)pkt)) {
+    if (Fast_Reply.length > 0) {
+        pdu_len = MSTP_Create_Frame(
+            &mstp_port->OutputBuffer[0], mstp_port->OutputBufferSize,
+            FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY,
+            Fast_Reply.destination_mac, mstp_port->This_Station,
+            &Fast_Reply.buffer[0], Fast_Reply.length);
+        Fast_Reply.length = 0;
+        DLMSTP_Statistics.transmit_pdu_counter++;
+        DLSTATS_SEND(PORT_TYPE_MSTP, pdu_len);
+        BACNET_TRACE1(dlmstp_send, pdu_len);
+
+        return pdu_len;
+    }
+    count = dlmstp_queue_count(&PDU_Queue, &head);
+    for (i = 0; i < count; i++) {
+        pkt = dlmstp_queue_element(&PDU_Queue, head + i);
+        if (pkt->sent) {
+            continue;
+        }
         /* is this the reply to the DER? */
         matched = npdu_is_data_expecting_reply(
             &mstp_port->InputBuffer[0], mstp_port->DataLength,
@@ -260,10 +464,11 @@ uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
             mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
             mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
         DLMSTP_Statistics.transmit_pdu_counter++;
-        /* This will pop the element no matter where we found it */
-        (void)Ringbuf_Pop_Element(&PDU_Queue, (uint8_t *)pkt, NULL);
+        /* the slot is released once it reaches the head of the queue */
+        pkt->sent = true;
+        dlmstp_pdu_queue_release_sent();
+        DLSTATS_QUEUE_DEPTH(PORT_TYPE_MSTP, dlmstp_pdu_queue_depth());
     }
-    pthread_mutex_unlock(&Ring_Buffer_Mutex);
     if (pdu_len <= 0) {
         /* Didn't find a match so wait for application layer to provide one */
         millisleep(1);
@@ -294,12 +499,32 @@ void MSTP_Send_Frame(
 uint16_t MSTP_Put_Receive(struct mstp_port_struct_t *mstp_port)
 {
     uint16_t pdu_len = 0;
+    uint64_t event = 1;
     DLMSTP_PACKET *pkt;
-
-    pthread_mutex_lock(&Receive_Packet_Mutex);
-    pkt = (DLMSTP_PACKET *)Ringbuf_Data_Peek(&Receive_Queue);
+    BACNET_ADDRESS src = { 0 };
+
+    Fast_Reply.length = 0;
+    if (Reply_Callback &&
+        ((mstp_port->FrameType == FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY) ||
+         (mstp_port->FrameType ==
+          FRAME_TYPE_BACNET_EXTENDED_DATA_EXPECTING_REPLY))) {
+        /* answer now, so the reply is not postponed */
+        dlmstp_fill_bacnet_address(&src, mstp_port->SourceAddress);
+        Fast_Reply.length = Reply_Callback(
+            &src, &mstp_port->InputBuffer[0], mstp_port->DataLength,
+            &Fast_Reply.buffer[0], sizeof(Fast_Reply.buffer));
+        if (Fast_Reply.length > 0) {
+            Fast_Reply.destination_mac = mstp_port->SourceAddress;
+            DLMSTP_Statistics.receive_pdu_counter++;
+            DLSTATS_RECEIVE(PORT_TYPE_MSTP, mstp_port->DataLength);
+            BACNET_TRACE1(dlmstp_receive, mstp_port->DataLength);
+            return mstp_port->DataLength;
+        }
+    }
+    pkt = (DLMSTP_PACKET *)dlmstp_queue_put_peek(&Receive_Queue);
     if (!pkt) {
         debug_printf("MS/TP: Dropped! Not Ready.\n");
+        DLSTATS_DROP(PORT_TYPE_MSTP);
     } else {
         /* bounds check - maybe this should send an abort? */
         pdu_len = mstp_port->DataLength;
@@ -314,11 +539,16 @@ uint16_t MSTP_Put_Receive(struct mstp_port_struct_t *mstp_port)
         dlmstp_fill_bacnet_address(&pkt->address, mstp_port->SourceAddress);
         pkt->pdu_len = mstp_port->DataLength;
         pkt->ready = true;
-        if (Ringbuf_Data_Put(&Receive_Queue, (uint8_t *)pkt)) {
-            pthread_cond_signal(&Receive_Packet_Flag);
+        dlmstp_queue_put(&Receive_Queue);
+        LOCKSTAT_QUEUE_SAMPLE(
+            &Receive_Queue_Stats, dlmstp_receive_queue_depth());
+        DLSTATS_RECEIVE(PORT_TYPE_MSTP, pdu_len);
+        BACNET_TRACE1(dlmstp_receive, pdu_len);
+        /* wake the application; the eventfd is non-blocking */
+        if (write(Receive_Event_Fd, &event, sizeof(event)) < 0) {
+            debug_perror("MS/TP: eventfd write");
         }
     }
-    pthread_mutex_unlock(&Receive_Packet_Mutex);
 
     return pdu_len;
 }
@@ -336,20 +566,30 @@ uint16_t dlmstp_receive(
     unsigned timeout)
 { /* milliseconds to wait for a packet */
     uint16_t pdu_len = 0;
-    struct timespec abstime;
+    uint64_t event;
+    struct pollfd pfd;
     DLMSTP_PACKET *pkt;
     (void)max_pdu;
 
-    pthread_mutex_lock(&Receive_Packet_Mutex);
-    if (timeout > 0) {
-        get_abstime(&abstime, timeout);
-        pthread_cond_timedwait(
-            &Receive_Packet_Flag, &Receive_Packet_Mutex, &abstime);
+    pkt = (DLMSTP_PACKET *)dlmstp_queue_peek(&Receive_Queue);
+    if (!pkt && (timeout > 0)) {
+        if (timeout > 1000) {
+            fprintf(
+                stderr, "DLMSTP: limited timeout of %ums to 1000ms\n",
+                timeout);
+            timeout = 1000;
+        }
+        pfd.fd = Receive_Event_Fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, (int)timeout) > 0) {
+            /* clear the wakeup; the queue is checked below */
+            (void)read(Receive_Event_Fd, &event, sizeof(event));
+        }
+        pkt = (DLMSTP_PACKET *)dlmstp_queue_peek(&Receive_Queue);
     }
-
     /* see if there is a packet available, and a place
        to put the reply (if necessary) and process it */
-    pkt = (DLMSTP_PACKET *)Ringbuf_Peek(&Receive_Queue);
     if (pkt) {
         if (pkt->pdu_len) {
             DLMSTP_Statistics.receive_pdu_counter++;
@@ -362,9 +602,8 @@ uint16_t dlmstp_receive(
             pdu_len = pkt->pdu_len;
         }
         pkt->ready = false;
-        (void)Ringbuf_Pop(&Receive_Queue, NULL);
+        dlmstp_queue_pop(&Receive_Queue);
     }
-    pthread_mutex_unlock(&Receive_Packet_Mutex);
 
     return pdu_len;
 }
@@ -387,13 +626,19 @@ static void *dlmstp_thread(void *pArg)
         if ((MSTP_Port.ReceivedValidFrame == false) &&
             (MSTP_Port.ReceivedValidFrameNotForUs == false) &&
             (MSTP_Port.ReceivedInvalidFrame == false)) {
-            RS485_Check_UART_Data(&MSTP_Port);
-            MSTP_Receive_Frame_FSM(&MSTP_Port);
-            if (MSTP_Port.receive_state == MSTP_RECEIVE_STATE_PREAMBLE) {
-                if (Preamble_Callback) {
-                    Preamble_Callback();
+            /* consume the whole block of received bytes at once */
+            do {
+                RS485_Check_UART_Data(&MSTP_Port);
+                MSTP_Receive_Frame_FSM(&MSTP_Port);
+                if (MSTP_Port.receive_state == MSTP_RECEIVE_STATE_PREAMBLE) {
+                    if (Preamble_Callback) {
+                        Preamble_Callback();
+                    }
                 }
-            }
+            } while (RS485_Receive_Pending(&MSTP_Port) &&
+                     (MSTP_Port.ReceivedValidFrame == false) &&
+                     (MSTP_Port.ReceivedValidFrameNotForUs == false) &&
+                     (MSTP_Port.ReceivedInvalidFrame == false));
         }
         if (MSTP_Port.ReceivedValidFrame) {
             DLMSTP_Statistics.receive_valid_frame_counter++;
@@ -419,6 +664,7 @@ static void *dlmstp_thread(void *pArg)
             /* we don't run the master state machine for this frame */
             MSTP_Port.ReceivedValidFrameNotForUs = false;
         } else if (MSTP_Port.ReceivedInvalidFrame) {
+            DLSTATS_DECODE_ERROR(PORT_TYPE_MSTP);
             if (Invalid_Frame_Rx_Callback) {
                 DLMSTP_Statistics.receive_invalid_frame_counter++;
                 Invalid_Frame_Rx_Callback(
@@ -474,17 +720,13 @@ static void *dlmstp_thread(void *pArg)
                         }
                         master_state = MSTP_Port.master_state;
                     }
-                    pthread_mutex_lock(&Thread_Mutex);
-                    if (!Thread_Run) {
+                    if (!dlmstp_thread_running()) {
                         run_loop = false;
                     }
-                    pthread_mutex_unlock(&Thread_Mutex);
                 }
             }
         }
-        pthread_mutex_lock(&Thread_Mutex);
-        thread_alive = Thread_Run;
-        pthread_mutex_unlock(&Thread_Mutex);
+        thread_alive = dlmstp_thread_running();
     }
 
     return NULL;
@@ -798,6 +1040,17 @@ void dlmstp_set_invalid_frame_rx_complete_callback(
  * @brief Set the MS/TP Preamble callback
  * @param cb_func - callback function to be called when a preamble is received
  */
+/**
+ * @brief Set the callback that may answer a DATA_EXPECTING_REPLY frame
+ *  from the MS/TP thread, before the frame is queued for the application
+ * @param cb_func - callback that returns the length of the reply NPDU,
+ *  or 0 to leave the frame to the application
+ */
+void dlmstp_set_reply_callback(dlmstp_hook_reply_cb cb_func)
+{
+    Reply_Callback = cb_func;
+}
+
 void dlmstp_set_frame_rx_start_callback(dlmstp_hook_frame_rx_start_cb cb_func)
 {
     Preamble_Callback = cb_func;
@@ -809,6 +1062,7 @@ void dlmstp_set_frame_rx_start_callback(dlmstp_hook_frame_rx_start_cb cb_func)
 void dlmstp_reset_statistics(void)
 {
     memset(&DLMSTP_Statistics, 0, sizeof(struct dlmstp_statistics));
+    MSTP_Statistics_Reset(&MSTP_Port);
 }
 
 /**
@@ -823,6 +1077,42 @@ void dlmstp_fill_statistics(struct dlmstp_statistics *statistics)
     memmove(statistics, &DLMSTP_Statistics, sizeof(struct dlmstp_statistics));
 }
 
+/**
+ * @brief Copy the MSTP state machine statistics
+ * @param statistics - MSTP state machine statistics
+ * @return true if the statistics were copied
+ */
+bool dlmstp_fill_mstp_statistics(struct mstp_port_statistics *statistics)
+{
+    if (statistics == NULL) {
+        return false;
+    }
+    memmove(statistics, &MSTP_Statistics, sizeof(struct mstp_port_statistics));
+
+    return true;
+}
+
+/**
+ * @brief Get the largest APDU that a station receives, as learned by the
+ *  MS/TP port from the frames of the station
+ * @param mac - MS/TP MAC address of the station
+ * @return 480 for a legacy station, 1476 for a station that receives
+ *  extended frames, or 0 when it is not known
+ */
+uint16_t dlmstp_peer_max_apdu(uint8_t mac)
+{
+    return MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, mac);
+}
+
+/**
+ * @brief Get the free running millisecond clock for the MS/TP statistics
+ * @return milliseconds
+ */
+static uint32_t dlmstp_statistics_milliseconds(void)
+{
+    return (uint32_t)mstimer_now();
+}
+
 /**
  * @brief Get the MSTP port Max-Info-Frames limit
  * @return Max-Info-Frames limit
@@ -912,9 +1202,7 @@ const char *dlmstp_get_interface(void)
  */
 bool dlmstp_init(char *ifname)
 {
-    pthread_attr_t thread_attr;
-    struct sched_param sch_param;
-    pthread_condattr_t attr;
+    THREAD_SCHED thread_sched;
     int rv = 0;
 
     if (DLMSTP_Initialized) {
@@ -928,41 +1216,18 @@ bool dlmstp_init(char *ifname)
     } else {
         ifname = (char *)RS485_Interface();
     }
-    pthread_condattr_init(&attr);
-    if ((rv = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)) != 0) {
-        fprintf(
-            stderr, "MS/TP Interface: %s\n failed to set MONOTONIC clock\n",
-            ifname);
-        exit(1);
-    }
-    pthread_mutex_init(&Thread_Mutex, NULL);
-    rv = pthread_mutex_init(&Ring_Buffer_Mutex, NULL);
-    if (rv != 0) {
-        fprintf(
-            stderr, "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n",
-            ifname);
-        exit(1);
-    }
     /* initialize PDU queue */
-    Ringbuf_Init(
+    dlmstp_queue_init(
         &PDU_Queue, (uint8_t *)&PDU_Buffer, sizeof(struct mstp_pdu_packet),
         MSTP_PDU_PACKET_COUNT);
     /* initialize packet queue */
-    Ringbuf_Init(
+    dlmstp_queue_init(
         &Receive_Queue, (uint8_t *)&Receive_Buffer, sizeof(DLMSTP_PACKET),
         MSTP_RECEIVE_PACKET_COUNT);
-    rv = pthread_cond_init(&Receive_Packet_Flag, &attr);
-    if (rv != 0) {
-        fprintf(
-            stderr,
-            "MS/TP Interface: %s\n cannot allocate PThread Condition.\n",
-            ifname);
-        exit(1);
-    }
-    rv = pthread_mutex_init(&Receive_Packet_Mutex, NULL);
-    if (rv != 0) {
+    Receive_Event_Fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (Receive_Event_Fd < 0) {
         fprintf(
-            stderr, "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n",
+            stderr, "MS/TP Interface: %s\n cannot allocate eventfd.\n",
             ifname);
         exit(1);
     }
@@ -980,6 +1245,12 @@ bool dlmstp_init(char *ifname)
     MSTP_Port.ValidFrameTimerReset = dlmstp_valid_frame_milliseconds_reset;
     MSTP_Port.BaudRate = dlmstp_baud_rate;
     MSTP_Port.BaudRateSet = dlmstp_set_baud_rate;
+    MSTP_Statistics.Milliseconds = dlmstp_statistics_milliseconds;
+    MSTP_Port.Statistics = &MSTP_Statistics;
+    MSTP_Port.Extended_Frame_Peers = &MSTP_Extended_Frame_Peers;
+#if defined(BACNET_MSTP_POLL_BACKOFF)
+    MSTP_Port.Poll_Schedule = &MSTP_Poll_Schedule;
+#endif
     MSTP_Init(&MSTP_Port);
 #if PRINT_ENABLED
     debug_fprintf(stderr, "MS/TP MAC: %02X\n", MSTP_Port.This_Station);
@@ -1008,49 +1279,12 @@ bool dlmstp_init(char *ifname)
         (MSTP_Port.CheckAutoBaud ? "true" : "false"));
     fflush(stderr);
 #endif
-    pthread_attr_init(&thread_attr);
-
-    /* Set scheduling policy to SCHED_FIFO and priority */
-    rv = pthread_attr_setinheritsched(&thread_attr, PTHREAD_EXPLICIT_SCHED);
-    if (rv != 0) {
-        fprintf(
-            stderr,
-            "MS/TP Interface: %s\n cannot setup thread schedule to "
-            "explicit.\n",
-            ifname);
-        exit(1);
-    }
-    rv = pthread_attr_setschedpolicy(&thread_attr, SCHED_FIFO);
-    if (rv != 0) {
-        fprintf(
-            stderr,
-            "MS/TP Interface: %s\n cannot setup thread schedule policy to "
-            "FIFO.\n",
-            ifname);
-        exit(1);
-    }
-    sch_param.sched_priority = 99;
-    rv = pthread_attr_setschedparam(&thread_attr, &sch_param);
-    if (rv != 0) {
-        fprintf(
-            stderr, "MS/TP Interface: %s\n cannot setup thread priority.\n",
-            ifname);
-        exit(1);
-    }
+    /* the state machine runs with SCHED_FIFO priority 99 by default */
+    thread_sched_init(&thread_sched, "MSTP", 99);
     /* start one thread */
     Thread_Run = true;
-    rv = pthread_create(&hThread, &thread_attr, dlmstp_thread, NULL);
-    if (rv == EPERM) {
-        fprintf(
-            stdout,
-            "MS/TP Interface: %s\n"
-            "  Insufficient permissions to create thread with priority.\n"
-            "    A thread without priority will be created.\n"
-            "  Run this executable as a user with thread priority permission\n"
-            "    or grant capability with \"setcap 'cap_sys_nice=eip'\"",
-            ifname);
-        rv = pthread_create(&hThread, NULL, dlmstp_thread, NULL);
-    }
+    rv = thread_sched_create(
+        &hThread, NULL, &thread_sched, "MS/TP", dlmstp_thread, NULL);
     if (rv != 0) {
         fprintf(
             stderr, "MS/TP Interface: %s\n Failed to start MS/TP thread.\n",
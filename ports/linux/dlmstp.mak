@@ -9,6 +9,7 @@ CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
 
 SRCS = rs485.c \
 	dlmstp.c \
+	thread-sched.c \
 	mstimer-init.c \
 	$(BACNET_SRC_DIR)/bacnet/datalink/cobs.c \
 	$(BACNET_SRC_DIR)/bacnet/datalink/crc.c \
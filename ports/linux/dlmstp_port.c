@@ -5,6 +5,7 @@
  * @date 2008
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#define _GNU_SOURCE
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -22,7 +23,9 @@
 #include "bacnet/basic/sys/debug.h"
 /* port specific */
 #include "dlmstp_port.h"
+#include "lockstat-mutex.h"
 #include "rs485.h"
+#include "thread-sched.h"
 /* OS Specific include */
 #include "bacport.h"
 
@@ -36,6 +39,20 @@
         if (x < 0xFFFF)               \
             x++;                      \
     }
+
+/* ports whose state machines run from the shared thread */
+static struct mstp_port_struct_t *Thread_Ports[DLMSTP_PORT_THREAD_MAX];
+static unsigned Thread_Port_Count;
+static bool Thread_Started;
+static pthread_mutex_t Thread_Mutex = PTHREAD_MUTEX_INITIALIZER;
+#if defined(BACNET_LOCK_STATISTICS)
+static LOCKSTAT_LOCK Thread_Mutex_Stats =
+    LOCKSTAT_LOCK_INIT("mstp-port-thread");
+#endif
+/* scheduling of the state machine threads */
+static THREAD_SCHED Thread_Sched;
+static bool Thread_Sched_Configured;
+
 static uint32_t Timer_Silence(void *poPort)
 {
     int32_t res;
@@ -95,6 +112,7 @@ void dlmstp_cleanup(void *poPort)
     if (!poSharedData) {
         return;
     }
+    dlmstp_port_detach(mstp_port);
 
     /* restore the old port settings */
     termios2_tcsetattr(
@@ -229,69 +247,218 @@ static void *dlmstp_receive_fsm_task(void *pArg)
     return NULL;
 }
 
-static void *dlmstp_master_fsm_task(void *pArg)
+/**
+ * @brief Run the receive and master node state machines of a port once
+ * @param mstp_port - port specific data
+ * @param wait - true to wait a few milliseconds for received bytes
+ *  when none are pending
+ */
+static void dlmstp_port_fsm(struct mstp_port_struct_t *mstp_port, bool wait)
 {
     uint32_t silence = 0;
     bool run_master = false;
-    SHARED_MSTP_DATA *poSharedData;
-    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)pArg;
-    if (!mstp_port) {
-        return NULL;
-    }
 
-    poSharedData =
-        (SHARED_MSTP_DATA *)((struct mstp_port_struct_t *)pArg)->UserData;
-    if (!poSharedData) {
-        return NULL;
-    }
-
-    for (;;) {
-        if (mstp_port->ReceivedValidFrame == false &&
-            mstp_port->ReceivedValidFrameNotForUs == false &&
-            mstp_port->ReceivedInvalidFrame == false) {
+    if (mstp_port->ReceivedValidFrame == false &&
+        mstp_port->ReceivedValidFrameNotForUs == false &&
+        mstp_port->ReceivedInvalidFrame == false) {
+        if (wait || RS485_Receive_Pending(mstp_port)) {
             RS485_Check_UART_Data(mstp_port);
-            MSTP_Receive_Frame_FSM(mstp_port);
         }
-        if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame ||
-            mstp_port->ReceivedValidFrameNotForUs) {
-            run_master = true;
-        } else {
-            silence = mstp_port->SilenceTimer(NULL);
-            switch (mstp_port->master_state) {
-                case MSTP_MASTER_STATE_IDLE:
-                    if (silence >= Tno_token) {
-                        run_master = true;
-                    }
-                    break;
-                case MSTP_MASTER_STATE_WAIT_FOR_REPLY:
-                    if (silence >= mstp_port->Treply_timeout) {
-                        run_master = true;
-                    }
-                    break;
-                case MSTP_MASTER_STATE_POLL_FOR_MASTER:
-                    if (silence >= mstp_port->Tusage_timeout) {
-                        run_master = true;
-                    }
-                    break;
-                default:
+        MSTP_Receive_Frame_FSM(mstp_port);
+    }
+    if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame ||
+        mstp_port->ReceivedValidFrameNotForUs) {
+        run_master = true;
+    } else {
+        silence = mstp_port->SilenceTimer(mstp_port);
+        switch (mstp_port->master_state) {
+            case MSTP_MASTER_STATE_IDLE:
+                if (silence >= Tno_token) {
                     run_master = true;
-                    break;
+                }
+                break;
+            case MSTP_MASTER_STATE_WAIT_FOR_REPLY:
+                if (silence >= mstp_port->Treply_timeout) {
+                    run_master = true;
+                }
+                break;
+            case MSTP_MASTER_STATE_POLL_FOR_MASTER:
+                if (silence >= mstp_port->Tusage_timeout) {
+                    run_master = true;
+                }
+                break;
+            default:
+                run_master = true;
+                break;
+        }
+    }
+    if (run_master) {
+        if (mstp_port->This_Station <= DEFAULT_MAX_MASTER) {
+            while (MSTP_Master_Node_FSM(mstp_port)) {
+                /* do nothing while immediate transitioning */
             }
+        } else if (mstp_port->This_Station < 255) {
+            MSTP_Slave_Node_FSM(mstp_port);
         }
-        if (run_master) {
-            if (mstp_port->This_Station <= DEFAULT_MAX_MASTER) {
-                while (MSTP_Master_Node_FSM(mstp_port)) {
-                    /* do nothing while immediate transitioning */
+    }
+}
+
+static void *dlmstp_master_fsm_task(void *pArg)
+{
+    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)pArg;
+
+    if (!mstp_port || !mstp_port->UserData) {
+        return NULL;
+    }
+    for (;;) {
+        dlmstp_port_fsm(mstp_port, true);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Run the state machines of every attached port from one thread
+ *
+ * One select() waits for the received bytes of all the ports, so a
+ * quiet trunk does not delay the others, and the timers of each port
+ * are checked at least every DLMSTP_PORT_THREAD_WAIT_US.
+ * @param pArg - not used
+ */
+static void *dlmstp_port_thread(void *pArg)
+{
+    struct mstp_port_struct_t *mstp_port;
+    SHARED_MSTP_DATA *poSharedData;
+    struct timeval waiter;
+    fd_set input;
+    int max_fd;
+    unsigned i;
+
+    (void)pArg;
+    for (;;) {
+        LOCKSTAT_MUTEX_LOCK(&Thread_Mutex, &Thread_Mutex_Stats);
+        FD_ZERO(&input);
+        max_fd = -1;
+        for (i = 0; i < Thread_Port_Count; i++) {
+            mstp_port = Thread_Ports[i];
+            poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+            if (!RS485_Receive_Pending(mstp_port)) {
+                FD_SET(poSharedData->RS485_Handle, &input);
+                if (poSharedData->RS485_Handle > max_fd) {
+                    max_fd = poSharedData->RS485_Handle;
                 }
-            } else if (mstp_port->This_Station < 255) {
-                MSTP_Slave_Node_FSM(mstp_port);
             }
         }
+        pthread_mutex_unlock(&Thread_Mutex);
+        /* ports are attached and detached while the thread waits */
+        waiter.tv_sec = 0;
+        waiter.tv_usec = DLMSTP_PORT_THREAD_WAIT_US;
+        if (select(max_fd + 1, &input, NULL, NULL, &waiter) < 0) {
+            FD_ZERO(&input);
+        }
+        LOCKSTAT_MUTEX_LOCK(&Thread_Mutex, &Thread_Mutex_Stats);
+        for (i = 0; i < Thread_Port_Count; i++) {
+            mstp_port = Thread_Ports[i];
+            poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+            dlmstp_port_fsm(
+                mstp_port, FD_ISSET(poSharedData->RS485_Handle, &input));
+        }
+        pthread_mutex_unlock(&Thread_Mutex);
     }
 
     return NULL;
 }
 
+/**
+ * @brief Start a state machine thread with the configured scheduling
+ * @param start_routine - thread function
+ * @param arg - argument of the thread function
+ * @return true if the thread was started
+ */
+static bool dlmstp_thread_start(void *(*start_routine)(void *), void *arg)
+{
+    pthread_t thread;
+
+    if (!Thread_Sched_Configured) {
+        thread_sched_init(&Thread_Sched, "MSTP", 0);
+        Thread_Sched_Configured = true;
+    }
+    if (thread_sched_create(
+            &thread, NULL, &Thread_Sched, "MS/TP", start_routine, arg) != 0) {
+        return false;
+    }
+    pthread_detach(thread);
+
+    return true;
+}
+
+/**
+ * @brief Configure the scheduling of the state machine threads that are
+ *  started after this call, by dlmstp_init() or dlmstp_port_attach(),
+ *  instead of the BACNET_MSTP_PRIORITY and BACNET_MSTP_CPU environment
+ * @param priority - SCHED_FIFO priority 1..99, or 0 for the default policy
+ * @param cpu - CPU to pin the thread to, or -1 for any CPU
+ */
+void dlmstp_port_thread_set(int priority, int cpu)
+{
+    LOCKSTAT_MUTEX_LOCK(&Thread_Mutex, &Thread_Mutex_Stats);
+    Thread_Sched.priority = priority;
+    Thread_Sched.cpu = cpu;
+    Thread_Sched_Configured = true;
+    pthread_mutex_unlock(&Thread_Mutex);
+}
+
+/**
+ * @brief Run the state machines of an opened port from the thread shared
+ *  by all the attached ports, which is started by the first attach
+ * @param poPort - port opened with dlmstp_port_open()
+ * @return true if the port was attached
+ */
+bool dlmstp_port_attach(void *poPort)
+{
+    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
+    bool status = false;
+
+    if (!mstp_port || !mstp_port->UserData) {
+        return false;
+    }
+    LOCKSTAT_MUTEX_LOCK(&Thread_Mutex, &Thread_Mutex_Stats);
+    if (!Thread_Started) {
+        Thread_Started = dlmstp_thread_start(dlmstp_port_thread, NULL);
+        if (!Thread_Started) {
+            fprintf(stderr, "Failed to start MS/TP port thread\n");
+        }
+    }
+    if (Thread_Started && (Thread_Port_Count < DLMSTP_PORT_THREAD_MAX)) {
+        Thread_Ports[Thread_Port_Count] = mstp_port;
+        Thread_Port_Count++;
+        status = true;
+    }
+    pthread_mutex_unlock(&Thread_Mutex);
+
+    return status;
+}
+
+/**
+ * @brief Stop running the state machines of a port from the shared thread
+ * @param poPort - port given to dlmstp_port_attach()
+ */
+void dlmstp_port_detach(void *poPort)
+{
+    unsigned i;
+
+    LOCKSTAT_MUTEX_LOCK(&Thread_Mutex, &Thread_Mutex_Stats);
+    for (i = 0; i < Thread_Port_Count; i++) {
+        if (Thread_Ports[i] == poPort) {
+            Thread_Port_Count--;
+            Thread_Ports[i] = Thread_Ports[Thread_Port_Count];
+            Thread_Ports[Thread_Port_Count] = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&Thread_Mutex);
+}
+
 void dlmstp_fill_bacnet_address(BACNET_ADDRESS *src, uint8_t mstp_address)
 {
     int i = 0;
@@ -546,21 +713,14 @@ void dlmstp_set_baud_rate(void *poPort, uint32_t baud)
         return;
     }
 
+    /* the termios2 BOTHER speeds and the turnaround are in bits/second */
     switch (baud) {
         case 9600:
-            poSharedData->RS485_Baud = B9600;
-            break;
         case 19200:
-            poSharedData->RS485_Baud = B19200;
-            break;
         case 38400:
-            poSharedData->RS485_Baud = B38400;
-            break;
         case 57600:
-            poSharedData->RS485_Baud = B57600;
-            break;
         case 115200:
-            poSharedData->RS485_Baud = B115200;
+            poSharedData->RS485_Baud = baud;
             break;
         default:
             break;
@@ -580,16 +740,12 @@ uint32_t dlmstp_baud_rate(void *poPort)
     }
 
     switch (poSharedData->RS485_Baud) {
-        case B19200:
-            return 19200;
-        case B38400:
-            return 38400;
-        case B57600:
-            return 57600;
-        case B115200:
-            return 115200;
+        case 19200:
+        case 38400:
+        case 57600:
+        case 115200:
+            return poSharedData->RS485_Baud;
         default:
-        case B9600:
             return 9600;
     }
 }
@@ -634,9 +790,15 @@ void dlmstp_get_broadcast_address(BACNET_ADDRESS *dest)
     return;
 }
 
-bool dlmstp_init(void *poPort, char *ifname)
+/**
+ * @brief Open and initialize a port, without starting a thread to run
+ *  its state machines; see dlmstp_port_attach()
+ * @param poPort - port specific data, with UserData of SHARED_MSTP_DATA
+ * @param ifname - serial port name, such as /dev/ttyUSB0
+ * @return true if the port is open
+ */
+bool dlmstp_port_open(void *poPort, char *ifname)
 {
-    unsigned long hThread = 0;
     int rv = 0;
     SHARED_MSTP_DATA *poSharedData;
     struct termios2 newtio;
@@ -652,6 +814,7 @@ bool dlmstp_init(void *poPort, char *ifname)
     }
 
     poSharedData->RS485_Port_Name = ifname;
+    poSharedData->RS485_Baud = dlmstp_baud_rate(mstp_port);
     /* initialize PDU queue */
     Ringbuf_Init(
         &poSharedData->PDU_Queue, (uint8_t *)&poSharedData->PDU_Buffer,
@@ -690,6 +853,7 @@ bool dlmstp_init(void *poPort, char *ifname)
     /* save current serial port settings */
     termios2_tcgetattr(
         poSharedData->RS485_Handle, &poSharedData->RS485_oldtio2);
+    RS485_Set_Low_Latency(poSharedData->RS485_Handle);
     /* clear struct for new port settings */
     memset(&newtio, 0, sizeof(newtio));
     /*
@@ -732,8 +896,23 @@ bool dlmstp_init(void *poPort, char *ifname)
     debug_fprintf(stderr, "MS/TP Max_Master: %02X\n", mstp_port->Nmax_master);
     debug_fprintf(
         stderr, "MS/TP Max_Info_Frames: %u\n", mstp_port->Nmax_info_frames);
-    rv = pthread_create(&hThread, NULL, dlmstp_master_fsm_task, mstp_port);
-    if (rv != 0) {
+
+    return true;
+}
+
+/**
+ * @brief Open and initialize a port, and start a thread of its own to run
+ *  its state machines
+ * @param poPort - port specific data, with UserData of SHARED_MSTP_DATA
+ * @param ifname - serial port name, such as /dev/ttyUSB0
+ * @return true if the port is open
+ */
+bool dlmstp_init(void *poPort, char *ifname)
+{
+    if (!dlmstp_port_open(poPort, ifname)) {
+        return false;
+    }
+    if (!dlmstp_thread_start(dlmstp_master_fsm_task, poPort)) {
         fprintf(stderr, "Failed to start Master Node FSM task\n");
     }
 
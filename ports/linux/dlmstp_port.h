@@ -28,6 +28,15 @@
 #define DLMSTP_HEADER_MAX (2 + 1 + 1 + 1 + 2 + 1 + 2)
 #define DLMSTP_MPDU_MAX (DLMSTP_HEADER_MAX + MAX_PDU)
 
+/* number of ports whose state machines can share one thread */
+#ifndef DLMSTP_PORT_THREAD_MAX
+#define DLMSTP_PORT_THREAD_MAX 16
+#endif
+/* longest wait of the shared thread for bytes, in microseconds */
+#ifndef DLMSTP_PORT_THREAD_WAIT_US
+#define DLMSTP_PORT_THREAD_WAIT_US 1000
+#endif
+
 /* count must be a power of 2 for ringbuf library */
 #ifndef MSTP_PDU_PACKET_COUNT
 #define MSTP_PDU_PACKET_COUNT 8
@@ -105,6 +114,14 @@ extern "C" {
 BACNET_STACK_EXPORT
 bool dlmstp_init(void *poShared, char *ifname);
 BACNET_STACK_EXPORT
+bool dlmstp_port_open(void *poShared, char *ifname);
+BACNET_STACK_EXPORT
+bool dlmstp_port_attach(void *poShared);
+BACNET_STACK_EXPORT
+void dlmstp_port_detach(void *poShared);
+BACNET_STACK_EXPORT
+void dlmstp_port_thread_set(int priority, int cpu);
+BACNET_STACK_EXPORT
 void dlmstp_reset(void *poShared);
 BACNET_STACK_EXPORT
 void dlmstp_cleanup(void *poShared);
@@ -0,0 +1,576 @@
+/**
+ * @file
+ * @brief Shared-memory datalink between the BACnet processes of one host.
+ *
+ * A virtual network is a POSIX shared memory segment, named by the
+ * interface name, holding a queue for each node.  A process attaches by
+ * claiming a free node, which becomes its MAC address.  The queues are
+ * bounded multi-producer rings, so any process can send to any node
+ * without a lock, and the node that owns a queue sleeps on a futex in
+ * the segment until an NPDU arrives.  Every field of the segment starts
+ * out as zero, so the first process to attach has nothing to set up.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/datalink/dlshm.h"
+#include "bacnet/datalink/dlstats.h"
+
+/* identifies a shared-memory datalink segment */
+#define DLSHM_MAGIC 0x42534D31UL
+/* name of the virtual network when none is given */
+#define DLSHM_NAME_DEFAULT "bacnet"
+
+#if (DLSHM_QUEUE_SIZE & (DLSHM_QUEUE_SIZE - 1)) != 0
+#error "DLSHM_QUEUE_SIZE must be a power of two"
+#endif
+#if DLSHM_NODES_MAX > 255
+#error "DLSHM_NODES_MAX must fit the one octet MAC address"
+#endif
+
+/* one NPDU in a queue */
+struct dlshm_slot {
+    /* the turn of the slot, relative to its index, so that zero is the
+       state of an empty queue */
+    uint32_t turn;
+    uint16_t pdu_len;
+    uint8_t src_node;
+    uint8_t reserved;
+    uint8_t pdu[DLSHM_MPDU_MAX];
+};
+
+/* the queue of NPDUs sent to one node */
+struct dlshm_node {
+    /* process that owns the node, or zero if the node is free */
+    int32_t pid;
+    /* next position to fill, by any sender */
+    uint32_t head;
+    /* next position to empty, by the owner only */
+    uint32_t tail;
+    /* futex word, bumped after each NPDU is queued */
+    uint32_t signal;
+    /* non-zero while the owner sleeps on the futex */
+    uint32_t waiting;
+    struct dlshm_slot slot[DLSHM_QUEUE_SIZE];
+};
+
+/* the shared memory segment of a virtual network */
+struct dlshm_segment {
+    uint32_t magic;
+    /* size of the segment, which changes with the build limits */
+    uint32_t length;
+    struct dlshm_node node[DLSHM_NODES_MAX];
+};
+
+/* the attachment of the datalink API */
+static DLSHM_PORT DLSHM_Port;
+
+/**
+ * @brief Wake the owner of a node, if it sleeps
+ * @param node - the node
+ */
+static void dlshm_futex_wake(struct dlshm_node *node)
+{
+    (void)__atomic_add_fetch(&node->signal, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&node->waiting, __ATOMIC_SEQ_CST)) {
+        (void)syscall(SYS_futex, &node->signal, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief Sleep until an NPDU is queued to a node, or the time is up
+ * @param node - the node
+ * @param signal - value of the futex word when the queue was empty
+ * @param timeout - number of milliseconds to wait
+ */
+static void
+dlshm_futex_wait(struct dlshm_node *node, uint32_t signal, unsigned timeout)
+{
+    struct timespec ts;
+
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (long)(timeout % 1000) * 1000000L;
+    (void)syscall(
+        SYS_futex, &node->signal, FUTEX_WAIT, signal, &ts, NULL, 0);
+}
+
+/**
+ * @brief Put an NPDU in the queue of a node
+ * @param node - the receiving node
+ * @param src_node - MAC address of the sending node
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @return true if the NPDU is queued, false if the queue is full
+ */
+static bool dlshm_queue_put(
+    struct dlshm_node *node,
+    uint8_t src_node,
+    const uint8_t *pdu,
+    unsigned pdu_len)
+{
+    struct dlshm_slot *slot;
+    uint32_t position, index, turn;
+    int32_t diff;
+
+    position = __atomic_load_n(&node->head, __ATOMIC_RELAXED);
+    for (;;) {
+        index = position & (DLSHM_QUEUE_SIZE - 1);
+        slot = &node->slot[index];
+        turn = __atomic_load_n(&slot->turn, __ATOMIC_ACQUIRE) + index;
+        diff = (int32_t)(turn - position);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(
+                    &node->head, &position, position + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* full */
+            return false;
+        } else {
+            position = __atomic_load_n(&node->head, __ATOMIC_RELAXED);
+        }
+    }
+    slot->pdu_len = (uint16_t)pdu_len;
+    slot->src_node = src_node;
+    memcpy(slot->pdu, pdu, pdu_len);
+    __atomic_store_n(&slot->turn, position + 1 - index, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * @brief Get the NPDU at the front of the queue of a node
+ * @param node - the node, which is owned by this process
+ * @return the slot of the NPDU, or NULL if the queue is empty
+ */
+static struct dlshm_slot *dlshm_queue_peek(struct dlshm_node *node)
+{
+    struct dlshm_slot *slot;
+    uint32_t position, index, turn;
+
+    position = __atomic_load_n(&node->tail, __ATOMIC_RELAXED);
+    index = position & (DLSHM_QUEUE_SIZE - 1);
+    slot = &node->slot[index];
+    turn = __atomic_load_n(&slot->turn, __ATOMIC_ACQUIRE) + index;
+    if (turn != (position + 1)) {
+        return NULL;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Remove the NPDU at the front of the queue of a node
+ * @param node - the node, which is owned by this process
+ * @param slot - the slot returned by dlshm_queue_peek()
+ */
+static void dlshm_queue_pop(struct dlshm_node *node, struct dlshm_slot *slot)
+{
+    uint32_t position, index;
+
+    position = __atomic_load_n(&node->tail, __ATOMIC_RELAXED);
+    index = position & (DLSHM_QUEUE_SIZE - 1);
+    __atomic_store_n(&node->tail, position + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(
+        &slot->turn, position + DLSHM_QUEUE_SIZE - index, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Determine if a node is owned by a running process
+ * @param node - the node
+ * @return process that owns the node, or zero if the node is free
+ */
+static int32_t dlshm_node_owner(struct dlshm_node *node)
+{
+    int32_t pid;
+
+    pid = __atomic_load_n(&node->pid, __ATOMIC_ACQUIRE);
+    if ((pid != 0) && (kill((pid_t)pid, 0) != 0) && (errno == ESRCH)) {
+        /* the owner exited without a cleanup */
+        if (__atomic_compare_exchange_n(
+                &node->pid, &pid, 0, false, __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE)) {
+            pid = 0;
+        }
+    }
+
+    return pid;
+}
+
+/**
+ * @brief Claim a node for this process, and discard the NPDUs that were
+ *  queued to an earlier owner
+ * @param node - the node
+ * @return true if this process now owns the node
+ */
+static bool dlshm_node_claim(struct dlshm_node *node)
+{
+    struct dlshm_slot *slot;
+    int32_t pid = 0;
+
+    if (dlshm_node_owner(node) != 0) {
+        return false;
+    }
+    if (!__atomic_compare_exchange_n(
+            &node->pid, &pid, (int32_t)getpid(), false, __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    while ((slot = dlshm_queue_peek(node)) != NULL) {
+        dlshm_queue_pop(node, slot);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Map the shared memory segment of a virtual network, creating
+ *  the segment when it does not exist yet
+ * @param name - name of the shared memory object, starting with a slash
+ * @return the segment, or NULL if it can not be used
+ */
+static struct dlshm_segment *dlshm_segment_map(const char *name)
+{
+    struct dlshm_segment *segment;
+    struct stat st;
+    uint32_t expected;
+    void *address;
+    int fd;
+
+    fd = shm_open(name, O_RDWR | O_CREAT, 0660);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        /* new segments are filled with zero */
+        if (ftruncate(fd, sizeof(struct dlshm_segment)) != 0) {
+            close(fd);
+            return NULL;
+        }
+    } else if (st.st_size != (off_t)sizeof(struct dlshm_segment)) {
+        /* built with other limits */
+        close(fd);
+        return NULL;
+    }
+    address = mmap(
+        NULL, sizeof(struct dlshm_segment), PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return NULL;
+    }
+    segment = (struct dlshm_segment *)address;
+    expected = 0;
+    (void)__atomic_compare_exchange_n(
+        &segment->magic, &expected, DLSHM_MAGIC, false, __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE);
+    expected = 0;
+    (void)__atomic_compare_exchange_n(
+        &segment->length, &expected, (uint32_t)sizeof(struct dlshm_segment),
+        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    if ((__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != DLSHM_MAGIC) ||
+        (__atomic_load_n(&segment->length, __ATOMIC_ACQUIRE) !=
+         sizeof(struct dlshm_segment))) {
+        munmap(address, sizeof(struct dlshm_segment));
+        return NULL;
+    }
+
+    return segment;
+}
+
+/**
+ * @brief Attach to a virtual network
+ * @param port - the attachment
+ * @param ifname - name of the virtual network, optionally followed by a
+ *  colon and the MAC address to claim, such as "gateway" or "gateway:3".
+ *  Without a MAC address, the first free node is claimed.
+ * @return true if attached
+ */
+bool dlshm_port_open(DLSHM_PORT *port, const char *ifname)
+{
+    struct dlshm_segment *segment;
+    const char *colon = NULL;
+    unsigned long node = DLSHM_NODES_MAX;
+    size_t name_len;
+    unsigned i;
+
+    if (!port) {
+        return false;
+    }
+    port->segment = NULL;
+    if (!ifname || (ifname[0] == 0)) {
+        ifname = DLSHM_NAME_DEFAULT;
+    }
+    colon = strchr(ifname, ':');
+    if (colon) {
+        name_len = (size_t)(colon - ifname);
+        node = strtoul(colon + 1, NULL, 0);
+        if (node >= DLSHM_NODES_MAX) {
+            return false;
+        }
+    } else {
+        name_len = strlen(ifname);
+    }
+    if ((name_len == 0) || (name_len > DLSHM_NAME_MAX)) {
+        return false;
+    }
+    port->name[0] = '/';
+    memcpy(&port->name[1], ifname, name_len);
+    port->name[name_len + 1] = 0;
+    segment = dlshm_segment_map(port->name);
+    if (!segment) {
+        return false;
+    }
+    if (node < DLSHM_NODES_MAX) {
+        if (!dlshm_node_claim(&segment->node[node])) {
+            node = DLSHM_NODES_MAX;
+        }
+    } else {
+        for (i = 0; i < DLSHM_NODES_MAX; i++) {
+            if (dlshm_node_claim(&segment->node[i])) {
+                node = i;
+                break;
+            }
+        }
+    }
+    if (node >= DLSHM_NODES_MAX) {
+        munmap(segment, sizeof(struct dlshm_segment));
+        return false;
+    }
+    port->node = (uint8_t)node;
+    port->segment = segment;
+
+    return true;
+}
+
+/**
+ * @brief Send an NPDU to a node, or to every other node for a broadcast.
+ *  An NPDU to a node that is free, or that has a full queue, is dropped
+ *  as it would be on a network.
+ * @param port - the attachment
+ * @param dest - destination address
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent, or -1 if the NPDU can not be sent
+ */
+int dlshm_port_send_pdu(
+    DLSHM_PORT *port,
+    const BACNET_ADDRESS *dest,
+    const uint8_t *pdu,
+    unsigned pdu_len)
+{
+    struct dlshm_segment *segment;
+    struct dlshm_node *node;
+    unsigned i;
+
+    if (!port || !port->segment || !dest || !pdu || (pdu_len == 0) ||
+        (pdu_len > DLSHM_MPDU_MAX)) {
+        return -1;
+    }
+    segment = (struct dlshm_segment *)port->segment;
+    if ((dest->net == BACNET_BROADCAST_NETWORK) || (dest->mac_len == 0)) {
+        for (i = 0; i < DLSHM_NODES_MAX; i++) {
+            node = &segment->node[i];
+            if ((i == port->node) || (dlshm_node_owner(node) == 0)) {
+                continue;
+            }
+            if (dlshm_queue_put(node, port->node, pdu, pdu_len)) {
+                dlshm_futex_wake(node);
+            } else {
+                DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+            }
+        }
+    } else if ((dest->mac_len == 1) && (dest->mac[0] < DLSHM_NODES_MAX)) {
+        node = &segment->node[dest->mac[0]];
+        if ((dlshm_node_owner(node) != 0) &&
+            dlshm_queue_put(node, port->node, pdu, pdu_len)) {
+            dlshm_futex_wake(node);
+        } else {
+            DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+        }
+    } else {
+        return -1;
+    }
+    DLSTATS_SEND(PORT_TYPE_VIRTUAL, pdu_len);
+
+    return (int)pdu_len;
+}
+
+/**
+ * @brief Receive the next NPDU sent to the node of an attachment
+ * @param port - the attachment
+ * @param src - source address of the NPDU
+ * @param pdu - buffer for the NPDU
+ * @param max_pdu - size of the buffer
+ * @param timeout - number of milliseconds to wait for an NPDU
+ * @return number of bytes received, or 0 if none
+ */
+uint16_t dlshm_port_receive(
+    DLSHM_PORT *port,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout)
+{
+    struct dlshm_segment *segment;
+    struct dlshm_node *node;
+    struct dlshm_slot *slot;
+    uint16_t pdu_len = 0;
+    uint32_t signal;
+
+    if (!port || !port->segment) {
+        return 0;
+    }
+    segment = (struct dlshm_segment *)port->segment;
+    node = &segment->node[port->node];
+    slot = dlshm_queue_peek(node);
+    if (!slot && (timeout > 0)) {
+        __atomic_store_n(&node->waiting, 1, __ATOMIC_SEQ_CST);
+        signal = __atomic_load_n(&node->signal, __ATOMIC_SEQ_CST);
+        slot = dlshm_queue_peek(node);
+        if (!slot) {
+            dlshm_futex_wait(node, signal, timeout);
+            slot = dlshm_queue_peek(node);
+        }
+        __atomic_store_n(&node->waiting, 0, __ATOMIC_SEQ_CST);
+    }
+    if (!slot) {
+        return 0;
+    }
+    if (pdu && (slot->pdu_len <= max_pdu)) {
+        pdu_len = slot->pdu_len;
+        memcpy(pdu, slot->pdu, pdu_len);
+        if (src) {
+            memset(src, 0, sizeof(*src));
+            src->mac_len = 1;
+            src->mac[0] = slot->src_node;
+        }
+        DLSTATS_RECEIVE(PORT_TYPE_VIRTUAL, pdu_len);
+    } else {
+        DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+    }
+    dlshm_queue_pop(node, slot);
+
+    return pdu_len;
+}
+
+/**
+ * @brief Free the node of an attachment, and unmap the segment.  The
+ *  segment stays for the other processes, and for the next attachment.
+ * @param port - the attachment
+ */
+void dlshm_port_close(DLSHM_PORT *port)
+{
+    struct dlshm_segment *segment;
+    int32_t pid;
+
+    if (!port || !port->segment) {
+        return;
+    }
+    segment = (struct dlshm_segment *)port->segment;
+    pid = (int32_t)getpid();
+    (void)__atomic_compare_exchange_n(
+        &segment->node[port->node].pid, &pid, 0, false, __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE);
+    munmap(segment, sizeof(struct dlshm_segment));
+    port->segment = NULL;
+}
+
+/**
+ * @brief Attach the datalink API to a virtual network
+ * @param ifname - name of the virtual network, see dlshm_port_open()
+ * @return true if attached
+ */
+bool dlshm_init(char *ifname)
+{
+    dlshm_port_close(&DLSHM_Port);
+
+    return dlshm_port_open(&DLSHM_Port, ifname);
+}
+
+/**
+ * @brief Send an NPDU using the datalink API
+ * @param dest - destination address
+ * @param npdu_data - network information, which is not used
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent, or -1 if the NPDU can not be sent
+ */
+int dlshm_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)npdu_data;
+
+    return dlshm_port_send_pdu(&DLSHM_Port, dest, pdu, pdu_len);
+}
+
+/**
+ * @brief Receive an NPDU using the datalink API
+ * @param src - source address of the NPDU
+ * @param pdu - buffer for the NPDU
+ * @param max_pdu - size of the buffer
+ * @param timeout - number of milliseconds to wait for an NPDU
+ * @return number of bytes received, or 0 if none
+ */
+uint16_t dlshm_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+{
+    return dlshm_port_receive(&DLSHM_Port, src, pdu, max_pdu, timeout);
+}
+
+/**
+ * @brief Detach the datalink API from its virtual network
+ */
+void dlshm_cleanup(void)
+{
+    dlshm_port_close(&DLSHM_Port);
+}
+
+/**
+ * @brief Get the local broadcast address of a virtual network
+ * @param dest - the broadcast address
+ */
+void dlshm_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    if (dest) {
+        memset(dest, 0, sizeof(*dest));
+        dest->net = BACNET_BROADCAST_NETWORK;
+    }
+}
+
+/**
+ * @brief Get the address of the node of the datalink API
+ * @param my_address - the address of the node
+ */
+void dlshm_get_my_address(BACNET_ADDRESS *my_address)
+{
+    if (my_address) {
+        memset(my_address, 0, sizeof(*my_address));
+        my_address->mac_len = 1;
+        my_address->mac[0] = DLSHM_Port.node;
+    }
+}
@@ -9,6 +9,11 @@
 #include <stdbool.h> /* for the standard bool type. */
 
 #include "bacport.h"
+#if defined(BACNET_ETHERNET_RING)
+#include <poll.h>
+#include <sys/mman.h>
+#include <linux/filter.h>
+#endif
 #include "bacnet/bacdef.h"
 #include "bacnet/datalink/ethernet.h"
 #include "bacnet/bacint.h"
@@ -29,6 +34,35 @@ uint8_t Ethernet_MAC_Address[MAX_MAC_LEN] = { 0 };
 static int eth802_sockfd = -1; /* 802.2 file handle */
 static struct sockaddr eth_addr = { 0 }; /* used for binding 802.2 */
 
+#if defined(BACNET_ETHERNET_RING)
+/* memory-mapped TPACKET_V3 receive ring, shared with the kernel */
+#ifndef ETHERNET_RING_BLOCK_SIZE
+#define ETHERNET_RING_BLOCK_SIZE (1 << 16)
+#endif
+#ifndef ETHERNET_RING_BLOCK_COUNT
+#define ETHERNET_RING_BLOCK_COUNT 8
+#endif
+#ifndef ETHERNET_RING_FRAME_SIZE
+#define ETHERNET_RING_FRAME_SIZE 2048
+#endif
+/* milliseconds before the kernel hands over a partly filled block */
+#ifndef ETHERNET_RING_BLOCK_TIMEOUT
+#define ETHERNET_RING_BLOCK_TIMEOUT 10
+#endif
+static uint8_t *Ethernet_Ring;
+/* the block being read, its next frame, and the frames left to read */
+static unsigned Ethernet_Ring_Block;
+static struct tpacket3_hdr *Ethernet_Ring_Frame;
+static uint32_t Ethernet_Ring_Frames;
+/* accept only the frames with the BACnet LLC DSAP and SSAP */
+static struct sock_filter Ethernet_Ring_Filter[] = {
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 14),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x8282, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, ETHERNET_MPDU_MAX),
+    BPF_STMT(BPF_RET | BPF_K, 0),
+};
+#endif
+
 bool ethernet_valid(void)
 {
     return (eth802_sockfd >= 0);
@@ -40,6 +74,17 @@ void ethernet_cleanup(void)
         close(eth802_sockfd);
     }
     eth802_sockfd = -1;
+#if defined(BACNET_ETHERNET_RING)
+    if (Ethernet_Ring) {
+        munmap(
+            Ethernet_Ring,
+            (size_t)ETHERNET_RING_BLOCK_SIZE * ETHERNET_RING_BLOCK_COUNT);
+        Ethernet_Ring = NULL;
+    }
+    Ethernet_Ring_Block = 0;
+    Ethernet_Ring_Frame = NULL;
+    Ethernet_Ring_Frames = 0;
+#endif
 
     return;
 }
@@ -147,6 +192,156 @@ static int ethernet_bind(struct sockaddr *eth_addr, const char *interface_name)
     return sock_fd;
 }
 
+#if defined(BACNET_ETHERNET_RING)
+/* opens an 802.2 packet socket that receives into a memory-mapped ring */
+/* returns the socket, or -1 if the ring is not available */
+static int ethernet_ring_bind(const char *interface_name)
+{
+    struct sockaddr_ll sll = { 0 };
+    struct tpacket_req3 req = { 0 };
+    struct sock_fprog fprog = { 0 };
+    int version = TPACKET_V3;
+    size_t ring_size;
+    void *ring;
+    int sock_fd;
+
+    sock_fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_802_2));
+    if (sock_fd < 0) {
+        fprintf(
+            stderr, "ethernet: Error opening packet socket: %s\n",
+            strerror(errno));
+        return -1;
+    }
+    /* filter before binding, so that no other frames are queued */
+    fprog.len = sizeof(Ethernet_Ring_Filter) / sizeof(Ethernet_Ring_Filter[0]);
+    fprog.filter = Ethernet_Ring_Filter;
+    req.tp_block_size = ETHERNET_RING_BLOCK_SIZE;
+    req.tp_block_nr = ETHERNET_RING_BLOCK_COUNT;
+    req.tp_frame_size = ETHERNET_RING_FRAME_SIZE;
+    req.tp_frame_nr = (ETHERNET_RING_BLOCK_SIZE / ETHERNET_RING_FRAME_SIZE) *
+        ETHERNET_RING_BLOCK_COUNT;
+    req.tp_retire_blk_tov = ETHERNET_RING_BLOCK_TIMEOUT;
+    if ((setsockopt(
+             sock_fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) !=
+         0) ||
+        (setsockopt(
+             sock_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) !=
+         0) ||
+        (setsockopt(sock_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) !=
+         0)) {
+        fprintf(
+            stderr, "ethernet: Unable to set up the receive ring: %s\n",
+            strerror(errno));
+        close(sock_fd);
+        return -1;
+    }
+    ring_size = (size_t)ETHERNET_RING_BLOCK_SIZE * ETHERNET_RING_BLOCK_COUNT;
+    ring =
+        mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, sock_fd, 0);
+    if (ring == MAP_FAILED) {
+        fprintf(
+            stderr, "ethernet: Unable to map the receive ring: %s\n",
+            strerror(errno));
+        close(sock_fd);
+        return -1;
+    }
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_802_2);
+    sll.sll_ifindex = (int)if_nametoindex(interface_name);
+    if (bind(sock_fd, (struct sockaddr *)&sll, sizeof(sll)) != 0) {
+        fprintf(
+            stderr, "ethernet: Unable to bind packet socket: %s\n",
+            strerror(errno));
+        munmap(ring, ring_size);
+        close(sock_fd);
+        return -1;
+    }
+    Ethernet_Ring = ring;
+    Ethernet_Ring_Block = 0;
+    Ethernet_Ring_Frame = NULL;
+    Ethernet_Ring_Frames = 0;
+    fprintf(
+        stderr, "ethernet: receive ring of %u blocks on \"%s\"\n",
+        (unsigned)ETHERNET_RING_BLOCK_COUNT, interface_name);
+    atexit(ethernet_cleanup);
+
+    return sock_fd;
+}
+
+/* returns the next frame of the receive ring, waiting for a block of
+   frames up to timeout milliseconds, or NULL if none arrived.  The frame
+   stays valid until the next call. */
+static uint8_t *ethernet_ring_frame(unsigned timeout, int *length)
+{
+    struct tpacket_block_desc *block;
+    struct pollfd pfd;
+
+    if (Ethernet_Ring_Frames > 0) {
+        Ethernet_Ring_Frame =
+            (struct tpacket3_hdr *)((uint8_t *)Ethernet_Ring_Frame +
+                                    Ethernet_Ring_Frame->tp_next_offset);
+    } else {
+        block = (struct tpacket_block_desc *)(Ethernet_Ring +
+                                              ((size_t)Ethernet_Ring_Block *
+                                               ETHERNET_RING_BLOCK_SIZE));
+        if (Ethernet_Ring_Frame) {
+            /* every frame of the block was read - hand it back */
+            Ethernet_Ring_Frame = NULL;
+            __atomic_store_n(
+                &block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                __ATOMIC_RELEASE);
+            Ethernet_Ring_Block =
+                (Ethernet_Ring_Block + 1) % ETHERNET_RING_BLOCK_COUNT;
+            block = (struct tpacket_block_desc *)(Ethernet_Ring +
+                                                  ((size_t)Ethernet_Ring_Block *
+                                                   ETHERNET_RING_BLOCK_SIZE));
+        }
+        if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+              TP_STATUS_USER)) {
+            pfd.fd = eth802_sockfd;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+            if ((poll(&pfd, 1, (int)timeout) <= 0) ||
+                !(__atomic_load_n(
+                      &block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+                  TP_STATUS_USER)) {
+                return NULL;
+            }
+        }
+        Ethernet_Ring_Frames = block->hdr.bh1.num_pkts;
+        if (Ethernet_Ring_Frames == 0) {
+            __atomic_store_n(
+                &block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                __ATOMIC_RELEASE);
+            Ethernet_Ring_Block =
+                (Ethernet_Ring_Block + 1) % ETHERNET_RING_BLOCK_COUNT;
+            return NULL;
+        }
+        Ethernet_Ring_Frame =
+            (struct tpacket3_hdr *)((uint8_t *)block +
+                                    block->hdr.bh1.offset_to_first_pkt);
+    }
+    Ethernet_Ring_Frames--;
+    *length = (int)Ethernet_Ring_Frame->tp_snaplen;
+
+    return (uint8_t *)Ethernet_Ring_Frame + Ethernet_Ring_Frame->tp_mac;
+}
+#endif
+
+/* sends a whole frame on the 802.2 socket */
+static int ethernet_frame_send(const uint8_t *mtu, int mtu_len)
+{
+#if defined(BACNET_ETHERNET_RING)
+    if (Ethernet_Ring) {
+        /* the packet socket is bound to the interface */
+        return send(eth802_sockfd, mtu, mtu_len, 0);
+    }
+#endif
+    return sendto(
+        eth802_sockfd, mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
+        sizeof(struct sockaddr));
+}
+
 /* function to find the local ethernet MAC address */
 static int get_local_hwaddr(const char *ifname, unsigned char *mac)
 {
@@ -171,13 +366,18 @@ static int get_local_hwaddr(const char *ifname, unsigned char *mac)
 
 bool ethernet_init(char *interface_name)
 {
-    if (interface_name) {
-        get_local_hwaddr(interface_name, Ethernet_MAC_Address);
+    if (!interface_name) {
+        interface_name = "eth0";
+    }
+    get_local_hwaddr(interface_name, Ethernet_MAC_Address);
+#if defined(BACNET_ETHERNET_RING)
+    eth802_sockfd = ethernet_ring_bind(interface_name);
+    if (eth802_sockfd < 0) {
         eth802_sockfd = ethernet_bind(&eth_addr, interface_name);
-    } else {
-        get_local_hwaddr("eth0", Ethernet_MAC_Address);
-        eth802_sockfd = ethernet_bind(&eth_addr, "eth0");
     }
+#else
+    eth802_sockfd = ethernet_bind(&eth_addr, interface_name);
+#endif
 
     return ethernet_valid();
 }
@@ -187,9 +387,7 @@ int ethernet_send(uint8_t *mtu, int mtu_len)
     int bytes = 0;
 
     /* Send the packet */
-    bytes = sendto(
-        eth802_sockfd, &mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
-        sizeof(struct sockaddr));
+    bytes = ethernet_frame_send(mtu, mtu_len);
     /* did it get sent? */
     if (bytes < 0) {
         fprintf(
@@ -259,9 +457,7 @@ int ethernet_send_pdu(
     encode_unsigned16(&mtu[12], 3 + pdu_len);
 
     /* Send the packet */
-    bytes = sendto(
-        eth802_sockfd, &mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
-        sizeof(struct sockaddr));
+    bytes = ethernet_frame_send(mtu, mtu_len);
     /* did it get sent? */
     if (bytes < 0) {
         fprintf(
@@ -271,26 +467,14 @@ int ethernet_send_pdu(
     return bytes;
 }
 
-/* receives an 802.2 framed packet */
-/* returns the number of octets in the PDU, or zero on failure */
-uint16_t ethernet_receive(
-    BACNET_ADDRESS *src, /* source address */
-    uint8_t *pdu, /* PDU data */
-    uint16_t max_pdu, /* amount of space available in the PDU  */
-    unsigned timeout)
-{ /* number of milliseconds to wait for a packet */
-    int received_bytes;
-    uint8_t buf[ETHERNET_MPDU_MAX] = { 0 }; /* data */
-    uint16_t pdu_len = 0; /* return value */
+/* waits up to timeout milliseconds for a frame, and reads it */
+/* returns the number of octets read, zero if none, or negative on error */
+static int ethernet_select_read(uint8_t *buf, size_t size, unsigned timeout)
+{
     fd_set read_fds;
     int max;
     struct timeval select_timeout;
 
-    /* Make sure the socket is open */
-    if (eth802_sockfd <= 0) {
-        return 0;
-    }
-
     /* we could just use a non-blocking socket, but that consumes all
        the CPU time.  We can use a timeout; it is only supported as
        a select. */
@@ -307,10 +491,42 @@ uint16_t ethernet_receive(
     max = eth802_sockfd;
 
     if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        received_bytes = read(eth802_sockfd, &buf[0], sizeof(buf));
-    } else {
+        return read(eth802_sockfd, buf, size);
+    }
+
+    return 0;
+}
+
+/* receives an 802.2 framed packet */
+/* returns the number of octets in the PDU, or zero on failure */
+uint16_t ethernet_receive(
+    BACNET_ADDRESS *src, /* source address */
+    uint8_t *pdu, /* PDU data */
+    uint16_t max_pdu, /* amount of space available in the PDU  */
+    unsigned timeout)
+{ /* number of milliseconds to wait for a packet */
+    int received_bytes;
+    uint8_t buf[ETHERNET_MPDU_MAX] = { 0 }; /* data */
+    uint8_t *frame = &buf[0];
+    uint16_t pdu_len = 0; /* return value */
+
+    /* Make sure the socket is open */
+    if (eth802_sockfd <= 0) {
         return 0;
     }
+#if defined(BACNET_ETHERNET_RING)
+    if (Ethernet_Ring) {
+        /* the frame is read in place from the ring */
+        frame = ethernet_ring_frame(timeout, &received_bytes);
+        if (!frame) {
+            return 0;
+        }
+    } else {
+        received_bytes = ethernet_select_read(buf, sizeof(buf), timeout);
+    }
+#else
+    received_bytes = ethernet_select_read(buf, sizeof(buf), timeout);
+#endif
 
     /* See if there is a problem */
     if (received_bytes < 0) {
@@ -330,29 +546,29 @@ uint16_t ethernet_receive(
     }
 
     /* the signature of an 802.2 BACnet packet */
-    if ((buf[14] != 0x82) && (buf[15] != 0x82)) {
+    if ((frame[14] != 0x82) && (frame[15] != 0x82)) {
         /*fprintf(stderr,"ethernet: Non-BACnet packet\n"); */
         return 0;
     }
     /* copy the source address */
     src->mac_len = 6;
-    memmove(src->mac, &buf[6], 6);
+    memmove(src->mac, &frame[6], 6);
 
     /* check destination address for when */
     /* the Ethernet card is in promiscious mode */
-    if ((memcmp(&buf[0], Ethernet_MAC_Address, 6) != 0) &&
-        (memcmp(&buf[0], Ethernet_Broadcast, 6) != 0)) {
+    if ((memcmp(&frame[0], Ethernet_MAC_Address, 6) != 0) &&
+        (memcmp(&frame[0], Ethernet_Broadcast, 6) != 0)) {
         /*fprintf(stderr, "ethernet: This packet isn't for us\n"); */
         return 0;
     }
 
-    (void)decode_unsigned16(&buf[12], &pdu_len);
+    (void)decode_unsigned16(&frame[12], &pdu_len);
     pdu_len -= 3 /* DSAP, SSAP, LLC Control */;
     /* copy the buffer into the PDU */
-    if (pdu_len < max_pdu) {
-        memmove(&pdu[0], &buf[17], pdu_len);
+    if ((pdu_len < max_pdu) && ((17 + pdu_len) <= received_bytes)) {
+        memmove(&pdu[0], &frame[17], pdu_len);
     }
-    /* ignore packets that are too large */
+    /* ignore packets that are too large, or cut short */
     else {
         pdu_len = 0;
     }
@@ -0,0 +1,260 @@
+/**
+ * @file
+ * @brief An epoll and timerfd event loop for the Linux ports.
+ *
+ * The datalink receive functions each hide a select() with a timeout, and
+ * the applications poll their mstimers between the receive calls, so the
+ * timeout adds to the response latency.  This module waits in one
+ * epoll_wait() for any registered datalink file descriptor or timerfd,
+ * and dispatches the callback of each source that is ready.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "bacnet/basic/sys/debug.h"
+#include "event-loop.h"
+
+/* one file descriptor or timer in the event loop */
+struct event_loop_source {
+    int fd;
+    bool timer;
+    uint32_t interval_milliseconds;
+    event_loop_fd_callback fd_callback;
+    event_loop_timer_callback timer_callback;
+};
+
+static struct event_loop_source Event_Loop_Source[EVENT_LOOP_SOURCES_MAX];
+static int Event_Loop_Fd = -1;
+
+/**
+ * @brief Find an unused event source
+ * @return the unused event source, or NULL if the table is full
+ */
+static struct event_loop_source *event_loop_source_alloc(void)
+{
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        if (Event_Loop_Source[i].fd < 0) {
+            return &Event_Loop_Source[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Add an event source file descriptor to the epoll set
+ * @param source - the event source
+ * @return true if the file descriptor was added
+ */
+static bool event_loop_source_watch(struct event_loop_source *source)
+{
+    struct epoll_event event = { 0 };
+
+    event.events = EPOLLIN;
+    event.data.ptr = source;
+    if (epoll_ctl(Event_Loop_Fd, EPOLL_CTL_ADD, source->fd, &event) < 0) {
+        debug_perror("event-loop: epoll_ctl");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Initialize the event loop
+ * @return true if the event loop is ready
+ */
+bool event_loop_init(void)
+{
+    unsigned i;
+
+    if (Event_Loop_Fd >= 0) {
+        return true;
+    }
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        Event_Loop_Source[i].fd = -1;
+    }
+    Event_Loop_Fd = epoll_create1(EPOLL_CLOEXEC);
+    if (Event_Loop_Fd < 0) {
+        debug_perror("event-loop: epoll_create1");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the event loop and the timers that it owns.  The datalink
+ *  file descriptors are owned by the datalink and are left open.
+ */
+void event_loop_cleanup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        if ((Event_Loop_Source[i].fd >= 0) && Event_Loop_Source[i].timer) {
+            close(Event_Loop_Source[i].fd);
+        }
+        Event_Loop_Source[i].fd = -1;
+    }
+    if (Event_Loop_Fd >= 0) {
+        close(Event_Loop_Fd);
+        Event_Loop_Fd = -1;
+    }
+}
+
+/**
+ * @brief Add a file descriptor, such as a datalink socket, to the loop
+ * @param fd - the file descriptor to wait on for reading
+ * @param callback - called when the file descriptor is ready to read
+ * @return true if the file descriptor was added
+ */
+bool event_loop_fd_add(int fd, event_loop_fd_callback callback)
+{
+    struct event_loop_source *source;
+
+    if ((Event_Loop_Fd < 0) || (fd < 0) || !callback) {
+        return false;
+    }
+    source = event_loop_source_alloc();
+    if (!source) {
+        return false;
+    }
+    source->fd = fd;
+    source->timer = false;
+    source->interval_milliseconds = 0;
+    source->fd_callback = callback;
+    source->timer_callback = NULL;
+    if (!event_loop_source_watch(source)) {
+        source->fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Remove a file descriptor from the loop, such as before the
+ *  datalink closes it
+ * @param fd - the file descriptor that was added
+ * @return true if the file descriptor was found and removed
+ */
+bool event_loop_fd_remove(int fd)
+{
+    unsigned i;
+
+    if ((Event_Loop_Fd < 0) || (fd < 0)) {
+        return false;
+    }
+    for (i = 0; i < EVENT_LOOP_SOURCES_MAX; i++) {
+        if ((Event_Loop_Source[i].fd == fd) && !Event_Loop_Source[i].timer) {
+            epoll_ctl(Event_Loop_Fd, EPOLL_CTL_DEL, fd, NULL);
+            Event_Loop_Source[i].fd = -1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Add a cyclic timer, such as the TSM or COV timer, to the loop
+ * @param interval_milliseconds - the period of the timer
+ * @param callback - called with the elapsed time when the timer expires
+ * @return true if the timer was added
+ */
+bool event_loop_timer_add(
+    uint32_t interval_milliseconds, event_loop_timer_callback callback)
+{
+    struct event_loop_source *source;
+    struct itimerspec spec = { 0 };
+    int fd;
+
+    if ((Event_Loop_Fd < 0) || (interval_milliseconds == 0) || !callback) {
+        return false;
+    }
+    source = event_loop_source_alloc();
+    if (!source) {
+        return false;
+    }
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        debug_perror("event-loop: timerfd_create");
+        return false;
+    }
+    spec.it_interval.tv_sec = interval_milliseconds / 1000;
+    spec.it_interval.tv_nsec = (interval_milliseconds % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0) {
+        debug_perror("event-loop: timerfd_settime");
+        close(fd);
+        return false;
+    }
+    source->fd = fd;
+    source->timer = true;
+    source->interval_milliseconds = interval_milliseconds;
+    source->fd_callback = NULL;
+    source->timer_callback = callback;
+    if (!event_loop_source_watch(source)) {
+        close(fd);
+        source->fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wait for the registered sources, and call the callback of each
+ *  source that is ready.  An expired timer reports the time for all of
+ *  its expirations since the previous callback.
+ * @param timeout_milliseconds - time to wait, or -1 to wait until a
+ *  file descriptor is ready or a timer expires
+ * @return number of callbacks, or -1 on error
+ */
+int event_loop_run_once(int timeout_milliseconds)
+{
+    struct epoll_event events[EVENT_LOOP_SOURCES_MAX];
+    struct event_loop_source *source;
+    uint64_t expirations;
+    int count;
+    int i;
+
+    if (Event_Loop_Fd < 0) {
+        return -1;
+    }
+    count = epoll_wait(
+        Event_Loop_Fd, events, EVENT_LOOP_SOURCES_MAX, timeout_milliseconds);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        debug_perror("event-loop: epoll_wait");
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        source = events[i].data.ptr;
+        if (source->fd < 0) {
+            /* removed by an earlier callback */
+            continue;
+        }
+        if (source->timer) {
+            if (read(source->fd, &expirations, sizeof(expirations)) ==
+                sizeof(expirations)) {
+                source->timer_callback(
+                    (uint32_t)expirations * source->interval_milliseconds);
+            }
+        } else {
+            source->fd_callback(source->fd);
+        }
+    }
+
+    return count;
+}
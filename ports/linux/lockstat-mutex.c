@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Instrumented mutexes and queue depth samples of the threads of
+ *  the Linux ports.
+ *
+ * An instrumented lock first tries the mutex.  When the mutex is held by
+ * another thread, the wait for it is timed with the monotonic clock.  The
+ * acquisition is recorded once the mutex is held, so the statistics of a
+ * lock are guarded by the lock itself, and an uncontended lock costs one
+ * trylock.  The records are registered on their first use, under a mutex
+ * of their own.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+#include "lockstat-mutex.h"
+
+static pthread_mutex_t Register_Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Get the time of the monotonic clock
+ * @return the time in microseconds
+ */
+static uint64_t lockstat_mutex_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000ULL) +
+        ((uint64_t)now.tv_nsec / 1000ULL);
+}
+
+/**
+ * @brief Lock a mutex, and record the acquisition and its wait
+ * @param mutex - mutex to lock
+ * @param stats - statistics of the lock
+ * @return 0 on success, or the error of pthread_mutex_lock()
+ */
+int lockstat_mutex_lock(pthread_mutex_t *mutex, LOCKSTAT_LOCK *stats)
+{
+    uint64_t start, wait = 0;
+    bool contended = false;
+    int rc;
+
+    rc = pthread_mutex_trylock(mutex);
+    if (rc == EBUSY) {
+        contended = true;
+        start = lockstat_mutex_clock();
+        rc = pthread_mutex_lock(mutex);
+        wait = lockstat_mutex_clock() - start;
+    }
+    if (rc != 0) {
+        return rc;
+    }
+    if (!stats->registered) {
+        pthread_mutex_lock(&Register_Mutex);
+        lockstat_lock_register(stats);
+        pthread_mutex_unlock(&Register_Mutex);
+    }
+    lockstat_lock_record(
+        stats, contended, (wait > UINT32_MAX) ? UINT32_MAX : (uint32_t)wait);
+
+    return 0;
+}
+
+/**
+ * @brief Record the depth of a queue, from its only producer or consumer
+ * @param stats - statistics of the queue
+ * @param depth - number of elements in the queue
+ */
+void lockstat_mutex_queue_sample(LOCKSTAT_QUEUE *stats, uint32_t depth)
+{
+    if (!stats->registered) {
+        pthread_mutex_lock(&Register_Mutex);
+        lockstat_queue_register(stats);
+        pthread_mutex_unlock(&Register_Mutex);
+    }
+    lockstat_queue_sample(stats, depth);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief Instrumented mutexes and queue depth samples of the threads of
+ *  the Linux ports, built in with BACNET_LOCK_STATISTICS
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_PORT_LINUX_LOCKSTAT_MUTEX_H
+#define BACNET_PORT_LINUX_LOCKSTAT_MUTEX_H
+
+#include <stdint.h>
+#include <pthread.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/sys/lockstat.h"
+
+/* Lock a mutex, timing the wait into the named statistics, and sample the
+   depth of a queue.  Without BACNET_LOCK_STATISTICS, the statistics are
+   not declared, and these are the plain pthread calls. */
+#if defined(BACNET_LOCK_STATISTICS)
+#define LOCKSTAT_MUTEX_LOCK(mutex, stats) lockstat_mutex_lock(mutex, stats)
+#define LOCKSTAT_QUEUE_SAMPLE(stats, depth) \
+    lockstat_mutex_queue_sample(stats, depth)
+#else
+#define LOCKSTAT_MUTEX_LOCK(mutex, stats) pthread_mutex_lock(mutex)
+#define LOCKSTAT_QUEUE_SAMPLE(stats, depth) ((void)0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+int lockstat_mutex_lock(pthread_mutex_t *mutex, LOCKSTAT_LOCK *stats);
+BACNET_STACK_EXPORT
+void lockstat_mutex_queue_sample(LOCKSTAT_QUEUE *stats, uint32_t depth);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -236,29 +236,72 @@ void RS485_Send_Frame(
     }
 }
 
+/* largest block read from the serial port in one system call */
+#ifndef RS485_RX_BLOCK_SIZE
+#define RS485_RX_BLOCK_SIZE 2048
+#endif
+
 /****************************************************************************
- * DESCRIPTION: Get a byte of receive data
+ * DESCRIPTION: Wait for receive data, and read it into the FIFO as a block
  * RETURN:      none
  * ALGORITHM:   none
- * NOTES:       none
+ * NOTES:       The bytes of a block arrived back to back, so the receive
+ *              state machine can consume them without waiting in between.
+ *              They are read straight into the free space of the FIFO.
  *****************************************************************************/
-void RS485_Check_UART_Data(struct mstp_port_struct_t *mstp_port)
+static void rs485_fifo_fill(int handle, FIFO_BUFFER *fifo, long microseconds)
 {
     fd_set input;
     struct timeval waiter;
-    uint8_t buf[2048];
+    volatile uint8_t *data = NULL;
+    size_t len;
     ssize_t n;
+
+    waiter.tv_sec = 0;
+    waiter.tv_usec = microseconds;
+    FD_ZERO(&input);
+    FD_SET(handle, &input);
+    n = select(handle + 1, &input, NULL, NULL, &waiter);
+    if (n <= 0) {
+        return;
+    }
+    if (FD_ISSET(handle, &input)) {
+        len = FIFO_Write_Window(fifo, &data);
+        if (len > RS485_RX_BLOCK_SIZE) {
+            len = RS485_RX_BLOCK_SIZE;
+        }
+        if (len == 0) {
+            return;
+        }
+        /* the kernel writes the bytes, so volatile access is not needed */
+        n = read(handle, (void *)(uintptr_t)data, len);
+        if (n > 0) {
+            (void)FIFO_Write_Commit(fifo, (unsigned)n);
+        }
+    }
+}
+
+/****************************************************************************
+ * DESCRIPTION: Get a byte of receive data
+ * RETURN:      none
+ * ALGORITHM:   none
+ * NOTES:       The serial port is only read when the FIFO is empty, so a
+ *              burst of bytes costs one select() and one read().
+ *****************************************************************************/
+void RS485_Check_UART_Data(struct mstp_port_struct_t *mstp_port)
+{
     int handle = RS485_Handle;
     SHARED_MSTP_DATA *poSharedData;
     FIFO_BUFFER *fifo = &Rx_FIFO;
 
-    waiter.tv_sec = 0;
-    waiter.tv_usec = 5000;
     poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
     if (poSharedData) {
         handle = poSharedData->RS485_Handle;
         fifo = &poSharedData->Rx_FIFO;
     }
+    if (FIFO_Empty(fifo)) {
+        rs485_fifo_fill(handle, fifo, 5000);
+    }
     if (mstp_port->ReceiveError == true) {
         /* do nothing but wait for state machine to clear the error */
     } else if (mstp_port->DataAvailable == false) {
@@ -267,24 +310,47 @@ void RS485_Check_UART_Data(struct mstp_port_struct_t *mstp_port)
             /* data is available */
             mstp_port->DataRegister = FIFO_Get(fifo);
             mstp_port->DataAvailable = true;
-            /* FIFO is giving data - just poll */
-            waiter.tv_sec = 0;
-            waiter.tv_usec = 0;
         }
     }
-    /* grab bytes and stuff them into the FIFO every time */
-    FD_ZERO(&input);
-    FD_SET(handle, &input);
-    n = select(handle + 1, &input, NULL, NULL, &waiter);
-    if (n < 0) {
-        return;
+}
+
+/****************************************************************************
+ * DESCRIPTION: Determine if received bytes are waiting in the FIFO
+ * RETURN:      true if RS485_Check_UART_Data() has a byte without waiting
+ * ALGORITHM:   none
+ * NOTES:       none
+ *****************************************************************************/
+bool RS485_Receive_Pending(struct mstp_port_struct_t *mstp_port)
+{
+    SHARED_MSTP_DATA *poSharedData;
+    FIFO_BUFFER *fifo = &Rx_FIFO;
+
+    poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    if (poSharedData) {
+        fifo = &poSharedData->Rx_FIFO;
     }
-    if (FD_ISSET(handle, &input)) {
-        n = read(handle, buf, sizeof(buf));
-        if (n > 0) {
-            FIFO_Add(fifo, &buf[0], n);
-        }
+
+    return !FIFO_Empty(fifo);
+}
+
+/****************************************************************************
+ * DESCRIPTION: Ask the serial driver to pass received bytes on at once
+ * RETURN:      none
+ * ALGORITHM:   none
+ * NOTES:       Not every driver supports it, so a failure is ignored.
+ *****************************************************************************/
+void RS485_Set_Low_Latency(int handle)
+{
+#if defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+    struct serial_struct serial = { 0 };
+
+    if (ioctl(handle, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        (void)ioctl(handle, TIOCSSERIAL, &serial);
     }
+#else
+    (void)handle;
+#endif
 }
 
 void RS485_Cleanup(void)
@@ -319,6 +385,7 @@ void RS485_Initialize(void)
     termios2_tcgetattr(RS485_Handle, &RS485_oldtio2);
 
     RS485_Set_Baud_Rate(RS485_Baud);
+    RS485_Set_Low_Latency(RS485_Handle);
 
     /* destructor */
     atexit(RS485_Cleanup);
@@ -329,6 +396,94 @@ void RS485_Initialize(void)
     FIFO_Init(&Rx_FIFO, Rx_Buffer, sizeof(Rx_Buffer));
 }
 
+/****************************************************************************
+ * DESCRIPTION: Open another serial port for an MS/TP port structure
+ * RETURN:      true if the port was opened
+ * ALGORITHM:   none
+ * NOTES:       The port data is allocated from the heap and kept in the
+ *              UserData of the MS/TP port, so that the receive functions
+ *              use this port instead of the one from RS485_Initialize().
+ *****************************************************************************/
+bool RS485_Port_Open(
+    struct mstp_port_struct_t *mstp_port, char *ifname, uint32_t baud)
+{
+    SHARED_MSTP_DATA *poSharedData;
+    struct termios2 newtio;
+
+    if (!mstp_port || !ifname) {
+        return false;
+    }
+    poSharedData = calloc(1, sizeof(SHARED_MSTP_DATA));
+    if (!poSharedData) {
+        return false;
+    }
+    poSharedData->RS485_Port_Name = ifname;
+    poSharedData->RS485_Baud = baud;
+    poSharedData->RS485_Handle = open(ifname, O_RDWR | O_NOCTTY);
+    if (poSharedData->RS485_Handle < 0) {
+        perror(ifname);
+        free(poSharedData);
+        return false;
+    }
+    termios2_tcgetattr(
+        poSharedData->RS485_Handle, &poSharedData->RS485_oldtio2);
+    memset(&newtio, 0, sizeof(newtio));
+    newtio.c_cflag =
+        CS8 | CLOCAL | CREAD | RS485MOD | BOTHER | (BOTHER << IBSHIFT);
+    newtio.c_ispeed = baud;
+    newtio.c_ospeed = baud;
+    termios2_tcsetattr(poSharedData->RS485_Handle, TCSAFLUSH, &newtio);
+    RS485_Set_Low_Latency(poSharedData->RS485_Handle);
+    termios2_tcflush(poSharedData->RS485_Handle, TCIOFLUSH);
+    FIFO_Init(
+        &poSharedData->Rx_FIFO, poSharedData->Rx_Buffer,
+        sizeof(poSharedData->Rx_Buffer));
+    mstp_port->UserData = poSharedData;
+
+    return true;
+}
+
+/****************************************************************************
+ * DESCRIPTION: Close a serial port opened with RS485_Port_Open()
+ * RETURN:      none
+ * ALGORITHM:   none
+ * NOTES:       none
+ *****************************************************************************/
+void RS485_Port_Close(struct mstp_port_struct_t *mstp_port)
+{
+    SHARED_MSTP_DATA *poSharedData;
+
+    if (!mstp_port || !mstp_port->UserData) {
+        return;
+    }
+    poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    termios2_tcsetattr(
+        poSharedData->RS485_Handle, TCSANOW, &poSharedData->RS485_oldtio2);
+    close(poSharedData->RS485_Handle);
+    free(poSharedData);
+    mstp_port->UserData = NULL;
+}
+
+/****************************************************************************
+ * DESCRIPTION: Get the file descriptor of the serial port of an MS/TP port
+ * RETURN:      the file descriptor, or -1 if the port is not open
+ * ALGORITHM:   none
+ * NOTES:       Lets an application wait on several ports with one select()
+ *****************************************************************************/
+int RS485_Port_Handle(const struct mstp_port_struct_t *mstp_port)
+{
+    const SHARED_MSTP_DATA *poSharedData = NULL;
+
+    if (mstp_port) {
+        poSharedData = (const SHARED_MSTP_DATA *)mstp_port->UserData;
+    }
+    if (poSharedData) {
+        return poSharedData->RS485_Handle;
+    }
+
+    return RS485_Handle;
+}
+
 /* Print in a format for Wireshark ExtCap */
 void RS485_Print_Ports(void)
 {
@@ -35,6 +35,10 @@ BACNET_STACK_EXPORT
 void RS485_Check_UART_Data(
     struct mstp_port_struct_t *mstp_port); /* port specific data */
 BACNET_STACK_EXPORT
+bool RS485_Receive_Pending(struct mstp_port_struct_t *mstp_port);
+BACNET_STACK_EXPORT
+void RS485_Set_Low_Latency(int handle);
+BACNET_STACK_EXPORT
 uint32_t RS485_Get_Port_Baud_Rate(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
 uint32_t RS485_Get_Baud_Rate(void);
@@ -45,6 +49,14 @@ bool RS485_Get_Config(struct serial_rs485 *config);
 BACNET_STACK_EXPORT
 bool RS485_Set_Config(const struct serial_rs485 *config);
 
+BACNET_STACK_EXPORT
+bool RS485_Port_Open(
+    struct mstp_port_struct_t *mstp_port, char *ifname, uint32_t baud);
+BACNET_STACK_EXPORT
+void RS485_Port_Close(struct mstp_port_struct_t *mstp_port);
+BACNET_STACK_EXPORT
+int RS485_Port_Handle(const struct mstp_port_struct_t *mstp_port);
+
 BACNET_STACK_EXPORT
 void RS485_Cleanup(void);
 BACNET_STACK_EXPORT
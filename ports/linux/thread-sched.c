@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Real-time scheduling, CPU affinity, and memory locking of the
+ *  datalink threads of the Linux ports.
+ *
+ * A timing critical thread, such as the MS/TP state machine that has to
+ * answer within Treply_timeout, is preempted by bulk IP work when it runs
+ * with the default policy and floats across the CPUs.  Each datalink
+ * names its threads, and the scheduling of the named threads is read
+ * from the environment:
+ *
+ *  BACNET_<NAME>_PRIORITY - SCHED_FIFO priority 1..99, or 0 for the
+ *      default policy
+ *  BACNET_<NAME>_CPU - CPU to pin the threads to
+ *  BACNET_MEMORY_LOCK - 1 to lock the memory of the process, so that
+ *      the threads are not delayed by page faults
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+#include "thread-sched.h"
+
+static pthread_mutex_t Memory_Lock_Mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool Memory_Lock_Tried;
+static bool Memory_Locked;
+
+/**
+ * @brief Get an integer from the environment variable of a named thread
+ * @param name - name of the threads, such as MSTP
+ * @param suffix - last part of the variable name, such as PRIORITY
+ * @param value - [out] the value, if the variable is set
+ * @return true if the variable is set
+ */
+static bool
+thread_sched_getenv(const char *name, const char *suffix, int *value)
+{
+    char variable[64];
+    const char *pEnv;
+    char *pEnd = NULL;
+    long number;
+
+    snprintf(variable, sizeof(variable), "BACNET_%s_%s", name, suffix);
+    pEnv = getenv(variable);
+    if (!pEnv || (pEnv[0] == 0)) {
+        return false;
+    }
+    number = strtol(pEnv, &pEnd, 0);
+    if ((pEnd == pEnv) || (number < -1) || (number > 1024)) {
+        fprintf(stderr, "%s=%s is not valid\n", variable, pEnv);
+        return false;
+    }
+    *value = (int)number;
+
+    return true;
+}
+
+/**
+ * @brief Initialize the scheduling of the named threads of a datalink,
+ *  from the default priority and from the environment
+ * @param sched - scheduling to initialize
+ * @param name - name of the threads, such as MSTP
+ * @param priority - default SCHED_FIFO priority, or 0 for the default
+ *  policy
+ */
+void thread_sched_init(THREAD_SCHED *sched, const char *name, int priority)
+{
+    const char *pEnv;
+    int value;
+
+    if (!sched) {
+        return;
+    }
+    sched->priority = priority;
+    sched->cpu = -1;
+    if (name) {
+        if (thread_sched_getenv(name, "PRIORITY", &value)) {
+            sched->priority = value;
+        }
+        if (thread_sched_getenv(name, "CPU", &value)) {
+            sched->cpu = value;
+        }
+    }
+    if (sched->priority < 0) {
+        sched->priority = 0;
+    } else if (sched->priority > sched_get_priority_max(SCHED_FIFO)) {
+        sched->priority = sched_get_priority_max(SCHED_FIFO);
+    }
+    if ((sched->cpu < -1) || (sched->cpu >= CPU_SETSIZE)) {
+        sched->cpu = -1;
+    }
+    pEnv = getenv("BACNET_MEMORY_LOCK");
+    if (pEnv && (atoi(pEnv) != 0)) {
+        (void)thread_sched_memory_lock();
+    }
+}
+
+/**
+ * @brief Create a thread with SCHED_FIFO priority and pinned to a CPU.
+ *  Without the permission to use SCHED_FIFO, the thread is created with
+ *  the default policy.
+ * @param thread - [out] the thread that was created
+ * @param attr - attributes of the thread, or NULL for the defaults
+ * @param sched - scheduling of the thread, or NULL for the default
+ * @param name - name of the thread used in the messages
+ * @param start_routine - thread function
+ * @param arg - argument of the thread function
+ * @return 0 if the thread was created, or the error of pthread_create()
+ */
+int thread_sched_create(
+    pthread_t *thread,
+    pthread_attr_t *attr,
+    const THREAD_SCHED *sched,
+    const char *name,
+    void *(*start_routine)(void *),
+    void *arg)
+{
+    pthread_attr_t thread_attr;
+    pthread_attr_t *pAttr = attr;
+    struct sched_param sch_param = { 0 };
+    cpu_set_t cpuset;
+    int rv;
+
+    if (!name) {
+        name = "BACnet";
+    }
+    if (sched && (sched->priority > 0)) {
+        if (!pAttr) {
+            pthread_attr_init(&thread_attr);
+            pAttr = &thread_attr;
+        }
+        sch_param.sched_priority = sched->priority;
+        pthread_attr_setinheritsched(pAttr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(pAttr, SCHED_FIFO);
+        pthread_attr_setschedparam(pAttr, &sch_param);
+    }
+    rv = pthread_create(thread, pAttr, start_routine, arg);
+    if ((rv == EPERM) && pAttr) {
+        fprintf(
+            stderr,
+            "%s: insufficient permissions to create thread with priority.\n"
+            " A thread without priority will be created.\n"
+            " Run this executable as a user with thread priority permission\n"
+            " or grant capability with \"setcap 'cap_sys_nice=eip'\"\n",
+            name);
+        pthread_attr_setinheritsched(pAttr, PTHREAD_INHERIT_SCHED);
+        rv = pthread_create(thread, pAttr, start_routine, arg);
+    }
+    if (pAttr == &thread_attr) {
+        pthread_attr_destroy(&thread_attr);
+    }
+    if ((rv == 0) && sched && (sched->cpu >= 0) &&
+        (sched->cpu < CPU_SETSIZE)) {
+        CPU_ZERO(&cpuset);
+        CPU_SET(sched->cpu, &cpuset);
+        if (pthread_setaffinity_np(*thread, sizeof(cpuset), &cpuset) != 0) {
+            fprintf(
+                stderr, "%s: cannot pin thread to CPU %d\n", name,
+                sched->cpu);
+        }
+    }
+
+    return rv;
+}
+
+/**
+ * @brief Lock the current and future memory of the process, once
+ * @return true if the memory is locked
+ */
+bool thread_sched_memory_lock(void)
+{
+    bool status;
+
+    pthread_mutex_lock(&Memory_Lock_Mutex);
+    if (!Memory_Lock_Tried) {
+        Memory_Lock_Tried = true;
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            Memory_Locked = true;
+        } else {
+            fprintf(
+                stderr,
+                "BACnet: cannot lock the memory of the process.\n"
+                " Grant capability with \"setcap 'cap_ipc_lock=eip'\"\n");
+        }
+    }
+    status = Memory_Locked;
+    pthread_mutex_unlock(&Memory_Lock_Mutex);
+
+    return status;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief Real-time scheduling, CPU affinity, and memory locking of the
+ *  datalink threads of the Linux ports.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_PORT_LINUX_THREAD_SCHED_H
+#define BACNET_PORT_LINUX_THREAD_SCHED_H
+
+#include <stdbool.h>
+#include <pthread.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* scheduling of one datalink thread */
+typedef struct thread_sched {
+    /* SCHED_FIFO priority 1..99, or 0 for the default policy */
+    int priority;
+    /* CPU to pin the thread to, or -1 for any CPU */
+    int cpu;
+} THREAD_SCHED;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void thread_sched_init(THREAD_SCHED *sched, const char *name, int priority);
+BACNET_STACK_EXPORT
+int thread_sched_create(
+    pthread_t *thread,
+    pthread_attr_t *attr,
+    const THREAD_SCHED *sched,
+    const char *name,
+    void *(*start_routine)(void *),
+    void *arg);
+BACNET_STACK_EXPORT
+bool thread_sched_memory_lock(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @brief Trend Log buffers kept in memory-mapped files for the Linux ports.
+ *
+ * Each log buffer is a file holding a small header with the ring state,
+ * followed by the fixed size records of the log.  The file is mapped into
+ * memory and handed to the Trend Log object, so the kernel pages the
+ * records in and out, and the log is there again after a restart without
+ * reading it back in.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bacnet/basic/object/trendlog.h"
+#include "bacnet/basic/sys/debug.h"
+#include "trendlog-mmap.h"
+
+/* identifies a Trend Log buffer file */
+#define TRENDLOG_MMAP_MAGIC 0x544C4F47UL
+/* records start at this offset, which keeps them aligned */
+#define TRENDLOG_MMAP_RECORDS_OFFSET 64
+
+/* header at the start of a Trend Log buffer file */
+struct trendlog_mmap_header {
+    uint32_t magic;
+    /* size of a record, which changes with the record layout */
+    uint32_t record_size;
+    TL_LOG_BUFFER_STATE state;
+};
+
+/* one Trend Log buffer file mapped into memory */
+struct trendlog_mmap_file {
+    bool used;
+    uint32_t object_instance;
+    void *address;
+    size_t length;
+};
+
+static struct trendlog_mmap_file Trendlog_Mmap_File[TRENDLOG_MMAP_MAX];
+
+/**
+ * @brief Find the mapped file of a Trend Log
+ * @param object_instance - object-instance number of the Trend Log
+ * @return the mapped file, or NULL if the log has none
+ */
+static struct trendlog_mmap_file *trendlog_mmap_find(uint32_t object_instance)
+{
+    unsigned i;
+
+    for (i = 0; i < TRENDLOG_MMAP_MAX; i++) {
+        if (Trendlog_Mmap_File[i].used &&
+            (Trendlog_Mmap_File[i].object_instance == object_instance)) {
+            return &Trendlog_Mmap_File[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Keep the records of a Trend Log in a memory-mapped file
+ * @note Call after Trend_Log_Init().  An existing file with the same
+ *  buffer size and record layout keeps its records; otherwise the log
+ *  starts out empty.
+ * @param object_instance - object-instance number of the Trend Log
+ * @param pathname - name of the file, which is created when missing
+ * @param buffer_size - number of records in the log buffer
+ * @return true if the Trend Log uses the file
+ */
+bool trendlog_mmap_open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size)
+{
+    struct trendlog_mmap_file *file = NULL;
+    struct trendlog_mmap_header *header;
+    void *address;
+    size_t length;
+    unsigned i;
+    int fd;
+
+    if (!pathname || (buffer_size == 0)) {
+        return false;
+    }
+    trendlog_mmap_close(object_instance);
+    for (i = 0; i < TRENDLOG_MMAP_MAX; i++) {
+        if (!Trendlog_Mmap_File[i].used) {
+            file = &Trendlog_Mmap_File[i];
+            break;
+        }
+    }
+    if (!file) {
+        return false;
+    }
+    length = TRENDLOG_MMAP_RECORDS_OFFSET +
+        ((size_t)buffer_size * sizeof(TL_DATA_REC));
+    fd = open(pathname, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        debug_perror("trendlog-mmap: open");
+        return false;
+    }
+    if (ftruncate(fd, (off_t)length) < 0) {
+        debug_perror("trendlog-mmap: ftruncate");
+        close(fd);
+        return false;
+    }
+    address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* the mapping keeps its own reference to the file */
+    close(fd);
+    if (address == MAP_FAILED) {
+        debug_perror("trendlog-mmap: mmap");
+        return false;
+    }
+    header = address;
+    if ((header->magic != TRENDLOG_MMAP_MAGIC) ||
+        (header->record_size != sizeof(TL_DATA_REC))) {
+        /* a new file, or records of another layout */
+        header->magic = TRENDLOG_MMAP_MAGIC;
+        header->record_size = sizeof(TL_DATA_REC);
+        header->state.ulBufferSize = 0;
+    }
+    if (!Trend_Log_Buffer_Set(
+            object_instance,
+            (TL_DATA_REC *)((uint8_t *)address + TRENDLOG_MMAP_RECORDS_OFFSET),
+            buffer_size, &header->state)) {
+        munmap(address, length);
+        return false;
+    }
+    file->used = true;
+    file->object_instance = object_instance;
+    file->address = address;
+    file->length = length;
+
+    return true;
+}
+
+/**
+ * @brief Return a Trend Log to its built-in buffer, and unmap its file
+ * @param object_instance - object-instance number of the Trend Log
+ */
+void trendlog_mmap_close(uint32_t object_instance)
+{
+    struct trendlog_mmap_file *file;
+
+    file = trendlog_mmap_find(object_instance);
+    if (!file) {
+        return;
+    }
+    (void)Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+    (void)msync(file->address, file->length, MS_SYNC);
+    (void)munmap(file->address, file->length);
+    file->used = false;
+}
+
+/**
+ * @brief Return every Trend Log to its built-in buffer, and unmap the files
+ */
+void trendlog_mmap_cleanup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < TRENDLOG_MMAP_MAX; i++) {
+        if (Trendlog_Mmap_File[i].used) {
+            trendlog_mmap_close(Trendlog_Mmap_File[i].object_instance);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/**
+ * @file
+ * @brief Trend Log buffers kept in memory-mapped files for the Linux ports,
+ *  so that the logs survive a restart and may be larger than RAM.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_PORT_LINUX_TRENDLOG_MMAP_H
+#define BACNET_PORT_LINUX_TRENDLOG_MMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* maximum number of Trend Logs kept in memory-mapped files */
+#ifndef TRENDLOG_MMAP_MAX
+#define TRENDLOG_MMAP_MAX 512
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool trendlog_mmap_open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size);
+BACNET_STACK_EXPORT
+void trendlog_mmap_close(uint32_t object_instance);
+BACNET_STACK_EXPORT
+void trendlog_mmap_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
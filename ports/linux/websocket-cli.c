@@ -14,6 +14,8 @@
 #include "bacnet/datalink/bsc/websocket.h"
 #include "bacnet/basic/sys/debug.h"
 #include "websocket-global.h"
+#include "lockstat-mutex.h"
+#include "thread-sched.h"
 
 #undef DEBUG_PRINTF
 #if DEBUG_WEBSOCKET_CLIENT
@@ -52,8 +54,26 @@ typedef struct {
     size_t fragment_buffer_len;
     char err_desc[BSC_WEBSOCKET_ERR_DESC_STR_MAX_LEN];
     BACNET_ERROR_CODE err_code;
+    /* host and port of the peer, to save its TLS session */
+    char host[BSC_WSURL_MAX_LEN];
+    uint16_t port;
 } BSC_WEBSOCKET_CONNECTION;
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+/* TLS sessions of the recently connected peers.  Each connection has its
+   own lws context, so a session is kept here between the connections, and
+   a reconnect to the same hub resumes it instead of a full handshake. */
+typedef struct {
+    char host[BSC_WSURL_MAX_LEN];
+    uint16_t port;
+    uint8_t *blob;
+    size_t blob_len;
+} BSC_WEBSOCKET_TLS_SESSION;
+
+static BSC_WEBSOCKET_TLS_SESSION
+    bws_cli_tls_session[BSC_CLIENT_WEBSOCKETS_MAX_NUM];
+#endif
+
 /* Some forward function declarations */
 
 static int bws_cli_websocket_event(
@@ -67,6 +87,9 @@ static const char *bws_hub_protocol = BSC_WEBSOCKET_HUB_PROTOCOL_STR;
 static const char *bws_direct_protocol = BSC_WEBSOCKET_DIRECT_PROTOCOL_STR;
 
 static pthread_mutex_t bws_cli_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+#if defined(BACNET_LOCK_STATISTICS)
+static LOCKSTAT_LOCK bws_cli_stats = LOCKSTAT_LOCK_INIT("bsc-client");
+#endif
 
 /* Websockets protocol defined in BACnet/SC \S AB.7.1.  */
 
@@ -130,6 +153,106 @@ static BSC_WEBSOCKET_HANDLE bws_cli_find_connnection(struct lws *ws)
     return BSC_WEBSOCKET_INVALID_HANDLE;
 }
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+static BSC_WEBSOCKET_TLS_SESSION *
+bws_cli_tls_session_find(const char *host, uint16_t port, bool alloc)
+{
+    BSC_WEBSOCKET_TLS_SESSION *free_session = NULL;
+    int i;
+
+    for (i = 0; i < BSC_CLIENT_WEBSOCKETS_MAX_NUM; i++) {
+        if ((bws_cli_tls_session[i].port == port) &&
+            (strcmp(bws_cli_tls_session[i].host, host) == 0)) {
+            return &bws_cli_tls_session[i];
+        }
+        if (!free_session && !bws_cli_tls_session[i].blob) {
+            free_session = &bws_cli_tls_session[i];
+        }
+    }
+    if (!alloc) {
+        return NULL;
+    }
+    if (!free_session) {
+        /* replace the oldest session */
+        free(bws_cli_tls_session[0].blob);
+        memmove(
+            &bws_cli_tls_session[0], &bws_cli_tls_session[1],
+            sizeof(bws_cli_tls_session[0]) *
+                (BSC_CLIENT_WEBSOCKETS_MAX_NUM - 1));
+        free_session = &bws_cli_tls_session[BSC_CLIENT_WEBSOCKETS_MAX_NUM - 1];
+    }
+    memset(free_session, 0, sizeof(*free_session));
+    snprintf(free_session->host, sizeof(free_session->host), "%s", host);
+    free_session->port = port;
+
+    return free_session;
+}
+
+static int bws_cli_tls_session_save_cb(
+    struct lws_context *cx, struct lws_tls_session_dump *info)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session = info->opaque;
+    uint8_t *blob;
+
+    (void)cx;
+    blob = malloc(info->blob_len);
+    if (!blob) {
+        return 1;
+    }
+    memcpy(blob, info->blob, info->blob_len);
+    free(session->blob);
+    session->blob = blob;
+    session->blob_len = info->blob_len;
+
+    return 0;
+}
+
+static int bws_cli_tls_session_load_cb(
+    struct lws_context *cx, struct lws_tls_session_dump *info)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session = info->opaque;
+
+    (void)cx;
+    /* libwebsockets frees the blob after loading it */
+    info->blob = malloc(session->blob_len);
+    if (!info->blob) {
+        return 1;
+    }
+    memcpy(info->blob, session->blob, session->blob_len);
+    info->blob_len = session->blob_len;
+
+    return 0;
+}
+
+/* keep the TLS session of an established connection for the next one */
+static void bws_cli_tls_session_save(BSC_WEBSOCKET_HANDLE h, struct lws *wsi)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session;
+
+    session = bws_cli_tls_session_find(
+        bws_cli_conn[h].host, bws_cli_conn[h].port, true);
+    (void)lws_tls_session_dump_save(
+        lws_get_vhost(wsi), bws_cli_conn[h].host, bws_cli_conn[h].port,
+        bws_cli_tls_session_save_cb, session);
+}
+
+/* offer the TLS session of the last connection to the same peer */
+static void bws_cli_tls_session_load(BSC_WEBSOCKET_HANDLE h)
+{
+    BSC_WEBSOCKET_TLS_SESSION *session;
+    struct lws_vhost *vhost;
+
+    session = bws_cli_tls_session_find(
+        bws_cli_conn[h].host, bws_cli_conn[h].port, false);
+    vhost = lws_get_vhost_by_name(bws_cli_conn[h].ctx, "default");
+    if (session && session->blob && vhost) {
+        (void)lws_tls_session_dump_load(
+            vhost, bws_cli_conn[h].host, bws_cli_conn[h].port,
+            bws_cli_tls_session_load_cb, session);
+    }
+}
+#endif
+
 static void bws_set_err_desc(BSC_WEBSOCKET_HANDLE h, char *err_desc)
 {
     size_t len;
@@ -224,8 +347,13 @@ static int bws_cli_websocket_event(
         reason, user, in);
 
     switch (reason) {
+        case LWS_CALLBACK_OPENSSL_LOAD_EXTRA_CLIENT_VERIFY_CERTS: {
+            /* user is the SSL_CTX of the client */
+            bsc_websocket_tls_setup(user, false);
+            break;
+        }
         case LWS_CALLBACK_CLIENT_ESTABLISHED: {
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             h = bws_cli_find_connnection(wsi);
 
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
@@ -240,6 +368,9 @@ static int bws_cli_websocket_event(
 
             DEBUG_PRINTF("bws_cli_websocket_event() connection established\n");
             bws_cli_conn[h].state = BSC_WEBSOCKET_STATE_CONNECTED;
+#if defined(LWS_WITH_TLS_SESSIONS)
+            bws_cli_tls_session_save(h, wsi);
+#endif
             dispatch_func = bws_cli_conn[h].dispatch_func;
             user_param = bws_cli_conn[h].user_param;
             pthread_mutex_unlock(&bws_cli_mutex);
@@ -248,7 +379,7 @@ static int bws_cli_websocket_event(
             break;
         }
         case LWS_CALLBACK_CLIENT_RECEIVE: {
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             h = bws_cli_find_connnection(wsi);
 
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
@@ -343,7 +474,7 @@ static int bws_cli_websocket_event(
                         h, BSC_WEBSOCKET_RECEIVED, 0, NULL,
                         bws_cli_conn[h].fragment_buffer,
                         bws_cli_conn[h].fragment_buffer_len, user_param);
-                    pthread_mutex_lock(&bws_cli_mutex);
+                    LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
                     bws_cli_conn[h].fragment_buffer_len = 0;
                     pthread_mutex_unlock(&bws_cli_mutex);
                 } else {
@@ -353,7 +484,7 @@ static int bws_cli_websocket_event(
             break;
         }
         case LWS_CALLBACK_CLIENT_WRITEABLE: {
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             h = bws_cli_find_connnection(wsi);
 
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
@@ -380,7 +511,7 @@ static int bws_cli_websocket_event(
                 pthread_mutex_unlock(&bws_cli_mutex);
                 dispatch_func(
                     h, BSC_WEBSOCKET_SENDABLE, 0, NULL, NULL, 0, user_param);
-                pthread_mutex_lock(&bws_cli_mutex);
+                LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
                 bws_cli_conn[h].want_send_data = false;
                 bws_cli_conn[h].can_send_data = false;
                 DEBUG_PRINTF(
@@ -401,7 +532,7 @@ static int bws_cli_websocket_event(
             break;
         }
         case LWS_CALLBACK_WS_PEER_INITIATED_CLOSE: {
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             h = bws_cli_find_connnection(wsi);
             if (h != BSC_WEBSOCKET_INVALID_HANDLE && len >= 2) {
                 err_code[0] = ((uint8_t *)in)[1];
@@ -414,7 +545,7 @@ static int bws_cli_websocket_event(
         case LWS_CALLBACK_CLIENT_CLOSED:
         case LWS_CALLBACK_CLOSED:
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR: {
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             h = bws_cli_find_connnection(wsi);
             if (h != BSC_WEBSOCKET_INVALID_HANDLE) {
                 bws_cli_conn[h].state = BSC_WEBSOCKET_STATE_DISCONNECTING;
@@ -448,7 +579,7 @@ static void *bws_cli_worker(void *arg)
 
     while (1) {
         DEBUG_PRINTF("bws_cli_worker() try mutex h = %d\n", h);
-        pthread_mutex_lock(&bws_cli_mutex);
+        LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
         DEBUG_PRINTF("bws_cli_worker() mutex locked h = %d\n", h);
         if (conn->state == BSC_WEBSOCKET_STATE_CONNECTED) {
             if (conn->want_send_data) {
@@ -478,7 +609,7 @@ static void *bws_cli_worker(void *arg)
             bsc_websocket_global_lock();
             lws_context_destroy(conn->ctx);
             bsc_websocket_global_unlock();
-            pthread_mutex_lock(&bws_cli_mutex);
+            LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
             dispatch_func = conn->dispatch_func;
             user_param = conn->user_param;
             err_code = conn->err_code;
@@ -526,6 +657,7 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     pthread_t thread_id;
     size_t len;
     pthread_attr_t attr;
+    THREAD_SCHED sched;
     int r;
 
     DEBUG_PRINTF("bws_cli_connect() >>> proto = %d, url = %s\n", proto, url);
@@ -552,7 +684,8 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     tmp_url[len] = 0;
 
     bsc_websocket_init_log();
-    pthread_mutex_lock(&bws_cli_mutex);
+    bsc_websocket_tls_trust_set(ca_cert, ca_cert_size);
+    LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
 
     if (lws_parse_uri(tmp_url, &prot, &addr, &port, &path) != 0 || port == -1 ||
         !prot || !addr || !path) {
@@ -581,6 +714,8 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     bws_cli_conn[h].fragment_buffer_size = 0;
     bws_cli_conn[h].dispatch_func = dispatch_func;
     bws_cli_conn[h].user_param = dispatch_func_user_param;
+    snprintf(bws_cli_conn[h].host, sizeof(bws_cli_conn[h].host), "%s", addr);
+    bws_cli_conn[h].port = (uint16_t)port;
     info.port = CONTEXT_PORT_NO_LISTEN;
     if (proto == BSC_WEBSOCKET_HUB_PROTOCOL) {
         info.protocols = bws_cli_hub_protocol;
@@ -606,7 +741,7 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     bsc_websocket_global_lock();
     bws_cli_conn[h].ctx = lws_create_context(&info);
     bsc_websocket_global_unlock();
-    pthread_mutex_lock(&bws_cli_mutex);
+    LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
     DEBUG_PRINTF("bws_cli_connect() created ctx %p\n", bws_cli_conn[h].ctx);
 
     if (!bws_cli_conn[h].ctx) {
@@ -617,6 +752,9 @@ BSC_WEBSOCKET_RET bws_cli_connect(
         return BSC_WEBSOCKET_NO_RESOURCES;
     }
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+    bws_cli_tls_session_load(h);
+#endif
     bws_cli_conn[h].ws = NULL;
     cinfo.context = bws_cli_conn[h].ctx;
     cinfo.address = addr;
@@ -651,8 +789,10 @@ BSC_WEBSOCKET_RET bws_cli_connect(
     }
 
     if (!r) {
-        r = pthread_create(
-            &thread_id, &attr, &bws_cli_worker, &bws_cli_conn[h]);
+        thread_sched_init(&sched, "BSC", 0);
+        r = thread_sched_create(
+            &thread_id, &attr, &sched, "BACnet/SC", &bws_cli_worker,
+            &bws_cli_conn[h]);
     }
 
     if (r) {
@@ -675,7 +815,7 @@ BSC_WEBSOCKET_RET bws_cli_connect(
         bsc_websocket_global_lock();
         lws_context_destroy(bws_cli_conn[h].ctx);
         bsc_websocket_global_unlock();
-        pthread_mutex_lock(&bws_cli_mutex);
+        LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
         bws_cli_free_connection(h);
         pthread_mutex_unlock(&bws_cli_mutex);
         DEBUG_PRINTF(
@@ -693,7 +833,7 @@ void bws_cli_disconnect(BSC_WEBSOCKET_HANDLE h)
     DEBUG_PRINTF("bws_cli_disconnect() >>> h = %d\n", h);
 
     if (h >= 0 && h < BSC_CLIENT_WEBSOCKETS_MAX_NUM) {
-        pthread_mutex_lock(&bws_cli_mutex);
+        LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
         DEBUG_PRINTF(
             "bws_cli_disconnect() state = %d\n", bws_cli_conn[h].state);
         if (bws_cli_conn[h].state == BSC_WEBSOCKET_STATE_CONNECTING ||
@@ -713,7 +853,7 @@ void bws_cli_send(BSC_WEBSOCKET_HANDLE h)
     DEBUG_PRINTF("bws_cli_send() >>> h = %d\n", h);
 
     if (h >= 0 && h < BSC_CLIENT_WEBSOCKETS_MAX_NUM) {
-        pthread_mutex_lock(&bws_cli_mutex);
+        LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
 
         if (bws_cli_conn[h].state == BSC_WEBSOCKET_STATE_CONNECTED) {
             /* tell worker to process send request */
@@ -733,6 +873,7 @@ BSC_WEBSOCKET_RET bws_cli_dispatch_send(
 {
     int written;
     BSC_WEBSOCKET_RET ret;
+    struct lws *ws;
 
     DEBUG_PRINTF(
         "bws_cli_dispatch_send() >>> h = %d, payload = %p, payload_size = %d\n",
@@ -744,7 +885,7 @@ BSC_WEBSOCKET_RET bws_cli_dispatch_send(
         return BSC_WEBSOCKET_BAD_PARAM;
     }
 
-    pthread_mutex_lock(&bws_cli_mutex);
+    LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
 
     if ((bws_cli_conn[h].state != BSC_WEBSOCKET_STATE_CONNECTED) ||
         !bws_cli_conn[h].want_send_data || !bws_cli_conn[h].can_send_data) {
@@ -758,8 +899,14 @@ BSC_WEBSOCKET_RET bws_cli_dispatch_send(
         return BSC_WEBSOCKET_INVALID_OPERATION;
     }
 
-    written =
-        lws_write(bws_cli_conn[h].ws, payload, payload_size, LWS_WRITE_BINARY);
+    /* The send is dispatched from LWS_CALLBACK_CLIENT_WRITEABLE on the
+       worker of the connection, so the wsi stays valid without the client
+       mutex, and the workers of other connections are not serialized
+       behind this write. */
+    ws = bws_cli_conn[h].ws;
+    pthread_mutex_unlock(&bws_cli_mutex);
+    written = lws_write(ws, payload, payload_size, LWS_WRITE_BINARY);
+    LOCKSTAT_MUTEX_LOCK(&bws_cli_mutex, &bws_cli_stats);
 
     DEBUG_PRINTF("bws_cli_dispatch_send() %d bytes is sent\n", written);
 
@@ -9,10 +9,16 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <pthread.h>
 #include <libwebsockets.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
 #include "websocket-global.h"
+#include "lockstat-mutex.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/datalink/bsc/bsc-peer-cache.h"
 
 #if LWS_MAX_SMP <= 1
 #warning \
@@ -22,12 +28,19 @@
 static pthread_mutex_t websocket_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 static pthread_mutex_t websocket_dispatch_mutex =
     PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_mutex_t websocket_tls_mutex = PTHREAD_MUTEX_INITIALIZER;
+#if defined(BACNET_LOCK_STATISTICS) && (BSC_DEBUG_WEBSOCKET_MUTEX_ENABLED != 1)
+static LOCKSTAT_LOCK websocket_stats =
+    LOCKSTAT_LOCK_INIT("bsc-websocket-global");
+static LOCKSTAT_LOCK websocket_dispatch_stats =
+    LOCKSTAT_LOCK_INIT("bsc-websocket-dispatch");
+#endif
 
 #if (BSC_DEBUG_WEBSOCKET_MUTEX_ENABLED != 1)
 
 void bsc_websocket_global_lock(void)
 {
-    pthread_mutex_lock(&websocket_mutex);
+    LOCKSTAT_MUTEX_LOCK(&websocket_mutex, &websocket_stats);
 }
 
 void bsc_websocket_global_unlock(void)
@@ -37,7 +50,7 @@ void bsc_websocket_global_unlock(void)
 
 void bws_dispatch_lock(void)
 {
-    pthread_mutex_lock(&websocket_dispatch_mutex);
+    LOCKSTAT_MUTEX_LOCK(&websocket_dispatch_mutex, &websocket_dispatch_stats);
 }
 
 void bws_dispatch_unlock(void)
@@ -127,3 +140,112 @@ void bsc_websocket_init_log(void)
     }
     bsc_websocket_global_unlock();
 }
+
+/**
+ * @brief Set the trust anchors of a server or a client, so that the peer
+ *  certificates verified with other CA certificates are verified again
+ * @param ca_cert - CA certificates in PEM format
+ * @param ca_cert_size - size of the CA certificates
+ */
+void bsc_websocket_tls_trust_set(const uint8_t *ca_cert, size_t ca_cert_size)
+{
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+
+    if (!ca_cert || !ca_cert_size) {
+        return;
+    }
+    if (EVP_Digest(
+            ca_cert, ca_cert_size, digest, &digest_len, EVP_sha256(), NULL) &&
+        (digest_len == BSC_PEER_FINGERPRINT_SIZE)) {
+        pthread_mutex_lock(&websocket_tls_mutex);
+        (void)bsc_peer_cache_trust_set(digest);
+        pthread_mutex_unlock(&websocket_tls_mutex);
+    }
+}
+
+/**
+ * @brief Forget the verified peer certificates, such as when a certificate
+ *  revocation list changes
+ */
+void bsc_websocket_tls_peers_invalidate(void)
+{
+    pthread_mutex_lock(&websocket_tls_mutex);
+    bsc_peer_cache_invalidate();
+    pthread_mutex_unlock(&websocket_tls_mutex);
+}
+
+/**
+ * @brief Verify the certificate chain of a peer, unless the certificate
+ *  of the peer was verified before and has not expired
+ * @param store_ctx - certificate store context of the handshake
+ * @param arg - not used
+ * @return 1 if the certificate is trusted, 0 otherwise
+ */
+static int bsc_websocket_tls_verify(X509_STORE_CTX *store_ctx, void *arg)
+{
+    X509 *cert = X509_STORE_CTX_get0_cert(store_ctx);
+    uint8_t fingerprint[EVP_MAX_MD_SIZE];
+    unsigned int fingerprint_len = 0;
+    char identity[BSC_PEER_IDENTITY_MAX + 1] = { 0 };
+    time_t now = time(NULL);
+    int days = 0, seconds = 0;
+    bool cached = false;
+    int ret;
+    (void)arg;
+
+    if (cert &&
+        X509_digest(cert, EVP_sha256(), fingerprint, &fingerprint_len) &&
+        (fingerprint_len == BSC_PEER_FINGERPRINT_SIZE)) {
+        pthread_mutex_lock(&websocket_tls_mutex);
+        cached = bsc_peer_cache_lookup(fingerprint, now, NULL, 0);
+        pthread_mutex_unlock(&websocket_tls_mutex);
+        if (cached) {
+            X509_STORE_CTX_set_error(store_ctx, X509_V_OK);
+            return 1;
+        }
+    } else {
+        fingerprint_len = 0;
+    }
+    ret = X509_verify_cert(store_ctx);
+    if ((ret == 1) && fingerprint_len &&
+        (X509_STORE_CTX_get_error(store_ctx) == X509_V_OK) &&
+        ASN1_TIME_diff(&days, &seconds, NULL, X509_get0_notAfter(cert)) &&
+        ((days > 0) || ((days == 0) && (seconds > 0)))) {
+        (void)X509_NAME_get_text_by_NID(
+            X509_get_subject_name(cert), NID_commonName, identity,
+            sizeof(identity));
+        pthread_mutex_lock(&websocket_tls_mutex);
+        bsc_peer_cache_add(
+            fingerprint, (uint64_t)now + (uint64_t)days * 86400UL + seconds,
+            identity, now);
+        pthread_mutex_unlock(&websocket_tls_mutex);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Set up the TLS context of a server or a client: the peer
+ *  certificates are looked up in the verified peer cache, and a server
+ *  lets the reconnecting peers resume their TLS sessions
+ * @param ssl_ctx - SSL_CTX of the libwebsockets context
+ * @param server - true for the TLS context of a server
+ */
+void bsc_websocket_tls_setup(void *ssl_ctx, bool server)
+{
+    SSL_CTX *ctx = (SSL_CTX *)ssl_ctx;
+    static const unsigned char session_id_context[] = "BACnet/SC";
+
+    if (!ctx) {
+        return;
+    }
+    SSL_CTX_set_cert_verify_callback(ctx, bsc_websocket_tls_verify, NULL);
+    if (server) {
+        SSL_CTX_set_session_id_context(
+            ctx, session_id_context, sizeof(session_id_context) - 1);
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, BSC_WEBSOCKET_TLS_SESSION_CACHE_SIZE);
+        SSL_CTX_set_timeout(ctx, BSC_WEBSOCKET_TLS_SESSION_TIMEOUT_S);
+    }
+}
@@ -8,6 +8,20 @@
 #ifndef __BSC_WEBSOCKET_MUTEX_INCLUDED__
 #define __BSC_WEBSOCKET_MUTEX_INCLUDED__
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* number of TLS sessions that a server keeps for resumption */
+#ifndef BSC_WEBSOCKET_TLS_SESSION_CACHE_SIZE
+#define BSC_WEBSOCKET_TLS_SESSION_CACHE_SIZE 256
+#endif
+
+/* seconds that a TLS session can be resumed */
+#ifndef BSC_WEBSOCKET_TLS_SESSION_TIMEOUT_S
+#define BSC_WEBSOCKET_TLS_SESSION_TIMEOUT_S 3600
+#endif
+
 #ifndef BSC_DEBUG_WEBSOCKET_MUTEX_ENABLED
 #define BSC_DEBUG_WEBSOCKET_MUTEX_ENABLED 0
 #endif
@@ -26,4 +40,8 @@ void bsc_websocket_global_unlock_dbg(char *f, int line);
 
 void bsc_websocket_init_log(void);
 
+void bsc_websocket_tls_trust_set(const uint8_t *ca_cert, size_t ca_cert_size);
+void bsc_websocket_tls_peers_invalidate(void);
+void bsc_websocket_tls_setup(void *ssl_ctx, bool server);
+
 #endif
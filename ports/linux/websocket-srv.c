@@ -14,6 +14,8 @@
 #include "bacnet/datalink/bsc/websocket.h"
 #include "bacnet/basic/sys/debug.h"
 #include "websocket-global.h"
+#include "lockstat-mutex.h"
+#include "thread-sched.h"
 #include <arpa/inet.h>
 
 #undef DEBUG_PRINTF
@@ -58,6 +60,8 @@ typedef struct {
     size_t fragment_buffer_size;
     size_t fragment_buffer_len;
     BACNET_ERROR_CODE err_code;
+    /* index of the service thread which owns the connection */
+    int tsi;
 } BSC_WEBSOCKET_CONNECTION;
 
 #if BSC_CONF_WEBSOCKET_SERVERS_NUM < 1
@@ -68,6 +72,13 @@ static pthread_mutex_t bws_global_mutex =
     PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 static pthread_mutex_t bws_srv_direct_mutex[BSC_CONF_WEBSOCKET_SERVERS_NUM];
 static pthread_mutex_t bws_srv_hub_mutex[BSC_CONF_WEBSOCKET_SERVERS_NUM];
+#if defined(BACNET_LOCK_STATISTICS)
+static LOCKSTAT_LOCK bws_global_stats = LOCKSTAT_LOCK_INIT("bsc-server-global");
+static LOCKSTAT_LOCK bws_srv_direct_stats[BSC_CONF_WEBSOCKET_SERVERS_NUM];
+static LOCKSTAT_LOCK bws_srv_hub_stats[BSC_CONF_WEBSOCKET_SERVERS_NUM];
+static char bws_srv_direct_stats_name[BSC_CONF_WEBSOCKET_SERVERS_NUM][32];
+static char bws_srv_hub_stats_name[BSC_CONF_WEBSOCKET_SERVERS_NUM][32];
+#endif
 
 #if BSC_SERVER_HUB_WEBSOCKETS_MAX_NUM > 0
 static BSC_WEBSOCKET_CONNECTION
@@ -85,17 +96,33 @@ static BSC_WEBSOCKET_CONNECTION
 static BSC_WEBSOCKET_CONNECTION bws_direct_conn[1][1] = { 0 };
 #endif
 
+struct BACNetWebsocketServerContext;
+
+typedef struct {
+    struct BACNetWebsocketServerContext *ctx;
+    int tsi;
+    pthread_t thread_id;
+} BSC_WEBSOCKET_SERVICE_THREAD;
+
 typedef struct BACNetWebsocketServerContext {
     bool used;
     struct lws_context *wsctx;
     BSC_WEBSOCKET_PROTOCOL proto;
     BSC_WEBSOCKET_CONNECTION *conn;
     pthread_mutex_t *mutex;
+#if defined(BACNET_LOCK_STATISTICS)
+    LOCKSTAT_LOCK *mutex_stats;
+#endif
     BSC_WEBSOCKET_SRV_DISPATCH dispatch_func;
     void *user_param;
     bool stop_worker;
+    int threads_num;
+    BSC_WEBSOCKET_SERVICE_THREAD thread[BSC_WEBSOCKET_SERVER_THREADS_NUM];
 } BSC_WEBSOCKET_CONTEXT;
 
+/* index of the service thread that runs the websocket callback */
+static __thread int bws_srv_tsi;
+
 static BSC_WEBSOCKET_CONTEXT bws_hub_ctx[BSC_CONF_WEBSOCKET_SERVERS_NUM] = {
     0
 };
@@ -132,7 +159,7 @@ static BSC_WEBSOCKET_CONTEXT *bws_alloc_server_ctx(BSC_WEBSOCKET_PROTOCOL proto)
         ? &bws_hub_ctx[0]
         : &bws_direct_ctx[0];
 
-    pthread_mutex_lock(&bws_global_mutex);
+    LOCKSTAT_MUTEX_LOCK(&bws_global_mutex, &bws_global_stats);
     DEBUG_PRINTF("bws_alloc_server_ctx() >>> proto = %d\n", proto);
 
     for (i = 0; i < BSC_CONF_WEBSOCKET_SERVERS_NUM; i++) {
@@ -140,9 +167,25 @@ static BSC_WEBSOCKET_CONTEXT *bws_alloc_server_ctx(BSC_WEBSOCKET_PROTOCOL proto)
             if (proto == BSC_WEBSOCKET_HUB_PROTOCOL) {
                 ctx[i].mutex = &bws_srv_hub_mutex[i];
                 ctx[i].conn = &bws_hub_conn[i][0];
+#if defined(BACNET_LOCK_STATISTICS)
+                snprintf(
+                    bws_srv_hub_stats_name[i],
+                    sizeof(bws_srv_hub_stats_name[i]), "bsc-hub-server-%d",
+                    i);
+                bws_srv_hub_stats[i].name = bws_srv_hub_stats_name[i];
+                ctx[i].mutex_stats = &bws_srv_hub_stats[i];
+#endif
             } else {
                 ctx[i].mutex = &bws_srv_direct_mutex[i];
                 ctx[i].conn = &bws_direct_conn[i][0];
+#if defined(BACNET_LOCK_STATISTICS)
+                snprintf(
+                    bws_srv_direct_stats_name[i],
+                    sizeof(bws_srv_direct_stats_name[i]),
+                    "bsc-direct-server-%d", i);
+                bws_srv_direct_stats[i].name = bws_srv_direct_stats_name[i];
+                ctx[i].mutex_stats = &bws_srv_direct_stats[i];
+#endif
             }
             if (!bws_mutex_init(ctx[i].mutex)) {
                 DEBUG_PRINTF("bws_alloc_server_ctx() <<< ret = %p\n", &ctx[i]);
@@ -218,7 +261,7 @@ static void bws_set_disconnect_reason(
 
 static void bws_free_server_ctx(BSC_WEBSOCKET_CONTEXT *ctx)
 {
-    pthread_mutex_lock(&bws_global_mutex);
+    LOCKSTAT_MUTEX_LOCK(&bws_global_mutex, &bws_global_stats);
     DEBUG_PRINTF("bws_free_server_ctx() >>> ctx = %p\n", ctx);
     ctx->used = false;
     ctx->wsctx = NULL;
@@ -237,7 +280,7 @@ static bool bws_validate_ctx_pointer(BSC_WEBSOCKET_CONTEXT *ctx)
     bool is_validated = false;
     int i;
 
-    pthread_mutex_lock(&bws_global_mutex);
+    LOCKSTAT_MUTEX_LOCK(&bws_global_mutex, &bws_global_stats);
 
     for (i = 0; i < BSC_CONF_WEBSOCKET_SERVERS_NUM; i++) {
         if (ctx == &bws_hub_ctx[i]) {
@@ -348,8 +391,13 @@ static int bws_srv_websocket_event(
         ctx, ctx->user_param, ctx->proto, wsi, reason, in, len);
 
     switch (reason) {
+        case LWS_CALLBACK_OPENSSL_LOAD_EXTRA_SERVER_VERIFY_CERTS: {
+            /* user is the SSL_CTX of the server */
+            bsc_websocket_tls_setup(user, true);
+            break;
+        }
         case LWS_CALLBACK_ESTABLISHED: {
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             DEBUG_PRINTF("bws_srv_websocket_event() established connection\n");
             h = bws_srv_alloc_connection(ctx);
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
@@ -365,6 +413,7 @@ static int bws_srv_websocket_event(
             ctx->conn[h].ws = wsi;
             ctx->conn[h].state = BSC_WEBSOCKET_STATE_CONNECTED;
             ctx->conn[h].err_code = ERROR_CODE_SUCCESS;
+            ctx->conn[h].tsi = bws_srv_tsi;
             dispatch_func = ctx->dispatch_func;
             user_param = ctx->user_param;
             pthread_mutex_unlock(ctx->mutex);
@@ -377,7 +426,7 @@ static int bws_srv_websocket_event(
         }
         case LWS_CALLBACK_CLOSED: {
             DEBUG_PRINTF("bws_srv_websocket_event() closed connection\n");
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             h = bws_find_connnection(ctx, wsi);
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
                 pthread_mutex_unlock(ctx->mutex);
@@ -403,7 +452,7 @@ static int bws_srv_websocket_event(
             break;
         }
         case LWS_CALLBACK_WS_PEER_INITIATED_CLOSE: {
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             h = bws_find_connnection(ctx, wsi);
             if (h != BSC_WEBSOCKET_INVALID_HANDLE && len >= 2) {
                 err_code[0] = ((uint8_t *)in)[1];
@@ -414,7 +463,7 @@ static int bws_srv_websocket_event(
             break;
         }
         case LWS_CALLBACK_RECEIVE: {
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             h = bws_find_connnection(ctx, wsi);
             if (h == BSC_WEBSOCKET_INVALID_HANDLE) {
                 pthread_mutex_unlock(ctx->mutex);
@@ -505,7 +554,7 @@ static int bws_srv_websocket_event(
                             BSC_WEBSOCKET_RECEIVED, 0, NULL,
                             ctx->conn[h].fragment_buffer,
                             ctx->conn[h].fragment_buffer_len, user_param);
-                        pthread_mutex_lock(ctx->mutex);
+                        LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
                         ctx->conn[h].fragment_buffer_len = 0;
                         pthread_mutex_unlock(ctx->mutex);
                     } else {
@@ -516,7 +565,7 @@ static int bws_srv_websocket_event(
             break;
         }
         case LWS_CALLBACK_SERVER_WRITEABLE: {
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             DEBUG_PRINTF(
                 "bws_srv_websocket_event() ctx %p proto %d can write\n", ctx,
                 ctx->proto);
@@ -548,7 +597,7 @@ static int bws_srv_websocket_event(
                             BSC_WEBSOCKET_SENDABLE, 0, NULL, NULL, 0,
                             user_param);
                     }
-                    pthread_mutex_lock(ctx->mutex);
+                    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
                     ctx->conn[h].want_send_data = false;
                     ctx->conn[h].can_send_data = false;
                     pthread_mutex_unlock(ctx->mutex);
@@ -569,31 +618,100 @@ static int bws_srv_websocket_event(
     return ret;
 }
 
+static void *bws_srv_worker(void *arg);
+
+/**
+ * @brief Create the service threads of a server, other than the first one
+ *  which runs the worker that creates them.
+ * @param ctx - server context
+ * @return true if all of the service threads are running
+ */
+static bool bws_srv_start_service_threads(BSC_WEBSOCKET_CONTEXT *ctx)
+{
+    THREAD_SCHED sched;
+    int i;
+
+    thread_sched_init(&sched, "BSC", 0);
+    for (i = 1; i < ctx->threads_num; i++) {
+        ctx->thread[i].ctx = ctx;
+        ctx->thread[i].tsi = i;
+        if (thread_sched_create(
+                &ctx->thread[i].thread_id, NULL, &sched, "BACnet/SC",
+                &bws_srv_worker, &ctx->thread[i]) != 0) {
+            DEBUG_PRINTF(
+                "bws_srv_start_service_threads() ctx %p can not create "
+                "service thread %d\n",
+                ctx, i);
+            ctx->threads_num = i;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wait until the service threads of a server, other than the first
+ *  one, have left libwebsockets.
+ * @param ctx - server context
+ */
+static void bws_srv_join_service_threads(BSC_WEBSOCKET_CONTEXT *ctx)
+{
+    int i;
+
+    for (i = 1; i < ctx->threads_num; i++) {
+        pthread_join(ctx->thread[i].thread_id, NULL);
+    }
+}
+
 static void *bws_srv_worker(void *arg)
 {
-    BSC_WEBSOCKET_CONTEXT *ctx = (BSC_WEBSOCKET_CONTEXT *)arg;
+    BSC_WEBSOCKET_SERVICE_THREAD *thread = (BSC_WEBSOCKET_SERVICE_THREAD *)arg;
+    BSC_WEBSOCKET_CONTEXT *ctx = thread->ctx;
+    int tsi = thread->tsi;
     int i;
     BSC_WEBSOCKET_SRV_DISPATCH dispatch_func;
     void *user_param;
 
     DEBUG_PRINTF(
-        "bws_srv_worker() started for ctx %p proto %d user_param %p\n", ctx,
-        ctx->proto, ctx->user_param);
+        "bws_srv_worker() started for ctx %p proto %d user_param %p tsi %d\n",
+        ctx, ctx->proto, ctx->user_param, tsi);
 
-    pthread_mutex_lock(ctx->mutex);
-    dispatch_func = ctx->dispatch_func;
-    user_param = ctx->user_param;
-    pthread_mutex_unlock(ctx->mutex);
+    bws_srv_tsi = tsi;
+
+    if (tsi == 0) {
+        LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
+        dispatch_func = ctx->dispatch_func;
+        user_param = ctx->user_param;
+        pthread_mutex_unlock(ctx->mutex);
 
-    dispatch_func(
-        (BSC_WEBSOCKET_SRV_HANDLE)ctx, 0, BSC_WEBSOCKET_SERVER_STARTED, 0, NULL,
-        NULL, 0, user_param);
+        dispatch_func(
+            (BSC_WEBSOCKET_SRV_HANDLE)ctx, 0, BSC_WEBSOCKET_SERVER_STARTED, 0,
+            NULL, NULL, 0, user_param);
+
+        if (!bws_srv_start_service_threads(ctx)) {
+            /* connections of a thread that is not running would never be
+               serviced, so the server goes down */
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
+            ctx->stop_worker = true;
+            lws_cancel_service(ctx->wsctx);
+            pthread_mutex_unlock(ctx->mutex);
+        }
+    }
 
     while (1) {
         DEBUG_PRINTF(
             "bws_srv_worker() ctx %p proto %d blocked user_param %p\n", ctx,
             ctx->proto, ctx->user_param);
-        pthread_mutex_lock(ctx->mutex);
+        LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
+
+        if (ctx->stop_worker && (tsi != 0)) {
+            DEBUG_PRINTF(
+                "bws_srv_worker() ctx %p service thread %d stopped\n", ctx,
+                tsi);
+            pthread_mutex_unlock(ctx->mutex);
+            return NULL;
+        }
 
         if (ctx->stop_worker) {
             DEBUG_PRINTF(
@@ -620,10 +738,13 @@ static void *bws_srv_worker(void *arg)
                        protected by global websocket mutex.
             */
             pthread_mutex_unlock(ctx->mutex);
+            /* the other service threads leave libwebsockets first, so only
+               this thread is inside it when the context is destroyed */
+            bws_srv_join_service_threads(ctx);
             bsc_websocket_global_lock();
             lws_context_destroy(ctx->wsctx);
             bsc_websocket_global_unlock();
-            pthread_mutex_lock(ctx->mutex);
+            LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
             ctx->wsctx = NULL;
             DEBUG_PRINTF("bws_srv_worker() set wsctx %p\n", ctx->wsctx);
             ctx->stop_worker = false;
@@ -650,6 +771,11 @@ static void *bws_srv_worker(void *arg)
                 "socket %d(%p) state = %d\n",
                 ctx, ctx->user_param, ctx->proto, i, &ctx->conn[i],
                 ctx->conn[i].state);
+            if (ctx->conn[i].tsi != tsi) {
+                /* lws_callback_on_writable() must be called from the
+                   service thread which owns the connection */
+                continue;
+            }
             if (ctx->conn[i].state == BSC_WEBSOCKET_STATE_CONNECTED) {
                 if (ctx->conn[i].want_send_data) {
                     DEBUG_PRINTF(
@@ -674,9 +800,9 @@ static void *bws_srv_worker(void *arg)
 
         DEBUG_PRINTF(
             "bws_srv_worker() ctx %p user_param %p proto %d going to block on "
-            "lws_service() call\n",
+            "lws_service_tsi() call\n",
             ctx, ctx->user_param, ctx->proto);
-        lws_service(ctx->wsctx, 0);
+        lws_service_tsi(ctx->wsctx, 0, tsi);
     }
 
     return NULL;
@@ -701,6 +827,7 @@ BSC_WEBSOCKET_RET bws_srv_start(
     struct lws_context_creation_info info = { 0 };
     BSC_WEBSOCKET_CONTEXT *ctx;
     pthread_attr_t attr;
+    THREAD_SCHED sched;
     int r;
     struct lws_protocols protos[] = { { NULL, bws_srv_websocket_event, 0, 0, 0,
                                         NULL, 0 },
@@ -743,8 +870,9 @@ BSC_WEBSOCKET_RET bws_srv_start(
     }
 
     bsc_websocket_init_log();
+    bsc_websocket_tls_trust_set(ca_cert, ca_cert_size);
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
     info.port = port;
     info.iface = iface;
     info.protocols = protos;
@@ -761,6 +889,7 @@ BSC_WEBSOCKET_RET bws_srv_start(
     info.timeout_secs = timeout_s;
     info.connect_timeout_secs = timeout_s;
     info.user = ctx;
+    info.count_threads = BSC_WEBSOCKET_SERVER_THREADS_NUM;
 
     /* TRICKY: check comments related to lws_context_destroy() call */
 
@@ -768,7 +897,7 @@ BSC_WEBSOCKET_RET bws_srv_start(
     bsc_websocket_global_lock();
     ctx->wsctx = lws_create_context(&info);
     bsc_websocket_global_unlock();
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
 
     if (!ctx->wsctx) {
         pthread_mutex_unlock(ctx->mutex);
@@ -780,6 +909,15 @@ BSC_WEBSOCKET_RET bws_srv_start(
     ctx->dispatch_func = dispatch_func;
     ctx->user_param = dispatch_func_user_param;
     ctx->proto = proto;
+    /* libwebsockets limits the threads to its LWS_MAX_SMP */
+    ctx->threads_num = lws_get_count_threads(ctx->wsctx);
+    if (ctx->threads_num < 1) {
+        ctx->threads_num = 1;
+    } else if (ctx->threads_num > BSC_WEBSOCKET_SERVER_THREADS_NUM) {
+        ctx->threads_num = BSC_WEBSOCKET_SERVER_THREADS_NUM;
+    }
+    ctx->thread[0].ctx = ctx;
+    ctx->thread[0].tsi = 0;
     r = pthread_attr_init(&attr);
 
     if (!r) {
@@ -787,7 +925,10 @@ BSC_WEBSOCKET_RET bws_srv_start(
     }
 
     if (!r) {
-        r = pthread_create(&thread_id, &attr, &bws_srv_worker, ctx);
+        thread_sched_init(&sched, "BSC", 0);
+        r = thread_sched_create(
+            &thread_id, &attr, &sched, "BACnet/SC", &bws_srv_worker,
+            &ctx->thread[0]);
     }
 
     if (r) {
@@ -810,7 +951,7 @@ BSC_WEBSOCKET_RET bws_srv_start(
         bsc_websocket_global_lock();
         lws_context_destroy(ctx->wsctx);
         bsc_websocket_global_unlock();
-        pthread_mutex_lock(ctx->mutex);
+        LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
         ctx->wsctx = NULL;
         pthread_mutex_unlock(ctx->mutex);
         bws_free_server_ctx(ctx);
@@ -840,7 +981,7 @@ BSC_WEBSOCKET_RET bws_srv_stop(BSC_WEBSOCKET_SRV_HANDLE sh)
     }
 #endif
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
 
     if (ctx->stop_worker) {
         pthread_mutex_unlock(ctx->mutex);
@@ -870,7 +1011,7 @@ void bws_srv_disconnect(BSC_WEBSOCKET_SRV_HANDLE sh, BSC_WEBSOCKET_HANDLE h)
     }
 #endif
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
     if (h >= 0 && h < bws_srv_get_max_sockets(ctx->proto) &&
         !ctx->stop_worker) {
         if (ctx->conn[h].state == BSC_WEBSOCKET_STATE_CONNECTED) {
@@ -896,7 +1037,7 @@ void bws_srv_send(BSC_WEBSOCKET_SRV_HANDLE sh, BSC_WEBSOCKET_HANDLE h)
     }
 #endif
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
     if (ctx->conn[h].state == BSC_WEBSOCKET_STATE_CONNECTED) {
         /* tell worker to process send request */
         ctx->conn[h].want_send_data = true;
@@ -915,6 +1056,7 @@ BSC_WEBSOCKET_RET bws_srv_dispatch_send(
     int written;
     BSC_WEBSOCKET_RET ret;
     BSC_WEBSOCKET_CONTEXT *ctx = (BSC_WEBSOCKET_CONTEXT *)sh;
+    struct lws *ws;
 
     DEBUG_PRINTF(
         "bws_srv_dispatch_send() >>> ctx = %p h = %d payload %p "
@@ -939,7 +1081,7 @@ BSC_WEBSOCKET_RET bws_srv_dispatch_send(
         return BSC_WEBSOCKET_BAD_PARAM;
     }
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
 
     if (ctx->stop_worker) {
         pthread_mutex_unlock(ctx->mutex);
@@ -956,8 +1098,14 @@ BSC_WEBSOCKET_RET bws_srv_dispatch_send(
         return BSC_WEBSOCKET_INVALID_OPERATION;
     }
 
-    written =
-        lws_write(ctx->conn[h].ws, payload, payload_size, LWS_WRITE_BINARY);
+    /* The send is dispatched from LWS_CALLBACK_SERVER_WRITEABLE on the
+       service thread which owns the connection, so the wsi stays valid
+       without the server mutex, and writes to other connections are not
+       serialized behind this one. */
+    ws = ctx->conn[h].ws;
+    pthread_mutex_unlock(ctx->mutex);
+    written = lws_write(ws, payload, payload_size, LWS_WRITE_BINARY);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
 
     DEBUG_PRINTF("bws_srv_dispatch_send() %d bytes is sent\n", written);
 
@@ -995,7 +1143,7 @@ bool bws_srv_get_peer_ip_addr(
         return false;
     }
 
-    pthread_mutex_lock(ctx->mutex);
+    LOCKSTAT_MUTEX_LOCK(ctx->mutex, ctx->mutex_stats);
 
     if (ctx->conn[h].state != BSC_WEBSOCKET_STATE_IDLE &&
         ctx->conn[h].ws != NULL && !ctx->stop_worker) {
@@ -26,6 +26,8 @@ static BACNET_IP_ADDRESS BIP_Address;
 static BACNET_IP_ADDRESS BIP_Broadcast_Address;
 /* lwIP socket, of sorts */
 static struct udp_pcb *Server_upcb;
+/* contiguous copy of a received packet that is a chain of pbufs */
+static uint8_t BIP_Receive_Buffer[BIP_MPDU_MAX];
 /* track packets for diagnostics */
 struct bacnet_stats {
     uint32_t xmit; /* Transmitted packets. */
@@ -208,8 +210,15 @@ static int bip_encode_bip_address(
 /** Function to send a packet out the BACnet/IP socket (Annex J).
  * @ingroup DLBIP
  *
+ * With BACNET_LWIP_ZERO_COPY, the MPDU is referenced by a PBUF_REF
+ * rather than copied into a PBUF_POOL, and lwIP chains its UDP and IP
+ * headers in front of it.  The MPDU only has to stay valid until
+ * udp_sendto() returns: lwIP copies a PBUF_REF that it queues, such as
+ * for an ARP request, but the netif driver must not hold on to it.
+ *
  * @param dest [in] Destination address and port
- * @param mtu_len [in] PBUF packet
+ * @param mtu [in] the BVLC message
+ * @param mtu_len [in] number of bytes of the BVLC message
  * @return number of bytes sent, or 0 on failure.
  */
 int bip_send_mpdu(
@@ -221,12 +230,21 @@ int bip_send_mpdu(
     uint16_t port = 0;
     err_t status = ERR_OK;
 
+#if defined(BACNET_LWIP_ZERO_COPY)
+    pkt = pbuf_alloc(PBUF_TRANSPORT, mtu_len, PBUF_REF);
+    if (pkt == NULL) {
+        return 0;
+    }
+    pkt->payload = (void *)mtu;
+    bip_decode_bip_address(dest, &dst_ip, &port);
+#else
     pkt = pbuf_alloc(PBUF_TRANSPORT, mtu_len, PBUF_POOL);
     if (pkt == NULL) {
         return 0;
     }
     bip_decode_bip_address(dest, &dst_ip, &port);
     pbuf_take(pkt, mtu, mtu_len);
+#endif
     status = udp_sendto(Server_upcb, pkt, &dst_ip, port);
     if (status == ERR_OK) {
         BIP_STATS_INC(xmit);
@@ -257,6 +275,11 @@ int bip_send_pdu(
 }
 
 /** LwIP BACnet service callback
+ *
+ * The BVLC message is decoded in place from the payload of the packet.
+ * A packet that lwIP delivers as a chain of pbufs is first copied into
+ * a contiguous buffer, since the payload of its first pbuf is only part
+ * of the message.
  *
  * @param arg [in] optional argument from service
  * @param upcb [in] UDP control block
@@ -278,6 +301,16 @@ void bip_server_callback(
     uint8_t *npdu = (uint8_t *)pkt->payload;
     uint16_t npdu_len = pkt->tot_len;
 
+    if (pkt->len < pkt->tot_len) {
+        if ((pkt->tot_len > sizeof(BIP_Receive_Buffer)) ||
+            (pbuf_copy_partial(pkt, BIP_Receive_Buffer, pkt->tot_len, 0) !=
+             pkt->tot_len)) {
+            BIP_STATS_INC(drop);
+            pbuf_free(pkt);
+            return;
+        }
+        npdu = BIP_Receive_Buffer;
+    }
     bip_encode_bip_address(&saddr, addr, port);
     npdu_offset = bvlc_handler(&saddr, &src, npdu, npdu_len);
     if (npdu_offset > 0) {
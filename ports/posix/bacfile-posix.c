@@ -15,28 +15,196 @@
 #include "bacnet/bacdef.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/object/bacfile.h"
+#include "bacfile-posix.h"
 
 #ifndef FILE_RECORD_SIZE
 #define FILE_RECORD_SIZE MAX_OCTET_STRING_BYTES
 #endif
 
+/* number of files that are kept open between requests */
+#ifndef BACFILE_POSIX_OPEN_FILES
+#define BACFILE_POSIX_OPEN_FILES 4
+#endif
+
 /**
- * @brief Determines the file size for a given file
- * @param  pFile - file handle
- * @return  file size in bytes, or 0 if not found
+ * An open file, with the offsets of the records found in it so far.
+ * A record is a line, or FILE_RECORD_SIZE - 1 octets of a longer line.
+ */
+struct bacfile_posix_open_file {
+    char *pathname;
+    FILE *pFile;
+    bool writable;
+    unsigned long last_used;
+    /* offset of the end of each complete record */
+    long *record_end;
+    size_t record_count;
+    size_t record_size;
+    /* true when the records have been indexed up to the end of file */
+    bool record_eof;
+};
+static struct bacfile_posix_open_file Open_File[BACFILE_POSIX_OPEN_FILES];
+static unsigned long Open_File_Uses;
+
+/**
+ * @brief Close an open file and forget its records
+ * @param file - the open file
+ */
+static void bacfile_posix_open_file_close(struct bacfile_posix_open_file *file)
+{
+    if (file->pFile) {
+        fclose(file->pFile);
+    }
+    free(file->pathname);
+    free(file->record_end);
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * @brief Find an open file, or open it and keep it open.  The least
+ *  recently used file is closed when all the slots are in use.
+ * @param pathname - name of the file
+ * @param truncate - true to open the file as a clean slate
+ * @param create - true to create the file if it does not exist
+ * @return the open file, or NULL if it can not be opened
+ */
+static struct bacfile_posix_open_file *
+bacfile_posix_open(const char *pathname, bool truncate, bool create)
+{
+    struct bacfile_posix_open_file *file = NULL;
+    struct bacfile_posix_open_file *lru = &Open_File[0];
+    FILE *pFile = NULL;
+    bool writable = true;
+    unsigned i;
+
+    for (i = 0; i < BACFILE_POSIX_OPEN_FILES; i++) {
+        if (Open_File[i].pFile &&
+            (strcmp(Open_File[i].pathname, pathname) == 0)) {
+            file = &Open_File[i];
+            break;
+        }
+        if (!Open_File[i].pFile) {
+            lru = &Open_File[i];
+            lru->last_used = 0;
+        } else if (lru->pFile && (Open_File[i].last_used < lru->last_used)) {
+            lru = &Open_File[i];
+        }
+    }
+    if (file && truncate) {
+        bacfile_posix_open_file_close(file);
+        lru = file;
+        file = NULL;
+    }
+    if (!file) {
+        if (truncate) {
+            pFile = fopen(pathname, "wb+");
+        } else {
+            pFile = fopen(pathname, "rb+");
+            if (!pFile) {
+                pFile = fopen(pathname, "rb");
+                writable = false;
+            }
+            if (!pFile && create) {
+                pFile = fopen(pathname, "wb+");
+                writable = true;
+            }
+        }
+        if (!pFile) {
+            return NULL;
+        }
+        bacfile_posix_open_file_close(lru);
+        lru->pathname = malloc(strlen(pathname) + 1);
+        if (!lru->pathname) {
+            fclose(pFile);
+            return NULL;
+        }
+        strcpy(lru->pathname, pathname);
+        lru->pFile = pFile;
+        lru->writable = writable;
+        file = lru;
+    }
+    file->last_used = ++Open_File_Uses;
+
+    return file;
+}
+
+/**
+ * @brief Forget the records which end after a position that was written
+ * @param file - the open file
+ * @param position - offset of the first octet written
+ */
+static void bacfile_posix_record_invalidate(
+    struct bacfile_posix_open_file *file, long position)
+{
+    while ((file->record_count > 0) &&
+           (file->record_end[file->record_count - 1] > position)) {
+        file->record_count--;
+    }
+    file->record_eof = false;
+}
+
+/**
+ * @brief Index the records of a file up to a record
+ * @param file - the open file
+ * @param records - the number of complete records wanted
+ * @param buffer - buffer for a record, of FILE_RECORD_SIZE octets
+ * @return true if the file has that many complete records
+ */
+static bool bacfile_posix_record_index(
+    struct bacfile_posix_open_file *file, size_t records, char *buffer)
+{
+    long position = 0;
+    long *record_end = NULL;
+    size_t size = 0;
+
+    if (file->record_count >= records) {
+        return true;
+    }
+    if (file->record_eof) {
+        return false;
+    }
+    if (file->record_count > 0) {
+        position = file->record_end[file->record_count - 1];
+    }
+    if (fseek(file->pFile, position, SEEK_SET) != 0) {
+        return false;
+    }
+    while (file->record_count < records) {
+        if ((fgets(buffer, FILE_RECORD_SIZE, file->pFile) == NULL) ||
+            feof(file->pFile)) {
+            file->record_eof = true;
+            return false;
+        }
+        if (file->record_count >= file->record_size) {
+            size = file->record_size ? file->record_size * 2 : 64;
+            record_end = realloc(file->record_end, size * sizeof(long));
+            if (!record_end) {
+                return false;
+            }
+            file->record_end = record_end;
+            file->record_size = size;
+        }
+        file->record_end[file->record_count] = ftell(file->pFile);
+        file->record_count++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the files kept open between requests.  Call it before
+ *  a file is changed by other means than the File object.
+ * @param pathname - name of the file to close, or NULL for all of them
  */
-static long fsize(FILE *pFile)
+void bacfile_posix_close(const char *pathname)
 {
-    long size = 0;
-    long origin = 0;
-
-    if (pFile) {
-        origin = ftell(pFile);
-        fseek(pFile, 0L, SEEK_END);
-        size = ftell(pFile);
-        fseek(pFile, origin, SEEK_SET);
+    unsigned i;
+
+    for (i = 0; i < BACFILE_POSIX_OPEN_FILES; i++) {
+        if (Open_File[i].pFile &&
+            (!pathname || (strcmp(Open_File[i].pathname, pathname) == 0))) {
+            bacfile_posix_open_file_close(&Open_File[i]);
+        }
     }
-    return (size);
 }
 
 /**
@@ -46,18 +214,19 @@ static long fsize(FILE *pFile)
  */
 size_t bacfile_posix_file_size(const char *pathname)
 {
-    FILE *pFile = NULL;
+    struct bacfile_posix_open_file *file = NULL;
     long file_position = 0;
     size_t file_size = 0;
 
     if (pathname) {
-        pFile = fopen(pathname, "rb");
-        if (pFile) {
-            file_position = fsize(pFile);
+        file = bacfile_posix_open(pathname, false, false);
+        if (file) {
+            if (fseek(file->pFile, 0L, SEEK_END) == 0) {
+                file_position = ftell(file->pFile);
+            }
             if (file_position >= 0) {
                 file_size = (size_t)file_position;
             }
-            fclose(pFile);
         } else {
             debug_printf_stderr("Failed to open %s for reading!\n", pathname);
         }
@@ -97,15 +266,15 @@ size_t bacfile_posix_read_stream_data(
     uint8_t *fileData,
     size_t fileDataLen)
 {
-    FILE *pFile = NULL;
+    struct bacfile_posix_open_file *file = NULL;
     size_t len = 0;
 
     if (pathname) {
-        pFile = fopen(pathname, "rb");
-        if (pFile) {
-            (void)fseek(pFile, fileStartPosition, SEEK_SET);
-            len = fread(fileData, 1, fileDataLen, pFile);
-            fclose(pFile);
+        file = bacfile_posix_open(pathname, false, false);
+        if (file) {
+            if (fseek(file->pFile, fileStartPosition, SEEK_SET) == 0) {
+                len = fread(fileData, 1, fileDataLen, file->pFile);
+            }
         } else {
             debug_printf_stderr("Failed to open %s for reading!\n", pathname);
         }
@@ -129,27 +298,33 @@ size_t bacfile_posix_write_stream_data(
     size_t fileDataLen)
 {
     size_t bytes_written = 0;
-    FILE *pFile = NULL;
+    struct bacfile_posix_open_file *file = NULL;
+    int result = -1;
 
     if (pathname) {
         if (fileStartPosition == 0) {
             /* open the file as a clean slate when starting at 0 */
-            pFile = fopen(pathname, "wb");
+            file = bacfile_posix_open(pathname, true, true);
         } else if (fileStartPosition == -1) {
             /* If 'File Start Position' parameter has the special
                value -1, then the write operation shall be treated
                as an append to the current end of file. */
-            pFile = fopen(pathname, "ab+");
+            file = bacfile_posix_open(pathname, false, true);
         } else {
             /* open for update */
-            pFile = fopen(pathname, "rb+");
+            file = bacfile_posix_open(pathname, false, false);
         }
-        if (pFile) {
-            if (fileStartPosition != -1) {
-                (void)fseek(pFile, fileStartPosition, SEEK_SET);
+        if (file && file->writable) {
+            if (fileStartPosition == -1) {
+                result = fseek(file->pFile, 0L, SEEK_END);
+            } else {
+                result = fseek(file->pFile, fileStartPosition, SEEK_SET);
             }
-            bytes_written = fwrite(fileData, fileDataLen, 1, pFile);
-            fclose(pFile);
+        }
+        if (result == 0) {
+            bacfile_posix_record_invalidate(file, ftell(file->pFile));
+            bytes_written = fwrite(fileData, 1, fileDataLen, file->pFile);
+            fflush(file->pFile);
         } else {
             debug_printf_stderr("Failed to open %s for writing!\n", pathname);
         }
@@ -175,42 +350,48 @@ bool bacfile_posix_write_record_data(
     size_t fileDataLen)
 {
     bool status = false;
-    FILE *pFile = NULL;
-    uint32_t i = 0;
+    struct bacfile_posix_open_file *file = NULL;
     char dummy_data[FILE_RECORD_SIZE];
-    const char *pData = NULL;
     size_t fileSeekRecord = 0;
+    int result = -1;
 
     if (pathname) {
         if (fileStartRecord == 0) {
             /* open the file as a clean slate when starting at 0 */
-            pFile = fopen(pathname, "wb");
-            fileSeekRecord = fileIndexRecord;
+            file = bacfile_posix_open(pathname, true, true);
         } else if (fileStartRecord == -1) {
             /* If 'File Start Record' parameter has the special
                value -1, then the write operation shall be treated
                as an append to the current end of file. */
-            pFile = fopen(pathname, "ab+");
-            fileSeekRecord = fileIndexRecord;
+            file = bacfile_posix_open(pathname, false, true);
         } else {
             /* open for update */
-            pFile = fopen(pathname, "rb+");
+            file = bacfile_posix_open(pathname, false, false);
             fileSeekRecord = fileStartRecord + fileIndexRecord;
         }
-        if (pFile) {
-            if ((fileStartRecord != -1) && (fileSeekRecord > 0)) {
+        if (file && file->writable) {
+            if ((fileSeekRecord > 0) &&
+                bacfile_posix_record_index(
+                    file, fileSeekRecord, &dummy_data[0])) {
                 /* seek to the start record */
-                for (i = 0; i < fileSeekRecord; i++) {
-                    pData = fgets(&dummy_data[0], sizeof(dummy_data), pFile);
-                    if ((pData == NULL) || feof(pFile)) {
-                        break;
-                    }
-                }
+                result = fseek(
+                    file->pFile, file->record_end[fileSeekRecord - 1],
+                    SEEK_SET);
+            } else if (fileSeekRecord > 0) {
+                /* fewer records: write at the end of the file */
+                result = fseek(file->pFile, 0L, SEEK_END);
+            } else if (fileStartRecord == -1) {
+                result = fseek(file->pFile, 0L, SEEK_END);
+            } else {
+                result = fseek(file->pFile, 0L, SEEK_SET);
             }
-            if (fwrite(fileData, fileDataLen, 1, pFile) == 1) {
+        }
+        if (result == 0) {
+            bacfile_posix_record_invalidate(file, ftell(file->pFile));
+            if (fwrite(fileData, fileDataLen, 1, file->pFile) == 1) {
                 status = true;
             }
-            fclose(pFile);
+            fflush(file->pFile);
         } else {
             debug_printf_stderr("Failed to open %s for writing!\n", pathname);
         }
@@ -236,29 +417,34 @@ bool bacfile_posix_read_record_data(
     size_t fileDataLen)
 {
     bool status = false;
-    FILE *pFile = NULL;
-    uint32_t i = 0;
+    struct bacfile_posix_open_file *file = NULL;
     char dummy_data[FILE_RECORD_SIZE] = { 0 };
-    const char *pData = NULL;
     size_t fileSeekRecord = 0;
+    long position = 0;
 
     if (pathname) {
-        pFile = fopen(pathname, "rb");
-        if (pFile) {
+        file = bacfile_posix_open(pathname, false, false);
+        if (file) {
             fileSeekRecord = fileStartRecord + fileIndexRecord;
-            /* seek to the start record */
-            for (i = 0; i < fileSeekRecord; i++) {
-                pData = fgets(&dummy_data[0], sizeof(dummy_data), pFile);
-                if ((pData == NULL) || feof(pFile)) {
-                    break;
+            if ((fileSeekRecord == 0) ||
+                bacfile_posix_record_index(
+                    file, fileSeekRecord, &dummy_data[0])) {
+                if (fileSeekRecord > 1) {
+                    position = file->record_end[fileSeekRecord - 2];
+                }
+                /* the last record of the seek */
+                if ((fileSeekRecord > 0) &&
+                    ((fseek(file->pFile, position, SEEK_SET) != 0) ||
+                     (fgets(&dummy_data[0], sizeof(dummy_data),
+                            file->pFile) == NULL))) {
+                    return false;
+                }
+                if (fileDataLen <= sizeof(dummy_data)) {
+                    /* copy the record data */
+                    memmove(fileData, &dummy_data[0], fileDataLen);
+                    status = true;
                 }
             }
-            if ((i == fileSeekRecord) && (fileDataLen <= sizeof(dummy_data))) {
-                /* copy the record data */
-                memmove(fileData, &dummy_data[0], fileDataLen);
-                status = true;
-            }
-            fclose(pFile);
         } else {
             debug_printf_stderr("Failed to open %s for reading!\n", pathname);
         }
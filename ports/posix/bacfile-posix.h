@@ -45,6 +45,8 @@ bool bacfile_posix_read_record_data(
     uint8_t *fileData,
     size_t fileDataLen);
 BACNET_STACK_EXPORT
+void bacfile_posix_close(const char *pathname);
+BACNET_STACK_EXPORT
 void bacfile_posix_init(void);
 
 #ifdef __cplusplus
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -21,11 +22,27 @@
 #include "led.h"
 #include "rs485.h"
 
+#if defined(RS485_DMA_ENABLED)
+/* USART2 requests - RX=DMA1 Channel6, TX=DMA1 Channel7 */
+#define RS485_DMA_RX_CHANNEL DMA1_Channel6
+#define RS485_DMA_TX_CHANNEL DMA1_Channel7
+/* circular DMA buffer of received bytes - size must be power of two */
+static uint8_t Receive_DMA_Data[NEXT_POWER_OF_2(DLMSTP_MPDU_MAX)];
+/* index of the next received byte to read */
+static volatile uint16_t Receive_DMA_Tail;
+/* index of the DMA at the last idle line */
+static volatile uint16_t Receive_Idle_Head;
+/* time when the line last went idle, after a received or sent frame */
+static volatile uint32_t Line_Idle_Timestamp;
+/* buffer of the frame that the DMA is transmitting */
+static uint8_t Transmit_DMA_Data[DLMSTP_MPDU_MAX];
+#else
 /* buffer for storing received bytes - size must be power of two */
 static uint8_t Receive_Buffer_Data[NEXT_POWER_OF_2(DLMSTP_MPDU_MAX)];
 static FIFO_BUFFER Receive_Buffer;
 /* amount of silence on the wire */
 static struct mstimer Silence_Timer;
+#endif
 /* baud rate */
 static uint32_t Baud_Rate = 38400;
 /* flag to track RTS status */
@@ -35,7 +52,43 @@ static volatile bool Transmitting;
 static volatile uint32_t RS485_Transmit_Bytes;
 static volatile uint32_t RS485_Receive_Bytes;
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief Get the index in the receive buffer where the DMA writes next
+ * @return index of the next byte to be received
+ */
+static uint16_t rs485_dma_head(void)
+{
+    uint16_t count = DMA_GetCurrDataCounter(RS485_DMA_RX_CHANNEL);
+
+    return (uint16_t)(sizeof(Receive_DMA_Data) - count) &
+        (sizeof(Receive_DMA_Data) - 1);
+}
+
+/**
+ * @brief Reset the silence on the wire timer.
+ * @note The silence is measured from the idle line and transmit complete
+ *  interrupts, so the receive state machine reading the bytes later than
+ *  they arrived does not restart it.
+ */
+void rs485_silence_reset(void)
+{
+}
+
+/**
+ * @brief Return the RS-485 silence time in milliseconds, since the line
+ *  went idle, which is detected within one character time
+ * @return silence time in milliseconds, or 0 while a frame is on the line
+ */
+uint32_t rs485_silence_milliseconds(void)
+{
+    if (Transmitting || (rs485_dma_head() != Receive_Idle_Head)) {
+        return 0;
+    }
 
+    return mstimer_now() - Line_Idle_Timestamp;
+}
+#else
 /**
  * @brief Reset the silence on the wire timer.
  */
@@ -52,6 +105,7 @@ uint32_t rs485_silence_milliseconds(void)
 {
     return mstimer_elapsed(&Silence_Timer);
 }
+#endif
 
 /**
  * @brief Determines if an error occured while receiving
@@ -62,6 +116,42 @@ bool rs485_receive_error(void)
     return false;
 }
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief USARTx interrupt handler sub-routine for the idle line that ends
+ *  a received frame, and the transmit complete that ends a sent frame
+ */
+void USART2_IRQHandler(void)
+{
+    if (USART_GetITStatus(USART2, USART_IT_IDLE) != RESET) {
+        /* reading SR then DR clears the idle line flag */
+        (void)USART_ReceiveData(USART2);
+        Receive_Idle_Head = rs485_dma_head();
+        Line_Idle_Timestamp = mstimer_now();
+    }
+    if (USART_GetITStatus(USART2, USART_IT_TC) != RESET) {
+        USART_ITConfig(USART2, USART_IT_TC, DISABLE);
+        USART_ClearITPendingBit(USART2, USART_IT_TC);
+        /* skip any echo of the sent frame */
+        Receive_Idle_Head = rs485_dma_head();
+        Receive_DMA_Tail = Receive_Idle_Head;
+        Line_Idle_Timestamp = mstimer_now();
+        rs485_rts_enable(false);
+    }
+}
+
+/**
+ * @brief Transmit DMA interrupt handler sub-routine
+ */
+void DMA1_Channel7_IRQHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_IT_TC7) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_GL7);
+        /* the last byte is still shifting out */
+        USART_ITConfig(USART2, USART_IT_TC, ENABLE);
+    }
+}
+#else
 /**
  * @brief USARTx interrupt handler sub-routine
  */
@@ -82,6 +172,7 @@ void USART2_IRQHandler(void)
         USART_ClearFlag(USART2, USART_FLAG_ORE);
     }
 }
+#endif
 
 /**
  * @brief Control the DE and /RE pins on the RS-485 transceiver
@@ -89,6 +180,7 @@ void USART2_IRQHandler(void)
  */
 void rs485_rts_enable(bool enable)
 {
+    Transmitting = enable;
     if (enable) {
         led_tx_on_interval(10);
         GPIO_WriteBit(GPIOA, GPIO_Pin_1, Bit_SET);
@@ -116,6 +208,18 @@ bool rs485_byte_available(uint8_t *data_register)
 {
     bool data_available = false; /* return value */
 
+#if defined(RS485_DMA_ENABLED)
+    if (Receive_DMA_Tail != rs485_dma_head()) {
+        if (data_register) {
+            *data_register = Receive_DMA_Data[Receive_DMA_Tail];
+            Receive_DMA_Tail =
+                (Receive_DMA_Tail + 1) & (sizeof(Receive_DMA_Data) - 1);
+            RS485_Receive_Bytes++;
+        }
+        data_available = true;
+        led_rx_on_interval(10);
+    }
+#else
     if (!FIFO_Empty(&Receive_Buffer)) {
         if (data_register) {
             *data_register = FIFO_Get(&Receive_Buffer);
@@ -124,6 +228,7 @@ bool rs485_byte_available(uint8_t *data_register)
         data_available = true;
         led_rx_on_interval(10);
     }
+#endif
 
     return data_available;
 }
@@ -155,6 +260,20 @@ bool rs485_frame_sent(void)
 void rs485_bytes_send(const uint8_t *buffer, /* data to send */
     uint16_t nbytes)
 { /* number of bytes of data */
+#if defined(RS485_DMA_ENABLED)
+    if (buffer && (nbytes > 0) && (nbytes <= sizeof(Transmit_DMA_Data))) {
+        while (Transmitting) {
+            /* wait for the previous frame to leave the shift register */
+        }
+        memcpy(Transmit_DMA_Data, buffer, nbytes);
+        rs485_rts_enable(true);
+        DMA_Cmd(RS485_DMA_TX_CHANNEL, DISABLE);
+        DMA_SetCurrDataCounter(RS485_DMA_TX_CHANNEL, nbytes);
+        USART_ClearFlag(USART2, USART_FLAG_TC);
+        DMA_Cmd(RS485_DMA_TX_CHANNEL, ENABLE);
+        RS485_Transmit_Bytes += nbytes;
+    }
+#else
     uint8_t tx_byte;
 
     while (nbytes) {
@@ -177,6 +296,7 @@ void rs485_bytes_send(const uint8_t *buffer, /* data to send */
     }
     rs485_rts_enable(false);
     rs485_silence_reset();
+#endif
 
     return;
 }
@@ -253,6 +373,49 @@ uint32_t rs485_bytes_received(void)
     return RS485_Receive_Bytes;
 }
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief Initialize the DMA channels of the USART: a circular receive
+ *  that never stops, and a transmit of one frame at a time
+ */
+static void rs485_dma_init(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    DMA_DeInit(RS485_DMA_RX_CHANNEL);
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)Receive_DMA_Data;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = sizeof(Receive_DMA_Data);
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_Init(RS485_DMA_RX_CHANNEL, &DMA_InitStructure);
+    DMA_Cmd(RS485_DMA_RX_CHANNEL, ENABLE);
+    Receive_DMA_Tail = 0;
+    Receive_Idle_Head = 0;
+
+    DMA_DeInit(RS485_DMA_TX_CHANNEL);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)Transmit_DMA_Data;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = sizeof(Transmit_DMA_Data);
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_Init(RS485_DMA_TX_CHANNEL, &DMA_InitStructure);
+    DMA_ITConfig(RS485_DMA_TX_CHANNEL, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel7_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    USART_DMACmd(USART2, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+}
+#endif
+
 /**
  * @brief Initialize the room network USART
  */
@@ -293,14 +456,23 @@ void rs485_init(void)
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
+#if defined(RS485_DMA_ENABLED)
+    rs485_dma_init();
+    /* enable the USART to generate interrupts on an idle line */
+    USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
+    Line_Idle_Timestamp = mstimer_now();
+#else
     /* enable the USART to generate interrupts */
     USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+#endif
 
     rs485_baud_rate_set(Baud_Rate);
 
     USART_Cmd(USART2, ENABLE);
 
+#if !defined(RS485_DMA_ENABLED)
     FIFO_Init(&Receive_Buffer, &Receive_Buffer_Data[0],
         (unsigned)sizeof(Receive_Buffer_Data));
+#endif
     rs485_silence_reset();
 }
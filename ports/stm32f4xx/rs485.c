@@ -42,6 +42,19 @@
 #define RS485_AF_PINSOURCE_RX GPIO_PinSource9
 #define RS485_AF_PINSOURCE_TX GPIO_PinSource14
 #define RS485_AF_FUNCTION GPIO_AF_USART6
+#if defined(RS485_DMA_ENABLED)
+/* USART6 requests - RX=DMA2 Stream1, TX=DMA2 Stream6, both on Channel5 */
+#define RS485_DMA_RCC RCC_AHB1Periph_DMA2
+#define RS485_DMA_CHANNEL DMA_Channel_5
+#define RS485_DMA_RX_STREAM DMA2_Stream1
+#define RS485_DMA_TX_STREAM DMA2_Stream6
+#define RS485_DMA_TX_NVIC_IRQ DMA2_Stream6_IRQn
+#define RS485_DMA_TX_ISR DMA2_Stream6_IRQHandler
+#define RS485_DMA_TX_IT_TC DMA_IT_TCIF6
+#define RS485_DMA_TX_FLAGS                                     \
+    (DMA_FLAG_FEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_TEIF6 |       \
+     DMA_FLAG_HTIF6 | DMA_FLAG_TCIF6)
+#endif
 #endif
 #if defined(RS485_DFR0259_ENABLED)
 /* DFR0259 RS485 Shield - CE=PF15 */
@@ -56,6 +69,20 @@
 #define RS485_RTS_GPIO GPIOD
 #endif
 
+#if defined(RS485_DMA_ENABLED)
+/* circular DMA buffer of received bytes - size must be power of two */
+/* BACnet DLMSTP_MPDU_MAX for MS/TP is 1501 bytes */
+static uint8_t Receive_DMA_Data[NEXT_POWER_OF_2(DLMSTP_MPDU_MAX)];
+/* index of the next received byte to read */
+static volatile uint16_t Receive_DMA_Tail;
+/* index of the DMA at the last idle line */
+static volatile uint16_t Receive_Idle_Head;
+/* time when the line last went idle, after a received or sent frame */
+static volatile uint32_t Line_Idle_Timestamp;
+
+/* buffer of the frame that the DMA is transmitting */
+static uint8_t Transmit_DMA_Data[DLMSTP_MPDU_MAX];
+#else
 /* buffer for storing received bytes - size must be power of two */
 /* BACnet DLMSTP_MPDU_MAX for MS/TP is 1501 bytes */
 static uint8_t Receive_Queue_Data[NEXT_POWER_OF_2(DLMSTP_MPDU_MAX)];
@@ -65,6 +92,7 @@ static FIFO_BUFFER Receive_Queue;
 /* BACnet DLMSTP_MPDU_MAX for MS/TP is 1501 bytes */
 static uint8_t Transmit_Queue_Data[NEXT_POWER_OF_2(DLMSTP_MPDU_MAX)];
 static FIFO_BUFFER Transmit_Queue;
+#endif
 
 /* baud rate of the UART interface */
 static uint32_t Baud_Rate = 38400;
@@ -75,6 +103,43 @@ static volatile bool Transmitting;
 static volatile uint32_t RS485_Transmit_Bytes;
 static volatile uint32_t RS485_Receive_Bytes;
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief Get the index in the receive buffer where the DMA writes next
+ * @return index of the next byte to be received
+ */
+static uint16_t rs485_dma_head(void)
+{
+    uint16_t count = DMA_GetCurrDataCounter(RS485_DMA_RX_STREAM);
+
+    return (uint16_t)(sizeof(Receive_DMA_Data) - count) &
+        (sizeof(Receive_DMA_Data) - 1);
+}
+
+/**
+ * @brief Reset the silence on the wire timer.
+ * @note The silence is measured from the idle line and transmit complete
+ *  interrupts, so the receive state machine reading the bytes later than
+ *  they arrived does not restart it.
+ */
+void rs485_silence_reset(void)
+{
+}
+
+/**
+ * @brief Return the RS-485 silence time in milliseconds, since the line
+ *  went idle, which is detected within one character time
+ * @return silence time in milliseconds, or 0 while a frame is on the line
+ */
+uint32_t rs485_silence_milliseconds(void)
+{
+    if (Transmitting || (rs485_dma_head() != Receive_Idle_Head)) {
+        return 0;
+    }
+
+    return mstimer_now() - Line_Idle_Timestamp;
+}
+#else
 /* amount of silence on the wire */
 static struct mstimer Silence_Timer;
 
@@ -94,6 +159,7 @@ uint32_t rs485_silence_milliseconds(void)
 {
     return mstimer_elapsed(&Silence_Timer);
 }
+#endif
 
 /**
  * @brief Determines if an error occured while receiving
@@ -104,6 +170,52 @@ bool rs485_receive_error(void)
     return false;
 }
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief USARTx interrupt handler sub-routine for the idle line that ends
+ *  a received frame, and the transmit complete that ends a sent frame
+ */
+void RS485_USARTx_ISR(void)
+{
+    if (USART_GetITStatus(RS485_USARTx, USART_IT_IDLE) != RESET) {
+        /* reading SR then DR clears the idle line flag */
+        (void)USART_ReceiveData(RS485_USARTx);
+        Receive_Idle_Head = rs485_dma_head();
+        Line_Idle_Timestamp = mstimer_now();
+    }
+    if (USART_GetITStatus(RS485_USARTx, USART_IT_TC) != RESET) {
+        USART_ITConfig(RS485_USARTx, USART_IT_TC, DISABLE);
+        USART_ClearITPendingBit(RS485_USARTx, USART_IT_TC);
+        /* skip any echo of the sent frame */
+        Receive_Idle_Head = rs485_dma_head();
+        Receive_DMA_Tail = Receive_Idle_Head;
+        Line_Idle_Timestamp = mstimer_now();
+        rs485_rts_enable(false);
+    }
+    /* errors are detected by the CRC of the frame, so just clear them */
+    if (USART_GetFlagStatus(RS485_USARTx, USART_FLAG_NE) == SET) {
+        USART_ClearFlag(RS485_USARTx, USART_FLAG_NE);
+    }
+    if (USART_GetFlagStatus(RS485_USARTx, USART_FLAG_FE) == SET) {
+        USART_ClearFlag(RS485_USARTx, USART_FLAG_FE);
+    }
+    if (USART_GetFlagStatus(RS485_USARTx, USART_FLAG_PE) == SET) {
+        USART_ClearFlag(RS485_USARTx, USART_FLAG_PE);
+    }
+}
+
+/**
+ * @brief Transmit DMA interrupt handler sub-routine
+ */
+void RS485_DMA_TX_ISR(void)
+{
+    if (DMA_GetITStatus(RS485_DMA_TX_STREAM, RS485_DMA_TX_IT_TC) != RESET) {
+        DMA_ClearITPendingBit(RS485_DMA_TX_STREAM, RS485_DMA_TX_IT_TC);
+        /* the last byte is still shifting out */
+        USART_ITConfig(RS485_USARTx, USART_IT_TC, ENABLE);
+    }
+}
+#else
 /**
  * @brief USARTx interrupt handler sub-routine
  */
@@ -158,6 +270,7 @@ void RS485_USARTx_ISR(void)
         USART_ClearFlag(RS485_USARTx, USART_FLAG_PE);
     }
 }
+#endif
 
 /**
  * @brief Control the DE and /RE pins on the RS-485 transceiver
@@ -192,6 +305,17 @@ bool rs485_byte_available(uint8_t *data_register)
 {
     bool data_available = false; /* return value */
 
+#if defined(RS485_DMA_ENABLED)
+    if (Receive_DMA_Tail != rs485_dma_head()) {
+        if (data_register) {
+            *data_register = Receive_DMA_Data[Receive_DMA_Tail];
+            Receive_DMA_Tail =
+                (Receive_DMA_Tail + 1) & (sizeof(Receive_DMA_Data) - 1);
+            RS485_Receive_Bytes++;
+        }
+        data_available = true;
+    }
+#else
     if (!FIFO_Empty(&Receive_Queue)) {
         if (data_register) {
             *data_register = FIFO_Get(&Receive_Queue);
@@ -199,6 +323,7 @@ bool rs485_byte_available(uint8_t *data_register)
         rs485_silence_reset();
         data_available = true;
     }
+#endif
 
     return data_available;
 }
@@ -211,6 +336,24 @@ bool rs485_byte_available(uint8_t *data_register)
  */
 void rs485_bytes_send(const uint8_t *buffer, uint16_t nbytes)
 {
+#if defined(RS485_DMA_ENABLED)
+    if (buffer && (nbytes > 0) && (nbytes <= sizeof(Transmit_DMA_Data))) {
+        while (Transmitting) {
+            /* wait for the previous frame to leave the shift register */
+        }
+        memcpy(Transmit_DMA_Data, buffer, nbytes);
+        rs485_rts_enable(true);
+        DMA_Cmd(RS485_DMA_TX_STREAM, DISABLE);
+        while (DMA_GetCmdStatus(RS485_DMA_TX_STREAM) != DISABLE) {
+            /* the stream finishes its current transfer */
+        }
+        DMA_ClearFlag(RS485_DMA_TX_STREAM, RS485_DMA_TX_FLAGS);
+        DMA_SetCurrDataCounter(RS485_DMA_TX_STREAM, nbytes);
+        USART_ClearFlag(RS485_USARTx, USART_FLAG_TC);
+        DMA_Cmd(RS485_DMA_TX_STREAM, ENABLE);
+        RS485_Transmit_Bytes += nbytes;
+    }
+#else
     if (buffer && (nbytes > 0)) {
         if (FIFO_Add(&Transmit_Queue, buffer, nbytes)) {
             rs485_silence_reset();
@@ -222,6 +365,7 @@ void rs485_bytes_send(const uint8_t *buffer, uint16_t nbytes)
             /* TXE interrupt will load the first byte */
         }
     }
+#endif
 }
 
 /**
@@ -296,6 +440,50 @@ uint32_t rs485_bytes_received(void)
     return RS485_Receive_Bytes;
 }
 
+#if defined(RS485_DMA_ENABLED)
+/**
+ * @brief Initialize the DMA streams of the USART: a circular receive
+ *  that never stops, and a transmit of one frame at a time
+ */
+static void rs485_dma_init(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHB1PeriphClockCmd(RS485_DMA_RCC, ENABLE);
+    DMA_DeInit(RS485_DMA_RX_STREAM);
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_Channel = RS485_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&RS485_USARTx->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)Receive_DMA_Data;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = sizeof(Receive_DMA_Data);
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_Init(RS485_DMA_RX_STREAM, &DMA_InitStructure);
+    DMA_Cmd(RS485_DMA_RX_STREAM, ENABLE);
+    Receive_DMA_Tail = 0;
+    Receive_Idle_Head = 0;
+
+    DMA_DeInit(RS485_DMA_TX_STREAM);
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)Transmit_DMA_Data;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = sizeof(Transmit_DMA_Data);
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_Init(RS485_DMA_TX_STREAM, &DMA_InitStructure);
+    DMA_ITConfig(RS485_DMA_TX_STREAM, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = RS485_DMA_TX_NVIC_IRQ;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    USART_DMACmd(RS485_USARTx, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+}
+#endif
+
 /**
  * @brief Initialize the USART for RS485
  */
@@ -304,6 +492,7 @@ void rs485_init(void)
     GPIO_InitTypeDef GPIO_InitStructure;
     NVIC_InitTypeDef NVIC_InitStructure;
 
+#if !defined(RS485_DMA_ENABLED)
     /* initialize the Rx and Tx byte queues */
     FIFO_Init(
         &Receive_Queue, &Receive_Queue_Data[0],
@@ -311,6 +500,7 @@ void rs485_init(void)
     FIFO_Init(
         &Transmit_Queue, &Transmit_Queue_Data[0],
         (unsigned)sizeof(Transmit_Queue_Data));
+#endif
 
     /* Enable GPIOx clock */
     RCC_AHB1PeriphClockCmd(RS485_GPIO_RCC, ENABLE);
@@ -352,8 +542,15 @@ void rs485_init(void)
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
+#if defined(RS485_DMA_ENABLED)
+    rs485_dma_init();
+    /* enable the USART to generate interrupts on an idle line */
+    USART_ITConfig(RS485_USARTx, USART_IT_IDLE, ENABLE);
+    Line_Idle_Timestamp = mstimer_now();
+#else
     /* enable the USART to generate interrupts on RX */
     USART_ITConfig(RS485_USARTx, USART_IT_RXNE, ENABLE);
+#endif
 
     rs485_baud_rate_set(Baud_Rate);
 
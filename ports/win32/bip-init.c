@@ -39,6 +39,35 @@ static struct in_addr BIP_Broadcast_Binding_Address;
 /* enable debugging */
 static bool BIP_Debug;
 
+#if defined(BACNET_BIP_IOCP)
+/* number of overlapped receives posted on each socket */
+#ifndef BIP_IOCP_RECEIVES
+#define BIP_IOCP_RECEIVES 16
+#endif
+/* size of the receive buffer of each socket, in bytes */
+#ifndef BIP_IOCP_RCVBUF
+#define BIP_IOCP_RCVBUF (1024L * 1024L)
+#endif
+/* ignore the ICMP port unreachable reports of earlier sends */
+#ifndef SIO_UDP_CONNRESET
+#define SIO_UDP_CONNRESET _WSAIOW(IOC_VENDOR, 12)
+#endif
+/* an overlapped receive - the OVERLAPPED is first, so that a completion
+   leads back to its receive */
+struct bip_iocp_receive {
+    OVERLAPPED overlapped;
+    SOCKET socket;
+    WSABUF wsabuf;
+    DWORD flags;
+    struct sockaddr_in sin;
+    int sin_len;
+    char buffer[BIP_MPDU_MAX];
+};
+/* I/O completion port of the unicast and broadcast sockets */
+static HANDLE BIP_IOCP;
+static struct bip_iocp_receive BIP_IOCP_Receive[2][BIP_IOCP_RECEIVES];
+#endif
+
 /**
  * @brief Print the IPv4 address with debug info
  * @param str - debug info string
@@ -239,8 +268,13 @@ static void bip_init_windows(void)
     WSADATA wd;
 
     if (!BIP_Initialized) {
+#if defined(BACNET_BIP_IOCP)
+        /* overlapped receives need Windows Sockets 2 */
+        Result = WSAStartup(MAKEWORD(2, 2), &wd);
+#else
         Result = WSAStartup((1 << 8) | 1, &wd);
         /*Result = WSAStartup(MAKEWORD(2,2), &wd); */
+#endif
         if (Result != 0) {
             print_last_error("TCP/IP stack initialization failed");
             exit(1);
@@ -404,6 +438,175 @@ uint8_t bip_get_subnet_prefix(void)
     return prefix;
 }
 
+#if defined(BACNET_BIP_IOCP)
+/**
+ * @brief Post an overlapped receive on its socket
+ * @param rx - the receive to post
+ * @return true if the receive is pending or already completed
+ */
+static bool bip_iocp_post(struct bip_iocp_receive *rx)
+{
+    int rv;
+
+    memset(&rx->overlapped, 0, sizeof(rx->overlapped));
+    rx->wsabuf.buf = rx->buffer;
+    rx->wsabuf.len = sizeof(rx->buffer);
+    rx->flags = 0;
+    rx->sin_len = sizeof(rx->sin);
+    rv = WSARecvFrom(
+        rx->socket, &rx->wsabuf, 1, NULL, &rx->flags,
+        (struct sockaddr *)&rx->sin, &rx->sin_len, &rx->overlapped, NULL);
+    if ((rv == SOCKET_ERROR) && (WSAGetLastError() != WSA_IO_PENDING)) {
+        print_last_error("failed to post an overlapped receive");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Create the I/O completion port of the sockets, enlarge their
+ *  receive buffers, and post the overlapped receives on them
+ * @return true if the receives are posted
+ */
+static bool bip_iocp_init(void)
+{
+    SOCKET sockets[2];
+    unsigned count = 1, s, i;
+    int value = BIP_IOCP_RCVBUF;
+    BOOL reset = FALSE;
+    DWORD bytes = 0;
+
+    sockets[0] = BIP_Socket;
+    sockets[1] = BIP_Broadcast_Socket;
+    if (BIP_Broadcast_Socket != BIP_Socket) {
+        count = 2;
+    }
+    BIP_IOCP = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    if (!BIP_IOCP) {
+        fprintf(stderr, "BIP: failed to create the I/O completion port\n");
+        return false;
+    }
+    for (s = 0; s < count; s++) {
+        if (setsockopt(
+                sockets[s], SOL_SOCKET, SO_RCVBUF, (char *)&value,
+                sizeof(value)) == SOCKET_ERROR) {
+            print_last_error("failed to set RCVBUF socket option");
+        }
+        (void)WSAIoctl(
+            sockets[s], SIO_UDP_CONNRESET, &reset, sizeof(reset), NULL, 0,
+            &bytes, NULL, NULL);
+        if (!CreateIoCompletionPort(
+                (HANDLE)sockets[s], BIP_IOCP, (ULONG_PTR)sockets[s], 0)) {
+            fprintf(stderr, "BIP: failed to bind the I/O completion port\n");
+            return false;
+        }
+        for (i = 0; i < BIP_IOCP_RECEIVES; i++) {
+            BIP_IOCP_Receive[s][i].socket = sockets[s];
+            if (!bip_iocp_post(&BIP_IOCP_Receive[s][i])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wait for a completed overlapped receive, copy its datagram,
+ *  and post the receive again
+ * @param timeout - number of milliseconds to wait for a datagram
+ * @param mtu - buffer for the datagram
+ * @param max_mtu - size of the buffer
+ * @param sin - filled with the source address of the datagram
+ * @param socket - filled with the socket that received the datagram
+ * @return number of bytes received, or 0 if none
+ */
+static int bip_iocp_receive(
+    unsigned timeout,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    struct sockaddr_in *sin,
+    SOCKET *socket)
+{
+    struct bip_iocp_receive *rx;
+    LPOVERLAPPED overlapped = NULL;
+    ULONG_PTR key = 0;
+    DWORD bytes = 0;
+    int received_bytes = 0;
+
+    if (!GetQueuedCompletionStatus(
+            BIP_IOCP, &bytes, &key, &overlapped, timeout)) {
+        if (!overlapped) {
+            /* timeout, and no datagram */
+            return 0;
+        }
+        /* the receive failed, such as for a datagram that was too big */
+        bytes = 0;
+    }
+    rx = (struct bip_iocp_receive *)overlapped;
+    if ((bytes > 0) && (bytes <= max_mtu)) {
+        memcpy(mtu, rx->buffer, bytes);
+        *sin = rx->sin;
+        *socket = rx->socket;
+        received_bytes = (int)bytes;
+    }
+    (void)bip_iocp_post(rx);
+
+    return received_bytes;
+}
+#endif
+
+/**
+ * @brief Wait for a datagram on either socket, and receive it
+ * @param timeout - number of milliseconds to wait for a datagram
+ * @param mtu - buffer for the datagram
+ * @param max_mtu - size of the buffer
+ * @param sin - filled with the source address of the datagram
+ * @param socket - filled with the socket that received the datagram
+ * @return number of bytes received, 0 if none, or negative on error
+ */
+static int bip_select_receive(
+    unsigned timeout,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    struct sockaddr_in *sin,
+    SOCKET *socket)
+{
+    fd_set read_fds;
+    int max = 0;
+    struct timeval select_timeout;
+    socklen_t sin_len = sizeof(*sin);
+
+    /* we could just use a non-blocking socket, but that consumes all
+       the CPU time.  We can use a timeout; it is only supported as
+       a select. */
+    if (timeout >= 1000) {
+        select_timeout.tv_sec = timeout / 1000;
+        select_timeout.tv_usec =
+            1000 * (timeout - select_timeout.tv_sec * 1000);
+    } else {
+        select_timeout.tv_sec = 0;
+        select_timeout.tv_usec = 1000 * timeout;
+    }
+    FD_ZERO(&read_fds);
+    FD_SET(BIP_Socket, &read_fds);
+    FD_SET(BIP_Broadcast_Socket, &read_fds);
+
+    max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
+
+    /* see if there is a packet for us */
+    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
+        *socket =
+            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
+        return recvfrom(
+            *socket, (char *)&mtu[0], max_mtu, 0, (struct sockaddr *)sin,
+            &sin_len);
+    }
+
+    return 0;
+}
+
 /**
  * The send function for BACnet/IP driver layer
  *
@@ -447,61 +650,45 @@ int bip_send_mpdu(
 }
 
 /**
- * BACnet/IP Datalink Receive handler.
+ * BACnet/IP Datalink Receive handler that leaves the NPDU in place
+ * after the BVLC header, so it can be decoded without a copy.
  *
  * @param src - returns the source address
- * @param npdu - returns the NPDU buffer
- * @param max_npdu -maximum size of the NPDU buffer
+ * @param mtu - returns the received BVLC message
+ * @param max_mtu - maximum size of the BVLC message buffer
  * @param timeout - number of milliseconds to wait for a packet
+ * @param npdu_offset - returns the offset of the NPDU in the mtu buffer
  *
- * @return Number of bytes received, or 0 if none or timeout.
+ * @return Number of NPDU bytes received, or 0 if none or timeout.
  */
-uint16_t bip_receive(
-    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+uint16_t bip_receive_npdu(
+    BACNET_ADDRESS *src,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    unsigned timeout,
+    uint16_t *npdu_offset)
 {
     uint16_t npdu_len = 0; /* return value */
-    fd_set read_fds;
-    int max = 0;
-    struct timeval select_timeout;
     struct sockaddr_in sin = { 0 };
     BACNET_IP_ADDRESS addr = { 0 };
-    socklen_t sin_len = sizeof(sin);
     int received_bytes = 0;
     int offset = 0;
-    uint16_t i = 0;
-    SOCKET socket;
+    SOCKET socket = INVALID_SOCKET;
 
     /* Make sure the socket is open */
     if (BIP_Socket == INVALID_SOCKET) {
         return 0;
     }
-    /* we could just use a non-blocking socket, but that consumes all
-       the CPU time.  We can use a timeout; it is only supported as
-       a select. */
-    if (timeout >= 1000) {
-        select_timeout.tv_sec = timeout / 1000;
-        select_timeout.tv_usec =
-            1000 * (timeout - select_timeout.tv_sec * 1000);
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 1000 * timeout;
-    }
-    FD_ZERO(&read_fds);
-    FD_SET(BIP_Socket, &read_fds);
-    FD_SET(BIP_Broadcast_Socket, &read_fds);
-
-    max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
-
-    /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        socket =
-            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
-        received_bytes = recvfrom(
-            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
-            &sin_len);
+#if defined(BACNET_BIP_IOCP)
+    if (BIP_IOCP) {
+        received_bytes = bip_iocp_receive(timeout, mtu, max_mtu, &sin, &socket);
     } else {
-        return 0;
+        received_bytes =
+            bip_select_receive(timeout, mtu, max_mtu, &sin, &socket);
     }
+#else
+    received_bytes = bip_select_receive(timeout, mtu, max_mtu, &sin, &socket);
+#endif
     /* See if there is a problem */
     if (received_bytes < 0) {
         return 0;
@@ -511,20 +698,9 @@ uint16_t bip_receive(
         return 0;
     }
     /* the signature of a BACnet/IPv packet */
-    if (npdu[0] != BVLL_TYPE_BACNET_IP) {
+    if (mtu[0] != BVLL_TYPE_BACNET_IP) {
         return 0;
     }
-    /* Erase up to 16 bytes after the received bytes as safety margin to
-     * ensure that the decoding functions will run into a 'safe field'
-     * of zero, if for any reason they would overrun, when parsing the
-     * message. */
-    max = (int)max_npdu - received_bytes;
-    if (max > 0) {
-        if (max > 16) {
-            max = 16;
-        }
-        memset(&npdu[received_bytes], 0, max);
-    }
     /* Data link layer addressing between B/IPv4 nodes consists of a 32-bit
        IPv4 address followed by a two-octet UDP port number (both of which
        shall be transmitted with the most significant octet first). This
@@ -536,23 +712,43 @@ uint16_t bip_receive(
         "Received MPDU->", &sin.sin_addr, sin.sin_port, received_bytes);
     /* pass the packet into the BBMD handler */
     offset = socket == BIP_Socket
-        ? bvlc_handler(&addr, src, npdu, received_bytes)
-        : bvlc_broadcast_handler(&addr, src, npdu, received_bytes);
+        ? bvlc_handler(&addr, src, mtu, received_bytes)
+        : bvlc_broadcast_handler(&addr, src, mtu, received_bytes);
     if (offset > 0) {
         npdu_len = received_bytes - offset;
-        if (npdu_len <= max_npdu) {
-            /* shift the buffer to return a valid NPDU */
-            for (i = 0; i < npdu_len; i++) {
-                npdu[i] = npdu[offset + i];
-            }
-        } else {
-            npdu_len = 0;
+        if (npdu_offset) {
+            *npdu_offset = (uint16_t)offset;
         }
     }
 
     return npdu_len;
 }
 
+/**
+ * BACnet/IP Datalink Receive handler.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    uint16_t npdu_len = 0;
+    uint16_t offset = 0;
+
+    npdu_len = bip_receive_npdu(src, npdu, max_npdu, timeout, &offset);
+    if ((npdu_len > 0) && (offset > 0)) {
+        /* shift the buffer to return a valid NPDU */
+        memmove(&npdu[0], &npdu[offset], npdu_len);
+    }
+
+    return npdu_len;
+}
+
 /**
  * The common send function for BACnet/IP application layer
  *
@@ -900,6 +1096,12 @@ bool bip_init(char *ifname)
             return false;
         }
     }
+#if defined(BACNET_BIP_IOCP)
+    if (!bip_iocp_init()) {
+        bip_cleanup();
+        return false;
+    }
+#endif
     bvlc_init();
 
     return true;
@@ -932,6 +1134,13 @@ void bip_cleanup(void)
         closesocket(sock_fd);
     }
     BIP_Broadcast_Socket = INVALID_SOCKET;
+#if defined(BACNET_BIP_IOCP)
+    /* closing the sockets cancelled the pending receives */
+    if (BIP_IOCP) {
+        CloseHandle(BIP_IOCP);
+        BIP_IOCP = NULL;
+    }
+#endif
 
     if (BIP_Initialized) {
         BIP_Initialized = false;
@@ -12,6 +12,16 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 
+/* confirmed request header: segmented replies are accepted when
+   the TSM is able to reassemble them */
+#if BACNET_SEGMENTATION_ENABLED
+#define APDU_SEGMENTED_RESPONSE_ACCEPTED BIT(1)
+#define APDU_MAX_SEGMENTS_ACCEPTED BACNET_SEGMENTATION_SEGMENTS_MAX
+#else
+#define APDU_SEGMENTED_RESPONSE_ACCEPTED 0
+#define APDU_MAX_SEGMENTS_ACCEPTED 0
+#endif
+
 typedef struct _confirmed_service_data {
     bool segmented_message;
     bool more_follows;
@@ -735,6 +735,167 @@ int bacnet_audit_log_notification_context_decode(
     return apdu_len;
 }
 
+/**
+ * @brief Encode the list of notifications of an AuditNotification
+ *  service request, so that one request carries many notifications.
+ *
+ *  ConfirmedAuditNotification-Request ::= SEQUENCE {
+ *      notifications [0] SEQUENCE OF BACnetAuditNotification
+ *  }
+ *  UnconfirmedAuditNotification-Request ::= SEQUENCE {
+ *      notifications [0] SEQUENCE OF BACnetAuditNotification
+ *  }
+ *
+ * @param apdu - buffer of data to be encoded, or NULL for length
+ * @param notifications - array of notifications to be encoded
+ * @param count - number of notifications in the array
+ * @return the number of apdu bytes encoded
+ */
+int bacnet_audit_notification_service_encode(
+    uint8_t *apdu,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count)
+{
+    int len, apdu_len = 0; /* total length of the apdu, return value */
+    unsigned index;
+
+    if (!notifications || (count == 0)) {
+        return 0;
+    }
+    len = encode_opening_tag(apdu, 0);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    for (index = 0; index < count; index++) {
+        len = bacnet_audit_log_notification_encode(apdu, &notifications[index]);
+        apdu_len += len;
+        if (apdu) {
+            apdu += len;
+        }
+    }
+    len = encode_closing_tag(apdu, 0);
+    apdu_len += len;
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the list of notifications of an AuditNotification
+ *  service request
+ * @param apdu - buffer of data to be decoded
+ * @param apdu_size - number of bytes in the buffer
+ * @param notifications - array to hold the decoded notifications,
+ *  or NULL to only validate and count them
+ * @param list_size - number of notifications the array can hold.
+ *  Notifications beyond the array are validated and counted only.
+ * @param count - number of notifications in the list
+ * @return number of bytes decoded, or #BACNET_STATUS_ERROR (-1)
+ *  if malformed
+ */
+int bacnet_audit_notification_service_decode(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned list_size,
+    unsigned *count)
+{
+    BACNET_AUDIT_NOTIFICATION *value;
+    int len = 0;
+    int apdu_len = 0;
+    unsigned index = 0;
+
+    if (!apdu) {
+        return BACNET_STATUS_ERROR;
+    }
+    if (!bacnet_is_opening_tag_number(apdu, apdu_size, 0, &len)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    while (!bacnet_is_closing_tag_number(
+        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+        value = NULL;
+        if (notifications && (index < list_size)) {
+            value = &notifications[index];
+        }
+        len = bacnet_audit_log_notification_decode(
+            &apdu[apdu_len], apdu_size - apdu_len, value);
+        if (len <= 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        apdu_len += len;
+        index++;
+    }
+    apdu_len += len;
+    if (index == 0) {
+        /* the list holds at least one notification */
+        return BACNET_STATUS_ERROR;
+    }
+    if (count) {
+        *count = index;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the ConfirmedAuditNotification service APDU
+ * @param apdu - buffer of data to be encoded, or NULL for length
+ * @param invoke_id - invoke ID of the request
+ * @param notifications - array of notifications to be encoded
+ * @param count - number of notifications in the array
+ * @return the number of apdu bytes encoded
+ */
+int bacnet_audit_notification_confirmed_encode_apdu(
+    uint8_t *apdu,
+    uint8_t invoke_id,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count)
+{
+    int len = 0;
+
+    if (apdu) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_AUDIT_NOTIFICATION;
+        apdu += 4;
+    }
+    len = bacnet_audit_notification_service_encode(apdu, notifications, count);
+    if (len == 0) {
+        return 0;
+    }
+
+    return len + 4;
+}
+
+/**
+ * @brief Encode the UnconfirmedAuditNotification service APDU
+ * @param apdu - buffer of data to be encoded, or NULL for length
+ * @param notifications - array of notifications to be encoded
+ * @param count - number of notifications in the array
+ * @return the number of apdu bytes encoded
+ */
+int bacnet_audit_notification_unconfirmed_encode_apdu(
+    uint8_t *apdu,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count)
+{
+    int len = 0;
+
+    if (apdu) {
+        apdu[0] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+        apdu[1] = SERVICE_UNCONFIRMED_AUDIT_NOTIFICATION;
+        apdu += 2;
+    }
+    len = bacnet_audit_notification_service_encode(apdu, notifications, count);
+    if (len == 0) {
+        return 0;
+    }
+
+    return len + 2;
+}
+
 /**
  * @brief Compare two BACnetAuditNotification for same-ness
  * @param value1 - value 1 structure
@@ -234,6 +234,30 @@ bool bacnet_audit_log_notification_same(
     const BACNET_AUDIT_NOTIFICATION *value1,
     const BACNET_AUDIT_NOTIFICATION *value2);
 
+BACNET_STACK_EXPORT
+int bacnet_audit_notification_service_encode(
+    uint8_t *apdu,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count);
+BACNET_STACK_EXPORT
+int bacnet_audit_notification_service_decode(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned list_size,
+    unsigned *count);
+BACNET_STACK_EXPORT
+int bacnet_audit_notification_confirmed_encode_apdu(
+    uint8_t *apdu,
+    uint8_t invoke_id,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count);
+BACNET_STACK_EXPORT
+int bacnet_audit_notification_unconfirmed_encode_apdu(
+    uint8_t *apdu,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count);
+
 BACNET_STACK_EXPORT
 int bacnet_audit_value_encode(uint8_t *apdu, const BACNET_AUDIT_VALUE *value);
 BACNET_STACK_EXPORT
@@ -494,6 +494,41 @@ int bacnet_tag_encode(uint8_t *apdu, uint32_t apdu_size, const BACNET_TAG *tag)
     return apdu_len;
 }
 
+/* The initial tag octet decoded into its fields, so that the one and two
+   octet tags, which are nearly all of the tags, avoid the general path.
+   Bits 0-2 hold the small length/value/type, and bits 3-6 the tag number */
+#define TAG_OCTET_LVT_MASK 0x0007U
+#define TAG_OCTET_NUMBER_SHIFT 3
+#define TAG_OCTET_NUMBER_MASK 0x000FU
+#define TAG_OCTET_CONTEXT 0x0080U
+#define TAG_OCTET_OPENING 0x0100U
+#define TAG_OCTET_CLOSING 0x0200U
+#define TAG_OCTET_EXTENDED_VALUE 0x0400U
+#define TAG_OCTET_EXTENDED_NUMBER 0x0800U
+#define TAG_OCTET(x)                                                     \
+    ((uint16_t)(((((x) & 0x07) < 5) ? ((x) & 0x07) : 0) |                \
+                (((x) >> 4) << TAG_OCTET_NUMBER_SHIFT) |                 \
+                (((x) & 0x08) ? TAG_OCTET_CONTEXT : 0) |                 \
+                ((((x) & 0x0F) == 0x0E) ? TAG_OCTET_OPENING : 0) |       \
+                ((((x) & 0x0F) == 0x0F) ? TAG_OCTET_CLOSING : 0) |       \
+                ((((x) & 0x07) == 5) ? TAG_OCTET_EXTENDED_VALUE : 0) |   \
+                ((((x) & 0xF0) == 0xF0) ? TAG_OCTET_EXTENDED_NUMBER : 0)))
+#define TAG_OCTET_ROW(x)                                                 \
+    TAG_OCTET((x) + 0x0), TAG_OCTET((x) + 0x1), TAG_OCTET((x) + 0x2),    \
+        TAG_OCTET((x) + 0x3), TAG_OCTET((x) + 0x4), TAG_OCTET((x) + 0x5), \
+        TAG_OCTET((x) + 0x6), TAG_OCTET((x) + 0x7), TAG_OCTET((x) + 0x8), \
+        TAG_OCTET((x) + 0x9), TAG_OCTET((x) + 0xA), TAG_OCTET((x) + 0xB), \
+        TAG_OCTET((x) + 0xC), TAG_OCTET((x) + 0xD), TAG_OCTET((x) + 0xE), \
+        TAG_OCTET((x) + 0xF)
+static const uint16_t Tag_Octet_Table[256] = {
+    TAG_OCTET_ROW(0x00), TAG_OCTET_ROW(0x10), TAG_OCTET_ROW(0x20),
+    TAG_OCTET_ROW(0x30), TAG_OCTET_ROW(0x40), TAG_OCTET_ROW(0x50),
+    TAG_OCTET_ROW(0x60), TAG_OCTET_ROW(0x70), TAG_OCTET_ROW(0x80),
+    TAG_OCTET_ROW(0x90), TAG_OCTET_ROW(0xA0), TAG_OCTET_ROW(0xB0),
+    TAG_OCTET_ROW(0xC0), TAG_OCTET_ROW(0xD0), TAG_OCTET_ROW(0xE0),
+    TAG_OCTET_ROW(0xF0)
+};
+
 /**
  * @brief Decode the BACnet Tag Number and Value
  * as defined in clause 20.2.1 General Rules For Encoding BACnet Tags
@@ -513,8 +548,33 @@ int bacnet_tag_decode(const uint8_t *apdu, uint32_t apdu_size, BACNET_TAG *tag)
     bool opening_tag = false;
     bool closing_tag = false;
     uint32_t len_value_type = 0;
+    uint16_t octet;
 
     if (apdu && (apdu_size > 0)) {
+        octet = Tag_Octet_Table[apdu[0]];
+        if (!(octet & TAG_OCTET_EXTENDED_NUMBER)) {
+            /* fast path: one octet, or a length in the second octet */
+            if (!(octet & TAG_OCTET_EXTENDED_VALUE)) {
+                len_value_type = octet & TAG_OCTET_LVT_MASK;
+                len = 1;
+            } else if ((apdu_size >= 2) && (apdu[1] < 254)) {
+                len_value_type = apdu[1];
+                len = 2;
+            }
+            if (len > 0) {
+                if (tag) {
+                    tag->number = (uint8_t)((octet >> TAG_OCTET_NUMBER_SHIFT) &
+                                            TAG_OCTET_NUMBER_MASK);
+                    tag->application = !(octet & TAG_OCTET_CONTEXT);
+                    tag->opening = (octet & TAG_OCTET_OPENING) != 0;
+                    tag->closing = (octet & TAG_OCTET_CLOSING) != 0;
+                    tag->context = (octet & TAG_OCTET_CONTEXT) &&
+                        !(octet & (TAG_OCTET_OPENING | TAG_OCTET_CLOSING));
+                    tag->len_value_type = len_value_type;
+                }
+                return len;
+            }
+        }
         len = bacnet_tag_number_decode(&apdu[0], apdu_size, &tag_number);
     }
     if (len > 0) {
@@ -752,7 +812,7 @@ int bacnet_tag_number_and_value_decode(
         if (value) {
             *value = tag.len_value_type;
         }
-        if (value) {
+        if (tag_number) {
             *tag_number = tag.number;
         }
     }
@@ -5084,6 +5144,86 @@ int encode_simple_ack(uint8_t *apdu, uint8_t invoke_id, uint8_t service_choice)
     return 3;
 }
 
+/**
+ * @brief Start an element-streaming encode of a BACnetARRAY or BACnetLIST
+ *  value.  Each element is checked against the remaining space as it is
+ *  encoded, so an oversized value stops at the first element that does
+ *  not fit instead of after sizing the whole value.  The count of
+ *  elements that fit is where the next segment of the value would start.
+ * @param stream [out] the stream to start
+ * @param apdu [in] buffer for the elements, or NULL to only find the
+ *  length, up to apdu_size
+ * @param apdu_size [in] number of bytes available for the elements
+ */
+void bacnet_array_stream_begin(
+    BACNET_ARRAY_STREAM *stream, uint8_t *apdu, uint32_t apdu_size)
+{
+    if (stream) {
+        stream->apdu = apdu;
+        stream->apdu_size = apdu_size;
+        stream->apdu_len = 0;
+        stream->count = 0;
+        stream->status = 0;
+    }
+}
+
+/**
+ * @brief Encode the next element of a stream
+ * @param stream [in,out] the stream
+ * @param encoder [in] function to encode one property array element
+ * @param object_instance [in] object instance number of the property
+ * @param index [in] element index for the encoder, 0 to N-1
+ * @return true if the element was encoded, false if it did not fit or
+ *  failed to encode, or an earlier element did, and the stream stopped
+ */
+bool bacnet_array_stream_next(
+    BACNET_ARRAY_STREAM *stream,
+    bacnet_array_property_element_encode_function encoder,
+    uint32_t object_instance,
+    BACNET_ARRAY_INDEX index)
+{
+    int len;
+
+    if (!stream || !encoder || (stream->status != 0)) {
+        return false;
+    }
+    len = encoder(object_instance, index, NULL);
+    if (len < 0) {
+        stream->status = BACNET_STATUS_ERROR;
+        return false;
+    }
+    if ((uint32_t)len > (stream->apdu_size - stream->apdu_len)) {
+        stream->status = BACNET_STATUS_ABORT;
+        return false;
+    }
+    if (stream->apdu) {
+        len = encoder(object_instance, index, &stream->apdu[stream->apdu_len]);
+    }
+    stream->apdu_len += (uint32_t)len;
+    stream->count++;
+
+    return true;
+}
+
+/**
+ * @brief End a stream
+ * @param stream [in] the stream
+ * @return The length of the elements encoded, or
+ *   BACNET_STATUS_ABORT if an element did not fit, or
+ *   BACNET_STATUS_ERROR if an element failed to encode
+ */
+int bacnet_array_stream_end(const BACNET_ARRAY_STREAM *stream)
+{
+    if (!stream) {
+        return BACNET_STATUS_ERROR;
+    }
+    if (stream->status != 0) {
+        return stream->status;
+    }
+
+    return (int)stream->apdu_len;
+}
+
 /**
  * @brief Encode a BACnetARRAY property value
  * @param object_instance [in] BACnet network port object instance number
@@ -5109,6 +5249,7 @@ int bacnet_array_encode(
 {
     int apdu_len = 0, len = 0;
     BACNET_ARRAY_INDEX index;
+    BACNET_ARRAY_STREAM stream;
 
     if (array_index == 0) {
         /* Array element zero is the number of objects in the list */
@@ -5120,23 +5261,18 @@ int bacnet_array_encode(
             apdu_len = len;
         }
     } else if (array_index == BACNET_ARRAY_ALL) {
-        /* if no index was specified, then try to encode the entire list */
-        /* into one packet. */
+        /* if no index was specified, then try to encode the entire list
+           into one packet, stopping at the first element that does
+           not fit */
+        bacnet_array_stream_begin(
+            &stream, apdu, (max_apdu > 0) ? (uint32_t)max_apdu : 0);
         for (index = 0; index < array_size; index++) {
-            len += encoder(object_instance, index, NULL);
-        }
-        if (len > max_apdu) {
-            /* encoded size is larger than APDU size */
-            apdu_len = BACNET_STATUS_ABORT;
-        } else {
-            for (index = 0; index < array_size; index++) {
-                len = encoder(object_instance, index, apdu);
-                if (apdu) {
-                    apdu += len;
-                }
-                apdu_len += len;
+            if (!bacnet_array_stream_next(
+                    &stream, encoder, object_instance, index)) {
+                break;
             }
         }
+        apdu_len = bacnet_array_stream_end(&stream);
     } else if (array_index <= array_size) {
         /* index was specified; encode a single array element */
         index = array_index - 1;
@@ -5315,3 +5451,154 @@ BACNET_ERROR_CODE bacnet_list_write(
 
     return error_code;
 }
+
+/**
+ * @brief Start decoding the tagged values in a buffer with a cursor
+ * @param cursor - the decode cursor to initialize
+ * @param apdu - buffer of tagged values, which must remain valid while
+ *  the cursor and its decoded values are in use
+ * @param apdu_size - number of bytes in the buffer
+ */
+void bacnet_decode_cursor_init(
+    BACNET_DECODE_CURSOR *cursor, const uint8_t *apdu, uint32_t apdu_size)
+{
+    if (cursor) {
+        cursor->apdu = apdu;
+        cursor->apdu_size = apdu ? apdu_size : 0;
+        cursor->offset = 0;
+    }
+}
+
+/**
+ * @brief Determine if the cursor has decoded all of its buffer
+ * @param cursor - the decode cursor
+ * @return true if there are no more tagged values to decode
+ */
+bool bacnet_decode_cursor_end(const BACNET_DECODE_CURSOR *cursor)
+{
+    if (cursor) {
+        return cursor->offset >= cursor->apdu_size;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode the value of an application tagged primitive in place
+ * @param value - the tagged value with its data view set
+ * @return true if the value was decoded
+ */
+static bool bacnet_decode_cursor_primitive(BACNET_APPLICATION_DATA_VIEW *value)
+{
+    const uint8_t *data = value->data;
+    uint32_t data_len = value->data_len;
+    int len = 0;
+
+    switch (value->tag.number) {
+        case BACNET_APPLICATION_TAG_NULL:
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            return data_len == 0;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            len = bacnet_unsigned_decode(
+                data, data_len, data_len, &value->type.Unsigned_Int);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            len = bacnet_signed_decode(
+                data, data_len, data_len, &value->type.Signed_Int);
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            len = bacnet_real_decode(
+                data, data_len, data_len, &value->type.Real);
+            break;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            len = bacnet_double_decode(
+                data, data_len, data_len, &value->type.Double);
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            len = bacnet_enumerated_decode(
+                data, data_len, data_len, &value->type.Enumerated);
+            break;
+        case BACNET_APPLICATION_TAG_DATE:
+            len = bacnet_date_decode(
+                data, data_len, data_len, &value->type.Date);
+            break;
+        case BACNET_APPLICATION_TAG_TIME:
+            len = bacnet_time_decode(
+                data, data_len, data_len, &value->type.Time);
+            break;
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            len = bacnet_object_id_decode(
+                data, data_len, data_len, &value->type.Object_Id.type,
+                &value->type.Object_Id.instance);
+            break;
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            if (data_len == 0) {
+                return false;
+            }
+            value->type.Character_Set = data[0];
+            value->data = &data[1];
+            value->data_len = data_len - 1;
+            return true;
+        default:
+            /* octet string, bit string, and reserved tags are a view
+               of the value octets only */
+            return true;
+    }
+
+    return (len > 0) && ((uint32_t)len == data_len);
+}
+
+/**
+ * @brief Decode the next tagged value at the cursor without copying it.
+ *  Application tagged primitives are decoded into the value union, and
+ *  context tagged primitives are only a view of their value octets.  An
+ *  opening or closing tag is returned by itself, so that the caller can
+ *  walk into constructed data.
+ * @param cursor - the decode cursor, which is advanced past the value
+ * @param value - the decoded tag and value, which refers to the buffer
+ * @return number of bytes decoded, 0 at the end of the buffer, or
+ *  BACNET_STATUS_ERROR if the tagged value is malformed
+ */
+int bacnet_decode_cursor_next(
+    BACNET_DECODE_CURSOR *cursor, BACNET_APPLICATION_DATA_VIEW *value)
+{
+    const uint8_t *apdu;
+    uint32_t apdu_size;
+    uint32_t data_len = 0;
+    int tag_len;
+
+    if (!cursor || !value) {
+        return BACNET_STATUS_ERROR;
+    }
+    if (cursor->offset >= cursor->apdu_size) {
+        return 0;
+    }
+    apdu = &cursor->apdu[cursor->offset];
+    apdu_size = cursor->apdu_size - cursor->offset;
+    tag_len = bacnet_tag_decode(apdu, apdu_size, &value->tag);
+    if (tag_len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    value->data = NULL;
+    value->data_len = 0;
+    if (!value->tag.opening && !value->tag.closing) {
+        if (value->tag.application &&
+            (value->tag.number == BACNET_APPLICATION_TAG_BOOLEAN)) {
+            /* the value is in the tag */
+            value->type.Boolean = value->tag.len_value_type ? true : false;
+        } else {
+            data_len = value->tag.len_value_type;
+        }
+        if (data_len > (apdu_size - tag_len)) {
+            return BACNET_STATUS_ERROR;
+        }
+        value->data = &apdu[tag_len];
+        value->data_len = data_len;
+        if (value->tag.application && !bacnet_decode_cursor_primitive(value)) {
+            return BACNET_STATUS_ERROR;
+        }
+    }
+    cursor->offset += tag_len + data_len;
+
+    return tag_len + (int)data_len;
+}
@@ -89,6 +89,51 @@ typedef struct BACnetTag {
 /* max size of a BACnet tag */
 #define BACNET_TAG_SIZE 7
 
+/**
+ * @brief A tagged value decoded in place by the decode cursor.
+ * Fixed size values are decoded into the union, and the data pointer
+ * refers to the value octets in the APDU, so strings are not copied.
+ * For a character string the data follows the character set octet.
+ */
+typedef struct BACnet_Application_Data_View {
+    BACNET_TAG tag;
+    const uint8_t *data;
+    uint32_t data_len;
+    union {
+        bool Boolean;
+        BACNET_UNSIGNED_INTEGER Unsigned_Int;
+        int32_t Signed_Int;
+        float Real;
+        double Double;
+        uint32_t Enumerated;
+        uint8_t Character_Set;
+        BACNET_DATE Date;
+        BACNET_TIME Time;
+        BACNET_OBJECT_ID Object_Id;
+    } type;
+} BACNET_APPLICATION_DATA_VIEW;
+
+/** @brief Position of the decode cursor in an APDU */
+typedef struct BACnet_Decode_Cursor {
+    const uint8_t *apdu;
+    uint32_t apdu_size;
+    uint32_t offset;
+} BACNET_DECODE_CURSOR;
+
+/** @brief Position of an element-streaming encoder of a BACnetARRAY or
+ *  BACnetLIST value in an APDU */
+typedef struct BACnet_Array_Stream {
+    /* NULL to only find the length */
+    uint8_t *apdu;
+    uint32_t apdu_size;
+    uint32_t apdu_len;
+    /* number of elements encoded */
+    uint32_t count;
+    /* 0, BACNET_STATUS_ABORT if an element did not fit,
+       or BACNET_STATUS_ERROR if an element failed to encode */
+    int status;
+} BACNET_ARRAY_STREAM;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -722,6 +767,27 @@ BACNET_ERROR_CODE bacnet_list_write(
     uint8_t *apdu,
     size_t apdu_size);
 
+BACNET_STACK_EXPORT
+void bacnet_array_stream_begin(
+    BACNET_ARRAY_STREAM *stream, uint8_t *apdu, uint32_t apdu_size);
+BACNET_STACK_EXPORT
+bool bacnet_array_stream_next(
+    BACNET_ARRAY_STREAM *stream,
+    bacnet_array_property_element_encode_function encoder,
+    uint32_t object_instance,
+    BACNET_ARRAY_INDEX index);
+BACNET_STACK_EXPORT
+int bacnet_array_stream_end(const BACNET_ARRAY_STREAM *stream);
+
+BACNET_STACK_EXPORT
+void bacnet_decode_cursor_init(
+    BACNET_DECODE_CURSOR *cursor, const uint8_t *apdu, uint32_t apdu_size);
+BACNET_STACK_EXPORT
+int bacnet_decode_cursor_next(
+    BACNET_DECODE_CURSOR *cursor, BACNET_APPLICATION_DATA_VIEW *value);
+BACNET_STACK_EXPORT
+bool bacnet_decode_cursor_end(const BACNET_DECODE_CURSOR *cursor);
+
 /* from clause 20.2.1.2 Tag Number */
 /* true if extended tag numbering is used */
 #define IS_EXTENDED_TAG_NUMBER(x) (((x) & 0xF0) == 0xF0)
@@ -197,6 +197,12 @@ struct BACnet_Device_Address {
     uint8_t adr[MAX_MAC_LEN]; /* hwaddr (MAC) address */
 };
 typedef struct BACnet_Device_Address BACNET_ADDRESS;
+/* a received NPDU that is left in place in the datalink receive buffer */
+typedef struct BACnet_Datalink_Packet {
+    BACNET_ADDRESS src;
+    uint8_t *pdu;
+    uint16_t pdu_len;
+} BACNET_DATALINK_PACKET;
 /* define a MAC address for manipulation */
 struct BACnet_MAC_Address {
     uint8_t len; /* length of MAC address */
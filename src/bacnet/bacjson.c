@@ -0,0 +1,771 @@
+/**
+ * @file
+ * @brief Streaming JSON writer of BACnet values
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacerror.h"
+#include "bacnet/bacstr.h"
+#include "bacnet/bactext.h"
+#include "bacnet/datetime.h"
+#include "bacnet/rpm.h"
+#include "bacnet/bacjson.h"
+
+/* largest text form of a constructed value without a JSON form */
+#ifndef BACJSON_TEXT_MAX
+#define BACJSON_TEXT_MAX 512
+#endif
+
+static const char Hex_Digits[] = "0123456789abcdef";
+
+/**
+ * @brief Initialize a writer
+ * @param writer - writer to initialize
+ * @param sink - function that takes the JSON text
+ * @param context - context passed to the sink
+ */
+void bacjson_writer_init(
+    BACNET_JSON_WRITER *writer, bacjson_sink_function sink, void *context)
+{
+    if (writer) {
+        writer->sink = sink;
+        writer->context = context;
+        writer->length = 0;
+        writer->error = false;
+    }
+}
+
+/**
+ * @brief A sink that appends the JSON text to a buffer, and keeps it
+ *  NUL terminated
+ * @param context - a BACNET_JSON_BUFFER
+ * @param data - JSON text
+ * @param length - number of bytes of JSON text
+ * @return true if the text fits in the buffer
+ */
+bool bacjson_buffer_sink(void *context, const char *data, size_t length)
+{
+    BACNET_JSON_BUFFER *buffer = context;
+
+    if (!buffer || !buffer->buffer || (buffer->size == 0)) {
+        return false;
+    }
+    if ((buffer->length + length) >= buffer->size) {
+        return false;
+    }
+    memcpy(&buffer->buffer[buffer->length], data, length);
+    buffer->length += length;
+    buffer->buffer[buffer->length] = 0;
+
+    return true;
+}
+
+/**
+ * @brief Give some bytes of JSON text to the sink
+ * @param writer - writer
+ * @param data - JSON text
+ * @param length - number of bytes
+ * @return true if the sink took the text
+ */
+static bool
+bacjson_write_data(BACNET_JSON_WRITER *writer, const char *data, size_t length)
+{
+    if (!writer || writer->error || !writer->sink) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    if (!writer->sink(writer->context, data, length)) {
+        writer->error = true;
+        return false;
+    }
+    writer->length += length;
+
+    return true;
+}
+
+/**
+ * @brief Write JSON text as it is, such as punctuation or a key
+ * @param writer - writer
+ * @param text - NUL terminated JSON text
+ * @return true if the text was written
+ */
+bool bacjson_write(BACNET_JSON_WRITER *writer, const char *text)
+{
+    if (!text) {
+        return false;
+    }
+
+    return bacjson_write_data(writer, text, strlen(text));
+}
+
+/**
+ * @brief Write a quoted JSON string.  Runs of plain characters are given
+ *  to the sink at once, and the quote, backslash and control characters
+ *  are escaped.  Bytes above 0x7F are written as they are, so the string
+ *  should be UTF-8.
+ * @param writer - writer
+ * @param str - characters of the string
+ * @param length - number of bytes of the string
+ * @return true if the string was written
+ */
+bool bacjson_write_string(
+    BACNET_JSON_WRITER *writer, const char *str, size_t length)
+{
+    char escape[6] = { '\\', 'u', '0', '0', 0, 0 };
+    size_t start = 0, i;
+    unsigned char c;
+
+    if (!bacjson_write_data(writer, "\"", 1)) {
+        return false;
+    }
+    for (i = 0; str && (i < length); i++) {
+        c = (unsigned char)str[i];
+        if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+            continue;
+        }
+        bacjson_write_data(writer, &str[start], i - start);
+        start = i + 1;
+        if ((c == '"') || (c == '\\')) {
+            escape[1] = (char)c;
+            bacjson_write_data(writer, escape, 2);
+            escape[1] = 'u';
+        } else {
+            escape[4] = Hex_Digits[c >> 4];
+            escape[5] = Hex_Digits[c & 0x0F];
+            bacjson_write_data(writer, escape, 6);
+        }
+    }
+    if (str) {
+        bacjson_write_data(writer, &str[start], length - start);
+    }
+
+    return bacjson_write_data(writer, "\"", 1);
+}
+
+/**
+ * @brief Write an unsigned integer as a JSON number
+ * @param writer - writer
+ * @param value - value to write
+ * @return true if the number was written
+ */
+bool bacjson_write_unsigned(
+    BACNET_JSON_WRITER *writer, BACNET_UNSIGNED_INTEGER value)
+{
+    char digits[24];
+    size_t offset = sizeof(digits);
+
+    do {
+        offset--;
+        digits[offset] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value && offset);
+
+    return bacjson_write_data(writer, &digits[offset], sizeof(digits) - offset);
+}
+
+/**
+ * @brief Write a signed integer as a JSON number
+ * @param writer - writer
+ * @param value - value to write
+ * @return true if the number was written
+ */
+bool bacjson_write_signed(BACNET_JSON_WRITER *writer, int32_t value)
+{
+    if (value < 0) {
+        bacjson_write_data(writer, "-", 1);
+        return bacjson_write_unsigned(
+            writer, (BACNET_UNSIGNED_INTEGER)(-(int64_t)value));
+    }
+
+    return bacjson_write_unsigned(writer, (BACNET_UNSIGNED_INTEGER)value);
+}
+
+/**
+ * @brief Write a floating point value as a JSON number with enough digits
+ *  to read back the same value, or null when it is not a number
+ * @param writer - writer
+ * @param value - value to write
+ * @param digits - significant digits of the value
+ * @return true if the number was written
+ */
+static bool
+bacjson_write_double(BACNET_JSON_WRITER *writer, double value, int digits)
+{
+    char text[32];
+    int len;
+
+    if (!isfinite(value)) {
+        return bacjson_write_data(writer, "null", 4);
+    }
+    len = snprintf(text, sizeof(text), "%.*g", digits, value);
+    if ((len <= 0) || ((size_t)len >= sizeof(text))) {
+        return bacjson_write_data(writer, "null", 4);
+    }
+
+    return bacjson_write_data(writer, text, (size_t)len);
+}
+
+/**
+ * @brief Write a name as a JSON string, or the value as a number when
+ *  there is no name
+ * @param writer - writer
+ * @param name - name of the value, or NULL
+ * @param value - value to write without a name
+ * @return true if the name or the number was written
+ */
+static bool bacjson_write_name(
+    BACNET_JSON_WRITER *writer, const char *name, uint32_t value)
+{
+    if (name) {
+        return bacjson_write_string(writer, name, strlen(name));
+    }
+
+    return bacjson_write_unsigned(writer, value);
+}
+
+/**
+ * @brief Write a number of two or more digits with leading zeros,
+ *  or '*' when the field is unspecified
+ * @param writer - writer
+ * @param value - value of the field
+ * @param width - number of digits
+ * @param wildcard - true if the field is unspecified
+ */
+static void bacjson_write_field(
+    BACNET_JSON_WRITER *writer, unsigned value, unsigned width, bool wildcard)
+{
+    char digits[4];
+    unsigned i;
+
+    if (wildcard) {
+        bacjson_write_data(writer, "*", 1);
+        return;
+    }
+    if (width > sizeof(digits)) {
+        width = sizeof(digits);
+    }
+    for (i = width; i > 0; i--) {
+        digits[i - 1] = (char)('0' + (value % 10));
+        value /= 10;
+    }
+    bacjson_write_data(writer, digits, width);
+}
+
+/**
+ * @brief Write the fields of a date as YYYY-MM-DD
+ * @param writer - writer
+ * @param bdate - date to write
+ */
+static void
+bacjson_write_date_fields(BACNET_JSON_WRITER *writer, const BACNET_DATE *bdate)
+{
+    bacjson_write_field(writer, bdate->year, 4, datetime_wildcard_year(bdate));
+    bacjson_write_data(writer, "-", 1);
+    bacjson_write_field(
+        writer, bdate->month, 2, datetime_wildcard_month(bdate));
+    bacjson_write_data(writer, "-", 1);
+    bacjson_write_field(writer, bdate->day, 2, datetime_wildcard_day(bdate));
+}
+
+/**
+ * @brief Write the fields of a time as hh:mm:ss.cc
+ * @param writer - writer
+ * @param btime - time to write
+ */
+static void
+bacjson_write_time_fields(BACNET_JSON_WRITER *writer, const BACNET_TIME *btime)
+{
+    bacjson_write_field(writer, btime->hour, 2, datetime_wildcard_hour(btime));
+    bacjson_write_data(writer, ":", 1);
+    bacjson_write_field(writer, btime->min, 2, datetime_wildcard_minute(btime));
+    bacjson_write_data(writer, ":", 1);
+    bacjson_write_field(writer, btime->sec, 2, datetime_wildcard_second(btime));
+    bacjson_write_data(writer, ".", 1);
+    bacjson_write_field(
+        writer, btime->hundredths, 2, datetime_wildcard_hundredths(btime));
+}
+
+/**
+ * @brief Write an object type as its name, or as a number
+ * @param writer - writer
+ * @param object_type - object type
+ * @return true if the object type was written
+ */
+static bool
+bacjson_write_object_type(BACNET_JSON_WRITER *writer, uint32_t object_type)
+{
+    return bacjson_write_name(
+        writer, bactext_object_type_name_default(object_type, NULL),
+        object_type);
+}
+
+/**
+ * @brief Write an enumerated value by name for the well known properties,
+ *  or as a number
+ * @param writer - writer
+ * @param object_type - object type of the property
+ * @param property - property of the value
+ * @param value - enumerated value
+ * @return true if the value was written
+ */
+static bool bacjson_write_enumerated(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    uint32_t value)
+{
+    const char *name = NULL;
+
+    switch (property) {
+        case PROP_OBJECT_TYPE:
+            name = bactext_object_type_name_default(value, NULL);
+            break;
+        case PROP_PROPERTY_LIST:
+            name = bactext_property_name_default(value, NULL);
+            break;
+        case PROP_UNITS:
+        case PROP_CONTROLLED_VARIABLE_UNITS:
+        case PROP_OUTPUT_UNITS:
+            name = bactext_engineering_unit_name_default(value, NULL);
+            break;
+        case PROP_EVENT_STATE:
+            name = bactext_event_state_name(value);
+            break;
+        case PROP_RELIABILITY:
+            name = bactext_reliability_name(value);
+            break;
+        case PROP_POLARITY:
+            name = bactext_binary_polarity_name(value);
+            break;
+        case PROP_SYSTEM_STATUS:
+            name = bactext_device_status_name(value);
+            break;
+        case PROP_SEGMENTATION_SUPPORTED:
+            name = bactext_segmentation_name(value);
+            break;
+        case PROP_PRESENT_VALUE:
+        case PROP_RELINQUISH_DEFAULT:
+            if ((object_type == OBJECT_BINARY_INPUT) ||
+                (object_type == OBJECT_BINARY_OUTPUT) ||
+                (object_type == OBJECT_BINARY_VALUE)) {
+                name = bactext_binary_present_value_name(value);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return bacjson_write_name(writer, name, value);
+}
+
+#if defined(BACAPP_PRINT_ENABLED)
+/**
+ * @brief Write a value without a JSON form as a string, in the text form
+ *  of bacapp_snprintf_value()
+ * @param writer - writer
+ * @param object_type - object type of the property
+ * @param property - property of the value
+ * @param value - value to write
+ * @return true if the value was written
+ */
+static bool bacjson_write_text(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    const BACNET_APPLICATION_DATA_VALUE *value)
+{
+    BACNET_APPLICATION_DATA_VALUE element;
+    BACNET_OBJECT_PROPERTY_VALUE object_value = { 0 };
+    char text[BACJSON_TEXT_MAX];
+    int len;
+
+    /* only this value, not the values linked after it */
+    element = *value;
+    element.next = NULL;
+    object_value.object_type = object_type;
+    object_value.object_instance = 0;
+    object_value.object_property = property;
+    object_value.array_index = BACNET_ARRAY_ALL;
+    object_value.value = &element;
+    len = bacapp_snprintf_value(text, sizeof(text), &object_value);
+    if (len < 0) {
+        len = 0;
+    } else if ((size_t)len >= sizeof(text)) {
+        len = sizeof(text) - 1;
+    }
+
+    return bacjson_write_string(writer, text, (size_t)len);
+}
+#endif
+
+/**
+ * @brief Write one value, without the values linked after it
+ * @param writer - writer
+ * @param object_type - object type of the property
+ * @param property - property of the value
+ * @param value - value to write
+ * @return true if the value was written
+ */
+static bool bacjson_write_element(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    const BACNET_APPLICATION_DATA_VALUE *value)
+{
+    size_t i, length;
+    char hex[2];
+
+    switch (value->tag) {
+#if defined(BACAPP_NULL)
+        case BACNET_APPLICATION_TAG_NULL:
+            return bacjson_write_data(writer, "null", 4);
+#endif
+#if defined(BACAPP_BOOLEAN)
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            return bacjson_write(
+                writer, value->type.Boolean ? "true" : "false");
+#endif
+#if defined(BACAPP_UNSIGNED)
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            return bacjson_write_unsigned(writer, value->type.Unsigned_Int);
+#endif
+#if defined(BACAPP_SIGNED)
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            return bacjson_write_signed(writer, value->type.Signed_Int);
+#endif
+#if defined(BACAPP_REAL)
+        case BACNET_APPLICATION_TAG_REAL:
+            return bacjson_write_double(writer, value->type.Real, 9);
+#endif
+#if defined(BACAPP_DOUBLE)
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            return bacjson_write_double(writer, value->type.Double, 17);
+#endif
+#if defined(BACAPP_OCTET_STRING)
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            length = octetstring_length(&value->type.Octet_String);
+            bacjson_write_data(writer, "\"", 1);
+            for (i = 0; i < length; i++) {
+                hex[0] = Hex_Digits[value->type.Octet_String.value[i] >> 4];
+                hex[1] = Hex_Digits[value->type.Octet_String.value[i] & 0x0F];
+                bacjson_write_data(writer, hex, 2);
+            }
+            return bacjson_write_data(writer, "\"", 1);
+#endif
+#if defined(BACAPP_CHARACTER_STRING)
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            return bacjson_write_string(
+                writer, characterstring_value(&value->type.Character_String),
+                characterstring_length(&value->type.Character_String));
+#endif
+#if defined(BACAPP_BIT_STRING)
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            length = bitstring_bits_used(&value->type.Bit_String);
+            bacjson_write_data(writer, "[", 1);
+            for (i = 0; i < length; i++) {
+                if (i > 0) {
+                    bacjson_write_data(writer, ",", 1);
+                }
+                bacjson_write(
+                    writer,
+                    bitstring_bit(&value->type.Bit_String, (uint8_t)i)
+                        ? "true"
+                        : "false");
+            }
+            return bacjson_write_data(writer, "]", 1);
+#endif
+#if defined(BACAPP_ENUMERATED)
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            return bacjson_write_enumerated(
+                writer, object_type, property, value->type.Enumerated);
+#endif
+#if defined(BACAPP_DATE)
+        case BACNET_APPLICATION_TAG_DATE:
+            bacjson_write_data(writer, "\"", 1);
+            bacjson_write_date_fields(writer, &value->type.Date);
+            return bacjson_write_data(writer, "\"", 1);
+#endif
+#if defined(BACAPP_TIME)
+        case BACNET_APPLICATION_TAG_TIME:
+            bacjson_write_data(writer, "\"", 1);
+            bacjson_write_time_fields(writer, &value->type.Time);
+            return bacjson_write_data(writer, "\"", 1);
+#endif
+#if defined(BACAPP_OBJECT_ID)
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            bacjson_write(writer, "{\"type\":");
+            bacjson_write_object_type(writer, value->type.Object_Id.type);
+            bacjson_write(writer, ",\"instance\":");
+            bacjson_write_unsigned(writer, value->type.Object_Id.instance);
+            return bacjson_write_data(writer, "}", 1);
+#endif
+#if defined(BACAPP_DATETIME)
+        case BACNET_APPLICATION_TAG_DATETIME:
+            bacjson_write_data(writer, "\"", 1);
+            bacjson_write_date_fields(writer, &value->type.Date_Time.date);
+            bacjson_write_data(writer, "T", 1);
+            bacjson_write_time_fields(writer, &value->type.Date_Time.time);
+            return bacjson_write_data(writer, "\"", 1);
+#endif
+        case BACNET_APPLICATION_TAG_EMPTYLIST:
+            return bacjson_write_data(writer, "[]", 2);
+        default:
+            break;
+    }
+#if defined(BACAPP_PRINT_ENABLED)
+    return bacjson_write_text(writer, object_type, property, value);
+#else
+    return bacjson_write_data(writer, "null", 4);
+#endif
+}
+
+/**
+ * @brief Write a value, or a list of linked values as a JSON array
+ * @param writer - writer
+ * @param object_type - object type of the property, for the names of
+ *  enumerations and the text of constructed values
+ * @param property - property of the value
+ * @param value - value to write, with the values linked after it
+ * @return true if the value was written
+ */
+bool bacjson_write_value(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    const BACNET_APPLICATION_DATA_VALUE *value)
+{
+    if (!value) {
+        return bacjson_write_data(writer, "null", 4);
+    }
+    if (!value->next) {
+        return bacjson_write_element(writer, object_type, property, value);
+    }
+    bacjson_write_data(writer, "[", 1);
+    while (value) {
+        bacjson_write_element(writer, object_type, property, value);
+        value = value->next;
+        if (value) {
+            bacjson_write_data(writer, ",", 1);
+        }
+    }
+
+    return bacjson_write_data(writer, "]", 1);
+}
+
+/**
+ * @brief Decode the encoded value of a property one element at a time,
+ *  and write it.  A value of more than one element is written as a
+ *  JSON array, and an empty value as an empty array.
+ * @param writer - writer
+ * @param object_type - object type of the property
+ * @param property - property of the value
+ * @param array_index - array index of the value, or BACNET_ARRAY_ALL
+ * @param apdu - encoded value, such as the property-value of a
+ *  ReadProperty-ACK without its context tags
+ * @param apdu_len - number of bytes of the encoded value
+ * @return true if the value was decoded and written, or false if it is
+ *  malformed and the JSON text is incomplete
+ */
+bool bacjson_write_property_value(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    const uint8_t *apdu,
+    size_t apdu_len)
+{
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    bool array = false;
+    int len;
+
+    if (!apdu || (apdu_len == 0)) {
+        return bacjson_write_data(writer, "[]", 2);
+    }
+    while (apdu_len > 0) {
+        len = bacapp_decode_known_array_property(
+            apdu, (int)apdu_len, &value, object_type, property, array_index);
+        if ((len <= 0) || ((size_t)len > apdu_len)) {
+            return false;
+        }
+        apdu += len;
+        apdu_len -= (size_t)len;
+        if (!array && (apdu_len > 0)) {
+            array = true;
+            bacjson_write_data(writer, "[", 1);
+        }
+        bacjson_write_element(writer, object_type, property, &value);
+        if (apdu_len > 0) {
+            bacjson_write_data(writer, ",", 1);
+        }
+    }
+    if (array) {
+        bacjson_write_data(writer, "]", 1);
+    }
+
+    return !writer->error;
+}
+
+/**
+ * @brief Write the results of one property of a ReadPropertyMultiple-ACK
+ * @param writer - writer
+ * @param object_type - object type of the property
+ * @param apdu - encoded results, after the object identifier
+ * @param apdu_len - number of bytes of the encoded results
+ * @return number of bytes decoded, or 0 if the results are malformed
+ */
+static int bacjson_write_rpm_property(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    const uint8_t *apdu,
+    size_t apdu_len)
+{
+    BACNET_PROPERTY_ID property = PROP_ALL;
+    BACNET_ARRAY_INDEX array_index = BACNET_ARRAY_ALL;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_OTHER;
+    int apdu_offset, len, data_len;
+
+    len = rpm_ack_decode_object_property(
+        apdu, (unsigned)apdu_len, &property, &array_index);
+    if (len <= 0) {
+        return 0;
+    }
+    apdu_offset = len;
+    bacjson_write(writer, "{\"property\":");
+    bacjson_write_name(
+        writer, bactext_property_name_default(property, NULL), property);
+    if (array_index != BACNET_ARRAY_ALL) {
+        bacjson_write(writer, ",\"index\":");
+        bacjson_write_unsigned(writer, array_index);
+    }
+    if (bacnet_is_opening_tag_number(
+            &apdu[apdu_offset], apdu_len - apdu_offset, 4, &len)) {
+        data_len = bacnet_enclosed_data_length(
+            &apdu[apdu_offset], apdu_len - apdu_offset);
+        if (data_len < 0) {
+            return 0;
+        }
+        apdu_offset += len;
+        bacjson_write(writer, ",\"value\":");
+        if (!bacjson_write_property_value(
+                writer, object_type, property, array_index,
+                &apdu[apdu_offset], (size_t)data_len)) {
+            return 0;
+        }
+        apdu_offset += data_len;
+        if (!bacnet_is_closing_tag_number(
+                &apdu[apdu_offset], apdu_len - apdu_offset, 4, &len)) {
+            return 0;
+        }
+        apdu_offset += len;
+    } else if (bacnet_is_opening_tag_number(
+                   &apdu[apdu_offset], apdu_len - apdu_offset, 5, &len)) {
+        apdu_offset += len;
+        len = bacerror_decode_error_class_and_code(
+            &apdu[apdu_offset], (unsigned)(apdu_len - apdu_offset),
+            &error_class, &error_code);
+        if (len <= 0) {
+            return 0;
+        }
+        apdu_offset += len;
+        if (!bacnet_is_closing_tag_number(
+                &apdu[apdu_offset], apdu_len - apdu_offset, 5, &len)) {
+            return 0;
+        }
+        apdu_offset += len;
+        bacjson_write(writer, ",\"error-class\":");
+        bacjson_write_name(
+            writer, bactext_error_class_name_default(error_class, NULL),
+            error_class);
+        bacjson_write(writer, ",\"error-code\":");
+        bacjson_write_name(
+            writer, bactext_error_code_name_default(error_code, NULL),
+            error_code);
+    } else {
+        return 0;
+    }
+    bacjson_write_data(writer, "}", 1);
+
+    return apdu_offset;
+}
+
+/**
+ * @brief Write the list of read access results of a
+ *  ReadPropertyMultiple-ACK as a JSON array, decoding the values one at a
+ *  time from the service request without building the lists of
+ *  rpm_ack_decode_service_request()
+ * @param writer - writer
+ * @param apdu - service request of the ReadPropertyMultiple-ACK
+ * @param apdu_len - number of bytes of the service request
+ * @return true if the whole ACK was decoded and written, or false if it is
+ *  malformed and the JSON text is incomplete
+ */
+bool bacjson_write_rpm_ack(
+    BACNET_JSON_WRITER *writer, const uint8_t *apdu, size_t apdu_len)
+{
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t object_instance = 0;
+    bool first_object = true, first_property, closed = true;
+    size_t apdu_offset = 0;
+    int len;
+
+    if (!writer || !apdu) {
+        return false;
+    }
+    bacjson_write_data(writer, "[", 1);
+    while (apdu_offset < apdu_len) {
+        /* object-identifier [0], then list-of-results [1] */
+        len = rpm_ack_decode_object_id(
+            &apdu[apdu_offset], (unsigned)(apdu_len - apdu_offset),
+            &object_type, &object_instance);
+        if (len <= 0) {
+            break;
+        }
+        apdu_offset += (size_t)len;
+        if (!first_object) {
+            bacjson_write_data(writer, ",", 1);
+        }
+        first_object = false;
+        bacjson_write(writer, "{\"object-type\":");
+        bacjson_write_object_type(writer, object_type);
+        bacjson_write(writer, ",\"object-instance\":");
+        bacjson_write_unsigned(writer, object_instance);
+        bacjson_write(writer, ",\"properties\":[");
+        first_property = true;
+        closed = false;
+        while (apdu_offset < apdu_len) {
+            if (bacnet_is_closing_tag_number(
+                    &apdu[apdu_offset], apdu_len - apdu_offset, 1, &len)) {
+                apdu_offset += (size_t)len;
+                closed = true;
+                break;
+            }
+            if (!first_property) {
+                bacjson_write_data(writer, ",", 1);
+            }
+            first_property = false;
+            len = bacjson_write_rpm_property(
+                writer, object_type, &apdu[apdu_offset],
+                apdu_len - apdu_offset);
+            if (len <= 0) {
+                return false;
+            }
+            apdu_offset += (size_t)len;
+        }
+        bacjson_write(writer, "]}");
+    }
+    bacjson_write_data(writer, "]", 1);
+
+    return !writer->error && closed && (apdu_offset == apdu_len);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief API for a streaming JSON writer of BACnet values
+ *
+ * The writer gives JSON text to a caller-supplied sink as it goes, in
+ * small pieces, without formatting whole values into strings first.
+ * A sink can append to a buffer, write to a file or a socket, or feed
+ * a compressor, so any number of values can be exported with a fixed
+ * amount of memory.
+ *
+ * Values are written as JSON types where one fits: null, true/false,
+ * numbers, strings, and arrays for lists and bit strings.  Enumerations
+ * of well known properties are written by name.  Object identifiers are
+ * objects with a type and an instance, and dates and times are ISO 8601
+ * strings with '*' for unspecified fields.  The constructed datatypes
+ * without a JSON form are written as strings in the text form of
+ * bacapp_snprintf_value().
+ *
+ * A ReadPropertyMultiple-ACK is written as an array of objects, each with
+ * an array of properties that have a value or an error:
+ * {@code
+ * [{"object-type":"analog-input","object-instance":1,"properties":[
+ *   {"property":"present-value","value":72.5},
+ *   {"property":"units","value":"degrees-fahrenheit"},
+ *   {"property":"priority-array","index":1,"error-class":"property",
+ *    "error-code":"unknown-property"}]}]
+ * }
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_JSON_H
+#define BACNET_JSON_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacapp.h"
+
+/**
+ * @brief Callback that takes the next piece of JSON text
+ * @param context - context given to bacjson_writer_init()
+ * @param data - JSON text, not NUL terminated
+ * @param length - number of bytes of JSON text
+ * @return true if the text was taken, false to stop the writer
+ */
+typedef bool (*bacjson_sink_function)(
+    void *context, const char *data, size_t length);
+
+typedef struct bacnet_json_writer {
+    bacjson_sink_function sink;
+    void *context;
+    /* number of bytes taken by the sink */
+    size_t length;
+    /* true once the sink has refused text; nothing more is written */
+    bool error;
+} BACNET_JSON_WRITER;
+
+/* context of bacjson_buffer_sink(), which keeps the text NUL terminated */
+typedef struct bacnet_json_buffer {
+    char *buffer;
+    size_t size;
+    size_t length;
+} BACNET_JSON_BUFFER;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void bacjson_writer_init(
+    BACNET_JSON_WRITER *writer, bacjson_sink_function sink, void *context);
+BACNET_STACK_EXPORT
+bool bacjson_buffer_sink(void *context, const char *data, size_t length);
+
+BACNET_STACK_EXPORT
+bool bacjson_write(BACNET_JSON_WRITER *writer, const char *text);
+BACNET_STACK_EXPORT
+bool bacjson_write_string(
+    BACNET_JSON_WRITER *writer, const char *str, size_t length);
+BACNET_STACK_EXPORT
+bool bacjson_write_unsigned(
+    BACNET_JSON_WRITER *writer, BACNET_UNSIGNED_INTEGER value);
+BACNET_STACK_EXPORT
+bool bacjson_write_signed(BACNET_JSON_WRITER *writer, int32_t value);
+
+BACNET_STACK_EXPORT
+bool bacjson_write_value(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    const BACNET_APPLICATION_DATA_VALUE *value);
+BACNET_STACK_EXPORT
+bool bacjson_write_property_value(
+    BACNET_JSON_WRITER *writer,
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    const uint8_t *apdu,
+    size_t apdu_len);
+BACNET_STACK_EXPORT
+bool bacjson_write_rpm_ack(
+    BACNET_JSON_WRITER *writer, const uint8_t *apdu, size_t apdu_len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -544,19 +544,18 @@ size_t characterstring_copy_value(
 bool characterstring_same(
     const BACNET_CHARACTER_STRING *dest, const BACNET_CHARACTER_STRING *src)
 {
-    size_t i; /* counter */
     bool same_status = false;
 
     if (src && dest) {
         if ((src->encoding == dest->encoding) &&
             (src->length == dest->length) &&
             (src->length <= MAX_CHARACTER_STRING_BYTES)) {
-            same_status = true;
-            for (i = 0; i < src->length; i++) {
-                if (src->value[i] != dest->value[i]) {
-                    same_status = false;
-                    break;
-                }
+            /* names often share a prefix, so check the last byte first */
+            if ((src->length == 0) ||
+                ((src->value[src->length - 1] ==
+                  dest->value[src->length - 1]) &&
+                 (memcmp(src->value, dest->value, src->length) == 0))) {
+                same_status = true;
             }
         }
     } else if (src) {
@@ -584,19 +583,14 @@ bool characterstring_same(
 bool characterstring_ansi_same(
     const BACNET_CHARACTER_STRING *src1, const char *src2)
 {
-    size_t i; /* counter */
     bool same_status = false;
 
     if (src1 && src2) {
         if ((src1->encoding == CHARACTER_ANSI_X34) &&
             (src1->length == strlen(src2)) &&
             (src1->length <= MAX_CHARACTER_STRING_BYTES)) {
-            same_status = true;
-            for (i = 0; i < src1->length; i++) {
-                if (src2[i] != src1->value[i]) {
-                    same_status = false;
-                    break;
-                }
+            if (memcmp(src1->value, src2, src1->length) == 0) {
+                same_status = true;
             }
         }
     } else if (src2) {
@@ -855,6 +849,33 @@ static const char trailingBytesForUTF8[256] = {
     3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5
 };
 
+/**
+ * @brief Count the leading ASCII characters, other than null, one machine
+ *  word at a time
+ * @param str  Pointer to the bytes to check.
+ * @param length  Count of bytes to check.
+ * @return number of bytes that are known to be non-null ASCII characters,
+ *  a multiple of the word size; the remaining bytes are checked one by one
+ */
+static size_t utf8_ascii_span(const unsigned char *str, size_t length)
+{
+    const size_t ones = (size_t)-1 / 0xFF;
+    const size_t highs = ones * 0x80;
+    size_t span = 0;
+    size_t word;
+
+    while ((length - span) >= sizeof(word)) {
+        memcpy(&word, &str[span], sizeof(word));
+        /* stop at any byte with bit 7 set, or any null byte */
+        if ((word & highs) || ((word - ones) & ~word & highs)) {
+            break;
+        }
+        span += sizeof(word);
+    }
+
+    return span;
+}
+
 /**
  * @brief Based on the valid_utf8 routine from the PCRE library by Philip Hazel
  * length is in bytes, since without knowing whether the string is valid
@@ -883,6 +904,10 @@ bool utf8_isvalid(const char *str, size_t length)
     /* Check characters. */
     pend = (const unsigned char *)str + length;
     for (p = (const unsigned char *)str; p < pend; p++) {
+        p += utf8_ascii_span(p, (size_t)(pend - p));
+        if (p >= pend) {
+            break;
+        }
         c = *p;
         /* null in middle of string */
         if (c == 0) {
@@ -896,10 +921,10 @@ bool utf8_isvalid(const char *str, size_t length)
             return false;
         }
         ab = (size_t)trailingBytesForUTF8[c];
-        if (length < ab) {
+        /* the trailing bytes must be within the string */
+        if ((size_t)(pend - p) <= ab) {
             return false;
         }
-        length -= ab;
 
         p++;
         /* Check top bits in the second byte */
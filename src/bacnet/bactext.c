@@ -11,6 +11,24 @@
 #include "bacnet/bacenum.h"
 #include "bacnet/bacstr.h"
 #include "bacnet/bactext.h"
+#include "bacnet/basic/sys/platform.h"
+
+/* enable the sorted indices of the large text lists, for a binary search
+   by name in place of a linear search, using RAM for one pointer per name */
+#ifndef BACNET_BACTEXT_SORTED_INDEX
+#define BACNET_BACTEXT_SORTED_INDEX 0
+#endif
+/* enable the tables of the large text lists, for a lookup of the name
+   by value in place of a linear search, using RAM for one pointer per
+   value below the proprietary range */
+#ifndef BACNET_BACTEXT_NAME_TABLE
+#define BACNET_BACTEXT_NAME_TABLE 0
+#endif
+
+static bool bactext_istring_index(
+    INDTEXT_DATA *istring, const char *search_name, uint32_t *found_index);
+static const char *bactext_index_name(
+    INDTEXT_DATA *data_list, uint32_t index, const char *default_string);
 
 static const char *ASHRAE_Reserved_String = "Reserved for Use by ASHRAE";
 static const char *Vendor_Proprietary_String = "Vendor Proprietary Value";
@@ -20,7 +38,7 @@ static const char *Vendor_Proprietary_String = "Vendor Proprietary Value";
 static bool bactext_string_to_uint32_index(
     INDTEXT_DATA *istring, const char *search_name, uint32_t *found_index)
 {
-    if (indtext_by_istring(istring, search_name, found_index) == true) {
+    if (bactext_istring_index(istring, search_name, found_index) == true) {
         return true;
     }
 
@@ -265,6 +283,23 @@ INDTEXT_DATA bacnet_object_type_names[] = {
     { 0, NULL }
 };
 
+#if BACNET_BACTEXT_SORTED_INDEX
+static INDTEXT_DATA
+    *Object_Type_Names_Sorted[ARRAY_SIZE(bacnet_object_type_names)];
+static INDTEXT_INDEX Object_Type_Names_Index = {
+    bacnet_object_type_names, Object_Type_Names_Sorted,
+    ARRAY_SIZE(Object_Type_Names_Sorted), 0, false
+};
+#endif
+
+#if BACNET_BACTEXT_NAME_TABLE
+static const char *Object_Type_Names_Text[OBJECT_PROPRIETARY_MIN];
+static INDTEXT_TABLE Object_Type_Names_Table = {
+    bacnet_object_type_names, Object_Type_Names_Text,
+    ARRAY_SIZE(Object_Type_Names_Text), 0, false
+};
+#endif
+
 INDTEXT_DATA bacnet_object_type_names_capitalized[] = {
     { OBJECT_ANALOG_INPUT, "Analog Input" },
     { OBJECT_ANALOG_OUTPUT, "Analog Output" },
@@ -337,37 +372,46 @@ INDTEXT_DATA bacnet_object_type_names_capitalized[] = {
     { 0, NULL }
 };
 
+#if BACNET_BACTEXT_NAME_TABLE
+static const char *Object_Type_Names_Capitalized_Text[OBJECT_PROPRIETARY_MIN];
+static INDTEXT_TABLE Object_Type_Names_Capitalized_Table = {
+    bacnet_object_type_names_capitalized, Object_Type_Names_Capitalized_Text,
+    ARRAY_SIZE(Object_Type_Names_Capitalized_Text), 0, false
+};
+#endif
+
 const char *bactext_object_type_name(uint32_t index)
 {
-    return indtext_by_index_split_default(
-        bacnet_object_type_names, index, OBJECT_PROPRIETARY_MIN,
-        ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return bactext_index_name(
+        bacnet_object_type_names, index,
+        (index < OBJECT_PROPRIETARY_MIN) ? ASHRAE_Reserved_String
+                                         : Vendor_Proprietary_String);
 }
 
 const char *
 bactext_object_type_name_default(uint32_t index, const char *default_string)
 {
-    return indtext_by_index_default(
-        bacnet_object_type_names, index, default_string);
+    return bactext_index_name(bacnet_object_type_names, index, default_string);
 }
 
 const char *bactext_object_type_name_capitalized(uint32_t index)
 {
-    return indtext_by_index_split_default(
-        bacnet_object_type_names_capitalized, index, OBJECT_PROPRIETARY_MIN,
-        ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return bactext_index_name(
+        bacnet_object_type_names_capitalized, index,
+        (index < OBJECT_PROPRIETARY_MIN) ? ASHRAE_Reserved_String
+                                         : Vendor_Proprietary_String);
 }
 
 const char *bactext_object_type_name_capitalized_default(
     uint32_t index, const char *default_string)
 {
-    return indtext_by_index_default(
+    return bactext_index_name(
         bacnet_object_type_names_capitalized, index, default_string);
 }
 
 bool bactext_object_type_index(const char *search_name, uint32_t *found_index)
 {
-    return indtext_by_istring(
+    return bactext_istring_index(
         bacnet_object_type_names, search_name, found_index);
 }
 
@@ -928,6 +972,22 @@ INDTEXT_DATA bacnet_property_names[] = {
     { 0, NULL }
 };
 
+#if BACNET_BACTEXT_SORTED_INDEX
+static INDTEXT_DATA *Property_Names_Sorted[ARRAY_SIZE(bacnet_property_names)];
+static INDTEXT_INDEX Property_Names_Index = {
+    bacnet_property_names, Property_Names_Sorted,
+    ARRAY_SIZE(Property_Names_Sorted), 0, false
+};
+#endif
+
+#if BACNET_BACTEXT_NAME_TABLE
+static const char *Property_Names_Text[PROP_PROPRIETARY_RANGE_MIN];
+static INDTEXT_TABLE Property_Names_Table = {
+    bacnet_property_names, Property_Names_Text,
+    ARRAY_SIZE(Property_Names_Text), 0, false
+};
+#endif
+
 bool bactext_property_name_proprietary(uint32_t index)
 {
     bool status = false;
@@ -948,7 +1008,7 @@ const char *bactext_property_name(uint32_t index)
     if (bactext_property_name_proprietary(index)) {
         return Vendor_Proprietary_String;
     } else {
-        return indtext_by_index_default(
+        return bactext_index_name(
             bacnet_property_names, index, ASHRAE_Reserved_String);
     }
 }
@@ -956,18 +1016,24 @@ const char *bactext_property_name(uint32_t index)
 const char *
 bactext_property_name_default(uint32_t index, const char *default_string)
 {
-    return indtext_by_index_default(
-        bacnet_property_names, index, default_string);
+    return bactext_index_name(bacnet_property_names, index, default_string);
 }
 
 uint32_t bactext_property_id(const char *name)
 {
-    return indtext_by_istring_default(bacnet_property_names, name, 0);
+    uint32_t index = 0;
+
+    if (!bactext_istring_index(bacnet_property_names, name, &index)) {
+        index = 0;
+    }
+
+    return index;
 }
 
 bool bactext_property_index(const char *search_name, uint32_t *found_index)
 {
-    return indtext_by_istring(bacnet_property_names, search_name, found_index);
+    return bactext_istring_index(
+        bacnet_property_names, search_name, found_index);
 }
 
 bool bactext_property_strtol(const char *search_name, uint32_t *found_index)
@@ -1426,6 +1492,57 @@ INDTEXT_DATA bacnet_engineering_unit_names[] = {
        subject to the procedures and constraints described in Clause 23. */
 };
 
+#if BACNET_BACTEXT_SORTED_INDEX
+static INDTEXT_DATA
+    *Engineering_Unit_Names_Sorted[ARRAY_SIZE(bacnet_engineering_unit_names)];
+static INDTEXT_INDEX Engineering_Unit_Names_Index = {
+    bacnet_engineering_unit_names, Engineering_Unit_Names_Sorted,
+    ARRAY_SIZE(Engineering_Unit_Names_Sorted), 0, false
+};
+#endif
+
+#if BACNET_BACTEXT_NAME_TABLE
+/* the units in the second ASHRAE range are searched in the list */
+static const char *Engineering_Unit_Names_Text[UNITS_PROPRIETARY_RANGE_MIN];
+static INDTEXT_TABLE Engineering_Unit_Names_Table = {
+    bacnet_engineering_unit_names, Engineering_Unit_Names_Text,
+    ARRAY_SIZE(Engineering_Unit_Names_Text), 0, false
+};
+#endif
+
+#if BACNET_BACTEXT_SORTED_INDEX
+/**
+ * @brief Search a list of strings, case insensitive, with the sorted index
+ *  of the list when it has one
+ * @param istring - list of strings and indices
+ * @param search_name - string to search for
+ * @param found_index - index of the string found
+ * @return true if the matching string is found
+ */
+static bool bactext_istring_index(
+    INDTEXT_DATA *istring, const char *search_name, uint32_t *found_index)
+{
+    if (istring == bacnet_property_names) {
+        return indtext_index_by_istring(
+            &Property_Names_Index, search_name, found_index);
+    } else if (istring == bacnet_object_type_names) {
+        return indtext_index_by_istring(
+            &Object_Type_Names_Index, search_name, found_index);
+    } else if (istring == bacnet_engineering_unit_names) {
+        return indtext_index_by_istring(
+            &Engineering_Unit_Names_Index, search_name, found_index);
+    }
+
+    return indtext_by_istring(istring, search_name, found_index);
+}
+#else
+static bool bactext_istring_index(
+    INDTEXT_DATA *istring, const char *search_name, uint32_t *found_index)
+{
+    return indtext_by_istring(istring, search_name, found_index);
+}
+#endif
+
 bool bactext_engineering_unit_name_proprietary(uint32_t index)
 {
     bool status = false;
@@ -1447,7 +1564,7 @@ const char *bactext_engineering_unit_name(uint32_t index)
     if (bactext_engineering_unit_name_proprietary(index)) {
         return Vendor_Proprietary_String;
     } else if (index <= UNITS_RESERVED_RANGE_MAX2) {
-        return indtext_by_index_default(
+        return bactext_index_name(
             bacnet_engineering_unit_names, index, ASHRAE_Reserved_String);
     }
 
@@ -1457,14 +1574,14 @@ const char *bactext_engineering_unit_name(uint32_t index)
 const char *bactext_engineering_unit_name_default(
     uint32_t index, const char *default_string)
 {
-    return indtext_by_index_default(
+    return bactext_index_name(
         bacnet_engineering_unit_names, index, default_string);
 }
 
 bool bactext_engineering_unit_index(
     const char *search_name, uint32_t *found_index)
 {
-    return indtext_by_istring(
+    return bactext_istring_index(
         bacnet_engineering_unit_names, search_name, found_index);
 }
 
@@ -1828,18 +1945,63 @@ INDTEXT_DATA bacnet_error_code_names[] = {
     { 0, NULL }
 };
 
+#if BACNET_BACTEXT_NAME_TABLE
+static const char *Error_Code_Names_Text[ERROR_CODE_PROPRIETARY_FIRST];
+static INDTEXT_TABLE Error_Code_Names_Table = {
+    bacnet_error_code_names, Error_Code_Names_Text,
+    ARRAY_SIZE(Error_Code_Names_Text), 0, false
+};
+
+/**
+ * @brief Find the string for a value in a list of strings, with the table
+ *  of the list when it has one
+ * @param data_list - list of strings and indices
+ * @param index - value to search for
+ * @param default_string - string to return if the value is not found
+ * @return the string found, or the default string
+ */
+static const char *bactext_index_name(
+    INDTEXT_DATA *data_list, uint32_t index, const char *default_string)
+{
+    if (data_list == bacnet_property_names) {
+        return indtext_table_by_index_default(
+            &Property_Names_Table, index, default_string);
+    } else if (data_list == bacnet_object_type_names) {
+        return indtext_table_by_index_default(
+            &Object_Type_Names_Table, index, default_string);
+    } else if (data_list == bacnet_object_type_names_capitalized) {
+        return indtext_table_by_index_default(
+            &Object_Type_Names_Capitalized_Table, index, default_string);
+    } else if (data_list == bacnet_engineering_unit_names) {
+        return indtext_table_by_index_default(
+            &Engineering_Unit_Names_Table, index, default_string);
+    } else if (data_list == bacnet_error_code_names) {
+        return indtext_table_by_index_default(
+            &Error_Code_Names_Table, index, default_string);
+    }
+
+    return indtext_by_index_default(data_list, index, default_string);
+}
+#else
+static const char *bactext_index_name(
+    INDTEXT_DATA *data_list, uint32_t index, const char *default_string)
+{
+    return indtext_by_index_default(data_list, index, default_string);
+}
+#endif
+
 const char *bactext_error_code_name(uint32_t index)
 {
-    return indtext_by_index_split_default(
-        bacnet_error_code_names, index, ERROR_CODE_PROPRIETARY_FIRST,
-        ASHRAE_Reserved_String, Vendor_Proprietary_String);
+    return bactext_index_name(
+        bacnet_error_code_names, index,
+        (index < ERROR_CODE_PROPRIETARY_FIRST) ? ASHRAE_Reserved_String
+                                               : Vendor_Proprietary_String);
 }
 
 const char *
 bactext_error_code_name_default(uint32_t index, const char *default_string)
 {
-    return indtext_by_index_default(
-        bacnet_error_code_names, index, default_string);
+    return bactext_index_name(bacnet_error_code_names, index, default_string);
 }
 
 INDTEXT_DATA bacnet_month_names[] = {
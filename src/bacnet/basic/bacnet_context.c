@@ -0,0 +1,193 @@
+/**
+ * @file
+ * @brief A stack context that owns the per-device state of the stack, so
+ *  that one process can host many device instances
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/npdu/h_npdu.h"
+#include "bacnet/basic/service/h_cov.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/bacnet_context.h"
+
+struct bacnet_stack_context {
+#if (MAX_TSM_TRANSACTIONS)
+    TSM_CONTEXT *tsm;
+#endif
+    ADDRESS_CONTEXT *address;
+    COV_CONTEXT *cov;
+};
+
+/* the stack context of the calling thread, or NULL for the default */
+static BACNET_STACK_THREAD_LOCAL BACNET_STACK_CONTEXT *Stack_Context;
+
+/**
+ * @brief Allocate a stack context with no transactions, no bindings, and
+ *  no COV subscriptions
+ * @param device_id - device instance that the stack context hosts, which
+ *  the address cache will not bind, or UINT32_MAX for none
+ * @return the new stack context, or NULL if out of memory
+ */
+BACNET_STACK_CONTEXT *bacnet_stack_context_create(uint32_t device_id)
+{
+    BACNET_STACK_CONTEXT *context;
+    ADDRESS_CONTEXT *address;
+    bool status;
+
+    context = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_STACK_CONTEXT));
+    if (!context) {
+        return NULL;
+    }
+#if (MAX_TSM_TRANSACTIONS)
+    context->tsm = tsm_context_create();
+#endif
+    context->address = address_context_create();
+    context->cov = handler_cov_context_create();
+    status = context->address && context->cov;
+#if (MAX_TSM_TRANSACTIONS)
+    status = status && context->tsm;
+#endif
+    if (!status) {
+        bacnet_stack_context_delete(context);
+        return NULL;
+    }
+    address = address_context_select(context->address);
+    address_own_device_id_set(device_id);
+    (void)address_context_select(address);
+
+    return context;
+}
+
+/**
+ * @brief Free a stack context. The stack context must not be selected
+ *  by any thread.
+ * @param context - stack context from bacnet_stack_context_create()
+ */
+void bacnet_stack_context_delete(BACNET_STACK_CONTEXT *context)
+{
+    if (context) {
+#if (MAX_TSM_TRANSACTIONS)
+        tsm_context_delete(context->tsm);
+#endif
+        address_context_delete(context->address);
+        handler_cov_context_delete(context->cov);
+        BACNET_MEMPOOL_FREE(context, sizeof(BACNET_STACK_CONTEXT));
+    }
+}
+
+/**
+ * @brief Select the stack context used by the stack functions called
+ *  from this thread
+ * @param context - stack context from bacnet_stack_context_create(), or
+ *  NULL for the default context of the process
+ * @return the stack context that was selected before, or NULL for the
+ *  default context
+ */
+BACNET_STACK_CONTEXT *bacnet_stack_context_select(BACNET_STACK_CONTEXT *context)
+{
+    BACNET_STACK_CONTEXT *previous = Stack_Context;
+
+    if (context) {
+#if (MAX_TSM_TRANSACTIONS)
+        (void)tsm_context_select(context->tsm);
+#endif
+        (void)address_context_select(context->address);
+        (void)handler_cov_context_select(context->cov);
+    } else {
+#if (MAX_TSM_TRANSACTIONS)
+        (void)tsm_context_select(NULL);
+#endif
+        (void)address_context_select(NULL);
+        (void)handler_cov_context_select(NULL);
+    }
+    Stack_Context = context;
+
+    return previous;
+}
+
+/**
+ * @brief Get the stack context used by the stack functions called from
+ *  this thread
+ * @return the selected stack context, or NULL for the default context
+ */
+BACNET_STACK_CONTEXT *bacnet_stack_context_selected(void)
+{
+    return Stack_Context;
+}
+
+/**
+ * @brief Handle a received NPDU in a stack context
+ * @param context - stack context, or NULL for the default context
+ * @param src - source address of the NPDU
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ */
+void bacnet_stack_context_npdu_handler(
+    BACNET_STACK_CONTEXT *context,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t pdu_len)
+{
+    BACNET_STACK_CONTEXT *previous;
+
+    previous = bacnet_stack_context_select(context);
+    npdu_handler(src, pdu, pdu_len);
+    (void)bacnet_stack_context_select(previous);
+}
+
+/**
+ * @brief Run the millisecond timer of the transactions of a stack context
+ * @param context - stack context, or NULL for the default context
+ * @param milliseconds - number of milliseconds since the last call
+ */
+void bacnet_stack_context_timer_milliseconds(
+    BACNET_STACK_CONTEXT *context, uint16_t milliseconds)
+{
+#if (MAX_TSM_TRANSACTIONS)
+    BACNET_STACK_CONTEXT *previous;
+
+    previous = bacnet_stack_context_select(context);
+    tsm_timer_milliseconds(milliseconds);
+    (void)bacnet_stack_context_select(previous);
+#else
+    (void)context;
+    (void)milliseconds;
+#endif
+}
+
+/**
+ * @brief Run the second timers of the address cache and the COV
+ *  subscriptions of a stack context
+ * @param context - stack context, or NULL for the default context
+ * @param seconds - number of seconds since the last call
+ */
+void bacnet_stack_context_timer_seconds(
+    BACNET_STACK_CONTEXT *context, uint16_t seconds)
+{
+    BACNET_STACK_CONTEXT *previous;
+
+    previous = bacnet_stack_context_select(context);
+    address_cache_timer(seconds);
+    handler_cov_timer_seconds(seconds);
+    (void)bacnet_stack_context_select(previous);
+}
+
+/**
+ * @brief Run the COV task of a stack context
+ * @param context - stack context, or NULL for the default context
+ */
+void bacnet_stack_context_task(BACNET_STACK_CONTEXT *context)
+{
+    BACNET_STACK_CONTEXT *previous;
+
+    previous = bacnet_stack_context_select(context);
+    handler_cov_task();
+    (void)bacnet_stack_context_select(previous);
+}
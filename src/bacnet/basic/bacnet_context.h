@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief A stack context that owns the per-device state of the stack, so
+ *  that one process can host many device instances
+ *
+ * The transaction state machine, the address cache, and the COV
+ * subscriptions each keep their state in a context that is selected for
+ * the calling thread.  A stack context groups one context of each, and
+ * the context-taking functions below select it around a call into the
+ * stack, so that many device instances can share one event loop.  With
+ * BACNET_STACK_CONTEXT_THREADS, the selection is kept per thread, so that
+ * the stack contexts can also run on several threads in parallel, as long
+ * as each stack context is only used by one thread at a time.
+ *
+ * The object database, the Device object, and the service handler tables
+ * are shared by all of the stack contexts.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_CONTEXT_H
+#define BACNET_BASIC_CONTEXT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+typedef struct bacnet_stack_context BACNET_STACK_CONTEXT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+BACNET_STACK_CONTEXT *bacnet_stack_context_create(uint32_t device_id);
+BACNET_STACK_EXPORT
+void bacnet_stack_context_delete(BACNET_STACK_CONTEXT *context);
+BACNET_STACK_EXPORT
+BACNET_STACK_CONTEXT *
+bacnet_stack_context_select(BACNET_STACK_CONTEXT *context);
+BACNET_STACK_EXPORT
+BACNET_STACK_CONTEXT *bacnet_stack_context_selected(void);
+
+BACNET_STACK_EXPORT
+void bacnet_stack_context_npdu_handler(
+    BACNET_STACK_CONTEXT *context,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t pdu_len);
+BACNET_STACK_EXPORT
+void bacnet_stack_context_timer_milliseconds(
+    BACNET_STACK_CONTEXT *context, uint16_t milliseconds);
+BACNET_STACK_EXPORT
+void bacnet_stack_context_timer_seconds(
+    BACNET_STACK_CONTEXT *context, uint16_t seconds);
+BACNET_STACK_EXPORT
+void bacnet_stack_context_task(BACNET_STACK_CONTEXT *context);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
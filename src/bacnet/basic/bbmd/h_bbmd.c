@@ -14,6 +14,8 @@
 #include "bacnet/datalink/bip.h"
 #include "bacnet/datalink/bvlc.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/trace.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/bbmd/h_bbmd.h"
 
@@ -68,6 +70,457 @@ static BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY
 #define MAX_FD_ENTRIES 128
 #endif
 static BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY FD_Table[MAX_FD_ENTRIES];
+/* cached Forwarded-NPDU destinations: the FDT entries, then the BDT */
+static BACNET_IP_ADDRESS BBMD_Forward_List[MAX_FD_ENTRIES + MAX_BBMD_ENTRIES];
+static unsigned BBMD_Forward_FDT_Count;
+static unsigned BBMD_Forward_List_Count;
+static bool BBMD_Forward_List_Valid;
+#if defined(BACNET_BIP_BATCH)
+/* the cached destinations, except the originating node */
+static BACNET_IP_ADDRESS BBMD_Forward_Dest[MAX_FD_ENTRIES + MAX_BBMD_ENTRIES];
+#endif
+
+/** Invalidate the cached Forwarded-NPDU destinations, after a change to
+ * the BDT, the FDT, or the NAT handling.
+ */
+static void bbmd_forward_list_invalidate(void)
+{
+    BBMD_Forward_List_Valid = false;
+}
+
+#if defined(BACNET_BBMD_FDT_HASH)
+/* The FDT is indexed by a hash of the B/IPv4 address, and the entries
+   expire from a timing wheel of one second slots, so that registration,
+   delete, and the maintenance timer do not scan the whole table.  The
+   FD_Table array is still the table, so Read-FDT and bvlc_fdt_list()
+   work as before.  The ttl_seconds_remaining of each entry is refreshed
+   from the wheel on Read-FDT, on bvlc_fdt_list(), and once per turn of
+   the wheel; changes made through the bvlc_fdt_list() pointer are
+   indexed at the same time. */
+#ifndef BBMD_FDT_HASH_SIZE
+#define BBMD_FDT_HASH_SIZE 64
+#endif
+#ifndef BBMD_FDT_WHEEL_SIZE
+#define BBMD_FDT_WHEEL_SIZE 64
+#endif
+#if (MAX_FD_ENTRIES >= UINT16_MAX)
+#error "MAX_FD_ENTRIES must be less than 65535 with BACNET_BBMD_FDT_HASH"
+#endif
+#define BBMD_FDT_NONE UINT16_MAX
+static uint16_t FDT_Hash_Head[BBMD_FDT_HASH_SIZE];
+static uint16_t FDT_Hash_Next[MAX_FD_ENTRIES];
+static uint16_t FDT_Hash_Bucket[MAX_FD_ENTRIES];
+static uint16_t FDT_Wheel_Head[BBMD_FDT_WHEEL_SIZE];
+static uint16_t FDT_Wheel_Next[MAX_FD_ENTRIES];
+static uint16_t FDT_Wheel_Prev[MAX_FD_ENTRIES];
+static uint32_t FDT_Expire_Seconds[MAX_FD_ENTRIES];
+static bool FDT_Indexed[MAX_FD_ENTRIES];
+static uint32_t FDT_Clock_Seconds;
+
+/**
+ * @brief Hash a B/IPv4 address into an FDT hash bucket
+ * @param addr - B/IPv4 address
+ * @return hash bucket
+ */
+static uint16_t bbmd_fdt_hash(const BACNET_IP_ADDRESS *addr)
+{
+    uint32_t key;
+
+    key = ((uint32_t)addr->address[0] << 24) |
+        ((uint32_t)addr->address[1] << 16) |
+        ((uint32_t)addr->address[2] << 8) | (uint32_t)addr->address[3];
+    key ^= addr->port;
+    key *= 2654435761UL;
+
+    return (uint16_t)((key >> 16) % BBMD_FDT_HASH_SIZE);
+}
+
+/**
+ * @brief Add an FDT entry to the hash bucket of its address
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_hash_insert(uint16_t index)
+{
+    uint16_t bucket = bbmd_fdt_hash(&FD_Table[index].dest_address);
+
+    FDT_Hash_Bucket[index] = bucket;
+    FDT_Hash_Next[index] = FDT_Hash_Head[bucket];
+    FDT_Hash_Head[bucket] = index;
+}
+
+/**
+ * @brief Remove an FDT entry from its hash bucket
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_hash_remove(uint16_t index)
+{
+    uint16_t *link = &FDT_Hash_Head[FDT_Hash_Bucket[index]];
+
+    while (*link != BBMD_FDT_NONE) {
+        if (*link == index) {
+            *link = FDT_Hash_Next[index];
+            break;
+        }
+        link = &FDT_Hash_Next[*link];
+    }
+    FDT_Hash_Next[index] = BBMD_FDT_NONE;
+}
+
+/**
+ * @brief Add an FDT entry to the wheel slot of its expiry time
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_wheel_insert(uint16_t index)
+{
+    uint16_t slot = FDT_Expire_Seconds[index] % BBMD_FDT_WHEEL_SIZE;
+
+    FDT_Wheel_Prev[index] = BBMD_FDT_NONE;
+    FDT_Wheel_Next[index] = FDT_Wheel_Head[slot];
+    if (FDT_Wheel_Head[slot] != BBMD_FDT_NONE) {
+        FDT_Wheel_Prev[FDT_Wheel_Head[slot]] = index;
+    }
+    FDT_Wheel_Head[slot] = index;
+}
+
+/**
+ * @brief Remove an FDT entry from its wheel slot
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_wheel_remove(uint16_t index)
+{
+    uint16_t slot = FDT_Expire_Seconds[index] % BBMD_FDT_WHEEL_SIZE;
+
+    if (FDT_Wheel_Prev[index] != BBMD_FDT_NONE) {
+        FDT_Wheel_Next[FDT_Wheel_Prev[index]] = FDT_Wheel_Next[index];
+    } else {
+        FDT_Wheel_Head[slot] = FDT_Wheel_Next[index];
+    }
+    if (FDT_Wheel_Next[index] != BBMD_FDT_NONE) {
+        FDT_Wheel_Prev[FDT_Wheel_Next[index]] = FDT_Wheel_Prev[index];
+    }
+    FDT_Wheel_Next[index] = BBMD_FDT_NONE;
+    FDT_Wheel_Prev[index] = BBMD_FDT_NONE;
+}
+
+/**
+ * @brief Add an FDT entry to the hash and the wheel
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_index_insert(uint16_t index)
+{
+    FDT_Expire_Seconds[index] =
+        FDT_Clock_Seconds + FD_Table[index].ttl_seconds_remaining;
+    bbmd_fdt_hash_insert(index);
+    bbmd_fdt_wheel_insert(index);
+    FDT_Indexed[index] = true;
+}
+
+/**
+ * @brief Remove an FDT entry from the hash and the wheel
+ * @param index - FD_Table index
+ */
+static void bbmd_fdt_index_remove(uint16_t index)
+{
+    bbmd_fdt_hash_remove(index);
+    bbmd_fdt_wheel_remove(index);
+    FDT_Indexed[index] = false;
+}
+
+/**
+ * @brief Clear the FDT hash and wheel, and index the valid entries
+ */
+static void bbmd_fdt_index_init(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < BBMD_FDT_HASH_SIZE; i++) {
+        FDT_Hash_Head[i] = BBMD_FDT_NONE;
+    }
+    for (i = 0; i < BBMD_FDT_WHEEL_SIZE; i++) {
+        FDT_Wheel_Head[i] = BBMD_FDT_NONE;
+    }
+    for (i = 0; i < MAX_FD_ENTRIES; i++) {
+        FDT_Hash_Next[i] = BBMD_FDT_NONE;
+        FDT_Wheel_Next[i] = BBMD_FDT_NONE;
+        FDT_Wheel_Prev[i] = BBMD_FDT_NONE;
+        FDT_Indexed[i] = false;
+        if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
+            bbmd_fdt_index_insert(i);
+        }
+    }
+}
+
+/**
+ * @brief Refresh the time remaining of each FDT entry from the wheel,
+ *  and index the entries that were changed through bvlc_fdt_list()
+ */
+static void bbmd_fdt_refresh(void)
+{
+    uint32_t remaining;
+    uint16_t i;
+
+    for (i = 0; i < MAX_FD_ENTRIES; i++) {
+        if (FDT_Indexed[i]) {
+            if (!FD_Table[i].valid) {
+                bbmd_fdt_index_remove(i);
+            } else {
+                remaining = FDT_Expire_Seconds[i] - FDT_Clock_Seconds;
+                if (remaining > UINT16_MAX) {
+                    remaining = UINT16_MAX;
+                }
+                FD_Table[i].ttl_seconds_remaining = (uint16_t)remaining;
+                if (FDT_Hash_Bucket[i] !=
+                    bbmd_fdt_hash(&FD_Table[i].dest_address)) {
+                    bbmd_fdt_hash_remove(i);
+                    bbmd_fdt_hash_insert(i);
+                }
+            }
+        } else if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
+            bbmd_fdt_index_insert(i);
+        }
+    }
+}
+
+/**
+ * @brief Find an FDT entry by its B/IPv4 address
+ * @param addr - B/IPv4 address
+ * @return FD_Table index, or BBMD_FDT_NONE if not found
+ */
+static uint16_t bbmd_fdt_find(const BACNET_IP_ADDRESS *addr)
+{
+    uint16_t index = FDT_Hash_Head[bbmd_fdt_hash(addr)];
+
+    while (index != BBMD_FDT_NONE) {
+        if (FD_Table[index].valid &&
+            !bvlc_address_different(&FD_Table[index].dest_address, addr)) {
+            break;
+        }
+        index = FDT_Hash_Next[index];
+    }
+
+    return index;
+}
+
+/**
+ * @brief Add an entry to the Foreign-Device-Table, or restart its timer
+ * @param addr - B/IPv4 address to be added
+ * @param ttl_seconds - Time-to-Live T, in seconds
+ * @return true if the Foreign Device entry was added or already exists
+ */
+static bool
+bbmd_fdt_entry_add(const BACNET_IP_ADDRESS *addr, uint16_t ttl_seconds)
+{
+    uint16_t index;
+
+    index = bbmd_fdt_find(addr);
+    if (index != BBMD_FDT_NONE) {
+        bbmd_fdt_index_remove(index);
+    } else {
+        for (index = 0; index < MAX_FD_ENTRIES; index++) {
+            if (!FD_Table[index].valid && !FDT_Indexed[index]) {
+                break;
+            }
+        }
+        if (index == MAX_FD_ENTRIES) {
+            return false;
+        }
+        bvlc_address_copy(&FD_Table[index].dest_address, addr);
+        FD_Table[index].valid = true;
+    }
+    FD_Table[index].ttl_seconds = ttl_seconds;
+    /* Upon receipt of a BVLL Register-Foreign-Device message,
+       a BBMD shall start a timer with a value equal to the
+       Time-to-Live parameter supplied plus a fixed grace
+       period of 30 seconds. */
+    if (ttl_seconds < (UINT16_MAX - 30)) {
+        FD_Table[index].ttl_seconds_remaining = ttl_seconds + 30;
+    } else {
+        FD_Table[index].ttl_seconds_remaining = UINT16_MAX;
+    }
+    bbmd_fdt_index_insert(index);
+
+    return true;
+}
+
+/**
+ * @brief Delete an entry in the Foreign-Device-Table
+ * @param addr - B/IPv4 address to be deleted
+ * @return true if the Foreign Device entry was found and removed.
+ */
+static bool bbmd_fdt_entry_delete(const BACNET_IP_ADDRESS *addr)
+{
+    uint16_t index;
+
+    index = bbmd_fdt_find(addr);
+    if (index == BBMD_FDT_NONE) {
+        return false;
+    }
+    bbmd_fdt_index_remove(index);
+    FD_Table[index].valid = false;
+    FD_Table[index].ttl_seconds_remaining = 0;
+
+    return true;
+}
+
+/**
+ * @brief Expire the FDT entries in the wheel slots that have passed
+ * @param seconds - number of elapsed seconds since the last call
+ */
+static void bbmd_fdt_timer(uint16_t seconds)
+{
+    uint32_t clock_seconds = FDT_Clock_Seconds + seconds;
+    uint32_t slot_seconds = FDT_Clock_Seconds;
+    unsigned steps = seconds;
+    uint16_t index;
+    uint16_t next;
+
+    if (steps > BBMD_FDT_WHEEL_SIZE) {
+        steps = BBMD_FDT_WHEEL_SIZE;
+    }
+    while (steps > 0) {
+        steps--;
+        slot_seconds++;
+        index = FDT_Wheel_Head[slot_seconds % BBMD_FDT_WHEEL_SIZE];
+        while (index != BBMD_FDT_NONE) {
+            next = FDT_Wheel_Next[index];
+            if (FDT_Expire_Seconds[index] <= clock_seconds) {
+                bbmd_fdt_index_remove(index);
+                FD_Table[index].valid = false;
+                FD_Table[index].ttl_seconds_remaining = 0;
+            }
+            index = next;
+        }
+    }
+    if ((FDT_Clock_Seconds / BBMD_FDT_WHEEL_SIZE) !=
+        (clock_seconds / BBMD_FDT_WHEEL_SIZE)) {
+        FDT_Clock_Seconds = clock_seconds;
+        bbmd_fdt_refresh();
+    } else {
+        FDT_Clock_Seconds = clock_seconds;
+    }
+}
+#else
+static bool
+bbmd_fdt_entry_add(const BACNET_IP_ADDRESS *addr, uint16_t ttl_seconds)
+{
+    return bvlc_foreign_device_table_entry_add(&FD_Table[0], addr, ttl_seconds);
+}
+
+static bool bbmd_fdt_entry_delete(const BACNET_IP_ADDRESS *addr)
+{
+    return bvlc_foreign_device_table_entry_delete(&FD_Table[0], addr);
+}
+
+static void bbmd_fdt_timer(uint16_t seconds)
+{
+    bvlc_foreign_device_table_maintenance_timer(&FD_Table[0], seconds);
+}
+
+static void bbmd_fdt_refresh(void)
+{
+}
+
+static void bbmd_fdt_index_init(void)
+{
+}
+#endif
+
+#if defined(BACNET_BBMD_DUPLICATE_FILTER)
+/* A broadcast can reach a BBMD twice: as an Original-Broadcast-NPDU on
+   its subnet and as a Forwarded-NPDU from a peer, or from two peers when
+   the BDT masks are wrong.  A hash of the originating B/IPv4 address and
+   the NPDU is kept for a short window, in two generations that are each
+   one window long, and a repeat within the window is not given to the
+   network layer.  Forwarding is not changed. */
+#ifndef BBMD_DUPLICATE_FILTER_SIZE
+#define BBMD_DUPLICATE_FILTER_SIZE 32
+#endif
+#ifndef BBMD_DUPLICATE_FILTER_WINDOW_MS
+#define BBMD_DUPLICATE_FILTER_WINDOW_MS 500
+#endif
+static uint32_t Duplicate_Hash[2][BBMD_DUPLICATE_FILTER_SIZE];
+static uint8_t Duplicate_Count[2];
+static uint8_t Duplicate_Generation;
+static unsigned long Duplicate_Generation_Start;
+
+/**
+ * @brief Hash a broadcast NPDU and its originating address with FNV-1a
+ * @param addr - B/IPv4 address of the originating device
+ * @param npdu - NPDU of the broadcast
+ * @param npdu_len - number of bytes in the NPDU
+ * @return hash of the broadcast
+ */
+static uint32_t bbmd_duplicate_hash(
+    const BACNET_IP_ADDRESS *addr, const uint8_t *npdu, uint16_t npdu_len)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned i;
+
+    for (i = 0; i < IP_ADDRESS_MAX; i++) {
+        hash = (hash ^ addr->address[i]) * 16777619UL;
+    }
+    hash = (hash ^ (addr->port >> 8)) * 16777619UL;
+    hash = (hash ^ (addr->port & 0xFF)) * 16777619UL;
+    for (i = 0; i < npdu_len; i++) {
+        hash = (hash ^ npdu[i]) * 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Check if a broadcast was received within the window, and
+ *  remember it
+ * @param addr - B/IPv4 address of the originating device
+ * @param npdu - NPDU of the broadcast
+ * @param npdu_len - number of bytes in the NPDU
+ * @return true if the broadcast is a repeat
+ */
+static bool bbmd_duplicate_broadcast(
+    const BACNET_IP_ADDRESS *addr, const uint8_t *npdu, uint16_t npdu_len)
+{
+    unsigned long elapsed;
+    uint32_t hash;
+    uint8_t *count;
+    unsigned g, i;
+
+    elapsed = mstimer_now() - Duplicate_Generation_Start;
+    if (elapsed >= BBMD_DUPLICATE_FILTER_WINDOW_MS) {
+        /* the older generation is out of the window */
+        Duplicate_Generation ^= 1;
+        Duplicate_Count[Duplicate_Generation] = 0;
+        if (elapsed >= (2 * BBMD_DUPLICATE_FILTER_WINDOW_MS)) {
+            Duplicate_Count[Duplicate_Generation ^ 1] = 0;
+        }
+        Duplicate_Generation_Start += elapsed;
+    }
+    hash = bbmd_duplicate_hash(addr, npdu, npdu_len);
+    for (g = 0; g < 2; g++) {
+        for (i = 0; i < Duplicate_Count[g]; i++) {
+            if (Duplicate_Hash[g][i] == hash) {
+                return true;
+            }
+        }
+    }
+    count = &Duplicate_Count[Duplicate_Generation];
+    if (*count < BBMD_DUPLICATE_FILTER_SIZE) {
+        Duplicate_Hash[Duplicate_Generation][*count] = hash;
+        (*count)++;
+    }
+
+    return false;
+}
+#else
+static bool bbmd_duplicate_broadcast(
+    const BACNET_IP_ADDRESS *addr, const uint8_t *npdu, uint16_t npdu_len)
+{
+    (void)addr;
+    (void)npdu;
+    (void)npdu_len;
+
+    return false;
+}
+#endif
 #endif
 
 /**
@@ -95,7 +548,8 @@ static void debug_print_bip(const char *str, const BACNET_IP_ADDRESS *addr)
 {
 #if PRINT_ENABLED
     if (BVLC_Debug) {
-        printf(
+        debug_log(
+            DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG,
             "BVLC: %s %u.%u.%u.%u:%u\n", str, (unsigned)addr->address[0],
             (unsigned)addr->address[1], (unsigned)addr->address[2],
             (unsigned)addr->address[3], (unsigned)addr->port);
@@ -115,7 +569,9 @@ static void debug_print_unsigned(const char *str, const unsigned int value)
 {
 #if PRINT_ENABLED
     if (BVLC_Debug) {
-        printf("BVLC: %s %u\n", str, value);
+        debug_log(
+            DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG, "BVLC: %s %u\n", str,
+            value);
     }
 #else
     (void)str;
@@ -133,7 +589,9 @@ static void debug_print_npdu(
 {
 #if PRINT_ENABLED
     if (BVLC_Debug) {
-        printf("BVLC: %s NPDU=MTU[%u] len=%u\n", str, offset, length);
+        debug_log(
+            DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG,
+            "BVLC: %s NPDU=MTU[%u] len=%u\n", str, offset, length);
     }
 #else
     (void)str;
@@ -150,7 +608,7 @@ static void debug_print_string(const char *str)
 {
 #if PRINT_ENABLED
     if (BVLC_Debug) {
-        printf("BVLC: %s\n", str);
+        debug_log(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG, "BVLC: %s\n", str);
     }
 #else
     (void)str;
@@ -226,6 +684,7 @@ void bvlc_bdt_restore_local(void)
                 BBMD_Table, BBMD_Table_tmp,
                 sizeof(BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY) *
                     MAX_BBMD_ENTRIES);
+            bbmd_forward_list_invalidate();
         }
     }
 }
@@ -246,7 +705,10 @@ void bvlc_bdt_restore_local(void)
 void bvlc_maintenance_timer(uint16_t seconds)
 {
 #if BBMD_ENABLED
-    bvlc_foreign_device_table_maintenance_timer(&FD_Table[0], seconds);
+    bbmd_fdt_timer(seconds);
+    /* expired FDT entries, and tables changed through bvlc_bdt_list()
+       or bvlc_fdt_list(), are picked up once a second */
+    bbmd_forward_list_invalidate();
 #else
     (void)seconds;
 #endif
@@ -335,95 +797,94 @@ static uint16_t bbmd_forward_npdu(
     return mtu_len;
 }
 
-/** Sends all Broadcast Devices a Forwarded NPDU
+/** Determine if a Forwarded-NPDU may be sent to a destination
  *
- * @param bip_src - source IP address and UDP port
- * @param npdu - returns the NPDU
- * @param max_npdu - amount of space available in the NPDU
- * @param npdu_length - reported length of the NPDU
- * @param original - was the message an original (not forwarded)
- * @return number of bytes encoded in the Forwarded NPDU
+ * @param bip_dest - destination IP address and UDP port
+ * @param my_addr - my IP address and UDP port
+ * @return true if the destination is not my own or the NAT router
  */
-static uint16_t bbmd_bdt_forward_npdu(
-    const BACNET_IP_ADDRESS *bip_src,
-    const uint8_t *npdu,
-    uint16_t npdu_length,
-    bool original)
+static bool bbmd_forward_address_valid(
+    const BACNET_IP_ADDRESS *bip_dest, const BACNET_IP_ADDRESS *my_addr)
+{
+    if (!bvlc_address_different(bip_dest, my_addr)) {
+        /* don't forward to our selves */
+        return false;
+    }
+    if (BVLC_NAT_Handling) {
+        if (bvlc_address_different(bip_dest, &BVLC_Global_Address)) {
+            /* NAT router port forwards BACnet packets from global IP.
+               Packets sent to that global IP by us would end up back,
+               creating a loop. */
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Rebuild the cached Forwarded-NPDU destinations from the FDT and BDT,
+ * with the foreign devices first, so that the broadcast distribution
+ * masks are only applied when a table changes.
+ */
+static void bbmd_forward_list_update(void)
 {
-    uint8_t mtu[BIP_MPDU_MAX] = { 0 };
-    uint16_t mtu_len = 0;
-    unsigned i = 0; /* loop counter */
     BACNET_IP_ADDRESS bip_dest = { 0 };
     BACNET_IP_ADDRESS my_addr = { 0 };
+    unsigned count = 0;
+    unsigned i = 0; /* loop counter */
 
+    if (BBMD_Forward_List_Valid) {
+        return;
+    }
     bip_get_addr(&my_addr);
-    /* If we are forwarding an original broadcast message and the NAT
-     * handling is enabled, change the source address to NAT routers
-     * global IP address so the recipient can reply (local IP address
-     * is not accessible from internet side.
-     *
-     * If we are forwarding a message from peer BBMD or foreign device
-     * or the NAT handling is disabled, leave the source address as is.
-     */
-    if (BVLC_NAT_Handling && original) {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), &BVLC_Global_Address, npdu,
-            npdu_length);
-    } else {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
+    for (i = 0; i < MAX_FD_ENTRIES; i++) {
+        if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
+            bvlc_address_copy(&bip_dest, &FD_Table[i].dest_address);
+            if (bbmd_forward_address_valid(&bip_dest, &my_addr)) {
+                bvlc_address_copy(&BBMD_Forward_List[count], &bip_dest);
+                count++;
+            }
+        }
     }
-    /* loop through the BDT and send one to each entry */
+    BBMD_Forward_FDT_Count = count;
     for (i = 0; i < MAX_BBMD_ENTRIES; i++) {
         if (BBMD_Table[i].valid) {
             bvlc_broadcast_distribution_table_entry_forward_address(
                 &bip_dest, &BBMD_Table[i]);
-            if (!bvlc_address_different(&bip_dest, &my_addr)) {
-                /* don't forward to our selves */
-                continue;
-            }
-            if (!bvlc_address_different(&bip_dest, bip_src)) {
-                /* don't forward back to origin */
-                continue;
+            if (bbmd_forward_address_valid(&bip_dest, &my_addr)) {
+                bvlc_address_copy(&BBMD_Forward_List[count], &bip_dest);
+                count++;
             }
-            if (BVLC_NAT_Handling) {
-                if (bvlc_address_different(&bip_dest, &BVLC_Global_Address)) {
-                    /* NAT router port forwards BACnet packets from global IP.
-                       Packets sent to that global IP by us would end up back,
-                       creating a loop. */
-                    continue;
-                }
-            }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
-            debug_print_bip("BDT Send Forwarded-NPDU", &bip_dest);
         }
     }
-
-    return mtu_len;
+    BBMD_Forward_List_Count = count;
+    BBMD_Forward_List_Valid = true;
 }
 
-/** Sends all Foreign Devices a Forwarded NPDU
+/** Sends all Foreign Devices, and optionally all Broadcast Devices,
+ * a Forwarded NPDU.  The Forwarded-NPDU is encoded once and sent to the
+ * cached destinations, except the originating node.
  *
  * @param bip_src - source IP address and UDP port
- * @param npdu - returns the NPDU
- * @param max_npdu - amount of space available in the NPDU
+ * @param npdu - the NPDU
  * @param npdu_length - reported length of the NPDU
  * @param original - was the message an original (not forwarded)
+ * @param bdt - true to also send to the BDT entries
  * @return number of bytes encoded in the Forwarded NPDU
  */
-static uint16_t bbmd_fdt_forward_npdu(
+static uint16_t bbmd_broadcast_forward_npdu(
     const BACNET_IP_ADDRESS *bip_src,
     const uint8_t *npdu,
     uint16_t npdu_length,
-    bool original)
+    bool original,
+    bool bdt)
 {
     uint8_t mtu[BIP_MPDU_MAX] = { 0 };
     uint16_t mtu_len = 0;
+    unsigned count = 0;
+    unsigned dest_count = 0;
     unsigned i = 0; /* loop counter */
-    BACNET_IP_ADDRESS bip_dest = { 0 };
-    BACNET_IP_ADDRESS my_addr = { 0 };
 
-    bip_get_addr(&my_addr);
     /* If we are forwarding an original broadcast message and the NAT
      * handling is enabled, change the source address to NAT routers
      * global IP address so the recipient can reply (local IP address
@@ -440,31 +901,37 @@ static uint16_t bbmd_fdt_forward_npdu(
         mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
             &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
     }
-
-    /* loop through the FDT and send one to each entry */
-    for (i = 0; i < MAX_FD_ENTRIES; i++) {
-        if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
-            bvlc_address_copy(&bip_dest, &FD_Table[i].dest_address);
-            if (!bvlc_address_different(&bip_dest, &my_addr)) {
-                /* don't forward to our selves */
-                continue;
-            }
-            if (!bvlc_address_different(&bip_dest, bip_src)) {
-                /* don't forward back to origin */
-                continue;
-            }
-            if (BVLC_NAT_Handling) {
-                if (bvlc_address_different(&bip_dest, &BVLC_Global_Address)) {
-                    /* NAT router port forwards BACnet packets from global IP.
-                       Packets sent to that global IP by us would end up back,
-                       creating a loop. */
-                    continue;
-                }
-            }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
-            debug_print_bip("FDT Send Forwarded-NPDU", &bip_dest);
+    if (mtu_len == 0) {
+        return 0;
+    }
+    bbmd_forward_list_update();
+    count = bdt ? BBMD_Forward_List_Count : BBMD_Forward_FDT_Count;
+    for (i = 0; i < count; i++) {
+        if (!bvlc_address_different(&BBMD_Forward_List[i], bip_src)) {
+            /* don't forward back to origin */
+            continue;
+        }
+        if (i < BBMD_Forward_FDT_Count) {
+            debug_print_bip("FDT Send Forwarded-NPDU", &BBMD_Forward_List[i]);
+        } else {
+            debug_print_bip("BDT Send Forwarded-NPDU", &BBMD_Forward_List[i]);
         }
+#if defined(BACNET_BIP_BATCH)
+        bvlc_address_copy(
+            &BBMD_Forward_Dest[dest_count], &BBMD_Forward_List[i]);
+#else
+        bip_send_mpdu(&BBMD_Forward_List[i], mtu, mtu_len);
+#endif
+        dest_count++;
+    }
+#if defined(BACNET_BIP_BATCH)
+    if (dest_count > 0) {
+        bip_send_mpdu_many(&BBMD_Forward_Dest[0], dest_count, mtu, mtu_len);
     }
+#else
+    (void)dest_count;
+#endif
+    BACNET_TRACE2(bbmd_forward, mtu_len, dest_count);
 
     return mtu_len;
 }
@@ -569,79 +1036,156 @@ static void bbmd_read_fdt_ack_handler(
 #endif
 
 /**
- * The common send function for BACnet/IP application layer
- *
+ * @brief Choose the destination and the BVLC message of an NPDU
  * @param dest - Points to a #BACNET_ADDRESS structure containing the
  *  destination address.
- * @param npdu_data - Points to a BACNET_NPDU_DATA structure containing the
- *  destination network layer control flags and data.
- * @param mtu - the bytes of data to send
- * @param mtu_len - the number of bytes of data to send
- * @return Upon successful completion, returns the number of bytes sent.
- *  Otherwise, -1 shall be returned to indicate the error.
+ * @param pdu - the NPDU to send, also forwarded to the BDT and FDT when
+ *  it is a local broadcast of a BBMD
+ * @param pdu_len - the number of bytes of the NPDU
+ * @param bvlc_dest - returns the B/IPv4 destination address
+ * @param message_type - returns the BVLC message that carries the NPDU
+ * @return true if the destination address is valid
  */
-int bvlc_send_pdu(
+static bool bvlc_send_destination(
     const BACNET_ADDRESS *dest,
-    const BACNET_NPDU_DATA *npdu_data,
     const uint8_t *pdu,
-    unsigned pdu_len)
+    unsigned pdu_len,
+    BACNET_IP_ADDRESS *bvlc_dest,
+    uint8_t *message_type)
 {
-    BACNET_IP_ADDRESS bvlc_dest = { 0 };
-    uint8_t mtu[BIP_MPDU_MAX] = { 0 };
-    uint16_t mtu_len = 0;
 #if BBMD_ENABLED
     BACNET_IP_ADDRESS bip_src = { 0 };
 #endif
 
-    /* this datalink doesn't need to know the npdu data */
-    (void)npdu_data;
     /* handle various broadcasts: */
     if ((dest->net == BACNET_BROADCAST_NETWORK) || (dest->mac_len == 0)) {
         /* mac_len = 0 is a broadcast address */
         /* net = 0 indicates local, net = 65535 indicates global */
         if (Remote_BBMD.port) {
             /* we are a foreign device */
-            bvlc_address_copy(&bvlc_dest, &Remote_BBMD);
-            mtu_len = bvlc_encode_distribute_broadcast_to_network(
-                mtu, sizeof(mtu), pdu, pdu_len);
-            debug_print_bip("Send Distribute-Broadcast-to-Network", &bvlc_dest);
+            bvlc_address_copy(bvlc_dest, &Remote_BBMD);
+            *message_type = BVLC_DISTRIBUTE_BROADCAST_TO_NETWORK;
+            debug_print_bip("Send Distribute-Broadcast-to-Network", bvlc_dest);
         } else {
-            bip_get_broadcast_addr(&bvlc_dest);
-            mtu_len =
-                bvlc_encode_original_broadcast(mtu, sizeof(mtu), pdu, pdu_len);
-            debug_print_bip("Send Original-Broadcast-NPDU", &bvlc_dest);
+            bip_get_broadcast_addr(bvlc_dest);
+            *message_type = BVLC_ORIGINAL_BROADCAST_NPDU;
+            debug_print_bip("Send Original-Broadcast-NPDU", bvlc_dest);
 #if BBMD_ENABLED
-            if (mtu_len > 0) {
+            if ((pdu_len > 0) && ((pdu_len + 4) <= BIP_MPDU_MAX)) {
                 bip_get_addr(&bip_src);
-                (void)bbmd_fdt_forward_npdu(&bip_src, pdu, pdu_len, true);
-                (void)bbmd_bdt_forward_npdu(&bip_src, pdu, pdu_len, true);
+                (void)bbmd_broadcast_forward_npdu(
+                    &bip_src, pdu, pdu_len, true, true);
             }
+#else
+            (void)pdu;
 #endif
         }
     } else if ((dest->net > 0) && (dest->len == 0)) {
         /* net > 0 and net < 65535 are network specific broadcast if len = 0 */
         if (dest->mac_len == 6) {
             /* network specific broadcast to address */
-            bvlc_ip_address_from_bacnet_local(&bvlc_dest, dest);
+            bvlc_ip_address_from_bacnet_local(bvlc_dest, dest);
         } else {
-            bip_get_broadcast_addr(&bvlc_dest);
+            bip_get_broadcast_addr(bvlc_dest);
         }
-        mtu_len =
-            bvlc_encode_original_broadcast(mtu, sizeof(mtu), pdu, pdu_len);
-        debug_print_bip("Send Original-Broadcast-NPDU", &bvlc_dest);
+        *message_type = BVLC_ORIGINAL_BROADCAST_NPDU;
+        debug_print_bip("Send Original-Broadcast-NPDU", bvlc_dest);
     } else if (dest->mac_len == 6) {
         /* valid unicast */
-        bvlc_ip_address_from_bacnet_local(&bvlc_dest, dest);
-        mtu_len = bvlc_encode_original_unicast(mtu, sizeof(mtu), pdu, pdu_len);
-        debug_print_bip("Send Original-Unicast-NPDU", &bvlc_dest);
+        bvlc_ip_address_from_bacnet_local(bvlc_dest, dest);
+        *message_type = BVLC_ORIGINAL_UNICAST_NPDU;
+        debug_print_bip("Send Original-Unicast-NPDU", bvlc_dest);
     } else {
         debug_print_string("Send failure. Invalid Address.");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * The common send function for BACnet/IP application layer
+ *
+ * @param dest - Points to a #BACNET_ADDRESS structure containing the
+ *  destination address.
+ * @param npdu_data - Points to a BACNET_NPDU_DATA structure containing the
+ *  destination network layer control flags and data.
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ * @return Upon successful completion, returns the number of bytes sent.
+ *  Otherwise, -1 shall be returned to indicate the error.
+ */
+int bvlc_send_pdu(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *pdu,
+    unsigned pdu_len)
+{
+    BACNET_IP_ADDRESS bvlc_dest = { 0 };
+    /* every byte that is sent gets encoded, so no need to clear it */
+    uint8_t mtu[BIP_MPDU_MAX];
+    uint16_t mtu_len = 0;
+    uint8_t message_type = 0;
+
+    /* this datalink doesn't need to know the npdu data */
+    (void)npdu_data;
+    if (!bvlc_send_destination(
+            dest, pdu, pdu_len, &bvlc_dest, &message_type)) {
         return -1;
     }
+    if (message_type == BVLC_DISTRIBUTE_BROADCAST_TO_NETWORK) {
+        mtu_len = bvlc_encode_distribute_broadcast_to_network(
+            mtu, sizeof(mtu), pdu, pdu_len);
+    } else if (message_type == BVLC_ORIGINAL_BROADCAST_NPDU) {
+        mtu_len =
+            bvlc_encode_original_broadcast(mtu, sizeof(mtu), pdu, pdu_len);
+    } else {
+        mtu_len = bvlc_encode_original_unicast(mtu, sizeof(mtu), pdu, pdu_len);
+    }
 
     return bip_send_mpdu(&bvlc_dest, mtu, mtu_len);
 }
 
+#if defined(BACNET_PBUF_SEND)
+/**
+ * @brief Send an NPDU from a PDU buffer.  The BVLC header is prepended
+ *  in the headroom of the buffer, so the NPDU is not copied.
+ * @param dest - Points to a #BACNET_ADDRESS structure containing the
+ *  destination address.
+ * @param npdu_data - Points to a BACNET_NPDU_DATA structure containing the
+ *  destination network layer control flags and data.
+ * @param pbuf - the NPDU, with at least BIP_HEADER_MAX bytes of headroom,
+ *  or else it is copied by bvlc_send_pdu().  On return it holds the
+ *  whole BVLC message.
+ * @return Upon successful completion, returns the number of bytes sent.
+ *  Otherwise, -1 shall be returned to indicate the error.
+ */
+int bvlc_send_pbuf(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    BACNET_PBUF *pbuf)
+{
+    BACNET_IP_ADDRESS bvlc_dest = { 0 };
+    uint8_t message_type = 0;
+    uint16_t pdu_len = pbuf_length(pbuf);
+    uint8_t *mtu;
+
+    if ((pbuf_headroom(pbuf) < BIP_HEADER_MAX) ||
+        ((pdu_len + BIP_HEADER_MAX) > BIP_MPDU_MAX)) {
+        return bvlc_send_pdu(dest, npdu_data, pbuf_data(pbuf), pdu_len);
+    }
+    if (!bvlc_send_destination(
+            dest, pbuf_data(pbuf), pdu_len, &bvlc_dest, &message_type)) {
+        return -1;
+    }
+    mtu = pbuf_prepend(pbuf, BIP_HEADER_MAX);
+    (void)bvlc_encode_header(
+        mtu, BIP_HEADER_MAX, message_type, pbuf_length(pbuf));
+
+    return bip_send_mpdu(&bvlc_dest, mtu, pbuf_length(pbuf));
+}
+#endif
+
 /**
  * The Result Code send function for BACnet/IPv4 application layer
  *
@@ -897,6 +1441,7 @@ int bvlc_bbmd_enabled_handler(
             if (function_len > 0) {
                 /* BDT changed! Save backup to file */
                 bvlc_bdt_backup_local();
+                bbmd_forward_list_invalidate();
                 result_code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
                 send_result = true;
             } else {
@@ -972,8 +1517,13 @@ int bvlc_bbmd_enabled_handler(
                     the BBMD's FDT. */
                 offset = header_len + function_len - npdu_len;
                 npdu = &mtu[offset];
-                (void)bbmd_fdt_forward_npdu(
-                    &fwd_address, npdu, npdu_len, false);
+                (void)bbmd_broadcast_forward_npdu(
+                    &fwd_address, npdu, npdu_len, false, false);
+                if (bbmd_duplicate_broadcast(&fwd_address, npdu, npdu_len)) {
+                    offset = 0;
+                    debug_print_string("Dropped Forwarded-NPDU: Duplicate!");
+                    break;
+                }
                 /* prepare the message for me! */
                 bvlc_ip_address_to_bacnet_local(src, &fwd_address);
                 debug_print_npdu("Forwarded-NPDU", offset, npdu_len);
@@ -1000,8 +1550,8 @@ int bvlc_bbmd_enabled_handler(
             function_len =
                 bvlc_decode_register_foreign_device(pdu, pdu_len, &ttl_seconds);
             if (function_len) {
-                if (bvlc_foreign_device_table_entry_add(
-                        &FD_Table[0], addr, ttl_seconds)) {
+                if (bbmd_fdt_entry_add(addr, ttl_seconds)) {
+                    bbmd_forward_list_invalidate();
                     result_code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
                     send_result = true;
                 } else {
@@ -1021,6 +1571,7 @@ int bvlc_bbmd_enabled_handler(
                it shall return a BVLC-Result message to the originating device
                with a result code of X'0040' indicating that the read attempt
                has failed. */
+            bbmd_fdt_refresh();
             BVLC_Buffer_Len = bvlc_encode_read_foreign_device_table_ack(
                 BVLC_Buffer, sizeof(BVLC_Buffer), &FD_Table[0]);
             if (BVLC_Buffer_Len > 0) {
@@ -1051,8 +1602,8 @@ int bvlc_bbmd_enabled_handler(
             function_len =
                 bvlc_decode_delete_foreign_device(pdu, pdu_len, &fwd_address);
             if (function_len > 0) {
-                if (bvlc_foreign_device_table_entry_delete(
-                        &FD_Table[0], &fwd_address)) {
+                if (bbmd_fdt_entry_delete(&fwd_address)) {
+                    bbmd_forward_list_invalidate();
                     result_code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
                     send_result = true;
                 } else {
@@ -1083,8 +1634,8 @@ int bvlc_bbmd_enabled_handler(
                attempt was unsuccessful */
             npdu_len = bbmd_forward_npdu(addr, pdu, pdu_len);
             if (npdu_len > 0) {
-                (void)bbmd_fdt_forward_npdu(addr, pdu, pdu_len, false);
-                (void)bbmd_bdt_forward_npdu(addr, pdu, pdu_len, false);
+                (void)bbmd_broadcast_forward_npdu(
+                    addr, pdu, pdu_len, false, true);
             } else {
                 result_code = BVLC_RESULT_DISTRIBUTE_BROADCAST_TO_NETWORK_NAK;
                 send_result = true;
@@ -1149,10 +1700,16 @@ int bvlc_bbmd_enabled_handler(
                     debug_print_string("Dropped Original-Broadcast-NPDU: "
                                        "Confirmed Service!");
                 } else {
-                    (void)bbmd_fdt_forward_npdu(addr, npdu, npdu_len, true);
-                    (void)bbmd_bdt_forward_npdu(addr, npdu, npdu_len, true);
-                    debug_print_npdu(
-                        "Original-Broadcast-NPDU", offset, npdu_len);
+                    (void)bbmd_broadcast_forward_npdu(
+                        addr, npdu, npdu_len, true, true);
+                    if (bbmd_duplicate_broadcast(addr, npdu, npdu_len)) {
+                        offset = 0;
+                        debug_print_string(
+                            "Dropped Original-Broadcast-NPDU: Duplicate!");
+                    } else {
+                        debug_print_npdu(
+                            "Original-Broadcast-NPDU", offset, npdu_len);
+                    }
                 }
             } else {
                 debug_print_string(
@@ -1410,6 +1967,10 @@ void bvlc_set_function_code(uint8_t function_code)
  */
 BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *bvlc_fdt_list(void)
 {
+    /* the caller may read or change the table */
+    bbmd_fdt_refresh();
+    bbmd_forward_list_invalidate();
+
     return &FD_Table[0];
 }
 
@@ -1419,6 +1980,9 @@ BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *bvlc_fdt_list(void)
  */
 BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY *bvlc_bdt_list(void)
 {
+    /* the caller may change the table */
+    bbmd_forward_list_invalidate();
+
     return &BBMD_Table[0];
 }
 
@@ -1430,6 +1994,7 @@ void bvlc_bdt_list_clear(void)
     bvlc_broadcast_distribution_table_valid_clear(&BBMD_Table[0]);
     /* BDT changed! Save backup to file */
     bvlc_bdt_backup_local();
+    bbmd_forward_list_invalidate();
 }
 #endif
 
@@ -1452,6 +2017,9 @@ void bvlc_set_global_address_for_nat(const BACNET_IP_ADDRESS *addr)
 {
     bvlc_address_copy(&BVLC_Global_Address, addr);
     BVLC_NAT_Handling = true;
+#if BBMD_ENABLED
+    bbmd_forward_list_invalidate();
+#endif
     debug_print_bip("NAT Address enabled", addr);
 }
 
@@ -1461,6 +2029,9 @@ void bvlc_set_global_address_for_nat(const BACNET_IP_ADDRESS *addr)
 void bvlc_disable_nat(void)
 {
     BVLC_NAT_Handling = false;
+#if BBMD_ENABLED
+    bbmd_forward_list_invalidate();
+#endif
     debug_print_string("NAT Address disabled");
 }
 
@@ -1471,6 +2042,8 @@ void bvlc_init(void)
     bvlc_broadcast_distribution_table_link_array(
         &BBMD_Table[0], MAX_BBMD_ENTRIES);
     bvlc_foreign_device_table_link_array(&FD_Table[0], MAX_FD_ENTRIES);
+    bbmd_fdt_index_init();
+    bbmd_forward_list_invalidate();
 #else
     debug_print_string("Initializing (BBMD Disabled).");
 #endif
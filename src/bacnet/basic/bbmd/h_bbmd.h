@@ -15,6 +15,7 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/datalink/bvlc.h"
+#include "bacnet/basic/sys/pbuf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,13 @@ int bvlc_send_pdu(
     const BACNET_NPDU_DATA *npdu_data,
     const uint8_t *pdu,
     unsigned pdu_len);
+#if defined(BACNET_PBUF_SEND)
+BACNET_STACK_EXPORT
+int bvlc_send_pbuf(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    BACNET_PBUF *pbuf);
+#endif
 
 BACNET_STACK_EXPORT
 uint16_t bvlc_get_last_result(void);
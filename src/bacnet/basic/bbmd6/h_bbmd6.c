@@ -67,6 +67,287 @@ static BACNET_IP6_BROADCAST_DISTRIBUTION_TABLE_ENTRY
 #define MAX_FD6_ENTRIES 128
 #endif
 static BACNET_IP6_FOREIGN_DEVICE_TABLE_ENTRY FD_Table[MAX_FD6_ENTRIES];
+/* number of hash buckets of the BDT and FDT indexes - a power of two */
+#ifndef BBMD6_HASH_SIZE
+#define BBMD6_HASH_SIZE 64
+#endif
+/* seconds added to the Time-to-Live of a foreign device (see U.4.5.2) */
+#define BBMD6_FD_GRACE_SECONDS 30
+/* hash chains keyed by B/IPv6 address and port: entry index + 1, or zero */
+static uint16_t BBMD_Table_Bucket[BBMD6_HASH_SIZE];
+static uint16_t BBMD_Table_Next[MAX_BBMD6_ENTRIES];
+static uint16_t FD_Table_Bucket[BBMD6_HASH_SIZE];
+static uint16_t FD_Table_Next[MAX_FD6_ENTRIES];
+static unsigned FD_Table_Count;
+/* cached Forwarded-NPDU destinations: the FDT entries, then the BDT */
+static BACNET_IP6_ADDRESS
+    BBMD6_Forward_List[MAX_FD6_ENTRIES + MAX_BBMD6_ENTRIES];
+static unsigned BBMD6_Forward_FDT_Count;
+static unsigned BBMD6_Forward_List_Count;
+static bool BBMD6_Forward_List_Valid;
+#if defined(BACNET_BIP_BATCH)
+/* the cached destinations, except the originating node */
+static BACNET_IP6_ADDRESS
+    BBMD6_Forward_Dest[MAX_FD6_ENTRIES + MAX_BBMD6_ENTRIES];
+#endif
+
+/**
+ * Hash a B/IPv6 address and port using FNV-1a
+ *
+ * @param addr - B/IPv6 address
+ * @return hash bucket of the address
+ */
+static unsigned bbmd6_hash(const BACNET_IP6_ADDRESS *addr)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned i;
+
+    for (i = 0; i < IP6_ADDRESS_MAX; i++) {
+        hash ^= addr->address[i];
+        hash *= 16777619UL;
+    }
+    hash ^= (uint8_t)(addr->port >> 8);
+    hash *= 16777619UL;
+    hash ^= (uint8_t)(addr->port & 0xFF);
+    hash *= 16777619UL;
+
+    return (unsigned)(hash & (BBMD6_HASH_SIZE - 1));
+}
+
+/**
+ * Add a table entry to the head of its hash chain
+ *
+ * @param bucket - hash buckets of the table
+ * @param next - hash chain links of the table
+ * @param index - index of the entry in the table
+ * @param addr - B/IPv6 address of the entry
+ */
+static void bbmd6_index_link(
+    uint16_t *bucket,
+    uint16_t *next,
+    unsigned index,
+    const BACNET_IP6_ADDRESS *addr)
+{
+    unsigned hash = bbmd6_hash(addr);
+
+    next[index] = bucket[hash];
+    bucket[hash] = (uint16_t)(index + 1);
+}
+
+/**
+ * Remove a table entry from its hash chain
+ *
+ * @param bucket - hash buckets of the table
+ * @param next - hash chain links of the table
+ * @param index - index of the entry in the table
+ * @param addr - B/IPv6 address of the entry
+ */
+static void bbmd6_index_unlink(
+    uint16_t *bucket,
+    uint16_t *next,
+    unsigned index,
+    const BACNET_IP6_ADDRESS *addr)
+{
+    uint16_t *link = &bucket[bbmd6_hash(addr)];
+
+    while (*link) {
+        if (*link == (index + 1)) {
+            *link = next[index];
+            break;
+        }
+        link = &next[*link - 1];
+    }
+    next[index] = 0;
+}
+
+/**
+ * Find the Broadcast Distribution Table entry of a B/IPv6 address
+ *
+ * @param addr - B/IPv6 address
+ * @return index of the entry + 1, or zero if not found
+ */
+static unsigned bbmd6_bdt_find(const BACNET_IP6_ADDRESS *addr)
+{
+    unsigned index = BBMD_Table_Bucket[bbmd6_hash(addr)];
+
+    while (index) {
+        if (!bvlc6_address_different(
+                &BBMD_Table[index - 1].bip6_address, addr)) {
+            break;
+        }
+        index = BBMD_Table_Next[index - 1];
+    }
+
+    return index;
+}
+
+/**
+ * Find the Foreign Device Table entry of a B/IPv6 address
+ *
+ * @param addr - B/IPv6 address
+ * @return index of the entry + 1, or zero if not found
+ */
+static unsigned bbmd6_fdt_find(const BACNET_IP6_ADDRESS *addr)
+{
+    unsigned index = FD_Table_Bucket[bbmd6_hash(addr)];
+
+    while (index) {
+        if (!bvlc6_address_different(&FD_Table[index - 1].bip6_address, addr)) {
+            break;
+        }
+        index = FD_Table_Next[index - 1];
+    }
+
+    return index;
+}
+
+/**
+ * Invalidate the cached Forwarded-NPDU destinations, after a change to
+ * the BDT or the FDT.
+ */
+static void bbmd6_forward_list_invalidate(void)
+{
+    BBMD6_Forward_List_Valid = false;
+}
+
+/**
+ * Remove an entry from the Foreign Device Table
+ *
+ * @param index - index of the entry in the FDT
+ */
+static void bbmd6_fdt_release(unsigned index)
+{
+    bbmd6_index_unlink(
+        FD_Table_Bucket, FD_Table_Next, index, &FD_Table[index].bip6_address);
+    FD_Table[index].valid = false;
+    FD_Table_Count--;
+    bbmd6_forward_list_invalidate();
+}
+
+/**
+ * Register a foreign device, or renew its registration
+ *
+ * @param addr - B/IPv6 address of the foreign device
+ * @param ttl_seconds - Time-to-Live requested by the foreign device
+ * @return true if the foreign device is registered
+ */
+static bool
+bbmd6_fdt_register(const BACNET_IP6_ADDRESS *addr, uint16_t ttl_seconds)
+{
+    uint32_t remaining;
+    unsigned index;
+
+    index = bbmd6_fdt_find(addr);
+    if (index) {
+        index--;
+    } else {
+        for (index = 0; index < MAX_FD6_ENTRIES; index++) {
+            if (!FD_Table[index].valid) {
+                break;
+            }
+        }
+        if (index == MAX_FD6_ENTRIES) {
+            return false;
+        }
+        bvlc6_address_copy(&FD_Table[index].bip6_address, addr);
+        FD_Table[index].valid = true;
+        bbmd6_index_link(FD_Table_Bucket, FD_Table_Next, index, addr);
+        FD_Table_Count++;
+        bbmd6_forward_list_invalidate();
+    }
+    remaining = (uint32_t)ttl_seconds + BBMD6_FD_GRACE_SECONDS;
+    if (remaining > UINT16_MAX) {
+        remaining = UINT16_MAX;
+    }
+    FD_Table[index].ttl_seconds = ttl_seconds;
+    FD_Table[index].ttl_seconds_remaining = (uint16_t)remaining;
+
+    return true;
+}
+
+/**
+ * Rebuild the cached Forwarded-NPDU destinations from the FDT and BDT,
+ * with the foreign devices first, so that the tables are only walked
+ * when they change.
+ */
+static void bbmd6_forward_list_update(void)
+{
+    BACNET_IP6_ADDRESS my_addr = { 0 };
+    unsigned count = 0;
+    unsigned i = 0; /* loop counter */
+
+    if (BBMD6_Forward_List_Valid) {
+        return;
+    }
+    bip6_get_addr(&my_addr);
+    for (i = 0; i < MAX_FD6_ENTRIES; i++) {
+        if (FD_Table[i].valid &&
+            bvlc6_address_different(&my_addr, &FD_Table[i].bip6_address)) {
+            bvlc6_address_copy(
+                &BBMD6_Forward_List[count], &FD_Table[i].bip6_address);
+            count++;
+        }
+    }
+    BBMD6_Forward_FDT_Count = count;
+    for (i = 0; i < MAX_BBMD6_ENTRIES; i++) {
+        if (BBMD_Table[i].valid &&
+            bvlc6_address_different(&my_addr, &BBMD_Table[i].bip6_address)) {
+            bvlc6_address_copy(
+                &BBMD6_Forward_List[count], &BBMD_Table[i].bip6_address);
+            count++;
+        }
+    }
+    BBMD6_Forward_List_Count = count;
+    BBMD6_Forward_List_Valid = true;
+}
+
+/**
+ * Send a Forwarded-NPDU to all Foreign Devices, and optionally to all
+ * Broadcast Devices, except the originating node.
+ *
+ * @param mtu - the encoded Forwarded-NPDU
+ * @param mtu_len - the number of bytes of the encoded Forwarded-NPDU
+ * @param origin - B/IPv6 address of the originating node, or NULL
+ * @param bdt - true to also send to the BDT entries
+ * @return number of destinations
+ */
+static unsigned bbmd6_broadcast_forward(
+    const uint8_t *mtu,
+    uint16_t mtu_len,
+    const BACNET_IP6_ADDRESS *origin,
+    bool bdt)
+{
+    unsigned count = 0;
+    unsigned dest_count = 0;
+    unsigned i = 0; /* loop counter */
+
+    if (!mtu || (mtu_len == 0)) {
+        return 0;
+    }
+    bbmd6_forward_list_update();
+    count = bdt ? BBMD6_Forward_List_Count : BBMD6_Forward_FDT_Count;
+    for (i = 0; i < count; i++) {
+        if (origin &&
+            !bvlc6_address_different(&BBMD6_Forward_List[i], origin)) {
+            /* don't forward back to origin */
+            continue;
+        }
+#if defined(BACNET_BIP_BATCH)
+        bvlc6_address_copy(
+            &BBMD6_Forward_Dest[dest_count], &BBMD6_Forward_List[i]);
+#else
+        bip6_send_mpdu(&BBMD6_Forward_List[i], mtu, mtu_len);
+#endif
+        dest_count++;
+    }
+#if defined(BACNET_BIP_BATCH)
+    if (dest_count > 0) {
+        bip6_send_mpdu_many(&BBMD6_Forward_Dest[0], dest_count, mtu, mtu_len);
+    }
+#endif
+
+    return dest_count;
+}
 #endif
 
 /**
@@ -96,7 +377,7 @@ void bvlc6_maintenance_timer(uint16_t seconds)
                     FD_Table[i].ttl_seconds_remaining -= seconds;
                 }
                 if (FD_Table[i].ttl_seconds_remaining == 0) {
-                    FD_Table[i].valid = false;
+                    bbmd6_fdt_release(i);
                 }
             }
         }
@@ -194,8 +475,9 @@ static void bbmd6_add_vmac(uint32_t device_id, const BACNET_IP6_ADDRESS *addr)
         if (!found) {
             vmac = VMAC_Find_By_Key(device_id);
             if (vmac) {
-                /* device ID already exists. Update MAC. */
-                memmove(vmac, &new_vmac, sizeof(struct vmac_data));
+                /* device ID already exists. Update MAC and its index. */
+                VMAC_Delete(device_id);
+                VMAC_Add(device_id, &new_vmac);
                 PRINTF("BVLC6: VMAC for %u [", (unsigned int)device_id);
                 for (i = 0; i < new_vmac.mac_len; i++) {
                     PRINTF("%02X", new_vmac.mac[i]);
@@ -294,6 +576,9 @@ int bvlc6_send_pdu(
     unsigned pdu_len)
 {
     BACNET_IP6_ADDRESS bvlc_dest = { 0 };
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+    BACNET_IP6_ADDRESS my_addr = { 0 };
+#endif
     uint8_t mtu[BIP6_MPDU_MAX] = { 0 };
     uint16_t mtu_len = 0;
     uint32_t vmac_src = 0;
@@ -315,6 +600,13 @@ int bvlc6_send_pdu(
         } else {
             bip6_get_broadcast_addr(&bvlc_dest);
             vmac_src = Device_Object_Instance_Number();
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+            /* as a BBMD, our own broadcasts also go to the BDT and FDT */
+            bip6_get_addr(&my_addr);
+            mtu_len = bvlc6_encode_forwarded_npdu(
+                mtu, sizeof(mtu), vmac_src, &my_addr, pdu, pdu_len);
+            bbmd6_broadcast_forward(mtu, mtu_len, NULL, true);
+#endif
             mtu_len = bvlc6_encode_original_broadcast(
                 mtu, sizeof(mtu), vmac_src, pdu, pdu_len);
             PRINTF("BVLC6: Sent Original-Broadcast-NPDU.\n");
@@ -347,62 +639,6 @@ int bvlc6_send_pdu(
     return bip6_send_mpdu(&bvlc_dest, mtu, mtu_len);
 }
 
-#if defined(BACDL_BIP6) && BBMD6_ENABLED
-/**
- * The send function for Broadcast Distribution Table
- *
- * @param addr - Points to a #BACNET_IP6_ADDRESS structure containing the
- *  source IPv6 address.
- * @param vmac_src - Source-Virtual-Address
- * @param npdu - the bytes of NPDU+APDU data to send
- * @param npdu_len - the number of bytes of NPDU+APDU data to send
- */
-static void bbmd6_send_pdu_bdt(uint8_t *mtu, unsigned int mtu_len)
-{
-    BACNET_IP6_ADDRESS my_addr = { 0 };
-    unsigned i = 0; /* loop counter */
-
-    if (mtu) {
-        bip6_get_addr(&my_addr);
-        for (i = 0; i < MAX_BBMD6_ENTRIES; i++) {
-            if (BBMD_Table[i].valid) {
-                if (bvlc6_address_different(
-                        &my_addr, &BBMD_Table[i].bip6_address)) {
-                    bip6_send_mpdu(&BBMD_Table[i].bip6_address, mtu, mtu_len);
-                }
-            }
-        }
-    }
-}
-
-/**
- * The send function for Broadcast Distribution Table
- *
- * @param addr - Points to a #BACNET_IP6_ADDRESS structure containing the
- *  source IPv6 address.
- * @param vmac_src - Source-Virtual-Address
- * @param npdu - the bytes of NPDU+APDU data to send
- * @param npdu_len - the number of bytes of NPDU+APDU data to send
- */
-static void bbmd6_send_pdu_fdt(uint8_t *mtu, unsigned int mtu_len)
-{
-    BACNET_IP6_ADDRESS my_addr = { 0 };
-    unsigned i = 0; /* loop counter */
-
-    if (mtu) {
-        bip6_get_addr(&my_addr);
-        for (i = 0; i < MAX_FD6_ENTRIES; i++) {
-            if (FD_Table[i].valid) {
-                if (bvlc6_address_different(
-                        &my_addr, &FD_Table[i].bip6_address)) {
-                    bip6_send_mpdu(&FD_Table[i].bip6_address, mtu, mtu_len);
-                }
-            }
-        }
-    }
-}
-#endif
-
 /**
  * The Result Code send function for BACnet/IPv6 application layer
  *
@@ -781,7 +1017,6 @@ int bvlc6_bbmd_disabled_handler(
 }
 
 #if defined(BACDL_BIP6) && BBMD6_ENABLED
-#warning FIXME: Needs ported to IPv6
 /**
  * Use this handler when you are a BBMD.
  * Sets the BVLC6_Function_Code in case it is needed later.
@@ -812,7 +1047,10 @@ int bvlc6_bbmd_enabled_handler(
     uint16_t npdu_len = 0;
     bool send_result = false;
     uint16_t offset = 0;
+    uint16_t ttl_seconds = 0;
+    unsigned index = 0;
     BACNET_IP6_ADDRESS fwd_address = { 0 };
+    BACNET_IP6_ADDRESS bvlc_dest = { 0 };
 
     header_len =
         bvlc6_decode_header(mtu, mtu_len, &message_type, &message_length);
@@ -836,16 +1074,63 @@ int bvlc6_bbmd_enabled_handler(
                 }
                 break;
             case BVLC6_REGISTER_FOREIGN_DEVICE:
+                PRINTF("BIP6: Received Register-Foreign-Device.\n");
                 result_code = BVLC6_RESULT_REGISTER_FOREIGN_DEVICE_NAK;
+                function_len = bvlc6_decode_register_foreign_device(
+                    pdu, pdu_len, &vmac_src, &ttl_seconds);
+                if (function_len && !bbmd6_address_match_self(addr)) {
+                    if (bbmd6_fdt_register(addr, ttl_seconds)) {
+                        bbmd6_add_vmac(vmac_src, addr);
+                        result_code = BVLC6_RESULT_SUCCESSFUL_COMPLETION;
+                    }
+                }
                 send_result = true;
                 break;
             case BVLC6_DELETE_FOREIGN_DEVICE:
+                PRINTF("BIP6: Received Delete-Foreign-Device.\n");
                 result_code = BVLC6_RESULT_DELETE_FOREIGN_DEVICE_NAK;
+                function_len = bvlc6_decode_delete_foreign_device(
+                    pdu, pdu_len, &vmac_src, &fwd_address);
+                if (function_len) {
+                    index = bbmd6_fdt_find(&fwd_address);
+                    if (index) {
+                        bbmd6_fdt_release(index - 1);
+                        result_code = BVLC6_RESULT_SUCCESSFUL_COMPLETION;
+                    }
+                }
                 send_result = true;
                 break;
             case BVLC6_DISTRIBUTE_BROADCAST_TO_NETWORK:
-                result_code = BVLC6_RESULT_DISTRIBUTE_BROADCAST_TO_NETWORK_NAK;
-                send_result = true;
+                PRINTF("BIP6: Received Distribute-Broadcast-To-Network.\n");
+                function_len = bvlc6_decode_distribute_broadcast_to_network(
+                    pdu, pdu_len, &vmac_src, NULL, 0, &npdu_len);
+                if (!function_len || !bbmd6_fdt_find(addr)) {
+                    /* only registered foreign devices may distribute */
+                    result_code =
+                        BVLC6_RESULT_DISTRIBUTE_BROADCAST_TO_NETWORK_NAK;
+                    send_result = true;
+                    break;
+                }
+                offset = header_len + (function_len - npdu_len);
+                npdu = &mtu[offset];
+                /*  Upon receipt of a BVLL Distribute-Broadcast-To-Network
+                    message from a registered foreign device, the receiving
+                    BBMD shall transmit a BVLL Forwarded-NPDU message via
+                    multicast to the local multicast domain, and unicast it
+                    to each entry in its BDT and to each foreign device in
+                    its FDT except the originating node. */
+                BVLC6_Buffer_Len = bvlc6_encode_forwarded_npdu(
+                    &BVLC6_Buffer[0], sizeof(BVLC6_Buffer), vmac_src, addr,
+                    npdu, npdu_len);
+                bip6_get_broadcast_addr(&bvlc_dest);
+                bip6_send_mpdu(&bvlc_dest, &BVLC6_Buffer[0], BVLC6_Buffer_Len);
+                bbmd6_broadcast_forward(
+                    &BVLC6_Buffer[0], BVLC6_Buffer_Len, addr, true);
+                bbmd6_add_vmac(vmac_src, addr);
+                bvlc6_vmac_address_set(src, vmac_src);
+                if (npdu_confirmed_service(npdu, npdu_len)) {
+                    offset = 0;
+                }
                 break;
             case BVLC6_ORIGINAL_UNICAST_NPDU:
                 /* This message is used to send directed NPDUs to
@@ -902,8 +1187,8 @@ int bvlc6_bbmd_enabled_handler(
                         BVLC6_Buffer_Len = bvlc6_encode_forwarded_npdu(
                             &BVLC6_Buffer[0], sizeof(BVLC6_Buffer), vmac_src,
                             addr, npdu, npdu_len);
-                        bbmd6_send_pdu_bdt(&BVLC6_Buffer[0], BVLC6_Buffer_Len);
-                        bbmd6_send_pdu_fdt(&BVLC6_Buffer[0], BVLC6_Buffer_Len);
+                        bbmd6_broadcast_forward(
+                            &BVLC6_Buffer[0], BVLC6_Buffer_Len, addr, true);
                     }
                     if (!bbmd6_address_match_self(addr)) {
                         /* The Virtual MAC address table shall be updated
@@ -916,36 +1201,45 @@ int bvlc6_bbmd_enabled_handler(
                 break;
             case BVLC6_FORWARDED_NPDU:
                 PRINTF("BIP6: Received Forwarded-NPDU.\n");
+                if (bbmd6_address_match_self(addr)) {
+                    /* our own multicast of a Forwarded-NPDU */
+                    break;
+                }
                 function_len = bvlc6_decode_forwarded_npdu(
                     pdu, pdu_len, &vmac_src, &fwd_address, NULL, 0, &npdu_len);
                 if (function_len) {
+                    if (bbmd6_address_match_self(&fwd_address)) {
+                        /* ignore forwards of my own broadcasts */
+                        break;
+                    }
                     offset = header_len + (function_len - npdu_len);
                     npdu = &mtu[offset];
-                    /*  Upon receipt of a BVLL Forwarded-NPDU message
-                        from a BBMD which is in the receiving BBMD's BDT,
-                        a BBMD shall construct a BVLL Forwarded-NPDU and
-                        transmit it via multicast to B/IPv6 devices in the
-                        local multicast domain. */
-                    BVLC6_Buffer_Len = bvlc6_encode_forwarded_npdu(
-                        &BVLC6_Buffer[0], sizeof(BVLC6_Buffer), vmac_src, addr,
-                        npdu, npdu_len);
-                    bip6_get_broadcast_addr(&bvlc_dest);
-                    bip6_send_mpdu(
-                        &bvlc_dest, &BVLC6_Buffer[0], BVLC6_Buffer_Len);
-                    /*  In addition, the constructed BVLL Forwarded-NPDU
-                        message shall be unicast to each foreign device in
-                        the BBMD's FDT. If the BBMD is unable to transmit
-                        the Forwarded-NPDU, or the message was not received
-                        from a BBMD which is in the receiving BBMD's BDT,
-                        no BVLC-Result shall be returned and the message
-                        shall be discarded. */
-                    bbmd6_send_pdu_fdt(&BVLC6_Buffer[0], BVLC6_Buffer_Len);
-                    if (!bbmd6_address_match_self(addr)) {
-                        /* The Virtual MAC address table shall be updated
-                           using the respective parameter values of the
-                           incoming messages. */
-                        bbmd6_add_vmac(vmac_src, &fwd_address);
-                        bvlc6_vmac_address_set(src, vmac_src);
+                    if (bbmd6_bdt_find(addr)) {
+                        /*  Upon receipt of a BVLL Forwarded-NPDU message
+                            from a BBMD which is in the receiving BBMD's
+                            BDT, a BBMD shall construct a BVLL
+                            Forwarded-NPDU and transmit it via multicast to
+                            B/IPv6 devices in the local multicast domain.
+                            In addition, the constructed BVLL Forwarded-NPDU
+                            message shall be unicast to each foreign device
+                            in the BBMD's FDT. */
+                        BVLC6_Buffer_Len = bvlc6_encode_forwarded_npdu(
+                            &BVLC6_Buffer[0], sizeof(BVLC6_Buffer), vmac_src,
+                            &fwd_address, npdu, npdu_len);
+                        bip6_get_broadcast_addr(&bvlc_dest);
+                        bip6_send_mpdu(
+                            &bvlc_dest, &BVLC6_Buffer[0], BVLC6_Buffer_Len);
+                        bbmd6_broadcast_forward(
+                            &BVLC6_Buffer[0], BVLC6_Buffer_Len, &fwd_address,
+                            false);
+                    }
+                    /* The Virtual MAC address table shall be updated
+                       using the respective parameter values of the
+                       incoming messages. */
+                    bbmd6_add_vmac(vmac_src, &fwd_address);
+                    bvlc6_vmac_address_set(src, vmac_src);
+                    if (npdu_confirmed_service(npdu, npdu_len)) {
+                        offset = 0;
                     }
                 }
                 break;
@@ -1080,6 +1374,95 @@ uint8_t bvlc6_get_function_code(void)
     return BVLC6_Function_Code;
 }
 
+/**
+ * Add a peer BBMD to the Broadcast Distribution Table
+ *
+ * @param addr - B/IPv6 address of the peer BBMD
+ * @return true if the peer BBMD is in the BDT
+ */
+bool bvlc6_bdt_entry_add(const BACNET_IP6_ADDRESS *addr)
+{
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+    unsigned index;
+
+    if (!addr) {
+        return false;
+    }
+    if (bbmd6_bdt_find(addr)) {
+        return true;
+    }
+    for (index = 0; index < MAX_BBMD6_ENTRIES; index++) {
+        if (!BBMD_Table[index].valid) {
+            bvlc6_address_copy(&BBMD_Table[index].bip6_address, addr);
+            BBMD_Table[index].valid = true;
+            bbmd6_index_link(BBMD_Table_Bucket, BBMD_Table_Next, index, addr);
+            bbmd6_forward_list_invalidate();
+            return true;
+        }
+    }
+#else
+    (void)addr;
+#endif
+
+    return false;
+}
+
+/**
+ * Remove a peer BBMD from the Broadcast Distribution Table
+ *
+ * @param addr - B/IPv6 address of the peer BBMD
+ * @return true if the peer BBMD was in the BDT
+ */
+bool bvlc6_bdt_entry_delete(const BACNET_IP6_ADDRESS *addr)
+{
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+    unsigned index;
+
+    if (!addr) {
+        return false;
+    }
+    index = bbmd6_bdt_find(addr);
+    if (index) {
+        index--;
+        bbmd6_index_unlink(BBMD_Table_Bucket, BBMD_Table_Next, index, addr);
+        BBMD_Table[index].valid = false;
+        bbmd6_forward_list_invalidate();
+        return true;
+    }
+#else
+    (void)addr;
+#endif
+
+    return false;
+}
+
+/**
+ * Remove every peer BBMD from the Broadcast Distribution Table
+ */
+void bvlc6_bdt_list_clear(void)
+{
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+    memset(&BBMD_Table, 0, sizeof(BBMD_Table));
+    memset(&BBMD_Table_Bucket, 0, sizeof(BBMD_Table_Bucket));
+    memset(&BBMD_Table_Next, 0, sizeof(BBMD_Table_Next));
+    bbmd6_forward_list_invalidate();
+#endif
+}
+
+/**
+ * Get the number of foreign devices that are registered with us
+ *
+ * @return number of Foreign Device Table entries
+ */
+unsigned bvlc6_fdt_count(void)
+{
+#if defined(BACDL_BIP6) && BBMD6_ENABLED
+    return FD_Table_Count;
+#else
+    return 0;
+#endif
+}
+
 /**
  * Cleanup any memory usage
  */
@@ -1099,7 +1482,10 @@ void bvlc6_init(void)
     bvlc6_address_set(
         &Remote_BBMD, 0, 0, 0, 0, 0, 0, 0, BIP6_MULTICAST_GROUP_ID);
 #if defined(BACDL_BIP6) && BBMD6_ENABLED
-    memset(&BBMD_Table, 0, sizeof(BBMD_Table));
+    bvlc6_bdt_list_clear();
     memset(&FD_Table, 0, sizeof(FD_Table));
+    memset(&FD_Table_Bucket, 0, sizeof(FD_Table_Bucket));
+    memset(&FD_Table_Next, 0, sizeof(FD_Table_Next));
+    FD_Table_Count = 0;
 #endif
 }
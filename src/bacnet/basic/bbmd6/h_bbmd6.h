@@ -68,6 +68,15 @@ uint8_t bvlc6_get_function_code(void);
 BACNET_STACK_EXPORT
 void bvlc6_maintenance_timer(uint16_t seconds);
 
+BACNET_STACK_EXPORT
+bool bvlc6_bdt_entry_add(const BACNET_IP6_ADDRESS *addr);
+BACNET_STACK_EXPORT
+bool bvlc6_bdt_entry_delete(const BACNET_IP6_ADDRESS *addr);
+BACNET_STACK_EXPORT
+void bvlc6_bdt_list_clear(void);
+BACNET_STACK_EXPORT
+unsigned bvlc6_fdt_count(void);
+
 BACNET_STACK_EXPORT
 void bvlc6_debug_enable(void);
 
@@ -36,6 +36,73 @@ void VMAC_Debug_Enable(void)
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist VMAC_List;
 
+/* number of buckets in the reverse lookup index by VMAC address */
+#ifndef VMAC_HASH_SIZE
+#define VMAC_HASH_SIZE 256
+#endif
+
+/* The Key List data, which is also linked into a hash index by the
+   VMAC address so that a received packet can find its device ID
+   without scanning the whole list. */
+struct vmac_entry {
+    /* first, so the Key List data is also the VMAC data */
+    struct vmac_data vmac;
+    uint32_t device_id;
+    struct vmac_entry *next;
+};
+static struct vmac_entry *VMAC_Hash[VMAC_HASH_SIZE];
+
+/**
+ * @brief Compute the hash index bucket of a VMAC address
+ * @param vmac - VMAC address
+ * @return the bucket number
+ */
+static unsigned vmac_hash_bucket(const struct vmac_data *vmac)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned int mac_len = VMAC_MAC_MAX;
+    unsigned int i;
+
+    if (vmac->mac_len < mac_len) {
+        mac_len = vmac->mac_len;
+    }
+    for (i = 0; i < mac_len; i++) {
+        hash = (hash ^ vmac->mac[i]) * 16777619UL;
+    }
+
+    return (unsigned)(hash % VMAC_HASH_SIZE);
+}
+
+/**
+ * @brief Add an entry to the hash index
+ * @param entry - the Key List data
+ */
+static void vmac_hash_link(struct vmac_entry *entry)
+{
+    unsigned bucket = vmac_hash_bucket(&entry->vmac);
+
+    entry->next = VMAC_Hash[bucket];
+    VMAC_Hash[bucket] = entry;
+}
+
+/**
+ * @brief Remove an entry from the hash index
+ * @param entry - the Key List data
+ */
+static void vmac_hash_unlink(const struct vmac_entry *entry)
+{
+    struct vmac_entry **link;
+
+    link = &VMAC_Hash[vmac_hash_bucket(&entry->vmac)];
+    while (*link) {
+        if (*link == entry) {
+            *link = entry->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
 /**
  * Returns the number of VMAC in the list
  */
@@ -55,30 +122,34 @@ unsigned int VMAC_Count(void)
 bool VMAC_Add(uint32_t device_id, const struct vmac_data *src)
 {
     bool status = false;
-    struct vmac_data *pVMAC = NULL;
+    struct vmac_entry *pVMAC = NULL;
     int index = 0;
     size_t i = 0;
 
     pVMAC = Keylist_Data(VMAC_List, device_id);
     if (!pVMAC) {
-        pVMAC = calloc(1, sizeof(struct vmac_data));
+        pVMAC = calloc(1, sizeof(struct vmac_entry));
         if (pVMAC) {
             /* copy the MAC into the data store */
-            for (i = 0; i < sizeof(pVMAC->mac); i++) {
+            for (i = 0; i < sizeof(pVMAC->vmac.mac); i++) {
                 if (i < src->mac_len) {
-                    pVMAC->mac[i] = src->mac[i];
+                    pVMAC->vmac.mac[i] = src->mac[i];
                 } else {
                     break;
                 }
             }
-            pVMAC->mac_len = src->mac_len;
+            pVMAC->vmac.mac_len = src->mac_len;
+            pVMAC->device_id = device_id;
             index = Keylist_Data_Add(VMAC_List, device_id, pVMAC);
             if (index >= 0) {
+                vmac_hash_link(pVMAC);
                 status = true;
                 if (VMAC_Debug) {
                     debug_fprintf(
                         stderr, "VMAC %u added.\n", (unsigned int)device_id);
                 }
+            } else {
+                free(pVMAC);
             }
         }
     }
@@ -96,10 +167,11 @@ bool VMAC_Add(uint32_t device_id, const struct vmac_data *src)
 bool VMAC_Delete(uint32_t device_id)
 {
     bool status = false;
-    struct vmac_data *pVMAC;
+    struct vmac_entry *pVMAC;
 
     pVMAC = Keylist_Data_Delete(VMAC_List, device_id);
     if (pVMAC) {
+        vmac_hash_unlink(pVMAC);
         free(pVMAC);
         status = true;
     }
@@ -112,11 +184,19 @@ bool VMAC_Delete(uint32_t device_id)
  *
  * @param device_id - BACnet device object instance number
  *
- * @return pointer to the VMAC data from the list
+ * @return pointer to the VMAC data from the list.  The VMAC address is
+ *  indexed, so use VMAC_Delete() and VMAC_Add() to change it.
  */
 struct vmac_data *VMAC_Find_By_Key(uint32_t device_id)
 {
-    return Keylist_Data(VMAC_List, device_id);
+    struct vmac_entry *pVMAC;
+
+    pVMAC = Keylist_Data(VMAC_List, device_id);
+    if (pVMAC) {
+        return &pVMAC->vmac;
+    }
+
+    return NULL;
 }
 
 /**
@@ -232,25 +312,23 @@ bool VMAC_Match(const struct vmac_data *vmac1, const struct vmac_data *vmac2)
  */
 bool VMAC_Find_By_Data(const struct vmac_data *vmac, uint32_t *device_id)
 {
-    bool status = false;
-    struct vmac_data *list_vmac;
-    int count = 0;
-    int index = 0;
+    const struct vmac_entry *pVMAC;
 
-    count = Keylist_Count(VMAC_List);
-    while (count) {
-        index = count - 1;
-        list_vmac = Keylist_Data_Index(VMAC_List, index);
-        if (list_vmac) {
-            if (VMAC_Match(vmac, list_vmac)) {
-                status = Keylist_Index_Key(VMAC_List, index, device_id);
-                break;
+    if (!vmac) {
+        return false;
+    }
+    pVMAC = VMAC_Hash[vmac_hash_bucket(vmac)];
+    while (pVMAC) {
+        if (VMAC_Match(vmac, &pVMAC->vmac)) {
+            if (device_id) {
+                *device_id = pVMAC->device_id;
             }
+            return true;
         }
-        count--;
+        pVMAC = pVMAC->next;
     }
 
-    return status;
+    return false;
 }
 
 /**
@@ -258,7 +336,7 @@ bool VMAC_Find_By_Data(const struct vmac_data *vmac, uint32_t *device_id)
  */
 void VMAC_Cleanup(void)
 {
-    struct vmac_data *pVMAC;
+    struct vmac_entry *pVMAC;
     const int index = 0;
     unsigned i = 0;
 
@@ -274,8 +352,8 @@ void VMAC_Cleanup(void)
                     debug_fprintf(
                         stderr, "VMAC List: %lu [", (unsigned long)device_id);
                     /* print the MAC */
-                    for (i = 0; i < pVMAC->mac_len; i++) {
-                        debug_fprintf(stderr, "%02X", pVMAC->mac[i]);
+                    for (i = 0; i < pVMAC->vmac.mac_len; i++) {
+                        debug_fprintf(stderr, "%02X", pVMAC->vmac.mac[i]);
                     }
                     debug_fprintf(stderr, "]\n");
                 }
@@ -284,6 +362,9 @@ void VMAC_Cleanup(void)
         } while (pVMAC);
         Keylist_Delete(VMAC_List);
         VMAC_List = NULL;
+        for (i = 0; i < VMAC_HASH_SIZE; i++) {
+            VMAC_Hash[i] = NULL;
+        }
     }
 }
 
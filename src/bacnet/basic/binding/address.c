@@ -10,13 +10,17 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/bacaddr.h"
 #include "bacnet/bacdcode.h"
+#include "bacnet/bacint.h"
 #include "bacnet/readrange.h"
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/sys/mempool.h"
 
 /* we are likely compiling the demo command line tools if print enabled */
 #if !defined(BACNET_ADDRESS_CACHE_FILE)
@@ -29,9 +33,6 @@
 /* occurs in BACnet.  A device id is bound to a MAC address. */
 /* The normal method is using Who-Is, and using the data from I-Am */
 
-static uint32_t Top_Protected_Entry;
-static uint32_t Own_Device_ID = 0xFFFFFFFF;
-
 /* The address cache is used for binding to BACnet devices */
 /* The number of entries corresponds to the number of */
 /* devices that might respond to an I-Am on the network. */
@@ -41,13 +42,66 @@ static uint32_t Own_Device_ID = 0xFFFFFFFF;
 #define MAX_ADDRESS_CACHE 255
 #endif
 
-static struct Address_Cache_Entry {
+/* The device-id and MAC address hash indices and the time-to-live heap */
+/* keep the lookups and the timer from scanning the whole cache. */
+#if !defined(ADDRESS_CACHE_HASH_SIZE)
+#define ADDRESS_CACHE_HASH_SIZE MAX_ADDRESS_CACHE
+#endif
+
+/* binary snapshot of the bound entries, for warm restarts */
+#define ADDRESS_SNAPSHOT_MAGIC 0x42414443UL
+#define ADDRESS_SNAPSHOT_VERSION 1
+#define ADDRESS_SNAPSHOT_HEADER_SIZE 20
+/* device-id, max-apdu, TTL, flags, net, mac_len, mac, len, adr */
+#define ADDRESS_SNAPSHOT_RECORD_SIZE \
+    (4 + 4 + 4 + 1 + 2 + 1 + MAX_MAC_LEN + 1 + MAX_MAC_LEN)
+
+struct Address_Cache_Entry {
     uint8_t Flags;
     uint32_t device_id;
     unsigned max_apdu;
     BACNET_ADDRESS address;
-    uint32_t TimeToLive;
-} Address_Cache[MAX_ADDRESS_CACHE];
+    /* cache clock time, in seconds, when this entry expires */
+    uint32_t Expires;
+    /* index links are entry index + 1, and zero means none */
+    unsigned device_next;
+    unsigned mac_next;
+    unsigned heap_position;
+    uint32_t mac_hash;
+    bool device_linked : 1;
+    bool mac_linked : 1;
+};
+
+/* the state of one address cache, so that each stack context binds
+   its own devices */
+struct address_context {
+    struct Address_Cache_Entry Cache[MAX_ADDRESS_CACHE];
+    uint32_t Top_Protected_Entry;
+    /* our own device, which is never bound, if set */
+    uint32_t Own_Device_ID;
+    bool Own_Device_ID_Set;
+    /* hash buckets for the device-id and MAC address indices */
+    unsigned Device_Bucket[ADDRESS_CACHE_HASH_SIZE];
+    unsigned MAC_Bucket[ADDRESS_CACHE_HASH_SIZE];
+    /* binary min-heap of entry index + 1 ordered by the time of expiry */
+    unsigned TTL_Heap[MAX_ADDRESS_CACHE];
+    unsigned TTL_Heap_Count;
+    /* cache clock, in seconds, advanced by address_cache_timer() */
+    uint32_t Seconds;
+    /* lookups that found a bound entry, and lookups that did not */
+    unsigned long Hits;
+    unsigned long Misses;
+    /* periodic snapshot of the bound entries, if a file is set */
+    const char *Snapshot_Pathname;
+    uint32_t Snapshot_Interval;
+    uint32_t Snapshot_Elapsed;
+    bool Snapshot_Dirty;
+};
+
+static struct address_context Address_Default;
+/* the address cache of the calling thread */
+static BACNET_STACK_THREAD_LOCAL struct address_context *Address =
+    &Address_Default;
 
 /* State flags for cache entries */
 
@@ -69,6 +123,346 @@ static struct Address_Cache_Entry {
 #define BAC_ADDR_SHORT_TIME BAC_ADDR_SECS_1HOUR
 #define BAC_ADDR_FOREVER 0xFFFFFFFF /* Permanent entry */
 
+/**
+ * @brief Compute the hash of a BACnet address using the same fields
+ *  that bacnet_address_same() compares.
+ * @param src  Pointer to the BACnet address
+ * @return hash value
+ */
+static uint32_t address_mac_hash(const BACNET_ADDRESS *src)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t i, len;
+
+    len = src->mac_len;
+    if (len > MAX_MAC_LEN) {
+        len = MAX_MAC_LEN;
+    }
+    hash = (hash ^ src->mac_len) * 16777619UL;
+    for (i = 0; i < len; i++) {
+        hash = (hash ^ src->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (src->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (src->net >> 8)) * 16777619UL;
+    if (src->net) {
+        len = src->len;
+        if (len > MAX_MAC_LEN) {
+            len = MAX_MAC_LEN;
+        }
+        hash = (hash ^ src->len) * 16777619UL;
+        for (i = 0; i < len; i++) {
+            hash = (hash ^ src->adr[i]) * 16777619UL;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Remove an entry from a hash chain
+ * @param link  Pointer to the bucket of the chain
+ * @param entry  entry index + 1 to be removed
+ * @param next_mac  true to follow the MAC address chain, false to follow
+ *  the device-id chain
+ */
+static void address_chain_unlink(unsigned *link, unsigned entry, bool next_mac)
+{
+    struct Address_Cache_Entry *pMatch;
+
+    while (*link) {
+        pMatch = &Address->Cache[*link - 1];
+        if (*link == entry) {
+            if (next_mac) {
+                *link = pMatch->mac_next;
+                pMatch->mac_next = 0;
+            } else {
+                *link = pMatch->device_next;
+                pMatch->device_next = 0;
+            }
+            break;
+        }
+        if (next_mac) {
+            link = &pMatch->mac_next;
+        } else {
+            link = &pMatch->device_next;
+        }
+    }
+}
+
+/**
+ * @brief Add or remove an entry in the device-id index
+ * @param pMatch  Pointer to the entry
+ * @param linked  true to add the entry to the index, false to remove it
+ */
+static void address_device_index(struct Address_Cache_Entry *pMatch, bool linked)
+{
+    unsigned entry = (unsigned)(pMatch - Address->Cache) + 1;
+    unsigned bucket = pMatch->device_id % ADDRESS_CACHE_HASH_SIZE;
+
+    if (pMatch->device_linked) {
+        address_chain_unlink(&Address->Device_Bucket[bucket], entry, false);
+        pMatch->device_linked = false;
+    }
+    if (linked) {
+        pMatch->device_next = Address->Device_Bucket[bucket];
+        Address->Device_Bucket[bucket] = entry;
+        pMatch->device_linked = true;
+    }
+}
+
+/**
+ * @brief Add or remove an entry in the MAC address index
+ * @param pMatch  Pointer to the entry
+ * @param linked  true to add the entry to the index, false to remove it
+ */
+static void address_mac_index(struct Address_Cache_Entry *pMatch, bool linked)
+{
+    unsigned entry = (unsigned)(pMatch - Address->Cache) + 1;
+    unsigned bucket;
+
+    if (pMatch->mac_linked) {
+        bucket = pMatch->mac_hash % ADDRESS_CACHE_HASH_SIZE;
+        address_chain_unlink(&Address->MAC_Bucket[bucket], entry, true);
+        pMatch->mac_linked = false;
+    }
+    if (linked) {
+        pMatch->mac_hash = address_mac_hash(&pMatch->address);
+        bucket = pMatch->mac_hash % ADDRESS_CACHE_HASH_SIZE;
+        pMatch->mac_next = Address->MAC_Bucket[bucket];
+        Address->MAC_Bucket[bucket] = entry;
+        pMatch->mac_linked = true;
+    }
+}
+
+/**
+ * @brief Swap two positions in the time-to-live heap
+ * @param a  heap position [0..n-1]
+ * @param b  heap position [0..n-1]
+ */
+static void address_heap_swap(unsigned a, unsigned b)
+{
+    unsigned entry = Address->TTL_Heap[a];
+
+    Address->TTL_Heap[a] = Address->TTL_Heap[b];
+    Address->TTL_Heap[b] = entry;
+    Address->Cache[Address->TTL_Heap[a] - 1].heap_position = a + 1;
+    Address->Cache[Address->TTL_Heap[b] - 1].heap_position = b + 1;
+}
+
+/**
+ * @brief Get the expiry time of an entry at a position in the heap
+ * @param position  heap position [0..n-1]
+ * @return cache clock time when the entry expires
+ */
+static uint32_t address_heap_expires(unsigned position)
+{
+    return Address->Cache[Address->TTL_Heap[position] - 1].Expires;
+}
+
+/**
+ * @brief Restore the heap order around a position in the heap
+ * @param position  heap position [0..n-1]
+ */
+static void address_heap_sift(unsigned position)
+{
+    unsigned parent, child;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (address_heap_expires(parent) <= address_heap_expires(position)) {
+            break;
+        }
+        address_heap_swap(parent, position);
+        position = parent;
+    }
+    for (;;) {
+        child = (position * 2) + 1;
+        if (child >= Address->TTL_Heap_Count) {
+            break;
+        }
+        if (((child + 1) < Address->TTL_Heap_Count) &&
+            (address_heap_expires(child + 1) < address_heap_expires(child))) {
+            child++;
+        }
+        if (address_heap_expires(position) <= address_heap_expires(child)) {
+            break;
+        }
+        address_heap_swap(position, child);
+        position = child;
+    }
+}
+
+/**
+ * @brief Remove an entry from the time-to-live heap
+ * @param pMatch  Pointer to the entry
+ */
+static void address_heap_remove(struct Address_Cache_Entry *pMatch)
+{
+    unsigned position;
+
+    if (pMatch->heap_position) {
+        position = pMatch->heap_position - 1;
+        Address->TTL_Heap_Count--;
+        if (position != Address->TTL_Heap_Count) {
+            address_heap_swap(position, Address->TTL_Heap_Count);
+            pMatch->heap_position = 0;
+            address_heap_sift(position);
+        }
+        pMatch->heap_position = 0;
+    }
+}
+
+/**
+ * @brief Get the remaining time to live of an entry
+ * @param pMatch  Pointer to the entry
+ * @return time to live in seconds
+ */
+static uint32_t address_entry_ttl(const struct Address_Cache_Entry *pMatch)
+{
+    if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
+        return BAC_ADDR_FOREVER;
+    }
+    if (pMatch->Expires > Address->Seconds) {
+        return pMatch->Expires - Address->Seconds;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Set the time to live of an entry, and keep the entry in the
+ *  time-to-live heap unless it is static.
+ * @param pMatch  Pointer to the entry
+ * @param ttl  time to live in seconds
+ */
+static void
+address_entry_ttl_set(struct Address_Cache_Entry *pMatch, uint32_t ttl)
+{
+    if (ttl > (UINT32_MAX - Address->Seconds)) {
+        pMatch->Expires = UINT32_MAX;
+    } else {
+        pMatch->Expires = Address->Seconds + ttl;
+    }
+    if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
+        address_heap_remove(pMatch);
+    } else if (pMatch->heap_position) {
+        address_heap_sift(pMatch->heap_position - 1);
+    } else {
+        Address->TTL_Heap[Address->TTL_Heap_Count] =
+            (unsigned)(pMatch - Address->Cache) + 1;
+        pMatch->heap_position = Address->TTL_Heap_Count + 1;
+        Address->TTL_Heap_Count++;
+        address_heap_sift(Address->TTL_Heap_Count - 1);
+    }
+}
+
+/**
+ * @brief Set the device-id of an entry and update the index
+ * @param pMatch  Pointer to the entry
+ * @param device_id  Device-Id
+ */
+static void
+address_entry_device_set(struct Address_Cache_Entry *pMatch, uint32_t device_id)
+{
+    address_device_index(pMatch, false);
+    pMatch->device_id = device_id;
+    address_device_index(pMatch, true);
+    Address->Snapshot_Dirty = true;
+}
+
+/**
+ * @brief Set the address of an entry and update the index
+ * @param pMatch  Pointer to the entry
+ * @param src  Pointer to the BACnet address
+ */
+static void address_entry_address_set(
+    struct Address_Cache_Entry *pMatch, const BACNET_ADDRESS *src)
+{
+    address_mac_index(pMatch, false);
+    bacnet_address_copy(&pMatch->address, src);
+    address_mac_index(pMatch, true);
+    Address->Snapshot_Dirty = true;
+}
+
+/**
+ * @brief Release an entry and remove it from the indices
+ * @param pMatch  Pointer to the entry
+ * @param flags  new flags for the entry, zero or BAC_ADDR_RESERVED
+ */
+static void
+address_entry_release(struct Address_Cache_Entry *pMatch, uint8_t flags)
+{
+    address_device_index(pMatch, false);
+    address_mac_index(pMatch, false);
+    address_heap_remove(pMatch);
+    pMatch->Flags = flags;
+    Address->Snapshot_Dirty = true;
+}
+
+/**
+ * @brief Find the entry in use for a device-id
+ * @param device_id  Device-Id
+ * @return Pointer to the entry, or NULL if not found
+ */
+static struct Address_Cache_Entry *address_device_find(uint32_t device_id)
+{
+    struct Address_Cache_Entry *pMatch;
+    struct Address_Cache_Entry *pCandidate = NULL;
+    unsigned entry;
+
+    entry = Address->Device_Bucket[device_id % ADDRESS_CACHE_HASH_SIZE];
+    while (entry) {
+        pMatch = &Address->Cache[entry - 1];
+        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
+            (pMatch->device_id == device_id)) {
+            /* the first entry in the table wins, as in a linear search */
+            if (!pCandidate || (pMatch < pCandidate)) {
+                pCandidate = pMatch;
+            }
+        }
+        entry = pMatch->device_next;
+    }
+
+    return pCandidate;
+}
+
+/**
+ * @brief Rebuild the indices from the entries in the cache
+ */
+static void address_index_rebuild(void)
+{
+    struct Address_Cache_Entry *pMatch;
+    unsigned index;
+
+    for (index = 0; index < ADDRESS_CACHE_HASH_SIZE; index++) {
+        Address->Device_Bucket[index] = 0;
+        Address->MAC_Bucket[index] = 0;
+    }
+    Address->TTL_Heap_Count = 0;
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address->Cache[index];
+        pMatch->device_next = 0;
+        pMatch->mac_next = 0;
+        pMatch->heap_position = 0;
+        pMatch->device_linked = false;
+        pMatch->mac_linked = false;
+    }
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address->Cache[index];
+        if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
+            address_device_index(pMatch, true);
+            address_mac_index(pMatch, true);
+        }
+        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) != 0) &&
+            ((pMatch->Flags & BAC_ADDR_STATIC) == 0)) {
+            Address->TTL_Heap[Address->TTL_Heap_Count] = index + 1;
+            pMatch->heap_position = Address->TTL_Heap_Count + 1;
+            Address->TTL_Heap_Count++;
+            address_heap_sift(Address->TTL_Heap_Count - 1);
+        }
+    }
+}
+
 /**
  * @brief Set the index of the first (top) address being protected.
  *
@@ -77,7 +471,7 @@ static struct Address_Cache_Entry {
 void address_protected_entry_index_set(uint32_t top_protected_entry_index)
 {
     if (top_protected_entry_index < MAX_ADDRESS_CACHE) {
-        Top_Protected_Entry = top_protected_entry_index;
+        Address->Top_Protected_Entry = top_protected_entry_index;
     }
 }
 
@@ -88,7 +482,8 @@ void address_protected_entry_index_set(uint32_t top_protected_entry_index)
  */
 void address_own_device_id_set(uint32_t own_id)
 {
-    Own_Device_ID = own_id;
+    Address->Own_Device_ID = own_id;
+    Address->Own_Device_ID_Set = true;
 }
 
 /**
@@ -101,15 +496,12 @@ void address_remove_device(uint32_t device_id)
     struct Address_Cache_Entry *pMatch;
     uint32_t index = 0;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->Flags = 0;
-            if (index < Top_Protected_Entry) {
-                Top_Protected_Entry--;
-            }
-            break;
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
+        index = (uint32_t)(pMatch - Address->Cache);
+        address_entry_release(pMatch, 0);
+        if (index < Address->Top_Protected_Entry) {
+            Address->Top_Protected_Entry--;
         }
     }
 
@@ -133,7 +525,7 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
     unsigned index;
 
     pCandidate = NULL;
-    if (Top_Protected_Entry > (MAX_ADDRESS_CACHE - 1)) {
+    if (Address->Top_Protected_Entry > (MAX_ADDRESS_CACHE - 1)) {
         return pCandidate;
     }
     /* Longest possible non static time to live */
@@ -141,14 +533,15 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
 
     /* First pass - try only in use and bound entries */
 
-    for (index = Top_Protected_Entry; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+    for (index = Address->Top_Protected_Entry; index < MAX_ADDRESS_CACHE;
+         index++) {
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags &
              (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
             BAC_ADDR_IN_USE) {
-            if (pMatch->TimeToLive <= ulTime) {
+            if (address_entry_ttl(pMatch) <= ulTime) {
                 /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
+                ulTime = address_entry_ttl(pMatch);
                 pCandidate = pMatch;
             }
         }
@@ -156,20 +549,21 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
 
     if (pCandidate != NULL) {
         /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
+        address_entry_release(pCandidate, BAC_ADDR_RESERVED);
         /* only reserve it for a short while */
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
+        address_entry_ttl_set(pCandidate, BAC_ADDR_SHORT_TIME);
         return (pCandidate);
     }
 
     /* Second pass - try in use and un bound as last resort */
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags &
              (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
             ((uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
+            if (address_entry_ttl(pMatch) <= ulTime) {
+                /* Shorter lived entry found */
+                ulTime = address_entry_ttl(pMatch);
                 pCandidate = pMatch;
             }
         }
@@ -177,9 +571,9 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
 
     if (pCandidate != NULL) {
         /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
+        address_entry_release(pCandidate, BAC_ADDR_RESERVED);
         /* only reserve it for a short while */
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
+        address_entry_ttl_set(pCandidate, BAC_ADDR_SHORT_TIME);
     }
 
     return (pCandidate);
@@ -257,11 +651,15 @@ void address_init(void)
     struct Address_Cache_Entry *pMatch;
     unsigned index;
 
-    Top_Protected_Entry = 0;
+    Address->Top_Protected_Entry = 0;
+    Address->Seconds = 0;
+    Address->Hits = 0;
+    Address->Misses = 0;
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         pMatch->Flags = 0;
     }
+    address_index_rebuild();
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -281,11 +679,11 @@ void address_init_partial(void)
     unsigned index;
 
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
             /* It's in use so let's check further */
             if (((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) ||
-                (pMatch->TimeToLive == 0)) {
+                (address_entry_ttl(pMatch) == 0)) {
                 pMatch->Flags = 0;
             }
         }
@@ -295,6 +693,7 @@ void address_init_partial(void)
             pMatch->Flags = 0;
         }
     }
+    address_index_rebuild();
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -316,27 +715,36 @@ void address_set_device_TTL(
     uint32_t device_id, uint32_t TimeOut, bool StaticFlag)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then we have either static or normaal */
-                if (StaticFlag) {
-                    pMatch->Flags |= BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = BAC_ADDR_FOREVER;
-                } else {
-                    pMatch->Flags &= ~BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = TimeOut;
-                }
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* If bound then we have either static or normaal */
+            if (StaticFlag) {
+                pMatch->Flags |= BAC_ADDR_STATIC;
+                address_entry_ttl_set(pMatch, BAC_ADDR_FOREVER);
             } else {
-                /* For unbound we can only set the time to live */
-                pMatch->TimeToLive = TimeOut;
+                pMatch->Flags &= ~BAC_ADDR_STATIC;
+                address_entry_ttl_set(pMatch, TimeOut);
             }
-            break; /* Exit now if found at all - bound or unbound */
+        } else {
+            /* For unbound we can only set the time to live */
+            address_entry_ttl_set(pMatch, TimeOut);
         }
+        Address->Snapshot_Dirty = true;
+    }
+}
+
+/**
+ * @brief Count a lookup of the cache for the hit rate
+ * @param found - true if the lookup found a bound entry
+ */
+static void address_lookup_count(bool found)
+{
+    if (found) {
+        Address->Hits++;
+    } else {
+        Address->Misses++;
     }
 }
 
@@ -352,25 +760,20 @@ bool address_get_by_device(
 {
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
-    unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then fetch data */
-                bacnet_address_copy(src, &pMatch->address);
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                /* Prove we found it */
-                found = true;
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* If bound then fetch data */
+            bacnet_address_copy(src, &pMatch->address);
+            if (max_apdu) {
+                *max_apdu = pMatch->max_apdu;
             }
-            /* Exit now if found at all - bound or unbound */
-            break;
+            /* Prove we found it */
+            found = true;
         }
     }
+    address_lookup_count(found);
 
     return found;
 }
@@ -386,23 +789,36 @@ bool address_get_by_device(
 bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id)
 {
     struct Address_Cache_Entry *pMatch;
+    struct Address_Cache_Entry *pCandidate = NULL;
     bool found = false; /* return value */
-    unsigned index;
+    unsigned entry;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+    if (!src) {
+        return false;
+    }
+    entry =
+        Address->MAC_Bucket[address_mac_hash(src) % ADDRESS_CACHE_HASH_SIZE];
+    while (entry) {
+        pMatch = &Address->Cache[entry - 1];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
             /* If bound */
             if (bacnet_address_same(&pMatch->address, src)) {
-                if (device_id) {
-                    *device_id = pMatch->device_id;
+                /* the first entry in the table wins */
+                if (!pCandidate || (pMatch < pCandidate)) {
+                    pCandidate = pMatch;
                 }
-                found = true;
-                break;
             }
         }
+        entry = pMatch->mac_next;
     }
+    if (pCandidate) {
+        if (device_id) {
+            *device_id = pCandidate->device_id;
+        }
+        found = true;
+    }
+    address_lookup_count(found);
 
     return found;
 }
@@ -421,7 +837,7 @@ void address_add(
     struct Address_Cache_Entry *pMatch;
     unsigned index;
 
-    if (Own_Device_ID == device_id) {
+    if (Address->Own_Device_ID_Set && (Address->Own_Device_ID == device_id)) {
         return;
     }
 
@@ -432,44 +848,40 @@ void address_add(
        bind request if it exists */
 
     /* existing device or bind request outstanding - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
         /* Device already in the list, then update the values. */
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Pick the right time to live */
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
-                /* Bind requested so long time */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
-                /* Static already so make sure it never expires */
-                pMatch->TimeToLive = BAC_ADDR_FOREVER;
-            } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            } else {
-                /* Renewing existing entry */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            /* Clear bind request flag just in case */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            found = true;
-            break;
+        address_entry_address_set(pMatch, src);
+        pMatch->max_apdu = max_apdu;
+        /* Pick the right time to live */
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
+            /* Bind requested so long time */
+            address_entry_ttl_set(pMatch, BAC_ADDR_LONG_TIME);
+        } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
+            /* Static already so make sure it never expires */
+            address_entry_ttl_set(pMatch, BAC_ADDR_FOREVER);
+        } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
+            /* Opportunistic entry so leave on short fuse */
+            address_entry_ttl_set(pMatch, BAC_ADDR_SHORT_TIME);
+        } else {
+            /* Renewing existing entry */
+            address_entry_ttl_set(pMatch, BAC_ADDR_LONG_TIME);
         }
+        /* Clear bind request flag just in case */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        found = true;
     }
     /* New device - add to cache if there is room. */
     if (!found) {
         for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-            pMatch = &Address_Cache[index];
+            pMatch = &Address->Cache[index];
             if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0) {
-                pMatch->Flags = BAC_ADDR_IN_USE;
-                pMatch->device_id = device_id;
+                address_entry_release(pMatch, BAC_ADDR_IN_USE);
+                address_entry_device_set(pMatch, device_id);
                 pMatch->max_apdu = max_apdu;
-                bacnet_address_copy(&pMatch->address, src);
+                address_entry_address_set(pMatch, src);
                 /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+                address_entry_ttl_set(pMatch, BAC_ADDR_SHORT_TIME);
                 found = true;
                 break;
             }
@@ -481,11 +893,11 @@ void address_add(
         pMatch = address_remove_oldest();
         if (pMatch != NULL) {
             pMatch->Flags = BAC_ADDR_IN_USE;
-            pMatch->device_id = device_id;
+            address_entry_device_set(pMatch, device_id);
             pMatch->max_apdu = max_apdu;
-            bacnet_address_copy(&pMatch->address, src);
+            address_entry_address_set(pMatch, src);
             /* Opportunistic entry so leave on short fuse */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+            address_entry_ttl_set(pMatch, BAC_ADDR_SHORT_TIME);
         }
     }
     return;
@@ -515,45 +927,45 @@ bool address_device_bind_request(
     unsigned index;
 
     /* existing device - update address info if currently bound */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* Already bound */
-                found = true;
-                if (src) {
-                    bacnet_address_copy(src, &pMatch->address);
-                }
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                if (device_ttl) {
-                    *device_ttl = pMatch->TimeToLive;
-                }
-                if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                    /* Was picked up opportunistacilly */
-                    /* Convert to normal entry  */
-                    pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
-                    /* And give it a decent time to live */
-                    pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-                }
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* Already bound */
+            found = true;
+            if (src) {
+                bacnet_address_copy(src, &pMatch->address);
+            }
+            if (max_apdu) {
+                *max_apdu = pMatch->max_apdu;
+            }
+            if (device_ttl) {
+                *device_ttl = address_entry_ttl(pMatch);
+            }
+            if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
+                /* Was picked up opportunistacilly */
+                /* Convert to normal entry  */
+                pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
+                /* And give it a decent time to live */
+                address_entry_ttl_set(pMatch, BAC_ADDR_LONG_TIME);
             }
-            /* True if bound, false if bind request outstanding */
-            return (found);
         }
+        address_lookup_count(found);
+        /* True if bound, false if bind request outstanding */
+        return (found);
     }
+    address_lookup_count(false);
 
     /* Not there already so look for a free entry to put it in */
     /* existing device - update address info if currently bound */
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0) {
             /* In use and awaiting binding */
-            pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-            pMatch->device_id = device_id;
+            address_entry_release(
+                pMatch, (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ));
+            address_entry_device_set(pMatch, device_id);
             /* No point in leaving bind requests in for long haul */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+            address_entry_ttl_set(pMatch, BAC_ADDR_SHORT_TIME);
             /* now would be a good time to do a Who-Is request */
             return (false);
         }
@@ -564,9 +976,9 @@ bool address_device_bind_request(
     pMatch = address_remove_oldest();
     if (pMatch != NULL) {
         pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-        pMatch->device_id = device_id;
+        address_entry_device_set(pMatch, device_id);
         /* No point in leaving bind requests in for long haul */
-        pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        address_entry_ttl_set(pMatch, BAC_ADDR_SHORT_TIME);
     }
     return (false);
 }
@@ -600,23 +1012,18 @@ void address_add_binding(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
     /* existing device or bind request - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Clear bind request flag in case it was set */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            /* Only update TTL if not static */
-            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
-                /* and set it on a long fuse */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            break;
+    pMatch = address_device_find(device_id);
+    if (pMatch) {
+        address_entry_address_set(pMatch, src);
+        pMatch->max_apdu = max_apdu;
+        /* Clear bind request flag in case it was set */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        /* Only update TTL if not static */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
+            /* and set it on a long fuse */
+            address_entry_ttl_set(pMatch, BAC_ADDR_LONG_TIME);
         }
     }
     return;
@@ -646,7 +1053,7 @@ bool address_device_get_by_index(
     bool found = false; /* return value */
 
     if (index < MAX_ADDRESS_CACHE) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
             if (src) {
@@ -659,7 +1066,7 @@ bool address_device_get_by_index(
                 *max_apdu = pMatch->max_apdu;
             }
             if (device_ttl) {
-                *device_ttl = pMatch->TimeToLive;
+                *device_ttl = address_entry_ttl(pMatch);
             }
             found = true;
         }
@@ -700,7 +1107,7 @@ unsigned address_count(void)
     unsigned index;
 
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         /* Only count bound entries */
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
@@ -711,6 +1118,37 @@ unsigned address_count(void)
     return count;
 }
 
+/**
+ * Add the memory used by the address cache of the default context
+ * to a report.
+ *
+ * @param usage - report to add the memory used by the cache to
+ */
+void address_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes += sizeof(Address_Default);
+    usage->count += address_count();
+}
+
+/**
+ * @brief Get the number of lookups by device-id or by MAC address, and of
+ *  bind requests, since address_init(), for the hit rate of the cache
+ * @param hits - filled with the lookups that found a bound entry
+ * @param misses - filled with the lookups that did not
+ */
+void address_cache_lookups(unsigned long *hits, unsigned long *misses)
+{
+    if (hits) {
+        *hits = Address->Hits;
+    }
+    if (misses) {
+        *misses = Address->Misses;
+    }
+}
+
 /**
  * Build a list of the current bindings for the device address binding
  * property. Basically encode the address list to be send out.
@@ -729,7 +1167,7 @@ int address_list_encode(uint8_t *apdu, unsigned apdu_len)
 
     /* Look for matching address. */
     for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+        pMatch = &Address->Cache[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
             iLen += encode_application_object_id(
@@ -881,13 +1319,13 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
         uiTarget = uiTotal;
     }
 
-    pMatch = Address_Cache;
+    pMatch = Address->Cache;
     uiIndex = 1;
     while ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) !=
            BAC_ADDR_IN_USE) { /* Find first bound entry */
         pMatch++;
         /* Shall not happen as the count has been checked first. */
-        if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+        if (pMatch > &Address->Cache[MAX_ADDRESS_CACHE - 1]) {
             /* Issue with the table. */
             return (0);
         }
@@ -904,7 +1342,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
             pMatch++;
         }
         /* Shall not happen as the count has been checked first. */
-        if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+        if (pMatch > &Address->Cache[MAX_ADDRESS_CACHE - 1]) {
             /* Issue with the table. */
             return (0);
         }
@@ -955,7 +1393,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
             /* Find next bound entry */
             pMatch++;
             /* Can normally not happen. */
-            if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+            if (pMatch > &Address->Cache[MAX_ADDRESS_CACHE - 1]) {
                 /* Issue with the table. */
                 return (0);
             }
@@ -973,12 +1411,257 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     return (iLen);
 }
 
+#ifdef BACNET_ADDRESS_CACHE_FILE
 /**
- * Scan the cache and eliminate any expired entries. Should be called
+ * @brief Encode the bound entry of a device for the snapshot file
+ * @param buffer  buffer of ADDRESS_SNAPSHOT_RECORD_SIZE bytes
+ * @param pMatch  Pointer to the entry
+ */
+static void address_snapshot_record_encode(
+    uint8_t *buffer, const struct Address_Cache_Entry *pMatch)
+{
+    unsigned i;
+
+    buffer += encode_unsigned32(buffer, pMatch->device_id);
+    buffer += encode_unsigned32(buffer, (uint32_t)pMatch->max_apdu);
+    buffer += encode_unsigned32(buffer, address_entry_ttl(pMatch));
+    *buffer++ = pMatch->Flags & (BAC_ADDR_STATIC | BAC_ADDR_SHORT_TTL);
+    buffer += encode_unsigned16(buffer, pMatch->address.net);
+    *buffer++ = pMatch->address.mac_len;
+    for (i = 0; i < MAX_MAC_LEN; i++) {
+        *buffer++ = pMatch->address.mac[i];
+    }
+    *buffer++ = pMatch->address.len;
+    for (i = 0; i < MAX_MAC_LEN; i++) {
+        *buffer++ = pMatch->address.adr[i];
+    }
+}
+
+/**
+ * @brief Save the bound entries of the cache, with their remaining time
+ *  to live, to a binary snapshot file that address_cache_restore() loads
+ *  on the next start.  The file is written beside the old one and then
+ *  renamed over it, so a reset while saving leaves the old snapshot.
+ *
+ * @param pathname  name of the snapshot file
+ * @return true if the snapshot was saved
+ */
+bool address_cache_save(const char *pathname)
+{
+    struct Address_Cache_Entry *pMatch;
+    uint8_t buffer[ADDRESS_SNAPSHOT_RECORD_SIZE] = { 0 };
+    char *temp_pathname;
+    size_t temp_pathname_size;
+    FILE *pFile;
+    uint32_t count = 0;
+    unsigned index;
+    bool status;
+
+    if (!pathname) {
+        return false;
+    }
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address->Cache[index];
+        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+            BAC_ADDR_IN_USE) {
+            count++;
+        }
+    }
+    temp_pathname_size = strlen(pathname) + 5;
+    temp_pathname = BACNET_MEMPOOL_CALLOC(temp_pathname_size);
+    if (!temp_pathname) {
+        return false;
+    }
+    strcpy(temp_pathname, pathname);
+    strcat(temp_pathname, ".tmp");
+    pFile = fopen(temp_pathname, "wb");
+    if (!pFile) {
+        BACNET_MEMPOOL_FREE(temp_pathname, temp_pathname_size);
+        return false;
+    }
+    (void)encode_unsigned32(&buffer[0], ADDRESS_SNAPSHOT_MAGIC);
+    (void)encode_unsigned32(&buffer[4], ADDRESS_SNAPSHOT_VERSION);
+    (void)encode_unsigned32(&buffer[8], ADDRESS_SNAPSHOT_RECORD_SIZE);
+    (void)encode_unsigned32(&buffer[12], (uint32_t)time(NULL));
+    (void)encode_unsigned32(&buffer[16], count);
+    status = fwrite(buffer, ADDRESS_SNAPSHOT_HEADER_SIZE, 1, pFile) == 1;
+    for (index = 0; status && (index < MAX_ADDRESS_CACHE); index++) {
+        pMatch = &Address->Cache[index];
+        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+            BAC_ADDR_IN_USE) {
+            address_snapshot_record_encode(buffer, pMatch);
+            status = fwrite(buffer, sizeof(buffer), 1, pFile) == 1;
+        }
+    }
+    if (fclose(pFile) != 0) {
+        status = false;
+    }
+    if (status) {
+        (void)remove(pathname);
+        status = rename(temp_pathname, pathname) == 0;
+    }
+    if (status) {
+        Address->Snapshot_Dirty = false;
+    } else {
+        (void)remove(temp_pathname);
+    }
+    BACNET_MEMPOOL_FREE(temp_pathname, temp_pathname_size);
+
+    return status;
+}
+
+/**
+ * @brief Restore one bound entry from the snapshot file.  Entries that
+ *  are already bound, such as static entries from the address_cache
+ *  text file, are kept as they are.
+ * @param buffer  buffer of ADDRESS_SNAPSHOT_RECORD_SIZE bytes
+ * @param elapsed  seconds since the snapshot was saved
+ * @return true if the entry was restored
+ */
+static bool address_snapshot_record_restore(
+    const uint8_t *buffer, uint32_t elapsed)
+{
+    struct Address_Cache_Entry *pMatch;
+    BACNET_ADDRESS src = { 0 };
+    uint32_t device_id, max_apdu, ttl;
+    uint8_t flags;
+    unsigned i;
+
+    buffer += decode_unsigned32(buffer, &device_id);
+    buffer += decode_unsigned32(buffer, &max_apdu);
+    buffer += decode_unsigned32(buffer, &ttl);
+    flags = *buffer++ & (BAC_ADDR_STATIC | BAC_ADDR_SHORT_TTL);
+    buffer += decode_unsigned16(buffer, &src.net);
+    src.mac_len = *buffer++;
+    for (i = 0; i < MAX_MAC_LEN; i++) {
+        src.mac[i] = *buffer++;
+    }
+    src.len = *buffer++;
+    for (i = 0; i < MAX_MAC_LEN; i++) {
+        src.adr[i] = *buffer++;
+    }
+    if ((src.mac_len > MAX_MAC_LEN) || (src.len > MAX_MAC_LEN)) {
+        return false;
+    }
+    if ((flags & BAC_ADDR_STATIC) == 0) {
+        if (ttl <= elapsed) {
+            /* expired while we were down */
+            return false;
+        }
+        ttl -= elapsed;
+    }
+    pMatch = address_device_find(device_id);
+    if (pMatch && ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0)) {
+        return false;
+    }
+    address_add(device_id, max_apdu, &src);
+    pMatch = address_device_find(device_id);
+    if (!pMatch) {
+        return false;
+    }
+    pMatch->Flags = BAC_ADDR_IN_USE | flags;
+    address_entry_ttl_set(pMatch, ttl);
+
+    return true;
+}
+
+/**
+ * @brief Restore the bound entries of a snapshot file written by
+ *  address_cache_save(), so that a warm restart does not have to bind
+ *  every device again.  The time to live of each entry is reduced by
+ *  the time since the snapshot was saved, and entries that expired in
+ *  the meantime are dropped.
+ *
+ * @param pathname  name of the snapshot file
+ * @return true if the snapshot file was valid and was restored
+ */
+bool address_cache_restore(const char *pathname)
+{
+    uint8_t buffer[ADDRESS_SNAPSHOT_RECORD_SIZE] = { 0 };
+    uint32_t magic = 0, version = 0, record_size = 0;
+    uint32_t saved = 0, count = 0, now, elapsed = 0;
+    FILE *pFile;
+    bool status;
+
+    if (!pathname) {
+        return false;
+    }
+    pFile = fopen(pathname, "rb");
+    if (!pFile) {
+        return false;
+    }
+    status = fread(buffer, ADDRESS_SNAPSHOT_HEADER_SIZE, 1, pFile) == 1;
+    if (status) {
+        (void)decode_unsigned32(&buffer[0], &magic);
+        (void)decode_unsigned32(&buffer[4], &version);
+        (void)decode_unsigned32(&buffer[8], &record_size);
+        (void)decode_unsigned32(&buffer[12], &saved);
+        (void)decode_unsigned32(&buffer[16], &count);
+        status = (magic == ADDRESS_SNAPSHOT_MAGIC) &&
+            (version == ADDRESS_SNAPSHOT_VERSION) &&
+            (record_size == ADDRESS_SNAPSHOT_RECORD_SIZE);
+    }
+    if (status) {
+        now = (uint32_t)time(NULL);
+        if (now > saved) {
+            elapsed = now - saved;
+        }
+    }
+    while (status && (count > 0)) {
+        status = fread(buffer, sizeof(buffer), 1, pFile) == 1;
+        if (status) {
+            (void)address_snapshot_record_restore(buffer, elapsed);
+        }
+        count--;
+    }
+    fclose(pFile);
+
+    return status;
+}
+
+/**
+ * @brief Set the snapshot file that address_cache_timer() saves the
+ *  bound entries to, every interval seconds when they have changed.
+ *
+ * @param pathname  name of the snapshot file, or NULL to stop saving.
+ *  The string must remain valid while it is set.
+ * @param interval  seconds between snapshots
+ */
+void address_cache_snapshot_set(const char *pathname, uint32_t interval)
+{
+    Address->Snapshot_Pathname = pathname;
+    Address->Snapshot_Interval = interval;
+    Address->Snapshot_Elapsed = 0;
+}
+#else
+bool address_cache_save(const char *pathname)
+{
+    (void)pathname;
+    return false;
+}
+
+bool address_cache_restore(const char *pathname)
+{
+    (void)pathname;
+    return false;
+}
+
+void address_cache_snapshot_set(const char *pathname, uint32_t interval)
+{
+    (void)pathname;
+    (void)interval;
+}
+#endif
+
+/**
+ * Eliminate any expired entries. Should be called
  * periodically to ensure the cache is managed correctly. If this function
  * is never called at all the whole cache is effectively rendered static and
  * entries never expire unless explicitly deleted.
  *
+ * The entries holding a slot, except statics, are kept in a heap ordered
+ * by their time of expiry, so only the expired entries are visited.
+ *
  * @param uSeconds  Approximate number of seconds since last call to this
  * function
  */
@@ -987,17 +1670,82 @@ void address_cache_timer(uint16_t uSeconds)
     struct Address_Cache_Entry *pMatch;
     unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) != 0) &&
-            ((pMatch->Flags & BAC_ADDR_STATIC) ==
-             0)) { /* Check all entries holding a slot except statics
-                    */
-            if (pMatch->TimeToLive >= uSeconds) {
-                pMatch->TimeToLive -= uSeconds;
+    if (Address->Seconds > (UINT32_MAX / 2)) {
+        /* rebase the cache clock long before it can wrap */
+        for (index = 0; index < Address->TTL_Heap_Count; index++) {
+            pMatch = &Address->Cache[Address->TTL_Heap[index] - 1];
+            if (pMatch->Expires == UINT32_MAX) {
+                /* keep the saturated entries at the end of time */
+            } else if (pMatch->Expires > Address->Seconds) {
+                pMatch->Expires -= Address->Seconds;
             } else {
-                pMatch->Flags = 0;
+                pMatch->Expires = 0;
             }
         }
+        Address->Seconds = 0;
+    }
+    Address->Seconds += uSeconds;
+    while (Address->TTL_Heap_Count > 0) {
+        pMatch = &Address->Cache[Address->TTL_Heap[0] - 1];
+        if (pMatch->Expires >= Address->Seconds) {
+            break;
+        }
+        address_entry_release(pMatch, 0);
+    }
+#ifdef BACNET_ADDRESS_CACHE_FILE
+    if (Address->Snapshot_Pathname && Address->Snapshot_Interval) {
+        Address->Snapshot_Elapsed += uSeconds;
+        if (Address->Snapshot_Elapsed >= Address->Snapshot_Interval) {
+            Address->Snapshot_Elapsed = 0;
+            if (Address->Snapshot_Dirty) {
+                (void)address_cache_save(Address->Snapshot_Pathname);
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * Allocates an empty address cache for a stack context.
+ *
+ * @return the new context, or NULL if out of memory
+ */
+ADDRESS_CONTEXT *address_context_create(void)
+{
+    struct address_context *context;
+
+    context = BACNET_MEMPOOL_CALLOC(sizeof(struct address_context));
+
+    return context;
+}
+
+/**
+ * Frees an address cache. The context must not be selected by any thread.
+ *
+ * @param context  context from address_context_create()
+ */
+void address_context_delete(ADDRESS_CONTEXT *context)
+{
+    if (context && (context != &Address_Default)) {
+        BACNET_MEMPOOL_FREE(context, sizeof(struct address_context));
     }
 }
+
+/**
+ * Selects the address cache used by the address functions called from
+ * this thread. With BACNET_STACK_CONTEXT_THREADS, each thread selects
+ * its own context; otherwise one context is selected for the whole
+ * process.
+ *
+ * @param context  context from address_context_create(), or NULL for
+ *  the default context
+ * @return the context that was selected before
+ */
+ADDRESS_CONTEXT *address_context_select(ADDRESS_CONTEXT *context)
+{
+    struct address_context *previous = Address;
+
+    Address = context ? context : &Address_Default;
+
+    return previous;
+}
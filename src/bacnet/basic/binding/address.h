@@ -16,6 +16,10 @@
 /* BACnet Stack API */
 #include "bacnet/bacaddr.h"
 #include "bacnet/readrange.h"
+#include "bacnet/basic/sys/memusage.h"
+
+/* the state of one address cache */
+typedef struct address_context ADDRESS_CONTEXT;
 
 /* refactored utility functions - see bacaddr.c module */
 #define address_mac_init(m, a, l) bacnet_address_mac_init(m, a, l)
@@ -63,6 +67,10 @@ bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id);
 
 BACNET_STACK_EXPORT
 unsigned address_count(void);
+BACNET_STACK_EXPORT
+void address_memory_usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+void address_cache_lookups(unsigned long *hits, unsigned long *misses);
 
 BACNET_STACK_EXPORT
 bool address_bind_request(
@@ -91,12 +99,25 @@ void address_set_device_TTL(
 
 BACNET_STACK_EXPORT
 void address_cache_timer(uint16_t uSeconds);
+BACNET_STACK_EXPORT
+bool address_cache_save(const char *pathname);
+BACNET_STACK_EXPORT
+bool address_cache_restore(const char *pathname);
+BACNET_STACK_EXPORT
+void address_cache_snapshot_set(const char *pathname, uint32_t interval);
 
 BACNET_STACK_EXPORT
 void address_protected_entry_index_set(uint32_t top_protected_entry_index);
 BACNET_STACK_EXPORT
 void address_own_device_id_set(uint32_t own_id);
 
+BACNET_STACK_EXPORT
+ADDRESS_CONTEXT *address_context_create(void);
+BACNET_STACK_EXPORT
+void address_context_delete(ADDRESS_CONTEXT *context);
+BACNET_STACK_EXPORT
+ADDRESS_CONTEXT *address_context_select(ADDRESS_CONTEXT *context);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,416 @@
+/**
+ * @file
+ * @brief A cache of the capabilities of peer BACnet devices
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacenum.h"
+#include "bacnet/bacstr.h"
+#include "bacnet/basic/binding/capability.h"
+
+/* the device-id hash index keeps the lookups from scanning the cache */
+#ifndef CAPABILITY_CACHE_HASH_SIZE
+#define CAPABILITY_CACHE_HASH_SIZE MAX_CAPABILITY_CACHE
+#endif
+/* the smallest APDU that every BACnet device accepts */
+#define CAPABILITY_APDU_MIN 50
+
+struct capability_entry {
+    uint32_t device_id;
+    /* largest APDU accepted by the device, from I-Am, or zero */
+    unsigned max_apdu;
+    /* largest reply known to get through, lowered by aborts, or zero */
+    unsigned reply_limit;
+    int segmentation;
+    uint16_t vendor_id;
+    /* services executed by the device, from Protocol_Services_Supported */
+    uint64_t services;
+    /* services the device rejected as unrecognized */
+    uint64_t denied;
+    bool in_use : 1;
+    bool iam_known : 1;
+    bool services_known : 1;
+    /* when the entry was last learned, for replacing the oldest entry */
+    uint32_t sequence;
+    /* next entry index + 1 in the hash chain, or zero */
+    unsigned next;
+};
+
+static struct capability_entry Capability_Cache[MAX_CAPABILITY_CACHE];
+static unsigned Capability_Bucket[CAPABILITY_CACHE_HASH_SIZE];
+static uint32_t Capability_Sequence;
+
+/**
+ * @brief Find the entry of a device
+ * @param device_id - device instance
+ * @return the entry, or NULL if the device is not in the cache
+ */
+static struct capability_entry *capability_find(uint32_t device_id)
+{
+    struct capability_entry *entry;
+    unsigned index;
+
+    index = Capability_Bucket[device_id % CAPABILITY_CACHE_HASH_SIZE];
+    while (index) {
+        entry = &Capability_Cache[index - 1];
+        if (entry->device_id == device_id) {
+            return entry;
+        }
+        index = entry->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Remove an entry from its hash chain and free it
+ * @param entry - entry in use
+ */
+static void capability_release(struct capability_entry *entry)
+{
+    unsigned *link;
+    unsigned index = (unsigned)(entry - Capability_Cache) + 1;
+
+    link = &Capability_Bucket[entry->device_id % CAPABILITY_CACHE_HASH_SIZE];
+    while (*link) {
+        if (*link == index) {
+            *link = entry->next;
+            break;
+        }
+        link = &Capability_Cache[*link - 1].next;
+    }
+    entry->next = 0;
+    entry->in_use = false;
+}
+
+/**
+ * @brief Find the entry of a device, adding it if needed.  When the cache
+ *  is full, the entry that was learned longest ago is replaced.
+ * @param device_id - device instance
+ * @return the entry
+ */
+static struct capability_entry *capability_add(uint32_t device_id)
+{
+    struct capability_entry *entry;
+    struct capability_entry *oldest = NULL;
+    unsigned index, bucket;
+
+    entry = capability_find(device_id);
+    if (!entry) {
+        for (index = 0; index < MAX_CAPABILITY_CACHE; index++) {
+            entry = &Capability_Cache[index];
+            if (!entry->in_use) {
+                break;
+            }
+            if (!oldest ||
+                ((Capability_Sequence - entry->sequence) >
+                 (Capability_Sequence - oldest->sequence))) {
+                oldest = entry;
+            }
+        }
+        if (index == MAX_CAPABILITY_CACHE) {
+            entry = oldest;
+            capability_release(entry);
+        }
+        entry->device_id = device_id;
+        entry->max_apdu = 0;
+        entry->reply_limit = 0;
+        entry->segmentation = SEGMENTATION_NONE;
+        entry->vendor_id = 0;
+        entry->services = 0;
+        entry->denied = 0;
+        entry->iam_known = false;
+        entry->services_known = false;
+        entry->in_use = true;
+        bucket = device_id % CAPABILITY_CACHE_HASH_SIZE;
+        entry->next = Capability_Bucket[bucket];
+        Capability_Bucket[bucket] = (unsigned)(entry - Capability_Cache) + 1;
+    }
+    Capability_Sequence++;
+    entry->sequence = Capability_Sequence;
+
+    return entry;
+}
+
+/**
+ * @brief Get the bit of a service in the service masks
+ * @param service - service from the Protocol_Services_Supported list
+ * @return bit mask of the service, or zero if out of range
+ */
+static uint64_t capability_service_bit(BACNET_SERVICES_SUPPORTED service)
+{
+    if ((unsigned)service >= 64) {
+        return 0;
+    }
+
+    return (uint64_t)1 << (unsigned)service;
+}
+
+/**
+ * @brief Forget the capabilities of every device
+ */
+void capability_init(void)
+{
+    unsigned index;
+
+    for (index = 0; index < MAX_CAPABILITY_CACHE; index++) {
+        Capability_Cache[index].in_use = false;
+        Capability_Cache[index].next = 0;
+    }
+    for (index = 0; index < CAPABILITY_CACHE_HASH_SIZE; index++) {
+        Capability_Bucket[index] = 0;
+    }
+    Capability_Sequence = 0;
+}
+
+/**
+ * @brief Learn the capabilities that a device announces in I-Am
+ * @param device_id - device instance
+ * @param max_apdu - largest APDU accepted by the device
+ * @param segmentation - segmentation supported by the device
+ * @param vendor_id - vendor identifier of the device
+ */
+void capability_iam_set(
+    uint32_t device_id,
+    unsigned max_apdu,
+    int segmentation,
+    uint16_t vendor_id)
+{
+    struct capability_entry *entry;
+
+    entry = capability_add(device_id);
+    if (entry->max_apdu != max_apdu) {
+        /* the device may have been replaced - learn its limit again */
+        entry->reply_limit = 0;
+    }
+    entry->max_apdu = max_apdu;
+    entry->segmentation = segmentation;
+    entry->vendor_id = vendor_id;
+    entry->iam_known = true;
+}
+
+/**
+ * @brief Learn the services that a device executes, as read from its
+ *  Protocol_Services_Supported property
+ * @param device_id - device instance
+ * @param services_supported - the Protocol_Services_Supported bit string
+ */
+void capability_services_set(
+    uint32_t device_id, const BACNET_BIT_STRING *services_supported)
+{
+    struct capability_entry *entry;
+    uint64_t services = 0;
+    uint8_t bit, bits_used;
+
+    if (!services_supported) {
+        return;
+    }
+    bits_used = bitstring_bits_used(services_supported);
+    for (bit = 0; (bit < bits_used) && (bit < 64); bit++) {
+        if (bitstring_bit(services_supported, bit)) {
+            services |= (uint64_t)1 << bit;
+        }
+    }
+    entry = capability_add(device_id);
+    entry->services = services;
+    entry->services_known = true;
+    /* the list is the authority for the services it names */
+    entry->denied &= ~services;
+}
+
+/**
+ * @brief Learn that a device does not execute a service
+ * @param device_id - device instance
+ * @param service - service from the Protocol_Services_Supported list
+ */
+void capability_service_denied(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service)
+{
+    struct capability_entry *entry;
+
+    entry = capability_add(device_id);
+    entry->denied |= capability_service_bit(service);
+}
+
+/**
+ * @brief Learn from the abort of a confirmed request.  When the reply or
+ *  the request did not fit, the largest reply that the device is sent
+ *  for is halved, down to the smallest APDU.
+ * @param device_id - device instance
+ * @param service - service of the aborted request
+ * @param reason - BACNET_ABORT_REASON of the abort
+ */
+void capability_abort(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service, uint8_t reason)
+{
+    struct capability_entry *entry;
+    unsigned limit;
+
+    (void)service;
+    switch (reason) {
+        case ABORT_REASON_BUFFER_OVERFLOW:
+        case ABORT_REASON_SEGMENTATION_NOT_SUPPORTED:
+        case ABORT_REASON_APDU_TOO_LONG:
+            entry = capability_add(device_id);
+            limit = entry->reply_limit;
+            if (limit == 0) {
+                limit = entry->max_apdu ? entry->max_apdu : MAX_APDU;
+            }
+            limit /= 2;
+            if (limit < CAPABILITY_APDU_MIN) {
+                limit = CAPABILITY_APDU_MIN;
+            }
+            entry->reply_limit = limit;
+            if (reason == ABORT_REASON_SEGMENTATION_NOT_SUPPORTED) {
+                entry->segmentation = SEGMENTATION_NONE;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Learn from the reject of a confirmed request.  A service that
+ *  is rejected as unrecognized is not requested again.
+ * @param device_id - device instance
+ * @param service - service of the rejected request
+ * @param reason - BACNET_REJECT_REASON of the reject
+ */
+void capability_reject(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service, uint8_t reason)
+{
+    if (reason == REJECT_REASON_UNRECOGNIZED_SERVICE) {
+        capability_service_denied(device_id, service);
+    }
+}
+
+/**
+ * @brief Determine if a service is worth requesting from a device
+ * @param device_id - device instance
+ * @param service - service from the Protocol_Services_Supported list
+ * @return false if the device is known not to execute the service,
+ *  true if it does or if it is not known
+ */
+bool capability_service_supported(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service)
+{
+    const struct capability_entry *entry;
+    uint64_t bit;
+
+    entry = capability_find(device_id);
+    if (!entry) {
+        return true;
+    }
+    bit = capability_service_bit(service);
+    if (entry->denied & bit) {
+        return false;
+    }
+    if (entry->services_known && bit && !(entry->services & bit)) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the largest APDU to size requests and replies for a device
+ * @param device_id - device instance
+ * @return the smaller of the max APDU in the I-Am of the device and the
+ *  largest reply known to get through, or zero if neither is known
+ */
+unsigned capability_max_apdu(uint32_t device_id)
+{
+    const struct capability_entry *entry;
+    unsigned max_apdu;
+
+    entry = capability_find(device_id);
+    if (!entry) {
+        return 0;
+    }
+    max_apdu = entry->max_apdu;
+    if (entry->reply_limit &&
+        ((max_apdu == 0) || (entry->reply_limit < max_apdu))) {
+        max_apdu = entry->reply_limit;
+    }
+
+    return max_apdu;
+}
+
+/**
+ * @brief Get the segmentation supported by a device
+ * @param device_id - device instance
+ * @param segmentation - BACNET_SEGMENTATION of the device, if known
+ * @return true if the segmentation of the device is known
+ */
+bool capability_segmentation(uint32_t device_id, int *segmentation)
+{
+    const struct capability_entry *entry;
+
+    entry = capability_find(device_id);
+    if (!entry || !entry->iam_known) {
+        return false;
+    }
+    if (segmentation) {
+        *segmentation = entry->segmentation;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the vendor identifier of a device
+ * @param device_id - device instance
+ * @param vendor_id - vendor identifier of the device, if known
+ * @return true if the vendor identifier of the device is known
+ */
+bool capability_vendor_id(uint32_t device_id, uint16_t *vendor_id)
+{
+    const struct capability_entry *entry;
+
+    entry = capability_find(device_id);
+    if (!entry || !entry->iam_known) {
+        return false;
+    }
+    if (vendor_id) {
+        *vendor_id = entry->vendor_id;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Forget the capabilities of a device
+ * @param device_id - device instance
+ */
+void capability_remove_device(uint32_t device_id)
+{
+    struct capability_entry *entry;
+
+    entry = capability_find(device_id);
+    if (entry) {
+        capability_release(entry);
+    }
+}
+
+/**
+ * @brief Get the number of devices in the cache
+ * @return number of devices
+ */
+unsigned capability_count(void)
+{
+    unsigned index, count = 0;
+
+    for (index = 0; index < MAX_CAPABILITY_CACHE; index++) {
+        if (Capability_Cache[index].in_use) {
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief API for a cache of the capabilities of peer BACnet devices
+ *
+ * Client requests are shaped by what the peer device can take: the
+ * largest APDU it accepts, whether it segments, and which services it
+ * executes.  The cache learns them from I-Am, from reads of the
+ * Protocol_Services_Supported property, and from the aborts and rejects
+ * of earlier requests, so that request builders can pack requests to
+ * the peer's limit and skip requests that are known to fail.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_CAPABILITY_H
+#define BACNET_BASIC_CAPABILITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacenum.h"
+#include "bacnet/bacstr.h"
+
+/* number of devices whose capabilities are remembered */
+#ifndef MAX_CAPABILITY_CACHE
+#define MAX_CAPABILITY_CACHE 255
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void capability_init(void);
+
+BACNET_STACK_EXPORT
+void capability_iam_set(
+    uint32_t device_id,
+    unsigned max_apdu,
+    int segmentation,
+    uint16_t vendor_id);
+BACNET_STACK_EXPORT
+void capability_services_set(
+    uint32_t device_id, const BACNET_BIT_STRING *services_supported);
+BACNET_STACK_EXPORT
+void capability_service_denied(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service);
+BACNET_STACK_EXPORT
+void capability_abort(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service, uint8_t reason);
+BACNET_STACK_EXPORT
+void capability_reject(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service, uint8_t reason);
+
+BACNET_STACK_EXPORT
+bool capability_service_supported(
+    uint32_t device_id, BACNET_SERVICES_SUPPORTED service);
+BACNET_STACK_EXPORT
+unsigned capability_max_apdu(uint32_t device_id);
+BACNET_STACK_EXPORT
+bool capability_segmentation(uint32_t device_id, int *segmentation);
+BACNET_STACK_EXPORT
+bool capability_vendor_id(uint32_t device_id, uint16_t *vendor_id);
+
+BACNET_STACK_EXPORT
+void capability_remove_device(uint32_t device_id);
+BACNET_STACK_EXPORT
+unsigned capability_count(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
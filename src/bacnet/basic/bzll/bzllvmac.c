@@ -36,6 +36,70 @@ void BZLL_VMAC_Debug_Enable(void)
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist VMAC_List;
 
+/* number of buckets in the reverse lookup index by VMAC address */
+#ifndef BZLL_VMAC_HASH_SIZE
+#define BZLL_VMAC_HASH_SIZE 256
+#endif
+
+/* The Key List data, which is also linked into a hash index by the
+   EUI64 and endpoint so that a received packet can find its device ID
+   without scanning the whole list. */
+struct bzll_vmac_entry {
+    /* first, so the Key List data is also the VMAC data */
+    struct bzll_vmac_data vmac;
+    uint32_t device_id;
+    struct bzll_vmac_entry *next;
+};
+static struct bzll_vmac_entry *VMAC_Hash[BZLL_VMAC_HASH_SIZE];
+
+/**
+ * @brief Compute the hash index bucket of a VMAC address
+ * @param vmac - VMAC address
+ * @return the bucket number
+ */
+static unsigned bzll_vmac_hash_bucket(const struct bzll_vmac_data *vmac)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned int i;
+
+    for (i = 0; i < BZLL_VMAC_EUI64; i++) {
+        hash = (hash ^ vmac->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ vmac->endpoint) * 16777619UL;
+
+    return (unsigned)(hash % BZLL_VMAC_HASH_SIZE);
+}
+
+/**
+ * @brief Add an entry to the hash index
+ * @param entry - the Key List data
+ */
+static void bzll_vmac_hash_link(struct bzll_vmac_entry *entry)
+{
+    unsigned bucket = bzll_vmac_hash_bucket(&entry->vmac);
+
+    entry->next = VMAC_Hash[bucket];
+    VMAC_Hash[bucket] = entry;
+}
+
+/**
+ * @brief Remove an entry from the hash index
+ * @param entry - the Key List data
+ */
+static void bzll_vmac_hash_unlink(const struct bzll_vmac_entry *entry)
+{
+    struct bzll_vmac_entry **link;
+
+    link = &VMAC_Hash[bzll_vmac_hash_bucket(&entry->vmac)];
+    while (*link) {
+        if (*link == entry) {
+            *link = entry->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
 /**
  * Returns the number of VMAC in the list
  */
@@ -55,7 +119,7 @@ unsigned int BZLL_VMAC_Count(void)
 bool BZLL_VMAC_Add(uint32_t device_id, const struct bzll_vmac_data *vmac)
 {
     bool status = false;
-    struct bzll_vmac_data *list_vmac = NULL;
+    struct bzll_vmac_entry *list_vmac = NULL;
     uint32_t list_device_id = 0;
     int index = 0;
     size_t i = 0;
@@ -74,29 +138,35 @@ bool BZLL_VMAC_Add(uint32_t device_id, const struct bzll_vmac_data *vmac)
     if (!found) {
         list_vmac = Keylist_Data(VMAC_List, device_id);
         if (list_vmac) {
-            /* device ID already exists. Update MAC. */
-            memmove(list_vmac, vmac, sizeof(struct bzll_vmac_data));
+            /* device ID already exists. Update MAC and its index. */
+            bzll_vmac_hash_unlink(list_vmac);
+            memmove(&list_vmac->vmac, vmac, sizeof(struct bzll_vmac_data));
+            bzll_vmac_hash_link(list_vmac);
             found = true;
             status = true;
         }
     }
     if (!found) {
         /* new entry - add it! */
-        list_vmac = calloc(1, sizeof(struct bzll_vmac_data));
+        list_vmac = calloc(1, sizeof(struct bzll_vmac_entry));
         if (list_vmac) {
             /* copy the MAC into the data store */
-            for (i = 0; i < sizeof(list_vmac->mac); i++) {
-                list_vmac->mac[i] = vmac->mac[i];
+            for (i = 0; i < sizeof(list_vmac->vmac.mac); i++) {
+                list_vmac->vmac.mac[i] = vmac->mac[i];
             }
-            list_vmac->endpoint = vmac->endpoint;
+            list_vmac->vmac.endpoint = vmac->endpoint;
+            list_vmac->device_id = device_id;
             index = Keylist_Data_Add(VMAC_List, device_id, list_vmac);
             if (index >= 0) {
+                bzll_vmac_hash_link(list_vmac);
                 status = true;
                 if (VMAC_Debug) {
                     debug_fprintf(
                         stderr, "BZLL VMAC %u added.\n",
                         (unsigned int)device_id);
                 }
+            } else {
+                free(list_vmac);
             }
         }
     }
@@ -114,10 +184,11 @@ bool BZLL_VMAC_Add(uint32_t device_id, const struct bzll_vmac_data *vmac)
 bool BZLL_VMAC_Delete(uint32_t device_id)
 {
     bool status = false;
-    struct bzll_vmac_data *pVMAC;
+    struct bzll_vmac_entry *pVMAC;
 
     pVMAC = Keylist_Data_Delete(VMAC_List, device_id);
     if (pVMAC) {
+        bzll_vmac_hash_unlink(pVMAC);
         free(pVMAC);
         status = true;
     }
@@ -208,28 +279,23 @@ bool BZLL_VMAC_Same(
 bool BZLL_VMAC_Entry_To_Device_ID(
     const struct bzll_vmac_data *vmac, uint32_t *device_id)
 {
-    bool status = false;
-    struct bzll_vmac_data *list_vmac;
-    int count = 0;
-    int index = 0;
+    const struct bzll_vmac_entry *list_vmac;
 
     if (!vmac) {
         return false; /* invalid parameter */
     }
-    count = Keylist_Count(VMAC_List);
-    while (count) {
-        index = count - 1;
-        list_vmac = Keylist_Data_Index(VMAC_List, index);
-        if (list_vmac) {
-            if (BZLL_VMAC_Same(vmac, list_vmac)) {
-                status = Keylist_Index_Key(VMAC_List, index, device_id);
-                break;
+    list_vmac = VMAC_Hash[bzll_vmac_hash_bucket(vmac)];
+    while (list_vmac) {
+        if (BZLL_VMAC_Same(vmac, &list_vmac->vmac)) {
+            if (device_id) {
+                *device_id = list_vmac->device_id;
             }
+            return true;
         }
-        count--;
+        list_vmac = list_vmac->next;
     }
 
-    return status;
+    return false;
 }
 
 /**
@@ -262,7 +328,7 @@ bool BZLL_VMAC_Entry_Set(
  */
 void BZLL_VMAC_Cleanup(void)
 {
-    struct bzll_vmac_data *pVMAC;
+    struct bzll_vmac_entry *pVMAC;
     const int index = 0;
     unsigned i = 0;
 
@@ -280,7 +346,7 @@ void BZLL_VMAC_Cleanup(void)
                         (unsigned long)device_id);
                     /* print the MAC */
                     for (i = 0; i < BZLL_VMAC_EUI64; i++) {
-                        debug_fprintf(stderr, "%02X", pVMAC->mac[i]);
+                        debug_fprintf(stderr, "%02X", pVMAC->vmac.mac[i]);
                     }
                     debug_fprintf(stderr, "]\n");
                 }
@@ -289,6 +355,9 @@ void BZLL_VMAC_Cleanup(void)
         } while (pVMAC);
         Keylist_Delete(VMAC_List);
         VMAC_List = NULL;
+        for (i = 0; i < BZLL_VMAC_HASH_SIZE; i++) {
+            VMAC_Hash[i] = NULL;
+        }
     }
 }
 
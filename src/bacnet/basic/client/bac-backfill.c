@@ -0,0 +1,590 @@
+/**
+ * @file
+ * @brief Backfill the records of Trend Log objects in other BACnet devices.
+ *
+ * Each log keeps the sequence number of the next record to read. The task
+ * sends ReadRange by sequence number requests for many logs and devices
+ * at once, up to a window of requests in progress, and asks each device
+ * for as many records as fit in its Max_APDU. The records of each
+ * ReadRange-ACK are decoded and passed to the record callback, and then
+ * the cursor callback is given the advanced cursor to persist. A log with
+ * no more records rests for the interval before it is read again.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/apdu.h"
+#include "bacnet/readrange.h"
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/tsm/tsm.h"
+/* me */
+#include "bacnet/basic/client/bac-backfill.h"
+
+/* estimated encoded size of each BACnetLogRecord in a ReadRange-ACK,
+   and of the rest of the ACK, for sizing to the max APDU of the device */
+#define BACNET_BACKFILL_RECORD_SIZE 24
+#define BACNET_BACKFILL_ACK_OVERHEAD 32
+
+/* states of one log */
+typedef enum {
+    BACNET_BACKFILL_IDLE,
+    BACNET_BACKFILL_BINDING,
+    BACNET_BACKFILL_WAITING,
+    BACNET_BACKFILL_RESTING
+} BACNET_BACKFILL_STATE;
+
+typedef struct backfill_log_t {
+    bool valid;
+    BACNET_BACKFILL_CURSOR cursor;
+    BACNET_BACKFILL_STATE state;
+    /* the invoke id is needed to filter incoming messages */
+    uint8_t invoke_id;
+    BACNET_ADDRESS address;
+    unsigned max_apdu;
+    /* records asked for by each request - halved when a request fails,
+       and grown again while the log has more records */
+    uint32_t records;
+    /* timeout timer for binding, and the rest timer */
+    struct mstimer timer;
+} BACKFILL_LOG;
+static BACKFILL_LOG Backfill_Log[BACNET_BACKFILL_LOG_MAX];
+/* log that the task looks at first, so every log gets a turn */
+static unsigned Backfill_Next;
+/* number of requests in progress at once */
+static unsigned Backfill_Window = 4;
+/* time that a log with no more records rests */
+static unsigned long Backfill_Interval = 60000UL;
+/* where the records, cursors, and errors are reported */
+static bacnet_backfill_record_callback_t Backfill_Record_Callback;
+static bacnet_backfill_cursor_callback_t Backfill_Cursor_Callback;
+static bacnet_backfill_error_callback_t Backfill_Error_Callback;
+
+/**
+ * @brief Find a log
+ * @param device_id [in] device instance of the log
+ * @param object_type [in] object type of the log
+ * @param object_instance [in] object instance of the log
+ * @return the log, or NULL if the log is not backfilled
+ */
+static BACKFILL_LOG *bacnet_backfill_log(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        if (Backfill_Log[i].valid &&
+            (Backfill_Log[i].cursor.device_id == device_id) &&
+            (Backfill_Log[i].cursor.object_type == object_type) &&
+            (Backfill_Log[i].cursor.object_instance == object_instance)) {
+            return &Backfill_Log[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the log whose request is waiting for a reply
+ * @param src [in] BACNET_ADDRESS of the source of the reply
+ * @param invoke_id [in] the invokeID of the reply
+ * @return the log, or NULL if no log is waiting for this reply
+ */
+static BACKFILL_LOG *
+bacnet_backfill_log_waiting(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        if (Backfill_Log[i].valid &&
+            (Backfill_Log[i].state == BACNET_BACKFILL_WAITING) &&
+            (Backfill_Log[i].invoke_id == invoke_id) &&
+            address_match(&Backfill_Log[i].address, src)) {
+            return &Backfill_Log[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Get the most records that fit in a ReadRange-ACK from a device
+ * @param max_apdu [in] max APDU of the device
+ * @return number of records
+ */
+static uint32_t bacnet_backfill_records_max(unsigned max_apdu)
+{
+    if (max_apdu > MAX_APDU) {
+        /* the ACK also has to fit in our own receive buffer */
+        max_apdu = MAX_APDU;
+    }
+    if (max_apdu <=
+        (BACNET_BACKFILL_ACK_OVERHEAD + BACNET_BACKFILL_RECORD_SIZE)) {
+        return 1;
+    }
+
+    return (max_apdu - BACNET_BACKFILL_ACK_OVERHEAD) /
+        BACNET_BACKFILL_RECORD_SIZE;
+}
+
+/**
+ * @brief Let a log rest until the next interval
+ * @param log [in] the log
+ */
+static void bacnet_backfill_rest(BACKFILL_LOG *log)
+{
+    log->invoke_id = 0;
+    mstimer_set(&log->timer, Backfill_Interval);
+    log->state = BACNET_BACKFILL_RESTING;
+}
+
+/**
+ * @brief Finish a request of a log with an error, and ask for fewer
+ *  records next time in case the reply was too long for the device
+ * @param log [in] the log
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ * @param fewer [in] true to ask for fewer records next time
+ */
+static void bacnet_backfill_error(
+    BACKFILL_LOG *log,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code,
+    bool fewer)
+{
+    if (fewer && (log->records > 1)) {
+        log->records /= 2;
+    }
+    bacnet_backfill_rest(log);
+    if (Backfill_Error_Callback) {
+        Backfill_Error_Callback(&log->cursor, error_class, error_code);
+    }
+}
+
+/**
+ * @brief Handler for an Error PDU of a ReadRange request
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param invoke_id [in] the invokeID from the rejected message
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+static void bacnet_backfill_error_handler(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    BACKFILL_LOG *log;
+
+    log = bacnet_backfill_log_waiting(src, invoke_id);
+    if (log) {
+        bacnet_backfill_error(log, error_class, error_code, false);
+    }
+}
+
+/**
+ * @brief Handler for a ReadRange-ACK. Passes each record to the record
+ *  callback, and then advances the cursor of the log.
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *  decoded from the APDU header of this message.
+ */
+static void bacnet_backfill_ack_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
+{
+    BACNET_READ_RANGE_DATA data = { 0 };
+    BACNET_LOG_RECORD record = { 0 };
+    BACNET_BACKFILL_CURSOR current;
+    BACKFILL_LOG *log;
+    uint8_t *apdu;
+    int apdu_len, len;
+    uint32_t count = 0;
+    bool more = false;
+
+    log = bacnet_backfill_log_waiting(src, service_data->invoke_id);
+    if (!log) {
+        return;
+    }
+    len = rr_ack_decode_service_request(service_request, service_len, &data);
+    if ((len <= 0) || (data.object_type != log->cursor.object_type) ||
+        (data.object_instance != log->cursor.object_instance) ||
+        ((data.ItemCount > 0) && (data.FirstSequence == 0))) {
+        bacnet_backfill_error(
+            log, ERROR_CLASS_SERVICES, ERROR_CODE_INTERNAL_ERROR, false);
+        return;
+    }
+    current = log->cursor;
+    apdu = data.application_data;
+    apdu_len = data.application_data_len;
+    while ((count < data.ItemCount) && (apdu_len > 0)) {
+        len = bacnet_log_record_decode(apdu, (size_t)apdu_len, &record);
+        if (len <= 0) {
+            break;
+        }
+        current.sequence = data.FirstSequence + count;
+        if (Backfill_Record_Callback) {
+            Backfill_Record_Callback(&current, &record);
+        }
+        apdu += len;
+        apdu_len -= len;
+        count++;
+    }
+    if (count > 0) {
+        log->cursor.sequence = data.FirstSequence + count;
+    }
+    if (count < data.ItemCount) {
+        /* keep the records that were decoded, and read the rest again */
+        bacnet_backfill_error(
+            log, ERROR_CLASS_SERVICES, ERROR_CODE_INTERNAL_ERROR, false);
+    } else {
+        more = bitstring_bit(&data.ResultFlags, RESULT_FLAG_MORE_ITEMS);
+        if (more) {
+            /* grow back towards the most records that fit */
+            if (log->records < bacnet_backfill_records_max(log->max_apdu)) {
+                log->records++;
+            }
+            log->invoke_id = 0;
+            log->state = BACNET_BACKFILL_IDLE;
+        } else {
+            bacnet_backfill_rest(log);
+        }
+    }
+    if (Backfill_Cursor_Callback) {
+        Backfill_Cursor_Callback(&log->cursor, !more);
+    }
+}
+
+/**
+ * @brief Send the next ReadRange request of a log
+ * @param log [in] the log, which is bound
+ * @return true if the request was sent
+ */
+static bool bacnet_backfill_send(BACKFILL_LOG *log)
+{
+    BACNET_READ_RANGE_DATA request = { 0 };
+    uint32_t records_max;
+
+    records_max = bacnet_backfill_records_max(log->max_apdu);
+    if ((log->records == 0) || (log->records > records_max)) {
+        log->records = records_max;
+    }
+    request.object_type = log->cursor.object_type;
+    request.object_instance = log->cursor.object_instance;
+    request.object_property = PROP_LOG_BUFFER;
+    request.array_index = BACNET_ARRAY_ALL;
+    request.Count = (int32_t)log->records;
+    if (log->cursor.sequence == 0) {
+        /* the oldest records, whose sequence numbers are not known yet */
+        request.RequestType = RR_BY_TIME;
+        datetime_set_values(&request.Range.RefTime, 1900, 1, 1, 0, 0, 0, 0);
+    } else {
+        request.RequestType = RR_BY_SEQUENCE;
+        request.Range.RefSeqNum = log->cursor.sequence;
+    }
+    log->invoke_id = Send_ReadRange_Request(log->cursor.device_id, &request);
+    if (log->invoke_id == 0) {
+        return false;
+    }
+    log->state = BACNET_BACKFILL_WAITING;
+
+    return true;
+}
+
+/**
+ * @brief Bind a log to its device, and send its next request when bound
+ * @param log [in] the log
+ * @return true if a request was sent
+ */
+static bool bacnet_backfill_start(BACKFILL_LOG *log)
+{
+    bool found;
+
+    found = address_bind_request(
+        log->cursor.device_id, &log->max_apdu, &log->address);
+    if (found) {
+        return bacnet_backfill_send(log);
+    }
+    if (log->state != BACNET_BACKFILL_BINDING) {
+        Send_WhoIs(log->cursor.device_id, log->cursor.device_id);
+        mstimer_set(&log->timer, apdu_timeout());
+        log->state = BACNET_BACKFILL_BINDING;
+    } else if (mstimer_expired(&log->timer)) {
+        /* unable to bind within APDU timeout */
+        bacnet_backfill_error(
+            log, ERROR_CLASS_SERVICES, ERROR_CODE_TIMEOUT, false);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Handles the backfill repetitive task
+ */
+void bacnet_backfill_task(void)
+{
+    BACKFILL_LOG *log;
+    unsigned i, n, active = 0;
+
+    /* requests in progress go first so that a freed invoke ID is
+       not taken by a new request before its reply is seen */
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        log = &Backfill_Log[i];
+        if (!log->valid || (log->state != BACNET_BACKFILL_WAITING)) {
+            continue;
+        }
+        if (tsm_invoke_id_free(log->invoke_id)) {
+            /* freed without an ACK or Error - an Abort or Reject */
+            bacnet_backfill_error(
+                log, ERROR_CLASS_SERVICES, ERROR_CODE_ABORT_OTHER, true);
+        } else if (tsm_invoke_id_failed(log->invoke_id)) {
+            tsm_free_invoke_id(log->invoke_id);
+            bacnet_backfill_error(
+                log, ERROR_CLASS_SERVICES, ERROR_CODE_ABORT_TSM_TIMEOUT, true);
+        } else {
+            active++;
+        }
+    }
+    /* start the requests of the other logs while the window is open */
+    for (n = 0; n < BACNET_BACKFILL_LOG_MAX; n++) {
+        if (active >= Backfill_Window) {
+            break;
+        }
+        i = (Backfill_Next + n) % BACNET_BACKFILL_LOG_MAX;
+        log = &Backfill_Log[i];
+        if (!log->valid || (log->state == BACNET_BACKFILL_WAITING)) {
+            continue;
+        }
+        if ((log->state == BACNET_BACKFILL_RESTING) &&
+            !mstimer_expired(&log->timer)) {
+            continue;
+        }
+        if (bacnet_backfill_start(log)) {
+            active++;
+        } else if (
+            (log->state != BACNET_BACKFILL_BINDING) &&
+            (log->state != BACNET_BACKFILL_RESTING)) {
+            /* no invoke ID available - try again next time */
+            break;
+        }
+    }
+    Backfill_Next = (Backfill_Next + 1) % BACNET_BACKFILL_LOG_MAX;
+}
+
+/**
+ * @brief Determine if every log is resting, with no request in progress
+ * @return true if no log has records to read until the next interval
+ */
+bool bacnet_backfill_idle(void)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        if (Backfill_Log[i].valid &&
+            (Backfill_Log[i].state != BACNET_BACKFILL_RESTING)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Add a log to backfill, from a cursor that was persisted before
+ *  or from the oldest record of the log
+ * @param cursor [in] the log, and the sequence number of its next record
+ * @return true if the log was added, or its cursor was updated
+ */
+bool bacnet_backfill_add(const BACNET_BACKFILL_CURSOR *cursor)
+{
+    BACKFILL_LOG *log;
+    unsigned i;
+
+    if (!cursor || (cursor->device_id >= BACNET_MAX_INSTANCE)) {
+        return false;
+    }
+    log = bacnet_backfill_log(
+        cursor->device_id, cursor->object_type, cursor->object_instance);
+    if (log) {
+        if (log->state != BACNET_BACKFILL_WAITING) {
+            log->cursor.sequence = cursor->sequence;
+        }
+        return true;
+    }
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        log = &Backfill_Log[i];
+        if (!log->valid) {
+            memset(log, 0, sizeof(*log));
+            log->cursor = *cursor;
+            log->state = BACNET_BACKFILL_IDLE;
+            log->valid = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Stop backfilling a log
+ * @param device_id [in] device instance of the log
+ * @param object_type [in] object type of the log
+ * @param object_instance [in] object instance of the log
+ * @return true if the log was removed
+ */
+bool bacnet_backfill_remove(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    BACKFILL_LOG *log;
+
+    log = bacnet_backfill_log(device_id, object_type, object_instance);
+    if (!log) {
+        return false;
+    }
+    if (log->state == BACNET_BACKFILL_WAITING) {
+        tsm_free_invoke_id(log->invoke_id);
+    }
+    log->valid = false;
+
+    return true;
+}
+
+/**
+ * @brief Get the number of logs that are backfilled
+ * @return number of logs
+ */
+unsigned bacnet_backfill_count(void)
+{
+    unsigned i, count = 0;
+
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        if (Backfill_Log[i].valid) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Get the cursor of a log, such as to persist every cursor
+ * @param index [in] 0..bacnet_backfill_count()-1
+ * @param cursor [out] the log, and the sequence number of its next record
+ * @return true if the cursor was found
+ */
+bool bacnet_backfill_cursor(unsigned index, BACNET_BACKFILL_CURSOR *cursor)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_BACKFILL_LOG_MAX; i++) {
+        if (Backfill_Log[i].valid) {
+            if (index == 0) {
+                if (cursor) {
+                    *cursor = Backfill_Log[i].cursor;
+                }
+                return true;
+            }
+            index--;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Sets the callback for each record that is read
+ * @param callback - function for callback
+ */
+void bacnet_backfill_record_callback_set(
+    bacnet_backfill_record_callback_t callback)
+{
+    Backfill_Record_Callback = callback;
+}
+
+/**
+ * @brief Sets the callback for each cursor that advances
+ * @param callback - function for callback
+ */
+void bacnet_backfill_cursor_callback_set(
+    bacnet_backfill_cursor_callback_t callback)
+{
+    Backfill_Cursor_Callback = callback;
+}
+
+/**
+ * @brief Sets the callback for each request that fails
+ * @param callback - function for callback
+ */
+void bacnet_backfill_error_callback_set(
+    bacnet_backfill_error_callback_t callback)
+{
+    Backfill_Error_Callback = callback;
+}
+
+/**
+ * @brief Sets the number of requests in progress at once
+ * @param window - 1..BACNET_BACKFILL_WINDOW_MAX
+ */
+void bacnet_backfill_window_set(unsigned window)
+{
+    if (window < 1) {
+        window = 1;
+    } else if (window > BACNET_BACKFILL_WINDOW_MAX) {
+        window = BACNET_BACKFILL_WINDOW_MAX;
+    }
+    Backfill_Window = window;
+}
+
+/**
+ * @brief Gets the number of requests in progress at once
+ * @return the window
+ */
+unsigned bacnet_backfill_window(void)
+{
+    return Backfill_Window;
+}
+
+/**
+ * @brief Sets the time that a log with no more records rests
+ * @param milliseconds - time before the log is read again
+ */
+void bacnet_backfill_interval_set(unsigned long milliseconds)
+{
+    Backfill_Interval = milliseconds;
+}
+
+/**
+ * @brief Gets the time that a log with no more records rests
+ * @return milliseconds before the log is read again
+ */
+unsigned long bacnet_backfill_interval(void)
+{
+    return Backfill_Interval;
+}
+
+/**
+ * @brief Initializes the backfill module, and handles the I-Am, the
+ *  ReadRange-ACK, and the ReadRange Error replies
+ */
+void bacnet_backfill_init(void)
+{
+    memset(Backfill_Log, 0, sizeof(Backfill_Log));
+    Backfill_Next = 0;
+    /* handle i-am to support binding to other devices */
+    apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, handler_i_am_bind);
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_RANGE, bacnet_backfill_ack_handler);
+    apdu_set_error_handler(
+        SERVICE_CONFIRMED_READ_RANGE, bacnet_backfill_error_handler);
+}
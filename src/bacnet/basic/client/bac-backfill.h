@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief API to backfill the records of Trend Log objects in other
+ *  BACnet devices, using ReadRange by sequence number from a cursor
+ *  kept for each log
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_CLIENT_BACKFILL_H
+#define BACNET_BASIC_CLIENT_BACKFILL_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/baclog.h"
+
+/* largest number of logs that are backfilled */
+#ifndef BACNET_BACKFILL_LOG_MAX
+#define BACNET_BACKFILL_LOG_MAX 64
+#endif
+
+/* largest number of ReadRange requests in progress at once */
+#ifndef BACNET_BACKFILL_WINDOW_MAX
+#define BACNET_BACKFILL_WINDOW_MAX 16
+#endif
+
+/**
+ * Where the backfill of one log stands, which the application persists
+ * so that a restart resumes from the next record not yet read.
+ */
+typedef struct bacnet_backfill_cursor {
+    uint32_t device_id;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    /* sequence number of the next record to read, or zero to start
+       from the oldest record in the log */
+    uint32_t sequence;
+} BACNET_BACKFILL_CURSOR;
+
+/**
+ * Save one record of a log to a data store
+ *
+ * @param cursor [in] the log, with the sequence number of this record
+ * @param record [in] the decoded record
+ */
+typedef void (*bacnet_backfill_record_callback_t)(
+    const BACNET_BACKFILL_CURSOR *cursor, const BACNET_LOG_RECORD *record);
+
+/**
+ * Persist the cursor of a log, after the records of a ReadRange-ACK
+ * have all been passed to the record callback
+ *
+ * @param cursor [in] the log, with the sequence number of its next record
+ * @param caught_up [in] true if the log has no more records to read
+ */
+typedef void (*bacnet_backfill_cursor_callback_t)(
+    const BACNET_BACKFILL_CURSOR *cursor, bool caught_up);
+
+/**
+ * Report a ReadRange request of a log that failed
+ *
+ * @param cursor [in] the log
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+typedef void (*bacnet_backfill_error_callback_t)(
+    const BACNET_BACKFILL_CURSOR *cursor,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void bacnet_backfill_init(void);
+BACNET_STACK_EXPORT
+void bacnet_backfill_task(void);
+BACNET_STACK_EXPORT
+bool bacnet_backfill_idle(void);
+
+BACNET_STACK_EXPORT
+bool bacnet_backfill_add(const BACNET_BACKFILL_CURSOR *cursor);
+BACNET_STACK_EXPORT
+bool bacnet_backfill_remove(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned bacnet_backfill_count(void);
+BACNET_STACK_EXPORT
+bool bacnet_backfill_cursor(unsigned index, BACNET_BACKFILL_CURSOR *cursor);
+
+BACNET_STACK_EXPORT
+void bacnet_backfill_record_callback_set(
+    bacnet_backfill_record_callback_t callback);
+BACNET_STACK_EXPORT
+void bacnet_backfill_cursor_callback_set(
+    bacnet_backfill_cursor_callback_t callback);
+BACNET_STACK_EXPORT
+void bacnet_backfill_error_callback_set(
+    bacnet_backfill_error_callback_t callback);
+
+BACNET_STACK_EXPORT
+void bacnet_backfill_window_set(unsigned window);
+BACNET_STACK_EXPORT
+unsigned bacnet_backfill_window(void);
+BACNET_STACK_EXPORT
+void bacnet_backfill_interval_set(unsigned long milliseconds);
+BACNET_STACK_EXPORT
+unsigned long bacnet_backfill_interval(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -7,23 +7,56 @@
  */
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/basic/sys/mstimer.h"
 /* us */
 #include "bacnet/basic/client/bac-rw.h"
 #include "bacnet/basic/client/bac-data.h"
 
-/* number of objects data stored */
+/* largest number of objects data stored - the store grows on demand */
 #ifndef BACNET_DATA_OBJECT_MAX
-#define BACNET_DATA_OBJECT_MAX 16
+#define BACNET_DATA_OBJECT_MAX 65536UL
 #endif
-/* Polling interval timer */
-static struct mstimer Object_Poll_Timer;
+/* number of objects in the store when it is first allocated */
+#ifndef BACNET_DATA_OBJECT_MIN
+#define BACNET_DATA_OBJECT_MIN 16UL
+#endif
+/* polling interval of objects without their own interval */
+static unsigned long Poll_Milliseconds = 60UL * 1000UL;
 /* property R/W process interval timer */
 static struct mstimer Read_Write_Timer;
+/* SubscribeCOV lifetime in seconds, or zero to poll every object */
+static uint32_t COV_Lifetime;
+/* the subscriptions are renewed at 3/4 of their lifetime, rounded up to
+   a multiple of this period so that they are renewed together */
+#ifndef BACNET_DATA_COV_BATCH_MS
+#define BACNET_DATA_COV_BATCH_MS 10000UL
+#endif
+/* number of devices remembered that do not accept SubscribeCOV */
+#ifndef BACNET_DATA_COV_DENY_MAX
+#define BACNET_DATA_COV_DENY_MAX 32
+#endif
+static uint32_t COV_Deny[BACNET_DATA_COV_DENY_MAX];
+static unsigned COV_Deny_Count;
+/* the polling interval doubles up to this many times while the polled
+   value of an object without COV does not change */
+#ifndef BACNET_DATA_POLL_BACKOFF_MAX
+#define BACNET_DATA_POLL_BACKOFF_MAX 2
+#endif
+/* COV states of an object */
+typedef enum bacnet_data_cov_state {
+    BACNET_DATA_COV_NONE = 0,
+    BACNET_DATA_COV_SUBSCRIBING,
+    BACNET_DATA_COV_SUBSCRIBED,
+    BACNET_DATA_COV_DENIED
+} BACNET_DATA_COV_STATE;
 
 /* variables for remote BACnet Object Data */
 typedef struct bacnet_object_data {
@@ -41,9 +74,181 @@ typedef struct bacnet_object_data {
             uint32_t Enumerated;
         } type;
     } Present_Value;
-    bool refresh;
+    /* polling interval, or zero for the default interval */
+    unsigned long Poll_Interval;
+    /* time of the next read */
+    unsigned long Poll_Deadline;
+    /* lower values are read first when several objects are due */
+    uint8_t Poll_Priority;
+    /* position in the deadline heap, or BACNET_DATA_HEAP_NONE */
+    uint32_t Heap_Position;
+    /* BACNET_DATA_COV_STATE of the object */
+    uint8_t COV_State;
+    /* number of times the polling interval is doubled */
+    uint8_t Poll_Backoff;
 } BACNET_DATA_OBJECT;
-static BACNET_DATA_OBJECT Object_Table[BACNET_DATA_OBJECT_MAX];
+static BACNET_DATA_OBJECT *Object_Table;
+static uint32_t Object_Count;
+static uint32_t Object_Capacity;
+/* open addressing hash of the object index plus one, or zero if empty */
+static uint32_t *Object_Hash;
+static uint32_t Object_Hash_Size;
+
+/* binary heap of object indexes */
+#define BACNET_DATA_HEAP_NONE UINT32_MAX
+typedef struct bacnet_data_heap {
+    uint32_t *index;
+    uint32_t count;
+    /* true if the heap is ordered by deadline, false if by priority */
+    bool deadline;
+} BACNET_DATA_HEAP;
+/* objects waiting for their deadline */
+static BACNET_DATA_HEAP Poll_Heap = { NULL, 0, true };
+/* objects that are due, waiting for room in the read queue */
+static BACNET_DATA_HEAP Ready_Heap = { NULL, 0, false };
+
+/**
+ * @brief Determine if one heap element goes before another
+ * @param heap - heap of object indexes
+ * @param a - object index
+ * @param b - object index
+ * @return true if a goes before b
+ */
+static bool
+bacnet_data_heap_before(const BACNET_DATA_HEAP *heap, uint32_t a, uint32_t b)
+{
+    const BACNET_DATA_OBJECT *object_a = &Object_Table[a];
+    const BACNET_DATA_OBJECT *object_b = &Object_Table[b];
+
+    if (!heap->deadline &&
+        (object_a->Poll_Priority != object_b->Poll_Priority)) {
+        return object_a->Poll_Priority < object_b->Poll_Priority;
+    }
+
+    return (long)(object_a->Poll_Deadline - object_b->Poll_Deadline) < 0;
+}
+
+/**
+ * @brief Store an object index at a heap position
+ * @param heap - heap of object indexes
+ * @param position - heap position
+ * @param index - object index
+ */
+static void bacnet_data_heap_store(
+    BACNET_DATA_HEAP *heap, uint32_t position, uint32_t index)
+{
+    heap->index[position] = index;
+    if (heap->deadline) {
+        Object_Table[index].Heap_Position = position;
+    }
+}
+
+/**
+ * @brief Move a heap element up or down until the heap is ordered
+ * @param heap - heap of object indexes
+ * @param position - heap position of the element
+ */
+static void bacnet_data_heap_sift(BACNET_DATA_HEAP *heap, uint32_t position)
+{
+    uint32_t index = heap->index[position];
+    uint32_t parent, child;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (!bacnet_data_heap_before(heap, index, heap->index[parent])) {
+            break;
+        }
+        bacnet_data_heap_store(heap, position, heap->index[parent]);
+        position = parent;
+    }
+    for (;;) {
+        child = (2 * position) + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (((child + 1) < heap->count) &&
+            bacnet_data_heap_before(
+                heap, heap->index[child + 1], heap->index[child])) {
+            child++;
+        }
+        if (!bacnet_data_heap_before(heap, heap->index[child], index)) {
+            break;
+        }
+        bacnet_data_heap_store(heap, position, heap->index[child]);
+        position = child;
+    }
+    bacnet_data_heap_store(heap, position, index);
+}
+
+/**
+ * @brief Add an object index to a heap
+ * @param heap - heap of object indexes, with room for every object
+ * @param index - object index
+ */
+static void bacnet_data_heap_push(BACNET_DATA_HEAP *heap, uint32_t index)
+{
+    heap->count++;
+    bacnet_data_heap_store(heap, heap->count - 1, index);
+    bacnet_data_heap_sift(heap, heap->count - 1);
+}
+
+/**
+ * @brief Remove the first object index from a heap
+ * @param heap - heap of object indexes, not empty
+ * @return object index
+ */
+static uint32_t bacnet_data_heap_pop(BACNET_DATA_HEAP *heap)
+{
+    uint32_t index = heap->index[0];
+
+    heap->count--;
+    if (heap->count > 0) {
+        bacnet_data_heap_store(heap, 0, heap->index[heap->count]);
+        bacnet_data_heap_sift(heap, 0);
+    }
+    if (heap->deadline) {
+        Object_Table[index].Heap_Position = BACNET_DATA_HEAP_NONE;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Get the hash of an object for the hash table
+ * @param  device_instance - object-instance number of the device object
+ * @param  object_type - object type of the object
+ * @param  object_instance - object-instance number of the object
+ * @return hash value
+ */
+static uint32_t bacnet_data_object_hash(
+    uint32_t device_instance, uint16_t object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    hash = device_instance * 2654435761UL;
+    hash ^= ((uint32_t)object_type << 22) ^ object_instance;
+    hash *= 2246822519UL;
+
+    return hash ^ (hash >> 15);
+}
+
+/**
+ * @brief Add an object index to the hash table, which has room for it
+ * @param index - object index
+ */
+static void bacnet_data_object_hash_add(uint32_t index)
+{
+    const BACNET_DATA_OBJECT *object = &Object_Table[index];
+    uint32_t slot;
+
+    slot = bacnet_data_object_hash(
+        object->Device_ID, object->Object_Type, object->Object_ID);
+    slot &= (Object_Hash_Size - 1);
+    while (Object_Hash[slot]) {
+        slot = (slot + 1) & (Object_Hash_Size - 1);
+    }
+    Object_Hash[slot] = index + 1;
+}
 
 /**
  * @brief Find the index of a BACnet object type of a given instance.
@@ -56,40 +261,124 @@ static int bacnet_data_object_index_find(
     uint32_t device_instance, uint16_t object_type, uint32_t object_instance)
 {
     BACNET_DATA_OBJECT *object = NULL;
-    unsigned i = 0;
+    uint32_t slot;
 
-    for (i = 0; i < BACNET_DATA_OBJECT_MAX; i++) {
-        object = &Object_Table[i];
+    if (!Object_Hash) {
+        return BACNET_STATUS_ERROR;
+    }
+    slot = bacnet_data_object_hash(
+        device_instance, object_type, object_instance);
+    slot &= (Object_Hash_Size - 1);
+    while (Object_Hash[slot]) {
+        object = &Object_Table[Object_Hash[slot] - 1];
         if ((object->Device_ID == device_instance) &&
             (object->Object_Type == object_type) &&
             (object->Object_ID == object_instance)) {
-            return i;
+            return (int)(Object_Hash[slot] - 1);
         }
+        slot = (slot + 1) & (Object_Hash_Size - 1);
     }
 
     return BACNET_STATUS_ERROR;
 }
 
 /**
- * @brief Find a free index of an BACnet value object type
- * @return The index of a free element, or BACNET_STATUS_ERROR if
- *  no free elements exist
+ * @brief Free the store, the heaps, and the hash table, which keep their
+ *  pointers until the caller replaces them
  */
-static int bacnet_data_object_index_find_free(void)
+static void bacnet_data_object_free(void)
 {
-    BACNET_DATA_OBJECT *object = NULL;
-    unsigned i = 0;
-
-    for (i = 0; i < BACNET_DATA_OBJECT_MAX; i++) {
-        object = &Object_Table[i];
-        if ((object->Device_ID >= BACNET_MAX_INSTANCE) &&
-            (object->Object_Type == MAX_BACNET_OBJECT_TYPE) &&
-            (object->Object_ID >= BACNET_MAX_INSTANCE)) {
-            return i;
-        }
+    BACNET_MEMPOOL_FREE(
+        Object_Table, Object_Capacity * sizeof(BACNET_DATA_OBJECT));
+    BACNET_MEMPOOL_FREE(Poll_Heap.index, Object_Capacity * sizeof(uint32_t));
+    BACNET_MEMPOOL_FREE(Ready_Heap.index, Object_Capacity * sizeof(uint32_t));
+    BACNET_MEMPOOL_FREE(Object_Hash, Object_Hash_Size * sizeof(uint32_t));
+}
+
+/**
+ * @brief Make room in the store, the heaps, and the hash table for
+ *  another object, doubling them when they are full
+ * @return true if there is room for another object
+ */
+static bool bacnet_data_object_reserve(void)
+{
+    BACNET_DATA_OBJECT *table;
+    uint32_t *poll_index, *ready_index, *hash;
+    uint32_t capacity, hash_size, i;
+
+    if (Object_Count < Object_Capacity) {
+        return true;
+    }
+    capacity = Object_Capacity ? Object_Capacity * 2 : BACNET_DATA_OBJECT_MIN;
+    if (capacity > BACNET_DATA_OBJECT_MAX) {
+        capacity = BACNET_DATA_OBJECT_MAX;
+    }
+    if (capacity <= Object_Capacity) {
+        return false;
+    }
+    /* the hash table is a power of two, kept at most half full */
+    hash_size = 1;
+    while (hash_size < (capacity * 2)) {
+        hash_size *= 2;
+    }
+    /* everything is allocated before anything moves, so that each array
+       keeps the size that the capacity says when it is freed */
+    table = BACNET_MEMPOOL_CALLOC(capacity * sizeof(BACNET_DATA_OBJECT));
+    poll_index = BACNET_MEMPOOL_CALLOC(capacity * sizeof(uint32_t));
+    ready_index = BACNET_MEMPOOL_CALLOC(capacity * sizeof(uint32_t));
+    hash = BACNET_MEMPOOL_CALLOC(hash_size * sizeof(uint32_t));
+    if (!table || !poll_index || !ready_index || !hash) {
+        BACNET_MEMPOOL_FREE(table, capacity * sizeof(BACNET_DATA_OBJECT));
+        BACNET_MEMPOOL_FREE(poll_index, capacity * sizeof(uint32_t));
+        BACNET_MEMPOOL_FREE(ready_index, capacity * sizeof(uint32_t));
+        BACNET_MEMPOOL_FREE(hash, hash_size * sizeof(uint32_t));
+        return false;
+    }
+    if (Object_Capacity) {
+        memcpy(
+            table, Object_Table, Object_Capacity * sizeof(BACNET_DATA_OBJECT));
+        memcpy(
+            poll_index, Poll_Heap.index, Object_Capacity * sizeof(uint32_t));
+        memcpy(
+            ready_index, Ready_Heap.index,
+            Object_Capacity * sizeof(uint32_t));
     }
+    bacnet_data_object_free();
+    Object_Table = table;
+    Poll_Heap.index = poll_index;
+    Ready_Heap.index = ready_index;
+    Object_Hash = hash;
+    Object_Hash_Size = hash_size;
+    for (i = 0; i < Object_Count; i++) {
+        bacnet_data_object_hash_add(i);
+    }
+    Object_Capacity = capacity;
 
-    return BACNET_STATUS_ERROR;
+    return true;
+}
+
+/**
+ * @brief Get the polling interval of an object
+ * @param object - BACnet object structure data pointer
+ * @return polling interval in milliseconds
+ */
+static unsigned long
+bacnet_data_object_interval(const BACNET_DATA_OBJECT *object)
+{
+    unsigned long interval = object->Poll_Interval;
+
+    if (interval == 0) {
+        interval = Poll_Milliseconds;
+    }
+    if (interval == 0) {
+        interval = 1;
+    }
+    if (COV_Lifetime > 0) {
+        /* adaptive polling of the objects without COV */
+        interval <<= object->Poll_Backoff;
+    }
+
+    return interval;
 }
 
 /**
@@ -97,15 +386,43 @@ static int bacnet_data_object_index_find_free(void)
  */
 static void bacnet_data_object_init(void)
 {
-    unsigned i = 0;
-    BACNET_DATA_OBJECT *object = NULL;
+    bacnet_data_object_free();
+    Object_Table = NULL;
+    Object_Hash = NULL;
+    Object_Hash_Size = 0;
+    Poll_Heap.index = NULL;
+    Poll_Heap.count = 0;
+    Ready_Heap.index = NULL;
+    Ready_Heap.count = 0;
+    Object_Count = 0;
+    Object_Capacity = 0;
+    COV_Deny_Count = 0;
+}
 
-    for (i = 0; i < BACNET_DATA_OBJECT_MAX; i++) {
-        object = &Object_Table[i];
-        object->Device_ID = BACNET_MAX_INSTANCE;
-        object->Object_Type = MAX_BACNET_OBJECT_TYPE;
-        object->Object_ID = BACNET_MAX_INSTANCE;
+/**
+ * @brief Compare two stored present values
+ * @param a - present value
+ * @param b - present value
+ * @return true if the values are the same
+ */
+static bool bacnet_data_present_value_same(
+    const struct bacnet_present_value *a, const struct bacnet_present_value *b)
+{
+    if (a->tag != b->tag) {
+        return false;
+    }
+    switch (a->tag) {
+        case BACNET_APPLICATION_TAG_REAL:
+            return !islessgreater(a->type.Real, b->type.Real);
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            return a->type.Unsigned_Int == b->type.Unsigned_Int;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            return a->type.Enumerated == b->type.Enumerated;
+        default:
+            break;
     }
+
+    return false;
 }
 
 static void bacnet_data_object_store(
@@ -114,13 +431,16 @@ static void bacnet_data_object_store(
     const BACNET_APPLICATION_DATA_VALUE *value)
 {
     BACNET_DATA_OBJECT *object = NULL;
+    struct bacnet_present_value previous;
 
     assert(rp_data != NULL);
     assert(value != NULL);
-    if ((index < BACNET_DATA_OBJECT_MAX) && (!value->context_specific)) {
+    if ((index >= 0) && ((uint32_t)index < Object_Count) &&
+        (!value->context_specific)) {
         object = &Object_Table[index];
         switch (rp_data->object_property) {
             case PROP_PRESENT_VALUE:
+                previous = object->Present_Value;
                 if (value->tag == BACNET_APPLICATION_TAG_REAL) {
                     object->Present_Value.tag = value->tag;
                     object->Present_Value.type.Real = value->type.Real;
@@ -135,11 +455,18 @@ static void bacnet_data_object_store(
                     object->Present_Value.type.Enumerated =
                         value->type.Enumerated;
                 }
+                if (bacnet_data_present_value_same(
+                        &previous, &object->Present_Value)) {
+                    if (object->Poll_Backoff < BACNET_DATA_POLL_BACKOFF_MAX) {
+                        object->Poll_Backoff++;
+                    }
+                } else {
+                    object->Poll_Backoff = 0;
+                }
                 break;
             default:
                 break;
         }
-        object->refresh = false;
     }
 }
 
@@ -189,35 +516,23 @@ void bacnet_data_value_save(
 }
 
 /**
- * @brief Handles the BACnet Data Analog Value processing
- * @param object - BACnet object structure data pointer
- */
-static void bacnet_data_object_process(const BACNET_DATA_OBJECT *object)
-{
-    if (object && (object->Device_ID < BACNET_MAX_INSTANCE) &&
-        (object->Object_ID < BACNET_MAX_INSTANCE)) {
-        bacnet_read_property_queue(
-            object->Device_ID, (BACNET_OBJECT_TYPE)object->Object_Type,
-            object->Object_ID, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
-    }
-}
-
-/**
- * @brief Adds a BACnet Data remote value point
+ * @brief Adds a BACnet Data remote value point, or finds it
  * @param device_id - ID of the destination device
  * @param object_type - Type of the object whose property is to be read.
  * @param object_instance - Instance # of the object to be read.
- * @return true if added or existing, false if not added or existing
+ * @param added [out] true if the point was added
+ * @return object index, or BACNET_STATUS_ERROR if not added or existing
  */
-bool bacnet_data_object_add(
+static int bacnet_data_object_index_add(
     uint32_t device_id,
     BACNET_OBJECT_TYPE object_type,
-    uint32_t object_instance)
+    uint32_t object_instance,
+    bool *added)
 {
     BACNET_DATA_OBJECT *object = NULL;
-    bool status = false;
-    int index = 0;
+    int index = BACNET_STATUS_ERROR;
 
+    *added = false;
     switch (object_type) {
         case OBJECT_ANALOG_INPUT:
         case OBJECT_ANALOG_OUTPUT:
@@ -228,22 +543,24 @@ bool bacnet_data_object_add(
         case OBJECT_MULTI_STATE_INPUT:
         case OBJECT_MULTI_STATE_OUTPUT:
         case OBJECT_MULTI_STATE_VALUE:
+            if ((device_id >= BACNET_MAX_INSTANCE) ||
+                (object_instance >= BACNET_MAX_INSTANCE)) {
+                break;
+            }
             index = bacnet_data_object_index_find(
                 device_id, object_type, object_instance);
-            if (index == BACNET_STATUS_ERROR) {
-                index = bacnet_data_object_index_find_free();
-                if (index != BACNET_STATUS_ERROR) {
-                    object = &Object_Table[index];
-                    object->Device_ID = device_id;
-                    object->Object_Type = object_type;
-                    object->Object_ID = object_instance;
-                    object->refresh = true;
-                    status = true;
-                }
-            } else {
+            if ((index == BACNET_STATUS_ERROR) &&
+                bacnet_data_object_reserve()) {
+                index = (int)Object_Count;
                 object = &Object_Table[index];
-                object->refresh = true;
-                status = true;
+                memset(object, 0, sizeof(BACNET_DATA_OBJECT));
+                object->Device_ID = device_id;
+                object->Object_Type = object_type;
+                object->Object_ID = object_instance;
+                object->Heap_Position = BACNET_DATA_HEAP_NONE;
+                Object_Count++;
+                bacnet_data_object_hash_add((uint32_t)index);
+                *added = true;
             }
             break;
         case OBJECT_DEVICE:
@@ -251,7 +568,105 @@ bool bacnet_data_object_add(
             break;
     }
 
-    return status;
+    return index;
+}
+
+/**
+ * @brief Schedule the next read of an object at a deadline
+ * @param index - object index, which is not in either heap
+ * @param deadline - time of the next read
+ */
+static void bacnet_data_object_schedule(uint32_t index, unsigned long deadline)
+{
+    Object_Table[index].Poll_Deadline = deadline;
+    bacnet_data_heap_push(&Poll_Heap, index);
+}
+
+/**
+ * @brief Read an object that is waiting for its deadline right away
+ * @param index - object index
+ */
+static void bacnet_data_object_refresh(uint32_t index)
+{
+    BACNET_DATA_OBJECT *object = &Object_Table[index];
+    uint32_t position = object->Heap_Position;
+
+    if (position != BACNET_DATA_HEAP_NONE) {
+        object->Poll_Deadline = mstimer_now();
+        bacnet_data_heap_sift(&Poll_Heap, position);
+    }
+}
+
+/**
+ * @brief Adds a BACnet Data remote value point with its own polling
+ *  interval and priority, or changes them for an existing point.
+ *  A new point is first read at a random time within its interval, so
+ *  that many points added at once are spread out instead of read at once.
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be read.
+ * @param object_instance - Instance # of the object to be read.
+ * @param milliseconds - polling interval, or zero for the default interval
+ * @param priority - lower values are read first when several points are due
+ * @return true if added or existing, false if not added or existing
+ */
+bool bacnet_data_object_poll_set(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    unsigned long milliseconds,
+    uint8_t priority)
+{
+    BACNET_DATA_OBJECT *object = NULL;
+    unsigned long interval;
+    bool added = false;
+    int index;
+
+    index = bacnet_data_object_index_add(
+        device_id, object_type, object_instance, &added);
+    if (index == BACNET_STATUS_ERROR) {
+        return false;
+    }
+    object = &Object_Table[index];
+    object->Poll_Interval = milliseconds;
+    object->Poll_Priority = priority;
+    if (added) {
+        interval = bacnet_data_object_interval(object);
+        bacnet_data_object_schedule(
+            (uint32_t)index,
+            mstimer_now() + ((unsigned long)rand() % interval));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Adds a BACnet Data remote value point, polled at the default
+ *  interval, and reads it right away if it already exists
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be read.
+ * @param object_instance - Instance # of the object to be read.
+ * @return true if added or existing, false if not added or existing
+ */
+bool bacnet_data_object_add(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    bool added = false;
+    int index;
+
+    index = bacnet_data_object_index_add(
+        device_id, object_type, object_instance, &added);
+    if (index == BACNET_STATUS_ERROR) {
+        return false;
+    }
+    if (added) {
+        bacnet_data_object_schedule((uint32_t)index, mstimer_now());
+    } else {
+        bacnet_data_object_refresh((uint32_t)index);
+    }
+
+    return true;
 }
 
 /**
@@ -363,45 +778,179 @@ bool bacnet_data_multistate_present_value(
 }
 
 /**
- * @brief Handles the BACnet Data repetitive task
+ * @brief Determine if a device does not accept SubscribeCOV
+ * @param device_id - device instance
+ * @return true if the device does not accept SubscribeCOV
  */
-void bacnet_data_task(void)
+static bool bacnet_data_cov_denied(uint32_t device_id)
 {
-    static unsigned object_index = 0;
-    BACNET_DATA_OBJECT *object = NULL;
-    unsigned i = 0;
+    unsigned i;
 
-    if (mstimer_expired(&Object_Poll_Timer)) {
-        mstimer_reset(&Object_Poll_Timer);
-        for (i = 0; i < BACNET_DATA_OBJECT_MAX; i++) {
-            object = &Object_Table[i];
-            object->refresh = true;
+    for (i = 0; i < COV_Deny_Count; i++) {
+        if (COV_Deny[i] == device_id) {
+            return true;
         }
     }
+
+    return false;
+}
+
+/**
+ * @brief Determine if an object is to be subscribed instead of polled
+ * @param object - BACnet object structure data pointer
+ * @return true if the object is to be subscribed
+ */
+static bool bacnet_data_object_cov(const BACNET_DATA_OBJECT *object)
+{
+    return (COV_Lifetime > 0) &&
+        (object->COV_State != BACNET_DATA_COV_DENIED) &&
+        !bacnet_data_cov_denied(object->Device_ID);
+}
+
+/**
+ * @brief Handles the BACnet Data repetitive task.  Objects that are due
+ *  are read in order of priority while the read queue has room, and each
+ *  is scheduled one interval after its last deadline, so that the reads
+ *  keep their spread.
+ */
+void bacnet_data_task(void)
+{
+    BACNET_DATA_OBJECT *object = NULL;
+    unsigned long now, interval;
+    uint32_t index;
+    bool status;
+
     if (mstimer_expired(&Read_Write_Timer)) {
         mstimer_reset(&Read_Write_Timer);
         bacnet_read_write_task();
     }
-    if (bacnet_read_write_idle()) {
-        object = &Object_Table[object_index];
-        if (object->refresh) {
-            object->refresh = false;
-            bacnet_data_object_process(object);
+    now = mstimer_now();
+    while (Poll_Heap.count > 0) {
+        object = &Object_Table[Poll_Heap.index[0]];
+        if ((long)(now - object->Poll_Deadline) < 0) {
+            break;
+        }
+        bacnet_data_heap_push(&Ready_Heap, bacnet_data_heap_pop(&Poll_Heap));
+    }
+    while ((Ready_Heap.count > 0) && !bacnet_read_write_busy()) {
+        object = &Object_Table[Ready_Heap.index[0]];
+        if (bacnet_data_object_cov(object)) {
+            status = bacnet_subscribe_cov_queue(
+                object->Device_ID, (BACNET_OBJECT_TYPE)object->Object_Type,
+                object->Object_ID, COV_Lifetime);
+        } else {
+            status = bacnet_read_property_queue(
+                object->Device_ID, (BACNET_OBJECT_TYPE)object->Object_Type,
+                object->Object_ID, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+        }
+        if (!status) {
+            break;
+        }
+        index = bacnet_data_heap_pop(&Ready_Heap);
+        if (bacnet_data_object_cov(object)) {
+            /* renew before the subscription expires */
+            object->COV_State = BACNET_DATA_COV_SUBSCRIBING;
+            interval = (unsigned long)COV_Lifetime * 750UL;
+            interval += BACNET_DATA_COV_BATCH_MS -
+                ((now + interval) % BACNET_DATA_COV_BATCH_MS);
+            bacnet_data_object_schedule(index, now + interval);
+            continue;
         }
-        object_index++;
-        if (object_index >= BACNET_DATA_OBJECT_MAX) {
-            object_index = 0;
+        interval = bacnet_data_object_interval(object);
+        if ((long)(now - (object->Poll_Deadline + interval)) >= 0) {
+            /* too far behind to catch up - start again from now */
+            bacnet_data_object_schedule(index, now + interval);
+        } else {
+            bacnet_data_object_schedule(
+                index, object->Poll_Deadline + interval);
         }
     }
 }
 
 /**
- * @brief Set the BACnet Data Poll seconds
+ * @brief Handle the end of a SubscribeCOV request.  An object that does
+ *  not support COV, or a device that does not accept SubscribeCOV, is
+ *  polled instead.
+ * @param device_id [in] Device instance number
+ * @param invoke_id [in] invoke ID of the request
+ * @param rp_data [in] the request and its error code
+ * @param array_count [in] number of array elements in the request
+ * @param milliseconds [in] time from sending the request until its reply
+ */
+static void bacnet_data_request_complete(
+    uint32_t device_id,
+    uint8_t invoke_id,
+    const BACNET_READ_PROPERTY_DATA *rp_data,
+    uint32_t array_count,
+    unsigned long milliseconds)
+{
+    BACNET_DATA_OBJECT *object;
+    int index;
+
+    (void)invoke_id;
+    (void)array_count;
+    (void)milliseconds;
+    index = bacnet_data_object_index_find(
+        device_id, rp_data->object_type, rp_data->object_instance);
+    if (index == BACNET_STATUS_ERROR) {
+        return;
+    }
+    object = &Object_Table[index];
+    if (object->COV_State != BACNET_DATA_COV_SUBSCRIBING) {
+        return;
+    }
+    if (rp_data->error_code == ERROR_CODE_SUCCESS) {
+        object->COV_State = BACNET_DATA_COV_SUBSCRIBED;
+        return;
+    }
+    if ((rp_data->error_code == ERROR_CODE_TIMEOUT) ||
+        (rp_data->error_code == ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+        /* poll now, and subscribe again at the next deadline */
+        object->COV_State = BACNET_DATA_COV_NONE;
+    } else if (rp_data->error_class == ERROR_CLASS_OBJECT) {
+        /* this object does not support COV */
+        object->COV_State = BACNET_DATA_COV_DENIED;
+    } else {
+        /* this device does not accept SubscribeCOV */
+        object->COV_State = BACNET_DATA_COV_DENIED;
+        if ((COV_Deny_Count < BACNET_DATA_COV_DENY_MAX) &&
+            !bacnet_data_cov_denied(device_id)) {
+            COV_Deny[COV_Deny_Count] = device_id;
+            COV_Deny_Count++;
+        }
+    }
+    bacnet_data_object_refresh((uint32_t)index);
+}
+
+/**
+ * @brief Set the lifetime of the SubscribeCOV of each object, which makes
+ *  COV the first choice to acquire the present value of the objects.
+ *  Objects or devices that do not accept SubscribeCOV are polled, with an
+ *  interval that doubles while their value does not change.
+ * @param seconds - lifetime of the subscriptions, or zero to poll
+ */
+void bacnet_data_cov_lifetime_set(uint32_t seconds)
+{
+    COV_Lifetime = seconds;
+}
+
+/**
+ * @brief Get the lifetime of the SubscribeCOV of each object
+ * @return lifetime of the subscriptions in seconds, or zero if polling
+ */
+uint32_t bacnet_data_cov_lifetime(void)
+{
+    return COV_Lifetime;
+}
+
+/**
+ * @brief Set the BACnet Data Poll seconds of the objects that do not
+ *  have their own polling interval
  * @param seconds - number of seconds between polling intervals
  */
 void bacnet_data_poll_seconds_set(unsigned int seconds)
 {
-    mstimer_set(&Object_Poll_Timer, seconds * 1000);
+    Poll_Milliseconds = (unsigned long)seconds * 1000UL;
 }
 
 /**
@@ -410,7 +959,16 @@ void bacnet_data_poll_seconds_set(unsigned int seconds)
  */
 unsigned int bacnet_data_poll_seconds(void)
 {
-    return mstimer_interval(&Object_Poll_Timer) * 1000;
+    return (unsigned int)(Poll_Milliseconds / 1000UL);
+}
+
+/**
+ * @brief Get the number of BACnet Data remote value points
+ * @return number of points
+ */
+unsigned int bacnet_data_object_count(void)
+{
+    return Object_Count;
 }
 
 /**
@@ -420,8 +978,7 @@ void bacnet_data_init(void)
 {
     bacnet_data_object_init();
     bacnet_read_write_init();
-    /* start the cyclic poll timer */
-    mstimer_set(&Object_Poll_Timer, 1 * 60 * 1000);
     mstimer_set(&Read_Write_Timer, 10);
     bacnet_read_write_value_callback_set(bacnet_data_value_save);
+    bacnet_read_write_complete_callback_set(bacnet_data_request_complete);
 }
@@ -35,6 +35,10 @@ void bacnet_data_poll_seconds_set(unsigned int seconds);
 BACNET_STACK_EXPORT
 unsigned int bacnet_data_poll_seconds(void);
 BACNET_STACK_EXPORT
+void bacnet_data_cov_lifetime_set(uint32_t seconds);
+BACNET_STACK_EXPORT
+uint32_t bacnet_data_cov_lifetime(void);
+BACNET_STACK_EXPORT
 void bacnet_data_value_save(
     uint32_t device_instance,
     BACNET_READ_PROPERTY_DATA *rp_data,
@@ -45,6 +49,15 @@ bool bacnet_data_object_add(
     BACNET_OBJECT_TYPE object_type,
     uint32_t object_instance);
 BACNET_STACK_EXPORT
+bool bacnet_data_object_poll_set(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    unsigned long milliseconds,
+    uint8_t priority);
+BACNET_STACK_EXPORT
+unsigned int bacnet_data_object_count(void);
+BACNET_STACK_EXPORT
 bool bacnet_data_analog_present_value(
     uint32_t device_id,
     BACNET_OBJECT_TYPE object_type,
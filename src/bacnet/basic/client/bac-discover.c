@@ -16,9 +16,14 @@
 /* BACnet Stack API */
 #include "bacnet/bactext.h"
 #include "bacnet/bacapp.h"
+#include "bacnet/bacint.h"
+#include "bacnet/readrange.h"
 #include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/binding/capability.h"
+#include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/property.h"
 /* us */
@@ -35,10 +40,48 @@ static OS_Keylist Device_List = NULL;
 static BACNET_ADDRESS Target_DEST = { 0 };
 /* re-discovery time */
 static unsigned long Discovery_Milliseconds;
+/* number of devices discovered at once */
+#ifndef BACNET_DISCOVER_DEVICE_WINDOW
+#define BACNET_DISCOVER_DEVICE_WINDOW 4
+#endif
+static unsigned Device_Window = BACNET_DISCOVER_DEVICE_WINDOW;
+/* largest number of requests outstanding to each device */
+#ifndef BACNET_DISCOVER_REQUEST_WINDOW
+#define BACNET_DISCOVER_REQUEST_WINDOW 4
+#endif
+static unsigned Request_Window = BACNET_DISCOVER_REQUEST_WINDOW;
+/* number of passes to request the object-list elements that are missing */
+#ifndef BACNET_DISCOVER_RETRY_MAX
+#define BACNET_DISCOVER_RETRY_MAX 3
+#endif
+/* reply time above twice the fastest reply that closes the request window */
+#define BACNET_DISCOVER_LATENCY_SLACK_MS 50UL
+/* encoded size of an object-list element in a ReadPropertyMultiple-ACK,
+   and of the rest of the ACK, for sizing the object-list requests */
+#define BACNET_DISCOVER_RPM_ELEMENT_SIZE 12
+#define BACNET_DISCOVER_RPM_OVERHEAD_SIZE 20
+/* encoded size of an object-list journal item in a ReadRange-ACK */
+#define BACNET_DISCOVER_JOURNAL_ITEM_SIZE 7
+/* properties read from each object, from the most to the least, for
+   devices that are unable to return all the properties in one reply */
+static const BACNET_PROPERTY_ID Object_Read_Property[] = {
+    PROP_ALL, PROP_REQUIRED, PROP_OBJECT_NAME
+};
+#define BACNET_DISCOVER_READ_LEVEL_MAX \
+    ((sizeof(Object_Read_Property) / sizeof(Object_Read_Property[0])) - 1)
+/* where each discovered object and device is reported */
+static bacnet_discover_object_complete_callback Object_Complete_Callback;
+static bacnet_discover_device_complete_callback Device_Complete_Callback;
+/* snapshot file identifier and format version */
+#define BACNET_DISCOVER_SNAPSHOT_MAGIC 0x42445343UL
+#define BACNET_DISCOVER_SNAPSHOT_VERSION 1UL
 /* states of discovery */
 typedef enum bacnet_discover_state_enum {
     BACNET_DISCOVER_STATE_INIT = 0,
     BACNET_DISCOVER_STATE_BINDING,
+    BACNET_DISCOVER_STATE_SNAPSHOT_REQUEST,
+    BACNET_DISCOVER_STATE_JOURNAL_REVISION_REQUEST,
+    BACNET_DISCOVER_STATE_JOURNAL_REQUEST,
     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST,
     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST,
@@ -49,13 +92,18 @@ typedef enum bacnet_discover_state_enum {
     BACNET_DISCOVER_STATE_DONE
 } BACNET_DISCOVER_STATE;
 
+/* property values are kept encoded in an arena of their device */
 typedef struct bacnet_property_data_t {
-    uint8_t *application_data;
-    int application_data_len;
+    uint32_t property_id;
+    uint32_t offset;
+    uint32_t length;
 } BACNET_PROPERTY_DATA;
 
 typedef struct bacnet_object_data_t {
-    OS_Keylist Property_List;
+    /* array of properties, sorted by property identifier */
+    BACNET_PROPERTY_DATA *Property_List;
+    uint32_t Property_Count;
+    uint32_t Property_Capacity;
     /* used for discovering object data */
     uint32_t Property_List_Size;
     uint32_t Property_List_Index;
@@ -63,9 +111,45 @@ typedef struct bacnet_object_data_t {
 
 typedef struct bacnet_device_data_t {
     OS_Keylist Object_List;
+    /* encoded property values of the objects, and the bytes of the values
+       that were replaced which are reclaimed when the arena is compacted */
+    uint8_t *Arena;
+    uint32_t Arena_Size;
+    uint32_t Arena_Capacity;
+    uint32_t Arena_Unused;
     /* used for discovering device data */
     uint32_t Object_List_Size;
     uint32_t Object_List_Index;
+    /* bitmap of the object-list array elements received */
+    uint8_t *Object_List_Received;
+    uint32_t Object_List_Received_Size;
+    unsigned Object_List_Pass;
+    /* max APDU from the I-Am */
+    unsigned Max_APDU;
+    /* requests queued or in progress, and the adaptive request window */
+    unsigned Outstanding;
+    unsigned Window;
+    unsigned Completions;
+    unsigned Retry_Count;
+    unsigned long Latency_Min;
+    bool RPM_Unsupported;
+    /* index of the properties read from each object, learned from
+       the replies that were too large for the device */
+    unsigned Read_Level;
+    /* loaded from a snapshot, and not yet checked against the device */
+    bool Snapshot;
+    bool Snapshot_Revision_Valid;
+    uint32_t Snapshot_Revision;
+    uint32_t Snapshot_Object_List_Size;
+    BACNET_ERROR_CODE Snapshot_Error;
+    /* object-list is current as of the Journal_Revision, and is brought
+       up to date from the object-list journal of the device */
+    bool Journal_Valid;
+    bool Journal_Unsupported;
+    bool Journal_Error;
+    bool Journal_More;
+    uint32_t Journal_Revision;
+    uint32_t Journal_Target;
     /* timer and stats */
     struct mstimer Discovery_Timer;
     unsigned long Discovery_Elapsed_Milliseconds;
@@ -73,47 +157,197 @@ typedef struct bacnet_device_data_t {
 } BACNET_DEVICE_DATA;
 
 /**
- * @brief Add a ReadProperty reply data value to the property-list
- * @param list - Keylist to add the property to
- * @param key - BACnet property key
+ * @brief Find a property in the property-list of an object
+ * @param object - object with the property-list
+ * @param property_id - BACnet property identifier
+ * @return Pointer to the property data structure, or NULL if not found
+ */
+static BACNET_PROPERTY_DATA *bacnet_property_data(
+    const BACNET_OBJECT_DATA *object, uint32_t property_id)
+{
+    uint32_t low = 0, high, middle;
+
+    high = object->Property_Count;
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        if (object->Property_List[middle].property_id < property_id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if ((low < object->Property_Count) &&
+        (object->Property_List[low].property_id == property_id)) {
+        return &object->Property_List[low];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Add a property to the property-list of an object
+ * @param object - object with the property-list
+ * @param property_id - BACnet property identifier
  * @return Pointer to the property data structure
  */
-static BACNET_PROPERTY_DATA *bacnet_property_data_add(OS_Keylist list, KEY key)
+static BACNET_PROPERTY_DATA *
+bacnet_property_data_add(BACNET_OBJECT_DATA *object, uint32_t property_id)
 {
-    BACNET_PROPERTY_DATA *data = NULL;
-    int index;
+    BACNET_PROPERTY_DATA *list;
+    uint32_t index, capacity;
 
-    data = Keylist_Data(list, key);
-    if (!data) {
-        data = calloc(1, sizeof(BACNET_PROPERTY_DATA));
-        if (data) {
-            index = Keylist_Data_Add(list, key, data);
-            if (index < 0) {
-                free(data);
-                data = NULL;
+    for (index = 0; index < object->Property_Count; index++) {
+        if (object->Property_List[index].property_id >= property_id) {
+            break;
+        }
+    }
+    if ((index < object->Property_Count) &&
+        (object->Property_List[index].property_id == property_id)) {
+        return &object->Property_List[index];
+    }
+    if (object->Property_Count >= object->Property_Capacity) {
+        capacity = object->Property_Capacity ? object->Property_Capacity * 2
+                                             : 4;
+        list = BACNET_MEMPOOL_REALLOC(
+            object->Property_List,
+            object->Property_Capacity * sizeof(BACNET_PROPERTY_DATA),
+            capacity * sizeof(BACNET_PROPERTY_DATA));
+        if (!list) {
+            return NULL;
+        }
+        object->Property_List = list;
+        object->Property_Capacity = capacity;
+    }
+    memmove(
+        &object->Property_List[index + 1], &object->Property_List[index],
+        (object->Property_Count - index) * sizeof(BACNET_PROPERTY_DATA));
+    object->Property_List[index].property_id = property_id;
+    object->Property_List[index].offset = 0;
+    object->Property_List[index].length = 0;
+    object->Property_Count++;
+
+    return &object->Property_List[index];
+}
+
+/**
+ * @brief Get the encoded value of a property from the arena of its device
+ * @param device - device with the arena
+ * @param property - property data structure
+ * @return Pointer to the encoded value, or NULL if the value is empty
+ */
+static uint8_t *bacnet_property_data_value(
+    const BACNET_DEVICE_DATA *device, const BACNET_PROPERTY_DATA *property)
+{
+    if (property->length == 0) {
+        return NULL;
+    }
+
+    return &device->Arena[property->offset];
+}
+
+/**
+ * @brief Copy the property values of a device into a new arena without the
+ *  bytes of the values that were replaced
+ * @param device - device with the arena
+ * @param extra - number of bytes to reserve for a new value
+ * @return true if the arena was compacted
+ */
+static bool
+bacnet_device_arena_compact(BACNET_DEVICE_DATA *device, uint32_t extra)
+{
+    BACNET_OBJECT_DATA *object;
+    BACNET_PROPERTY_DATA *property;
+    uint8_t *arena;
+    uint32_t capacity, size = 0;
+    int object_count, object_index;
+    uint32_t i;
+
+    capacity = device->Arena_Size - device->Arena_Unused + extra;
+    capacity += capacity / 2;
+    arena = BACNET_MEMPOOL_CALLOC(capacity);
+    if (!arena) {
+        return false;
+    }
+    object_count = Keylist_Count(device->Object_List);
+    for (object_index = 0; object_index < object_count; object_index++) {
+        object = Keylist_Data_Index(device->Object_List, object_index);
+        if (!object) {
+            continue;
+        }
+        for (i = 0; i < object->Property_Count; i++) {
+            property = &object->Property_List[i];
+            if (property->length > 0) {
+                memcpy(
+                    &arena[size], &device->Arena[property->offset],
+                    property->length);
+                property->offset = size;
+                size += property->length;
             }
         }
     }
+    BACNET_MEMPOOL_FREE(device->Arena, device->Arena_Capacity);
+    device->Arena = arena;
+    device->Arena_Size = size;
+    device->Arena_Capacity = capacity;
+    device->Arena_Unused = 0;
 
-    return data;
+    return true;
 }
 
 /**
- * @brief Remove all the property data from the property-list
- * @param list - Keylist to remove the property from
+ * @brief Store the encoded value of a property in the arena of its device.
+ *  A value that fits in the place of the previous value is stored there.
+ * @param device - device with the arena
+ * @param property - property data structure
+ * @param data - encoded value
+ * @param length - number of bytes in the encoded value
+ * @return true if the value was stored
  */
-static void bacnet_property_data_cleanup(OS_Keylist list)
+static bool bacnet_property_data_store(
+    BACNET_DEVICE_DATA *device,
+    BACNET_PROPERTY_DATA *property,
+    const uint8_t *data,
+    uint32_t length)
 {
-    BACNET_PROPERTY_DATA *data = NULL;
+    uint8_t *arena;
+    uint32_t capacity;
 
-    do {
-        data = Keylist_Data_Pop(list);
-        if (data) {
-            free(data->application_data);
-            free(data);
+    if (length <= property->length) {
+        if (length > 0) {
+            memcpy(&device->Arena[property->offset], data, length);
         }
-    } while (data);
-    Keylist_Delete(list);
+        device->Arena_Unused += property->length - length;
+        property->length = length;
+        return true;
+    }
+    device->Arena_Unused += property->length;
+    property->length = 0;
+    if ((device->Arena_Capacity - device->Arena_Size) < length) {
+        if (device->Arena_Unused > (device->Arena_Size / 2)) {
+            if (!bacnet_device_arena_compact(device, length)) {
+                return false;
+            }
+        }
+        if ((device->Arena_Capacity - device->Arena_Size) < length) {
+            capacity = device->Arena_Capacity ? device->Arena_Capacity : 256;
+            while ((capacity - device->Arena_Size) < length) {
+                capacity *= 2;
+            }
+            arena = BACNET_MEMPOOL_REALLOC(
+                device->Arena, device->Arena_Capacity, capacity);
+            if (!arena) {
+                return false;
+            }
+            device->Arena = arena;
+            device->Arena_Capacity = capacity;
+        }
+    }
+    memcpy(&device->Arena[device->Arena_Size], data, length);
+    property->offset = device->Arena_Size;
+    property->length = length;
+    device->Arena_Size += length;
+
+    return true;
 }
 
 /**
@@ -133,14 +367,12 @@ static BACNET_OBJECT_DATA *bacnet_object_data_add(
     key = KEY_ENCODE(object_type, object_instance);
     data = Keylist_Data(list, key);
     if (!data) {
-        data = calloc(1, sizeof(BACNET_OBJECT_DATA));
+        data = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_OBJECT_DATA));
         if (data) {
-            data->Property_List = Keylist_Create();
-            data->Property_List_Size = 0;
-            data->Property_List_Index = 0;
+            /* other properties are already zeros */
             index = Keylist_Data_Add(list, key, data);
             if (index < 0) {
-                free(data);
+                BACNET_MEMPOOL_FREE(data, sizeof(*data));
                 data = NULL;
             }
         }
@@ -149,6 +381,35 @@ static BACNET_OBJECT_DATA *bacnet_object_data_add(
     return data;
 }
 
+/**
+ * @brief Remove an object and its property data from the object list
+ * @param device - device with the object list and the arena
+ * @param object_type - BACnet object type
+ * @param object_instance - BACnet object instance
+ */
+static void bacnet_object_data_remove(
+    BACNET_DEVICE_DATA *device,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    BACNET_OBJECT_DATA *data = NULL;
+    uint32_t i;
+    KEY key;
+
+    key = KEY_ENCODE(object_type, object_instance);
+    data = Keylist_Data_Delete(device->Object_List, key);
+    if (data) {
+        /* the values are reclaimed when the arena is compacted */
+        for (i = 0; i < data->Property_Count; i++) {
+            device->Arena_Unused += data->Property_List[i].length;
+        }
+        BACNET_MEMPOOL_FREE(
+            data->Property_List,
+            data->Property_Capacity * sizeof(BACNET_PROPERTY_DATA));
+        BACNET_MEMPOOL_FREE(data, sizeof(*data));
+    }
+}
+
 /**
  * @brief Add an object to the object list
  * @param list - Keylist to add the object to
@@ -176,8 +437,10 @@ static void bacnet_object_data_cleanup(OS_Keylist list)
     do {
         data = Keylist_Data_Pop(list);
         if (data) {
-            bacnet_property_data_cleanup(data->Property_List);
-            free(data);
+            BACNET_MEMPOOL_FREE(
+                data->Property_List,
+                data->Property_Capacity * sizeof(BACNET_PROPERTY_DATA));
+            BACNET_MEMPOOL_FREE(data, sizeof(*data));
         }
     } while (data);
     Keylist_Delete(list);
@@ -199,7 +462,7 @@ static BACNET_DEVICE_DATA *bacnet_device_data_add(uint32_t device_instance)
         data = Keylist_Data(Device_List, key);
         if (!data) {
             /* device is not in the list */
-            data = calloc(1, sizeof(BACNET_DEVICE_DATA));
+            data = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_DEVICE_DATA));
             if (data) {
                 data->Object_List = Keylist_Create();
                 data->Discovery_State = BACNET_DISCOVER_STATE_INIT;
@@ -208,7 +471,7 @@ static BACNET_DEVICE_DATA *bacnet_device_data_add(uint32_t device_instance)
                 /* add to list */
                 index = Keylist_Data_Add(Device_List, key, data);
                 if (index < 0) {
-                    free(data);
+                    BACNET_MEMPOOL_FREE(data, sizeof(*data));
                     data = NULL;
                 }
             }
@@ -246,7 +509,10 @@ void bacnet_discover_cleanup(void)
         data = Keylist_Data_Pop(Device_List);
         if (data) {
             bacnet_object_data_cleanup(data->Object_List);
-            free(data);
+            BACNET_MEMPOOL_FREE(data->Arena, data->Arena_Capacity);
+            BACNET_MEMPOOL_FREE(
+                data->Object_List_Received, data->Object_List_Received_Size);
+            BACNET_MEMPOOL_FREE(data, sizeof(*data));
         }
     } while (data);
     Keylist_Delete(Device_List);
@@ -337,29 +603,26 @@ bool bacnet_discover_device_object_identifier(
 size_t bacnet_discover_device_memory(uint32_t device_id)
 {
     size_t heap_size = 0;
-    size_t object_count = 0, property_count = 0;
-    size_t i, j;
+    size_t object_count = 0;
+    size_t i;
     KEY key = device_id;
     BACNET_DEVICE_DATA *device;
     BACNET_OBJECT_DATA *object;
-    BACNET_PROPERTY_DATA *property;
 
     device = Keylist_Data(Device_List, key);
     if (device) {
         heap_size += sizeof(BACNET_DEVICE_DATA);
+        if (device->Object_List_Received) {
+            heap_size += device->Object_List_Received_Size;
+        }
+        heap_size += device->Arena_Capacity;
         object_count = Keylist_Count(device->Object_List);
         heap_size += (object_count * sizeof(BACNET_OBJECT_DATA));
         for (i = 0; i < object_count; i++) {
             object = Keylist_Data_Index(device->Object_List, i);
             if (object) {
-                property_count = Keylist_Count(object->Property_List);
-                heap_size += (property_count * sizeof(BACNET_PROPERTY_DATA));
-                for (j = 0; j < property_count; j++) {
-                    property = Keylist_Data_Index(object->Property_List, j);
-                    if (property) {
-                        heap_size += property->application_data_len;
-                    }
-                }
+                heap_size +=
+                    (object->Property_Capacity * sizeof(BACNET_PROPERTY_DATA));
             }
         }
     }
@@ -417,14 +680,12 @@ bool bacnet_discover_property_value(
         key = KEY_ENCODE(object_type, object_instance);
         object = Keylist_Data(device->Object_List, key);
         if (object) {
-            key = object_property;
-            property = Keylist_Data(object->Property_List, key);
+            property = bacnet_property_data(object, object_property);
             if (property) {
-                if (property->application_data_len > 0) {
+                if (property->length > 0) {
                     len = bacapp_decode_known_property(
-                        property->application_data,
-                        property->application_data_len, value, object_type,
-                        object_property);
+                        bacnet_property_data_value(device, property),
+                        property->length, value, object_type, object_property);
                     if (len > 0) {
                         status = true;
                     }
@@ -504,7 +765,7 @@ unsigned int bacnet_discover_object_property_count(
         key = KEY_ENCODE(object_type, object_instance);
         object = Keylist_Data(device->Object_List, key);
         if (object) {
-            count = Keylist_Count(object->Property_List);
+            count = object->Property_Count;
         }
     }
 
@@ -537,9 +798,9 @@ bool bacnet_discover_object_property_identifier(
         key = KEY_ENCODE(object_type, object_instance);
         object = Keylist_Data(device->Object_List, key);
         if (object) {
-            if (Keylist_Index_Key(object->Property_List, index, &key)) {
+            if (index < object->Property_Count) {
                 if (property_id) {
-                    *property_id = key;
+                    *property_id = object->Property_List[index].property_id;
                 }
                 status = true;
             }
@@ -549,6 +810,38 @@ bool bacnet_discover_object_property_identifier(
     return status;
 }
 
+/**
+ * @brief Mark an object-list array element as received
+ * @param device_data [in] Pointer to the device data structure
+ * @param array_index [in] object-list array index 1..size
+ */
+static void bacnet_object_list_received_set(
+    BACNET_DEVICE_DATA *device_data, uint32_t array_index)
+{
+    if (device_data->Object_List_Received && (array_index >= 1) &&
+        (array_index <= device_data->Object_List_Size)) {
+        device_data->Object_List_Received[array_index / 8] |=
+            (uint8_t)(1 << (array_index % 8));
+    }
+}
+
+/**
+ * @brief Determine if an object-list array element was received
+ * @param device_data [in] Pointer to the device data structure
+ * @param array_index [in] object-list array index 1..size
+ * @return true if the element was received
+ */
+static bool bacnet_object_list_received(
+    const BACNET_DEVICE_DATA *device_data, uint32_t array_index)
+{
+    if (!device_data->Object_List_Received) {
+        return false;
+    }
+
+    return device_data->Object_List_Received[array_index / 8] &
+        (1 << (array_index % 8));
+}
+
 /**
  * @brief add a ReadProperty reply value from a device object property
  * @param device_id [in] Device instance number where data originated
@@ -574,38 +867,39 @@ static void bacnet_device_object_property_add(
         (rp_data->object_instance == device_id) &&
         (rp_data->object_property == PROP_OBJECT_LIST)) {
         if (value->tag == BACNET_APPLICATION_TAG_UNSIGNED_INT) {
+            BACNET_MEMPOOL_FREE(
+                device_data->Object_List_Received,
+                device_data->Object_List_Received_Size);
             device_data->Object_List_Size = value->type.Unsigned_Int;
             device_data->Object_List_Index = 0;
+            device_data->Object_List_Received_Size =
+                (device_data->Object_List_Size / 8) + 1;
+            device_data->Object_List_Received = BACNET_MEMPOOL_CALLOC(
+                device_data->Object_List_Received_Size);
             if (device_data->Discovery_State ==
                 BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST) {
                 device_data->Discovery_State =
                     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE;
             }
         } else if (value->tag == BACNET_APPLICATION_TAG_OBJECT_ID) {
-            if (rp_data->array_index <= device_data->Object_List_Size) {
+            if ((rp_data->array_index >= 1) &&
+                (rp_data->array_index <= device_data->Object_List_Size)) {
                 object_data = bacnet_object_data_add(
                     device_data->Object_List, value->type.Object_Id.type,
                     value->type.Object_Id.instance);
                 debug_printf(
                     "add %u object-list[%u] %s-%lu %s.\n", device_id,
-                    device_data->Object_List_Index,
+                    (unsigned)rp_data->array_index,
                     bactext_object_type_name(value->type.Object_Id.type),
                     (unsigned long)value->type.Object_Id.instance,
                     object_data ? "success" : "fail");
-                if (device_data->Discovery_State ==
-                    BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+                if (object_data) {
+                    bacnet_object_list_received_set(
+                        device_data, rp_data->array_index);
                 }
             }
         }
     } else {
-        /* move to next state */
-        if (device_data->Discovery_State ==
-            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST) {
-            device_data->Discovery_State =
-                BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-        }
         object_data = bacnet_object_data_add(
             device_data->Object_List, rp_data->object_type,
             rp_data->object_instance);
@@ -616,8 +910,8 @@ static void bacnet_device_object_property_add(
                 rp_data->object_instance);
             return;
         }
-        property_data = bacnet_property_data_add(
-            object_data->Property_List, rp_data->object_property);
+        property_data =
+            bacnet_property_data_add(object_data, rp_data->object_property);
         if (!property_data) {
             debug_fprintf(
                 stderr, "%s-%u %s property fail to add!\n",
@@ -626,30 +920,16 @@ static void bacnet_device_object_property_add(
                 bactext_property_name(rp_data->object_property));
             return;
         }
-        if (rp_data->application_data_len > 0) {
-            if (property_data->application_data_len !=
-                rp_data->application_data_len) {
-                free(property_data->application_data);
-                property_data->application_data =
-                    calloc(1, rp_data->application_data_len);
-            }
-            if (property_data->application_data) {
-                property_data->application_data_len =
-                    rp_data->application_data_len;
-                memcpy(
-                    property_data->application_data, rp_data->application_data,
-                    rp_data->application_data_len);
-            } else {
-                debug_fprintf(
-                    stderr, "%s-%u %s property fail to allocate!\n",
-                    bactext_object_type_name(rp_data->object_type),
-                    rp_data->object_instance,
-                    bactext_property_name(rp_data->object_property));
-            }
-        } else {
-            free(property_data->application_data);
-            property_data->application_data = NULL;
-            property_data->application_data_len = 0;
+        if (!bacnet_property_data_store(
+                device_data, property_data, rp_data->application_data,
+                (rp_data->application_data_len > 0)
+                    ? (uint32_t)rp_data->application_data_len
+                    : 0)) {
+            debug_fprintf(
+                stderr, "%s-%u %s property fail to allocate!\n",
+                bactext_object_type_name(rp_data->object_type),
+                rp_data->object_instance,
+                bactext_property_name(rp_data->object_property));
         }
         if (rp_data->array_index == BACNET_ARRAY_ALL) {
             debug_printf(
@@ -674,72 +954,6 @@ static void bacnet_device_object_property_add(
     }
 }
 
-/**
- * @brief Handle the error from a ReadProperty or ReadPropertyMultiple
- * @param device_id - device instance number where data originated
- * @param rp_data - ReadProperty data structure
- * @param device_data - Pointer to the device data structure
- */
-static void Device_Error_Handler(
-    uint32_t device_id,
-    BACNET_READ_PROPERTY_DATA *rp_data,
-    BACNET_DEVICE_DATA *device_data)
-{
-    bool status = false;
-
-    if (device_data) {
-        debug_printf(
-            "%u - %s\n", device_id,
-            bactext_error_code_name((int)rp_data->error_code));
-        switch (device_data->Discovery_State) {
-            case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
-                /* resend request */
-                if (device_data->Object_List_Index != 0) {
-                    device_data->Object_List_Index--;
-                }
-                device_data->Discovery_State =
-                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
-                break;
-            case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
-                if (rp_data->error_code == ERROR_CODE_TIMEOUT) {
-                    /* resend request */
-                    if (device_data->Object_List_Index != 0) {
-                        device_data->Object_List_Index--;
-                    }
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-                } else if (
-                    (rp_data->error_code ==
-                     ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED) &&
-                    (rp_data->object_property == PROP_ALL)) {
-                    /* fallback to ReadProperty required properties */
-                    /* FIXME: fill a property-list with properties
-                       and use FSM to ReadProperty of each.
-                       For now, read the object-name property */
-                    status = bacnet_read_property_queue(
-                        device_id, rp_data->object_type,
-                        rp_data->object_instance, PROP_OBJECT_NAME,
-                        BACNET_ARRAY_ALL);
-                    if (status) {
-                        device_data->Discovery_State =
-                            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
-                    } else {
-                        /* skip */
-                        device_data->Discovery_State =
-                            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-                    }
-                } else {
-                    /* skip */
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-                }
-                break;
-            default:
-                break;
-        }
-    }
-}
-
 /**
  * @brief Reply with the value from the ReadProperty request
  * @param device_id [in] Device instance number
@@ -763,7 +977,9 @@ static void bacnet_read_property_reply(
         return;
     }
     if (rp_data->error_code != ERROR_CODE_SUCCESS) {
-        Device_Error_Handler(device_id, rp_data, device_data);
+        debug_printf(
+            "%u - %s\n", device_id,
+            bactext_error_code_name((int)rp_data->error_code));
     } else if (value) {
         bacnet_device_object_property_add(
             device_id, rp_data, value, device_data);
@@ -771,116 +987,689 @@ static void bacnet_read_property_reply(
 }
 
 /**
- * @brief Non-blocking task for running BACnet discover state machine
- * @param device_id - Device ID from discovered device
- * @param device_data - Pointer to the device data structure
+ * @brief Adapt the request window of a device to the replies, opening it
+ *  one request for each window of timely replies, and closing it when the
+ *  replies slow down or time out
+ * @param device_data [in] Pointer to the device data structure
+ * @param rp_data [in] the request and its error code
+ * @param milliseconds [in] time from sending the request until its reply
  */
-static void
-bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
+static void bacnet_discover_window_update(
+    BACNET_DEVICE_DATA *device_data,
+    const BACNET_READ_PROPERTY_DATA *rp_data,
+    unsigned long milliseconds)
 {
-    KEY key = 0;
-    BACNET_OBJECT_TYPE object_type = 0;
-    uint32_t object_instance = 0;
+    if ((rp_data->error_code == ERROR_CODE_TIMEOUT) ||
+        (rp_data->error_code == ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+        device_data->Window /= 2;
+        device_data->Completions = 0;
+    } else if (milliseconds > 0) {
+        if ((device_data->Latency_Min == 0) ||
+            (milliseconds < device_data->Latency_Min)) {
+            device_data->Latency_Min = milliseconds;
+        }
+        if (milliseconds >
+            ((2UL * device_data->Latency_Min) +
+             BACNET_DISCOVER_LATENCY_SLACK_MS)) {
+            device_data->Window--;
+            device_data->Completions = 0;
+        } else {
+            device_data->Completions++;
+            if (device_data->Completions >= device_data->Window) {
+                device_data->Window++;
+                device_data->Completions = 0;
+            }
+        }
+    }
+    if (device_data->Window < 1) {
+        device_data->Window = 1;
+    } else if (device_data->Window > Request_Window) {
+        device_data->Window = Request_Window;
+    }
+}
+
+/**
+ * @brief Get the read level of the properties read from an object
+ * @param property_id [in] the property read from the object
+ * @return index of the property in the properties read from each object
+ */
+static unsigned bacnet_discover_read_level(BACNET_PROPERTY_ID property_id)
+{
+    unsigned level;
+
+    for (level = 0; level < BACNET_DISCOVER_READ_LEVEL_MAX; level++) {
+        if (Object_Read_Property[level] == property_id) {
+            break;
+        }
+    }
+
+    return level;
+}
+
+/**
+ * @brief Report an object with all of its properties read or failed
+ * @param device_id [in] Device instance number
+ * @param rp_data [in] the last request of the object
+ */
+static void bacnet_discover_object_complete(
+    uint32_t device_id, const BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    if (Object_Complete_Callback) {
+        Object_Complete_Callback(
+            device_id, rp_data->object_type, rp_data->object_instance);
+    }
+}
+
+/**
+ * @brief Handle the end of a ReadProperty or ReadPropertyMultiple request
+ * @param device_id [in] Device instance number
+ * @param invoke_id [in] invoke ID of the request
+ * @param rp_data [in] the request and its error code
+ * @param array_count [in] number of array elements in the request
+ * @param milliseconds [in] time from sending the request until its reply
+ */
+static void bacnet_read_property_complete(
+    uint32_t device_id,
+    uint8_t invoke_id,
+    const BACNET_READ_PROPERTY_DATA *rp_data,
+    uint32_t array_count,
+    unsigned long milliseconds)
+{
+    BACNET_DEVICE_DATA *device_data;
+    BACNET_ERROR_CODE error_code;
     bool status = false;
+    unsigned level;
 
-    if (!device_data) {
+    (void)invoke_id;
+    device_data = bacnet_device_data(Device_List, device_id);
+    if (!device_data || !rp_data) {
+        return;
+    }
+    if (device_data->Outstanding > 0) {
+        device_data->Outstanding--;
+    }
+    bacnet_discover_window_update(device_data, rp_data, milliseconds);
+    if (rp_data->error_code == ERROR_CODE_SUCCESS) {
+        device_data->Retry_Count = 0;
+        if (device_data->Discovery_State ==
+            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST) {
+            bacnet_discover_object_complete(device_id, rp_data);
+        }
         return;
     }
     switch (device_data->Discovery_State) {
-        case BACNET_DISCOVER_STATE_INIT:
-            status = bacnet_read_property_queue(
-                device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST, 0);
-            if (status) {
-                device_data->Discovery_State =
-                    BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST;
-            } else {
-                debug_fprintf(
-                    stderr, "%u object-list-size fail to queue!\n", device_id);
-            }
+        case BACNET_DISCOVER_STATE_SNAPSHOT_REQUEST:
+            device_data->Snapshot_Error = rp_data->error_code;
             break;
-        case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST:
-            /* waiting for response */
-            return;
-        case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE:
-            device_data->Object_List_Index = 0;
-            device_data->Discovery_State =
-                BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+        case BACNET_DISCOVER_STATE_JOURNAL_REQUEST:
+            device_data->Journal_Error = true;
+            error_code = rp_data->error_code;
+            if ((error_code == ERROR_CODE_UNKNOWN_PROPERTY) ||
+                (error_code == ERROR_CODE_REJECT_UNRECOGNIZED_SERVICE) ||
+                (error_code == ERROR_CODE_READ_ACCESS_DENIED)) {
+                /* the device has no object-list journal */
+                device_data->Journal_Unsupported = true;
+            }
             break;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
-            /* waiting for response */
-            break;
-        case BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE:
-            device_data->Object_List_Index++;
-            if (device_data->Object_List_Index <=
-                device_data->Object_List_Size) {
-                debug_printf(
-                    "%u object-list[%u] size=%u.\n", device_id,
-                    device_data->Object_List_Index,
-                    device_data->Object_List_Size);
-                status = bacnet_read_property_queue(
-                    device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
-                    device_data->Object_List_Index);
-                if (status) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST;
-                    return;
-                } else {
-                    debug_fprintf(
-                        stderr, "%u object-list[%u] %s-%u fail to queue!\n",
-                        device_id, device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
-                    device_data->Object_List_Index--;
-                }
-            } else {
-                device_data->Object_List_Index = 0;
-                device_data->Discovery_State =
-                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            if ((array_count > 1) &&
+                (rp_data->error_code != ERROR_CODE_TIMEOUT) &&
+                (rp_data->error_code != ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+                /* fallback to ReadProperty of each element */
+                device_data->RPM_Unsupported = true;
             }
+            /* the missing elements are requested in the next pass */
             break;
         case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
-            /* waiting for response */
-            break;
-        case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE:
-            if (device_data->Object_List_Index <
-                device_data->Object_List_Size) {
-                if (Keylist_Index_Key(
-                        device_data->Object_List,
-                        device_data->Object_List_Index, &key)) {
-                    object_type = KEY_DECODE_TYPE(key);
-                    object_instance = KEY_DECODE_ID(key);
-                    debug_printf(
-                        "%u object-list[%u] %s-%u read ALL.\n", device_id,
-                        device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
+            level = bacnet_discover_read_level(rp_data->object_property);
+            if ((rp_data->error_code == ERROR_CODE_TIMEOUT) ||
+                (rp_data->error_code == ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+                if (device_data->Retry_Count < BACNET_DISCOVER_RETRY_MAX) {
+                    /* resend request */
+                    device_data->Retry_Count++;
                     status = bacnet_read_property_queue(
-                        device_id, object_type, object_instance, PROP_ALL,
-                        BACNET_ARRAY_ALL);
+                        device_id, rp_data->object_type,
+                        rp_data->object_instance, rp_data->object_property,
+                        rp_data->array_index);
                 }
-                if (status) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
-                    device_data->Object_List_Index++;
-                } else {
-                    debug_fprintf(
-                        stderr, "%u object-list[%u] %s-%u fail to queue!\n",
-                        device_id, device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
+            } else if (
+                ((rp_data->error_code ==
+                  ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED) ||
+                 (rp_data->error_code == ERROR_CODE_ABORT_BUFFER_OVERFLOW) ||
+                 (rp_data->error_code == ERROR_CODE_ABORT_APDU_TOO_LONG)) &&
+                (level < BACNET_DISCOVER_READ_LEVEL_MAX)) {
+                /* the reply is too large - read fewer properties of this
+                   object, and of the objects that follow it */
+                level++;
+                if (device_data->Read_Level < level) {
+                    device_data->Read_Level = level;
                 }
+                status = bacnet_read_property_queue(
+                    device_id, rp_data->object_type, rp_data->object_instance,
+                    Object_Read_Property[level], BACNET_ARRAY_ALL);
+            }
+            if (status) {
+                device_data->Outstanding++;
             } else {
-                /* track the duration */
-                device_data->Discovery_Elapsed_Milliseconds =
-                    mstimer_elapsed(&device_data->Discovery_Timer);
-                /* rediscover in the future */
-                mstimer_set(
-                    &device_data->Discovery_Timer, Discovery_Milliseconds);
-                device_data->Discovery_State = BACNET_DISCOVER_STATE_DONE;
+                bacnet_discover_object_complete(device_id, rp_data);
             }
             break;
-        case BACNET_DISCOVER_STATE_DONE:
-            /* finished getting all the object properties */
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Get the number of object-list elements to request at once
+ * @param device_id [in] device instance
+ * @param device_data [in] Pointer to the device data structure
+ * @return number of object-list elements that fit in one reply
+ */
+static uint32_t bacnet_discover_object_list_chunk(
+    uint32_t device_id, const BACNET_DEVICE_DATA *device_data)
+{
+    unsigned max_apdu = MAX_APDU, limit;
+    uint32_t count = 1;
+
+    if (device_data->RPM_Unsupported ||
+        !capability_service_supported(
+            device_id, SERVICE_SUPPORTED_READ_PROP_MULTIPLE)) {
+        return 1;
+    }
+    if ((device_data->Max_APDU > 0) && (device_data->Max_APDU < max_apdu)) {
+        max_apdu = device_data->Max_APDU;
+    }
+    /* the device may have aborted larger replies before */
+    limit = capability_max_apdu(device_id);
+    if ((limit > 0) && (limit < max_apdu)) {
+        max_apdu = limit;
+    }
+    if (max_apdu > BACNET_DISCOVER_RPM_OVERHEAD_SIZE) {
+        count = (max_apdu - BACNET_DISCOVER_RPM_OVERHEAD_SIZE) /
+            BACNET_DISCOVER_RPM_ELEMENT_SIZE;
+    }
+    if (count < 1) {
+        count = 1;
+    } else if (count > BACNET_READ_WRITE_ARRAY_COUNT_MAX) {
+        count = BACNET_READ_WRITE_ARRAY_COUNT_MAX;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Queue requests for the object-list elements that are missing,
+ *  while the request window of the device is open
+ * @param device_id - Device ID from discovered device
+ * @param device_data - Pointer to the device data structure
+ * @return true if every element has been requested in this pass
+ */
+static bool bacnet_discover_object_list_request(
+    uint32_t device_id, BACNET_DEVICE_DATA *device_data)
+{
+    uint32_t index, count, chunk;
+    bool status = false;
+
+    chunk = bacnet_discover_object_list_chunk(device_id, device_data);
+    while (device_data->Outstanding < device_data->Window) {
+        index = device_data->Object_List_Index;
+        while ((index <= device_data->Object_List_Size) &&
+               bacnet_object_list_received(device_data, index)) {
+            index++;
+        }
+        if (index > device_data->Object_List_Size) {
+            device_data->Object_List_Index = index;
+            return true;
+        }
+        count = 1;
+        while ((count < chunk) &&
+               ((index + count) <= device_data->Object_List_Size) &&
+               !bacnet_object_list_received(device_data, index + count)) {
+            count++;
+        }
+        debug_printf(
+            "%u object-list[%u..%u] size=%u.\n", device_id, (unsigned)index,
+            (unsigned)(index + count - 1),
+            (unsigned)device_data->Object_List_Size);
+        status = bacnet_read_property_array_queue(
+            device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST, index,
+            count);
+        if (!status) {
+            debug_fprintf(
+                stderr, "%u object-list[%u] fail to queue!\n", device_id,
+                (unsigned)index);
+            device_data->Object_List_Index = index;
+            break;
+        }
+        device_data->Outstanding++;
+        device_data->Object_List_Index = index + count;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Get the Database_Revision of a device from the device cache
+ * @param device_id - Device ID of the device
+ * @param revision [out] the Database_Revision of the device
+ * @return true if the Database_Revision is in the cache
+ */
+static bool
+bacnet_discover_database_revision(uint32_t device_id, uint32_t *revision)
+{
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+
+    if (!bacnet_discover_property_value(
+            device_id, OBJECT_DEVICE, device_id, PROP_DATABASE_REVISION,
+            &value)) {
+        return false;
+    }
+    if (value.tag != BACNET_APPLICATION_TAG_UNSIGNED_INT) {
+        return false;
+    }
+    *revision = (uint32_t)value.type.Unsigned_Int;
+
+    return true;
+}
+
+/**
+ * @brief Determine if the snapshot of a device matches the Database_Revision
+ *  and object-list size that were just read from the device
+ * @param device_id - Device ID of the device
+ * @param device_data - Pointer to the device data structure
+ * @return true if the snapshot is current
+ */
+static bool bacnet_discover_snapshot_current(
+    uint32_t device_id, const BACNET_DEVICE_DATA *device_data)
+{
+    uint32_t revision = 0;
+
+    if (device_data->Snapshot_Error != ERROR_CODE_SUCCESS) {
+        return false;
+    }
+    if (!device_data->Snapshot_Revision_Valid ||
+        !bacnet_discover_database_revision(device_id, &revision)) {
+        return false;
+    }
+
+    return (revision == device_data->Snapshot_Revision) &&
+        (device_data->Object_List_Size ==
+         device_data->Snapshot_Object_List_Size);
+}
+
+/**
+ * @brief Apply the changes in a ReadRange-ACK of the object-list journal
+ *  to the object-list of the device
+ * @param device_id [in] Device instance number where data originated
+ * @param rr_data [in] the decoded ReadRange-ACK
+ */
+static void bacnet_read_range_reply(
+    uint32_t device_id, const BACNET_READ_RANGE_DATA *rr_data)
+{
+    BACNET_DEVICE_DATA *device_data;
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t object_instance = 0, change = 0, item;
+    const uint8_t *apdu;
+    uint32_t apdu_size;
+    int len;
+
+    device_data = bacnet_device_data(Device_List, device_id);
+    if (!device_data || !rr_data ||
+        (device_data->Discovery_State !=
+         BACNET_DISCOVER_STATE_JOURNAL_REQUEST) ||
+        (rr_data->object_type != OBJECT_DEVICE) ||
+        (rr_data->object_property != PROP_DEVICE_OBJECT_JOURNAL)) {
+        return;
+    }
+    if ((rr_data->ItemCount > 0) &&
+        (rr_data->FirstSequence != (device_data->Journal_Revision + 1))) {
+        /* the oldest changes are no longer in the journal */
+        device_data->Journal_Error = true;
+        return;
+    }
+    apdu = rr_data->application_data;
+    apdu_size = (rr_data->application_data_len > 0)
+        ? (uint32_t)rr_data->application_data_len
+        : 0;
+    for (item = 0; item < rr_data->ItemCount; item++) {
+        len = bacnet_object_id_application_decode(
+            apdu, apdu_size, &object_type, &object_instance);
+        if (len > 0) {
+            apdu += len;
+            apdu_size -= len;
+            len = bacnet_enumerated_application_decode(
+                apdu, apdu_size, &change);
+        }
+        if (len <= 0) {
+            device_data->Journal_Error = true;
+            return;
+        }
+        apdu += len;
+        apdu_size -= len;
+        if (change == DEVICE_OBJECT_CHANGE_CREATED) {
+            debug_printf(
+                "%u journal %s-%lu created.\n", device_id,
+                bactext_object_type_name(object_type),
+                (unsigned long)object_instance);
+            if (!bacnet_object_data_add(
+                    device_data->Object_List, object_type, object_instance)) {
+                device_data->Journal_Error = true;
+                return;
+            }
+        } else if (change == DEVICE_OBJECT_CHANGE_DELETED) {
+            debug_printf(
+                "%u journal %s-%lu deleted.\n", device_id,
+                bactext_object_type_name(object_type),
+                (unsigned long)object_instance);
+            bacnet_object_data_remove(
+                device_data, object_type, object_instance);
+        } else if (change != DEVICE_OBJECT_CHANGE_RENAMED) {
+            /* unknown change - read the whole object-list */
+            device_data->Journal_Error = true;
+            return;
+        }
+        /* a renamed object is read again with every other object */
+        device_data->Journal_Revision++;
+    }
+    device_data->Journal_More =
+        bitstring_bit(&rr_data->ResultFlags, RESULT_FLAG_MORE_ITEMS);
+}
+
+/**
+ * @brief Queue a ReadRange of the object-list journal, starting from the
+ *  change after the Journal_Revision
+ * @param device_id - Device ID of the device
+ * @param device_data - Pointer to the device data structure
+ * @return true if the request was queued
+ */
+static bool bacnet_discover_journal_request(
+    uint32_t device_id, BACNET_DEVICE_DATA *device_data)
+{
+    unsigned max_apdu = MAX_APDU;
+    uint32_t count = 1;
+    bool status;
+
+    if ((device_data->Max_APDU > 0) && (device_data->Max_APDU < max_apdu)) {
+        max_apdu = device_data->Max_APDU;
+    }
+    if (max_apdu > BACNET_DISCOVER_RPM_OVERHEAD_SIZE) {
+        count = (max_apdu - BACNET_DISCOVER_RPM_OVERHEAD_SIZE) /
+            BACNET_DISCOVER_JOURNAL_ITEM_SIZE;
+    }
+    if (count > (device_data->Journal_Target - device_data->Journal_Revision)) {
+        count = device_data->Journal_Target - device_data->Journal_Revision;
+    }
+    debug_printf(
+        "%u object-list journal %lu..%lu.\n", device_id,
+        (unsigned long)(device_data->Journal_Revision + 1),
+        (unsigned long)device_data->Journal_Target);
+    device_data->Journal_Error = false;
+    device_data->Journal_More = false;
+    status = bacnet_read_range_queue(
+        device_id, OBJECT_DEVICE, device_id, PROP_DEVICE_OBJECT_JOURNAL,
+        device_data->Journal_Revision + 1, count);
+    if (status) {
+        device_data->Outstanding++;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Forget the objects of a device, and discover it again from the
+ *  start, when its object-list can not be brought up to date
+ * @param device_data - Pointer to the device data structure
+ */
+static void bacnet_discover_device_reset(BACNET_DEVICE_DATA *device_data)
+{
+    bacnet_object_data_cleanup(device_data->Object_List);
+    device_data->Object_List = Keylist_Create();
+    device_data->Arena_Size = 0;
+    device_data->Arena_Unused = 0;
+    device_data->Snapshot = false;
+    device_data->Journal_Valid = false;
+    device_data->Discovery_State = BACNET_DISCOVER_STATE_INIT;
+}
+
+/**
+ * @brief Non-blocking task for running BACnet discover state machine
+ * @param device_id - Device ID from discovered device
+ * @param device_data - Pointer to the device data structure
+ */
+static void
+bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
+{
+    KEY key = 0;
+    BACNET_OBJECT_TYPE object_type = 0;
+    uint32_t object_instance = 0;
+    BACNET_PROPERTY_ID property_id;
+    uint32_t index;
+    bool status = false;
+
+    if (!device_data) {
+        return;
+    }
+    switch (device_data->Discovery_State) {
+        case BACNET_DISCOVER_STATE_INIT:
+            /* the duration starts when the device is discovered */
+            mstimer_set(&device_data->Discovery_Timer, 0);
+            device_data->Outstanding = 0;
+            device_data->Window = 1;
+            device_data->Completions = 0;
+            device_data->Retry_Count = 0;
+            device_data->Latency_Min = 0;
+            device_data->RPM_Unsupported = false;
+            device_data->Read_Level = 0;
+            if (device_data->Snapshot) {
+                /* check the snapshot before reading the device again */
+                device_data->Snapshot_Error = ERROR_CODE_SUCCESS;
+                status = bacnet_read_property_queue(
+                    device_id, OBJECT_DEVICE, device_id,
+                    PROP_DATABASE_REVISION, BACNET_ARRAY_ALL);
+                if (status) {
+                    device_data->Outstanding++;
+                    status = bacnet_read_property_queue(
+                        device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
+                        0);
+                }
+                if (status) {
+                    device_data->Outstanding++;
+                } else {
+                    /* unable to check the snapshot - discover again */
+                    device_data->Snapshot_Error = ERROR_CODE_OTHER;
+                }
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_SNAPSHOT_REQUEST;
+                break;
+            }
+            /* the object-list is current as of the revision read first */
+            status = bacnet_read_property_queue(
+                device_id, OBJECT_DEVICE, device_id, PROP_DATABASE_REVISION,
+                BACNET_ARRAY_ALL);
+            if (status) {
+                device_data->Outstanding++;
+            }
+            if (status && device_data->Journal_Valid &&
+                !device_data->Journal_Unsupported) {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_JOURNAL_REVISION_REQUEST;
+                break;
+            }
+            device_data->Journal_Valid = false;
+            status = bacnet_read_property_queue(
+                device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST, 0);
+            if (status) {
+                device_data->Outstanding++;
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST;
+            } else {
+                debug_fprintf(
+                    stderr, "%u object-list-size fail to queue!\n", device_id);
+            }
+            break;
+        case BACNET_DISCOVER_STATE_SNAPSHOT_REQUEST:
+            if (device_data->Outstanding > 0) {
+                break;
+            }
+            if ((device_data->Snapshot_Error == ERROR_CODE_TIMEOUT) ||
+                (device_data->Snapshot_Error ==
+                 ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+                /* keep the snapshot until the device replies */
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            } else if (bacnet_discover_snapshot_current(
+                           device_id, device_data)) {
+                debug_printf("%u snapshot is current.\n", device_id);
+                device_data->Snapshot = false;
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            } else {
+                debug_printf("%u snapshot is stale.\n", device_id);
+                bacnet_discover_device_reset(device_data);
+            }
+            break;
+        case BACNET_DISCOVER_STATE_JOURNAL_REVISION_REQUEST:
+            if (device_data->Outstanding > 0) {
+                break;
+            }
+            if (!bacnet_discover_database_revision(
+                    device_id, &device_data->Journal_Target) ||
+                (device_data->Journal_Target <
+                 device_data->Journal_Revision)) {
+                /* the device database was reset */
+                bacnet_discover_device_reset(device_data);
+            } else if (
+                device_data->Journal_Target == device_data->Journal_Revision) {
+                debug_printf("%u object-list is current.\n", device_id);
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+            } else if (bacnet_discover_journal_request(
+                           device_id, device_data)) {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_JOURNAL_REQUEST;
+            } else {
+                bacnet_discover_device_reset(device_data);
+            }
+            break;
+        case BACNET_DISCOVER_STATE_JOURNAL_REQUEST:
+            if (device_data->Outstanding > 0) {
+                break;
+            }
+            if (device_data->Journal_Error) {
+                debug_printf("%u object-list journal failed.\n", device_id);
+                bacnet_discover_device_reset(device_data);
+            } else if (
+                device_data->Journal_Revision >= device_data->Journal_Target) {
+                device_data->Object_List_Size =
+                    (uint32_t)Keylist_Count(device_data->Object_List);
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+            } else if (
+                !device_data->Journal_More ||
+                !bacnet_discover_journal_request(device_id, device_data)) {
+                /* the journal ended before the Database_Revision */
+                bacnet_discover_device_reset(device_data);
+            }
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST:
+            if (device_data->Outstanding == 0) {
+                /* no object-list size - skip this device */
+                device_data->Object_List_Size = 0;
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            }
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE:
+            device_data->Object_List_Index = 1;
+            device_data->Object_List_Pass = 0;
+            device_data->Discovery_State =
+                BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST;
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
+            if (!bacnet_discover_object_list_request(device_id, device_data) ||
+                (device_data->Outstanding > 0)) {
+                break;
+            }
+            /* end of a pass - request any missing elements again */
+            for (index = 1; index <= device_data->Object_List_Size; index++) {
+                if (!bacnet_object_list_received(device_data, index)) {
+                    break;
+                }
+            }
+            if ((index <= device_data->Object_List_Size) &&
+                (device_data->Object_List_Pass < BACNET_DISCOVER_RETRY_MAX)) {
+                device_data->Object_List_Pass++;
+                device_data->Object_List_Index = index;
+            } else {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+            }
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE:
+            if (!device_data->Journal_Valid &&
+                bacnet_discover_database_revision(
+                    device_id, &device_data->Journal_Revision)) {
+                /* later changes are read from the object-list journal */
+                device_data->Journal_Valid = true;
+            }
+            device_data->Object_List_Index = 0;
+            device_data->Discovery_State =
+                BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
+            while ((device_data->Outstanding < device_data->Window) &&
+                   (device_data->Object_List_Index <
+                    (uint32_t)Keylist_Count(device_data->Object_List))) {
+                status = false;
+                if (Keylist_Index_Key(
+                        device_data->Object_List,
+                        device_data->Object_List_Index, &key)) {
+                    object_type = KEY_DECODE_TYPE(key);
+                    object_instance = KEY_DECODE_ID(key);
+                    property_id =
+                        Object_Read_Property[device_data->Read_Level];
+                    debug_printf(
+                        "%u object-list[%u] %s-%u read %s.\n", device_id,
+                        device_data->Object_List_Index,
+                        bactext_object_type_name(object_type),
+                        (unsigned)object_instance,
+                        bactext_property_name(property_id));
+                    status = bacnet_read_property_queue(
+                        device_id, object_type, object_instance, property_id,
+                        BACNET_ARRAY_ALL);
+                }
+                if (status) {
+                    device_data->Outstanding++;
+                    device_data->Object_List_Index++;
+                } else {
+                    debug_fprintf(
+                        stderr, "%u object-list[%u] %s-%u fail to queue!\n",
+                        device_id, device_data->Object_List_Index,
+                        bactext_object_type_name(object_type),
+                        (unsigned)object_instance);
+                    break;
+                }
+            }
+            if ((device_data->Outstanding == 0) &&
+                (device_data->Object_List_Index >=
+                 (uint32_t)Keylist_Count(device_data->Object_List))) {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            }
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE:
+            /* track the duration */
+            device_data->Discovery_Elapsed_Milliseconds =
+                mstimer_elapsed(&device_data->Discovery_Timer);
+            if (Device_Complete_Callback) {
+                Device_Complete_Callback(device_id);
+            }
+            /* rediscover in the future */
+            mstimer_set(&device_data->Discovery_Timer, Discovery_Milliseconds);
+            device_data->Discovery_State = BACNET_DISCOVER_STATE_DONE;
+            break;
+        case BACNET_DISCOVER_STATE_DONE:
+            /* finished getting all the object properties */
             if (mstimer_expired(&device_data->Discovery_Timer)) {
                 mstimer_set(&device_data->Discovery_Timer, 0);
                 device_data->Discovery_State = BACNET_DISCOVER_STATE_INIT;
@@ -895,26 +1684,40 @@ bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
 }
 
 /**
- * @brief Adds a device to the device list
- * @param device_id - Device ID from discovered device
- * @param src - BACnet address from discovered device
- * @return non-zero device index for device if added or existing
+ * @brief Run the discovery of each device, with a limited number of
+ *  devices being discovered at once
  */
 static void bacnet_discover_devices_task(void)
 {
     unsigned int device_index = 0;
     unsigned int device_count = 0;
+    unsigned int device_active = 0;
     uint32_t device_id = 0;
     BACNET_DEVICE_DATA *device_data;
     KEY key;
 
     device_count = Keylist_Count(Device_List);
+    for (device_index = 0; device_index < device_count; device_index++) {
+        device_data = Keylist_Data_Index(Device_List, device_index);
+        if (device_data &&
+            (device_data->Discovery_State != BACNET_DISCOVER_STATE_INIT) &&
+            (device_data->Discovery_State != BACNET_DISCOVER_STATE_DONE)) {
+            device_active++;
+        }
+    }
     for (device_index = 0; device_index < device_count; device_index++) {
         device_data = Keylist_Data_Index(Device_List, device_index);
         if (!device_data) {
             debug_fprintf(stderr, "device[%u] is NULL!\n", device_index);
             continue;
         }
+        if (device_data->Discovery_State == BACNET_DISCOVER_STATE_INIT) {
+            if (device_active >= Device_Window) {
+                /* wait for another device to finish */
+                continue;
+            }
+            device_active++;
+        }
         if (Keylist_Index_Key(Device_List, device_index, &key)) {
             device_id = key;
             bacnet_discover_device_fsm(device_id, device_data);
@@ -960,41 +1763,22 @@ bool bacnet_discover_device_object_property_iterate(
     rp_data.object_type = object_type;
     rp_data.object_instance = object_instance;
     /* property */
-    property_count = Keylist_Count(object->Property_List);
+    property_count = object->Property_Count;
     for (property_index = 0; property_index < property_count;
          property_index++) {
-        if (Keylist_Index_Key(object->Property_List, property_index, &key)) {
-            rp_data.object_property = key;
-        } else {
-            continue;
-        }
-        property = Keylist_Data_Index(object->Property_List, property_index);
-        if (property) {
-            rp_data.error_class = ERROR_CLASS_PROPERTY;
-            rp_data.error_code = ERROR_CODE_SUCCESS;
-            rp_data.application_data = property->application_data;
-            rp_data.application_data_len = property->application_data_len;
-            status = callback(
-                device_id, device_index, object_index, property_index, &rp_data,
-                context);
-            /* callback returns true if the iteration
-                should continue, false if it should stop */
-            if (!status) {
-                return false;
-            }
-        } else {
-            rp_data.application_data = NULL;
-            rp_data.application_data_len = 0;
-            rp_data.error_class = ERROR_CLASS_PROPERTY;
-            rp_data.error_code = ERROR_CODE_UNKNOWN_PROPERTY;
-            status = callback(
-                device_id, device_index, object_index, property_index, &rp_data,
-                context);
-            /* callback returns true if the iteration
-                should continue, false if it should stop */
-            if (!status) {
-                return false;
-            }
+        property = &object->Property_List[property_index];
+        rp_data.object_property = property->property_id;
+        rp_data.error_class = ERROR_CLASS_PROPERTY;
+        rp_data.error_code = ERROR_CODE_SUCCESS;
+        rp_data.application_data = bacnet_property_data_value(device, property);
+        rp_data.application_data_len = (int)property->length;
+        status = callback(
+            device_id, device_index, object_index, property_index, &rp_data,
+            context);
+        /* callback returns true if the iteration
+            should continue, false if it should stop */
+        if (!status) {
+            return false;
         }
     }
 
@@ -1085,7 +1869,7 @@ void bacnet_discover_task(void)
         mstimer_restart(&Read_Write_Timer);
         bacnet_read_write_task();
     }
-    if (bacnet_read_write_idle()) {
+    if (!bacnet_read_write_busy()) {
         bacnet_discover_devices_task();
     }
 }
@@ -1182,6 +1966,313 @@ unsigned long bacnet_discover_read_process_milliseconds(void)
     return mstimer_interval(&Read_Write_Timer);
 }
 
+/**
+ * @brief Update the number of requests in progress at once, to serve the
+ *  request window of each device being discovered at once
+ */
+static void bacnet_discover_window_update_all(void)
+{
+    bacnet_read_write_window_set(Device_Window * Request_Window);
+}
+
+/**
+ * @brief Set the number of devices that are discovered at once
+ * @param count - number of devices, 1 or more
+ */
+void bacnet_discover_device_window_set(unsigned count)
+{
+    Device_Window = count ? count : 1;
+    bacnet_discover_window_update_all();
+}
+
+/**
+ * @brief Get the number of devices that are discovered at once
+ * @return number of devices
+ */
+unsigned bacnet_discover_device_window(void)
+{
+    return Device_Window;
+}
+
+/**
+ * @brief Set the largest number of requests outstanding to each device.
+ *  The requests to a device start at one and adapt to its reply time.
+ * @param count - number of requests, 1 or more
+ */
+void bacnet_discover_request_window_set(unsigned count)
+{
+    Request_Window = count ? count : 1;
+    bacnet_discover_window_update_all();
+}
+
+/**
+ * @brief Get the largest number of requests outstanding to each device
+ * @return number of requests
+ */
+unsigned bacnet_discover_request_window(void)
+{
+    return Request_Window;
+}
+
+/**
+ * @brief Write an unsigned 32-bit value to a snapshot file
+ * @param file - snapshot file
+ * @param value - value to write
+ * @return true if the value was written
+ */
+static bool bacnet_discover_snapshot_write(FILE *file, uint32_t value)
+{
+    uint8_t buffer[4];
+
+    encode_unsigned32(buffer, value);
+
+    return fwrite(buffer, sizeof(buffer), 1, file) == 1;
+}
+
+/**
+ * @brief Read an unsigned 32-bit value from a snapshot file
+ * @param file - snapshot file
+ * @param value [out] value that was read
+ * @return true if the value was read
+ */
+static bool bacnet_discover_snapshot_read(FILE *file, uint32_t *value)
+{
+    uint8_t buffer[4];
+
+    if (fread(buffer, sizeof(buffer), 1, file) != 1) {
+        return false;
+    }
+    decode_unsigned32(buffer, value);
+
+    return true;
+}
+
+/**
+ * @brief Write the objects and property values of a device to a snapshot
+ * @param file - snapshot file
+ * @param device_id - Device ID of the device
+ * @param device_data - Pointer to the device data structure
+ * @return true if the device was written
+ */
+static bool bacnet_discover_snapshot_device_write(
+    FILE *file, uint32_t device_id, const BACNET_DEVICE_DATA *device_data)
+{
+    BACNET_OBJECT_DATA *object_data;
+    BACNET_PROPERTY_DATA *property_data;
+    int object_count, object_index;
+    uint32_t property_count, property_index;
+    KEY key;
+    bool status;
+
+    object_count = Keylist_Count(device_data->Object_List);
+    status = bacnet_discover_snapshot_write(file, device_id) &&
+        bacnet_discover_snapshot_write(
+                 file, device_data->Object_List_Size) &&
+        bacnet_discover_snapshot_write(file, (uint32_t)object_count);
+    for (object_index = 0; status && (object_index < object_count);
+         object_index++) {
+        object_data =
+            Keylist_Data_Index(device_data->Object_List, object_index);
+        if (!object_data ||
+            !Keylist_Index_Key(device_data->Object_List, object_index, &key)) {
+            return false;
+        }
+        property_count = object_data->Property_Count;
+        status = bacnet_discover_snapshot_write(file, key) &&
+            bacnet_discover_snapshot_write(file, property_count);
+        for (property_index = 0; status && (property_index < property_count);
+             property_index++) {
+            property_data = &object_data->Property_List[property_index];
+            status = bacnet_discover_snapshot_write(
+                         file, property_data->property_id) &&
+                bacnet_discover_snapshot_write(file, property_data->length);
+            if (status && (property_data->length > 0)) {
+                status = fwrite(
+                             bacnet_property_data_value(
+                                 device_data, property_data),
+                             property_data->length, 1, file) == 1;
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Save the devices that have been discovered, with their object-list
+ *  and property values, to a snapshot file for a warm restart.
+ * @param pathname - name of the snapshot file
+ * @return true if the snapshot was saved
+ */
+bool bacnet_discover_save(const char *pathname)
+{
+    BACNET_DEVICE_DATA *device_data;
+    FILE *file;
+    int device_count, device_index;
+    uint32_t count = 0;
+    KEY key;
+    bool status;
+
+    if (!pathname) {
+        return false;
+    }
+    file = fopen(pathname, "wb");
+    if (!file) {
+        return false;
+    }
+    /* only the devices with a complete discovery are saved */
+    device_count = Keylist_Count(Device_List);
+    for (device_index = 0; device_index < device_count; device_index++) {
+        device_data = Keylist_Data_Index(Device_List, device_index);
+        if (device_data &&
+            ((device_data->Discovery_State == BACNET_DISCOVER_STATE_DONE) ||
+             device_data->Snapshot)) {
+            count++;
+        }
+    }
+    status =
+        bacnet_discover_snapshot_write(file, BACNET_DISCOVER_SNAPSHOT_MAGIC) &&
+        bacnet_discover_snapshot_write(
+            file, BACNET_DISCOVER_SNAPSHOT_VERSION) &&
+        bacnet_discover_snapshot_write(file, count);
+    for (device_index = 0; status && (device_index < device_count);
+         device_index++) {
+        device_data = Keylist_Data_Index(Device_List, device_index);
+        if (device_data &&
+            ((device_data->Discovery_State == BACNET_DISCOVER_STATE_DONE) ||
+             device_data->Snapshot) &&
+            Keylist_Index_Key(Device_List, device_index, &key)) {
+            status =
+                bacnet_discover_snapshot_device_write(file, key, device_data);
+        }
+    }
+    if (fclose(file) != 0) {
+        status = false;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Read the objects and property values of a device from a snapshot
+ * @param file - snapshot file
+ * @param device_data - Pointer to the device data structure, or NULL to
+ *  skip the device
+ * @return true if the device was read
+ */
+static bool bacnet_discover_snapshot_device_read(
+    FILE *file, BACNET_DEVICE_DATA *device_data)
+{
+    BACNET_OBJECT_DATA *object_data = NULL;
+    BACNET_PROPERTY_DATA *property_data = NULL;
+    uint32_t object_list_size = 0, object_count = 0, property_count = 0;
+    uint32_t object_key = 0, property_key = 0, length = 0;
+    uint32_t object_index, property_index;
+    uint8_t *data;
+
+    if (!bacnet_discover_snapshot_read(file, &object_list_size) ||
+        !bacnet_discover_snapshot_read(file, &object_count)) {
+        return false;
+    }
+    if (device_data) {
+        device_data->Object_List_Size = object_list_size;
+        device_data->Snapshot_Object_List_Size = object_list_size;
+    }
+    for (object_index = 0; object_index < object_count; object_index++) {
+        if (!bacnet_discover_snapshot_read(file, &object_key) ||
+            !bacnet_discover_snapshot_read(file, &property_count)) {
+            return false;
+        }
+        if (device_data) {
+            object_data = bacnet_object_data_add(
+                device_data->Object_List, KEY_DECODE_TYPE(object_key),
+                KEY_DECODE_ID(object_key));
+        }
+        for (property_index = 0; property_index < property_count;
+             property_index++) {
+            if (!bacnet_discover_snapshot_read(file, &property_key) ||
+                !bacnet_discover_snapshot_read(file, &length) ||
+                (length > INT32_MAX)) {
+                return false;
+            }
+            data = NULL;
+            if (length > 0) {
+                data = BACNET_MEMPOOL_CALLOC(length);
+                if (!data) {
+                    return false;
+                }
+                if (fread(data, length, 1, file) != 1) {
+                    BACNET_MEMPOOL_FREE(data, length);
+                    return false;
+                }
+            }
+            property_data = NULL;
+            if (object_data) {
+                property_data =
+                    bacnet_property_data_add(object_data, property_key);
+            }
+            if (property_data) {
+                bacnet_property_data_store(
+                    device_data, property_data, data, length);
+            }
+            BACNET_MEMPOOL_FREE(data, length);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Load the devices, with their object-list and property values, from
+ *  a snapshot file.  Each device is checked against its Database_Revision
+ *  and object-list size, and is discovered again only if either changed.
+ * @param pathname - name of the snapshot file
+ * @return true if the snapshot was loaded
+ */
+bool bacnet_discover_load(const char *pathname)
+{
+    BACNET_DEVICE_DATA *device_data;
+    FILE *file;
+    uint32_t magic = 0, version = 0, count = 0, index;
+    uint32_t device_id = 0;
+    bool status;
+
+    if (!pathname || !Device_List) {
+        return false;
+    }
+    file = fopen(pathname, "rb");
+    if (!file) {
+        return false;
+    }
+    status = bacnet_discover_snapshot_read(file, &magic) &&
+        bacnet_discover_snapshot_read(file, &version) &&
+        bacnet_discover_snapshot_read(file, &count) &&
+        (magic == BACNET_DISCOVER_SNAPSHOT_MAGIC) &&
+        (version == BACNET_DISCOVER_SNAPSHOT_VERSION);
+    for (index = 0; status && (index < count); index++) {
+        status = bacnet_discover_snapshot_read(file, &device_id) &&
+            (device_id <= BACNET_MAX_INSTANCE);
+        if (!status) {
+            break;
+        }
+        /* a device that is already known is not replaced */
+        device_data = NULL;
+        if (!bacnet_device_data(Device_List, device_id)) {
+            device_data = bacnet_device_data_add(device_id);
+        }
+        status = bacnet_discover_snapshot_device_read(file, device_data);
+        if (device_data) {
+            device_data->Snapshot = true;
+            device_data->Snapshot_Revision_Valid =
+                bacnet_discover_database_revision(
+                    device_id, &device_data->Snapshot_Revision);
+        }
+    }
+    fclose(file);
+
+    return status;
+}
+
 /**
  * Save the I-Am service data to a data store
  *
@@ -1198,15 +2289,39 @@ void bacnet_discover_device_add(
 {
     BACNET_DEVICE_DATA *device_data;
 
-    (void)max_apdu;
     (void)segmentation;
     device_data = bacnet_device_data_add(device_instance);
+    if (device_data) {
+        device_data->Max_APDU = max_apdu;
+    }
     debug_printf(
         "device[%d] %lu - vendor=%u %s.\n",
         Keylist_Index(Device_List, device_instance), device_instance, vendor_id,
         device_data ? "success" : "fail");
 }
 
+/**
+ * @brief Set the function called each time the properties of an object
+ *  have been discovered, so that the object can be used right away
+ * @param callback - function to call, or NULL for none
+ */
+void bacnet_discover_object_complete_callback_set(
+    bacnet_discover_object_complete_callback callback)
+{
+    Object_Complete_Callback = callback;
+}
+
+/**
+ * @brief Set the function called each time the discovery of a device
+ *  has finished
+ * @param callback - function to call, or NULL for none
+ */
+void bacnet_discover_device_complete_callback_set(
+    bacnet_discover_device_complete_callback callback)
+{
+    Device_Complete_Callback = callback;
+}
+
 /**
  * @brief Initializes the ReadProperty module
  */
@@ -1226,4 +2341,7 @@ void bacnet_discover_init(void)
     }
     bacnet_read_write_value_callback_set(bacnet_read_property_reply);
     bacnet_read_write_device_callback_set(bacnet_discover_device_add);
+    bacnet_read_write_complete_callback_set(bacnet_read_property_complete);
+    bacnet_read_write_range_callback_set(bacnet_read_range_reply);
+    bacnet_discover_window_update_all();
 }
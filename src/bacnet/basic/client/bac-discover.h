@@ -36,6 +36,23 @@ typedef bool (*bacnet_discover_device_callback)(
     BACNET_READ_PROPERTY_DATA *rp_data,
     void *context_data);
 
+/**
+ * @brief Callback function for an object that has been discovered
+ * @param device_id [in] The device ID of the object
+ * @param object_type [in] The object type of the object
+ * @param object_instance [in] The object instance of the object
+ */
+typedef void (*bacnet_discover_object_complete_callback)(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance);
+
+/**
+ * @brief Callback function for a device that has been discovered
+ * @param device_id [in] The device ID of the device
+ */
+typedef void (*bacnet_discover_device_complete_callback)(uint32_t device_id);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -129,6 +146,15 @@ void bacnet_discover_read_process_milliseconds_set(unsigned long milliseconds);
 BACNET_STACK_EXPORT
 unsigned long bacnet_discover_read_process_milliseconds(void);
 
+BACNET_STACK_EXPORT
+void bacnet_discover_device_window_set(unsigned count);
+BACNET_STACK_EXPORT
+unsigned bacnet_discover_device_window(void);
+BACNET_STACK_EXPORT
+void bacnet_discover_request_window_set(unsigned count);
+BACNET_STACK_EXPORT
+unsigned bacnet_discover_request_window(void);
+
 BACNET_STACK_EXPORT
 void bacnet_discover_device_add(
     uint32_t device_instance,
@@ -136,6 +162,18 @@ void bacnet_discover_device_add(
     int segmentation,
     uint16_t vendor_id);
 
+BACNET_STACK_EXPORT
+void bacnet_discover_object_complete_callback_set(
+    bacnet_discover_object_complete_callback callback);
+BACNET_STACK_EXPORT
+void bacnet_discover_device_complete_callback_set(
+    bacnet_discover_device_complete_callback callback);
+
+BACNET_STACK_EXPORT
+bool bacnet_discover_save(const char *pathname);
+BACNET_STACK_EXPORT
+bool bacnet_discover_load(const char *pathname);
+
 BACNET_STACK_EXPORT
 void bacnet_discover_init(void);
 
@@ -10,16 +10,20 @@
 #include <stdlib.h>
 #include "bacnet/abort.h"
 #include "bacnet/apdu.h"
+#include "bacnet/cov.h"
 #include "bacnet/iam.h"
 #include "bacnet/reject.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/binding/capability.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/sys/ringbuf.h"
+#include "bacnet/basic/sys/valbuf.h"
 #include "bacnet/basic/tsm/tsm.h"
 /* me */
 #include "bacnet/basic/client/bac-rw.h"
@@ -27,12 +31,15 @@
 /* timer for address cache */
 static struct mstimer Cache_Timer;
 #define CACHE_CYCLE_SECONDS 60
-/* timeout timer for read-write task */
-static struct mstimer Read_Write_Timer;
 /* where the data from the read is stored */
 static bacnet_read_write_value_callback_t bacnet_read_write_value_callback;
 /* where the data from the I-Am is called */
 static bacnet_read_write_device_callback_t bacnet_read_write_device_callback;
+/* where the end of each request is reported */
+static bacnet_read_write_complete_callback_t
+    bacnet_read_write_complete_callback;
+/* where the items of a ReadRange are stored */
+static bacnet_read_write_range_callback_t bacnet_read_write_range_callback;
 
 /* states for client task */
 typedef enum {
@@ -46,11 +53,23 @@ typedef enum {
 /* data queue */
 typedef struct target_data_t {
     bool write_property;
+    /* true for a SubscribeCOV request of the object */
+    bool subscribe_cov;
+    /* SubscribeCOV lifetime in seconds */
+    uint32_t lifetime;
+    /* true for a ReadRange request by sequence number of the property */
+    bool read_range;
+    /* first sequence number of the ReadRange request */
+    uint32_t sequence;
     uint32_t device_id;
     uint32_t object_instance;
     BACNET_OBJECT_TYPE object_type;
     BACNET_PROPERTY_ID object_property;
     int32_t array_index;
+    /* number of array elements to read - more than one uses RPM */
+    uint32_t array_count;
+    /* true if this read is not packed with other reads */
+    bool single;
     uint8_t priority;
     /* application tag data type for writing */
     uint8_t tag;
@@ -62,6 +81,8 @@ typedef struct target_data_t {
         uint32_t Unsigned_Int;
         int32_t Signed_Int;
     } type;
+    /* share of the encoded value for writing any other value */
+    BACNET_VALBUF *value;
 } TARGET_DATA;
 #define TARGET_DATA_QUEUE_SIZE (sizeof(struct target_data_t))
 /* count must be a power of 2 for ringbuf library */
@@ -70,17 +91,206 @@ typedef struct target_data_t {
 #endif
 static TARGET_DATA Target_Data_Buffer[TARGET_DATA_QUEUE_COUNT];
 static RING_BUFFER Target_Data_Queue;
+/* largest number of queued requests - the queue doubles when it is full */
+#ifndef TARGET_DATA_QUEUE_COUNT_MAX
+#define TARGET_DATA_QUEUE_COUNT_MAX 256
+#endif
+/* queue storage after the queue has grown beyond the static buffer */
+static TARGET_DATA *Target_Data_Heap;
 /* local storage - keeps it off the c-stack */
 static BACNET_APPLICATION_DATA_VALUE Target_Decoded_Property_Value;
-/* the invoke id is needed to filter incoming messages */
-static uint8_t Request_Invoke_ID;
-static BACNET_ADDRESS Target_Address;
-static uint32_t Target_Device_ID;
 static uint16_t Target_Vendor_ID;
-static bool Error_Detected = false;
-static BACNET_ERROR_CLASS Error_Class;
-static BACNET_ERROR_CODE Error_Code;
-static BACNET_CLIENT_STATE RW_State = BACNET_CLIENT_IDLE;
+/* largest number of queued reads packed into one ReadPropertyMultiple */
+#ifndef BACNET_READ_WRITE_COALESCE_MAX
+#define BACNET_READ_WRITE_COALESCE_MAX 16
+#endif
+/* estimated encoded size of each packed read in a ReadPropertyMultiple-ACK,
+   and of the rest of the ACK, for sizing to the max APDU of the device */
+#define BACNET_READ_WRITE_COALESCE_SIZE 24
+#define BACNET_READ_WRITE_COALESCE_OVERHEAD 16
+static bool Coalesce_Enabled = true;
+/* request taken from the queue that is in progress */
+typedef struct read_write_transaction_t {
+    TARGET_DATA target;
+    /* reads of the same device packed with the target */
+    TARGET_DATA coalesced[BACNET_READ_WRITE_COALESCE_MAX - 1];
+    unsigned coalesced_count;
+    unsigned max_apdu;
+    BACNET_CLIENT_STATE state;
+    /* the invoke id is needed to filter incoming messages */
+    uint8_t invoke_id;
+    BACNET_ADDRESS address;
+    /* timeout timer for binding and sending */
+    struct mstimer timer;
+    /* time when the request was sent */
+    unsigned long sent;
+    bool error_detected;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+} READ_WRITE_TRANSACTION;
+/* maximum number of requests in progress at once */
+#ifndef BACNET_READ_WRITE_WINDOW_MAX
+#define BACNET_READ_WRITE_WINDOW_MAX 16
+#endif
+static READ_WRITE_TRANSACTION Transaction[BACNET_READ_WRITE_WINDOW_MAX];
+/* request index plus one for each invoke ID in use, or zero */
+static uint8_t Transaction_Invoke_Index[256];
+/* number of requests in progress at once - one request at a time default */
+static unsigned Transaction_Window = 1;
+/* number of requests in progress at once to a device, or zero for any */
+static unsigned Transaction_Device_Window;
+/* largest number of devices waiting for a Who-Is to bind them */
+#ifndef BACNET_READ_WRITE_BIND_MAX
+#define BACNET_READ_WRITE_BIND_MAX 64
+#endif
+/* time to collect the devices to bind before sending a Who-Is */
+#ifndef BACNET_READ_WRITE_BIND_WINDOW_MS
+#define BACNET_READ_WRITE_BIND_WINDOW_MS 50
+#endif
+/* shortest time between two Who-Is */
+#ifndef BACNET_READ_WRITE_BIND_INTERVAL_MS
+#define BACNET_READ_WRITE_BIND_INTERVAL_MS 10
+#endif
+/* largest gap in the device instances of one Who-Is range */
+#ifndef BACNET_READ_WRITE_BIND_RANGE_GAP
+#define BACNET_READ_WRITE_BIND_RANGE_GAP 8
+#endif
+/* devices to bind, sorted by device instance */
+static uint32_t Bind_Pending[BACNET_READ_WRITE_BIND_MAX];
+static unsigned Bind_Pending_Count;
+static struct mstimer Bind_Window_Timer;
+static struct mstimer Bind_Interval_Timer;
+
+/**
+ * @brief Add a device to the devices waiting for a Who-Is to bind them
+ * @param device_id [in] device instance to bind
+ */
+static void bacnet_read_write_bind_queue(uint32_t device_id)
+{
+    unsigned i;
+
+    for (i = 0; i < Bind_Pending_Count; i++) {
+        if (Bind_Pending[i] == device_id) {
+            return;
+        }
+        if (Bind_Pending[i] > device_id) {
+            break;
+        }
+    }
+    if (Bind_Pending_Count >= BACNET_READ_WRITE_BIND_MAX) {
+        /* no room to wait - bind this device on its own */
+        Send_WhoIs(device_id, device_id);
+        return;
+    }
+    if (Bind_Pending_Count == 0) {
+        mstimer_set(&Bind_Window_Timer, BACNET_READ_WRITE_BIND_WINDOW_MS);
+    }
+    memmove(
+        &Bind_Pending[i + 1], &Bind_Pending[i],
+        (Bind_Pending_Count - i) * sizeof(Bind_Pending[0]));
+    Bind_Pending[i] = device_id;
+    Bind_Pending_Count++;
+}
+
+/**
+ * @brief Send one Who-Is for the next range of devices waiting to be bound,
+ *  after the devices have been collected, and no faster than the Who-Is
+ *  interval
+ */
+static void bacnet_read_write_bind_task(void)
+{
+    uint32_t low, high;
+    unsigned count = 1;
+
+    if ((Bind_Pending_Count == 0) || !mstimer_expired(&Bind_Window_Timer) ||
+        !mstimer_expired(&Bind_Interval_Timer)) {
+        return;
+    }
+    low = Bind_Pending[0];
+    high = low;
+    while ((count < Bind_Pending_Count) &&
+           ((Bind_Pending[count] - high) <=
+            (BACNET_READ_WRITE_BIND_RANGE_GAP + 1))) {
+        high = Bind_Pending[count];
+        count++;
+    }
+    Send_WhoIs(low, high);
+    Bind_Pending_Count -= count;
+    memmove(
+        &Bind_Pending[0], &Bind_Pending[count],
+        Bind_Pending_Count * sizeof(Bind_Pending[0]));
+    mstimer_set(&Bind_Interval_Timer, BACNET_READ_WRITE_BIND_INTERVAL_MS);
+}
+
+/**
+ * @brief Find the request that is waiting for a reply
+ * @param src [in] BACNET_ADDRESS of the source of the reply
+ * @param invoke_id [in] the invokeID of the reply
+ * @return the request, or NULL if no request is waiting for this reply
+ */
+static READ_WRITE_TRANSACTION *
+bacnet_read_write_transaction(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    READ_WRITE_TRANSACTION *transaction;
+    unsigned index;
+
+    index = Transaction_Invoke_Index[invoke_id];
+    if ((index == 0) || (index > BACNET_READ_WRITE_WINDOW_MAX)) {
+        return NULL;
+    }
+    transaction = &Transaction[index - 1];
+    if ((transaction->state == BACNET_CLIENT_WAITING) &&
+        (transaction->invoke_id == invoke_id) &&
+        address_match(&transaction->address, src)) {
+        return transaction;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Finish a request with an error
+ * @param transaction [in] the request
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+static void bacnet_read_write_transaction_error(
+    READ_WRITE_TRANSACTION *transaction,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    transaction->error_detected = true;
+    transaction->error_class = error_class;
+    transaction->error_code = error_code;
+    transaction->state = BACNET_CLIENT_FINISHED;
+}
+
+/**
+ * @brief Get the service of the request that was sent
+ * @param transaction [in] the request
+ * @return service of the request, as in Protocol_Services_Supported
+ */
+static BACNET_SERVICES_SUPPORTED
+bacnet_read_write_service(const READ_WRITE_TRANSACTION *transaction)
+{
+    const TARGET_DATA *target = &transaction->target;
+
+    if (target->subscribe_cov) {
+        return SERVICE_SUPPORTED_SUBSCRIBE_COV;
+    }
+    if (target->write_property) {
+        return SERVICE_SUPPORTED_WRITE_PROPERTY;
+    }
+    if (target->read_range) {
+        return SERVICE_SUPPORTED_READ_RANGE;
+    }
+    if ((target->object_property == PROP_ALL) || (target->array_count > 1) ||
+        (transaction->coalesced_count > 0)) {
+        return SERVICE_SUPPORTED_READ_PROP_MULTIPLE;
+    }
+
+    return SERVICE_SUPPORTED_READ_PROPERTY;
+}
 
 /**
  * @brief Handler for an Error PDU.
@@ -95,11 +305,12 @@ static void MyErrorHandler(
     BACNET_ERROR_CLASS error_class,
     BACNET_ERROR_CODE error_code)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = error_class;
-        Error_Code = error_code;
+    READ_WRITE_TRANSACTION *transaction;
+
+    transaction = bacnet_read_write_transaction(src, invoke_id);
+    if (transaction) {
+        bacnet_read_write_transaction_error(
+            transaction, error_class, error_code);
     }
 }
 
@@ -113,12 +324,17 @@ static void MyErrorHandler(
 static void MyAbortHandler(
     BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t abort_reason, bool server)
 {
+    READ_WRITE_TRANSACTION *transaction;
+
     (void)server;
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = ERROR_CLASS_SERVICES;
-        Error_Code = abort_convert_to_error_code(abort_reason);
+    transaction = bacnet_read_write_transaction(src, invoke_id);
+    if (transaction) {
+        capability_abort(
+            transaction->target.device_id,
+            bacnet_read_write_service(transaction), abort_reason);
+        bacnet_read_write_transaction_error(
+            transaction, ERROR_CLASS_SERVICES,
+            abort_convert_to_error_code(abort_reason));
     }
 }
 
@@ -131,11 +347,16 @@ static void MyAbortHandler(
 static void
 MyRejectHandler(BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = ERROR_CLASS_SERVICES;
-        Error_Code = reject_convert_to_error_code(reject_reason);
+    READ_WRITE_TRANSACTION *transaction;
+
+    transaction = bacnet_read_write_transaction(src, invoke_id);
+    if (transaction) {
+        capability_reject(
+            transaction->target.device_id,
+            bacnet_read_write_service(transaction), reject_reason);
+        bacnet_read_write_transaction_error(
+            transaction, ERROR_CLASS_SERVICES,
+            reject_convert_to_error_code(reject_reason));
     }
 }
 
@@ -160,6 +381,7 @@ static void My_I_Am_Bind(
         service_request, service_len, &device_id, &max_apdu, &segmentation,
         &vendor_id);
     if (len > 0) {
+        capability_iam_set(device_id, max_apdu, segmentation, vendor_id);
         found = address_bind_request(device_id, NULL, NULL);
         if (!found) {
             if (Target_Vendor_ID != 0) {
@@ -191,9 +413,11 @@ static void My_I_Am_Bind(
 static void
 MyWritePropertySimpleAckHandler(BACNET_ADDRESS *src, uint8_t invoke_id)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        /* nothing to do */
+    READ_WRITE_TRANSACTION *transaction;
+
+    transaction = bacnet_read_write_transaction(src, invoke_id);
+    if (transaction) {
+        transaction->state = BACNET_CLIENT_FINISHED;
     }
 }
 
@@ -238,6 +462,13 @@ static void bacnet_read_property_ack_process(
                 apdu, (unsigned)apdu_len, value, rp_data->object_type,
                 rp_data->object_property, rp_data->array_index);
             if (len > 0) {
+                if ((rp_data->object_type == OBJECT_DEVICE) &&
+                    (rp_data->object_property ==
+                     PROP_PROTOCOL_SERVICES_SUPPORTED) &&
+                    (value->tag == BACNET_APPLICATION_TAG_BIT_STRING)) {
+                    capability_services_set(
+                        device_id, &value->type.Bit_String);
+                }
                 if ((len < apdu_len) &&
                     (rp_data->array_index == BACNET_ARRAY_ALL)) {
                     /* assume that since there is more data that this
@@ -297,19 +528,21 @@ static void My_Read_Property_Ack_Handler(
     int len = 0;
     BACNET_READ_PROPERTY_DATA rp_data = { 0 };
     uint32_t device_id = 0;
+    READ_WRITE_TRANSACTION *transaction;
 
-    if (address_match(&Target_Address, src) &&
-        (service_data->invoke_id == Request_Invoke_ID)) {
+    transaction =
+        bacnet_read_write_transaction(src, service_data->invoke_id);
+    if (transaction) {
         address_get_device_id(src, &device_id);
         rp_data.error_code = ERROR_CODE_SUCCESS;
         len = rp_ack_decode_service_request(
             service_request, service_len, &rp_data);
         if (len < 0) {
             /* unable to decode value */
-            Error_Detected = true;
-            Error_Class = ERROR_CLASS_SERVICES;
-            Error_Code = ERROR_CODE_INTERNAL_ERROR;
+            bacnet_read_write_transaction_error(
+                transaction, ERROR_CLASS_SERVICES, ERROR_CODE_INTERNAL_ERROR);
         } else {
+            transaction->state = BACNET_CLIENT_FINISHED;
             bacnet_read_property_ack_process(device_id, &rp_data);
         }
     }
@@ -332,10 +565,13 @@ static void My_Read_Property_Multiple_Ack_Handler(
 {
     BACNET_READ_PROPERTY_DATA rp_data = { 0 };
     uint32_t device_id = 0;
+    READ_WRITE_TRANSACTION *transaction;
 
     address_get_device_id(src, &device_id);
-    if (address_match(&Target_Address, src) &&
-        (service_data->invoke_id == Request_Invoke_ID)) {
+    transaction =
+        bacnet_read_write_transaction(src, service_data->invoke_id);
+    if (transaction) {
+        transaction->state = BACNET_CLIENT_FINISHED;
         rp_data.error_code = ERROR_CODE_SUCCESS;
         rpm_ack_object_property_process(
             apdu, apdu_len, device_id, &rp_data,
@@ -343,6 +579,66 @@ static void My_Read_Property_Multiple_Ack_Handler(
     }
 }
 
+/** Handler for a ReadRange ACK.
+ *  Passes the items from a matching ReadRange request to the range callback
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ * decoded from the APDU header of this message.
+ */
+static void My_Read_Range_Ack_Handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
+{
+    BACNET_READ_RANGE_DATA rr_data = { 0 };
+    uint32_t device_id = 0;
+    READ_WRITE_TRANSACTION *transaction;
+    int len;
+
+    transaction =
+        bacnet_read_write_transaction(src, service_data->invoke_id);
+    if (transaction) {
+        len = rr_ack_decode_service_request(
+            service_request, service_len, &rr_data);
+        if (len <= 0) {
+            /* unable to decode the items */
+            bacnet_read_write_transaction_error(
+                transaction, ERROR_CLASS_SERVICES, ERROR_CODE_INTERNAL_ERROR);
+        } else {
+            transaction->state = BACNET_CLIENT_FINISHED;
+            address_get_device_id(src, &device_id);
+            if (bacnet_read_write_range_callback) {
+                bacnet_read_write_range_callback(device_id, &rr_data);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Sends a ReadRange by sequence number service request
+ * @param target [in] The request with the object property, first sequence
+ *  number, and number of items
+ * @return invoke_id of request
+ */
+static uint8_t Send_Read_Range_Request(const TARGET_DATA *target)
+{
+    BACNET_READ_RANGE_DATA rr_data = { 0 };
+
+    rr_data.object_type = target->object_type;
+    rr_data.object_instance = target->object_instance;
+    rr_data.object_property = target->object_property;
+    rr_data.array_index = BACNET_ARRAY_ALL;
+    rr_data.RequestType = RR_BY_SEQUENCE;
+    rr_data.Range.RefSeqNum = target->sequence;
+    rr_data.Count = (int32_t)target->array_count;
+
+    return Send_ReadRange_Request(target->device_id, &rr_data);
+}
+
 /**
  * @brief Sends a ReadPropertyMultiple service request
  * @param device_id [in] The contents of the service request.
@@ -377,26 +673,228 @@ static uint8_t Send_RPM_All_Request(
 }
 
 /**
- * @brief Handles the ReadProperty process
- * @param service_request [in] The contents of the service request.
+ * @brief Sends a ReadPropertyMultiple service request for consecutive
+ *  elements of an array property
+ * @param target [in] The request with the first array index and count
+ * @return invoke_id of request
+ */
+static uint8_t Send_RPM_Array_Request(const TARGET_DATA *target)
+{
+    BACNET_READ_ACCESS_DATA read_access_data = { 0 };
+    BACNET_PROPERTY_REFERENCE property_list[BACNET_READ_WRITE_ARRAY_COUNT_MAX];
+    uint8_t pdu[MAX_PDU] = { 0 };
+    uint32_t count, i;
+
+    count = target->array_count;
+    if (count > BACNET_READ_WRITE_ARRAY_COUNT_MAX) {
+        count = BACNET_READ_WRITE_ARRAY_COUNT_MAX;
+    }
+    /* configure the property list */
+    for (i = 0; i < count; i++) {
+        property_list[i].error.error_class = ERROR_CLASS_DEVICE;
+        property_list[i].error.error_code = ERROR_CODE_OTHER;
+        property_list[i].value = NULL;
+        property_list[i].propertyArrayIndex = target->array_index + i;
+        property_list[i].propertyIdentifier = target->object_property;
+        if ((i + 1) < count) {
+            property_list[i].next = &property_list[i + 1];
+        } else {
+            property_list[i].next = NULL;
+        }
+    }
+    /* configure the read access data */
+    read_access_data.listOfProperties = &property_list[0];
+    read_access_data.object_instance = target->object_instance;
+    read_access_data.object_type = target->object_type;
+    read_access_data.next = NULL;
+
+    return Send_Read_Property_Multiple_Request(
+        pdu, sizeof(pdu), target->device_id, &read_access_data);
+}
+
+/**
+ * @brief Determine if a queued request is a read that can be packed
+ *  with other reads of the same device
+ * @param target [in] queued request
+ * @return true if the request can be packed
+ */
+static bool bacnet_read_write_coalescable(const TARGET_DATA *target)
+{
+    if (!Coalesce_Enabled || target->write_property || target->subscribe_cov ||
+        target->read_range || target->single ||
+        (target->array_count > 1) || (target->object_property == PROP_ALL) ||
+        (target->object_property == PROP_REQUIRED) ||
+        (target->object_property == PROP_OPTIONAL)) {
+        return false;
+    }
+
+    return capability_service_supported(
+        target->device_id, SERVICE_SUPPORTED_READ_PROP_MULTIPLE);
+}
+
+/**
+ * @brief Take the queued reads of the same device as the request, as many
+ *  as fit in a ReadPropertyMultiple-ACK of the device max APDU.
+ *  The other queued requests keep their order.
+ * @param transaction [in] request about to be sent
+ * @return number of reads taken from the queue
+ */
+static unsigned
+bacnet_read_write_coalesce_take(READ_WRITE_TRANSACTION *transaction)
+{
+    TARGET_DATA element;
+    unsigned count, limit = 1, max_apdu;
+
+    transaction->coalesced_count = 0;
+    if (!bacnet_read_write_coalescable(&transaction->target)) {
+        return 0;
+    }
+    /* the device may have aborted larger replies before */
+    max_apdu = capability_max_apdu(transaction->target.device_id);
+    if ((max_apdu == 0) || (max_apdu > transaction->max_apdu)) {
+        max_apdu = transaction->max_apdu;
+    }
+    if (max_apdu > BACNET_READ_WRITE_COALESCE_OVERHEAD) {
+        limit = (max_apdu - BACNET_READ_WRITE_COALESCE_OVERHEAD) /
+            BACNET_READ_WRITE_COALESCE_SIZE;
+    }
+    if (limit > BACNET_READ_WRITE_COALESCE_MAX) {
+        limit = BACNET_READ_WRITE_COALESCE_MAX;
+    }
+    count = Ringbuf_Count(&Target_Data_Queue);
+    while (count > 0) {
+        Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&element);
+        if (((transaction->coalesced_count + 1) < limit) &&
+            (element.device_id == transaction->target.device_id) &&
+            bacnet_read_write_coalescable(&element)) {
+            transaction->coalesced[transaction->coalesced_count] = element;
+            transaction->coalesced_count++;
+        } else {
+            Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&element);
+        }
+        count--;
+    }
+
+    return transaction->coalesced_count;
+}
+
+/**
+ * @brief Return the packed reads of a request to the front of the queue,
+ *  in their order, to be sent again
+ * @param transaction [in] request with packed reads
+ * @param single [in] true if the reads are to be sent alone
+ */
+static void bacnet_read_write_coalesce_return(
+    READ_WRITE_TRANSACTION *transaction, bool single)
+{
+    unsigned i;
+
+    for (i = transaction->coalesced_count; i > 0; i--) {
+        transaction->coalesced[i - 1].single = single;
+        if (!Ringbuf_Put_Front(
+                &Target_Data_Queue,
+                (uint8_t *)&transaction->coalesced[i - 1])) {
+            break;
+        }
+    }
+    transaction->coalesced_count = i;
+}
+
+/**
+ * @brief Return the packed reads of a request that was not sent
+ * @param transaction [in] request with packed reads
+ */
+static void bacnet_read_write_coalesce_undo(READ_WRITE_TRANSACTION *transaction)
+{
+    bacnet_read_write_coalesce_return(transaction, false);
+}
+
+/**
+ * @brief Sends a ReadPropertyMultiple service request for a request and
+ *  the reads packed with it
+ * @param transaction [in] request with packed reads
+ * @return invoke_id of request
+ */
+static uint8_t Send_RPM_Coalesced_Request(READ_WRITE_TRANSACTION *transaction)
+{
+    BACNET_READ_ACCESS_DATA read_access_data[BACNET_READ_WRITE_COALESCE_MAX];
+    BACNET_PROPERTY_REFERENCE property_list[BACNET_READ_WRITE_COALESCE_MAX];
+    uint8_t pdu[MAX_PDU] = { 0 };
+    const TARGET_DATA *target;
+    unsigned i, count;
+
+    count = transaction->coalesced_count + 1;
+    for (i = 0; i < count; i++) {
+        if (i == 0) {
+            target = &transaction->target;
+        } else {
+            target = &transaction->coalesced[i - 1];
+        }
+        property_list[i].error.error_class = ERROR_CLASS_DEVICE;
+        property_list[i].error.error_code = ERROR_CODE_OTHER;
+        property_list[i].value = NULL;
+        property_list[i].propertyIdentifier = target->object_property;
+        property_list[i].propertyArrayIndex = target->array_index;
+        property_list[i].next = NULL;
+        read_access_data[i].object_type = target->object_type;
+        read_access_data[i].object_instance = target->object_instance;
+        read_access_data[i].listOfProperties = &property_list[i];
+        if ((i + 1) < count) {
+            read_access_data[i].next = &read_access_data[i + 1];
+        } else {
+            read_access_data[i].next = NULL;
+        }
+    }
+
+    return Send_Read_Property_Multiple_Request(
+        pdu, sizeof(pdu), transaction->target.device_id, &read_access_data[0]);
+}
+
+/**
+ * @brief Sends a SubscribeCOV service request for unconfirmed
+ *  notifications of an object
+ * @param target [in] The request with the object and lifetime
+ * @return invoke_id of request
+ */
+static uint8_t Send_COV_Subscribe_Request(const TARGET_DATA *target)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+
+    cov_data.subscriberProcessIdentifier = BACNET_READ_WRITE_COV_PROCESS_ID;
+    cov_data.monitoredObjectIdentifier.type = target->object_type;
+    cov_data.monitoredObjectIdentifier.instance = target->object_instance;
+    cov_data.cancellationRequest = false;
+    cov_data.issueConfirmedNotifications = false;
+    cov_data.lifetime = target->lifetime;
+    cov_data.covSubscribeToProperty = false;
+    cov_data.next = NULL;
+
+    return Send_COV_Subscribe(target->device_id, &cov_data);
+}
+
+/**
+ * @brief Handles the ReadProperty process of one request
+ * @param transaction [in] The request in progress
  * @return true if the process is finished
  */
-static bool bacnet_read_write_process(const TARGET_DATA *target)
+static bool bacnet_read_write_process(READ_WRITE_TRANSACTION *transaction)
 {
+    const TARGET_DATA *target = &transaction->target;
     bool found = false;
     unsigned max_apdu = 0;
     uint8_t application_data[16] = { 0 };
     int application_data_len = 0;
     bool valid_tag = false;
 
-    switch (RW_State) {
+    switch (transaction->state) {
         case BACNET_CLIENT_IDLE:
-            mstimer_set(&Read_Write_Timer, apdu_timeout());
+            mstimer_set(&transaction->timer, apdu_timeout());
+            transaction->invoke_id = 0;
             if (target->device_id < BACNET_MAX_INSTANCE) {
-                Error_Detected = false;
-                RW_State = BACNET_CLIENT_BIND;
+                transaction->error_detected = false;
+                transaction->state = BACNET_CLIENT_BIND;
             } else {
-                RW_State = BACNET_CLIENT_FINISHED;
+                transaction->state = BACNET_CLIENT_FINISHED;
             }
             break;
         case BACNET_CLIENT_BIND:
@@ -404,32 +902,51 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
             address_own_device_id_set(Device_Object_Instance_Number());
             /* try to bind with the device */
             found = address_bind_request(
-                target->device_id, &max_apdu, &Target_Address);
+                target->device_id, &max_apdu, &transaction->address);
             if (found) {
-                Target_Device_ID = target->device_id;
-                RW_State = BACNET_CLIENT_SEND;
+                transaction->max_apdu = max_apdu;
+                transaction->state = BACNET_CLIENT_SEND;
             } else {
-                Send_WhoIs(target->device_id, target->device_id);
-                RW_State = BACNET_CLIENT_BINDING;
+                bacnet_read_write_bind_queue(target->device_id);
+                mstimer_set(
+                    &transaction->timer,
+                    apdu_timeout() + BACNET_READ_WRITE_BIND_WINDOW_MS);
+                transaction->state = BACNET_CLIENT_BINDING;
             }
             break;
         case BACNET_CLIENT_BINDING:
             found = address_bind_request(
-                target->device_id, &max_apdu, &Target_Address);
+                target->device_id, &max_apdu, &transaction->address);
             if (found) {
-                Target_Device_ID = target->device_id;
-                mstimer_set(&Read_Write_Timer, apdu_timeout());
-                RW_State = BACNET_CLIENT_SEND;
-            } else if (mstimer_expired(&Read_Write_Timer)) {
+                transaction->max_apdu = max_apdu;
+                mstimer_set(&transaction->timer, apdu_timeout());
+                transaction->state = BACNET_CLIENT_SEND;
+            } else if (mstimer_expired(&transaction->timer)) {
                 /* unable to bind within APDU timeout */
-                Error_Detected = true;
-                Error_Class = ERROR_CLASS_SERVICES;
-                Error_Code = ERROR_CODE_TIMEOUT;
-                RW_State = BACNET_CLIENT_FINISHED;
+                bacnet_read_write_transaction_error(
+                    transaction, ERROR_CLASS_SERVICES, ERROR_CODE_TIMEOUT);
             }
             break;
         case BACNET_CLIENT_SEND:
-            if (target->write_property) {
+            if (!capability_service_supported(
+                    target->device_id,
+                    bacnet_read_write_service(transaction))) {
+                /* known to fail - do not send it */
+                bacnet_read_write_transaction_error(
+                    transaction, ERROR_CLASS_SERVICES,
+                    ERROR_CODE_REJECT_UNRECOGNIZED_SERVICE);
+            } else if (target->subscribe_cov) {
+                transaction->invoke_id = Send_COV_Subscribe_Request(target);
+            } else if (target->read_range) {
+                transaction->invoke_id = Send_Read_Range_Request(target);
+            } else if (target->write_property && target->value) {
+                transaction->invoke_id = Send_Write_Property_Request_Data(
+                    target->device_id, target->object_type,
+                    target->object_instance, target->object_property,
+                    valbuf_data(target->value),
+                    (int)valbuf_length(target->value), target->priority,
+                    target->array_index);
+            } else if (target->write_property) {
                 switch (target->tag) {
                     case BACNET_APPLICATION_TAG_NULL:
                         application_data_len =
@@ -465,7 +982,7 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
                         break;
                 }
                 if (valid_tag) {
-                    Request_Invoke_ID = Send_Write_Property_Request_Data(
+                    transaction->invoke_id = Send_Write_Property_Request_Data(
                         target->device_id, target->object_type,
                         target->object_instance, target->object_property,
                         &application_data[0], application_data_len,
@@ -473,50 +990,138 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
                 }
             } else {
                 if (target->object_property == PROP_ALL) {
-                    Request_Invoke_ID = Send_RPM_All_Request(
+                    transaction->invoke_id = Send_RPM_All_Request(
                         target->device_id, target->object_type,
                         target->object_instance);
+                } else if (target->array_count > 1) {
+                    transaction->invoke_id = Send_RPM_Array_Request(target);
+                } else if (bacnet_read_write_coalesce_take(transaction) > 0) {
+                    transaction->invoke_id =
+                        Send_RPM_Coalesced_Request(transaction);
                 } else {
-                    Request_Invoke_ID = Send_Read_Property_Request(
+                    transaction->invoke_id = Send_Read_Property_Request(
                         target->device_id, target->object_type,
                         target->object_instance, target->object_property,
                         target->array_index);
                 }
             }
-            if (Request_Invoke_ID == 0) {
-                if (mstimer_expired(&Read_Write_Timer)) {
+            if (transaction->invoke_id == 0) {
+                bacnet_read_write_coalesce_undo(transaction);
+                if (mstimer_expired(&transaction->timer)) {
                     /* TSM Timeout - no invokeIDs available */
-                    Error_Detected = true;
-                    Error_Class = ERROR_CLASS_SERVICES;
-                    Error_Code = ERROR_CODE_TIMEOUT;
-                    RW_State = BACNET_CLIENT_FINISHED;
+                    bacnet_read_write_transaction_error(
+                        transaction, ERROR_CLASS_SERVICES, ERROR_CODE_TIMEOUT);
                 }
             } else {
-                RW_State = BACNET_CLIENT_WAITING;
+                transaction->sent = mstimer_now();
+                transaction->state = BACNET_CLIENT_WAITING;
+                Transaction_Invoke_Index[transaction->invoke_id] =
+                    (uint8_t)(transaction - &Transaction[0]) + 1;
             }
             break;
         case BACNET_CLIENT_WAITING:
-            if (Error_Detected) {
-                RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
-                Error_Detected = false;
-                RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
-                Error_Detected = true;
-                Error_Class = ERROR_CLASS_SERVICES;
-                Error_Code = ERROR_CODE_ABORT_TSM_TIMEOUT;
-                RW_State = BACNET_CLIENT_FINISHED;
-                tsm_free_invoke_id(Request_Invoke_ID);
+            /* the reply handlers finish the request */
+            if (tsm_invoke_id_free(transaction->invoke_id)) {
+                transaction->state = BACNET_CLIENT_FINISHED;
+            } else if (tsm_invoke_id_failed(transaction->invoke_id)) {
+                bacnet_read_write_transaction_error(
+                    transaction, ERROR_CLASS_SERVICES,
+                    ERROR_CODE_ABORT_TSM_TIMEOUT);
+                tsm_free_invoke_id(transaction->invoke_id);
             }
             break;
         case BACNET_CLIENT_FINISHED:
-            RW_State = BACNET_CLIENT_IDLE;
-            break;
         default:
             break;
     }
 
-    return (RW_State == BACNET_CLIENT_FINISHED);
+    return (transaction->state == BACNET_CLIENT_FINISHED);
+}
+
+/**
+ * @brief Report the end of one queued request
+ * @param transaction [in] The finished request
+ * @param target [in] The queued request, which may be packed with others
+ */
+static void bacnet_read_write_finish_target(
+    const READ_WRITE_TRANSACTION *transaction, const TARGET_DATA *target)
+{
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    unsigned long milliseconds = 0;
+
+    rp_data.object_type = target->object_type;
+    rp_data.object_instance = target->object_instance;
+    rp_data.object_property = target->object_property;
+    rp_data.array_index = target->array_index;
+    if (transaction->error_detected) {
+        rp_data.error_class = transaction->error_class;
+        rp_data.error_code = transaction->error_code;
+        if (bacnet_read_write_value_callback) {
+            bacnet_read_write_value_callback(
+                target->device_id, &rp_data, NULL);
+        }
+    } else {
+        rp_data.error_class = ERROR_CLASS_SERVICES;
+        rp_data.error_code = ERROR_CODE_SUCCESS;
+    }
+    if (bacnet_read_write_complete_callback) {
+        if (transaction->invoke_id != 0) {
+            milliseconds = mstimer_now() - transaction->sent;
+        }
+        bacnet_read_write_complete_callback(
+            target->device_id, transaction->invoke_id, &rp_data,
+            target->array_count, milliseconds);
+    }
+}
+
+/**
+ * @brief Report the end of a request and the reads packed with it,
+ *  and free it
+ * @param transaction [in] The finished request
+ */
+static void bacnet_read_write_finish(READ_WRITE_TRANSACTION *transaction)
+{
+    unsigned i;
+    bool single = true;
+
+    if ((transaction->coalesced_count > 0) && transaction->error_detected &&
+        (transaction->error_code != ERROR_CODE_TIMEOUT) &&
+        (transaction->error_code != ERROR_CODE_ABORT_TSM_TIMEOUT)) {
+        if ((transaction->error_code == ERROR_CODE_ABORT_BUFFER_OVERFLOW) ||
+            (transaction->error_code ==
+             ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED) ||
+            (transaction->error_code == ERROR_CODE_ABORT_APDU_TOO_LONG)) {
+            /* the reply was too long - the abort lowered the limit of
+               the device, so fewer reads are packed next time */
+            single = false;
+        } else {
+            /* the device did not accept the packed reads - send them alone */
+            capability_service_denied(
+                transaction->target.device_id,
+                SERVICE_SUPPORTED_READ_PROP_MULTIPLE);
+        }
+        bacnet_read_write_coalesce_return(transaction, single);
+        transaction->target.single = single;
+        if ((transaction->coalesced_count == 0) &&
+            Ringbuf_Put_Front(
+                &Target_Data_Queue, (uint8_t *)&transaction->target)) {
+            Transaction_Invoke_Index[transaction->invoke_id] = 0;
+            transaction->state = BACNET_CLIENT_IDLE;
+            return;
+        }
+    }
+    bacnet_read_write_finish_target(transaction, &transaction->target);
+    valbuf_release(transaction->target.value);
+    transaction->target.value = NULL;
+    for (i = 0; i < transaction->coalesced_count; i++) {
+        bacnet_read_write_finish_target(
+            transaction, &transaction->coalesced[i]);
+    }
+    transaction->coalesced_count = 0;
+    if (transaction->invoke_id != 0) {
+        Transaction_Invoke_Index[transaction->invoke_id] = 0;
+    }
+    transaction->state = BACNET_CLIENT_IDLE;
 }
 
 /**
@@ -530,6 +1135,17 @@ void bacnet_read_write_value_callback_set(
     bacnet_read_write_value_callback = callback;
 }
 
+/**
+ * @brief Sets the callback for when a ReadRange returns items
+ *
+ * @param callback - function for callback
+ */
+void bacnet_read_write_range_callback_set(
+    bacnet_read_write_range_callback_t callback)
+{
+    bacnet_read_write_range_callback = callback;
+}
+
 /**
  * @brief Sets the callback for when an I-Am returns device data
  *
@@ -541,37 +1157,202 @@ void bacnet_read_write_device_callback_set(
     bacnet_read_write_device_callback = callback;
 }
 
+/**
+ * @brief Sets the callback for when a request is finished
+ *
+ * @param callback - function for callback
+ */
+void bacnet_read_write_complete_callback_set(
+    bacnet_read_write_complete_callback_t callback)
+{
+    bacnet_read_write_complete_callback = callback;
+}
+
+/**
+ * @brief Sets the number of requests that can be in progress at once
+ * @param window - number of requests 1..BACNET_READ_WRITE_WINDOW_MAX,
+ *  and no more than the TSM transactions
+ */
+void bacnet_read_write_window_set(unsigned window)
+{
+    if (window < 1) {
+        window = 1;
+    } else if (window > BACNET_READ_WRITE_WINDOW_MAX) {
+        window = BACNET_READ_WRITE_WINDOW_MAX;
+    }
+#if MAX_TSM_TRANSACTIONS
+    if (window > MAX_TSM_TRANSACTIONS) {
+        window = MAX_TSM_TRANSACTIONS;
+    }
+#endif
+    Transaction_Window = window;
+}
+
+/**
+ * @brief Gets the number of requests that can be in progress at once
+ * @return number of requests
+ */
+unsigned bacnet_read_write_window(void)
+{
+    return Transaction_Window;
+}
+
+/**
+ * @brief Enables or disables packing queued reads of the same device into
+ *  ReadPropertyMultiple requests
+ * @param enable - true to pack reads
+ */
+void bacnet_read_write_coalesce_set(bool enable)
+{
+    Coalesce_Enabled = enable;
+}
+
+/**
+ * @brief Determines if queued reads of the same device are packed into
+ *  ReadPropertyMultiple requests
+ * @return true if reads are packed
+ */
+bool bacnet_read_write_coalesce(void)
+{
+    return Coalesce_Enabled;
+}
+
+/**
+ * @brief Sets the number of requests that can be in progress at once
+ *  to the same device
+ * @param window - number of requests, or zero for no limit other than
+ *  the number of requests in progress at once
+ */
+void bacnet_read_write_device_window_set(unsigned window)
+{
+    Transaction_Device_Window = window;
+}
+
+/**
+ * @brief Gets the number of requests that can be in progress at once
+ *  to the same device
+ * @return number of requests, or zero for no limit
+ */
+unsigned bacnet_read_write_device_window(void)
+{
+    return Transaction_Device_Window;
+}
+
+/**
+ * @brief Determine if another request can be in progress to a device
+ * @param device_id - ID of the destination device
+ * @return true if the device has fewer requests in progress than allowed
+ */
+static bool bacnet_read_write_device_ready(uint32_t device_id)
+{
+    unsigned i, active = 0;
+
+    if (Transaction_Device_Window == 0) {
+        return true;
+    }
+    for (i = 0; i < BACNET_READ_WRITE_WINDOW_MAX; i++) {
+        if ((Transaction[i].state != BACNET_CLIENT_IDLE) &&
+            (Transaction[i].target.device_id == device_id)) {
+            active++;
+        }
+    }
+
+    return active < Transaction_Device_Window;
+}
+
+/**
+ * @brief Adds a request to the queue, doubling the queue when it is full
+ *  up to TARGET_DATA_QUEUE_COUNT_MAX requests
+ * @param target - request to add
+ * @return true if added, false if not added
+ */
+static bool bacnet_read_write_queue_put(const TARGET_DATA *target)
+{
+    RING_BUFFER queue;
+    TARGET_DATA *buffer;
+    TARGET_DATA element;
+    unsigned count;
+
+    if (Ringbuf_Full(&Target_Data_Queue)) {
+        count = Ringbuf_Size(&Target_Data_Queue) * 2;
+        if (count > TARGET_DATA_QUEUE_COUNT_MAX) {
+            return false;
+        }
+        buffer = BACNET_MEMPOOL_CALLOC(count * sizeof(TARGET_DATA));
+        if (!buffer) {
+            return false;
+        }
+        Ringbuf_Initialize(
+            &queue, (uint8_t *)buffer, count * sizeof(TARGET_DATA),
+            TARGET_DATA_QUEUE_SIZE, count);
+        while (Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&element)) {
+            Ringbuf_Put(&queue, (uint8_t *)&element);
+        }
+        BACNET_MEMPOOL_FREE(
+            Target_Data_Heap,
+            Ringbuf_Size(&Target_Data_Queue) * sizeof(TARGET_DATA));
+        Target_Data_Heap = buffer;
+        Target_Data_Queue = queue;
+    }
+
+    return Ringbuf_Put(&Target_Data_Queue, (const uint8_t *)target);
+}
+
 /**
  * @brief Handles the ReadProperty repetitive task
  */
 void bacnet_read_write_task(void)
 {
+    unsigned i, active = 0, count;
+    READ_WRITE_TRANSACTION *transaction = NULL;
     TARGET_DATA *target;
-    bool status = false;
-    BACNET_READ_PROPERTY_DATA rp_data;
 
-    if (!Ringbuf_Empty(&Target_Data_Queue)) {
-        target = (TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
-        status = bacnet_read_write_process(target);
-        if (status) {
-            if (Error_Detected) {
-                if (bacnet_read_write_value_callback) {
-                    rp_data.error_class = Error_Class;
-                    rp_data.error_code = Error_Code;
-                    rp_data.object_type = target->object_type;
-                    rp_data.object_instance = target->object_instance;
-                    rp_data.object_property = target->object_property;
-                    rp_data.array_index = target->array_index;
-                    bacnet_read_write_value_callback(
-                        target->device_id, &rp_data, NULL);
-                }
+    bacnet_read_write_bind_task();
+    /* requests in progress go first so that a freed invoke ID is
+       not taken by a new request before its reply is seen */
+    for (i = 0; i < BACNET_READ_WRITE_WINDOW_MAX; i++) {
+        if (Transaction[i].state != BACNET_CLIENT_IDLE) {
+            if (bacnet_read_write_process(&Transaction[i])) {
+                bacnet_read_write_finish(&Transaction[i]);
+            } else {
+                active++;
             }
-            Ringbuf_Pop(&Target_Data_Queue, NULL);
+        }
+    }
+    /* start queued requests while the window is open */
+    for (i = 0; i < BACNET_READ_WRITE_WINDOW_MAX; i++) {
+        if ((active >= Transaction_Window) ||
+            Ringbuf_Empty(&Target_Data_Queue)) {
+            break;
+        }
+        transaction = &Transaction[i];
+        if (transaction->state != BACNET_CLIENT_IDLE) {
+            continue;
+        }
+        /* requests to a device at its window go to the back of the
+           queue, keeping their order, so other devices are not held up */
+        count = Ringbuf_Count(&Target_Data_Queue);
+        target = (TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
+        while (count && !bacnet_read_write_device_ready(target->device_id)) {
+            Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&transaction->target);
+            Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&transaction->target);
+            target = (TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
+            count--;
+        }
+        if (count == 0) {
+            break;
+        }
+        Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&transaction->target);
+        if (bacnet_read_write_process(transaction)) {
+            bacnet_read_write_finish(transaction);
+        } else {
+            active++;
         }
     }
     if (mstimer_expired(&Cache_Timer)) {
         mstimer_reset(&Cache_Timer);
         address_cache_timer(CACHE_CYCLE_SECONDS);
+        npdu_route_cache_timer(CACHE_CYCLE_SECONDS);
     }
 }
 
@@ -596,15 +1377,56 @@ bool bacnet_read_property_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
+
+    target.write_property = false;
+    target.device_id = device_id;
+    target.object_type = object_type;
+    target.object_instance = object_instance;
+    target.object_property = object_property;
+    target.array_index = array_index;
+    target.array_count = 1;
+    status = bacnet_read_write_queue_put(&target);
+
+    return status;
+}
+
+/**
+ * @brief Adds a request to read consecutive elements of an array property
+ *  of a remote data point, using ReadPropertyMultiple for more than one
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be read.
+ * @param object_instance - Instance # of the object to be read.
+ * @param object_property - Array property to be read
+ * @param array_index [in] first array index to be read, 1 to n
+ * @param array_count [in] number of array elements to be read,
+ *  1 to BACNET_READ_WRITE_ARRAY_COUNT_MAX
+ * @return true if added, false if not added
+ */
+bool bacnet_read_property_array_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t array_index,
+    uint32_t array_count)
+{
+    bool status = false;
+    TARGET_DATA target = { 0 };
 
+    if (array_count < 1) {
+        array_count = 1;
+    } else if (array_count > BACNET_READ_WRITE_ARRAY_COUNT_MAX) {
+        array_count = BACNET_READ_WRITE_ARRAY_COUNT_MAX;
+    }
     target.write_property = false;
     target.device_id = device_id;
     target.object_type = object_type;
     target.object_instance = object_instance;
     target.object_property = object_property;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    target.array_count = array_count;
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -645,7 +1467,7 @@ bool bacnet_write_property_real_queue(
     target.type.Real = value;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -684,7 +1506,7 @@ bool bacnet_write_property_null_queue(
     target.tag = BACNET_APPLICATION_TAG_NULL;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -714,7 +1536,7 @@ bool bacnet_write_property_enumerated_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -725,7 +1547,7 @@ bool bacnet_write_property_enumerated_queue(
     target.type.Enumerated = value;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -755,7 +1577,7 @@ bool bacnet_write_property_unsigned_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -766,7 +1588,7 @@ bool bacnet_write_property_unsigned_queue(
     target.type.Unsigned_Int = value;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -796,7 +1618,7 @@ bool bacnet_write_property_signed_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -807,7 +1629,7 @@ bool bacnet_write_property_signed_queue(
     target.type.Signed_Int = value;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
@@ -837,7 +1659,7 @@ bool bacnet_write_property_boolean_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -848,27 +1670,92 @@ bool bacnet_write_property_boolean_queue(
     target.type.Boolean = value;
     target.priority = priority;
     target.array_index = array_index;
-    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+    status = bacnet_read_write_queue_put(&target);
 
     return status;
 }
 
 /**
- * @brief Determines if the BACnet ReadProperty queue is empty
+ * @brief Adds a WriteProperty request to a remote data point with an
+ *  encoded value of any type, such as a list or a constructed value.
+ *  The queue takes a share of the value buffer instead of a copy, so the
+ *  caller may release its own share at once, and the encoded bytes are
+ *  sent as they are.
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be written.
+ * @param object_instance - Instance # of the object to be written.
+ * @param object_property - Property to be written
+ * @param value - buffer of the encoded property value
+ * @param priority - BACnet priority for writing 1..16, or 0 if not set
+ * @param array_index [in] Optional: if the Property is an array,
+ *   - 0 for the array size
+ *   - 1 to n for individual array members
+ *   - BACNET_ARRAY_ALL (~0) for the full array to be written.
+ * @return true if added, false if not added
+ */
+bool bacnet_write_property_value_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    BACNET_VALBUF *value,
+    uint8_t priority,
+    uint32_t array_index)
+{
+    bool status = false;
+    TARGET_DATA target = { 0 };
+
+    if (!value || (valbuf_length(value) == 0) ||
+        (valbuf_length(value) > MAX_APDU)) {
+        return false;
+    }
+    target.write_property = true;
+    target.device_id = device_id;
+    target.object_type = object_type;
+    target.object_instance = object_instance;
+    target.object_property = object_property;
+    target.value = valbuf_share(value);
+    target.priority = priority;
+    target.array_index = array_index;
+    status = bacnet_read_write_queue_put(&target);
+    if (!status) {
+        valbuf_release(target.value);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Determines if the BACnet ReadProperty queue is empty, and
+ *  no requests are in progress
  * @return true if the parameter queue is empty, and thus, idle
  */
 bool bacnet_read_write_idle(void)
 {
-    return Ringbuf_Empty(&Target_Data_Queue);
+    unsigned i;
+
+    if (!Ringbuf_Empty(&Target_Data_Queue)) {
+        return false;
+    }
+    for (i = 0; i < BACNET_READ_WRITE_WINDOW_MAX; i++) {
+        if (Transaction[i].state != BACNET_CLIENT_IDLE) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /**
- * @brief Determines if the BACnet ReadProperty queue is full
+ * @brief Determines if the BACnet ReadProperty queue is full, and has
+ *  grown as large as it can
  * @return true if the parameter queue is full, and thus, busy
  */
 bool bacnet_read_write_busy(void)
 {
-    return Ringbuf_Full(&Target_Data_Queue);
+    return Ringbuf_Full(&Target_Data_Queue) &&
+        ((Ringbuf_Size(&Target_Data_Queue) * 2) >
+         TARGET_DATA_QUEUE_COUNT_MAX);
 }
 
 /**
@@ -891,15 +1778,129 @@ uint16_t bacnet_read_write_vendor_id_filter(void)
     return Target_Vendor_ID;
 }
 
+/**
+ * @brief Report the values of a COV notification to the value callback,
+ *  the same as the values of a ReadProperty-ACK
+ * @param cov_data [in] data decoded from the COV notification
+ */
+static void bacnet_read_write_cov_notification(BACNET_COV_DATA *cov_data)
+{
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    BACNET_PROPERTY_VALUE *property_value;
+
+    if (!cov_data || !bacnet_read_write_value_callback) {
+        return;
+    }
+    rp_data.object_type = cov_data->monitoredObjectIdentifier.type;
+    rp_data.object_instance = cov_data->monitoredObjectIdentifier.instance;
+    rp_data.error_class = ERROR_CLASS_SERVICES;
+    rp_data.error_code = ERROR_CODE_SUCCESS;
+    property_value = cov_data->listOfValues;
+    while (property_value) {
+        rp_data.object_property = property_value->propertyIdentifier;
+        rp_data.array_index = property_value->propertyArrayIndex;
+        bacnet_read_write_value_callback(
+            cov_data->initiatingDeviceIdentifier, &rp_data,
+            &property_value->value);
+        property_value = property_value->next;
+    }
+}
+
+/* COV notification callback */
+static BACNET_COV_NOTIFICATION Read_Write_COV_Notification = {
+    NULL, bacnet_read_write_cov_notification
+};
+
+/**
+ * @brief Adds a SubscribeCOV request for unconfirmed COV notifications
+ *  of a remote object, whose values go to the value callback
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object to subscribe
+ * @param object_instance - Instance # of the object to subscribe
+ * @param lifetime - lifetime of the subscription in seconds,
+ *  0=indefinite
+ * @return true if added, false if not added
+ */
+bool bacnet_subscribe_cov_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t lifetime)
+{
+    TARGET_DATA target = { 0 };
+
+    target.subscribe_cov = true;
+    target.device_id = device_id;
+    target.object_type = object_type;
+    target.object_instance = object_instance;
+    target.object_property = PROP_PRESENT_VALUE;
+    target.array_index = BACNET_ARRAY_ALL;
+    target.lifetime = lifetime;
+
+    return bacnet_read_write_queue_put(&target);
+}
+
+/**
+ * @brief Adds a ReadRange by sequence number request of a list property
+ *  of a remote object, such as a Log_Buffer.  The items of the reply are
+ *  passed to the range callback.
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be read.
+ * @param object_instance - Instance # of the object to be read.
+ * @param object_property - List property to be read
+ * @param sequence [in] sequence number of the first item to be read
+ * @param count [in] number of items to be read, 1 or more
+ * @return true if added, false if not added
+ */
+bool bacnet_read_range_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t sequence,
+    uint32_t count)
+{
+    TARGET_DATA target = { 0 };
+
+    if (count < 1) {
+        count = 1;
+    } else if (count > INT32_MAX) {
+        count = INT32_MAX;
+    }
+    target.read_range = true;
+    target.device_id = device_id;
+    target.object_type = object_type;
+    target.object_instance = object_instance;
+    target.object_property = object_property;
+    target.array_index = BACNET_ARRAY_ALL;
+    target.array_count = count;
+    target.sequence = sequence;
+
+    return bacnet_read_write_queue_put(&target);
+}
+
 /**
  * @brief Initializes the ReadProperty module
  */
 void bacnet_read_write_init(void)
 {
+    TARGET_DATA target;
+
+    while (Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&target)) {
+        valbuf_release(target.value);
+    }
+    if (Target_Data_Heap) {
+        BACNET_MEMPOOL_FREE(
+            Target_Data_Heap,
+            Ringbuf_Size(&Target_Data_Queue) * sizeof(TARGET_DATA));
+    }
+    Target_Data_Heap = NULL;
     Ringbuf_Initialize(
         &Target_Data_Queue, (uint8_t *)&Target_Data_Buffer,
         sizeof(Target_Data_Buffer), TARGET_DATA_QUEUE_SIZE,
         TARGET_DATA_QUEUE_COUNT);
+    Bind_Pending_Count = 0;
+    mstimer_set(&Bind_Interval_Timer, BACNET_READ_WRITE_BIND_INTERVAL_MS);
     /* handle i-am to support binding to other devices */
     apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_I_AM, My_I_Am_Bind);
     /* handle the data coming back from confirmed requests */
@@ -908,12 +1909,24 @@ void bacnet_read_write_init(void)
     apdu_set_confirmed_ack_handler(
         SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
         My_Read_Property_Multiple_Ack_Handler);
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_RANGE, My_Read_Range_Ack_Handler);
     /* handle the Simple ACK coming back */
     apdu_set_confirmed_simple_ack_handler(
         SERVICE_CONFIRMED_WRITE_PROPERTY, MyWritePropertySimpleAckHandler);
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV, MyWritePropertySimpleAckHandler);
     /* handle any errors coming back */
     apdu_set_error_handler(SERVICE_CONFIRMED_READ_PROPERTY, MyErrorHandler);
+    apdu_set_error_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, MyErrorHandler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_READ_RANGE, MyErrorHandler);
     apdu_set_error_handler(SERVICE_CONFIRMED_WRITE_PROPERTY, MyErrorHandler);
+    apdu_set_error_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV, MyErrorHandler);
+    /* handle the COV notifications of our subscriptions */
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_COV_NOTIFICATION, handler_ucov_notification);
+    handler_ucov_notification_add(&Read_Write_COV_Notification);
     apdu_set_abort_handler(MyAbortHandler);
     apdu_set_reject_handler(MyRejectHandler);
     /* configure the address cache */
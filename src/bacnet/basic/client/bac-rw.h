@@ -12,7 +12,19 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/bacapp.h"
+#include "bacnet/readrange.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/sys/valbuf.h"
+
+/* subscriber process identifier of the SubscribeCOV requests */
+#ifndef BACNET_READ_WRITE_COV_PROCESS_ID
+#define BACNET_READ_WRITE_COV_PROCESS_ID 1
+#endif
+
+/* largest number of array elements read by one request */
+#ifndef BACNET_READ_WRITE_ARRAY_COUNT_MAX
+#define BACNET_READ_WRITE_ARRAY_COUNT_MAX 32
+#endif
 
 /**
  * Save the requested ReadProperty data to a data store
@@ -42,6 +54,34 @@ typedef void (*bacnet_read_write_device_callback_t)(
     int segmentation,
     uint16_t vendor_id);
 
+/**
+ * Report the end of a queued request
+ *
+ * @param device_instance [in] device instance number of the request
+ * @param invoke_id [in] invoke ID of the request, or zero if it was not sent
+ * @param rp_data [in] the object property and array index of the request,
+ *  and its error class and code, or ERROR_CODE_SUCCESS if there was none
+ * @param array_count [in] number of array elements in the request
+ * @param milliseconds [in] time from sending the request until its reply,
+ *  or zero if the request was not sent
+ */
+typedef void (*bacnet_read_write_complete_callback_t)(
+    uint32_t device_instance,
+    uint8_t invoke_id,
+    const BACNET_READ_PROPERTY_DATA *rp_data,
+    uint32_t array_count,
+    unsigned long milliseconds);
+
+/**
+ * Save the items of a ReadRange-ACK to a data store
+ *
+ * @param device_instance [in] device instance number where data originated
+ * @param rr_data [in] the decoded ReadRange-ACK, with the encoded items
+ *  in its application data
+ */
+typedef void (*bacnet_read_write_range_callback_t)(
+    uint32_t device_instance, const BACNET_READ_RANGE_DATA *rr_data);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -62,6 +102,28 @@ bool bacnet_read_property_queue(
     BACNET_PROPERTY_ID object_property,
     uint32_t array_index);
 BACNET_STACK_EXPORT
+bool bacnet_read_property_array_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t array_index,
+    uint32_t array_count);
+BACNET_STACK_EXPORT
+bool bacnet_read_range_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t sequence,
+    uint32_t count);
+BACNET_STACK_EXPORT
+bool bacnet_subscribe_cov_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t lifetime);
+BACNET_STACK_EXPORT
 bool bacnet_write_property_real_queue(
     uint32_t device_id,
     BACNET_OBJECT_TYPE object_type,
@@ -115,12 +177,39 @@ bool bacnet_write_property_boolean_queue(
     uint8_t priority,
     uint32_t array_index);
 BACNET_STACK_EXPORT
+bool bacnet_write_property_value_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    BACNET_VALBUF *value,
+    uint8_t priority,
+    uint32_t array_index);
+BACNET_STACK_EXPORT
 void bacnet_read_write_value_callback_set(
     bacnet_read_write_value_callback_t callback);
 BACNET_STACK_EXPORT
 void bacnet_read_write_device_callback_set(
     bacnet_read_write_device_callback_t callback);
 BACNET_STACK_EXPORT
+void bacnet_read_write_complete_callback_set(
+    bacnet_read_write_complete_callback_t callback);
+BACNET_STACK_EXPORT
+void bacnet_read_write_range_callback_set(
+    bacnet_read_write_range_callback_t callback);
+BACNET_STACK_EXPORT
+void bacnet_read_write_window_set(unsigned window);
+BACNET_STACK_EXPORT
+unsigned bacnet_read_write_window(void);
+BACNET_STACK_EXPORT
+void bacnet_read_write_coalesce_set(bool enable);
+BACNET_STACK_EXPORT
+bool bacnet_read_write_coalesce(void);
+BACNET_STACK_EXPORT
+void bacnet_read_write_device_window_set(unsigned window);
+BACNET_STACK_EXPORT
+unsigned bacnet_read_write_device_window(void);
+BACNET_STACK_EXPORT
 void bacnet_read_write_vendor_id_filter_set(uint16_t vendor_id);
 BACNET_STACK_EXPORT
 uint16_t bacnet_read_write_vendor_id_filter(void);
@@ -18,6 +18,7 @@
 #include "bacnet/apdu.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/trace.h"
 #include "bacnet/datalink/datalink.h"
 
 #if PRINT_ENABLED
@@ -29,6 +30,32 @@ static uint8_t Local_Network_Number_Status = NETWORK_NUMBER_LEARNED;
 
 static i_am_router_to_network_function I_Am_Router_To_Network_Function;
 
+/* number of remote networks whose router is remembered */
+#ifndef NPDU_ROUTE_CACHE_SIZE
+#define NPDU_ROUTE_CACHE_SIZE 16
+#endif
+/* seconds that a learned route is used before it must be learned again */
+#ifndef NPDU_ROUTE_CACHE_TTL
+#define NPDU_ROUTE_CACHE_TTL 3600
+#endif
+/* seconds that a router stays busy when Router-Available is not heard */
+#ifndef NPDU_ROUTE_CACHE_BUSY_TIME
+#define NPDU_ROUTE_CACHE_BUSY_TIME 30
+#endif
+
+/* the router on the local network to a remote network */
+struct npdu_route_entry {
+    /* remote network number, or zero if the entry is not used */
+    uint16_t dnet;
+    /* seconds until the route must be learned again */
+    uint16_t ttl;
+    /* seconds until a busy router is used again, or zero if not busy */
+    uint16_t busy;
+    uint8_t mac_len;
+    uint8_t mac[MAX_MAC_LEN];
+};
+static struct npdu_route_entry Route_Cache[NPDU_ROUTE_CACHE_SIZE];
+
 /**
  * @brief Set a handler function called for the I Am Router To Network message
  *
@@ -126,6 +153,257 @@ int npdu_send_what_is_network_number(BACNET_ADDRESS *dst)
     return datalink_send_pdu(&daddr, &npdu_data, pdu, pdu_len);
 }
 
+/**
+ * @brief Find the route cache entry of a remote network
+ * @param dnet - remote network number
+ * @return the entry, or NULL if the network is not in the cache
+ */
+static struct npdu_route_entry *npdu_route_cache_find(uint16_t dnet)
+{
+    unsigned index;
+
+    for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+        if (Route_Cache[index].dnet == dnet) {
+            return &Route_Cache[index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Determine if an entry routes through a router
+ * @param entry - route cache entry
+ * @param router - local address of the router
+ * @return true if the entry routes through the router
+ */
+static bool npdu_route_cache_router_same(
+    const struct npdu_route_entry *entry, const BACNET_ADDRESS *router)
+{
+    uint8_t i;
+
+    if (entry->mac_len != router->mac_len) {
+        return false;
+    }
+    for (i = 0; i < entry->mac_len; i++) {
+        if (entry->mac[i] != router->mac[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Forget every learned route
+ */
+void npdu_route_cache_init(void)
+{
+    unsigned index;
+
+    for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+        Route_Cache[index].dnet = 0;
+    }
+}
+
+/**
+ * @brief Learn the router on the local network to a remote network, as
+ *  heard in I-Am-Router-To-Network.  When the cache is full, the route
+ *  that is nearest to expiry is replaced.
+ * @param dnet - remote network number
+ * @param router - local address of the router
+ * @return true if the route was added or renewed
+ */
+bool npdu_route_cache_add(uint16_t dnet, const BACNET_ADDRESS *router)
+{
+    struct npdu_route_entry *entry;
+    unsigned index;
+    uint8_t i;
+
+    if (!router || (router->net != 0) || (router->mac_len == 0) ||
+        (router->mac_len > MAX_MAC_LEN) || (dnet == 0) ||
+        (dnet == BACNET_BROADCAST_NETWORK) || (dnet == Local_Network_Number)) {
+        return false;
+    }
+    entry = npdu_route_cache_find(dnet);
+    if (!entry) {
+        entry = &Route_Cache[0];
+        for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+            if (Route_Cache[index].dnet == 0) {
+                entry = &Route_Cache[index];
+                break;
+            }
+            if (Route_Cache[index].ttl < entry->ttl) {
+                entry = &Route_Cache[index];
+            }
+        }
+        entry->dnet = dnet;
+    }
+    entry->ttl = NPDU_ROUTE_CACHE_TTL;
+    entry->busy = 0;
+    entry->mac_len = router->mac_len;
+    for (i = 0; i < router->mac_len; i++) {
+        entry->mac[i] = router->mac[i];
+    }
+    /* from now on, remote traffic is sent to the learned routers */
+    npdu_route_function_set(npdu_route_cache_resolve);
+
+    return true;
+}
+
+/**
+ * @brief Forget the route to a remote network, as when the router
+ *  rejects a message because it has no route to the network
+ * @param dnet - remote network number
+ */
+void npdu_route_cache_remove(uint16_t dnet)
+{
+    struct npdu_route_entry *entry;
+
+    entry = npdu_route_cache_find(dnet);
+    if (entry && dnet) {
+        entry->dnet = 0;
+    }
+}
+
+/**
+ * @brief Mark the routes through a router as busy or available, as heard
+ *  in Router-Busy-To-Network and Router-Available-To-Network.  A busy
+ *  route is not used until the router is available again, or until
+ *  NPDU_ROUTE_CACHE_BUSY_TIME seconds have passed.
+ * @param router - local address of the router
+ * @param dnet - remote network number, or zero for all of the networks
+ *  served by the router
+ * @param busy - true if the router is busy, false if it is available
+ */
+void npdu_route_cache_busy_set(
+    const BACNET_ADDRESS *router, uint16_t dnet, bool busy)
+{
+    struct npdu_route_entry *entry;
+    unsigned index;
+
+    if (!router || (router->net != 0)) {
+        return;
+    }
+    if (dnet) {
+        entry = npdu_route_cache_find(dnet);
+        if (!entry || !npdu_route_cache_router_same(entry, router)) {
+            /* the router announces that it serves the network */
+            if (!npdu_route_cache_add(dnet, router)) {
+                return;
+            }
+            entry = npdu_route_cache_find(dnet);
+        }
+        entry->busy = busy ? NPDU_ROUTE_CACHE_BUSY_TIME : 0;
+        return;
+    }
+    for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+        entry = &Route_Cache[index];
+        if (entry->dnet && npdu_route_cache_router_same(entry, router)) {
+            entry->busy = busy ? NPDU_ROUTE_CACHE_BUSY_TIME : 0;
+        }
+    }
+}
+
+/**
+ * @brief Get the router on the local network to a remote network
+ * @param dnet - remote network number
+ * @param router - local address of the router, filled in if found
+ * @return true if a route is known and the router is not busy
+ */
+bool npdu_route_cache_lookup(uint16_t dnet, BACNET_ADDRESS *router)
+{
+    const struct npdu_route_entry *entry;
+    uint8_t i;
+
+    entry = npdu_route_cache_find(dnet);
+    if (!entry || (dnet == 0) || entry->busy) {
+        return false;
+    }
+    if (router) {
+        bacnet_address_init(router, NULL, 0, NULL);
+        router->mac_len = entry->mac_len;
+        for (i = 0; i < entry->mac_len; i++) {
+            router->mac[i] = entry->mac[i];
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Fill in the MAC address of the router to the remote network
+ *  of a destination, so the message is sent to the router rather than
+ *  broadcast on the local network.  Used by npdu_encode_pdu().
+ * @param dest - destination on a remote network without a MAC address
+ * @return true if the MAC address of the router was filled in
+ */
+bool npdu_route_cache_resolve(BACNET_ADDRESS *dest)
+{
+    BACNET_ADDRESS router;
+    uint8_t i;
+
+    if (!dest || (dest->mac_len != 0) || (dest->net == 0) ||
+        (dest->net == BACNET_BROADCAST_NETWORK)) {
+        return false;
+    }
+    if (!npdu_route_cache_lookup(dest->net, &router)) {
+        return false;
+    }
+    dest->mac_len = router.mac_len;
+    for (i = 0; i < router.mac_len; i++) {
+        dest->mac[i] = router.mac[i];
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the number of remote networks in the route cache
+ * @return number of learned routes
+ */
+unsigned npdu_route_cache_count(void)
+{
+    unsigned index, count = 0;
+
+    for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+        if (Route_Cache[index].dnet) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Age the learned routes.  A route that is not heard again within
+ *  NPDU_ROUTE_CACHE_TTL seconds is forgotten, and remote traffic to its
+ *  network is broadcast again until the route is learned again.
+ * @param seconds - number of seconds since the last call
+ */
+void npdu_route_cache_timer(uint16_t seconds)
+{
+    struct npdu_route_entry *entry;
+    unsigned index;
+
+    for (index = 0; index < NPDU_ROUTE_CACHE_SIZE; index++) {
+        entry = &Route_Cache[index];
+        if (entry->dnet == 0) {
+            continue;
+        }
+        if (entry->busy > seconds) {
+            entry->busy -= seconds;
+        } else {
+            entry->busy = 0;
+        }
+        if (entry->ttl > seconds) {
+            entry->ttl -= seconds;
+        } else {
+            entry->dnet = 0;
+        }
+    }
+}
+
 /** @file h_npdu.c  Handles messages at the NPDU level of the BACnet stack. */
 
 /** Handler to manage the Network Layer Control Messages received in a packet.
@@ -154,6 +432,7 @@ static void network_control_handler(
     uint8_t status = 0;
     uint16_t npdu_offset = 0;
     uint16_t len = 0;
+    bool busy = false;
 
     switch (npdu_data->network_message_type) {
         case NETWORK_MESSAGE_WHAT_IS_NETWORK_NUMBER:
@@ -194,12 +473,41 @@ static void network_control_handler(
             }
             break;
         case NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK:
-            if (I_Am_Router_To_Network_Function) {
-                while (npdu_len >= 2) {
-                    len = decode_unsigned16(&npdu[npdu_offset], &dnet);
+            while (npdu_len >= 2) {
+                len = decode_unsigned16(&npdu[npdu_offset], &dnet);
+                if (src->net == 0) {
+                    /* learn the routers on our own network */
+                    (void)npdu_route_cache_add(dnet, src);
+                }
+                if (I_Am_Router_To_Network_Function) {
                     I_Am_Router_To_Network_Function(src, dnet);
-                    npdu_len -= len;
-                    npdu_offset += len;
+                }
+                npdu_len -= len;
+                npdu_offset += len;
+            }
+            break;
+        case NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK:
+        case NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK:
+            busy = npdu_data->network_message_type ==
+                NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK;
+            if (npdu_len < 2) {
+                /* an empty list means all of the networks of the router */
+                npdu_route_cache_busy_set(src, 0, busy);
+            }
+            while (npdu_len >= 2) {
+                len = decode_unsigned16(&npdu[npdu_offset], &dnet);
+                npdu_route_cache_busy_set(src, dnet, busy);
+                npdu_len -= len;
+                npdu_offset += len;
+            }
+            break;
+        case NETWORK_MESSAGE_REJECT_MESSAGE_TO_NETWORK:
+            if ((src->net == 0) && (npdu_len >= 3)) {
+                (void)decode_unsigned16(&npdu[1], &dnet);
+                if (npdu[0] == NETWORK_REJECT_NO_ROUTE) {
+                    npdu_route_cache_remove(dnet);
+                } else if (npdu[0] == NETWORK_REJECT_ROUTER_BUSY) {
+                    npdu_route_cache_busy_set(src, dnet, true);
                 }
             }
             break;
@@ -246,6 +554,7 @@ void npdu_handler(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
     if (pdu_len < 1) {
         return;
     }
+    BACNET_TRACE1(npdu_entry, pdu_len);
 
     /* only handle the version that we know how to handle */
     if (pdu[0] == BACNET_PROTOCOL_VERSION) {
@@ -294,6 +603,7 @@ void npdu_handler(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
             (unsigned)pdu[0]);
 #endif
     }
+    BACNET_TRACE1(npdu_exit, pdu_len);
 
     return;
 }
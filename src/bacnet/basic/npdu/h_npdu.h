@@ -34,6 +34,24 @@ int npdu_send_network_number_is(
 BACNET_STACK_EXPORT
 int npdu_send_what_is_network_number(BACNET_ADDRESS *dst);
 
+BACNET_STACK_EXPORT
+void npdu_route_cache_init(void);
+BACNET_STACK_EXPORT
+bool npdu_route_cache_add(uint16_t dnet, const BACNET_ADDRESS *router);
+BACNET_STACK_EXPORT
+void npdu_route_cache_remove(uint16_t dnet);
+BACNET_STACK_EXPORT
+void npdu_route_cache_busy_set(
+    const BACNET_ADDRESS *router, uint16_t dnet, bool busy);
+BACNET_STACK_EXPORT
+bool npdu_route_cache_lookup(uint16_t dnet, BACNET_ADDRESS *router);
+BACNET_STACK_EXPORT
+bool npdu_route_cache_resolve(BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+unsigned npdu_route_cache_count(void);
+BACNET_STACK_EXPORT
+void npdu_route_cache_timer(uint16_t seconds);
+
 BACNET_STACK_EXPORT
 void npdu_handler_cleanup(void);
 BACNET_STACK_EXPORT
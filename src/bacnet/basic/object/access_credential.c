@@ -23,6 +23,14 @@ static bool Access_Credential_Initialized = false;
 
 static ACCESS_CREDENTIAL_DESCR ac_descr[MAX_ACCESS_CREDENTIALS];
 
+/* Authentication factor index: every factor slot of every credential,
+   chained from a hash bucket of its format and value, so that a presented
+   factor is found with one lookup instead of a scan of all credentials */
+#define FACTOR_SLOTS (MAX_ACCESS_CREDENTIALS * MAX_AUTHENTICATION_FACTORS)
+#define FACTOR_SLOT_NONE UINT32_MAX
+static uint32_t Factor_Bucket[ACCESS_CREDENTIAL_FACTOR_BUCKETS];
+static uint32_t Factor_Next[FACTOR_SLOTS];
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Properties_Required[] = {
     /* unordered list of required properties */
@@ -83,6 +91,9 @@ void Access_Credential_Init(void)
             ac_descr[i].credential_disable = ACCESS_CREDENTIAL_DISABLE_NONE;
             ac_descr[i].assigned_access_rights_count = 0;
         }
+        for (i = 0; i < ACCESS_CREDENTIAL_FACTOR_BUCKETS; i++) {
+            Factor_Bucket[i] = FACTOR_SLOT_NONE;
+        }
     }
 
     return;
@@ -146,6 +157,194 @@ bool Access_Credential_Object_Name(
     return status;
 }
 
+/**
+ * @brief Hash the format and value of an authentication factor
+ * @param af [in] authentication factor
+ * @return hash bucket of the authentication factor
+ */
+static unsigned Authentication_Factor_Bucket(
+    const BACNET_AUTHENTICATION_FACTOR *af)
+{
+    uint32_t hash = 2166136261UL;
+    size_t i;
+
+    hash = (hash ^ (uint32_t)af->format_type) * 16777619UL;
+    hash = (hash ^ af->format_class) * 16777619UL;
+    for (i = 0; i < af->value.length; i++) {
+        hash = (hash ^ af->value.value[i]) * 16777619UL;
+    }
+
+    return hash % ACCESS_CREDENTIAL_FACTOR_BUCKETS;
+}
+
+/**
+ * @brief Compare the format and value of two authentication factors
+ * @param af1 [in] authentication factor
+ * @param af2 [in] authentication factor
+ * @return true if both factors have the same format and value
+ */
+static bool Authentication_Factor_Same(
+    const BACNET_AUTHENTICATION_FACTOR *af1,
+    const BACNET_AUTHENTICATION_FACTOR *af2)
+{
+    return (af1->format_type == af2->format_type) &&
+        (af1->format_class == af2->format_class) &&
+        octetstring_value_same(&af1->value, &af2->value);
+}
+
+/**
+ * @brief Add a factor slot of a credential to the authentication factor index
+ * @param object_index [in] credential index
+ * @param index [in] authentication factor array index
+ */
+static void Factor_Index_Insert(unsigned object_index, unsigned index)
+{
+    uint32_t slot = (object_index * MAX_AUTHENTICATION_FACTORS) + index;
+    unsigned bucket;
+
+    bucket = Authentication_Factor_Bucket(
+        &ac_descr[object_index].auth_factors[index].authentication_factor);
+    Factor_Next[slot] = Factor_Bucket[bucket];
+    Factor_Bucket[bucket] = slot;
+}
+
+/**
+ * @brief Remove a factor slot of a credential from the authentication
+ *  factor index
+ * @param object_index [in] credential index
+ * @param index [in] authentication factor array index
+ */
+static void Factor_Index_Remove(unsigned object_index, unsigned index)
+{
+    uint32_t slot = (object_index * MAX_AUTHENTICATION_FACTORS) + index;
+    uint32_t *link;
+
+    link = &Factor_Bucket[Authentication_Factor_Bucket(
+        &ac_descr[object_index].auth_factors[index].authentication_factor)];
+    while (*link != FACTOR_SLOT_NONE) {
+        if (*link == slot) {
+            *link = Factor_Next[slot];
+            break;
+        }
+        link = &Factor_Next[*link];
+    }
+}
+
+/**
+ * @brief Set an element of the Authentication_Factors array, and keep
+ *  the authentication factor index current
+ * @param object_instance [in] BACnet object instance number
+ * @param index [in] array index 0..N-1 to replace, or N to append
+ * @param factor [in] credential authentication factor
+ * @return true if the element was set
+ */
+bool Access_Credential_Authentication_Factor_Set(
+    uint32_t object_instance,
+    unsigned index,
+    const BACNET_CREDENTIAL_AUTHENTICATION_FACTOR *factor)
+{
+    ACCESS_CREDENTIAL_DESCR *pObject;
+    unsigned object_index;
+
+    object_index = Access_Credential_Instance_To_Index(object_instance);
+    if ((object_index >= MAX_ACCESS_CREDENTIALS) || !factor ||
+        !Access_Credential_Initialized) {
+        return false;
+    }
+    pObject = &ac_descr[object_index];
+    if ((index > pObject->auth_factors_count) ||
+        (index >= MAX_AUTHENTICATION_FACTORS)) {
+        return false;
+    }
+    if (index < pObject->auth_factors_count) {
+        Factor_Index_Remove(object_index, index);
+    } else {
+        pObject->auth_factors_count++;
+    }
+    pObject->auth_factors[index] = *factor;
+    Factor_Index_Insert(object_index, index);
+
+    return true;
+}
+
+/**
+ * @brief Remove an element of the Authentication_Factors array, and keep
+ *  the authentication factor index current
+ * @param object_instance [in] BACnet object instance number
+ * @param index [in] array index 0..N-1 to remove
+ * @return true if the element was removed
+ */
+bool Access_Credential_Authentication_Factor_Remove(
+    uint32_t object_instance, unsigned index)
+{
+    ACCESS_CREDENTIAL_DESCR *pObject;
+    unsigned object_index;
+    unsigned i;
+
+    object_index = Access_Credential_Instance_To_Index(object_instance);
+    if ((object_index >= MAX_ACCESS_CREDENTIALS) ||
+        !Access_Credential_Initialized) {
+        return false;
+    }
+    pObject = &ac_descr[object_index];
+    if (index >= pObject->auth_factors_count) {
+        return false;
+    }
+    /* the later elements move down a slot */
+    for (i = index; i < pObject->auth_factors_count; i++) {
+        Factor_Index_Remove(object_index, i);
+    }
+    pObject->auth_factors_count--;
+    for (i = index; i < pObject->auth_factors_count; i++) {
+        pObject->auth_factors[i] = pObject->auth_factors[i + 1];
+        Factor_Index_Insert(object_index, i);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Find the credential that holds a presented authentication factor
+ * @param af [in] authentication factor presented at an access point
+ * @param object_instance [out] BACnet object instance number of the
+ *  credential, or NULL
+ * @param index [out] Authentication_Factors array index 0..N-1 that holds
+ *  the factor, whose disable field is left to the caller, or NULL
+ * @return true if a credential holds the authentication factor
+ */
+bool Access_Credential_Authentication_Factor_Find(
+    const BACNET_AUTHENTICATION_FACTOR *af,
+    uint32_t *object_instance,
+    unsigned *index)
+{
+    const BACNET_CREDENTIAL_AUTHENTICATION_FACTOR *factor;
+    uint32_t slot;
+    unsigned object_index, factor_index;
+
+    if (!af || !Access_Credential_Initialized) {
+        return false;
+    }
+    slot = Factor_Bucket[Authentication_Factor_Bucket(af)];
+    while (slot != FACTOR_SLOT_NONE) {
+        object_index = slot / MAX_AUTHENTICATION_FACTORS;
+        factor_index = slot % MAX_AUTHENTICATION_FACTORS;
+        factor = &ac_descr[object_index].auth_factors[factor_index];
+        if (Authentication_Factor_Same(af, &factor->authentication_factor)) {
+            if (object_instance) {
+                *object_instance =
+                    Access_Credential_Index_To_Instance(object_index);
+            }
+            if (index) {
+                *index = factor_index;
+            }
+            return true;
+        }
+        slot = Factor_Next[slot];
+    }
+
+    return false;
+}
+
 /**
  * @brief Encode a BACnetARRAY property element
  * @param object_instance [in] BACnet network port object instance number
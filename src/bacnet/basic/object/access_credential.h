@@ -37,6 +37,12 @@
 #define MAX_ASSIGNED_ACCESS_RIGHTS 4
 #endif
 
+/* number of hash buckets of the authentication factor index */
+#ifndef ACCESS_CREDENTIAL_FACTOR_BUCKETS
+#define ACCESS_CREDENTIAL_FACTOR_BUCKETS \
+    (MAX_ACCESS_CREDENTIALS * MAX_AUTHENTICATION_FACTORS)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -80,6 +86,20 @@ bool Access_Credential_Object_Name(
 BACNET_STACK_EXPORT
 bool Access_Credential_Name_Set(uint32_t object_instance, char *new_name);
 
+BACNET_STACK_EXPORT
+bool Access_Credential_Authentication_Factor_Set(
+    uint32_t object_instance,
+    unsigned index,
+    const BACNET_CREDENTIAL_AUTHENTICATION_FACTOR *factor);
+BACNET_STACK_EXPORT
+bool Access_Credential_Authentication_Factor_Remove(
+    uint32_t object_instance, unsigned index);
+BACNET_STACK_EXPORT
+bool Access_Credential_Authentication_Factor_Find(
+    const BACNET_AUTHENTICATION_FACTOR *af,
+    uint32_t *object_instance,
+    unsigned *index);
+
 BACNET_STACK_EXPORT
 int Access_Credential_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
 BACNET_STACK_EXPORT
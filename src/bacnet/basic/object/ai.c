@@ -21,14 +21,29 @@
 #include "bacnet/timestamp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
 #include "bacnet/basic/sys/debug.h"
 /* me! */
 #include "bacnet/basic/object/ai.h"
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+#define OBJECT_PRESENT_VALUE(o) (Dense_Values.Present_Value[(o)->Dense_Slot])
+#define OBJECT_PRIOR_VALUE(o) (Dense_Values.Prior_Value[(o)->Dense_Slot])
+#define OBJECT_COV_INCREMENT(o) (Dense_Values.COV_Increment[(o)->Dense_Slot])
+#else
+#define OBJECT_PRESENT_VALUE(o) ((o)->Present_Value)
+#define OBJECT_PRIOR_VALUE(o) ((o)->Prior_Value)
+#define OBJECT_COV_INCREMENT(o) ((o)->COV_Increment)
+#endif
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_INPUT;
+/* callback for change-of-value conditions */
+static cov_object_changed_callback Analog_Input_Change_Of_Value_Callback;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Properties_Required[] = {
@@ -98,7 +113,73 @@ static struct analog_input_descr *Analog_Input_Object(uint32_t object_instance)
     return Keylist_Data(Object_List, object_instance);
 }
 
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Analog_Input_Changed(const struct analog_input_descr *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Changed;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void
+Analog_Input_Changed_Set(struct analog_input_descr *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Changed = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Analog_Input_Object_Free(struct analog_input_descr *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+}
+
 #if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Updates the active event set of the GetEventInformation
+ *  and GetAlarmSummary services after an event state change or
+ *  an acknowledgment
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object to check for an active event
+ */
+static void Analog_Input_Event_Active_Update(
+    uint32_t object_instance, const struct analog_input_descr *pObject)
+{
+    handler_get_event_information_active_set(
+        Object_Type, object_instance,
+        (pObject->Event_State != EVENT_STATE_NORMAL) ||
+            !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+}
+
 /**
  * @brief Gets an object from the list using its index in the list
  * @param index - index of the object in the list
@@ -175,12 +256,26 @@ float Analog_Input_Present_Value(uint32_t object_instance)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        value = pObject->Present_Value;
+        value = OBJECT_PRESENT_VALUE(pObject);
     }
 
     return value;
 }
 
+/**
+ * @brief Sets the COV flag and reports the change to the COV callback
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Analog_Input_Change_Of_Value_Set(
+    struct analog_input_descr *pObject, uint32_t object_instance)
+{
+    Analog_Input_Changed_Set(pObject, true);
+    if (Analog_Input_Change_Of_Value_Callback) {
+        Analog_Input_Change_Of_Value_Callback(Object_Type, object_instance);
+    }
+}
+
 /**
  * This function is used to detect a value change,
  * using the new value compared against the prior
@@ -188,27 +283,28 @@ float Analog_Input_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
- * @param index  Object index
+ * @param pObject  Object data
+ * @param object_instance  Object instance number
  * @param value  Given present value.
  */
-static void
-Analog_Input_COV_Detect(struct analog_input_descr *pObject, float value)
+static void Analog_Input_COV_Detect(
+    struct analog_input_descr *pObject, uint32_t object_instance, float value)
 {
     float prior_value = 0.0f;
     float cov_increment = 0.0f;
     float cov_delta = 0.0f;
 
     if (pObject) {
-        prior_value = pObject->Prior_Value;
-        cov_increment = pObject->COV_Increment;
+        prior_value = OBJECT_PRIOR_VALUE(pObject);
+        cov_increment = OBJECT_COV_INCREMENT(pObject);
         if (prior_value > value) {
             cov_delta = prior_value - value;
         } else {
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
-            pObject->Prior_Value = value;
+            Analog_Input_Change_Of_Value_Set(pObject, object_instance);
+            OBJECT_PRIOR_VALUE(pObject) = value;
         }
     }
 }
@@ -226,8 +322,8 @@ void Analog_Input_Present_Value_Set(uint32_t object_instance, float value)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        Analog_Input_COV_Detect(pObject, value);
-        pObject->Present_Value = value;
+        Analog_Input_COV_Detect(pObject, object_instance, value);
+        OBJECT_PRESENT_VALUE(pObject) = value;
     }
 }
 
@@ -522,6 +618,7 @@ bool Analog_Input_Event_Detection_Enable_Set(
             Event_Message_Texts shall be equal to their respective initial
             conditions.*/
             Analog_Input_Reset_Event_Properties(pObject);
+            Analog_Input_Event_Active_Update(object_instance, pObject);
         }
         retval = true;
     }
@@ -623,7 +720,7 @@ bool Analog_Input_Reliability_Set(
         fault = Analog_Input_Object_Fault(pObject);
         pObject->Reliability = value;
         if (fault != Analog_Input_Object_Fault(pObject)) {
-            pObject->Changed = true;
+            Analog_Input_Change_Of_Value_Set(pObject, object_instance);
         }
         status = true;
     }
@@ -657,7 +754,7 @@ bool Analog_Input_Change_Of_Value(uint32_t object_instance)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        changed = pObject->Changed;
+        changed = Analog_Input_Changed(pObject);
     }
 
     return changed;
@@ -673,10 +770,20 @@ void Analog_Input_Change_Of_Value_Clear(uint32_t object_instance)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        pObject->Changed = false;
+        Analog_Input_Changed_Set(pObject, false);
     }
 }
 
+/**
+ * @brief Sets a callback used when the change-of-value condition trips
+ * @param cb - callback used to report the changed object, such as
+ *  handler_cov_object_changed()
+ */
+void Analog_Input_Change_Of_Value_Callback_Set(cov_object_changed_callback cb)
+{
+    Analog_Input_Change_Of_Value_Callback = cb;
+}
+
 /**
  * For a given object instance-number, loads the value_list with the COV data.
  *
@@ -705,7 +812,7 @@ bool Analog_Input_Encode_Value_List(
             fault = true;
         }
         out_of_service = pObject->Out_Of_Service;
-        present_value = pObject->Present_Value;
+        present_value = OBJECT_PRESENT_VALUE(pObject);
         status = cov_value_list_encode_real(
             value_list, present_value, in_alarm, fault, overridden,
             out_of_service);
@@ -726,7 +833,7 @@ float Analog_Input_COV_Increment(uint32_t object_instance)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        value = pObject->COV_Increment;
+        value = OBJECT_COV_INCREMENT(pObject);
     }
 
     return value;
@@ -743,8 +850,9 @@ void Analog_Input_COV_Increment_Set(uint32_t object_instance, float value)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        pObject->COV_Increment = value;
-        Analog_Input_COV_Detect(pObject, pObject->Present_Value);
+        OBJECT_COV_INCREMENT(pObject) = value;
+        Analog_Input_COV_Detect(
+            pObject, object_instance, OBJECT_PRESENT_VALUE(pObject));
     }
 }
 
@@ -824,7 +932,7 @@ void Analog_Input_Out_Of_Service_Set(uint32_t object_instance, bool value)
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Changed = true;
+            Analog_Input_Change_Of_Value_Set(pObject, object_instance);
         }
         pObject->Out_Of_Service = value;
     }
@@ -1042,7 +1150,8 @@ int Analog_Input_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
         case PROP_COV_INCREMENT:
             apdu_len =
-                encode_application_real(&apdu[0], pObject->COV_Increment);
+                encode_application_real(
+                    &apdu[0], OBJECT_COV_INCREMENT(pObject));
             break;
 #if defined(INTRINSIC_REPORTING)
         case PROP_TIME_DELAY:
@@ -1387,7 +1496,7 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
         /* Send EventNotification. */
         SendNotify = true;
     } else {
-        PresentVal = CurrentAI->Present_Value;
+        PresentVal = OBJECT_PRESENT_VALUE(CurrentAI);
         FromState = CurrentAI->Event_State;
         Reliability = CurrentAI->Reliability;
         if (Reliability != RELIABILITY_NO_FAULT_DETECTED) {
@@ -1758,6 +1867,7 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    Analog_Input_Event_Active_Update(object_instance, CurrentAI);
 #else
     (void)object_instance;
 #endif /* defined(INTRINSIC_REPORTING) */
@@ -1951,6 +2061,9 @@ int Analog_Input_Alarm_Ack(
     CurrentAI->Ack_notify_data.bSendAckNotify = true;
     CurrentAI->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
+    Analog_Input_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, CurrentAI);
+
     return 1;
 }
 
@@ -2057,17 +2170,25 @@ uint32_t Analog_Input_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct analog_input_descr));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct analog_input_descr));
         if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+            pObject->Dense_Slot =
+                dense_value_slot_alloc(&Dense_Values, object_instance);
+            if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+                return BACNET_MAX_INSTANCE;
+            }
+#endif
             pObject->Object_Name = NULL;
             pObject->Description = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
-            pObject->COV_Increment = 1.0;
-            pObject->Present_Value = 0.0f;
-            pObject->Prior_Value = 0.0;
+            OBJECT_COV_INCREMENT(pObject) = 1.0;
+            OBJECT_PRESENT_VALUE(pObject) = 0.0f;
+            OBJECT_PRIOR_VALUE(pObject) = 0.0;
             pObject->Units = UNITS_PERCENT;
             pObject->Out_Of_Service = false;
-            pObject->Changed = false;
+            Analog_Input_Changed_Set(pObject, false);
             pObject->Event_State = EVENT_STATE_NORMAL;
 #if defined(INTRINSIC_REPORTING)
             pObject->Event_Detection_Enable = true;
@@ -2079,7 +2200,7 @@ uint32_t Analog_Input_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Analog_Input_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -2102,7 +2223,11 @@ bool Analog_Input_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+#if defined(INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
+        Analog_Input_Object_Free(pObject);
         status = true;
     }
 
@@ -2120,12 +2245,74 @@ void Analog_Input_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Analog_Input_Object_Free(pObject);
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
+}
+
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Analog Input values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Analog Input objects
+ */
+const DENSE_VALUE_TABLE *Analog_Input_Dense_Values(void)
+{
+    return &Dense_Values;
+}
+
+/**
+ * @brief Evaluates the COV increment of every Analog Input at once
+ *  and flags the objects whose change-of-value condition tripped.
+ * @param bitmap - filled with one bit per dense slot, set when the COV flag
+ *  of the object in that slot is set
+ * @param bitmap_words - number of 32-bit words in the bitmap
+ * @param instances - set to the column that maps each slot to its
+ *  object instance
+ * @return number of slots - when larger than bitmap_words * 32, the bitmap
+ *  was too small and the remaining slots were not evaluated
+ */
+unsigned Analog_Input_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances)
+{
+    if (instances) {
+        *instances = Dense_Values.Instance;
+    }
+
+    return dense_value_cov_evaluate(&Dense_Values, bitmap, bitmap_words);
+}
+#endif
+
+/**
+ * @brief Add the memory used by the Analog Input objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Analog_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct analog_input_descr);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Analog Input objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Analog_Input_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
 }
 
 /**
@@ -2140,6 +2327,8 @@ void Analog_Input_Init(void)
     /* Set handler for GetEventInformation function */
     handler_get_event_information_set(
         Object_Type, Analog_Input_Event_Information);
+    handler_get_event_information_index_set(
+        Object_Type, Analog_Input_Instance_To_Index);
     /* Set handler for AcknowledgeAlarm function */
     handler_alarm_ack_set(Object_Type, Analog_Input_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
@@ -14,8 +14,11 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 #if defined(INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
 #include "bacnet/getevent.h"
@@ -25,13 +28,19 @@
 
 typedef struct analog_input_descr {
     unsigned Event_State : 3;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the Present_Value, Prior_Value, COV_Increment and
+       change-of-value flag in the dense value table */
+    uint32_t Dense_Slot;
+#else
     float Present_Value;
-    BACNET_RELIABILITY Reliability;
-    bool Out_Of_Service;
-    uint16_t Units;
     float Prior_Value;
     float COV_Increment;
     bool Changed;
+#endif
+    BACNET_RELIABILITY Reliability;
+    bool Out_Of_Service;
+    uint16_t Units;
     const char *Object_Name;
     const char *Description;
     void *Context;
@@ -131,6 +140,8 @@ bool Analog_Input_Change_Of_Value(uint32_t instance);
 BACNET_STACK_EXPORT
 void Analog_Input_Change_Of_Value_Clear(uint32_t instance);
 BACNET_STACK_EXPORT
+void Analog_Input_Change_Of_Value_Callback_Set(cov_object_changed_callback cb);
+BACNET_STACK_EXPORT
 bool Analog_Input_Encode_Value_List(
     uint32_t object_instance, BACNET_PROPERTY_VALUE *value_list);
 float Analog_Input_COV_Increment(uint32_t instance);
@@ -226,8 +237,19 @@ BACNET_STACK_EXPORT
 bool Analog_Input_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Analog_Input_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Analog_Input_Dense_Values(void);
+BACNET_STACK_EXPORT
+unsigned Analog_Input_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances);
+#endif
 BACNET_STACK_EXPORT
 void Analog_Input_Init(void);
+BACNET_STACK_EXPORT
+void Analog_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Analog_Input_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -28,16 +28,27 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/priority_array.h"
 /* me! */
 #include "ao.h"
 
 struct object_data {
     bool Out_Of_Service : 1;
     bool Overridden : 1;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the Prior_Value, COV_Increment and change-of-value flag
+       in the dense value table */
+    uint32_t Dense_Slot;
+#else
     bool Changed : 1;
     float COV_Increment;
     float Prior_Value;
-    bool Relinquished[BACNET_MAX_PRIORITY];
+#endif
+    /* active priority 1..16 of the present-value, or 0 if relinquished */
+    uint8_t Present_Value_Priority;
+    uint16_t Priority_Active_Bits;
     float Priority_Array[BACNET_MAX_PRIORITY];
     float Relinquish_Default;
     float Min_Pres_Value;
@@ -50,6 +61,62 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+#define OBJECT_PRIOR_VALUE(o) (Dense_Values.Prior_Value[(o)->Dense_Slot])
+#define OBJECT_COV_INCREMENT(o) (Dense_Values.COV_Increment[(o)->Dense_Slot])
+#else
+#define OBJECT_PRIOR_VALUE(o) ((o)->Prior_Value)
+#define OBJECT_COV_INCREMENT(o) ((o)->COV_Increment)
+#endif
+
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Analog_Output_Changed(const struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Changed;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void Analog_Output_Changed_Set(struct object_data *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Changed = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Analog_Output_Object_Free(struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+}
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_OUTPUT;
 /* callback for present value writes */
@@ -165,6 +232,21 @@ unsigned Analog_Output_Instance_To_Index(uint32_t object_instance)
     return Keylist_Index(Object_List, object_instance);
 }
 
+/**
+ * @brief Calculated the present-value property from the cached active
+ *  priority of the priority array.
+ * @param pObject - pointer to the object data
+ * @return The present-value of the object
+ */
+static float Object_Present_Value(const struct object_data *pObject)
+{
+    if (pObject->Present_Value_Priority) {
+        return pObject->Priority_Array[pObject->Present_Value_Priority - 1];
+    }
+
+    return pObject->Relinquish_Default;
+}
+
 /**
  * @brief For a given object instance-number, determines the present-value
  * @param  object_instance - object-instance number of the object
@@ -173,18 +255,11 @@ unsigned Analog_Output_Instance_To_Index(uint32_t object_instance)
 float Analog_Output_Present_Value(uint32_t object_instance)
 {
     float value = 0.0;
-    uint8_t priority = 0; /* loop counter */
     struct object_data *pObject;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        value = Analog_Output_Relinquish_Default(object_instance);
-        for (priority = 0; priority < BACNET_MAX_PRIORITY; priority++) {
-            if (!pObject->Relinquished[priority]) {
-                value = pObject->Priority_Array[priority];
-                break;
-            }
-        }
+        value = Object_Present_Value(pObject);
     }
 
     return value;
@@ -197,18 +272,12 @@ float Analog_Output_Present_Value(uint32_t object_instance)
  */
 unsigned Analog_Output_Present_Value_Priority(uint32_t object_instance)
 {
-    unsigned p = 0; /* loop counter */
     unsigned priority = 0; /* return value */
     struct object_data *pObject;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        for (p = 0; p < BACNET_MAX_PRIORITY; p++) {
-            if (!pObject->Relinquished[p]) {
-                priority = p + 1;
-                break;
-            }
-        }
+        priority = pObject->Present_Value_Priority;
     }
 
     return priority;
@@ -233,7 +302,7 @@ static int Analog_Output_Priority_Array_Encode(
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && (index < BACNET_MAX_PRIORITY)) {
-        if (pObject->Relinquished[index]) {
+        if (!BIT_CHECK(pObject->Priority_Active_Bits, index)) {
             apdu_len = encode_application_null(apdu);
         } else {
             real_value = pObject->Priority_Array[index];
@@ -300,16 +369,20 @@ Analog_Output_Present_Value_COV_Detect(struct object_data *pObject, float value)
     float cov_delta = 0.0;
 
     if (pObject) {
-        prior_value = pObject->Prior_Value;
-        cov_increment = pObject->COV_Increment;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+        /* keep the column current for the bulk evaluation */
+        Dense_Values.Present_Value[pObject->Dense_Slot] = value;
+#endif
+        prior_value = OBJECT_PRIOR_VALUE(pObject);
+        cov_increment = OBJECT_COV_INCREMENT(pObject);
         if (prior_value > value) {
             cov_delta = prior_value - value;
         } else {
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
-            pObject->Prior_Value = value;
+            Analog_Output_Changed_Set(pObject, true);
+            OBJECT_PRIOR_VALUE(pObject) = value;
         }
     }
 }
@@ -333,10 +406,14 @@ bool Analog_Output_Present_Value_Set(
         if ((priority >= 1) && (priority <= BACNET_MAX_PRIORITY) &&
             (value >= pObject->Min_Pres_Value) &&
             (value <= pObject->Max_Pres_Value)) {
-            pObject->Relinquished[priority - 1] = false;
+            BIT_SET(pObject->Priority_Active_Bits, priority - 1);
             pObject->Priority_Array[priority - 1] = value;
+            if ((pObject->Present_Value_Priority == 0) ||
+                (priority < pObject->Present_Value_Priority)) {
+                pObject->Present_Value_Priority = (uint8_t)priority;
+            }
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                pObject, Object_Present_Value(pObject));
             status = true;
         }
     }
@@ -359,10 +436,14 @@ bool Analog_Output_Present_Value_Relinquish(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         if ((priority >= 1) && (priority <= BACNET_MAX_PRIORITY)) {
-            pObject->Relinquished[priority - 1] = true;
+            BIT_CLEAR(pObject->Priority_Active_Bits, priority - 1);
             pObject->Priority_Array[priority - 1] = 0.0;
+            if (priority == pObject->Present_Value_Priority) {
+                pObject->Present_Value_Priority = Priority_Active_Next(
+                    pObject->Priority_Active_Bits, priority + 1);
+            }
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                pObject, Object_Present_Value(pObject));
             status = true;
         }
     }
@@ -384,7 +465,7 @@ bool Analog_Output_Priority_Array_Relinquished(
 
     pObject = Keylist_Data(Object_List, object_instance);
     if ((priority >= 1) && (priority <= BACNET_MAX_PRIORITY)) {
-        if (pObject->Relinquished[priority - 1]) {
+        if (!BIT_CHECK(pObject->Priority_Active_Bits, priority - 1)) {
             status = true;
         }
     }
@@ -413,8 +494,8 @@ float Analog_Output_Priority_Array_Value(
 }
 
 /**
- * @brief For a given object instance-number, writes the present-value to the
- * remote node
+ * @brief For a given object instance-number, writes the present-value
+ *  as a WriteProperty request would, and calls the write callback
  * @param  object_instance - object-instance number of the object
  * @param  value - floating point analog value
  * @param  priority - priority-array index value 1..16
@@ -422,7 +503,7 @@ float Analog_Output_Priority_Array_Value(
  * @param  error_code - BACnet Error code
  * @return  true if values are within range and present-value is set.
  */
-static bool Analog_Output_Present_Value_Write(
+bool Analog_Output_Present_Value_Write(
     uint32_t object_instance,
     float value,
     uint8_t priority,
@@ -678,7 +759,7 @@ void Analog_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
-            pObject->Changed = true;
+            Analog_Output_Changed_Set(pObject, true);
         }
     }
 }
@@ -716,7 +797,7 @@ void Analog_Output_Overridden_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Overridden != value) {
             pObject->Overridden = value;
-            pObject->Changed = true;
+            Analog_Output_Changed_Set(pObject, true);
         }
     }
 }
@@ -776,7 +857,7 @@ bool Analog_Output_Reliability_Set(
             fault = Analog_Output_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Analog_Output_Object_Fault(pObject)) {
-                pObject->Changed = true;
+                Analog_Output_Changed_Set(pObject, true);
             }
             status = true;
         }
@@ -927,7 +1008,7 @@ bool Analog_Output_Change_Of_Value(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        changed = pObject->Changed;
+        changed = Analog_Output_Changed(pObject);
     }
 
     return changed;
@@ -943,7 +1024,7 @@ void Analog_Output_Change_Of_Value_Clear(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        pObject->Changed = false;
+        Analog_Output_Changed_Set(pObject, false);
     }
 }
 
@@ -968,7 +1049,8 @@ bool Analog_Output_Encode_Value_List(
             fault = true;
         }
         status = cov_value_list_encode_real(
-            value_list, pObject->Prior_Value, in_alarm, fault, overridden,
+            value_list, OBJECT_PRIOR_VALUE(pObject), in_alarm, fault,
+            overridden,
             pObject->Out_Of_Service);
     }
 
@@ -987,7 +1069,7 @@ float Analog_Output_COV_Increment(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        value = pObject->COV_Increment;
+        value = OBJECT_COV_INCREMENT(pObject);
     }
 
     return value;
@@ -1005,7 +1087,7 @@ void Analog_Output_COV_Increment_Set(uint32_t object_instance, float value)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        pObject->COV_Increment = value;
+        OBJECT_COV_INCREMENT(pObject) = value;
     }
 }
 
@@ -1141,6 +1223,59 @@ int Analog_Output_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
     return apdu_len;
 }
 
+/**
+ * @brief WriteProperty of a primitive value, which skips the decode of
+ *  Analog_Output_Write_Property() for the properties that setpoint writes
+ *  use
+ * @param  wp_data - BACNET_WRITE_PROPERTY_DATA data, including
+ * requested data and space for the reply, or error response.
+ * @param  value - primitive value of the request
+ * @return 1 if written, BACNET_STATUS_ERROR if an error is loaded, or 0 to
+ *  use Analog_Output_Write_Property()
+ */
+int Analog_Output_Write_Property_Typed(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value)
+{
+    bool status = false;
+
+    switch (wp_data->object_property) {
+        case PROP_PRESENT_VALUE:
+            if (value->tag != BACNET_APPLICATION_TAG_REAL) {
+                return 0;
+            }
+            status = Analog_Output_Present_Value_Write(
+                wp_data->object_instance, value->type.Real, wp_data->priority,
+                &wp_data->error_class, &wp_data->error_code);
+            break;
+        case PROP_OUT_OF_SERVICE:
+            if (value->tag != BACNET_APPLICATION_TAG_BOOLEAN) {
+                return 0;
+            }
+            Analog_Output_Out_Of_Service_Set(
+                wp_data->object_instance, value->type.Boolean);
+            status = true;
+            break;
+        case PROP_COV_INCREMENT:
+            if (value->tag != BACNET_APPLICATION_TAG_REAL) {
+                return 0;
+            }
+            if (value->type.Real >= 0.0f) {
+                Analog_Output_COV_Increment_Set(
+                    wp_data->object_instance, value->type.Real);
+                status = true;
+            } else {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        default:
+            return 0;
+    }
+
+    return status ? 1 : BACNET_STATUS_ERROR;
+}
+
 /**
  * @brief WriteProperty handler for this object.  For the given WriteProperty
  * data, the application_data is loaded or the error flags are set.
@@ -1319,27 +1454,36 @@ uint32_t Analog_Output_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+            pObject->Dense_Slot =
+                dense_value_slot_alloc(&Dense_Values, object_instance);
+            if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+                return BACNET_MAX_INSTANCE;
+            }
+#endif
             pObject->Object_Name = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
             pObject->Overridden = false;
+            pObject->Priority_Active_Bits = 0;
+            pObject->Present_Value_Priority = 0;
             for (priority = 0; priority < BACNET_MAX_PRIORITY; priority++) {
-                pObject->Relinquished[priority] = true;
                 pObject->Priority_Array[priority] = 0.0;
             }
             pObject->Relinquish_Default = 0.0;
-            pObject->COV_Increment = 1.0;
-            pObject->Prior_Value = 0.0;
+            OBJECT_COV_INCREMENT(pObject) = 1.0;
+            OBJECT_PRIOR_VALUE(pObject) = 0.0;
             pObject->Units = UNITS_NO_UNITS;
             pObject->Out_Of_Service = false;
-            pObject->Changed = false;
+            Analog_Output_Changed_Set(pObject, false);
             pObject->Min_Pres_Value = 0;
             pObject->Max_Pres_Value = 100;
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Analog_Output_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1362,7 +1506,7 @@ bool Analog_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        Analog_Output_Object_Free(pObject);
         status = true;
     }
 
@@ -1380,12 +1524,74 @@ void Analog_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Analog_Output_Object_Free(pObject);
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
+}
+
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Analog Output values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Analog Output objects
+ */
+const DENSE_VALUE_TABLE *Analog_Output_Dense_Values(void)
+{
+    return &Dense_Values;
+}
+
+/**
+ * @brief Evaluates the COV increment of every Analog Output at once
+ *  and flags the objects whose change-of-value condition tripped.
+ * @param bitmap - filled with one bit per dense slot, set when the COV flag
+ *  of the object in that slot is set
+ * @param bitmap_words - number of 32-bit words in the bitmap
+ * @param instances - set to the column that maps each slot to its
+ *  object instance
+ * @return number of slots - when larger than bitmap_words * 32, the bitmap
+ *  was too small and the remaining slots were not evaluated
+ */
+unsigned Analog_Output_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances)
+{
+    if (instances) {
+        *instances = Dense_Values.Instance;
+    }
+
+    return dense_value_cov_evaluate(&Dense_Values, bitmap, bitmap_words);
+}
+#endif
+
+/**
+ * @brief Add the memory used by the Analog Output objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Analog_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Analog Output objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Analog_Output_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
 }
 
 /**
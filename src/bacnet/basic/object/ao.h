@@ -17,6 +17,8 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -53,6 +55,13 @@ BACNET_STACK_EXPORT
 bool Analog_Output_Present_Value_Set(
     uint32_t object_instance, float value, unsigned priority);
 BACNET_STACK_EXPORT
+bool Analog_Output_Present_Value_Write(
+    uint32_t object_instance,
+    float value,
+    uint8_t priority,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code);
+BACNET_STACK_EXPORT
 bool Analog_Output_Present_Value_Relinquish(
     uint32_t object_instance, unsigned priority);
 BACNET_STACK_EXPORT
@@ -133,6 +142,10 @@ BACNET_STACK_EXPORT
 int Analog_Output_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
 BACNET_STACK_EXPORT
 bool Analog_Output_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
+BACNET_STACK_EXPORT
+int Analog_Output_Write_Property_Typed(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value);
 
 BACNET_STACK_EXPORT
 void *Analog_Output_Context_Get(uint32_t object_instance);
@@ -145,8 +158,19 @@ BACNET_STACK_EXPORT
 bool Analog_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Analog_Output_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Analog_Output_Dense_Values(void);
+BACNET_STACK_EXPORT
+unsigned Analog_Output_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances);
+#endif
 BACNET_STACK_EXPORT
 void Analog_Output_Init(void);
+BACNET_STACK_EXPORT
+void Analog_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Analog_Output_List_Revision(void);
 
 #ifdef __cplusplus
 }
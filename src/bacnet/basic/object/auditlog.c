@@ -88,6 +88,7 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "auditlog.h"
 
@@ -99,7 +100,15 @@ struct object_data {
     bool Enable;
     bool Out_Of_Service;
     int Buffer_Size;
+#if defined(BACNET_AUDIT_LOG_RING)
+    /* preallocated ring of Buffer_Size records */
+    BACNET_AUDIT_LOG_RECORD *Ring;
+    /* index of the oldest record in the ring */
+    uint32_t Ring_Head;
+    uint32_t Ring_Count;
+#else
     OS_Keylist Records;
+#endif
     int Record_Count_Total;
     const char *Object_Name;
     const char *Description;
@@ -238,6 +247,74 @@ unsigned Audit_Log_Instance_To_Index(uint32_t object_instance)
     return Keylist_Index(Object_List, object_instance);
 }
 
+#if defined(BACNET_AUDIT_LOG_RING)
+/**
+ * @brief Delete a record from the ring, keeping the others in order
+ * @param pObject - object holding the ring
+ * @param index - 0..N index of the record, from the oldest
+ */
+static void Audit_Log_Ring_Delete(struct object_data *pObject, uint32_t index)
+{
+    uint32_t i;
+
+    if (index >= pObject->Ring_Count) {
+        return;
+    }
+    if (index == 0) {
+        /* the oldest record is the common case */
+        pObject->Ring_Head = (pObject->Ring_Head + 1) % pObject->Buffer_Size;
+    } else {
+        for (i = index; i < (pObject->Ring_Count - 1); i++) {
+            pObject->Ring[(pObject->Ring_Head + i) % pObject->Buffer_Size] =
+                pObject->Ring
+                    [(pObject->Ring_Head + i + 1) % pObject->Buffer_Size];
+        }
+    }
+    pObject->Ring_Count--;
+}
+
+/**
+ * @brief Move the records into a ring of another size
+ * @note When the ring shrinks, the oldest records are kept.
+ * @param pObject - object holding the ring
+ * @param buffer_size - number of records in the new ring
+ * @return true if the ring has the new size
+ */
+static bool
+Audit_Log_Ring_Resize(struct object_data *pObject, uint32_t buffer_size)
+{
+    BACNET_AUDIT_LOG_RECORD *ring = NULL;
+    uint32_t count, i;
+
+    if (!pObject->Ring) {
+        /* the ring is allocated with the first record */
+        return true;
+    }
+    count = pObject->Ring_Count;
+    if (count > buffer_size) {
+        count = buffer_size;
+    }
+    if (buffer_size > 0) {
+        ring = BACNET_MEMPOOL_CALLOC(
+            buffer_size * sizeof(BACNET_AUDIT_LOG_RECORD));
+        if (!ring) {
+            return false;
+        }
+        for (i = 0; i < count; i++) {
+            ring[i] =
+                pObject->Ring[(pObject->Ring_Head + i) % pObject->Buffer_Size];
+        }
+    }
+    BACNET_MEMPOOL_FREE(
+        pObject->Ring, pObject->Buffer_Size * sizeof(BACNET_AUDIT_LOG_RECORD));
+    pObject->Ring = ring;
+    pObject->Ring_Head = 0;
+    pObject->Ring_Count = count;
+
+    return true;
+}
+#endif
+
 /**
  * For a given object instance-number, returns the Audit Log entity by index.
  *
@@ -254,7 +331,14 @@ Audit_Log_Record_Entry(uint32_t object_instance, uint32_t index)
 
     pObject = Object_Data(object_instance);
     if (pObject) {
+#if defined(BACNET_AUDIT_LOG_RING)
+        if (index < pObject->Ring_Count) {
+            entry = &pObject->Ring
+                         [(pObject->Ring_Head + index) % pObject->Buffer_Size];
+        }
+#else
         entry = Keylist_Data_Index(pObject->Records, index);
+#endif
     }
 
     return entry;
@@ -272,8 +356,13 @@ void Audit_Log_Record_Entry_Delete(uint32_t object_instance, uint32_t index)
 
     pObject = Object_Data(object_instance);
     if (pObject) {
-        entry = Keylist_Data_Delete(pObject->Records, index);
-        free(entry);
+#if defined(BACNET_AUDIT_LOG_RING)
+        (void)entry;
+        Audit_Log_Ring_Delete(pObject, index);
+#else
+        entry = Keylist_Data_Delete_By_Index(pObject->Records, index);
+        BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
+#endif
     }
 }
 
@@ -299,12 +388,38 @@ bool Audit_Log_Record_Entry_Add(
     if (!pObject) {
         return false;
     }
+#if defined(BACNET_AUDIT_LOG_RING)
+    (void)index;
+    if (!pObject->Ring) {
+        if (pObject->Buffer_Size <= 0) {
+            return false;
+        }
+        pObject->Ring = BACNET_MEMPOOL_CALLOC(
+            pObject->Buffer_Size * sizeof(BACNET_AUDIT_LOG_RECORD));
+        if (!pObject->Ring) {
+            return false;
+        }
+        pObject->Ring_Head = 0;
+        pObject->Ring_Count = 0;
+    }
+    if (pObject->Ring_Count >= (uint32_t)pObject->Buffer_Size) {
+        /* log is full, so the oldest record is overwritten */
+        entry = &pObject->Ring[pObject->Ring_Head];
+        pObject->Ring_Head = (pObject->Ring_Head + 1) % pObject->Buffer_Size;
+    } else {
+        entry = &pObject->Ring
+                     [(pObject->Ring_Head + pObject->Ring_Count) %
+                      pObject->Buffer_Size];
+        pObject->Ring_Count++;
+    }
+    memcpy(entry, value, sizeof(BACNET_AUDIT_LOG_RECORD));
+#else
     if (Keylist_Count(pObject->Records) >= pObject->Buffer_Size) {
         /* log is full, so delete oldest record before adding a new record */
         entry = Keylist_Data_Delete_By_Index(pObject->Records, 0);
     }
     if (!entry) {
-        entry = calloc(1, sizeof(BACNET_AUDIT_LOG_RECORD));
+        entry = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_AUDIT_LOG_RECORD));
         if (!entry) {
             return false;
         }
@@ -313,9 +428,10 @@ bool Audit_Log_Record_Entry_Add(
     index =
         Keylist_Data_Add(pObject->Records, pObject->Record_Count_Total, entry);
     if (index < 0) {
-        free(entry);
+        BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
         return false;
     }
+#endif
     pObject->Record_Count_Total++;
 
     return true;
@@ -359,14 +475,23 @@ bool Audit_Log_Buffer_Size_Set(uint32_t object_instance, uint32_t buffer_size)
     if (buffer_size > INT_MAX) {
         return false;
     }
+#if defined(BACNET_AUDIT_LOG_RING)
+    (void)entry;
+    (void)i;
+    if (!Audit_Log_Ring_Resize(pObject, buffer_size)) {
+        return false;
+    }
+#else
     if (buffer_size < pObject->Buffer_Size) {
         /* The disposition of existing log records when Buffer_Size is written
             is a local matter. We can shrink the log buffer. */
-        for (i = buffer_size; i < pObject->Buffer_Size; i++) {
-            entry = Keylist_Data_Delete_By_Index(pObject->Records, i);
-            free(entry);
+        for (i = Keylist_Count(pObject->Records); i > (int)buffer_size;
+             i--) {
+            entry = Keylist_Data_Delete_By_Index(pObject->Records, i - 1);
+            BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
         }
     }
+#endif
     pObject->Buffer_Size = buffer_size;
 
     return true;
@@ -580,7 +705,11 @@ uint32_t Audit_Log_Record_Count(uint32_t object_instance)
 
     pObject = Object_Data(object_instance);
     if (pObject) {
+#if defined(BACNET_AUDIT_LOG_RING)
+        record_count = pObject->Ring_Count;
+#else
         record_count = Keylist_Count(pObject->Records);
+#endif
     }
 
     return record_count;
@@ -900,11 +1029,31 @@ static int Audit_Log_Record_Search(
  */
 void Audit_Log_Record_Notification_Insert(
     uint32_t object_instance, BACNET_AUDIT_NOTIFICATION *notification)
+{
+    Audit_Log_Record_Notification_Insert_List(object_instance, notification, 1);
+}
+
+/**
+ * @brief Insert a list of notification records into a audit log, such as
+ *  the notifications of one AuditNotification request.  The object, its
+ *  enable, and the time stamp are looked up once for the whole list.
+ * @param  object_instance - object-instance number of the object
+ * @param  notifications - array of notifications
+ * @param  count - number of notifications in the array
+ */
+void Audit_Log_Record_Notification_Insert_List(
+    uint32_t object_instance,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count)
 {
     BACNET_AUDIT_LOG_RECORD seek_entry = { 0 };
     struct object_data *pObject;
+    unsigned i;
     int index;
 
+    if (!notifications || (count == 0)) {
+        return;
+    }
     pObject = Object_Data(object_instance);
     if (!pObject) {
         return;
@@ -912,22 +1061,25 @@ void Audit_Log_Record_Notification_Insert(
     if (!Audit_Log_Enable(object_instance)) {
         return;
     }
-    /*  As records are added into the log, the Audit Log object will scan
-        existing entries for a matching record. */
+    /* the notifications of one request share their time stamp */
     datetime_local(
         &seek_entry.timestamp.date, &seek_entry.timestamp.time, NULL, NULL);
     seek_entry.tag = AUDIT_LOG_DATUM_TAG_NOTIFICATION;
-    memcpy(
-        &seek_entry.log_datum.notification, notification,
-        sizeof(BACNET_AUDIT_NOTIFICATION));
-    index = Audit_Log_Record_Search(object_instance, &seek_entry);
-    if (index >= 0) {
-        /*  If a match is found, the existing record is updated with the new
-            time stamp and the record is moved to the end of the list.
-            i.e. delete the old entry and add the new entry */
-        Audit_Log_Record_Entry_Delete(object_instance, index);
-    }
-    Audit_Log_Record_Entry_Add(object_instance, &seek_entry);
+    for (i = 0; i < count; i++) {
+        memcpy(
+            &seek_entry.log_datum.notification, &notifications[i],
+            sizeof(BACNET_AUDIT_NOTIFICATION));
+        /*  As records are added into the log, the Audit Log object will
+            scan existing entries for a matching record. */
+        index = Audit_Log_Record_Search(object_instance, &seek_entry);
+        if (index >= 0) {
+            /*  If a match is found, the existing record is updated with
+                the new time stamp and the record is moved to the end of
+                the list. i.e. delete the old entry and add the new entry */
+            Audit_Log_Record_Entry_Delete(object_instance, index);
+        }
+        Audit_Log_Record_Entry_Add(object_instance, &seek_entry);
+    }
 }
 
 /**
@@ -1232,6 +1384,45 @@ int Audit_Log_Read_Range_By_Sequence(BACNET_READ_RANGE_DATA *pRequest)
     return apdu_len;
 }
 
+/**
+ * @brief Find the first record, in time order, after the reference time
+ * @note The records of a log are in time order, so a binary search finds
+ *  the record without scanning the log.
+ * @param object_instance [in] BACnet object instance number
+ * @param record_count [in] number of records in the log
+ * @param reference [in] the reference time
+ * @param after [in] true to skip the records at the reference time too
+ * @return the 0 based index of the first record later than, or with
+ *  after false at or later than, the reference time, or record_count
+ *  if there is no such record
+ */
+static uint32_t Audit_Log_Record_Time_Bound(
+    uint32_t object_instance,
+    uint32_t record_count,
+    const BACNET_DATE_TIME *reference,
+    bool after)
+{
+    const BACNET_AUDIT_LOG_RECORD *entry;
+    uint32_t low = 0, high = record_count, middle;
+    int diff;
+
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        entry = Audit_Log_Record_Entry(object_instance, middle);
+        if (!entry) {
+            break;
+        }
+        diff = datetime_compare(&entry->timestamp, reference);
+        if ((diff < 0) || (after && (diff == 0))) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
 /**
  * Handle encoding for the By Time option.
  * The fact that the buffer always has at least a single entry is used
@@ -1253,8 +1444,6 @@ int Audit_Log_Read_Range_By_Time(BACNET_READ_RANGE_DATA *pRequest)
     uint32_t record_count;
     uint32_t total_record_count;
     BACNET_AUDIT_LOG_RECORD *entry = NULL;
-    int diff;
-
     int32_t iTemp = 0;
     int iCount = 0;
     uint32_t uiIndex = 0; /* Current entry number */
@@ -1272,27 +1461,16 @@ int Audit_Log_Read_Range_By_Time(BACNET_READ_RANGE_DATA *pRequest)
         /* Start at end of log and look for record which has
          * timestamp greater than or equal to the reference.
          */
-        iCount = record_count - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = total_record_count;
-        for (;;) {
-            record_index = iCount;
-            entry =
-                Audit_Log_Record_Entry(pRequest->object_instance, record_index);
-            diff =
-                datetime_compare(&entry->timestamp, &pRequest->Range.RefTime);
-            if (diff < 0) {
-                /* If datetime1 is before datetime2, returns negative.*/
-                break;
-            }
-            uiFirstSeq--;
-            if (iCount) {
-                iCount--;
-            } else {
-                /* end of records, not found */
-                return 0;
-            }
+        iCount = (int)Audit_Log_Record_Time_Bound(
+                     pRequest->object_instance, record_count,
+                     &pRequest->Range.RefTime, false) -
+            1;
+        if (iCount < 0) {
+            /* end of records, not found */
+            return 0;
         }
+        /* The sequence number for the record we found */
+        uiFirstSeq = total_record_count - (record_count - 1 - iCount);
         /* We have an and point for our request,
          * now work backwards to find where we should start from
          */
@@ -1315,26 +1493,15 @@ int Audit_Log_Read_Range_By_Time(BACNET_READ_RANGE_DATA *pRequest)
         /* Start at beginning of log and look for 1st record which has
          * timestamp greater than the reference time.
          */
-        iCount = 0;
+        iCount = (int)Audit_Log_Record_Time_Bound(
+            pRequest->object_instance, record_count, &pRequest->Range.RefTime,
+            true);
+        if ((uint32_t)iCount == record_count) {
+            return (0);
+        }
         /* Figure out the sequence number for the first record, last is
          * ulTotalRecordCount */
-        uiFirstSeq = total_record_count - record_count - 1;
-        for (;;) {
-            record_index = iCount;
-            entry =
-                Audit_Log_Record_Entry(pRequest->object_instance, record_index);
-            diff =
-                datetime_compare(&entry->timestamp, &pRequest->Range.RefTime);
-            if (diff > 0) {
-                /* If datetime1 is after datetime2, returns positive.*/
-                break;
-            }
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t)iCount == record_count) {
-                return (0);
-            }
-        }
+        uiFirstSeq = total_record_count - record_count - 1 + iCount;
     }
 
     /* We now have a starting point for the operation and a +ve count */
@@ -1436,20 +1603,27 @@ uint32_t Audit_Log_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (!pObject) {
             return BACNET_MAX_INSTANCE;
         }
         pObject->Object_Name = NULL;
         pObject->Description = NULL;
+#if defined(BACNET_AUDIT_LOG_RING)
+        /* the ring is allocated with the first record */
+        pObject->Ring = NULL;
+        pObject->Ring_Head = 0;
+        pObject->Ring_Count = 0;
+#else
         pObject->Records = Keylist_Create();
+#endif
         pObject->Buffer_Size = BACNET_AUDIT_LOG_RECORDS_MAX;
         pObject->Enable = false;
         pObject->Out_Of_Service = false;
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
-            free(pObject);
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             return BACNET_MAX_INSTANCE;
         }
     }
@@ -1458,17 +1632,25 @@ uint32_t Audit_Log_Create(uint32_t object_instance)
 }
 
 /**
- * @brief Deletes all the Audit Logs and their data
+ * @brief Deletes the log records of an Audit Log
+ * @param pObject - object whose records are deleted
  */
-static void Audit_Log_Records_Cleanup(OS_Keylist list)
+static void Audit_Log_Records_Cleanup(struct object_data *pObject)
 {
+#if defined(BACNET_AUDIT_LOG_RING)
+    BACNET_MEMPOOL_FREE(
+        pObject->Ring, pObject->Buffer_Size * sizeof(BACNET_AUDIT_LOG_RECORD));
+    pObject->Ring = NULL;
+    pObject->Ring_Count = 0;
+#else
     BACNET_AUDIT_LOG_RECORD *entry;
 
-    while (Keylist_Count(list) > 0) {
-        entry = Keylist_Data_Pop(list);
-        free(entry);
+    while (Keylist_Count(pObject->Records) > 0) {
+        entry = Keylist_Data_Pop(pObject->Records);
+        BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
     }
-    Keylist_Delete(list);
+    Keylist_Delete(pObject->Records);
+#endif
 }
 
 /**
@@ -1483,8 +1665,8 @@ bool Audit_Log_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        Audit_Log_Records_Cleanup(pObject->Records);
-        free(pObject);
+        Audit_Log_Records_Cleanup(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1502,8 +1684,8 @@ void Audit_Log_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                Audit_Log_Records_Cleanup(pObject->Records);
-                free(pObject);
+                Audit_Log_Records_Cleanup(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1511,6 +1693,50 @@ void Audit_Log_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Audit Log objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Audit_Log_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    const struct object_data *pObject;
+    unsigned count, index;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+    /* the log records of each object */
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, (int)index);
+        if (!pObject) {
+            continue;
+        }
+#if defined(BACNET_AUDIT_LOG_RING)
+        if (pObject->Ring) {
+            usage->dynamic_bytes += (size_t)pObject->Buffer_Size *
+                sizeof(BACNET_AUDIT_LOG_RECORD);
+        }
+#else
+        usage->dynamic_bytes += Keylist_Memory_Size(pObject->Records);
+        usage->dynamic_bytes += (size_t)Keylist_Count(pObject->Records) *
+            sizeof(BACNET_AUDIT_LOG_RECORD);
+#endif
+    }
+}
+
+/**
+ * @brief Get the revision of the list of Audit Log objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Audit_Log_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * @brief Initializes the Audit Log object data
  */
@@ -32,6 +32,7 @@
 #include "bacnet/readrange.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,6 +87,10 @@ BACNET_STACK_EXPORT
 void Audit_Log_Cleanup(void);
 BACNET_STACK_EXPORT
 void Audit_Log_Init(void);
+BACNET_STACK_EXPORT
+void Audit_Log_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Audit_Log_List_Revision(void);
 
 BACNET_STACK_EXPORT
 uint32_t Audit_Log_Buffer_Size(uint32_t object_instance);
@@ -104,6 +109,11 @@ BACNET_STACK_EXPORT
 void Audit_Log_Record_Notification_Insert(
     uint32_t instance, BACNET_AUDIT_NOTIFICATION *notification);
 BACNET_STACK_EXPORT
+void Audit_Log_Record_Notification_Insert_List(
+    uint32_t object_instance,
+    const BACNET_AUDIT_NOTIFICATION *notifications,
+    unsigned count);
+BACNET_STACK_EXPORT
 BACNET_AUDIT_LOG_RECORD *
 Audit_Log_Record_Entry(uint32_t object_instance, uint32_t index);
 BACNET_STACK_EXPORT
@@ -24,12 +24,36 @@
 #include "bacnet/timestamp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
 #include "bacnet/basic/sys/debug.h"
 /* me! */
 #include "bacnet/basic/object/av.h"
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* instances registered by Analog_Value_Create_Lazy() are in the list
+   without data, which is built from a template object on first access */
+struct analog_value_lazy_range {
+    uint32_t first_instance;
+    uint32_t last_instance;
+    uint32_t template_instance;
+};
+static struct analog_value_lazy_range *Lazy_Range;
+static unsigned Lazy_Range_Count;
+/* number of ranges allocated */
+static unsigned Lazy_Range_Size;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+#define OBJECT_PRESENT_VALUE(o) (Dense_Values.Present_Value[(o)->Dense_Slot])
+#define OBJECT_PRIOR_VALUE(o) (Dense_Values.Prior_Value[(o)->Dense_Slot])
+#define OBJECT_COV_INCREMENT(o) (Dense_Values.COV_Increment[(o)->Dense_Slot])
+#else
+#define OBJECT_PRESENT_VALUE(o) ((o)->Present_Value)
+#define OBJECT_PRIOR_VALUE(o) ((o)->Prior_Value)
+#define OBJECT_COV_INCREMENT(o) ((o)->COV_Increment)
+#endif
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_VALUE;
 /* callback for present value writes */
@@ -86,17 +110,94 @@ void Analog_Value_Property_Lists(
     return;
 }
 
+static struct analog_value_descr *
+Analog_Value_Object_Build(uint32_t object_instance);
+
 /**
- * @brief Gets an object from the list using an instance number as the key
+ * @brief Gets an object from the list using an instance number as the key.
+ *  An object registered lazily is built on its first access.
  * @param  object_instance - object-instance number of the object
  * @return object found in the list, or NULL if not found
  */
 static struct analog_value_descr *Analog_Value_Object(uint32_t object_instance)
 {
-    return Keylist_Data(Object_List, object_instance);
+    struct analog_value_descr *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject && (Lazy_Range_Count > 0)) {
+        pObject = Analog_Value_Object_Build(object_instance);
+    }
+
+    return pObject;
+}
+
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Analog_Value_Changed(const struct analog_value_descr *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Changed;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void
+Analog_Value_Changed_Set(struct analog_value_descr *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Changed = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Analog_Value_Object_Free(struct analog_value_descr *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
 }
 
 #if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Updates the active event set of the GetEventInformation
+ *  and GetAlarmSummary services after an event state change or
+ *  an acknowledgment
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object to check for an active event
+ */
+static void Analog_Value_Event_Active_Update(
+    uint32_t object_instance, const struct analog_value_descr *pObject)
+{
+    handler_get_event_information_active_set(
+        Object_Type, object_instance,
+        (pObject->Event_State != EVENT_STATE_NORMAL) ||
+            !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+}
+
 /**
  * @brief Gets an object from the list using its index in the list
  * @param index - index of the object in the list
@@ -115,14 +216,8 @@ static struct analog_value_descr *Analog_Value_Object_Index(int index)
  */
 bool Analog_Value_Valid_Instance(uint32_t object_instance)
 {
-    struct analog_value_descr *pObject;
-
-    pObject = Analog_Value_Object(object_instance);
-    if (pObject) {
-        return true;
-    }
-
-    return false;
+    /* a lazy object is valid before it is built */
+    return Keylist_Index(Object_List, object_instance) >= 0;
 }
 
 /**
@@ -173,7 +268,7 @@ float Analog_Value_Present_Value(uint32_t object_instance)
 
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
-        value = pObject->Present_Value;
+        value = OBJECT_PRESENT_VALUE(pObject);
     }
 
     return value;
@@ -197,16 +292,16 @@ Analog_Value_COV_Detect(struct analog_value_descr *pObject, float value)
     float cov_delta = 0.0f;
 
     if (pObject) {
-        prior_value = pObject->Prior_Value;
-        cov_increment = pObject->COV_Increment;
+        prior_value = OBJECT_PRIOR_VALUE(pObject);
+        cov_increment = OBJECT_COV_INCREMENT(pObject);
         if (prior_value > value) {
             cov_delta = prior_value - value;
         } else {
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
-            pObject->Prior_Value = value;
+            Analog_Value_Changed_Set(pObject, true);
+            OBJECT_PRIOR_VALUE(pObject) = value;
         }
     }
 }
@@ -231,13 +326,57 @@ bool Analog_Value_Present_Value_Set(
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         Analog_Value_COV_Detect(pObject, value);
-        pObject->Present_Value = value;
+        OBJECT_PRESENT_VALUE(pObject) = value;
         status = true;
     }
 
     return status;
 }
 
+/**
+ * @brief For a given object instance-number, writes the present-value
+ *  as a WriteProperty request would, and calls the write callback
+ * @param  object_instance - object-instance number of the object
+ * @param  value - floating point analog value
+ * @param  priority - priority-array index value 1..16
+ * @param  error_class - the BACnet error class
+ * @param  error_code - BACnet Error code
+ * @return  true if values are within range and present-value is set.
+ */
+bool Analog_Value_Present_Value_Write(
+    uint32_t object_instance,
+    float value,
+    uint8_t priority,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code)
+{
+    bool status = false;
+    float old_value = 0.0f;
+
+    if (priority == 6) {
+        /* Command priority 6 is reserved for use by Minimum On/Off
+           algorithm and may not be used for other purposes in any
+           object. */
+        *error_class = ERROR_CLASS_PROPERTY;
+        *error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+    } else {
+        old_value = Analog_Value_Present_Value(object_instance);
+        if (Analog_Value_Present_Value_Set(object_instance, value, priority)) {
+            status = true;
+            if (Analog_Value_Write_Present_Value_Callback) {
+                Analog_Value_Write_Present_Value_Callback(
+                    object_instance, old_value,
+                    Analog_Value_Present_Value(object_instance));
+            }
+        } else {
+            *error_class = ERROR_CLASS_PROPERTY;
+            *error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+        }
+    }
+
+    return status;
+}
+
 /**
  * For a given object instance-number, return the name.
  *
@@ -475,7 +614,7 @@ bool Analog_Value_Reliability_Set(
         fault = Analog_Value_Object_Fault(pObject);
         pObject->Reliability = value;
         if (fault != Analog_Value_Object_Fault(pObject)) {
-            pObject->Changed = true;
+            Analog_Value_Changed_Set(pObject, true);
         }
         status = true;
     }
@@ -507,9 +646,10 @@ bool Analog_Value_Change_Of_Value(uint32_t object_instance)
     bool changed = false;
     struct analog_value_descr *pObject;
 
-    pObject = Analog_Value_Object(object_instance);
+    /* a lazy object that is not built has not changed */
+    pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        changed = pObject->Changed;
+        changed = Analog_Value_Changed(pObject);
     }
 
     return changed;
@@ -523,9 +663,9 @@ void Analog_Value_Change_Of_Value_Clear(uint32_t object_instance)
 {
     struct analog_value_descr *pObject;
 
-    pObject = Analog_Value_Object(object_instance);
+    pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        pObject->Changed = false;
+        Analog_Value_Changed_Set(pObject, false);
     }
 }
 
@@ -557,7 +697,7 @@ bool Analog_Value_Encode_Value_List(
             fault = true;
         }
         out_of_service = pObject->Out_Of_Service;
-        present_value = pObject->Present_Value;
+        present_value = OBJECT_PRESENT_VALUE(pObject);
         status = cov_value_list_encode_real(
             value_list, present_value, in_alarm, fault, overridden,
             out_of_service);
@@ -578,7 +718,7 @@ float Analog_Value_COV_Increment(uint32_t object_instance)
 
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
-        value = pObject->COV_Increment;
+        value = OBJECT_COV_INCREMENT(pObject);
     }
 
     return value;
@@ -595,8 +735,8 @@ void Analog_Value_COV_Increment_Set(uint32_t object_instance, float value)
 
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
-        pObject->COV_Increment = value;
-        Analog_Value_COV_Detect(pObject, pObject->Present_Value);
+        OBJECT_COV_INCREMENT(pObject) = value;
+        Analog_Value_COV_Detect(pObject, OBJECT_PRESENT_VALUE(pObject));
     }
 }
 
@@ -676,7 +816,7 @@ void Analog_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Changed = true;
+            Analog_Value_Changed_Set(pObject, true);
         }
         pObject->Out_Of_Service = value;
     }
@@ -824,7 +964,8 @@ int Analog_Value_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
         case PROP_COV_INCREMENT:
             apdu_len =
-                encode_application_real(&apdu[0], CurrentAV->COV_Increment);
+                encode_application_real(
+                    &apdu[0], OBJECT_COV_INCREMENT(CurrentAV));
             break;
 #if defined(INTRINSIC_REPORTING)
         case PROP_TIME_DELAY:
@@ -917,6 +1058,67 @@ int Analog_Value_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
     return apdu_len;
 }
 
+/**
+ * @brief WriteProperty of a primitive value, which skips the decode of
+ *  Analog_Value_Write_Property() for the properties that setpoint writes use
+ * @param  wp_data - BACNET_WRITE_PROPERTY_DATA data, including
+ * requested data and space for the reply, or error response.
+ * @param  value - primitive value of the request
+ * @return 1 if written, BACNET_STATUS_ERROR if an error is loaded, or 0 to
+ *  use Analog_Value_Write_Property()
+ */
+int Analog_Value_Write_Property_Typed(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value)
+{
+    bool status = false;
+    ANALOG_VALUE_DESCR *CurrentAV;
+
+    CurrentAV = Analog_Value_Object(wp_data->object_instance);
+    if (!CurrentAV) {
+        return 0;
+    }
+    switch (wp_data->object_property) {
+        case PROP_PRESENT_VALUE:
+            if (value->tag != BACNET_APPLICATION_TAG_REAL) {
+                return 0;
+            }
+            status = Analog_Value_Present_Value_Write(
+                wp_data->object_instance, value->type.Real, wp_data->priority,
+                &wp_data->error_class, &wp_data->error_code);
+            break;
+        case PROP_UNITS:
+            if (value->tag != BACNET_APPLICATION_TAG_ENUMERATED) {
+                return 0;
+            }
+            if (value->type.Enumerated <= UINT16_MAX) {
+                CurrentAV->Units = value->type.Enumerated;
+                status = true;
+            } else {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_COV_INCREMENT:
+            if (value->tag != BACNET_APPLICATION_TAG_REAL) {
+                return 0;
+            }
+            if (value->type.Real >= 0.0f) {
+                Analog_Value_COV_Increment_Set(
+                    wp_data->object_instance, value->type.Real);
+                status = true;
+            } else {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        default:
+            return 0;
+    }
+
+    return status ? 1 : BACNET_STATUS_ERROR;
+}
+
 /**
  * @brief WriteProperty handler for this object.  For the given WriteProperty
  * data, the application_data is loaded or the error flags are set.
@@ -928,7 +1130,6 @@ bool Analog_Value_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
 {
     bool status = false; /* return value */
     int len = 0;
-    float old_value = 0.0f;
     BACNET_APPLICATION_DATA_VALUE value = { 0 };
     ANALOG_VALUE_DESCR *CurrentAV;
 
@@ -960,33 +1161,10 @@ bool Analog_Value_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             status = write_property_type_valid(
                 wp_data, &value, BACNET_APPLICATION_TAG_REAL);
             if (status) {
-                /* Command priority 6 is reserved for use by Minimum On/Off
-                   algorithm and may not be used for other purposes in any
-                   object. */
-                if (wp_data->priority == 6) {
-                    /* Command priority 6 is reserved for use by Minimum On/Off
-                       algorithm and may not be used for other purposes in any
-                       object. */
-                    wp_data->error_class = ERROR_CLASS_PROPERTY;
-                    wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
-                } else {
-                    old_value =
-                        Analog_Value_Present_Value(wp_data->object_instance);
-                    if (Analog_Value_Present_Value_Set(
-                            wp_data->object_instance, value.type.Real,
-                            wp_data->priority)) {
-                        status = true;
-                        if (Analog_Value_Write_Present_Value_Callback) {
-                            Analog_Value_Write_Present_Value_Callback(
-                                wp_data->object_instance, old_value,
-                                Analog_Value_Present_Value(
-                                    wp_data->object_instance));
-                        }
-                    } else {
-                        wp_data->error_class = ERROR_CLASS_PROPERTY;
-                        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
-                    }
-                }
+                status = Analog_Value_Present_Value_Write(
+                    wp_data->object_instance, value.type.Real,
+                    wp_data->priority, &wp_data->error_class,
+                    &wp_data->error_code);
             }
             break;
         case PROP_OUT_OF_SERVICE:
@@ -1150,7 +1328,8 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
     float PresentVal = 0.0f;
     bool SendNotify = false;
 
-    CurrentAV = Analog_Value_Object(object_instance);
+    /* a lazy object that is not built has no event detection to run */
+    CurrentAV = Keylist_Data(Object_List, object_instance);
     if (!CurrentAV) {
         return;
     }
@@ -1485,6 +1664,7 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    Analog_Value_Event_Active_Update(object_instance, CurrentAV);
 #else
     (void)object_instance;
 #endif /* defined(INTRINSIC_REPORTING) */
@@ -1519,6 +1699,8 @@ int Analog_Value_Event_Information(
              false) ||
             (pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked ==
              false);
+    } else if (index < Analog_Value_Count()) {
+        return 0; /* a lazy object that is not built has no event */
     } else {
         return -1; /* end of list  */
     }
@@ -1678,6 +1860,9 @@ int Analog_Value_Alarm_Ack(
     CurrentAV->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
     /* Return OK */
+    Analog_Value_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, CurrentAV);
+
     return 1;
 }
 
@@ -1722,6 +1907,8 @@ int Analog_Value_Alarm_Summary(
         } else {
             return 0; /* no active alarm at this index */
         }
+    } else if (index < Analog_Value_Count()) {
+        return 0; /* a lazy object that is not built has no alarm */
     } else {
         return -1; /* end of list  */
     }
@@ -1737,7 +1924,7 @@ void *Analog_Value_Context_Get(uint32_t object_instance)
 {
     struct analog_value_descr *pObject;
 
-    pObject = Keylist_Data(Object_List, object_instance);
+    pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         return pObject->Context;
     }
@@ -1754,12 +1941,116 @@ void Analog_Value_Context_Set(uint32_t object_instance, void *context)
 {
     struct analog_value_descr *pObject;
 
-    pObject = Keylist_Data(Object_List, object_instance);
+    pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         pObject->Context = context;
     }
 }
 
+/**
+ * @brief Allocate and initialize the data of an Analog Value object
+ * @param object_instance - object-instance number of the object
+ * @return the object data, or NULL if out of memory
+ */
+static struct analog_value_descr *
+Analog_Value_Object_Alloc(uint32_t object_instance)
+{
+    struct analog_value_descr *pObject = NULL;
+#if defined(INTRINSIC_REPORTING)
+    unsigned j;
+#endif
+
+    (void)object_instance;
+    pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct analog_value_descr));
+    if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+        pObject->Dense_Slot =
+            dense_value_slot_alloc(&Dense_Values, object_instance);
+        if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+            return NULL;
+        }
+#endif
+        pObject->Object_Name = NULL;
+        pObject->Description = NULL;
+        pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
+        OBJECT_COV_INCREMENT(pObject) = 1.0;
+        OBJECT_PRESENT_VALUE(pObject) = 0.0f;
+        OBJECT_PRIOR_VALUE(pObject) = 0.0;
+        pObject->Units = UNITS_PERCENT;
+        pObject->Out_Of_Service = false;
+        Analog_Value_Changed_Set(pObject, false);
+        pObject->Event_State = EVENT_STATE_NORMAL;
+#if defined(INTRINSIC_REPORTING)
+        pObject->Event_Detection_Enable = true;
+        /* notification class not connected */
+        pObject->Notification_Class = BACNET_MAX_INSTANCE;
+        /* initialize Event time stamps using wildcards
+        and set Acked_transitions */
+        for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
+            datetime_wildcard_set(&pObject->Event_Time_Stamps[j]);
+            pObject->Acked_Transitions[j].bIsAcked = true;
+        }
+#endif
+    }
+
+    return pObject;
+}
+
+/**
+ * @brief Build the data of an object registered by
+ *  Analog_Value_Create_Lazy(), with the configuration of its template
+ * @param object_instance - object-instance number of the object
+ * @return the object data, or NULL if the instance is not in the list
+ *  or out of memory
+ */
+static struct analog_value_descr *
+Analog_Value_Object_Build(uint32_t object_instance)
+{
+    const struct analog_value_descr *pTemplate = NULL;
+    struct analog_value_descr *pObject = NULL;
+    unsigned i;
+
+    if (Keylist_Index(Object_List, object_instance) < 0) {
+        return NULL;
+    }
+    /* the latest range of the instance has its template */
+    for (i = Lazy_Range_Count; i > 0; i--) {
+        if ((object_instance >= Lazy_Range[i - 1].first_instance) &&
+            (object_instance <= Lazy_Range[i - 1].last_instance)) {
+            pTemplate =
+                Keylist_Data(Object_List, Lazy_Range[i - 1].template_instance);
+            break;
+        }
+    }
+    pObject = Analog_Value_Object_Alloc(object_instance);
+    if (!pObject) {
+        return NULL;
+    }
+    if (pTemplate) {
+        OBJECT_PRESENT_VALUE(pObject) = OBJECT_PRESENT_VALUE(pTemplate);
+        OBJECT_COV_INCREMENT(pObject) = OBJECT_COV_INCREMENT(pTemplate);
+        pObject->Description = pTemplate->Description;
+        pObject->Reliability = pTemplate->Reliability;
+        pObject->Units = pTemplate->Units;
+        pObject->Out_Of_Service = pTemplate->Out_Of_Service;
+#if defined(INTRINSIC_REPORTING)
+        pObject->Time_Delay = pTemplate->Time_Delay;
+        pObject->Notification_Class = pTemplate->Notification_Class;
+        pObject->High_Limit = pTemplate->High_Limit;
+        pObject->Low_Limit = pTemplate->Low_Limit;
+        pObject->Deadband = pTemplate->Deadband;
+        pObject->Limit_Enable = pTemplate->Limit_Enable;
+        pObject->Event_Enable = pTemplate->Event_Enable;
+        pObject->Event_Detection_Enable = pTemplate->Event_Detection_Enable;
+        pObject->Notify_Type = pTemplate->Notify_Type;
+#endif
+    }
+    (void)Keylist_Data_Set(Object_List, object_instance, pObject);
+
+    return pObject;
+}
+
 /**
  * @brief Creates a Analog Value object
  * @param object_instance - object-instance number of the object
@@ -1769,9 +2060,6 @@ uint32_t Analog_Value_Create(uint32_t object_instance)
 {
     struct analog_value_descr *pObject = NULL;
     int index = 0;
-#if defined(INTRINSIC_REPORTING)
-    unsigned j;
-#endif
 
     if (!Object_List) {
         Object_List = Keylist_Create();
@@ -1786,35 +2074,14 @@ uint32_t Analog_Value_Create(uint32_t object_instance)
             the object identifier is a local matter.*/
         object_instance = Keylist_Next_Empty_Key(Object_List, 1);
     }
-    pObject = Keylist_Data(Object_List, object_instance);
+    pObject = Analog_Value_Object(object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct analog_value_descr));
+        pObject = Analog_Value_Object_Alloc(object_instance);
         if (pObject) {
-            pObject->Object_Name = NULL;
-            pObject->Description = NULL;
-            pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
-            pObject->COV_Increment = 1.0;
-            pObject->Present_Value = 0.0f;
-            pObject->Prior_Value = 0.0;
-            pObject->Units = UNITS_PERCENT;
-            pObject->Out_Of_Service = false;
-            pObject->Changed = false;
-            pObject->Event_State = EVENT_STATE_NORMAL;
-#if defined(INTRINSIC_REPORTING)
-            pObject->Event_Detection_Enable = true;
-            /* notification class not connected */
-            pObject->Notification_Class = BACNET_MAX_INSTANCE;
-            /* initialize Event time stamps using wildcards
-            and set Acked_transitions */
-            for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
-                datetime_wildcard_set(&pObject->Event_Time_Stamps[j]);
-                pObject->Acked_Transitions[j].bIsAcked = true;
-            }
-#endif
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Analog_Value_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1825,6 +2092,166 @@ uint32_t Analog_Value_Create(uint32_t object_instance)
     return object_instance;
 }
 
+/**
+ * @brief Compare two object instances for sorting
+ * @param a - pointer to the first object instance
+ * @param b - pointer to the second object instance
+ * @return negative, zero, or positive as a is less, equal, or greater
+ */
+static int Analog_Value_Instance_Compare(const void *a, const void *b)
+{
+    uint32_t instance_a = *(const uint32_t *)a;
+    uint32_t instance_b = *(const uint32_t *)b;
+
+    return (instance_a > instance_b) - (instance_a < instance_b);
+}
+
+/**
+ * @brief Sort object instances and remove the duplicates and the
+ *  instances that are out of range
+ * @param object_instances - array of object instances, sorted in place
+ * @param count - number of object instances in the array
+ * @return number of unique object instances at the front of the array
+ */
+static unsigned
+Analog_Value_Instances_Sort(uint32_t *object_instances, unsigned count)
+{
+    unsigned i, unique = 0;
+
+    qsort(
+        object_instances, count, sizeof(uint32_t),
+        Analog_Value_Instance_Compare);
+    for (i = 0; i < count; i++) {
+        if (object_instances[i] >= BACNET_MAX_INSTANCE) {
+            break;
+        }
+        if ((unique == 0) ||
+            (object_instances[i] != object_instances[unique - 1])) {
+            object_instances[unique] = object_instances[i];
+            unique++;
+        }
+    }
+
+    return unique;
+}
+
+/**
+ * @brief Creates many Analog Value objects at once. The room for the
+ *  objects is reserved up front and they are inserted in one pass.
+ * @param object_instances - array of object-instance numbers, which is
+ *  sorted in place. Instances that already exist are skipped.
+ * @param count - number of object-instance numbers in the array
+ * @return the number of objects that were created
+ */
+unsigned Analog_Value_Create_Bulk(uint32_t *object_instances, unsigned count)
+{
+    struct analog_value_descr **objects = NULL;
+    unsigned i, created = 0;
+    int added;
+
+    if (!object_instances || (count == 0)) {
+        return 0;
+    }
+    if (!Object_List) {
+        Object_List = Keylist_Create();
+    }
+    count = Analog_Value_Instances_Sort(object_instances, count);
+    objects =
+        BACNET_MEMPOOL_CALLOC(count * sizeof(struct analog_value_descr *));
+    if (!objects) {
+        return 0;
+    }
+    /* keep only the new instances, in order, at the front of the array */
+    for (i = 0; i < count; i++) {
+        if (Keylist_Index(Object_List, object_instances[i]) >= 0) {
+            continue;
+        }
+        objects[created] = Analog_Value_Object_Alloc(object_instances[i]);
+        if (!objects[created]) {
+            break;
+        }
+        object_instances[created] = object_instances[i];
+        created++;
+    }
+    added = Keylist_Data_Add_Keys(
+        Object_List, object_instances, (void *const *)objects, (int)created);
+    if (added < 0) {
+        for (i = 0; i < created; i++) {
+            Analog_Value_Object_Free(objects[i]);
+        }
+        created = 0;
+    }
+    BACNET_MEMPOOL_FREE(objects, count * sizeof(struct analog_value_descr *));
+
+    return created;
+}
+
+/**
+ * @brief Registers a range of Analog Value objects whose data is built
+ *  on first access, such as a read, a write, or a COV subscription.
+ *  Until then, each object uses the room of a key in the list, so the
+ *  startup time and memory of a large object database depend on the
+ *  objects that are used.
+ * @param first_instance - object-instance number of the first object
+ * @param count - number of objects in the range
+ * @param template_instance - object-instance number of an object whose
+ *  configuration is copied into each object when it is built, or
+ *  BACNET_MAX_INSTANCE for the defaults of Analog_Value_Create()
+ * @return the number of objects that were registered. Instances that
+ *  already exist are skipped.
+ */
+unsigned Analog_Value_Create_Lazy(
+    uint32_t first_instance, unsigned count, uint32_t template_instance)
+{
+    struct analog_value_lazy_range *range = NULL;
+    uint32_t *object_instances = NULL;
+    unsigned i, created = 0;
+    int added;
+
+    if ((count == 0) || (first_instance >= BACNET_MAX_INSTANCE)) {
+        return 0;
+    }
+    if (count > (BACNET_MAX_INSTANCE - first_instance)) {
+        count = BACNET_MAX_INSTANCE - first_instance;
+    }
+    if (!Object_List) {
+        Object_List = Keylist_Create();
+    }
+    if (Lazy_Range_Count >= Lazy_Range_Size) {
+        range = BACNET_MEMPOOL_REALLOC(
+            Lazy_Range, Lazy_Range_Size * sizeof(*range),
+            (Lazy_Range_Count + 1) * sizeof(*range));
+        if (!range) {
+            return 0;
+        }
+        Lazy_Range = range;
+        Lazy_Range_Size = Lazy_Range_Count + 1;
+    }
+    object_instances = BACNET_MEMPOOL_CALLOC(count * sizeof(uint32_t));
+    if (!object_instances) {
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        if (Keylist_Index(Object_List, first_instance + i) < 0) {
+            object_instances[created] = first_instance + i;
+            created++;
+        }
+    }
+    added = Keylist_Data_Add_Keys(
+        Object_List, object_instances, NULL, (int)created);
+    BACNET_MEMPOOL_FREE(object_instances, count * sizeof(uint32_t));
+    if (added <= 0) {
+        return 0;
+    }
+    range = &Lazy_Range[Lazy_Range_Count];
+    range->first_instance = first_instance;
+    range->last_instance = first_instance + count - 1;
+    range->template_instance = template_instance;
+    Lazy_Range_Count++;
+
+    return created;
+}
+
 /**
  * @brief Deletes an Analog Value object
  * @param object_instance - object-instance number of the object
@@ -1832,16 +2259,61 @@ uint32_t Analog_Value_Create(uint32_t object_instance)
  */
 bool Analog_Value_Delete(uint32_t object_instance)
 {
-    bool status = false;
     struct analog_value_descr *pObject = NULL;
 
+    if (Keylist_Index(Object_List, object_instance) < 0) {
+        return false;
+    }
+    /* a lazy object that is not built has no data */
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
-        status = true;
+#if defined(INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
+        Analog_Value_Object_Free(pObject);
     }
 
-    return status;
+    return true;
+}
+
+/**
+ * @brief Deletes many Analog Value objects at once, in one pass
+ * @param object_instances - array of object-instance numbers, which is
+ *  sorted in place
+ * @param count - number of object-instance numbers in the array
+ * @return the number of objects that were deleted
+ */
+unsigned Analog_Value_Delete_Bulk(uint32_t *object_instances, unsigned count)
+{
+    struct analog_value_descr **objects = NULL;
+    unsigned i;
+    int deleted;
+
+    if (!object_instances || (count == 0)) {
+        return 0;
+    }
+    count = Analog_Value_Instances_Sort(object_instances, count);
+    objects =
+        BACNET_MEMPOOL_CALLOC(count * sizeof(struct analog_value_descr *));
+    if (!objects) {
+        return 0;
+    }
+    /* the lazy objects that are not built are deleted without data */
+    deleted = Keylist_Data_Delete_Keys(
+        Object_List, object_instances, (void **)objects, (int)count);
+    for (i = 0; i < count; i++) {
+        if (objects[i]) {
+#if defined(INTRINSIC_REPORTING)
+            handler_get_event_information_active_set(
+                Object_Type, object_instances[i], false);
+#endif
+            Analog_Value_Object_Free(objects[i]);
+        }
+    }
+    BACNET_MEMPOOL_FREE(objects, count * sizeof(struct analog_value_descr *));
+
+    return (deleted > 0) ? (unsigned)deleted : 0;
 }
 
 /**
@@ -1852,15 +2324,82 @@ void Analog_Value_Cleanup(void)
     struct analog_value_descr *pObject;
 
     if (Object_List) {
-        do {
+        /* the lazy objects that are not built pop without data */
+        while (Keylist_Count(Object_List) > 0) {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Analog_Value_Object_Free(pObject);
             }
-        } while (pObject);
+        }
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+    BACNET_MEMPOOL_FREE(Lazy_Range, Lazy_Range_Size * sizeof(*Lazy_Range));
+    Lazy_Range = NULL;
+    Lazy_Range_Count = 0;
+    Lazy_Range_Size = 0;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
+}
+
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Analog Value values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Analog Value objects
+ */
+const DENSE_VALUE_TABLE *Analog_Value_Dense_Values(void)
+{
+    return &Dense_Values;
+}
+
+/**
+ * @brief Evaluates the COV increment of every Analog Value at once
+ *  and flags the objects whose change-of-value condition tripped.
+ * @param bitmap - filled with one bit per dense slot, set when the COV flag
+ *  of the object in that slot is set
+ * @param bitmap_words - number of 32-bit words in the bitmap
+ * @param instances - set to the column that maps each slot to its
+ *  object instance
+ * @return number of slots - when larger than bitmap_words * 32, the bitmap
+ *  was too small and the remaining slots were not evaluated
+ */
+unsigned Analog_Value_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances)
+{
+    if (instances) {
+        *instances = Dense_Values.Instance;
+    }
+
+    return dense_value_cov_evaluate(&Dense_Values, bitmap, bitmap_words);
+}
+#endif
+
+/**
+ * @brief Add the memory used by the Analog Value objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Analog_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct analog_value_descr);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Analog Value objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Analog_Value_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
 }
 
 /**
@@ -1875,6 +2414,8 @@ void Analog_Value_Init(void)
     /* Set handler for GetEventInformation function */
     handler_get_event_information_set(
         Object_Type, Analog_Value_Event_Information);
+    handler_get_event_information_index_set(
+        Object_Type, Analog_Value_Instance_To_Index);
     /* Set handler for AcknowledgeAlarm function */
     handler_alarm_ack_set(Object_Type, Analog_Value_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
@@ -18,6 +18,8 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/wp.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 #if defined(INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
 #include "bacnet/alarm_ack.h"
@@ -29,10 +31,16 @@ typedef struct analog_value_descr {
     unsigned Event_State : 3;
     bool Out_Of_Service;
     BACNET_ENGINEERING_UNITS Units;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the Present_Value, Prior_Value, COV_Increment and
+       change-of-value flag in the dense value table */
+    uint32_t Dense_Slot;
+#else
     float Present_Value;
     float Prior_Value;
     float COV_Increment;
     bool Changed;
+#endif
     const char *Object_Name;
     const char *Description;
     BACNET_RELIABILITY Reliability;
@@ -95,6 +103,10 @@ int Analog_Value_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
 
 BACNET_STACK_EXPORT
 bool Analog_Value_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
+BACNET_STACK_EXPORT
+int Analog_Value_Write_Property_Typed(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value);
 
 BACNET_STACK_EXPORT
 void Analog_Value_Write_Present_Value_Callback_Set(
@@ -104,6 +116,13 @@ BACNET_STACK_EXPORT
 bool Analog_Value_Present_Value_Set(
     uint32_t object_instance, float value, uint8_t priority);
 BACNET_STACK_EXPORT
+bool Analog_Value_Present_Value_Write(
+    uint32_t object_instance,
+    float value,
+    uint8_t priority,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code);
+BACNET_STACK_EXPORT
 float Analog_Value_Present_Value(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
@@ -230,11 +249,29 @@ void Analog_Value_Context_Set(uint32_t object_instance, void *context);
 BACNET_STACK_EXPORT
 uint32_t Analog_Value_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Analog_Value_Create_Bulk(uint32_t *object_instances, unsigned count);
+BACNET_STACK_EXPORT
+unsigned Analog_Value_Create_Lazy(
+    uint32_t first_instance, unsigned count, uint32_t template_instance);
+BACNET_STACK_EXPORT
 bool Analog_Value_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Analog_Value_Delete_Bulk(uint32_t *object_instances, unsigned count);
+BACNET_STACK_EXPORT
 void Analog_Value_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Analog_Value_Dense_Values(void);
+BACNET_STACK_EXPORT
+unsigned Analog_Value_Change_Of_Value_Bulk(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances);
+#endif
 BACNET_STACK_EXPORT
 void Analog_Value_Init(void);
+BACNET_STACK_EXPORT
+void Analog_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Analog_Value_List_Revision(void);
 
 #ifdef __cplusplus
 }
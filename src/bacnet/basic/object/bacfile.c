@@ -27,6 +27,7 @@
 #include "bacnet/basic/object/bacfile.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/basic/tsm/tsm.h"
 
 #ifndef FILE_RECORD_SIZE
@@ -104,13 +105,24 @@ void BACfile_Property_Lists(
 static char *bacfile_strdup(const char *s)
 {
     size_t size = strlen(s) + 1;
-    char *p = malloc(size);
+    char *p = BACNET_MEMPOOL_CALLOC(size);
     if (p != NULL) {
         memcpy(p, s, size);
     }
     return p;
 }
 
+/**
+ * @brief free a string from bacfile_strdup()
+ * @param  s - string to free, or NULL
+ */
+static void bacfile_strfree(char *s)
+{
+    if (s != NULL) {
+        BACNET_MEMPOOL_FREE(s, strlen(s) + 1);
+    }
+}
+
 /**
  * @brief For a given object instance-number, returns the pathname
  * @param  object_instance - object-instance number of the object
@@ -140,7 +152,7 @@ void bacfile_pathname_set(uint32_t object_instance, const char *pathname)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        free(pObject->Pathname);
+        bacfile_strfree(pObject->Pathname);
         pObject->Pathname = bacfile_strdup(pathname);
     }
 }
@@ -224,7 +236,7 @@ bool bacfile_object_name_set(uint32_t object_instance, const char *new_name)
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         status = true;
-        free(pObject->Object_Name);
+        bacfile_strfree(pObject->Object_Name);
         pObject->Object_Name = bacfile_strdup(new_name);
     }
 
@@ -625,7 +637,7 @@ void bacfile_file_type_set(uint32_t object_instance, const char *mime_type)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        free(pObject->File_Type);
+        bacfile_strfree(pObject->File_Type);
         pObject->File_Type = bacfile_strdup(mime_type);
     }
 }
@@ -1205,7 +1217,7 @@ uint32_t bacfile_create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->Pathname = NULL;
@@ -1219,7 +1231,7 @@ uint32_t bacfile_create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1242,7 +1254,7 @@ bool bacfile_delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1260,10 +1272,10 @@ void bacfile_cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject->Pathname);
-                free(pObject->File_Type);
-                free(pObject->Object_Name);
-                free(pObject);
+                bacfile_strfree(pObject->Pathname);
+                bacfile_strfree(pObject->File_Type);
+                bacfile_strfree(pObject->Object_Name);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1271,6 +1283,49 @@ void bacfile_cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the File objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void bacfile_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    const struct object_data *pObject;
+    unsigned count, index;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+    /* the names are duplicated onto the heap */
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, (int)index);
+        if (!pObject) {
+            continue;
+        }
+        if (pObject->Object_Name) {
+            usage->dynamic_bytes += strlen(pObject->Object_Name) + 1;
+        }
+        if (pObject->Pathname) {
+            usage->dynamic_bytes += strlen(pObject->Pathname) + 1;
+        }
+        if (pObject->File_Type) {
+            usage->dynamic_bytes += strlen(pObject->File_Type) + 1;
+        }
+    }
+}
+
+/**
+ * @brief Get the revision of the list of File objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned bacfile_list_revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * @brief Initializes the object data
  */
@@ -19,6 +19,7 @@
 #include "bacnet/awf.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -149,6 +150,10 @@ BACNET_STACK_EXPORT
 void bacfile_cleanup(void);
 BACNET_STACK_EXPORT
 void bacfile_init(void);
+BACNET_STACK_EXPORT
+void bacfile_memory_usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned bacfile_list_revision(void);
 
 #ifdef __cplusplus
 }
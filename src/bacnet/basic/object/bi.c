@@ -26,6 +26,8 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
 #include "bacnet/basic/sys/debug.h"
 /* me! */
 #include "bacnet/basic/object/bi.h"
@@ -34,8 +36,14 @@ static const char *Default_Active_Text = "Active";
 static const char *Default_Inactive_Text = "Inactive";
 struct object_data {
     bool Out_Of_Service : 1;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the Present_Value and change-of-value flag in the dense
+       value table */
+    uint32_t Dense_Slot;
+#else
     bool Change_Of_Value : 1;
     bool Present_Value : 1;
+#endif
     bool Polarity : 1;
     bool Write_Enabled : 1;
     unsigned Event_State : 3;
@@ -62,11 +70,72 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+/* the binary present value is stored as 0.0 or 1.0 */
+#define OBJECT_PRESENT_VALUE(o) \
+    (Dense_Values.Present_Value[(o)->Dense_Slot] > 0.0f)
+#define OBJECT_PRESENT_VALUE_SET(o, v) \
+    (Dense_Values.Present_Value[(o)->Dense_Slot] = (v) ? 1.0f : 0.0f)
+#else
+#define OBJECT_PRESENT_VALUE(o) ((o)->Present_Value)
+#define OBJECT_PRESENT_VALUE_SET(o, v) ((o)->Present_Value = (v))
+#endif
+
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Binary_Input_Changed(const struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Change_Of_Value;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void Binary_Input_Changed_Set(struct object_data *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Change_Of_Value = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Binary_Input_Object_Free(struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+}
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_BINARY_INPUT;
 /* callback for present value writes */
 static binary_input_write_present_value_callback
     Binary_Input_Write_Present_Value_Callback;
+/* callback for change-of-value conditions */
+static cov_object_changed_callback Binary_Input_Change_Of_Value_Callback;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Properties_Required[] = {
@@ -133,6 +202,26 @@ static struct object_data *Binary_Input_Object(uint32_t object_instance)
     return Keylist_Data(Object_List, object_instance);
 }
 
+#if defined(INTRINSIC_REPORTING) && (BINARY_INPUT_INTRINSIC_REPORTING)
+/**
+ * @brief Updates the active event set of the GetEventInformation
+ *  and GetAlarmSummary services after an event state change or
+ *  an acknowledgment
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object to check for an active event
+ */
+static void Binary_Input_Event_Active_Update(
+    uint32_t object_instance, const struct object_data *pObject)
+{
+    handler_get_event_information_active_set(
+        Object_Type, object_instance,
+        (pObject->Event_State != EVENT_STATE_NORMAL) ||
+            !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+}
+#endif
+
 /**
  * @brief Determines if a given Binary Input instance is valid
  * @param  object_instance - object-instance number of the object
@@ -263,7 +352,7 @@ BACNET_BINARY_PV Binary_Input_Present_Value(uint32_t object_instance)
 
     pObject = Binary_Input_Object(object_instance);
     if (pObject) {
-        value = Binary_Present_Value(pObject->Present_Value);
+        value = Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject));
         if (Binary_Polarity(pObject->Polarity) != POLARITY_NORMAL) {
             if (value == BINARY_INACTIVE) {
                 value = BINARY_ACTIVE;
@@ -276,17 +365,34 @@ BACNET_BINARY_PV Binary_Input_Present_Value(uint32_t object_instance)
     return value;
 }
 
+/**
+ * @brief Sets the COV flag and reports the change to the COV callback
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Binary_Input_Change_Of_Value_Set(
+    struct object_data *pObject, uint32_t object_instance)
+{
+    Binary_Input_Changed_Set(pObject, true);
+    if (Binary_Input_Change_Of_Value_Callback) {
+        Binary_Input_Change_Of_Value_Callback(Object_Type, object_instance);
+    }
+}
+
 /**
  * @brief For a given object instance-number, checks the present-value for COV
  * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
  * @param  value - binary value
  */
 static void Binary_Input_Present_Value_COV_Detect(
-    struct object_data *pObject, BACNET_BINARY_PV value)
+    struct object_data *pObject,
+    uint32_t object_instance,
+    BACNET_BINARY_PV value)
 {
     if (pObject) {
-        if (Binary_Present_Value(pObject->Present_Value) != value) {
-            pObject->Change_Of_Value = true;
+        if (Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject)) != value) {
+            Binary_Input_Change_Of_Value_Set(pObject, object_instance);
         }
     }
 }
@@ -294,14 +400,15 @@ static void Binary_Input_Present_Value_COV_Detect(
 /**
  * @brief For a given object instance-number, checks the out-of-service for COV
  * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
  * @param  value - out-of-service value
  */
-static void
-Binary_Input_Out_Of_Service_COV_Detect(struct object_data *pObject, bool value)
+static void Binary_Input_Out_Of_Service_COV_Detect(
+    struct object_data *pObject, uint32_t object_instance, bool value)
 {
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Change_Of_Value = true;
+            Binary_Input_Change_Of_Value_Set(pObject, object_instance);
         }
     }
 }
@@ -338,7 +445,7 @@ void Binary_Input_Out_Of_Service_Set(uint32_t object_instance, bool value)
 
     pObject = Binary_Input_Object(object_instance);
     if (pObject) {
-        Binary_Input_Out_Of_Service_COV_Detect(pObject, value);
+        Binary_Input_Out_Of_Service_COV_Detect(pObject, object_instance, value);
         pObject->Out_Of_Service = value;
     }
 
@@ -403,7 +510,7 @@ bool Binary_Input_Reliability_Set(
             fault = Binary_Input_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Binary_Input_Object_Fault(pObject)) {
-                pObject->Change_Of_Value = true;
+                Binary_Input_Change_Of_Value_Set(pObject, object_instance);
             }
             status = true;
         }
@@ -439,7 +546,7 @@ bool Binary_Input_Change_Of_Value(uint32_t object_instance)
 
     pObject = Binary_Input_Object(object_instance);
     if (pObject) {
-        status = pObject->Change_Of_Value;
+        status = Binary_Input_Changed(pObject);
     }
 
     return status;
@@ -455,7 +562,7 @@ void Binary_Input_Change_Of_Value_Clear(uint32_t object_instance)
 
     pObject = Binary_Input_Object(object_instance);
     if (pObject) {
-        pObject->Change_Of_Value = false;
+        Binary_Input_Changed_Set(pObject, false);
     }
 
     return;
@@ -485,7 +592,7 @@ bool Binary_Input_Encode_Value_List(
             fault = true;
         }
         out_of_service = pObject->Out_Of_Service;
-        present_value = Binary_Present_Value(pObject->Present_Value);
+        present_value = Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject));
         status = cov_value_list_encode_enumerated(
             value_list, present_value, in_alarm, fault, overridden,
             out_of_service);
@@ -517,8 +624,10 @@ bool Binary_Input_Present_Value_Set(
                     value = BINARY_INACTIVE;
                 }
             }
-            Binary_Input_Present_Value_COV_Detect(pObject, value);
-            pObject->Present_Value = Binary_Present_Value_Boolean(value);
+            Binary_Input_Present_Value_COV_Detect(
+                pObject, object_instance, value);
+            OBJECT_PRESENT_VALUE_SET(
+                pObject, Binary_Present_Value_Boolean(value));
             status = true;
         }
     }
@@ -550,9 +659,12 @@ static bool Binary_Input_Present_Value_Write(
     if (pObject) {
         if (value <= MAX_BINARY_PV) {
             if (pObject->Write_Enabled) {
-                old_value = Binary_Present_Value(pObject->Present_Value);
-                Binary_Input_Present_Value_COV_Detect(pObject, value);
-                pObject->Present_Value = Binary_Present_Value_Boolean(value);
+                old_value =
+                    Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject));
+                Binary_Input_Present_Value_COV_Detect(
+                    pObject, object_instance, value);
+                OBJECT_PRESENT_VALUE_SET(
+                    pObject, Binary_Present_Value_Boolean(value));
                 if (pObject->Out_Of_Service) {
                     /* The physical point that the object represents
                         is not in service. This means that changes to the
@@ -602,7 +714,8 @@ static bool Binary_Input_Out_Of_Service_Write(
     pObject = Binary_Input_Object(object_instance);
     if (pObject) {
         if (pObject->Write_Enabled) {
-            Binary_Input_Out_Of_Service_COV_Detect(pObject, value);
+            Binary_Input_Out_Of_Service_COV_Detect(
+                pObject, object_instance, value);
             pObject->Out_Of_Service = value;
             status = true;
         } else {
@@ -1242,6 +1355,16 @@ void Binary_Input_Write_Present_Value_Callback_Set(
     Binary_Input_Write_Present_Value_Callback = cb;
 }
 
+/**
+ * @brief Sets a callback used when the change-of-value condition trips
+ * @param cb - callback used to report the changed object, such as
+ *  handler_cov_object_changed()
+ */
+void Binary_Input_Change_Of_Value_Callback_Set(cov_object_changed_callback cb)
+{
+    Binary_Input_Change_Of_Value_Callback = cb;
+}
+
 /**
  * @brief Determines a object write-enabled flag state
  * @param object_instance - object-instance number of the object
@@ -1345,19 +1468,27 @@ uint32_t Binary_Input_Create(uint32_t object_instance)
 
     pObject = Binary_Input_Object(object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+            pObject->Dense_Slot =
+                dense_value_slot_alloc(&Dense_Values, object_instance);
+            if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+                return BACNET_MAX_INSTANCE;
+            }
+#endif
 #if defined(INTRINSIC_REPORTING) && (BINARY_INPUT_INTRINSIC_REPORTING)
             unsigned j;
 #endif
             pObject->Object_Name = NULL;
             pObject->Description = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
-            pObject->Present_Value = false;
+            OBJECT_PRESENT_VALUE_SET(pObject, false);
             pObject->Out_Of_Service = false;
             pObject->Active_Text = Default_Active_Text;
             pObject->Inactive_Text = Default_Inactive_Text;
-            pObject->Change_Of_Value = false;
+            Binary_Input_Changed_Set(pObject, false);
             pObject->Write_Enabled = false;
             pObject->Polarity = false;
 #if defined(INTRINSIC_REPORTING) && (BINARY_INPUT_INTRINSIC_REPORTING)
@@ -1375,6 +1506,8 @@ uint32_t Binary_Input_Create(uint32_t object_instance)
             /* Set handler for GetEventInformation function */
             handler_get_event_information_set(
                 Object_Type, Binary_Input_Event_Information);
+            handler_get_event_information_index_set(
+                Object_Type, Binary_Input_Instance_To_Index);
             /* Set handler for AcknowledgeAlarm function */
             handler_alarm_ack_set(Object_Type, Binary_Input_Alarm_Ack);
             /* Set handler for GetAlarmSummary Service */
@@ -1384,7 +1517,7 @@ uint32_t Binary_Input_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Binary_Input_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1406,13 +1539,28 @@ void Binary_Input_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Binary_Input_Object_Free(pObject);
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
+}
+
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Binary Input values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Binary Input objects
+ */
+const DENSE_VALUE_TABLE *Binary_Input_Dense_Values(void)
+{
+    return &Dense_Values;
 }
+#endif
 
 /**
  * Delete a specific Binary Input object
@@ -1426,13 +1574,43 @@ bool Binary_Input_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+#if defined(INTRINSIC_REPORTING) && (BINARY_INPUT_INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
+        Binary_Input_Object_Free(pObject);
         status = true;
     }
 
     return status;
 }
 
+/**
+ * @brief Add the memory used by the Binary Input objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Binary_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Binary Input objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Binary_Input_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Binary Input object data
  */
@@ -1792,6 +1970,9 @@ int Binary_Input_Alarm_Ack(
     pObject->Ack_notify_data.bSendAckNotify = true;
     pObject->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
+    Binary_Input_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, pObject);
+
     return 1;
 }
 
@@ -2161,7 +2342,8 @@ void Binary_Input_Intrinsic_Reporting(uint32_t object_instance)
             event_data.notificationParams.changeOfState.newState =
                 (BACNET_PROPERTY_STATE) {
                     .tag = PROP_STATE_BINARY_VALUE,
-                    .state = { .binaryValue = pObject->Present_Value }
+                    .state = { .binaryValue = Binary_Present_Value(
+                                   OBJECT_PRESENT_VALUE(pObject)) }
                 };
             /* Status_Flags of the referenced object. */
             bitstring_init(
@@ -2227,5 +2409,6 @@ void Binary_Input_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    Binary_Input_Event_Active_Update(object_instance, pObject);
 #endif
 }
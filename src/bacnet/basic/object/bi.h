@@ -17,6 +17,8 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #if (INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
@@ -113,6 +115,8 @@ BACNET_STACK_EXPORT
 bool Binary_Input_Change_Of_Value(uint32_t instance);
 BACNET_STACK_EXPORT
 void Binary_Input_Change_Of_Value_Clear(uint32_t instance);
+BACNET_STACK_EXPORT
+void Binary_Input_Change_Of_Value_Callback_Set(cov_object_changed_callback cb);
 
 BACNET_STACK_EXPORT
 int Binary_Input_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
@@ -140,8 +144,16 @@ BACNET_STACK_EXPORT
 bool Binary_Input_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Binary_Input_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Binary_Input_Dense_Values(void);
+#endif
 BACNET_STACK_EXPORT
 void Binary_Input_Init(void);
+BACNET_STACK_EXPORT
+void Binary_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Binary_Input_List_Revision(void);
 
 #if defined(INTRINSIC_REPORTING) && (BINARY_INPUT_INTRINSIC_REPORTING)
 BACNET_STACK_EXPORT
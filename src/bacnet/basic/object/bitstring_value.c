@@ -22,6 +22,7 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "bitstring_value.h"
 
@@ -849,7 +850,7 @@ uint32_t BitString_Value_Create(uint32_t object_instance)
 
     pObject = BitString_Value_Object(object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->Description = NULL;
@@ -861,7 +862,7 @@ uint32_t BitString_Value_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -884,7 +885,7 @@ bool BitString_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -902,7 +903,7 @@ void BitString_Value_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -910,6 +911,32 @@ void BitString_Value_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the BitString Value objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void BitString_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of BitString Value objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned BitString_Value_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object data
  */
@@ -18,6 +18,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -123,6 +124,10 @@ void BitString_Value_Cleanup(void);
 
 BACNET_STACK_EXPORT
 void BitString_Value_Init(void);
+BACNET_STACK_EXPORT
+void BitString_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned BitString_Value_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -20,6 +20,7 @@
 #include "bacnet/lighting.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/proplist.h"
 /* me! */
 #include "bacnet/basic/object/blo.h"
@@ -1578,7 +1579,7 @@ uint32_t Binary_Lighting_Output_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (!pObject) {
             return BACNET_MAX_INSTANCE;
         }
@@ -1600,7 +1601,7 @@ uint32_t Binary_Lighting_Output_Create(uint32_t object_instance)
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
-            free(pObject);
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             return BACNET_MAX_INSTANCE;
         }
     }
@@ -1620,7 +1621,7 @@ bool Binary_Lighting_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1638,7 +1639,7 @@ void Binary_Lighting_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1646,6 +1647,32 @@ void Binary_Lighting_Output_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Binary Lighting Output objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Binary_Lighting_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Binary Lighting Output objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Binary_Lighting_Output_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object list
  */
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for write value request
@@ -170,6 +171,10 @@ BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Cleanup(void);
 BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Init(void);
+BACNET_STACK_EXPORT
+void Binary_Lighting_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Binary_Lighting_Output_List_Revision(void);
 
 BACNET_STACK_EXPORT
 int Binary_Lighting_Output_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
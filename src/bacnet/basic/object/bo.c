@@ -29,6 +29,9 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/priority_array.h"
 /* me! */
 #include "bo.h"
 
@@ -36,12 +39,20 @@ static const char *Default_Active_Text = "Active";
 static const char *Default_Inactive_Text = "Inactive";
 struct object_data {
     bool Out_Of_Service : 1;
+#if !defined(BACNET_OBJECT_DENSE_VALUES)
     bool Changed : 1;
+#endif
     bool Relinquish_Default : 1;
     bool Polarity : 1;
     uint16_t Priority_Array;
     uint16_t Priority_Active_Bits;
+    /* active priority 1..16 of the present-value, or 0 if relinquished */
+    uint8_t Present_Value_Priority;
     uint8_t Reliability;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the change-of-value flag in the dense value table */
+    uint32_t Dense_Slot;
+#endif
     const char *Object_Name;
     const char *Active_Text;
     const char *Inactive_Text;
@@ -50,6 +61,57 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+#endif
+
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Binary_Output_Changed(const struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Changed;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void Binary_Output_Changed_Set(struct object_data *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Changed = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Binary_Output_Object_Free(struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+}
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_BINARY_OUTPUT;
 /* callback for present value writes */
@@ -172,28 +234,24 @@ unsigned Binary_Output_Instance_To_Index(uint32_t object_instance)
 }
 
 /**
- * @brief Calculated the present-value property from the priority array.
+ * @brief Calculated the present-value property from the cached active
+ *  priority of the priority array.
  * @param pObject - pointer to the object data
  * @return The present-value of the object
  */
 static BACNET_BINARY_PV Object_Present_Value(struct object_data *pObject)
 {
     BACNET_BINARY_PV value = BINARY_INACTIVE;
-    unsigned p = 0;
 
     if (pObject) {
-        if (pObject->Relinquish_Default) {
-            value = BINARY_ACTIVE;
-        }
-        for (p = 0; p < BACNET_MAX_PRIORITY; p++) {
-            if (BIT_CHECK(pObject->Priority_Active_Bits, p)) {
-                if (BIT_CHECK(pObject->Priority_Array, p)) {
-                    value = BINARY_ACTIVE;
-                } else {
-                    value = BINARY_INACTIVE;
-                }
-                break;
+        if (pObject->Present_Value_Priority) {
+            if (BIT_CHECK(
+                    pObject->Priority_Array,
+                    pObject->Present_Value_Priority - 1)) {
+                value = BINARY_ACTIVE;
             }
+        } else if (pObject->Relinquish_Default) {
+            value = BINARY_ACTIVE;
         }
     }
 
@@ -261,18 +319,12 @@ static int Binary_Output_Priority_Array_Encode(
  */
 unsigned Binary_Output_Present_Value_Priority(uint32_t object_instance)
 {
-    unsigned p = 0; /* loop counter */
     unsigned priority = 0; /* return value */
     struct object_data *pObject;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        for (p = 0; p < BACNET_MAX_PRIORITY; p++) {
-            if (BIT_CHECK(pObject->Priority_Active_Bits, p)) {
-                priority = p + 1;
-                break;
-            }
-        }
+        priority = pObject->Present_Value_Priority;
     }
 
     return priority;
@@ -308,11 +360,15 @@ bool Binary_Output_Present_Value_Set(
                 } else {
                     BIT_CLEAR(pObject->Priority_Array, priority);
                 }
+                if ((pObject->Present_Value_Priority == 0) ||
+                    (priority < pObject->Present_Value_Priority)) {
+                    pObject->Present_Value_Priority = (uint8_t)(priority + 1);
+                }
                 status = true;
             }
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
-                pObject->Changed = true;
+                Binary_Output_Changed_Set(pObject, true);
             }
         }
     }
@@ -388,9 +444,13 @@ bool Binary_Output_Present_Value_Relinquish(
             old_value = Object_Present_Value(pObject);
             BIT_CLEAR(pObject->Priority_Active_Bits, priority);
             BIT_CLEAR(pObject->Priority_Array, priority);
+            if ((priority + 1) == pObject->Present_Value_Priority) {
+                pObject->Present_Value_Priority = Priority_Active_Next(
+                    pObject->Priority_Active_Bits, priority + 2);
+            }
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
-                pObject->Changed = true;
+                Binary_Output_Changed_Set(pObject, true);
             }
             status = true;
         }
@@ -549,7 +609,7 @@ void Binary_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
-            pObject->Changed = true;
+            Binary_Output_Changed_Set(pObject, true);
         }
     }
 }
@@ -794,7 +854,7 @@ bool Binary_Output_Reliability_Set(
             fault = Binary_Output_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Binary_Output_Object_Fault(pObject)) {
-                pObject->Changed = true;
+                Binary_Output_Changed_Set(pObject, true);
             }
             status = true;
         }
@@ -962,7 +1022,7 @@ bool Binary_Output_Change_Of_Value(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        changed = pObject->Changed;
+        changed = Binary_Output_Changed(pObject);
     }
 
     return changed;
@@ -979,7 +1039,7 @@ void Binary_Output_Change_Of_Value_Clear(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        pObject->Changed = false;
+        Binary_Output_Changed_Set(pObject, false);
     }
 }
 
@@ -1302,18 +1362,26 @@ uint32_t Binary_Output_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+            pObject->Dense_Slot =
+                dense_value_slot_alloc(&Dense_Values, object_instance);
+            if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+                return BACNET_MAX_INSTANCE;
+            }
+#endif
             pObject->Object_Name = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
             pObject->Out_Of_Service = false;
             pObject->Active_Text = Default_Active_Text;
             pObject->Inactive_Text = Default_Inactive_Text;
-            pObject->Changed = false;
+            Binary_Output_Changed_Set(pObject, false);
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Binary_Output_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1335,13 +1403,28 @@ void Binary_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Binary_Output_Object_Free(pObject);
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
+}
+
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Binary Output values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Binary Output objects
+ */
+const DENSE_VALUE_TABLE *Binary_Output_Dense_Values(void)
+{
+    return &Dense_Values;
 }
+#endif
 
 /**
  * Creates a Binary Input object
@@ -1353,13 +1436,39 @@ bool Binary_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        Binary_Output_Object_Free(pObject);
         status = true;
     }
 
     return status;
 }
 
+/**
+ * @brief Add the memory used by the Binary Output objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Binary_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Binary Output objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Binary_Output_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Binary Input object data
  */
@@ -18,6 +18,8 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -36,6 +38,10 @@ extern "C" {
 
 BACNET_STACK_EXPORT
 void Binary_Output_Init(void);
+BACNET_STACK_EXPORT
+void Binary_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Binary_Output_List_Revision(void);
 
 BACNET_STACK_EXPORT
 void Binary_Output_Property_Lists(
@@ -147,6 +153,10 @@ BACNET_STACK_EXPORT
 bool Binary_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Binary_Output_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Binary_Output_Dense_Values(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -26,6 +26,8 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/dense_value.h"
 #include "bacnet/basic/sys/debug.h"
 /* me! */
 #include "bacnet/basic/object/bv.h"
@@ -34,8 +36,14 @@ static const char *Default_Active_Text = "Active";
 static const char *Default_Inactive_Text = "Inactive";
 struct object_data {
     bool Out_Of_Service : 1;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* slot of the Present_Value and change-of-value flag in the dense
+       value table */
+    uint32_t Dense_Slot;
+#else
     bool Change_Of_Value : 1;
     bool Present_Value : 1;
+#endif
     bool Write_Enabled : 1;
     unsigned Event_State : 3;
     uint8_t Reliability;
@@ -61,6 +69,65 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/* values scanned for COV, kept in parallel arrays indexed by Dense_Slot */
+static DENSE_VALUE_TABLE Dense_Values;
+/* the binary present value is stored as 0.0 or 1.0 */
+#define OBJECT_PRESENT_VALUE(o) \
+    (Dense_Values.Present_Value[(o)->Dense_Slot] > 0.0f)
+#define OBJECT_PRESENT_VALUE_SET(o, v) \
+    (Dense_Values.Present_Value[(o)->Dense_Slot] = (v) ? 1.0f : 0.0f)
+#else
+#define OBJECT_PRESENT_VALUE(o) ((o)->Present_Value)
+#define OBJECT_PRESENT_VALUE_SET(o, v) ((o)->Present_Value = (v))
+#endif
+
+/**
+ * @brief Determines the COV flag of an object
+ * @param pObject - object data
+ * @return true if the COV flag is set
+ */
+static bool Binary_Value_Changed(const struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    return (Dense_Values.Flags[pObject->Dense_Slot] &
+            DENSE_VALUE_FLAG_CHANGED) != 0;
+#else
+    return pObject->Change_Of_Value;
+#endif
+}
+
+/**
+ * @brief Sets or clears the COV flag of an object
+ * @param pObject - object data
+ * @param value - true to set the COV flag, false to clear it
+ */
+static void Binary_Value_Changed_Set(struct object_data *pObject, bool value)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    if (value) {
+        Dense_Values.Flags[pObject->Dense_Slot] |=
+            DENSE_VALUE_FLAG_CHANGED;
+    } else {
+        Dense_Values.Flags[pObject->Dense_Slot] &=
+            (uint8_t)~DENSE_VALUE_FLAG_CHANGED;
+    }
+#else
+    pObject->Change_Of_Value = value;
+#endif
+}
+
+/**
+ * @brief Frees the data of an object
+ * @param pObject - object data
+ */
+static void Binary_Value_Object_Free(struct object_data *pObject)
+{
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_slot_free(&Dense_Values, pObject->Dense_Slot);
+#endif
+    BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+}
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_BINARY_VALUE;
 /* callback for present value writes */
@@ -139,6 +206,26 @@ static struct object_data *Binary_Value_Object(uint32_t object_instance)
     return Keylist_Data(Object_List, object_instance);
 }
 
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+/**
+ * @brief Updates the active event set of the GetEventInformation
+ *  and GetAlarmSummary services after an event state change or
+ *  an acknowledgment
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object to check for an active event
+ */
+static void Binary_Value_Event_Active_Update(
+    uint32_t object_instance, const struct object_data *pObject)
+{
+    handler_get_event_information_active_set(
+        Object_Type, object_instance,
+        (pObject->Event_State != EVENT_STATE_NORMAL) ||
+            !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+            !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+}
+#endif
+
 /**
  * @brief Determines if a given object instance is valid
  * @param  object_instance - object-instance number of the object
@@ -237,7 +324,7 @@ BACNET_BINARY_PV Binary_Value_Present_Value(uint32_t object_instance)
 
     pObject = Binary_Value_Object(object_instance);
     if (pObject) {
-        value = Binary_Present_Value(pObject->Present_Value);
+        value = Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject));
     }
 
     return value;
@@ -252,8 +339,8 @@ static void Binary_Value_Present_Value_COV_Detect(
     struct object_data *pObject, BACNET_BINARY_PV value)
 {
     if (pObject) {
-        if (Binary_Present_Value(pObject->Present_Value) != value) {
-            pObject->Change_Of_Value = true;
+        if (Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject)) != value) {
+            Binary_Value_Changed_Set(pObject, true);
         }
     }
 }
@@ -291,7 +378,7 @@ void Binary_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     pObject = Binary_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Change_Of_Value = true;
+            Binary_Value_Changed_Set(pObject, true);
         }
         pObject->Out_Of_Service = value;
     }
@@ -357,7 +444,7 @@ bool Binary_Value_Reliability_Set(
             fault = Binary_Value_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Binary_Value_Object_Fault(pObject)) {
-                pObject->Change_Of_Value = true;
+                Binary_Value_Changed_Set(pObject, true);
             }
             status = true;
         }
@@ -393,7 +480,7 @@ bool Binary_Value_Change_Of_Value(uint32_t object_instance)
 
     pObject = Binary_Value_Object(object_instance);
     if (pObject) {
-        status = pObject->Change_Of_Value;
+        status = Binary_Value_Changed(pObject);
     }
 
     return status;
@@ -409,7 +496,7 @@ void Binary_Value_Change_Of_Value_Clear(uint32_t object_instance)
 
     pObject = Binary_Value_Object(object_instance);
     if (pObject) {
-        pObject->Change_Of_Value = false;
+        Binary_Value_Changed_Set(pObject, false);
     }
 
     return;
@@ -439,7 +526,7 @@ bool Binary_Value_Encode_Value_List(
             fault = true;
         }
         out_of_service = pObject->Out_Of_Service;
-        if (pObject->Present_Value) {
+        if (OBJECT_PRESENT_VALUE(pObject)) {
             present_value = BINARY_ACTIVE;
         }
         status = cov_value_list_encode_enumerated(
@@ -466,7 +553,8 @@ bool Binary_Value_Present_Value_Set(
     if (pObject) {
         if (value <= MAX_BINARY_PV) {
             Binary_Value_Present_Value_COV_Detect(pObject, value);
-            pObject->Present_Value = Binary_Present_Value_Boolean(value);
+            OBJECT_PRESENT_VALUE_SET(
+                pObject, Binary_Present_Value_Boolean(value));
             status = true;
         }
     }
@@ -498,9 +586,11 @@ static bool Binary_Value_Present_Value_Write(
     if (pObject) {
         if (value <= MAX_BINARY_PV) {
             if (pObject->Write_Enabled) {
-                old_value = Binary_Present_Value(pObject->Present_Value);
+                old_value =
+                    Binary_Present_Value(OBJECT_PRESENT_VALUE(pObject));
                 Binary_Value_Present_Value_COV_Detect(pObject, value);
-                pObject->Present_Value = Binary_Present_Value_Boolean(value);
+                OBJECT_PRESENT_VALUE_SET(
+                    pObject, Binary_Present_Value_Boolean(value));
                 if (pObject->Out_Of_Service) {
                     /* The physical point that the object represents
                         is not in service. This means that changes to the
@@ -1247,19 +1337,27 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+            pObject->Dense_Slot =
+                dense_value_slot_alloc(&Dense_Values, object_instance);
+            if (pObject->Dense_Slot == DENSE_VALUE_SLOT_NONE) {
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+                return BACNET_MAX_INSTANCE;
+            }
+#endif
 #if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
             unsigned j;
 #endif
             pObject->Object_Name = NULL;
             pObject->Description = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
-            pObject->Present_Value = false;
+            OBJECT_PRESENT_VALUE_SET(pObject, false);
             pObject->Out_Of_Service = false;
             pObject->Active_Text = Default_Active_Text;
             pObject->Inactive_Text = Default_Inactive_Text;
-            pObject->Change_Of_Value = false;
+            Binary_Value_Changed_Set(pObject, false);
             pObject->Write_Enabled = false;
 #if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
             pObject->Event_State = EVENT_STATE_NORMAL;
@@ -1276,6 +1374,8 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
             /* Set handler for GetEventInformation function */
             handler_get_event_information_set(
                 Object_Type, Binary_Value_Event_Information);
+            handler_get_event_information_index_set(
+                Object_Type, Binary_Value_Instance_To_Index);
             /* Set handler for AcknowledgeAlarm function */
             handler_alarm_ack_set(Object_Type, Binary_Value_Alarm_Ack);
             /* Set handler for GetAlarmSummary Service */
@@ -1285,7 +1385,7 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                Binary_Value_Object_Free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1307,14 +1407,29 @@ void Binary_Value_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Binary_Value_Object_Free(pObject);
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    dense_value_table_cleanup(&Dense_Values);
+#endif
 }
 
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+/**
+ * @brief Gets the dense table of the Binary Value values scanned for COV.
+ *  The Instance column maps each slot in use back to its object.
+ * @return dense value table of the Binary Value objects
+ */
+const DENSE_VALUE_TABLE *Binary_Value_Dense_Values(void)
+{
+    return &Dense_Values;
+}
+#endif
+
 /**
  * Deletes a Binary Value object
  */
@@ -1325,13 +1440,43 @@ bool Binary_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
+        Binary_Value_Object_Free(pObject);
         status = true;
     }
 
     return status;
 }
 
+/**
+ * @brief Add the memory used by the Binary Value objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Binary_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Binary Value objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Binary_Value_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Binary Value object data
  */
@@ -1690,6 +1835,9 @@ int Binary_Value_Alarm_Ack(
     pObject->Ack_notify_data.bSendAckNotify = true;
     pObject->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
+    Binary_Value_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, pObject);
+
     return 1;
 }
 
@@ -2063,7 +2211,8 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
             event_data.notificationParams.changeOfState.newState =
                 (BACNET_PROPERTY_STATE) {
                     .tag = PROP_STATE_BINARY_VALUE,
-                    .state = { .binaryValue = pObject->Present_Value }
+                    .state = { .binaryValue = Binary_Present_Value(
+                                   OBJECT_PRESENT_VALUE(pObject)) }
                 };
             /* Status_Flags of the referenced object. */
             bitstring_init(
@@ -2129,6 +2278,7 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    Binary_Value_Event_Active_Update(object_instance, pObject);
 #endif /* defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING) \
         */
 }
@@ -17,6 +17,8 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #if (INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
@@ -41,6 +43,10 @@ extern "C" {
 
 BACNET_STACK_EXPORT
 void Binary_Value_Init(void);
+BACNET_STACK_EXPORT
+void Binary_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Binary_Value_List_Revision(void);
 
 BACNET_STACK_EXPORT
 void Binary_Value_Property_Lists(
@@ -133,6 +139,10 @@ BACNET_STACK_EXPORT
 bool Binary_Value_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Binary_Value_Cleanup(void);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+BACNET_STACK_EXPORT
+const DENSE_VALUE_TABLE *Binary_Value_Dense_Values(void);
+#endif
 
 BACNET_STACK_EXPORT
 unsigned Binary_Value_Event_State(uint32_t object_instance);
@@ -30,13 +30,17 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "calendar.h"
 
 struct object_data {
     bool Changed : 1;
     bool Write_Enabled : 1;
+    bool Present_Value_Valid : 1;
     bool Present_Value;
+    /* time remaining until the local date changes */
+    uint32_t Midnight_Milliseconds;
     OS_Keylist Date_List;
     const char *Object_Name;
     const char *Description;
@@ -47,6 +51,11 @@ static OS_Keylist Object_List;
 /* callback for present value writes */
 static calendar_write_present_value_callback
     Calendar_Write_Present_Value_Callback;
+/* callback for present value changes */
+static calendar_write_present_value_callback
+    Calendar_Present_Value_Change_Callback;
+/* the cached present-value is only used when a timer keeps it current */
+static bool Calendar_Timer_Running;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Calendar_Properties_Required[] = {
@@ -199,10 +208,9 @@ static bool Calendar_Present_Value_Write(
  */
 static void Calendar_Date_List_Clean(OS_Keylist list)
 {
-    void *data;
     while (Keylist_Count(list) > 0) {
-        data = Keylist_Data_Pop(list);
-        free(data);
+        BACNET_MEMPOOL_FREE(
+            Keylist_Data_Pop(list), sizeof(BACNET_CALENDAR_ENTRY));
     }
 }
 
@@ -223,6 +231,8 @@ Calendar_Date_List_Get(uint32_t object_instance, uint8_t index)
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         entry = Keylist_Data_Index(pObject->Date_List, index);
+        /* the entry may be modified through the returned pointer */
+        pObject->Present_Value_Valid = false;
     }
 
     return entry;
@@ -248,7 +258,7 @@ bool Calendar_Date_List_Add(
         return false;
     }
 
-    entry = calloc(1, sizeof(BACNET_CALENDAR_ENTRY));
+    entry = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_CALENDAR_ENTRY));
     if (!entry) {
         return false;
     }
@@ -256,9 +266,10 @@ bool Calendar_Date_List_Add(
     index = Keylist_Data_Add(
         pObject->Date_List, Keylist_Count(pObject->Date_List), entry);
     if (index < 0) {
-        free(entry);
+        BACNET_MEMPOOL_FREE(entry, sizeof(BACNET_CALENDAR_ENTRY));
         return false;
     }
+    pObject->Present_Value_Valid = false;
 
     return true;
 }
@@ -279,6 +290,7 @@ bool Calendar_Date_List_Delete_All(uint32_t object_instance)
     }
 
     Calendar_Date_List_Clean(pObject->Date_List);
+    pObject->Present_Value_Valid = false;
 
     return true;
 }
@@ -301,6 +313,31 @@ int Calendar_Date_List_Count(uint32_t object_instance)
     return Keylist_Count(pObject->Date_List);
 }
 
+/**
+ * @brief Encode one BACnetCalendarEntry of the Date_List
+ * @param object_instance [in] object-instance number of the object
+ * @param index [in] element index, 0 to N-1
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL to
+ *  return the length of buffer if it had been built
+ * @return The length of the apdu encoded, or BACNET_STATUS_ERROR
+ */
+static int Calendar_Date_List_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX index, uint8_t *apdu)
+{
+    BACNET_CALENDAR_ENTRY *entry = NULL;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        entry = Keylist_Data_Index(pObject->Date_List, index);
+    }
+    if (!entry) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return bacnet_calendar_entry_encode(apdu, entry);
+}
+
 /**
  * @brief Encode a Calendar entity list complex data type
  *
@@ -308,35 +345,80 @@ int Calendar_Date_List_Count(uint32_t object_instance)
  * @param apdu - the APDU buffer
  * @param apdu_size - size of the apdu buffer.
  *
- * @return bytes encoded or zero on error.
+ * @return bytes encoded or zero on error, or BACNET_STATUS_ABORT
+ *  if the list does not fit
  */
 int Calendar_Date_List_Encode(
     uint32_t object_instance, uint8_t *apdu, int max_apdu)
 {
-    BACNET_CALENDAR_ENTRY *entry = NULL;
-    int apdu_len = 0;
+    BACNET_ARRAY_STREAM stream;
     unsigned index = 0;
     unsigned size = 0;
+    struct object_data *pObject;
+    int apdu_len;
 
-    size = Calendar_Date_List_Count(object_instance);
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+    size = Keylist_Count(pObject->Date_List);
+    bacnet_array_stream_begin(
+        &stream, apdu, (max_apdu > 0) ? (uint32_t)max_apdu : 0);
     for (index = 0; index < size; index++) {
-        entry = Calendar_Date_List_Get(object_instance, index);
-        apdu_len += bacnet_calendar_entry_encode(NULL, entry);
+        if (!bacnet_array_stream_next(
+                &stream, Calendar_Date_List_Element_Encode, object_instance,
+                index)) {
+            break;
+        }
+    }
+    apdu_len = bacnet_array_stream_end(&stream);
+    if (apdu_len == BACNET_STATUS_ERROR) {
+        apdu_len = 0;
     }
-    if (apdu_len > max_apdu) {
-        return BACNET_STATUS_ABORT;
+
+    return apdu_len;
+}
+
+/**
+ * @brief Evaluate the Date_List against the local date, and note the
+ *  time remaining until the local date changes
+ * @param  pObject - object to evaluate
+ * @return  true if the local date is in the Date_List
+ */
+static bool Calendar_Date_List_Evaluate(struct object_data *pObject)
+{
+    BACNET_DATE date = { 0 };
+    BACNET_TIME time = { 0 };
+    BACNET_CALENDAR_ENTRY *entry = NULL;
+    unsigned size = 0;
+    unsigned index;
+    uint32_t seconds;
+    bool value = false;
+
+    datetime_local(&date, &time, NULL, NULL);
+    seconds = datetime_seconds_since_midnight(&time);
+    if (seconds < 86400UL) {
+        pObject->Midnight_Milliseconds =
+            ((86400UL - seconds) * 1000UL) - (time.hundredths * 10UL);
+    } else {
+        pObject->Midnight_Milliseconds = 0;
     }
-    apdu_len = 0;
+    size = Keylist_Count(pObject->Date_List);
     for (index = 0; index < size; index++) {
-        entry = Calendar_Date_List_Get(object_instance, index);
-        apdu_len += bacnet_calendar_entry_encode(&apdu[apdu_len], entry);
+        entry = Keylist_Data_Index(pObject->Date_List, index);
+        if (bacapp_date_in_calendar_entry(&date, entry)) {
+            value = true;
+            break;
+        }
     }
 
-    return apdu_len;
+    return value;
 }
 
 /**
- * For a given object instance-number, determines the present-value
+ * For a given object instance-number, determines the present-value.
+ * While Calendar_Timer() is running, the present-value is cached until
+ * the local date changes or the Date_List is modified.
  *
  * @param  object_instance - object-instance number of the object
  *
@@ -344,23 +426,50 @@ int Calendar_Date_List_Encode(
  */
 bool Calendar_Present_Value(uint32_t object_instance)
 {
-    BACNET_DATE date;
-    BACNET_TIME time;
-    BACNET_CALENDAR_ENTRY *entry = NULL;
-    unsigned size = 0;
-    int index;
-
-    datetime_local(&date, &time, NULL, NULL);
+    struct object_data *pObject;
+    bool old_value;
 
-    size = Calendar_Date_List_Count(object_instance);
-    for (index = 0; index < size; index++) {
-        entry = Calendar_Date_List_Get(object_instance, index);
-        if (bacapp_date_in_calendar_entry(&date, entry)) {
-            return true;
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    if (!pObject->Present_Value_Valid || !Calendar_Timer_Running) {
+        old_value = pObject->Present_Value;
+        pObject->Present_Value = Calendar_Date_List_Evaluate(pObject);
+        pObject->Present_Value_Valid = true;
+        if ((old_value != pObject->Present_Value) &&
+            Calendar_Present_Value_Change_Callback) {
+            Calendar_Present_Value_Change_Callback(
+                object_instance, old_value, pObject->Present_Value);
         }
     }
 
-    return false;
+    return pObject->Present_Value;
+}
+
+/**
+ * @brief Updates the object present-value when the local date changes
+ * @param object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed since previously
+ *  called.  Suggest that this is called every 1000 milliseconds.
+ */
+void Calendar_Timer(uint32_t object_instance, uint16_t milliseconds)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return;
+    }
+    Calendar_Timer_Running = true;
+    if (pObject->Present_Value_Valid) {
+        if (pObject->Midnight_Milliseconds > milliseconds) {
+            pObject->Midnight_Milliseconds -= milliseconds;
+            return;
+        }
+        pObject->Present_Value_Valid = false;
+    }
+    (void)Calendar_Present_Value(object_instance);
 }
 
 /**
@@ -624,6 +733,17 @@ void Calendar_Write_Present_Value_Callback_Set(
     Calendar_Write_Present_Value_Callback = cb;
 }
 
+/**
+ * @brief Sets a callback used when the present-value changes, either
+ *  from a change of the local date or a change of the Date_List
+ * @param cb - callback used to provide indications
+ */
+void Calendar_Present_Value_Change_Callback_Set(
+    calendar_write_present_value_callback cb)
+{
+    Calendar_Present_Value_Change_Callback = cb;
+}
+
 /**
  * @brief Determines a object write-enabled flag state
  * @param object_instance - object-instance number of the object
@@ -727,7 +847,7 @@ uint32_t Calendar_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (!pObject) {
             return BACNET_MAX_INSTANCE;
         }
@@ -740,7 +860,7 @@ uint32_t Calendar_Create(uint32_t object_instance)
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
-            free(pObject);
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             return BACNET_MAX_INSTANCE;
         }
     }
@@ -762,7 +882,7 @@ bool Calendar_Delete(uint32_t object_instance)
     if (pObject) {
         Calendar_Date_List_Clean(pObject->Date_List);
         Keylist_Delete(pObject->Date_List);
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -782,7 +902,7 @@ void Calendar_Cleanup(void)
             if (pObject) {
                 Calendar_Date_List_Clean(pObject->Date_List);
                 Keylist_Delete(pObject->Date_List);
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -790,6 +910,32 @@ void Calendar_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Calendar objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Calendar_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Calendar objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Calendar_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Calendar object data
  */
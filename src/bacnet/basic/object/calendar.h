@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -64,6 +65,11 @@ bool Calendar_Present_Value(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Calendar_Write_Present_Value_Callback_Set(
     calendar_write_present_value_callback cb);
+BACNET_STACK_EXPORT
+void Calendar_Present_Value_Change_Callback_Set(
+    calendar_write_present_value_callback cb);
+BACNET_STACK_EXPORT
+void Calendar_Timer(uint32_t object_instance, uint16_t milliseconds);
 
 BACNET_STACK_EXPORT
 BACNET_CALENDAR_ENTRY *
@@ -104,6 +110,10 @@ BACNET_STACK_EXPORT
 void Calendar_Cleanup(void);
 BACNET_STACK_EXPORT
 void Calendar_Init(void);
+BACNET_STACK_EXPORT
+void Calendar_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Calendar_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,7 @@
 #include "bacnet/bactext.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #if defined(CHANNEL_LIGHTING_COMMAND) || defined(CHANNEL_COLOR_COMMAND)
 #include "bacnet/lighting.h"
 #endif
@@ -565,6 +566,94 @@ static int Channel_Control_Groups_Element_Encode(
     return apdu_len;
 }
 
+/**
+ * @brief Determine the datatype a channel value is coerced into for a member
+ * @param object_type - object type of the member
+ * @param object_property - property identifier of the member
+ * @param array_index - array index of the member
+ * @return application tag of the coerced datatype, or
+ *  MAX_BACNET_APPLICATION_TAG when the value is written without coercion
+ */
+static BACNET_APPLICATION_TAG Channel_Member_Coerce_Tag(
+    BACNET_OBJECT_TYPE object_type,
+    BACNET_PROPERTY_ID object_property,
+    BACNET_ARRAY_INDEX array_index)
+{
+    if (array_index != BACNET_ARRAY_ALL) {
+        return MAX_BACNET_APPLICATION_TAG;
+    }
+    switch (object_type) {
+        case OBJECT_ANALOG_OUTPUT:
+        case OBJECT_ANALOG_VALUE:
+        case OBJECT_LIGHTING_OUTPUT:
+            if ((object_property == PROP_PRESENT_VALUE) ||
+                (object_property == PROP_RELINQUISH_DEFAULT)) {
+                return BACNET_APPLICATION_TAG_REAL;
+            }
+            break;
+        case OBJECT_BINARY_OUTPUT:
+        case OBJECT_BINARY_VALUE:
+            if ((object_property == PROP_PRESENT_VALUE) ||
+                (object_property == PROP_RELINQUISH_DEFAULT)) {
+                return BACNET_APPLICATION_TAG_ENUMERATED;
+            }
+            break;
+        case OBJECT_MULTI_STATE_OUTPUT:
+        case OBJECT_MULTI_STATE_VALUE:
+            if ((object_property == PROP_PRESENT_VALUE) ||
+                (object_property == PROP_RELINQUISH_DEFAULT)) {
+                return BACNET_APPLICATION_TAG_UNSIGNED_INT;
+            }
+            break;
+        case OBJECT_COLOR:
+            if ((object_property == PROP_PRESENT_VALUE) ||
+                (object_property == PROP_DEFAULT_COLOR)) {
+                return BACNET_APPLICATION_TAG_XY_COLOR;
+            }
+            break;
+        case OBJECT_COLOR_TEMPERATURE:
+            if ((object_property == PROP_PRESENT_VALUE) ||
+                (object_property == PROP_DEFAULT_COLOR_TEMPERATURE)) {
+                return BACNET_APPLICATION_TAG_UNSIGNED_INT;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return MAX_BACNET_APPLICATION_TAG;
+}
+
+/**
+ * @brief Encode a channel value coerced into a given datatype
+ * @param apdu - buffer to hold the encoding
+ * @param apdu_size - size of the buffer
+ * @param value - BACnetChannelValue
+ * @param tag - coerced datatype, or MAX_BACNET_APPLICATION_TAG for none
+ * @return number of bytes encoded, or zero or less on failure
+ */
+static int Channel_Member_Value_Encode(
+    uint8_t *apdu,
+    size_t apdu_size,
+    const BACNET_CHANNEL_VALUE *value,
+    BACNET_APPLICATION_TAG tag)
+{
+    int apdu_len;
+
+    if (tag == MAX_BACNET_APPLICATION_TAG) {
+        apdu_len =
+            bacnet_channel_value_no_coerce_encode(apdu, apdu_size, value);
+    } else {
+        apdu_len = bacnet_channel_value_coerce_data_encode(
+            apdu, apdu_size, value, tag);
+        if (apdu_len == BACNET_STATUS_ERROR) {
+            apdu_len = 0;
+        }
+    }
+
+    return apdu_len;
+}
+
 /**
  * For a given object instance-number, sets the present-value at a given
  * priority 1..16.
@@ -581,104 +670,78 @@ bool Channel_Write_Member_Value(
     int apdu_len = 0;
 
     if (wp_data && value) {
-        if (((wp_data->object_type == OBJECT_ANALOG_OUTPUT) ||
-             (wp_data->object_type == OBJECT_ANALOG_VALUE)) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_RELINQUISH_DEFAULT)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_REAL);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else if (
-            ((wp_data->object_type == OBJECT_BINARY_OUTPUT) ||
-             (wp_data->object_type == OBJECT_BINARY_VALUE)) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_RELINQUISH_DEFAULT)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_ENUMERATED);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else if (
-            ((wp_data->object_type == OBJECT_MULTI_STATE_OUTPUT) ||
-             (wp_data->object_type == OBJECT_MULTI_STATE_VALUE)) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_RELINQUISH_DEFAULT)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_UNSIGNED_INT);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else if (
-            (wp_data->object_type == OBJECT_LIGHTING_OUTPUT) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_RELINQUISH_DEFAULT)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_REAL);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else if (
-            (wp_data->object_type == OBJECT_COLOR) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_DEFAULT_COLOR)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_XY_COLOR);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else if (
-            (wp_data->object_type == OBJECT_COLOR_TEMPERATURE) &&
-            ((wp_data->object_property == PROP_PRESENT_VALUE) ||
-             (wp_data->object_property == PROP_DEFAULT_COLOR_TEMPERATURE)) &&
-            (wp_data->array_index == BACNET_ARRAY_ALL)) {
-            apdu_len = bacnet_channel_value_coerce_data_encode(
-                wp_data->application_data, wp_data->application_data_len, value,
-                BACNET_APPLICATION_TAG_UNSIGNED_INT);
-            if (apdu_len != BACNET_STATUS_ERROR) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
-        } else {
-            /* no coercion */
-            apdu_len = bacnet_channel_value_no_coerce_encode(
-                wp_data->application_data, wp_data->application_data_len,
-                value);
-            if (apdu_len > 0) {
-                wp_data->application_data_len = apdu_len;
-                status = true;
-            }
+        apdu_len = Channel_Member_Value_Encode(
+            wp_data->application_data, wp_data->application_data_len, value,
+            Channel_Member_Coerce_Tag(
+                wp_data->object_type, wp_data->object_property,
+                wp_data->array_index));
+        if (apdu_len > 0) {
+            wp_data->application_data_len = apdu_len;
+            status = true;
         }
     }
 
     return status;
 }
 
+/**
+ * @brief Compare two members for the batched write order: by coerced
+ *  datatype, then by object type, instance, property and array index
+ * @param tag1 - coerced datatype of the first member
+ * @param member1 - first member
+ * @param tag2 - coerced datatype of the second member
+ * @param member2 - second member
+ * @return negative, zero, or positive like memcmp
+ */
+static int Channel_Member_Compare(
+    BACNET_APPLICATION_TAG tag1,
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *member1,
+    BACNET_APPLICATION_TAG tag2,
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *member2)
+{
+    if (tag1 != tag2) {
+        return (tag1 < tag2) ? -1 : 1;
+    }
+    if (member1->objectIdentifier.type != member2->objectIdentifier.type) {
+        return (member1->objectIdentifier.type <
+                member2->objectIdentifier.type)
+            ? -1
+            : 1;
+    }
+    if (member1->objectIdentifier.instance !=
+        member2->objectIdentifier.instance) {
+        return (member1->objectIdentifier.instance <
+                member2->objectIdentifier.instance)
+            ? -1
+            : 1;
+    }
+    if (member1->propertyIdentifier != member2->propertyIdentifier) {
+        return (member1->propertyIdentifier < member2->propertyIdentifier)
+            ? -1
+            : 1;
+    }
+    if (member1->arrayIndex != member2->arrayIndex) {
+        return (member1->arrayIndex < member2->arrayIndex) ? -1 : 1;
+    }
+
+    return 0;
+}
+
 /**
  * For a given object instance-number, sets the present-value at a given
  * priority 1..16.
  *
+ * The members are written as one batch: valid members are ordered by
+ * coerced datatype and object, duplicate member references are written
+ * once, and the channel value is coerced and encoded once per datatype
+ * rather than once per member.
+ *
  * @param pObject - object instance data
  * @param value - application value
  * @param priority - BACnet priority 0=none,1..16
  *
- * @return  true if values are within range and present-value is sent.
+ * @return  true if the value was sent to at least one member;
+ *  failed members are reflected in the Write_Status property.
  */
 static bool Channel_Write_Members(
     struct object_data *pObject,
@@ -687,8 +750,13 @@ static bool Channel_Write_Members(
     uint8_t priority)
 {
     BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_APPLICATION_TAG tags[CHANNEL_MEMBERS_MAX];
+    BACNET_APPLICATION_TAG tag = MAX_BACNET_APPLICATION_TAG;
+    uint8_t order[CHANNEL_MEMBERS_MAX];
+    unsigned count = 0, i = 0, j = 0, m = 0;
+    int apdu_len = 0;
+    int compare = 0;
     bool status = false;
-    unsigned m = 0;
     const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember = NULL;
 
     if (pObject && value) {
@@ -696,7 +764,6 @@ static bool Channel_Write_Members(
         debug_printf(
             "channel[%lu].Channel_Write_Members\n",
             (unsigned long)object_instance);
-
         for (m = 0; m < CHANNEL_MEMBERS_MAX; m++) {
             pMember = &pObject->Members[m];
             /* NOTE: our implementation is for internal objects only */
@@ -704,44 +771,78 @@ static bool Channel_Write_Members(
                we would need to update all channels when our device ID
                changed.  Instead, we'll just screen when members are
                set. */
-            if ((pMember->deviceIdentifier.type == OBJECT_DEVICE) &&
-                (pMember->deviceIdentifier.instance != BACNET_MAX_INSTANCE) &&
-                (pMember->objectIdentifier.instance != BACNET_MAX_INSTANCE)) {
-                wp_data.object_type = pMember->objectIdentifier.type;
-                wp_data.object_instance = pMember->objectIdentifier.instance;
-                wp_data.object_property = pMember->propertyIdentifier;
-                wp_data.array_index = pMember->arrayIndex;
-                wp_data.error_class = ERROR_CLASS_PROPERTY;
-                wp_data.error_code = ERROR_CODE_SUCCESS;
-                wp_data.priority = priority;
-                wp_data.application_data_len = sizeof(wp_data.application_data);
-                status = Channel_Write_Member_Value(&wp_data, value);
-                if (status) {
-                    debug_printf(
-                        "channel[%lu].Channel_Write_Member[%u] coerced\n",
-                        (unsigned long)object_instance, m);
-                    if (Write_Property_Internal_Callback) {
-                        status = Write_Property_Internal_Callback(&wp_data);
-                        if (status) {
-                            wp_data.error_code = ERROR_CODE_SUCCESS;
-                        }
-                        debug_printf(
-                            "channel[%lu].Channel_Write_Member[%u] "
-                            "%s\n",
-                            (unsigned long)object_instance, m,
-                            bactext_error_code_name(wp_data.error_code));
-                    }
-                } else {
-                    debug_printf(
-                        "channel[%lu].Channel_Write_Member[%u] "
-                        "coercion failed!\n",
-                        (unsigned long)object_instance, m);
-                    pObject->Write_Status = BACNET_WRITE_STATUS_FAILED;
-                }
-            } else {
+            if ((pMember->deviceIdentifier.type != OBJECT_DEVICE) ||
+                (pMember->deviceIdentifier.instance == BACNET_MAX_INSTANCE) ||
+                (pMember->objectIdentifier.instance == BACNET_MAX_INSTANCE)) {
                 debug_printf(
                     "channel[%lu].Channel_Write_Member[%u] invalid!\n",
                     (unsigned long)object_instance, m);
+                continue;
+            }
+            tags[m] = Channel_Member_Coerce_Tag(
+                pMember->objectIdentifier.type, pMember->propertyIdentifier,
+                pMember->arrayIndex);
+            /* insertion sort - the member list is short */
+            compare = 1;
+            for (i = count; i > 0; i--) {
+                compare = Channel_Member_Compare(
+                    tags[order[i - 1]], &pObject->Members[order[i - 1]],
+                    tags[m], pMember);
+                if (compare <= 0) {
+                    break;
+                }
+            }
+            if ((i > 0) && (compare == 0)) {
+                /* duplicate member reference: write it once */
+                continue;
+            }
+            for (j = count; j > i; j--) {
+                order[j] = order[j - 1];
+            }
+            order[i] = (uint8_t)m;
+            count++;
+        }
+        for (i = 0; i < count; i++) {
+            m = order[i];
+            pMember = &pObject->Members[m];
+            if ((i == 0) || (tags[m] != tag)) {
+                /* coerce and encode once per datatype */
+                tag = tags[m];
+                apdu_len = Channel_Member_Value_Encode(
+                    wp_data.application_data,
+                    sizeof(wp_data.application_data), value, tag);
+            }
+            if (apdu_len <= 0) {
+                debug_printf(
+                    "channel[%lu].Channel_Write_Member[%u] "
+                    "coercion failed!\n",
+                    (unsigned long)object_instance, m);
+                pObject->Write_Status = BACNET_WRITE_STATUS_FAILED;
+                continue;
+            }
+            debug_printf(
+                "channel[%lu].Channel_Write_Member[%u] coerced\n",
+                (unsigned long)object_instance, m);
+            wp_data.object_type = pMember->objectIdentifier.type;
+            wp_data.object_instance = pMember->objectIdentifier.instance;
+            wp_data.object_property = pMember->propertyIdentifier;
+            wp_data.array_index = pMember->arrayIndex;
+            wp_data.error_class = ERROR_CLASS_PROPERTY;
+            wp_data.error_code = ERROR_CODE_SUCCESS;
+            wp_data.priority = priority;
+            wp_data.application_data_len = apdu_len;
+            if (Write_Property_Internal_Callback) {
+                if (Write_Property_Internal_Callback(&wp_data)) {
+                    wp_data.error_code = ERROR_CODE_SUCCESS;
+                    status = true;
+                }
+                debug_printf(
+                    "channel[%lu].Channel_Write_Member[%u] "
+                    "%s\n",
+                    (unsigned long)object_instance, m,
+                    bactext_error_code_name(wp_data.error_code));
+            } else {
+                status = true;
             }
         }
         if (pObject->Write_Status == BACNET_WRITE_STATUS_IN_PROGRESS) {
@@ -1436,7 +1537,7 @@ uint32_t Channel_Create(uint32_t object_instance)
 
     pObject = Object_Data(object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             /* channel defaults */
             pObject->Object_Name = NULL;
@@ -1454,7 +1555,7 @@ uint32_t Channel_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1477,7 +1578,7 @@ bool Channel_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1495,7 +1596,7 @@ void Channel_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1503,6 +1604,32 @@ void Channel_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Channel objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Channel_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Channel objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Channel_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object data
  */
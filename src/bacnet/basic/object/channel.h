@@ -18,6 +18,7 @@
 #include "bacnet/write_group.h"
 #include "bacnet/basic/object/lo.h"
 #include "bacnet/channel_value.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -118,6 +119,10 @@ BACNET_STACK_EXPORT
 void Channel_Cleanup(void);
 BACNET_STACK_EXPORT
 void Channel_Init(void);
+BACNET_STACK_EXPORT
+void Channel_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Channel_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -29,7 +29,8 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
-#include "bacnet/basic/sys/linear.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/lighting_command.h"
 /* me! */
 #include "bacnet/basic/object/color_object.h"
 
@@ -53,6 +54,8 @@ struct object_data {
     uint32_t Default_Fade_Time;
     /* The transition may be NONE or FADE. */
     BACNET_COLOR_TRANSITION Transition;
+    /* active while the color command is in progress */
+    struct lighting_command_transition Transition_Timer;
     const char *Object_Name;
     const char *Description;
     void *Context;
@@ -243,6 +246,7 @@ static bool Color_Present_Value_Write(
         }
         pObject->Color_Command.operation = BACNET_COLOR_OPERATION_FADE_TO_COLOR;
         xy_color_copy(&pObject->Color_Command.target.color, value);
+        lighting_command_transition_start(&pObject->Transition_Timer);
         status = true;
     } else {
         *error_class = ERROR_CLASS_OBJECT;
@@ -333,6 +337,7 @@ bool Color_Command_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && value) {
         color_command_copy(&pObject->Color_Command, value);
+        lighting_command_transition_start(&pObject->Transition_Timer);
         status = true;
     }
 
@@ -365,6 +370,7 @@ static bool Color_Command_Write(
         (void)priority;
         if (pObject->Write_Enabled) {
             color_command_copy(&pObject->Color_Command, value);
+            lighting_command_transition_start(&pObject->Transition_Timer);
             status = true;
         } else {
             *error_class = ERROR_CLASS_PROPERTY;
@@ -821,7 +827,7 @@ Color_Fade_To_Color_Handler(uint32_t object_instance, uint16_t milliseconds)
 {
     BACNET_XY_COLOR old_value;
     struct object_data *pObject;
-    float x1, x2, x3, y1, y3;
+    uint32_t fade_time;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
@@ -845,17 +851,21 @@ Color_Fade_To_Color_Handler(uint32_t object_instance, uint16_t milliseconds)
             pObject->Color_Command.transit.fade_time = 0;
         } else {
             /* fading */
-            x1 = 0.0f;
-            x2 = (float)milliseconds;
-            x3 = (float)pObject->Color_Command.transit.fade_time;
-            y1 = old_value.x_coordinate;
-            y3 = pObject->Color_Command.target.color.x_coordinate;
+            fade_time = pObject->Color_Command.transit.fade_time;
             pObject->Tracking_Value.x_coordinate =
-                linear_interpolate(x1, x2, x3, y1, y3);
-            y1 = old_value.y_coordinate;
-            y3 = pObject->Color_Command.target.color.y_coordinate;
+                lighting_command_fixed_to_float(
+                    lighting_command_fixed_interpolate(
+                        lighting_command_fixed(old_value.x_coordinate),
+                        lighting_command_fixed(
+                            pObject->Color_Command.target.color.x_coordinate),
+                        milliseconds, fade_time));
             pObject->Tracking_Value.y_coordinate =
-                linear_interpolate(x1, x2, x3, y1, y3);
+                lighting_command_fixed_to_float(
+                    lighting_command_fixed_interpolate(
+                        lighting_command_fixed(old_value.y_coordinate),
+                        lighting_command_fixed(
+                            pObject->Color_Command.target.color.y_coordinate),
+                        milliseconds, fade_time));
             pObject->Color_Command.transit.fade_time -= milliseconds;
             pObject->In_Progress =
                 BACNET_COLOR_OPERATION_IN_PROGRESS_FADE_ACTIVE;
@@ -870,6 +880,8 @@ Color_Fade_To_Color_Handler(uint32_t object_instance, uint16_t milliseconds)
 /**
  * Updates the color object tracking value per ramp or fade
  *
+ * @note lighting_command_transition_task() updates all the objects with
+ *  a color command in progress, and is used instead of this function.
  * @param  object_instance - object-instance number of the object
  * @param milliseconds - number of milliseconds elapsed
  */
@@ -895,6 +907,28 @@ void Color_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * @brief Steps the color command of an object from the
+ *  lighting command transition task
+ * @param  object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed
+ * @return true while the color command is in progress
+ */
+static bool
+Color_Transition_Callback(uint32_t object_instance, uint16_t milliseconds)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    Color_Timer(object_instance, milliseconds);
+
+    return pObject->Color_Command.operation ==
+        BACNET_COLOR_OPERATION_FADE_TO_COLOR;
+}
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -1192,7 +1226,7 @@ uint32_t Color_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             /* color defaults */
@@ -1212,12 +1246,15 @@ uint32_t Color_Create(uint32_t object_instance)
             pObject->Transition = BACNET_COLOR_TRANSITION_FADE;
             pObject->Changed = false;
             pObject->Write_Enabled = false;
+            pObject->Transition_Timer.key = object_instance;
+            pObject->Transition_Timer.callback = Color_Transition_Callback;
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
+            lighting_command_transition_start(&pObject->Transition_Timer);
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1238,7 +1275,8 @@ bool Color_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        lighting_command_transition_stop(&pObject->Transition_Timer);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1256,7 +1294,8 @@ void Color_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                lighting_command_transition_stop(&pObject->Transition_Timer);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1264,6 +1303,32 @@ void Color_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Color objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Color_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Color objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Color_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Color object data
  */
@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for tracking value
@@ -133,6 +134,10 @@ BACNET_STACK_EXPORT
 void Color_Cleanup(void);
 BACNET_STACK_EXPORT
 void Color_Init(void);
+BACNET_STACK_EXPORT
+void Color_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Color_List_Revision(void);
 
 #ifdef __cplusplus
 }
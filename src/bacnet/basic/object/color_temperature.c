@@ -28,6 +28,8 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/lighting_command.h"
 #include "bacnet/basic/sys/linear.h"
 /* me! */
 #include "color_temperature.h"
@@ -46,6 +48,8 @@ struct object_data {
     BACNET_COLOR_TRANSITION Transition;
     uint32_t Present_Value_Minimum;
     uint32_t Present_Value_Maximum;
+    /* active while the color command is in progress */
+    struct lighting_command_transition Transition_Timer;
     const char *Object_Name;
     const char *Description;
     void *Context;
@@ -254,6 +258,7 @@ static bool Color_Temperature_Present_Value_Write(
                     BACNET_COLOR_OPERATION_FADE_TO_CCT;
             }
             pObject->Color_Command.target.color_temperature = value;
+            lighting_command_transition_start(&pObject->Transition_Timer);
             status = true;
         } else {
             *error_class = ERROR_CLASS_PROPERTY;
@@ -432,6 +437,7 @@ bool Color_Temperature_Command_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && value) {
         color_command_copy(&pObject->Color_Command, value);
+        lighting_command_transition_start(&pObject->Transition_Timer);
         status = true;
     }
 
@@ -1093,9 +1099,9 @@ static void Color_Temperature_Fade_To_CCT_Handler(
             pObject->Color_Command.transit.fade_time = 0;
         } else {
             /* fading */
-            pObject->Tracking_Value = linear_interpolate_int(
-                0, milliseconds, pObject->Color_Command.transit.fade_time,
-                old_value, target_value);
+            pObject->Tracking_Value = lighting_command_fixed_interpolate(
+                old_value, target_value, milliseconds,
+                pObject->Color_Command.transit.fade_time);
             pObject->Color_Command.transit.fade_time -= milliseconds;
             pObject->In_Progress =
                 BACNET_COLOR_OPERATION_IN_PROGRESS_FADE_ACTIVE;
@@ -1269,6 +1275,8 @@ static void Color_Temperature_Step_Down_CCT_Handler(uint32_t object_instance)
 /**
  * Updates the color temperature tracking value per ramp or fade
  *
+ * @note lighting_command_transition_task() updates all the objects with
+ *  a color command in progress, and is used instead of this function.
  * @param  object_instance - object-instance number of the object
  * @param milliseconds - number of milliseconds elapsed
  */
@@ -1302,6 +1310,31 @@ void Color_Temperature_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * @brief Steps the color command of an object from the
+ *  lighting command transition task
+ * @note The step operations are only performed once.
+ * @param  object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed
+ * @return true while the color command is in progress
+ */
+static bool Color_Temperature_Transition_Callback(
+    uint32_t object_instance, uint16_t milliseconds)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    Color_Temperature_Timer(object_instance, milliseconds);
+
+    return (pObject->Color_Command.operation ==
+            BACNET_COLOR_OPERATION_FADE_TO_CCT) ||
+        (pObject->Color_Command.operation ==
+         BACNET_COLOR_OPERATION_RAMP_TO_CCT);
+}
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -1635,7 +1668,7 @@ uint32_t Color_Temperature_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->Present_Value = 0;
@@ -1657,12 +1690,16 @@ uint32_t Color_Temperature_Create(uint32_t object_instance)
                 pObject->Default_Color_Temperature;
             pObject->Changed = false;
             pObject->Write_Enabled = false;
+            pObject->Transition_Timer.key = object_instance;
+            pObject->Transition_Timer.callback =
+                Color_Temperature_Transition_Callback;
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
+            lighting_command_transition_start(&pObject->Transition_Timer);
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1683,7 +1720,8 @@ bool Color_Temperature_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        lighting_command_transition_stop(&pObject->Transition_Timer);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1701,7 +1739,8 @@ void Color_Temperature_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                lighting_command_transition_stop(&pObject->Transition_Timer);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1709,6 +1748,32 @@ void Color_Temperature_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Color Temperature objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Color_Temperature_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Color Temperature objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Color_Temperature_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Color object data
  */
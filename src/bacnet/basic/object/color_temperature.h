@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for write present value request
@@ -156,6 +157,10 @@ BACNET_STACK_EXPORT
 void Color_Temperature_Cleanup(void);
 BACNET_STACK_EXPORT
 void Color_Temperature_Init(void);
+BACNET_STACK_EXPORT
+void Color_Temperature_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Color_Temperature_List_Revision(void);
 
 #ifdef __cplusplus
 }
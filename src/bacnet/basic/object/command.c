@@ -17,6 +17,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -28,11 +30,61 @@
 #include "bacnet/proplist.h"
 #include "bacnet/timestamp.h"
 #include "bacnet/basic/services.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me!*/
 #include "bacnet/basic/object/command.h"
 
 static COMMAND_DESCR Command_Descr[MAX_COMMANDS];
 
+/* largest application encoded BACnetActionCommand property value */
+#define COMMAND_ACTION_VALUE_SIZE 16
+
+/* an action that writes to an object of another device */
+struct command_remote_write {
+    uint32_t device_instance;
+    BACNET_WRITE_ACCESS_DATA write_access_data;
+    BACNET_PROPERTY_VALUE property_value;
+};
+
+/* one action of a precompiled action list */
+struct command_action_step {
+    BACNET_ACTION_LIST *entry;
+    /* direct accessor of a local REAL property, or NULL */
+    const LOOP_REAL_ACCESSOR *accessor;
+    /* write to another device, or NULL for a local object */
+    struct command_remote_write *remote;
+    /* number of steps written together from this step - remote writes
+       to the same device are linked into one WritePropertyMultiple */
+    unsigned batch_count;
+    uint8_t application_data[COMMAND_ACTION_VALUE_SIZE];
+    int application_data_len;
+};
+
+/* action list with its objects resolved and its values encoded once,
+   rebuilt the first time it is executed after it has changed */
+struct command_action_plan {
+    struct command_action_step *step;
+    unsigned count;
+    /* number of steps allocated */
+    unsigned size;
+    bool valid;
+};
+
+struct command_state {
+    struct command_action_plan Plan[MAX_COMMAND_ACTIONS];
+    /* action list in process 1..MAX_COMMAND_ACTIONS, and its next step */
+    uint32_t Action;
+    unsigned Step;
+    /* milliseconds until the next step is executed */
+    uint32_t Post_Delay;
+};
+static struct command_state Command_State[MAX_COMMANDS];
+static write_property_function Write_Property_Internal_Callback;
+static loop_real_accessor_function Real_Accessor_Callback;
+static command_write_property_multiple_function
+    Write_Property_Multiple_Callback;
+
 /* clang-format off */
 /* These arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Command_Properties_Required[] = {
@@ -79,6 +131,21 @@ void Command_Property_Lists(
     return;
 }
 
+/**
+ * @brief Marks every action list as changed, so that its plan is rebuilt
+ *  the next time that it is executed
+ */
+static void Command_Action_Plans_Invalidate(void)
+{
+    unsigned i, j;
+
+    for (i = 0; i < MAX_COMMANDS; i++) {
+        for (j = 0; j < MAX_COMMAND_ACTIONS; j++) {
+            Command_State[i].Plan[j].valid = false;
+        }
+    }
+}
+
 /**
  * Initializes the Command object data
  */
@@ -89,7 +156,11 @@ void Command_Init(void)
         Command_Descr[i].Present_Value = 0;
         Command_Descr[i].In_Process = false;
         Command_Descr[i].All_Writes_Successful = true; /* Optimistic default */
+        Command_State[i].Action = 0;
+        Command_State[i].Step = 0;
+        Command_State[i].Post_Delay = 0;
     }
+    Command_Action_Plans_Invalidate();
 }
 
 /**
@@ -327,6 +398,15 @@ static COMMAND_DESCR *Object_Data(uint32_t object_instance)
     return NULL;
 }
 
+/**
+ * @brief For a given object instance-number, returns an action list
+ * @note The action list is expected to be changed through the returned
+ *  pointer, so its plan is rebuilt the next time that it is executed.
+ * @param instance - object-instance number of the object
+ * @param index - action list 0..MAX_COMMAND_ACTIONS-1, which is executed
+ *  when index + 1 is written to the present-value
+ * @return the first action of the list, or NULL if not found
+ */
 BACNET_ACTION_LIST *Command_Action_List_Entry(uint32_t instance, unsigned index)
 {
     COMMAND_DESCR *pObject;
@@ -335,6 +415,8 @@ BACNET_ACTION_LIST *Command_Action_List_Entry(uint32_t instance, unsigned index)
     pObject = Object_Data(instance);
     if (pObject && (index < MAX_COMMAND_ACTIONS)) {
         pAction = &pObject->Action[index];
+        Command_State[Command_Instance_To_Index(instance)].Plan[index].valid =
+            false;
     }
 
     return pAction;
@@ -349,6 +431,311 @@ unsigned Command_Action_List_Count(uint32_t instance)
     return MAX_COMMAND_ACTIONS;
 }
 
+/**
+ * @brief For a given object instance-number, marks its action lists as
+ *  changed, for example after an action linked from an earlier entry was
+ *  changed, or after the objects that the actions refer to were created
+ *  or deleted
+ * @param instance - object-instance number of the object
+ */
+void Command_Action_List_Invalidate(uint32_t instance)
+{
+    unsigned index, i;
+
+    index = Command_Instance_To_Index(instance);
+    if (index < MAX_COMMANDS) {
+        for (i = 0; i < MAX_COMMAND_ACTIONS; i++) {
+            Command_State[index].Plan[i].valid = false;
+        }
+    }
+}
+
+/**
+ * @brief Determines if an action of an action list is not configured
+ * @param entry - action
+ * @return true if the action has no object to write
+ */
+static bool Command_Action_Entry_Empty(const BACNET_ACTION_LIST *entry)
+{
+    return entry->Object_Id.instance >= BACNET_MAX_INSTANCE;
+}
+
+/**
+ * @brief Frees the steps of an action list plan
+ * @param plan - plan of an action list
+ */
+static void Command_Action_Plan_Free(struct command_action_plan *plan)
+{
+    unsigned i;
+
+    for (i = 0; i < plan->count; i++) {
+        BACNET_MEMPOOL_FREE(
+            plan->step[i].remote, sizeof(struct command_remote_write));
+    }
+    BACNET_MEMPOOL_FREE(
+        plan->step, plan->size * sizeof(struct command_action_step));
+    plan->step = NULL;
+    plan->count = 0;
+    plan->size = 0;
+    plan->valid = false;
+}
+
+/**
+ * @brief Precompiles an action list: the values are encoded once, a local
+ *  REAL property is resolved to its direct accessor, and consecutive
+ *  writes to the same other device are linked into one
+ *  WritePropertyMultiple request.
+ * @param plan - plan of the action list
+ * @param list - first action of the list
+ * @param first - step where the execution resumes, which starts a batch
+ * @return true if the plan was built
+ */
+static bool Command_Action_Plan_Build(
+    struct command_action_plan *plan, BACNET_ACTION_LIST *list, unsigned first)
+{
+    BACNET_OBJECT_PROPERTY_REFERENCE reference = { 0 };
+    BACNET_ACTION_LIST *entry;
+    struct command_action_step *step = NULL;
+    struct command_remote_write *remote;
+    struct command_remote_write *prior = NULL;
+    unsigned count = 0, batch = 0, i = 0;
+    int len;
+
+    Command_Action_Plan_Free(plan);
+    for (entry = list; entry; entry = entry->next) {
+        if (!Command_Action_Entry_Empty(entry)) {
+            count++;
+        }
+    }
+    if (count > 0) {
+        step = BACNET_MEMPOOL_CALLOC(
+            count * sizeof(struct command_action_step));
+        if (!step) {
+            return false;
+        }
+    }
+    plan->step = step;
+    plan->size = count;
+    for (entry = list; entry; entry = entry->next) {
+        if (Command_Action_Entry_Empty(entry)) {
+            continue;
+        }
+        plan->count = i + 1;
+        step[i].entry = entry;
+        len = bacnet_action_property_value_encode(NULL, &entry->Value);
+        if ((len <= 0) || (len > COMMAND_ACTION_VALUE_SIZE)) {
+            Command_Action_Plan_Free(plan);
+            return false;
+        }
+        step[i].application_data_len = bacnet_action_property_value_encode(
+            step[i].application_data, &entry->Value);
+        if ((entry->Device_Id.instance >= BACNET_MAX_INSTANCE) ||
+            (entry->Device_Id.instance == Device_Object_Instance_Number())) {
+#if defined(BACACTION_REAL)
+            if ((entry->Value.tag == BACNET_APPLICATION_TAG_REAL) &&
+                Real_Accessor_Callback) {
+                reference.object_identifier = entry->Object_Id;
+                reference.property_identifier = entry->Property_Identifier;
+                reference.property_array_index = entry->Property_Array_Index;
+                step[i].accessor = Real_Accessor_Callback(&reference);
+            }
+#endif
+            step[i].batch_count = 1;
+            prior = NULL;
+            i++;
+            continue;
+        }
+        remote = BACNET_MEMPOOL_CALLOC(sizeof(struct command_remote_write));
+        if (!remote) {
+            Command_Action_Plan_Free(plan);
+            return false;
+        }
+        step[i].remote = remote;
+        remote->device_instance = entry->Device_Id.instance;
+        remote->write_access_data.object_type = entry->Object_Id.type;
+        remote->write_access_data.object_instance = entry->Object_Id.instance;
+        remote->write_access_data.listOfProperties = &remote->property_value;
+        remote->property_value.propertyIdentifier = entry->Property_Identifier;
+        remote->property_value.propertyArrayIndex =
+            entry->Property_Array_Index;
+        remote->property_value.priority = entry->Priority;
+        bacapp_decode_application_data(
+            step[i].application_data, step[i].application_data_len,
+            &remote->property_value.value);
+        /* a delay or a quit on failure ends the batch */
+        if (prior && (i != first) &&
+            (prior->device_instance == remote->device_instance) &&
+            (step[i - 1].entry->Post_Delay == 0) &&
+            !step[i - 1].entry->Quit_On_Failure) {
+            prior->write_access_data.next = &remote->write_access_data;
+            step[batch].batch_count++;
+        } else {
+            batch = i;
+            step[i].batch_count = 1;
+        }
+        prior = remote;
+        i++;
+    }
+    plan->valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Writes the value of one action to a local object
+ * @param step - step of an action list plan
+ * @return true if the value was written
+ */
+static bool Command_Action_Step_Write(const struct command_action_step *step)
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    const BACNET_ACTION_LIST *entry = step->entry;
+
+#if defined(BACACTION_REAL)
+    if (step->accessor && step->accessor->write &&
+        step->accessor->valid(entry->Object_Id.instance)) {
+        /* local object - skip the encoding and decoding */
+        return step->accessor->write(
+            entry->Object_Id.instance, entry->Value.type.Real,
+            entry->Priority, &wp_data.error_class, &wp_data.error_code);
+    }
+#endif
+    if (!Write_Property_Internal_Callback) {
+        return false;
+    }
+    wp_data.object_type = entry->Object_Id.type;
+    wp_data.object_instance = entry->Object_Id.instance;
+    wp_data.object_property = entry->Property_Identifier;
+    wp_data.array_index = entry->Property_Array_Index;
+    wp_data.priority = entry->Priority;
+    wp_data.error_class = ERROR_CLASS_PROPERTY;
+    wp_data.error_code = ERROR_CODE_SUCCESS;
+    memcpy(
+        wp_data.application_data, step->application_data,
+        step->application_data_len);
+    wp_data.application_data_len = step->application_data_len;
+
+    return Write_Property_Internal_Callback(&wp_data);
+}
+
+/**
+ * @brief Executes the steps of the action list in process, until the
+ *  list ends, a write fails that quits on failure, or a step has a
+ *  post delay
+ * @param index - 0..MAX_COMMANDS-1 index of the object
+ */
+static void Command_Action_Run(unsigned index)
+{
+    COMMAND_DESCR *pObject = &Command_Descr[index];
+    struct command_state *state = &Command_State[index];
+    struct command_action_plan *plan;
+    struct command_action_step *step;
+    const BACNET_ACTION_LIST *last;
+    unsigned n, i;
+    bool status, quit = false;
+
+    plan = &state->Plan[state->Action - 1];
+    if (!plan->valid &&
+        !Command_Action_Plan_Build(
+            plan, &pObject->Action[state->Action - 1], state->Step)) {
+        pObject->All_Writes_Successful = false;
+    }
+    while (!quit && (state->Step < plan->count)) {
+        step = &plan->step[state->Step];
+        n = step->batch_count;
+        if (step->remote) {
+            status = false;
+            if (Write_Property_Multiple_Callback) {
+                status = Write_Property_Multiple_Callback(
+                    step->remote->device_instance,
+                    &step->remote->write_access_data);
+            }
+        } else {
+            status = Command_Action_Step_Write(step);
+        }
+        for (i = 0; i < n; i++) {
+            step[i].entry->Write_Successful = status;
+            if (!status && step[i].entry->Quit_On_Failure) {
+                quit = true;
+            }
+        }
+        if (!status) {
+            pObject->All_Writes_Successful = false;
+        }
+        state->Step += n;
+        last = step[n - 1].entry;
+        if (!quit && last->Post_Delay && (state->Step < plan->count)) {
+            /* post delay is in seconds */
+            if (last->Post_Delay < (UINT32_MAX / 1000UL)) {
+                state->Post_Delay = last->Post_Delay * 1000UL;
+            } else {
+                state->Post_Delay = UINT32_MAX;
+            }
+            return;
+        }
+    }
+    state->Action = 0;
+    state->Step = 0;
+    state->Post_Delay = 0;
+    pObject->In_Process = false;
+}
+
+/**
+ * @brief Executes an action list of the object.  The writes of the list
+ *  are started now, and the steps that follow a post delay are executed
+ *  by Command_Timer().
+ * @param instance - object-instance number of the object
+ * @param value - present-value to set, 1..MAX_COMMAND_ACTIONS to execute
+ *  that action list, or 0 to execute no action
+ * @return true if the present-value was set, or false if the object is
+ *  not found, the value is out of range, or the object is in process
+ */
+bool Command_Action_Execute(uint32_t instance, uint32_t value)
+{
+    unsigned index;
+
+    index = Command_Instance_To_Index(instance);
+    if ((index >= MAX_COMMANDS) || (value > MAX_COMMAND_ACTIONS) ||
+        Command_Descr[index].In_Process) {
+        return false;
+    }
+    Command_Descr[index].Present_Value = value;
+    if (value == 0) {
+        return true;
+    }
+    Command_Descr[index].In_Process = true;
+    Command_Descr[index].All_Writes_Successful = true;
+    Command_State[index].Action = value;
+    Command_State[index].Step = 0;
+    Command_State[index].Post_Delay = 0;
+    Command_Action_Run(index);
+
+    return true;
+}
+
+/**
+ * @brief Updates the post delay of the action list in process
+ * @param object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed
+ */
+void Command_Timer(uint32_t object_instance, uint16_t milliseconds)
+{
+    unsigned index;
+    struct command_state *state;
+
+    index = Command_Instance_To_Index(object_instance);
+    if ((index >= MAX_COMMANDS) || !Command_Descr[index].In_Process) {
+        return;
+    }
+    state = &Command_State[index];
+    if (state->Post_Delay > milliseconds) {
+        state->Post_Delay -= milliseconds;
+    } else {
+        state->Post_Delay = 0;
+        Command_Action_Run(index);
+    }
+}
+
 /**
  * @brief Encode a BACnetARRAY property element
  * @param object_instance [in] BACnet network port object instance number
@@ -483,13 +870,19 @@ bool Command_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             status = write_property_type_valid(
                 wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
             if (status) {
-                if (value.type.Unsigned_Int >= MAX_COMMAND_ACTIONS) {
+                if (value.type.Unsigned_Int > MAX_COMMAND_ACTIONS) {
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
                     wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
                     return false;
                 }
-                Command_Present_Value_Set(
-                    wp_data->object_instance, value.type.Unsigned_Int);
+                if (Command_In_Process(wp_data->object_instance)) {
+                    wp_data->error_class = ERROR_CLASS_OBJECT;
+                    wp_data->error_code = ERROR_CODE_BUSY;
+                    return false;
+                }
+                Command_Action_Execute(
+                    wp_data->object_instance,
+                    (uint32_t)value.type.Unsigned_Int);
             } else {
                 wp_data->error_class = ERROR_CLASS_PROPERTY;
                 wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
@@ -516,3 +909,36 @@ void Command_Intrinsic_Reporting(uint32_t object_instance)
 {
     (void)object_instance;
 }
+
+/**
+ * @brief Sets the callback used to write the actions to local objects
+ * @param cb - callback used to write the actions, or NULL
+ */
+void Command_Write_Property_Internal_Callback_Set(write_property_function cb)
+{
+    Write_Property_Internal_Callback = cb;
+}
+
+/**
+ * @brief Sets the callback that finds the direct accessor of a local
+ *  object property that an action writes a REAL value to, instead of
+ *  encoding the value for WriteProperty
+ * @param cb - callback used to find the accessors, or NULL
+ */
+void Command_Real_Accessor_Callback_Set(loop_real_accessor_function cb)
+{
+    Real_Accessor_Callback = cb;
+    Command_Action_Plans_Invalidate();
+}
+
+/**
+ * @brief Sets the callback used to write the actions to the objects of
+ *  other devices, with one WritePropertyMultiple request for each run of
+ *  consecutive actions to the same device
+ * @param cb - callback used to write the actions, or NULL
+ */
+void Command_Write_Property_Multiple_Callback_Set(
+    command_write_property_multiple_function cb)
+{
+    Write_Property_Multiple_Callback = cb;
+}
@@ -15,6 +15,8 @@
 #include "bacnet/bacaction.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/wpm.h"
+#include "bacnet/basic/object/loop.h"
 
 #ifndef MAX_COMMANDS
 #define MAX_COMMANDS 4
@@ -24,6 +26,16 @@
 #define MAX_COMMAND_ACTIONS 8
 #endif
 
+/**
+ * @brief Writes the actions of a command to the objects of another device
+ * @param device_instance - device instance of the objects
+ * @param write_access_data - list of objects and property values to write,
+ *  which fits in one WritePropertyMultiple request
+ * @return true if the values were written
+ */
+typedef bool (*command_write_property_multiple_function)(
+    uint32_t device_instance, BACNET_WRITE_ACCESS_DATA *write_access_data);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -99,6 +111,21 @@ BACNET_ACTION_LIST *
 Command_Action_List_Entry(uint32_t instance, unsigned index);
 BACNET_STACK_EXPORT
 unsigned Command_Action_List_Count(uint32_t instance);
+BACNET_STACK_EXPORT
+void Command_Action_List_Invalidate(uint32_t instance);
+
+BACNET_STACK_EXPORT
+bool Command_Action_Execute(uint32_t instance, uint32_t value);
+BACNET_STACK_EXPORT
+void Command_Timer(uint32_t object_instance, uint16_t milliseconds);
+
+BACNET_STACK_EXPORT
+void Command_Write_Property_Internal_Callback_Set(write_property_function cb);
+BACNET_STACK_EXPORT
+void Command_Real_Accessor_Callback_Set(loop_real_accessor_function cb);
+BACNET_STACK_EXPORT
+void Command_Write_Property_Multiple_Callback_Set(
+    command_write_property_multiple_function cb);
 
 /* note: header of Intrinsic_Reporting function is required
    even when INTRINSIC_REPORTING is not defined */
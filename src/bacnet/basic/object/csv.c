@@ -21,6 +21,7 @@
 #include "bacnet/basic/object/csv.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List = NULL;
@@ -137,12 +138,12 @@ uint32_t CharacterString_Value_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct characterstring_object));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct characterstring_object));
         if (pObject) {
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
             pObject->Object_Name = NULL;
@@ -167,11 +168,11 @@ uint32_t CharacterString_Value_Create(uint32_t object_instance)
 bool CharacterString_Value_Delete(uint32_t object_instance)
 {
     bool status = false;
-    struct object_data *pObject = NULL;
+    struct characterstring_object *pObject = NULL;
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -183,13 +184,13 @@ bool CharacterString_Value_Delete(uint32_t object_instance)
  */
 void CharacterString_Value_Cleanup(void)
 {
-    struct object_data *pObject = NULL;
+    struct characterstring_object *pObject = NULL;
 
     if (Object_List) {
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -208,6 +209,32 @@ CharacterString_Value_Object(uint32_t object_instance)
     return Keylist_Data(Object_List, object_instance);
 }
 
+/**
+ * @brief Add the memory used by the CharacterString Value objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void CharacterString_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct characterstring_object);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of CharacterString Value objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned CharacterString_Value_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initialize the character string values.
  */
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -95,6 +96,10 @@ BACNET_STACK_EXPORT
 void CharacterString_Value_Cleanup(void);
 BACNET_STACK_EXPORT
 void CharacterString_Value_Init(void);
+BACNET_STACK_EXPORT
+void CharacterString_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned CharacterString_Value_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -8,6 +8,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -67,6 +68,16 @@
 #include "bacnet/basic/object/color_object.h"
 #include "bacnet/basic/object/color_temperature.h"
 #include "bacnet/basic/object/program.h"
+#if defined(BACNET_DEVICE_SNAPSHOT)
+#include "bacnet/basic/sys/rcu.h"
+#endif
+#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/memusage.h"
+#if defined(BACNET_STRING_POOL)
+#include "bacnet/basic/sys/strpool.h"
+#endif
+#include "bacnet/basic/tsm/tsm.h"
 
 /* external prototypes */
 extern int Routed_Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata);
@@ -76,6 +87,43 @@ Routed_Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data);
 /* may be overridden by outside table */
 static object_functions_t *Object_Table;
 
+/* Object_Table position + 1 of each standard object type, or 0 when the
+   type is not in the table, so a lookup is a single array load */
+static uint8_t Object_Table_Index[OBJECT_PROPRIETARY_MIN];
+/* proprietary object types in the table, sorted by type */
+#ifndef DEVICE_OBJECT_TABLE_PROPRIETARY_MAX
+#define DEVICE_OBJECT_TABLE_PROPRIETARY_MAX 8
+#endif
+struct device_object_table_proprietary {
+    uint16_t type;
+    uint8_t position;
+};
+static struct device_object_table_proprietary
+    Object_Table_Proprietary[DEVICE_OBJECT_TABLE_PROPRIETARY_MAX];
+static unsigned Object_Table_Proprietary_Count;
+/* false when the table is too large to index, and is searched */
+static bool Object_Table_Indexed;
+
+/* locks the objects while other threads read them */
+static device_read_lock_function Device_Read_Lock_Callback;
+
+#if defined(BACNET_PROPERTY_LIST_CACHE)
+/* The property lists of each Object_Table entry, counted and flattened
+   into one ALL list for ReadPropertyMultiple.  An entry is rebuilt when
+   the object returns different lists, such as a Network Port object
+   that changed its network type. */
+struct device_property_list_cache {
+    const int32_t *pRequired;
+    const int32_t *pOptional;
+    const int32_t *pProprietary;
+    struct special_property_list_t list;
+    int32_t *pAll;
+    struct property_list_bitset_t bitset;
+};
+static struct device_property_list_cache *Property_List_Cache;
+static unsigned Property_List_Cache_Size;
+#endif
+
 /* clang-format off */
 static object_functions_t My_Object_Table[] = {
     { OBJECT_DEVICE, NULL /* Init - don't init Device or it will recourse! */,
@@ -158,7 +206,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Calendar_Create, Calendar_Delete, NULL /* Timer */ },
+        Calendar_Create, Calendar_Delete, Calendar_Timer },
 #if (BACNET_PROTOCOL_REVISION >= 10)
     { OBJECT_BITSTRING_VALUE, BitString_Value_Init,
         BitString_Value_Count, BitString_Value_Index_To_Instance,
@@ -232,7 +280,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, Command_Timer },
     #if defined(INTRINSIC_REPORTING)
     { OBJECT_NOTIFICATION_CLASS, Notification_Class_Init,
         Notification_Class_Count, Notification_Class_Index_To_Instance,
@@ -313,7 +361,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Lighting_Output_Create, Lighting_Output_Delete, Lighting_Output_Timer },
+        Lighting_Output_Create, Lighting_Output_Delete,
+        NULL /* Timer: lighting_command_transition_task() */ },
     { OBJECT_CHANNEL, Channel_Init, Channel_Count, Channel_Index_To_Instance,
         Channel_Valid_Instance, Channel_Object_Name, Channel_Read_Property,
         Channel_Write_Property, Channel_Property_Lists,
@@ -343,7 +392,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Iterator */, NULL /* Value_Lists */, NULL /* COV */,
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Color_Create, Color_Delete, Color_Timer },
+        Color_Create, Color_Delete,
+        NULL /* Timer: lighting_command_transition_task() */ },
     { OBJECT_COLOR_TEMPERATURE, Color_Temperature_Init, Color_Temperature_Count,
         Color_Temperature_Index_To_Instance, Color_Temperature_Valid_Instance,
         Color_Temperature_Object_Name, Color_Temperature_Read_Property,
@@ -352,7 +402,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
         Color_Temperature_Create, Color_Temperature_Delete,
-        Color_Temperature_Timer },
+        NULL /* Timer: lighting_command_transition_task() */ },
 #endif
 #if defined(BACFILE)
     { OBJECT_FILE, bacfile_init, bacfile_count, bacfile_index_to_instance,
@@ -375,7 +425,12 @@ static object_functions_t My_Object_Table[] = {
         Structured_View_Index_To_Instance, Structured_View_Valid_Instance,
         Structured_View_Object_Name, Structured_View_Read_Property,
         NULL /* Write_Property */, Structured_View_Property_Lists,
-        NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+        Structured_View_Read_Range_Info,
+#else
+        NULL /* ReadRangeInfo */,
+#endif
+        NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */,  NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
         Structured_View_Create, Structured_View_Delete, NULL /* Timer */ },
@@ -426,7 +481,28 @@ struct object_functions *
 Device_Object_Functions_Find(BACNET_OBJECT_TYPE Object_Type)
 {
     struct object_functions *pObject = NULL;
+    unsigned low, high, mid;
 
+    if (Object_Table_Indexed) {
+        if (Object_Type < OBJECT_PROPRIETARY_MIN) {
+            mid = Object_Table_Index[Object_Type];
+            return mid ? &Object_Table[mid - 1] : NULL;
+        }
+        low = 0;
+        high = Object_Table_Proprietary_Count;
+        while (low < high) {
+            mid = low + (high - low) / 2;
+            if (Object_Table_Proprietary[mid].type == Object_Type) {
+                return &Object_Table[Object_Table_Proprietary[mid].position];
+            }
+            if (Object_Table_Proprietary[mid].type < Object_Type) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return NULL;
+    }
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
         /* handle each object type */
@@ -439,6 +515,59 @@ Device_Object_Functions_Find(BACNET_OBJECT_TYPE Object_Type)
     return (NULL);
 }
 
+/**
+ * @brief Index the object types of the Object_Table for
+ *  Device_Object_Functions_Find().  The first entry of a type wins,
+ *  as in a search of the table.
+ */
+static void Device_Object_Table_Index_Init(void)
+{
+    struct object_functions *pObject = NULL;
+    unsigned position = 0;
+    unsigned i = 0;
+    uint16_t type = 0;
+
+    Object_Table_Indexed = false;
+    Object_Table_Proprietary_Count = 0;
+    memset(Object_Table_Index, 0, sizeof(Object_Table_Index));
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (position >= UINT8_MAX) {
+            return;
+        }
+        type = (uint16_t)pObject->Object_Type;
+        if (type < OBJECT_PROPRIETARY_MIN) {
+            if (Object_Table_Index[type] == 0) {
+                Object_Table_Index[type] = (uint8_t)(position + 1);
+            }
+        } else {
+            for (i = 0; i < Object_Table_Proprietary_Count; i++) {
+                if (Object_Table_Proprietary[i].type >= type) {
+                    break;
+                }
+            }
+            if ((i == Object_Table_Proprietary_Count) ||
+                (Object_Table_Proprietary[i].type != type)) {
+                if (Object_Table_Proprietary_Count >=
+                    DEVICE_OBJECT_TABLE_PROPRIETARY_MAX) {
+                    return;
+                }
+                memmove(
+                    &Object_Table_Proprietary[i + 1],
+                    &Object_Table_Proprietary[i],
+                    (Object_Table_Proprietary_Count - i) *
+                        sizeof(Object_Table_Proprietary[0]));
+                Object_Table_Proprietary[i].type = type;
+                Object_Table_Proprietary[i].position = (uint8_t)position;
+                Object_Table_Proprietary_Count++;
+            }
+        }
+        position++;
+        pObject++;
+    }
+    Object_Table_Indexed = true;
+}
+
 /** Try to find a rr_info_function helper function for the requested object
  * type.
  * @ingroup ObjIntf
@@ -458,28 +587,181 @@ rr_info_function Device_Objects_RR_Info(BACNET_OBJECT_TYPE object_type)
     return (pObject != NULL ? pObject->Object_RR_Info : NULL);
 }
 
-/** For a given object type, returns the special property list.
- * This function is used for ReadPropertyMultiple calls which want
- * just Required, just Optional, or All properties.
- * @ingroup ObjIntf
- *
- * @param object_type [in] The desired BACNET_OBJECT_TYPE whose properties
- *            are to be listed.
- * @param pPropertyList [out] Reference to the structure which will, on return,
- *            list, separately, the Required, Optional, and Proprietary object
- *            properties with their counts.
+#if defined(BACNET_PROPERTY_LIST_CACHE)
+/**
+ * @brief Rebuild the property list cache entry of an Object_Table entry
+ * @param pCache [in,out] the cache entry
+ * @param pPropertyList [in] the lists returned by the object
+ * @return true if the cache entry is valid
  */
-void Device_Objects_Property_List(
+static bool Device_Property_List_Cache_Build(
+    struct device_property_list_cache *pCache,
+    const struct special_property_list_t *pPropertyList)
+{
+    struct special_property_list_t *list = &pCache->list;
+    uint32_t count;
+    int32_t *pAll;
+
+    list->Required.count = pPropertyList->Required.pList == NULL
+        ? 0
+        : property_list_count(pPropertyList->Required.pList);
+    list->Optional.count = pPropertyList->Optional.pList == NULL
+        ? 0
+        : property_list_count(pPropertyList->Optional.pList);
+    list->Proprietary.count = pPropertyList->Proprietary.pList == NULL
+        ? 0
+        : property_list_count(pPropertyList->Proprietary.pList);
+    count = list->Required.count + list->Optional.count +
+        list->Proprietary.count;
+    /* terminated with -1 like the object lists */
+    pAll = BACNET_MEMPOOL_REALLOC(
+        pCache->pAll,
+        pCache->pAll ? (list->All.count + 1) * sizeof(int32_t) : 0,
+        (count + 1) * sizeof(int32_t));
+    if (!pAll) {
+        return false;
+    }
+    pCache->pAll = pAll;
+    if (list->Required.count) {
+        memcpy(
+            pAll, pPropertyList->Required.pList,
+            list->Required.count * sizeof(int32_t));
+        pAll += list->Required.count;
+    }
+    if (list->Optional.count) {
+        memcpy(
+            pAll, pPropertyList->Optional.pList,
+            list->Optional.count * sizeof(int32_t));
+        pAll += list->Optional.count;
+    }
+    if (list->Proprietary.count) {
+        memcpy(
+            pAll, pPropertyList->Proprietary.pList,
+            list->Proprietary.count * sizeof(int32_t));
+        pAll += list->Proprietary.count;
+    }
+    *pAll = -1;
+    list->Required.pList = pPropertyList->Required.pList;
+    list->Optional.pList = pPropertyList->Optional.pList;
+    list->Proprietary.pList = pPropertyList->Proprietary.pList;
+    list->All.pList = pCache->pAll;
+    list->All.count = count;
+    property_list_bitset_init(&pCache->bitset, pCache->pAll);
+    pCache->pRequired = pPropertyList->Required.pList;
+    pCache->pOptional = pPropertyList->Optional.pList;
+    pCache->pProprietary = pPropertyList->Proprietary.pList;
+
+    return true;
+}
+
+/**
+ * @brief Fill in the lists from the property list cache of an object
+ * @param pObject [in] the Object_Table entry
+ * @param pPropertyList [in,out] the lists returned by the object, which
+ *  get their counts and the ALL list from the cache
+ * @return the cache entry, or NULL if the lists are not cached
+ */
+static struct device_property_list_cache *Device_Property_List_Cached(
+    const struct object_functions *pObject,
+    struct special_property_list_t *pPropertyList)
+{
+    struct device_property_list_cache *pCache;
+    size_t index;
+
+    if ((pObject < Object_Table) || !Property_List_Cache) {
+        return NULL;
+    }
+    index = pObject - Object_Table;
+    if (index >= Property_List_Cache_Size) {
+        return NULL;
+    }
+    pCache = &Property_List_Cache[index];
+    if (!pCache->pAll ||
+        (pCache->pRequired != pPropertyList->Required.pList) ||
+        (pCache->pOptional != pPropertyList->Optional.pList) ||
+        (pCache->pProprietary != pPropertyList->Proprietary.pList)) {
+        if (!Device_Property_List_Cache_Build(pCache, pPropertyList)) {
+            return NULL;
+        }
+    }
+    *pPropertyList = pCache->list;
+
+    return pCache;
+}
+
+/**
+ * @brief Allocate the property list cache for the Object_Table, and fill
+ *  it in for each object type
+ */
+static void Device_Property_List_Cache_Init(void)
+{
+    struct special_property_list_t property_list = { 0 };
+    struct object_functions *pObject;
+    unsigned count = 0;
+    unsigned index;
+
+    for (index = 0; index < Property_List_Cache_Size; index++) {
+        BACNET_MEMPOOL_FREE(
+            Property_List_Cache[index].pAll,
+            (Property_List_Cache[index].list.All.count + 1) *
+                sizeof(int32_t));
+    }
+    BACNET_MEMPOOL_FREE(
+        Property_List_Cache,
+        Property_List_Cache_Size * sizeof(struct device_property_list_cache));
+    Property_List_Cache = NULL;
+    Property_List_Cache_Size = 0;
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        count++;
+        pObject++;
+    }
+    if (count == 0) {
+        return;
+    }
+    Property_List_Cache = BACNET_MEMPOOL_CALLOC(
+        count * sizeof(struct device_property_list_cache));
+    if (!Property_List_Cache) {
+        return;
+    }
+    Property_List_Cache_Size = count;
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        Device_Objects_Property_List(pObject->Object_Type, 0, &property_list);
+        pObject++;
+    }
+}
+#endif
+
+/**
+ * @brief Lock the objects while they are read from another thread.  The
+ *  reads update lazy caches, such as the property lists, so the reads of
+ *  several threads are serialized by the callback.
+ * @param lock - true to lock, false to unlock
+ */
+static void Device_Read_Lock(bool lock)
+{
+    if (Device_Read_Lock_Callback) {
+        Device_Read_Lock_Callback(lock);
+    }
+}
+
+/**
+ * @brief Fill in the special property list of an object type
+ * @param object_type [in] The desired BACNET_OBJECT_TYPE
+ * @param pPropertyList [out] The lists and their counts
+ */
+static void Device_Objects_Property_List_Fill(
     BACNET_OBJECT_TYPE object_type,
-    uint32_t object_instance,
     struct special_property_list_t *pPropertyList)
 {
     struct object_functions *pObject = NULL;
 
-    (void)object_instance;
     pPropertyList->Required.pList = NULL;
     pPropertyList->Optional.pList = NULL;
     pPropertyList->Proprietary.pList = NULL;
+    pPropertyList->All.pList = NULL;
+    pPropertyList->All.count = 0;
 
     /* If we can find an entry for the required object type
      * and there is an Object_List_RPM fn ptr then call it
@@ -491,6 +773,11 @@ void Device_Objects_Property_List(
         pObject->Object_RPM_List(
             &pPropertyList->Required.pList, &pPropertyList->Optional.pList,
             &pPropertyList->Proprietary.pList);
+#if defined(BACNET_PROPERTY_LIST_CACHE)
+        if (Device_Property_List_Cached(pObject, pPropertyList)) {
+            return;
+        }
+#endif
     }
 
     /* Fetch the counts if available otherwise zero them */
@@ -509,6 +796,29 @@ void Device_Objects_Property_List(
     return;
 }
 
+/** For a given object type, returns the special property list.
+ * This function is used for ReadPropertyMultiple calls which want
+ * just Required, just Optional, or All properties.
+ * @ingroup ObjIntf
+ *
+ * @param object_type [in] The desired BACNET_OBJECT_TYPE whose properties
+ *            are to be listed.
+ * @param pPropertyList [out] Reference to the structure which will, on return,
+ *            list, separately, the Required, Optional, and Proprietary object
+ *            properties with their counts, and with BACNET_PROPERTY_LIST_CACHE
+ *            all of them in one list.
+ */
+void Device_Objects_Property_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    struct special_property_list_t *pPropertyList)
+{
+    (void)object_instance;
+    Device_Read_Lock(true);
+    Device_Objects_Property_List_Fill(object_type, pPropertyList);
+    Device_Read_Lock(false);
+}
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Device_Properties_Required[] = {
     /* List of Required properties in this object */
@@ -528,6 +838,10 @@ static const int32_t Device_Properties_Required[] = {
     PROP_OBJECT_LIST,
     PROP_MAX_APDU_LENGTH_ACCEPTED,
     PROP_SEGMENTATION_SUPPORTED,
+#if BACNET_SEGMENTATION_ENABLED
+    PROP_MAX_SEGMENTS_ACCEPTED,
+    PROP_APDU_SEGMENT_TIMEOUT,
+#endif
     PROP_APDU_TIMEOUT,
     PROP_NUMBER_OF_APDU_RETRIES,
     PROP_DEVICE_ADDRESS_BINDING,
@@ -559,7 +873,15 @@ static const int32_t Device_Properties_Optional[] = {
     -1
 };
 
-static const int32_t Device_Properties_Proprietary[] = { -1 };
+static const int32_t Device_Properties_Proprietary[] = {
+#if defined(BACNET_DEVICE_MEMORY_USAGE)
+    PROP_DEVICE_MEMORY_USAGE,
+#endif
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    PROP_DEVICE_OBJECT_JOURNAL,
+#endif
+    -1
+};
 
 /**
  * @brief Returns the list of required, optional, and proprietary properties
@@ -604,7 +926,22 @@ bool Device_Objects_Property_List_Member(
 {
     bool found = false;
     struct special_property_list_t property_list = { 0 };
+#if defined(BACNET_PROPERTY_LIST_CACHE)
+    struct object_functions *pObject;
+    struct device_property_list_cache *pCache;
 
+    pObject = Device_Object_Functions_Find(object_type);
+    if ((pObject != NULL) && (pObject->Object_RPM_List != NULL)) {
+        pObject->Object_RPM_List(
+            &property_list.Required.pList, &property_list.Optional.pList,
+            &property_list.Proprietary.pList);
+        pCache = Device_Property_List_Cached(pObject, &property_list);
+        if (pCache) {
+            return property_list_bitset_member(
+                &pCache->bitset, object_property);
+        }
+    }
+#endif
     Device_Objects_Property_List(object_type, object_instance, &property_list);
     found = property_list_member(property_list.Required.pList, object_property);
     if (!found) {
@@ -665,6 +1002,118 @@ static uint32_t Interval_Offset_Minutes;
 /* Max_Info_Frames - rely on MS/TP subsystem, if there is one */
 /* Device_Address_Binding - required, but relies on binding cache */
 static uint32_t Database_Revision = 0;
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+/* the most recent changes of the Object_List, oldest first, where the
+   newest change made the current Database_Revision */
+struct device_object_journal {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_DEVICE_OBJECT_CHANGE change;
+};
+static struct device_object_journal
+    Object_Journal[BACNET_DEVICE_OBJECT_JOURNAL_SIZE];
+static unsigned Object_Journal_Oldest;
+static unsigned Object_Journal_Count;
+#endif
+/* Object_List - flattened index of child object identifiers */
+static BACNET_OBJECT_ID *Object_List_Index;
+static unsigned Object_List_Index_Size;
+static unsigned Object_List_Index_Count;
+/* sum of the object counts, and Device_Object_Revision(), when it was built */
+static unsigned Object_List_Index_Sum;
+static unsigned Object_List_Index_Revision;
+static bool Object_List_Index_Valid;
+/* Protocol_Services_Supported and Protocol_Object_Types_Supported - the
+   encoded bitstrings, which are read by every discovery scan */
+#define DEVICE_BITSTRING_CACHE_BYTES (MAX_BITSTRING_BYTES + 4)
+struct device_bitstring_cache {
+    /* zero if the entry is empty */
+    uint8_t length;
+    /* apdu_service_handler_revision() when the value was encoded */
+    unsigned revision;
+    uint8_t value[DEVICE_BITSTRING_CACHE_BYTES];
+};
+/* the gateway Device, and the routed Devices that share one entry */
+static struct device_bitstring_cache Services_Supported_Cache[2];
+static struct device_bitstring_cache Object_Types_Supported_Cache;
+#if defined(BACNET_DEVICE_SNAPSHOT)
+/* Object_List, Protocol_Services_Supported, and
+   Protocol_Object_Types_Supported - published copy for lock-free reads */
+struct device_snapshot {
+    /* Device_Object_Revision() when the copy was made */
+    unsigned object_revision;
+    /* apdu_service_handler_revision() when the copy was made */
+    unsigned services_revision;
+    unsigned object_count;
+    /* bytes allocated for the copy and the identifiers that follow it */
+    size_t size;
+    BACNET_OBJECT_ID *object_list;
+    BACNET_BIT_STRING services_supported;
+    BACNET_BIT_STRING object_types_supported;
+};
+static RCU_DOMAIN Device_Snapshot_Domain;
+static RCU_POINTER Device_Snapshot;
+
+/**
+ * @brief Free a copy that is no longer published, once no reader holds it
+ * @param snapshot [in] the copy, or NULL
+ */
+static void Device_Snapshot_Free(struct device_snapshot *snapshot)
+{
+    if (snapshot) {
+        BACNET_MEMPOOL_FREE(snapshot, snapshot->size);
+    }
+}
+#endif
+#if defined(INTRINSIC_REPORTING)
+/* objects evaluated by Device_local_reporting() - event detection enabled */
+struct reporting_list_entry {
+    struct object_functions *pObject;
+    uint32_t instance;
+};
+static struct reporting_list_entry *Reporting_List;
+static unsigned Reporting_List_Size;
+static unsigned Reporting_List_Count;
+/* Device_Object_Revision() when the list was built */
+static unsigned Reporting_List_Revision;
+static bool Reporting_List_Valid;
+#endif
+#if defined(BACNET_OBJECT_NAME_INDEX)
+/* Object_Name - optional hash index into the Object_List index, with
+   a second chain by object identifier to find the entry of a rename */
+struct object_name_index_entry {
+    uint32_t hash;
+    unsigned next;
+    unsigned id_next;
+};
+static struct object_name_index_entry *Object_Name_Index;
+static unsigned Object_Name_Index_Size;
+static unsigned *Object_Name_Bucket;
+static unsigned *Object_Id_Bucket;
+static unsigned Object_Name_Bucket_Size;
+static bool Object_Name_Index_Valid;
+#define OBJECT_NAME_INDEX_NONE (~(unsigned)0)
+#endif
+#if defined(BACNET_PROPERTY_VALUE_CACHE)
+/* Object_Name, Description, Units, and Property_List - optional cache of
+   the encoded values, which rarely change and are read by every poll */
+#ifndef BACNET_PROPERTY_VALUE_CACHE_SIZE
+#define BACNET_PROPERTY_VALUE_CACHE_SIZE 64
+#endif
+#ifndef BACNET_PROPERTY_VALUE_CACHE_BYTES
+#define BACNET_PROPERTY_VALUE_CACHE_BYTES 128
+#endif
+struct property_value_cache_entry {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID object_property;
+    /* zero if the entry is empty */
+    uint16_t length;
+    uint8_t value[BACNET_PROPERTY_VALUE_CACHE_BYTES];
+};
+static struct property_value_cache_entry
+    Property_Value_Cache[BACNET_PROPERTY_VALUE_CACHE_SIZE];
+#endif
 /* Configuration_Files */
 /* Last_Restore_Time */
 /* Backup_Failure_Timeout */
@@ -884,7 +1333,9 @@ bool Device_Set_Object_Name(const BACNET_CHARACTER_STRING *object_name)
     if (!characterstring_same(&My_Object_Name, object_name)) {
         /* Make the change and update the database revision */
         status = characterstring_copy(&My_Object_Name, object_name);
-        Device_Inc_Database_Revision();
+        Device_Object_Changed(
+            OBJECT_DEVICE, Object_Instance_Number,
+            DEVICE_OBJECT_CHANGE_RENAMED);
     }
 
     return status;
@@ -1145,7 +1596,13 @@ uint8_t Device_Protocol_Revision(void)
 
 BACNET_SEGMENTATION Device_Segmentation_Supported(void)
 {
+#if BACNET_SEGMENTATION_ENABLED
+    /* segmented ComplexACKs are sent, but segmented requests
+       are not accepted */
+    return SEGMENTATION_TRANSMIT;
+#else
     return SEGMENTATION_NONE;
+#endif
 }
 
 /**
@@ -1164,7 +1621,42 @@ uint32_t Device_Database_Revision(void)
 void Device_Set_Database_Revision(uint32_t revision)
 {
     Database_Revision = revision;
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    /* the changes that led to this revision are not known */
+    Object_Journal_Count = 0;
+#endif
+}
+
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+/**
+ * @brief Add a change to the Object_List journal, dropping the oldest
+ *  change when the journal is full
+ * @param object_type [in] type of the object that changed
+ * @param object_instance [in] instance of the object that changed
+ * @param change [in] what changed
+ */
+static void Device_Object_Journal_Add(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_DEVICE_OBJECT_CHANGE change)
+{
+    struct device_object_journal *entry;
+
+    if (Object_Journal_Count < BACNET_DEVICE_OBJECT_JOURNAL_SIZE) {
+        entry = &Object_Journal
+            [(Object_Journal_Oldest + Object_Journal_Count) %
+             BACNET_DEVICE_OBJECT_JOURNAL_SIZE];
+        Object_Journal_Count++;
+    } else {
+        entry = &Object_Journal[Object_Journal_Oldest];
+        Object_Journal_Oldest =
+            (Object_Journal_Oldest + 1) % BACNET_DEVICE_OBJECT_JOURNAL_SIZE;
+    }
+    entry->object_type = object_type;
+    entry->object_instance = object_instance;
+    entry->change = change;
 }
+#endif
 
 /*
  * Shortcut for incrementing database revision as this is potentially
@@ -1174,14 +1666,48 @@ void Device_Set_Database_Revision(uint32_t revision)
 void Device_Inc_Database_Revision(void)
 {
     Database_Revision++;
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    Device_Object_Journal_Add(
+        OBJECT_DEVICE, Object_Instance_Number, DEVICE_OBJECT_CHANGE_ANY);
+#endif
+    Device_Object_List_Index_Invalidate();
 }
 
-/** Get the total count of objects supported by this Device Object.
- * @note Since many network clients depend on the object list
- *       for discovery, it must be consistent!
+/**
+ * @brief Increment the Database_Revision for a change of one object,
+ *  and keep the change in the Object_List journal so that clients are
+ *  able to read only the changes since the revision that they know.
+ * @note Objects created, deleted, or renamed with the BACnet services are
+ *  counted automatically.  Call this after an object is renamed from the
+ *  application instead of Device_Object_Name_Index_Update().
+ * @param object_type [in] type of the object that changed
+ * @param object_instance [in] instance of the object that changed
+ * @param change [in] what changed
+ */
+void Device_Object_Changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_DEVICE_OBJECT_CHANGE change)
+{
+    Database_Revision++;
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    Device_Object_Journal_Add(object_type, object_instance, change);
+#endif
+    if (change == DEVICE_OBJECT_CHANGE_RENAMED) {
+        /* the Object_List is the same - only the name and revision */
+        Device_Object_Name_Index_Update(object_type, object_instance);
+        Device_Property_Value_Cache_Invalidate(
+            OBJECT_DEVICE, Object_Instance_Number);
+    } else {
+        Device_Object_List_Index_Invalidate();
+    }
+}
+
+/**
+ * @brief Get the sum of the object counts from each object type
  * @return The count of objects, for all supported Object types.
  */
-unsigned Device_Object_List_Count(void)
+static unsigned Device_Object_List_Count_Sum(void)
 {
     unsigned count = 0; /* number of objects */
     struct object_functions *pObject = NULL;
@@ -1198,17 +1724,15 @@ unsigned Device_Object_List_Count(void)
     return count;
 }
 
-/** Lookup the Object at the given array index in the Device's Object List.
- * Even though we don't keep a single linear array of objects in the Device,
- * this method acts as though we do and works through a virtual, concatenated
- * array of all of our object type arrays.
- *
+/**
+ * @brief Lookup the Object at the given array index by walking through
+ *  a virtual, concatenated array of all of our object type arrays.
  * @param array_index [in] The desired array index (1 to N)
  * @param object_type [out] The object's type, if found.
  * @param instance [out] The object's instance number, if found.
  * @return True if found, else false.
  */
-bool Device_Object_List_Identifier(
+static bool Device_Object_List_Walk(
     uint32_t array_index, BACNET_OBJECT_TYPE *object_type, uint32_t *instance)
 {
     bool status = false;
@@ -1257,62 +1781,585 @@ bool Device_Object_List_Identifier(
     return status;
 }
 
+/* revisions of the lists of objects of the object types, which change
+   when an object is created or deleted */
+typedef unsigned (*device_list_revision_function)(void);
+static const struct device_list_revision {
+    BACNET_OBJECT_TYPE object_type;
+    device_list_revision_function function;
+} Device_List_Revision[] = {
+    { OBJECT_ANALOG_INPUT, Analog_Input_List_Revision },
+    { OBJECT_ANALOG_OUTPUT, Analog_Output_List_Revision },
+    { OBJECT_ANALOG_VALUE, Analog_Value_List_Revision },
+    { OBJECT_BINARY_INPUT, Binary_Input_List_Revision },
+    { OBJECT_BINARY_OUTPUT, Binary_Output_List_Revision },
+    { OBJECT_BINARY_VALUE, Binary_Value_List_Revision },
+    { OBJECT_BINARY_LIGHTING_OUTPUT, Binary_Lighting_Output_List_Revision },
+    { OBJECT_BITSTRING_VALUE, BitString_Value_List_Revision },
+    { OBJECT_CALENDAR, Calendar_List_Revision },
+    { OBJECT_CHANNEL, Channel_List_Revision },
+    { OBJECT_CHARACTERSTRING_VALUE, CharacterString_Value_List_Revision },
+    { OBJECT_COLOR, Color_List_Revision },
+    { OBJECT_COLOR_TEMPERATURE, Color_Temperature_List_Revision },
+#if defined(BACFILE)
+    { OBJECT_FILE, bacfile_list_revision },
+#endif
+    { OBJECT_INTEGER_VALUE, Integer_Value_List_Revision },
+    { OBJECT_LIFE_SAFETY_POINT, Life_Safety_Point_List_Revision },
+    { OBJECT_LIFE_SAFETY_ZONE, Life_Safety_Zone_List_Revision },
+    { OBJECT_LIGHTING_OUTPUT, Lighting_Output_List_Revision },
+    { OBJECT_LOAD_CONTROL, Load_Control_List_Revision },
+    { OBJECT_LOOP, Loop_List_Revision },
+    { OBJECT_MULTI_STATE_INPUT, Multistate_Input_List_Revision },
+    { OBJECT_MULTI_STATE_OUTPUT, Multistate_Output_List_Revision },
+    { OBJECT_MULTI_STATE_VALUE, Multistate_Value_List_Revision },
+    { OBJECT_PROGRAM, Program_List_Revision },
+    { OBJECT_STRUCTURED_VIEW, Structured_View_List_Revision },
+    { OBJECT_TIME_VALUE, Time_Value_List_Revision },
+    { OBJECT_TIMER, Timer_List_Revision },
+};
+/* the revision functions of the object types in the object table */
+static device_list_revision_function
+    Object_List_Revision[ARRAY_SIZE(Device_List_Revision)];
+static unsigned Object_List_Revision_Count;
+
 /**
- * @brief Encode a BACnetARRAY property element
- * @param object_instance [in] BACnet network port object instance number
- * @param array_index [in] array index requested:
- *    0 to N for individual array members
- * @param apdu [out] Buffer in which the APDU contents are built, or NULL to
- * return the length of buffer if it had been built
- * @return The length of the apdu encoded or
- *   BACNET_STATUS_ERROR for ERROR_CODE_INVALID_ARRAY_INDEX
+ * @brief Find the revision functions of the object types that are in the
+ *  object table
  */
-int Device_Object_List_Element_Encode(
-    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+static void Device_Object_Revision_Init(void)
 {
-    int apdu_len = BACNET_STATUS_ERROR;
-    BACNET_OBJECT_TYPE object_type;
-    uint32_t instance;
-    bool found;
-
-    if (object_instance == Device_Object_Instance_Number()) {
-        /* single element is zero based, add 1 for BACnetARRAY which is one
-         * based */
-        array_index++;
-        found =
-            Device_Object_List_Identifier(array_index, &object_type, &instance);
-        if (found) {
-            apdu_len =
-                encode_application_object_id(apdu, object_type, instance);
+    size_t i;
+
+    Object_List_Revision_Count = 0;
+    for (i = 0; i < ARRAY_SIZE(Device_List_Revision); i++) {
+        if (Device_Object_Functions_Find(Device_List_Revision[i].object_type)) {
+            Object_List_Revision[Object_List_Revision_Count] =
+                Device_List_Revision[i].function;
+            Object_List_Revision_Count++;
         }
     }
-
-    return apdu_len;
 }
 
-/** Determine if we have an object with the given object_name.
- * If the object_type and object_instance pointers are not null,
- * and the lookup succeeds, they will be given the resulting values.
- * @param object_name [in] The desired Object Name to look for.
- * @param object_type [out] The BACNET_OBJECT_TYPE of the matching Object.
- * @param object_instance [out] The object instance number of the matching
- * Object.
- * @return True on success or else False if not found.
+/**
+ * @brief Get a number that changes when an object of the object table is
+ *  created or deleted, even directly from the application, so that a copy
+ *  of the Object_List can tell that it is stale.
+ * @note The lists of objects are only changed by the thread that owns the
+ *  objects, while it holds off the readers of other threads, such as the
+ *  APDU workers, so the revisions are not read while they change.
+ * @return The sum of the revisions of the lists of objects
  */
-bool Device_Valid_Object_Name(
-    const BACNET_CHARACTER_STRING *object_name1,
-    BACNET_OBJECT_TYPE *object_type,
-    uint32_t *object_instance)
+static unsigned Device_Object_Revision(void)
 {
-    bool found = false;
-    BACNET_OBJECT_TYPE type = OBJECT_NONE;
-    uint32_t instance;
-    uint32_t max_objects = 0, i = 0;
-    bool check_id = false;
-    BACNET_CHARACTER_STRING object_name2;
-    struct object_functions *pObject = NULL;
+    unsigned revision = 0;
+    unsigned i;
 
-    max_objects = Device_Object_List_Count();
+    for (i = 0; i < Object_List_Revision_Count; i++) {
+        revision += Object_List_Revision[i]();
+    }
+
+    return revision;
+}
+
+/**
+ * @brief Rebuild the flattened Object_List index from the object tables
+ * @param count [in] The count of objects, for all supported Object types.
+ * @return True if the index was rebuilt, false if memory was not available.
+ */
+static bool Device_Object_List_Index_Build(unsigned count)
+{
+    BACNET_OBJECT_ID *index = NULL;
+    struct object_functions *pObject = NULL;
+    unsigned object_count = 0;
+    unsigned object_index = 0;
+    unsigned i = 0, n = 0;
+
+    Object_List_Index_Valid = false;
+#if defined(BACNET_OBJECT_NAME_INDEX)
+    Object_Name_Index_Valid = false;
+#endif
+    /* the object counts changed */
+    Object_Types_Supported_Cache.length = 0;
+    Object_List_Index_Revision = Device_Object_Revision();
+    if (count > Object_List_Index_Size) {
+        index = BACNET_MEMPOOL_REALLOC(
+            Object_List_Index,
+            Object_List_Index_Size * sizeof(BACNET_OBJECT_ID),
+            count * sizeof(BACNET_OBJECT_ID));
+        if (!index) {
+            return false;
+        }
+        Object_List_Index = index;
+        Object_List_Index_Size = count;
+    }
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Count && pObject->Object_Index_To_Instance) {
+            object_count = pObject->Object_Count();
+            if (pObject->Object_Iterator) {
+                object_index = pObject->Object_Iterator(~(unsigned)0);
+            } else {
+                object_index = 0;
+            }
+            for (i = 0; (i < object_count) && (n < count); i++) {
+                Object_List_Index[n].type = pObject->Object_Type;
+                Object_List_Index[n].instance =
+                    pObject->Object_Index_To_Instance(object_index);
+                n++;
+                if (pObject->Object_Iterator) {
+                    object_index = pObject->Object_Iterator(object_index);
+                } else {
+                    object_index++;
+                }
+            }
+        }
+        pObject++;
+    }
+    Object_List_Index_Count = n;
+    Object_List_Index_Sum = count;
+    Object_List_Index_Valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Mark the flattened Object_List index as stale, so that it is
+ *  rebuilt on the next access.
+ * @note Objects created or deleted with Device_Create_Object() or
+ *  Device_Delete_Object(), or any change that increments the Database
+ *  Revision, already invalidate the index, and so does an object that
+ *  is created or deleted in an object table kept in a key list.  Call
+ *  this after any other change to the set of objects, such as a rename
+ *  of an object instance.
+ */
+void Device_Object_List_Index_Invalidate(void)
+{
+    Object_List_Index_Valid = false;
+    Object_Types_Supported_Cache.length = 0;
+    Device_Local_Reporting_Invalidate();
+#if defined(BACNET_OBJECT_NAME_INDEX)
+    Object_Name_Index_Valid = false;
+#endif
+#if defined(BACNET_PROPERTY_VALUE_CACHE)
+    Device_Property_Value_Cache_Invalidate(OBJECT_NONE, BACNET_MAX_INSTANCE);
+#endif
+#if defined(BACNET_DEVICE_SNAPSHOT)
+    /* withdraw the copy, and free it once no reader holds it */
+    Device_Snapshot_Free(
+        rcu_publish(&Device_Snapshot_Domain, &Device_Snapshot, NULL));
+#endif
+}
+
+/**
+ * @brief Determine if the flattened Object_List index can be used
+ * @return True if the index is usable for this Device
+ */
+static bool Device_Object_List_Index_Enabled(void)
+{
+#ifdef BAC_ROUTING
+    /* routed Device object instance depends on the current device */
+    if (Device_Router_Mode) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief Determine if the flattened Object_List index is current
+ * @note The object tables are kept in key lists, so an object that is
+ *  created or deleted directly from the application changes the
+ *  Device_Object_Revision() even when the count of objects stays the same.
+ * @return True if the index is valid, and no object was created or
+ *  deleted since it was built
+ */
+static bool Device_Object_List_Index_Current(void)
+{
+    return Object_List_Index_Valid &&
+        (Object_List_Index_Revision == Device_Object_Revision());
+}
+
+/** Get the total count of objects supported by this Device Object.
+ * @note Since many network clients depend on the object list
+ *       for discovery, it must be consistent!
+ * @note The count is kept with the flattened Object_List index, which
+ *       is rebuilt when it is not current, so that objects created or
+ *       deleted directly from the application are included.
+ * @return The count of objects, for all supported Object types.
+ */
+unsigned Device_Object_List_Count(void)
+{
+    if (Device_Object_List_Index_Enabled()) {
+        if (!Device_Object_List_Index_Current()) {
+            (void)Device_Object_List_Index_Build(
+                Device_Object_List_Count_Sum());
+        }
+        if (Object_List_Index_Valid) {
+            return Object_List_Index_Sum;
+        }
+    }
+
+    return Device_Object_List_Count_Sum();
+}
+
+/** Lookup the Object at the given array index in the Device's Object List.
+ * A flattened index of the type and instance of every object is kept
+ * and refreshed whenever the set of objects changes, so that the lookup
+ * is constant time.  If the index could not be allocated, this method
+ * works through a virtual, concatenated array of all of our object
+ * type arrays.
+ *
+ * @param array_index [in] The desired array index (1 to N)
+ * @param object_type [out] The object's type, if found.
+ * @param instance [out] The object's instance number, if found.
+ * @return True if found, else false.
+ */
+bool Device_Object_List_Identifier(
+    uint32_t array_index, BACNET_OBJECT_TYPE *object_type, uint32_t *instance)
+{
+    bool status = false;
+
+    /* array index zero is length - so invalid */
+    if (array_index == 0) {
+        return status;
+    }
+    if (Device_Object_List_Index_Enabled()) {
+        if (!Device_Object_List_Index_Current()) {
+            (void)Device_Object_List_Count();
+        }
+        if (Object_List_Index_Valid) {
+            if (array_index <= Object_List_Index_Count) {
+                *object_type = Object_List_Index[array_index - 1].type;
+                *instance = Object_List_Index[array_index - 1].instance;
+                status = true;
+            }
+            return status;
+        }
+    }
+
+    return Device_Object_List_Walk(array_index, object_type, instance);
+}
+
+#if defined(BACNET_OBJECT_NAME_INDEX)
+/**
+ * @brief Compute a hash of an encoded character string (FNV-1a)
+ * @param object_name [in] The object name
+ * @return hash value of the character set and characters
+ */
+static uint32_t Device_Object_Name_Hash(const BACNET_CHARACTER_STRING *name)
+{
+    uint32_t hash = 2166136261UL;
+    const char *value;
+    size_t length, i;
+
+    hash ^= characterstring_encoding(name);
+    hash *= 16777619UL;
+    value = characterstring_value(name);
+    length = characterstring_length(name);
+    for (i = 0; i < length; i++) {
+        hash ^= (uint8_t)value[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Compute the bucket of an object identifier
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object
+ * @param object_instance [in] The object instance number of the Object
+ * @return bucket of the object identifier hash chain
+ */
+static unsigned Device_Object_Id_Bucket(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)object_type << 22) |
+        (object_instance & BACNET_MAX_INSTANCE);
+    /* integer finalizer to spread the sequential instances */
+    hash ^= hash >> 16;
+    hash *= 0x7feb352dUL;
+    hash ^= hash >> 15;
+
+    return hash & (Object_Name_Bucket_Size - 1);
+}
+
+/**
+ * @brief Add an Object_List index entry into the object name hash chain
+ * @param n [in] The Object_List index entry, 0..N-1
+ */
+static void Device_Object_Name_Index_Link(unsigned n)
+{
+    BACNET_CHARACTER_STRING object_name;
+    struct object_functions *pObject = NULL;
+    unsigned bucket;
+
+    characterstring_init_ansi(&object_name, "");
+    pObject = Device_Object_Functions_Find(Object_List_Index[n].type);
+    if (pObject && pObject->Object_Name) {
+        (void)pObject->Object_Name(
+            Object_List_Index[n].instance, &object_name);
+    }
+    Object_Name_Index[n].hash = Device_Object_Name_Hash(&object_name);
+    bucket = Object_Name_Index[n].hash & (Object_Name_Bucket_Size - 1);
+    Object_Name_Index[n].next = Object_Name_Bucket[bucket];
+    Object_Name_Bucket[bucket] = n;
+}
+
+/**
+ * @brief Remove an Object_List index entry from the object name hash chain
+ * @param n [in] The Object_List index entry, 0..N-1
+ */
+static void Device_Object_Name_Index_Unlink(unsigned n)
+{
+    unsigned bucket;
+    unsigned *link;
+
+    bucket = Object_Name_Index[n].hash & (Object_Name_Bucket_Size - 1);
+    link = &Object_Name_Bucket[bucket];
+    while (*link != OBJECT_NAME_INDEX_NONE) {
+        if (*link == n) {
+            *link = Object_Name_Index[n].next;
+            break;
+        }
+        link = &Object_Name_Index[*link].next;
+    }
+    Object_Name_Index[n].next = OBJECT_NAME_INDEX_NONE;
+}
+
+/**
+ * @brief Rebuild the object name hash index from the Object_List index
+ * @return True if the index is usable, false if memory was not available.
+ */
+static bool Device_Object_Name_Index_Build(void)
+{
+    struct object_name_index_entry *index = NULL;
+    unsigned *bucket = NULL;
+    unsigned *id_bucket_list = NULL;
+    unsigned bucket_size = 1;
+    unsigned n, id_bucket;
+
+    if (!Object_List_Index_Valid) {
+        return false;
+    }
+    if (Object_List_Index_Count > Object_Name_Index_Size) {
+        index = BACNET_MEMPOOL_REALLOC(
+            Object_Name_Index,
+            Object_Name_Index_Size * sizeof(struct object_name_index_entry),
+            Object_List_Index_Count * sizeof(struct object_name_index_entry));
+        if (!index) {
+            return false;
+        }
+        Object_Name_Index = index;
+        Object_Name_Index_Size = Object_List_Index_Count;
+    }
+    /* keep the load factor at or below 0.5 */
+    while (bucket_size < (Object_List_Index_Count * 2)) {
+        bucket_size <<= 1;
+    }
+    if (bucket_size > Object_Name_Bucket_Size) {
+        /* the buckets are filled in below, so they are not copied, and
+           both are replaced together to keep their size in step */
+        bucket = BACNET_MEMPOOL_CALLOC(bucket_size * sizeof(unsigned));
+        id_bucket_list = BACNET_MEMPOOL_CALLOC(bucket_size * sizeof(unsigned));
+        if (!bucket || !id_bucket_list) {
+            BACNET_MEMPOOL_FREE(bucket, bucket_size * sizeof(unsigned));
+            BACNET_MEMPOOL_FREE(
+                id_bucket_list, bucket_size * sizeof(unsigned));
+            return false;
+        }
+        BACNET_MEMPOOL_FREE(
+            Object_Name_Bucket, Object_Name_Bucket_Size * sizeof(unsigned));
+        BACNET_MEMPOOL_FREE(
+            Object_Id_Bucket, Object_Name_Bucket_Size * sizeof(unsigned));
+        Object_Name_Bucket = bucket;
+        Object_Id_Bucket = id_bucket_list;
+        Object_Name_Bucket_Size = bucket_size;
+    }
+    for (n = 0; n < Object_Name_Bucket_Size; n++) {
+        Object_Name_Bucket[n] = OBJECT_NAME_INDEX_NONE;
+        Object_Id_Bucket[n] = OBJECT_NAME_INDEX_NONE;
+    }
+    for (n = 0; n < Object_List_Index_Count; n++) {
+        Device_Object_Name_Index_Link(n);
+        id_bucket = Device_Object_Id_Bucket(
+            Object_List_Index[n].type, Object_List_Index[n].instance);
+        Object_Name_Index[n].id_next = Object_Id_Bucket[id_bucket];
+        Object_Id_Bucket[id_bucket] = n;
+    }
+    Object_Name_Index_Valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Determine if the object name hash index is usable, and
+ *  rebuild it when it is stale.
+ * @return True if the index is usable
+ */
+static bool Device_Object_Name_Index_Ready(void)
+{
+    if (!Device_Object_List_Index_Enabled()) {
+        return false;
+    }
+    /* refresh the Object_List index when stale */
+    (void)Device_Object_List_Count();
+    if (!Object_List_Index_Valid) {
+        return false;
+    }
+    if (!Object_Name_Index_Valid) {
+        (void)Device_Object_Name_Index_Build();
+    }
+
+    return Object_Name_Index_Valid;
+}
+
+/**
+ * @brief Find an object name using the object name hash index
+ * @param object_name [in] The desired Object Name to look for.
+ * @param object_type [out] The BACNET_OBJECT_TYPE of the matching Object.
+ * @param object_instance [out] The object instance number of the matching
+ * Object.
+ * @return True on success or else False if not found.
+ */
+static bool Device_Object_Name_Index_Find(
+    const BACNET_CHARACTER_STRING *object_name1,
+    BACNET_OBJECT_TYPE *object_type,
+    uint32_t *object_instance)
+{
+    BACNET_CHARACTER_STRING object_name2;
+    struct object_functions *pObject = NULL;
+    uint32_t hash;
+    unsigned n;
+
+    hash = Device_Object_Name_Hash(object_name1);
+    n = Object_Name_Bucket[hash & (Object_Name_Bucket_Size - 1)];
+    while (n != OBJECT_NAME_INDEX_NONE) {
+        if (Object_Name_Index[n].hash == hash) {
+            /* the hash only narrows the search - compare the names */
+            pObject = Device_Object_Functions_Find(Object_List_Index[n].type);
+            if ((pObject != NULL) && (pObject->Object_Name != NULL) &&
+                (pObject->Object_Name(
+                     Object_List_Index[n].instance, &object_name2) &&
+                 characterstring_same(object_name1, &object_name2))) {
+                if (object_type) {
+                    *object_type = Object_List_Index[n].type;
+                }
+                if (object_instance) {
+                    *object_instance = Object_List_Index[n].instance;
+                }
+                return true;
+            }
+        }
+        n = Object_Name_Index[n].next;
+    }
+
+    return false;
+}
+#endif
+
+/**
+ * @brief Update the object name index after an object has been renamed
+ * @note Objects renamed with WriteProperty are updated automatically.
+ *  Call this after an object is renamed from the application,
+ *  for example after Analog_Input_Name_Set().
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the renamed Object.
+ * @param object_instance [in] The object instance number of the renamed
+ *  Object.
+ */
+void Device_Object_Name_Index_Update(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+#if defined(BACNET_OBJECT_NAME_INDEX)
+    unsigned n;
+
+    Device_Property_Value_Cache_Invalidate(object_type, object_instance);
+
+    if (!Object_Name_Index_Valid) {
+        /* rebuilt on the next lookup */
+        return;
+    }
+    n = Object_Id_Bucket[Device_Object_Id_Bucket(object_type, object_instance)];
+    while (n != OBJECT_NAME_INDEX_NONE) {
+        if ((Object_List_Index[n].type == object_type) &&
+            (Object_List_Index[n].instance == object_instance)) {
+            Device_Object_Name_Index_Unlink(n);
+            Device_Object_Name_Index_Link(n);
+            return;
+        }
+        n = Object_Name_Index[n].id_next;
+    }
+    /* not in the index, so the index is stale */
+    Object_Name_Index_Valid = false;
+#else
+    Device_Property_Value_Cache_Invalidate(object_type, object_instance);
+#endif
+}
+
+/**
+ * @brief Encode a BACnetARRAY property element
+ * @param object_instance [in] BACnet network port object instance number
+ * @param array_index [in] array index requested:
+ *    0 to N for individual array members
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL to
+ * return the length of buffer if it had been built
+ * @return The length of the apdu encoded or
+ *   BACNET_STATUS_ERROR for ERROR_CODE_INVALID_ARRAY_INDEX
+ */
+int Device_Object_List_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+{
+    int apdu_len = BACNET_STATUS_ERROR;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t instance;
+    bool found;
+
+    if (object_instance == Device_Object_Instance_Number()) {
+        /* single element is zero based, add 1 for BACnetARRAY which is one
+         * based */
+        array_index++;
+        found =
+            Device_Object_List_Identifier(array_index, &object_type, &instance);
+        if (found) {
+            apdu_len =
+                encode_application_object_id(apdu, object_type, instance);
+        }
+    }
+
+    return apdu_len;
+}
+
+/** Determine if we have an object with the given object_name.
+ * If the object_type and object_instance pointers are not null,
+ * and the lookup succeeds, they will be given the resulting values.
+ * @param object_name [in] The desired Object Name to look for.
+ * @param object_type [out] The BACNET_OBJECT_TYPE of the matching Object.
+ * @param object_instance [out] The object instance number of the matching
+ * Object.
+ * @return True on success or else False if not found.
+ */
+bool Device_Valid_Object_Name(
+    const BACNET_CHARACTER_STRING *object_name1,
+    BACNET_OBJECT_TYPE *object_type,
+    uint32_t *object_instance)
+{
+    bool found = false;
+    BACNET_OBJECT_TYPE type = OBJECT_NONE;
+    uint32_t instance;
+    uint32_t max_objects = 0, i = 0;
+    bool check_id = false;
+    BACNET_CHARACTER_STRING object_name2;
+    struct object_functions *pObject = NULL;
+
+#if defined(BACNET_OBJECT_NAME_INDEX)
+    if (Device_Object_Name_Index_Ready()) {
+        return Device_Object_Name_Index_Find(
+            object_name1, object_type, object_instance);
+    }
+#endif
+    max_objects = Device_Object_List_Count();
     for (i = 1; i <= max_objects; i++) {
         check_id = Device_Object_List_Identifier(i, &type, &instance);
         if (check_id) {
@@ -1348,7 +2395,9 @@ bool Device_Valid_Object_Id(
 
     pObject = Device_Object_Functions_Find(object_type);
     if ((pObject != NULL) && (pObject->Object_Valid_Instance != NULL)) {
+        Device_Read_Lock(true);
         status = pObject->Object_Valid_Instance(object_instance);
+        Device_Read_Lock(false);
     }
 
     return status;
@@ -1486,17 +2535,211 @@ uint32_t Device_Interval_Offset(void)
 }
 #endif
 
+/**
+ * @brief Fill the Protocol_Services_Supported bits: the services that
+ *  are executed, not initiated, based on the handlers that are set
+ * @param bit_string [out] the bits of the supported services
+ */
+static void Device_Protocol_Services_Supported(BACNET_BIT_STRING *bit_string)
+{
+    unsigned i;
+
+    bitstring_init(bit_string);
+    for (i = 0; i < MAX_BACNET_SERVICES_SUPPORTED; i++) {
+        /* automatic lookup based on handlers set */
+        bitstring_set_bit(
+            bit_string, (uint8_t)i,
+            apdu_service_supported((BACNET_SERVICES_SUPPORTED)i));
+    }
+}
+
+/**
+ * @brief Fill the Protocol_Object_Types_Supported bits: the object types
+ *  that can be in this device, not the types that this device can access
+ * @param bit_string [out] the bits of the object types with objects
+ */
+static void
+Device_Protocol_Object_Types_Supported(BACNET_BIT_STRING *bit_string)
+{
+    struct object_functions *pObject = NULL;
+    unsigned i;
+
+    bitstring_init(bit_string);
+    for (i = 0; i < MAX_ASHRAE_OBJECT_TYPE; i++) {
+        /* initialize all the object types to not-supported */
+        bitstring_set_bit(bit_string, (uint8_t)i, false);
+    }
+    /* set the object types with objects to supported */
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if ((pObject->Object_Count) && (pObject->Object_Count() > 0)) {
+            bitstring_set_bit(bit_string, (uint8_t)pObject->Object_Type, true);
+        }
+        pObject++;
+    }
+}
+
+/**
+ * @brief Encode a bitstring property from its cache entry, and fill the
+ *  entry first when it is empty or was filled at another revision
+ * @param entry [in,out] the cache entry of the property
+ * @param revision [in] the current revision of the property value
+ * @param fill [in] function that fills the bits of the property value
+ * @param apdu [out] buffer for the encoded value
+ * @return the length of the encoded value
+ */
+static int Device_Bitstring_Cache_Encode(
+    struct device_bitstring_cache *entry,
+    unsigned revision,
+    void (*fill)(BACNET_BIT_STRING *bit_string),
+    uint8_t *apdu)
+{
+    BACNET_BIT_STRING bit_string = { 0 };
+    int len;
+
+    if ((entry->length == 0) || (entry->revision != revision)) {
+        entry->length = 0;
+        fill(&bit_string);
+        len = encode_application_bitstring(NULL, &bit_string);
+        if (len > (int)sizeof(entry->value)) {
+            return encode_application_bitstring(apdu, &bit_string);
+        }
+        entry->length =
+            (uint8_t)encode_application_bitstring(entry->value, &bit_string);
+        entry->revision = revision;
+    }
+    memcpy(apdu, entry->value, entry->length);
+
+    return entry->length;
+}
+
+/**
+ * @brief Encode the Protocol_Services_Supported of the current Device
+ * @param apdu [out] buffer for the encoded value
+ * @return the length of the encoded value
+ */
+static int Device_Protocol_Services_Supported_Encode(uint8_t *apdu)
+{
+    unsigned index = 0;
+
+#ifdef BAC_ROUTING
+    /* the routed Devices reject the same services, unlike the gateway */
+    if (Routed_Device_Service_Approval(
+            SERVICE_SUPPORTED_REINITIALIZE_DEVICE, 0, NULL, 0) > 0) {
+        index = 1;
+    }
+#endif
+
+    return Device_Bitstring_Cache_Encode(
+        &Services_Supported_Cache[index], apdu_service_handler_revision(),
+        Device_Protocol_Services_Supported, apdu);
+}
+
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+/**
+ * @brief Encode one change of the Object_List journal
+ * @param object_instance [in] instance of the Device object - unused
+ * @param item [in] change 1..N, from the oldest change
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ *  to return the length of buffer if it had been built
+ * @return The length of the apdu encoded
+ */
+static int Device_Object_Journal_Item_Encode(
+    uint32_t object_instance, uint32_t item, uint8_t *apdu)
+{
+    const struct device_object_journal *entry;
+    int len, apdu_len;
+
+    (void)object_instance;
+    entry = &Object_Journal
+        [(Object_Journal_Oldest + item - 1) %
+         BACNET_DEVICE_OBJECT_JOURNAL_SIZE];
+    apdu_len = encode_application_object_id(
+        apdu, entry->object_type, entry->object_instance);
+    if (apdu) {
+        apdu += apdu_len;
+    }
+    len = encode_application_enumerated(apdu, entry->change);
+    apdu_len += len;
+
+    return apdu_len;
+}
+
+/**
+ * @brief Handle a ReadRange request of the Object_List journal, where the
+ *  sequence number of each change is the Database_Revision that it made
+ * @param apdu [out] Buffer in which the APDU contents are built
+ * @param pRequest [in,out] the ReadRange request, and the result flags,
+ *  item count, and first sequence number of the reply
+ * @return The length of the apdu encoded, which could be 0
+ */
+static int
+Device_Object_Journal_Encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
+{
+    size_t apdu_size;
+
+    if (!pRequest) {
+        return 0;
+    }
+    bitstring_init(&pRequest->ResultFlags);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, false);
+    pRequest->ItemCount = 0;
+    if (Object_Journal_Count == 0) {
+        return 0;
+    }
+    apdu_size = MAX_APDU - pRequest->Overhead;
+    if (pRequest->RequestType == RR_BY_SEQUENCE) {
+        return readrange_ack_by_sequence_encode(
+            pRequest, Device_Object_Journal_Item_Encode, Object_Journal_Count,
+            Database_Revision, apdu, apdu_size);
+    }
+
+    return readrange_ack_by_position_encode(
+        pRequest, Device_Object_Journal_Item_Encode, Object_Journal_Count,
+        apdu, apdu_size);
+}
+#endif
+
+#if defined(BACNET_DEVICE_MEMORY_USAGE)
+/**
+ * @brief Encode the proprietary memory usage property of the Device:
+ *  the static bytes, the dynamic bytes, and the number of items used by
+ *  all of the registered modules, as three Unsigned values
+ * @param apdu [out] Buffer in which the APDU contents are built
+ * @param apdu_size [in] size of the buffer
+ * @return The length of the apdu encoded, or BACNET_STATUS_ABORT
+ */
+static int Device_Memory_Usage_Encode(uint8_t *apdu, size_t apdu_size)
+{
+    BACNET_MEMORY_USAGE usage = { 0 };
+    int apdu_len = 0;
+
+    memusage_total(&usage);
+    apdu_len += encode_application_unsigned(NULL, usage.static_bytes);
+    apdu_len += encode_application_unsigned(NULL, usage.dynamic_bytes);
+    apdu_len += encode_application_unsigned(NULL, usage.count);
+    if ((size_t)apdu_len > apdu_size) {
+        return BACNET_STATUS_ABORT;
+    }
+    apdu_len = encode_application_unsigned(apdu, usage.static_bytes);
+    apdu_len +=
+        encode_application_unsigned(&apdu[apdu_len], usage.dynamic_bytes);
+    apdu_len += encode_application_unsigned(&apdu[apdu_len], usage.count);
+
+    return apdu_len;
+}
+#endif
+
 /* return the length of the apdu encoded or BACNET_STATUS_ERROR for error or
    BACNET_STATUS_ABORT for abort message */
 int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
 {
     int apdu_len = 0; /* return value */
-    BACNET_BIT_STRING bit_string = { 0 };
     BACNET_CHARACTER_STRING char_string = { 0 };
-    uint32_t i = 0;
     uint32_t count = 0;
     uint8_t *apdu = NULL;
-    struct object_functions *pObject = NULL;
     uint16_t apdu_max = 0;
 
     if ((rpdata == NULL) || (rpdata->application_data == NULL) ||
@@ -1505,6 +2748,23 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
     }
     apdu = rpdata->application_data;
     apdu_max = rpdata->application_data_len;
+#if defined(BACNET_DEVICE_MEMORY_USAGE)
+    if (rpdata->object_property == PROP_DEVICE_MEMORY_USAGE) {
+        apdu_len = Device_Memory_Usage_Encode(apdu, apdu_max);
+        if (apdu_len == BACNET_STATUS_ABORT) {
+            rpdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+        }
+        return apdu_len;
+    }
+#endif
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    if (rpdata->object_property == PROP_DEVICE_OBJECT_JOURNAL) {
+        /* the journal can only be read with the ReadRange service */
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_READ_ACCESS_DENIED;
+        return BACNET_STATUS_ERROR;
+    }
+#endif
     switch (rpdata->object_property) {
         case PROP_OBJECT_IDENTIFIER:
             apdu_len = encode_application_object_id(
@@ -1580,35 +2840,12 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
                 &apdu[0], Device_Protocol_Revision());
             break;
         case PROP_PROTOCOL_SERVICES_SUPPORTED:
-            /* Note: list of services that are executed, not initiated. */
-            bitstring_init(&bit_string);
-            for (i = 0; i < MAX_BACNET_SERVICES_SUPPORTED; i++) {
-                /* automatic lookup based on handlers set */
-                bitstring_set_bit(
-                    &bit_string, (uint8_t)i,
-                    apdu_service_supported((BACNET_SERVICES_SUPPORTED)i));
-            }
-            apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
+            apdu_len = Device_Protocol_Services_Supported_Encode(&apdu[0]);
             break;
         case PROP_PROTOCOL_OBJECT_TYPES_SUPPORTED:
-            /* Note: this is the list of objects that can be in this device,
-               not a list of objects that this device can access */
-            bitstring_init(&bit_string);
-            for (i = 0; i < MAX_ASHRAE_OBJECT_TYPE; i++) {
-                /* initialize all the object types to not-supported */
-                bitstring_set_bit(&bit_string, (uint8_t)i, false);
-            }
-            /* set the object types with objects to supported */
-
-            pObject = Object_Table;
-            while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
-                if ((pObject->Object_Count) && (pObject->Object_Count() > 0)) {
-                    bitstring_set_bit(
-                        &bit_string, (uint8_t)pObject->Object_Type, true);
-                }
-                pObject++;
-            }
-            apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
+            apdu_len = Device_Bitstring_Cache_Encode(
+                &Object_Types_Supported_Cache, 0,
+                Device_Protocol_Object_Types_Supported, &apdu[0]);
             break;
         case PROP_OBJECT_LIST:
             count = Device_Object_List_Count();
@@ -1624,7 +2861,8 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
             }
             break;
         case PROP_MAX_APDU_LENGTH_ACCEPTED:
-            apdu_len = encode_application_unsigned(&apdu[0], MAX_APDU);
+            apdu_len = encode_application_unsigned(
+                &apdu[0], apdu_max_length_accepted());
             break;
         case PROP_SEGMENTATION_SUPPORTED:
             apdu_len = encode_application_enumerated(
@@ -1633,6 +2871,16 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
         case PROP_APDU_TIMEOUT:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_timeout());
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PROP_MAX_SEGMENTS_ACCEPTED:
+            apdu_len = encode_application_unsigned(
+                &apdu[0], BACNET_SEGMENTATION_SEGMENTS_MAX);
+            break;
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], apdu_segment_timeout());
+            break;
+#endif
         case PROP_NUMBER_OF_APDU_RETRIES:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_retries());
             break;
@@ -1689,62 +2937,349 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
         case PROP_TIME_OF_DEVICE_RESTART:
             apdu_len =
-                bacapp_encode_timestamp(&apdu[0], &Time_Of_Device_Restart);
-            break;
-        default:
-            rpdata->error_class = ERROR_CLASS_PROPERTY;
-            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
-            apdu_len = BACNET_STATUS_ERROR;
-            break;
+                bacapp_encode_timestamp(&apdu[0], &Time_Of_Device_Restart);
+            break;
+        default:
+            rpdata->error_class = ERROR_CLASS_PROPERTY;
+            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            apdu_len = BACNET_STATUS_ERROR;
+            break;
+    }
+
+    return apdu_len;
+}
+
+/** Looks up the common Object and Property, and encodes its Value in an
+ * APDU. Sets the error class and code if request is not appropriate.
+ * @param pObject - object table
+ * @param rpdata [in,out] Structure with the requested Object & Property info
+ *  on entry, and APDU message on return.
+ * @return The length of the APDU on success, else BACNET_STATUS_ERROR
+ */
+static int Read_Property_Common(
+    const struct object_functions *pObject, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int apdu_len = BACNET_STATUS_ERROR;
+    BACNET_CHARACTER_STRING char_string;
+    uint8_t *apdu = NULL;
+#if (BACNET_PROTOCOL_REVISION >= 14)
+    struct special_property_list_t property_list;
+#endif
+
+    if ((rpdata->application_data == NULL) ||
+        (rpdata->application_data_len == 0)) {
+        return 0;
+    }
+    apdu = rpdata->application_data;
+    if (property_list_common(rpdata->object_property)) {
+        apdu_len = property_list_common_encode(rpdata, Object_Instance_Number);
+    } else if (rpdata->object_property == PROP_OBJECT_NAME) {
+        characterstring_init_ansi(&char_string, "");
+        if (pObject->Object_Name) {
+            (void)pObject->Object_Name(rpdata->object_instance, &char_string);
+        }
+        apdu_len = encode_application_character_string(&apdu[0], &char_string);
+#if (BACNET_PROTOCOL_REVISION >= 14)
+    } else if (rpdata->object_property == PROP_PROPERTY_LIST) {
+        Device_Objects_Property_List(
+            rpdata->object_type, rpdata->object_instance, &property_list);
+        apdu_len = property_list_encode(
+            rpdata, property_list.Required.pList, property_list.Optional.pList,
+            property_list.Proprietary.pList);
+#endif
+    } else if (pObject->Object_Read_Property) {
+        apdu_len = pObject->Object_Read_Property(rpdata);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Remove the cached encoded property values of an object, after
+ *  one of them changed
+ * @note Properties written with WriteProperty, objects renamed with
+ *  Device_Object_Name_Index_Update(), and any change that increments the
+ *  Database Revision already invalidate the cache.  Call this after the
+ *  application changes the Object_Name, Description, or Units of an
+ *  object, for example after Analog_Input_Description_Set().
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object, or
+ *  OBJECT_NONE for every object
+ * @param object_instance [in] The object instance number of the Object
+ */
+void Device_Property_Value_Cache_Invalidate(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+#if defined(BACNET_PROPERTY_VALUE_CACHE)
+    unsigned i;
+
+    for (i = 0; i < BACNET_PROPERTY_VALUE_CACHE_SIZE; i++) {
+        if ((object_type == OBJECT_NONE) ||
+            ((Property_Value_Cache[i].object_type == object_type) &&
+             (Property_Value_Cache[i].object_instance == object_instance))) {
+            Property_Value_Cache[i].length = 0;
+        }
+    }
+#else
+    (void)object_type;
+    (void)object_instance;
+#endif
+}
+
+#if defined(BACNET_PROPERTY_VALUE_CACHE)
+/**
+ * @brief Find the cache entry of a property value that can be cached
+ * @param rpdata [in] The requested Object and Property
+ * @return the cache entry for the property, which may hold the value of
+ *  another property, or NULL if the property is not cached
+ */
+static struct property_value_cache_entry *
+Device_Property_Value_Cache_Entry(const BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    uint32_t hash;
+
+    if (rpdata->array_index != BACNET_ARRAY_ALL) {
+        return NULL;
+    }
+    switch (rpdata->object_property) {
+        case PROP_OBJECT_NAME:
+        case PROP_DESCRIPTION:
+        case PROP_UNITS:
+        case PROP_PROPERTY_LIST:
+            break;
+        default:
+            return NULL;
+    }
+    hash = ((uint32_t)rpdata->object_type * 31UL) + rpdata->object_instance;
+    hash = (hash * 31UL) + (uint32_t)rpdata->object_property;
+
+    return &Property_Value_Cache[hash % BACNET_PROPERTY_VALUE_CACHE_SIZE];
+}
+
+/**
+ * @brief Read a property value from the cache, or from the object and
+ *  keep the encoded value in the cache
+ * @param pObject - object table
+ * @param rpdata [in,out] Structure with the requested Object & Property info
+ *  on entry, and APDU message on return.
+ * @return The length of the APDU on success, else BACNET_STATUS_ERROR
+ */
+static int Read_Property_Cached(
+    const struct object_functions *pObject, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    struct property_value_cache_entry *entry;
+    int apdu_len;
+
+    entry = Device_Property_Value_Cache_Entry(rpdata);
+    if (!entry) {
+        return Read_Property_Common(pObject, rpdata);
+    }
+    if ((entry->length > 0) && (entry->object_type == rpdata->object_type) &&
+        (entry->object_instance == rpdata->object_instance) &&
+        (entry->object_property == rpdata->object_property) &&
+        (entry->length <= rpdata->application_data_len)) {
+        memcpy(rpdata->application_data, entry->value, entry->length);
+        return entry->length;
+    }
+    apdu_len = Read_Property_Common(pObject, rpdata);
+    if ((apdu_len > 0) && (apdu_len <= rpdata->application_data_len) &&
+        (apdu_len <= BACNET_PROPERTY_VALUE_CACHE_BYTES)) {
+        entry->object_type = rpdata->object_type;
+        entry->object_instance = rpdata->object_instance;
+        entry->object_property = rpdata->object_property;
+        entry->length = (uint16_t)apdu_len;
+        memcpy(entry->value, rpdata->application_data, apdu_len);
+    }
+
+    return apdu_len;
+}
+#endif
+
+#if defined(BACNET_DEVICE_SNAPSHOT)
+/**
+ * @brief Copy the read-mostly Device properties, and publish the copy for
+ *  the readers, unless a current copy is already published
+ * @note Called with the objects locked, which serializes the writers
+ */
+static void Device_Snapshot_Update(void)
+{
+    struct device_snapshot *snapshot;
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t instance = 0;
+    unsigned count, object_revision, i;
+    size_t size;
+
+    object_revision = Device_Object_Revision();
+    snapshot = rcu_dereference(&Device_Snapshot);
+    if (snapshot && (snapshot->object_revision == object_revision) &&
+        (snapshot->services_revision == apdu_service_handler_revision())) {
+        return;
+    }
+    count = Device_Object_List_Count();
+    /* the identifiers follow the copy in the same allocation */
+    size = sizeof(struct device_snapshot) + (count * sizeof(BACNET_OBJECT_ID));
+    snapshot = BACNET_MEMPOOL_CALLOC(size);
+    if (!snapshot) {
+        return;
+    }
+    snapshot->size = size;
+    snapshot->object_list = (BACNET_OBJECT_ID *)(void *)(snapshot + 1);
+    for (i = 0; i < count; i++) {
+        if (!Device_Object_List_Identifier(i + 1, &object_type, &instance)) {
+            break;
+        }
+        snapshot->object_list[i].type = object_type;
+        snapshot->object_list[i].instance = instance;
+    }
+    snapshot->object_count = i;
+    snapshot->object_revision = object_revision;
+    snapshot->services_revision = apdu_service_handler_revision();
+    Device_Protocol_Services_Supported(&snapshot->services_supported);
+    Device_Protocol_Object_Types_Supported(&snapshot->object_types_supported);
+    Device_Snapshot_Free(
+        rcu_publish(&Device_Snapshot_Domain, &Device_Snapshot, snapshot));
+}
+
+/**
+ * @brief Encode a property from the published copy
+ * @param snapshot [in] the published copy
+ * @param rpdata [in,out] the requested property, and its encoded value
+ * @return The length of the APDU on success, else BACNET_STATUS_ERROR
+ *  or BACNET_STATUS_ABORT
+ */
+static int Device_Snapshot_Encode(
+    const struct device_snapshot *snapshot, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    uint8_t *apdu = rpdata->application_data;
+    int apdu_max = rpdata->application_data_len;
+    int apdu_len = 0;
+    unsigned i;
+
+    if (rpdata->object_property == PROP_PROTOCOL_SERVICES_SUPPORTED) {
+        apdu_len =
+            encode_application_bitstring(NULL, &snapshot->services_supported);
+        if (apdu_len > apdu_max) {
+            apdu_len = BACNET_STATUS_ABORT;
+        } else {
+            apdu_len = encode_application_bitstring(
+                apdu, &snapshot->services_supported);
+        }
+    } else if (
+        rpdata->object_property == PROP_PROTOCOL_OBJECT_TYPES_SUPPORTED) {
+        apdu_len = encode_application_bitstring(
+            NULL, &snapshot->object_types_supported);
+        if (apdu_len > apdu_max) {
+            apdu_len = BACNET_STATUS_ABORT;
+        } else {
+            apdu_len = encode_application_bitstring(
+                apdu, &snapshot->object_types_supported);
+        }
+    } else if (rpdata->array_index == 0) {
+        /* Array element zero is the number of objects in the list */
+        apdu_len = encode_application_unsigned(NULL, snapshot->object_count);
+        if (apdu_len > apdu_max) {
+            apdu_len = BACNET_STATUS_ABORT;
+        } else {
+            apdu_len =
+                encode_application_unsigned(apdu, snapshot->object_count);
+        }
+    } else if (rpdata->array_index == BACNET_ARRAY_ALL) {
+        for (i = 0; i < snapshot->object_count; i++) {
+            apdu_len += encode_application_object_id(
+                NULL, snapshot->object_list[i].type,
+                snapshot->object_list[i].instance);
+        }
+        if (apdu_len > apdu_max) {
+            apdu_len = BACNET_STATUS_ABORT;
+        } else {
+            apdu_len = 0;
+            for (i = 0; i < snapshot->object_count; i++) {
+                apdu_len += encode_application_object_id(
+                    &apdu[apdu_len], snapshot->object_list[i].type,
+                    snapshot->object_list[i].instance);
+            }
+        }
+    } else if (rpdata->array_index <= snapshot->object_count) {
+        i = rpdata->array_index - 1;
+        apdu_len = encode_application_object_id(
+            NULL, snapshot->object_list[i].type,
+            snapshot->object_list[i].instance);
+        if (apdu_len > apdu_max) {
+            apdu_len = BACNET_STATUS_ABORT;
+        } else {
+            apdu_len = encode_application_object_id(
+                apdu, snapshot->object_list[i].type,
+                snapshot->object_list[i].instance);
+        }
+    } else {
+        apdu_len = BACNET_STATUS_ERROR;
+    }
+    if (apdu_len == BACNET_STATUS_ABORT) {
+        rpdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+    } else if (apdu_len == BACNET_STATUS_ERROR) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_INVALID_ARRAY_INDEX;
     }
 
     return apdu_len;
 }
 
-/** Looks up the common Object and Property, and encodes its Value in an
- * APDU. Sets the error class and code if request is not appropriate.
- * @param pObject - object table
- * @param rpdata [in,out] Structure with the requested Object & Property info
- *  on entry, and APDU message on return.
- * @return The length of the APDU on success, else BACNET_STATUS_ERROR
+/**
+ * @brief Read the Object_List, Protocol_Services_Supported, or
+ *  Protocol_Object_Types_Supported of this Device from the published copy,
+ *  without locking the objects.  The copy is withdrawn when the Database
+ *  Revision changes, and is made again when an object was created or
+ *  deleted, see Device_Object_Revision(), or the service handlers differ
+ *  from the copy.
+ * @param rpdata [in,out] the requested property, and its encoded value
+ * @param apdu_len [out] The length of the APDU on success, else
+ *  BACNET_STATUS_ERROR or BACNET_STATUS_ABORT
+ * @return true if the property was read from the copy
  */
-static int Read_Property_Common(
-    const struct object_functions *pObject, BACNET_READ_PROPERTY_DATA *rpdata)
+static bool
+Device_Snapshot_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata, int *apdu_len)
 {
-    int apdu_len = BACNET_STATUS_ERROR;
-    BACNET_CHARACTER_STRING char_string;
-    uint8_t *apdu = NULL;
-#if (BACNET_PROTOCOL_REVISION >= 14)
-    struct special_property_list_t property_list;
-#endif
+    struct device_snapshot *snapshot;
+    unsigned phase;
 
-    if ((rpdata->application_data == NULL) ||
+    if ((rpdata->object_type != OBJECT_DEVICE) ||
+        (rpdata->object_instance != Object_Instance_Number) ||
+        !Device_Object_List_Index_Enabled() ||
+        (rpdata->application_data == NULL) ||
         (rpdata->application_data_len == 0)) {
-        return 0;
+        return false;
     }
-    apdu = rpdata->application_data;
-    if (property_list_common(rpdata->object_property)) {
-        apdu_len = property_list_common_encode(rpdata, Object_Instance_Number);
-    } else if (rpdata->object_property == PROP_OBJECT_NAME) {
-        characterstring_init_ansi(&char_string, "");
-        if (pObject->Object_Name) {
-            (void)pObject->Object_Name(rpdata->object_instance, &char_string);
-        }
-        apdu_len = encode_application_character_string(&apdu[0], &char_string);
-#if (BACNET_PROTOCOL_REVISION >= 14)
-    } else if (rpdata->object_property == PROP_PROPERTY_LIST) {
-        Device_Objects_Property_List(
-            rpdata->object_type, rpdata->object_instance, &property_list);
-        apdu_len = property_list_encode(
-            rpdata, property_list.Required.pList, property_list.Optional.pList,
-            property_list.Proprietary.pList);
-#endif
-    } else if (pObject->Object_Read_Property) {
-        apdu_len = pObject->Object_Read_Property(rpdata);
+    switch (rpdata->object_property) {
+        case PROP_OBJECT_LIST:
+            break;
+        case PROP_PROTOCOL_SERVICES_SUPPORTED:
+        case PROP_PROTOCOL_OBJECT_TYPES_SUPPORTED:
+            if (rpdata->array_index != BACNET_ARRAY_ALL) {
+                /* the common error handling applies */
+                return false;
+            }
+            break;
+        default:
+            return false;
     }
+    phase = rcu_read_lock(&Device_Snapshot_Domain);
+    snapshot = rcu_dereference(&Device_Snapshot);
+    if (!snapshot || (snapshot->object_revision != Device_Object_Revision()) ||
+        (snapshot->services_revision != apdu_service_handler_revision())) {
+        rcu_read_unlock(&Device_Snapshot_Domain, phase);
+        Device_Read_Lock(true);
+        Device_Snapshot_Update();
+        Device_Read_Lock(false);
+        phase = rcu_read_lock(&Device_Snapshot_Domain);
+        snapshot = rcu_dereference(&Device_Snapshot);
+    }
+    if (snapshot) {
+        *apdu_len = Device_Snapshot_Encode(snapshot, rpdata);
+    }
+    rcu_read_unlock(&Device_Snapshot_Domain, phase);
 
-    return apdu_len;
+    return (snapshot != NULL);
 }
+#endif
 
 /** Looks up the requested Object and Property, and encodes its Value in an
  * APDU.
@@ -1763,15 +3298,26 @@ int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
     /* initialize the default return values */
     rpdata->error_class = ERROR_CLASS_OBJECT;
     rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+#if defined(BACNET_DEVICE_SNAPSHOT)
+    if (Device_Snapshot_Read_Property(rpdata, &apdu_len)) {
+        return apdu_len;
+    }
+#endif
     pObject = Device_Object_Functions_Find(rpdata->object_type);
     if (pObject != NULL) {
+        Device_Read_Lock(true);
         if (pObject->Object_Valid_Instance &&
             pObject->Object_Valid_Instance(rpdata->object_instance)) {
+#if defined(BACNET_PROPERTY_VALUE_CACHE)
+            apdu_len = Read_Property_Cached(pObject, rpdata);
+#else
             apdu_len = Read_Property_Common(pObject, rpdata);
+#endif
         } else {
             rpdata->error_class = ERROR_CLASS_OBJECT;
             rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
         }
+        Device_Read_Lock(false);
     } else {
         rpdata->error_class = ERROR_CLASS_OBJECT;
         rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
@@ -2090,6 +3636,16 @@ void Device_Write_Property_Store_Callback_Set(write_property_function cb)
     Device_Write_Property_Store_Callback = cb;
 }
 
+/**
+ * @brief Set the callback that locks the objects while the read services
+ *  are run by worker threads.  The objects are read one thread at a time.
+ * @param cb [in] The function to be called, or NULL for a single thread
+ */
+void Device_Read_Lock_Callback_Set(device_read_lock_function cb)
+{
+    Device_Read_Lock_Callback = cb;
+}
+
 /**
  * @brief Store the value of a property when WriteProperty is successful
  */
@@ -2100,6 +3656,48 @@ static void Device_Write_Property_Store(BACNET_WRITE_PROPERTY_DATA *wp_data)
     }
 }
 
+/* object types with a setter for primitive values that skips the generic
+   decode of the WriteProperty value */
+static const struct {
+    BACNET_OBJECT_TYPE object_type;
+    write_property_typed_function write_property;
+} My_Typed_Write_Table[] = {
+    { OBJECT_ANALOG_OUTPUT, Analog_Output_Write_Property_Typed },
+    { OBJECT_ANALOG_VALUE, Analog_Value_Write_Property_Typed },
+};
+
+/**
+ * @brief Write a property of an object, through its typed setter when the
+ *  value is a primitive that the setter takes
+ * @param pObject - functions of the object type
+ * @param wp_data - WriteProperty request, with space for the error
+ * @return true if the value was written
+ */
+static bool Device_Write_Property_Object(
+    const struct object_functions *pObject,
+    BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    BACNET_WRITE_PROPERTY_PRIMITIVE value = { 0 };
+    write_property_typed_function typed_write = NULL;
+    unsigned i;
+    int result = 0;
+
+    for (i = 0; i < ARRAY_SIZE(My_Typed_Write_Table); i++) {
+        if (My_Typed_Write_Table[i].object_type == pObject->Object_Type) {
+            typed_write = My_Typed_Write_Table[i].write_property;
+            break;
+        }
+    }
+    if (typed_write && write_property_primitive_decode(wp_data, &value)) {
+        result = typed_write(wp_data, &value);
+    }
+    if (result == 0) {
+        return pObject->Object_Write_Property(wp_data);
+    }
+
+    return result > 0;
+}
+
 /** Looks up the requested Object and Property, and set the new Value in it,
  *  if allowed.
  * If the Object or Property can't be found, sets the error class and code.
@@ -2132,10 +3730,25 @@ bool Device_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                 if (wp_data->object_property == PROP_OBJECT_NAME) {
                     status = Device_Write_Property_Object_Name(
                         wp_data, pObject->Object_Write_Property);
+                    if (status && (wp_data->object_type == OBJECT_DEVICE)) {
+                        /* the Device object counts its own renames */
+                        Device_Object_Name_Index_Update(
+                            wp_data->object_type, wp_data->object_instance);
+                    } else if (status) {
+                        Device_Object_Changed(
+                            wp_data->object_type, wp_data->object_instance,
+                            DEVICE_OBJECT_CHANGE_RENAMED);
+                    }
                 } else {
-                    status = pObject->Object_Write_Property(wp_data);
+                    status = Device_Write_Property_Object(pObject, wp_data);
                 }
                 if (status) {
+                    Device_Property_Value_Cache_Invalidate(
+                        wp_data->object_type, wp_data->object_instance);
+                    if (wp_data->object_property ==
+                        PROP_EVENT_DETECTION_ENABLE) {
+                        Device_Local_Reporting_Invalidate();
+                    }
                     Device_Write_Property_Store(wp_data);
                 }
             } else {
@@ -2375,7 +3988,9 @@ bool Device_Create_Object(BACNET_CREATE_OBJECT_DATA *data)
                 } else {
                     /* required by ACK */
                     data->object_instance = object_instance;
-                    Device_Inc_Database_Revision();
+                    Device_Object_Changed(
+                        data->object_type, object_instance,
+                        DEVICE_OBJECT_CHANGE_CREATED);
                     status = true;
                 }
             }
@@ -2414,7 +4029,9 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
             /* The object being deleted must already exist */
             status = pObject->Object_Delete(data->object_instance);
             if (status) {
-                Device_Inc_Database_Revision();
+                Device_Object_Changed(
+                    data->object_type, data->object_instance,
+                    DEVICE_OBJECT_CHANGE_DELETED);
             } else {
                 /* The object exists but cannot be deleted. */
                 data->error_class = ERROR_CLASS_OBJECT;
@@ -2434,8 +4051,274 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
     return status;
 }
 
+/* object types with bulk create and delete, found by their Object_Create
+   so that an application table with other object functions is not used */
+static const struct device_object_bulk {
+    create_object_function Object_Create;
+    object_bulk_function Object_Create_Bulk;
+    object_bulk_function Object_Delete_Bulk;
+} Device_Object_Bulk_Table[] = {
+    { Analog_Value_Create, Analog_Value_Create_Bulk,
+      Analog_Value_Delete_Bulk },
+};
+
+/**
+ * @brief Find the bulk create and delete functions of an object type
+ * @param pObject - object functions of the object type
+ * @return the bulk functions, or NULL if the object type has none
+ */
+static const struct device_object_bulk *
+Device_Object_Bulk_Find(const struct object_functions *pObject)
+{
+    unsigned i;
+
+    for (i = 0; i < ARRAY_SIZE(Device_Object_Bulk_Table); i++) {
+        if (pObject->Object_Create &&
+            (pObject->Object_Create ==
+             Device_Object_Bulk_Table[i].Object_Create)) {
+            return &Device_Object_Bulk_Table[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Compare two object instances for sorting
+ * @param a - pointer to the first object instance
+ * @param b - pointer to the second object instance
+ * @return negative, zero, or positive as a is less, equal, or greater
+ */
+static int Device_Object_Instance_Compare(const void *a, const void *b)
+{
+    uint32_t instance_a = *(const uint32_t *)a;
+    uint32_t instance_b = *(const uint32_t *)b;
+
+    return (instance_a > instance_b) - (instance_a < instance_b);
+}
+
+/**
+ * @brief Creates many objects of one type at once, and increments the
+ *  Database_Revision once. Object types without a bulk create have their
+ *  objects created one at a time in ascending instance order.
+ * @ingroup ObjHelpers
+ * @param object_type - type of the objects to create
+ * @param object_instances - array of object-instance numbers, which is
+ *  sorted in place. Instances that already exist are skipped.
+ * @param count - number of object-instance numbers in the array
+ * @return the number of objects that were created
+ */
+unsigned Device_Create_Objects(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instances, unsigned count)
+{
+    const struct device_object_bulk *pBulk = NULL;
+    struct object_functions *pObject = NULL;
+    unsigned created = 0, i;
+
+    pObject = Device_Object_Functions_Find(object_type);
+    if (!pObject || !pObject->Object_Create || !object_instances) {
+        return 0;
+    }
+    pBulk = Device_Object_Bulk_Find(pObject);
+    if (pBulk) {
+        created = pBulk->Object_Create_Bulk(object_instances, count);
+    } else {
+        qsort(
+            object_instances, count, sizeof(uint32_t),
+            Device_Object_Instance_Compare);
+        for (i = 0; i < count; i++) {
+            if ((object_instances[i] >= BACNET_MAX_INSTANCE) ||
+                (pObject->Object_Valid_Instance &&
+                 pObject->Object_Valid_Instance(object_instances[i]))) {
+                continue;
+            }
+            if (pObject->Object_Create(object_instances[i]) ==
+                object_instances[i]) {
+                created++;
+            }
+        }
+    }
+    if (created > 0) {
+        Device_Inc_Database_Revision();
+    }
+
+    return created;
+}
+
+/**
+ * @brief Deletes many objects of one type at once, and increments the
+ *  Database_Revision once.
+ * @ingroup ObjHelpers
+ * @param object_type - type of the objects to delete
+ * @param object_instances - array of object-instance numbers, which is
+ *  sorted in place
+ * @param count - number of object-instance numbers in the array
+ * @return the number of objects that were deleted
+ */
+unsigned Device_Delete_Objects(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instances, unsigned count)
+{
+    const struct device_object_bulk *pBulk = NULL;
+    struct object_functions *pObject = NULL;
+    unsigned deleted = 0, i;
+
+    pObject = Device_Object_Functions_Find(object_type);
+    if (!pObject || !pObject->Object_Delete || !object_instances) {
+        return 0;
+    }
+    pBulk = Device_Object_Bulk_Find(pObject);
+    if (pBulk) {
+        deleted = pBulk->Object_Delete_Bulk(object_instances, count);
+    } else {
+        qsort(
+            object_instances, count, sizeof(uint32_t),
+            Device_Object_Instance_Compare);
+        /* from the end, so that fewer objects are moved in each list */
+        for (i = count; i > 0; i--) {
+            if (pObject->Object_Delete(object_instances[i - 1])) {
+                deleted++;
+            }
+        }
+    }
+    if (deleted > 0) {
+        Device_Inc_Database_Revision();
+    }
+
+    return deleted;
+}
+
+/**
+ * @brief Mark the list of objects evaluated by Device_local_reporting()
+ *  as stale, so that it is rebuilt on the next evaluation.
+ * @note Changes to the Database Revision, and writes of the
+ *  Event_Detection_Enable property with WriteProperty, already invalidate
+ *  the list.  Call this after enabling event detection of an object
+ *  directly from the application.
+ */
+void Device_Local_Reporting_Invalidate(void)
+{
+#if defined(INTRINSIC_REPORTING)
+    Reporting_List_Valid = false;
+#endif
+}
+
 #if defined(INTRINSIC_REPORTING)
-void Device_local_reporting(void)
+/**
+ * @brief Determine if event detection is enabled in an object
+ * @param pObject [in] The object type functions
+ * @param object_instance [in] The object instance number
+ * @return false only if Event_Detection_Enable is FALSE
+ */
+static bool Device_Local_Reporting_Enabled(
+    const struct object_functions *pObject, uint32_t object_instance)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    uint8_t apdu[16] = { 0 };
+    bool enabled = true;
+    int len;
+
+    if (pObject->Object_Read_Property) {
+        rpdata.object_type = pObject->Object_Type;
+        rpdata.object_instance = object_instance;
+        rpdata.object_property = PROP_EVENT_DETECTION_ENABLE;
+        rpdata.array_index = BACNET_ARRAY_ALL;
+        rpdata.application_data = apdu;
+        rpdata.application_data_len = sizeof(apdu);
+        len = pObject->Object_Read_Property(&rpdata);
+        if (len > 0) {
+            /* objects without the property are always evaluated */
+            (void)bacnet_boolean_application_decode(apdu, len, &enabled);
+        }
+    }
+
+    return enabled;
+}
+
+/**
+ * @brief Get the count of objects whose type has intrinsic reporting
+ * @return The count of objects
+ */
+static unsigned Device_Local_Reporting_Objects(void)
+{
+    struct object_functions *pObject = NULL;
+    unsigned count = 0;
+
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Intrinsic_Reporting && pObject->Object_Count) {
+            count += pObject->Object_Count();
+        }
+        pObject++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Build the list of objects evaluated by Device_local_reporting()
+ *  from the objects with intrinsic reporting and event detection enabled
+ * @param count [in] The count of objects whose type has intrinsic reporting
+ * @return true if the list was built
+ */
+static bool Device_Local_Reporting_Build(unsigned count)
+{
+    struct reporting_list_entry *list = NULL;
+    struct object_functions *pObject = NULL;
+    unsigned object_count = 0;
+    unsigned object_index = 0;
+    uint32_t object_instance = 0;
+    unsigned i = 0, n = 0;
+
+    Reporting_List_Valid = false;
+    Reporting_List_Revision = Device_Object_Revision();
+    if (count > Reporting_List_Size) {
+        list = BACNET_MEMPOOL_REALLOC(
+            Reporting_List, Reporting_List_Size * sizeof(*list),
+            count * sizeof(*list));
+        if (!list) {
+            return false;
+        }
+        Reporting_List = list;
+        Reporting_List_Size = count;
+    }
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Intrinsic_Reporting && pObject->Object_Count &&
+            pObject->Object_Index_To_Instance) {
+            object_count = pObject->Object_Count();
+            if (pObject->Object_Iterator) {
+                object_index = pObject->Object_Iterator(~(unsigned)0);
+            } else {
+                object_index = 0;
+            }
+            for (i = 0; (i < object_count) && (n < count); i++) {
+                object_instance =
+                    pObject->Object_Index_To_Instance(object_index);
+                if (Device_Local_Reporting_Enabled(pObject, object_instance)) {
+                    Reporting_List[n].pObject = pObject;
+                    Reporting_List[n].instance = object_instance;
+                    n++;
+                }
+                if (pObject->Object_Iterator) {
+                    object_index = pObject->Object_Iterator(object_index);
+                } else {
+                    object_index++;
+                }
+            }
+        }
+        pObject++;
+    }
+    Reporting_List_Count = n;
+    Reporting_List_Valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Run the intrinsic reporting of every object whose type has
+ *  intrinsic reporting, without the list
+ */
+static void Device_Local_Reporting_Scan(void)
 {
     struct object_functions *pObject = NULL;
     uint32_t objects_count = 0;
@@ -2444,11 +4327,8 @@ void Device_local_reporting(void)
     uint32_t idx = 0;
 
     objects_count = Device_Object_List_Count();
-
-    /* loop for all objects */
     for (idx = 1; idx <= objects_count; idx++) {
         Device_Object_List_Identifier(idx, &object_type, &object_instance);
-
         pObject = Device_Object_Functions_Find(object_type);
         if (pObject != NULL) {
             if (pObject->Object_Valid_Instance &&
@@ -2460,6 +4340,40 @@ void Device_local_reporting(void)
         }
     }
 }
+
+/**
+ * @brief Run the intrinsic reporting of the objects that have
+ *  event detection enabled
+ * @note The objects with event detection enabled are kept in a list, so
+ *  that the cost of each call scales with the number of objects being
+ *  watched rather than with the number of objects in the device.
+ *  The list is rebuilt when the Database Revision changes, when an object
+ *  is created or deleted, see Device_Object_Revision(), or after
+ *  Device_Local_Reporting_Invalidate().  Without memory for the list,
+ *  every object is evaluated.
+ */
+void Device_local_reporting(void)
+{
+    struct reporting_list_entry *entry = NULL;
+    unsigned i = 0;
+
+    if (!Reporting_List_Valid ||
+        (Reporting_List_Revision != Device_Object_Revision())) {
+        if (!Device_Local_Reporting_Build(Device_Local_Reporting_Objects())) {
+            Device_Local_Reporting_Scan();
+            return;
+        }
+    }
+    for (i = 0; i < Reporting_List_Count; i++) {
+        entry = &Reporting_List[i];
+        /* an object can be deleted by the reporting of another */
+        if (entry->pObject->Object_Valid_Instance &&
+            !entry->pObject->Object_Valid_Instance(entry->instance)) {
+            continue;
+        }
+        entry->pObject->Object_Intrinsic_Reporting(entry->instance);
+    }
+}
 #endif
 
 /** Looks up the requested Object to see if the functionality is supported.
@@ -2491,6 +4405,126 @@ struct object_functions *Device_Object_Functions(void)
     return Object_Table;
 }
 
+/* direct accessors of the Present_Value of local objects, which the
+   Loop and Timer objects use instead of ReadProperty and WriteProperty */
+static const struct device_loop_accessor {
+    BACNET_OBJECT_TYPE object_type;
+    LOOP_REAL_ACCESSOR accessor;
+} Device_Loop_Accessors[] = {
+    { OBJECT_ANALOG_INPUT,
+      { Analog_Input_Valid_Instance, Analog_Input_Present_Value, NULL } },
+    { OBJECT_ANALOG_OUTPUT,
+      { Analog_Output_Valid_Instance, Analog_Output_Present_Value,
+        Analog_Output_Present_Value_Write } },
+    { OBJECT_ANALOG_VALUE,
+      { Analog_Value_Valid_Instance, Analog_Value_Present_Value,
+        Analog_Value_Present_Value_Write } },
+    { OBJECT_LOOP, { Loop_Valid_Instance, Loop_Present_Value, NULL } },
+};
+
+/**
+ * @brief Finds the direct accessor of an object property that a Loop
+ *  object references
+ * @param reference - object property reference of a loop
+ * @return the accessor, or NULL to use ReadProperty and WriteProperty
+ */
+static const LOOP_REAL_ACCESSOR *
+Device_Loop_Real_Accessor(const BACNET_OBJECT_PROPERTY_REFERENCE *reference)
+{
+    unsigned i;
+
+    if ((reference->property_identifier != PROP_PRESENT_VALUE) ||
+        (reference->property_array_index != BACNET_ARRAY_ALL)) {
+        return NULL;
+    }
+    for (i = 0; i < ARRAY_SIZE(Device_Loop_Accessors); i++) {
+        if (Device_Loop_Accessors[i].object_type ==
+            reference->object_identifier.type) {
+            return &Device_Loop_Accessors[i].accessor;
+        }
+    }
+
+    return NULL;
+}
+
+/* memory reports of the object types, registered for the object types
+   that are in the object table */
+static const struct device_memory_usage {
+    BACNET_OBJECT_TYPE object_type;
+    const char *name;
+    memusage_function function;
+} Device_Memory_Usage[] = {
+    { OBJECT_ANALOG_INPUT, "analog-input", Analog_Input_Memory_Usage },
+    { OBJECT_ANALOG_OUTPUT, "analog-output", Analog_Output_Memory_Usage },
+    { OBJECT_ANALOG_VALUE, "analog-value", Analog_Value_Memory_Usage },
+    { OBJECT_BINARY_INPUT, "binary-input", Binary_Input_Memory_Usage },
+    { OBJECT_BINARY_OUTPUT, "binary-output", Binary_Output_Memory_Usage },
+    { OBJECT_BINARY_VALUE, "binary-value", Binary_Value_Memory_Usage },
+    { OBJECT_BINARY_LIGHTING_OUTPUT, "binary-lighting-output",
+      Binary_Lighting_Output_Memory_Usage },
+    { OBJECT_BITSTRING_VALUE, "bitstring-value",
+      BitString_Value_Memory_Usage },
+    { OBJECT_CALENDAR, "calendar", Calendar_Memory_Usage },
+    { OBJECT_CHANNEL, "channel", Channel_Memory_Usage },
+    { OBJECT_CHARACTERSTRING_VALUE, "characterstring-value",
+      CharacterString_Value_Memory_Usage },
+    { OBJECT_COLOR, "color", Color_Memory_Usage },
+    { OBJECT_COLOR_TEMPERATURE, "color-temperature",
+      Color_Temperature_Memory_Usage },
+#if defined(BACFILE)
+    { OBJECT_FILE, "file", bacfile_memory_usage },
+#endif
+    { OBJECT_INTEGER_VALUE, "integer-value", Integer_Value_Memory_Usage },
+    { OBJECT_LIFE_SAFETY_POINT, "life-safety-point",
+      Life_Safety_Point_Memory_Usage },
+    { OBJECT_LIFE_SAFETY_ZONE, "life-safety-zone",
+      Life_Safety_Zone_Memory_Usage },
+    { OBJECT_LIGHTING_OUTPUT, "lighting-output",
+      Lighting_Output_Memory_Usage },
+    { OBJECT_LOAD_CONTROL, "load-control", Load_Control_Memory_Usage },
+    { OBJECT_LOOP, "loop", Loop_Memory_Usage },
+    { OBJECT_MULTI_STATE_INPUT, "multi-state-input",
+      Multistate_Input_Memory_Usage },
+    { OBJECT_MULTI_STATE_OUTPUT, "multi-state-output",
+      Multistate_Output_Memory_Usage },
+    { OBJECT_MULTI_STATE_VALUE, "multi-state-value",
+      Multistate_Value_Memory_Usage },
+    { OBJECT_PROGRAM, "program", Program_Memory_Usage },
+    { OBJECT_STRUCTURED_VIEW, "structured-view",
+      Structured_View_Memory_Usage },
+    { OBJECT_TIME_VALUE, "time-value", Time_Value_Memory_Usage },
+    { OBJECT_TIMER, "timer", Timer_Memory_Usage },
+    { OBJECT_TRENDLOG, "trend-log", Trend_Log_Memory_Usage },
+};
+
+/**
+ * @brief Register the memory reports of the stack modules and of the
+ *  object types in the object table, see memusage_debug_print()
+ */
+static void Device_Memory_Usage_Init(void)
+{
+    size_t i;
+
+    memusage_register("address-cache", address_memory_usage);
+    memusage_register("cov-subscriptions", handler_cov_memory_usage);
+#if (MAX_TSM_TRANSACTIONS)
+    memusage_register("tsm", tsm_memory_usage);
+#endif
+#if defined(BACNET_STRING_POOL)
+    memusage_register("string-pool", strpool_memory_usage);
+#endif
+#if defined(BACNET_MEMPOOL)
+    /* the pools also hold the dynamic bytes of the other modules */
+    memusage_register("memory-pools", mempool_memory_usage);
+#endif
+    for (i = 0; i < ARRAY_SIZE(Device_Memory_Usage); i++) {
+        if (Device_Object_Functions_Find(Device_Memory_Usage[i].object_type)) {
+            memusage_register(
+                Device_Memory_Usage[i].name, Device_Memory_Usage[i].function);
+        }
+    }
+}
+
 /** Initialize the Device Object.
  Initialize the group of object helper functions for any supported Object.
  Initialize each of the Device Object child Object instances.
@@ -2509,6 +4543,8 @@ void Device_Init(object_functions_t *object_table)
     } else {
         Object_Table = &My_Object_Table[0];
     }
+    Device_Object_Table_Index_Init();
+    Device_Object_Revision_Init();
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
         if (pObject->Object_Init) {
@@ -2516,6 +4552,11 @@ void Device_Init(object_functions_t *object_table)
         }
         pObject++;
     }
+    Device_Object_List_Index_Invalidate();
+    Device_Memory_Usage_Init();
+#if defined(BACNET_PROPERTY_LIST_CACHE)
+    Device_Property_List_Cache_Init();
+#endif
 #if (BACNET_PROTOCOL_REVISION >= 14)
     /* link WriteProperty to Channel object for members */
     Channel_Write_Property_Internal_Callback_Set(Device_Write_Property);
@@ -2523,6 +4564,29 @@ void Device_Init(object_functions_t *object_table)
     /* link ReadProperty and WriteProperty to Loop object for references */
     Loop_Read_Property_Internal_Callback_Set(Device_Read_Property);
     Loop_Write_Property_Internal_Callback_Set(Device_Write_Property);
+    /* bind Loop references to local objects, and run the loops together */
+    Loop_Real_Accessor_Callback_Set(Device_Loop_Real_Accessor);
+    Device_Timer_Batch_Set(OBJECT_LOOP, Loop_Timer_Batch);
+    /* link WriteProperty to Timer object for its list of references */
+    Timer_Write_Property_Internal_Callback_Set(Device_Write_Property);
+    Timer_Real_Accessor_Callback_Set(Device_Loop_Real_Accessor);
+    /* link WriteProperty to Command object for its action lists */
+    Command_Write_Property_Internal_Callback_Set(Device_Write_Property);
+    Command_Real_Accessor_Callback_Set(Device_Loop_Real_Accessor);
+    /* link Calendar object changes to Schedule objects that refer to them */
+    Calendar_Present_Value_Change_Callback_Set(
+        Schedule_Calendar_Present_Value_Change);
+    /* keep the member states of the Life Safety Zone objects */
+    Life_Safety_Point_Change_Callback_Set(Life_Safety_Zone_Point_Change);
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* evaluate the COV increment of the dense analog objects in bulk */
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_INPUT, Analog_Input_Change_Of_Value_Bulk);
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_OUTPUT, Analog_Output_Change_Of_Value_Bulk);
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_VALUE, Analog_Value_Change_Of_Value_Bulk);
+#endif
 }
 
 bool DeviceGetRRInfo(
@@ -2531,6 +4595,13 @@ bool DeviceGetRRInfo(
 { /* Where to put the response */
     bool status = false; /* return value */
 
+#if defined(BACNET_DEVICE_OBJECT_JOURNAL)
+    if (pRequest->object_property == PROP_DEVICE_OBJECT_JOURNAL) {
+        pInfo->RequestTypes = RR_BY_POSITION | RR_BY_SEQUENCE;
+        pInfo->Handler = Device_Object_Journal_Encode;
+        return true;
+    }
+#endif
     switch (pRequest->object_property) {
         case PROP_VT_CLASSES_SUPPORTED:
         case PROP_ACTIVE_VT_SESSIONS:
@@ -2579,23 +4650,35 @@ bool DeviceGetRRInfo(
 
 /**
  * @brief Updates all the object timers with elapsed milliseconds
+ * @note Object types set with Device_Timer_Scheduled_Set() are only
+ *  updated when one of their wake-ups is due.  The Lighting Output,
+ *  Color, and Color Temperature objects are only updated while a
+ *  transition is active.
  * @param milliseconds - number of milliseconds elapsed
  */
 void Device_Timer(uint16_t milliseconds)
 {
     struct object_functions *pObject;
+    object_timer_batch_function batch;
     unsigned count = 0;
     uint32_t instance;
 
+    Device_Timer_Wakeups(milliseconds);
+    lighting_command_transition_task(milliseconds);
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
-        if (pObject->Object_Count) {
+        count = 0;
+        batch = Device_Timer_Batch(pObject->Object_Type);
+        if (batch) {
+            batch(milliseconds);
+        } else if (
+            pObject->Object_Count && pObject->Object_Timer &&
+            !Device_Timer_Scheduled(pObject->Object_Type)) {
             count = pObject->Object_Count();
         }
         while (count) {
             count--;
-            if ((pObject->Object_Timer) &&
-                (pObject->Object_Index_To_Instance)) {
+            if (pObject->Object_Index_To_Instance) {
                 instance = pObject->Object_Index_To_Instance(count);
                 pObject->Object_Timer(instance, milliseconds);
             }
@@ -2635,6 +4718,7 @@ void Routing_Device_Init(uint32_t first_object_instance)
     pDevObject->Object_Name = Routed_Device_Name;
     pDevObject->Object_Read_Property = Routed_Device_Read_Property_Local;
     pDevObject->Object_Write_Property = Routed_Device_Write_Property_Local;
+    Device_Object_List_Index_Invalidate();
 }
 
 #endif /* BAC_ROUTING */
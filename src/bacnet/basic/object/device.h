@@ -110,6 +110,19 @@ typedef void (*object_intrinsic_reporting_function)(uint32_t object_instance);
 typedef void (*object_timer_function)(
     uint32_t object_instance, uint16_t milliseconds);
 
+/**
+ * @brief Updates every object of one object type with the elapsed
+ *  milliseconds in a single call
+ * @param milliseconds - number of milliseconds elapsed
+ */
+typedef void (*object_timer_batch_function)(uint16_t milliseconds);
+
+/**
+ * @brief Locks or unlocks the objects for reading from another thread
+ * @param lock - true to lock, false to unlock
+ */
+typedef void (*device_read_lock_function)(bool lock);
+
 /** Defines the group of object helper functions for any supported Object.
  * @ingroup ObjHelpers
  * Each Object must provide some implementation of each of these helpers
@@ -119,6 +132,17 @@ typedef void (*object_timer_function)(
  * In both appearance and operation, this group of functions acts like
  * they are member functions of a C++ Object base class.
  */
+/**
+ * @brief Creates or deletes many objects of one object type at once.
+ * @ingroup ObjHelpers
+ * @param object_instances [in] array of object-instance numbers, which is
+ *  sorted in place
+ * @param count [in] number of object-instance numbers in the array
+ * @return the number of objects that were created or deleted
+ */
+typedef unsigned (*object_bulk_function)(
+    uint32_t *object_instances, unsigned count);
+
 typedef struct object_functions {
     BACNET_OBJECT_TYPE Object_Type;
     object_init_function Object_Init;
@@ -142,6 +166,34 @@ typedef struct object_functions {
     object_timer_function Object_Timer;
 } object_functions_t;
 
+/* proprietary Device property with the static bytes, the dynamic bytes,
+   and the number of items used by the stack, see memusage_total() */
+#ifndef PROP_DEVICE_MEMORY_USAGE
+#define PROP_DEVICE_MEMORY_USAGE (PROP_PROPRIETARY_RANGE_MIN + 0)
+#endif
+
+/* proprietary Device property with the recent changes of the Object_List,
+   read with ReadRange by sequence number, where the sequence number of
+   each change is the Database_Revision that it made.  Each item is the
+   Object_Identifier of the object and its BACNET_DEVICE_OBJECT_CHANGE. */
+#ifndef PROP_DEVICE_OBJECT_JOURNAL
+#define PROP_DEVICE_OBJECT_JOURNAL (PROP_PROPRIETARY_RANGE_MIN + 1)
+#endif
+
+/* number of the most recent Object_List changes kept in the journal */
+#ifndef BACNET_DEVICE_OBJECT_JOURNAL_SIZE
+#define BACNET_DEVICE_OBJECT_JOURNAL_SIZE 32
+#endif
+
+/* what changed with each Database_Revision */
+typedef enum {
+    /* unknown change - the whole Object_List has to be read again */
+    DEVICE_OBJECT_CHANGE_ANY = 0,
+    DEVICE_OBJECT_CHANGE_CREATED = 1,
+    DEVICE_OBJECT_CHANGE_DELETED = 2,
+    DEVICE_OBJECT_CHANGE_RENAMED = 3
+} BACNET_DEVICE_OBJECT_CHANGE;
+
 /* String Lengths - excluding any nul terminator */
 #define MAX_DEV_NAME_LEN 32
 #define MAX_DEV_LOC_LEN 64
@@ -205,6 +257,54 @@ Device_Object_Functions_Find(BACNET_OBJECT_TYPE Object_Type);
 
 BACNET_STACK_EXPORT
 void Device_Timer(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+void Device_Timer_Scheduled_Set(BACNET_OBJECT_TYPE object_type, bool scheduled);
+BACNET_STACK_EXPORT
+bool Device_Timer_Scheduled(BACNET_OBJECT_TYPE object_type);
+BACNET_STACK_EXPORT
+void Device_Timer_Batch_Set(
+    BACNET_OBJECT_TYPE object_type, object_timer_batch_function function);
+BACNET_STACK_EXPORT
+object_timer_batch_function Device_Timer_Batch(BACNET_OBJECT_TYPE object_type);
+BACNET_STACK_EXPORT
+void Device_Timer_Wakeup(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds);
+BACNET_STACK_EXPORT
+void Device_Timer_Deadline(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds);
+BACNET_STACK_EXPORT
+void Device_Timer_Cancel(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+uint32_t Device_Timer_Remaining(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+uint32_t Device_Timer_Next(void);
+BACNET_STACK_EXPORT
+void Device_Timer_Wakeups(uint16_t milliseconds);
+
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Save(const char *pathname);
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Load(const char *pathname);
+BACNET_STACK_EXPORT
+void Device_Snapshot_Pathname_Set(const char *pathname);
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Write_Property_Store(BACNET_WRITE_PROPERTY_DATA *wp_data);
+BACNET_STACK_EXPORT
+void Device_Snapshot_Timer(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Compact(void);
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Journal_Load(const char *pathname);
+BACNET_STACK_EXPORT
+void Device_Snapshot_Journal_Set(const char *pathname);
+BACNET_STACK_EXPORT
+bool Device_Snapshot_Journal_Flush(void);
 
 BACNET_STACK_EXPORT
 bool Device_Reinitialize(BACNET_REINITIALIZE_DEVICE_DATA *rd_data);
@@ -285,6 +385,14 @@ void Device_UUID_Get(uint8_t *uuid, size_t length);
 BACNET_STACK_EXPORT
 unsigned Device_Object_List_Count(void);
 BACNET_STACK_EXPORT
+void Device_Object_List_Index_Invalidate(void);
+BACNET_STACK_EXPORT
+void Device_Object_Name_Index_Update(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+void Device_Property_Value_Cache_Invalidate(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
 bool Device_Object_List_Identifier(
     uint32_t array_index, BACNET_OBJECT_TYPE *object_type, uint32_t *instance);
 BACNET_STACK_EXPORT
@@ -294,6 +402,12 @@ int Device_Object_List_Element_Encode(
 BACNET_STACK_EXPORT
 bool Device_Create_Object(BACNET_CREATE_OBJECT_DATA *data);
 BACNET_STACK_EXPORT
+unsigned Device_Create_Objects(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instances, unsigned count);
+BACNET_STACK_EXPORT
+unsigned Device_Delete_Objects(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instances, unsigned count);
+BACNET_STACK_EXPORT
 bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data);
 
 BACNET_STACK_EXPORT
@@ -381,6 +495,11 @@ BACNET_STACK_EXPORT
 void Device_Set_Database_Revision(uint32_t revision);
 BACNET_STACK_EXPORT
 void Device_Inc_Database_Revision(void);
+BACNET_STACK_EXPORT
+void Device_Object_Changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_DEVICE_OBJECT_CHANGE change);
 
 BACNET_STACK_EXPORT
 bool Device_Valid_Object_Name(
@@ -416,7 +535,11 @@ BACNET_STACK_EXPORT
 bool Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data);
 BACNET_STACK_EXPORT
 void Device_Write_Property_Store_Callback_Set(write_property_function cb);
+BACNET_STACK_EXPORT
+void Device_Read_Lock_Callback_Set(device_read_lock_function cb);
 
+BACNET_STACK_EXPORT
+void Device_Local_Reporting_Invalidate(void);
 #if defined(INTRINSIC_REPORTING)
 BACNET_STACK_EXPORT
 void Device_local_reporting(void);
@@ -0,0 +1,763 @@
+/**
+ * @file
+ * @brief Snapshot of the Device object database for a fast server startup.
+ *
+ * Every object in the Object_Table is saved with the encoded values of
+ * its properties, so that a server can restore its objects from one file
+ * after a power cycle, instead of creating and configuring them one at a
+ * time. Commandable objects save their Priority_Array slots as the
+ * Present_Value with the priority as the array index, which are written
+ * back at that priority on restore.
+ *
+ * Optionally, each successful WriteProperty is also kept in an append-only
+ * journal of (object, property, priority, encoded value) records. Writes
+ * to the same property and priority are coalesced in memory, and appended
+ * to the journal together on an interval or when enough are pending. The
+ * journal is replayed over the snapshot at startup, and is compacted into
+ * a new snapshot once it grows large, so that a flash file system is only
+ * rewritten now and then instead of on every write.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacint.h"
+#include "bacnet/proplist.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/sys/mempool.h"
+
+/* snapshot file identifier and version */
+#define DEVICE_SNAPSHOT_MAGIC 0x42444253UL
+#define DEVICE_SNAPSHOT_VERSION 1UL
+/* write-behind delay from the first change until the snapshot is saved */
+#ifndef DEVICE_SNAPSHOT_DELAY_MS
+#define DEVICE_SNAPSHOT_DELAY_MS 5000UL
+#endif
+
+/* journal file identifier and version */
+#define DEVICE_JOURNAL_MAGIC 0x42444A4CUL
+#define DEVICE_JOURNAL_VERSION 1UL
+/* number of coalesced writes that are appended to the journal together */
+#ifndef DEVICE_JOURNAL_RECORDS_MAX
+#define DEVICE_JOURNAL_RECORDS_MAX 32
+#endif
+/* write-behind delay from the first pending write until it is appended */
+#ifndef DEVICE_JOURNAL_FLUSH_MS
+#define DEVICE_JOURNAL_FLUSH_MS 1000UL
+#endif
+/* journal size in bytes that is compacted into a new snapshot */
+#ifndef DEVICE_JOURNAL_COMPACT_SIZE
+#define DEVICE_JOURNAL_COMPACT_SIZE 65536L
+#endif
+
+/* a pending write - the last value written to a property at a priority */
+struct journal_record {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID object_property;
+    BACNET_ARRAY_INDEX array_index;
+    uint8_t priority;
+    size_t length;
+    uint8_t *data;
+};
+
+static const char *Snapshot_Pathname;
+static bool Snapshot_Dirty;
+static bool Snapshot_Restoring;
+static uint32_t Snapshot_Revision;
+static uint32_t Snapshot_Elapsed_Milliseconds;
+static const char *Journal_Pathname;
+static FILE *Journal_File;
+static long Journal_Size;
+static struct journal_record Journal_Record[DEVICE_JOURNAL_RECORDS_MAX];
+static unsigned Journal_Count;
+static uint32_t Journal_Elapsed_Milliseconds;
+
+/**
+ * @brief Write one big-endian 32-bit value to the snapshot file
+ * @param file - snapshot file
+ * @param value - value to write
+ * @return true if the value was written
+ */
+static bool Device_Snapshot_Write(FILE *file, uint32_t value)
+{
+    uint8_t buffer[4];
+
+    (void)encode_unsigned32(buffer, value);
+
+    return fwrite(buffer, sizeof(buffer), 1, file) == 1;
+}
+
+/**
+ * @brief Write one encoded property value to the snapshot file
+ * @param file - snapshot file
+ * @param rpdata - property that was read, with its encoded value
+ * @param length - number of bytes in the encoded value
+ * @return true if the property was written
+ */
+static bool Device_Snapshot_Property_Write(
+    FILE *file, const BACNET_READ_PROPERTY_DATA *rpdata, int length)
+{
+    return Device_Snapshot_Write(file, rpdata->object_property) &&
+        Device_Snapshot_Write(file, rpdata->array_index) &&
+        Device_Snapshot_Write(file, (uint32_t)length) &&
+        (fwrite(rpdata->application_data, (size_t)length, 1, file) == 1);
+}
+
+/**
+ * @brief Determine if a property is saved in the snapshot
+ * @param object_property - property identifier
+ * @return true if the property value is saved
+ */
+static bool Device_Snapshot_Property_Saved(BACNET_PROPERTY_ID object_property)
+{
+    switch (object_property) {
+        case PROP_OBJECT_IDENTIFIER:
+        case PROP_OBJECT_TYPE:
+        case PROP_PROPERTY_LIST:
+        case PROP_OBJECT_LIST:
+        case PROP_STRUCTURED_OBJECT_LIST:
+        case PROP_PRIORITY_ARRAY:
+        case PROP_STATUS_FLAGS:
+        case PROP_EVENT_STATE:
+            return false;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Save the properties of one object to the snapshot file
+ * @param file - snapshot file
+ * @param object_type - object type of the object
+ * @param object_instance - object instance of the object
+ * @return true if the object was saved
+ */
+static bool Device_Snapshot_Object_Write(
+    FILE *file, BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct special_property_list_t property_list = { 0 };
+    const struct property_list_t *lists[3];
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    long count_position, end_position;
+    uint32_t count = 0, priority;
+    unsigned list, index;
+    bool commandable;
+    int len;
+
+    Device_Objects_Property_List(object_type, object_instance, &property_list);
+    lists[0] = &property_list.Required;
+    lists[1] = &property_list.Optional;
+    lists[2] = &property_list.Proprietary;
+    commandable = property_list_member(
+                      property_list.Required.pList, PROP_PRIORITY_ARRAY) ||
+        property_list_member(property_list.Optional.pList, PROP_PRIORITY_ARRAY);
+    if (!Device_Snapshot_Write(file, object_type) ||
+        !Device_Snapshot_Write(file, object_instance)) {
+        return false;
+    }
+    /* the property count is patched once the properties are written */
+    count_position = ftell(file);
+    if ((count_position < 0) || !Device_Snapshot_Write(file, 0)) {
+        return false;
+    }
+    rpdata.object_type = object_type;
+    rpdata.object_instance = object_instance;
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    for (list = 0; list < 3; list++) {
+        if (!lists[list]->pList) {
+            continue;
+        }
+        for (index = 0; index < lists[list]->count; index++) {
+            rpdata.object_property = lists[list]->pList[index];
+            if (!Device_Snapshot_Property_Saved(rpdata.object_property) ||
+                (commandable &&
+                 (rpdata.object_property == PROP_PRESENT_VALUE))) {
+                continue;
+            }
+            rpdata.array_index = BACNET_ARRAY_ALL;
+            len = Device_Read_Property(&rpdata);
+            if (len > 0) {
+                if (!Device_Snapshot_Property_Write(file, &rpdata, len)) {
+                    return false;
+                }
+                count++;
+            }
+        }
+    }
+    if (commandable) {
+        /* the relinquished slots are encoded as a single NULL tag */
+        rpdata.object_property = PROP_PRIORITY_ARRAY;
+        for (priority = BACNET_MIN_PRIORITY; priority <= BACNET_MAX_PRIORITY;
+             priority++) {
+            rpdata.array_index = priority;
+            len = Device_Read_Property(&rpdata);
+            if ((len > 1) || ((len == 1) && (apdu[0] != 0))) {
+                rpdata.object_property = PROP_PRESENT_VALUE;
+                if (!Device_Snapshot_Property_Write(file, &rpdata, len)) {
+                    return false;
+                }
+                rpdata.object_property = PROP_PRIORITY_ARRAY;
+                count++;
+            }
+        }
+    }
+    end_position = ftell(file);
+
+    return (end_position >= 0) &&
+        (fseek(file, count_position, SEEK_SET) == 0) &&
+        Device_Snapshot_Write(file, count) &&
+        (fseek(file, end_position, SEEK_SET) == 0);
+}
+
+/**
+ * @brief Save all the objects of this device, with the encoded values of
+ *  their properties, to a snapshot file.
+ * @note The snapshot is written to a temporary file that replaces the
+ *  previous snapshot once it is complete, so that a power cycle while
+ *  saving leaves the previous snapshot intact.
+ * @param pathname - name of the snapshot file
+ * @return true if the snapshot was saved
+ */
+bool Device_Snapshot_Save(const char *pathname)
+{
+    BACNET_OBJECT_TYPE object_type = OBJECT_DEVICE;
+    uint32_t object_instance = 0;
+    char temp_pathname[256] = { 0 };
+    unsigned count, index;
+    FILE *file;
+    bool status;
+
+    if (!pathname) {
+        return false;
+    }
+    if (snprintf(temp_pathname, sizeof(temp_pathname), "%s.tmp", pathname) >=
+        (int)sizeof(temp_pathname)) {
+        return false;
+    }
+    file = fopen(temp_pathname, "wb");
+    if (!file) {
+        return false;
+    }
+    count = Device_Object_List_Count();
+    status = Device_Snapshot_Write(file, DEVICE_SNAPSHOT_MAGIC) &&
+        Device_Snapshot_Write(file, DEVICE_SNAPSHOT_VERSION) &&
+        Device_Snapshot_Write(file, Device_Database_Revision()) &&
+        Device_Snapshot_Write(file, count);
+    for (index = 1; status && (index <= count); index++) {
+        if (Device_Object_List_Identifier(
+                index, &object_type, &object_instance)) {
+            status = Device_Snapshot_Object_Write(
+                file, object_type, object_instance);
+        } else {
+            /* keep the object count, with an empty object */
+            status = Device_Snapshot_Write(file, MAX_BACNET_OBJECT_TYPE) &&
+                Device_Snapshot_Write(file, BACNET_MAX_INSTANCE) &&
+                Device_Snapshot_Write(file, 0);
+        }
+    }
+    if (fclose(file) != 0) {
+        status = false;
+    }
+    if (status && (rename(temp_pathname, pathname) != 0)) {
+        /* some platforms do not replace an existing file */
+        (void)remove(pathname);
+        status = (rename(temp_pathname, pathname) == 0);
+    }
+    if (!status) {
+        (void)remove(temp_pathname);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Restore the properties of one object from the snapshot buffer
+ * @param buffer - snapshot properties of the object
+ * @param buffer_size - number of bytes in the buffer
+ * @param object_type - object type of the object
+ * @param object_instance - object instance of the object
+ * @param property_count - number of properties of the object
+ * @return number of bytes of the object in the buffer, or zero if the
+ *  buffer is malformed
+ */
+static size_t Device_Snapshot_Object_Restore(
+    const uint8_t *buffer,
+    size_t buffer_size,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t property_count)
+{
+    static BACNET_WRITE_PROPERTY_DATA wp_data;
+    uint32_t object_property = 0, array_index = 0, length = 0;
+    uint32_t index;
+    size_t offset;
+    unsigned pass;
+
+    /* the Present_Value is restored last, once Out_Of_Service and any
+       other properties that it depends on are restored */
+    for (pass = 0; pass < 2; pass++) {
+        offset = 0;
+        for (index = 0; index < property_count; index++) {
+            if ((buffer_size - offset) < 12) {
+                return 0;
+            }
+            offset += decode_unsigned32(&buffer[offset], &object_property);
+            offset += decode_unsigned32(&buffer[offset], &array_index);
+            offset += decode_unsigned32(&buffer[offset], &length);
+            if (((buffer_size - offset) < length) || (length > MAX_APDU)) {
+                return 0;
+            }
+            if ((pass == 0) == (object_property != PROP_PRESENT_VALUE)) {
+                wp_data.object_type = object_type;
+                wp_data.object_instance = object_instance;
+                wp_data.object_property = object_property;
+                wp_data.array_index = array_index;
+                wp_data.priority = BACNET_NO_PRIORITY;
+                if ((object_property == PROP_PRESENT_VALUE) &&
+                    (array_index >= BACNET_MIN_PRIORITY) &&
+                    (array_index <= BACNET_MAX_PRIORITY)) {
+                    wp_data.array_index = BACNET_ARRAY_ALL;
+                    wp_data.priority = (uint8_t)array_index;
+                }
+                memcpy(wp_data.application_data, &buffer[offset], length);
+                wp_data.application_data_len = (int)length;
+                /* properties that are not writable are simply skipped */
+                (void)Device_Write_Property(&wp_data);
+            }
+            offset += length;
+        }
+    }
+
+    return offset;
+}
+
+/**
+ * @brief Restore the objects of this device from a snapshot file.
+ *  Objects in the snapshot that do not exist are created, and the saved
+ *  property values are written to every object.
+ * @note The file is read into memory with one read and restored from the
+ *  buffer, rather than memory mapped, since not every port has mmap().
+ * @param pathname - name of the snapshot file
+ * @return true if the snapshot was restored
+ */
+bool Device_Snapshot_Load(const char *pathname)
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    uint32_t magic = 0, version = 0, revision = 0, count = 0;
+    uint32_t object_type = 0, object_instance = 0, property_count = 0;
+    uint8_t *buffer = NULL;
+    size_t buffer_size = 0, offset = 0, len;
+    uint32_t index;
+    FILE *file;
+    long size;
+    bool status = false;
+
+    if (!pathname) {
+        return false;
+    }
+    file = fopen(pathname, "rb");
+    if (!file) {
+        return false;
+    }
+    if ((fseek(file, 0, SEEK_END) == 0) && ((size = ftell(file)) >= 16) &&
+        (fseek(file, 0, SEEK_SET) == 0)) {
+        buffer_size = (size_t)size;
+        buffer = BACNET_MEMPOOL_CALLOC(buffer_size);
+        if (buffer && (fread(buffer, buffer_size, 1, file) != 1)) {
+            BACNET_MEMPOOL_FREE(buffer, buffer_size);
+            buffer = NULL;
+        }
+    }
+    fclose(file);
+    if (!buffer) {
+        return false;
+    }
+    offset += decode_unsigned32(&buffer[offset], &magic);
+    offset += decode_unsigned32(&buffer[offset], &version);
+    offset += decode_unsigned32(&buffer[offset], &revision);
+    offset += decode_unsigned32(&buffer[offset], &count);
+    if ((magic == DEVICE_SNAPSHOT_MAGIC) &&
+        (version == DEVICE_SNAPSHOT_VERSION)) {
+        status = true;
+        Snapshot_Restoring = true;
+        for (index = 0; status && (index < count); index++) {
+            if ((buffer_size - offset) < 12) {
+                status = false;
+                break;
+            }
+            offset += decode_unsigned32(&buffer[offset], &object_type);
+            offset += decode_unsigned32(&buffer[offset], &object_instance);
+            offset += decode_unsigned32(&buffer[offset], &property_count);
+            if (object_type == OBJECT_DEVICE) {
+                /* the device instance may be configured at startup */
+                object_instance = Device_Object_Instance_Number();
+            } else if (
+                (object_type < MAX_BACNET_OBJECT_TYPE) &&
+                !Device_Valid_Object_Id(
+                    (BACNET_OBJECT_TYPE)object_type, object_instance)) {
+                create_data.object_type = (BACNET_OBJECT_TYPE)object_type;
+                create_data.object_instance = object_instance;
+                create_data.list_of_initial_values = NULL;
+                (void)Device_Create_Object(&create_data);
+            }
+            if (property_count > 0) {
+                len = Device_Snapshot_Object_Restore(
+                    &buffer[offset], buffer_size - offset,
+                    (BACNET_OBJECT_TYPE)object_type,
+                    object_instance, property_count);
+                if (len == 0) {
+                    status = false;
+                }
+                offset += len;
+            }
+        }
+        Snapshot_Restoring = false;
+    }
+    BACNET_MEMPOOL_FREE(buffer, buffer_size);
+    /* the restored database is what the snapshot already holds */
+    Snapshot_Revision = Device_Database_Revision();
+    Snapshot_Dirty = false;
+
+    return status;
+}
+
+/**
+ * @brief Replay the records of a journal file over the objects of this
+ *  device, in the order they were appended.
+ * @note A record that was cut short by a power cycle while it was being
+ *  appended ends the replay, and the records before it are kept.
+ * @param pathname - name of the journal file
+ * @return true if the journal was replayed
+ */
+bool Device_Snapshot_Journal_Load(const char *pathname)
+{
+    static BACNET_WRITE_PROPERTY_DATA wp_data;
+    uint8_t header[24] = { 0 };
+    uint32_t magic = 0, version = 0, value = 0, length = 0;
+    unsigned offset;
+    FILE *file;
+    bool status = false;
+
+    if (!pathname) {
+        return false;
+    }
+    file = fopen(pathname, "rb");
+    if (!file) {
+        return false;
+    }
+    if (fread(header, 8, 1, file) == 1) {
+        (void)decode_unsigned32(&header[0], &magic);
+        (void)decode_unsigned32(&header[4], &version);
+        status = (magic == DEVICE_JOURNAL_MAGIC) &&
+            (version == DEVICE_JOURNAL_VERSION);
+    }
+    Snapshot_Restoring = true;
+    while (status && (fread(header, sizeof(header), 1, file) == 1)) {
+        offset = decode_unsigned32(&header[0], &value);
+        wp_data.object_type = (BACNET_OBJECT_TYPE)value;
+        offset += decode_unsigned32(&header[offset], &wp_data.object_instance);
+        offset += decode_unsigned32(&header[offset], &value);
+        wp_data.object_property = (BACNET_PROPERTY_ID)value;
+        offset += decode_unsigned32(&header[offset], &wp_data.array_index);
+        offset += decode_unsigned32(&header[offset], &value);
+        wp_data.priority = (uint8_t)value;
+        (void)decode_unsigned32(&header[offset], &length);
+        if ((length > sizeof(wp_data.application_data)) ||
+            ((length > 0) &&
+             (fread(wp_data.application_data, length, 1, file) != 1))) {
+            break;
+        }
+        wp_data.application_data_len = (int)length;
+        /* properties that are no longer writable are simply skipped */
+        (void)Device_Write_Property(&wp_data);
+    }
+    Snapshot_Restoring = false;
+    fclose(file);
+
+    return status;
+}
+
+/**
+ * @brief Get the size of the data allocated for a pending write
+ * @param length - number of bytes of the encoded value
+ * @return size of the allocation, which is never empty
+ */
+static size_t Device_Snapshot_Journal_Data_Size(size_t length)
+{
+    return length ? length : 1;
+}
+
+/**
+ * @brief Free the pending writes of the journal
+ */
+static void Device_Snapshot_Journal_Discard(void)
+{
+    unsigned index;
+
+    for (index = 0; index < Journal_Count; index++) {
+        BACNET_MEMPOOL_FREE(
+            Journal_Record[index].data,
+            Device_Snapshot_Journal_Data_Size(Journal_Record[index].length));
+        Journal_Record[index].data = NULL;
+    }
+    Journal_Count = 0;
+    Journal_Elapsed_Milliseconds = 0;
+}
+
+/**
+ * @brief Append the pending writes to the journal file
+ * @return true if every pending write was appended
+ */
+bool Device_Snapshot_Journal_Flush(void)
+{
+    const struct journal_record *record;
+    unsigned index;
+    bool status;
+
+    if (!Journal_File) {
+        return false;
+    }
+    status = true;
+    for (index = 0; status && (index < Journal_Count); index++) {
+        record = &Journal_Record[index];
+        status = Device_Snapshot_Write(Journal_File, record->object_type) &&
+            Device_Snapshot_Write(Journal_File, record->object_instance) &&
+            Device_Snapshot_Write(Journal_File, record->object_property) &&
+            Device_Snapshot_Write(Journal_File, record->array_index) &&
+            Device_Snapshot_Write(Journal_File, record->priority) &&
+            Device_Snapshot_Write(Journal_File, (uint32_t)record->length) &&
+            ((record->length == 0) ||
+             (fwrite(record->data, record->length, 1, Journal_File) == 1));
+        if (status) {
+            Journal_Size += 24L + (long)record->length;
+        }
+    }
+    if (fflush(Journal_File) != 0) {
+        status = false;
+    }
+    if (status) {
+        Device_Snapshot_Journal_Discard();
+    }
+
+    return status;
+}
+
+/**
+ * @brief Compact the journal - save the snapshot, which holds every write
+ *  of the journal, and start a new empty journal.
+ * @note The journal is only emptied once the new snapshot replaced the
+ *  previous one, so a power cycle in between replays the journal over the
+ *  new snapshot, which restores the same values.
+ * @return true if the snapshot was saved and the journal emptied
+ */
+bool Device_Snapshot_Compact(void)
+{
+    bool status;
+
+    if (!Snapshot_Pathname) {
+        return false;
+    }
+    Snapshot_Revision = Device_Database_Revision();
+    status = Device_Snapshot_Save(Snapshot_Pathname);
+    if (status) {
+        Snapshot_Dirty = false;
+        Snapshot_Elapsed_Milliseconds = 0;
+    }
+    if (!Journal_Pathname) {
+        return status;
+    }
+    if (status) {
+        Device_Snapshot_Journal_Discard();
+        if (Journal_File) {
+            fclose(Journal_File);
+        }
+        Journal_File = fopen(Journal_Pathname, "wb");
+        Journal_Size = 0;
+        if (Journal_File) {
+            status =
+                Device_Snapshot_Write(Journal_File, DEVICE_JOURNAL_MAGIC) &&
+                Device_Snapshot_Write(Journal_File, DEVICE_JOURNAL_VERSION) &&
+                (fflush(Journal_File) == 0);
+            Journal_Size = 8;
+        } else {
+            status = false;
+        }
+    } else if (!Journal_File) {
+        /* keep journaling behind the previous snapshot */
+        Journal_File = fopen(Journal_Pathname, "ab");
+    }
+
+    return status;
+}
+
+/**
+ * @brief Set the journal file that keeps the writes between snapshots.
+ *  Call it after Device_Snapshot_Load(), Device_Snapshot_Journal_Load()
+ *  and Device_Snapshot_Pathname_Set(), since the restored objects are
+ *  compacted into the snapshot and the journal starts empty.
+ * @param pathname - name of the journal file, or NULL to stop journaling
+ */
+void Device_Snapshot_Journal_Set(const char *pathname)
+{
+    if (Journal_File) {
+        (void)Device_Snapshot_Journal_Flush();
+        fclose(Journal_File);
+        Journal_File = NULL;
+    }
+    Device_Snapshot_Journal_Discard();
+    Journal_Pathname = pathname;
+    Journal_Size = 0;
+    if (pathname) {
+        (void)Device_Snapshot_Compact();
+    }
+}
+
+/**
+ * @brief Keep a successful write as a pending journal record, replacing
+ *  a pending write to the same property and priority
+ * @param wp_data - WriteProperty data that was stored
+ * @return true if the write is pending
+ */
+static bool
+Device_Snapshot_Journal_Record(const BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    struct journal_record *record = NULL;
+    size_t length;
+    uint8_t *data;
+    unsigned index;
+
+    if (wp_data->application_data_len < 0) {
+        return false;
+    }
+    length = (size_t)wp_data->application_data_len;
+    for (index = 0; index < Journal_Count; index++) {
+        record = &Journal_Record[index];
+        if ((record->object_type == wp_data->object_type) &&
+            (record->object_instance == wp_data->object_instance) &&
+            (record->object_property == wp_data->object_property) &&
+            (record->array_index == wp_data->array_index) &&
+            (record->priority == wp_data->priority)) {
+            break;
+        }
+        record = NULL;
+    }
+    if (!record) {
+        if ((Journal_Count >= DEVICE_JOURNAL_RECORDS_MAX) &&
+            !Device_Snapshot_Journal_Flush()) {
+            return false;
+        }
+        if (Journal_Count == 0) {
+            Journal_Elapsed_Milliseconds = 0;
+        }
+        record = &Journal_Record[Journal_Count];
+        record->data = NULL;
+        record->length = 0;
+        record->object_type = wp_data->object_type;
+        record->object_instance = wp_data->object_instance;
+        record->object_property = wp_data->object_property;
+        record->array_index = wp_data->array_index;
+        record->priority = wp_data->priority;
+        Journal_Count++;
+    }
+    if ((length != record->length) || !record->data) {
+        data = BACNET_MEMPOOL_REALLOC(
+            record->data,
+            record->data ? Device_Snapshot_Journal_Data_Size(record->length)
+                         : 0,
+            Device_Snapshot_Journal_Data_Size(length));
+        if (!data) {
+            return false;
+        }
+        record->data = data;
+        record->length = length;
+    }
+    if (length > 0) {
+        memcpy(record->data, wp_data->application_data, length);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Set the snapshot file that is saved by Device_Snapshot_Timer()
+ * @param pathname - name of the snapshot file, or NULL to stop saving
+ */
+void Device_Snapshot_Pathname_Set(const char *pathname)
+{
+    Snapshot_Pathname = pathname;
+    Snapshot_Revision = Device_Database_Revision();
+    Snapshot_Elapsed_Milliseconds = 0;
+}
+
+/**
+ * @brief Mark the snapshot as changed when WriteProperty is successful.
+ *  Set with Device_Write_Property_Store_Callback_Set() to save the
+ *  snapshot behind the writes.
+ * @param wp_data - WriteProperty data that was stored
+ * @return true
+ */
+bool Device_Snapshot_Write_Property_Store(BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    if (!Snapshot_Restoring) {
+        if (Journal_File && wp_data &&
+            Device_Snapshot_Journal_Record(wp_data)) {
+            return true;
+        }
+        if (!Snapshot_Dirty) {
+            Snapshot_Elapsed_Milliseconds = 0;
+        }
+        Snapshot_Dirty = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Save the snapshot once it has changed and the write-behind delay
+ *  has elapsed. Objects that are created or deleted change the database
+ *  revision, which also changes the snapshot. With a journal, the pending
+ *  writes are appended once their write-behind delay has elapsed, and the
+ *  journal is compacted once it grows large.
+ * @param milliseconds - time since the previous call
+ */
+void Device_Snapshot_Timer(uint16_t milliseconds)
+{
+    if (!Snapshot_Pathname) {
+        return;
+    }
+    if (Journal_Count > 0) {
+        Journal_Elapsed_Milliseconds += milliseconds;
+        if (Journal_Elapsed_Milliseconds >= DEVICE_JOURNAL_FLUSH_MS) {
+            if (!Device_Snapshot_Journal_Flush()) {
+                Journal_Elapsed_Milliseconds = 0;
+            }
+        }
+    }
+    if (Journal_File && (Journal_Size >= DEVICE_JOURNAL_COMPACT_SIZE)) {
+        (void)Device_Snapshot_Compact();
+    }
+    if (!Snapshot_Dirty &&
+        (Snapshot_Revision != Device_Database_Revision())) {
+        Snapshot_Elapsed_Milliseconds = 0;
+        Snapshot_Dirty = true;
+    }
+    if (!Snapshot_Dirty) {
+        return;
+    }
+    Snapshot_Elapsed_Milliseconds += milliseconds;
+    if (Snapshot_Elapsed_Milliseconds >= DEVICE_SNAPSHOT_DELAY_MS) {
+        (void)Device_Snapshot_Compact();
+        Snapshot_Elapsed_Milliseconds = 0;
+    }
+}
@@ -0,0 +1,340 @@
+/**
+ * @file
+ * @brief Scheduled Object_Timer wake-ups for the Device object timer.
+ *
+ * Object types that are set as scheduled have their Object_Timer called
+ * only for the objects with a wake-up that is due, kept in a timer wheel
+ * that counts in milliseconds, instead of for every object on every
+ * Device_Timer() call.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/timer_wheel.h"
+#include "bacnet/basic/object/device.h"
+
+/* Object_Timer wake-ups of the object types that schedule them */
+struct device_timer_entry {
+    /* first member, so that the node is the entry */
+    struct timer_wheel_node node;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    /* wheel tick of the previous Object_Timer call */
+    uint32_t last;
+};
+static struct timer_wheel Timer_Wheel;
+static bool Timer_Wheel_Initialized;
+static OS_Keylist Timer_Entry_List;
+static uint8_t Timer_Scheduled_Types[(MAX_BACNET_OBJECT_TYPE + 7) / 8];
+/* object types that update all of their objects in one call */
+#ifndef MAX_DEVICE_TIMER_BATCH_TYPES
+#define MAX_DEVICE_TIMER_BATCH_TYPES 4
+#endif
+static struct device_timer_batch {
+    BACNET_OBJECT_TYPE object_type;
+    object_timer_batch_function function;
+} Timer_Batch_Types[MAX_DEVICE_TIMER_BATCH_TYPES];
+static unsigned Timer_Batch_Types_Count;
+/* entry whose Object_Timer is being called by Device_Timer_Wakeups() */
+static struct device_timer_entry *Timer_Entry_Running;
+
+/**
+ * @brief Get the timer wheel that schedules the Object_Timer wake-ups
+ * @return the timer wheel, counting in milliseconds
+ */
+static struct timer_wheel *Device_Timer_Wheel(void)
+{
+    if (!Timer_Wheel_Initialized) {
+        timer_wheel_init(&Timer_Wheel);
+        Timer_Wheel_Initialized = true;
+    }
+
+    return &Timer_Wheel;
+}
+
+/**
+ * @brief Set whether an object type schedules its Object_Timer calls.
+ * @details The Object_Timer of a scheduled object type is only called
+ *  for the objects with a wake-up from Device_Timer_Wakeup() that is due,
+ *  and is passed the milliseconds since its previous call.  An idle
+ *  object of a scheduled type costs nothing in Device_Timer().
+ *  The Object_Timer of other object types is called for every object
+ *  on every Device_Timer().
+ * @param object_type [in] The BACNET_OBJECT_TYPE
+ * @param scheduled [in] true if the objects schedule their wake-ups
+ */
+void Device_Timer_Scheduled_Set(BACNET_OBJECT_TYPE object_type, bool scheduled)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        if (scheduled) {
+            Timer_Scheduled_Types[object_type / 8] |=
+                (uint8_t)(1 << (object_type % 8));
+        } else {
+            Timer_Scheduled_Types[object_type / 8] &=
+                (uint8_t)~(1 << (object_type % 8));
+        }
+    }
+}
+
+/**
+ * @brief Determine if an object type schedules its Object_Timer calls
+ * @param object_type [in] The BACNET_OBJECT_TYPE
+ * @return true if the Object_Timer is only called for due wake-ups
+ */
+bool Device_Timer_Scheduled(BACNET_OBJECT_TYPE object_type)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        return Timer_Scheduled_Types[object_type / 8] &
+            (1 << (object_type % 8));
+    }
+
+    return false;
+}
+
+/**
+ * @brief Set the function that updates every object of a type at once.
+ * @details Device_Timer() calls the batch function of an object type
+ *  once, instead of calling its Object_Timer for each object, so that
+ *  the objects are updated together without looking each one up.
+ * @param object_type [in] The BACNET_OBJECT_TYPE
+ * @param function [in] The batch function, or NULL to go back to
+ *  calling the Object_Timer for each object
+ */
+void Device_Timer_Batch_Set(
+    BACNET_OBJECT_TYPE object_type, object_timer_batch_function function)
+{
+    unsigned i;
+
+    for (i = 0; i < Timer_Batch_Types_Count; i++) {
+        if (Timer_Batch_Types[i].object_type == object_type) {
+            break;
+        }
+    }
+    if (!function) {
+        if (i < Timer_Batch_Types_Count) {
+            Timer_Batch_Types_Count--;
+            Timer_Batch_Types[i] = Timer_Batch_Types[Timer_Batch_Types_Count];
+        }
+    } else if (i < MAX_DEVICE_TIMER_BATCH_TYPES) {
+        if (i == Timer_Batch_Types_Count) {
+            Timer_Batch_Types_Count++;
+        }
+        Timer_Batch_Types[i].object_type = object_type;
+        Timer_Batch_Types[i].function = function;
+    }
+}
+
+/**
+ * @brief Get the function that updates every object of a type at once
+ * @param object_type [in] The BACNET_OBJECT_TYPE
+ * @return the batch function, or NULL if the Object_Timer is called
+ *  for each object
+ */
+object_timer_batch_function Device_Timer_Batch(BACNET_OBJECT_TYPE object_type)
+{
+    unsigned i;
+
+    for (i = 0; i < Timer_Batch_Types_Count; i++) {
+        if (Timer_Batch_Types[i].object_type == object_type) {
+            return Timer_Batch_Types[i].function;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the wake-up entry of an object, or create it
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object instance number
+ * @return the entry, or NULL if out of memory
+ */
+static struct device_timer_entry *
+Device_Timer_Entry(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct device_timer_entry *entry;
+    KEY key = KEY_ENCODE(object_type, object_instance);
+
+    if (!Timer_Entry_List) {
+        Timer_Entry_List = Keylist_Create();
+        if (!Timer_Entry_List) {
+            return NULL;
+        }
+    }
+    entry = Keylist_Data(Timer_Entry_List, key);
+    if (!entry) {
+        entry = BACNET_MEMPOOL_CALLOC(sizeof(struct device_timer_entry));
+        if (!entry) {
+            return NULL;
+        }
+        if (Keylist_Data_Add(Timer_Entry_List, key, entry) < 0) {
+            BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
+            return NULL;
+        }
+        timer_wheel_node_init(&entry->node);
+        entry->object_type = object_type;
+        entry->object_instance = object_instance;
+        entry->last = timer_wheel_now(Device_Timer_Wheel());
+    }
+
+    return entry;
+}
+
+/**
+ * @brief Schedule the next Object_Timer call of an object.
+ * @note When the object already has a wake-up pending, the earlier of
+ *  the two is kept.  An object that wants to be called again must
+ *  schedule its next wake-up from its Object_Timer.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object instance number
+ * @param milliseconds [in] The time from now until the wake-up
+ */
+void Device_Timer_Wakeup(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds)
+{
+    struct timer_wheel *wheel = Device_Timer_Wheel();
+    struct device_timer_entry *entry;
+
+    entry = Device_Timer_Entry(object_type, object_instance);
+    if (!entry) {
+        return;
+    }
+    if (timer_wheel_pending(&entry->node) &&
+        ((entry->node.expires - timer_wheel_now(wheel)) <= milliseconds)) {
+        return;
+    }
+    timer_wheel_add(wheel, &entry->node, milliseconds);
+}
+
+/**
+ * @brief Schedule the next Object_Timer call of an object at a deadline.
+ * @details Unlike Device_Timer_Wakeup(), a pending wake-up is replaced
+ *  even when it is earlier, and the next Object_Timer call is passed the
+ *  milliseconds since this call.  An object that restarts a countdown
+ *  is then called when the countdown runs out, and not before.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object instance number
+ * @param milliseconds [in] The time from now until the deadline
+ */
+void Device_Timer_Deadline(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds)
+{
+    struct timer_wheel *wheel = Device_Timer_Wheel();
+    struct device_timer_entry *entry;
+
+    entry = Device_Timer_Entry(object_type, object_instance);
+    if (!entry) {
+        return;
+    }
+    entry->last = timer_wheel_now(wheel);
+    timer_wheel_add(wheel, &entry->node, milliseconds);
+}
+
+/**
+ * @brief Cancel the pending Object_Timer wake-up of an object
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object instance number
+ */
+void Device_Timer_Cancel(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct device_timer_entry *entry;
+    KEY key = KEY_ENCODE(object_type, object_instance);
+
+    entry = Keylist_Data(Timer_Entry_List, key);
+    if (!entry) {
+        return;
+    }
+    timer_wheel_remove(Device_Timer_Wheel(), &entry->node);
+    if (entry != Timer_Entry_Running) {
+        /* the running entry is freed once its Object_Timer returns */
+        Keylist_Data_Delete(Timer_Entry_List, key);
+        BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
+    }
+}
+
+/**
+ * @brief Get the time until the pending Object_Timer wake-up of an object
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object instance number
+ * @return milliseconds until the wake-up, or UINT32_MAX if none
+ */
+uint32_t Device_Timer_Remaining(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    const struct device_timer_entry *entry;
+    const struct timer_wheel *wheel = Device_Timer_Wheel();
+
+    entry = Keylist_Data(
+        Timer_Entry_List, KEY_ENCODE(object_type, object_instance));
+    if (!entry || !timer_wheel_pending(&entry->node)) {
+        return UINT32_MAX;
+    }
+    if ((int32_t)(entry->node.expires - timer_wheel_now(wheel)) <= 0) {
+        return 0;
+    }
+
+    return entry->node.expires - timer_wheel_now(wheel);
+}
+
+/**
+ * @brief Get the time until the next scheduled Object_Timer wake-up
+ * @note Object types that do not schedule their wake-ups still need
+ *  Device_Timer() to be called at the regular interval.
+ * @return milliseconds until the next wake-up, or UINT32_MAX if none
+ */
+uint32_t Device_Timer_Next(void)
+{
+    return timer_wheel_next(Device_Timer_Wheel());
+}
+
+/**
+ * @brief Advance the scheduled wake-ups, and call the Object_Timer of
+ *  the objects with a wake-up that is due
+ * @param milliseconds - number of milliseconds elapsed
+ */
+void Device_Timer_Wakeups(uint16_t milliseconds)
+{
+    struct timer_wheel *wheel = Device_Timer_Wheel();
+    struct timer_wheel_node *node;
+    struct device_timer_entry *entry;
+    struct object_functions *pObject;
+    uint32_t elapsed;
+    uint16_t interval;
+
+    timer_wheel_advance(wheel, milliseconds);
+    while ((node = timer_wheel_expired(wheel)) != NULL) {
+        entry = (struct device_timer_entry *)node;
+        elapsed = timer_wheel_now(wheel) - entry->last;
+        entry->last = timer_wheel_now(wheel);
+        pObject = Device_Object_Functions_Find(entry->object_type);
+        if (pObject && pObject->Object_Timer) {
+            Timer_Entry_Running = entry;
+            do {
+                interval =
+                    (elapsed > UINT16_MAX) ? UINT16_MAX : (uint16_t)elapsed;
+                pObject->Object_Timer(entry->object_instance, interval);
+                elapsed -= interval;
+            } while (elapsed);
+            Timer_Entry_Running = NULL;
+        }
+        if (!timer_wheel_pending(&entry->node)) {
+            /* the object is idle */
+            Keylist_Data_Delete(
+                Timer_Entry_List,
+                KEY_ENCODE(entry->object_type, entry->object_instance));
+            BACNET_MEMPOOL_FREE(entry, sizeof(*entry));
+        }
+    }
+}
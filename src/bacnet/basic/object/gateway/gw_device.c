@@ -9,6 +9,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -65,8 +66,27 @@ bool Routed_Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data);
 
 /** Model the gateway as the main Device, with (two) remote
  * Devices that are reached via its routing capabilities.
+ * With BACNET_ROUTED_DEVICES_DYNAMIC, MAX_NUM_DEVICES is the initial
+ * table size and the table doubles when it is full, so pointers from
+ * Get_Routed_Device_Object() are only valid until the next
+ * Add_Routed_Device().
  */
+#if defined(BACNET_ROUTED_DEVICES_DYNAMIC)
+DEVICE_OBJECT_DATA *Devices;
+static uint16_t *Devices_Address_Bucket;
+static uint16_t *Devices_Address_Next;
+static uint16_t Devices_Size;
+#else
 DEVICE_OBJECT_DATA Devices[MAX_NUM_DEVICES];
+static uint16_t Devices_Address_Bucket[MAX_NUM_DEVICES];
+static uint16_t Devices_Address_Next[MAX_NUM_DEVICES];
+static const uint16_t Devices_Size = MAX_NUM_DEVICES;
+#endif
+/* The address index hashes the MAC of each routed device into a bucket
+   chain of index+1 values, or 0, in ascending index order.  The apps set
+   bacDevAddr through the pointers handed out below, so the index is
+   rebuilt on the next lookup after any of those calls. */
+static bool Devices_Address_Stale = true;
 /** Keep track of the number of managed devices, including the gateway */
 uint16_t Num_Managed_Devices = 0;
 /** Which Device entry are we currently managing.
@@ -80,6 +100,145 @@ uint16_t iCurrent_Device_Idx = 0;
  * found in device.c
  */
 
+/**
+ * @brief Get the number of valid entries in the Devices[] table
+ * @return number of managed devices, including the gateway
+ */
+static uint16_t Routed_Device_Count(void)
+{
+    return min(Devices_Size, Num_Managed_Devices);
+}
+
+/**
+ * @brief Hash a MAC address into an address index bucket
+ * @param mac_len - number of bytes in the MAC address
+ * @param mac - the MAC address
+ * @return bucket number of the address index
+ */
+static uint16_t
+Routed_Device_Address_Bucket(uint8_t mac_len, const uint8_t *mac)
+{
+    uint32_t hash = mac_len;
+    uint8_t i;
+
+    for (i = 0; i < mac_len; i++) {
+        hash = (hash * 31) + mac[i];
+    }
+
+    return (uint16_t)(hash % Devices_Size);
+}
+
+/**
+ * @brief Rebuild the MAC address index from the Devices[] table
+ */
+static void Routed_Device_Address_Index(void)
+{
+    BACNET_ADDRESS *addr;
+    uint16_t bucket;
+    uint16_t idx;
+
+    memset(Devices_Address_Bucket, 0, Devices_Size * sizeof(uint16_t));
+    /* link from the end, so that each chain is in ascending order */
+    idx = Routed_Device_Count();
+    while (idx > 0) {
+        idx--;
+        addr = &Devices[idx].bacDevAddr;
+        if ((addr->len == 0) || (addr->len > MAX_MAC_LEN)) {
+            Devices_Address_Next[idx] = 0;
+            continue;
+        }
+        bucket = Routed_Device_Address_Bucket(addr->len, addr->adr);
+        Devices_Address_Next[idx] = Devices_Address_Bucket[bucket];
+        Devices_Address_Bucket[bucket] = idx + 1;
+    }
+    Devices_Address_Stale = false;
+}
+
+/**
+ * @brief Find the first Device at or after the given index with the
+ *  given MAC address, using the address index
+ * @param idx - first index into Devices[] to consider
+ * @param dlen - length of the MAC address, which must match the length
+ *  of the Device address
+ * @param dadr - the MAC address
+ * @return index of the matching Device, or -1 if there is none
+ */
+static int
+Routed_Device_Address_Find(int idx, uint8_t dlen, const uint8_t *dadr)
+{
+    const BACNET_ADDRESS *addr;
+    uint16_t next;
+
+    if ((dlen == 0) || (dlen > MAX_MAC_LEN) || (dadr == NULL) ||
+        (Devices_Size == 0)) {
+        return -1;
+    }
+    if (Devices_Address_Stale) {
+        Routed_Device_Address_Index();
+    }
+    next = Devices_Address_Bucket[Routed_Device_Address_Bucket(dlen, dadr)];
+    while (next != 0) {
+        if ((next - 1) >= idx) {
+            addr = &Devices[next - 1].bacDevAddr;
+            if ((addr->len == dlen) && (memcmp(addr->adr, dadr, dlen) == 0)) {
+                return next - 1;
+            }
+        }
+        next = Devices_Address_Next[next - 1];
+    }
+
+    return -1;
+}
+
+#if defined(BACNET_ROUTED_DEVICES_DYNAMIC)
+/**
+ * @brief Double the size of the Devices[] table and its address index
+ * @return true if the table grew
+ */
+static bool Routed_Device_Table_Grow(void)
+{
+    DEVICE_OBJECT_DATA *table;
+    uint16_t *buckets;
+    uint16_t *next;
+    uint32_t size;
+
+    if (Devices_Size) {
+        size = (uint32_t)Devices_Size * 2;
+    } else {
+        size = MAX_NUM_DEVICES;
+    }
+    /* UINT16_MAX is the index of "no room" from Add_Routed_Device() */
+    if (size > UINT16_MAX) {
+        size = UINT16_MAX;
+    }
+    if (size <= Devices_Size) {
+        return false;
+    }
+    table = realloc(Devices, size * sizeof(DEVICE_OBJECT_DATA));
+    if (!table) {
+        return false;
+    }
+    Devices = table;
+    buckets = realloc(Devices_Address_Bucket, size * sizeof(uint16_t));
+    if (!buckets) {
+        return false;
+    }
+    Devices_Address_Bucket = buckets;
+    next = realloc(Devices_Address_Next, size * sizeof(uint16_t));
+    if (!next) {
+        return false;
+    }
+    Devices_Address_Next = next;
+    memset(
+        &Devices[Devices_Size], 0,
+        (size - Devices_Size) * sizeof(DEVICE_OBJECT_DATA));
+    Devices_Size = (uint16_t)size;
+    Devices_Address_Stale = true;
+
+    return true;
+}
+#endif
+
 /** Add a Device to our table of Devices[].
  * The first entry must be the gateway device.
  * @param Object_Instance [in] Set the new Device to this instance number.
@@ -94,9 +253,16 @@ uint16_t Add_Routed_Device(
     const char *sDescription)
 {
     int i = Num_Managed_Devices;
-    if (i < MAX_NUM_DEVICES) {
+#if defined(BACNET_ROUTED_DEVICES_DYNAMIC)
+    if (i >= Devices_Size) {
+        (void)Routed_Device_Table_Grow();
+    }
+#endif
+    if (i < Devices_Size) {
         DEVICE_OBJECT_DATA *pDev = &Devices[i];
+        memset(&pDev->bacDevAddr, 0, sizeof(BACNET_ADDRESS));
         Num_Managed_Devices++;
+        Devices_Address_Stale = true;
         iCurrent_Device_Idx = i;
         pDev->bacObj.mObject_Type = OBJECT_DEVICE;
         pDev->bacObj.Object_Instance_Number = Object_Instance;
@@ -131,10 +297,12 @@ uint16_t Add_Routed_Device(
  */
 DEVICE_OBJECT_DATA *Get_Routed_Device_Object(int idx)
 {
+    /* the caller may change the address through the pointer */
+    Devices_Address_Stale = true;
     if (idx == -1) {
         return &Devices[iCurrent_Device_Idx];
     } else if (
-        (idx >= 0) && (idx < min(MAX_NUM_DEVICES, Num_Managed_Devices))) {
+        (idx >= 0) && (idx < Routed_Device_Count())) {
         iCurrent_Device_Idx = idx;
         return &Devices[idx];
     } else {
@@ -153,10 +321,12 @@ DEVICE_OBJECT_DATA *Get_Routed_Device_Object(int idx)
  */
 BACNET_ADDRESS *Get_Routed_Device_Address(int idx)
 {
+    /* the caller may change the address through the pointer */
+    Devices_Address_Stale = true;
     if (idx == -1) {
         return &Devices[iCurrent_Device_Idx].bacDevAddr;
     } else if (
-        (idx >= 0) && (idx < min(MAX_NUM_DEVICES, Num_Managed_Devices))) {
+        (idx >= 0) && (idx < Routed_Device_Count())) {
         iCurrent_Device_Idx = idx;
         return &Devices[idx].bacDevAddr;
     } else {
@@ -203,7 +373,7 @@ bool Routed_Device_Address_Lookup(int idx, uint8_t dlen, const uint8_t *dadr)
     DEVICE_OBJECT_DATA *pDev;
     int i;
 
-    if ((idx >= 0) && (idx < min(MAX_NUM_DEVICES, Num_Managed_Devices))) {
+    if ((idx >= 0) && (idx < Routed_Device_Count())) {
         pDev = &Devices[idx];
         if (dlen == 0) {
             /* Automatic match */
@@ -257,7 +427,7 @@ bool Routed_Device_GetNext(
     int idx = *cursor;
     bool bSuccess = false;
 
-    if ((idx < 0) || (idx >= min(MAX_NUM_DEVICES, Num_Managed_Devices))) {
+    if ((idx < 0) || (idx >= Routed_Device_Count())) {
         /* The next index will be out of range.
            Eg, last call to GetNext may have been the last successful one.*/
         idx = -1;
@@ -283,18 +453,22 @@ bool Routed_Device_GetNext(
             /* Step over this case (starting point) */
             idx = 1;
         }
-        while (idx < min(MAX_NUM_DEVICES, Num_Managed_Devices)) {
-            bSuccess =
-                Routed_Device_Address_Lookup(idx++, dest->len, dest->adr);
-            if (bSuccess) {
-                /* We don't need to keep looking */
-                break;
+        if (dest->len == 0) {
+            /* MAC broadcast: take the entry indexed by the cursor */
+            iCurrent_Device_Idx = idx++;
+            bSuccess = true;
+        } else {
+            /* MAC unicast: find the Device in the address index */
+            idx = Routed_Device_Address_Find(idx, dest->len, dest->adr);
+            if (idx > 0) {
+                iCurrent_Device_Idx = idx++;
+                bSuccess = true;
             }
         }
     }
     if (!bSuccess) {
         *cursor = -1;
-    } else if (idx == min(MAX_NUM_DEVICES, Num_Managed_Devices)) {
+    } else if (idx == Routed_Device_Count()) {
         /* No more to GetNext */
         *cursor = -1;
     } else {
@@ -355,7 +529,7 @@ static uint32_t Routed_Device_Instance_To_Index(uint32_t Instance_Number)
 {
     int i;
 
-    for (i = 0; i < min(MAX_NUM_DEVICES, Num_Managed_Devices); i++) {
+    for (i = 0; i < Routed_Device_Count(); i++) {
         if (Devices[i].bacObj.Object_Instance_Number == Instance_Number) {
             /* Found Instance, so return the Device Index Number */
             return i;
@@ -10,7 +10,6 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
-#include <string.h>
 #include <stdlib.h>
 
 /* BACnet Stack defines - first */
@@ -24,31 +23,14 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
-#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/object/value_object.h"
 /* me! */
 #include "bacnet/basic/object/iv.h"
 
-/* Key List for storing the object data sorted by instance number  */
-static OS_Keylist Object_List = NULL;
-/* common object type */
-static const BACNET_OBJECT_TYPE Object_Type = OBJECT_INTEGER_VALUE;
 /* callback for present value writes */
 static integer_value_write_present_value_callback
     Integer_Value_Write_Present_Value_Callback;
 
-struct integer_object {
-    bool Out_Of_Service : 1;
-    bool Changed : 1;
-    int32_t Present_Value;
-    int32_t Prior_Value;
-    uint32_t COV_Increment;
-    BACNET_ENGINEERING_UNITS Units;
-    uint32_t Instance;
-    const char *Object_Name;
-    const char *Description;
-    void *Context;
-} INTERGER_VALUE_DESCR;
-
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Integer_Value_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -66,6 +48,21 @@ static const int32_t Integer_Value_Properties_Optional[] = {
 
 static const int32_t Integer_Value_Properties_Proprietary[] = { -1 };
 
+/* descriptor of the object type for the value object engine */
+static const VALUE_OBJECT_CLASS Integer_Value_Class = {
+    OBJECT_INTEGER_VALUE,
+    BACNET_APPLICATION_TAG_SIGNED_INT,
+    "INTEGER-VALUE-",
+    Integer_Value_Properties_Required,
+    Integer_Value_Properties_Optional,
+    Integer_Value_Properties_Proprietary,
+    UNITS_PERCENT,
+    { .Unsigned_Int = 1 },
+};
+
+/* the objects, sorted by instance number */
+static VALUE_OBJECT_LIST Integer_Values = { &Integer_Value_Class, NULL };
+
 /**
  * Returns the list of required, optional, and proprietary properties.
  * Used by ReadPropertyMultiple service.
@@ -95,14 +92,15 @@ void Integer_Value_Property_Lists(
     return;
 }
 
+
 /**
  * @brief Gets an object from the list using an instance number as the key
  * @param  object_instance - object-instance number of the object
  * @return object found in the list, or NULL if not found
  */
-static struct integer_object *Integer_Value_Object(uint32_t object_instance)
+static VALUE_OBJECT *Integer_Value_Object(uint32_t object_instance)
 {
-    return Keylist_Data(Object_List, object_instance);
+    return Value_Object_Data(&Integer_Values, object_instance);
 }
 
 /**
@@ -114,9 +112,7 @@ static struct integer_object *Integer_Value_Object(uint32_t object_instance)
  */
 bool Integer_Value_Valid_Instance(uint32_t object_instance)
 {
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
-
-    return (pObject != NULL);
+    return (Integer_Value_Object(object_instance) != NULL);
 }
 
 /**
@@ -126,7 +122,7 @@ bool Integer_Value_Valid_Instance(uint32_t object_instance)
  */
 unsigned Integer_Value_Count(void)
 {
-    return Keylist_Count(Object_List);
+    return Value_Object_Count(&Integer_Values);
 }
 
 /**
@@ -139,11 +135,7 @@ unsigned Integer_Value_Count(void)
  */
 uint32_t Integer_Value_Index_To_Instance(unsigned index)
 {
-    KEY key = UINT32_MAX;
-
-    Keylist_Index_Key(Object_List, index, &key);
-
-    return key;
+    return Value_Object_Index_To_Instance(&Integer_Values, index);
 }
 
 /**
@@ -157,7 +149,7 @@ uint32_t Integer_Value_Index_To_Instance(unsigned index)
  */
 unsigned Integer_Value_Instance_To_Index(uint32_t object_instance)
 {
-    return Keylist_Index(Object_List, object_instance);
+    return Value_Object_Instance_To_Index(&Integer_Values, object_instance);
 }
 
 /**
@@ -170,40 +162,15 @@ unsigned Integer_Value_Instance_To_Index(uint32_t object_instance)
 int32_t Integer_Value_Present_Value(uint32_t object_instance)
 {
     int32_t value = 0;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
-        value = pObject->Present_Value;
+        value = pObject->Present_Value.Signed_Int;
     }
 
     return value;
 }
 
-/**
- * This function is used to detect a value change,
- * using the new value compared against the prior
- * value, using a delta as threshold.
- *
- * This method will update the COV-changed attribute.
- *
- * @param index  Object index
- * @param value  Given present value.
- */
-static void
-Integer_Value_COV_Detect(struct integer_object *pObject, int32_t value)
-{
-    if (pObject) {
-        int32_t prior_value = pObject->Prior_Value;
-        uint32_t cov_increment = pObject->COV_Increment;
-        uint32_t cov_delta = (uint32_t)abs(prior_value - value);
-
-        if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
-            pObject->Prior_Value = value;
-        }
-    }
-}
-
 /**
  * For a given object instance-number, sets the present-value
  *
@@ -215,18 +182,13 @@ Integer_Value_COV_Detect(struct integer_object *pObject, int32_t value)
 bool Integer_Value_Present_Value_Set(
     uint32_t object_instance, int32_t value, uint8_t priority)
 {
-    bool status = false;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT_VALUE data = { 0 };
 
     (void)priority;
+    data.Signed_Int = value;
 
-    if (pObject) {
-        Integer_Value_COV_Detect(pObject, value);
-        pObject->Present_Value = value;
-        status = true;
-    }
-
-    return status;
+    return Value_Object_Present_Value_Set(
+        &Integer_Values, object_instance, &data);
 }
 
 /**
@@ -242,24 +204,7 @@ bool Integer_Value_Present_Value_Set(
 bool Integer_Value_Object_Name(
     uint32_t object_instance, BACNET_CHARACTER_STRING *object_name)
 {
-    char text[32] = "";
-    bool status = false;
-    struct integer_object *pObject;
-
-    pObject = Integer_Value_Object(object_instance);
-    if (pObject) {
-        if (pObject->Object_Name) {
-            status =
-                characterstring_init_ansi(object_name, pObject->Object_Name);
-        } else {
-            snprintf(
-                text, sizeof(text), "INTEGER-VALUE-%lu",
-                (unsigned long)object_instance);
-            status = characterstring_init_ansi(object_name, text);
-        }
-    }
-
-    return status;
+    return Value_Object_Name(&Integer_Values, object_instance, object_name);
 }
 
 /**
@@ -271,9 +216,8 @@ bool Integer_Value_Object_Name(
 bool Integer_Value_Name_Set(uint32_t object_instance, const char *new_name)
 {
     bool status = false;
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Integer_Value_Object(object_instance);
     if (pObject) {
         status = true;
         pObject->Object_Name = new_name;
@@ -290,9 +234,8 @@ bool Integer_Value_Name_Set(uint32_t object_instance, const char *new_name)
 const char *Integer_Value_Name_ASCII(uint32_t object_instance)
 {
     const char *name = NULL;
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Integer_Value_Object(object_instance);
     if (pObject) {
         name = pObject->Object_Name;
     }
@@ -314,9 +257,8 @@ bool Integer_Value_Description(
     uint32_t object_instance, BACNET_CHARACTER_STRING *description)
 {
     bool status = false;
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Integer_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Description) {
             status =
@@ -339,9 +281,8 @@ bool Integer_Value_Description_Set(
     uint32_t object_instance, const char *new_name)
 {
     bool status = false; /* return value */
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Integer_Value_Object(object_instance);
     if (pObject) {
         status = true;
         pObject->Description = new_name;
@@ -358,9 +299,8 @@ bool Integer_Value_Description_Set(
 const char *Integer_Value_Description_ANSI(uint32_t object_instance)
 {
     const char *name = NULL;
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Integer_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Description == NULL) {
             name = "";
@@ -382,7 +322,7 @@ const char *Integer_Value_Description_ANSI(uint32_t object_instance)
 BACNET_ENGINEERING_UNITS Integer_Value_Units(uint32_t object_instance)
 {
     BACNET_ENGINEERING_UNITS units = UNITS_NO_UNITS;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
         units = pObject->Units;
@@ -403,7 +343,7 @@ bool Integer_Value_Units_Set(
     uint32_t object_instance, BACNET_ENGINEERING_UNITS units)
 {
     bool status = false;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
         pObject->Units = units;
@@ -423,7 +363,7 @@ bool Integer_Value_Units_Set(
  */
 bool Integer_Value_Out_Of_Service(uint32_t object_instance)
 {
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
     bool value = false;
 
     if (pObject) {
@@ -443,7 +383,7 @@ bool Integer_Value_Out_Of_Service(uint32_t object_instance)
  */
 void Integer_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
 {
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
         pObject->Out_Of_Service = value;
@@ -462,75 +402,7 @@ void Integer_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
  */
 int Integer_Value_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
 {
-    int apdu_len = 0; /* return value */
-    BACNET_BIT_STRING bit_string;
-    BACNET_CHARACTER_STRING char_string;
-    uint8_t *apdu = NULL;
-    BACNET_ENGINEERING_UNITS units;
-    int32_t integer_value = 0;
-    bool state = false;
-
-    if ((rpdata == NULL) || (rpdata->application_data == NULL) ||
-        (rpdata->application_data_len == 0)) {
-        return 0;
-    }
-
-    apdu = rpdata->application_data;
-    switch (rpdata->object_property) {
-        case PROP_OBJECT_IDENTIFIER:
-            apdu_len = encode_application_object_id(
-                &apdu[0], Object_Type, rpdata->object_instance);
-            break;
-        case PROP_OBJECT_NAME:
-            Integer_Value_Object_Name(rpdata->object_instance, &char_string);
-            apdu_len =
-                encode_application_character_string(&apdu[0], &char_string);
-            break;
-        case PROP_OBJECT_TYPE:
-            apdu_len = encode_application_enumerated(&apdu[0], Object_Type);
-            break;
-        case PROP_DESCRIPTION:
-            if (Integer_Value_Description(
-                    rpdata->object_instance, &char_string)) {
-                apdu_len =
-                    encode_application_character_string(&apdu[0], &char_string);
-            }
-
-            break;
-        case PROP_PRESENT_VALUE:
-            integer_value =
-                Integer_Value_Present_Value(rpdata->object_instance);
-            apdu_len = encode_application_signed(&apdu[0], integer_value);
-            break;
-        case PROP_STATUS_FLAGS:
-            bitstring_init(&bit_string);
-            bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM, false);
-            bitstring_set_bit(&bit_string, STATUS_FLAG_FAULT, false);
-            bitstring_set_bit(&bit_string, STATUS_FLAG_OVERRIDDEN, false);
-            state = Integer_Value_Out_Of_Service(rpdata->object_instance);
-            bitstring_set_bit(&bit_string, STATUS_FLAG_OUT_OF_SERVICE, state);
-            apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
-            break;
-        case PROP_OUT_OF_SERVICE:
-            state = Integer_Value_Out_Of_Service(rpdata->object_instance);
-            apdu_len = encode_application_boolean(&apdu[0], state);
-            break;
-        case PROP_UNITS:
-            units = Integer_Value_Units(rpdata->object_instance);
-            apdu_len = encode_application_enumerated(&apdu[0], (uint32_t)units);
-            break;
-        case PROP_COV_INCREMENT:
-            apdu_len = encode_application_unsigned(
-                &apdu[0], Integer_Value_COV_Increment(rpdata->object_instance));
-            break;
-        default:
-            rpdata->error_class = ERROR_CLASS_PROPERTY;
-            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
-            apdu_len = BACNET_STATUS_ERROR;
-            break;
-    }
-
-    return apdu_len;
+    return Value_Object_Read_Property(&Integer_Values, rpdata);
 }
 
 /**
@@ -545,80 +417,15 @@ int Integer_Value_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
 bool Integer_Value_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
 {
     bool status = false; /* return value */
-    int len = 0;
     int32_t old_value = 0;
-    BACNET_APPLICATION_DATA_VALUE value = { 0 };
-
-    /* decode the some of the request */
-    len = bacapp_decode_application_data(
-        wp_data->application_data, wp_data->application_data_len, &value);
-    /* FIXME: len < application_data_len: more data? */
-    if (len < 0) {
-        /* error while decoding - a value larger than we can handle */
-        wp_data->error_class = ERROR_CLASS_PROPERTY;
-        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
-        return false;
-    }
-    switch (wp_data->object_property) {
-        case PROP_PRESENT_VALUE:
-            status = write_property_type_valid(
-                wp_data, &value, BACNET_APPLICATION_TAG_SIGNED_INT);
-            if (status) {
-                old_value =
-                    Integer_Value_Present_Value(wp_data->object_instance);
-                Integer_Value_Present_Value_Set(
-                    wp_data->object_instance, value.type.Signed_Int,
-                    wp_data->priority);
-                if (Integer_Value_Write_Present_Value_Callback) {
-                    Integer_Value_Write_Present_Value_Callback(
-                        wp_data->object_instance, old_value,
-                        Integer_Value_Present_Value(wp_data->object_instance));
-                }
-            }
-            break;
-        case PROP_COV_INCREMENT:
-            status = write_property_type_valid(
-                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
-            if (status) {
-                Integer_Value_COV_Increment_Set(
-                    wp_data->object_instance, value.type.Unsigned_Int);
-            }
-            break;
-        case PROP_OUT_OF_SERVICE:
-            status = write_property_type_valid(
-                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
-            if (status) {
-                Integer_Value_Out_Of_Service_Set(
-                    wp_data->object_instance, value.type.Boolean);
-            }
-            break;
-        case PROP_UNITS:
-            status = write_property_type_valid(
-                wp_data, &value, BACNET_APPLICATION_TAG_ENUMERATED);
-            if (status) {
-                if (value.type.Enumerated <= UINT16_MAX) {
-                    Integer_Value_Units_Set(
-                        wp_data->object_instance, value.type.Enumerated);
-                } else {
-                    status = false;
-                    wp_data->error_class = ERROR_CLASS_PROPERTY;
-                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
-                }
-            }
-            break;
-        default:
-            if (property_lists_member(
-                    Integer_Value_Properties_Required,
-                    Integer_Value_Properties_Optional,
-                    Integer_Value_Properties_Proprietary,
-                    wp_data->object_property)) {
-                wp_data->error_class = ERROR_CLASS_PROPERTY;
-                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
-            } else {
-                wp_data->error_class = ERROR_CLASS_PROPERTY;
-                wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
-            }
-            break;
+
+    old_value = Integer_Value_Present_Value(wp_data->object_instance);
+    status = Value_Object_Write_Property(&Integer_Values, wp_data);
+    if (status && (wp_data->object_property == PROP_PRESENT_VALUE) &&
+        Integer_Value_Write_Present_Value_Callback) {
+        Integer_Value_Write_Present_Value_Callback(
+            wp_data->object_instance, old_value,
+            Integer_Value_Present_Value(wp_data->object_instance));
     }
 
     return status;
@@ -642,7 +449,7 @@ void Integer_Value_Write_Present_Value_Callback_Set(
 bool Integer_Value_Change_Of_Value(uint32_t object_instance)
 {
     bool changed = false;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
         changed = pObject->Changed;
@@ -657,7 +464,7 @@ bool Integer_Value_Change_Of_Value(uint32_t object_instance)
  */
 void Integer_Value_Change_Of_Value_Clear(uint32_t object_instance)
 {
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
         pObject->Changed = false;
@@ -672,10 +479,10 @@ void Integer_Value_Change_Of_Value_Clear(uint32_t object_instance)
 uint32_t Integer_Value_COV_Increment(uint32_t object_instance)
 {
     uint32_t value = 0;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
     if (pObject) {
-        value = pObject->COV_Increment;
+        value = pObject->COV_Increment.Unsigned_Int;
     }
 
     return value;
@@ -692,22 +499,8 @@ uint32_t Integer_Value_COV_Increment(uint32_t object_instance)
 bool Integer_Value_Encode_Value_List(
     uint32_t object_instance, BACNET_PROPERTY_VALUE *value_list)
 {
-    bool status = false;
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
-
-    if (pObject) {
-        bool out_of_service = pObject->Out_Of_Service;
-        uint32_t present_value = pObject->Present_Value;
-        const bool in_alarm = false;
-        const bool fault = false;
-        const bool overridden = false;
-
-        status = cov_value_list_encode_signed_int(
-            value_list, present_value, in_alarm, fault, overridden,
-            out_of_service);
-    }
-
-    return status;
+    return Value_Object_Encode_Value_List(
+        &Integer_Values, object_instance, value_list);
 }
 
 /**
@@ -717,12 +510,10 @@ bool Integer_Value_Encode_Value_List(
  */
 void Integer_Value_COV_Increment_Set(uint32_t object_instance, uint32_t value)
 {
-    struct integer_object *pObject = Integer_Value_Object(object_instance);
+    VALUE_OBJECT_VALUE data = { 0 };
 
-    if (pObject) {
-        pObject->COV_Increment = value;
-        Integer_Value_COV_Detect(pObject, pObject->Present_Value);
-    }
+    data.Unsigned_Int = value;
+    Value_Object_COV_Increment_Set(&Integer_Values, object_instance, &data);
 }
 
 /**
@@ -732,9 +523,8 @@ void Integer_Value_COV_Increment_Set(uint32_t object_instance, uint32_t value)
  */
 void *Integer_Value_Context_Get(uint32_t object_instance)
 {
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         return pObject->Context;
     }
@@ -749,9 +539,8 @@ void *Integer_Value_Context_Get(uint32_t object_instance)
  */
 void Integer_Value_Context_Set(uint32_t object_instance, void *context)
 {
-    struct integer_object *pObject;
+    VALUE_OBJECT *pObject = Integer_Value_Object(object_instance);
 
-    pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         pObject->Context = context;
     }
@@ -764,48 +553,7 @@ void Integer_Value_Context_Set(uint32_t object_instance, void *context)
  */
 uint32_t Integer_Value_Create(uint32_t object_instance)
 {
-    struct integer_object *pObject = NULL;
-
-    if (!Object_List) {
-        Object_List = Keylist_Create();
-    }
-    if (object_instance > BACNET_MAX_INSTANCE) {
-        return BACNET_MAX_INSTANCE;
-    } else if (object_instance == BACNET_MAX_INSTANCE) {
-        /* wildcard instance */
-        /* the Object_Identifier property of the newly created object
-            shall be initialized to a value that is unique within the
-            responding BACnet-user device. The method used to generate
-            the object identifier is a local matter.*/
-        object_instance = Keylist_Next_Empty_Key(Object_List, 1);
-    }
-    pObject = Keylist_Data(Object_List, object_instance);
-    if (!pObject) {
-        pObject = calloc(1, sizeof(struct integer_object));
-        if (pObject) {
-            int index = Keylist_Data_Add(Object_List, object_instance, pObject);
-
-            if (index < 0) {
-                free(pObject);
-                return BACNET_MAX_INSTANCE;
-            }
-
-            pObject->Object_Name = NULL;
-            pObject->Description = NULL;
-            pObject->COV_Increment = 1;
-            pObject->Present_Value = 0;
-            pObject->Prior_Value = 0;
-            pObject->Units = UNITS_PERCENT;
-            pObject->Out_Of_Service = false;
-            pObject->Changed = false;
-
-            /* add to list */
-        } else {
-            return BACNET_MAX_INSTANCE;
-        }
-    }
-
-    return object_instance;
+    return Value_Object_Create(&Integer_Values, object_instance);
 }
 
 /**
@@ -815,16 +563,7 @@ uint32_t Integer_Value_Create(uint32_t object_instance)
  */
 bool Integer_Value_Delete(uint32_t object_instance)
 {
-    bool status = false;
-    struct integer_object *pObject =
-        Keylist_Data_Delete(Object_List, object_instance);
-
-    if (pObject) {
-        free(pObject);
-        status = true;
-    }
-
-    return status;
+    return Value_Object_Delete(&Integer_Values, object_instance);
 }
 
 /**
@@ -832,19 +571,25 @@ bool Integer_Value_Delete(uint32_t object_instance)
  */
 void Integer_Value_Cleanup(void)
 {
-    if (Object_List) {
-        struct integer_object *pObject;
+    Value_Object_Cleanup(&Integer_Values);
+}
 
-        do {
-            pObject = Keylist_Data_Pop(Object_List);
-            if (pObject) {
-                free(pObject);
-            }
-        } while (pObject);
+/**
+ * @brief Add the memory used by the Integer Value objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Integer_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    Value_Object_Memory_Usage(&Integer_Values, usage);
+}
 
-        Keylist_Delete(Object_List);
-        Object_List = NULL;
-    }
+/**
+ * @brief Get the revision of the list of Integer Value objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Integer_Value_List_Revision(void)
+{
+    return Value_Object_List_Revision(&Integer_Values);
 }
 
 /**
@@ -852,7 +597,5 @@ void Integer_Value_Cleanup(void)
  */
 void Integer_Value_Init(void)
 {
-    if (!Object_List) {
-        Object_List = Keylist_Create();
-    }
+    Value_Object_Init(&Integer_Values);
 }
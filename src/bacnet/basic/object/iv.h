@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/wp.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -111,6 +112,10 @@ BACNET_STACK_EXPORT
 void Integer_Value_Cleanup(void);
 BACNET_STACK_EXPORT
 void Integer_Value_Init(void);
+BACNET_STACK_EXPORT
+void Integer_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Integer_Value_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 
 /* from Table 12-33. Requested_Shed_Level Default Values and Power Targets */
 #define DEFAULT_VALUE_PERCENT 100
@@ -1667,13 +1668,13 @@ bool Load_Control_Shed_Level_Array_Set(
     key = array_index;
     entry = Keylist_Data(pObject->Shed_Level_List, key);
     if (!entry) {
-        entry = calloc(1, sizeof(struct shed_level_data));
+        entry = BACNET_MEMPOOL_CALLOC(sizeof(struct shed_level_data));
         if (!entry) {
             return false;
         }
         key_index = Keylist_Data_Add(pObject->Shed_Level_List, key, entry);
         if (key_index < 0) {
-            free(entry);
+            BACNET_MEMPOOL_FREE(entry, sizeof(struct shed_level_data));
             return false;
         }
     }
@@ -2101,7 +2102,7 @@ uint32_t Load_Control_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             /* defaults */
@@ -2122,14 +2123,15 @@ uint32_t Load_Control_Create(uint32_t object_instance)
             pObject->Start_Time_Property_Written = false;
             pObject->Shed_Level_List = Keylist_Create();
             for (i = 0; i < ARRAY_SIZE(shed_levels); i++) {
-                entry = calloc(1, sizeof(struct shed_level_data));
+                entry = BACNET_MEMPOOL_CALLOC(sizeof(struct shed_level_data));
                 if (entry) {
                     entry->Value = shed_levels[i].Value;
                     entry->Description = shed_levels[i].Description;
                     index = Keylist_Data_Add(
                         pObject->Shed_Level_List, 1 + i, entry);
                     if (index < 0) {
-                        free(entry);
+                        BACNET_MEMPOOL_FREE(
+                            entry, sizeof(struct shed_level_data));
                     }
                 }
             }
@@ -2147,7 +2149,7 @@ uint32_t Load_Control_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -2158,6 +2160,21 @@ uint32_t Load_Control_Create(uint32_t object_instance)
     return object_instance;
 }
 
+/**
+ * Frees the shed levels of a Load Control object, and their list
+ * @param pObject - object data
+ */
+static void Load_Control_Shed_Level_List_Free(struct object_data *pObject)
+{
+    while (Keylist_Count(pObject->Shed_Level_List) > 0) {
+        BACNET_MEMPOOL_FREE(
+            Keylist_Data_Pop(pObject->Shed_Level_List),
+            sizeof(struct shed_level_data));
+    }
+    Keylist_Delete(pObject->Shed_Level_List);
+    pObject->Shed_Level_List = NULL;
+}
+
 /**
  * Deletes an Load Control object
  * @param object_instance - object-instance number of the object
@@ -2170,7 +2187,8 @@ bool Load_Control_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        Load_Control_Shed_Level_List_Free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -2188,7 +2206,8 @@ void Load_Control_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Load_Control_Shed_Level_List_Free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -2196,6 +2215,32 @@ void Load_Control_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Load Control objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Load_Control_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Load Control objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Load_Control_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Load Control object data
  */
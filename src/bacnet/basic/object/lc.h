@@ -16,6 +16,7 @@
 #include "bacnet/shed_level.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 typedef struct shed_level_data {
     /* Represents the shed levels for the LEVEL choice of
@@ -174,6 +175,10 @@ void Load_Control_Cleanup(void);
 
 BACNET_STACK_EXPORT
 void Load_Control_Init(void);
+BACNET_STACK_EXPORT
+void Load_Control_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Load_Control_List_Revision(void);
 
 BACNET_STACK_EXPORT
 unsigned Load_Control_Priority_For_Writing(uint32_t object_instance);
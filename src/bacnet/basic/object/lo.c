@@ -21,9 +21,11 @@
 #include "bacnet/lighting.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/basic/sys/linear.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/lighting_command.h"
+#include "bacnet/basic/sys/priority_array.h"
 #include "bacnet/bactext.h"
 #include "bacnet/proplist.h"
 /* me! */
@@ -42,6 +44,8 @@ struct object_data {
     float Feedback_Value;
     float Priority_Array[BACNET_MAX_PRIORITY];
     uint16_t Priority_Active_Bits;
+    /* active priority 1..16 of the present-value, or 0 if relinquished */
+    uint8_t Present_Value_Priority;
     float Relinquish_Default;
     float Power;
     float Instantaneous_Power;
@@ -288,6 +292,13 @@ static float Priority_Array_Next_Value(
     float real_value;
     unsigned p;
 
+    if (priority == 0) {
+        /* the present-value is tracked by the cached active priority */
+        if (pObject->Present_Value_Priority) {
+            return pObject->Priority_Array[pObject->Present_Value_Priority - 1];
+        }
+        return Relinquish_Default_Value(pObject);
+    }
     real_value = Relinquish_Default_Value(pObject);
     for (p = priority; p < BACNET_MAX_PRIORITY; p++) {
         if (Priority_Array_Active(pObject, p)) {
@@ -360,14 +371,10 @@ static int Lighting_Output_Priority_Array_Encode(
  */
 static unsigned Present_Value_Priority(const struct object_data *pObject)
 {
-    unsigned p; /* loop counter */
     unsigned priority = BACNET_MAX_PRIORITY + 1; /* return value */
 
-    for (p = 0; p < BACNET_MAX_PRIORITY; p++) {
-        if (BIT_CHECK(pObject->Priority_Active_Bits, p)) {
-            priority = p + 1;
-            break;
-        }
+    if (pObject->Present_Value_Priority) {
+        priority = pObject->Present_Value_Priority;
     }
 
     return priority;
@@ -389,9 +396,12 @@ Present_Value_Relinquish(struct object_data *pObject, unsigned priority)
 
     if (priority && (priority <= BACNET_MAX_PRIORITY) &&
         (priority != 6 /* reserved */)) {
-        priority--;
-        BIT_CLEAR(pObject->Priority_Active_Bits, priority);
-        pObject->Priority_Array[priority] = 0.0;
+        BIT_CLEAR(pObject->Priority_Active_Bits, priority - 1);
+        pObject->Priority_Array[priority - 1] = 0.0;
+        if (priority == pObject->Present_Value_Priority) {
+            pObject->Present_Value_Priority = Priority_Active_Next(
+                pObject->Priority_Active_Bits, priority + 1);
+        }
         status = true;
     }
 
@@ -429,9 +439,12 @@ Present_Value_Set(struct object_data *pObject, float value, unsigned priority)
 
     if (priority && (priority <= BACNET_MAX_PRIORITY) &&
         (priority != 6 /* reserved */)) {
-        priority--;
-        BIT_SET(pObject->Priority_Active_Bits, priority);
-        pObject->Priority_Array[priority] = value;
+        BIT_SET(pObject->Priority_Active_Bits, priority - 1);
+        pObject->Priority_Array[priority - 1] = value;
+        if ((pObject->Present_Value_Priority == 0) ||
+            (priority < pObject->Present_Value_Priority)) {
+            pObject->Present_Value_Priority = (uint8_t)priority;
+        }
         status = true;
     }
 
@@ -3509,6 +3522,8 @@ bool Lighting_Output_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
 
 /**
  * @brief Updates the lighting object tracking value per ramp or fade or step
+ * @note lighting_command_transition_task() updates all the objects with
+ *  a lighting command in progress, and is used instead of this function.
  * @param  object_instance - object-instance number of the object
  * @param milliseconds - number of milliseconds elapsed since previously
  * called.  Suggest that this is called every 10 milliseconds.
@@ -3523,6 +3538,30 @@ void Lighting_Output_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * @brief Steps the lighting command of an object from the
+ *  lighting command transition task
+ * @param  object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed
+ * @return true while the lighting command is in progress
+ */
+static bool Lighting_Output_Transition_Callback(
+    uint32_t object_instance, uint16_t milliseconds)
+{
+    struct object_data *pObject;
+    BACNET_LIGHTING_OPERATION operation;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    lighting_command_timer(&pObject->Lighting_Command, milliseconds);
+    operation = pObject->Lighting_Command.Lighting_Operation;
+
+    return (operation != BACNET_LIGHTS_NONE) &&
+        (operation != BACNET_LIGHTS_STOP);
+}
+
 static void Lighting_Output_Tracking_Value_Callback(
     uint32_t object_instance, float old_value, float value)
 {
@@ -3605,7 +3644,7 @@ uint32_t Lighting_Output_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (!pObject) {
             return BACNET_MAX_INSTANCE;
         }
@@ -3616,6 +3655,9 @@ uint32_t Lighting_Output_Create(uint32_t object_instance)
         pObject->Lighting_Command.Key = object_instance;
         pObject->Lighting_Command.Notification_Head.callback =
             Lighting_Output_Tracking_Value_Callback;
+        pObject->Lighting_Command.Transition.key = object_instance;
+        pObject->Lighting_Command.Transition.callback =
+            Lighting_Output_Transition_Callback;
         pObject->Last_Lighting_Command.operation = BACNET_LIGHTS_NONE;
         pObject->Last_Lighting_Command.use_target_level = false;
         pObject->Last_Lighting_Command.use_ramp_rate = false;
@@ -3633,6 +3675,7 @@ uint32_t Lighting_Output_Create(uint32_t object_instance)
             pObject->Priority_Array[p] = 0.0f;
             BIT_CLEAR(pObject->Priority_Active_Bits, p);
         }
+        pObject->Present_Value_Priority = 0;
         pObject->Relinquish_Default = 0.0f;
         pObject->Power = 0.0f;
         pObject->Instantaneous_Power = 0.0f;
@@ -3645,7 +3688,7 @@ uint32_t Lighting_Output_Create(uint32_t object_instance)
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
-            free(pObject);
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             return BACNET_MAX_INSTANCE;
         }
     }
@@ -3665,7 +3708,8 @@ bool Lighting_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        lighting_command_transition_stop(&pObject->Lighting_Command.Transition);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -3683,7 +3727,9 @@ void Lighting_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                lighting_command_transition_stop(
+                    &pObject->Lighting_Command.Transition);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -3691,6 +3737,32 @@ void Lighting_Output_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Lighting Output objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Lighting_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Lighting Output objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Lighting_Output_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object list
  */
@@ -16,6 +16,7 @@
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
 #include "bacnet/basic/sys/lighting_command.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -252,6 +253,10 @@ BACNET_STACK_EXPORT
 void Lighting_Output_Cleanup(void);
 BACNET_STACK_EXPORT
 void Lighting_Output_Init(void);
+BACNET_STACK_EXPORT
+void Lighting_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Lighting_Output_List_Revision(void);
 
 BACNET_STACK_EXPORT
 int Lighting_Output_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
@@ -30,6 +30,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "bacnet/basic/object/loop.h"
 
@@ -40,6 +41,7 @@ static const BACNET_OBJECT_TYPE Object_Type = OBJECT_LOOP;
 /* handling for manipulated and reference properties */
 static write_property_function Write_Property_Internal_Callback;
 static read_property_function Read_Property_Internal_Callback;
+static loop_real_accessor_function Real_Accessor_Callback;
 
 struct object_data {
     /* internal variables for PID calculations */
@@ -56,6 +58,11 @@ struct object_data {
     BACNET_OBJECT_PROPERTY_REFERENCE Controlled_Variable_Reference;
     float Setpoint;
     BACNET_OBJECT_PROPERTY_REFERENCE Setpoint_Reference;
+    /* direct accessors of the local references, or NULL to use
+       ReadProperty and WriteProperty - bound when the loop next runs */
+    const LOOP_REAL_ACCESSOR *Manipulated_Variable_Accessor;
+    const LOOP_REAL_ACCESSOR *Controlled_Variable_Accessor;
+    const LOOP_REAL_ACCESSOR *Setpoint_Accessor;
     BACNET_ACTION Action;
     float Proportional_Constant;
     BACNET_ENGINEERING_UNITS Proportional_Constant_Units;
@@ -73,6 +80,10 @@ struct object_data {
     BACNET_RELIABILITY Reliability;
     bool Out_Of_Service : 1;
     bool Changed : 1;
+    bool Accessors_Bound : 1;
+    /* the reference is to the property it sets, so there is nothing to read */
+    bool Controlled_Variable_Self : 1;
+    bool Setpoint_Self : 1;
     void *Context;
 };
 
@@ -713,6 +724,7 @@ bool Loop_Manipulated_Variable_Reference_Set(
     if (pObject) {
         status = bacnet_object_property_reference_copy(
             &pObject->Manipulated_Variable_Reference, value);
+        pObject->Accessors_Bound = false;
     }
 
     return status;
@@ -762,6 +774,7 @@ bool Loop_Controlled_Variable_Reference_Set(
     if (pObject) {
         status = bacnet_object_property_reference_copy(
             &pObject->Controlled_Variable_Reference, value);
+        pObject->Accessors_Bound = false;
     }
 
     return status;
@@ -895,6 +908,7 @@ bool Loop_Setpoint_Reference_Set(
     if (pObject) {
         status = bacnet_object_property_reference_copy(
             &pObject->Setpoint_Reference, value);
+        pObject->Accessors_Bound = false;
     }
 
     return status;
@@ -1969,21 +1983,110 @@ void Loop_Read_Property_Internal_Callback_Set(read_property_function cb)
     Read_Property_Internal_Callback = cb;
 }
 
+/**
+ * @brief Sets a callback used to find the direct accessors of the local
+ *  object properties that a loop references
+ * @param cb - callback used to bind the references
+ */
+void Loop_Real_Accessor_Callback_Set(loop_real_accessor_function cb)
+{
+    struct object_data *pObject;
+    int count, index;
+
+    Real_Accessor_Callback = cb;
+    count = Keylist_Count(Object_List);
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (pObject) {
+            pObject->Accessors_Bound = false;
+        }
+    }
+}
+
+/**
+ * @brief Finds the direct accessor of a referenced local object property
+ * @param reference - object property reference
+ * @return the accessor, or NULL to use ReadProperty and WriteProperty
+ */
+static const LOOP_REAL_ACCESSOR *
+Loop_Real_Accessor(const BACNET_OBJECT_PROPERTY_REFERENCE *reference)
+{
+    if (Real_Accessor_Callback && !Object_Property_Reference_Empty(reference)) {
+        return Real_Accessor_Callback(reference);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Determines if a reference is to a property of the loop itself
+ * @param reference - object property reference
+ * @param object_instance - object-instance number of the loop
+ * @param property - property of the loop
+ * @return true if the reference is to the property of the loop
+ */
+static bool Loop_Reference_Self(
+    const BACNET_OBJECT_PROPERTY_REFERENCE *reference,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID property)
+{
+    return (reference->object_identifier.type == OBJECT_LOOP) &&
+        (reference->object_identifier.instance == object_instance) &&
+        (reference->property_identifier == property) &&
+        (reference->property_array_index == BACNET_ARRAY_ALL);
+}
+
+/**
+ * @brief Binds the references of a loop to direct accessors, once after
+ *  any of them changed
+ * @param pObject - object instance data
+ * @param object_instance - object-instance number of the object
+ */
+static void
+Loop_Accessors_Bind(struct object_data *pObject, uint32_t object_instance)
+{
+    if (pObject->Accessors_Bound) {
+        return;
+    }
+    pObject->Manipulated_Variable_Accessor =
+        Loop_Real_Accessor(&pObject->Manipulated_Variable_Reference);
+    pObject->Controlled_Variable_Accessor =
+        Loop_Real_Accessor(&pObject->Controlled_Variable_Reference);
+    pObject->Setpoint_Accessor =
+        Loop_Real_Accessor(&pObject->Setpoint_Reference);
+    pObject->Controlled_Variable_Self = Loop_Reference_Self(
+        &pObject->Controlled_Variable_Reference, object_instance,
+        PROP_CONTROLLED_VARIABLE_VALUE);
+    pObject->Setpoint_Self = Loop_Reference_Self(
+        &pObject->Setpoint_Reference, object_instance, PROP_SETPOINT);
+    pObject->Accessors_Bound = true;
+}
+
 /**
  * @brief For a given object, reads a BACnet Object Property reference
- * @param value - application value
- * @param priority - BACnet priority 0=none,1..16
- * @return  true if values are within range and value is written.
+ * @param reference - object property reference to read
+ * @param accessor - direct accessor of the reference, or NULL to use
+ *  ReadProperty
+ * @param value - [out] the value that was read
+ * @return  true if the value was read
  */
 static bool Loop_Read_Variable_Reference_Update(
-    const BACNET_OBJECT_PROPERTY_REFERENCE *reference, float *value)
+    const BACNET_OBJECT_PROPERTY_REFERENCE *reference,
+    const LOOP_REAL_ACCESSOR *accessor,
+    float *value)
 {
     BACNET_READ_PROPERTY_DATA data = { 0 };
     uint8_t apdu[32] = { 0 };
     int apdu_len = 0, len = 0;
     bool status = false;
 
-    if (!Object_Property_Reference_Empty(reference)) {
+    if (accessor) {
+        /* local object - no need to encode and decode the value */
+        if (accessor->valid(reference->object_identifier.instance)) {
+            *value = accessor->read(reference->object_identifier.instance);
+            status = true;
+        }
+    } else if (!Object_Property_Reference_Empty(reference)) {
         data.object_type = reference->object_identifier.type;
         data.object_instance = reference->object_identifier.instance;
         data.object_property = reference->property_identifier;
@@ -2032,14 +2135,21 @@ static bool Loop_Write_Manipulated_Variable(
 {
     BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
     BACNET_OBJECT_PROPERTY_REFERENCE *member;
+    const LOOP_REAL_ACCESSOR *accessor;
     bool status = false;
 
     if (pObject) {
         member = &pObject->Manipulated_Variable_Reference;
+        accessor = pObject->Manipulated_Variable_Accessor;
         if ((member->object_identifier.type == OBJECT_LOOP) &&
             (member->object_identifier.instance == object_instance)) {
             /* self - perform simulation by setting the controlled variable */
             pObject->Controlled_Variable_Value = value;
+        } else if (accessor && accessor->write) {
+            /* local object - no need to encode and decode the value */
+            status = accessor->write(
+                member->object_identifier.instance, value, priority,
+                &wp_data.error_class, &wp_data.error_code);
         } else if (!Object_Property_Reference_Empty(member)) {
             wp_data.object_type = member->object_identifier.type;
             wp_data.object_instance = member->object_identifier.instance;
@@ -2117,6 +2227,62 @@ Loop_PID_Algorithm(struct object_data *pObject, uint32_t elapsed_milliseconds)
     return output;
 }
 
+/**
+ * @brief Updates the loop operation of one object
+ * @param pObject - object instance data
+ * @param object_instance - object-instance number of the object
+ * @param elapsed_milliseconds - number of milliseconds elapsed
+ */
+static void Loop_Timer_Object(
+    struct object_data *pObject,
+    uint32_t object_instance,
+    uint16_t elapsed_milliseconds)
+{
+    Loop_Accessors_Bind(pObject, object_instance);
+    /* update any variable references */
+    if (!pObject->Controlled_Variable_Self) {
+        Loop_Read_Variable_Reference_Update(
+            &pObject->Controlled_Variable_Reference,
+            pObject->Controlled_Variable_Accessor,
+            &pObject->Controlled_Variable_Value);
+    }
+    if (!pObject->Setpoint_Self) {
+        Loop_Read_Variable_Reference_Update(
+            &pObject->Setpoint_Reference, pObject->Setpoint_Accessor,
+            &pObject->Setpoint);
+    }
+    /* loop algorithm updates the present-value */
+    if (!pObject->Out_Of_Service) {
+        /* When Out_Of_Service is TRUE:
+            (a) the Present_Value property shall be
+                decoupled from the algorithm;
+        */
+        pObject->Present_Value =
+            Loop_PID_Algorithm(pObject, elapsed_milliseconds);
+    }
+    if (pObject->Update_Interval) {
+        pObject->Update_Timer += elapsed_milliseconds;
+        /*  NOTE: No property that represents the interval at which
+            the process variable is sampled or the algorithm is executed
+            is part of this object.
+            The Update_Interval value may be the same as these other values
+            but could also be different depending on the algorithm utilized.
+            The sampling or execution interval is a local matter and need
+            not be represented as part of this object.*/
+        if (pObject->Update_Timer >= pObject->Update_Interval) {
+            pObject->Update_Timer -= pObject->Update_Interval;
+            /*  The property referenced by Manipulated_Variable_Reference
+                and other functions that depend on the state of the
+                Present_Value or Reliability properties shall
+                respond to changes made to these properties,
+                as if those changes had been made by the algorithm.*/
+            Loop_Write_Manipulated_Variable(
+                pObject, object_instance, pObject->Present_Value,
+                pObject->Priority_For_Writing);
+        }
+    }
+}
+
 /**
  * @brief Updates the object loop operation
  * @param object_instance - object-instance number of the object
@@ -2128,41 +2294,26 @@ void Loop_Timer(uint32_t object_instance, uint16_t elapsed_milliseconds)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        /* update any variable references */
-        Loop_Read_Variable_Reference_Update(
-            &pObject->Controlled_Variable_Reference,
-            &pObject->Controlled_Variable_Value);
-        Loop_Read_Variable_Reference_Update(
-            &pObject->Setpoint_Reference, &pObject->Setpoint);
-        /* loop algorithm updates the present-value */
-        if (!pObject->Out_Of_Service) {
-            /* When Out_Of_Service is TRUE:
-                (a) the Present_Value property shall be
-                    decoupled from the algorithm;
-            */
-            pObject->Present_Value =
-                Loop_PID_Algorithm(pObject, elapsed_milliseconds);
-        }
-        if (pObject->Update_Interval) {
-            pObject->Update_Timer += elapsed_milliseconds;
-            /*  NOTE: No property that represents the interval at which
-                the process variable is sampled or the algorithm is executed
-                is part of this object.
-                The Update_Interval value may be the same as these other values
-                but could also be different depending on the algorithm utilized.
-                The sampling or execution interval is a local matter and need
-                not be represented as part of this object.*/
-            if (pObject->Update_Timer >= pObject->Update_Interval) {
-                pObject->Update_Timer -= pObject->Update_Interval;
-                /*  The property referenced by Manipulated_Variable_Reference
-                    and other functions that depend on the state of the
-                    Present_Value or Reliability properties shall
-                    respond to changes made to these properties,
-                    as if those changes had been made by the algorithm.*/
-                Loop_Write_Manipulated_Variable(
-                    pObject, object_instance, pObject->Present_Value,
-                    pObject->Priority_For_Writing);
-            }
+        Loop_Timer_Object(pObject, object_instance, elapsed_milliseconds);
+    }
+}
+
+/**
+ * @brief Updates the loop operation of every object in one pass over
+ *  the object list, without looking each object up by instance
+ * @param elapsed_milliseconds - number of milliseconds elapsed
+ */
+void Loop_Timer_Batch(uint16_t elapsed_milliseconds)
+{
+    struct object_data *pObject;
+    KEY key = 0;
+    int count, index;
+
+    count = Keylist_Count(Object_List);
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (pObject && Keylist_Index_Key(Object_List, index, &key)) {
+            Loop_Timer_Object(pObject, (uint32_t)key, elapsed_milliseconds);
         }
     }
 }
@@ -2195,7 +2346,7 @@ uint32_t Loop_Create(uint32_t object_instance)
         /* already exists - signal success but don't change data */
         return object_instance;
     }
-    pObject = calloc(1, sizeof(struct object_data));
+    pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
     if (!pObject) {
         /* no RAM available - signal failure */
         return BACNET_MAX_INSTANCE;
@@ -2203,7 +2354,7 @@ uint32_t Loop_Create(uint32_t object_instance)
     index = Keylist_Data_Add(Object_List, object_instance, pObject);
     if (index < 0) {
         /* unable to add to list - signal failure */
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         return BACNET_MAX_INSTANCE;
     }
     /* only need to set property values that are non-zero */
@@ -2253,7 +2404,7 @@ bool Loop_Delete(uint32_t object_instance)
         Keylist_Data_Delete(Object_List, object_instance);
 
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -2271,7 +2422,7 @@ void Loop_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
 
@@ -2288,6 +2439,32 @@ size_t Loop_Size(void)
     return sizeof(struct object_data);
 }
 
+/**
+ * @brief Add the memory used by the Loop objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Loop_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Loop objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Loop_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object data
  */
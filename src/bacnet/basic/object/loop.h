@@ -17,6 +17,36 @@
 #include "bacnet/wp.h"
 #include "bacnet/rp.h"
 #include "bacnet/list_element.h"
+#include "bacnet/basic/sys/memusage.h"
+
+/**
+ * Direct access to the REAL property of a local object that a loop
+ * references, used instead of ReadProperty and WriteProperty
+ * @{
+ */
+typedef struct loop_real_accessor {
+    /** determines if the object instance exists - required */
+    bool (*valid)(uint32_t object_instance);
+    /** reads the property value - required */
+    float (*read)(uint32_t object_instance);
+    /** writes the property value, or NULL to use WriteProperty */
+    bool (*write)(
+        uint32_t object_instance,
+        float value,
+        uint8_t priority,
+        BACNET_ERROR_CLASS *error_class,
+        BACNET_ERROR_CODE *error_code);
+} LOOP_REAL_ACCESSOR;
+/** @} */
+
+/**
+ * @brief Finds the direct accessor of a referenced object property
+ * @param reference - object property reference of a loop
+ * @return the accessor, or NULL if the property is only reachable with
+ *  ReadProperty and WriteProperty
+ */
+typedef const LOOP_REAL_ACCESSOR *(*loop_real_accessor_function)(
+    const BACNET_OBJECT_PROPERTY_REFERENCE *reference);
 
 #ifdef __cplusplus
 extern "C" {
@@ -186,11 +216,15 @@ bool Loop_Reliability_Evaluation_Inhibit_Set(uint32_t instance, bool value);
 
 BACNET_STACK_EXPORT
 void Loop_Timer(uint32_t object_instance, uint16_t elapsed_milliseconds);
+BACNET_STACK_EXPORT
+void Loop_Timer_Batch(uint16_t elapsed_milliseconds);
 
 BACNET_STACK_EXPORT
 void Loop_Write_Property_Internal_Callback_Set(write_property_function cb);
 BACNET_STACK_EXPORT
 void Loop_Read_Property_Internal_Callback_Set(read_property_function cb);
+BACNET_STACK_EXPORT
+void Loop_Real_Accessor_Callback_Set(loop_real_accessor_function cb);
 
 BACNET_STACK_EXPORT
 int Loop_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
@@ -208,6 +242,10 @@ BACNET_STACK_EXPORT
 size_t Loop_Size(void);
 BACNET_STACK_EXPORT
 void Loop_Init(void);
+BACNET_STACK_EXPORT
+void Loop_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Loop_List_Revision(void);
 
 BACNET_STACK_EXPORT
 void *Loop_Context_Get(uint32_t object_instance);
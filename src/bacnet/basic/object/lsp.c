@@ -19,6 +19,7 @@
 #include "bacnet/basic/object/lsp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/proplist.h"
 
 struct object_data {
@@ -36,6 +37,8 @@ struct object_data {
 static OS_Keylist Object_List;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_LIFE_SAFETY_POINT;
+/* callback for present-value and mode changes */
+static life_safety_point_change_callback Life_Safety_Point_Change_Callback;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Life_Safety_Point_Properties_Required[] = {
@@ -137,6 +140,22 @@ unsigned Life_Safety_Point_Instance_To_Index(uint32_t object_instance)
     return Keylist_Index(Object_List, object_instance);
 }
 
+/**
+ * @brief Report the present-value and the mode of an object to the change
+ *  callback
+ * @param  object_instance - object-instance number of the object
+ * @param  pObject - object data
+ * @param  deleted - true if the object is deleted
+ */
+static void Life_Safety_Point_Change_Notify(
+    uint32_t object_instance, const struct object_data *pObject, bool deleted)
+{
+    if (Life_Safety_Point_Change_Callback) {
+        Life_Safety_Point_Change_Callback(
+            object_instance, pObject->Present_Value, pObject->Mode, deleted);
+    }
+}
+
 /**
  * @brief For a given object instance-number, determines the present-value
  * @param  object_instance - object-instance number of the object
@@ -170,7 +189,10 @@ bool Life_Safety_Point_Present_Value_Set(
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        pObject->Present_Value = value;
+        if (pObject->Present_Value != value) {
+            pObject->Present_Value = value;
+            Life_Safety_Point_Change_Notify(object_instance, pObject, false);
+        }
         status = true;
     }
 
@@ -322,7 +344,11 @@ bool Life_Safety_Point_Mode_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         if (value <= LIFE_SAFETY_MODE_PROPRIETARY_MAX) {
-            pObject->Mode = value;
+            if (pObject->Mode != value) {
+                pObject->Mode = value;
+                Life_Safety_Point_Change_Notify(
+                    object_instance, pObject, false);
+            }
             status = true;
         }
     }
@@ -330,6 +356,30 @@ bool Life_Safety_Point_Mode_Set(
     return status;
 }
 
+/**
+ * @brief Sets a callback used when the present-value or the mode of an
+ *  object changes, or an object is created or deleted, such as to keep
+ *  the member states of the Life Safety Zone objects.  The present-value
+ *  and the mode of the existing objects are reported at once.
+ * @param cb - callback used to provide indications, or NULL
+ */
+void Life_Safety_Point_Change_Callback_Set(
+    life_safety_point_change_callback cb)
+{
+    struct object_data *pObject;
+    KEY key = 0;
+    int index, count;
+
+    Life_Safety_Point_Change_Callback = cb;
+    count = Keylist_Count(Object_List);
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (pObject && Keylist_Index_Key(Object_List, index, &key)) {
+            Life_Safety_Point_Change_Notify(key, pObject, false);
+        }
+    }
+}
+
 /**
  * @brief For a given object instance-number, gets the property value
  * @param  object_instance - object-instance number of the object
@@ -727,7 +777,7 @@ uint32_t Life_Safety_Point_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
@@ -739,9 +789,10 @@ uint32_t Life_Safety_Point_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
+            Life_Safety_Point_Change_Notify(object_instance, pObject, false);
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -762,7 +813,8 @@ bool Life_Safety_Point_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        Life_Safety_Point_Change_Notify(object_instance, pObject, true);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -775,12 +827,21 @@ bool Life_Safety_Point_Delete(uint32_t object_instance)
 void Life_Safety_Point_Cleanup(void)
 {
     struct object_data *pObject;
+    KEY key = 0;
+    int index, count;
 
     if (Object_List) {
+        count = Keylist_Count(Object_List);
+        for (index = 0; index < count; index++) {
+            pObject = Keylist_Data_Index(Object_List, index);
+            if (pObject && Keylist_Index_Key(Object_List, index, &key)) {
+                Life_Safety_Point_Change_Notify(key, pObject, true);
+            }
+        }
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -788,6 +849,32 @@ void Life_Safety_Point_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Life Safety Point objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Life_Safety_Point_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Life Safety Point objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Life_Safety_Point_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * @brief Initializes the object data
  */
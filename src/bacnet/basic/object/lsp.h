@@ -15,6 +15,21 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
+
+/**
+ * @brief Callback for a change of the present-value or the mode of a
+ *  Life Safety Point, including its creation and its deletion
+ * @param  object_instance - object-instance number of the object
+ * @param  state - present-value of the object
+ * @param  mode - mode of the object
+ * @param  deleted - true if the object was deleted
+ */
+typedef void (*life_safety_point_change_callback)(
+    uint32_t object_instance,
+    BACNET_LIFE_SAFETY_STATE state,
+    BACNET_LIFE_SAFETY_MODE mode,
+    bool deleted);
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +75,9 @@ BACNET_STACK_EXPORT
 bool Life_Safety_Point_Mode_Set(
     uint32_t object_instance, BACNET_LIFE_SAFETY_MODE value);
 BACNET_STACK_EXPORT
+void Life_Safety_Point_Change_Callback_Set(
+    life_safety_point_change_callback cb);
+BACNET_STACK_EXPORT
 BACNET_LIFE_SAFETY_OPERATION
 Life_Safety_Point_Operation_Expected(uint32_t object_instance);
 BACNET_STACK_EXPORT
@@ -96,6 +114,10 @@ BACNET_STACK_EXPORT
 void Life_Safety_Point_Cleanup(void);
 BACNET_STACK_EXPORT
 void Life_Safety_Point_Init(void);
+BACNET_STACK_EXPORT
+void Life_Safety_Point_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Life_Safety_Point_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -25,6 +25,7 @@
 #include "bacnet/wp.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/proplist.h"
 /* me! */
 #include "bacnet/basic/object/lsz.h"
@@ -40,10 +41,29 @@ struct object_data {
     uint8_t Reliability;
     const char *Object_Name;
     OS_Keylist Zone_Members;
+    /* the local Life Safety Points in the Zone_Members, by instance */
+    OS_Keylist Member_Points;
+    /* number of the member points in each state and mode, where the
+       reserved and proprietary values share the last count */
+    unsigned Member_Point_Count;
+    unsigned Member_State_Count[LIFE_SAFETY_STATE_RESERVED_MIN + 1];
+    unsigned Member_Mode_Count[LIFE_SAFETY_MODE_RESERVED_MIN + 1];
     void *Context;
 };
+/* a local Life Safety Point in the Zone_Members of a zone */
+struct member_point {
+    /* number of times the point is in the Zone_Members */
+    unsigned References;
+};
+/* the last present-value and mode of a local Life Safety Point */
+struct point_data {
+    BACNET_LIFE_SAFETY_STATE State;
+    BACNET_LIFE_SAFETY_MODE Mode;
+};
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* Key List of the Life Safety Points reported by their change callback */
+static OS_Keylist Point_List;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_LIFE_SAFETY_ZONE;
 
@@ -504,6 +524,213 @@ static int Life_Safety_Zone_Members_Encode(
     return apdu_len;
 }
 
+/**
+ * @brief Free the data of every node of a list, and empty the list
+ * @param list - list of the zone members, member points, or points
+ * @param size - size of the data of one node
+ */
+static void Life_Safety_Zone_List_Free(OS_Keylist list, size_t size)
+{
+    (void)size;
+    while (Keylist_Count(list) > 0) {
+        BACNET_MEMPOOL_FREE(Keylist_Data_Pop(list), size);
+    }
+}
+
+/**
+ * @brief Add or remove the references of a member point to the member
+ *  state and mode counts of a zone
+ * @param pObject - zone object data
+ * @param point - the present-value and the mode of the point
+ * @param references - number of references to the point
+ * @param add - true to add the references, false to remove them
+ */
+static void Life_Safety_Zone_Member_Count_Update(
+    struct object_data *pObject,
+    const struct point_data *point,
+    unsigned references,
+    bool add)
+{
+    unsigned state, mode;
+
+    state = min(point->State, LIFE_SAFETY_STATE_RESERVED_MIN);
+    mode = min(point->Mode, LIFE_SAFETY_MODE_RESERVED_MIN);
+    if (add) {
+        pObject->Member_Point_Count += references;
+        pObject->Member_State_Count[state] += references;
+        pObject->Member_Mode_Count[mode] += references;
+    } else {
+        pObject->Member_Point_Count -= references;
+        pObject->Member_State_Count[state] -= references;
+        pObject->Member_Mode_Count[mode] -= references;
+    }
+}
+
+/**
+ * @brief Add a reference to a local Life Safety Point to the member points
+ *  of a zone, and count its present-value and mode if it is known
+ * @param pObject - zone object data
+ * @param point_instance - object-instance number of the point
+ */
+static void Life_Safety_Zone_Member_Point_Add(
+    struct object_data *pObject, uint32_t point_instance)
+{
+    struct member_point *member;
+    const struct point_data *point;
+
+    member = Keylist_Data(pObject->Member_Points, point_instance);
+    if (!member) {
+        member = BACNET_MEMPOOL_CALLOC(sizeof(struct member_point));
+        if (!member) {
+            return;
+        }
+        if (Keylist_Data_Add(pObject->Member_Points, point_instance, member) <
+            0) {
+            BACNET_MEMPOOL_FREE(member, sizeof(struct member_point));
+            return;
+        }
+    }
+    member->References++;
+    point = Keylist_Data(Point_List, point_instance);
+    if (point) {
+        Life_Safety_Zone_Member_Count_Update(pObject, point, 1, true);
+    }
+}
+
+/**
+ * @brief Update the member state and mode counts of the zones when the
+ *  present-value or the mode of a local Life Safety Point changes, so that
+ *  the zones never walk their Zone_Members.  This function matches the
+ *  Life Safety Point change callback.
+ * @param point_instance - object-instance number of the point
+ * @param state - present-value of the point
+ * @param mode - mode of the point
+ * @param deleted - true if the point was deleted
+ */
+void Life_Safety_Zone_Point_Change(
+    uint32_t point_instance,
+    BACNET_LIFE_SAFETY_STATE state,
+    BACNET_LIFE_SAFETY_MODE mode,
+    bool deleted)
+{
+    struct object_data *pObject;
+    const struct member_point *member;
+    struct point_data *point;
+    struct point_data old_value = { 0 };
+    struct point_data value = { 0 };
+    bool known = false;
+    int index, count;
+
+    if (!Point_List) {
+        Point_List = Keylist_Create();
+    }
+    point = Keylist_Data(Point_List, point_instance);
+    if (point) {
+        old_value = *point;
+        known = true;
+    } else if (deleted) {
+        return;
+    } else {
+        point = BACNET_MEMPOOL_CALLOC(sizeof(struct point_data));
+        if (!point) {
+            return;
+        }
+        if (Keylist_Data_Add(Point_List, point_instance, point) < 0) {
+            BACNET_MEMPOOL_FREE(point, sizeof(struct point_data));
+            return;
+        }
+    }
+    value.State = state;
+    value.Mode = mode;
+    count = Keylist_Count(Object_List);
+    for (index = 0; index < count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (!pObject) {
+            continue;
+        }
+        member = Keylist_Data(pObject->Member_Points, point_instance);
+        if (!member) {
+            continue;
+        }
+        if (known) {
+            Life_Safety_Zone_Member_Count_Update(
+                pObject, &old_value, member->References, false);
+        }
+        if (!deleted) {
+            Life_Safety_Zone_Member_Count_Update(
+                pObject, &value, member->References, true);
+        }
+    }
+    if (deleted) {
+        BACNET_MEMPOOL_FREE(
+            Keylist_Data_Delete(Point_List, point_instance),
+            sizeof(struct point_data));
+    } else {
+        *point = value;
+    }
+}
+
+/**
+ * @brief For a given zone, get the number of member points in a state
+ * @param object_instance - object-instance number of the zone
+ * @param state - present-value of the member points, where the reserved
+ *  and proprietary values share one count
+ * @return number of member points in the state
+ */
+unsigned Life_Safety_Zone_Member_State_Count(
+    uint32_t object_instance, BACNET_LIFE_SAFETY_STATE state)
+{
+    const struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+
+    return pObject->Member_State_Count[min(
+        state, LIFE_SAFETY_STATE_RESERVED_MIN)];
+}
+
+/**
+ * @brief For a given zone, get the number of member points in a mode
+ * @param object_instance - object-instance number of the zone
+ * @param mode - mode of the member points, where the reserved and
+ *  proprietary values share one count
+ * @return number of member points in the mode
+ */
+unsigned Life_Safety_Zone_Member_Mode_Count(
+    uint32_t object_instance, BACNET_LIFE_SAFETY_MODE mode)
+{
+    const struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+
+    return pObject->Member_Mode_Count[min(
+        mode, LIFE_SAFETY_MODE_RESERVED_MIN)];
+}
+
+/**
+ * @brief For a given zone, get the number of members that are local Life
+ *  Safety Points with a known present-value and mode.  Members that
+ *  include a device identifier are not counted.
+ * @param object_instance - object-instance number of the zone
+ * @return number of member points
+ */
+unsigned Life_Safety_Zone_Member_Point_Count(uint32_t object_instance)
+{
+    const struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+
+    return pObject->Member_Point_Count;
+}
+
 /**
  * @brief Add a member to the Zone Members list
  * @param object_instance - object-instance number of the object
@@ -522,13 +749,25 @@ bool Life_Safety_Zone_Members_Add(
     if (!pObject) {
         return false;
     }
-    entry = calloc(1, sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
+    entry = BACNET_MEMPOOL_CALLOC(
+        sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
     if (!entry) {
         return false;
     }
     memcpy(entry, data, sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
-    status = Keylist_Data_Add(
-        pObject->Zone_Members, Keylist_Count(pObject->Zone_Members), entry);
+    if (Keylist_Data_Add(
+            pObject->Zone_Members, Keylist_Count(pObject->Zone_Members),
+            entry) < 0) {
+        BACNET_MEMPOOL_FREE(
+            entry, sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
+        return false;
+    }
+    status = true;
+    if ((entry->objectIdentifier.type == OBJECT_LIFE_SAFETY_POINT) &&
+        (entry->deviceIdentifier.type != OBJECT_DEVICE)) {
+        Life_Safety_Zone_Member_Point_Add(
+            pObject, entry->objectIdentifier.instance);
+    }
 
     return status;
 }
@@ -543,7 +782,17 @@ void Life_Safety_Zone_Members_Clear(uint32_t object_instance)
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        Keylist_Data_Free(pObject->Zone_Members);
+        Life_Safety_Zone_List_Free(
+            pObject->Zone_Members,
+            sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
+        Life_Safety_Zone_List_Free(
+            pObject->Member_Points, sizeof(struct member_point));
+        pObject->Member_Point_Count = 0;
+        memset(
+            pObject->Member_State_Count, 0,
+            sizeof(pObject->Member_State_Count));
+        memset(
+            pObject->Member_Mode_Count, 0, sizeof(pObject->Member_Mode_Count));
     }
 }
 
@@ -904,7 +1153,7 @@ uint32_t Life_Safety_Zone_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
@@ -915,10 +1164,11 @@ uint32_t Life_Safety_Zone_Create(uint32_t object_instance)
             pObject->Maintenance_Required = false;
             pObject->Out_Of_Service = false;
             pObject->Zone_Members = Keylist_Create();
+            pObject->Member_Points = Keylist_Create();
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -941,9 +1191,14 @@ bool Life_Safety_Zone_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        Keylist_Data_Free(pObject->Zone_Members);
+        Life_Safety_Zone_List_Free(
+            pObject->Zone_Members,
+            sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
         Keylist_Delete(pObject->Zone_Members);
-        free(pObject);
+        Life_Safety_Zone_List_Free(
+            pObject->Member_Points, sizeof(struct member_point));
+        Keylist_Delete(pObject->Member_Points);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -961,12 +1216,53 @@ void Life_Safety_Zone_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                Life_Safety_Zone_List_Free(
+                    pObject->Zone_Members,
+                    sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE));
+                Keylist_Delete(pObject->Zone_Members);
+                Life_Safety_Zone_List_Free(
+                    pObject->Member_Points, sizeof(struct member_point));
+                Keylist_Delete(pObject->Member_Points);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+    if (Point_List) {
+        Life_Safety_Zone_List_Free(Point_List, sizeof(struct point_data));
+        Keylist_Delete(Point_List);
+        Point_List = NULL;
+    }
+}
+
+/**
+ * @brief Add the memory used by the Life Safety Zone objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Life_Safety_Zone_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->dynamic_bytes += Keylist_Memory_Size(Point_List);
+    usage->dynamic_bytes +=
+        Keylist_Count(Point_List) * sizeof(struct point_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Life Safety Zone objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Life_Safety_Zone_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
 }
 
 /**
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -83,6 +84,20 @@ bool Life_Safety_Zone_Members_Add(
     const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *data);
 BACNET_STACK_EXPORT
 void Life_Safety_Zone_Members_Clear(uint32_t object_instance);
+BACNET_STACK_EXPORT
+void Life_Safety_Zone_Point_Change(
+    uint32_t point_instance,
+    BACNET_LIFE_SAFETY_STATE state,
+    BACNET_LIFE_SAFETY_MODE mode,
+    bool deleted);
+BACNET_STACK_EXPORT
+unsigned Life_Safety_Zone_Member_State_Count(
+    uint32_t object_instance, BACNET_LIFE_SAFETY_STATE state);
+BACNET_STACK_EXPORT
+unsigned Life_Safety_Zone_Member_Mode_Count(
+    uint32_t object_instance, BACNET_LIFE_SAFETY_MODE mode);
+BACNET_STACK_EXPORT
+unsigned Life_Safety_Zone_Member_Point_Count(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
 bool Life_Safety_Zone_Maintenance_Required(uint32_t object_instance);
@@ -109,6 +124,10 @@ BACNET_STACK_EXPORT
 void Life_Safety_Zone_Cleanup(void);
 BACNET_STACK_EXPORT
 void Life_Safety_Zone_Init(void);
+BACNET_STACK_EXPORT
+void Life_Safety_Zone_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Life_Safety_Zone_List_Revision(void);
 
 #ifdef __cplusplus
 }
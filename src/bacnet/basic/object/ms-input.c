@@ -19,6 +19,8 @@
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/strpool.h"
 #include "bacnet/basic/services.h"
 /* me! */
 #include "bacnet/basic/object/ms-input.h"
@@ -269,6 +271,39 @@ static int Multistate_Input_State_Text_Encode(
     return apdu_len;
 }
 
+#if defined(BACNET_STRING_POOL)
+/**
+ * @brief Copy the pre-encoded State_Text array of an object that uses
+ *  a pooled state-text list
+ * @param object_instance - object-instance number of the object
+ * @param apdu [out] Buffer in which the APDU contents are built
+ * @param apdu_size [in] Size of the buffer
+ * @return number of bytes copied, or 0 if the state-text list is not
+ *  pooled or does not fit in the buffer
+ */
+static int Multistate_Input_State_Text_Pooled_Encode(
+    uint32_t object_instance, uint8_t *apdu, int apdu_size)
+{
+    const struct object_data *pObject;
+    const uint8_t *encoded;
+    size_t encoded_len = 0;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+    encoded = strpool_list_encoded(pObject->State_Text, &encoded_len);
+    if (!encoded || (apdu_size < 0) || (encoded_len > (size_t)apdu_size)) {
+        return 0;
+    }
+    if (apdu) {
+        memcpy(apdu, encoded, encoded_len);
+    }
+
+    return (int)encoded_len;
+}
+#endif
+
 /**
  * @brief For a given object instance-number, sets the list of state-text from
  * a C string array. The state_text_list consists of C strings separated
@@ -810,6 +845,15 @@ int Multistate_Input_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
                 Multistate_Input_Max_States(rpdata->object_instance));
             break;
         case PROP_STATE_TEXT:
+#if defined(BACNET_STRING_POOL)
+            if (rpdata->array_index == BACNET_ARRAY_ALL) {
+                apdu_len = Multistate_Input_State_Text_Pooled_Encode(
+                    rpdata->object_instance, apdu, apdu_size);
+                if (apdu_len > 0) {
+                    break;
+                }
+            }
+#endif
             max_states = Multistate_Input_Max_States(rpdata->object_instance);
             apdu_len = bacnet_array_encode(
                 rpdata->object_instance, rpdata->array_index,
@@ -1011,7 +1055,7 @@ uint32_t Multistate_Input_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->State_Text = Default_State_Text;
@@ -1023,7 +1067,7 @@ uint32_t Multistate_Input_Create(uint32_t object_instance)
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1046,7 +1090,7 @@ bool Multistate_Input_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1064,7 +1108,7 @@ void Multistate_Input_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1072,6 +1116,32 @@ void Multistate_Input_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Multistate Input objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Multistate_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Multistate Input objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Multistate_Input_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * @brief Initializes the object list
  */
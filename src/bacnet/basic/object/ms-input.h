@@ -16,6 +16,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -133,6 +134,10 @@ void Multistate_Input_Cleanup(void);
 
 BACNET_STACK_EXPORT
 void Multistate_Input_Init(void);
+BACNET_STACK_EXPORT
+void Multistate_Input_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Multistate_Input_List_Revision(void);
 
 #ifdef __cplusplus
 }
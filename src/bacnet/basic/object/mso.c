@@ -28,13 +28,18 @@
 #include "bacnet/proplist.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/strpool.h"
+#include "bacnet/basic/sys/priority_array.h"
 /* me! */
 #include "mso.h"
 
 struct object_data {
     bool Out_Of_Service : 1;
     bool Changed : 1;
-    bool Relinquished[BACNET_MAX_PRIORITY];
+    /* active priority 1..16 of the present-value, or 0 if relinquished */
+    uint8_t Present_Value_Priority;
+    uint16_t Priority_Active_Bits;
     uint8_t Priority_Array[BACNET_MAX_PRIORITY];
     uint8_t Relinquish_Default;
     uint8_t Reliability;
@@ -232,21 +237,20 @@ uint32_t Multistate_Output_Max_States(uint32_t object_instance)
 
 /**
  * @brief For a given object instance-number, determines the present-value
+ *  from the cached active priority of the priority array
  * @param  object_instance - object-instance number of the object
  * @return  present-value of the object
  */
 static uint32_t Object_Present_Value(const struct object_data *pObject)
 {
     uint32_t value = 1;
-    uint8_t priority = 0; /* loop counter */
 
     if (pObject) {
-        value = pObject->Relinquish_Default;
-        for (priority = 0; priority < BACNET_MAX_PRIORITY; priority++) {
-            if (!pObject->Relinquished[priority]) {
-                value = pObject->Priority_Array[priority];
-                break;
-            }
+        if (pObject->Present_Value_Priority) {
+            value =
+                pObject->Priority_Array[pObject->Present_Value_Priority - 1];
+        } else {
+            value = pObject->Relinquish_Default;
         }
     }
 
@@ -288,7 +292,7 @@ static int Multistate_Output_Priority_Array_Encode(
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && (priority < BACNET_MAX_PRIORITY)) {
-        if (pObject->Relinquished[priority]) {
+        if (!BIT_CHECK(pObject->Priority_Active_Bits, priority)) {
             apdu_len = encode_application_null(apdu);
         } else {
             value = pObject->Priority_Array[priority];
@@ -306,18 +310,12 @@ static int Multistate_Output_Priority_Array_Encode(
  */
 unsigned Multistate_Output_Present_Value_Priority(uint32_t object_instance)
 {
-    unsigned p = 0; /* loop counter */
     unsigned priority = 0; /* return value */
     struct object_data *pObject;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
-        for (p = 0; p < BACNET_MAX_PRIORITY; p++) {
-            if (!pObject->Relinquished[p]) {
-                priority = p + 1;
-                break;
-            }
-        }
+        priority = pObject->Present_Value_Priority;
     }
 
     return priority;
@@ -437,8 +435,12 @@ bool Multistate_Output_Present_Value_Set(
         if ((value >= 1) && (value <= max_states) && (priority >= 1) &&
             (priority <= BACNET_MAX_PRIORITY)) {
             old_value = Object_Present_Value(pObject);
-            pObject->Relinquished[priority - 1] = false;
+            BIT_SET(pObject->Priority_Active_Bits, priority - 1);
             pObject->Priority_Array[priority - 1] = value;
+            if ((pObject->Present_Value_Priority == 0) ||
+                (priority < pObject->Present_Value_Priority)) {
+                pObject->Present_Value_Priority = (uint8_t)priority;
+            }
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
@@ -465,7 +467,8 @@ bool Multistate_Output_Priority_Array_Relinquished(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         if ((priority >= 1) && (priority <= BACNET_MAX_PRIORITY)) {
-            status = pObject->Relinquished[priority - 1];
+            status =
+                !BIT_CHECK(pObject->Priority_Active_Bits, priority - 1);
         }
     }
 
@@ -514,8 +517,12 @@ bool Multistate_Output_Present_Value_Relinquish(
     if (pObject) {
         if ((priority >= 1) && (priority <= BACNET_MAX_PRIORITY)) {
             old_value = Object_Present_Value(pObject);
-            pObject->Relinquished[priority - 1] = true;
+            BIT_CLEAR(pObject->Priority_Active_Bits, priority - 1);
             pObject->Priority_Array[priority - 1] = 0;
+            if (priority == pObject->Present_Value_Priority) {
+                pObject->Present_Value_Priority = Priority_Active_Next(
+                    pObject->Priority_Active_Bits, priority + 1);
+            }
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
@@ -801,6 +808,39 @@ static int Multistate_Output_State_Text_Encode(
     return apdu_len;
 }
 
+#if defined(BACNET_STRING_POOL)
+/**
+ * @brief Copy the pre-encoded State_Text array of an object that uses
+ *  a pooled state-text list
+ * @param object_instance - object-instance number of the object
+ * @param apdu [out] Buffer in which the APDU contents are built
+ * @param apdu_size [in] Size of the buffer
+ * @return number of bytes copied, or 0 if the state-text list is not
+ *  pooled or does not fit in the buffer
+ */
+static int Multistate_Output_State_Text_Pooled_Encode(
+    uint32_t object_instance, uint8_t *apdu, int apdu_size)
+{
+    const struct object_data *pObject;
+    const uint8_t *encoded;
+    size_t encoded_len = 0;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return 0;
+    }
+    encoded = strpool_list_encoded(pObject->State_Text, &encoded_len);
+    if (!encoded || (apdu_size < 0) || (encoded_len > (size_t)apdu_size)) {
+        return 0;
+    }
+    if (apdu) {
+        memcpy(apdu, encoded, encoded_len);
+    }
+
+    return (int)encoded_len;
+}
+#endif
+
 /**
  * @brief For a given object instance-number, sets the list of state-text from
  * a C string array. The state_text_list consists of C strings separated
@@ -1112,6 +1152,15 @@ int Multistate_Output_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             apdu_len = encode_application_unsigned(&apdu[0], present_value);
             break;
         case PROP_STATE_TEXT:
+#if defined(BACNET_STRING_POOL)
+            if (rpdata->array_index == BACNET_ARRAY_ALL) {
+                apdu_len = Multistate_Output_State_Text_Pooled_Encode(
+                    rpdata->object_instance, apdu, apdu_size);
+                if (apdu_len > 0) {
+                    break;
+                }
+            }
+#endif
             max_states = Multistate_Output_Max_States(rpdata->object_instance);
             apdu_len = bacnet_array_encode(
                 rpdata->object_instance, rpdata->array_index,
@@ -1306,22 +1355,23 @@ uint32_t Multistate_Output_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (pObject) {
             pObject->Object_Name = NULL;
             pObject->State_Text = Default_State_Text;
             pObject->Out_Of_Service = false;
             pObject->Reliability = RELIABILITY_NO_FAULT_DETECTED;
             pObject->Changed = false;
+            pObject->Priority_Active_Bits = 0;
+            pObject->Present_Value_Priority = 0;
             for (priority = 0; priority < BACNET_MAX_PRIORITY; priority++) {
-                pObject->Relinquished[priority] = true;
                 pObject->Priority_Array[priority] = 0;
             }
             pObject->Relinquish_Default = 1;
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
                 return BACNET_MAX_INSTANCE;
             }
         } else {
@@ -1344,7 +1394,7 @@ bool Multistate_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1362,7 +1412,7 @@ void Multistate_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -1370,6 +1420,32 @@ void Multistate_Output_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Multistate Output objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Multistate_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Multistate Output objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Multistate_Output_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * @brief Initializes the object list
  */
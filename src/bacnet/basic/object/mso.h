@@ -17,6 +17,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -141,6 +142,10 @@ void Multistate_Output_Cleanup(void);
 
 BACNET_STACK_EXPORT
 void Multistate_Output_Init(void);
+BACNET_STACK_EXPORT
+void Multistate_Output_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Multistate_Output_List_Revision(void);
 
 #ifdef __cplusplus
 }
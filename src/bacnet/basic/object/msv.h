@@ -16,6 +16,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -132,6 +133,10 @@ void Multistate_Value_Cleanup(void);
 
 BACNET_STACK_EXPORT
 void Multistate_Value_Init(void);
+BACNET_STACK_EXPORT
+void Multistate_Value_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Multistate_Value_List_Revision(void);
 
 #ifdef __cplusplus
 }
@@ -36,7 +36,28 @@
 #if defined(INTRINSIC_REPORTING)
 static NOTIFICATION_CLASS_INFO NC_Info[MAX_NOTIFICATION_CLASSES];
 /* buffer for sending event messages */
-static uint8_t Event_Buffer[MAX_APDU];
+static uint8_t Event_Buffer[MAX_PDU];
+/* notification body, encoded once for all the recipients */
+static uint8_t Event_Body[MAX_APDU];
+
+/* recipient time window state for the minute of the cache refresh */
+#define NC_WINDOW_OUT 0
+#define NC_WINDOW_IN 1
+#define NC_WINDOW_CHECK 2
+
+/* Recipient resolved for sending event notifications.  The cache is
+   refreshed when a recipient list changes, when the minute changes, and
+   by Notification_Class_find_recipient() */
+typedef struct Notification_Class_Recipient_Cache {
+    uint8_t window; /* NC_WINDOW_OUT, NC_WINDOW_IN, or NC_WINDOW_CHECK */
+    bool bound; /* the destination address is known */
+    unsigned max_apdu;
+    BACNET_ADDRESS dest;
+} NC_RECIPIENT_CACHE;
+static NC_RECIPIENT_CACHE NC_Recipient_Cache[MAX_NOTIFICATION_CLASSES]
+                                            [NC_MAX_RECIPIENTS];
+static bool NC_Recipient_Cache_Valid;
+static BACNET_DATE_TIME NC_Recipient_Cache_Time;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Properties_Required[] = {
@@ -88,6 +109,7 @@ void Notification_Class_Init(void)
             bacnet_destination_default_init(destination);
         }
     }
+    NC_Recipient_Cache_Valid = false;
 
     return;
 }
@@ -431,6 +453,7 @@ bool Notification_Class_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     /* nothing to do - we have the address */
                 }
             }
+            NC_Recipient_Cache_Valid = false;
             status = true;
             break;
         default:
@@ -505,6 +528,7 @@ bool Notification_Class_Set_Recipient_List(
         for (i = 0; i < NC_MAX_RECIPIENTS; i++) {
             CurrentNotify->Recipient_List[i] = pRecipientList[i];
         }
+        NC_Recipient_Cache_Valid = false;
     } else {
         return false; /* unknown object */
     }
@@ -557,58 +581,127 @@ void Notification_Class_Set_Ack_Required(
     }
 }
 
-static bool
-IsRecipientActive(BACNET_DESTINATION *pBacDest, uint8_t EventToState)
+/**
+ * @brief Determine if a recipient wants the notifications of a transition
+ * @param pBacDest - recipient destination
+ * @param EventToState - event state of the transition
+ * @return true if the transition is one of the recipient transitions
+ */
+static bool Notification_Class_Transition_Enabled(
+    BACNET_DESTINATION *pBacDest, uint8_t EventToState)
 {
-    BACNET_DATE_TIME DateTime;
-
     /* valid Transitions */
     switch (EventToState) {
         case EVENT_STATE_OFFNORMAL:
         case EVENT_STATE_HIGH_LIMIT:
         case EVENT_STATE_LOW_LIMIT:
-            if (!bitstring_bit(
-                    &pBacDest->Transitions, TRANSITION_TO_OFFNORMAL)) {
-                return false;
-            }
-            break;
-
+            return bitstring_bit(
+                &pBacDest->Transitions, TRANSITION_TO_OFFNORMAL);
         case EVENT_STATE_FAULT:
-            if (!bitstring_bit(&pBacDest->Transitions, TRANSITION_TO_FAULT)) {
-                return false;
-            }
-            break;
-
+            return bitstring_bit(&pBacDest->Transitions, TRANSITION_TO_FAULT);
         case EVENT_STATE_NORMAL:
-            if (!bitstring_bit(&pBacDest->Transitions, TRANSITION_TO_NORMAL)) {
-                return false;
-            }
-            break;
-
+            return bitstring_bit(&pBacDest->Transitions, TRANSITION_TO_NORMAL);
         default:
             return false; /* shouldn't happen */
     }
+}
 
-    /* get actual date and time */
-    datetime_local(&DateTime.date, &DateTime.time, NULL, NULL);
-
-    /* valid Days */
-    if (!(bitstring_bit(&pBacDest->ValidDays, (DateTime.date.wday - 1)))) {
-        return false;
-    }
+/**
+ * @brief Determine if a time is within the FromTime and ToTime of a
+ *  recipient
+ * @param pBacDest - recipient destination
+ * @param btime - time to compare
+ * @return true if the time is within the recipient time window
+ */
+static bool Notification_Class_Time_Window(
+    BACNET_DESTINATION *pBacDest, const BACNET_TIME *btime)
+{
     /* valid FromTime */
-    if (datetime_compare_time(&DateTime.time, &pBacDest->FromTime) < 0) {
+    if (datetime_compare_time(btime, &pBacDest->FromTime) < 0) {
         return false;
     }
-
     /* valid ToTime */
-    if (datetime_compare_time(&pBacDest->ToTime, &DateTime.time) < 0) {
+    if (datetime_compare_time(&pBacDest->ToTime, btime) < 0) {
         return false;
     }
 
     return true;
 }
 
+/**
+ * @brief Resolve the addresses and time windows of all the recipients
+ *  for the current minute
+ * @param now - current local date and time
+ */
+static void Notification_Class_Recipient_Refresh(const BACNET_DATE_TIME *now)
+{
+    NC_RECIPIENT_CACHE *cache;
+    BACNET_DESTINATION *pBacDest;
+    BACNET_TIME minute_start, minute_end;
+    unsigned i, j;
+
+    datetime_set_time(&minute_start, now->time.hour, now->time.min, 0, 0);
+    datetime_set_time(&minute_end, now->time.hour, now->time.min, 59, 99);
+    for (i = 0; i < MAX_NOTIFICATION_CLASSES; i++) {
+        for (j = 0; j < NC_MAX_RECIPIENTS; j++) {
+            pBacDest = &NC_Info[i].Recipient_List[j];
+            cache = &NC_Recipient_Cache[i][j];
+            cache->window = NC_WINDOW_OUT;
+            cache->bound = false;
+            if (bacnet_recipient_device_wildcard(&pBacDest->Recipient)) {
+                /* unused slots denoted by wildcard */
+                continue;
+            }
+            /* valid Days */
+            if (!bitstring_bit(&pBacDest->ValidDays, (now->date.wday - 1))) {
+                /* not today */
+            } else if (
+                Notification_Class_Time_Window(pBacDest, &minute_start) &&
+                Notification_Class_Time_Window(pBacDest, &minute_end)) {
+                cache->window = NC_WINDOW_IN;
+            } else if (
+                (datetime_compare_time(&minute_end, &pBacDest->FromTime) <
+                 0) ||
+                (datetime_compare_time(&pBacDest->ToTime, &minute_start) <
+                 0)) {
+                /* not this minute */
+            } else {
+                /* the window opens or closes within this minute */
+                cache->window = NC_WINDOW_CHECK;
+            }
+            if (pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_DEVICE) {
+                cache->bound = address_get_by_device(
+                    pBacDest->Recipient.type.device.instance,
+                    &cache->max_apdu, &cache->dest);
+            } else if (
+                pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_ADDRESS) {
+                cache->dest = pBacDest->Recipient.type.address;
+                cache->max_apdu = MAX_APDU;
+                cache->bound = true;
+            }
+        }
+    }
+    NC_Recipient_Cache_Time = *now;
+    NC_Recipient_Cache_Valid = true;
+}
+
+/**
+ * @brief Refresh the recipient cache when it is not valid or when the
+ *  minute has changed
+ * @param now - filled with the current local date and time
+ */
+static void Notification_Class_Recipient_Update(BACNET_DATE_TIME *now)
+{
+    datetime_local(&now->date, &now->time, NULL, NULL);
+    if (!NC_Recipient_Cache_Valid ||
+        (datetime_compare_date(&now->date, &NC_Recipient_Cache_Time.date) !=
+         0) ||
+        (now->time.hour != NC_Recipient_Cache_Time.time.hour) ||
+        (now->time.min != NC_Recipient_Cache_Time.time.min)) {
+        Notification_Class_Recipient_Refresh(now);
+    }
+}
+
 void Notification_Class_common_reporting_function(
     BACNET_EVENT_NOTIFICATION_DATA *event_data)
 {
@@ -616,7 +709,11 @@ void Notification_Class_common_reporting_function(
 
     NOTIFICATION_CLASS_INFO *CurrentNotify;
     BACNET_DESTINATION *pBacDest;
+    NC_RECIPIENT_CACHE *cache;
+    BACNET_DATE_TIME now;
     uint32_t notify_index;
+    size_t body_len = 0;
+    unsigned max_apdu;
     uint8_t index;
 
     notify_index =
@@ -671,54 +768,69 @@ void Notification_Class_common_reporting_function(
     debug_printf_stderr(
         "Notification Class[%u]: send notifications\n",
         event_data->notificationClass);
+    Notification_Class_Recipient_Update(&now);
     /* pointer to first recipient */
     pBacDest = &CurrentNotify->Recipient_List[0];
-    for (index = 0; index < NC_MAX_RECIPIENTS; index++, pBacDest++) {
-        if (bacnet_recipient_device_wildcard(&pBacDest->Recipient)) {
-            /* unused slots denoted by wildcard */
+    cache = &NC_Recipient_Cache[notify_index][0];
+    for (index = 0; index < NC_MAX_RECIPIENTS;
+         index++, pBacDest++, cache++) {
+        if (cache->window == NC_WINDOW_OUT) {
+            /* unused slot, or outside of its valid days and times */
             continue;
         }
-        if (IsRecipientActive(pBacDest, event_data->toState)) {
-            BACNET_ADDRESS dest;
-            uint32_t device_id;
-            unsigned max_apdu;
-
-            /* Process Identifier */
-            event_data->processIdentifier = pBacDest->ProcessIdentifier;
-
-            /* send notification */
-            if (pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_DEVICE) {
-                /* send notification to the specified device */
-                device_id = pBacDest->Recipient.type.device.instance;
-                debug_printf_stderr(
-                    "Notification Class[%u]: send notification to %u\n",
-                    event_data->notificationClass, (unsigned)device_id);
-                if (pBacDest->ConfirmedNotify == true) {
-                    Send_CEvent_Notify(device_id, event_data);
-                } else if (address_get_by_device(device_id, &max_apdu, &dest)) {
-                    Send_UEvent_Notify(Event_Buffer, event_data, &dest);
-                }
-            } else if (
-                pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_ADDRESS) {
-                debug_printf_stderr(
-                    "Notification Class[%u]: send notification to ADDR\n",
-                    event_data->notificationClass);
-                /* send notification to the address indicated */
-                if (pBacDest->ConfirmedNotify == true) {
-                    if (address_get_device_id(&dest, &device_id)) {
-                        Send_CEvent_Notify(device_id, event_data);
-                    }
-                } else {
-                    dest = pBacDest->Recipient.type.address;
-                    Send_UEvent_Notify(Event_Buffer, event_data, &dest);
-                }
+        if ((cache->window == NC_WINDOW_CHECK) &&
+            !Notification_Class_Time_Window(pBacDest, &now.time)) {
+            continue;
+        }
+        if (!Notification_Class_Transition_Enabled(
+                pBacDest, event_data->toState)) {
+            continue;
+        }
+        if (!cache->bound &&
+            (pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_DEVICE)) {
+            /* the device may have been bound since the refresh */
+            cache->bound = address_get_by_device(
+                pBacDest->Recipient.type.device.instance, &cache->max_apdu,
+                &cache->dest);
+        }
+        if (!cache->bound) {
+            continue;
+        }
+        /* Process Identifier */
+        event_data->processIdentifier = pBacDest->ProcessIdentifier;
+        if (body_len == 0) {
+            /* the body is the same for every recipient */
+            body_len = event_notification_body_encode(
+                Event_Body, sizeof(Event_Body), event_data);
+            if (body_len == 0) {
+                break;
+            }
+        }
+        /* send notification */
+        debug_printf_stderr(
+            "Notification Class[%u]: send notification to recipient %u\n",
+            event_data->notificationClass, (unsigned)index);
+        if (pBacDest->ConfirmedNotify == true) {
+            max_apdu = cache->max_apdu;
+            if (max_apdu > sizeof(Handler_Transmit_Buffer)) {
+                max_apdu = sizeof(Handler_Transmit_Buffer);
             }
+            Send_CEvent_Notify_Body(
+                Handler_Transmit_Buffer, (uint16_t)max_apdu,
+                pBacDest->ProcessIdentifier, Event_Body, body_len,
+                &cache->dest);
+        } else {
+            Send_UEvent_Notify_Body(
+                Event_Buffer, sizeof(Event_Buffer),
+                pBacDest->ProcessIdentifier, Event_Body, body_len,
+                &cache->dest);
         }
     }
 }
 
 /* This function tries to find the addresses of the defined devices. */
 /* It should be called periodically (example once per minute). */
+/* The recipients are resolved again on the next notification. */
 void Notification_Class_find_recipient(void)
 {
     NOTIFICATION_CLASS_INFO *notification;
@@ -744,6 +856,7 @@ void Notification_Class_find_recipient(void)
             }
         }
     }
+    NC_Recipient_Cache_Valid = false;
 }
 
 /**
@@ -924,6 +1037,7 @@ int Notification_Class_Add_List_Element(BACNET_LIST_ELEMENT_DATA *list_element)
             }
         }
     }
+    NC_Recipient_Cache_Valid = false;
 
     return BACNET_STATUS_OK;
 }
@@ -1058,6 +1172,7 @@ int Notification_Class_Remove_List_Element(
             }
         }
     }
+    NC_Recipient_Cache_Valid = false;
 
     return BACNET_STATUS_OK;
 }
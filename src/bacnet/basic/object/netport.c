@@ -317,7 +317,18 @@ static const int32_t BSC_Port_Properties_Optional[] = {
     -1
 };
 
-static const int32_t Network_Port_Properties_Proprietary[] = { -1 };
+static const int32_t Network_Port_Properties_Proprietary[] = {
+#if defined(BACNET_DATALINK_STATISTICS)
+    PROP_NETWORK_PORT_PACKETS_IN,
+    PROP_NETWORK_PORT_PACKETS_OUT,
+    PROP_NETWORK_PORT_BYTES_IN,
+    PROP_NETWORK_PORT_BYTES_OUT,
+    PROP_NETWORK_PORT_DROPS,
+    PROP_NETWORK_PORT_DECODE_ERRORS,
+    PROP_NETWORK_PORT_QUEUE_DEPTH,
+#endif
+    -1
+};
 
 /**
  * Returns the list of required, optional, and proprietary properties.
@@ -736,6 +747,32 @@ uint8_t Network_Port_Type(uint32_t object_instance)
     return port_type;
 }
 
+/**
+ * @brief Get the traffic counters of the datalink of a Network Port
+ * @param object_instance [in] BACnet network port object instance number
+ * @param counters [out] the traffic counters
+ * @return true if the counters were copied
+ */
+bool Network_Port_Statistics(
+    uint32_t object_instance, DLSTATS_COUNTERS *counters)
+{
+    bool status = false;
+#if defined(BACNET_DATALINK_STATISTICS)
+    unsigned index = 0;
+
+    index = Network_Port_Instance_To_Index(object_instance);
+    if (index < BACNET_NETWORK_PORTS_MAX) {
+        status = dlstats_counters(
+            (BACNET_PORT_TYPE)Object_List[index].Network_Type, counters);
+    }
+#else
+    (void)object_instance;
+    (void)counters;
+#endif
+
+    return status;
+}
+
 /**
  * For a given object instance-number, sets the BACnet port type
  *
@@ -3973,6 +4010,51 @@ static int Network_Port_Virtual_MAC_Table_Encode(
     return apdu_len;
 }
 
+#if defined(BACNET_DATALINK_STATISTICS)
+/**
+ * @brief Encode one of the datalink traffic counters of a Network Port
+ * @param object_instance [in] BACnet network port object instance number
+ * @param object_property [in] one of the PROP_NETWORK_PORT_ counters
+ * @param apdu [out] buffer for the encoded counter
+ * @return number of bytes encoded, or 0 if the property is not a counter
+ */
+static int Network_Port_Statistics_Encode(
+    uint32_t object_instance, int object_property, uint8_t *apdu)
+{
+    DLSTATS_COUNTERS counters = { 0 };
+    uint32_t value = 0;
+
+    (void)Network_Port_Statistics(object_instance, &counters);
+    switch (object_property) {
+        case PROP_NETWORK_PORT_PACKETS_IN:
+            value = counters.packets_in;
+            break;
+        case PROP_NETWORK_PORT_PACKETS_OUT:
+            value = counters.packets_out;
+            break;
+        case PROP_NETWORK_PORT_BYTES_IN:
+            value = counters.bytes_in;
+            break;
+        case PROP_NETWORK_PORT_BYTES_OUT:
+            value = counters.bytes_out;
+            break;
+        case PROP_NETWORK_PORT_DROPS:
+            value = counters.drops;
+            break;
+        case PROP_NETWORK_PORT_DECODE_ERRORS:
+            value = counters.decode_errors;
+            break;
+        case PROP_NETWORK_PORT_QUEUE_DEPTH:
+            value = counters.queue_depth;
+            break;
+        default:
+            return 0;
+    }
+
+    return encode_application_unsigned(apdu, value);
+}
+#endif
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -4432,6 +4514,14 @@ int Network_Port_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
 #endif /* BACDL_BSC */
         default:
+#if defined(BACNET_DATALINK_STATISTICS)
+            /* the proprietary traffic counters */
+            apdu_len = Network_Port_Statistics_Encode(
+                rpdata->object_instance, rpdata->object_property, apdu);
+            if (apdu_len > 0) {
+                break;
+            }
+#endif
             rpdata->error_class = ERROR_CLASS_PROPERTY;
             rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
             apdu_len = BACNET_STATUS_ERROR;
@@ -17,6 +17,21 @@
 #include "bacnet/readrange.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/datalink/dlstats.h"
+
+#if defined(BACNET_DATALINK_STATISTICS)
+/* proprietary properties with the traffic counters of the datalink */
+#ifndef PROP_NETWORK_PORT_STATISTICS_BASE
+#define PROP_NETWORK_PORT_STATISTICS_BASE (PROP_PROPRIETARY_RANGE_MIN)
+#endif
+#define PROP_NETWORK_PORT_PACKETS_IN (PROP_NETWORK_PORT_STATISTICS_BASE + 0)
+#define PROP_NETWORK_PORT_PACKETS_OUT (PROP_NETWORK_PORT_STATISTICS_BASE + 1)
+#define PROP_NETWORK_PORT_BYTES_IN (PROP_NETWORK_PORT_STATISTICS_BASE + 2)
+#define PROP_NETWORK_PORT_BYTES_OUT (PROP_NETWORK_PORT_STATISTICS_BASE + 3)
+#define PROP_NETWORK_PORT_DROPS (PROP_NETWORK_PORT_STATISTICS_BASE + 4)
+#define PROP_NETWORK_PORT_DECODE_ERRORS (PROP_NETWORK_PORT_STATISTICS_BASE + 5)
+#define PROP_NETWORK_PORT_QUEUE_DEPTH (PROP_NETWORK_PORT_STATISTICS_BASE + 6)
+#endif
 
 /**
  * @brief API for a network port object when changes need to be activated
@@ -75,6 +90,9 @@ bool Network_Port_Out_Of_Service_Set(uint32_t instance, bool oos_flag);
 BACNET_STACK_EXPORT
 uint8_t Network_Port_Type(uint32_t object_instance);
 BACNET_STACK_EXPORT
+bool Network_Port_Statistics(
+    uint32_t object_instance, DLSTATS_COUNTERS *counters);
+BACNET_STACK_EXPORT
 bool Network_Port_Type_Set(uint32_t object_instance, uint8_t value);
 
 BACNET_STACK_EXPORT
@@ -29,6 +29,17 @@ extern "C" {
    - SC_FailedConnectionRequests
 */
 
+/* An encoded status list, which is valid while the Version and Count of
+   the list are the ones it was encoded from. The datalink rebuilds the
+   lists often, and only a changed entry moves the Version on. */
+typedef struct BACnetSCStatusCache_T {
+    bool Valid;
+    uint32_t Version;
+    uint8_t Count;
+    int Length;
+    uint8_t Buffer[MAX_APDU];
+} BACNET_SC_STATUS_CACHE;
+
 typedef struct BACnetSCAttributes_T {
     BACNET_UNSIGNED_INTEGER Max_BVLC_Length_Accepted;
     BACNET_UNSIGNED_INTEGER Max_BVLC_Length_Accepted_dirty;
@@ -71,6 +82,8 @@ typedef struct BACnetSCAttributes_T {
     SC_Hub_Function_Connection_Status
         [BSC_CONF_HUB_FUNCTION_CONNECTION_STATUS_MAX_NUM];
     uint8_t SC_Hub_Function_Connection_Status_Count;
+    uint32_t SC_Hub_Function_Connection_Status_Version;
+    BACNET_SC_STATUS_CACHE SC_Hub_Function_Connection_Status_Cache;
     uint16_t Hub_Server_Port;
 #endif /* BSC_CONF_HUB_FUNCTIONS_NUM!=0 */
 #if BSC_CONF_HUB_CONNECTORS_NUM != 0
@@ -87,11 +100,15 @@ typedef struct BACnetSCAttributes_T {
     BACNET_SC_DIRECT_CONNECTION_STATUS SC_Direct_Connect_Connection_Status
         [BSC_CONF_NODE_SWITCH_CONNECTION_STATUS_MAX_NUM];
     uint8_t SC_Direct_Connect_Connection_Status_Count;
+    uint32_t SC_Direct_Connect_Connection_Status_Version;
+    BACNET_SC_STATUS_CACHE SC_Direct_Connect_Connection_Status_Cache;
     uint16_t Direct_Server_Port;
 #endif /* BSC_CONF_HUB_CONNECTORS_NUM!=0 */
     BACNET_SC_FAILED_CONNECTION_REQUEST SC_Failed_Connection_Requests
         [BSC_CONF_FAILED_CONNECTION_STATUS_MAX_NUM];
     uint8_t SC_Failed_Connection_Requests_Count;
+    uint32_t SC_Failed_Connection_Requests_Version;
+    BACNET_SC_STATUS_CACHE SC_Failed_Connection_Requests_Cache;
     uint32_t Certificate_Key_File;
     BACNET_UUID Local_UUID;
 } BACNET_SC_PARAMS;
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/basic/object/objects.h"
 
 /* list of devices */
@@ -63,7 +64,7 @@ OBJECT_DEVICE_T *objects_device_new(uint32_t device_instance)
         if (pDevice) {
             memset(pDevice, 0, sizeof(OBJECT_DEVICE_T));
         } else {
-            pDevice = calloc(1, sizeof(OBJECT_DEVICE_T));
+            pDevice = BACNET_MEMPOOL_CALLOC(sizeof(OBJECT_DEVICE_T));
             if (pDevice) {
                 pDevice->Object_Identifier.type = OBJECT_DEVICE;
                 pDevice->Object_Identifier.instance = device_instance;
@@ -71,7 +72,7 @@ OBJECT_DEVICE_T *objects_device_new(uint32_t device_instance)
                 index = Keylist_Data_Add(Device_List, key, pDevice);
                 if (index < 0) {
                     /* unable to add */
-                    free(pDevice);
+                    BACNET_MEMPOOL_FREE(pDevice, sizeof(*pDevice));
                     pDevice = NULL;
                 } else {
                     /* successfully added */
@@ -105,7 +106,7 @@ bool objects_device_delete(int index)
                 } while (pObject);
                 Keylist_Delete(pDevice->Object_List);
             }
-            free(pDevice);
+            BACNET_MEMPOOL_FREE(pDevice, sizeof(*pDevice));
             result = true;
         }
     }
@@ -26,6 +26,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "bacnet/basic/object/program.h"
 
@@ -1347,7 +1348,7 @@ uint32_t Program_Create(uint32_t object_instance)
         /* already exists - signal success but don't change data */
         return object_instance;
     }
-    pObject = calloc(1, sizeof(struct object_data));
+    pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
     if (!pObject) {
         /* no RAM available - signal failure */
         return BACNET_MAX_INSTANCE;
@@ -1355,7 +1356,7 @@ uint32_t Program_Create(uint32_t object_instance)
     index = Keylist_Data_Add(Object_List, object_instance, pObject);
     if (index < 0) {
         /* unable to add to list - signal failure */
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         return BACNET_MAX_INSTANCE;
     }
     pObject->Program_State = PROGRAM_STATE_IDLE;
@@ -1390,7 +1391,7 @@ bool Program_Delete(uint32_t object_instance)
         Keylist_Data_Delete(Object_List, object_instance);
 
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -1408,7 +1409,7 @@ void Program_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
 
@@ -1417,6 +1418,32 @@ void Program_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Program objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Program_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Program objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Program_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object data
  */
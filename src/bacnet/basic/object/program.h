@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/wp.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -111,6 +112,10 @@ BACNET_STACK_EXPORT
 void Program_Cleanup(void);
 BACNET_STACK_EXPORT
 void Program_Init(void);
+BACNET_STACK_EXPORT
+void Program_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Program_List_Revision(void);
 
 /* API for the program requests
     note: return value is 0 for success, non-zero for failure
@@ -28,6 +28,7 @@
 #include <bacnet/basic/object/sc_netport.h>
 #include <bacnet/basic/object/netport_internal.h>
 #include <bacnet/datalink/bsc/bsc-util.h>
+#include <bacnet/basic/sys/mempool.h>
 
 #define SC_MIN_RECONNECT_MIN 2
 #define SC_MIN_RECONNECT_MAX 300
@@ -43,6 +44,82 @@ string_splite(const char *str, char separator, int *indexes, int length);
 static bool
 string_subsstr(char *str, int length, int index, const char *substr);
 
+/**
+ * @brief Store an entry of a status list, and move the version of the list
+ *  on when the entry differs from the one stored before
+ * @param entry [out] the entry of the status list
+ * @param value [in] the new entry, cleared before it was filled in
+ * @param size [in] size of the entry
+ * @param version [in,out] version of the status list
+ */
+static void sc_status_entry_store(
+    void *entry, const void *value, size_t size, uint32_t *version)
+{
+    if (memcmp(entry, value, size) != 0) {
+        memcpy(entry, value, size);
+        *version += 1;
+    }
+}
+
+/**
+ * @brief Copy an encoded status list from its cache
+ * @param cache [in] the cache of the status list
+ * @param version [in] version of the status list
+ * @param count [in] number of entries in the status list
+ * @param apdu [out] Buffer in which the APDU contents are built.
+ * @param max_apdu [in] Max length of the APDU buffer.
+ * @param apdu_len [out] How many bytes were encoded in the buffer, or
+ *   BACNET_STATUS_ABORT if the response would not fit within the buffer.
+ * @return true if the cache was current
+ */
+static bool sc_status_cache_read(
+    const BACNET_SC_STATUS_CACHE *cache,
+    uint32_t version,
+    uint8_t count,
+    uint8_t *apdu,
+    int max_apdu,
+    int *apdu_len)
+{
+    if (!cache->Valid || (cache->Version != version) ||
+        (cache->Count != count)) {
+        return false;
+    }
+    if (cache->Length > max_apdu) {
+        *apdu_len = BACNET_STATUS_ABORT;
+    } else {
+        memcpy(apdu, cache->Buffer, cache->Length);
+        *apdu_len = cache->Length;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Keep an encoded status list in its cache
+ * @param cache [out] the cache of the status list
+ * @param version [in] version of the status list
+ * @param count [in] number of entries in the status list
+ * @param apdu [in] the encoded status list
+ * @param apdu_len [in] length of the encoded status list
+ */
+static void sc_status_cache_write(
+    BACNET_SC_STATUS_CACHE *cache,
+    uint32_t version,
+    uint8_t count,
+    const uint8_t *apdu,
+    int apdu_len)
+{
+    if ((apdu_len < 0) || (apdu_len > (int)sizeof(cache->Buffer))) {
+        cache->Valid = false;
+        return;
+    }
+    memcpy(cache->Buffer, apdu, apdu_len);
+    cache->Length = apdu_len;
+    cache->Version = version;
+    cache->Count = count;
+    cache->Valid = true;
+}
+
 static void sc_binding_parse(char *str, uint16_t *port, char **ifname)
 {
     char *p = NULL;
@@ -744,7 +821,7 @@ bool Network_Port_Routing_Table_Add(
         return false;
     }
     network_type = Network_Port_Type(object_instance);
-    entry = calloc(1, sizeof(BACNET_ROUTER_ENTRY));
+    entry = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_ROUTER_ENTRY));
     if (!entry) {
         return false;
     }
@@ -754,7 +831,7 @@ bool Network_Port_Routing_Table_Add(
     entry->Performance_Index = performance_index;
     index = Keylist_Data_Add(params->Routing_Table, network_number, entry);
     if (index < 0) {
-        free(entry);
+        BACNET_MEMPOOL_FREE(entry, sizeof(BACNET_ROUTER_ENTRY));
         return false;
     }
 
@@ -771,7 +848,7 @@ bool Network_Port_Routing_Table_Delete(
     }
 
     entry = Keylist_Data_Delete(params->Routing_Table, network_number);
-    free(entry);
+    BACNET_MEMPOOL_FREE(entry, sizeof(BACNET_ROUTER_ENTRY));
 
     return true;
 }
@@ -783,6 +860,11 @@ bool Network_Port_Routing_Table_Delete_All(uint32_t object_instance)
         return false;
     }
 
+    while (Keylist_Count(params->Routing_Table) > 0) {
+        BACNET_MEMPOOL_FREE(
+            Keylist_Data_Pop(params->Routing_Table),
+            sizeof(BACNET_ROUTER_ENTRY));
+    }
     Keylist_Delete(params->Routing_Table);
     params->Routing_Table = Keylist_Create();
 
@@ -1193,7 +1275,8 @@ bool Network_Port_SC_Hub_Function_Connection_Status_Add(
     BACNET_ERROR_CODE error,
     const char *error_details)
 {
-    BACNET_SC_HUB_FUNCTION_CONNECTION_STATUS *st;
+    BACNET_SC_HUB_FUNCTION_CONNECTION_STATUS entry;
+    BACNET_SC_HUB_FUNCTION_CONNECTION_STATUS *st = &entry;
     BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
     if (!params) {
         return false;
@@ -1204,10 +1287,7 @@ bool Network_Port_SC_Hub_Function_Connection_Status_Add(
         return false;
     }
 
-    st = &params->SC_Hub_Function_Connection_Status
-              [params->SC_Hub_Function_Connection_Status_Count];
-    params->SC_Hub_Function_Connection_Status_Count += 1;
-
+    memset(&entry, 0, sizeof(entry));
     st->State = state;
     st->Connect_Timestamp = *connect_ts;
     st->Disconnect_Timestamp = *disconnect_ts;
@@ -1223,6 +1303,12 @@ bool Network_Port_SC_Hub_Function_Connection_Status_Add(
     } else {
         st->Error_Details[0] = 0;
     }
+    sc_status_entry_store(
+        &params->SC_Hub_Function_Connection_Status
+             [params->SC_Hub_Function_Connection_Status_Count],
+        &entry, sizeof(entry),
+        &params->SC_Hub_Function_Connection_Status_Version);
+    params->SC_Hub_Function_Connection_Status_Count += 1;
 
     return true;
 }
@@ -1267,6 +1353,16 @@ int Network_Port_SC_Hub_Function_Connection_Status_Encode(
     int apdu_len = 0;
     unsigned index = 0;
     unsigned size = 0;
+    BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
+
+    if (params &&
+        sc_status_cache_read(
+            &params->SC_Hub_Function_Connection_Status_Cache,
+            params->SC_Hub_Function_Connection_Status_Version,
+            params->SC_Hub_Function_Connection_Status_Count, apdu, max_apdu,
+            &apdu_len)) {
+        return apdu_len;
+    }
 
     size =
         Network_Port_SC_Hub_Function_Connection_Status_Count(object_instance);
@@ -1285,6 +1381,12 @@ int Network_Port_SC_Hub_Function_Connection_Status_Encode(
         apdu_len +=
             bacapp_encode_SCHubFunctionConnection(&apdu[apdu_len], entry);
     }
+    if (params) {
+        sc_status_cache_write(
+            &params->SC_Hub_Function_Connection_Status_Cache,
+            params->SC_Hub_Function_Connection_Status_Version,
+            params->SC_Hub_Function_Connection_Status_Count, apdu, apdu_len);
+    }
 
     return apdu_len;
 }
@@ -1677,7 +1779,8 @@ bool Network_Port_SC_Direct_Connect_Connection_Status_Add(
     BACNET_ERROR_CODE error,
     const char *error_details)
 {
-    BACNET_SC_DIRECT_CONNECTION_STATUS *st;
+    BACNET_SC_DIRECT_CONNECTION_STATUS entry;
+    BACNET_SC_DIRECT_CONNECTION_STATUS *st = &entry;
     BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
     if (!params) {
         return false;
@@ -1688,9 +1791,7 @@ bool Network_Port_SC_Direct_Connect_Connection_Status_Add(
         return false;
     }
 
-    st = &params->SC_Direct_Connect_Connection_Status
-              [params->SC_Direct_Connect_Connection_Status_Count];
-    params->SC_Direct_Connect_Connection_Status_Count += 1;
+    memset(&entry, 0, sizeof(entry));
 
     if (uri) {
         bsc_copy_str(st->URI, uri, sizeof(st->URI));
@@ -1713,6 +1814,12 @@ bool Network_Port_SC_Direct_Connect_Connection_Status_Add(
     } else {
         st->Error_Details[0] = 0;
     }
+    sc_status_entry_store(
+        &params->SC_Direct_Connect_Connection_Status
+             [params->SC_Direct_Connect_Connection_Status_Count],
+        &entry, sizeof(entry),
+        &params->SC_Direct_Connect_Connection_Status_Version);
+    params->SC_Direct_Connect_Connection_Status_Count += 1;
 
     return true;
 }
@@ -1757,6 +1864,16 @@ int Network_Port_SC_Direct_Connect_Connection_Status_Encode(
     int apdu_len = 0;
     unsigned index = 0;
     unsigned size = 0;
+    BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
+
+    if (params &&
+        sc_status_cache_read(
+            &params->SC_Direct_Connect_Connection_Status_Cache,
+            params->SC_Direct_Connect_Connection_Status_Version,
+            params->SC_Direct_Connect_Connection_Status_Count, apdu, max_apdu,
+            &apdu_len)) {
+        return apdu_len;
+    }
 
     size =
         Network_Port_SC_Direct_Connect_Connection_Status_Count(object_instance);
@@ -1774,6 +1891,12 @@ int Network_Port_SC_Direct_Connect_Connection_Status_Encode(
             object_instance, index);
         apdu_len += bacapp_encode_SCDirectConnection(&apdu[apdu_len], entry);
     }
+    if (params) {
+        sc_status_cache_write(
+            &params->SC_Direct_Connect_Connection_Status_Cache,
+            params->SC_Direct_Connect_Connection_Status_Version,
+            params->SC_Direct_Connect_Connection_Status_Count, apdu, apdu_len);
+    }
 
     return apdu_len;
 }
@@ -1804,7 +1927,8 @@ bool Network_Port_SC_Failed_Connection_Requests_Add(
     BACNET_ERROR_CODE error,
     const char *error_details)
 {
-    BACNET_SC_FAILED_CONNECTION_REQUEST *entry;
+    BACNET_SC_FAILED_CONNECTION_REQUEST request;
+    BACNET_SC_FAILED_CONNECTION_REQUEST *entry = &request;
     BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
     if (!params) {
         return false;
@@ -1815,9 +1939,7 @@ bool Network_Port_SC_Failed_Connection_Requests_Add(
         return false;
     }
 
-    entry = &params->SC_Failed_Connection_Requests
-                 [params->SC_Failed_Connection_Requests_Count];
-    params->SC_Failed_Connection_Requests_Count += 1;
+    memset(&request, 0, sizeof(request));
 
     entry->Timestamp = *ts;
     memcpy(&entry->Peer_Address, peer_address, sizeof(entry->Peer_Address));
@@ -1832,6 +1954,12 @@ bool Network_Port_SC_Failed_Connection_Requests_Add(
     } else {
         entry->Error_Details[0] = 0;
     }
+    sc_status_entry_store(
+        &params->SC_Failed_Connection_Requests
+             [params->SC_Failed_Connection_Requests_Count],
+        &request, sizeof(request),
+        &params->SC_Failed_Connection_Requests_Version);
+    params->SC_Failed_Connection_Requests_Count += 1;
 
     return true;
 }
@@ -1874,6 +2002,16 @@ int Network_Port_SC_Failed_Connection_Requests_Encode(
     int apdu_len = 0;
     unsigned index = 0;
     unsigned size = 0;
+    BACNET_SC_PARAMS *params = Network_Port_SC_Params(object_instance);
+
+    if (params &&
+        sc_status_cache_read(
+            &params->SC_Failed_Connection_Requests_Cache,
+            params->SC_Failed_Connection_Requests_Version,
+            params->SC_Failed_Connection_Requests_Count, apdu, max_apdu,
+            &apdu_len)) {
+        return apdu_len;
+    }
 
     size = Network_Port_SC_Failed_Connection_Requests_Count(object_instance);
     for (index = 0; index < size; index++) {
@@ -1891,6 +2029,12 @@ int Network_Port_SC_Failed_Connection_Requests_Encode(
         apdu_len +=
             bacapp_encode_SCFailedConnectionRequest(&apdu[apdu_len], entry);
     }
+    if (params) {
+        sc_status_cache_write(
+            &params->SC_Failed_Connection_Requests_Cache,
+            params->SC_Failed_Connection_Requests_Version,
+            params->SC_Failed_Connection_Requests_Count, apdu, apdu_len);
+    }
 
     return apdu_len;
 }
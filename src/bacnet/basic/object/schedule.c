@@ -86,6 +86,55 @@ SCHEDULE_DESCR *Schedule_Object(uint32_t object_instance)
     return pObject;
 }
 
+/**
+ * @brief Forget the next transition of the Present_Value, so that the
+ *  next Schedule_Recalculate_PV() evaluates the schedule again
+ * @param pObject - object in which the schedule changed
+ */
+static void Schedule_Transition_Invalidate(SCHEDULE_DESCR *pObject)
+{
+    if (pObject) {
+        pObject->Transition_Valid = false;
+    }
+}
+
+/**
+ * @brief Forget the next transition of any Schedule that refers to the
+ *  Calendar in its Exception_Schedule, when the Calendar present-value
+ *  changes
+ * @param calendar_instance - object-instance number of the Calendar
+ * @param old_value - Calendar present-value prior to the change
+ * @param value - Calendar present-value after the change
+ */
+void Schedule_Calendar_Present_Value_Change(
+    uint32_t calendar_instance, bool old_value, bool value)
+{
+#if BACNET_EXCEPTION_SCHEDULE_SIZE
+    const BACNET_SPECIAL_EVENT *event;
+    unsigned i, e;
+
+    (void)old_value;
+    (void)value;
+    for (i = 0; i < MAX_SCHEDULES; i++) {
+        for (e = 0; e < BACNET_EXCEPTION_SCHEDULE_SIZE; e++) {
+            event = &Schedule_Descr[i].Exception_Schedule[e];
+            if ((event->periodTag ==
+                 BACNET_SPECIAL_EVENT_PERIOD_CALENDAR_REFERENCE) &&
+                (event->period.calendarReference.type == OBJECT_CALENDAR) &&
+                (event->period.calendarReference.instance ==
+                 calendar_instance)) {
+                Schedule_Transition_Invalidate(&Schedule_Descr[i]);
+                break;
+            }
+        }
+    }
+#else
+    (void)calendar_instance;
+    (void)old_value;
+    (void)value;
+#endif
+}
+
 /**
  * @brief Initialize the Schedule object data
  */
@@ -122,6 +171,7 @@ void Schedule_Init(void)
         psched->obj_prop_ref_cnt = 0; /* no references, add as needed */
         psched->Priority_For_Writing = 16; /* lowest priority */
         psched->Out_Of_Service = false;
+        Schedule_Transition_Invalidate(psched);
 #if BACNET_EXCEPTION_SCHEDULE_SIZE
         for (e = 0; e < BACNET_EXCEPTION_SCHEDULE_SIZE; e++) {
             event = &psched->Exception_Schedule[e];
@@ -232,6 +282,8 @@ void Schedule_Out_Of_Service_Set(uint32_t object_instance, bool value)
 
 /**
  * @brief Get the Weekly Schedule for a given object instance
+ * @note The schedule may be changed through the pointer, so the next
+ *  transition of the Present_Value is evaluated again.
  * @param object_instance - object-instance number of the object
  * @param array_index - index of the Weekly Schedule to get 0 to 6
  * @return pointer to the Weekly Schedule, or NULL if not found
@@ -243,6 +295,7 @@ Schedule_Weekly_Schedule(uint32_t object_instance, unsigned array_index)
 
     pObject = Schedule_Object(object_instance);
     if (pObject && (array_index < BACNET_WEEKLY_SCHEDULE_SIZE)) {
+        Schedule_Transition_Invalidate(pObject);
         return &pObject->Weekly_Schedule[array_index];
     }
 
@@ -267,7 +320,8 @@ bool Schedule_Weekly_Schedule_Set(
     if (pObject && (array_index < BACNET_WEEKLY_SCHEDULE_SIZE)) {
         memcpy(
             &pObject->Weekly_Schedule[array_index], value,
-            sizeof(BACNET_WEEKLY_SCHEDULE));
+            sizeof(BACNET_DAILY_SCHEDULE));
+        Schedule_Transition_Invalidate(pObject);
         return true;
     }
 
@@ -307,6 +361,8 @@ static int Schedule_Weekly_Schedule_Encode(
 #if BACNET_EXCEPTION_SCHEDULE_SIZE
 /**
  * @brief Get the Exception Schedule for a given object instance
+ * @note The schedule may be changed through the pointer, so the next
+ *  transition of the Present_Value is evaluated again.
  * @param object_instance - object-instance number of the object
  * @param array_index - index of the Exception Schedule to get 0 to 6
  * @return pointer to the Exception Schedule BACnetSpecialEvent,
@@ -319,6 +375,7 @@ Schedule_Exception_Schedule(uint32_t object_instance, unsigned array_index)
 
     pObject = Schedule_Object(object_instance);
     if (pObject && (array_index < BACNET_EXCEPTION_SCHEDULE_SIZE)) {
+        Schedule_Transition_Invalidate(pObject);
         return &pObject->Exception_Schedule[array_index];
     }
 
@@ -345,6 +402,7 @@ bool Schedule_Exception_Schedule_Set(
         memcpy(
             &pObject->Exception_Schedule[array_index], value,
             sizeof(BACNET_SPECIAL_EVENT));
+        Schedule_Transition_Invalidate(pObject);
         return true;
     }
 
@@ -399,6 +457,7 @@ bool Schedule_Effective_Period_Set(
     if (pObject) {
         datetime_copy_date(&pObject->Start_Date, start_date);
         datetime_copy_date(&pObject->End_Date, end_date);
+        Schedule_Transition_Invalidate(pObject);
         return true;
     }
 
@@ -952,6 +1011,12 @@ bool Schedule_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             }
             break;
     }
+    if (status &&
+        ((wp_data->object_property == PROP_WEEKLY_SCHEDULE) ||
+         (wp_data->object_property == PROP_EXCEPTION_SCHEDULE) ||
+         (wp_data->object_property == PROP_EFFECTIVE_PERIOD))) {
+        Schedule_Transition_Invalidate(&Schedule_Descr[object_index]);
+    }
 
     return status;
 }
@@ -978,7 +1043,86 @@ bool Schedule_In_Effective_Period(
 }
 
 /**
- * @brief Recalculate the Present Value of the Schedule object
+ * @brief Determine if any field of a time is a wildcard
+ * @param btime - time to check
+ * @return true if any field of the time is a wildcard
+ */
+static bool Schedule_Time_Wildcard(const BACNET_TIME *btime)
+{
+    return datetime_wildcard_hour(btime) || datetime_wildcard_minute(btime) ||
+        datetime_wildcard_second(btime) || datetime_wildcard_hundredths(btime);
+}
+
+/**
+ * @brief Set the Present Value from the Weekly_Schedule time value,
+ *  or from the Schedule_Default
+ * @param desc - schedule descriptor
+ * @param daily - Weekly_Schedule of the day
+ * @param index - time value of the day, or -1 for the Schedule_Default
+ */
+static void Schedule_Present_Value_Set(
+    SCHEDULE_DESCR *desc, const BACNET_DAILY_SCHEDULE *daily, int index)
+{
+    if (index >= 0) {
+        bacnet_primitive_to_application_data_value(
+            &desc->Present_Value, &daily->Time_Values[index].Value);
+    } else {
+        memcpy(
+            &desc->Present_Value, &desc->Schedule_Default,
+            sizeof(desc->Present_Value));
+    }
+}
+
+/**
+ * @brief Find the times of the day between which the Present Value does
+ *  not change, which are the nearest time values at or before the time
+ *  and after the time. Time values with wildcards are not ordered, so
+ *  their day is evaluated every time.
+ * @param desc - schedule descriptor, in which the transitions are saved
+ * @param daily - Weekly_Schedule of the day
+ * @param time - time of the day
+ * @return true if the transitions were found
+ */
+static bool Schedule_Transition_Find(
+    SCHEDULE_DESCR *desc,
+    const BACNET_DAILY_SCHEDULE *daily,
+    const BACNET_TIME *time)
+{
+    const BACNET_TIME *entry_time;
+    int i;
+
+    if (Schedule_Time_Wildcard(time)) {
+        return false;
+    }
+    datetime_set_time(&desc->Transition_Time, 0, 0, 0, 0);
+    desc->Next_Transition_Valid = false;
+    for (i = 0; i < daily->TV_Count; i++) {
+        entry_time = &daily->Time_Values[i].Time;
+        if (Schedule_Time_Wildcard(entry_time)) {
+            return false;
+        }
+        if (datetime_compare_time(entry_time, time) <= 0) {
+            if (datetime_compare_time(entry_time, &desc->Transition_Time) >
+                0) {
+                desc->Transition_Time = *entry_time;
+            }
+        } else if (
+            !desc->Next_Transition_Valid ||
+            (datetime_compare_time(entry_time, &desc->Next_Transition_Time) <
+             0)) {
+            desc->Next_Transition_Time = *entry_time;
+            desc->Next_Transition_Valid = true;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Recalculate the Present Value of the Schedule object.
+ *  The time of the next transition is saved, so that the schedule is
+ *  only evaluated again when that time passes, the day changes, or the
+ *  schedule changes.
  * @param desc - schedule descriptor
  * @param wday - day of the week
  * @param time - time of the day
@@ -986,30 +1130,33 @@ bool Schedule_In_Effective_Period(
 void Schedule_Recalculate_PV(
     SCHEDULE_DESCR *desc, BACNET_WEEKDAY wday, const BACNET_TIME *time)
 {
-    int i;
-    desc->Present_Value.tag = BACNET_APPLICATION_TAG_NULL;
-
+    const BACNET_DAILY_SCHEDULE *daily;
+    int i, index = -1;
+
+    daily = &desc->Weekly_Schedule[wday - 1];
+    if (desc->Transition_Valid && (desc->Transition_Weekday == wday) &&
+        !Schedule_Time_Wildcard(time) &&
+        (datetime_compare_time(time, &desc->Transition_Time) >= 0) &&
+        (!desc->Next_Transition_Valid ||
+         (datetime_compare_time(time, &desc->Next_Transition_Time) < 0))) {
+        /* the value may have changed, but not which value is used */
+        Schedule_Present_Value_Set(desc, daily, desc->Transition_Index);
+        return;
+    }
     /* for future development, here should be the loop for Exception Schedule */
 
     /*  Note to developers: please ping Edward at info@connect-ex.com
         for a more complete schedule object implementation. */
-    for (i = 0; i < desc->Weekly_Schedule[wday - 1].TV_Count &&
-         desc->Present_Value.tag == BACNET_APPLICATION_TAG_NULL;
-         i++) {
-        int diff = datetime_wildcard_compare_time(
-            time, &desc->Weekly_Schedule[wday - 1].Time_Values[i].Time);
+    for (i = 0; (i < daily->TV_Count) && (index < 0); i++) {
+        int diff =
+            datetime_wildcard_compare_time(time, &daily->Time_Values[i].Time);
         if (diff >= 0 &&
-            desc->Weekly_Schedule[wday - 1].Time_Values[i].Value.tag !=
-                BACNET_APPLICATION_TAG_NULL) {
-            bacnet_primitive_to_application_data_value(
-                &desc->Present_Value,
-                &desc->Weekly_Schedule[wday - 1].Time_Values[i].Value);
+            daily->Time_Values[i].Value.tag != BACNET_APPLICATION_TAG_NULL) {
+            index = i;
         }
     }
-
-    if (desc->Present_Value.tag == BACNET_APPLICATION_TAG_NULL) {
-        memcpy(
-            &desc->Present_Value, &desc->Schedule_Default,
-            sizeof(desc->Present_Value));
-    }
+    Schedule_Present_Value_Set(desc, daily, index);
+    desc->Transition_Index = (int16_t)index;
+    desc->Transition_Weekday = (uint8_t)wday;
+    desc->Transition_Valid = Schedule_Transition_Find(desc, daily, time);
 }
@@ -58,6 +58,17 @@ typedef struct schedule {
     uint8_t obj_prop_ref_cnt; /* actual number of obj_prop references */
     uint8_t Priority_For_Writing; /* (1..16) */
     bool Out_Of_Service;
+    /* The Present_Value from Schedule_Recalculate_PV() holds on the
+       Transition_Weekday from the Transition_Time until the
+       Next_Transition_Time, or until the end of the day when there is
+       no next transition. The Transition_Index is the Weekly_Schedule
+       time value of the Present_Value, or -1 for the Schedule_Default. */
+    BACNET_TIME Transition_Time;
+    BACNET_TIME Next_Transition_Time;
+    int16_t Transition_Index;
+    uint8_t Transition_Weekday;
+    bool Next_Transition_Valid;
+    bool Transition_Valid;
 } SCHEDULE_DESCR;
 
 BACNET_STACK_EXPORT
@@ -143,6 +154,9 @@ bool Schedule_In_Effective_Period(
 BACNET_STACK_EXPORT
 void Schedule_Recalculate_PV(
     SCHEDULE_DESCR *desc, BACNET_WEEKDAY wday, const BACNET_TIME *time);
+BACNET_STACK_EXPORT
+void Schedule_Calendar_Present_Value_Change(
+    uint32_t calendar_instance, bool old_value, bool value);
 
 #ifdef __cplusplus
 }
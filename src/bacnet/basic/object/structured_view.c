@@ -27,8 +27,10 @@
 #include "bacnet/property.h"
 #include "bacnet/reject.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "structured_view.h"
 
@@ -41,10 +43,18 @@ struct object_data {
     BACNET_SUBORDINATE_DATA *Subordinate_List;
     BACNET_RELATIONSHIP Default_Subordinate_Relationship;
     BACNET_DEVICE_OBJECT_REFERENCE Represents;
+    /* flattened hierarchy below this view, built when first read */
+    BACNET_STRUCTURED_VIEW_NODE *Hierarchy;
+    unsigned Hierarchy_Count;
+    unsigned Hierarchy_Size;
+    uint32_t Hierarchy_Generation;
 };
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* changed when any Subordinate_List changes, which makes every cached
+   hierarchy stale - zero is never used, so new objects start stale */
+static uint32_t Hierarchy_Generation = 1;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Properties_Required[] = {
@@ -65,7 +75,12 @@ static const int32_t Properties_Optional[] = {
     -1
 };
 
-static const int32_t Properties_Proprietary[] = { -1 };
+static const int32_t Properties_Proprietary[] = {
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+    PROP_STRUCTURED_VIEW_HIERARCHY,
+#endif
+    -1
+};
 
 /**
  * Returns the list of required, optional, and proprietary properties.
@@ -391,6 +406,7 @@ void Structured_View_Subordinate_List_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         pObject->Subordinate_List = subordinate_list;
+        Structured_View_Hierarchy_Invalidate();
     }
 }
 
@@ -646,6 +662,341 @@ int Structured_View_Subordinate_Relationships_Element_Encode(
     return apdu_len;
 }
 
+/**
+ * @brief Mark every cached hierarchy as stale.
+ * @details Called when a Subordinate_List is set and when a view is
+ *  created or deleted.  An application that changes the members of a
+ *  Subordinate_List in place calls it too.
+ */
+void Structured_View_Hierarchy_Invalidate(void)
+{
+    Hierarchy_Generation++;
+    if (Hierarchy_Generation == 0) {
+        Hierarchy_Generation = 1;
+    }
+}
+
+/**
+ * @brief Append a node to the cached hierarchy of a view
+ * @param pView - view that owns the hierarchy
+ * @param node - node to append
+ * @return true if the node was appended
+ */
+static bool Structured_View_Hierarchy_Append(
+    struct object_data *pView, const BACNET_STRUCTURED_VIEW_NODE *node)
+{
+    BACNET_STRUCTURED_VIEW_NODE *hierarchy;
+    unsigned size;
+
+    if (pView->Hierarchy_Count >= pView->Hierarchy_Size) {
+        size = pView->Hierarchy_Size ? pView->Hierarchy_Size * 2 : 16;
+        hierarchy = BACNET_MEMPOOL_REALLOC(
+            pView->Hierarchy,
+            pView->Hierarchy_Size * sizeof(BACNET_STRUCTURED_VIEW_NODE),
+            size * sizeof(BACNET_STRUCTURED_VIEW_NODE));
+        if (!hierarchy) {
+            return false;
+        }
+        pView->Hierarchy = hierarchy;
+        pView->Hierarchy_Size = size;
+    }
+    pView->Hierarchy[pView->Hierarchy_Count] = *node;
+    pView->Hierarchy_Count++;
+
+    return true;
+}
+
+/**
+ * @brief Determine if a local view is already on the path from a node
+ *  up to the top of the hierarchy, which would make a loop
+ * @param pView - view that owns the hierarchy
+ * @param parent - position of the node, from 1
+ * @param object_instance - instance of the local view
+ * @return true if the view is the node or one of its parents
+ */
+static bool Structured_View_Hierarchy_Ancestor(
+    const struct object_data *pView, uint32_t parent, uint32_t object_instance)
+{
+    const BACNET_STRUCTURED_VIEW_NODE *node;
+
+    while (parent) {
+        node = &pView->Hierarchy[parent - 1];
+        if ((node->Object_Type == OBJECT_STRUCTURED_VIEW) &&
+            (node->Object_Instance == object_instance)) {
+            return true;
+        }
+        parent = node->Parent;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Append the subordinates of a node, and below each local view
+ *  the subordinates of that view
+ * @param pView - view that owns the hierarchy
+ * @param parent - position of the node, from 1
+ * @param subordinate_list - Subordinate_List of the node
+ * @return true if every node was appended
+ */
+static bool Structured_View_Hierarchy_Build(
+    struct object_data *pView,
+    uint32_t parent,
+    const BACNET_SUBORDINATE_DATA *subordinate_list)
+{
+    BACNET_STRUCTURED_VIEW_NODE node = { 0 };
+    const struct object_data *pChild;
+    uint32_t device_instance = Device_Object_Instance_Number();
+    uint8_t depth = pView->Hierarchy[parent - 1].Depth + 1;
+
+    while (subordinate_list) {
+        node.Device_Instance = subordinate_list->Device_Instance;
+        node.Object_Type = subordinate_list->Object_Type;
+        node.Object_Instance = subordinate_list->Object_Instance;
+        node.Parent = parent;
+        node.Depth = depth;
+        if (!Structured_View_Hierarchy_Append(pView, &node)) {
+            return false;
+        }
+        pChild = NULL;
+        if ((node.Object_Type == OBJECT_STRUCTURED_VIEW) &&
+            (node.Device_Instance == device_instance) &&
+            (depth < BACNET_STRUCTURED_VIEW_HIERARCHY_DEPTH_MAX) &&
+            !Structured_View_Hierarchy_Ancestor(
+                pView, parent, node.Object_Instance)) {
+            pChild = Keylist_Data(Object_List, node.Object_Instance);
+        }
+        if (pChild &&
+            !Structured_View_Hierarchy_Build(
+                pView, pView->Hierarchy_Count, pChild->Subordinate_List)) {
+            return false;
+        }
+        subordinate_list = subordinate_list->next;
+    }
+
+    return true;
+}
+
+/**
+ * @brief For a given object instance-number, returns the hierarchy of
+ *  the local views and their subordinates below the view, flattened in
+ *  depth-first order with the parent and depth of each node.
+ * @details The hierarchy is cached until a Subordinate_List changes.
+ *  A local view that is already on the path to a node is not descended
+ *  into again, so a loop of views ends.
+ * @param object_instance - object-instance number of the object
+ * @param count - filled with the number of nodes
+ * @return the nodes, the first one being the view itself, or NULL if
+ *  the view is not found or out of memory
+ */
+const BACNET_STRUCTURED_VIEW_NODE *
+Structured_View_Hierarchy(uint32_t object_instance, unsigned *count)
+{
+    struct object_data *pObject;
+    BACNET_STRUCTURED_VIEW_NODE node = { 0 };
+
+    if (count) {
+        *count = 0;
+    }
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        return NULL;
+    }
+    if (pObject->Hierarchy_Generation != Hierarchy_Generation) {
+        pObject->Hierarchy_Count = 0;
+        node.Device_Instance = Device_Object_Instance_Number();
+        node.Object_Type = OBJECT_STRUCTURED_VIEW;
+        node.Object_Instance = object_instance;
+        if (!Structured_View_Hierarchy_Append(pObject, &node) ||
+            !Structured_View_Hierarchy_Build(
+                pObject, 1, pObject->Subordinate_List)) {
+            pObject->Hierarchy_Count = 0;
+            return NULL;
+        }
+        pObject->Hierarchy_Generation = Hierarchy_Generation;
+    }
+    if (count) {
+        *count = pObject->Hierarchy_Count;
+    }
+
+    return pObject->Hierarchy;
+}
+
+/**
+ * @brief Encode one node of the hierarchy as a SEQUENCE of the device
+ *  identifier, the object identifier, the position of the parent node,
+ *  and the depth
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL to
+ * return the length of buffer if it had been built
+ * @param node - node to encode
+ * @return The length of the apdu encoded
+ */
+int Structured_View_Hierarchy_Node_Encode(
+    uint8_t *apdu, const BACNET_STRUCTURED_VIEW_NODE *node)
+{
+    int len;
+    int apdu_len = 0;
+
+    len = encode_application_object_id(
+        apdu, OBJECT_DEVICE, node->Device_Instance);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = encode_application_object_id(
+        apdu, node->Object_Type, node->Object_Instance);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = encode_application_unsigned(apdu, node->Parent);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = encode_application_unsigned(apdu, node->Depth);
+    apdu_len += len;
+
+    return apdu_len;
+}
+
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+/**
+ * @brief Encode the whole hierarchy below a view as a BACnetLIST
+ * @param object_instance - object-instance number of the object
+ * @param apdu [out] Buffer in which the APDU contents are built
+ * @param apdu_size - size of the buffer
+ * @return The length of the apdu encoded, or BACNET_STATUS_ABORT if
+ *  the hierarchy does not fit
+ */
+static int Structured_View_Hierarchy_Encode(
+    uint32_t object_instance, uint8_t *apdu, int apdu_size)
+{
+    const BACNET_STRUCTURED_VIEW_NODE *hierarchy;
+    unsigned count = 0, i;
+    int len, apdu_len = 0;
+
+    hierarchy = Structured_View_Hierarchy(object_instance, &count);
+    for (i = 0; i < count; i++) {
+        len = Structured_View_Hierarchy_Node_Encode(NULL, &hierarchy[i]);
+        if ((apdu_len + len) > apdu_size) {
+            return BACNET_STATUS_ABORT;
+        }
+        apdu_len += Structured_View_Hierarchy_Node_Encode(
+            &apdu[apdu_len], &hierarchy[i]);
+    }
+
+    return apdu_len;
+}
+
+/* largest encoding of a node: two object identifiers, a 32-bit unsigned
+   and an 8-bit unsigned */
+#define STRUCTURED_VIEW_NODE_ENCODED_MAX (5 + 5 + 5 + 2)
+
+/**
+ * @brief ReadRange by position of the hierarchy below a view, so that
+ *  a client can fetch the tree in a few requests
+ * @param apdu - place to encode the data
+ * @param pRequest - BACNET_READ_RANGE_DATA data
+ * @return number of bytes encoded
+ */
+int Structured_View_Read_Range_Hierarchy(
+    uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
+{
+    const BACNET_STRUCTURED_VIEW_NODE *hierarchy;
+    unsigned count = 0;
+    uint32_t first, last, index;
+    int32_t start;
+    int len, apdu_len = 0;
+    int apdu_size;
+
+    if (!apdu || !pRequest) {
+        return 0;
+    }
+    bitstring_init(&pRequest->ResultFlags);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, false);
+    pRequest->ItemCount = 0;
+    hierarchy = Structured_View_Hierarchy(pRequest->object_instance, &count);
+    if (count == 0) {
+        return 0;
+    }
+    if (pRequest->RequestType == RR_READ_ALL) {
+        pRequest->Count = (int32_t)count;
+        pRequest->Range.RefIndex = 1;
+    }
+    if (pRequest->Count < 0) {
+        /* from the index backwards - convert to a positive count */
+        start = (int32_t)pRequest->Range.RefIndex + pRequest->Count + 1;
+        if (start < 1) {
+            pRequest->Count = (int32_t)pRequest->Range.RefIndex;
+            pRequest->Range.RefIndex = 1;
+        } else {
+            pRequest->Range.RefIndex = (uint32_t)start;
+            pRequest->Count = -pRequest->Count;
+        }
+    }
+    if ((pRequest->Range.RefIndex == 0) ||
+        (pRequest->Range.RefIndex > count)) {
+        /* nothing to return past the end of the list */
+        return 0;
+    }
+    first = pRequest->Range.RefIndex;
+    last = first + (uint32_t)pRequest->Count - 1;
+    if ((last > count) || (last < first)) {
+        last = count;
+    }
+    apdu_size = MAX_APDU - pRequest->Overhead;
+    for (index = first; index <= last; index++) {
+        if ((apdu_len + STRUCTURED_VIEW_NODE_ENCODED_MAX) > apdu_size) {
+            bitstring_set_bit(
+                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
+            break;
+        }
+        len = Structured_View_Hierarchy_Node_Encode(
+            &apdu[apdu_len], &hierarchy[index - 1]);
+        apdu_len += len;
+        pRequest->ItemCount++;
+    }
+    if (pRequest->ItemCount > 0) {
+        if (first == 1) {
+            bitstring_set_bit(
+                &pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
+        }
+        if ((first + pRequest->ItemCount - 1) == count) {
+            bitstring_set_bit(
+                &pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
+        }
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief ReadRange information of the Structured View properties
+ * @param pRequest [in] Info on the request
+ * @param pInfo [out] Where to write the response to
+ * @return true if the property supports ReadRange
+ */
+bool Structured_View_Read_Range_Info(
+    BACNET_READ_RANGE_DATA *pRequest, RR_PROP_INFO *pInfo)
+{
+    bool status = false;
+
+    if (pRequest->object_property == PROP_STRUCTURED_VIEW_HIERARCHY) {
+        pInfo->RequestTypes = RR_BY_POSITION;
+        pInfo->Handler = Structured_View_Read_Range_Hierarchy;
+        status = true;
+    } else {
+        pRequest->error_class = ERROR_CLASS_SERVICES;
+        pRequest->error_code = ERROR_CODE_PROPERTY_IS_NOT_A_LIST;
+    }
+
+    return status;
+}
+#endif
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -771,6 +1122,18 @@ int Structured_View_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
                 &apdu[0], Structured_View_Represents(rpdata->object_instance));
             break;
         default:
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+            if (rpdata->object_property == PROP_STRUCTURED_VIEW_HIERARCHY) {
+                /* the proprietary flattened hierarchy */
+                apdu_len = Structured_View_Hierarchy_Encode(
+                    rpdata->object_instance, apdu, apdu_max);
+                if (apdu_len == BACNET_STATUS_ABORT) {
+                    rpdata->error_code =
+                        ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+                }
+                break;
+            }
+#endif
             rpdata->error_class = ERROR_CLASS_PROPERTY;
             rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
             apdu_len = BACNET_STATUS_ERROR;
@@ -837,7 +1200,7 @@ uint32_t Structured_View_Create(uint32_t object_instance)
     }
     pObject = Keylist_Data(Object_List, object_instance);
     if (!pObject) {
-        pObject = calloc(1, sizeof(struct object_data));
+        pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
         if (!pObject) {
             return BACNET_MAX_INSTANCE;
         }
@@ -854,9 +1217,10 @@ uint32_t Structured_View_Create(uint32_t object_instance)
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
-            free(pObject);
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             return BACNET_MAX_INSTANCE;
         }
+        Structured_View_Hierarchy_Invalidate();
     }
 
     return object_instance;
@@ -874,7 +1238,12 @@ bool Structured_View_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(
+            pObject->Hierarchy,
+            pObject->Hierarchy_Size *
+                sizeof(BACNET_STRUCTURED_VIEW_NODE));
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+        Structured_View_Hierarchy_Invalidate();
         status = true;
     }
 
@@ -892,7 +1261,11 @@ void Structured_View_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(
+                    pObject->Hierarchy,
+                    pObject->Hierarchy_Size *
+                        sizeof(BACNET_STRUCTURED_VIEW_NODE));
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
         Keylist_Delete(Object_List);
@@ -900,6 +1273,32 @@ void Structured_View_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Structured View objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Structured_View_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Structured View objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Structured_View_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the Structured View object data
  */
@@ -15,7 +15,20 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/bacstr.h"
 #include "bacnet/bacdevobjpropref.h"
+#include "bacnet/readrange.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/sys/memusage.h"
+
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+/* proprietary property with the flattened hierarchy below a view */
+#ifndef PROP_STRUCTURED_VIEW_HIERARCHY
+#define PROP_STRUCTURED_VIEW_HIERARCHY (PROP_PROPRIETARY_RANGE_MIN + 16)
+#endif
+#endif
+/* levels of local Structured View objects that the hierarchy descends */
+#ifndef BACNET_STRUCTURED_VIEW_HIERARCHY_DEPTH_MAX
+#define BACNET_STRUCTURED_VIEW_HIERARCHY_DEPTH_MAX 16
+#endif
 
 struct BACnetSubordinateData;
 typedef struct BACnetSubordinateData {
@@ -29,6 +42,20 @@ typedef struct BACnetSubordinateData {
     struct BACnetSubordinateData *next;
 } BACNET_SUBORDINATE_DATA;
 
+/**
+ * One node of the flattened hierarchy below a Structured View, in
+ * depth-first order, starting with the view itself.
+ */
+typedef struct BACnetStructuredViewNode {
+    uint32_t Device_Instance;
+    BACNET_OBJECT_TYPE Object_Type;
+    uint32_t Object_Instance;
+    /* position of the parent node, from 1, or 0 for the view itself */
+    uint32_t Parent;
+    /* levels below the view, which is 0 for the view itself */
+    uint8_t Depth;
+} BACNET_STRUCTURED_VIEW_NODE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -108,6 +135,23 @@ BACNET_STACK_EXPORT
 int Structured_View_Subordinate_Relationships_Element_Encode(
     uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu);
 
+BACNET_STACK_EXPORT
+const BACNET_STRUCTURED_VIEW_NODE *
+Structured_View_Hierarchy(uint32_t object_instance, unsigned *count);
+BACNET_STACK_EXPORT
+void Structured_View_Hierarchy_Invalidate(void);
+BACNET_STACK_EXPORT
+int Structured_View_Hierarchy_Node_Encode(
+    uint8_t *apdu, const BACNET_STRUCTURED_VIEW_NODE *node);
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+BACNET_STACK_EXPORT
+bool Structured_View_Read_Range_Info(
+    BACNET_READ_RANGE_DATA *pRequest, RR_PROP_INFO *pInfo);
+BACNET_STACK_EXPORT
+int Structured_View_Read_Range_Hierarchy(
+    uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest);
+#endif
+
 BACNET_STACK_EXPORT
 BACNET_DEVICE_OBJECT_REFERENCE *
 Structured_View_Represents(uint32_t object_instance);
@@ -129,6 +173,10 @@ BACNET_STACK_EXPORT
 void Structured_View_Cleanup(void);
 BACNET_STACK_EXPORT
 void Structured_View_Init(void);
+BACNET_STACK_EXPORT
+void Structured_View_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Structured_View_List_Revision(void);
 
 #ifdef __cplusplus
 }
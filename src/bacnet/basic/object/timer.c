@@ -27,6 +27,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 /* me! */
 #include "bacnet/basic/object/timer.h"
 
@@ -39,6 +40,7 @@ static OS_Keylist Object_List = NULL;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_TIMER;
 static write_property_function Write_Property_Internal_Callback;
+static loop_real_accessor_function Real_Accessor_Callback;
 
 struct object_data {
     uint32_t Present_Value;
@@ -472,8 +474,11 @@ static bool Timer_Write_Members(
     uint8_t priority)
 {
     BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_OBJECT_PROPERTY_REFERENCE reference = { 0 };
+    const LOOP_REAL_ACCESSOR *accessor;
     bool status = false;
     unsigned i = 0;
+    int apdu_len = -1;
     const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember = NULL;
 
     if (pObject && value) {
@@ -485,6 +490,29 @@ static bool Timer_Write_Members(
             if ((pMember->deviceIdentifier.type == OBJECT_DEVICE) &&
                 (pMember->deviceIdentifier.instance != BACNET_MAX_INSTANCE) &&
                 (pMember->objectIdentifier.instance != BACNET_MAX_INSTANCE)) {
+                accessor = NULL;
+                if ((value->tag == BACNET_APPLICATION_TAG_REAL) &&
+                    Real_Accessor_Callback) {
+                    reference.object_identifier = pMember->objectIdentifier;
+                    reference.property_identifier =
+                        pMember->propertyIdentifier;
+                    reference.property_array_index = pMember->arrayIndex;
+                    accessor = Real_Accessor_Callback(&reference);
+                }
+                if (accessor && accessor->write &&
+                    accessor->valid(pMember->objectIdentifier.instance)) {
+                    /* local object - skip the encoding and decoding */
+                    status = accessor->write(
+                        pMember->objectIdentifier.instance, value->type.Real,
+                        priority, &wp_data.error_class, &wp_data.error_code);
+                    continue;
+                }
+                if (apdu_len < 0) {
+                    /* the value is the same for each member */
+                    apdu_len = bacnet_timer_value_encode(
+                        wp_data.application_data,
+                        sizeof(wp_data.application_data), value);
+                }
                 wp_data.object_type = pMember->objectIdentifier.type;
                 wp_data.object_instance = pMember->objectIdentifier.instance;
                 wp_data.object_property = pMember->propertyIdentifier;
@@ -492,9 +520,7 @@ static bool Timer_Write_Members(
                 wp_data.error_class = ERROR_CLASS_PROPERTY;
                 wp_data.error_code = ERROR_CODE_SUCCESS;
                 wp_data.priority = priority;
-                wp_data.application_data_len = bacnet_timer_value_encode(
-                    wp_data.application_data, sizeof(wp_data.application_data),
-                    value);
+                wp_data.application_data_len = apdu_len;
                 if (Write_Property_Internal_Callback) {
                     status = Write_Property_Internal_Callback(&wp_data);
                     if (status) {
@@ -536,6 +562,26 @@ static bool Timer_Write_Request_Initiate(struct object_data *pObject)
     return status;
 }
 
+/**
+ * @brief Schedules the next Timer_Task() of a running timer for the
+ *  moment that it expires, or cancels it for a stopped timer
+ * @details The deadline replaces any earlier one, so a timer that is
+ *  restarted expires a full timeout after the restart, however often
+ *  Device_Timer() is called.
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object data
+ */
+static void
+Timer_Wakeup(uint32_t object_instance, const struct object_data *pObject)
+{
+    if (pObject->Timer_State == TIMER_STATE_RUNNING) {
+        Device_Timer_Deadline(
+            Object_Type, object_instance, pObject->Present_Value);
+    } else {
+        Device_Timer_Cancel(Object_Type, object_instance);
+    }
+}
+
 /**
  * For a given object instance-number, determines the program-state
  *
@@ -617,6 +663,7 @@ bool Timer_State_Set(uint32_t object_instance, BACNET_TIMER_STATE value)
                    no write requests shall be initiated;
                    and no state transition shall occur.*/
             }
+            Timer_Wakeup(object_instance, pObject);
             /* Writing a value other than IDLE to this property
                shall cause a Result(-) to be returned */
             status = true;
@@ -749,6 +796,7 @@ bool Timer_Running_Set(uint32_t object_instance, bool start)
                 Timer_Write_Request_Initiate(pObject);
             }
         }
+        Timer_Wakeup(object_instance, pObject);
         status = true;
     }
 
@@ -1021,10 +1069,18 @@ uint32_t Timer_Present_Value(uint32_t object_instance)
 {
     uint32_t value = 0;
     struct object_data *pObject;
+    uint32_t remaining;
 
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject) {
         value = pObject->Present_Value;
+        if (pObject->Timer_State == TIMER_STATE_RUNNING) {
+            /* the time left until the deadline of the scheduled expiry */
+            remaining = Device_Timer_Remaining(Object_Type, object_instance);
+            if (remaining < value) {
+                value = remaining;
+            }
+        }
     }
 
     return value;
@@ -1110,6 +1166,7 @@ bool Timer_Present_Value_Set(uint32_t object_instance, uint32_t value)
                     &pObject->Update_Time.date, &pObject->Update_Time.time,
                     NULL, NULL);
                 Timer_Write_Request_Initiate(pObject);
+                Timer_Wakeup(object_instance, pObject);
                 status = true;
             } else {
                 status = false;
@@ -2079,6 +2136,17 @@ void Timer_Write_Property_Internal_Callback_Set(write_property_function cb)
     Write_Property_Internal_Callback = cb;
 }
 
+/**
+ * @brief Sets the callback that finds the direct accessor of a local
+ *  object property that a timer writes a REAL value to, instead of
+ *  encoding the value for WriteProperty
+ * @param cb - callback used to find the accessors, or NULL
+ */
+void Timer_Real_Accessor_Callback_Set(loop_real_accessor_function cb)
+{
+    Real_Accessor_Callback = cb;
+}
+
 /**
  * @brief Updates the object program operation
  * @details In the RUNNING state, the timer is active
@@ -2105,6 +2173,10 @@ void Timer_Task(uint32_t object_instance, uint16_t milliseconds)
                     pObject->Timer_State = TIMER_STATE_EXPIRED;
                     pObject->Last_State_Change =
                         TIMER_TRANSITION_RUNNING_TO_EXPIRED;
+                    datetime_local(
+                        &pObject->Update_Time.date,
+                        &pObject->Update_Time.time, NULL, NULL);
+                    Timer_Write_Request_Initiate(pObject);
                 }
                 break;
             case TIMER_STATE_EXPIRED:
@@ -2113,6 +2185,7 @@ void Timer_Task(uint32_t object_instance, uint16_t milliseconds)
                 /* do nothing */
                 break;
         }
+        Timer_Wakeup(object_instance, pObject);
     }
 }
 
@@ -2228,7 +2301,7 @@ uint32_t Timer_Create(uint32_t object_instance)
         /* already exists - signal success but don't change data */
         return object_instance;
     }
-    pObject = calloc(1, sizeof(struct object_data));
+    pObject = BACNET_MEMPOOL_CALLOC(sizeof(struct object_data));
     if (!pObject) {
         /* no RAM available - signal failure */
         return BACNET_MAX_INSTANCE;
@@ -2236,7 +2309,7 @@ uint32_t Timer_Create(uint32_t object_instance)
     index = Keylist_Data_Add(Object_List, object_instance, pObject);
     if (index < 0) {
         /* unable to add to list - signal failure */
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         return BACNET_MAX_INSTANCE;
     }
     pObject->Timer_State = TIMER_STATE_IDLE;
@@ -2273,7 +2346,7 @@ bool Timer_Delete(uint32_t object_instance)
         Keylist_Data_Delete(Object_List, object_instance);
 
     if (pObject) {
-        free(pObject);
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
         status = true;
     }
 
@@ -2291,7 +2364,7 @@ void Timer_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
-                free(pObject);
+                BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
             }
         } while (pObject);
 
@@ -2300,6 +2373,32 @@ void Timer_Cleanup(void)
     }
 }
 
+/**
+ * @brief Add the memory used by the Timer objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Timer_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!usage) {
+        return;
+    }
+    count = (unsigned)Keylist_Count(Object_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Object_List);
+    usage->dynamic_bytes += count * sizeof(struct object_data);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of Timer objects
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Timer_List_Revision(void)
+{
+    return Keylist_Revision(Object_List);
+}
+
 /**
  * Initializes the object data
  */
@@ -2308,4 +2407,6 @@ void Timer_Init(void)
     if (!Object_List) {
         Object_List = Keylist_Create();
     }
+    /* Timer_Task() is only called for running timers */
+    Device_Timer_Scheduled_Set(Object_Type, true);
 }
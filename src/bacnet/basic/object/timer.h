@@ -17,6 +17,8 @@
 #include "bacnet/wp.h"
 #include "bacnet/rp.h"
 #include "bacnet/list_element.h"
+#include "bacnet/basic/object/loop.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -166,6 +168,8 @@ void Timer_Task(uint32_t object_instance, uint16_t milliseconds);
 
 BACNET_STACK_EXPORT
 void Timer_Write_Property_Internal_Callback_Set(write_property_function cb);
+BACNET_STACK_EXPORT
+void Timer_Real_Accessor_Callback_Set(loop_real_accessor_function cb);
 
 BACNET_STACK_EXPORT
 int Timer_Add_List_Element(BACNET_LIST_ELEMENT_DATA *list_element);
@@ -181,6 +185,10 @@ BACNET_STACK_EXPORT
 void Timer_Cleanup(void);
 BACNET_STACK_EXPORT
 void Timer_Init(void);
+BACNET_STACK_EXPORT
+void Timer_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Timer_List_Revision(void);
 
 /* API for the program requests
     note: return value is 0 for success, non-zero for failure
@@ -7,6 +7,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <limits.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -22,6 +23,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/binding/address.h"
 #include "bacnet/basic/object/trendlog.h"
+#include "bacnet/basic/object/trendlog_block.h"
 #include "bacnet/datalink/datalink.h"
 #if defined(BACFILE)
 #include "bacnet/basic/object/bacfile.h" /* object list dependency */
@@ -32,9 +34,272 @@
 #define MAX_TREND_LOGS 8
 #endif
 
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+/* number of compressed blocks of a log, in the memory that the
+   records would take uncompressed */
+#ifndef TL_BLOCK_COUNT
+#define TL_BLOCK_COUNT \
+    ((TL_MAX_ENTRIES * sizeof(TL_DATA_REC)) / sizeof(TL_BLOCK))
+#endif
+/* ring of the compressed blocks of a log, with a cursor so that the
+   sequential reads of ReadRange decode each record once */
+typedef struct tl_block_ring {
+    uint32_t ulOldest; /* slot of the block with the oldest records */
+    uint32_t ulBlocks; /* number of blocks in use */
+    bool bCursor; /* true if the cursor is valid */
+    uint32_t ulCursorBlock; /* block of the cursor, from the oldest */
+    uint32_t ulCursorFirst; /* record number of its first record */
+    TL_BLOCK_STATE Cursor; /* state after the last record read */
+} TL_BLOCK_RING;
+static TL_BLOCK Blocks[MAX_TREND_LOGS][TL_BLOCK_COUNT];
+static TL_BLOCK_RING Rings[MAX_TREND_LOGS];
+#else
 static TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
+#endif
 static TL_LOG_INFO LogInfo[MAX_TREND_LOGS];
 
+static void TL_Insert_Record(int iLog, const TL_DATA_REC *pRecord);
+
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+/**
+ * @brief Empty the compressed blocks of a log
+ * @param iLog - Index of the log
+ */
+static void TL_Blocks_Clear(int iLog)
+{
+    TL_BLOCK_RING *pRing = &Rings[iLog];
+
+    pRing->ulOldest = 0;
+    pRing->ulBlocks = 0;
+    pRing->bCursor = false;
+}
+
+/**
+ * @brief Get the block of a log that holds the newest records
+ * @param iLog - Index of the log
+ * @return the newest block, or NULL if the log has no blocks
+ */
+static TL_BLOCK *TL_Blocks_Newest(int iLog)
+{
+    const TL_BLOCK_RING *pRing = &Rings[iLog];
+
+    if (pRing->ulBlocks == 0) {
+        return NULL;
+    }
+
+    return &Blocks[iLog]
+                  [(pRing->ulOldest + pRing->ulBlocks - 1) % TL_BLOCK_COUNT];
+}
+
+/**
+ * @brief Determine if the compressed blocks of a log are all full
+ * @param iLog - Index of the log
+ * @return true if the next record replaces the oldest records
+ */
+static bool TL_Blocks_Full(int iLog)
+{
+    const TL_BLOCK *pBlock = TL_Blocks_Newest(iLog);
+
+    return (Rings[iLog].ulBlocks == TL_BLOCK_COUNT) && pBlock &&
+        TL_Block_Full(pBlock);
+}
+
+/**
+ * @brief Estimate how many records the compressed blocks of a log hold,
+ *  from the bits the records so far take
+ * @param iLog - Index of the log
+ * @return the estimated Buffer_Size of the log
+ */
+static uint32_t TL_Blocks_Buffer_Size(int iLog)
+{
+    const TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    const TL_BLOCK *pBlock = TL_Blocks_Newest(iLog);
+    uint64_t ullBits;
+
+    if (!pBlock || (CurrentLog->ulRecordCount == 0)) {
+        return TL_MAX_ENTRIES;
+    }
+    if (TL_Blocks_Full(iLog)) {
+        return CurrentLog->ulRecordCount;
+    }
+    ullBits = (uint64_t)(Rings[iLog].ulBlocks - 1) * TL_BLOCK_BYTES * 8;
+    ullBits += pBlock->Last.usBit;
+    if (ullBits == 0) {
+        return TL_MAX_ENTRIES;
+    }
+
+    return (uint32_t)(((uint64_t)CurrentLog->ulRecordCount * TL_BLOCK_COUNT *
+                       TL_BLOCK_BYTES * 8) /
+                      ullBits);
+}
+
+/**
+ * @brief Compress a record into the newest block of a log, and free the
+ *  oldest block when all the blocks are full
+ * @param iLog - Index of the log
+ * @param pRecord - the record to insert
+ */
+static void TL_Blocks_Insert(int iLog, const TL_DATA_REC *pRecord)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    TL_BLOCK_RING *pRing = &Rings[iLog];
+    TL_BLOCK *pBlock = TL_Blocks_Newest(iLog);
+    uint16_t usCount;
+
+    if (pBlock && TL_Block_Append(pBlock, pRecord)) {
+        CurrentLog->ulRecordCount++;
+        return;
+    }
+    if (pRing->ulBlocks == TL_BLOCK_COUNT) {
+        /* drop the oldest records, a block at a time */
+        usCount = TL_Block_Count(&Blocks[iLog][pRing->ulOldest]);
+        if (CurrentLog->ulRecordCount > usCount) {
+            CurrentLog->ulRecordCount -= usCount;
+        } else {
+            CurrentLog->ulRecordCount = 0;
+        }
+        pRing->ulOldest = (pRing->ulOldest + 1) % TL_BLOCK_COUNT;
+        pRing->ulBlocks--;
+        pRing->bCursor = false;
+    }
+    pRing->ulBlocks++;
+    pBlock = TL_Blocks_Newest(iLog);
+    TL_Block_Init(pBlock);
+    if (TL_Block_Append(pBlock, pRecord)) {
+        CurrentLog->ulRecordCount++;
+    }
+}
+
+/**
+ * @brief Decode a record from the compressed blocks of a log.  The ring
+ *  keeps a cursor after the last record decoded, so reading the records
+ *  in order decodes each block once.
+ * @param iLog - Index of the log
+ * @param ulRecord - record number, 0 for the oldest
+ * @param pRecord - the decoded record
+ * @return true if the record was decoded
+ */
+static bool
+TL_Blocks_Record(int iLog, uint32_t ulRecord, TL_DATA_REC *pRecord)
+{
+    TL_BLOCK_RING *pRing = &Rings[iLog];
+    const TL_BLOCK *pBlock = NULL;
+    uint32_t ulBlock = 0;
+    uint32_t ulFirst = 0;
+    uint16_t usCount;
+
+    if (pRing->bCursor && (ulRecord >= pRing->ulCursorFirst)) {
+        ulBlock = pRing->ulCursorBlock;
+        ulFirst = pRing->ulCursorFirst;
+    }
+    while (ulBlock < pRing->ulBlocks) {
+        pBlock = &Blocks[iLog][(pRing->ulOldest + ulBlock) % TL_BLOCK_COUNT];
+        usCount = TL_Block_Count(pBlock);
+        if (ulRecord < (ulFirst + usCount)) {
+            break;
+        }
+        ulFirst += usCount;
+        ulBlock++;
+    }
+    if (ulBlock >= pRing->ulBlocks) {
+        return false;
+    }
+    if (!pRing->bCursor || (pRing->ulCursorBlock != ulBlock) ||
+        ((ulFirst + pRing->Cursor.usRecord) > ulRecord)) {
+        TL_Block_Start(pBlock, &pRing->Cursor);
+        pRing->ulCursorBlock = ulBlock;
+        pRing->ulCursorFirst = ulFirst;
+    }
+    pRing->bCursor = true;
+    do {
+        if (!TL_Block_Next(pBlock, &pRing->Cursor, pRecord)) {
+            pRing->bCursor = false;
+            return false;
+        }
+    } while ((ulFirst + pRing->Cursor.usRecord) <= ulRecord);
+
+    return true;
+}
+#endif
+
+/**
+ * @brief Get a record from the buffer of a log
+ * @param iLog - Index of the log
+ * @param ulRecord - record number, 0 for the oldest
+ * @param pRecord - the record
+ */
+static void TL_Record_Get(int iLog, uint32_t ulRecord, TL_DATA_REC *pRecord)
+{
+    const TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    if (!CurrentLog->pRecords) {
+        if (!TL_Blocks_Record(iLog, ulRecord, pRecord)) {
+            memset(pRecord, 0, sizeof(TL_DATA_REC));
+        }
+        return;
+    }
+#endif
+    if (CurrentLog->ulRecordCount < CurrentLog->ulBufferSize) {
+        *pRecord = CurrentLog->pRecords[ulRecord];
+    } else {
+        *pRecord = CurrentLog->pRecords
+                       [(CurrentLog->iIndex + ulRecord) %
+                        CurrentLog->ulBufferSize];
+    }
+}
+
+/**
+ * @brief Get the number of records the buffer of a log holds
+ * @param iLog - Index of the log
+ * @return the Buffer_Size of the log
+ */
+static uint32_t TL_Buffer_Size(int iLog)
+{
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    if (!LogInfo[iLog].pRecords) {
+        return TL_Blocks_Buffer_Size(iLog);
+    }
+#endif
+
+    return LogInfo[iLog].ulBufferSize;
+}
+
+/**
+ * @brief Determine if the buffer of a log is full
+ * @param iLog - Index of the log
+ * @return true if the next record replaces the oldest record
+ */
+static bool TL_Is_Full(int iLog)
+{
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    if (!LogInfo[iLog].pRecords) {
+        return TL_Blocks_Full(iLog);
+    }
+#endif
+
+    return LogInfo[iLog].ulRecordCount == LogInfo[iLog].ulBufferSize;
+}
+
+/**
+ * @brief Remove all the records from the buffer of a log
+ * @param iLog - Index of the log
+ */
+static void TL_Clear(int iLog)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+    CurrentLog->ulRecordCount = 0;
+    CurrentLog->iIndex = 0;
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    TL_Blocks_Clear(iLog);
+#endif
+    if (CurrentLog->pState) {
+        CurrentLog->pState->ulRecordCount = 0;
+        CurrentLog->pState->ulIndex = 0;
+    }
+}
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int32_t Trend_Log_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -146,6 +411,24 @@ static bacnet_time_t Trend_Log_Epoch_Seconds_Now(void)
     return datetime_seconds_since_epoch(&bdatetime);
 }
 
+/**
+ * @brief Add the memory used by the Trend Log objects to a report
+ * @param usage - report to add the memory used by the objects to
+ */
+void Trend_Log_Memory_Usage(BACNET_MEMORY_USAGE *usage)
+{
+    if (!usage) {
+        return;
+    }
+    /* the log buffers are reserved for every trend log at compile time */
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    usage->static_bytes += sizeof(Blocks) + sizeof(Rings) + sizeof(LogInfo);
+#else
+    usage->static_bytes += sizeof(Logs) + sizeof(LogInfo);
+#endif
+    usage->count += MAX_TREND_LOGS;
+}
+
 /*
  * Things to do when starting up the stack for Trend Logs.
  * Should be called whenever we reset the device or power it up
@@ -157,6 +440,7 @@ void Trend_Log_Init(void)
     int iEntry;
     BACNET_DATE_TIME bdatetime = { 0 };
     bacnet_time_t tClock;
+    TL_DATA_REC TempRec = { 0 };
     uint8_t month;
 
     if (!initialized) {
@@ -181,20 +465,30 @@ void Trend_Log_Init(void)
              * purposes.
              */
             /* Different month for each log */
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+            LogInfo[iLog].pRecords = NULL;
+            TL_Blocks_Clear(iLog);
+#else
+            LogInfo[iLog].pRecords = Logs[iLog];
+#endif
+            LogInfo[iLog].ulBufferSize = TL_MAX_ENTRIES;
+            LogInfo[iLog].pState = NULL;
+            LogInfo[iLog].iIndex = 0;
+            LogInfo[iLog].ulRecordCount = 0;
             month = iLog + 1;
             datetime_set_values(&bdatetime, 2009, month, 1, 0, 0, 0, 0);
             tClock = datetime_seconds_since_epoch(&bdatetime);
             for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
-                Logs[iLog][iEntry].tTimeStamp = tClock;
-                Logs[iLog][iEntry].ucRecType = TL_TYPE_REAL;
-                Logs[iLog][iEntry].Datum.fReal =
-                    (float)(iEntry + (iLog * TL_MAX_ENTRIES));
+                TempRec.tTimeStamp = tClock;
+                TempRec.ucRecType = TL_TYPE_REAL;
+                TempRec.Datum.fReal = (float)(iEntry + (iLog * TL_MAX_ENTRIES));
                 /* Put status flags with every second log */
                 if ((iLog & 1) == 0) {
-                    Logs[iLog][iEntry].ucStatus = 128;
+                    TempRec.ucStatus = 128;
                 } else {
-                    Logs[iLog][iEntry].ucStatus = 0;
+                    TempRec.ucStatus = 0;
                 }
+                TL_Insert_Record(iLog, &TempRec);
                 /* advance 15 minutes, in seconds */
                 tClock += 900;
             }
@@ -204,13 +498,12 @@ void Trend_Log_Init(void)
             LogInfo[iLog].bEnable = true;
             LogInfo[iLog].bStopWhenFull = false;
             LogInfo[iLog].bTrigger = false;
+            LogInfo[iLog].bChanged = false;
             LogInfo[iLog].LoggingType = LOGGING_TYPE_POLLED;
             LogInfo[iLog].Source.arrayIndex = 0;
             LogInfo[iLog].ucTimeFlags = 0;
             LogInfo[iLog].ulIntervalOffset = 0;
-            LogInfo[iLog].iIndex = 0;
             LogInfo[iLog].ulLogInterval = 900;
-            LogInfo[iLog].ulRecordCount = TL_MAX_ENTRIES;
             LogInfo[iLog].ulTotalRecordCount = 10000;
 
             LogInfo[iLog].Source.deviceIdentifier.instance =
@@ -235,6 +528,85 @@ void Trend_Log_Init(void)
     return;
 }
 
+/**
+ * @brief Place the records of a Trend Log in a buffer of the application,
+ *  such as a memory-mapped file, in place of the built-in buffer
+ * @note The ring state in the buffer state is kept current as records are
+ *  inserted, so a buffer in persistent memory survives a restart.  When the
+ *  state does not match the buffer size, the log starts out empty.
+ * @param object_instance - object-instance number of the object
+ * @param pRecords - buffer of records, or NULL for the built-in buffer
+ * @param ulBufferSize - number of records the buffer holds
+ * @param pState - ring state stored with the buffer, or NULL
+ * @return true if the buffer is used by the log
+ */
+bool Trend_Log_Buffer_Set(
+    uint32_t object_instance,
+    TL_DATA_REC *pRecords,
+    uint32_t ulBufferSize,
+    TL_LOG_BUFFER_STATE *pState)
+{
+    TL_LOG_INFO *CurrentLog;
+    unsigned log_index;
+
+    log_index = Trend_Log_Instance_To_Index(object_instance);
+    if (log_index >= MAX_TREND_LOGS) {
+        return false;
+    }
+    CurrentLog = &LogInfo[log_index];
+    if (!pRecords) {
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+        TL_Blocks_Clear((int)log_index);
+#else
+        pRecords = Logs[log_index];
+#endif
+        ulBufferSize = TL_MAX_ENTRIES;
+        pState = NULL;
+    } else if ((ulBufferSize == 0) || (ulBufferSize > INT_MAX)) {
+        return false;
+    }
+    CurrentLog->pRecords = pRecords;
+    CurrentLog->ulBufferSize = ulBufferSize;
+    CurrentLog->pState = pState;
+    if (pState && (pState->ulBufferSize == ulBufferSize) &&
+        (pState->ulRecordCount <= ulBufferSize) &&
+        (pState->ulIndex < ulBufferSize)) {
+        /* restore the records kept from before */
+        CurrentLog->ulRecordCount = pState->ulRecordCount;
+        CurrentLog->ulTotalRecordCount = pState->ulTotalRecordCount;
+        CurrentLog->iIndex = (int)pState->ulIndex;
+    } else {
+        CurrentLog->ulRecordCount = 0;
+        CurrentLog->ulTotalRecordCount = 0;
+        CurrentLog->iIndex = 0;
+        if (pState) {
+            pState->ulBufferSize = ulBufferSize;
+            pState->ulRecordCount = 0;
+            pState->ulTotalRecordCount = 0;
+            pState->ulIndex = 0;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the number of records the buffer of a Trend Log holds
+ * @param object_instance - object-instance number of the object
+ * @return the Buffer_Size of the log, or 0 if the object is not valid
+ */
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance)
+{
+    unsigned log_index;
+
+    log_index = Trend_Log_Instance_To_Index(object_instance);
+    if (log_index >= MAX_TREND_LOGS) {
+        return 0;
+    }
+
+    return TL_Buffer_Size((int)log_index);
+}
+
 /*
  * Note: we use the instance number here and build the name based
  * on the assumption that there is a 1 to 1 correspondence. If there
@@ -309,7 +681,8 @@ int Trend_Log_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
 
         case PROP_BUFFER_SIZE:
-            apdu_len = encode_application_unsigned(&apdu[0], TL_MAX_ENTRIES);
+            apdu_len = encode_application_unsigned(
+                &apdu[0], TL_Buffer_Size((int)log_index));
             break;
 
         case PROP_LOG_BUFFER:
@@ -459,8 +832,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                  * set */
                 if ((CurrentLog->bEnable == false) &&
                     (CurrentLog->bStopWhenFull == true) &&
-                    (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
-                    (value.type.Boolean == true)) {
+                    TL_Is_Full(log_index) && (value.type.Boolean == true)) {
                     status = false;
                     wp_data->error_class = ERROR_CLASS_OBJECT;
                     wp_data->error_code = ERROR_CODE_LOG_BUFFER_FULL;
@@ -502,7 +874,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     CurrentLog->bStopWhenFull = value.type.Boolean;
 
                     if ((value.type.Boolean == true) &&
-                        (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
+                        TL_Is_Full(log_index) &&
                         (CurrentLog->bEnable == true)) {
                         /* When full log is switched from normal to stop when
                          * full disable the log and record the fact - see
@@ -531,8 +903,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             if (status) {
                 if (value.type.Unsigned_Int == 0) {
                     /* Time to clear down the log */
-                    CurrentLog->ulRecordCount = 0;
-                    CurrentLog->iIndex = 0;
+                    TL_Clear(log_index);
                     TL_Insert_Status_Rec(
                         log_index, LOG_STATUS_BUFFER_PURGED, true);
                 }
@@ -541,12 +912,12 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
 
         case PROP_LOGGING_TYPE:
             /* logic
-             * triggered and polled options.
+             * triggered, polled, and COV options.
              */
             status = write_property_type_valid(
                 wp_data, &value, BACNET_APPLICATION_TAG_ENUMERATED);
             if (status) {
-                if (value.type.Enumerated != LOGGING_TYPE_COV) {
+                if (value.type.Enumerated <= LOGGING_TYPE_TRIGGERED) {
                     CurrentLog->LoggingType =
                         (BACNET_LOGGING_TYPE)value.type.Enumerated;
                     if (value.type.Enumerated == LOGGING_TYPE_POLLED) {
@@ -561,12 +932,17 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                          * selected */
                         CurrentLog->ulLogInterval = 0;
                     }
+                    if (value.type.Enumerated == LOGGING_TYPE_COV) {
+                        /* The logged object is local, so its own
+                         * change-of-value reports drive the log - take
+                         * a first reading to start from */
+                        CurrentLog->ulLogInterval = 0;
+                        CurrentLog->bChanged = true;
+                    }
                 } else {
-                    /* We don't currently support COV */
                     status = false;
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
-                    wp_data->error_code =
-                        ERROR_CODE_OPTIONAL_FUNCTIONALITY_NOT_SUPPORTED;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
                 }
             }
             break;
@@ -697,11 +1073,14 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     &TempSource, &CurrentLog->Source,
                     sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE)) != 0) {
                 /* Clear buffer if property being logged is changed */
-                CurrentLog->ulRecordCount = 0;
-                CurrentLog->iIndex = 0;
+                TL_Clear(log_index);
                 TL_Insert_Status_Rec(log_index, LOG_STATUS_BUFFER_PURGED, true);
             }
             CurrentLog->Source = TempSource;
+            if (CurrentLog->LoggingType == LOGGING_TYPE_COV) {
+                /* take a first reading of the new object */
+                CurrentLog->bChanged = true;
+            }
             status = true;
             break;
 
@@ -806,6 +1185,41 @@ bool TrendLogGetRRInfo(
     return (false);
 }
 
+/**
+ * @brief Insert a record into the log buffer, replacing the oldest record
+ *  when the buffer is full, and keep the ring state of the buffer
+ * @param iLog - Index of the log
+ * @param pRecord - the record to insert
+ */
+static void TL_Insert_Record(int iLog, const TL_DATA_REC *pRecord)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+#if defined(BACNET_TREND_LOG_COMPRESSION)
+    if (!CurrentLog->pRecords) {
+        TL_Blocks_Insert(iLog, pRecord);
+        CurrentLog->ulTotalRecordCount++;
+        return;
+    }
+#endif
+    CurrentLog->pRecords[CurrentLog->iIndex++] = *pRecord;
+    if ((uint32_t)CurrentLog->iIndex >= CurrentLog->ulBufferSize) {
+        CurrentLog->iIndex = 0;
+    }
+
+    CurrentLog->ulTotalRecordCount++;
+
+    if (CurrentLog->ulRecordCount < CurrentLog->ulBufferSize) {
+        CurrentLog->ulRecordCount++;
+    }
+    if (CurrentLog->pState) {
+        CurrentLog->pState->ulRecordCount = CurrentLog->ulRecordCount;
+        CurrentLog->pState->ulTotalRecordCount =
+            CurrentLog->ulTotalRecordCount;
+        CurrentLog->pState->ulIndex = (uint32_t)CurrentLog->iIndex;
+    }
+}
+
 /*****************************************************************************
  * Insert a status record into a trend log - does not check for enable/log   *
  * full, time slots and so on as these type of entries have to go in         *
@@ -844,16 +1258,7 @@ void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState)
             break;
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
-    }
+    TL_Insert_Record(iLog, &TempRec);
 }
 
 /*****************************************************************************
@@ -1267,6 +1672,42 @@ int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     return (iLen);
 }
 
+/**
+ * @brief Find the first record, in time order, after the reference time
+ * @note The records of a log are in time order, so a binary search over
+ *  the circular buffer finds the record without scanning the log.
+ * @param log_index - Index of the log to search
+ * @param uiOldest - buffer position of the oldest record in the log
+ * @param uiCount - number of records in the log
+ * @param tRefTime - the reference time
+ * @param bAfter - true to skip the records at the reference time too
+ * @return the 0 based record number of the first record later than, or
+ *  with bAfter false at or later than, the reference time, or uiCount
+ *  if there is no such record
+ */
+static uint32_t TL_Time_Bound(
+    int log_index, uint32_t uiCount, bacnet_time_t tRefTime, bool bAfter)
+{
+    uint32_t uiLow = 0;
+    uint32_t uiHigh = uiCount;
+    uint32_t uiMiddle = 0;
+    bacnet_time_t tTimeStamp = 0;
+    TL_DATA_REC Record;
+
+    while (uiLow < uiHigh) {
+        uiMiddle = uiLow + ((uiHigh - uiLow) / 2);
+        TL_Record_Get(log_index, uiMiddle, &Record);
+        tTimeStamp = Record.tTimeStamp;
+        if ((tTimeStamp < tRefTime) || (bAfter && (tTimeStamp == tRefTime))) {
+            uiLow = uiMiddle + 1;
+        } else {
+            uiHigh = uiMiddle;
+        }
+    }
+
+    return uiLow;
+}
+
 /**
  * @brief Handle encoding for the By Time option.
  * @note The fact that the buffer always has at least a single entry
@@ -1298,32 +1739,20 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     CurrentLog = &LogInfo[log_index];
 
     tRefTime = TL_BAC_Time_To_Local(&pRequest->Range.RefTime);
-    /* Find correct position for oldest entry in log */
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        uiIndex = 0;
-    } else {
-        uiIndex = CurrentLog->iIndex;
-    }
 
     if (pRequest->Count < 0) {
         /* Start at end of log and look for record which has
          * timestamp greater than or equal to the reference.
          */
-        iCount = CurrentLog->ulRecordCount - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = CurrentLog->ulTotalRecordCount;
-        for (;;) {
-            if (Logs[log_index][(uiIndex + iCount) % TL_MAX_ENTRIES]
-                    .tTimeStamp < tRefTime) {
-                break;
-            }
-
-            uiFirstSeq--;
-            iCount--;
-            if (iCount < 0) {
-                return (0);
-            }
+        iCount = (int)TL_Time_Bound(
+                     log_index, CurrentLog->ulRecordCount, tRefTime, false) -
+            1;
+        if (iCount < 0) {
+            return (0);
         }
+        /* The sequence number for the record we found */
+        uiFirstSeq = CurrentLog->ulTotalRecordCount -
+            (CurrentLog->ulRecordCount - 1 - iCount);
 
         /* We have an and point for our request,
          * now work backwards to find where we should start from
@@ -1348,23 +1777,15 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
         /* Start at beginning of log and look for 1st record which has
          * timestamp greater than the reference time.
          */
-        iCount = 0;
+        iCount = (int)TL_Time_Bound(
+            log_index, CurrentLog->ulRecordCount, tRefTime, true);
+        if ((uint32_t)iCount == CurrentLog->ulRecordCount) {
+            return (0);
+        }
         /* Figure out the sequence number for the first record, last is
          * ulTotalRecordCount */
-        uiFirstSeq =
-            CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
-        for (;;) {
-            if (Logs[log_index][(uiIndex + iCount) % TL_MAX_ENTRIES]
-                    .tTimeStamp > tRefTime) {
-                break;
-            }
-
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t)iCount == CurrentLog->ulRecordCount) {
-                return (0);
-            }
-        }
+        uiFirstSeq = CurrentLog->ulTotalRecordCount -
+            (CurrentLog->ulRecordCount - 1) + iCount;
     }
 
     /* We now have a starting point for the operation and a +ve count */
@@ -1422,20 +1843,14 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 int TL_encode_entry(uint8_t *apdu, int iLog, int iEntry)
 {
     int iLen = 0;
-    TL_DATA_REC *pSource = NULL;
+    TL_DATA_REC Source;
+    const TL_DATA_REC *pSource = &Source;
     BACNET_BIT_STRING TempBits;
     uint8_t ucCount = 0;
     BACNET_DATE_TIME TempTime;
 
-    /* Convert from BACnet 1 based to 0 based array index and then
-     * handle wrap around of the circular buffer */
-
-    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES) {
-        pSource = &Logs[iLog][(iEntry - 1) % TL_MAX_ENTRIES];
-    } else {
-        pSource =
-            &Logs[iLog][(LogInfo[iLog].iIndex + iEntry - 1) % TL_MAX_ENTRIES];
-    }
+    /* Convert from BACnet 1 based to 0 based record number */
+    TL_Record_Get(iLog, (uint32_t)(iEntry - 1), &Source);
 
     iLen = 0;
     /* First stick the time stamp in with tag [0] */
@@ -1581,6 +1996,121 @@ static int local_read_property(
     return (len);
 }
 
+/**
+ * @brief Store a bitstring in a log record, truncated at 32 bits
+ * @param pBits - log record bitstring storage
+ * @param pBitString - the bitstring to store
+ */
+static void TL_Bits_Store(TL_BITS *pBits, const BACNET_BIT_STRING *pBitString)
+{
+    uint8_t ucCount;
+
+    /* We truncate any bitstrings at 32 bits to conserve space */
+    if (bitstring_bits_used(pBitString) < 32) {
+        /* Store the bytes used and the bits free
+           in the last byte */
+        pBits->ucLen = bitstring_bytes_used(pBitString) << 4;
+        pBits->ucLen |= (8 - (bitstring_bits_used(pBitString) % 8)) & 7;
+        /* Fetch the octets with the bits directly */
+        for (ucCount = 0; ucCount < bitstring_bytes_used(pBitString);
+             ucCount++) {
+            pBits->ucStore[ucCount] = bitstring_octet(pBitString, ucCount);
+        }
+    } else {
+        /* We will only use the first 4 octets to save space */
+        pBits->ucLen = 4 << 4;
+        for (ucCount = 0; ucCount < 4; ucCount++) {
+            pBits->ucStore[ucCount] = bitstring_octet(pBitString, ucCount);
+        }
+    }
+}
+
+/**
+ * @brief Sample the Present_Value and Status_Flags of a local object
+ *  straight from the object, through its COV value list
+ * @note This skips encoding the values with ReadProperty only to decode
+ *  them again.  Any other property, or an object type without a value
+ *  list, is sampled with ReadProperty.
+ * @param Source - the logged object and property
+ * @param pRecord - log record to hold the value and status
+ * @return true if the value and status are in the record
+ */
+static bool TL_fetch_value_list(
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *Source,
+    TL_DATA_REC *pRecord)
+{
+    BACNET_PROPERTY_VALUE value_list[4] = { 0 };
+    const BACNET_PROPERTY_VALUE *pValue;
+    const BACNET_APPLICATION_DATA_VALUE *pDatum;
+    bool bValue = false;
+    bool bStatus = false;
+    unsigned i;
+
+    if ((Source->propertyIdentifier != PROP_PRESENT_VALUE) ||
+        (Source->arrayIndex != BACNET_ARRAY_ALL) ||
+        !Device_Value_List_Supported(Source->objectIdentifier.type)) {
+        return false;
+    }
+    for (i = 1; i < ARRAY_SIZE(value_list); i++) {
+        value_list[i - 1].next = &value_list[i];
+    }
+    if (!Device_Encode_Value_List(
+            Source->objectIdentifier.type, Source->objectIdentifier.instance,
+            value_list)) {
+        return false;
+    }
+    for (pValue = value_list; pValue; pValue = pValue->next) {
+        pDatum = &pValue->value;
+        if (pValue->propertyIdentifier == PROP_STATUS_FLAGS) {
+            if (pDatum->tag == BACNET_APPLICATION_TAG_BIT_STRING) {
+                pRecord->ucStatus =
+                    128 | bitstring_octet(&pDatum->type.Bit_String, 0);
+                bStatus = true;
+            }
+            continue;
+        }
+        if (pValue->propertyIdentifier != PROP_PRESENT_VALUE) {
+            continue;
+        }
+        bValue = true;
+        switch (pDatum->tag) {
+            case BACNET_APPLICATION_TAG_NULL:
+                pRecord->ucRecType = TL_TYPE_NULL;
+                break;
+            case BACNET_APPLICATION_TAG_BOOLEAN:
+                pRecord->ucRecType = TL_TYPE_BOOL;
+                pRecord->Datum.ucBoolean = pDatum->type.Boolean;
+                break;
+            case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+                pRecord->ucRecType = TL_TYPE_UNSIGN;
+                pRecord->Datum.ulUValue = pDatum->type.Unsigned_Int;
+                break;
+            case BACNET_APPLICATION_TAG_SIGNED_INT:
+                pRecord->ucRecType = TL_TYPE_SIGN;
+                pRecord->Datum.lSValue = pDatum->type.Signed_Int;
+                break;
+            case BACNET_APPLICATION_TAG_REAL:
+                pRecord->ucRecType = TL_TYPE_REAL;
+                pRecord->Datum.fReal = pDatum->type.Real;
+                break;
+            case BACNET_APPLICATION_TAG_BIT_STRING:
+                pRecord->ucRecType = TL_TYPE_BITS;
+                TL_Bits_Store(&pRecord->Datum.Bits, &pDatum->type.Bit_String);
+                break;
+            case BACNET_APPLICATION_TAG_ENUMERATED:
+                pRecord->ucRecType = TL_TYPE_ENUM;
+                pRecord->Datum.ulEnum = pDatum->type.Enumerated;
+                break;
+            default:
+                /* let ReadProperty handle the other datatypes */
+                bValue = false;
+                break;
+        }
+    }
+
+    return bValue && bStatus;
+}
+
 /**
  * @brief Attempt to fetch the logged property and store it in the Trend Log
  * @param iLog - Index of the log to fetch the property for.
@@ -1595,7 +2125,6 @@ static void TL_fetch_property(int iLog)
     BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
     BACNET_ERROR_CODE error_code = ERROR_CODE_OTHER;
     int iLen;
-    uint8_t ucCount;
     TL_LOG_INFO *CurrentLog;
     TL_DATA_REC TempRec;
     uint8_t tag_number = 0;
@@ -1611,6 +2140,11 @@ static void TL_fetch_property(int iLog)
     CurrentLog->tLastDataTime = TempRec.tTimeStamp;
     TempRec.ucStatus = 0;
 
+    if (TL_fetch_value_list(&CurrentLog->Source, &TempRec)) {
+        /* sampled straight from the object */
+        TL_Insert_Record(iLog, &TempRec);
+        return;
+    }
     iLen = local_read_property(
         ValueBuf, StatusBuf, &LogInfo[iLog].Source, &error_class, &error_code);
     if (iLen < 0) {
@@ -1654,28 +2188,7 @@ static void TL_fetch_property(int iLog)
             case BACNET_APPLICATION_TAG_BIT_STRING:
                 TempRec.ucRecType = TL_TYPE_BITS;
                 decode_bitstring(&ValueBuf[iLen], len_value_type, &TempBits);
-                /* We truncate any bitstrings at 32 bits to conserve space */
-                if (bitstring_bits_used(&TempBits) < 32) {
-                    /* Store the bytes used and the bits free
-                       in the last byte */
-                    TempRec.Datum.Bits.ucLen = bitstring_bytes_used(&TempBits)
-                        << 4;
-                    TempRec.Datum.Bits.ucLen |=
-                        (8 - (bitstring_bits_used(&TempBits) % 8)) & 7;
-                    /* Fetch the octets with the bits directly */
-                    for (ucCount = 0; ucCount < bitstring_bytes_used(&TempBits);
-                         ucCount++) {
-                        TempRec.Datum.Bits.ucStore[ucCount] =
-                            bitstring_octet(&TempBits, ucCount);
-                    }
-                } else {
-                    /* We will only use the first 4 octets to save space */
-                    TempRec.Datum.Bits.ucLen = 4 << 4;
-                    for (ucCount = 0; ucCount < 4; ucCount++) {
-                        TempRec.Datum.Bits.ucStore[ucCount] =
-                            bitstring_octet(&TempBits, ucCount);
-                    }
-                }
+                TL_Bits_Store(&TempRec.Datum.Bits, &TempBits);
                 break;
 
             case BACNET_APPLICATION_TAG_ENUMERATED:
@@ -1698,15 +2211,33 @@ static void TL_fetch_property(int iLog)
         TempRec.ucStatus = 128 | bitstring_octet(&TempBits, 0);
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
+    TL_Insert_Record(iLog, &TempRec);
+}
 
-    CurrentLog->ulTotalRecordCount++;
+/**
+ * @brief Report that the change-of-value condition of a local object
+ *  tripped, so the COV logs of the object take a reading on the next
+ *  timer tick, in place of sampling on an interval.
+ * @note This is a cov_object_changed_callback, to be chained with
+ *  handler_cov_object_changed() from the Change_Of_Value callback
+ *  of the objects.
+ * @param object_type - the object type that changed
+ * @param object_instance - the object instance that changed
+ */
+void Trend_Log_Object_Changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    TL_LOG_INFO *CurrentLog = NULL;
+    int iCount = 0;
 
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
+    for (iCount = 0; iCount < MAX_TREND_LOGS; iCount++) {
+        CurrentLog = &LogInfo[iCount];
+        if ((CurrentLog->LoggingType == LOGGING_TYPE_COV) &&
+            (CurrentLog->Source.objectIdentifier.type == object_type) &&
+            (CurrentLog->Source.objectIdentifier.instance ==
+             object_instance)) {
+            CurrentLog->bChanged = true;
+        }
     }
 }
 
@@ -1780,6 +2311,14 @@ void trend_log_timer(uint16_t uSeconds)
                     TL_fetch_property(iCount);
                     CurrentLog->bTrigger = false;
                 }
+            } else if (CurrentLog->LoggingType == LOGGING_TYPE_COV) {
+                /* COV logs take a reading only when the logged object
+                 * reported a change of value since the last reading
+                 */
+                if (CurrentLog->bChanged == true) {
+                    TL_fetch_property(iCount);
+                    CurrentLog->bChanged = false;
+                }
             }
         }
     }
@@ -17,6 +17,7 @@
 #include "bacnet/readrange.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/sys/memusage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,7 +68,18 @@ typedef struct tl_data_record {
 #define TL_T_START_WILD 1 /* Start time is wild carded */
 #define TL_T_STOP_WILD 2 /* Stop Time is wild carded */
 
+#ifndef TL_MAX_ENTRIES
 #define TL_MAX_ENTRIES 1000 /* Entries per datalog */
+#endif
+
+/* Ring state kept with a log buffer supplied by the application, so that
+ * a log buffer in persistent memory survives a restart */
+typedef struct tl_log_buffer_state {
+    uint32_t ulBufferSize; /* Number of records in the buffer */
+    uint32_t ulRecordCount; /* Count of items currently in the buffer */
+    uint32_t ulTotalRecordCount; /* Count of all items ever inserted */
+    uint32_t ulIndex; /* Current insertion point */
+} TL_LOG_BUFFER_STATE;
 
 /* Structure containing config and status info for a Trend Log */
 
@@ -90,8 +102,12 @@ typedef struct tl_log_info {
     /* Offset from start of period for taking reading in seconds */
     uint32_t ulIntervalOffset;
     bool bTrigger; /* Set to 1 to cause a reading to be taken */
+    bool bChanged; /* The logged object reported a change of value */
     int iIndex; /* Current insertion point */
     bacnet_time_t tLastDataTime;
+    TL_DATA_REC *pRecords; /* Ring buffer of the records */
+    uint32_t ulBufferSize; /* Number of records the ring buffer holds */
+    TL_LOG_BUFFER_STATE *pState; /* Optional copy of the ring state */
 } TL_LOG_INFO;
 
 /*
@@ -129,6 +145,15 @@ unsigned Trend_Log_Instance_To_Index(uint32_t instance);
 BACNET_STACK_EXPORT
 bool Trend_Log_Object_Instance_Add(uint32_t instance);
 
+BACNET_STACK_EXPORT
+bool Trend_Log_Buffer_Set(
+    uint32_t object_instance,
+    TL_DATA_REC *pRecords,
+    uint32_t ulBufferSize,
+    TL_LOG_BUFFER_STATE *pState);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance);
+
 BACNET_STACK_EXPORT
 bool Trend_Log_Object_Name(
     uint32_t object_instance, BACNET_CHARACTER_STRING *object_name);
@@ -140,6 +165,12 @@ BACNET_STACK_EXPORT
 bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
 BACNET_STACK_EXPORT
 void Trend_Log_Init(void);
+BACNET_STACK_EXPORT
+void Trend_Log_Memory_Usage(BACNET_MEMORY_USAGE *usage);
+
+BACNET_STACK_EXPORT
+void Trend_Log_Object_Changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
 
 BACNET_STACK_EXPORT
 void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState);
@@ -0,0 +1,501 @@
+/**
+ * @file
+ * @brief Compressed blocks of Trend Log records.
+ *
+ * Each record is packed against the record before it:
+ * - the time stamp as the change of the time between records, which is
+ *   one bit for a log with a steady interval,
+ * - the record type and the status flags as one bit when they repeat,
+ *   or else as 4 bits of type and 1 or 5 bits of status,
+ * - the value bits as the XOR with the value of the record before it,
+ *   coded as the leading zero count, the length, and the meaningful bits.
+ *
+ * The block keeps the state after its last record, so records are only
+ * appended, and readers walk the records from the start of the block.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* me! */
+#include "bacnet/basic/object/trendlog_block.h"
+
+#define TL_BLOCK_BITS (TL_BLOCK_BYTES * 8U)
+
+/**
+ * @brief Write bits to the packed data, most significant bit first
+ * @param pData - packed data
+ * @param pBit - next bit to write, which is advanced
+ * @param ulValue - the bits, in the low bits of the value
+ * @param ucBits - number of bits to write, 0..32
+ * @return false if the bits do not fit in the block
+ */
+static bool TL_Block_Bits_Write(
+    uint8_t *pData, uint16_t *pBit, uint32_t ulValue, uint8_t ucBits)
+{
+    uint32_t bit = *pBit;
+    uint8_t mask;
+
+    if ((bit + ucBits) > TL_BLOCK_BITS) {
+        return false;
+    }
+    while (ucBits > 0) {
+        ucBits--;
+        mask = (uint8_t)(0x80U >> (bit & 7U));
+        if ((ulValue >> ucBits) & 1U) {
+            pData[bit >> 3] |= mask;
+        } else {
+            pData[bit >> 3] &= (uint8_t)~mask;
+        }
+        bit++;
+    }
+    *pBit = (uint16_t)bit;
+
+    return true;
+}
+
+/**
+ * @brief Read bits from the packed data, most significant bit first
+ * @param pData - packed data
+ * @param pBit - next bit to read, which is advanced
+ * @param ucBits - number of bits to read, 0..32
+ * @return the bits, in the low bits of the value
+ */
+static uint32_t
+TL_Block_Bits_Read(const uint8_t *pData, uint16_t *pBit, uint8_t ucBits)
+{
+    uint32_t bit = *pBit;
+    uint32_t ulValue = 0;
+
+    while ((ucBits > 0) && (bit < TL_BLOCK_BITS)) {
+        ucBits--;
+        ulValue = (ulValue << 1) |
+            ((pData[bit >> 3] >> (7U - (bit & 7U))) & 1U);
+        bit++;
+    }
+    *pBit = (uint16_t)bit;
+
+    return ulValue;
+}
+
+/**
+ * @brief Get the value bits of a record whose datum is one 32-bit word
+ * @param pRecord - the record
+ * @param pValue - the value bits
+ * @return true if the datum of the record type is one word
+ */
+static bool TL_Block_Word(const TL_DATA_REC *pRecord, uint32_t *pValue)
+{
+    switch (pRecord->ucRecType) {
+        case TL_TYPE_STATUS:
+            *pValue = pRecord->Datum.ucLogStatus;
+            break;
+        case TL_TYPE_BOOL:
+            *pValue = pRecord->Datum.ucBoolean;
+            break;
+        case TL_TYPE_REAL:
+            memcpy(pValue, &pRecord->Datum.fReal, sizeof(*pValue));
+            break;
+        case TL_TYPE_DELTA:
+            memcpy(pValue, &pRecord->Datum.fTime, sizeof(*pValue));
+            break;
+        case TL_TYPE_ENUM:
+            *pValue = pRecord->Datum.ulEnum;
+            break;
+        case TL_TYPE_UNSIGN:
+            *pValue = pRecord->Datum.ulUValue;
+            break;
+        case TL_TYPE_SIGN:
+            *pValue = (uint32_t)pRecord->Datum.lSValue;
+            break;
+        case TL_TYPE_ERROR:
+            *pValue = ((uint32_t)pRecord->Datum.Error.usClass << 16) |
+                pRecord->Datum.Error.usCode;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Set the datum of a record whose datum is one 32-bit word
+ * @param pRecord - the record, with its type set
+ * @param ulValue - the value bits
+ */
+static void TL_Block_Word_Set(TL_DATA_REC *pRecord, uint32_t ulValue)
+{
+    switch (pRecord->ucRecType) {
+        case TL_TYPE_STATUS:
+            pRecord->Datum.ucLogStatus = (uint8_t)ulValue;
+            break;
+        case TL_TYPE_BOOL:
+            pRecord->Datum.ucBoolean = (uint8_t)ulValue;
+            break;
+        case TL_TYPE_REAL:
+            memcpy(&pRecord->Datum.fReal, &ulValue, sizeof(ulValue));
+            break;
+        case TL_TYPE_DELTA:
+            memcpy(&pRecord->Datum.fTime, &ulValue, sizeof(ulValue));
+            break;
+        case TL_TYPE_ENUM:
+            pRecord->Datum.ulEnum = ulValue;
+            break;
+        case TL_TYPE_UNSIGN:
+            pRecord->Datum.ulUValue = ulValue;
+            break;
+        case TL_TYPE_SIGN:
+            pRecord->Datum.lSValue = (int32_t)ulValue;
+            break;
+        case TL_TYPE_ERROR:
+            pRecord->Datum.Error.usClass = (uint16_t)(ulValue >> 16);
+            pRecord->Datum.Error.usCode = (uint16_t)(ulValue & 0xFFFFU);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Pack the status of a record: bit 7 when the status is used, and
+ *  the 4 status flags, which are all that the ReadRange encoding uses
+ * @param ucStatus - status of the record
+ * @return the packed status
+ */
+static uint8_t TL_Block_Status(uint8_t ucStatus)
+{
+    if (ucStatus & 0x80U) {
+        return (uint8_t)(0x80U | (ucStatus & 0x0FU));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Empty a block
+ * @param pBlock - the block
+ */
+void TL_Block_Init(TL_BLOCK *pBlock)
+{
+    if (pBlock) {
+        memset(pBlock, 0, sizeof(*pBlock));
+    }
+}
+
+/**
+ * @brief Pack the time stamp of a record
+ * @param pBlock - the block
+ * @param pState - coding state, which is advanced
+ * @param tTimeStamp - time stamp of the record
+ * @return false if the record does not fit
+ */
+static bool TL_Block_Time_Write(
+    TL_BLOCK *pBlock, TL_BLOCK_STATE *pState, bacnet_time_t tTimeStamp)
+{
+    int64_t llDelta;
+    int64_t llChange;
+    uint32_t ulBits;
+
+    if (pState->usRecord == 0) {
+        pBlock->tFirst = tTimeStamp;
+        pState->tTimeStamp = tTimeStamp;
+        pState->lDelta = 0;
+        return true;
+    }
+    if (tTimeStamp >= pState->tTimeStamp) {
+        llDelta = (int64_t)(tTimeStamp - pState->tTimeStamp);
+    } else {
+        llDelta = -(int64_t)(pState->tTimeStamp - tTimeStamp);
+    }
+    if ((llDelta > INT32_MAX) || (llDelta < INT32_MIN)) {
+        return false;
+    }
+    llChange = llDelta - pState->lDelta;
+    if ((llChange > INT32_MAX) || (llChange < INT32_MIN)) {
+        return false;
+    }
+    if (llChange == 0) {
+        if (!TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, 0, 1)) {
+            return false;
+        }
+    } else if ((llChange >= -63) && (llChange <= 64)) {
+        ulBits = (0x2U << 7) | (uint32_t)(llChange + 63);
+        if (!TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, ulBits, 9)) {
+            return false;
+        }
+    } else if ((llChange >= -2047) && (llChange <= 2048)) {
+        ulBits = (0x6U << 12) | (uint32_t)(llChange + 2047);
+        if (!TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, ulBits, 15)) {
+            return false;
+        }
+    } else if ((llChange >= -524287) && (llChange <= 524288)) {
+        ulBits = (0xEU << 20) | (uint32_t)(llChange + 524287);
+        if (!TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, ulBits, 24)) {
+            return false;
+        }
+    } else {
+        if (!TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, 0xF, 4) ||
+            !TL_Block_Bits_Write(
+                pBlock->ucData, &pState->usBit, (uint32_t)(int32_t)llChange,
+                32)) {
+            return false;
+        }
+    }
+    pState->tTimeStamp = tTimeStamp;
+    pState->lDelta = (int32_t)llDelta;
+
+    return true;
+}
+
+/**
+ * @brief Pack the value bits of a record as the XOR with the value bits
+ *  of the record before it
+ * @param pBlock - the block
+ * @param pState - coding state, which is advanced
+ * @param ulValue - value bits of the record
+ * @return false if the record does not fit
+ */
+static bool
+TL_Block_Word_Write(TL_BLOCK *pBlock, TL_BLOCK_STATE *pState, uint32_t ulValue)
+{
+    uint32_t ulXor = ulValue ^ pState->ulValue;
+    uint8_t ucLead = 0;
+    uint8_t ucTrail = 0;
+    uint8_t ucLen;
+
+    if (ulXor == 0) {
+        return TL_Block_Bits_Write(pBlock->ucData, &pState->usBit, 0, 1);
+    }
+    while (!(ulXor & (0x80000000UL >> ucLead))) {
+        ucLead++;
+    }
+    while (!(ulXor & (1UL << ucTrail))) {
+        ucTrail++;
+    }
+    ucLen = (uint8_t)(32 - ucLead - ucTrail);
+
+    return TL_Block_Bits_Write(
+               pBlock->ucData, &pState->usBit,
+               (1UL << 10) | ((uint32_t)ucLead << 5) | (ucLen - 1U), 11) &&
+        TL_Block_Bits_Write(
+               pBlock->ucData, &pState->usBit, ulXor >> ucTrail, ucLen);
+}
+
+/**
+ * @brief Append a record to a block
+ * @param pBlock - the block
+ * @param pRecord - the record
+ * @return false if the record does not fit in the block, which is then
+ *  left as it was
+ */
+bool TL_Block_Append(TL_BLOCK *pBlock, const TL_DATA_REC *pRecord)
+{
+    TL_BLOCK_STATE State;
+    uint8_t ucStatus;
+    uint8_t ucBytes;
+    uint8_t i;
+    uint32_t ulValue = 0;
+    bool status = true;
+
+    if (!pBlock || !pRecord || (pRecord->ucRecType > 0x0F) ||
+        (pBlock->Last.usRecord == UINT16_MAX)) {
+        return false;
+    }
+    State = pBlock->Last;
+    status = TL_Block_Time_Write(pBlock, &State, pRecord->tTimeStamp);
+    ucStatus = TL_Block_Status(pRecord->ucStatus);
+    if (status && (State.usRecord > 0) &&
+        (pRecord->ucRecType == State.ucRecType) &&
+        (ucStatus == State.ucStatus)) {
+        status = TL_Block_Bits_Write(pBlock->ucData, &State.usBit, 0, 1);
+    } else if (status) {
+        if (pRecord->ucRecType != State.ucRecType) {
+            /* values of another type are coded against zero */
+            State.ulValue = 0;
+        }
+        status = TL_Block_Bits_Write(
+            pBlock->ucData, &State.usBit,
+            0x20U | ((uint32_t)pRecord->ucRecType << 1) | (ucStatus >> 7), 6);
+        if (status && ucStatus) {
+            status = TL_Block_Bits_Write(
+                pBlock->ucData, &State.usBit, ucStatus & 0x0FU, 4);
+        }
+        State.ucRecType = pRecord->ucRecType;
+        State.ucStatus = ucStatus;
+    }
+    if (status && TL_Block_Word(pRecord, &ulValue)) {
+        status = TL_Block_Word_Write(pBlock, &State, ulValue);
+        State.ulValue = ulValue;
+    } else if (status && (pRecord->ucRecType == TL_TYPE_BITS)) {
+        ucBytes = (pRecord->Datum.Bits.ucLen >> 4) & 0x0F;
+        if (ucBytes > sizeof(pRecord->Datum.Bits.ucStore)) {
+            return false;
+        }
+        status = TL_Block_Bits_Write(
+            pBlock->ucData, &State.usBit, pRecord->Datum.Bits.ucLen, 8);
+        for (i = 0; status && (i < ucBytes); i++) {
+            status = TL_Block_Bits_Write(
+                pBlock->ucData, &State.usBit,
+                pRecord->Datum.Bits.ucStore[i], 8);
+        }
+        State.ulValue = 0;
+    }
+    if (!status) {
+        return false;
+    }
+    State.usRecord++;
+    pBlock->Last = State;
+
+    return true;
+}
+
+/**
+ * @brief Determine if a block might not take another record
+ * @param pBlock - the block
+ * @return true if the next record might not fit
+ */
+bool TL_Block_Full(const TL_BLOCK *pBlock)
+{
+    if (!pBlock) {
+        return true;
+    }
+
+    return (pBlock->Last.usBit + TL_BLOCK_RECORD_BITS_MAX) > TL_BLOCK_BITS;
+}
+
+/**
+ * @brief Get the number of records in a block
+ * @param pBlock - the block
+ * @return number of records
+ */
+uint16_t TL_Block_Count(const TL_BLOCK *pBlock)
+{
+    if (!pBlock) {
+        return 0;
+    }
+
+    return pBlock->Last.usRecord;
+}
+
+/**
+ * @brief Start a walk of the records of a block
+ * @param pBlock - the block
+ * @param pState - state of the walk
+ */
+void TL_Block_Start(const TL_BLOCK *pBlock, TL_BLOCK_STATE *pState)
+{
+    if (pState) {
+        memset(pState, 0, sizeof(*pState));
+        if (pBlock) {
+            pState->tTimeStamp = pBlock->tFirst;
+        }
+    }
+}
+
+/**
+ * @brief Unpack the time stamp of the next record
+ * @param pBlock - the block
+ * @param pState - state of the walk, which is advanced
+ */
+static void TL_Block_Time_Read(const TL_BLOCK *pBlock, TL_BLOCK_STATE *pState)
+{
+    int32_t lChange = 0;
+
+    if (pState->usRecord == 0) {
+        pState->tTimeStamp = pBlock->tFirst;
+        pState->lDelta = 0;
+        return;
+    }
+    if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1) == 0) {
+        lChange = 0;
+    } else if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1) == 0) {
+        lChange =
+            (int32_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 7) -
+            63;
+    } else if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1) == 0) {
+        lChange =
+            (int32_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 12) -
+            2047;
+    } else if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1) == 0) {
+        lChange =
+            (int32_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 20) -
+            524287;
+    } else {
+        lChange =
+            (int32_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 32);
+    }
+    pState->lDelta = (int32_t)((int64_t)pState->lDelta + lChange);
+    if (pState->lDelta >= 0) {
+        pState->tTimeStamp += (bacnet_time_t)pState->lDelta;
+    } else {
+        pState->tTimeStamp -= (bacnet_time_t)(-(int64_t)pState->lDelta);
+    }
+}
+
+/**
+ * @brief Unpack the next record of a block
+ * @param pBlock - the block
+ * @param pState - state of the walk, which is advanced
+ * @param pRecord - the record
+ * @return false if there are no more records
+ */
+bool TL_Block_Next(
+    const TL_BLOCK *pBlock, TL_BLOCK_STATE *pState, TL_DATA_REC *pRecord)
+{
+    uint32_t ulLead;
+    uint32_t ulLen;
+    uint32_t ulValue;
+    uint8_t ucBytes;
+    uint8_t i;
+
+    if (!pBlock || !pState || !pRecord ||
+        (pState->usRecord >= pBlock->Last.usRecord)) {
+        return false;
+    }
+    TL_Block_Time_Read(pBlock, pState);
+    if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1)) {
+        ulValue = TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 5);
+        if ((ulValue >> 1) != pState->ucRecType) {
+            pState->ulValue = 0;
+        }
+        pState->ucRecType = (uint8_t)(ulValue >> 1);
+        pState->ucStatus = 0;
+        if (ulValue & 1U) {
+            pState->ucStatus = (uint8_t)(0x80U |
+                TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 4));
+        }
+    }
+    memset(pRecord, 0, sizeof(*pRecord));
+    pRecord->tTimeStamp = pState->tTimeStamp;
+    pRecord->ucRecType = pState->ucRecType;
+    pRecord->ucStatus = pState->ucStatus;
+    if (TL_Block_Word(pRecord, &ulValue)) {
+        if (TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 1)) {
+            ulLead = TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 5);
+            ulLen = TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 5) + 1;
+            ulValue = TL_Block_Bits_Read(
+                pBlock->ucData, &pState->usBit, (uint8_t)ulLen);
+            if ((ulLead + ulLen) < 32) {
+                ulValue <<= (32 - ulLead - ulLen);
+            }
+            pState->ulValue ^= ulValue;
+        }
+        TL_Block_Word_Set(pRecord, pState->ulValue);
+    } else if (pRecord->ucRecType == TL_TYPE_BITS) {
+        pRecord->Datum.Bits.ucLen =
+            (uint8_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 8);
+        ucBytes = (pRecord->Datum.Bits.ucLen >> 4) & 0x0F;
+        for (i = 0; (i < ucBytes) && (i < sizeof(pRecord->Datum.Bits.ucStore));
+             i++) {
+            pRecord->Datum.Bits.ucStore[i] =
+                (uint8_t)TL_Block_Bits_Read(pBlock->ucData, &pState->usBit, 8);
+        }
+        pState->ulValue = 0;
+    }
+    pState->usRecord++;
+
+    return true;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief Compressed blocks of Trend Log records, with delta-of-delta time
+ *  stamps, XOR coded values, and bit-packed record types and status flags
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_OBJECT_TRENDLOG_BLOCK_H
+#define BACNET_BASIC_OBJECT_TRENDLOG_BLOCK_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/datetime.h"
+#include "bacnet/basic/object/trendlog.h"
+
+/* bytes of packed records in a block */
+#ifndef TL_BLOCK_BYTES
+#define TL_BLOCK_BYTES 120
+#endif
+
+/* most bits that one packed record takes */
+#define TL_BLOCK_RECORD_BITS_MAX 89
+
+/* Coding state after the last record, which the next record is coded
+ * against.  The block keeps it to append records, and readers keep
+ * their own copy to walk the records. */
+typedef struct tl_block_state {
+    uint16_t usRecord; /* records coded so far */
+    uint16_t usBit; /* bits coded so far */
+    bacnet_time_t tTimeStamp; /* time stamp of the last record */
+    int32_t lDelta; /* time between the last two records */
+    uint32_t ulValue; /* value bits of the last record */
+    uint8_t ucRecType; /* type of the last record */
+    uint8_t ucStatus; /* status of the last record */
+} TL_BLOCK_STATE;
+
+typedef struct tl_block {
+    bacnet_time_t tFirst; /* time stamp of the first record */
+    TL_BLOCK_STATE Last; /* state after the last record */
+    uint8_t ucData[TL_BLOCK_BYTES];
+} TL_BLOCK;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void TL_Block_Init(TL_BLOCK *pBlock);
+BACNET_STACK_EXPORT
+bool TL_Block_Append(TL_BLOCK *pBlock, const TL_DATA_REC *pRecord);
+BACNET_STACK_EXPORT
+bool TL_Block_Full(const TL_BLOCK *pBlock);
+BACNET_STACK_EXPORT
+uint16_t TL_Block_Count(const TL_BLOCK *pBlock);
+
+BACNET_STACK_EXPORT
+void TL_Block_Start(const TL_BLOCK *pBlock, TL_BLOCK_STATE *pState);
+BACNET_STACK_EXPORT
+bool TL_Block_Next(
+    const TL_BLOCK *pBlock, TL_BLOCK_STATE *pState, TL_DATA_REC *pRecord);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,757 @@
+/**
+ * @file
+ * @brief Table driven engine for the value objects, which have a single
+ *  primitive present-value, status-flags, out-of-service, units, and
+ *  COV-increment.  The storage, the COV detection, and the ReadProperty
+ *  and WriteProperty handlers live here once, and each object type
+ *  gives a VALUE_OBJECT_CLASS descriptor.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacapp.h"
+#include "bacnet/proplist.h"
+/* basic objects and services */
+#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
+/* me! */
+#include "bacnet/basic/object/value_object.h"
+
+/**
+ * @brief Initializes the list of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ */
+void Value_Object_Init(VALUE_OBJECT_LIST *objects)
+{
+    if (objects && !objects->List) {
+        objects->List = Keylist_Create();
+    }
+}
+
+/**
+ * @brief Deletes all the instances of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ */
+void Value_Object_Cleanup(VALUE_OBJECT_LIST *objects)
+{
+    VALUE_OBJECT *pObject;
+
+    if (!objects || !objects->List) {
+        return;
+    }
+    do {
+        pObject = Keylist_Data_Pop(objects->List);
+        if (pObject) {
+            BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+        }
+    } while (pObject);
+    Keylist_Delete(objects->List);
+    objects->List = NULL;
+}
+
+/**
+ * @brief Creates an instance of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object,
+ *  or BACNET_MAX_INSTANCE for the next free instance
+ * @return the object-instance that was created, or BACNET_MAX_INSTANCE
+ */
+uint32_t
+Value_Object_Create(VALUE_OBJECT_LIST *objects, uint32_t object_instance)
+{
+    VALUE_OBJECT *pObject;
+    int index;
+
+    if (!objects || !objects->Class) {
+        return BACNET_MAX_INSTANCE;
+    }
+    Value_Object_Init(objects);
+    if (object_instance > BACNET_MAX_INSTANCE) {
+        return BACNET_MAX_INSTANCE;
+    } else if (object_instance == BACNET_MAX_INSTANCE) {
+        /* wildcard instance */
+        /* the Object_Identifier property of the newly created object
+            shall be initialized to a value that is unique within the
+            responding BACnet-user device. The method used to generate
+            the object identifier is a local matter.*/
+        object_instance = Keylist_Next_Empty_Key(objects->List, 1);
+    }
+    pObject = Keylist_Data(objects->List, object_instance);
+    if (pObject) {
+        return object_instance;
+    }
+    pObject = BACNET_MEMPOOL_CALLOC(sizeof(VALUE_OBJECT));
+    if (!pObject) {
+        return BACNET_MAX_INSTANCE;
+    }
+    index = Keylist_Data_Add(objects->List, object_instance, pObject);
+    if (index < 0) {
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+        return BACNET_MAX_INSTANCE;
+    }
+    pObject->Units = objects->Class->Units;
+    pObject->COV_Increment = objects->Class->COV_Increment;
+
+    return object_instance;
+}
+
+/**
+ * @brief Deletes an instance of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @return true if the object-instance was deleted
+ */
+bool Value_Object_Delete(VALUE_OBJECT_LIST *objects, uint32_t object_instance)
+{
+    VALUE_OBJECT *pObject;
+
+    if (!objects) {
+        return false;
+    }
+    pObject = Keylist_Data_Delete(objects->List, object_instance);
+    if (pObject) {
+        BACNET_MEMPOOL_FREE(pObject, sizeof(*pObject));
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets an object from the list using an instance number as the key
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @return object found in the list, or NULL if not found
+ */
+VALUE_OBJECT *
+Value_Object_Data(const VALUE_OBJECT_LIST *objects, uint32_t object_instance)
+{
+    if (!objects) {
+        return NULL;
+    }
+
+    return Keylist_Data(objects->List, object_instance);
+}
+
+/**
+ * @brief Determines the number of instances of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ * @return number of instances
+ */
+unsigned Value_Object_Count(const VALUE_OBJECT_LIST *objects)
+{
+    if (!objects) {
+        return 0;
+    }
+
+    return (unsigned)Keylist_Count(objects->List);
+}
+
+/**
+ * @brief Determines the object instance-number for a given 0..N index
+ * @param objects - the instances of the object type, with its descriptor
+ * @param index - 0..N index of the object
+ * @return object instance-number for the given index, or UINT32_MAX
+ */
+uint32_t Value_Object_Index_To_Instance(
+    const VALUE_OBJECT_LIST *objects, unsigned index)
+{
+    KEY key = UINT32_MAX;
+
+    if (objects) {
+        Keylist_Index_Key(objects->List, index, &key);
+    }
+
+    return key;
+}
+
+/**
+ * @brief Determines the 0..N index for a given object instance-number
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @return index for the given instance-number, or the count if not valid
+ */
+unsigned Value_Object_Instance_To_Index(
+    const VALUE_OBJECT_LIST *objects, uint32_t object_instance)
+{
+    if (!objects) {
+        return 0;
+    }
+
+    return (unsigned)Keylist_Index(objects->List, object_instance);
+}
+
+/**
+ * @brief Loads the object-name into a characterstring, using the name
+ *  prefix of the object type when the object has no name of its own
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @param object_name - holds the object-name retrieved
+ * @return true if object-name was retrieved
+ */
+bool Value_Object_Name(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    BACNET_CHARACTER_STRING *object_name)
+{
+    char text[32] = "";
+    VALUE_OBJECT *pObject;
+
+    pObject = Value_Object_Data(objects, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    if (pObject->Object_Name) {
+        return characterstring_init_ansi(object_name, pObject->Object_Name);
+    }
+    snprintf(
+        text, sizeof(text), "%s%lu", objects->Class->Name_Prefix,
+        (unsigned long)object_instance);
+
+    return characterstring_init_ansi(object_name, text);
+}
+
+/**
+ * @brief Detects a change of value of the present-value, comparing the new
+ *  value against the prior value with the COV-increment as threshold for
+ *  the numeric types, and sets the COV flag of the object
+ * @param tag - application tag of the present-value
+ * @param pObject - object of the value
+ * @param value - new present-value
+ */
+static void Value_Object_COV_Detect(
+    BACNET_APPLICATION_TAG tag,
+    VALUE_OBJECT *pObject,
+    const VALUE_OBJECT_VALUE *value)
+{
+    const VALUE_OBJECT_VALUE *prior = &pObject->Prior_Value;
+    bool changed = false;
+
+    switch (tag) {
+        case BACNET_APPLICATION_TAG_REAL:
+            changed = !isless(
+                fabsf(prior->Real - value->Real), pObject->COV_Increment.Real);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            changed = (uint32_t)abs(prior->Signed_Int - value->Signed_Int) >=
+                pObject->COV_Increment.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            if (prior->Unsigned_Int > value->Unsigned_Int) {
+                changed = (prior->Unsigned_Int - value->Unsigned_Int) >=
+                    pObject->COV_Increment.Unsigned_Int;
+            } else {
+                changed = (value->Unsigned_Int - prior->Unsigned_Int) >=
+                    pObject->COV_Increment.Unsigned_Int;
+            }
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            changed = prior->Boolean != value->Boolean;
+            break;
+        default:
+            changed = prior->Enumerated != value->Enumerated;
+            break;
+    }
+    if (changed) {
+        pObject->Changed = true;
+        pObject->Prior_Value = *value;
+    }
+}
+
+/**
+ * @brief Sets the present-value of an object, and detects its change of
+ *  value
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @param value - new present-value, of the type of the descriptor
+ * @return true if the present-value was set
+ */
+bool Value_Object_Present_Value_Set(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    const VALUE_OBJECT_VALUE *value)
+{
+    VALUE_OBJECT *pObject;
+
+    pObject = Value_Object_Data(objects, object_instance);
+    if (!pObject || !value) {
+        return false;
+    }
+    Value_Object_COV_Detect(objects->Class->Value_Tag, pObject, value);
+    pObject->Present_Value = *value;
+
+    return true;
+}
+
+/**
+ * @brief Sets the COV-increment of an object, and detects the change of
+ *  value of the present-value against the new threshold
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @param value - new COV-increment, REAL for a REAL present-value and
+ *  Unsigned otherwise
+ * @return true if the COV-increment was set
+ */
+bool Value_Object_COV_Increment_Set(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    const VALUE_OBJECT_VALUE *value)
+{
+    VALUE_OBJECT *pObject;
+
+    pObject = Value_Object_Data(objects, object_instance);
+    if (!pObject || !value) {
+        return false;
+    }
+    pObject->COV_Increment = *value;
+    Value_Object_COV_Detect(
+        objects->Class->Value_Tag, pObject, &pObject->Present_Value);
+
+    return true;
+}
+
+/**
+ * @brief Loads the value_list with the COV data of an object
+ * @param objects - the instances of the object type, with its descriptor
+ * @param object_instance - object-instance number of the object
+ * @param value_list - list of COV data
+ * @return true if the value list is encoded
+ */
+bool Value_Object_Encode_Value_List(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE *value_list)
+{
+    const bool in_alarm = false;
+    const bool fault = false;
+    const bool overridden = false;
+    VALUE_OBJECT *pObject;
+    bool oos;
+
+    pObject = Value_Object_Data(objects, object_instance);
+    if (!pObject) {
+        return false;
+    }
+    oos = pObject->Out_Of_Service;
+    switch (objects->Class->Value_Tag) {
+        case BACNET_APPLICATION_TAG_REAL:
+            return cov_value_list_encode_real(
+                value_list, pObject->Present_Value.Real, in_alarm, fault,
+                overridden, oos);
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            return cov_value_list_encode_signed_int(
+                value_list, pObject->Present_Value.Signed_Int, in_alarm,
+                fault, overridden, oos);
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            return cov_value_list_encode_unsigned(
+                value_list, pObject->Present_Value.Unsigned_Int, in_alarm,
+                fault, overridden, oos);
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            return cov_value_list_encode_enumerated(
+                value_list, pObject->Present_Value.Enumerated, in_alarm,
+                fault, overridden, oos);
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Encodes a primitive value with its application tag
+ * @param apdu - buffer for the encoding
+ * @param tag - application tag of the value
+ * @param value - the value
+ * @return number of bytes encoded
+ */
+static int Value_Object_Value_Encode(
+    uint8_t *apdu, BACNET_APPLICATION_TAG tag, const VALUE_OBJECT_VALUE *value)
+{
+    switch (tag) {
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            return encode_application_boolean(apdu, value->Boolean);
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            return encode_application_unsigned(apdu, value->Unsigned_Int);
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            return encode_application_signed(apdu, value->Signed_Int);
+        case BACNET_APPLICATION_TAG_REAL:
+            return encode_application_real(apdu, value->Real);
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            return encode_application_enumerated(apdu, value->Enumerated);
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Determines the application tag of the COV-increment
+ * @param tag - application tag of the present-value
+ * @return application tag of the COV-increment
+ */
+static BACNET_APPLICATION_TAG
+Value_Object_COV_Increment_Tag(BACNET_APPLICATION_TAG tag)
+{
+    if (tag == BACNET_APPLICATION_TAG_REAL) {
+        return BACNET_APPLICATION_TAG_REAL;
+    }
+
+    return BACNET_APPLICATION_TAG_UNSIGNED_INT;
+}
+
+/**
+ * @brief Determines if a property is in the property lists of the
+ *  descriptor
+ * @param pClass - descriptor of the object type
+ * @param object_property - property to find
+ * @return true if the property is a member of the lists
+ */
+static bool Value_Object_Property_Member(
+    const VALUE_OBJECT_CLASS *pClass, BACNET_PROPERTY_ID object_property)
+{
+    return property_lists_member(
+        pClass->Properties_Required, pClass->Properties_Optional,
+        pClass->Properties_Proprietary, object_property);
+}
+
+/**
+ * @brief ReadProperty handler for a value object type.  For the given
+ *  ReadProperty data, the application_data is loaded or the error flags
+ *  are set.
+ * @param objects - the instances of the object type, with its descriptor
+ * @param rpdata - BACNET_READ_PROPERTY_DATA data, including
+ *  requested data and space for the reply, or error response.
+ * @return number of APDU bytes in the response, or
+ *  BACNET_STATUS_ERROR on error.
+ */
+int Value_Object_Read_Property(
+    const VALUE_OBJECT_LIST *objects, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int apdu_len = BACNET_STATUS_ERROR;
+    BACNET_BIT_STRING bit_string;
+    BACNET_CHARACTER_STRING char_string;
+    const VALUE_OBJECT_CLASS *pClass;
+    VALUE_OBJECT *pObject;
+    uint8_t *apdu;
+
+    if ((rpdata == NULL) || (rpdata->application_data == NULL) ||
+        (rpdata->application_data_len == 0)) {
+        return 0;
+    }
+    pObject = Value_Object_Data(objects, rpdata->object_instance);
+    if (!pObject) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    pClass = objects->Class;
+    apdu = rpdata->application_data;
+    switch (rpdata->object_property) {
+        case PROP_PRESENT_VALUE:
+            apdu_len = Value_Object_Value_Encode(
+                apdu, pClass->Value_Tag, &pObject->Present_Value);
+            break;
+        case PROP_STATUS_FLAGS:
+            bitstring_init(&bit_string);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM, false);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_FAULT, false);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_OVERRIDDEN, false);
+            bitstring_set_bit(
+                &bit_string, STATUS_FLAG_OUT_OF_SERVICE,
+                pObject->Out_Of_Service);
+            apdu_len = encode_application_bitstring(apdu, &bit_string);
+            break;
+        case PROP_OBJECT_IDENTIFIER:
+            apdu_len = encode_application_object_id(
+                apdu, pClass->Object_Type, rpdata->object_instance);
+            break;
+        case PROP_OBJECT_NAME:
+            Value_Object_Name(objects, rpdata->object_instance, &char_string);
+            apdu_len = encode_application_character_string(apdu, &char_string);
+            break;
+        case PROP_OBJECT_TYPE:
+            apdu_len = encode_application_enumerated(apdu, pClass->Object_Type);
+            break;
+        default:
+            if (!Value_Object_Property_Member(
+                    pClass, rpdata->object_property)) {
+                break;
+            }
+            switch (rpdata->object_property) {
+                case PROP_DESCRIPTION:
+                    characterstring_init_ansi(
+                        &char_string,
+                        pObject->Description ? pObject->Description : "");
+                    apdu_len =
+                        encode_application_character_string(apdu, &char_string);
+                    break;
+                case PROP_OUT_OF_SERVICE:
+                    apdu_len = encode_application_boolean(
+                        apdu, pObject->Out_Of_Service);
+                    break;
+                case PROP_UNITS:
+                    apdu_len = encode_application_enumerated(
+                        apdu, (uint32_t)pObject->Units);
+                    break;
+                case PROP_COV_INCREMENT:
+                    apdu_len = Value_Object_Value_Encode(
+                        apdu, Value_Object_COV_Increment_Tag(pClass->Value_Tag),
+                        &pObject->COV_Increment);
+                    break;
+                default:
+                    break;
+            }
+            break;
+    }
+    if (apdu_len == BACNET_STATUS_ERROR) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decodes the value of a WriteProperty request, through the
+ *  primitive decode when the value is a primitive, and else through the
+ *  generic decode for the tag that is checked against the property
+ * @param wp_data - WriteProperty request, with space for the error
+ * @param value - the decoded value and its tag
+ * @return true if the value was decoded
+ */
+static bool Value_Object_Write_Decode(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    BACNET_WRITE_PROPERTY_PRIMITIVE *value)
+{
+    BACNET_APPLICATION_DATA_VALUE generic = { 0 };
+    int len;
+
+    if (write_property_primitive_decode(wp_data, value)) {
+        return true;
+    }
+    len = bacapp_decode_application_data(
+        wp_data->application_data, wp_data->application_data_len, &generic);
+    if (len < 0) {
+        /* error while decoding - a value larger than we can handle */
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+        return false;
+    }
+    value->tag = generic.tag;
+    switch (generic.tag) {
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            value->type.Boolean = generic.type.Boolean;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            value->type.Unsigned_Int = generic.type.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            value->type.Signed_Int = generic.type.Signed_Int;
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            value->type.Real = generic.type.Real;
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            value->type.Enumerated = generic.type.Enumerated;
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks the tag of a written value
+ * @param wp_data - WriteProperty request, with space for the error
+ * @param value - the decoded value
+ * @param tag - expected application tag
+ * @return true if the value has the expected tag
+ */
+static bool Value_Object_Write_Tag_Valid(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value,
+    BACNET_APPLICATION_TAG tag)
+{
+    if (value->tag != tag) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_INVALID_DATA_TYPE;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Copies a decoded WriteProperty value into the typed storage
+ * @param value - the decoded value
+ * @param data - the typed storage
+ * @return true if the value fits the storage of its tag
+ */
+static bool Value_Object_Write_Value(
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value, VALUE_OBJECT_VALUE *data)
+{
+    switch (value->tag) {
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            data->Boolean = value->type.Boolean;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            if (value->type.Unsigned_Int > UINT32_MAX) {
+                return false;
+            }
+            data->Unsigned_Int = (uint32_t)value->type.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            data->Signed_Int = value->type.Signed_Int;
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            data->Real = value->type.Real;
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            data->Enumerated = value->type.Enumerated;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief WriteProperty handler for a value object type.  For the given
+ *  WriteProperty data, the application_data is loaded or the error flags
+ *  are set.
+ * @param objects - the instances of the object type, with its descriptor
+ * @param wp_data - BACNET_WRITE_PROPERTY_DATA data, including
+ *  requested data and space for the reply, or error response.
+ * @return false if an error is loaded, true if no errors
+ */
+bool Value_Object_Write_Property(
+    const VALUE_OBJECT_LIST *objects, BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    BACNET_WRITE_PROPERTY_PRIMITIVE value = { 0 };
+    VALUE_OBJECT_VALUE data = { 0 };
+    const VALUE_OBJECT_CLASS *pClass;
+    VALUE_OBJECT *pObject;
+    bool status = false;
+
+    if (!wp_data) {
+        return false;
+    }
+    pObject = Value_Object_Data(objects, wp_data->object_instance);
+    if (!pObject) {
+        wp_data->error_class = ERROR_CLASS_OBJECT;
+        wp_data->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return false;
+    }
+    if (!Value_Object_Write_Decode(wp_data, &value)) {
+        return false;
+    }
+    pClass = objects->Class;
+    if (wp_data->object_property == PROP_PRESENT_VALUE) {
+        /* the hot path: one typed copy, without the property lists */
+        if (!Value_Object_Write_Tag_Valid(wp_data, &value, pClass->Value_Tag)) {
+            return false;
+        }
+        if (!Value_Object_Write_Value(&value, &data)) {
+            wp_data->error_class = ERROR_CLASS_PROPERTY;
+            wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            return false;
+        }
+        return Value_Object_Present_Value_Set(
+            objects, wp_data->object_instance, &data);
+    }
+    if (!Value_Object_Property_Member(pClass, wp_data->object_property)) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+        return false;
+    }
+    switch (wp_data->object_property) {
+        case PROP_COV_INCREMENT:
+            status = Value_Object_Write_Tag_Valid(
+                wp_data, &value,
+                Value_Object_COV_Increment_Tag(pClass->Value_Tag));
+            if (status) {
+                status = Value_Object_Write_Value(&value, &data);
+                if (status && (value.tag == BACNET_APPLICATION_TAG_REAL)) {
+                    status = !isless(data.Real, 0.0f);
+                }
+                if (status) {
+                    Value_Object_COV_Increment_Set(
+                        objects, wp_data->object_instance, &data);
+                } else {
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            }
+            break;
+        case PROP_OUT_OF_SERVICE:
+            status = Value_Object_Write_Tag_Valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
+            if (status) {
+                pObject->Out_Of_Service = value.type.Boolean;
+            }
+            break;
+        case PROP_UNITS:
+            status = Value_Object_Write_Tag_Valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_ENUMERATED);
+            if (status) {
+                if (value.type.Enumerated <= UINT16_MAX) {
+                    pObject->Units = value.type.Enumerated;
+                } else {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            }
+            break;
+        default:
+            wp_data->error_class = ERROR_CLASS_PROPERTY;
+            wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            break;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Add the memory used by the instances of a value object type to a
+ *  report
+ * @param objects - the instances of the object type, with its descriptor
+ * @param usage - report to add the memory used by the objects to
+ */
+void Value_Object_Memory_Usage(
+    const VALUE_OBJECT_LIST *objects, BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    if (!objects || !usage) {
+        return;
+    }
+    count = Value_Object_Count(objects);
+    usage->dynamic_bytes += Keylist_Memory_Size(objects->List);
+    usage->dynamic_bytes += count * sizeof(VALUE_OBJECT);
+    usage->count += count;
+}
+
+/**
+ * @brief Get the revision of the list of instances of a value object type
+ * @param objects - the instances of the object type, with its descriptor
+ * @return a number that changes when an object is created or deleted
+ */
+unsigned Value_Object_List_Revision(const VALUE_OBJECT_LIST *objects)
+{
+    if (!objects) {
+        return 0;
+    }
+
+    return Keylist_Revision(objects->List);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Table driven engine for the value objects, which have a single
+ *  primitive present-value, status-flags, out-of-service, units, and
+ *  COV-increment, so that each value object type is a descriptor
+ *  and a handful of typed wrappers.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_OBJECT_VALUE_OBJECT_H
+#define BACNET_BASIC_OBJECT_VALUE_OBJECT_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacenum.h"
+#include "bacnet/bacstr.h"
+#include "bacnet/cov.h"
+#include "bacnet/rp.h"
+#include "bacnet/wp.h"
+#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/memusage.h"
+
+/**
+ * @brief Typed storage of a primitive value of a value object
+ */
+typedef union value_object_value {
+    bool Boolean;
+    uint32_t Unsigned_Int;
+    int32_t Signed_Int;
+    float Real;
+    uint32_t Enumerated;
+} VALUE_OBJECT_VALUE;
+
+/**
+ * @brief Descriptor of one value object type
+ */
+typedef struct value_object_class {
+    BACNET_OBJECT_TYPE Object_Type;
+    /* application tag of the present-value */
+    BACNET_APPLICATION_TAG Value_Tag;
+    /* default object-name is the prefix and the instance number */
+    const char *Name_Prefix;
+    const int32_t *Properties_Required;
+    const int32_t *Properties_Optional;
+    const int32_t *Properties_Proprietary;
+    /* values of a created object */
+    BACNET_ENGINEERING_UNITS Units;
+    VALUE_OBJECT_VALUE COV_Increment;
+} VALUE_OBJECT_CLASS;
+
+/**
+ * @brief Data of one value object instance
+ */
+typedef struct value_object {
+    bool Out_Of_Service : 1;
+    bool Changed : 1;
+    BACNET_ENGINEERING_UNITS Units;
+    VALUE_OBJECT_VALUE Present_Value;
+    VALUE_OBJECT_VALUE Prior_Value;
+    VALUE_OBJECT_VALUE COV_Increment;
+    const char *Object_Name;
+    const char *Description;
+    void *Context;
+} VALUE_OBJECT;
+
+/**
+ * @brief The instances of one value object type
+ */
+typedef struct value_object_list {
+    const VALUE_OBJECT_CLASS *Class;
+    OS_Keylist List;
+} VALUE_OBJECT_LIST;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void Value_Object_Init(VALUE_OBJECT_LIST *objects);
+BACNET_STACK_EXPORT
+void Value_Object_Cleanup(VALUE_OBJECT_LIST *objects);
+BACNET_STACK_EXPORT
+uint32_t
+Value_Object_Create(VALUE_OBJECT_LIST *objects, uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Value_Object_Delete(VALUE_OBJECT_LIST *objects, uint32_t object_instance);
+
+BACNET_STACK_EXPORT
+VALUE_OBJECT *
+Value_Object_Data(const VALUE_OBJECT_LIST *objects, uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned Value_Object_Count(const VALUE_OBJECT_LIST *objects);
+BACNET_STACK_EXPORT
+uint32_t Value_Object_Index_To_Instance(
+    const VALUE_OBJECT_LIST *objects, unsigned index);
+BACNET_STACK_EXPORT
+unsigned Value_Object_Instance_To_Index(
+    const VALUE_OBJECT_LIST *objects, uint32_t object_instance);
+
+BACNET_STACK_EXPORT
+bool Value_Object_Name(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    BACNET_CHARACTER_STRING *object_name);
+
+BACNET_STACK_EXPORT
+bool Value_Object_Present_Value_Set(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    const VALUE_OBJECT_VALUE *value);
+BACNET_STACK_EXPORT
+bool Value_Object_COV_Increment_Set(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    const VALUE_OBJECT_VALUE *value);
+BACNET_STACK_EXPORT
+bool Value_Object_Encode_Value_List(
+    const VALUE_OBJECT_LIST *objects,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE *value_list);
+
+BACNET_STACK_EXPORT
+int Value_Object_Read_Property(
+    const VALUE_OBJECT_LIST *objects, BACNET_READ_PROPERTY_DATA *rpdata);
+BACNET_STACK_EXPORT
+bool Value_Object_Write_Property(
+    const VALUE_OBJECT_LIST *objects, BACNET_WRITE_PROPERTY_DATA *wp_data);
+
+BACNET_STACK_EXPORT
+void Value_Object_Memory_Usage(
+    const VALUE_OBJECT_LIST *objects, BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+unsigned Value_Object_List_Revision(const VALUE_OBJECT_LIST *objects);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
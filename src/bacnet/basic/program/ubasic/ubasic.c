@@ -553,6 +553,62 @@ ubasic_get_arrayvarnum(struct ubasic_data *data, uint8_t varnum, uint16_t idx)
 }
 #endif
 
+#if UBASIC_LABEL_TABLE_SIZE > 0
+/*---------------------------------------------------------------------------*/
+static uint16_t label_hash(const char *label)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (*label) {
+        hash ^= (uint8_t)*label;
+        hash *= 16777619UL;
+        label++;
+    }
+
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/*---------------------------------------------------------------------------*/
+/* find the labels of the program once, so that goto and gosub jump
+   straight to them instead of tokenizing the program up to the label */
+static void label_table_init(struct ubasic_data *data)
+{
+    char label[UBASIC_LABEL_LEN_MAX] = { '\0' };
+    struct ubasic_tokenizer tree;
+    uint16_t hash;
+    uint8_t i;
+
+    data->label_count = 0;
+    tokenizer_init(&tree, data->program_ptr);
+    while (tokenizer_token(&tree) != UBASIC_TOKENIZER_ENDOFINPUT) {
+        tokenizer_next(&tree);
+        if (tokenizer_token(&tree) != UBASIC_TOKENIZER_COLON) {
+            continue;
+        }
+        tokenizer_next(&tree);
+        if (tokenizer_token(&tree) != UBASIC_TOKENIZER_LABEL) {
+            continue;
+        }
+        if (data->label_count >= UBASIC_LABEL_TABLE_SIZE) {
+            break;
+        }
+        tokenizer_label(&tree, label, sizeof(label));
+        hash = label_hash(label);
+        /* the first label with a hash wins, like the search does */
+        for (i = 0; i < data->label_count; i++) {
+            if (data->label_table[i].hash == hash) {
+                break;
+            }
+        }
+        if (i == data->label_count) {
+            data->label_table[i].hash = hash;
+            data->label_table[i].offset = tokenizer_save_offset(&tree);
+            data->label_count++;
+        }
+    }
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 void ubasic_load_program(struct ubasic_data *data, const char *program)
 {
@@ -567,6 +623,9 @@ void ubasic_load_program(struct ubasic_data *data, const char *program)
     if (data->program) {
         data->program_ptr = data->program;
         tokenizer_init(&data->tree, data->program_ptr);
+#if UBASIC_LABEL_TABLE_SIZE > 0
+        label_table_init(data);
+#endif
         data->status.bit.isRunning = 1;
     }
 }
@@ -1545,6 +1604,24 @@ static uint8_t jump_label(struct ubasic_data *data, char *label)
 {
     char currLabel[UBASIC_LABEL_LEN_MAX] = { '\0' };
     struct ubasic_tokenizer *tree = &data->tree;
+#if UBASIC_LABEL_TABLE_SIZE > 0
+    uint16_t hash = label_hash(label);
+    uint8_t i;
+
+    for (i = 0; i < data->label_count; i++) {
+        if (data->label_table[i].hash != hash) {
+            continue;
+        }
+        tokenizer_jump_offset(tree, data->label_table[i].offset);
+        tokenizer_label(tree, currLabel, sizeof(currLabel));
+        if (strcmp(label, currLabel) == 0) {
+            accept(data, UBASIC_TOKENIZER_LABEL);
+            return 1;
+        }
+        /* another label with the same hash: search for it */
+        break;
+    }
+#endif
 
     tokenizer_init(tree, data->program_ptr);
 
@@ -2881,6 +2958,9 @@ uint8_t ubasic_execute_statement(struct ubasic_data *data, char *stmt)
 
     data->program_ptr = stmt;
     data->for_stack_ptr = data->gosub_stack_ptr = 0;
+#if UBASIC_LABEL_TABLE_SIZE > 0
+    data->label_count = 0;
+#endif
     tokenizer_init(tree, stmt);
     do {
 #if defined(UBASIC_VARIABLE_TYPE_STRING)
@@ -84,6 +84,16 @@ struct ubasic_while_state {
 #define UBASIC_GOSUB_STACK_DEPTH 10
 #endif
 
+/* number of labels whose offsets are kept for goto and gosub,
+   or 0 to search the program text for every jump */
+#ifndef UBASIC_LABEL_TABLE_SIZE
+#define UBASIC_LABEL_TABLE_SIZE 16
+#endif
+struct ubasic_label {
+    uint16_t hash;
+    uint16_t offset;
+};
+
 #ifndef UBASIC_IF_THEN_STACK_DEPTH
 #define UBASIC_IF_THEN_STACK_DEPTH 4
 #endif
@@ -126,6 +136,12 @@ struct ubasic_data {
     uint16_t gosub_stack[UBASIC_GOSUB_STACK_DEPTH];
     uint8_t gosub_stack_ptr;
 
+#if UBASIC_LABEL_TABLE_SIZE > 0
+    /* labels of the program, found once when it is loaded */
+    struct ubasic_label label_table[UBASIC_LABEL_TABLE_SIZE];
+    uint8_t label_count;
+#endif
+
     struct ubasic_for_state for_stack[UBASIC_FOR_LOOP_STACK_DEPTH];
     uint8_t for_stack_ptr;
 
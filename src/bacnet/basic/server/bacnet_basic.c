@@ -15,6 +15,10 @@
 #include "bacnet/iam.h"
 /* BACnet Stack basic services */
 #include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/mstimer_wheel.h"
+#if BACNET_DEBUG_ASYNC
+#include "bacnet/basic/sys/debug_async.h"
+#endif
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/datalink/datalink.h"
@@ -29,16 +33,24 @@
 #include "bacnet/basic/server/bacnet_basic.h"
 #include "bacnet/basic/server/bacnet_port.h"
 
-/* 1s timer for basic non-critical timed tasks */
-static struct mstimer BACnet_Task_Timer;
-/* task timer for object functionality */
-static struct mstimer BACnet_Object_Timer;
+/* 1s event for basic non-critical timed tasks */
+static struct mstimer_wheel_event BACnet_Task_Event;
+/* task event for object functionality */
+static struct mstimer_wheel_event BACnet_Object_Event;
+static unsigned long BACnet_Object_Interval;
+/* longest wait for a packet when no timed event is due sooner */
+static unsigned long BACnet_Task_Timeout;
 /* uptimer for BACnet task */
 static unsigned long BACnet_Uptime_Seconds;
 /* packet counter for BACnet task */
 static unsigned long BACnet_Packet_Count;
 /* local Device ID to track changes */
 static uint32_t Device_ID = 0xFFFFFFFF;
+#if BACNET_DEBUG_ASYNC && defined(RINGBUF_ATOMIC_SUPPORTED)
+/* debug prints recorded by the stack, printed at the end of each task */
+static uint32_t Debug_Async_Buffer
+    [DEBUG_ASYNC_BUFFER_SIZE(DEBUG_ASYNC_RECORDS) / sizeof(uint32_t)];
+#endif
 /* callbacks for custom features in BACnet thread */
 static bacnet_basic_callback BACnet_Init_Callback;
 static void *BACnet_Init_Context;
@@ -148,7 +160,57 @@ unsigned long bacnet_basic_packet_count(void)
  */
 void bacnet_basic_task_object_timer_set(unsigned long milliseconds)
 {
-    mstimer_set(&BACnet_Object_Timer, milliseconds);
+    BACnet_Object_Interval = milliseconds;
+    if (mstimer_wheel_event_pending(&BACnet_Object_Event)) {
+        mstimer_wheel_event_periodic(&BACnet_Object_Event, milliseconds);
+    }
+}
+
+/**
+ * @brief Set the longest time that bacnet_basic_task() waits for a packet.
+ *  The task waits until the next timed event is due, but no longer than
+ *  this, so an idle device sleeps instead of polling.
+ * @param milliseconds [in] The longest wait, or 0 for no wait (default)
+ */
+void bacnet_basic_task_timeout_set(unsigned long milliseconds)
+{
+    BACnet_Task_Timeout = milliseconds;
+}
+
+/**
+ * @brief Handle the non-time-critical cyclic tasks
+ * @param event [in] The 1 second event
+ * @param elapsed [in] The milliseconds since the previous call
+ */
+static void bacnet_basic_task_seconds(
+    struct mstimer_wheel_event *event, unsigned long elapsed)
+{
+    uint32_t elapsed_seconds;
+
+    (void)elapsed;
+    /* presume that the elapsed time is the interval time */
+    elapsed_seconds = event->interval / 1000;
+    BACnet_Uptime_Seconds += elapsed_seconds;
+    dcc_timer_seconds(elapsed_seconds);
+    datalink_maintenance_timer(elapsed_seconds);
+    handler_cov_timer_seconds(elapsed_seconds);
+}
+
+/**
+ * @brief Handle the object specific cyclic tasks, and the delayed I-Am
+ *  response of the Who-Is handler
+ * @param event [in] The object timer event
+ * @param elapsed [in] The milliseconds since the previous call
+ */
+static void bacnet_basic_task_objects(
+    struct mstimer_wheel_event *event, unsigned long elapsed)
+{
+    (void)event;
+    if (elapsed > UINT16_MAX) {
+        elapsed = UINT16_MAX;
+    }
+    Device_Timer((uint16_t)elapsed);
+    handler_who_is_timer_milliseconds((uint16_t)elapsed);
 }
 
 /**
@@ -187,6 +249,10 @@ bool bacnet_basic_write_property_store(BACNET_WRITE_PROPERTY_DATA *wp_data)
  */
 void bacnet_basic_init(void)
 {
+#if BACNET_DEBUG_ASYNC && defined(RINGBUF_ATOMIC_SUPPORTED)
+    (void)debug_async_init(
+        Debug_Async_Buffer, sizeof(Debug_Async_Buffer), DEBUG_ASYNC_RECORDS);
+#endif
     /* set up our confirmed service unrecognized service handler - required! */
     apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
     /* we need to handle who-is to support dynamic device binding */
@@ -211,11 +277,17 @@ void bacnet_basic_init(void)
     apdu_set_confirmed_handler(
         SERVICE_CONFIRMED_REINITIALIZE_DEVICE, handler_reinitialize_device);
     /* start the 1 second timer for non-critical cyclic tasks */
-    mstimer_set(&BACnet_Task_Timer, 1000L);
+    mstimer_wheel_event_init(
+        &BACnet_Task_Event, bacnet_basic_task_seconds, NULL);
+    mstimer_wheel_event_periodic(&BACnet_Task_Event, 1000L);
     /* start the timer for more time sensitive object specific cyclic tasks */
-    if (mstimer_interval(&BACnet_Object_Timer) == 0) {
-        mstimer_set(&BACnet_Object_Timer, 100UL);
+    if (BACnet_Object_Interval == 0) {
+        BACnet_Object_Interval = 100UL;
     }
+    mstimer_wheel_event_init(
+        &BACnet_Object_Event, bacnet_basic_task_objects, NULL);
+    mstimer_wheel_event_periodic(
+        &BACnet_Object_Event, BACnet_Object_Interval);
     Device_Write_Property_Store_Callback_Set(bacnet_basic_write_property_store);
     Device_Init(NULL);
     /* initialize user data in this thread */
@@ -226,15 +298,15 @@ void bacnet_basic_init(void)
 static uint8_t PDUBuffer[MAX_MPDU];
 
 /**
- * @brief non-blocking BACnet task
+ * @brief BACnet task, which does not block unless a timeout is set with
+ *  bacnet_basic_task_timeout_set()
  */
 void bacnet_basic_task(void)
 {
     bool hello_world = false;
     uint16_t pdu_len = 0;
     BACNET_ADDRESS src = { 0 };
-    uint32_t elapsed_milliseconds = 0;
-    uint32_t elapsed_seconds = 0;
+    unsigned long timeout = 0;
 
     /* hello, World! */
     if (Device_ID != Device_Object_Instance_Number()) {
@@ -244,33 +316,28 @@ void bacnet_basic_task(void)
     if (hello_world) {
         Send_I_Am(&Handler_Transmit_Buffer[0]);
     }
-    /* handle non-time-critical cyclic tasks */
-    if (mstimer_expired(&BACnet_Task_Timer)) {
-        /* 1 second tasks */
-        mstimer_reset(&BACnet_Task_Timer);
-        /* presume that the elapsed time is the interval time */
-        elapsed_milliseconds = mstimer_interval(&BACnet_Task_Timer);
-        elapsed_seconds = elapsed_milliseconds / 1000;
-        BACnet_Uptime_Seconds += elapsed_seconds;
-        dcc_timer_seconds(elapsed_seconds);
-        datalink_maintenance_timer(elapsed_seconds);
-        handler_cov_timer_seconds(elapsed_seconds);
-    }
+    /* the cyclic tasks, and any other timed events that are due */
+    mstimer_wheel_task();
     while (!handler_cov_fsm()) {
         /* waiting for COV processing to be IDLE */
     }
-    /* object specific cyclic tasks */
-    if (mstimer_expired(&BACnet_Object_Timer)) {
-        elapsed_milliseconds = mstimer_elapsed(&BACnet_Object_Timer);
-        mstimer_restart(&BACnet_Object_Timer);
-        Device_Timer(elapsed_milliseconds);
+    /* handle the messaging, waiting until the next timed event is due */
+    if (BACnet_Task_Timeout) {
+        timeout = mstimer_wheel_next();
+        if (timeout > BACnet_Task_Timeout) {
+            timeout = BACnet_Task_Timeout;
+        }
     }
-    /* handle the messaging */
-    pdu_len = datalink_receive(&src, &PDUBuffer[0], sizeof(PDUBuffer), 0);
+    pdu_len = datalink_receive(
+        &src, &PDUBuffer[0], sizeof(PDUBuffer), (unsigned)timeout);
     if (pdu_len) {
         npdu_handler(&src, &PDUBuffer[0], pdu_len);
         BACnet_Packet_Count++;
     }
     /* call user task in this thread */
     bacnet_task_callback_handler();
+#if BACNET_DEBUG_ASYNC
+    /* print the debug messages of this pass, away from the handlers */
+    debug_async_task(0);
+#endif
 }
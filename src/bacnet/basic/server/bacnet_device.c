@@ -498,7 +498,7 @@ static object_functions_t My_Object_Table[] = {
       NULL /* Remove_List_Element */,
       Calendar_Create,
       Calendar_Delete,
-      NULL /* Timer */ },
+      Calendar_Timer },
 #endif
 #if defined(CONFIG_BACNET_BASIC_OBJECT_INTEGER_VALUE)
     { OBJECT_INTEGER_VALUE,
@@ -609,7 +609,7 @@ static object_functions_t My_Object_Table[] = {
       NULL /* Remove_List_Element */,
       Lighting_Output_Create,
       Lighting_Output_Delete,
-      Lighting_Output_Timer },
+      NULL /* Timer: lighting_command_transition_task() */ },
 #endif
 #if defined(CONFIG_BACNET_BASIC_OBJECT_CHANNEL)
     { OBJECT_CHANNEL,
@@ -675,7 +675,7 @@ static object_functions_t My_Object_Table[] = {
       NULL /* Remove_List_Element */,
       Color_Create,
       Color_Delete,
-      Color_Timer },
+      NULL /* Timer: lighting_command_transition_task() */ },
 #endif
 #if defined(CONFIG_BACNET_BASIC_OBJECT_COLOR_TEMPERATURE)
     { OBJECT_COLOR_TEMPERATURE,
@@ -697,7 +697,7 @@ static object_functions_t My_Object_Table[] = {
       NULL /* Remove_List_Element */,
       Color_Temperature_Create,
       Color_Temperature_Delete,
-      Color_Temperature_Timer },
+      NULL /* Timer: lighting_command_transition_task() */ },
 #endif
 #if defined(CONFIG_BACNET_BASIC_OBJECT_FILE)
     { OBJECT_FILE,
@@ -731,7 +731,11 @@ static object_functions_t My_Object_Table[] = {
       Structured_View_Read_Property,
       NULL /* Write_Property */,
       Structured_View_Property_Lists,
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+      Structured_View_Read_Range_Info,
+#else
       NULL /* ReadRangeInfo */,
+#endif
       NULL /* Iterator */,
       NULL /* Value_Lists */,
       NULL /* COV */,
@@ -2037,7 +2041,8 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
             }
             break;
         case PROP_MAX_APDU_LENGTH_ACCEPTED:
-            apdu_len = encode_application_unsigned(&apdu[0], MAX_APDU);
+            apdu_len = encode_application_unsigned(
+                &apdu[0], apdu_max_length_accepted());
             break;
         case PROP_SEGMENTATION_SUPPORTED:
             apdu_len = encode_application_enumerated(
@@ -2887,6 +2892,56 @@ struct object_functions *Device_Object_Functions(void)
     return Object_Table;
 }
 
+#ifdef CONFIG_BACNET_BASIC_OBJECT_LOOP
+/* direct accessors of the Present_Value of local objects, which the
+   Loop and Timer objects use instead of ReadProperty and WriteProperty */
+static const struct device_loop_accessor {
+    BACNET_OBJECT_TYPE object_type;
+    LOOP_REAL_ACCESSOR accessor;
+} Device_Loop_Accessors[] = {
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_INPUT
+    { OBJECT_ANALOG_INPUT,
+      { Analog_Input_Valid_Instance, Analog_Input_Present_Value, NULL } },
+#endif
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_OUTPUT
+    { OBJECT_ANALOG_OUTPUT,
+      { Analog_Output_Valid_Instance, Analog_Output_Present_Value,
+        Analog_Output_Present_Value_Write } },
+#endif
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_VALUE
+    { OBJECT_ANALOG_VALUE,
+      { Analog_Value_Valid_Instance, Analog_Value_Present_Value,
+        Analog_Value_Present_Value_Write } },
+#endif
+    { OBJECT_LOOP, { Loop_Valid_Instance, Loop_Present_Value, NULL } },
+};
+
+/**
+ * @brief Finds the direct accessor of an object property that a Loop
+ *  object references
+ * @param reference - object property reference of a loop
+ * @return the accessor, or NULL to use ReadProperty and WriteProperty
+ */
+static const LOOP_REAL_ACCESSOR *
+Device_Loop_Real_Accessor(const BACNET_OBJECT_PROPERTY_REFERENCE *reference)
+{
+    unsigned i;
+
+    if ((reference->property_identifier != PROP_PRESENT_VALUE) ||
+        (reference->property_array_index != BACNET_ARRAY_ALL)) {
+        return NULL;
+    }
+    for (i = 0; i < ARRAY_SIZE(Device_Loop_Accessors); i++) {
+        if (Device_Loop_Accessors[i].object_type ==
+            reference->object_identifier.type) {
+            return &Device_Loop_Accessors[i].accessor;
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 /** Initialize the Device Object.
  Initialize the group of object helper functions for any supported Object.
  Initialize each of the Device Object child Object instances.
@@ -2926,6 +2981,36 @@ void Device_Init(object_functions_t *object_table)
     /* link ReadProperty and WriteProperty to Loop object for references */
     Loop_Read_Property_Internal_Callback_Set(Device_Read_Property);
     Loop_Write_Property_Internal_Callback_Set(Device_Write_Property);
+    /* bind Loop references to local objects, and run the loops together */
+    Loop_Real_Accessor_Callback_Set(Device_Loop_Real_Accessor);
+    Device_Timer_Batch_Set(OBJECT_LOOP, Loop_Timer_Batch);
+#endif
+#ifdef CONFIG_BACNET_BASIC_OBJECT_TIMER
+    /* link WriteProperty to Timer object for its list of references */
+    Timer_Write_Property_Internal_Callback_Set(Device_Write_Property);
+#ifdef CONFIG_BACNET_BASIC_OBJECT_LOOP
+    Timer_Real_Accessor_Callback_Set(Device_Loop_Real_Accessor);
+#endif
+#endif
+#if defined(CONFIG_BACNET_BASIC_OBJECT_LIFE_SAFETY_POINT) && \
+    defined(CONFIG_BACNET_BASIC_OBJECT_LIFE_SAFETY_ZONE)
+    /* keep the member states of the Life Safety Zone objects */
+    Life_Safety_Point_Change_Callback_Set(Life_Safety_Zone_Point_Change);
+#endif
+#if defined(BACNET_OBJECT_DENSE_VALUES)
+    /* evaluate the COV increment of the dense analog objects in bulk */
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_INPUT
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_INPUT, Analog_Input_Change_Of_Value_Bulk);
+#endif
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_OUTPUT
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_OUTPUT, Analog_Output_Change_Of_Value_Bulk);
+#endif
+#ifdef CONFIG_BACNET_BASIC_OBJECT_ANALOG_VALUE
+    handler_cov_bulk_function_set(
+        OBJECT_ANALOG_VALUE, Analog_Value_Change_Of_Value_Bulk);
+#endif
 #endif
 }
 
@@ -2983,23 +3068,39 @@ bool DeviceGetRRInfo(
 
 /**
  * @brief Updates all the object timers with elapsed milliseconds
+ * @note Object types set with Device_Timer_Scheduled_Set() are only
+ *  updated when one of their wake-ups is due.  The Lighting Output,
+ *  Color, and Color Temperature objects are only updated while a
+ *  transition is active.
  * @param milliseconds - number of milliseconds elapsed
  */
 void Device_Timer(uint16_t milliseconds)
 {
     struct object_functions *pObject;
+    object_timer_batch_function batch;
     unsigned count = 0;
     uint32_t instance;
 
+    Device_Timer_Wakeups(milliseconds);
+#if defined(CONFIG_BACNET_BASIC_OBJECT_LIGHTING_OUTPUT) || \
+    defined(CONFIG_BACNET_BASIC_OBJECT_COLOR) ||            \
+    defined(CONFIG_BACNET_BASIC_OBJECT_COLOR_TEMPERATURE)
+    lighting_command_transition_task(milliseconds);
+#endif
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
-        if (pObject->Object_Count) {
+        count = 0;
+        batch = Device_Timer_Batch(pObject->Object_Type);
+        if (batch) {
+            batch(milliseconds);
+        } else if (
+            pObject->Object_Count && pObject->Object_Timer &&
+            !Device_Timer_Scheduled(pObject->Object_Type)) {
             count = pObject->Object_Count();
         }
         while (count) {
             count--;
-            if ((pObject->Object_Timer) &&
-                (pObject->Object_Index_To_Instance)) {
+            if (pObject->Object_Index_To_Instance) {
                 instance = pObject->Object_Index_To_Instance(count);
                 pObject->Object_Timer(instance, milliseconds);
             }
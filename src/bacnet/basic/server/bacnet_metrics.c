@@ -0,0 +1,657 @@
+/**
+ * @file
+ * @brief Export the counters of the BACnet stack in the Prometheus text
+ *  format, or as a JSON snapshot
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bactext.h"
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/datalink/dlstats.h"
+#if defined(BACDL_MSTP)
+#include "bacnet/datalink/mstp.h"
+#include "bacnet/datalink/dlmstp.h"
+#endif
+#include "bacnet/basic/server/bacnet_basic.h"
+#if defined(BACNET_LOCK_STATISTICS)
+#include "bacnet/basic/sys/lockstat.h"
+#endif
+/* me */
+#include "bacnet/basic/server/bacnet_metrics.h"
+
+/* text being formatted, and the metric family being written */
+struct bacnet_metrics_writer {
+    char *buffer;
+    size_t size;
+    size_t length;
+    bool json;
+    const char *name;
+    const char *type;
+    unsigned samples;
+};
+
+#if defined(BACNET_DATALINK_STATISTICS)
+/* the datalinks that update the traffic counters */
+static const BACNET_PORT_TYPE Metrics_Port_Types[] = {
+#if defined(BACDL_BIP)
+    PORT_TYPE_BIP,
+#endif
+#if defined(BACDL_BIP6)
+    PORT_TYPE_BIP6,
+#endif
+#if defined(BACDL_MSTP)
+    PORT_TYPE_MSTP,
+#endif
+#if defined(BACDL_BSC)
+    PORT_TYPE_BSC,
+#endif
+    PORT_TYPE_MAX
+};
+#endif
+
+/**
+ * @brief Append formatted text, counting the length that did not fit
+ * @param writer - text being formatted
+ * @param format - printf format
+ */
+static void
+metrics_printf(struct bacnet_metrics_writer *writer, const char *format, ...)
+{
+    va_list args;
+    char *text = NULL;
+    size_t available = 0;
+    int len;
+
+    if (writer->length < writer->size) {
+        text = &writer->buffer[writer->length];
+        available = writer->size - writer->length;
+    }
+    va_start(args, format);
+    len = vsnprintf(text, available, format, args);
+    va_end(args);
+    if (len > 0) {
+        writer->length += (size_t)len;
+    }
+}
+
+/**
+ * @brief Start a metric family, which is described once in the
+ *  Prometheus text format
+ * @param writer - text being formatted
+ * @param name - name of the metric
+ * @param type - counter, gauge, or histogram
+ * @param help - description of the metric
+ */
+static void metrics_family(
+    struct bacnet_metrics_writer *writer,
+    const char *name,
+    const char *type,
+    const char *help)
+{
+    writer->name = name;
+    writer->type = type;
+    if (!writer->json) {
+        metrics_printf(writer, "# HELP %s %s\n", name, help);
+        metrics_printf(writer, "# TYPE %s %s\n", name, type);
+    }
+}
+
+/**
+ * @brief Write one sample of the current metric family
+ * @param writer - text being formatted
+ * @param suffix - added to the name of a histogram sample, or ""
+ * @param labels - label names and values, terminated by NULL, or NULL
+ * @param value - value of the sample
+ */
+static void metrics_sample(
+    struct bacnet_metrics_writer *writer,
+    const char *suffix,
+    const char *const *labels,
+    uint64_t value)
+{
+    unsigned i;
+
+    if (writer->json) {
+        metrics_printf(
+            writer, "%s\n    {\"name\": \"%s%s\", \"type\": \"%s\"",
+            writer->samples ? "," : "", writer->name, suffix, writer->type);
+        if (labels && labels[0]) {
+            metrics_printf(writer, ", \"labels\": {");
+            for (i = 0; labels[i] && labels[i + 1]; i += 2) {
+                metrics_printf(
+                    writer, "%s\"%s\": \"%s\"", i ? ", " : "", labels[i],
+                    labels[i + 1]);
+            }
+            metrics_printf(writer, "}");
+        }
+        metrics_printf(
+            writer, ", \"value\": %llu}", (unsigned long long)value);
+    } else {
+        metrics_printf(writer, "%s%s", writer->name, suffix);
+        if (labels && labels[0]) {
+            metrics_printf(writer, "{");
+            for (i = 0; labels[i] && labels[i + 1]; i += 2) {
+                metrics_printf(
+                    writer, "%s%s=\"%s\"", i ? "," : "", labels[i],
+                    labels[i + 1]);
+            }
+            metrics_printf(writer, "}");
+        }
+        metrics_printf(writer, " %llu\n", (unsigned long long)value);
+    }
+    writer->samples++;
+}
+
+/**
+ * @brief Write a sample with no labels, as its own metric family
+ * @param writer - text being formatted
+ * @param name - name of the metric
+ * @param type - counter or gauge
+ * @param help - description of the metric
+ * @param value - value of the sample
+ */
+static void metrics_value(
+    struct bacnet_metrics_writer *writer,
+    const char *name,
+    const char *type,
+    const char *help,
+    uint64_t value)
+{
+    metrics_family(writer, name, type, help);
+    metrics_sample(writer, "", NULL, value);
+}
+
+#if defined(BACNET_APDU_STATISTICS) || defined(BACDL_MSTP) || \
+    defined(BACNET_LOCK_STATISTICS)
+/**
+ * @brief Write the samples of a power-of-two histogram, where bucket 0
+ *  counts the zero times and bucket N counts 2^(N-1) to 2^N-1
+ * @param writer - text being formatted
+ * @param label - name of the label of the histogram, or NULL
+ * @param label_value - value of the label
+ * @param buckets - counts of each bucket
+ * @param count - number of buckets, the last one without an upper bound
+ * @param sum - sum of the times, written if with_sum is true
+ * @param with_sum - true if the sum of the times is known
+ */
+static void metrics_histogram(
+    struct bacnet_metrics_writer *writer,
+    const char *label,
+    const char *label_value,
+    const uint32_t *buckets,
+    unsigned count,
+    uint64_t sum,
+    bool with_sum)
+{
+    const char *labels[5] = { NULL };
+    char bound[24];
+    uint64_t total = 0;
+    unsigned i, n = 0;
+
+    if (label) {
+        labels[n++] = label;
+        labels[n++] = label_value;
+    }
+    labels[n] = "le";
+    labels[n + 1] = bound;
+    for (i = 0; i < count; i++) {
+        total += buckets[i];
+        if ((i + 1) < count) {
+            snprintf(
+                bound, sizeof(bound), "%llu",
+                (unsigned long long)((1ULL << i) - 1ULL));
+        } else {
+            snprintf(bound, sizeof(bound), "+Inf");
+        }
+        metrics_sample(writer, "_bucket", labels, total);
+    }
+    labels[n] = NULL;
+    if (with_sum) {
+        metrics_sample(writer, "_sum", labels, sum);
+    }
+    metrics_sample(writer, "_count", labels, total);
+}
+#endif
+
+/**
+ * @brief Write the counters of the core stack
+ * @param writer - text being formatted
+ */
+static void metrics_stack(struct bacnet_metrics_writer *writer)
+{
+    const char *labels[3] = { "result", NULL, NULL };
+    unsigned long hits = 0, misses = 0;
+
+    metrics_value(
+        writer, "bacnet_uptime_seconds", "counter",
+        "Seconds since the BACnet task started.",
+        bacnet_basic_uptime_seconds());
+    metrics_value(
+        writer, "bacnet_packets_received_total", "counter",
+        "NPDUs received by the BACnet task.", bacnet_basic_packet_count());
+#if MAX_TSM_TRANSACTIONS
+    metrics_value(
+        writer, "bacnet_tsm_transactions", "gauge",
+        "Transactions that the transaction state machine can hold.",
+        MAX_TSM_TRANSACTIONS);
+    metrics_value(
+        writer, "bacnet_tsm_active_transactions", "gauge",
+        "Confirmed requests waiting for a reply.",
+        MAX_TSM_TRANSACTIONS - tsm_transaction_idle_count());
+#endif
+    metrics_value(
+        writer, "bacnet_address_cache_entries", "gauge",
+        "Devices bound in the address cache.", address_count());
+    address_cache_lookups(&hits, &misses);
+    metrics_family(
+        writer, "bacnet_address_cache_lookups_total", "counter",
+        "Address cache lookups, by whether a bound device was found.");
+    labels[1] = "hit";
+    metrics_sample(writer, "", labels, hits);
+    labels[1] = "miss";
+    metrics_sample(writer, "", labels, misses);
+    metrics_value(
+        writer, "bacnet_cov_subscriptions", "gauge",
+        "Active change of value subscriptions.",
+        handler_cov_subscription_count());
+    metrics_value(
+        writer, "bacnet_cov_changed_queue_depth", "gauge",
+        "Changed objects waiting for the change of value task.",
+        handler_cov_changed_count());
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+    metrics_value(
+        writer, "bacnet_datalink_tx_pending", "gauge",
+        "NPDUs waiting in the datalink transmit scheduler.",
+        datalink_tx_pending());
+#endif
+}
+
+#if defined(BACNET_DATALINK_STATISTICS)
+/**
+ * @brief Write one traffic counter of each datalink
+ * @param writer - text being formatted
+ * @param offset - offset of the counter in DLSTATS_COUNTERS
+ * @param direction - value of the direction label, or NULL
+ */
+static void metrics_datalink_counter(
+    struct bacnet_metrics_writer *writer,
+    size_t offset,
+    const char *direction)
+{
+    const char *labels[5] = { "port", NULL, NULL, NULL, NULL };
+    DLSTATS_COUNTERS counters;
+    unsigned i;
+
+    if (direction) {
+        labels[2] = "direction";
+        labels[3] = direction;
+    }
+    for (i = 0; Metrics_Port_Types[i] != PORT_TYPE_MAX; i++) {
+        if (dlstats_counters(Metrics_Port_Types[i], &counters)) {
+            labels[1] = bactext_network_port_type_name(Metrics_Port_Types[i]);
+            metrics_sample(
+                writer, "", labels,
+                *(const uint32_t *)(const void *)((const uint8_t *)&counters +
+                                                   offset));
+        }
+    }
+}
+
+/**
+ * @brief Write the traffic counters of the datalinks
+ * @param writer - text being formatted
+ */
+static void metrics_datalink(struct bacnet_metrics_writer *writer)
+{
+    metrics_family(
+        writer, "bacnet_datalink_packets_total", "counter",
+        "Packets received and sent by each datalink.");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, packets_in), "in");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, packets_out), "out");
+    metrics_family(
+        writer, "bacnet_datalink_octets_total", "counter",
+        "Octets received and sent by each datalink.");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, bytes_in), "in");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, bytes_out), "out");
+    metrics_family(
+        writer, "bacnet_datalink_drops_total", "counter",
+        "Packets that each datalink could not send or queue.");
+    metrics_datalink_counter(writer, offsetof(DLSTATS_COUNTERS, drops), NULL);
+    metrics_family(
+        writer, "bacnet_datalink_decode_errors_total", "counter",
+        "Received packets that each datalink could not decode.");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, decode_errors), NULL);
+    metrics_family(
+        writer, "bacnet_datalink_queue_depth", "gauge",
+        "Packets waiting in the transmit queue of each datalink.");
+    metrics_datalink_counter(
+        writer, offsetof(DLSTATS_COUNTERS, queue_depth), NULL);
+}
+#endif
+
+#if defined(BACNET_APDU_STATISTICS)
+/**
+ * @brief Get the statistics of a service that was requested
+ * @param index - confirmed services first, then the unconfirmed services
+ * @param name - filled with the name of the service
+ * @param stats - filled with the statistics of the service
+ * @return true if the service was requested
+ */
+static bool metrics_service(
+    unsigned index, const char **name, APDU_SERVICE_STATISTICS *stats)
+{
+    bool status;
+
+    if (index < MAX_BACNET_CONFIRMED_SERVICE) {
+        status = apdu_statistics_confirmed((uint8_t)index, stats);
+        *name = bactext_confirmed_service_name(index);
+    } else {
+        index -= MAX_BACNET_CONFIRMED_SERVICE;
+        status = apdu_statistics_unconfirmed((uint8_t)index, stats);
+        *name = bactext_unconfirmed_service_name(index);
+    }
+
+    return status && (stats->requests > 0);
+}
+
+/**
+ * @brief Write one counter of each service that was requested
+ * @param writer - text being formatted
+ * @param offset - offset of the counter in APDU_SERVICE_STATISTICS
+ * @param wide - true if the counter is 64 bits
+ */
+static void metrics_service_counter(
+    struct bacnet_metrics_writer *writer, size_t offset, bool wide)
+{
+    const char *labels[3] = { "service", NULL, NULL };
+    APDU_SERVICE_STATISTICS stats;
+    const uint8_t *counter;
+    unsigned i;
+
+    for (i = 0;
+         i < (MAX_BACNET_CONFIRMED_SERVICE + MAX_BACNET_UNCONFIRMED_SERVICE);
+         i++) {
+        if (metrics_service(i, &labels[1], &stats)) {
+            counter = (const uint8_t *)&stats + offset;
+            metrics_sample(
+                writer, "", labels,
+                wide ? *(const uint64_t *)(const void *)counter
+                     : *(const uint32_t *)(const void *)counter);
+        }
+    }
+}
+
+/**
+ * @brief Write the per-service counters of the APDU handler
+ * @param writer - text being formatted
+ */
+static void metrics_services(struct bacnet_metrics_writer *writer)
+{
+    const char *labels[5] = { "service", NULL, "type", NULL, NULL };
+    APDU_SERVICE_STATISTICS stats;
+    unsigned i;
+
+    metrics_family(
+        writer, "bacnet_service_requests_total", "counter",
+        "Requests received for each service.");
+    metrics_service_counter(
+        writer, offsetof(APDU_SERVICE_STATISTICS, requests), false);
+    metrics_family(
+        writer, "bacnet_service_dcc_drops_total", "counter",
+        "Requests dropped by DeviceCommunicationControl.");
+    metrics_service_counter(
+        writer, offsetof(APDU_SERVICE_STATISTICS, dcc_drops), false);
+    metrics_family(
+        writer, "bacnet_service_replies_total", "counter",
+        "APDUs sent by the handler of each service.");
+    metrics_service_counter(
+        writer, offsetof(APDU_SERVICE_STATISTICS, replies), false);
+    metrics_family(
+        writer, "bacnet_service_reply_octets_total", "counter",
+        "Octets of the APDUs sent by the handler of each service.");
+    metrics_service_counter(
+        writer, offsetof(APDU_SERVICE_STATISTICS, reply_octets), true);
+    metrics_family(
+        writer, "bacnet_service_reply_octets_max", "gauge",
+        "Largest APDU sent by the handler of each service.");
+    metrics_service_counter(
+        writer, offsetof(APDU_SERVICE_STATISTICS, reply_octets_max), false);
+    metrics_family(
+        writer, "bacnet_service_failures_total", "counter",
+        "Error, Reject, and Abort replies sent for each service.");
+    for (i = 0;
+         i < (MAX_BACNET_CONFIRMED_SERVICE + MAX_BACNET_UNCONFIRMED_SERVICE);
+         i++) {
+        if (metrics_service(i, &labels[1], &stats)) {
+            labels[3] = "error";
+            metrics_sample(writer, "", labels, stats.errors);
+            labels[3] = "reject";
+            metrics_sample(writer, "", labels, stats.rejects);
+            labels[3] = "abort";
+            metrics_sample(writer, "", labels, stats.aborts);
+        }
+    }
+    metrics_family(
+        writer, "bacnet_service_handler_microseconds", "histogram",
+        "Time of the handler of each service.");
+    for (i = 0;
+         i < (MAX_BACNET_CONFIRMED_SERVICE + MAX_BACNET_UNCONFIRMED_SERVICE);
+         i++) {
+        if (metrics_service(i, &labels[1], &stats)) {
+            metrics_histogram(
+                writer, "service", labels[1], stats.time_histogram,
+                APDU_STATISTICS_BUCKETS, stats.time_total, true);
+        }
+    }
+}
+#endif
+
+#if defined(BACDL_MSTP)
+/**
+ * @brief Write the frame and token counters of the MS/TP datalink
+ * @param writer - text being formatted
+ */
+static void metrics_mstp(struct bacnet_metrics_writer *writer)
+{
+    const char *labels[3] = { "result", NULL, NULL };
+    struct dlmstp_statistics frames = { 0 };
+    struct mstp_port_statistics tokens = { 0 };
+
+    dlmstp_fill_statistics(&frames);
+    metrics_value(
+        writer, "bacnet_mstp_transmit_frames_total", "counter",
+        "MS/TP frames sent.", frames.transmit_frame_counter);
+    metrics_family(
+        writer, "bacnet_mstp_receive_frames_total", "counter",
+        "MS/TP frames received, by whether they were valid and for us.");
+    labels[1] = "valid";
+    metrics_sample(writer, "", labels, frames.receive_valid_frame_counter);
+    labels[1] = "invalid";
+    metrics_sample(writer, "", labels, frames.receive_invalid_frame_counter);
+    labels[1] = "not-for-us";
+    metrics_sample(
+        writer, "", labels, frames.receive_valid_frame_not_for_us_counter);
+    metrics_value(
+        writer, "bacnet_mstp_lost_tokens_total", "counter",
+        "MS/TP tokens lost.", frames.lost_token_counter);
+    metrics_value(
+        writer, "bacnet_mstp_bad_crc_total", "counter",
+        "MS/TP frames received with a bad CRC.", frames.bad_crc_counter);
+    if (!dlmstp_fill_mstp_statistics(&tokens)) {
+        return;
+    }
+    metrics_value(
+        writer, "bacnet_mstp_tokens_total", "counter",
+        "MS/TP tokens received.", tokens.Token_Count);
+    metrics_value(
+        writer, "bacnet_mstp_token_frames_total", "counter",
+        "MS/TP data frames sent while holding the token.",
+        tokens.Token_Frame_Count);
+    metrics_value(
+        writer, "bacnet_mstp_token_frames_max", "gauge",
+        "Most MS/TP data frames sent during one token hold.",
+        tokens.Token_Frame_Max);
+    metrics_value(
+        writer, "bacnet_mstp_token_retries_total", "counter",
+        "MS/TP tokens sent again because the next station did not use it.",
+        tokens.Token_Retry_Count);
+    metrics_value(
+        writer, "bacnet_mstp_poll_for_master_total", "counter",
+        "MS/TP Poll For Master frames sent.", tokens.Poll_For_Master_Count);
+    metrics_value(
+        writer, "bacnet_mstp_reply_timeouts_total", "counter",
+        "MS/TP requests not answered within Treply_timeout.",
+        tokens.Reply_Timeout_Count);
+    metrics_family(
+        writer, "bacnet_mstp_token_rotation_milliseconds", "histogram",
+        "Time from receiving the MS/TP token until receiving it again.");
+    metrics_histogram(
+        writer, NULL, NULL, tokens.Token_Rotation, MSTP_HISTOGRAM_BUCKETS, 0,
+        false);
+    metrics_family(
+        writer, "bacnet_mstp_reply_latency_milliseconds", "histogram",
+        "Time from sending an MS/TP request until the reply.");
+    metrics_histogram(
+        writer, NULL, NULL, tokens.Reply_Latency, MSTP_HISTOGRAM_BUCKETS, 0,
+        false);
+}
+#endif
+
+#if defined(BACNET_LOCK_STATISTICS)
+/**
+ * @brief Write the waits for the instrumented locks, and the depths of the
+ *  instrumented queues, of the threads of the port
+ * @param writer - text being formatted
+ */
+static void metrics_locks(struct bacnet_metrics_writer *writer)
+{
+    const char *labels[3] = { "lock", NULL, NULL };
+    const LOCKSTAT_LOCK *lock;
+    const LOCKSTAT_QUEUE *queue;
+
+    metrics_family(
+        writer, "bacnet_lock_acquisitions_total", "counter",
+        "Acquisitions of each instrumented lock.");
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        labels[1] = lock->name;
+        metrics_sample(writer, "", labels, lock->acquisitions);
+    }
+    metrics_family(
+        writer, "bacnet_lock_contended_total", "counter",
+        "Acquisitions that found the lock held by another thread.");
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        labels[1] = lock->name;
+        metrics_sample(writer, "", labels, lock->contended);
+    }
+    metrics_family(
+        writer, "bacnet_lock_wait_microseconds_max", "gauge",
+        "Longest wait for each instrumented lock.");
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        labels[1] = lock->name;
+        metrics_sample(writer, "", labels, lock->wait_max);
+    }
+    metrics_family(
+        writer, "bacnet_lock_wait_microseconds", "histogram",
+        "Time waited for each instrumented lock.");
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        metrics_histogram(
+            writer, "lock", lock->name, lock->wait_histogram,
+            LOCKSTAT_BUCKETS, lock->wait_total, true);
+    }
+    labels[0] = "queue";
+    metrics_family(
+        writer, "bacnet_queue_depth", "gauge",
+        "Elements in each instrumented queue when last sampled.");
+    for (queue = lockstat_queues(); queue; queue = queue->next) {
+        labels[1] = queue->name;
+        metrics_sample(writer, "", labels, queue->depth);
+    }
+    metrics_family(
+        writer, "bacnet_queue_depth_max", "gauge",
+        "Most elements ever sampled in each instrumented queue.");
+    for (queue = lockstat_queues(); queue; queue = queue->next) {
+        labels[1] = queue->name;
+        metrics_sample(writer, "", labels, queue->depth_max);
+    }
+}
+#endif
+
+/**
+ * @brief Write all of the metrics
+ * @param writer - text being formatted
+ */
+static void metrics_write(struct bacnet_metrics_writer *writer)
+{
+    metrics_stack(writer);
+#if defined(BACNET_DATALINK_STATISTICS)
+    metrics_datalink(writer);
+#endif
+#if defined(BACNET_APDU_STATISTICS)
+    metrics_services(writer);
+#endif
+#if defined(BACDL_MSTP)
+    metrics_mstp(writer);
+#endif
+#if defined(BACNET_LOCK_STATISTICS)
+    metrics_locks(writer);
+#endif
+}
+
+/**
+ * @brief Format the metrics in the Prometheus text exposition format
+ * @param buffer - text buffer, or NULL to get the length
+ * @param size - size of the text buffer
+ * @return length of the text, not counting the terminating null.
+ *  The text was truncated if the length is not less than the size.
+ */
+size_t bacnet_metrics_prometheus(char *buffer, size_t size)
+{
+    struct bacnet_metrics_writer writer = { 0 };
+
+    writer.buffer = buffer;
+    writer.size = buffer ? size : 0;
+    metrics_write(&writer);
+
+    return writer.length;
+}
+
+/**
+ * @brief Format the metrics as a JSON snapshot: an object with the
+ *  timestamp and a list of the samples, each with its name, type,
+ *  labels, and value
+ * @param buffer - text buffer, or NULL to get the length
+ * @param size - size of the text buffer
+ * @param timestamp - seconds since the epoch of the snapshot
+ * @return length of the text, not counting the terminating null.
+ *  The text was truncated if the length is not less than the size.
+ */
+size_t bacnet_metrics_json(char *buffer, size_t size, uint64_t timestamp)
+{
+    struct bacnet_metrics_writer writer = { 0 };
+
+    writer.buffer = buffer;
+    writer.size = buffer ? size : 0;
+    writer.json = true;
+    metrics_printf(
+        &writer, "{\n  \"timestamp\": %llu,\n  \"metrics\": [",
+        (unsigned long long)timestamp);
+    metrics_write(&writer);
+    metrics_printf(&writer, "\n  ]\n}\n");
+
+    return writer.length;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief Export the counters of the BACnet stack in the Prometheus text
+ *  format, or as a JSON snapshot
+ *
+ * The exporter reads the counters that the stack keeps: the transaction
+ * state machine occupancy, the address cache size and hit rate, the COV
+ * subscriptions and change-of-value queue, and the uptime and packet
+ * count of the basic task.  The counters of the optional instrumentation
+ * are added when it is built in: the per-datalink traffic counters with
+ * BACNET_DATALINK_STATISTICS, the transmit queue with
+ * BACNET_DATALINK_TX_SCHEDULER, the per-service counters with
+ * BACNET_APDU_STATISTICS, the MS/TP frame and token counters with
+ * BACDL_MSTP, and the lock waits and queue depths of the threads of the
+ * port with BACNET_LOCK_STATISTICS.
+ *
+ * The exporter only formats text into a buffer.  Serving it, or writing
+ * it to a file, is left to the application.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_METRICS_H
+#define BACNET_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bacnet/bacdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+size_t bacnet_metrics_prometheus(char *buffer, size_t size);
+BACNET_STACK_EXPORT
+size_t bacnet_metrics_json(char *buffer, size_t size, uint64_t timestamp);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
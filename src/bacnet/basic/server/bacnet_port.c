@@ -13,7 +13,7 @@
 /* BACnet definitions */
 #include "bacnet/bacdef.h"
 /* BACnet library API */
-#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/mstimer_wheel.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/basic/object/netport.h"
 #if defined(BACDL_BIP)
@@ -26,34 +26,42 @@
 /* me! */
 #include "bacnet/basic/server/bacnet_port.h"
 
-/* timer used to renew Foreign Device Registration */
-static struct mstimer BACnet_Task_Timer;
+/* event used to renew Foreign Device Registration */
+static struct mstimer_wheel_event BACnet_Task_Event;
 
 /**
- * @brief Periodic tasks for the BACnet datalink layer
+ * @brief The 1 second tasks for the BACnet datalink layer
+ * @param event [in] The 1 second event
+ * @param elapsed [in] The milliseconds since the previous call
  */
-void bacnet_port_task(void)
+static void bacnet_port_task_seconds(
+    struct mstimer_wheel_event *event, unsigned long elapsed)
 {
-    uint32_t elapsed_milliseconds = 0;
-    uint32_t elapsed_seconds = 0;
+    uint32_t elapsed_seconds;
 
-    if (mstimer_expired(&BACnet_Task_Timer)) {
-        /* 1 second tasks */
-        mstimer_reset(&BACnet_Task_Timer);
-        /* presume that the elapsed time is the interval time */
-        elapsed_milliseconds = mstimer_interval(&BACnet_Task_Timer);
-        elapsed_seconds = elapsed_milliseconds / 1000;
+    (void)elapsed;
+    /* presume that the elapsed time is the interval time */
+    elapsed_seconds = event->interval / 1000;
 #if defined(BACDL_BIP)
-        bacnet_port_ipv4_task(elapsed_seconds);
+    bacnet_port_ipv4_task(elapsed_seconds);
 #elif defined(BACDL_BIP6)
-        bacnet_port_ipv6_task(elapsed_seconds);
+    bacnet_port_ipv6_task(elapsed_seconds);
 #elif defined(BACDL_MSTP)
-        bacnet_port_mstp_task(elapsed_seconds);
+    bacnet_port_mstp_task(elapsed_seconds);
 #else
-        /* nothing to do */
-        (void)elapsed_seconds;
+    /* nothing to do */
+    (void)elapsed_seconds;
 #endif
-    }
+}
+
+/**
+ * @brief Periodic tasks for the BACnet datalink layer
+ * @note The tasks are timed events, so this runs every timed event that
+ *  is due, and does nothing more when bacnet_basic_task() already did.
+ */
+void bacnet_port_task(void)
+{
+    mstimer_wheel_task();
 }
 
 /**
@@ -63,7 +71,9 @@ bool bacnet_port_init(void)
 {
     bool status = false;
     /* start the 1 second timer for non-critical cyclic tasks */
-    mstimer_set(&BACnet_Task_Timer, 1000L);
+    mstimer_wheel_event_init(
+        &BACnet_Task_Event, bacnet_port_task_seconds, NULL);
+    mstimer_wheel_event_periodic(&BACnet_Task_Event, 1000L);
 #if defined(BACDL_BIP)
     status = bacnet_port_ipv4_init();
 #elif defined(BACDL_BIP6)
@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -16,16 +17,34 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/dcc.h"
 #include "bacnet/iam.h"
+#include "bacnet/npdu.h"
 /* basic objects, services, TSM */
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/services.h"
+#include "bacnet/basic/sys/trace.h"
+
+/* smallest Max_APDU_Length_Accepted allowed for a BACnet device */
+#define APDU_LENGTH_MIN 50
 
 /* APDU Timeout in Milliseconds */
 static uint16_t Timeout_Milliseconds = 3000;
 /* Number of APDU Retries */
 static uint8_t Number_Of_Retries = 3;
+/* APDU Segment Timeout in Milliseconds */
+static uint16_t Segment_Timeout_Milliseconds = 2000;
+/* largest APDU of the datalink of this device, up to MAX_APDU */
+static uint16_t Max_APDU_Length_Accepted = MAX_APDU;
 static uint8_t Local_Network_Priority; /* Fixing test 10.1.2 Network priority */
+#if defined(BACNET_APDU_STATISTICS)
+static APDU_SERVICE_STATISTICS
+    Confirmed_Statistics[MAX_BACNET_CONFIRMED_SERVICE];
+static APDU_SERVICE_STATISTICS
+    Unconfirmed_Statistics[MAX_BACNET_UNCONFIRMED_SERVICE];
+static apdu_statistics_clock_function Statistics_Clock;
+/* the statistics of the service whose handler is running, for its replies */
+static APDU_SERVICE_STATISTICS *Statistics_Reply;
+#endif
 
 /* a simple table for crossing the services supported */
 static BACNET_SERVICES_SUPPORTED
@@ -107,6 +126,8 @@ static BACNET_SERVICES_SUPPORTED
 /* Confirmed Function Handlers */
 /* If they are not set, they are handled by a reject message */
 static confirmed_function Confirmed_Function[MAX_BACNET_CONFIRMED_SERVICE];
+/* changes each time a confirmed or unconfirmed service handler is set */
+static unsigned Service_Handler_Revision;
 
 /**
  * @brief Set a handler function for the given confirmed service.
@@ -119,6 +140,7 @@ void apdu_set_confirmed_handler(
 {
     if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
         Confirmed_Function[service_choice] = pFunction;
+        Service_Handler_Revision++;
     }
 }
 
@@ -152,9 +174,21 @@ void apdu_set_unconfirmed_handler(
 {
     if (service_choice < MAX_BACNET_UNCONFIRMED_SERVICE) {
         Unconfirmed_Function[service_choice] = pFunction;
+        Service_Handler_Revision++;
     }
 }
 
+/**
+ * @brief Get the revision of the service handlers, which changes each
+ *  time a confirmed or unconfirmed service handler is set, so that the
+ *  services supported can be cached until the revision changes.
+ * @return the revision of the service handlers
+ */
+unsigned apdu_service_handler_revision(void)
+{
+    return Service_Handler_Revision;
+}
+
 /**
  * @brief Checks if the given service is supported or not.
  *
@@ -492,6 +526,42 @@ void apdu_retries_set(uint8_t value)
     Number_Of_Retries = value;
 }
 
+uint16_t apdu_segment_timeout(void)
+{
+    return Segment_Timeout_Milliseconds;
+}
+
+void apdu_segment_timeout_set(uint16_t milliseconds)
+{
+    Segment_Timeout_Milliseconds = milliseconds;
+}
+
+/**
+ * @brief Get the largest APDU that this device sends and accepts, which
+ *  is advertised as its Max_APDU_Length_Accepted
+ * @return largest APDU in octets
+ */
+uint16_t apdu_max_length_accepted(void)
+{
+    return Max_APDU_Length_Accepted;
+}
+
+/**
+ * @brief Set the largest APDU that this device sends and accepts, such
+ *  as the limit of its datalink.  The buffers are sized for MAX_APDU, so
+ *  a larger value is reduced to MAX_APDU.
+ * @param value - largest APDU in octets, at least 50
+ */
+void apdu_max_length_accepted_set(uint16_t value)
+{
+    if (value < APDU_LENGTH_MIN) {
+        value = APDU_LENGTH_MIN;
+    } else if (value > MAX_APDU) {
+        value = MAX_APDU;
+    }
+    Max_APDU_Length_Accepted = value;
+}
+
 /* When network communications are completely disabled,
    only DeviceCommunicationControl and ReinitializeDevice APDUs
    shall be processed and no messages shall be initiated.
@@ -552,6 +622,145 @@ static bool apdu_unconfirmed_dcc_disabled(uint8_t service_choice)
     return status;
 }
 
+#if defined(BACNET_APDU_STATISTICS)
+/**
+ * @brief Set the clock that times the service handlers
+ * @param clock - free running microsecond clock, or NULL to only count
+ */
+void apdu_statistics_clock_set(apdu_statistics_clock_function clock)
+{
+    Statistics_Clock = clock;
+}
+
+/**
+ * @brief Clear the statistics of every service
+ */
+void apdu_statistics_reset(void)
+{
+    memset(Confirmed_Statistics, 0, sizeof(Confirmed_Statistics));
+    memset(Unconfirmed_Statistics, 0, sizeof(Unconfirmed_Statistics));
+}
+
+/**
+ * @brief Copy the statistics of a confirmed service
+ * @param service_choice - BACNET_CONFIRMED_SERVICE
+ * @param statistics - filled with the statistics
+ * @return true if the service choice is valid
+ */
+bool apdu_statistics_confirmed(
+    uint8_t service_choice, APDU_SERVICE_STATISTICS *statistics)
+{
+    if (!statistics || (service_choice >= MAX_BACNET_CONFIRMED_SERVICE)) {
+        return false;
+    }
+    *statistics = Confirmed_Statistics[service_choice];
+
+    return true;
+}
+
+/**
+ * @brief Copy the statistics of an unconfirmed service
+ * @param service_choice - BACNET_UNCONFIRMED_SERVICE
+ * @param statistics - filled with the statistics
+ * @return true if the service choice is valid
+ */
+bool apdu_statistics_unconfirmed(
+    uint8_t service_choice, APDU_SERVICE_STATISTICS *statistics)
+{
+    if (!statistics || (service_choice >= MAX_BACNET_UNCONFIRMED_SERVICE)) {
+        return false;
+    }
+    *statistics = Unconfirmed_Statistics[service_choice];
+
+    return true;
+}
+
+/**
+ * @brief Record an NPDU that is sent, as a reply of the service whose
+ *  handler is running.  Called by the datalink layer for each NPDU.
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes of the NPDU
+ */
+void apdu_statistics_reply(const uint8_t *pdu, unsigned pdu_len)
+{
+    APDU_SERVICE_STATISTICS *statistics = Statistics_Reply;
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint32_t apdu_len;
+    int apdu_offset;
+
+    if (!statistics || !pdu || (pdu_len == 0) || (pdu_len > UINT16_MAX)) {
+        return;
+    }
+    apdu_offset =
+        bacnet_npdu_decode(pdu, (uint16_t)pdu_len, &dest, NULL, &npdu_data);
+    if ((apdu_offset <= 0) || ((unsigned)apdu_offset >= pdu_len) ||
+        npdu_data.network_layer_message) {
+        return;
+    }
+    apdu_len = pdu_len - (unsigned)apdu_offset;
+    statistics->replies++;
+    statistics->reply_octets += apdu_len;
+    if (statistics->reply_octets_max < apdu_len) {
+        statistics->reply_octets_max = apdu_len;
+    }
+    switch (pdu[apdu_offset] & 0xF0) {
+        case PDU_TYPE_ERROR:
+            statistics->errors++;
+            break;
+        case PDU_TYPE_REJECT:
+            statistics->rejects++;
+            break;
+        case PDU_TYPE_ABORT:
+            statistics->aborts++;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Start the statistics of a service handler
+ * @param statistics - statistics of the service
+ * @return the start time of the handler
+ */
+static uint32_t
+apdu_statistics_handler_start(APDU_SERVICE_STATISTICS *statistics)
+{
+    Statistics_Reply = statistics;
+
+    return Statistics_Clock ? Statistics_Clock() : 0;
+}
+
+/**
+ * @brief Record the time of a service handler
+ * @param statistics - statistics of the service
+ * @param start - the start time of the handler
+ */
+static void apdu_statistics_handler_end(
+    APDU_SERVICE_STATISTICS *statistics, uint32_t start)
+{
+    uint32_t elapsed;
+    unsigned bucket = 0;
+
+    Statistics_Reply = NULL;
+    statistics->handled++;
+    if (!Statistics_Clock) {
+        return;
+    }
+    elapsed = Statistics_Clock() - start;
+    statistics->time_total += elapsed;
+    if (statistics->time_max < elapsed) {
+        statistics->time_max = elapsed;
+    }
+    while (elapsed && (bucket < (APDU_STATISTICS_BUCKETS - 1))) {
+        elapsed >>= 1;
+        bucket++;
+    }
+    statistics->time_histogram[bucket]++;
+}
+#endif
+
 /** Process the APDU header and invoke the appropriate service handler
  * to manage the received request.
  * Almost all requests and ACKs invoke this function.
@@ -572,6 +781,10 @@ void apdu_handler(
     uint8_t *service_request = NULL;
     uint16_t service_request_len = 0;
     int len = 0; /* counts where we are in PDU */
+#if defined(BACNET_APDU_STATISTICS)
+    APDU_SERVICE_STATISTICS *statistics = NULL;
+    uint32_t start = 0;
+#endif
 #if !BACNET_SVC_SERVER
     uint8_t invoke_id = 0;
     BACNET_CONFIRMED_SERVICE_ACK_DATA service_ack_data = { 0 };
@@ -579,6 +792,7 @@ void apdu_handler(
     BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
     uint8_t reason = 0;
     bool server = false;
+    BACNET_TSM_COMPLETION_DATA completion = { 0 };
 #endif
 
     if (!apdu) {
@@ -597,13 +811,31 @@ void apdu_handler(
                 /* service data unable to be decoded - simply drop */
                 break;
             }
+#if defined(BACNET_APDU_STATISTICS)
+            if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
+                statistics = &Confirmed_Statistics[service_choice];
+                statistics->requests++;
+            }
+#endif
             if (apdu_confirmed_dcc_disabled(service_choice)) {
                 /* When network communications are completely disabled,
                     only DeviceCommunicationControl and ReinitializeDevice
                     APDUs shall be processed and no messages shall be
                     initiated. */
+#if defined(BACNET_APDU_STATISTICS)
+                if (statistics) {
+                    statistics->dcc_drops++;
+                }
+#endif
                 break;
             }
+#if defined(BACNET_APDU_STATISTICS)
+            if (statistics) {
+                start = apdu_statistics_handler_start(statistics);
+            }
+#endif
+            BACNET_TRACE2(
+                apdu_confirmed_entry, service_choice, service_data.invoke_id);
             if ((service_choice < MAX_BACNET_CONFIRMED_SERVICE) &&
                 (Confirmed_Function[service_choice])) {
                 Confirmed_Function[service_choice](
@@ -612,6 +844,13 @@ void apdu_handler(
                 Unrecognized_Service_Handler(
                     service_request, service_request_len, src, &service_data);
             }
+            BACNET_TRACE2(
+                apdu_confirmed_exit, service_choice, service_data.invoke_id);
+#if defined(BACNET_APDU_STATISTICS)
+            if (statistics) {
+                apdu_statistics_handler_end(statistics, start);
+            }
+#endif
             break;
         case PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST:
             if (apdu_len < 2) {
@@ -621,6 +860,12 @@ void apdu_handler(
             /* prepare the service request buffer and length */
             service_request_len = apdu_len - 2;
             service_request = &apdu[2];
+#if defined(BACNET_APDU_STATISTICS)
+            if (service_choice < MAX_BACNET_UNCONFIRMED_SERVICE) {
+                statistics = &Unconfirmed_Statistics[service_choice];
+                statistics->requests++;
+            }
+#endif
             if (apdu_unconfirmed_dcc_disabled(service_choice)) {
                 /* When network communications are disabled,
                     only DeviceCommunicationControl and
@@ -628,15 +873,35 @@ void apdu_handler(
                     messages shall be initiated. If communications have
                     been initiation disabled, then WhoIs may be
                     processed. */
+#if defined(BACNET_APDU_STATISTICS)
+                if (statistics) {
+                    statistics->dcc_drops++;
+                }
+#endif
                 break;
             }
             if (service_choice < MAX_BACNET_UNCONFIRMED_SERVICE) {
                 if (Unconfirmed_Function[service_choice]) {
+#if defined(BACNET_APDU_STATISTICS)
+                    start = apdu_statistics_handler_start(statistics);
+#endif
+                    BACNET_TRACE1(apdu_unconfirmed_entry, service_choice);
                     Unconfirmed_Function[service_choice](
                         service_request, service_request_len, src);
+                    BACNET_TRACE1(apdu_unconfirmed_exit, service_choice);
+#if defined(BACNET_APDU_STATISTICS)
+                    apdu_statistics_handler_end(statistics, start);
+#endif
                 }
             }
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PDU_TYPE_SEGMENT_ACK:
+            /* the TSM matches the source address and invoke ID
+               to a segmented reply that we are sending */
+            tsm_segment_ack_received(src, apdu, apdu_len);
+            break;
+#endif
 #if !BACNET_SVC_SERVER
         case PDU_TYPE_SIMPLE_ACK:
             if (apdu_len < 3) {
@@ -645,6 +910,12 @@ void apdu_handler(
             invoke_id = apdu[1];
             service_choice = apdu[2];
             if (apdu_confirmed_simple_ack_service(service_choice)) {
+                completion.status = TSM_COMPLETION_ACK;
+                completion.invoke_id = invoke_id;
+                completion.service_choice = service_choice;
+                if (tsm_completion_dispatch(src, &completion)) {
+                    break;
+                }
                 if (Confirmed_ACK_Function[service_choice].simple != NULL) {
                     Confirmed_ACK_Function[service_choice].simple(
                         src, invoke_id);
@@ -673,6 +944,28 @@ void apdu_handler(
             service_request_len = apdu_len - (uint16_t)len;
             service_request = &apdu[len];
             if (!apdu_confirmed_simple_ack_service(service_choice)) {
+#if BACNET_SEGMENTATION_ENABLED
+                if (service_ack_data.segmented_message) {
+                    /* deliver the service data once all of the
+                       segments are reassembled */
+                    if (!tsm_segmented_complex_ack_received(
+                            src, &service_ack_data, service_choice,
+                            service_request, service_request_len,
+                            &service_request, &service_request_len)) {
+                        break;
+                    }
+                    service_ack_data.segmented_message = false;
+                    service_ack_data.more_follows = false;
+                }
+#endif
+                completion.status = TSM_COMPLETION_ACK;
+                completion.invoke_id = invoke_id;
+                completion.service_choice = service_choice;
+                completion.service_data = service_request;
+                completion.service_data_len = service_request_len;
+                if (tsm_completion_dispatch(src, &completion)) {
+                    break;
+                }
                 if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
                     if (Confirmed_ACK_Function[service_choice].complex !=
                         NULL) {
@@ -684,11 +977,6 @@ void apdu_handler(
                 tsm_free_invoke_id(invoke_id);
             }
             break;
-        case PDU_TYPE_SEGMENT_ACK:
-            /* FIXME: what about a denial of service attack here?
-                we could check src to see if that matched the tsm */
-            tsm_free_invoke_id(invoke_id);
-            break;
         case PDU_TYPE_ERROR:
             if (apdu_len < 3) {
                 break;
@@ -698,6 +986,23 @@ void apdu_handler(
             /* prepare the service request buffer and length */
             service_request_len = apdu_len - 3;
             service_request = &apdu[3];
+            completion.status = TSM_COMPLETION_ERROR;
+            completion.invoke_id = invoke_id;
+            completion.service_choice = service_choice;
+            completion.service_data = service_request;
+            completion.service_data_len = service_request_len;
+            if (!apdu_complex_error(service_choice)) {
+                len = bacerror_decode_error_class_and_code(
+                    service_request, service_request_len, &error_class,
+                    &error_code);
+                if (len != 0) {
+                    completion.error_class = error_class;
+                    completion.error_code = error_code;
+                }
+            }
+            if (tsm_completion_dispatch(src, &completion)) {
+                break;
+            }
             if (apdu_complex_error(service_choice)) {
                 if (Error_Function[service_choice].complex) {
                     Error_Function[service_choice].complex(
@@ -705,9 +1010,6 @@ void apdu_handler(
                         service_request_len);
                 }
             } else if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
-                len = bacerror_decode_error_class_and_code(
-                    service_request, service_request_len, &error_class,
-                    &error_code);
                 if ((len != 0) && (Error_Function[service_choice].error)) {
                     Error_Function[service_choice].error(
                         src, invoke_id, (BACNET_ERROR_CLASS)error_class,
@@ -722,6 +1024,12 @@ void apdu_handler(
             }
             invoke_id = apdu[1];
             reason = apdu[2];
+            completion.status = TSM_COMPLETION_REJECT;
+            completion.invoke_id = invoke_id;
+            completion.reason = reason;
+            if (tsm_completion_dispatch(src, &completion)) {
+                break;
+            }
             if (Reject_Function) {
                 Reject_Function(src, invoke_id, reason);
             }
@@ -734,6 +1042,21 @@ void apdu_handler(
             server = apdu[0] & 0x01;
             invoke_id = apdu[1];
             reason = apdu[2];
+#if BACNET_SEGMENTATION_ENABLED
+            if (!server) {
+                /* the client may abort a segmented reply we are sending */
+                tsm_segment_abort_received(src, invoke_id);
+            }
+#endif
+            if (server) {
+                /* only a server abort is the reply to our request */
+                completion.status = TSM_COMPLETION_ABORT;
+                completion.invoke_id = invoke_id;
+                completion.reason = reason;
+                if (tsm_completion_dispatch(src, &completion)) {
+                    break;
+                }
+            }
             if (Abort_Function) {
                 Abort_Function(src, invoke_id, reason, server);
             }
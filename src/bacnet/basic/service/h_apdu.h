@@ -95,6 +95,48 @@ void apdu_set_confirmed_simple_ack_handler(
     BACNET_CONFIRMED_SERVICE service_choice,
     confirmed_simple_ack_function pFunction);
 
+/* number of buckets in the handler time histograms.  Bucket 0 counts
+   times under 1 microsecond, bucket N counts 2^(N-1) to 2^N-1
+   microseconds, and the last bucket also counts all of the longer times. */
+#ifndef APDU_STATISTICS_BUCKETS
+#define APDU_STATISTICS_BUCKETS 24
+#endif
+
+/**
+ * Statistics of one service, recorded by apdu_handler() with
+ * BACNET_APDU_STATISTICS
+ *
+ * @{
+ */
+typedef struct apdu_service_statistics {
+    /** requests received, including those dropped */
+    uint32_t requests;
+    /** requests dropped because DeviceCommunicationControl disabled them */
+    uint32_t dcc_drops;
+    /** requests answered by the handler, timed by the statistics clock */
+    uint32_t handled;
+    /** total and longest handler time, in microseconds */
+    uint64_t time_total;
+    uint32_t time_max;
+    /** handler times, in power-of-two microsecond buckets */
+    uint32_t time_histogram[APDU_STATISTICS_BUCKETS];
+    /** APDUs sent by the handler, and their total and largest size */
+    uint32_t replies;
+    uint64_t reply_octets;
+    uint32_t reply_octets_max;
+    /** Error, Reject, and Abort replies sent by the handler */
+    uint32_t errors;
+    uint32_t rejects;
+    uint32_t aborts;
+} APDU_SERVICE_STATISTICS;
+/** @} */
+
+/**
+ * @brief Free running clock for the handler times
+ * @return the time in microseconds
+ */
+typedef uint32_t (*apdu_statistics_clock_function)(void);
+
 /* configure reject for confirmed services that are not supported */
 BACNET_STACK_EXPORT
 void apdu_set_unrecognized_service_handler_handler(
@@ -111,6 +153,8 @@ void apdu_set_unconfirmed_handler(
 /* returns true if the service is supported by a handler */
 BACNET_STACK_EXPORT
 bool apdu_service_supported(BACNET_SERVICES_SUPPORTED service_supported);
+BACNET_STACK_EXPORT
+unsigned apdu_service_handler_revision(void);
 
 /* Function to translate a SERVICE_SUPPORTED_ enum to its SERVICE_CONFIRMED_
  *  or SERVICE_UNCONFIRMED_ index.
@@ -155,6 +199,14 @@ BACNET_STACK_EXPORT
 uint8_t apdu_retries(void);
 BACNET_STACK_EXPORT
 void apdu_retries_set(uint8_t value);
+BACNET_STACK_EXPORT
+uint16_t apdu_segment_timeout(void);
+BACNET_STACK_EXPORT
+void apdu_segment_timeout_set(uint16_t value);
+BACNET_STACK_EXPORT
+uint16_t apdu_max_length_accepted(void);
+BACNET_STACK_EXPORT
+void apdu_max_length_accepted_set(uint16_t value);
 
 BACNET_STACK_EXPORT
 void apdu_handler(
@@ -162,6 +214,21 @@ void apdu_handler(
     uint8_t *apdu, /* APDU data */
     uint16_t pdu_len); /* for confirmed messages */
 
+#if defined(BACNET_APDU_STATISTICS)
+BACNET_STACK_EXPORT
+void apdu_statistics_clock_set(apdu_statistics_clock_function clock);
+BACNET_STACK_EXPORT
+void apdu_statistics_reset(void);
+BACNET_STACK_EXPORT
+bool apdu_statistics_confirmed(
+    uint8_t service_choice, APDU_SERVICE_STATISTICS *statistics);
+BACNET_STACK_EXPORT
+bool apdu_statistics_unconfirmed(
+    uint8_t service_choice, APDU_SERVICE_STATISTICS *statistics);
+BACNET_STACK_EXPORT
+void apdu_statistics_reply(const uint8_t *pdu, unsigned pdu_len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief AuditNotification service handlers that insert the list of
+ *  notifications of each request into the Audit Log objects
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacaudit.h"
+#include "bacnet/apdu.h"
+#include "bacnet/npdu.h"
+#include "bacnet/abort.h"
+#include "bacnet/reject.h"
+/* basic objects, services, TSM, and datalink */
+#include "bacnet/basic/object/auditlog.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/basic/sys/debug.h"
+
+/* number of notifications decoded before they are inserted together */
+#ifndef AUDIT_NOTIFICATION_INSERT_SIZE
+#define AUDIT_NOTIFICATION_INSERT_SIZE 8
+#endif
+
+static BACNET_AUDIT_NOTIFICATION Audit_Insert[AUDIT_NOTIFICATION_INSERT_SIZE];
+
+/**
+ * @brief Insert notifications into every Audit Log object
+ * @param count - number of notifications in the insert buffer
+ */
+static void audit_notification_insert(unsigned count)
+{
+    unsigned index;
+
+    for (index = 0; index < Audit_Log_Count(); index++) {
+        Audit_Log_Record_Notification_Insert_List(
+            Audit_Log_Index_To_Instance(index), Audit_Insert, count);
+    }
+}
+
+/**
+ * @brief Decode the list of notifications of a request and insert them
+ *  into the Audit Log objects, a buffer of them at a time
+ * @param apdu - the service request
+ * @param apdu_size - number of bytes in the service request
+ * @return number of bytes decoded, or #BACNET_STATUS_ERROR (-1)
+ *  if malformed
+ */
+static int audit_notification_decode_insert(
+    const uint8_t *apdu, uint32_t apdu_size)
+{
+    int len = 0;
+    int apdu_len = 0;
+    unsigned count = 0;
+
+    if (!bacnet_is_opening_tag_number(apdu, apdu_size, 0, &len)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    while (!bacnet_is_closing_tag_number(
+        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+        len = bacnet_audit_log_notification_decode(
+            &apdu[apdu_len], apdu_size - apdu_len, &Audit_Insert[count]);
+        if (len <= 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        apdu_len += len;
+        count++;
+        if (count == AUDIT_NOTIFICATION_INSERT_SIZE) {
+            audit_notification_insert(count);
+            count = 0;
+        }
+    }
+    apdu_len += len;
+    if (count > 0) {
+        audit_notification_insert(count);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Handler for a ConfirmedAuditNotification request
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_audit_notification(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS my_address = { 0 };
+    int len = 0;
+    int pdu_len = 0;
+    int bytes_sent = 0;
+
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, service_data->priority);
+    pdu_len = npdu_encode_pdu(
+        &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+    if (service_len == 0) {
+        len = reject_encode_apdu(
+            &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+            REJECT_REASON_MISSING_REQUIRED_PARAMETER);
+        debug_print("Audit: Missing Required Parameter. Sending Reject!\n");
+    } else if (service_data->segmented_message) {
+        len = abort_encode_apdu(
+            &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+            ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
+        debug_print("Audit: Segmented message. Sending Abort!\n");
+    } else if (
+        audit_notification_decode_insert(service_request, service_len) <= 0) {
+        len = reject_encode_apdu(
+            &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+            REJECT_REASON_INVALID_TAG);
+        debug_print("Audit: Bad Encoding. Sending Reject!\n");
+    } else {
+        len = encode_simple_ack(
+            &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+            SERVICE_CONFIRMED_AUDIT_NOTIFICATION);
+        debug_print("Audit: Sending Simple Ack!\n");
+    }
+    pdu_len += len;
+    bytes_sent = datalink_send_pdu(
+        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("Audit: Failed to send PDU");
+    }
+}
+
+/**
+ * @brief Handler for an UnconfirmedAuditNotification request
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ */
+void handler_uaudit_notification(
+    uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src)
+{
+    (void)src;
+    if (audit_notification_decode_insert(service_request, service_len) <= 0) {
+        debug_print("UAudit: Bad Encoding!\n");
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Header file for the AuditNotification service handlers
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_SERVICE_HANDLER_AUDIT_NOTIFICATION_H
+#define BACNET_BASIC_SERVICE_HANDLER_AUDIT_NOTIFICATION_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/apdu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void handler_audit_notification(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
+void handler_uaudit_notification(
+    uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
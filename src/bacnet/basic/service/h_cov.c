@@ -5,9 +5,11 @@
  * @date 2007
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -29,15 +31,34 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/trace.h"
 #include "bacnet/datalink/datalink.h"
 
 #ifndef MAX_COV_PROPERTIES
 #define MAX_COV_PROPERTIES 2
 #endif
+/* largest encoded value of a property monitored with SubscribeCOVProperty */
+#ifndef MAX_COV_PROPERTY_VALUE_SIZE
+#define MAX_COV_PROPERTY_VALUE_SIZE 32
+#endif
+/* encoded Status_Flags: tag, unused bits, and the flags */
+#define COV_STATUS_FLAGS_SIZE 4
+/* encoded listOfValues of a property subscription: the monitored
+   property and Status_Flags, each with its identifier and tags */
+#define COV_PROPERTY_VALUES_SIZE \
+    (MAX_COV_PROPERTY_VALUE_SIZE + COV_STATUS_FLAGS_SIZE + 24)
+
+/* marker for a subscription without a COV address */
+#define COV_ADDRESS_NONE UINT_MAX
 
 typedef struct BACnet_COV_Address {
     bool valid : 1;
     BACNET_ADDRESS dest;
+    /* number of subscriptions that use this address */
+    unsigned ref_count;
+    /* next address in the hash chain or free list, index+1 or 0 */
+    unsigned next;
 } BACNET_COV_ADDRESS;
 
 /* note: This COV service only monitors the properties
@@ -46,41 +67,311 @@ typedef struct BACnet_COV_Subscription_Flags {
     bool valid : 1;
     bool issueConfirmedNotifications : 1; /* optional */
     bool send_requested : 1;
+    /* SubscribeCOVProperty - only the monitored property is notified */
+    bool property : 1;
+    bool covIncrementPresent : 1;
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
 typedef struct BACnet_COV_Subscription {
     BACNET_COV_SUBSCRIPTION_FLAGS flag;
     unsigned dest_index;
+    /* next subscription in the object hash chain or free list,
+       index+1 or 0 */
+    unsigned next;
     uint8_t invokeID; /* for confirmed COV */
     uint32_t subscriberProcessIdentifier;
     uint32_t lifetime; /* optional */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+    /* SubscribeCOVProperty - the monitored property, its increment,
+       and its encoded value and Status_Flags when last notified */
+    struct BACnetPropertyReference monitoredProperty;
+    float covIncrement;
+    uint16_t value_len;
+    uint16_t status_flags_len;
+    uint8_t value[MAX_COV_PROPERTY_VALUE_SIZE];
+    uint8_t status_flags[COV_STATUS_FLAGS_SIZE];
 } BACNET_COV_SUBSCRIPTION;
 
+/* Subscriptions are found by monitored object through a hash chain,
+   and subscriber addresses are interned with a reference count.
+   With BACNET_COV_DYNAMIC, the sizes below are the initial table sizes
+   and each table doubles when it is full. */
 #ifndef MAX_COV_SUBCRIPTIONS
 #define MAX_COV_SUBCRIPTIONS 128
 #endif
-static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
 #ifndef MAX_COV_ADDRESSES
 #define MAX_COV_ADDRESSES 16
 #endif
-static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
+/* queue of objects that reported a change-of-value condition */
+#ifndef MAX_COV_CHANGED_OBJECTS
+#define MAX_COV_CHANGED_OBJECTS 32
+#endif
+/* states for transmitting */
+enum cov_task_state {
+    COV_STATE_IDLE = 0,
+    COV_STATE_MARK,
+    COV_STATE_CLEAR,
+    COV_STATE_FREE,
+    COV_STATE_SEND
+};
+/* the subscriptions of one stack context */
+struct cov_context {
+#if defined(BACNET_COV_DYNAMIC)
+    BACNET_COV_SUBSCRIPTION *Subscriptions;
+    unsigned *Object_Bucket;
+    unsigned Subscriptions_Size;
+    BACNET_COV_ADDRESS *Addresses;
+    unsigned *Address_Bucket;
+    unsigned Addresses_Size;
+#else
+    BACNET_COV_SUBSCRIPTION Subscriptions[MAX_COV_SUBCRIPTIONS];
+    unsigned Object_Bucket[MAX_COV_SUBCRIPTIONS];
+    BACNET_COV_ADDRESS Addresses[MAX_COV_ADDRESSES];
+    unsigned Address_Bucket[MAX_COV_ADDRESSES];
+#endif
+    /* number of table entries ever used - the rest have never been
+       touched */
+    unsigned Subscriptions_Used;
+    unsigned Addresses_Used;
+    /* released entries that can be reused, index+1 or 0 */
+    unsigned Subscriptions_Free;
+    unsigned Addresses_Free;
+    BACNET_OBJECT_ID Changed_Queue[MAX_COV_CHANGED_OBJECTS];
+    unsigned Changed_Head;
+    unsigned Changed_Count;
+    /* queue overflowed - the next cycle falls back to a full scan */
+    bool Changed_Overflow;
+    /* true when any subscription has a send or confirmation outstanding */
+    bool Work_Pending;
+    /* subscription visited by the COV task, and its state */
+    unsigned Task_Index;
+    enum cov_task_state Task_State;
+    /* monitored properties are read here before they are snapshot */
+    uint8_t Property_Buffer[MAX_APDU];
+};
+static struct cov_context COV_Default;
+/* the subscriptions of the calling thread */
+static BACNET_STACK_THREAD_LOCAL struct cov_context *COV = &COV_Default;
+#if defined(BACNET_COV_DYNAMIC)
+#define COV_Subscriptions_Size (COV->Subscriptions_Size)
+#define COV_Addresses_Size (COV->Addresses_Size)
+#else
+static const unsigned COV_Subscriptions_Size = MAX_COV_SUBCRIPTIONS;
+static const unsigned COV_Addresses_Size = MAX_COV_ADDRESSES;
+#endif
+/* true when objects report their changes with handler_cov_object_changed */
+static bool COV_Event_Driven;
+/* object types whose change-of-value condition is evaluated in bulk */
+#ifndef MAX_COV_BULK_TYPES
+#define MAX_COV_BULK_TYPES 8
+#endif
+static struct cov_bulk_type {
+    BACNET_OBJECT_TYPE object_type;
+    cov_object_bulk_function function;
+} COV_Bulk_Types[MAX_COV_BULK_TYPES];
+static unsigned COV_Bulk_Types_Count;
+/* changed-object bitmap filled by the bulk functions */
+static uint32_t *COV_Bulk_Bitmap;
+static unsigned COV_Bulk_Bitmap_Words;
+
+/**
+ * @brief Compute the hash chain of a monitored object
+ * @param object_type - monitored object type
+ * @param object_instance - monitored object instance
+ * @return bucket number 0..COV_Subscriptions_Size-1
+ */
+static unsigned
+cov_object_bucket(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)object_type << 22) ^ object_instance;
+    hash *= 2654435761UL;
+
+    return (unsigned)(hash % COV_Subscriptions_Size);
+}
+
+/**
+ * @brief Compute the hash chain of a COV address, using the same
+ *  fields that bacnet_address_same() compares
+ * @param dest - address to hash
+ * @return bucket number 0..COV_Addresses_Size-1
+ */
+static unsigned cov_address_bucket(const BACNET_ADDRESS *dest)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned i;
+
+    hash = (hash ^ dest->mac_len) * 16777619UL;
+    for (i = 0; (i < dest->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash ^ dest->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (dest->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (dest->net >> 8)) * 16777619UL;
+    if (dest->net) {
+        hash = (hash ^ dest->len) * 16777619UL;
+        for (i = 0; (i < dest->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash ^ dest->adr[i]) * 16777619UL;
+        }
+    }
+
+    return (unsigned)(hash % COV_Addresses_Size);
+}
+
+/**
+ * @brief Link a valid subscription into its object hash chain
+ * @param index - subscription index
+ */
+static void cov_subscription_link(unsigned index)
+{
+    unsigned bucket;
+
+    bucket = cov_object_bucket(
+        (BACNET_OBJECT_TYPE)COV->Subscriptions[index]
+            .monitoredObjectIdentifier.type,
+        COV->Subscriptions[index].monitoredObjectIdentifier.instance);
+    COV->Subscriptions[index].next = COV->Object_Bucket[bucket];
+    COV->Object_Bucket[bucket] = index + 1;
+}
+
+/**
+ * @brief Link a valid address into its address hash chain
+ * @param index - address index
+ */
+static void cov_address_link(unsigned index)
+{
+    unsigned bucket;
+
+    bucket = cov_address_bucket(&COV->Addresses[index].dest);
+    COV->Addresses[index].next = COV->Address_Bucket[bucket];
+    COV->Address_Bucket[bucket] = index + 1;
+}
+
+#if defined(BACNET_COV_DYNAMIC)
+/**
+ * @brief Double the size of the subscription table and rehash it
+ * @return true if the table grew
+ */
+static bool cov_subscriptions_grow(void)
+{
+    BACNET_COV_SUBSCRIPTION *subscriptions;
+    unsigned *buckets;
+    unsigned size;
+    unsigned index;
+
+    if (COV_Subscriptions_Size) {
+        size = COV_Subscriptions_Size * 2;
+    } else {
+        size = MAX_COV_SUBCRIPTIONS;
+    }
+    if ((size <= COV_Subscriptions_Size) ||
+        (size > (UINT_MAX / sizeof(BACNET_COV_SUBSCRIPTION)))) {
+        return false;
+    }
+    /* the buckets are rebuilt, so they are not copied */
+    buckets = BACNET_MEMPOOL_CALLOC(size * sizeof(unsigned));
+    if (!buckets) {
+        return false;
+    }
+    subscriptions = BACNET_MEMPOOL_REALLOC(
+        COV->Subscriptions,
+        COV_Subscriptions_Size * sizeof(BACNET_COV_SUBSCRIPTION),
+        size * sizeof(BACNET_COV_SUBSCRIPTION));
+    if (!subscriptions) {
+        BACNET_MEMPOOL_FREE(buckets, size * sizeof(unsigned));
+        return false;
+    }
+    COV->Subscriptions = subscriptions;
+    BACNET_MEMPOOL_FREE(
+        COV->Object_Bucket, COV_Subscriptions_Size * sizeof(unsigned));
+    COV->Object_Bucket = buckets;
+    memset(
+        &COV->Subscriptions[COV_Subscriptions_Size], 0,
+        (size - COV_Subscriptions_Size) * sizeof(BACNET_COV_SUBSCRIPTION));
+    COV_Subscriptions_Size = size;
+    for (index = 0; index < COV->Subscriptions_Used; index++) {
+        if (COV->Subscriptions[index].flag.valid) {
+            cov_subscription_link(index);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Double the size of the address table and rehash it
+ * @return true if the table grew
+ */
+static bool cov_addresses_grow(void)
+{
+    BACNET_COV_ADDRESS *addresses;
+    unsigned *buckets;
+    unsigned size;
+    unsigned index;
+
+    if (COV_Addresses_Size) {
+        size = COV_Addresses_Size * 2;
+    } else {
+        size = MAX_COV_ADDRESSES;
+    }
+    if ((size <= COV_Addresses_Size) ||
+        (size > (UINT_MAX / sizeof(BACNET_COV_ADDRESS)))) {
+        return false;
+    }
+    /* the buckets are rebuilt, so they are not copied */
+    buckets = BACNET_MEMPOOL_CALLOC(size * sizeof(unsigned));
+    if (!buckets) {
+        return false;
+    }
+    addresses = BACNET_MEMPOOL_REALLOC(
+        COV->Addresses, COV_Addresses_Size * sizeof(BACNET_COV_ADDRESS),
+        size * sizeof(BACNET_COV_ADDRESS));
+    if (!addresses) {
+        BACNET_MEMPOOL_FREE(buckets, size * sizeof(unsigned));
+        return false;
+    }
+    COV->Addresses = addresses;
+    BACNET_MEMPOOL_FREE(
+        COV->Address_Bucket, COV_Addresses_Size * sizeof(unsigned));
+    COV->Address_Bucket = buckets;
+    memset(
+        &COV->Addresses[COV_Addresses_Size], 0,
+        (size - COV_Addresses_Size) * sizeof(BACNET_COV_ADDRESS));
+    COV_Addresses_Size = size;
+    for (index = 0; index < COV->Addresses_Used; index++) {
+        if (COV->Addresses[index].valid) {
+            cov_address_link(index);
+        }
+    }
+
+    return true;
+}
+#else
+static bool cov_subscriptions_grow(void)
+{
+    return false;
+}
+
+static bool cov_addresses_grow(void)
+{
+    return false;
+}
+#endif
 
 /**
  * Gets the address from the list of COV addresses
  *
  * @param  index - offset into COV address list where address is stored
- * @param  dest - address to be filled when found
  *
- * @return true if valid address, false if not valid or not found
+ * @return pointer to the address, or NULL if not valid or not found
  */
 static BACNET_ADDRESS *cov_address_get(unsigned index)
 {
     BACNET_ADDRESS *cov_dest = NULL;
 
-    if (index < MAX_COV_ADDRESSES) {
-        if (COV_Addresses[index].valid) {
-            cov_dest = &COV_Addresses[index].dest;
+    if (index < COV->Addresses_Used) {
+        if (COV->Addresses[index].valid) {
+            cov_dest = &COV->Addresses[index].dest;
         }
     }
 
@@ -88,34 +379,41 @@ static BACNET_ADDRESS *cov_address_get(unsigned index)
 }
 
 /**
- * Removes the address from the list of COV addresses, if it is not
- * used by other COV subscriptions
+ * Releases one reference to an address in the list of COV addresses,
+ * and removes the address when no other COV subscription uses it
+ *
+ * @param  index - offset into COV address list where address is stored
  */
-static void cov_address_remove_unused(void)
+static void cov_address_release(unsigned index)
 {
-    unsigned index = 0;
-    unsigned cov_index = 0;
-    bool found = false;
+    unsigned bucket;
+    unsigned *link;
 
-    for (cov_index = 0; cov_index < MAX_COV_ADDRESSES; cov_index++) {
-        if (COV_Addresses[cov_index].valid) {
-            found = false;
-            for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-                if ((COV_Subscriptions[index].flag.valid) &&
-                    (COV_Subscriptions[index].dest_index == cov_index)) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                COV_Addresses[cov_index].valid = false;
-            }
+    if ((index >= COV->Addresses_Used) || (!COV->Addresses[index].valid)) {
+        return;
+    }
+    if (COV->Addresses[index].ref_count > 1) {
+        COV->Addresses[index].ref_count--;
+        return;
+    }
+    bucket = cov_address_bucket(&COV->Addresses[index].dest);
+    link = &COV->Address_Bucket[bucket];
+    while (*link) {
+        if (*link == (index + 1)) {
+            *link = COV->Addresses[index].next;
+            break;
         }
+        link = &COV->Addresses[*link - 1].next;
     }
+    COV->Addresses[index].valid = false;
+    COV->Addresses[index].ref_count = 0;
+    COV->Addresses[index].next = COV->Addresses_Free;
+    COV->Addresses_Free = index + 1;
 }
 
 /**
- * Adds the address to the list of COV addresses
+ * Adds the address to the list of COV addresses, or adds a reference
+ * when the address is already in the list
  *
  * @param  dest - address to be added if there is room in the list
  *
@@ -123,40 +421,144 @@ static void cov_address_remove_unused(void)
  */
 static int cov_address_add(const BACNET_ADDRESS *dest)
 {
-    int index = -1;
-    unsigned i = 0;
-    bool found = false;
-    bool valid = false;
-    BACNET_ADDRESS *cov_dest = NULL;
+    unsigned index = 0;
+    unsigned link = 0;
 
-    if (dest) {
-        for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-            valid = COV_Addresses[i].valid;
-            if (valid) {
-                cov_dest = &COV_Addresses[i].dest;
-                found = bacnet_address_same(dest, cov_dest);
-                if (found) {
-                    index = i;
-                    break;
-                }
+    if (!dest) {
+        return -1;
+    }
+    if (COV->Addresses_Used) {
+        link = COV->Address_Bucket[cov_address_bucket(dest)];
+        while (link) {
+            index = link - 1;
+            if (bacnet_address_same(dest, &COV->Addresses[index].dest)) {
+                COV->Addresses[index].ref_count++;
+                return (int)index;
             }
+            link = COV->Addresses[index].next;
         }
-        if (!found) {
-            /* find a free place to add a new address */
-            for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-                valid = COV_Addresses[i].valid;
-                if (!valid) {
-                    index = i;
-                    cov_dest = &COV_Addresses[i].dest;
-                    bacnet_address_copy(cov_dest, dest);
-                    COV_Addresses[i].valid = true;
-                    break;
-                }
+    }
+    /* find a free place to add a new address */
+    if (COV->Addresses_Free) {
+        index = COV->Addresses_Free - 1;
+        COV->Addresses_Free = COV->Addresses[index].next;
+    } else if (
+        (COV->Addresses_Used < COV_Addresses_Size) || cov_addresses_grow()) {
+        index = COV->Addresses_Used;
+        COV->Addresses_Used++;
+    } else {
+        return -1;
+    }
+    bacnet_address_copy(&COV->Addresses[index].dest, dest);
+    COV->Addresses[index].valid = true;
+    COV->Addresses[index].ref_count = 1;
+    cov_address_link(index);
+
+    return (int)index;
+}
+
+/**
+ * @brief Finds the subscription that matches the monitored object,
+ *  subscriber process identifier, and subscriber address
+ * @param src - subscriber address
+ * @param cov_data - subscription request
+ * @return subscription index, or -1 if not found
+ */
+static int cov_subscription_find(
+    const BACNET_ADDRESS *src, const BACNET_SUBSCRIBE_COV_DATA *cov_data)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription;
+    const BACNET_ADDRESS *dest;
+    unsigned link;
+
+    if (!COV->Subscriptions_Used) {
+        return -1;
+    }
+    link = COV->Object_Bucket[cov_object_bucket(
+        (BACNET_OBJECT_TYPE)cov_data->monitoredObjectIdentifier.type,
+        cov_data->monitoredObjectIdentifier.instance)];
+    while (link) {
+        cov_subscription = &COV->Subscriptions[link - 1];
+        if ((cov_subscription->monitoredObjectIdentifier.type ==
+             cov_data->monitoredObjectIdentifier.type) &&
+            (cov_subscription->monitoredObjectIdentifier.instance ==
+             cov_data->monitoredObjectIdentifier.instance) &&
+            (cov_subscription->subscriberProcessIdentifier ==
+             cov_data->subscriberProcessIdentifier) &&
+            (cov_subscription->flag.property ==
+             cov_data->covSubscribeToProperty) &&
+            (!cov_subscription->flag.property ||
+             ((cov_subscription->monitoredProperty.property_identifier ==
+               cov_data->monitoredProperty.property_identifier) &&
+              (cov_subscription->monitoredProperty.property_array_index ==
+               cov_data->monitoredProperty.property_array_index)))) {
+            dest = cov_address_get(cov_subscription->dest_index);
+            /* skip address matching if we don't have an address */
+            if (!dest || bacnet_address_same(src, dest)) {
+                return (int)(link - 1);
             }
         }
+        link = cov_subscription->next;
     }
 
-    return index;
+    return -1;
+}
+
+/**
+ * @brief Takes an unused subscription from the table
+ * @return subscription index, or -1 if the table is full
+ */
+static int cov_subscription_alloc(void)
+{
+    unsigned index;
+
+    if (COV->Subscriptions_Free) {
+        index = COV->Subscriptions_Free - 1;
+        COV->Subscriptions_Free = COV->Subscriptions[index].next;
+    } else if (
+        (COV->Subscriptions_Used < COV_Subscriptions_Size) ||
+        cov_subscriptions_grow()) {
+        index = COV->Subscriptions_Used;
+        COV->Subscriptions_Used++;
+    } else {
+        return -1;
+    }
+
+    return (int)index;
+}
+
+/**
+ * @brief Removes a subscription from its object hash chain, releases its
+ *  address, and returns it to the unused subscriptions
+ * @param index - subscription index
+ */
+static void cov_subscription_remove(unsigned index)
+{
+    unsigned bucket;
+    unsigned *link;
+
+    if ((index >= COV->Subscriptions_Used) ||
+        (!COV->Subscriptions[index].flag.valid)) {
+        return;
+    }
+    bucket = cov_object_bucket(
+        (BACNET_OBJECT_TYPE)COV->Subscriptions[index]
+            .monitoredObjectIdentifier.type,
+        COV->Subscriptions[index].monitoredObjectIdentifier.instance);
+    link = &COV->Object_Bucket[bucket];
+    while (*link) {
+        if (*link == (index + 1)) {
+            *link = COV->Subscriptions[index].next;
+            break;
+        }
+        link = &COV->Subscriptions[*link - 1].next;
+    }
+    cov_address_release(COV->Subscriptions[index].dest_index);
+    /* initialize with invalid COV address */
+    COV->Subscriptions[index].flag.valid = false;
+    COV->Subscriptions[index].dest_index = COV_ADDRESS_NONE;
+    COV->Subscriptions[index].next = COV->Subscriptions_Free;
+    COV->Subscriptions_Free = index + 1;
 }
 
 /*
@@ -247,10 +649,27 @@ static int cov_encode_subscription(
         &apdu[apdu_len], 0, cov_subscription->monitoredObjectIdentifier.type,
         cov_subscription->monitoredObjectIdentifier.instance);
     apdu_len += len;
-    /* propertyIdentifier [1] */
-    /* FIXME: we are monitoring 2 properties! How to encode? */
-    len = encode_context_enumerated(&apdu[apdu_len], 1, PROP_PRESENT_VALUE);
-    apdu_len += len;
+    if (cov_subscription->flag.property) {
+        /* propertyIdentifier [1] */
+        len = encode_context_enumerated(
+            &apdu[apdu_len], 1,
+            cov_subscription->monitoredProperty.property_identifier);
+        apdu_len += len;
+        /* propertyArrayIndex [2] */
+        if (cov_subscription->monitoredProperty.property_array_index !=
+            BACNET_ARRAY_ALL) {
+            len = encode_context_unsigned(
+                &apdu[apdu_len], 2,
+                cov_subscription->monitoredProperty.property_array_index);
+            apdu_len += len;
+        }
+    } else {
+        /* propertyIdentifier [1] */
+        /* FIXME: we are monitoring 2 properties! How to encode? */
+        len =
+            encode_context_enumerated(&apdu[apdu_len], 1, PROP_PRESENT_VALUE);
+        apdu_len += len;
+    }
     /* MonitoredPropertyReference [1] - closing */
     len = encode_closing_tag(&apdu[apdu_len], 1);
     apdu_len += len;
@@ -262,6 +681,12 @@ static int cov_encode_subscription(
     len =
         encode_context_unsigned(&apdu[apdu_len], 3, cov_subscription->lifetime);
     apdu_len += len;
+    /* COVIncrement [4] REAL OPTIONAL */
+    if (cov_subscription->flag.covIncrementPresent) {
+        len = encode_context_real(
+            &apdu[apdu_len], 4, cov_subscription->covIncrement);
+        apdu_len += len;
+    }
 
     return apdu_len;
 }
@@ -278,9 +703,10 @@ static int cov_encode_subscription(
  */
 /* Maximume length for an encoded COV subscription  - 31 bytes for BACNET IP6
  * 35 bytes for IPv4 (longest MAC) with the maximum length
- * of PID (5 bytes) and lets round it up to the 64bit machine word
+ * of PID (5 bytes), plus the array index and COVIncrement of a property
+ * subscription (10 bytes), and lets round it up to the 64bit machine word
  * alignment */
-#define MAX_COV_SUB_SIZE (40)
+#define MAX_COV_SUB_SIZE (48)
 int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
 {
     if (apdu) {
@@ -290,13 +716,13 @@ int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
         unsigned index = 0;
         int apdu_len = 0;
 
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].flag.valid) {
+        for (index = 0; index < COV->Subscriptions_Used; index++) {
+            if (COV->Subscriptions[index].flag.valid) {
                 /* Lets encode a COV subscription into an intermediate buffer
                  * that can hold it */
                 int len = cov_encode_subscription(
                     &cov_sub[0], max_apdu - apdu_len,
-                    &COV_Subscriptions[index]);
+                    &COV->Subscriptions[index]);
 
                 if ((apdu_len + len) > max_apdu) {
                     return -2;
@@ -314,6 +740,33 @@ int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
     return 0;
 }
 
+/** Count the active COV subscriptions.
+ * @ingroup DSCOV
+ * @return number of subscriptions
+ */
+unsigned handler_cov_subscription_count(void)
+{
+    unsigned index;
+    unsigned count = 0;
+
+    for (index = 0; index < COV->Subscriptions_Used; index++) {
+        if (COV->Subscriptions[index].flag.valid) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/** Get the number of changed objects waiting in the change-of-value queue.
+ * @ingroup DSCOV
+ * @return number of objects
+ */
+unsigned handler_cov_changed_count(void)
+{
+    return COV->Changed_Count;
+}
+
 /** Handler to initialize the COV list, clearing and disabling each entry.
  * @ingroup DSCOV
  */
@@ -321,21 +774,464 @@ void handler_cov_init(void)
 {
     unsigned index = 0;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+    for (index = 0; index < COV_Subscriptions_Size; index++) {
         /* initialize with invalid COV address */
-        COV_Subscriptions[index].flag.valid = false;
-        COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
-        COV_Subscriptions[index].subscriberProcessIdentifier = 0;
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
+        COV->Subscriptions[index].flag.valid = false;
+        COV->Subscriptions[index].dest_index = COV_ADDRESS_NONE;
+        COV->Subscriptions[index].next = 0;
+        COV->Subscriptions[index].subscriberProcessIdentifier = 0;
+        COV->Subscriptions[index].monitoredObjectIdentifier.type =
             OBJECT_ANALOG_INPUT;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance = 0;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications = false;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = 0;
-        COV_Subscriptions[index].flag.send_requested = false;
+        COV->Subscriptions[index].monitoredObjectIdentifier.instance = 0;
+        COV->Subscriptions[index].flag.issueConfirmedNotifications = false;
+        COV->Subscriptions[index].invokeID = 0;
+        COV->Subscriptions[index].lifetime = 0;
+        COV->Subscriptions[index].flag.send_requested = false;
+        COV->Subscriptions[index].flag.property = false;
+        COV->Subscriptions[index].flag.covIncrementPresent = false;
+        COV->Object_Bucket[index] = 0;
+    }
+    for (index = 0; index < COV_Addresses_Size; index++) {
+        COV->Addresses[index].valid = false;
+        COV->Addresses[index].ref_count = 0;
+        COV->Addresses[index].next = 0;
+        COV->Address_Bucket[index] = 0;
+    }
+    COV->Subscriptions_Used = 0;
+    COV->Subscriptions_Free = 0;
+    COV->Addresses_Used = 0;
+    COV->Addresses_Free = 0;
+    COV->Changed_Head = 0;
+    COV->Changed_Count = 0;
+    COV->Changed_Overflow = COV_Event_Driven;
+    COV->Work_Pending = true;
+}
+
+/** Handler to add the memory used by the COV subscriptions of the
+ *  default context to a report.
+ * @ingroup DSCOV
+ * @param usage - report to add the memory used by the subscriptions to
+ */
+void handler_cov_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned index;
+
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes += sizeof(COV_Default);
+#if defined(BACNET_COV_DYNAMIC)
+    usage->dynamic_bytes += (size_t)COV_Default.Subscriptions_Size *
+        (sizeof(BACNET_COV_SUBSCRIPTION) + sizeof(unsigned));
+    usage->dynamic_bytes += (size_t)COV_Default.Addresses_Size *
+        (sizeof(BACNET_COV_ADDRESS) + sizeof(unsigned));
+#endif
+    for (index = 0; index < COV_Default.Subscriptions_Used; index++) {
+        if (COV_Default.Subscriptions[index].flag.valid) {
+            usage->count++;
+        }
+    }
+}
+
+/** Handler to allocate the COV list of a stack context, with each entry
+ *  cleared and disabled.
+ * @ingroup DSCOV
+ * @return the new context, or NULL if out of memory
+ */
+COV_CONTEXT *handler_cov_context_create(void)
+{
+    struct cov_context *context;
+    struct cov_context *previous;
+
+    context = BACNET_MEMPOOL_CALLOC(sizeof(struct cov_context));
+    if (context) {
+        previous = COV;
+        COV = context;
+        handler_cov_init();
+        COV = previous;
+    }
+
+    return context;
+}
+
+/** Handler to free the COV list of a stack context. The context must not
+ *  be selected by any thread.
+ * @ingroup DSCOV
+ * @param context [in] context from handler_cov_context_create()
+ */
+void handler_cov_context_delete(COV_CONTEXT *context)
+{
+    if (context && (context != &COV_Default)) {
+#if defined(BACNET_COV_DYNAMIC)
+        BACNET_MEMPOOL_FREE(
+            context->Subscriptions,
+            context->Subscriptions_Size * sizeof(BACNET_COV_SUBSCRIPTION));
+        BACNET_MEMPOOL_FREE(
+            context->Object_Bucket,
+            context->Subscriptions_Size * sizeof(unsigned));
+        BACNET_MEMPOOL_FREE(
+            context->Addresses,
+            context->Addresses_Size * sizeof(BACNET_COV_ADDRESS));
+        BACNET_MEMPOOL_FREE(
+            context->Address_Bucket,
+            context->Addresses_Size * sizeof(unsigned));
+#endif
+        BACNET_MEMPOOL_FREE(context, sizeof(struct cov_context));
+    }
+}
+
+/** Handler to select the COV list used by the COV functions called from
+ *  this thread. With BACNET_STACK_CONTEXT_THREADS, each thread selects
+ *  its own context; otherwise one context is selected for the whole
+ *  process.
+ * @ingroup DSCOV
+ * @param context [in] context from handler_cov_context_create(), or NULL
+ *  for the default context
+ * @return the context that was selected before
+ */
+COV_CONTEXT *handler_cov_context_select(COV_CONTEXT *context)
+{
+    struct cov_context *previous = COV;
+
+    COV = context ? context : &COV_Default;
+
+    return previous;
+}
+
+/** Handler to enable or disable the event-driven change-of-value queue.
+ * @ingroup DSCOV
+ *  When enabled, the COV task no longer polls Device_COV() for every
+ *  subscription; it only visits the objects that were reported with
+ *  handler_cov_object_changed(). Every monitored object must then report
+ *  its changes, for example by registering handler_cov_object_changed()
+ *  as its change-of-value callback.
+ * @param enable [in] true to use the change-of-value queue
+ */
+void handler_cov_event_driven_set(bool enable)
+{
+    COV_Event_Driven = enable;
+    COV->Changed_Head = 0;
+    COV->Changed_Count = 0;
+    /* pick up any changes flagged before the queue was in use */
+    COV->Changed_Overflow = enable;
+}
+
+/** Handler to report that an object's change-of-value condition tripped.
+ * @ingroup DSCOV
+ *  Queues the object for the COV task. An object that is already in the
+ *  queue is not queued twice. When the queue is full, the next COV task
+ *  cycle falls back to a full scan of the subscriptions.
+ * @param object_type [in] The object type that changed.
+ * @param object_instance [in] The object instance that changed.
+ */
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    unsigned i = 0;
+    unsigned slot = 0;
+
+    if (!COV_Event_Driven || COV->Changed_Overflow) {
+        return;
+    }
+    for (i = 0; i < COV->Changed_Count; i++) {
+        slot = (COV->Changed_Head + i) % MAX_COV_CHANGED_OBJECTS;
+        if ((COV->Changed_Queue[slot].type == object_type) &&
+            (COV->Changed_Queue[slot].instance == object_instance)) {
+            return;
+        }
+    }
+    if (COV->Changed_Count < MAX_COV_CHANGED_OBJECTS) {
+        slot = (COV->Changed_Head + COV->Changed_Count) %
+            MAX_COV_CHANGED_OBJECTS;
+        COV->Changed_Queue[slot].type = object_type;
+        COV->Changed_Queue[slot].instance = object_instance;
+        COV->Changed_Count++;
+    } else {
+        COV->Changed_Overflow = true;
+    }
+}
+
+/**
+ * @brief Read the encoded value of a property for a property subscription
+ * @param object_type - monitored object type
+ * @param object_instance - monitored object instance
+ * @param reference - monitored property and array index
+ * @param value - buffer for the encoded value
+ * @param value_size - size of the buffer
+ * @param error_class - error class when the value can not be read
+ * @param error_code - error code when the value can not be read
+ * @return number of bytes encoded, or BACNET_STATUS_ERROR
+ */
+static int cov_property_read(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    const struct BACnetPropertyReference *reference,
+    uint8_t *value,
+    size_t value_size,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    int len;
+
+    rpdata.object_type = object_type;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = reference->property_identifier;
+    rpdata.array_index = reference->property_array_index;
+    rpdata.application_data = &COV->Property_Buffer[0];
+    rpdata.application_data_len = sizeof(COV->Property_Buffer);
+    rpdata.error_class = ERROR_CLASS_PROPERTY;
+    rpdata.error_code = ERROR_CODE_NOT_COV_PROPERTY;
+    len = Device_Read_Property(&rpdata);
+    if ((len < 0) || ((size_t)len > value_size)) {
+        if (len != BACNET_STATUS_ERROR) {
+            /* too large to snapshot */
+            rpdata.error_class = ERROR_CLASS_PROPERTY;
+            rpdata.error_code = ERROR_CODE_NOT_COV_PROPERTY;
+        }
+        if (error_class) {
+            *error_class = rpdata.error_class;
+        }
+        if (error_code) {
+            *error_code = rpdata.error_code;
+        }
+        return BACNET_STATUS_ERROR;
+    }
+    memcpy(value, &COV->Property_Buffer[0], (size_t)len);
+
+    return len;
+}
+
+/**
+ * @brief Read the encoded Status_Flags of a monitored object
+ * @param object_type - monitored object type
+ * @param object_instance - monitored object instance
+ * @param status_flags - buffer of COV_STATUS_FLAGS_SIZE bytes
+ * @return number of bytes encoded, or zero if the object has none
+ */
+static uint16_t cov_status_flags_read(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint8_t *status_flags)
+{
+    const struct BACnetPropertyReference reference = { PROP_STATUS_FLAGS,
+                                                       BACNET_ARRAY_ALL };
+    int len;
+
+    len = cov_property_read(
+        object_type, object_instance, &reference, status_flags,
+        COV_STATUS_FLAGS_SIZE, NULL, NULL);
+    if (len < 0) {
+        return 0;
+    }
+
+    return (uint16_t)len;
+}
+
+/**
+ * @brief Determine if the monitored property of a property subscription
+ *  changed since it was last notified.  A REAL that has a COV increment
+ *  only changes when it moved by the increment.
+ * @param cov_subscription - property subscription
+ * @return true if the property value or the Status_Flags changed
+ */
+static bool
+cov_property_changed(const BACNET_COV_SUBSCRIPTION *cov_subscription)
+{
+    uint8_t value[MAX_COV_PROPERTY_VALUE_SIZE];
+    uint8_t status_flags[COV_STATUS_FLAGS_SIZE];
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    float old_real = 0.0f, new_real = 0.0f, delta;
+    int len;
+    uint16_t status_flags_len;
+
+    object_type =
+        (BACNET_OBJECT_TYPE)cov_subscription->monitoredObjectIdentifier.type;
+    object_instance = cov_subscription->monitoredObjectIdentifier.instance;
+    len = cov_property_read(
+        object_type, object_instance, &cov_subscription->monitoredProperty,
+        value, sizeof(value), NULL, NULL);
+    if (len < 0) {
+        return false;
+    }
+    status_flags_len =
+        cov_status_flags_read(object_type, object_instance, status_flags);
+    if ((status_flags_len != cov_subscription->status_flags_len) ||
+        (memcmp(
+             status_flags, cov_subscription->status_flags, status_flags_len) !=
+         0)) {
+        return true;
+    }
+    if (cov_subscription->flag.covIncrementPresent &&
+        (bacnet_real_application_decode(
+             cov_subscription->value, cov_subscription->value_len,
+             &old_real) > 0) &&
+        (bacnet_real_application_decode(value, (uint32_t)len, &new_real) >
+         0)) {
+        delta = new_real - old_real;
+        if (delta < 0.0f) {
+            delta = -delta;
+        }
+        return (delta >= cov_subscription->covIncrement);
+    }
+
+    return ((uint16_t)len != cov_subscription->value_len) ||
+        (memcmp(value, cov_subscription->value, (size_t)len) != 0);
+}
+
+/**
+ * @brief Mark the subscriptions of a changed object for sending
+ *  and clear the COV flag of the object.
+ * @param object_type - object type that changed
+ * @param object_instance - object instance that changed
+ */
+static void
+cov_object_mark(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    unsigned link = 0;
+    unsigned index = 0;
+
+    /* only the subscribers of this object are visited */
+    if (COV->Subscriptions_Used) {
+        link =
+            COV->Object_Bucket[cov_object_bucket(object_type, object_instance)];
+    }
+    while (link) {
+        index = link - 1;
+        if ((COV->Subscriptions[index].monitoredObjectIdentifier.type ==
+             object_type) &&
+            (COV->Subscriptions[index].monitoredObjectIdentifier.instance ==
+             object_instance) &&
+            (!COV->Subscriptions[index].flag.property ||
+             cov_property_changed(&COV->Subscriptions[index]))) {
+            COV->Subscriptions[index].flag.send_requested = true;
+            COV->Work_Pending = true;
+        }
+        link = COV->Subscriptions[index].next;
+    }
+    Device_COV_Clear(object_type, object_instance);
+}
+
+/**
+ * @brief Mark the subscriptions of every queued object for sending
+ *  and clear the COV flag of each queued object.
+ */
+static void cov_changed_queue_drain(void)
+{
+    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
+    uint32_t object_instance = 0;
+
+    while (COV->Changed_Count > 0) {
+        object_type =
+            (BACNET_OBJECT_TYPE)COV->Changed_Queue[COV->Changed_Head].type;
+        object_instance = COV->Changed_Queue[COV->Changed_Head].instance;
+        COV->Changed_Head = (COV->Changed_Head + 1) % MAX_COV_CHANGED_OBJECTS;
+        COV->Changed_Count--;
+        cov_object_mark(object_type, object_instance);
+    }
+}
+
+/** Handler to register the bulk change-of-value evaluation of an object type.
+ * @ingroup DSCOV
+ *  Objects of a registered type are no longer polled with Device_COV() one
+ *  subscription at a time. Instead, once per COV task cycle, the function
+ *  evaluates every object of the type and the subscribers of the objects
+ *  it reports as changed are marked for sending.
+ * @param object_type [in] The object type to evaluate in bulk.
+ * @param function [in] The bulk evaluation, or NULL to go back to polling.
+ * @return true if the function was registered or removed
+ */
+bool handler_cov_bulk_function_set(
+    BACNET_OBJECT_TYPE object_type, cov_object_bulk_function function)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < COV_Bulk_Types_Count; i++) {
+        if (COV_Bulk_Types[i].object_type == object_type) {
+            break;
+        }
+    }
+    if (!function) {
+        if (i < COV_Bulk_Types_Count) {
+            COV_Bulk_Types_Count--;
+            COV_Bulk_Types[i] = COV_Bulk_Types[COV_Bulk_Types_Count];
+        }
+        return true;
+    }
+    if (i == COV_Bulk_Types_Count) {
+        if (COV_Bulk_Types_Count >= MAX_COV_BULK_TYPES) {
+            return false;
+        }
+        COV_Bulk_Types_Count++;
+    }
+    COV_Bulk_Types[i].object_type = object_type;
+    COV_Bulk_Types[i].function = function;
+
+    return true;
+}
+
+/**
+ * @brief Determine if an object type is evaluated in bulk
+ * @param object_type - object type
+ * @return true if a bulk function is registered for the object type
+ */
+static bool cov_bulk_type(BACNET_OBJECT_TYPE object_type)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < COV_Bulk_Types_Count; i++) {
+        if (COV_Bulk_Types[i].object_type == object_type) {
+            return true;
+        }
     }
-    for (index = 0; index < MAX_COV_ADDRESSES; index++) {
-        COV_Addresses[index].valid = false;
+
+    return false;
+}
+
+/**
+ * @brief Run the bulk evaluation of each registered object type and mark
+ *  the subscriptions of every object it reports as changed.
+ */
+static void cov_bulk_mark(void)
+{
+    const uint32_t *instances = NULL;
+    cov_object_bulk_function function = NULL;
+    uint32_t *bitmap = NULL;
+    uint32_t bits = 0;
+    unsigned i = 0, slots = 0, words = 0, word = 0, bit = 0;
+
+    for (i = 0; i < COV_Bulk_Types_Count; i++) {
+        function = COV_Bulk_Types[i].function;
+        slots = function(COV_Bulk_Bitmap, COV_Bulk_Bitmap_Words, &instances);
+        if (slots > (COV_Bulk_Bitmap_Words * 32U)) {
+            /* grow the bitmap to fit every slot, then evaluate again */
+            words = (slots + 31U) / 32U;
+            bitmap = BACNET_MEMPOOL_REALLOC(
+                COV_Bulk_Bitmap, COV_Bulk_Bitmap_Words * sizeof(uint32_t),
+                words * sizeof(uint32_t));
+            if (!bitmap) {
+                continue;
+            }
+            COV_Bulk_Bitmap = bitmap;
+            COV_Bulk_Bitmap_Words = words;
+            slots =
+                function(COV_Bulk_Bitmap, COV_Bulk_Bitmap_Words, &instances);
+        }
+        words = (slots + 31U) / 32U;
+        if (words > COV_Bulk_Bitmap_Words) {
+            words = COV_Bulk_Bitmap_Words;
+        }
+        for (word = 0; word < words; word++) {
+            bits = COV_Bulk_Bitmap[word];
+            for (bit = 0; bits; bit++, bits >>= 1) {
+                if (bits & 1U) {
+                    cov_object_mark(
+                        COV_Bulk_Types[i].object_type,
+                        instances[(word * 32U) + bit]);
+                }
+            }
+        }
     }
 }
 
@@ -345,105 +1241,105 @@ static bool cov_list_subscribe(
     BACNET_ERROR_CLASS *error_class,
     BACNET_ERROR_CODE *error_code)
 {
-    bool existing_entry = false;
     int index;
-    int first_invalid_index = -1;
+    int dest_index;
     bool found = true;
-    bool address_match = false;
-    const BACNET_ADDRESS *dest = NULL;
 
     /* unable to subscribe - resources? */
     /* unable to cancel subscription - other? */
 
     /* existing? - match Object ID and Process ID and address */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].flag.valid) {
-            dest = cov_address_get(COV_Subscriptions[index].dest_index);
-            if (dest) {
-                address_match = bacnet_address_same(src, dest);
-            } else {
-                /* skip address matching - we don't have an address */
-                address_match = true;
-            }
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                 cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                 cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                 cov_data->subscriberProcessIdentifier) &&
-                address_match) {
-                existing_entry = true;
-                if (cov_data->cancellationRequest) {
-                    /* initialize with invalid COV address */
-                    COV_Subscriptions[index].flag.valid = false;
-                    COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
-                    cov_address_remove_unused();
+    index = cov_subscription_find(src, cov_data);
+    if (index >= 0) {
+        if (COV->Subscriptions[index].invokeID) {
+            tsm_free_invoke_id(COV->Subscriptions[index].invokeID);
+            COV->Subscriptions[index].invokeID = 0;
+        }
+        if (cov_data->cancellationRequest) {
+            cov_subscription_remove(index);
+        } else {
+            if (!cov_address_get(COV->Subscriptions[index].dest_index)) {
+                dest_index = cov_address_add(src);
+                if (dest_index < 0) {
+                    COV->Subscriptions[index].dest_index = COV_ADDRESS_NONE;
                 } else {
-                    COV_Subscriptions[index].dest_index = cov_address_add(src);
-                    COV_Subscriptions[index].flag.issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].flag.send_requested = true;
-                }
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+                    COV->Subscriptions[index].dest_index = dest_index;
                 }
-                break;
             }
-        } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
+            COV->Subscriptions[index].flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            COV->Subscriptions[index].lifetime = cov_data->lifetime;
+            COV->Subscriptions[index].flag.covIncrementPresent =
+                cov_data->covIncrementPresent;
+            COV->Subscriptions[index].covIncrement = cov_data->covIncrement;
+            COV->Subscriptions[index].flag.send_requested = true;
+            COV->Work_Pending = true;
+        }
+    } else if (!cov_data->cancellationRequest) {
+        dest_index = cov_address_add(src);
+        if (dest_index >= 0) {
+            index = cov_subscription_alloc();
+            if (index < 0) {
+                cov_address_release(dest_index);
             }
         }
-    }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        const int addr_add_ret = cov_address_add(src);
-
-        if (addr_add_ret < 0) {
+        if ((dest_index < 0) || (index < 0)) {
+            /* Out of resources */
             *error_class = ERROR_CLASS_RESOURCES;
             *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
             found = false;
         } else {
-            index = first_invalid_index;
-            found = true;
-            COV_Subscriptions[index].dest_index = addr_add_ret;
-            COV_Subscriptions[index].flag.valid = true;
-            COV_Subscriptions[index].monitoredObjectIdentifier.type =
+            COV->Subscriptions[index].dest_index = dest_index;
+            COV->Subscriptions[index].flag.valid = true;
+            COV->Subscriptions[index].monitoredObjectIdentifier.type =
                 cov_data->monitoredObjectIdentifier.type;
-            COV_Subscriptions[index].monitoredObjectIdentifier.instance =
+            COV->Subscriptions[index].monitoredObjectIdentifier.instance =
                 cov_data->monitoredObjectIdentifier.instance;
-            COV_Subscriptions[index].subscriberProcessIdentifier =
+            COV->Subscriptions[index].subscriberProcessIdentifier =
                 cov_data->subscriberProcessIdentifier;
-            COV_Subscriptions[index].flag.issueConfirmedNotifications =
+            COV->Subscriptions[index].flag.issueConfirmedNotifications =
                 cov_data->issueConfirmedNotifications;
-            COV_Subscriptions[index].invokeID = 0;
-            COV_Subscriptions[index].lifetime = cov_data->lifetime;
-            COV_Subscriptions[index].flag.send_requested = true;
-        }
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
-            /* Out of resources */
-            *error_class = ERROR_CLASS_RESOURCES;
-            *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
-            found = false;
-        } else {
-            /* cancellationRequest - valid object not subscribed */
-            /* From BACnet Standard 135-2010-13.14.2
-               ...Cancellations that are issued for which no matching COV
-               context can be found shall succeed as if a context had
-               existed, returning 'Result(+)'. */
-            found = true;
+            COV->Subscriptions[index].invokeID = 0;
+            COV->Subscriptions[index].lifetime = cov_data->lifetime;
+            COV->Subscriptions[index].flag.property =
+                cov_data->covSubscribeToProperty;
+            COV->Subscriptions[index].monitoredProperty =
+                cov_data->monitoredProperty;
+            COV->Subscriptions[index].flag.covIncrementPresent =
+                cov_data->covIncrementPresent;
+            COV->Subscriptions[index].covIncrement = cov_data->covIncrement;
+            /* nothing notified yet */
+            COV->Subscriptions[index].value_len = 0;
+            COV->Subscriptions[index].status_flags_len = 0;
+            COV->Subscriptions[index].flag.send_requested = true;
+            cov_subscription_link(index);
+            COV->Work_Pending = true;
         }
+    } else {
+        /* cancellationRequest - valid object not subscribed */
+        /* From BACnet Standard 135-2010-13.14.2
+           ...Cancellations that are issued for which no matching COV
+           context can be found shall succeed as if a context had
+           existed, returning 'Result(+)'. */
+        found = true;
     }
 
     return found;
 }
 
+/**
+ * @brief Send a COV notification to a subscriber
+ * @param cov_subscription - subscription to notify
+ * @param value_list - values to notify, or NULL to use the encoded values
+ * @param values - encoded listOfValues, when value_list is NULL
+ * @param values_len - number of bytes in the encoded listOfValues
+ * @return true if the notification was sent
+ */
 static bool cov_send_request(
     BACNET_COV_SUBSCRIPTION *cov_subscription,
-    BACNET_PROPERTY_VALUE *value_list)
+    BACNET_PROPERTY_VALUE *value_list,
+    const uint8_t *values,
+    unsigned values_len)
 {
     int len = 0;
     int pdu_len = 0;
@@ -491,17 +1387,29 @@ static bool cov_send_request(
         invoke_id = tsm_next_free_invokeID();
         if (invoke_id) {
             cov_subscription->invokeID = invoke_id;
-            len = ccov_notify_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len],
-                sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id,
-                &cov_data);
+            if (value_list) {
+                len = ccov_notify_encode_apdu(
+                    &Handler_Transmit_Buffer[pdu_len],
+                    sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id,
+                    &cov_data);
+            } else {
+                len = ccov_notify_values_encode_apdu(
+                    &Handler_Transmit_Buffer[pdu_len],
+                    sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id,
+                    &cov_data, values, values_len);
+            }
         } else {
             goto COV_FAILED;
         }
-    } else {
+    } else if (value_list) {
         len = ucov_notify_encode_apdu(
             &Handler_Transmit_Buffer[pdu_len],
             sizeof(Handler_Transmit_Buffer) - pdu_len, &cov_data);
+    } else {
+        len = ucov_notify_values_encode_apdu(
+            &Handler_Transmit_Buffer[pdu_len],
+            sizeof(Handler_Transmit_Buffer) - pdu_len, &cov_data, values,
+            values_len);
     }
     pdu_len += len;
     if (cov_subscription->flag.issueConfirmedNotifications) {
@@ -513,6 +1421,10 @@ static bool cov_send_request(
         dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
     if (bytes_sent > 0) {
         status = true;
+        BACNET_TRACE3(
+            cov_send, cov_data.monitoredObjectIdentifier.type,
+            cov_data.monitoredObjectIdentifier.instance,
+            cov_subscription->flag.issueConfirmedNotifications);
 #if PRINT_ENABLED
         debug_fprintf(stderr, "COVnotification: Sent!\n");
 #endif
@@ -523,39 +1435,122 @@ COV_FAILED:
     return status;
 }
 
+/**
+ * @brief Encode one BACnetPropertyValue of a listOfValues
+ * @param apdu - buffer to encode into
+ * @param property - property identifier
+ * @param array_index - array index, or BACNET_ARRAY_ALL
+ * @param value - encoded value
+ * @param value_len - number of bytes in the encoded value
+ * @return number of bytes encoded
+ */
+static int cov_property_value_encode(
+    uint8_t *apdu,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    const uint8_t *value,
+    uint16_t value_len)
+{
+    int apdu_len = 0;
+
+    apdu_len += encode_context_enumerated(&apdu[apdu_len], 0, property);
+    if (array_index != BACNET_ARRAY_ALL) {
+        apdu_len += encode_context_unsigned(&apdu[apdu_len], 1, array_index);
+    }
+    apdu_len += encode_opening_tag(&apdu[apdu_len], 2);
+    memcpy(&apdu[apdu_len], value, value_len);
+    apdu_len += value_len;
+    apdu_len += encode_closing_tag(&apdu[apdu_len], 2);
+
+    return apdu_len;
+}
+
+/**
+ * @brief Notify a property subscription with the monitored property and
+ *  the Status_Flags of the object, and remember them as notified
+ * @param cov_subscription - property subscription
+ * @return true if the notification was sent
+ */
+static bool cov_property_send(BACNET_COV_SUBSCRIPTION *cov_subscription)
+{
+    uint8_t value[MAX_COV_PROPERTY_VALUE_SIZE];
+    uint8_t status_flags[COV_STATUS_FLAGS_SIZE];
+    uint8_t values[COV_PROPERTY_VALUES_SIZE];
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    int len, values_len = 0;
+    uint16_t status_flags_len;
+    bool status;
+
+    object_type =
+        (BACNET_OBJECT_TYPE)cov_subscription->monitoredObjectIdentifier.type;
+    object_instance = cov_subscription->monitoredObjectIdentifier.instance;
+    len = cov_property_read(
+        object_type, object_instance, &cov_subscription->monitoredProperty,
+        value, sizeof(value), NULL, NULL);
+    if (len < 0) {
+        return false;
+    }
+    status_flags_len =
+        cov_status_flags_read(object_type, object_instance, status_flags);
+    /* tag 4 - listOfValues */
+    values_len += encode_opening_tag(&values[values_len], 4);
+    values_len += cov_property_value_encode(
+        &values[values_len],
+        cov_subscription->monitoredProperty.property_identifier,
+        cov_subscription->monitoredProperty.property_array_index, value,
+        (uint16_t)len);
+    if (status_flags_len &&
+        (cov_subscription->monitoredProperty.property_identifier !=
+         PROP_STATUS_FLAGS)) {
+        values_len += cov_property_value_encode(
+            &values[values_len], PROP_STATUS_FLAGS, BACNET_ARRAY_ALL,
+            status_flags, status_flags_len);
+    }
+    values_len += encode_closing_tag(&values[values_len], 4);
+    status = cov_send_request(
+        cov_subscription, NULL, values, (unsigned)values_len);
+    if (status) {
+        memcpy(cov_subscription->value, value, (size_t)len);
+        cov_subscription->value_len = (uint16_t)len;
+        memcpy(
+            cov_subscription->status_flags, status_flags, status_flags_len);
+        cov_subscription->status_flags_len = status_flags_len;
+    }
+
+    return status;
+}
+
 static void cov_lifetime_expiration_handler(
     unsigned index, uint32_t elapsed_seconds, uint32_t lifetime_seconds)
 {
-    if (index < MAX_COV_SUBCRIPTIONS) {
+    if (index < COV->Subscriptions_Used) {
         /* handle lifetime expiration */
         if (lifetime_seconds >= elapsed_seconds) {
-            COV_Subscriptions[index].lifetime -= elapsed_seconds;
+            COV->Subscriptions[index].lifetime -= elapsed_seconds;
 #if 0
             fprintf(stderr, "COVtimer: subscription[%d].lifetime=%lu\n", index,
-                (unsigned long) COV_Subscriptions[index].lifetime);
+                (unsigned long) COV->Subscriptions[index].lifetime);
 #endif
         } else {
-            COV_Subscriptions[index].lifetime = 0;
+            COV->Subscriptions[index].lifetime = 0;
         }
-        if (COV_Subscriptions[index].lifetime == 0) {
+        if (COV->Subscriptions[index].lifetime == 0) {
             /* expire the subscription */
 #if PRINT_ENABLED
             debug_fprintf(
                 stderr, "COVtimer: PID=%u %s %u time remaining=%u seconds\n",
-                COV_Subscriptions[index].subscriberProcessIdentifier,
+                COV->Subscriptions[index].subscriberProcessIdentifier,
                 bactext_object_type_name(
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type),
-                COV_Subscriptions[index].monitoredObjectIdentifier.instance,
-                COV_Subscriptions[index].lifetime);
+                    COV->Subscriptions[index].monitoredObjectIdentifier.type),
+                COV->Subscriptions[index].monitoredObjectIdentifier.instance,
+                COV->Subscriptions[index].lifetime);
 #endif
-            /* initialize with invalid COV address */
-            COV_Subscriptions[index].flag.valid = false;
-            COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
-            cov_address_remove_unused();
-            if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+            cov_subscription_remove(index);
+            if (COV->Subscriptions[index].flag.issueConfirmedNotifications) {
+                if (COV->Subscriptions[index].invokeID) {
+                    tsm_free_invoke_id(COV->Subscriptions[index].invokeID);
+                    COV->Subscriptions[index].invokeID = 0;
                 }
             }
         }
@@ -590,9 +1585,9 @@ void handler_cov_timer_seconds(uint32_t elapsed_seconds)
 
     if (elapsed_seconds) {
         /* handle the subscription timeouts */
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].flag.valid) {
-                lifetime_seconds = COV_Subscriptions[index].lifetime;
+        for (index = 0; index < COV->Subscriptions_Used; index++) {
+            if (COV->Subscriptions[index].flag.valid) {
+                lifetime_seconds = COV->Subscriptions[index].lifetime;
                 if (lifetime_seconds) {
                     /* only expire COV with definite lifetimes */
                     cov_lifetime_expiration_handler(
@@ -605,89 +1600,111 @@ void handler_cov_timer_seconds(uint32_t elapsed_seconds)
 
 bool handler_cov_fsm(void)
 {
-    static int index = 0;
+    unsigned index = COV->Task_Index;
     BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
     uint32_t object_instance = 0;
     bool status = false;
     bool send = false;
     BACNET_PROPERTY_VALUE value_list[MAX_COV_PROPERTIES] = { 0 };
-    /* states for transmitting */
-    static enum {
-        COV_STATE_IDLE = 0,
-        COV_STATE_MARK,
-        COV_STATE_CLEAR,
-        COV_STATE_FREE,
-        COV_STATE_SEND
-    } cov_task_state = COV_STATE_IDLE;
+    enum cov_task_state cov_task_state = COV->Task_State;
 
     switch (cov_task_state) {
         case COV_STATE_IDLE:
             index = 0;
-            cov_task_state = COV_STATE_MARK;
+            if (COV->Subscriptions_Used) {
+                cov_bulk_mark();
+            }
+            if (!COV_Event_Driven || COV->Changed_Overflow) {
+                COV->Changed_Head = 0;
+                COV->Changed_Count = 0;
+                COV->Changed_Overflow = false;
+                cov_task_state = COV_STATE_MARK;
+            } else {
+                /* only the queued objects need to be visited */
+                cov_changed_queue_drain();
+                if (COV->Work_Pending) {
+                    COV->Work_Pending = false;
+                    cov_task_state = COV_STATE_FREE;
+                }
+            }
             break;
         case COV_STATE_MARK:
             /* mark any subscriptions where the value has changed */
-            if (COV_Subscriptions[index].flag.valid) {
-                object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+            if ((index < COV->Subscriptions_Used) &&
+                (COV->Subscriptions[index].flag.valid)) {
+                object_type = (BACNET_OBJECT_TYPE)COV->Subscriptions[index]
                                   .monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].monitoredObjectIdentifier.instance;
-                status = Device_COV(object_type, object_instance);
+                object_instance = COV->Subscriptions[index]
+                                      .monitoredObjectIdentifier.instance;
+                if (COV->Subscriptions[index].flag.property) {
+                    status = cov_property_changed(&COV->Subscriptions[index]);
+                } else if (!cov_bulk_type(object_type)) {
+                    /* bulk evaluated types were marked when leaving idle */
+                    status = Device_COV(object_type, object_instance);
+                }
                 if (status) {
-                    COV_Subscriptions[index].flag.send_requested = true;
+                    COV->Subscriptions[index].flag.send_requested = true;
 #if PRINT_ENABLED
                     debug_fprintf(stderr, "COVtask: Marking...\n");
 #endif
                 }
             }
             index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV->Subscriptions_Used) {
                 index = 0;
                 cov_task_state = COV_STATE_CLEAR;
             }
             break;
         case COV_STATE_CLEAR:
             /* clear the COV flag after checking all subscriptions */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+            if ((index < COV->Subscriptions_Used) &&
+                (COV->Subscriptions[index].flag.valid) &&
+                (COV->Subscriptions[index].flag.send_requested) &&
+                (!COV->Subscriptions[index].flag.property)) {
+                object_type = (BACNET_OBJECT_TYPE)COV->Subscriptions[index]
                                   .monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].monitoredObjectIdentifier.instance;
+                object_instance = COV->Subscriptions[index]
+                                      .monitoredObjectIdentifier.instance;
                 Device_COV_Clear(object_type, object_instance);
             }
             index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV->Subscriptions_Used) {
                 index = 0;
+                COV->Work_Pending = false;
                 cov_task_state = COV_STATE_FREE;
             }
             break;
         case COV_STATE_FREE:
             /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
+            if ((index < COV->Subscriptions_Used) &&
+                (COV->Subscriptions[index].flag.valid) &&
+                (COV->Subscriptions[index].flag.issueConfirmedNotifications) &&
+                (COV->Subscriptions[index].invokeID)) {
+                if (tsm_invoke_id_free(COV->Subscriptions[index].invokeID)) {
+                    COV->Subscriptions[index].invokeID = 0;
                 } else if (tsm_invoke_id_failed(
-                               COV_Subscriptions[index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+                               COV->Subscriptions[index].invokeID)) {
+                    tsm_free_invoke_id(COV->Subscriptions[index].invokeID);
+                    COV->Subscriptions[index].invokeID = 0;
+                } else {
+                    COV->Work_Pending = true;
                 }
             }
             index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV->Subscriptions_Used) {
                 index = 0;
                 cov_task_state = COV_STATE_SEND;
             }
             break;
         case COV_STATE_SEND:
             /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
+            if ((index < COV->Subscriptions_Used) &&
+                (COV->Subscriptions[index].flag.valid) &&
+                (COV->Subscriptions[index].flag.send_requested)) {
                 send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
+                if (COV->Subscriptions[index]
+                        .flag.issueConfirmedNotifications) {
+                    if (COV->Subscriptions[index].invokeID != 0) {
                         /* already sending */
                         send = false;
                     }
@@ -697,29 +1714,38 @@ bool handler_cov_fsm(void)
                     }
                 }
                 if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+                    object_type = (BACNET_OBJECT_TYPE)COV->Subscriptions[index]
                                       .monitoredObjectIdentifier.type;
-                    object_instance = COV_Subscriptions[index]
+                    object_instance = COV->Subscriptions[index]
                                           .monitoredObjectIdentifier.instance;
 #if PRINT_ENABLED
                     debug_fprintf(stderr, "COVtask: Sending...\n");
 #endif
-                    /* configure the linked list for the two properties */
-                    bacapp_property_value_list_init(
-                        &value_list[0], MAX_COV_PROPERTIES);
-                    status = Device_Encode_Value_List(
-                        object_type, object_instance, &value_list[0]);
-                    if (status) {
-                        status = cov_send_request(
-                            &COV_Subscriptions[index], &value_list[0]);
+                    if (COV->Subscriptions[index].flag.property) {
+                        status = cov_property_send(&COV->Subscriptions[index]);
+                    } else {
+                        /* configure the linked list for the two properties */
+                        bacapp_property_value_list_init(
+                            &value_list[0], MAX_COV_PROPERTIES);
+                        status = Device_Encode_Value_List(
+                            object_type, object_instance, &value_list[0]);
+                        if (status) {
+                            status = cov_send_request(
+                                &COV->Subscriptions[index], &value_list[0],
+                                NULL, 0);
+                        }
                     }
                     if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
+                        COV->Subscriptions[index].flag.send_requested = false;
                     }
                 }
+                if ((COV->Subscriptions[index].flag.send_requested) ||
+                    (COV->Subscriptions[index].invokeID)) {
+                    COV->Work_Pending = true;
+                }
             }
             index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV->Subscriptions_Used) {
                 index = 0;
                 cov_task_state = COV_STATE_IDLE;
             }
@@ -729,9 +1755,32 @@ bool handler_cov_fsm(void)
             cov_task_state = COV_STATE_IDLE;
             break;
     }
+    COV->Task_Index = index;
+    COV->Task_State = cov_task_state;
+
     return (cov_task_state == COV_STATE_IDLE);
 }
 
+/**
+ * @brief Determine if the COV task has work to finish, so the caller
+ *  should run it again without waiting.  An idle task only looks for
+ *  changes again when it is next run.
+ * @return true if a pass over the subscriptions is under way, or changes
+ *  reported by the objects are waiting
+ */
+bool handler_cov_busy(void)
+{
+    if (COV->Task_State != COV_STATE_IDLE) {
+        return true;
+    }
+    if (COV_Event_Driven) {
+        return (COV->Changed_Count > 0) || COV->Changed_Overflow ||
+            COV->Work_Pending;
+    }
+
+    return false;
+}
+
 void handler_cov_task(void)
 {
     handler_cov_fsm();
@@ -746,11 +1795,23 @@ static bool cov_subscribe(
     bool status = false; /* return value */
     BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
     uint32_t object_instance = 0;
+    uint8_t value[MAX_COV_PROPERTY_VALUE_SIZE];
 
     object_type = (BACNET_OBJECT_TYPE)cov_data->monitoredObjectIdentifier.type;
     object_instance = cov_data->monitoredObjectIdentifier.instance;
     status = Device_Valid_Object_Id(object_type, object_instance);
-    if (status) {
+    if (status && cov_data->covSubscribeToProperty) {
+        if (!cov_data->cancellationRequest) {
+            /* the monitored property must fit its snapshot */
+            status = (cov_property_read(
+                          object_type, object_instance,
+                          &cov_data->monitoredProperty, value, sizeof(value),
+                          error_class, error_code) >= 0);
+        }
+        if (status) {
+            status = cov_list_subscribe(src, cov_data, error_class, error_code);
+        }
+    } else if (status) {
         status = Device_Value_List_Supported(object_type);
         if (status) {
             status = cov_list_subscribe(src, cov_data, error_class, error_code);
@@ -778,28 +1839,22 @@ static bool cov_subscribe(
     return status;
 }
 
-/** Handler for a COV Subscribe Service request.
- * @ingroup DSCOV
- * This handler will be invoked by apdu_handler() if it has been enabled
- * by a call to apdu_set_confirmed_handler().
- * This handler builds a response packet, which is
- * - an Abort if
- *   - the message is segmented
- *   - if decoding fails
- * - an ACK, if cov_subscribe() succeeds
- * - an Error if cov_subscribe() fails
- *
+/**
+ * @brief Handle a SubscribeCOV or SubscribeCOVProperty request
  * @param service_request [in] The contents of the service request.
  * @param service_len [in] The length of the service_request.
  * @param src [in] BACNET_ADDRESS of the source of the message
  * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
  *                          decoded from the APDU header of this message.
+ * @param service_choice [in] SERVICE_CONFIRMED_SUBSCRIBE_COV or
+ *                            SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY
  */
-void handler_cov_subscribe(
+static void cov_subscribe_handler(
     uint8_t *service_request,
     uint16_t service_len,
     BACNET_ADDRESS *src,
-    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    BACNET_CONFIRMED_SERVICE service_choice)
 {
     BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
     int len = 0;
@@ -830,8 +1885,14 @@ void handler_cov_subscribe(
         debug_print("SubscribeCOV: Segmented message.  Sending Abort!\n");
         error = true;
     } else {
-        len = cov_subscribe_decode_service_request(
-            service_request, service_len, &cov_data);
+        if (service_choice == SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY) {
+            len = cov_subscribe_property_decode_service_request(
+                service_request, service_len, &cov_data);
+            cov_data.covSubscribeToProperty = true;
+        } else {
+            len = cov_subscribe_decode_service_request(
+                service_request, service_len, &cov_data);
+        }
         if (len <= 0) {
             debug_print("SubscribeCOV: Unable to decode Request!\n");
         }
@@ -845,7 +1906,7 @@ void handler_cov_subscribe(
             if (success) {
                 apdu_len = encode_simple_ack(
                     &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                    SERVICE_CONFIRMED_SUBSCRIBE_COV);
+                    service_choice);
                 debug_print("SubscribeCOV: Sending Simple Ack!\n");
             } else {
                 len = BACNET_STATUS_ERROR;
@@ -864,8 +1925,7 @@ void handler_cov_subscribe(
         } else if (len == BACNET_STATUS_ERROR) {
             apdu_len = bacerror_encode_apdu(
                 &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                SERVICE_CONFIRMED_SUBSCRIBE_COV, cov_data.error_class,
-                cov_data.error_code);
+                service_choice, cov_data.error_class, cov_data.error_code);
             debug_print("SubscribeCOV: Sending Error!\n");
         } else if (len == BACNET_STATUS_REJECT) {
             apdu_len = reject_encode_apdu(
@@ -883,3 +1943,57 @@ void handler_cov_subscribe(
 
     return;
 }
+
+/** Handler for a COV Subscribe Service request.
+ * @ingroup DSCOV
+ * This handler will be invoked by apdu_handler() if it has been enabled
+ * by a call to apdu_set_confirmed_handler().
+ * This handler builds a response packet, which is
+ * - an Abort if
+ *   - the message is segmented
+ *   - if decoding fails
+ * - an ACK, if cov_subscribe() succeeds
+ * - an Error if cov_subscribe() fails
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_cov_subscribe(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    cov_subscribe_handler(
+        service_request, service_len, src, service_data,
+        SERVICE_CONFIRMED_SUBSCRIBE_COV);
+}
+
+/** Handler for a COV Subscribe Property Service request.
+ * @ingroup DSCOV
+ * The subscription monitors a single property of the object, which is
+ * read and compared with the value that was last notified each time the
+ * object changes, so that only a real change of the property, by its
+ * COV increment if one was given, or of the Status_Flags of the object
+ * is notified. The encoded value of the property must fit in
+ * MAX_COV_PROPERTY_VALUE_SIZE bytes.
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_cov_subscribe_property(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    cov_subscribe_handler(
+        service_request, service_len, src, service_data,
+        SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY);
+}
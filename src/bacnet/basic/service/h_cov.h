@@ -16,6 +16,11 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
+#include "bacnet/cov.h"
+#include "bacnet/basic/sys/memusage.h"
+
+/* the COV subscriptions of one stack context */
+typedef struct cov_context COV_CONTEXT;
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,15 +33,43 @@ void handler_cov_subscribe(
     BACNET_ADDRESS *src,
     BACNET_CONFIRMED_SERVICE_DATA *service_data);
 BACNET_STACK_EXPORT
+void handler_cov_subscribe_property(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
 bool handler_cov_fsm(void);
 BACNET_STACK_EXPORT
+bool handler_cov_busy(void);
+BACNET_STACK_EXPORT
 void handler_cov_task(void);
 BACNET_STACK_EXPORT
 void handler_cov_timer_seconds(uint32_t elapsed_seconds);
 BACNET_STACK_EXPORT
 void handler_cov_init(void);
 BACNET_STACK_EXPORT
+void handler_cov_memory_usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
 int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu);
+BACNET_STACK_EXPORT
+unsigned handler_cov_subscription_count(void);
+BACNET_STACK_EXPORT
+unsigned handler_cov_changed_count(void);
+BACNET_STACK_EXPORT
+void handler_cov_event_driven_set(bool enable);
+BACNET_STACK_EXPORT
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool handler_cov_bulk_function_set(
+    BACNET_OBJECT_TYPE object_type, cov_object_bulk_function function);
+BACNET_STACK_EXPORT
+COV_CONTEXT *handler_cov_context_create(void);
+BACNET_STACK_EXPORT
+void handler_cov_context_delete(COV_CONTEXT *context);
+BACNET_STACK_EXPORT
+COV_CONTEXT *handler_cov_context_select(COV_CONTEXT *context);
 
 #ifdef __cplusplus
 }
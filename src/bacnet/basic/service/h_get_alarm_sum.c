@@ -47,6 +47,9 @@ void handler_get_alarm_summary(
     int alarm_value = 0;
     unsigned i = 0;
     unsigned j = 0;
+    unsigned index = 0;
+    unsigned position = 0;
+    bool active = false;
     bool error = false;
     BACNET_ADDRESS my_address;
     BACNET_NPDU_DATA npdu_data;
@@ -81,8 +84,17 @@ void handler_get_alarm_summary(
 
     for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
         if (Get_Alarm_Summary[i]) {
+            /* objects in alarm are a subset of the active event set */
+            active = handler_get_event_information_active(i);
+            position = handler_get_event_information_active_position(i, 0);
             for (j = 0; j < 0xffff; j++) {
-                alarm_value = Get_Alarm_Summary[i](j, &getalarm_data);
+                if (!active) {
+                    index = j;
+                } else if (!handler_get_event_information_active_object(
+                               position++, i, &index)) {
+                    break;
+                }
+                alarm_value = Get_Alarm_Summary[i](index, &getalarm_data);
                 if (alarm_value > 0) {
                     len = get_alarm_summary_ack_encode_apdu_data(
                         &Handler_Transmit_Buffer[pdu_len + apdu_len],
@@ -93,7 +105,7 @@ void handler_get_alarm_summary(
                     } else {
                         apdu_len += len;
                     }
-                } else if (alarm_value < 0) {
+                } else if ((alarm_value < 0) && !active) {
                     break;
                 }
             }
@@ -28,6 +28,17 @@
 #include "bacnet/datalink/datalink.h"
 
 static get_event_info_function Get_Event_Info[MAX_BACNET_OBJECT_TYPE];
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+#ifndef MAX_GET_EVENT_ACTIVE_OBJECTS
+#define MAX_GET_EVENT_ACTIVE_OBJECTS 1024
+#endif
+static get_event_index_function Get_Event_Index[MAX_BACNET_OBJECT_TYPE];
+/* objects with an active event, sorted by object type and instance */
+static BACNET_OBJECT_ID Active_Event[MAX_GET_EVENT_ACTIVE_OBJECTS];
+static unsigned Active_Event_Count;
+/* once an active event did not fit, the object types are scanned */
+static bool Active_Event_Overflow;
+#endif
 
 /**
  * @brief print the data for a GetEventInformation service request
@@ -65,6 +76,169 @@ void handler_get_event_information_set(
     }
 }
 
+/**
+ * @brief Set the function to find the index of an object by instance,
+ *  which makes the active events of the object type tracked by the
+ *  active event set instead of scanned on every request.
+ * @note The objects of the type must then report every change of their
+ *  event state or acknowledged transitions with
+ *  handler_get_event_information_active_set()
+ * @param object_type [in] The BACNET_OBJECT_TYPE to set the function for.
+ * @param pFunction [in] The instance to index function to set.
+ */
+void handler_get_event_information_index_set(
+    BACNET_OBJECT_TYPE object_type, get_event_index_function pFunction)
+{
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        Get_Event_Index[object_type] = pFunction;
+    }
+#else
+    (void)object_type;
+    (void)pFunction;
+#endif
+}
+
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+/**
+ * @brief Find the position of the first active event object that is
+ *  not before the given object
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object-instance of the object
+ * @return position in the active event set, up to the count
+ */
+static unsigned Active_Event_Lower_Bound(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    unsigned low = 0, high = Active_Event_Count, mid;
+    const BACNET_OBJECT_ID *object_id;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        object_id = &Active_Event[mid];
+        if ((object_id->type < object_type) ||
+            ((object_id->type == object_type) &&
+             (object_id->instance < object_instance))) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+#endif
+
+/**
+ * @brief Add or remove an object from the active event set.
+ * @details An object has an active event when its Event_State is not
+ *  NORMAL, or when one of its Acked_Transitions is not acknowledged.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the object
+ * @param object_instance [in] The object-instance of the object
+ * @param active [in] true if the object has an active event
+ */
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance, bool active)
+{
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+    unsigned position;
+    bool found;
+
+    position = Active_Event_Lower_Bound(object_type, object_instance);
+    found = (position < Active_Event_Count) &&
+        (Active_Event[position].type == object_type) &&
+        (Active_Event[position].instance == object_instance);
+    if (active && !found) {
+        if (Active_Event_Count >= MAX_GET_EVENT_ACTIVE_OBJECTS) {
+            debug_print("GetEventInformation: active event set is full!\n");
+            Active_Event_Overflow = true;
+            return;
+        }
+        memmove(
+            &Active_Event[position + 1], &Active_Event[position],
+            (Active_Event_Count - position) * sizeof(Active_Event[0]));
+        Active_Event[position].type = object_type;
+        Active_Event[position].instance = object_instance;
+        Active_Event_Count++;
+    } else if (!active && found) {
+        Active_Event_Count--;
+        memmove(
+            &Active_Event[position], &Active_Event[position + 1],
+            (Active_Event_Count - position) * sizeof(Active_Event[0]));
+    }
+#else
+    (void)object_type;
+    (void)object_instance;
+    (void)active;
+#endif
+}
+
+/**
+ * @brief Determine if the active events of an object type are tracked
+ *  by the active event set
+ * @param object_type [in] The BACNET_OBJECT_TYPE to check
+ * @return true if the active event set holds the active events of the type
+ */
+bool handler_get_event_information_active(BACNET_OBJECT_TYPE object_type)
+{
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+    return (object_type < MAX_BACNET_OBJECT_TYPE) &&
+        Get_Event_Index[object_type] && !Active_Event_Overflow;
+#else
+    (void)object_type;
+    return false;
+#endif
+}
+
+/**
+ * @brief Find where to resume iterating the active event set
+ * @param object_type [in] The BACNET_OBJECT_TYPE to iterate
+ * @param object_instance [in] The first object-instance to include
+ * @return position of the first active event object of the type
+ *  with the object-instance or a larger one
+ */
+unsigned handler_get_event_information_active_position(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+    return Active_Event_Lower_Bound(object_type, object_instance);
+#else
+    (void)object_type;
+    (void)object_instance;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get the index of an active event object from the active event set
+ * @param position [in] The position in the active event set
+ * @param object_type [in] The BACNET_OBJECT_TYPE being iterated
+ * @param object_index [out] The index of the object for its event functions
+ * @return true if the position holds an object of the type
+ */
+bool handler_get_event_information_active_object(
+    unsigned position, BACNET_OBJECT_TYPE object_type, unsigned *object_index)
+{
+#if defined(BACNET_GET_EVENT_ACTIVE_SET)
+    if ((position >= Active_Event_Count) ||
+        (Active_Event[position].type != object_type) ||
+        !Get_Event_Index[object_type]) {
+        return false;
+    }
+    if (object_index) {
+        *object_index =
+            Get_Event_Index[object_type](Active_Event[position].instance);
+    }
+
+    return true;
+#else
+    (void)position;
+    (void)object_type;
+    (void)object_index;
+    return false;
+#endif
+}
+
 /**
  * @brief Handle a GetEventInformation service request.
  * @details The GetEventInformation service is used by a client BACnet-user to
@@ -96,6 +270,8 @@ void handler_get_event_information(
     BACNET_ADDRESS my_address;
     BACNET_OBJECT_ID object_id;
     unsigned i = 0, j = 0; /* counter */
+    unsigned index = 0, position = 0;
+    bool active = false;
     BACNET_GET_EVENT_INFORMATION_DATA getevent_data = { 0 };
     int valid_event = 0;
 
@@ -136,10 +312,31 @@ void handler_get_event_information(
     }
     pdu_len += len;
     apdu_len = len;
-    for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
+    for (i = 0; (i < MAX_BACNET_OBJECT_TYPE) && !more_events; i++) {
         if (Get_Event_Info[i]) {
+            active = handler_get_event_information_active(i);
+            if (active) {
+                /* resume right after the 'Last Received Object Identifier'
+                   without visiting the objects before it */
+                if (object_id.type == MAX_BACNET_OBJECT_TYPE) {
+                    position = handler_get_event_information_active_position(
+                        i, 0);
+                } else if (object_id.type == i) {
+                    position = handler_get_event_information_active_position(
+                        i, object_id.instance + 1);
+                    object_id.type = MAX_BACNET_OBJECT_TYPE;
+                } else {
+                    continue;
+                }
+            }
             for (j = 0; j < 0xffff; j++) {
-                valid_event = Get_Event_Info[i](j, &getevent_data);
+                if (!active) {
+                    index = j;
+                } else if (!handler_get_event_information_active_object(
+                               position++, i, &index)) {
+                    break;
+                }
+                valid_event = Get_Event_Info[i](index, &getevent_data);
                 if (valid_event > 0) {
                     /* encode GetEvent_data only when type of object_id has max
                      * value */
@@ -183,7 +380,7 @@ void handler_get_event_information(
                     } else {
                         pdu_len += len;
                     }
-                } else if (valid_event < 0) {
+                } else if ((valid_event < 0) && !active) {
                     break;
                 }
             }
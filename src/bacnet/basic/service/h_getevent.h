@@ -27,6 +27,23 @@ BACNET_STACK_EXPORT
 void handler_get_event_information_set(
     BACNET_OBJECT_TYPE object_type, get_event_info_function pFunction);
 
+BACNET_STACK_EXPORT
+void handler_get_event_information_index_set(
+    BACNET_OBJECT_TYPE object_type, get_event_index_function pFunction);
+BACNET_STACK_EXPORT
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance, bool active);
+BACNET_STACK_EXPORT
+bool handler_get_event_information_active(BACNET_OBJECT_TYPE object_type);
+BACNET_STACK_EXPORT
+unsigned handler_get_event_information_active_position(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool handler_get_event_information_active_object(
+    unsigned position,
+    BACNET_OBJECT_TYPE object_type,
+    unsigned *object_index);
+
 BACNET_STACK_EXPORT
 void handler_get_event_information(
     uint8_t *service_request,
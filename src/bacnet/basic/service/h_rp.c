@@ -32,6 +32,137 @@
 
 /** @file h_rp.c  Handles Read Property requests. */
 
+/**
+ * @brief Encode the Complex-ACK of a ReadProperty request, with the value
+ *  read from the Device
+ * @param apdu [out] buffer for the APDU
+ * @param apdu_max [in] size of the buffer
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ * @param rpdata [out] the decoded request, and the error if any
+ * @return number of bytes encoded, or a negative BACNET_STATUS value
+ */
+static int rp_reply_ack_encode(
+    uint8_t *apdu,
+    size_t apdu_max,
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int len = 0;
+    int apdu_len = 0;
+
+    if (service_len == 0) {
+        rpdata->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+        debug_print("RP: Missing Required Parameter. Sending Reject!\n");
+        return BACNET_STATUS_REJECT;
+    }
+    if (service_data->segmented_message) {
+        /* we don't support segmentation - send an abort */
+        debug_print("RP: Segmented message.  Sending Abort!\n");
+        return BACNET_STATUS_ABORT;
+    }
+    len = rp_decode_service_request(service_request, service_len, rpdata);
+    if (len <= 0) {
+        debug_print("RP: Unable to decode Request!\n");
+        return len;
+    }
+    /* When the object-type in the Object Identifier parameter
+       contains the value DEVICE and the instance in the 'Object
+       Identifier' parameter contains the value 4194303, the responding
+       BACnet-user shall treat the Object Identifier as if it correctly
+       matched the local Device object. This allows the device instance
+       of a device that does not generate I-Am messages to be
+       determined. */
+    if ((rpdata->object_type == OBJECT_DEVICE) &&
+        (rpdata->object_instance == BACNET_MAX_INSTANCE)) {
+        rpdata->object_instance = Device_Object_Instance_Number();
+    }
+#if (BACNET_PROTOCOL_REVISION >= 17)
+    /* When the object-type in the Object Identifier parameter
+       contains the value NETWORK_PORT and the instance in the 'Object
+       Identifier' parameter contains the value 4194303, the responding
+       BACnet-user shall treat the Object Identifier as if it correctly
+       matched the local Network Port object representing the network
+       port through which the request was received. This allows the
+       network port instance of the network port that was used to
+       receive the request to be determined. */
+    if ((rpdata->object_type == OBJECT_NETWORK_PORT) &&
+        (rpdata->object_instance == BACNET_MAX_INSTANCE)) {
+        rpdata->object_instance = Network_Port_Index_To_Instance(0);
+    }
+#endif
+    apdu_len =
+        rp_ack_encode_apdu_init(&apdu[0], service_data->invoke_id, rpdata);
+    /* configure our storage: the value is encoded in place, with
+       room reserved for the closing tag */
+    rpdata->application_data = &apdu[apdu_len];
+    rpdata->application_data_len =
+        apdu_max - apdu_len - rp_ack_encode_apdu_object_property_end(NULL);
+    if (!read_property_bacnet_array_valid(rpdata)) {
+        len = BACNET_STATUS_ERROR;
+    } else {
+        len = Device_Read_Property(rpdata);
+    }
+    if (len < 0) {
+        debug_print("RP: Device_Read_Property: ");
+        if (len == BACNET_STATUS_ABORT) {
+            debug_print("Abort!\n");
+        } else if (len == BACNET_STATUS_ERROR) {
+            debug_print("Error!\n");
+        } else if (len == BACNET_STATUS_REJECT) {
+            debug_print("Reject!\n");
+        } else {
+            debug_print("Unknown Len!\n");
+        }
+        return len;
+    }
+    apdu_len += len;
+    apdu_len += rp_ack_encode_apdu_object_property_end(&apdu[apdu_len]);
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the Abort, Error, or Reject of a ReadProperty request
+ * @param apdu [out] buffer for the APDU
+ * @param status [in] BACNET_STATUS_ABORT, ERROR, or REJECT
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ * @param rpdata [in] the request, with the error
+ * @return number of bytes encoded, or -1 for an unknown status
+ */
+static int rp_reply_error_encode(
+    uint8_t *apdu,
+    int status,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int apdu_len = -1;
+
+    if (status == BACNET_STATUS_ABORT) {
+        apdu_len = abort_encode_apdu(
+            apdu, service_data->invoke_id,
+            abort_convert_error_code(rpdata->error_code), true);
+        debug_print("RP: Sending Abort!\n");
+    } else if (status == BACNET_STATUS_ERROR) {
+        apdu_len = bacerror_encode_apdu(
+            apdu, service_data->invoke_id, SERVICE_CONFIRMED_READ_PROPERTY,
+            rpdata->error_class, rpdata->error_code);
+        debug_print("RP: Sending Error!\n");
+    } else if (status == BACNET_STATUS_REJECT) {
+        apdu_len = reject_encode_apdu(
+            apdu, service_data->invoke_id,
+            reject_convert_error_code(rpdata->error_code));
+        debug_print("RP: Sending Reject!\n");
+    }
+
+    return apdu_len;
+}
+
 /** Handler for a ReadProperty Service request.
  * @ingroup DSRP
  * This handler will be invoked by apdu_handler() if it has been enabled
@@ -66,126 +197,180 @@ void handler_read_property(
     bool error = true; /* assume that there is an error */
     int bytes_sent = 0;
     BACNET_ADDRESS my_address;
+    uint8_t *apdu = NULL;
+    size_t apdu_max = 0;
+    uint8_t *pdu = &Handler_Transmit_Buffer[0];
+    size_t pdu_size = sizeof(Handler_Transmit_Buffer);
+#if defined(BACNET_PBUF_SEND)
+    BACNET_PBUF pbuf;
 
+    /* leave headroom so the datalink header is prepended in place */
+    (void)pbuf_init(
+        &pbuf, Handler_Transmit_Buffer, sizeof(Handler_Transmit_Buffer),
+        DATALINK_HEADROOM);
+    pdu = pbuf_tail(&pbuf);
+    pdu_size = pbuf_tailroom(&pbuf);
+#endif
     /* configure default error code as an abort since it is common */
     rpdata.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
     /* encode the NPDU portion of the packet */
     datalink_get_my_address(&my_address);
     npdu_encode_npdu_data(&npdu_data, false, service_data->priority);
-    npdu_len = npdu_encode_pdu(
-        &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+    npdu_len = npdu_encode_pdu(&pdu[0], src, &my_address, &npdu_data);
     if (npdu_len <= 0) {
         /* If 0 or negative, there were problems with the data or encoding. */
         len = BACNET_STATUS_ABORT;
         debug_print("RP: npdu_encode_pdu error.  Sending Abort!\n");
-    } else if (service_len == 0) {
-        len = BACNET_STATUS_REJECT;
-        rpdata.error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
-        debug_print("RP: Missing Required Parameter. Sending Reject!\n");
-    } else if (service_data->segmented_message) {
-        /* we don't support segmentation - send an abort */
-        len = BACNET_STATUS_ABORT;
-        debug_print("RP: Segmented message.  Sending Abort!\n");
     } else {
-        len = rp_decode_service_request(service_request, service_len, &rpdata);
-        if (len <= 0) {
-            debug_print("RP: Unable to decode Request!\n");
-        } else {
-            /* When the object-type in the Object Identifier parameter
-               contains the value DEVICE and the instance in the 'Object
-               Identifier' parameter contains the value 4194303, the responding
-               BACnet-user shall treat the Object Identifier as if it correctly
-               matched the local Device object. This allows the device instance
-               of a device that does not generate I-Am messages to be
-               determined. */
-            if ((rpdata.object_type == OBJECT_DEVICE) &&
-                (rpdata.object_instance == BACNET_MAX_INSTANCE)) {
-                rpdata.object_instance = Device_Object_Instance_Number();
-            }
-#if (BACNET_PROTOCOL_REVISION >= 17)
-            /* When the object-type in the Object Identifier parameter
-               contains the value NETWORK_PORT and the instance in the 'Object
-               Identifier' parameter contains the value 4194303, the responding
-               BACnet-user shall treat the Object Identifier as if it correctly
-               matched the local Network Port object representing the network
-               port through which the request was received. This allows the
-               network port instance of the network port that was used to
-               receive the request to be determined. */
-            if ((rpdata.object_type == OBJECT_NETWORK_PORT) &&
-                (rpdata.object_instance == BACNET_MAX_INSTANCE)) {
-                rpdata.object_instance = Network_Port_Index_To_Instance(0);
-            }
+        apdu = &pdu[npdu_len];
+        apdu_max = pdu_size - npdu_len;
+#if BACNET_SEGMENTATION_ENABLED
+        if (service_data->segmented_response_accepted) {
+            /* encode the whole reply, and segment it if needed */
+            apdu = &Handler_Segment_Buffer[0];
+            apdu_max = sizeof(Handler_Segment_Buffer);
+        }
 #endif
-            apdu_len = rp_ack_encode_apdu_init(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                &rpdata);
-            /* configure our storage */
-            rpdata.application_data =
-                &Handler_Transmit_Buffer[npdu_len + apdu_len];
-            rpdata.application_data_len =
-                sizeof(Handler_Transmit_Buffer) - (npdu_len + apdu_len);
-            if (!read_property_bacnet_array_valid(&rpdata)) {
-                len = BACNET_STATUS_ERROR;
-            } else {
-                len = Device_Read_Property(&rpdata);
-            }
-            if (len >= 0) {
-                apdu_len += len;
-                len = rp_ack_encode_apdu_object_property_end(
-                    &Handler_Transmit_Buffer[npdu_len + apdu_len]);
-                apdu_len += len;
-                if (apdu_len > service_data->max_resp) {
-                    /* too big for the sender - send an abort!
-                       Setting of error code needed here as read property
-                       processing may have overridden the default set at start
-                     */
-                    rpdata.error_code =
-                        ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
-                    len = BACNET_STATUS_ABORT;
-                    debug_print("RP: Message too large.\n");
-                } else {
-                    debug_print("RP: Sending Ack!\n");
-                    error = false;
+        len = rp_reply_ack_encode(
+            apdu, apdu_max, service_request, service_len, service_data,
+            &rpdata);
+        if (len >= 0) {
+            apdu_len = len;
+#if BACNET_SEGMENTATION_ENABLED
+            if ((apdu_len > service_data->max_resp) ||
+                (apdu_len > apdu_max_length_accepted())) {
+                if (tsm_set_segmented_complex_ack(
+                        src, &npdu_data, service_data, apdu,
+                        (uint16_t)apdu_len)) {
+                    debug_print("RP: Sending Segmented Ack!\n");
+                    return;
                 }
+                rpdata.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+                len = BACNET_STATUS_ABORT;
+                debug_print("RP: Message too large.\n");
             } else {
-                debug_print("RP: Device_Read_Property: ");
-                if (len == BACNET_STATUS_ABORT) {
-                    debug_print("Abort!\n");
-                } else if (len == BACNET_STATUS_ERROR) {
-                    debug_print("Error!\n");
-                } else if (len == BACNET_STATUS_REJECT) {
-                    debug_print("Reject!\n");
-                } else {
-                    debug_print("Unknown Len!\n");
+                if (apdu != &pdu[npdu_len]) {
+                    memcpy(&pdu[npdu_len], apdu, apdu_len);
                 }
+                debug_print("RP: Sending Ack!\n");
+                error = false;
             }
+#else
+            if (apdu_len > service_data->max_resp) {
+                /* too big for the sender - send an abort!
+                   Setting of error code needed here as read property
+                   processing may have overridden the default set at start
+                 */
+                rpdata.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+                len = BACNET_STATUS_ABORT;
+                debug_print("RP: Message too large.\n");
+            } else {
+                debug_print("RP: Sending Ack!\n");
+                error = false;
+            }
+#endif
         }
     }
     if (error) {
-        if (len == BACNET_STATUS_ABORT) {
-            apdu_len = abort_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                abort_convert_error_code(rpdata.error_code), true);
-            debug_print("RP: Sending Abort!\n");
-        } else if (len == BACNET_STATUS_ERROR) {
-            apdu_len = bacerror_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                SERVICE_CONFIRMED_READ_PROPERTY, rpdata.error_class,
-                rpdata.error_code);
-            debug_print("RP: Sending Error!\n");
-        } else if (len == BACNET_STATUS_REJECT) {
-            apdu_len = reject_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                reject_convert_error_code(rpdata.error_code));
-            debug_print("RP: Sending Reject!\n");
-        }
+        apdu_len = rp_reply_error_encode(
+            &pdu[npdu_len], len, service_data, &rpdata);
     }
     pdu_len = npdu_len + apdu_len;
-    bytes_sent = datalink_send_pdu(
-        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#if defined(BACNET_PBUF_SEND)
+    if (pbuf_append(&pbuf, (uint16_t)pdu_len)) {
+        bytes_sent = datalink_send_pbuf(src, &npdu_data, &pbuf);
+    }
+#else
+    bytes_sent = datalink_send_pdu(src, &npdu_data, &pdu[0], pdu_len);
+#endif
     if (bytes_sent <= 0) {
         debug_perror("RP: Failed to send PDU");
     }
 
     return;
 }
+
+/**
+ * @brief Answer a ReadProperty request into a buffer, without sending it.
+ *  An MS/TP datalink calls this from its own thread when a
+ *  DATA_EXPECTING_REPLY frame arrives, so that the reply is sent in the
+ *  same token visit instead of a Reply Postponed.
+ * @note Device_Read_Property() is called from the caller's thread, so the
+ *  objects must be safe to read while the application is running.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param npdu [in] the NPDU of the request
+ * @param npdu_len [in] number of bytes of the NPDU
+ * @param pdu [out] buffer for the NPDU of the reply
+ * @param pdu_size [in] size of the buffer
+ * @return number of bytes of the reply, or 0 if the request is left to
+ *  the application: any other request, a segmented request, or a reply
+ *  that would be an Abort or need segmentation
+ */
+uint16_t handler_read_property_fast_reply(
+    BACNET_ADDRESS *src,
+    uint8_t *npdu,
+    uint16_t npdu_len,
+    uint8_t *pdu,
+    uint16_t pdu_size)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS my_address;
+    uint8_t service_choice = 0;
+    uint8_t *service_request = NULL;
+    uint16_t service_len = 0;
+    uint8_t *apdu;
+    uint16_t apdu_size;
+    int apdu_offset;
+    int len;
+
+    if (!src || !npdu || (npdu_len < 1) || !pdu ||
+        (npdu[0] != BACNET_PROTOCOL_VERSION)) {
+        return 0;
+    }
+    apdu_offset = bacnet_npdu_decode(npdu, npdu_len, &dest, src, &npdu_data);
+    if ((apdu_offset <= 0) || (apdu_offset >= npdu_len) ||
+        npdu_data.network_layer_message || (dest.net != 0) ||
+        ((npdu[apdu_offset] & 0xF0) != PDU_TYPE_CONFIRMED_SERVICE_REQUEST)) {
+        return 0;
+    }
+    apdu = &npdu[apdu_offset];
+    apdu_size = npdu_len - (uint16_t)apdu_offset;
+    if ((apdu_decode_confirmed_service_request(
+             apdu, apdu_size, &service_data, &service_choice,
+             &service_request, &service_len) == 0) ||
+        (service_choice != SERVICE_CONFIRMED_READ_PROPERTY) ||
+        service_data.segmented_message) {
+        return 0;
+    }
+    service_data.priority = npdu_data.priority;
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, service_data.priority);
+    len = npdu_encode_pdu(pdu, src, &my_address, &npdu_data);
+    if ((len <= 0) || (len >= pdu_size)) {
+        return 0;
+    }
+    apdu = &pdu[len];
+    apdu_size = pdu_size - (uint16_t)len;
+    len = rp_reply_ack_encode(
+        apdu, apdu_size, service_request, service_len, &service_data,
+        &rpdata);
+    if (len >= 0) {
+        if ((len > service_data.max_resp) ||
+            (len > apdu_max_length_accepted())) {
+            return 0;
+        }
+        debug_print("RP: Sending Fast Ack!\n");
+    } else if (len == BACNET_STATUS_ABORT) {
+        return 0;
+    } else {
+        len = rp_reply_error_encode(apdu, len, &service_data, &rpdata);
+        if (len <= 0) {
+            return 0;
+        }
+    }
+
+    return (uint16_t)((apdu - pdu) + len);
+}
@@ -30,6 +30,13 @@ void handler_read_property(
     uint16_t service_len,
     BACNET_ADDRESS *src,
     BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
+uint16_t handler_read_property_fast_reply(
+    BACNET_ADDRESS *src,
+    uint8_t *npdu,
+    uint16_t npdu_len,
+    uint8_t *pdu,
+    uint16_t pdu_size);
 
 #ifdef __cplusplus
 }
@@ -33,8 +33,6 @@
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/datalink/datalink.h"
 
-static uint8_t Temp_Buf[MAX_APDU] = { 0 };
-
 /**
  * @brief Fetches the lists of properties (array of BACNET_PROPERTY_ID's) for
  * this object type and the special properties ALL or REQUIRED or OPTIONAL.
@@ -56,7 +54,11 @@ static BACNET_PROPERTY_ID RPM_Object_Property(
     required = pPropertyList->Required.count;
     optional = pPropertyList->Optional.count;
     proprietary = pPropertyList->Proprietary.count;
-    if (special_property == PROP_ALL) {
+    if ((special_property == PROP_ALL) && pPropertyList->All.pList) {
+        if (index < pPropertyList->All.count) {
+            property = pPropertyList->All.pList[index];
+        }
+    } else if (special_property == PROP_ALL) {
         if (index < required) {
             property = pPropertyList->Required.pList[index];
         } else if (index < (required + optional)) {
@@ -95,7 +97,9 @@ static unsigned RPM_Object_Property_Count(
 {
     unsigned count = 0; /* return value */
 
-    if (special_property == PROP_ALL) {
+    if ((special_property == PROP_ALL) && pPropertyList->All.pList) {
+        count = pPropertyList->All.count;
+    } else if (special_property == PROP_ALL) {
         count = pPropertyList->Required.count + pPropertyList->Optional.count +
             pPropertyList->Proprietary.count;
     } else if (special_property == PROP_REQUIRED) {
@@ -110,6 +114,8 @@ static unsigned RPM_Object_Property_Count(
 /**
  * @brief Encode the RPM property returning the length of the encoding,
  * or 0 if there is no room to fit the encoding.
+ * The property value is encoded in place, between the opening tag and
+ * the room reserved for the closing tag, so it is not copied.
  * @param apdu [out] The buffer to encode the property into.
  * @param offset [in] The offset into the buffer to start encoding.
  * @param max_apdu [in] The maximum length of the buffer.
@@ -121,17 +127,18 @@ static int RPM_Encode_Property(
     uint8_t *apdu, uint16_t offset, uint16_t max_apdu, BACNET_RPM_DATA *rpmdata)
 {
     int len = 0;
-    size_t copy_len = 0;
     int apdu_len = 0;
     BACNET_READ_PROPERTY_DATA rpdata;
 
     len = rpm_ack_encode_apdu_object_property(
-        &Temp_Buf[0], rpmdata->object_property, rpmdata->array_index);
-    copy_len = memcopy(&apdu[0], &Temp_Buf[0], offset, len, max_apdu);
-    if (copy_len == 0) {
+        NULL, rpmdata->object_property, rpmdata->array_index);
+    /* room for the property, and the opening and closing tags */
+    if (!memcopylen(offset, max_apdu, len + 2)) {
         rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
         return BACNET_STATUS_ABORT;
     }
+    len = rpm_ack_encode_apdu_object_property(
+        &apdu[offset], rpmdata->object_property, rpmdata->array_index);
     apdu_len += len;
     rpdata.error_class = ERROR_CLASS_OBJECT;
     rpdata.error_code = ERROR_CODE_UNKNOWN_OBJECT;
@@ -139,8 +146,8 @@ static int RPM_Encode_Property(
     rpdata.object_instance = rpmdata->object_instance;
     rpdata.object_property = rpmdata->object_property;
     rpdata.array_index = rpmdata->array_index;
-    rpdata.application_data = &Temp_Buf[0];
-    rpdata.application_data_len = sizeof(Temp_Buf);
+    rpdata.application_data = &apdu[offset + apdu_len + 1];
+    rpdata.application_data_len = max_apdu - (offset + apdu_len + 2);
 
     if ((rpmdata->object_property == PROP_ALL) ||
         (rpmdata->object_property == PROP_REQUIRED) ||
@@ -161,18 +168,17 @@ static int RPM_Encode_Property(
         }
         /* error was returned - encode that for the response */
         len = rpm_ack_encode_apdu_object_property_error(
-            &Temp_Buf[0], rpdata.error_class, rpdata.error_code);
-        copy_len =
-            memcopy(&apdu[0], &Temp_Buf[0], offset + apdu_len, len, max_apdu);
-
-        if (copy_len == 0) {
+            NULL, rpdata.error_class, rpdata.error_code);
+        if (!memcopylen(offset + apdu_len, max_apdu, len)) {
             rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
             return BACNET_STATUS_ABORT;
         }
-    } else if ((offset + apdu_len + 1 + len + 1) < max_apdu) {
-        /* enough room to fit the property value and tags */
+        len = rpm_ack_encode_apdu_object_property_error(
+            &apdu[offset + apdu_len], rpdata.error_class, rpdata.error_code);
+    } else if (len <= rpdata.application_data_len) {
+        /* the value is already in place - add the tags around it */
         len = rpm_ack_encode_apdu_object_property_value(
-            &apdu[offset + apdu_len], &Temp_Buf[0], len);
+            &apdu[offset + apdu_len], rpdata.application_data, len);
     } else {
         /* not enough room - abort! */
         rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -183,6 +189,18 @@ static int RPM_Encode_Property(
     return apdu_len;
 }
 
+/**
+ * @brief Check that a part of the RPM response fits in the buffer
+ * @param apdu_len [in] The current length of the response.
+ * @param apdu_max [in] The size of the response buffer.
+ * @param len [in] The length of the part, from encoding it with NULL.
+ * @return true if the part fits at the end of the response.
+ */
+static bool RPM_Encode_Fits(int apdu_len, uint16_t apdu_max, int len)
+{
+    return (len > 0) && memcopylen(apdu_len, apdu_max, len);
+}
+
 /** Handler for a ReadPropertyMultiple Service request.
  * @ingroup DSRPM
  * This handler will be invoked by apdu_handler() if it has been enabled
@@ -210,7 +228,6 @@ void handler_read_property_multiple(
 {
     bool berror = false;
     int len = 0;
-    uint16_t copy_len = 0;
     uint16_t decode_len = 0;
     int pdu_len = 0;
     BACNET_NPDU_DATA npdu_data;
@@ -220,6 +237,8 @@ void handler_read_property_multiple(
     int apdu_len = 0;
     int npdu_len = 0;
     int error = 0;
+    uint8_t *apdu = NULL;
+    uint16_t apdu_max = 0;
 
     if (service_data) {
         datalink_get_my_address(&my_address);
@@ -235,10 +254,19 @@ void handler_read_property_multiple(
             error = BACNET_STATUS_ABORT;
             debug_print("RPM: Segmented message. Sending Abort!\r\n");
         } else {
+            apdu = &Handler_Transmit_Buffer[npdu_len];
+            apdu_max = apdu_max_length_accepted();
+#if BACNET_SEGMENTATION_ENABLED
+            if (service_data->segmented_response_accepted) {
+                /* encode the whole reply, and segment it if needed */
+                apdu = &Handler_Segment_Buffer[0];
+                apdu_max = sizeof(Handler_Segment_Buffer);
+            }
+#endif
             /* decode apdu request & encode apdu reply
                encode complex ack, invoke id, service choice */
             apdu_len = rpm_ack_encode_apdu_init(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id);
+                &apdu[0], service_data->invoke_id);
 
             for (;;) {
                 /* Start by looking for an object ID */
@@ -279,11 +307,8 @@ void handler_read_property_multiple(
                 }
 #endif
                 /* Stick this object id into the reply - if it will fit */
-                len = rpm_ack_encode_apdu_object_begin(&Temp_Buf[0], &rpmdata);
-                copy_len = memcopy(
-                    &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0], apdu_len,
-                    len, MAX_APDU);
-                if (copy_len == 0) {
+                len = rpm_ack_encode_apdu_object_begin(NULL, &rpmdata);
+                if (!RPM_Encode_Fits(apdu_len, apdu_max, len)) {
                     debug_print("RPM: Response too big!\n");
                     rpmdata.error_code =
                         ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -291,7 +316,8 @@ void handler_read_property_multiple(
                     berror = true;
                     break;
                 }
-                apdu_len += copy_len;
+                apdu_len +=
+                    rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
                 /* do each property of this object of the RPM request */
                 for (;;) {
                     /* Fetch a property */
@@ -312,7 +338,9 @@ void handler_read_property_multiple(
                     if ((rpmdata.object_property == PROP_ALL) ||
                         (rpmdata.object_property == PROP_REQUIRED) ||
                         (rpmdata.object_property == PROP_OPTIONAL)) {
-                        struct special_property_list_t property_list;
+                        struct special_property_list_t property_list = {
+                            0
+                        };
                         unsigned property_count = 0;
                         unsigned index = 0;
                         BACNET_PROPERTY_ID special_object_property;
@@ -320,8 +348,8 @@ void handler_read_property_multiple(
                         if (!Device_Valid_Object_Id(
                                 rpmdata.object_type, rpmdata.object_instance)) {
                             len = RPM_Encode_Property(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                &apdu[0], (uint16_t)apdu_len, apdu_max,
+                                &rpmdata);
                             if (len > 0) {
                                 apdu_len += len;
                             } else {
@@ -336,14 +364,9 @@ void handler_read_property_multiple(
                             /* No array index options for this special property.
                                Encode error for this object property response */
                             len = rpm_ack_encode_apdu_object_property(
-                                &Temp_Buf[0], rpmdata.object_property,
+                                NULL, rpmdata.object_property,
                                 rpmdata.array_index);
-
-                            copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
-
-                            if (copy_len == 0) {
+                            if (!RPM_Encode_Fits(apdu_len, apdu_max, len)) {
                                 debug_print(
                                     "RPM: Too full to encode property!\n");
                                 rpmdata.error_code =
@@ -355,16 +378,14 @@ void handler_read_property_multiple(
                                 break;
                             }
 
+                            len = rpm_ack_encode_apdu_object_property(
+                                &apdu[apdu_len], rpmdata.object_property,
+                                rpmdata.array_index);
                             apdu_len += len;
                             len = rpm_ack_encode_apdu_object_property_error(
-                                &Temp_Buf[0], ERROR_CLASS_PROPERTY,
+                                NULL, ERROR_CLASS_PROPERTY,
                                 ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
-
-                            copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
-
-                            if (copy_len == 0) {
+                            if (!RPM_Encode_Fits(apdu_len, apdu_max, len)) {
                                 debug_print("RPM: Too full to encode error!\n");
                                 rpmdata.error_code =
                                     ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -374,6 +395,9 @@ void handler_read_property_multiple(
                                 berror = true;
                                 break;
                             }
+                            len = rpm_ack_encode_apdu_object_property_error(
+                                &apdu[apdu_len], ERROR_CLASS_PROPERTY,
+                                ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
                             apdu_len += len;
                         } else {
                             special_object_property = rpmdata.object_property;
@@ -395,8 +419,8 @@ void handler_read_property_multiple(
                                         rpmdata.object_type,
                                         rpmdata.object_instance)) {
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        &apdu[0], (uint16_t)apdu_len, apdu_max,
+                                        &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -417,8 +441,8 @@ void handler_read_property_multiple(
                                             &property_list,
                                             special_object_property, index);
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        &apdu[0], (uint16_t)apdu_len, apdu_max,
+                                        &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -436,8 +460,7 @@ void handler_read_property_multiple(
                     } else {
                         /* handle an individual property */
                         len = RPM_Encode_Property(
-                            &Handler_Transmit_Buffer[npdu_len],
-                            (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                            &apdu[0], (uint16_t)apdu_len, apdu_max, &rpmdata);
                         if (len > 0) {
                             apdu_len += len;
                         } else {
@@ -456,11 +479,8 @@ void handler_read_property_multiple(
                         /* Reached end of property list so cap the result list
                          */
                         decode_len++;
-                        len = rpm_ack_encode_apdu_object_end(&Temp_Buf[0]);
-                        copy_len = memcopy(
-                            &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0],
-                            apdu_len, len, MAX_APDU);
-                        if (copy_len == 0) {
+                        len = rpm_ack_encode_apdu_object_end(NULL);
+                        if (!RPM_Encode_Fits(apdu_len, apdu_max, len)) {
                             debug_print(
                                 "RPM: Too full to encode object end!\n");
                             rpmdata.error_code =
@@ -470,9 +490,9 @@ void handler_read_property_multiple(
                                both loops will be broken! */
                             berror = true;
                             break;
-                        } else {
-                            apdu_len += copy_len;
                         }
+                        apdu_len +=
+                            rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
                         /* finished with this property list */
                         break;
                     }
@@ -487,6 +507,23 @@ void handler_read_property_multiple(
             }
             /* If not having an error so far, check the remaining space. */
             if (!berror) {
+#if BACNET_SEGMENTATION_ENABLED
+                if ((apdu_len > service_data->max_resp) ||
+                    (apdu_len > apdu_max_length_accepted())) {
+                    if (tsm_set_segmented_complex_ack(
+                            src, &npdu_data, service_data, apdu,
+                            (uint16_t)apdu_len)) {
+                        debug_print("RPM: Sending Segmented Ack!\n");
+                        return;
+                    }
+                    rpmdata.error_code =
+                        ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+                    error = BACNET_STATUS_ABORT;
+                    debug_print("RPM: Message too large.  Sending Abort!\n");
+                } else if (apdu != &Handler_Transmit_Buffer[npdu_len]) {
+                    memcpy(&Handler_Transmit_Buffer[npdu_len], apdu, apdu_len);
+                }
+#else
                 if (apdu_len > service_data->max_resp) {
                     /* too big for the sender - send an abort */
                     rpmdata.error_code =
@@ -494,6 +531,7 @@ void handler_read_property_multiple(
                     error = BACNET_STATUS_ABORT;
                     debug_print("RPM: Message too large.  Sending Abort!\n");
                 }
+#endif
             }
         }
         /* Error fallback. */
@@ -153,6 +153,8 @@ void handler_read_range(
             error = true;
             data.application_data = &Temp_Buf[0];
             data.application_data_len = sizeof(Temp_Buf);
+            /* fill the records up to the APDU limit of this device */
+            data.Overhead += MAX_APDU - apdu_max_length_accepted();
             /* note: legacy API passed buffer separately */
             len = Encode_RR_payload(&Temp_Buf[0], &data);
             if (len >= 0) {
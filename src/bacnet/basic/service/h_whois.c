@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -21,6 +22,28 @@
 
 /** @file h_whois.c  Handles Who-Is requests. */
 
+/* longest random delay of the broadcast I-Am response, 0=no delay */
+static uint16_t I_Am_Response_Delay_Max;
+/* time left until the pending broadcast I-Am response is sent */
+static uint16_t I_Am_Response_Delay;
+static bool I_Am_Response_Pending;
+
+/**
+ * @brief Send the broadcast I-Am response, at once or after a random delay
+ */
+static void who_is_i_am_broadcast(void)
+{
+    if (I_Am_Response_Delay_Max == 0) {
+        Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+    } else if (!I_Am_Response_Pending) {
+        I_Am_Response_Delay =
+            (uint16_t)(rand() % ((unsigned)I_Am_Response_Delay_Max + 1U));
+        I_Am_Response_Pending = true;
+    } else {
+        /* the pending I-Am also answers this Who-Is */
+    }
+}
+
 /** Handler for Who-Is requests, with broadcast I-Am response.
  * @ingroup DMDDB
  * @param service_request [in] The received message to be handled.
@@ -38,18 +61,68 @@ void handler_who_is(
     len = whois_decode_service_request(
         service_request, service_len, &low_limit, &high_limit);
     if (len == 0) {
-        Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+        who_is_i_am_broadcast();
     } else if (len != BACNET_STATUS_ERROR) {
         /* is my device id within the limits? */
         if ((Device_Object_Instance_Number() >= (uint32_t)low_limit) &&
             (Device_Object_Instance_Number() <= (uint32_t)high_limit)) {
-            Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+            who_is_i_am_broadcast();
         }
     }
 
     return;
 }
 
+/** Configure a random delay of the broadcast I-Am response of
+ * handler_who_is().
+ * @ingroup DMDDB
+ *  When many devices answer a global Who-Is at the same time, the I-Am
+ *  burst can overrun BBMD queues and MS/TP links.  With a delay, each
+ *  response waits a random time of up to the given milliseconds, and every
+ *  Who-Is received while a response is waiting is answered by that one
+ *  I-Am.  Seed rand() with a value unique to the device, such as its
+ *  instance number, so the delays differ between devices.
+ *  The handler_who_is_timer_milliseconds() function must then be called
+ *  periodically.
+ * @param milliseconds [in] longest delay, or 0 to respond at once
+ */
+void handler_who_is_response_delay_set(uint16_t milliseconds)
+{
+    I_Am_Response_Delay_Max = milliseconds;
+    if ((milliseconds == 0) && I_Am_Response_Pending) {
+        I_Am_Response_Delay = 0;
+    } else if (I_Am_Response_Delay > milliseconds) {
+        I_Am_Response_Delay = milliseconds;
+    }
+}
+
+/** Get the longest random delay of the broadcast I-Am response
+ * @ingroup DMDDB
+ * @return longest delay in milliseconds, or 0 when responding at once
+ */
+uint16_t handler_who_is_response_delay(void)
+{
+    return I_Am_Response_Delay_Max;
+}
+
+/** Send the delayed broadcast I-Am response when its time has come
+ * @ingroup DMDDB
+ * @param milliseconds [in] time elapsed since the previous call
+ */
+void handler_who_is_timer_milliseconds(uint16_t milliseconds)
+{
+    if (!I_Am_Response_Pending) {
+        return;
+    }
+    if (I_Am_Response_Delay > milliseconds) {
+        I_Am_Response_Delay -= milliseconds;
+    } else {
+        I_Am_Response_Delay = 0;
+        I_Am_Response_Pending = false;
+        Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+    }
+}
+
 /** Handler for Who-Is requests, with Unicast I-Am response (per Addendum
  * 135-2004q).
  * @ingroup DMDDB
@@ -28,6 +28,13 @@ BACNET_STACK_EXPORT
 void handler_who_is(
     uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src);
 
+BACNET_STACK_EXPORT
+void handler_who_is_response_delay_set(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+uint16_t handler_who_is_response_delay(void);
+BACNET_STACK_EXPORT
+void handler_who_is_timer_milliseconds(uint16_t milliseconds);
+
 BACNET_STACK_EXPORT
 void handler_who_is_unicast(
     uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src);
@@ -27,6 +27,67 @@
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/datalink/datalink.h"
 
+#ifndef MAX_WPM_COMMIT_OBJECTS
+#define MAX_WPM_COMMIT_OBJECTS 64
+#endif
+/* called once per written object after all the writes of a request */
+static handler_write_property_multiple_commit_callback_t
+    Write_Property_Multiple_Commit_Callback;
+/* objects written by the current request, waiting for the commit */
+static struct {
+    BACNET_OBJECT_TYPE type;
+    uint32_t instance;
+} Write_Property_Multiple_Commit_Objects[MAX_WPM_COMMIT_OBJECTS];
+static unsigned Write_Property_Multiple_Commit_Count;
+
+/**
+ * @brief Call the commit callback once for each written object
+ */
+static void write_property_multiple_commit(void)
+{
+    unsigned i;
+
+    for (i = 0; i < Write_Property_Multiple_Commit_Count; i++) {
+        Write_Property_Multiple_Commit_Callback(
+            Write_Property_Multiple_Commit_Objects[i].type,
+            Write_Property_Multiple_Commit_Objects[i].instance);
+    }
+    Write_Property_Multiple_Commit_Count = 0;
+}
+
+/**
+ * @brief Write a property, and remember the written object for the commit
+ * @param wp_data [in,out] The BACNET_WRITE_PROPERTY_DATA structure.
+ * @return true if the property was written
+ */
+static bool write_property_multiple_apply(BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    unsigned i;
+
+    if (!Device_Write_Property(wp_data)) {
+        return false;
+    }
+    for (i = 0; i < Write_Property_Multiple_Commit_Count; i++) {
+        if ((Write_Property_Multiple_Commit_Objects[i].type ==
+             wp_data->object_type) &&
+            (Write_Property_Multiple_Commit_Objects[i].instance ==
+             wp_data->object_instance)) {
+            return true;
+        }
+    }
+    if (Write_Property_Multiple_Commit_Count >= MAX_WPM_COMMIT_OBJECTS) {
+        /* commit early rather than forget an object */
+        write_property_multiple_commit();
+    }
+    i = Write_Property_Multiple_Commit_Count;
+    Write_Property_Multiple_Commit_Objects[i].type = wp_data->object_type;
+    Write_Property_Multiple_Commit_Objects[i].instance =
+        wp_data->object_instance;
+    Write_Property_Multiple_Commit_Count++;
+
+    return true;
+}
+
 /** Decoding for an object property.
  *
  * @param apdu [in] The contents of the APDU buffer.
@@ -134,6 +195,7 @@ void handler_write_property_multiple(
     BACNET_WRITE_PROPERTY_DATA wp_data;
     BACNET_NPDU_DATA npdu_data;
     BACNET_ADDRESS my_address;
+    uint32_t database_revision = 0;
     int bytes_sent = 0;
 
     if (service_len == 0) {
@@ -150,7 +212,18 @@ void handler_write_property_multiple(
         /* first time - detect malformed request before writing any data */
         len = write_property_multiple_decode(
             service_request, service_len, &wp_data, NULL);
-        if (len > 0) {
+        if ((len > 0) && Write_Property_Multiple_Commit_Callback) {
+            /* apply every write, then commit each written object once */
+            database_revision = Device_Database_Revision();
+            len = write_property_multiple_decode(
+                service_request, service_len, &wp_data,
+                write_property_multiple_apply);
+            if ((Device_Database_Revision() - database_revision) > 1) {
+                /* one revision for the whole request */
+                Device_Set_Database_Revision(database_revision + 1);
+            }
+            write_property_multiple_commit();
+        } else if (len > 0) {
             len = write_property_multiple_decode(
                 service_request, service_len, &wp_data, Device_Write_Property);
         }
@@ -190,3 +263,22 @@ void handler_write_property_multiple(
         debug_perror("WPM: Failed to send PDU");
     }
 }
+
+/**
+ * @brief Configures the commit callback, which enables the transaction mode
+ *  of the WritePropertyMultiple handler
+ * @note In transaction mode, every write of a request is decoded and
+ *  checked before any write is applied.  After the writes are applied,
+ *  the Database_Revision advances at most once for the request, and the
+ *  callback is called once for each written object.  The callback is the
+ *  place to persist the objects and to report their change of value with
+ *  handler_cov_object_changed(), instead of doing so for each property in
+ *  the Device_Write_Property_Store_Callback_Set() callback.
+ * @param cb - pointer to #handler_write_property_multiple_commit_callback_t,
+ *  or NULL to apply each write on its own
+ */
+void handler_write_property_multiple_commit_callback_set(
+    handler_write_property_multiple_commit_callback_t cb)
+{
+    Write_Property_Multiple_Commit_Callback = cb;
+}
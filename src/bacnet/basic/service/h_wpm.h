@@ -21,6 +21,9 @@
 #include "bacnet/bacapp.h"
 #include "bacnet/apdu.h"
 
+typedef void (*handler_write_property_multiple_commit_callback_t)(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -31,6 +34,9 @@ void handler_write_property_multiple(
     uint16_t service_len,
     BACNET_ADDRESS *src,
     BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
+void handler_write_property_multiple_commit_callback_set(
+    handler_write_property_multiple_commit_callback_t cb);
 
 #ifdef __cplusplus
 }
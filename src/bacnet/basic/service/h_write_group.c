@@ -54,7 +54,10 @@ static void handler_write_group_notification_callback(
 {
     BACNET_WRITE_GROUP_NOTIFICATION *head;
 
-    handler_write_group_print_data(data);
+    if (change_list_index == 0) {
+        /* the request data is the same for each change-list element */
+        handler_write_group_print_data(data);
+    }
     head = &Write_Group_Notification_Head;
     do {
         if (head->callback) {
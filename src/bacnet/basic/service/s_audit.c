@@ -0,0 +1,286 @@
+/**
+ * @file
+ * @brief Send AuditNotification requests that carry a batch of
+ *  notifications.  Notifications are queued and sent together when the
+ *  batch is full, when the next one would not fit in the APDU, or when
+ *  the oldest one has waited for the batch time.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacaudit.h"
+#include "bacnet/dcc.h"
+#include "bacnet/npdu.h"
+/* some demo stuff needed */
+#include "bacnet/datalink/datalink.h"
+#include "bacnet/basic/tsm/tsm.h"
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/services.h"
+
+/* number of notifications held for the next request */
+#ifndef AUDIT_NOTIFICATION_QUEUE_SIZE
+#define AUDIT_NOTIFICATION_QUEUE_SIZE 8
+#endif
+/* default time the oldest queued notification waits for the batch */
+#ifndef AUDIT_NOTIFICATION_BATCH_MS
+#define AUDIT_NOTIFICATION_BATCH_MS 1000
+#endif
+/* confirmed APDU header, and the opening and closing tags of the list */
+#define AUDIT_NOTIFICATION_OVERHEAD 6
+
+static BACNET_AUDIT_NOTIFICATION Audit_Queue[AUDIT_NOTIFICATION_QUEUE_SIZE];
+/* encoded length of each queued notification */
+static uint16_t Audit_Queue_Len[AUDIT_NOTIFICATION_QUEUE_SIZE];
+static unsigned Audit_Queue_Count;
+/* encoded length of all of the queued notifications */
+static size_t Audit_Queue_Bytes;
+/* time that the oldest queued notification has waited */
+static uint16_t Audit_Queue_Elapsed;
+static unsigned Audit_Batch_Count = AUDIT_NOTIFICATION_QUEUE_SIZE;
+static uint16_t Audit_Batch_Milliseconds = AUDIT_NOTIFICATION_BATCH_MS;
+static BACNET_RECIPIENT Audit_Recipient;
+static bool Audit_Recipient_Valid;
+static bool Audit_Confirmed;
+
+/**
+ * @brief Set the Audit Log device that is sent the notifications
+ * @param recipient - device or address of the recipient, or NULL to stop
+ *  sending.  Notifications stay queued while there is no recipient.
+ * @param confirmed - true to send ConfirmedAuditNotification requests,
+ *  false to send UnconfirmedAuditNotification requests
+ */
+void Send_Audit_Notification_Recipient_Set(
+    const BACNET_RECIPIENT *recipient, bool confirmed)
+{
+    if (recipient) {
+        Audit_Recipient = *recipient;
+        Audit_Recipient_Valid = true;
+    } else {
+        Audit_Recipient_Valid = false;
+    }
+    Audit_Confirmed = confirmed;
+}
+
+/**
+ * @brief Set the thresholds that send the queued notifications
+ * @param count - number of notifications sent in one request, limited to
+ *  the queue size.  A count of 0 or 1 sends each notification when it
+ *  is queued.
+ * @param milliseconds - longest time a notification waits for the batch
+ */
+void Send_Audit_Notification_Batch_Set(
+    unsigned count, uint16_t milliseconds)
+{
+    if (count == 0) {
+        count = 1;
+    } else if (count > AUDIT_NOTIFICATION_QUEUE_SIZE) {
+        count = AUDIT_NOTIFICATION_QUEUE_SIZE;
+    }
+    Audit_Batch_Count = count;
+    Audit_Batch_Milliseconds = milliseconds;
+}
+
+/**
+ * @brief Get the number of notifications waiting to be sent
+ * @return number of queued notifications
+ */
+unsigned Send_Audit_Notification_Queue_Count(void)
+{
+    return Audit_Queue_Count;
+}
+
+/**
+ * @brief Get the address of the recipient, binding to it if needed
+ * @param dest - address of the recipient
+ * @param max_apdu - largest APDU the recipient accepts
+ * @return true if the recipient address is known
+ */
+static bool audit_notification_destination(
+    BACNET_ADDRESS *dest, unsigned *max_apdu)
+{
+    bool status = false;
+
+    if (!Audit_Recipient_Valid) {
+        return false;
+    }
+    if (Audit_Recipient.tag == BACNET_RECIPIENT_TAG_DEVICE) {
+        status = address_bind_request(
+            Audit_Recipient.type.device.instance, max_apdu, dest);
+    } else if (Audit_Recipient.tag == BACNET_RECIPIENT_TAG_ADDRESS) {
+        bacnet_address_copy(dest, &Audit_Recipient.type.address);
+        *max_apdu = MAX_APDU;
+        status = true;
+    }
+    if (*max_apdu > MAX_APDU) {
+        *max_apdu = MAX_APDU;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Send the first notifications of the queue in one request
+ * @param dest - address of the recipient
+ * @param count - number of notifications to send
+ * @return true if the request was sent, false if it should be retried
+ */
+static bool audit_notification_send(BACNET_ADDRESS *dest, unsigned count)
+{
+    uint8_t *pdu = &Handler_Transmit_Buffer[0];
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    uint8_t invoke_id = 0;
+    int pdu_len = 0;
+    int bytes_sent = 0;
+
+    if (!dcc_communication_enabled()) {
+        return false;
+    }
+    if (Audit_Confirmed) {
+        invoke_id = tsm_next_free_invokeID();
+        if (!invoke_id) {
+            return false;
+        }
+    }
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, Audit_Confirmed, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(pdu, dest, &my_address, &npdu_data);
+    if (Audit_Confirmed) {
+        pdu_len += bacnet_audit_notification_confirmed_encode_apdu(
+            &pdu[pdu_len], invoke_id, Audit_Queue, count);
+        tsm_set_confirmed_unsegmented_transaction(
+            invoke_id, dest, &npdu_data, pdu, (uint16_t)pdu_len);
+    } else {
+        pdu_len += bacnet_audit_notification_unconfirmed_encode_apdu(
+            &pdu[pdu_len], Audit_Queue, count);
+    }
+    bytes_sent = datalink_send_pdu(dest, &npdu_data, pdu, pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("Failed to Send AuditNotification Request");
+    }
+
+    return true;
+}
+
+/**
+ * @brief Remove the first notifications from the queue
+ * @param count - number of notifications to remove
+ */
+static void audit_notification_remove(unsigned count)
+{
+    unsigned index;
+
+    for (index = 0; index < count; index++) {
+        Audit_Queue_Bytes -= Audit_Queue_Len[index];
+    }
+    Audit_Queue_Count -= count;
+    for (index = 0; index < Audit_Queue_Count; index++) {
+        Audit_Queue[index] = Audit_Queue[index + count];
+        Audit_Queue_Len[index] = Audit_Queue_Len[index + count];
+    }
+    Audit_Queue_Elapsed = 0;
+}
+
+/**
+ * @brief Send the queued notifications, packing as many into each
+ *  request as fit the APDU of the recipient
+ * @return true if the queue is empty
+ */
+bool Send_Audit_Notification_Flush(void)
+{
+    BACNET_ADDRESS dest = { 0 };
+    unsigned max_apdu = 0;
+    unsigned count;
+    size_t len;
+
+    while (Audit_Queue_Count > 0) {
+        if (!audit_notification_destination(&dest, &max_apdu)) {
+            break;
+        }
+        len = AUDIT_NOTIFICATION_OVERHEAD + Audit_Queue_Len[0];
+        if (len > max_apdu) {
+            debug_fprintf(
+                stderr,
+                "Failed to Send AuditNotification Request "
+                "(exceeds destination maximum APDU)!\n");
+            audit_notification_remove(1);
+            continue;
+        }
+        for (count = 1; count < Audit_Queue_Count; count++) {
+            if ((len + Audit_Queue_Len[count]) > max_apdu) {
+                break;
+            }
+            len += Audit_Queue_Len[count];
+        }
+        if (!audit_notification_send(&dest, count)) {
+            break;
+        }
+        audit_notification_remove(count);
+    }
+
+    return (Audit_Queue_Count == 0);
+}
+
+/**
+ * @brief Queue a notification for the Audit Log device.  The queue is
+ *  sent when it holds the batch count of notifications, or before a
+ *  notification that would not fit in the same APDU.
+ * @param notification - notification to send
+ * @return true if the notification was queued or sent, false if the
+ *  queue is full because the recipient cannot be reached
+ */
+bool Send_Audit_Notification_Queue(
+    const BACNET_AUDIT_NOTIFICATION *notification)
+{
+    int len;
+
+    if (!notification) {
+        return false;
+    }
+    len = bacnet_audit_log_notification_encode(NULL, notification);
+    if ((Audit_Queue_Count > 0) &&
+        ((Audit_Queue_Count >= Audit_Batch_Count) ||
+         ((Audit_Queue_Bytes + len + AUDIT_NOTIFICATION_OVERHEAD) >
+          MAX_APDU))) {
+        (void)Send_Audit_Notification_Flush();
+    }
+    if (Audit_Queue_Count >= AUDIT_NOTIFICATION_QUEUE_SIZE) {
+        return false;
+    }
+    Audit_Queue[Audit_Queue_Count] = *notification;
+    Audit_Queue_Len[Audit_Queue_Count] = (uint16_t)len;
+    Audit_Queue_Count++;
+    Audit_Queue_Bytes += len;
+    if (Audit_Queue_Count >= Audit_Batch_Count) {
+        (void)Send_Audit_Notification_Flush();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send the queued notifications once the oldest one has waited
+ *  for the batch time.  Call this periodically.
+ * @param elapsed_milliseconds - time since the last call
+ */
+void Send_Audit_Notification_Task(uint16_t elapsed_milliseconds)
+{
+    if (Audit_Queue_Count == 0) {
+        return;
+    }
+    if (Audit_Queue_Elapsed < Audit_Batch_Milliseconds) {
+        if ((Audit_Batch_Milliseconds - Audit_Queue_Elapsed) >
+            elapsed_milliseconds) {
+            Audit_Queue_Elapsed += elapsed_milliseconds;
+            return;
+        }
+        Audit_Queue_Elapsed = Audit_Batch_Milliseconds;
+    }
+    (void)Send_Audit_Notification_Flush();
+}
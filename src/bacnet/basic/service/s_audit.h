@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief Header file for a batching AuditNotification service send
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_SERVICE_SEND_AUDIT_NOTIFICATION_H
+#define BACNET_BASIC_SERVICE_SEND_AUDIT_NOTIFICATION_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacaudit.h"
+#include "bacnet/bacdest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void Send_Audit_Notification_Recipient_Set(
+    const BACNET_RECIPIENT *recipient, bool confirmed);
+BACNET_STACK_EXPORT
+void Send_Audit_Notification_Batch_Set(
+    unsigned count, uint16_t milliseconds);
+
+BACNET_STACK_EXPORT
+bool Send_Audit_Notification_Queue(
+    const BACNET_AUDIT_NOTIFICATION *notification);
+BACNET_STACK_EXPORT
+bool Send_Audit_Notification_Flush(void);
+BACNET_STACK_EXPORT
+void Send_Audit_Notification_Task(uint16_t elapsed_milliseconds);
+BACNET_STACK_EXPORT
+unsigned Send_Audit_Notification_Queue_Count(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -83,6 +83,75 @@ uint8_t Send_CEvent_Notify_Address(
     return invoke_id;
 }
 
+/** Sends an Confirmed Alarm/Event Notification from a notification body
+ *  that was encoded once for all recipients.
+ * @ingroup EVNOTFCN
+ *
+ * @param pdu [in] the PDU buffer used for sending the message
+ * @param pdu_size [in] Size of the PDU buffer
+ * @param process_identifier [in] The process-identifier of the recipient.
+ * @param body [in] The notification body from event_notification_body_encode()
+ * @param body_len [in] The number of bytes in the notification body.
+ * @param dest [in] BACNET_ADDRESS of the destination device
+ * @return invoke id of outgoing message, or 0 if communication is disabled,
+ *         or no tsm slot is available.
+ */
+uint8_t Send_CEvent_Notify_Body(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest)
+{
+    int len = 0;
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    uint8_t invoke_id = 0;
+
+    if (!dcc_communication_enabled()) {
+        return 0;
+    }
+    if (!dest) {
+        return 0;
+    }
+    /* is there a tsm available? */
+    invoke_id = tsm_next_free_invokeID();
+    if (invoke_id) {
+        datalink_get_my_address(&my_address);
+        npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+        pdu_len = npdu_encode_pdu(NULL, dest, &my_address, &npdu_data);
+        len = cevent_notify_body_encode_apdu(
+            NULL, invoke_id, process_identifier, body, body_len);
+        if ((pdu_len + len) < pdu_size) {
+            /* encode the NPDU portion of the packet */
+            pdu_len = npdu_encode_pdu(pdu, dest, &my_address, &npdu_data);
+            /* encode the APDU portion of the packet */
+            len = cevent_notify_body_encode_apdu(
+                &pdu[pdu_len], invoke_id, process_identifier, body, body_len);
+            pdu_len += len;
+            tsm_set_confirmed_unsegmented_transaction(
+                invoke_id, dest, &npdu_data, pdu, (uint16_t)pdu_len);
+            bytes_sent = datalink_send_pdu(dest, &npdu_data, pdu, pdu_len);
+            if (bytes_sent <= 0) {
+                debug_perror(
+                    "Failed to Send ConfirmedEventNotification Request");
+            }
+        } else {
+            tsm_free_invoke_id(invoke_id);
+            invoke_id = 0;
+            debug_fprintf(
+                stderr,
+                "Failed to Send ConfirmedEventNotification Request "
+                "(exceeds destination maximum APDU)!\n");
+        }
+    }
+
+    return invoke_id;
+}
+
 /** Sends an Confirmed Alarm/Event Notification.
  * @ingroup EVNOTFCN
  *
@@ -35,6 +35,14 @@ uint8_t Send_CEvent_Notify_Address(
     uint16_t pdu_size,
     const BACNET_EVENT_NOTIFICATION_DATA *data,
     BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+uint8_t Send_CEvent_Notify_Body(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest);
 
 #ifdef __cplusplus
 }
@@ -84,8 +84,9 @@ int iam_encode_pdu(
 
     /* encode the APDU portion of the packet */
     len = iam_encode_apdu(
-        &buffer[pdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+        &buffer[pdu_len], Device_Object_Instance_Number(),
+        apdu_max_length_accepted(), SEGMENTATION_NONE,
+        Device_Vendor_Identifier());
     pdu_len += len;
 
     return pdu_len;
@@ -157,8 +158,9 @@ int iam_unicast_encode_pdu(
     npdu_len = npdu_encode_pdu(&buffer[0], dest, &my_address, npdu_data);
     /* encode the APDU portion of the packet */
     apdu_len = iam_encode_apdu(
-        &buffer[npdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+        &buffer[npdu_len], Device_Object_Instance_Number(),
+        apdu_max_length_accepted(), SEGMENTATION_NONE,
+        Device_Vendor_Identifier());
     pdu_len = npdu_len + apdu_len;
 
     return pdu_len;
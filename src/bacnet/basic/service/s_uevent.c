@@ -47,3 +47,53 @@ int Send_UEvent_Notify(
 
     return bytes_sent;
 }
+
+/**
+ * @brief Sends an Unconfirmed Alarm/Event Notification from a notification
+ *  body that was encoded once for all recipients.
+ * @ingroup BIBB-AE-N-A
+ * @param buffer [in,out] The buffer to build the message in for sending.
+ * @param buffer_size [in] The size of the buffer.
+ * @param process_identifier [in] The process-identifier of the recipient.
+ * @param body [in] The notification body from event_notification_body_encode()
+ * @param body_len [in] The number of bytes in the notification body.
+ * @param dest [in] The destination address information (may be a broadcast).
+ * @return Size of the message sent (bytes), or a negative value on error.
+ */
+int Send_UEvent_Notify_Body(
+    uint8_t *buffer,
+    size_t buffer_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest)
+{
+    int len = 0;
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+
+    datalink_get_my_address(&my_address);
+    /* encode the NPDU portion of the packet */
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(NULL, dest, &my_address, &npdu_data);
+    len = uevent_notify_body_encode_apdu(
+        NULL, process_identifier, body, body_len);
+    if ((size_t)(pdu_len + len) > buffer_size) {
+        debug_perror("EventNotification Request exceeds the buffer");
+        return -1;
+    }
+    pdu_len = npdu_encode_pdu(buffer, dest, &my_address, &npdu_data);
+    /* encode the APDU portion of the packet */
+    len = uevent_notify_body_encode_apdu(
+        &buffer[pdu_len], process_identifier, body, body_len);
+    pdu_len += len;
+    /* send the data */
+    bytes_sent = datalink_send_pdu(dest, &npdu_data, &buffer[0], pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("Failed to Send EventNotification Request");
+    }
+
+    return bytes_sent;
+}
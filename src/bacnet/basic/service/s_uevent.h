@@ -30,6 +30,14 @@ int Send_UEvent_Notify(
     uint8_t *buffer,
     const BACNET_EVENT_NOTIFICATION_DATA *data,
     BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+int Send_UEvent_Notify_Body(
+    uint8_t *buffer,
+    size_t buffer_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest);
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,7 @@
 #include "bacnet/basic/service/h_apdu.h"
 #include "bacnet/basic/service/h_arf.h"
 #include "bacnet/basic/service/h_arf_a.h"
+#include "bacnet/basic/service/h_audit.h"
 #include "bacnet/basic/service/h_awf.h"
 #include "bacnet/basic/service/h_ccov.h"
 #include "bacnet/basic/service/h_cov.h"
@@ -60,6 +61,7 @@
 #include "bacnet/basic/service/s_abort.h"
 #include "bacnet/basic/service/s_ack_alarm.h"
 #include "bacnet/basic/service/s_arfs.h"
+#include "bacnet/basic/service/s_audit.h"
 #include "bacnet/basic/service/s_awfs.h"
 #include "bacnet/basic/service/s_cevent.h"
 #include "bacnet/basic/service/s_cov.h"
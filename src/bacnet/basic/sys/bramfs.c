@@ -15,14 +15,30 @@
 #include "bacnet/bacdef.h"
 #include "bacnet/basic/sys/keylist.h"
 #include "bacnet/basic/object/bacfile.h"
+#include "bacnet/basic/sys/bramfs.h"
 #include "bacnet/datalink/cobs.h"
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist File_List;
 
+/* The data of a file is stored in fixed size extents, so that a write
+   beyond the end of the file adds extents rather than reallocating and
+   copying the whole file.  The records are null-terminated strings, and
+   the offset of each record is kept in an index, so that a record is
+   read or appended without scanning the file.  A stream write may change
+   any record, so it marks the index to be rebuilt by the next record
+   access. */
 struct file_data {
     size_t size; /* size of the file in bytes */
-    char *data; /* data buffer */
+    char **extent; /* data extents of BRAMFS_EXTENT_SIZE bytes */
+    size_t extent_count; /* number of allocated extents */
+    size_t extent_capacity; /* size of the extent pointer array */
+    char *data; /* contiguous copy of the data, or NULL if not made */
+    size_t *record_offset; /* offset of each record */
+    size_t record_count; /* number of records in the index */
+    size_t record_capacity; /* size of the record offset array */
+    size_t records_end; /* offset after the null of the last record */
+    bool record_index_valid; /* true if the index matches the data */
 };
 #define CRC32K_INITIAL_VALUE (0xFFFFFFFF)
 
@@ -64,7 +80,7 @@ static struct file_data *bacfile_ramfs_open(const char *pathname)
         pFile = calloc(1, sizeof(struct file_data));
         if (pFile) {
             pFile->size = 0;
-            pFile->data = NULL;
+            pFile->record_index_valid = true;
             index = Keylist_Data_Add(File_List, crc32K, pFile);
             if (index < 0) {
                 free(pFile);
@@ -77,21 +93,256 @@ static struct file_data *bacfile_ramfs_open(const char *pathname)
 }
 
 /**
- * @brief Determines the file size for a given file
- * @param  pathname - name of the file to get the size for
- * @return  file size in bytes, or 0 if not found
+ * @brief Mark the file data as changed, so that the contiguous copy and
+ *  the record index are made again when they are next used
+ * @param pFile - file to change
+ */
+static void file_data_changed(struct file_data *pFile)
+{
+    free(pFile->data);
+    pFile->data = NULL;
+    pFile->record_index_valid = false;
+}
+
+/**
+ * @brief Allocate the extents to hold a file of a given size.  The new
+ *  extents are zeroed.
+ * @param pFile - file to grow
+ * @param size - number of bytes the extents shall hold
+ * @return true if the extents were allocated
+ */
+static bool file_extents_reserve(struct file_data *pFile, size_t size)
+{
+    size_t count = (size + BRAMFS_EXTENT_SIZE - 1) / BRAMFS_EXTENT_SIZE;
+    size_t capacity;
+    char **extent;
+
+    if (count > pFile->extent_capacity) {
+        capacity = pFile->extent_capacity ? pFile->extent_capacity : 4;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        extent = realloc(pFile->extent, capacity * sizeof(char *));
+        if (!extent) {
+            return false;
+        }
+        pFile->extent = extent;
+        pFile->extent_capacity = capacity;
+    }
+    while (pFile->extent_count < count) {
+        pFile->extent[pFile->extent_count] = calloc(1, BRAMFS_EXTENT_SIZE);
+        if (!pFile->extent[pFile->extent_count]) {
+            return false;
+        }
+        pFile->extent_count++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Set the size of a file, freeing the extents beyond it.  The data
+ *  between the old and the new size of a larger file are zeroed.
+ * @param pFile - file to resize
+ * @param size - new size of the file in bytes
+ * @return true if the file was resized
+ */
+static bool file_resize(struct file_data *pFile, size_t size)
+{
+    size_t count = (size + BRAMFS_EXTENT_SIZE - 1) / BRAMFS_EXTENT_SIZE;
+    size_t offset, len;
+
+    if (!file_extents_reserve(pFile, size)) {
+        return false;
+    }
+    /* zero the rest of the last extent that is kept */
+    offset = size % BRAMFS_EXTENT_SIZE;
+    if ((size < pFile->size) && (offset > 0)) {
+        len = min(BRAMFS_EXTENT_SIZE - offset, pFile->size - size);
+        memset(&pFile->extent[count - 1][offset], 0, len);
+    }
+    while (pFile->extent_count > count) {
+        pFile->extent_count--;
+        free(pFile->extent[pFile->extent_count]);
+        pFile->extent[pFile->extent_count] = NULL;
+    }
+    pFile->size = size;
+
+    return true;
+}
+
+/**
+ * @brief Copy data out of the extents of a file
+ * @param pFile - file to read from
+ * @param offset - offset in the file, where offset + len <= file size
+ * @param buffer - buffer to copy the data into
+ * @param len - number of bytes to copy
+ */
+static void file_read(
+    const struct file_data *pFile, size_t offset, void *buffer, size_t len)
+{
+    uint8_t *data = buffer;
+    size_t index, chunk;
+
+    while (len > 0) {
+        index = offset % BRAMFS_EXTENT_SIZE;
+        chunk = min(len, BRAMFS_EXTENT_SIZE - index);
+        memcpy(data, &pFile->extent[offset / BRAMFS_EXTENT_SIZE][index], chunk);
+        data += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+}
+
+/**
+ * @brief Copy data into the extents of a file, growing the file if the
+ *  data ends beyond it
+ * @param pFile - file to write to
+ * @param offset - offset in the file, which may be beyond its end
+ * @param buffer - data to copy
+ * @param len - number of bytes to copy
+ * @return true if the data was written
+ */
+static bool file_write(
+    struct file_data *pFile, size_t offset, const void *buffer, size_t len)
+{
+    const uint8_t *data = buffer;
+    size_t index, chunk;
+
+    if ((offset + len) > pFile->size) {
+        if (!file_resize(pFile, offset + len)) {
+            return false;
+        }
+    }
+    while (len > 0) {
+        index = offset % BRAMFS_EXTENT_SIZE;
+        chunk = min(len, BRAMFS_EXTENT_SIZE - index);
+        memcpy(&pFile->extent[offset / BRAMFS_EXTENT_SIZE][index], data, chunk);
+        data += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the byte at an offset of a file
+ * @param pFile - file to read from
+ * @param offset - offset in the file, which is less than the file size
+ * @return the byte at the offset
+ */
+static char file_byte(const struct file_data *pFile, size_t offset)
+{
+    return pFile->extent[offset / BRAMFS_EXTENT_SIZE]
+                        [offset % BRAMFS_EXTENT_SIZE];
+}
+
+/**
+ * @brief Add a record offset to the end of the record index
+ * @param pFile - file of the index
+ * @param offset - offset of the record in the file
+ * @return true if the offset was added
+ */
+static bool record_index_add(struct file_data *pFile, size_t offset)
+{
+    size_t capacity;
+    size_t *record_offset;
+
+    if (pFile->record_count >= pFile->record_capacity) {
+        capacity = pFile->record_capacity ? pFile->record_capacity * 2 : 16;
+        record_offset =
+            realloc(pFile->record_offset, capacity * sizeof(size_t));
+        if (!record_offset) {
+            return false;
+        }
+        pFile->record_offset = record_offset;
+        pFile->record_capacity = capacity;
+    }
+    pFile->record_offset[pFile->record_count] = offset;
+    pFile->record_count++;
+
+    return true;
+}
+
+/**
+ * @brief Build the record index of a file, if the data changed since it
+ *  was built.  The records are null-terminated strings that end at the
+ *  first empty string, or at the end of the file.
+ * @param pFile - file to index
+ * @return true if the record index is valid
+ */
+static bool record_index_update(struct file_data *pFile)
+{
+    size_t offset = 0;
+    size_t len;
+
+    if (pFile->record_index_valid) {
+        return true;
+    }
+    pFile->record_count = 0;
+    while (offset < pFile->size) {
+        len = 0;
+        while ((len < MAX_OCTET_STRING_BYTES) &&
+               ((offset + len) < pFile->size) &&
+               (file_byte(pFile, offset + len) != 0)) {
+            len++;
+        }
+        if (len == 0) {
+            break;
+        }
+        if (!record_index_add(pFile, offset)) {
+            return false;
+        }
+        offset += len + 1;
+    }
+    pFile->records_end = min(offset, pFile->size);
+    pFile->record_index_valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Get the length of an indexed record
+ * @param pFile - file of the index
+ * @param index - record index number 0..N-1
+ * @return length of the record, not counting its null-terminator
+ */
+static size_t record_length(const struct file_data *pFile, size_t index)
+{
+    size_t end;
+
+    if ((index + 1) < pFile->record_count) {
+        end = pFile->record_offset[index + 1];
+    } else {
+        end = pFile->records_end;
+    }
+
+    return end - pFile->record_offset[index] - 1;
+}
+
+/**
+ * @brief Gets the file data as one contiguous buffer, which stays valid
+ *  until the file is next written
+ * @param  pathname - name of the file to get the data for
+ * @return  file data, or NULL if the file is empty or not found
  */
 const char *bacfile_ramfs_file_data(const char *pathname)
 {
     struct file_data *pFile;
-    const char *file_data = NULL;
 
     pFile = bacfile_ramfs_open(pathname);
-    if (pFile) {
-        file_data = pFile->data;
+    if (!pFile || (pFile->size == 0)) {
+        return NULL;
+    }
+    if (!pFile->data) {
+        pFile->data = malloc(pFile->size);
+        if (pFile->data) {
+            file_read(pFile, 0, pFile->data, pFile->size);
+        }
     }
 
-    return file_data;
+    return pFile->data;
 }
 
 /**
@@ -121,26 +372,12 @@ size_t bacfile_ramfs_file_size(const char *pathname)
 bool bacfile_ramfs_file_size_set(const char *pathname, size_t new_size)
 {
     struct file_data *pFile;
-    char *new_data;
-
     bool status = false;
 
     pFile = bacfile_ramfs_open(pathname);
     if (pFile) {
-        if (new_size > 0) {
-            new_data = realloc(pFile->data, new_size);
-            if (new_data) {
-                pFile->data = new_data;
-                pFile->size = new_size;
-                status = true;
-            }
-        } else {
-            /* free the data */
-            free(pFile->data);
-            pFile->data = NULL;
-            pFile->size = 0;
-            status = true;
-        }
+        file_data_changed(pFile);
+        status = file_resize(pFile, new_size);
     }
 
     return status;
@@ -164,14 +401,15 @@ size_t bacfile_ramfs_read_stream_data(
     size_t len = 0;
 
     pFile = bacfile_ramfs_open(pathname);
-    if (pFile) {
+    if (pFile && (fileStartPosition >= 0) &&
+        ((size_t)fileStartPosition < pFile->size)) {
         if (fileStartPosition + fileDataLen > pFile->size) {
             /* read only up to the end of the file */
             len = pFile->size - fileStartPosition;
         } else {
             len = fileDataLen;
         }
-        memcpy(fileData, pFile->data + fileStartPosition, len);
+        file_read(pFile, fileStartPosition, fileData, len);
     }
 
     return len;
@@ -193,49 +431,28 @@ size_t bacfile_ramfs_write_stream_data(
 {
     size_t bytes_written = 0;
     struct file_data *pFile;
-    size_t old_size;
-    char *new_data = NULL;
+    size_t offset;
 
     pFile = bacfile_ramfs_open(pathname);
-    if (pFile) {
+    if (pFile && (fileStartPosition >= -1)) {
+        file_data_changed(pFile);
         if (fileStartPosition == 0) {
             /* open the file as a clean slate when starting at 0 */
-            new_data = realloc(pFile->data, fileDataLen);
-            if (new_data) {
-                pFile->data = new_data;
-                memcpy(pFile->data, fileData, fileDataLen);
-                pFile->size = fileDataLen;
-                bytes_written = fileDataLen;
+            if (!file_resize(pFile, 0)) {
+                return 0;
             }
+            offset = 0;
         } else if (fileStartPosition == -1) {
             /* If 'File Start Position' parameter has the special
                value -1, then the write operation shall be treated
                as an append to the current end of file. */
-            old_size = pFile->size;
-            pFile->size += fileDataLen;
-            new_data = realloc(pFile->data, pFile->size);
-            if (new_data) {
-                pFile->data = new_data;
-                memcpy(pFile->data + old_size, fileData, fileDataLen);
-                bytes_written = fileDataLen;
-            }
+            offset = pFile->size;
         } else {
             /* open for update */
-            if (fileStartPosition + fileDataLen > pFile->size) {
-                /* extend the file size */
-                new_data =
-                    realloc(pFile->data, fileStartPosition + fileDataLen);
-                if (new_data) {
-                    pFile->data = new_data;
-                    pFile->size = fileStartPosition + fileDataLen;
-                    memcpy(
-                        pFile->data + fileStartPosition, fileData, fileDataLen);
-                    bytes_written = fileDataLen;
-                }
-            } else {
-                memcpy(pFile->data + fileStartPosition, fileData, fileDataLen);
-                bytes_written = fileDataLen;
-            }
+            offset = fileStartPosition;
+        }
+        if (file_write(pFile, offset, fileData, fileDataLen)) {
+            bytes_written = fileDataLen;
         }
     }
 
@@ -243,53 +460,51 @@ size_t bacfile_ramfs_write_stream_data(
 }
 
 /**
- * @brief Count the number of records in a file
- * @param records - string of null-terminated records
- * @return number of records
+ * @brief Replace an indexed record with one of another length, moving
+ *  the data after it
+ * @param pFile - file of the record
+ * @param index - record index number 0..N-1
+ * @param record - new record data, null-terminated
+ * @param record_len - length of the new record
+ * @return true if the record was replaced
  */
-static size_t record_count(const char *records)
+static bool record_replace(
+    struct file_data *pFile,
+    size_t index,
+    const char *record,
+    size_t record_len)
 {
-    size_t count = 0;
-    int len = 0;
-
-    if (records) {
-        do {
-            len = bacnet_strnlen(records, MAX_OCTET_STRING_BYTES);
-            if (len > 0) {
-                count++;
-                records = records + len + 1;
-            }
-        } while (len > 0);
+    size_t offset = pFile->record_offset[index];
+    size_t old_len = record_length(pFile, index);
+    size_t tail_offset = offset + old_len + 1;
+    size_t tail_len = pFile->size - tail_offset;
+    size_t new_size = pFile->size - old_len + record_len;
+    char *tail = NULL;
+    size_t i;
+
+    if (tail_len > 0) {
+        tail = malloc(tail_len);
+        if (!tail) {
+            return false; /* out of memory */
+        }
+        file_read(pFile, tail_offset, tail, tail_len);
     }
-
-    return count;
-}
-
-/**
- * @brief Get the specific record at index 0..N
- * @param records - string of null-terminated records
- * @param record_index - record index number 0..N of the records
- * @return record, or NULL
- */
-static char *record_by_index(char *records, size_t index)
-{
-    size_t count = 0;
-    int len = 0;
-
-    if (records) {
-        do {
-            len = bacnet_strnlen(records, MAX_OCTET_STRING_BYTES);
-            if (len > 0) {
-                if (index == count) {
-                    return records;
-                }
-                count++;
-                records = records + len + 1;
-            }
-        } while (len > 0);
+    if (!file_resize(pFile, max(pFile->size, new_size)) ||
+        !file_write(pFile, offset, record, record_len + 1) ||
+        !file_write(pFile, offset + record_len + 1, tail, tail_len) ||
+        !file_resize(pFile, new_size)) {
+        free(tail);
+        return false;
+    }
+    free(tail);
+    /* the records after the replaced record moved */
+    for (i = index + 1; i < pFile->record_count; i++) {
+        pFile->record_offset[i] =
+            pFile->record_offset[i] + record_len - old_len;
     }
+    pFile->records_end = pFile->records_end + record_len - old_len;
 
-    return NULL;
+    return true;
 }
 
 /**
@@ -312,17 +527,15 @@ bool bacfile_ramfs_write_record_data(
     size_t fileSeekRecord;
     size_t fileRecordCount;
     struct file_data *pFile;
-    char *record;
-    size_t record_len;
-    size_t tail_record_len;
+    size_t offset;
     char fileDataStr[MAX_OCTET_STRING_BYTES + 1] = {
         0
     }; /* +1 for null terminator */
     size_t fileDataStrLen = 0;
 
     pFile = bacfile_ramfs_open(pathname);
-    if (pFile) {
-        fileRecordCount = record_count(pFile->data);
+    if (pFile && record_index_update(pFile)) {
+        fileRecordCount = pFile->record_count;
         if (fileStartRecord == -1) {
             /* If 'File Start Record' parameter has the special
                value -1, then the write operation shall be treated
@@ -340,43 +553,36 @@ bool bacfile_ramfs_write_record_data(
         fileDataStrLen = min(fileDataLen, MAX_OCTET_STRING_BYTES);
         memcpy(fileDataStr, fileData, fileDataStrLen);
         fileDataStr[fileDataStrLen] = 0; /* null-terminate */
+        fileDataStrLen = strlen(fileDataStr);
         if (fileDataStrLen == 0) {
             return false; /* nothing to write */
         }
+        free(pFile->data);
+        pFile->data = NULL;
         if (fileSeekRecord < fileRecordCount) {
-            /* find the old record length */
-            record = record_by_index(pFile->data, fileSeekRecord);
-            record_len = bacnet_strnlen(record, MAX_OCTET_STRING_BYTES);
-            tail_record_len = pFile->size - (record - pFile->data) - record_len;
-            /* reallocate file to make room for new record */
-            record = realloc(
-                pFile->data, pFile->size - record_len + fileDataStrLen + 1);
-            if (!record) {
-                return false; /* out of memory */
-            }
-            pFile->data = record;
-            /* find the old record position after a realloc */
-            record = record_by_index(pFile->data, fileSeekRecord);
-            /* move all existing records after the inserted record */
-            if (tail_record_len > 0) {
-                memmove(
-                    record + fileDataStrLen, record + record_len,
-                    tail_record_len);
+            if (record_length(pFile, fileSeekRecord) == fileDataStrLen) {
+                /* overwrite the record in place */
+                status = file_write(
+                    pFile, pFile->record_offset[fileSeekRecord], fileDataStr,
+                    fileDataStrLen);
+            } else {
+                status = record_replace(
+                    pFile, fileSeekRecord, fileDataStr, fileDataStrLen);
             }
         } else {
             /* extend the file by this one record */
-            record = realloc(pFile->data, pFile->size + fileDataStrLen + 1);
-            if (!record) {
-                return false; /* out of memory */
+            offset = pFile->size;
+            status = file_write(pFile, offset, fileDataStr, fileDataStrLen + 1);
+            if (status) {
+                if ((pFile->records_end == offset) &&
+                    record_index_add(pFile, offset)) {
+                    pFile->records_end = pFile->size;
+                } else {
+                    /* the record follows data that are not records */
+                    pFile->record_index_valid = false;
+                }
             }
-            pFile->data = record;
-            record = pFile->data + pFile->size;
-            pFile->size += fileDataStrLen + 1; /* +1 for the null terminator */
         }
-        /* copy new record data into file */
-        memmove(record, fileDataStr, fileDataStrLen);
-        record[fileDataStrLen] = 0; /* null-terminate */
-        status = true;
     }
 
     return status;
@@ -401,19 +607,19 @@ bool bacfile_ramfs_read_record_data(
     bool status = false;
     size_t fileSeekRecord;
     struct file_data *pFile;
-    char *record;
     size_t record_len;
 
     pFile = bacfile_ramfs_open(pathname);
-    if (pFile) {
+    if (pFile && (fileStartRecord >= 0) && record_index_update(pFile)) {
         fileSeekRecord = fileStartRecord + fileIndexRecord;
         /* seek to the start record */
-        record = record_by_index(pFile->data, fileSeekRecord);
-        if (record) {
-            record_len = bacnet_strnlen(record, MAX_OCTET_STRING_BYTES);
+        if (fileSeekRecord < pFile->record_count) {
+            record_len = record_length(pFile, fileSeekRecord);
             if ((record_len > 0) && (record_len <= fileDataLen)) {
                 /* copy the record data */
-                memcpy(fileData, record, record_len);
+                file_read(
+                    pFile, pFile->record_offset[fileSeekRecord], fileData,
+                    record_len);
                 status = true;
             }
         }
@@ -422,6 +628,24 @@ bool bacfile_ramfs_read_record_data(
     return status;
 }
 
+/**
+ * @brief Get the number of records in a file
+ * @param pathname - name of the file
+ * @return number of records, which end at the first empty record
+ */
+size_t bacfile_ramfs_record_count(const char *pathname)
+{
+    struct file_data *pFile;
+    size_t count = 0;
+
+    pFile = bacfile_ramfs_open(pathname);
+    if (pFile && record_index_update(pFile)) {
+        count = pFile->record_count;
+    }
+
+    return count;
+}
+
 /**
  * @brief Deletes the files and their data
  */
@@ -433,6 +657,10 @@ void bacfile_ramfs_deinit(void)
         do {
             pFile = Keylist_Data_Pop(File_List);
             if (pFile) {
+                (void)file_resize(pFile, 0);
+                free(pFile->extent);
+                free(pFile->data);
+                free(pFile->record_offset);
                 free(pFile);
             }
         } while (pFile);
@@ -10,6 +10,11 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 
+/* size of the extents that hold the data of a file */
+#ifndef BRAMFS_EXTENT_SIZE
+#define BRAMFS_EXTENT_SIZE 512
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -46,6 +51,8 @@ bool bacfile_ramfs_read_record_data(
     size_t fileIndexRecord,
     uint8_t *fileData,
     size_t fileDataLen);
+BACNET_STACK_EXPORT
+size_t bacfile_ramfs_record_count(const char *pathname);
 
 BACNET_STACK_EXPORT
 void bacfile_ramfs_deinit(void);
@@ -180,6 +180,7 @@ bool datetime_dst_ordinal_range_set(
     DST_Range.End_Month = end_month;
     DST_Range.End_Week = end_week;
     DST_Range.End_Day = end_day;
+    dst_changed(&DST_Range);
 
     return true;
 }
@@ -219,6 +220,7 @@ bool datetime_dst_date_range_set(
     DST_Range.Begin_Day = start_day;
     DST_Range.End_Month = end_month;
     DST_Range.End_Day = end_day;
+    dst_changed(&DST_Range);
 
     return true;
 }
@@ -11,6 +11,70 @@
 #include <stdbool.h>
 #include "bacnet/basic/sys/days.h"
 
+/* days in a 400 year era of the Gregorian calendar */
+#define DAYS_PER_ERA 146097L
+
+/**
+ * Converts a date into days since March 1, year 0, without looping over
+ * the years or months.  Counting the years from March places the leap day
+ * at the end of the year, so the days before each month follow a line.
+ *
+ * @param year - years after Christ birth (0..9999 AD)
+ * @param month - months (1=Jan...12=Dec)
+ * @param day - day of month (1-31)
+ * @return number of days since March 1, year 0
+ */
+static int32_t days_from_civil(int32_t year, uint8_t month, uint8_t day)
+{
+    int32_t era, year_of_era, day_of_year, day_of_era;
+
+    if (month <= 2) {
+        year--;
+    }
+    era = (year >= 0 ? year : year - 399) / 400;
+    year_of_era = year - era * 400;
+    day_of_year =
+        (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 +
+        day_of_year;
+
+    return era * DAYS_PER_ERA + day_of_era;
+}
+
+/**
+ * Converts days since March 1, year 0 into a date, without looping over
+ * the years or months.
+ *
+ * @param days - number of days since March 1, year 0
+ * @param pYear - years after Christ birth (0..9999 AD)
+ * @param pMonth - months (1=Jan...12=Dec)
+ * @param pDay - day of month (1-31)
+ */
+static void
+days_to_civil(int32_t days, uint16_t *pYear, uint8_t *pMonth, uint8_t *pDay)
+{
+    int32_t era, year_of_era, day_of_year, day_of_era, month;
+
+    era = (days >= 0 ? days : days - (DAYS_PER_ERA - 1)) / DAYS_PER_ERA;
+    day_of_era = days - era * DAYS_PER_ERA;
+    year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+                   day_of_era / (DAYS_PER_ERA - 1)) /
+        365;
+    day_of_year =
+        day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    month = (5 * day_of_year + 2) / 153;
+    if (pDay) {
+        *pDay = (uint8_t)(day_of_year - (153 * month + 2) / 5 + 1);
+    }
+    month = month < 10 ? month + 3 : month - 9;
+    if (pMonth) {
+        *pMonth = (uint8_t)month;
+    }
+    if (pYear) {
+        *pYear = (uint16_t)(year_of_era + era * 400 + (month <= 2 ? 1 : 0));
+    }
+}
+
 /**
  * Determines if a year is a leap year using Gregorian algorithm
  *
@@ -76,11 +140,19 @@ uint32_t days_per_year(uint16_t year)
  */
 uint16_t days_of_year(uint16_t year, uint8_t month, uint8_t day)
 {
+    /* days before each month of a common year, and all of the days of
+       the year for months past December */
+    static const uint16_t days_before_month[14] = {
+        0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365
+    };
     uint16_t days = 0; /* return value */
-    uint8_t mm = 0; /* months counter */
 
-    for (mm = 1; mm < month; mm++) {
-        days += days_per_month(year, mm);
+    if (month > 13) {
+        month = 13;
+    }
+    days = days_before_month[month];
+    if ((month > 2) && days_is_leap_year(year)) {
+        days++;
     }
     days += day;
 
@@ -157,25 +229,17 @@ uint32_t days_apart(
     uint32_t days = 0; /* return value */
     uint32_t days1 = 0;
     uint32_t days2 = 0;
-    uint16_t yy = 0; /* year */
 
     if (year2 > year1) {
         days = days_of_year_remaining(year1, month1, day1);
-        for (yy = year1 + 1; yy < year2; yy++) {
-            days += 365;
-            if (days_is_leap_year(yy)) {
-                days++;
-            }
-        }
+        /* the whole years in between */
+        days += (uint32_t)(days_from_civil(year2, 1, 1) -
+                           days_from_civil((int32_t)year1 + 1, 1, 1));
         days += days_of_year(year2, month2, day2);
     } else if (year2 < year1) {
         days = days_of_year_remaining(year2, month2, day2);
-        for (yy = year2 + 1; yy < year1; yy++) {
-            days += 365;
-            if (days_is_leap_year(yy)) {
-                days++;
-            }
-        }
+        days += (uint32_t)(days_from_civil(year1, 1, 1) -
+                           days_from_civil((int32_t)year2 + 1, 1, 1));
         days += days_of_year(year1, month1, day1);
     } else {
         days1 = days_of_year(year1, month1, day1);
@@ -202,26 +266,14 @@ uint32_t
 days_since_epoch(uint16_t epoch_year, uint16_t year, uint8_t month, uint8_t day)
 {
     uint32_t days = 0; /* return value */
-    uint16_t yy = 0; /* year */
-    uint8_t mm = 0; /* months counter */
     uint8_t monthdays = 0; /* days in a month */
 
     /* validate the date conforms to our range */
     monthdays = days_per_month(year, month);
     if ((year >= epoch_year) && (year <= 9999) && (monthdays > 0) &&
         (day >= 1) && (day <= monthdays)) {
-        for (yy = epoch_year; yy < year; yy++) {
-            days += 365;
-            if (days_is_leap_year(yy)) {
-                days++;
-            }
-        }
-        for (mm = 1; mm < month; mm++) {
-            days += days_per_month(year, mm);
-        }
-        days += day;
-        /* 'days since' is one less */
-        days -= 1;
+        days = (uint32_t)(days_from_civil(year, month, day) -
+                          days_from_civil(epoch_year, 1, 1));
     }
 
     return (days);
@@ -243,30 +295,14 @@ void days_since_epoch_to_date(
     uint8_t *pMonth,
     uint8_t *pDay)
 {
-    uint8_t month = 1;
-    uint8_t day = 1;
-    uint16_t year;
+    int32_t epoch_days;
 
-    year = epoch_year;
-    while (days >= days_per_year(year)) {
-        days -= days_per_year(year);
-        year++;
-    }
-    while (days >= days_per_month(year, month)) {
-        days -= days_per_month(year, month);
-        month++;
-    }
-    day += days;
-    /* load values into the pointers */
-    if (pYear) {
-        *pYear = year;
-    }
-    if (pMonth) {
-        *pMonth = month;
-    }
-    if (pDay) {
-        *pDay = day;
+    epoch_days = days_from_civil(epoch_year, 1, 1);
+    /* keep the sum within range, far past the year 9999 */
+    if (days > (uint32_t)(INT32_MAX - epoch_days)) {
+        days = (uint32_t)(INT32_MAX - epoch_days);
     }
+    days_to_civil(epoch_days + (int32_t)days, pYear, pMonth, pDay);
 
     return;
 }
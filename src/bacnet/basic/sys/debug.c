@@ -13,7 +13,7 @@
 #include <stdlib.h> /* Standard Library */
 #include <errno.h>
 #endif
-#if DEBUG_ENABLED
+#if PRINT_ENABLED || DEBUG_ENABLED
 #include <string.h>
 #include <ctype.h>
 #endif
@@ -21,6 +21,92 @@
 #if DEBUG_PRINTF_WITH_TIMESTAMP
 #include "bacnet/datetime.h"
 #endif
+#if BACNET_DEBUG_ASYNC
+#include "bacnet/basic/sys/debug_async.h"
+#endif
+
+/* level of each category, in BACNET_DEBUG_CATEGORY order */
+static uint8_t Debug_Level[DEBUG_CATEGORY_MAX] = {
+    DEBUG_LEVEL_DEBUG, DEBUG_LEVEL_DEBUG, DEBUG_LEVEL_DEBUG,
+    DEBUG_LEVEL_DEBUG, DEBUG_LEVEL_DEBUG, DEBUG_LEVEL_DEBUG
+};
+
+/**
+ * @brief Set the most verbose level that is printed for a category
+ * @param category - category of the messages
+ * @param level - DEBUG_LEVEL_NONE to print nothing, up to
+ *  DEBUG_LEVEL_DEBUG to print everything
+ */
+void debug_level_set(BACNET_DEBUG_CATEGORY category, BACNET_DEBUG_LEVEL level)
+{
+    if ((category < DEBUG_CATEGORY_MAX) && (level <= DEBUG_LEVEL_DEBUG)) {
+        Debug_Level[category] = (uint8_t)level;
+    }
+}
+
+/**
+ * @brief Get the most verbose level that is printed for a category
+ * @param category - category of the messages
+ * @return the level of the category
+ */
+BACNET_DEBUG_LEVEL debug_level(BACNET_DEBUG_CATEGORY category)
+{
+    if (category < DEBUG_CATEGORY_MAX) {
+        return (BACNET_DEBUG_LEVEL)Debug_Level[category];
+    }
+
+    return DEBUG_LEVEL_NONE;
+}
+
+/**
+ * @brief Determine if a message is printed, before its arguments are
+ *  prepared
+ * @param category - category of the message
+ * @param level - level of the message
+ * @return true if the message is printed
+ */
+bool debug_level_enabled(
+    BACNET_DEBUG_CATEGORY category, BACNET_DEBUG_LEVEL level)
+{
+    return (category < DEBUG_CATEGORY_MAX) && (level != DEBUG_LEVEL_NONE) &&
+        (level <= Debug_Level[category]);
+}
+
+/**
+ * @brief Print to stderr when the level is enabled for the category
+ * @param category - category of the message
+ * @param level - level of the message
+ * @param format - printf format string
+ * @param ... - variable arguments
+ * @note This function is only available if PRINT_ENABLED is non-zero
+ */
+void debug_log(
+    BACNET_DEBUG_CATEGORY category,
+    BACNET_DEBUG_LEVEL level,
+    const char *format,
+    ...)
+{
+#if PRINT_ENABLED
+    va_list ap;
+
+    if (!debug_level_enabled(category, level)) {
+        return;
+    }
+    va_start(ap, format);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf(stderr, format, ap))
+#endif
+    {
+        vfprintf(stderr, format, ap);
+        fflush(stderr);
+    }
+    va_end(ap);
+#else
+    (void)category;
+    (void)level;
+    (void)format;
+#endif
+}
 
 #if DEBUG_PRINTF_WITH_TIMESTAMP
 /**
@@ -65,10 +151,18 @@ void debug_printf(const char *format, ...)
 #if DEBUG_ENABLED
     va_list ap;
 
+    if (!debug_level_enabled(DEBUG_CATEGORY_DEFAULT, DEBUG_LEVEL_DEBUG)) {
+        return;
+    }
     va_start(ap, format);
-    vfprintf(stdout, format, ap);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf(stdout, format, ap))
+#endif
+    {
+        vfprintf(stdout, format, ap);
+        fflush(stdout);
+    }
     va_end(ap);
-    fflush(stdout);
 #else
     (void)format;
 #endif
@@ -103,46 +197,79 @@ void debug_printf_hex(
     ...)
 {
 #if DEBUG_ENABLED
+    va_list ap;
+
+    if (!debug_level_enabled(DEBUG_CATEGORY_DEFAULT, DEBUG_LEVEL_DEBUG)) {
+        return;
+    }
+    va_start(ap, format);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf_hex(
+            stdout, offset, buffer, buffer_length, format, ap))
+#endif
+    {
+        vfprintf(stdout, format, ap);
+        /* print the buffer after the formatted text */
+        debug_hex_dump(stdout, offset, buffer, buffer_length);
+        fflush(stdout);
+    }
+    va_end(ap);
+#else
+    (void)offset;
+    (void)buffer;
+    (void)buffer_length;
+    (void)format;
+#endif
+}
+
+/**
+ * @brief print a HEX dump of a buffer, 16 bytes per line
+ * @param stream - file stream to print to
+ * @param offset - starting address to print to the left side
+ * @param buffer - buffer from which to print hex from
+ * @param length - number of bytes from the buffer to print
+ * @note This function is only available if PRINT_ENABLED or
+ *  DEBUG_ENABLED is non-zero
+ */
+void debug_hex_dump(
+    FILE *stream, uint32_t offset, const uint8_t *buffer, size_t length)
+{
+#if PRINT_ENABLED || DEBUG_ENABLED
     size_t i = 0;
     bool new_line = true;
     char line[16 + 1] = { 0 };
     size_t remainder = 0;
-    va_list ap;
 
-    va_start(ap, format);
-    vfprintf(stdout, format, ap);
-    va_end(ap);
-    /* print the buffer after the formatted text */
-    if (buffer && buffer_length) {
-        for (i = 0; i < buffer_length; i++) {
-            if (new_line) {
-                new_line = false;
-                printf("%08x  ", (unsigned int)(offset + i));
-                memset(line, '.', sizeof(line) - 1);
-            }
-            printf("%02x ", buffer[i]);
-            if (isprint(buffer[i])) {
-                line[i % 16] = buffer[i];
-            }
-            if ((i != 0) && (!((i + 1) % 16))) {
-                printf(" %s\n", line);
-                new_line = true;
-            }
+    if (!buffer || !length) {
+        return;
+    }
+    for (i = 0; i < length; i++) {
+        if (new_line) {
+            new_line = false;
+            fprintf(stream, "%08x  ", (unsigned int)(offset + i));
+            memset(line, '.', sizeof(line) - 1);
         }
-        remainder = buffer_length % 16;
-        if (remainder) {
-            for (i = 0; i < (16 - remainder); i++) {
-                printf("   ");
-            }
-            printf(" %s\n", line);
+        fprintf(stream, "%02x ", buffer[i]);
+        if (isprint(buffer[i])) {
+            line[i % 16] = buffer[i];
+        }
+        if ((i != 0) && (!((i + 1) % 16))) {
+            fprintf(stream, " %s\n", line);
+            new_line = true;
         }
     }
-    fflush(stdout);
+    remainder = length % 16;
+    if (remainder) {
+        for (i = 0; i < (16 - remainder); i++) {
+            fprintf(stream, "   ");
+        }
+        fprintf(stream, " %s\n", line);
+    }
 #else
+    (void)stream;
     (void)offset;
     (void)buffer;
-    (void)buffer_length;
-    (void)format;
+    (void)length;
 #endif
 }
 
@@ -152,7 +279,8 @@ void debug_printf_hex(
  * @param ... - variable arguments
  * @note This function is only available if
  * PRINT_ENABLED is non-zero
- * @return number of characters printed
+ * @return number of characters printed, or zero if the message is
+ *  recorded to be printed later
  */
 int debug_printf_stdout(const char *format, ...)
 {
@@ -161,9 +289,14 @@ int debug_printf_stdout(const char *format, ...)
     va_list ap;
 
     va_start(ap, format);
-    length = vfprintf(stdout, format, ap);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf(stdout, format, ap))
+#endif
+    {
+        length = vfprintf(stdout, format, ap);
+        fflush(stdout);
+    }
     va_end(ap);
-    fflush(stdout);
 #else
     (void)format;
 #endif
@@ -177,7 +310,8 @@ int debug_printf_stdout(const char *format, ...)
  * @param ... - variable arguments
  * @note This function is only available if
  * PRINT_ENABLED is non-zero
- * @return number of characters printed
+ * @return number of characters printed, or zero if the message is
+ *  recorded to be printed later
  */
 int debug_fprintf(FILE *stream, const char *format, ...)
 {
@@ -186,9 +320,14 @@ int debug_fprintf(FILE *stream, const char *format, ...)
     va_list ap;
 
     va_start(ap, format);
-    length = vfprintf(stream, format, ap);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf(stream, format, ap))
+#endif
+    {
+        length = vfprintf(stream, format, ap);
+        fflush(stream);
+    }
     va_end(ap);
-    fflush(stream);
 #else
     (void)stream;
     (void)format;
@@ -221,9 +360,14 @@ void debug_printf_stderr(const char *format, ...)
     va_list ap;
 
     va_start(ap, format);
-    vfprintf(stderr, format, ap);
+#if BACNET_DEBUG_ASYNC
+    if (!debug_async_vfprintf(stderr, format, ap))
+#endif
+    {
+        vfprintf(stderr, format, ap);
+        fflush(stderr);
+    }
     va_end(ap);
-    fflush(stderr);
 #else
     (void)format;
 #endif
@@ -238,8 +382,7 @@ void debug_printf_stderr(const char *format, ...)
  */
 void debug_print(const char *message)
 {
-    fprintf(stderr, "%s", message);
-    fflush(stderr);
+    debug_printf_stderr("%s", message);
 }
 #endif
 
@@ -21,10 +21,50 @@
 #define DEBUG_PRINTF_WITH_TIMESTAMP 0
 #endif
 
+/**
+ * Debug levels, from the most to the least severe.  A message is printed
+ * when its level is at or below the level set for its category.
+ */
+typedef enum BACnet_Debug_Level {
+    DEBUG_LEVEL_NONE = 0,
+    DEBUG_LEVEL_ERROR = 1,
+    DEBUG_LEVEL_WARNING = 2,
+    DEBUG_LEVEL_INFO = 3,
+    DEBUG_LEVEL_DEBUG = 4
+} BACNET_DEBUG_LEVEL;
+
+/**
+ * Debug categories, so that the modules can be filtered separately
+ */
+typedef enum BACnet_Debug_Category {
+    DEBUG_CATEGORY_DEFAULT = 0,
+    DEBUG_CATEGORY_DATALINK = 1,
+    DEBUG_CATEGORY_BVLC = 2,
+    DEBUG_CATEGORY_NETWORK = 3,
+    DEBUG_CATEGORY_APPLICATION = 4,
+    DEBUG_CATEGORY_OBJECT = 5,
+    DEBUG_CATEGORY_MAX = 6
+} BACNET_DEBUG_CATEGORY;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+BACNET_STACK_EXPORT
+void debug_level_set(
+    BACNET_DEBUG_CATEGORY category, BACNET_DEBUG_LEVEL level);
+BACNET_STACK_EXPORT
+BACNET_DEBUG_LEVEL debug_level(BACNET_DEBUG_CATEGORY category);
+BACNET_STACK_EXPORT
+bool debug_level_enabled(
+    BACNET_DEBUG_CATEGORY category, BACNET_DEBUG_LEVEL level);
+BACNET_STACK_EXPORT
+void debug_log(
+    BACNET_DEBUG_CATEGORY category,
+    BACNET_DEBUG_LEVEL level,
+    const char *format,
+    ...);
+
 BACNET_STACK_EXPORT
 void debug_printf(const char *format, ...);
 BACNET_STACK_EXPORT
@@ -49,6 +89,10 @@ void debug_printf_hex(
     const char *format,
     ...);
 
+BACNET_STACK_EXPORT
+void debug_hex_dump(
+    FILE *stream, uint32_t offset, const uint8_t *buffer, size_t length);
+
 #if PRINT_ENABLED
 BACNET_STACK_EXPORT
 void debug_print(const char *message);
@@ -0,0 +1,712 @@
+/**
+ * @file
+ * @brief Deferred debug printing from a lock-free ring
+ * @details A producer parses the format string once to copy the
+ *  arguments out of its va_list.  The consumer parses it again and prints
+ *  each conversion with its own fprintf() call, with every integer
+ *  widened to long long, so the original argument list is never rebuilt.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/debug_async.h"
+
+/* record flags */
+#define DEBUG_ASYNC_FLAG_TEXT 0x01
+#define DEBUG_ASYNC_FLAG_HEX 0x02
+
+/* argument types */
+#define DEBUG_ASYNC_ARG_INT 0
+#define DEBUG_ASYNC_ARG_SIGNED 1
+#define DEBUG_ASYNC_ARG_UNSIGNED 2
+#define DEBUG_ASYNC_ARG_DOUBLE 3
+#define DEBUG_ASYNC_ARG_POINTER 4
+#define DEBUG_ASYNC_ARG_STRING 5
+
+/* length modifiers */
+#define DEBUG_ASYNC_LENGTH_NONE 0
+#define DEBUG_ASYNC_LENGTH_CHAR 1
+#define DEBUG_ASYNC_LENGTH_SHORT 2
+#define DEBUG_ASYNC_LENGTH_LONG 3
+#define DEBUG_ASYNC_LENGTH_LONG_LONG 4
+#define DEBUG_ASYNC_LENGTH_INTMAX 5
+#define DEBUG_ASYNC_LENGTH_SIZE 6
+#define DEBUG_ASYNC_LENGTH_PTRDIFF 7
+#define DEBUG_ASYNC_LENGTH_LONG_DOUBLE 8
+
+/**
+ * One conversion specification of a format string
+ */
+struct debug_async_spec {
+    /** the specification without the length modifier and conversion */
+    char text[16];
+    /** number of format characters after the percent sign */
+    unsigned length;
+    /** number of asterisks, each an int argument before the value */
+    unsigned stars;
+    /** precision, or -1 if none is given in digits */
+    int precision;
+    /** true if the precision is an int argument */
+    bool precision_star;
+    unsigned modifier;
+    char conversion;
+};
+
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+static RING_BUFFER_ATOMIC Debug_Async_Ring;
+static volatile bool Debug_Async_Initialized;
+static volatile bool Debug_Async_Enabled;
+/* counted without atomics, so concurrent drops may be undercounted */
+static volatile unsigned long Debug_Async_Dropped;
+
+/**
+ * @brief Parse a conversion specification
+ * @param format - the characters after the percent sign
+ * @param spec - the parsed specification
+ * @return true if the specification can be recorded in binary
+ */
+static bool
+debug_async_spec_parse(const char *format, struct debug_async_spec *spec)
+{
+    unsigned i = 0, n = 0;
+
+    spec->stars = 0;
+    spec->precision = -1;
+    spec->precision_star = false;
+    spec->modifier = DEBUG_ASYNC_LENGTH_NONE;
+    spec->text[n++] = '%';
+    while (format[i] && strchr("-+ #0", format[i]) &&
+           (n < sizeof(spec->text) - 1)) {
+        spec->text[n++] = format[i++];
+    }
+    if (format[i] == '*') {
+        spec->stars++;
+        spec->text[n++] = format[i++];
+    }
+    while ((format[i] >= '0') && (format[i] <= '9') &&
+           (n < sizeof(spec->text) - 1)) {
+        spec->text[n++] = format[i++];
+    }
+    if ((format[i] == '.') && (n < sizeof(spec->text) - 1)) {
+        spec->text[n++] = format[i++];
+        if (format[i] == '*') {
+            spec->stars++;
+            spec->precision_star = true;
+            spec->text[n++] = format[i++];
+        } else {
+            spec->precision = 0;
+            while ((format[i] >= '0') && (format[i] <= '9') &&
+                   (n < sizeof(spec->text) - 1)) {
+                spec->precision = (spec->precision * 10) + (format[i] - '0');
+                spec->text[n++] = format[i++];
+            }
+        }
+    }
+    if (n >= sizeof(spec->text) - 1) {
+        return false;
+    }
+    spec->text[n] = 0;
+    switch (format[i]) {
+        case 'h':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_SHORT;
+            if (format[i] == 'h') {
+                i++;
+                spec->modifier = DEBUG_ASYNC_LENGTH_CHAR;
+            }
+            break;
+        case 'l':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_LONG;
+            if (format[i] == 'l') {
+                i++;
+                spec->modifier = DEBUG_ASYNC_LENGTH_LONG_LONG;
+            }
+            break;
+        case 'j':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_INTMAX;
+            break;
+        case 'z':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_SIZE;
+            break;
+        case 't':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_PTRDIFF;
+            break;
+        case 'L':
+            i++;
+            spec->modifier = DEBUG_ASYNC_LENGTH_LONG_DOUBLE;
+            break;
+        default:
+            break;
+    }
+    spec->conversion = format[i];
+    if (!spec->conversion) {
+        return false;
+    }
+    spec->length = i + 1;
+    if (spec->modifier == DEBUG_ASYNC_LENGTH_LONG_DOUBLE) {
+        return false;
+    }
+    switch (spec->conversion) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            return true;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            return (spec->modifier == DEBUG_ASYNC_LENGTH_NONE) ||
+                (spec->modifier == DEBUG_ASYNC_LENGTH_LONG);
+        case 'c':
+        case 's':
+        case 'p':
+            return spec->modifier == DEBUG_ASYNC_LENGTH_NONE;
+        default:
+            /* %n and anything unknown */
+            return false;
+    }
+}
+
+/**
+ * @brief Add an argument to a record
+ * @param record - record being filled
+ * @param type - DEBUG_ASYNC_ARG_ type
+ * @return the argument to set, or NULL if the record is full
+ */
+static union debug_async_arg *
+debug_async_arg_add(struct debug_async_record *record, uint8_t type)
+{
+    if (record->argc >= DEBUG_ASYNC_ARGS_MAX) {
+        return NULL;
+    }
+    record->type[record->argc] = type;
+
+    return &record->arg[record->argc++];
+}
+
+/**
+ * @brief Copy a string argument into the data of a record
+ * @param record - record being filled
+ * @param string - string argument
+ * @param precision - most characters to copy, or -1 for all
+ * @return true if the string fits
+ */
+static bool debug_async_string_add(
+    struct debug_async_record *record, const char *string, int precision)
+{
+    union debug_async_arg *arg;
+    size_t length = 0;
+
+    if (!string) {
+        string = "(null)";
+    }
+    while (string[length] &&
+           ((precision < 0) || (length < (size_t)precision))) {
+        length++;
+    }
+    if ((record->data_length + length + 1) > sizeof(record->data)) {
+        return false;
+    }
+    arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_STRING);
+    if (!arg) {
+        return false;
+    }
+    arg->unsigned_integer = record->data_length;
+    memcpy(&record->data[record->data_length], string, length);
+    record->data[record->data_length + length] = 0;
+    record->data_length += (uint8_t)(length + 1);
+
+    return true;
+}
+
+/**
+ * @brief Copy the arguments of a format string into a record
+ * @param record - record being filled, with its format
+ * @param ap - arguments of the format
+ * @return true if every argument was recorded
+ */
+static bool
+debug_async_capture(struct debug_async_record *record, va_list ap)
+{
+    const char *format = record->format;
+    struct debug_async_spec spec;
+    union debug_async_arg *arg;
+    unsigned i;
+    int star = -1;
+
+    while (*format) {
+        if (*format++ != '%') {
+            continue;
+        }
+        if (*format == '%') {
+            format++;
+            continue;
+        }
+        if (!debug_async_spec_parse(format, &spec)) {
+            return false;
+        }
+        format += spec.length;
+        for (i = 0; i < spec.stars; i++) {
+            arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_INT);
+            if (!arg) {
+                return false;
+            }
+            star = va_arg(ap, int);
+            arg->integer = star;
+        }
+        if (spec.precision_star) {
+            spec.precision = star;
+        }
+        switch (spec.conversion) {
+            case 'd':
+            case 'i':
+                arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_SIGNED);
+                if (!arg) {
+                    return false;
+                }
+                switch (spec.modifier) {
+                    case DEBUG_ASYNC_LENGTH_CHAR:
+                        arg->integer = (signed char)va_arg(ap, int);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_SHORT:
+                        arg->integer = (short)va_arg(ap, int);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_LONG:
+                        arg->integer = va_arg(ap, long);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_LONG_LONG:
+                        arg->integer = va_arg(ap, long long);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_INTMAX:
+                        arg->integer = (long long)va_arg(ap, intmax_t);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_SIZE:
+                        arg->integer = (long long)va_arg(ap, size_t);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_PTRDIFF:
+                        arg->integer = (long long)va_arg(ap, ptrdiff_t);
+                        break;
+                    default:
+                        arg->integer = va_arg(ap, int);
+                        break;
+                }
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_UNSIGNED);
+                if (!arg) {
+                    return false;
+                }
+                switch (spec.modifier) {
+                    case DEBUG_ASYNC_LENGTH_CHAR:
+                        arg->unsigned_integer =
+                            (unsigned char)va_arg(ap, unsigned);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_SHORT:
+                        arg->unsigned_integer =
+                            (unsigned short)va_arg(ap, unsigned);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_LONG:
+                        arg->unsigned_integer = va_arg(ap, unsigned long);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_LONG_LONG:
+                        arg->unsigned_integer =
+                            va_arg(ap, unsigned long long);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_INTMAX:
+                        arg->unsigned_integer = va_arg(ap, uintmax_t);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_SIZE:
+                        arg->unsigned_integer = va_arg(ap, size_t);
+                        break;
+                    case DEBUG_ASYNC_LENGTH_PTRDIFF:
+                        arg->unsigned_integer =
+                            (unsigned long long)va_arg(ap, ptrdiff_t);
+                        break;
+                    default:
+                        arg->unsigned_integer = va_arg(ap, unsigned);
+                        break;
+                }
+                break;
+            case 'c':
+                arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_INT);
+                if (!arg) {
+                    return false;
+                }
+                arg->integer = va_arg(ap, int);
+                break;
+            case 's':
+                if (!debug_async_string_add(
+                        record, va_arg(ap, const char *), spec.precision)) {
+                    return false;
+                }
+                break;
+            case 'p':
+                arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_POINTER);
+                if (!arg) {
+                    return false;
+                }
+                arg->pointer = va_arg(ap, void *);
+                break;
+            default:
+                /* floating point */
+                arg = debug_async_arg_add(record, DEBUG_ASYNC_ARG_DOUBLE);
+                if (!arg) {
+                    return false;
+                }
+                arg->real = va_arg(ap, double);
+                break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Record a message in the ring
+ * @param stream - stream to print to later
+ * @param offset - address printed at the left of the hex dump
+ * @param buffer - data to dump in hex, or NULL
+ * @param buffer_length - number of bytes in the buffer
+ * @param format - printf format string that outlives the record
+ * @param ap - arguments of the format
+ * @return true if the message was recorded or dropped, false if
+ *  recording is not enabled and ap was not used
+ */
+static bool debug_async_record_put(
+    FILE *stream,
+    uint32_t offset,
+    const uint8_t *buffer,
+    size_t buffer_length,
+    const char *format,
+    va_list ap)
+{
+    /* filled on the stack, since the elements of the ring are only
+       aligned for its sequence numbers */
+    struct debug_async_record data = { 0 }, *record = &data;
+    size_t length;
+    va_list aq;
+
+    if (!Debug_Async_Enabled || !format) {
+        return false;
+    }
+    if (Ringbuf_Atomic_Full(&Debug_Async_Ring)) {
+        Debug_Async_Dropped++;
+        return true;
+    }
+    record->format = format;
+    record->stream = stream;
+    record->offset = offset;
+    record->flags = 0;
+    record->argc = 0;
+    record->data_length = 0;
+    record->hex_length = 0;
+    va_copy(aq, ap);
+    if (!debug_async_capture(record, aq)) {
+        /* format it now, and print the text later */
+        record->flags = DEBUG_ASYNC_FLAG_TEXT;
+        record->argc = 0;
+        (void)vsnprintf(record->data, sizeof(record->data), format, ap);
+        record->data_length = (uint8_t)(strlen(record->data) + 1);
+    }
+    va_end(aq);
+    if (buffer && buffer_length) {
+        length = sizeof(record->data) - record->data_length;
+        if (buffer_length < length) {
+            length = buffer_length;
+        }
+        memcpy(&record->data[record->data_length], buffer, length);
+        record->hex_length = (uint8_t)length;
+        record->flags |= DEBUG_ASYNC_FLAG_HEX;
+    }
+    if (!Ringbuf_Atomic_Put(&Debug_Async_Ring, (const uint8_t *)record)) {
+        Debug_Async_Dropped++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Print one conversion of a recorded message
+ * @param stream - stream to print to
+ * @param spec - parsed conversion specification
+ * @param star - values of the asterisks in the specification
+ * @param record - recorded message
+ * @param arg - argument of the conversion
+ * @param type - DEBUG_ASYNC_ARG_ type of the argument
+ */
+static void debug_async_arg_print(
+    FILE *stream,
+    const struct debug_async_spec *spec,
+    const int *star,
+    const struct debug_async_record *record,
+    const union debug_async_arg *arg,
+    uint8_t type)
+{
+    char text[sizeof(spec->text) + 3];
+    size_t n = strlen(spec->text);
+
+    memcpy(text, spec->text, n);
+    if ((type == DEBUG_ASYNC_ARG_SIGNED) ||
+        (type == DEBUG_ASYNC_ARG_UNSIGNED)) {
+        text[n++] = 'l';
+        text[n++] = 'l';
+    }
+    text[n++] = spec->conversion;
+    text[n] = 0;
+#define DEBUG_ASYNC_FPRINTF(value)                                \
+    do {                                                          \
+        if (spec->stars == 2) {                                   \
+            fprintf(stream, text, star[0], star[1], (value));     \
+        } else if (spec->stars == 1) {                            \
+            fprintf(stream, text, star[0], (value));              \
+        } else {                                                  \
+            fprintf(stream, text, (value));                       \
+        }                                                         \
+    } while (0)
+    switch (type) {
+        case DEBUG_ASYNC_ARG_INT:
+            DEBUG_ASYNC_FPRINTF((int)arg->integer);
+            break;
+        case DEBUG_ASYNC_ARG_SIGNED:
+            DEBUG_ASYNC_FPRINTF(arg->integer);
+            break;
+        case DEBUG_ASYNC_ARG_UNSIGNED:
+            DEBUG_ASYNC_FPRINTF(arg->unsigned_integer);
+            break;
+        case DEBUG_ASYNC_ARG_DOUBLE:
+            DEBUG_ASYNC_FPRINTF(arg->real);
+            break;
+        case DEBUG_ASYNC_ARG_POINTER:
+            DEBUG_ASYNC_FPRINTF(arg->pointer);
+            break;
+        case DEBUG_ASYNC_ARG_STRING:
+            DEBUG_ASYNC_FPRINTF(&record->data[arg->unsigned_integer]);
+            break;
+        default:
+            break;
+    }
+#undef DEBUG_ASYNC_FPRINTF
+}
+
+/**
+ * @brief Print a recorded message
+ * @param record - recorded message
+ */
+static void debug_async_record_print(const struct debug_async_record *record)
+{
+    FILE *stream = record->stream ? record->stream : stdout;
+    const char *format = record->format;
+    struct debug_async_spec spec;
+    int star[2] = { 0, 0 };
+    unsigned argi = 0, i;
+    size_t length;
+
+    if (record->flags & DEBUG_ASYNC_FLAG_TEXT) {
+        fputs(record->data, stream);
+        format = "";
+    }
+    while (*format) {
+        if (*format != '%') {
+            length = strcspn(format, "%");
+            fwrite(format, 1, length, stream);
+            format += length;
+            continue;
+        }
+        format++;
+        if (*format == '%') {
+            fputc('%', stream);
+            format++;
+            continue;
+        }
+        /* the same format was parsed when it was recorded */
+        (void)debug_async_spec_parse(format, &spec);
+        format += spec.length;
+        for (i = 0; (i < spec.stars) && (argi < record->argc); i++) {
+            star[i] = (int)record->arg[argi++].integer;
+        }
+        if (argi < record->argc) {
+            debug_async_arg_print(
+                stream, &spec, star, record, &record->arg[argi],
+                record->type[argi]);
+            argi++;
+        }
+    }
+    if (record->flags & DEBUG_ASYNC_FLAG_HEX) {
+        debug_hex_dump(
+            stream, record->offset,
+            (const uint8_t *)&record->data[record->data_length],
+            record->hex_length);
+    }
+}
+#endif
+
+/**
+ * @brief Initialize the ring and start recording debug messages
+ * @param buffer - memory for the ring, of DEBUG_ASYNC_BUFFER_SIZE(count)
+ * @param buffer_size - size of the buffer in bytes
+ * @param count - number of records in the ring - a power of two
+ * @return true if the ring is initialized and recording is enabled
+ */
+bool debug_async_init(void *buffer, size_t buffer_size, unsigned count)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    Debug_Async_Enabled = false;
+    Debug_Async_Initialized = Ringbuf_Atomic_Initialize(
+        &Debug_Async_Ring, buffer, buffer_size,
+        sizeof(struct debug_async_record), count, true);
+    Debug_Async_Dropped = 0;
+    Debug_Async_Enabled = Debug_Async_Initialized;
+
+    return Debug_Async_Initialized;
+#else
+    (void)buffer;
+    (void)buffer_size;
+    (void)count;
+    return false;
+#endif
+}
+
+/**
+ * @brief Start or stop recording debug messages.  Messages that are
+ *  already recorded are still printed by debug_async_task().
+ * @param enable - true to record, false to print directly again
+ */
+void debug_async_enable(bool enable)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    Debug_Async_Enabled = enable && Debug_Async_Initialized;
+#else
+    (void)enable;
+#endif
+}
+
+/**
+ * @brief Determine if debug messages are recorded for later printing
+ * @return true if debug messages are recorded
+ */
+bool debug_async_enabled(void)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    return Debug_Async_Enabled;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Record a formatted message to be printed later
+ * @param stream - stream to print to, or NULL for stdout
+ * @param format - printf format string that outlives the record
+ * @param ap - arguments of the format
+ * @return true if the message was recorded or dropped, false if
+ *  recording is not enabled and the caller should print it
+ */
+bool debug_async_vfprintf(FILE *stream, const char *format, va_list ap)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    return debug_async_record_put(stream, 0, NULL, 0, format, ap);
+#else
+    (void)stream;
+    (void)format;
+    (void)ap;
+    return false;
+#endif
+}
+
+/**
+ * @brief Record a formatted message followed by a hex dump of a buffer.
+ *  Only as much of the buffer as fits in the record is dumped.
+ * @param stream - stream to print to, or NULL for stdout
+ * @param offset - starting address to print to the left side
+ * @param buffer - buffer from which to dump hex
+ * @param buffer_length - number of bytes from the buffer to dump
+ * @param format - printf format string that outlives the record
+ * @param ap - arguments of the format
+ * @return true if the message was recorded or dropped, false if
+ *  recording is not enabled and the caller should print it
+ */
+bool debug_async_vfprintf_hex(
+    FILE *stream,
+    uint32_t offset,
+    const uint8_t *buffer,
+    size_t buffer_length,
+    const char *format,
+    va_list ap)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    return debug_async_record_put(
+        stream, offset, buffer, buffer_length, format, ap);
+#else
+    (void)stream;
+    (void)offset;
+    (void)buffer;
+    (void)buffer_length;
+    (void)format;
+    (void)ap;
+    return false;
+#endif
+}
+
+/**
+ * @brief Print the recorded messages.  Call from one idle task or
+ *  background thread only.
+ * @param limit - most messages to print, or zero for all of them
+ * @return number of messages printed
+ */
+unsigned debug_async_task(unsigned limit)
+{
+    unsigned count = 0;
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    struct debug_async_record record;
+
+    if (!Debug_Async_Initialized) {
+        return 0;
+    }
+    while ((limit == 0) || (count < limit)) {
+        if (!Ringbuf_Atomic_Pop(&Debug_Async_Ring, (uint8_t *)&record)) {
+            break;
+        }
+        debug_async_record_print(&record);
+        count++;
+    }
+    if (count) {
+        fflush(NULL);
+    }
+#else
+    (void)limit;
+#endif
+
+    return count;
+}
+
+/**
+ * @brief Get the number of messages dropped because the ring was full
+ * @return number of dropped messages since debug_async_init()
+ */
+unsigned long debug_async_dropped(void)
+{
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+    return Debug_Async_Dropped;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief API for deferred debug printing from a lock-free ring
+ *
+ * Printing from the receive path of a datalink or a BBMD handler costs a
+ * formatted write and a flush for every message, which changes the timing
+ * that is being debugged.  With BACNET_DEBUG_ASYNC, the debug print
+ * functions instead record the format string pointer and the binary
+ * arguments in a lock-free ring, and debug_async_task() formats and
+ * prints them later from an idle task or a background thread.
+ *
+ * Format strings must be string literals or otherwise outlive the
+ * record.  The strings of %s arguments are copied.  A message that can
+ * not be recorded in binary, for example with too many arguments, is
+ * formatted into the record instead.  When the ring is full, the message
+ * is dropped and counted rather than waiting.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_DEBUG_ASYNC_H
+#define BACNET_SYS_DEBUG_ASYNC_H
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/sys/ringbuf_atomic.h"
+
+#ifndef DEBUG_ASYNC_ARGS_MAX
+#define DEBUG_ASYNC_ARGS_MAX 8
+#endif
+
+/* bytes for the copied strings, hex dump data, or formatted text,
+   at most 255 */
+#ifndef DEBUG_ASYNC_DATA_SIZE
+#define DEBUG_ASYNC_DATA_SIZE 96
+#endif
+
+/* number of records in the ring of a port - a power of two */
+#ifndef DEBUG_ASYNC_RECORDS
+#define DEBUG_ASYNC_RECORDS 64
+#endif
+
+/**
+ * One binary argument of a recorded message
+ */
+union debug_async_arg {
+    long long integer;
+    unsigned long long unsigned_integer;
+    double real;
+    const void *pointer;
+};
+
+/**
+ * One recorded message - an element of the ring
+ *
+ * @{
+ */
+struct debug_async_record {
+    /** format string, used by reference */
+    const char *format;
+    /** stream to print to */
+    FILE *stream;
+    /** address printed at the left of the hex dump */
+    uint32_t offset;
+    /** DEBUG_ASYNC_FLAG_ bits */
+    uint8_t flags;
+    uint8_t argc;
+    /** bytes of data used by strings or text */
+    uint8_t data_length;
+    /** bytes of data after data_length that are dumped in hex */
+    uint8_t hex_length;
+    uint8_t type[DEBUG_ASYNC_ARGS_MAX];
+    union debug_async_arg arg[DEBUG_ASYNC_ARGS_MAX];
+    char data[DEBUG_ASYNC_DATA_SIZE];
+};
+/** @} */
+
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+/** bytes of buffer for debug_async_init() */
+#define DEBUG_ASYNC_BUFFER_SIZE(record_count) \
+    RINGBUF_ATOMIC_BUFFER_SIZE(               \
+        sizeof(struct debug_async_record), (record_count))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool debug_async_init(void *buffer, size_t buffer_size, unsigned count);
+BACNET_STACK_EXPORT
+void debug_async_enable(bool enable);
+BACNET_STACK_EXPORT
+bool debug_async_enabled(void);
+
+BACNET_STACK_EXPORT
+bool debug_async_vfprintf(FILE *stream, const char *format, va_list ap);
+BACNET_STACK_EXPORT
+bool debug_async_vfprintf_hex(
+    FILE *stream,
+    uint32_t offset,
+    const uint8_t *buffer,
+    size_t buffer_length,
+    const char *format,
+    va_list ap);
+
+BACNET_STACK_EXPORT
+unsigned debug_async_task(unsigned limit);
+BACNET_STACK_EXPORT
+unsigned long debug_async_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,328 @@
+/**
+ * @file
+ * @brief Dense struct-of-arrays storage for frequently scanned object values
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/basic/sys/dense_value.h"
+#include "bacnet/basic/sys/mempool.h"
+
+/* number of slots allocated the first time the table grows */
+#ifndef DENSE_VALUE_CAPACITY_MIN
+#define DENSE_VALUE_CAPACITY_MIN 16
+#endif
+
+/**
+ * @brief Move one column of the table into a larger allocation, or
+ *  free it
+ * @param column - pointer to the column pointer
+ * @param data - new, zeroed column of more elements, or NULL to free
+ *  the column
+ * @param element_size - size of one element of the column
+ * @param capacity - current number of elements
+ */
+static void dense_value_column_move(
+    void **column, void *data, size_t element_size, uint32_t capacity)
+{
+    if (*column && data) {
+        memcpy(data, *column, (size_t)capacity * element_size);
+    }
+    BACNET_MEMPOOL_FREE(*column, (size_t)capacity * element_size);
+    *column = data;
+}
+
+/**
+ * @brief Grow every column of the table to hold more slots
+ * @param table - table to grow
+ * @return true if the table was grown
+ */
+static bool dense_value_table_grow(DENSE_VALUE_TABLE *table)
+{
+    uint32_t capacity = table->capacity;
+    uint32_t new_capacity;
+    void *present_value, *cov_increment, *prior_value, *flags, *instance;
+
+    if (capacity == 0) {
+        new_capacity = DENSE_VALUE_CAPACITY_MIN;
+    } else if (capacity < (UINT32_MAX / 2)) {
+        new_capacity = capacity * 2;
+    } else {
+        return false;
+    }
+    /* every column is allocated before any moves, so that the columns
+       always have the size that the capacity says when they are freed */
+    present_value = BACNET_MEMPOOL_CALLOC((size_t)new_capacity * sizeof(float));
+    cov_increment = BACNET_MEMPOOL_CALLOC((size_t)new_capacity * sizeof(float));
+    prior_value = BACNET_MEMPOOL_CALLOC((size_t)new_capacity * sizeof(float));
+    flags = BACNET_MEMPOOL_CALLOC((size_t)new_capacity * sizeof(uint8_t));
+    instance = BACNET_MEMPOOL_CALLOC((size_t)new_capacity * sizeof(uint32_t));
+    if (!present_value || !cov_increment || !prior_value || !flags ||
+        !instance) {
+        BACNET_MEMPOOL_FREE(
+            present_value, (size_t)new_capacity * sizeof(float));
+        BACNET_MEMPOOL_FREE(
+            cov_increment, (size_t)new_capacity * sizeof(float));
+        BACNET_MEMPOOL_FREE(prior_value, (size_t)new_capacity * sizeof(float));
+        BACNET_MEMPOOL_FREE(flags, (size_t)new_capacity * sizeof(uint8_t));
+        BACNET_MEMPOOL_FREE(instance, (size_t)new_capacity * sizeof(uint32_t));
+        return false;
+    }
+    dense_value_column_move(
+        (void **)&table->Present_Value, present_value, sizeof(float),
+        capacity);
+    dense_value_column_move(
+        (void **)&table->COV_Increment, cov_increment, sizeof(float),
+        capacity);
+    dense_value_column_move(
+        (void **)&table->Prior_Value, prior_value, sizeof(float), capacity);
+    dense_value_column_move(
+        (void **)&table->Flags, flags, sizeof(uint8_t), capacity);
+    dense_value_column_move(
+        (void **)&table->Instance, instance, sizeof(uint32_t), capacity);
+    table->capacity = new_capacity;
+
+    return true;
+}
+
+/**
+ * @brief Initialize an empty table
+ * @param table - table to initialize
+ */
+void dense_value_table_init(DENSE_VALUE_TABLE *table)
+{
+    if (table) {
+        memset(table, 0, sizeof(DENSE_VALUE_TABLE));
+    }
+}
+
+/**
+ * @brief Free the memory used by the table and leave it empty
+ * @param table - table to clean up
+ */
+void dense_value_table_cleanup(DENSE_VALUE_TABLE *table)
+{
+    if (table) {
+        dense_value_column_move(
+            (void **)&table->Present_Value, NULL, sizeof(float),
+            table->capacity);
+        dense_value_column_move(
+            (void **)&table->COV_Increment, NULL, sizeof(float),
+            table->capacity);
+        dense_value_column_move(
+            (void **)&table->Prior_Value, NULL, sizeof(float),
+            table->capacity);
+        dense_value_column_move(
+            (void **)&table->Flags, NULL, sizeof(uint8_t), table->capacity);
+        dense_value_column_move(
+            (void **)&table->Instance, NULL, sizeof(uint32_t),
+            table->capacity);
+        dense_value_table_init(table);
+    }
+}
+
+/**
+ * @brief Get the number of slots in use
+ * @param table - table
+ * @return number of slots in use
+ */
+uint32_t dense_value_table_count(const DENSE_VALUE_TABLE *table)
+{
+    return table ? table->count : 0;
+}
+
+/**
+ * @brief Get the scan limit of the table
+ * @param table - table
+ * @return one past the highest slot in use - slots below it that are not
+ *  in use have no DENSE_VALUE_FLAG_IN_USE flag
+ */
+uint32_t dense_value_table_limit(const DENSE_VALUE_TABLE *table)
+{
+    return table ? table->limit : 0;
+}
+
+/**
+ * @brief Allocate the lowest free slot and clear its values
+ * @param table - table
+ * @param instance - object instance that owns the slot
+ * @return slot number, or DENSE_VALUE_SLOT_NONE if out of memory
+ */
+uint32_t dense_value_slot_alloc(DENSE_VALUE_TABLE *table, uint32_t instance)
+{
+    uint32_t slot;
+
+    if (!table) {
+        return DENSE_VALUE_SLOT_NONE;
+    }
+    if (table->count == table->limit) {
+        /* no holes - append */
+        slot = table->limit;
+    } else {
+        for (slot = 0; slot < table->limit; slot++) {
+            if (!(table->Flags[slot] & DENSE_VALUE_FLAG_IN_USE)) {
+                break;
+            }
+        }
+    }
+    if ((slot >= table->capacity) && !dense_value_table_grow(table)) {
+        return DENSE_VALUE_SLOT_NONE;
+    }
+    table->Present_Value[slot] = 0.0f;
+    table->COV_Increment[slot] = 0.0f;
+    table->Prior_Value[slot] = 0.0f;
+    table->Flags[slot] = DENSE_VALUE_FLAG_IN_USE;
+    table->Instance[slot] = instance;
+    table->count++;
+    if (slot >= table->limit) {
+        table->limit = slot + 1;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Free a slot so that it can be reused
+ * @param table - table
+ * @param slot - slot number returned by dense_value_slot_alloc()
+ */
+void dense_value_slot_free(DENSE_VALUE_TABLE *table, uint32_t slot)
+{
+    if (!dense_value_slot_in_use(table, slot)) {
+        return;
+    }
+    table->Flags[slot] = 0;
+    table->count--;
+    while ((table->limit > 0) &&
+           !(table->Flags[table->limit - 1] & DENSE_VALUE_FLAG_IN_USE)) {
+        table->limit--;
+    }
+}
+
+/**
+ * @brief Determine if a slot is in use
+ * @param table - table
+ * @param slot - slot number
+ * @return true if the slot is in use
+ */
+bool dense_value_slot_in_use(const DENSE_VALUE_TABLE *table, uint32_t slot)
+{
+    return table && (slot < table->limit) &&
+        (table->Flags[slot] & DENSE_VALUE_FLAG_IN_USE);
+}
+
+/**
+ * @brief Evaluate the COV increment of every slot at once.
+ *
+ * A slot trips when the distance between its present value and its
+ * prior value reaches its COV increment; the COV flag of a tripped slot
+ * is set and its prior value becomes the present value.  The comparison
+ * runs branch free over 32 slots at a time so that the compiler can
+ * vectorize it.
+ *
+ * @param table - table of analog values to evaluate
+ * @param bitmap - filled with one bit per slot, bit (slot % 32) of word
+ *  (slot / 32), set when the slot is in use and its COV flag is set
+ * @param bitmap_words - number of 32-bit words in the bitmap
+ * @return number of slots in the table, which is the scan limit - when it
+ *  is larger than bitmap_words * 32, the remaining slots were not evaluated
+ */
+uint32_t dense_value_cov_evaluate(
+    DENSE_VALUE_TABLE *table, uint32_t *bitmap, uint32_t bitmap_words)
+{
+    uint32_t limit, count, base, word, n, i;
+    uint32_t tripped, in_use, changed;
+    const float *present_value, *prior_value, *cov_increment;
+    const uint8_t *flags;
+    float delta;
+
+    if (!table) {
+        return 0;
+    }
+    limit = table->limit;
+    if (!bitmap) {
+        return limit;
+    }
+    count = limit;
+    if (count > (bitmap_words * 32U)) {
+        count = bitmap_words * 32U;
+    }
+    for (base = 0, word = 0; base < count; base += 32, word++) {
+        n = count - base;
+        if (n > 32) {
+            n = 32;
+        }
+        present_value = &table->Present_Value[base];
+        prior_value = &table->Prior_Value[base];
+        cov_increment = &table->COV_Increment[base];
+        flags = &table->Flags[base];
+        tripped = 0;
+        in_use = 0;
+        changed = 0;
+        for (i = 0; i < n; i++) {
+            delta = present_value[i] - prior_value[i];
+            delta = (delta < 0.0f) ? -delta : delta;
+            tripped |= (uint32_t)(delta >= cov_increment[i]) << i;
+            in_use |= (uint32_t)((flags[i] & DENSE_VALUE_FLAG_IN_USE) != 0)
+                << i;
+            changed |= (uint32_t)((flags[i] & DENSE_VALUE_FLAG_CHANGED) != 0)
+                << i;
+        }
+        tripped &= in_use;
+        bitmap[word] = tripped | (changed & in_use);
+        /* only the newly tripped slots are written */
+        tripped &= ~changed;
+        while (tripped) {
+            i = 0;
+            while (!(tripped & (1U << i))) {
+                i++;
+            }
+            tripped &= ~(1U << i);
+            table->Flags[base + i] |= DENSE_VALUE_FLAG_CHANGED;
+            table->Prior_Value[base + i] = table->Present_Value[base + i];
+        }
+    }
+
+    return limit;
+}
+
+/**
+ * @brief Visit the slots in use, in slot order
+ * @param table - table to scan
+ * @param flags - visit only slots with any of these DENSE_VALUE_FLAG_ bits,
+ *  or zero to visit every slot in use
+ * @param callback - function called for each slot visited
+ * @param context - context passed to the callback
+ * @return number of slots visited
+ */
+unsigned dense_value_table_scan(
+    const DENSE_VALUE_TABLE *table,
+    uint8_t flags,
+    dense_value_scan_callback callback,
+    void *context)
+{
+    unsigned visited = 0;
+    uint32_t slot;
+    uint8_t slot_flags;
+
+    if (!table || !callback) {
+        return 0;
+    }
+    for (slot = 0; slot < table->limit; slot++) {
+        slot_flags = table->Flags[slot];
+        if (!(slot_flags & DENSE_VALUE_FLAG_IN_USE)) {
+            continue;
+        }
+        if (flags && !(slot_flags & flags)) {
+            continue;
+        }
+        visited++;
+        if (!callback(table, slot, context)) {
+            break;
+        }
+    }
+
+    return visited;
+}
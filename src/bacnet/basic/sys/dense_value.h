@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief Dense struct-of-arrays storage for frequently scanned object values
+ *
+ * Objects keep their descriptors in a key list, one heap allocation each.
+ * The few values that are scanned often - the present value, the COV
+ * increment, the last reported value and a handful of flags - can instead
+ * be kept in parallel arrays indexed by a compact slot number, so that a
+ * scan over many objects streams through contiguous memory instead of
+ * following one pointer per object.  Freed slots are reused lowest first
+ * to keep the table dense.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_DENSE_VALUE_H
+#define BACNET_SYS_DENSE_VALUE_H
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* slot number returned when no slot could be allocated */
+#define DENSE_VALUE_SLOT_NONE UINT32_MAX
+
+/* flags of each slot */
+#define DENSE_VALUE_FLAG_IN_USE 0x01
+#define DENSE_VALUE_FLAG_CHANGED 0x02
+#define DENSE_VALUE_FLAG_OUT_OF_SERVICE 0x04
+
+/**
+ * Dense value table - one element of each column per slot
+ *
+ * @{
+ */
+typedef struct dense_value_table {
+    /** present value - binary objects store 0.0 or 1.0 */
+    float *Present_Value;
+    /** COV increment */
+    float *COV_Increment;
+    /** value last reported by a COV notification */
+    float *Prior_Value;
+    /** DENSE_VALUE_FLAG_ bits */
+    uint8_t *Flags;
+    /** object instance that owns the slot */
+    uint32_t *Instance;
+    /** number of slots allocated in each column */
+    uint32_t capacity;
+    /** number of slots in use */
+    uint32_t count;
+    /** one past the highest slot that was ever used */
+    uint32_t limit;
+} DENSE_VALUE_TABLE;
+/** @} */
+
+/**
+ * Callback for each slot visited by a scan
+ * @param table - table being scanned
+ * @param slot - slot number
+ * @param context - context passed to the scan
+ * @return true to continue the scan, false to stop
+ */
+typedef bool (*dense_value_scan_callback)(
+    const DENSE_VALUE_TABLE *table, uint32_t slot, void *context);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void dense_value_table_init(DENSE_VALUE_TABLE *table);
+BACNET_STACK_EXPORT
+void dense_value_table_cleanup(DENSE_VALUE_TABLE *table);
+BACNET_STACK_EXPORT
+uint32_t dense_value_table_count(const DENSE_VALUE_TABLE *table);
+BACNET_STACK_EXPORT
+uint32_t dense_value_table_limit(const DENSE_VALUE_TABLE *table);
+
+BACNET_STACK_EXPORT
+uint32_t dense_value_slot_alloc(DENSE_VALUE_TABLE *table, uint32_t instance);
+BACNET_STACK_EXPORT
+void dense_value_slot_free(DENSE_VALUE_TABLE *table, uint32_t slot);
+BACNET_STACK_EXPORT
+bool dense_value_slot_in_use(const DENSE_VALUE_TABLE *table, uint32_t slot);
+
+BACNET_STACK_EXPORT
+uint32_t dense_value_cov_evaluate(
+    DENSE_VALUE_TABLE *table, uint32_t *bitmap, uint32_t bitmap_words);
+
+BACNET_STACK_EXPORT
+unsigned dense_value_table_scan(
+    const DENSE_VALUE_TABLE *table,
+    uint8_t flags,
+    dense_value_scan_callback callback,
+    void *context);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
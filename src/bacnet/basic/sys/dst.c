@@ -54,115 +54,179 @@ ordinal_week_month_day(uint16_t year, uint8_t month, uint8_t ordinal)
 }
 
 /**
- * This function returns true if the date-time is during DST
+ * This function returns the day of the month of an ordinal weekday
  *
- * @param year - Year of our Lord A.D. (2000,2001,..2099)
+ * @param data - daylight savings time data, for the epoch
+ * @param year - Year of our Lord A.D. (1900..9999)
  * @param month - months of the year (1=Jan,...,12=Dec)
- * @param day - day of the month (1..31)
- * @param hour - hours after midnight (0..23)
- * @param minute - minutes after hour (0..59)
- * @param second - holds seconds after minute (0..59)
- *
- * @return true if date-time falls in DST.  false if not.
+ * @param ordinal - Ordinal Day of the Month
+ *  1=1st, 2=2nd, 3=3rd, 4=4th, or 5=LAST
+ * @param weekday - day of the week (1=Monday..7=Sunday)
+ * @return day of the month (1..31), or 0 if not in the month
  */
-bool dst_active(
-    struct daylight_savings_data *data,
+static uint8_t ordinal_weekday_month_day(
+    const struct daylight_savings_data *data,
     uint16_t year,
     uint8_t month,
-    uint8_t day,
-    uint8_t hour,
-    uint8_t minute,
-    uint8_t second)
+    uint8_t ordinal,
+    uint8_t weekday)
+{
+    uint8_t days;
+    uint8_t i;
+
+    days = days_per_month(year, month);
+    i = ordinal_week_month_day(year, month, ordinal);
+    for (; i <= days; i++) {
+        if (days_of_week(
+                data->Epoch_Day,
+                days_since_epoch(data->Epoch_Year, year, month, i)) ==
+            weekday) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * This function returns the seconds since January 1 of a year
+ *
+ * @param year - Year of our Lord A.D. (1900..9999)
+ * @param month - months of the year (1=Jan,...,12=Dec)
+ * @param day - day of the month (1..31)
+ * @param seconds - seconds after midnight
+ * @return seconds since the start of the year
+ */
+static uint32_t
+year_seconds(uint16_t year, uint8_t month, uint8_t day, uint32_t seconds)
 {
-    bool active = false;
-    uint8_t i = 0;
-    uint32_t time_now = 0;
-    uint32_t time_dst = 0;
-    uint8_t day_of_week = 0;
-    uint8_t days = 0;
-    uint32_t days_begin = 0;
-    uint32_t days_now = 0;
-    uint32_t days_end = 0;
+    return ((uint32_t)days_of_year(year, month, day) - 1UL) * 86400UL +
+        seconds;
+}
 
+/**
+ * This function computes the DST begin and end instants of a year, so
+ * that dst_active() only compares them until the year or the
+ * parameters change.  DST is active from the beginning instant, and
+ * until but not including the end instant.
+ *
+ * @param data - daylight savings time data
+ * @param year - Year of our Lord A.D. (1900..9999)
+ */
+static void dst_cache_update(struct daylight_savings_data *data, uint16_t year)
+{
+    uint8_t day;
+    uint32_t days_begin, days_end;
+
+    data->Begin_Seconds = 0;
+    data->End_Seconds = 0;
     if (data->Ordinal) {
-        if ((month >= data->Begin_Month) && (month <= data->End_Month)) {
-            if (month == data->Begin_Month) {
-                days = days_per_month(year, month);
-                i = ordinal_week_month_day(year, month, data->Begin_Week);
-                for (; i <= days; i++) {
-                    day_of_week = days_of_week(
-                        data->Epoch_Day,
-                        days_since_epoch(data->Epoch_Year, year, month, i));
-                    if (day_of_week == data->Begin_Day) {
-                        if (day == i) {
-                            time_now = time_to_seconds(hour, minute, second);
-                            /* begins at 2 AM Standard Time */
-                            time_dst = time_to_seconds(2, 0, 0);
-                            if (time_now >= time_dst) {
-                                active = true;
-                            }
-                        } else if (day > i) {
-                            active = true;
-                        }
-                        break;
-                    }
-                }
-            } else if (month == data->End_Month) {
-                days = days_per_month(year, month);
-                i = ordinal_week_month_day(year, month, data->End_Week);
-                for (; i <= days; i++) {
-                    day_of_week = days_of_week(
-                        data->Epoch_Day,
-                        days_since_epoch(data->Epoch_Year, year, month, i));
-                    if (day_of_week == data->End_Day) {
-                        if (day == i) {
-                            time_now = time_to_seconds(hour, minute, second);
-                            /* ends at 2 AM Daylight time,
-                               which is 1 AM Standard Time */
-                            time_dst = time_to_seconds(1, 0, 0);
-                            if (time_now < time_dst) {
-                                active = true;
-                            }
-                        } else if (day < i) {
-                            active = true;
-                        }
-                        break;
-                    }
-                }
+        if (data->Begin_Month <= data->End_Month) {
+            day = ordinal_weekday_month_day(
+                data, year, data->Begin_Month, data->Begin_Week,
+                data->Begin_Day);
+            if (day) {
+                /* begins at 2 AM Standard Time */
+                data->Begin_Seconds = year_seconds(
+                    year, data->Begin_Month, day, time_to_seconds(2, 0, 0));
             } else {
-                /* months between the beginning and end months */
-                active = true;
+                /* not in the beginning month at all */
+                data->Begin_Seconds =
+                    year_seconds(year, data->Begin_Month + 1, 1, 0);
+            }
+            if (data->Begin_Month == data->End_Month) {
+                /* active until the end of the month */
+                data->End_Seconds =
+                    year_seconds(year, data->End_Month + 1, 1, 0);
+            } else {
+                day = ordinal_weekday_month_day(
+                    data, year, data->End_Month, data->End_Week,
+                    data->End_Day);
+                if (day) {
+                    /* ends at 2 AM Daylight time,
+                       which is 1 AM Standard Time */
+                    data->End_Seconds = year_seconds(
+                        year, data->End_Month, day, time_to_seconds(1, 0, 0));
+                } else {
+                    /* not in the ending month at all */
+                    data->End_Seconds =
+                        year_seconds(year, data->End_Month, 1, 0);
+                }
             }
         }
     } else {
-        days_now = days_since_epoch(data->Epoch_Year, year, month, day);
         days_begin = days_since_epoch(
             data->Epoch_Year, year, data->Begin_Month, data->Begin_Day);
         days_end = days_since_epoch(
             data->Epoch_Year, year, data->End_Month, data->End_Day);
-        if ((days_now >= days_begin) && (days_now <= days_end)) {
-            if (days_now == days_begin) {
-                time_now = time_to_seconds(hour, minute, second);
+        if (days_begin <= days_end) {
+            if (days_begin) {
                 /* begins at 2 AM Standard Time */
-                time_dst = time_to_seconds(2, 0, 0);
-                if (time_now >= time_dst) {
-                    active = true;
-                }
-            } else if (days_now == days_end) {
-                time_now = time_to_seconds(hour, minute, second);
+                data->Begin_Seconds = year_seconds(
+                    year, data->Begin_Month, data->Begin_Day,
+                    time_to_seconds(2, 0, 0));
+            }
+            if (days_end == days_begin) {
+                /* active until the end of the day */
+                data->End_Seconds = data->Begin_Seconds +
+                    time_to_seconds(22, 0, 0);
+            } else {
                 /* ends at 2 AM Daylight time,
                    which is 1 AM Standard Time */
-                time_dst = time_to_seconds(1, 0, 0);
-                if (time_now < time_dst) {
-                    active = true;
-                }
-            } else {
-                active = true;
+                data->End_Seconds = year_seconds(
+                    year, data->End_Month, data->End_Day,
+                    time_to_seconds(1, 0, 0));
             }
         }
     }
+    data->Cache_Year = year;
+}
+
+/**
+ * This function returns true if the date-time is during DST
+ *
+ * The beginning and end instants are computed once per year, or again
+ * after dst_init() or dst_changed().
+ *
+ * @param year - Year of our Lord A.D. (2000,2001,..2099)
+ * @param month - months of the year (1=Jan,...,12=Dec)
+ * @param day - day of the month (1..31)
+ * @param hour - hours after midnight (0..23)
+ * @param minute - minutes after hour (0..59)
+ * @param second - holds seconds after minute (0..59)
+ *
+ * @return true if date-time falls in DST.  false if not.
+ */
+bool dst_active(
+    struct daylight_savings_data *data,
+    uint16_t year,
+    uint8_t month,
+    uint8_t day,
+    uint8_t hour,
+    uint8_t minute,
+    uint8_t second)
+{
+    uint32_t time_now;
+
+    if (data->Cache_Year != year) {
+        dst_cache_update(data, year);
+    }
+    time_now =
+        year_seconds(year, month, day, time_to_seconds(hour, minute, second));
 
-    return active;
+    return (time_now >= data->Begin_Seconds) && (time_now < data->End_Seconds);
+}
+
+/**
+ * @brief Recompute the DST beginning and end instants at the next call
+ *  to dst_active(), after the members of the data were changed directly
+ * @param data - daylight savings time data
+ */
+void dst_changed(struct daylight_savings_data *data)
+{
+    if (data) {
+        data->Cache_Year = 0;
+    }
 }
 
 /**
@@ -204,6 +268,7 @@ void dst_init(
         data->End_Week = end_which_day;
         data->Epoch_Day = epoch_day;
         data->Epoch_Year = epoch_year;
+        dst_changed(data);
     }
 }
 
@@ -225,5 +290,6 @@ void dst_init_defaults(struct daylight_savings_data *data)
         /* BACnet Epoch */
         data->Epoch_Day = 1 /* Monday=1 */;
         data->Epoch_Year = 1900;
+        dst_changed(data);
     }
 }
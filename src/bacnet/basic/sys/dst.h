@@ -23,6 +23,11 @@ struct daylight_savings_data {
     uint8_t End_Week;
     uint16_t Epoch_Year;
     uint8_t Epoch_Day;
+    /* year of the cached instants, or 0 to compute them again */
+    uint16_t Cache_Year;
+    /* DST begins and ends at these seconds since January 1 */
+    uint32_t Begin_Seconds;
+    uint32_t End_Seconds;
 };
 
 #ifdef __cplusplus
@@ -50,6 +55,7 @@ void dst_init(
     uint16_t epoch_year);
 /* initialization */
 void dst_init_defaults(struct daylight_savings_data *data);
+void dst_changed(struct daylight_savings_data *data);
 
 #ifdef __cplusplus
 }
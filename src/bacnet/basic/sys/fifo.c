@@ -10,7 +10,9 @@
  * This library only uses a byte sized chunk for a data element.
  * It uses a data store whose size is a power of 2 (8, 16, 32, 64, ...)
  * and doesn't waste any data bytes.  It has very low overhead, and
- * utilizes modulo for indexing the data in the data store.
+ * utilizes a mask for indexing the data in the data store.  Blocks of
+ * bytes are copied in at most two contiguous segments, one up to the end
+ * of the data store and one from its start.
  *
  * To use this library, first declare a data store, sized for a power of 2:
  * {@code
@@ -57,12 +59,98 @@
  * checking the queue for data using FIFO_Empty(), and then pulling data from
  * the queue using FIFO_Get().
  *
+ * A producer such as a DMA transfer can instead fill the data store
+ * directly, by asking for the contiguous free space with
+ * FIFO_Write_Window() and then adding the bytes it wrote with
+ * FIFO_Write_Commit().  A consumer can likewise read in place with
+ * FIFO_Read_Window() and FIFO_Read_Commit().
+ *
  */
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include "bacnet/basic/sys/fifo.h"
 
+/**
+ * Returns the index in the data store of a head or tail position
+ *
+ * @param b - pointer to FIFO_BUFFER structure
+ * @param position - head or tail position
+ *
+ * @return index in the data store
+ */
+static unsigned FIFO_Index(FIFO_BUFFER const *b, unsigned position)
+{
+    if ((b->buffer_len & (b->buffer_len - 1)) == 0) {
+        return position & (b->buffer_len - 1);
+    }
+
+    /* a data store whose size is not a power of two */
+    return position % b->buffer_len;
+}
+
+/**
+ * Copies bytes out of the data store, in at most two segments
+ *
+ * @param b - pointer to FIFO_BUFFER structure
+ * @param tail - position of the first byte to copy
+ * @param buffer [out] - buffer to hold the bytes
+ * @param count - number of bytes to copy
+ */
+static void FIFO_Copy_Out(
+    FIFO_BUFFER const *b, unsigned tail, uint8_t *buffer, unsigned count)
+{
+    volatile const uint8_t *data;
+    unsigned index;
+    unsigned segment;
+    unsigned i;
+
+    index = FIFO_Index(b, tail);
+    segment = b->buffer_len - index;
+    if (segment > count) {
+        segment = count;
+    }
+    data = &b->buffer[index];
+    for (i = 0; i < segment; i++) {
+        buffer[i] = data[i];
+    }
+    data = &b->buffer[0];
+    for (i = 0; i < (count - segment); i++) {
+        buffer[segment + i] = data[i];
+    }
+}
+
+/**
+ * Copies bytes into the data store, in at most two segments
+ *
+ * @param b - pointer to FIFO_BUFFER structure
+ * @param head - position of the first byte to copy
+ * @param buffer [in] - bytes to copy
+ * @param count - number of bytes to copy
+ */
+static void FIFO_Copy_In(
+    FIFO_BUFFER *b, unsigned head, const uint8_t *buffer, unsigned count)
+{
+    volatile uint8_t *data;
+    unsigned index;
+    unsigned segment;
+    unsigned i;
+
+    index = FIFO_Index(b, head);
+    segment = b->buffer_len - index;
+    if (segment > count) {
+        segment = count;
+    }
+    data = &b->buffer[index];
+    for (i = 0; i < segment; i++) {
+        data[i] = buffer[i];
+    }
+    data = &b->buffer[0];
+    for (i = 0; i < (count - segment); i++) {
+        data[i] = buffer[segment + i];
+    }
+}
+
 /**
  * Returns the number of bytes in the FIFO
  *
@@ -134,7 +222,7 @@ uint8_t FIFO_Peek(FIFO_BUFFER const *b)
     unsigned index;
 
     if (b) {
-        index = b->tail % b->buffer_len;
+        index = FIFO_Index(b, b->tail);
         return (b->buffer[index]);
     }
 
@@ -153,9 +241,6 @@ uint8_t FIFO_Peek(FIFO_BUFFER const *b)
 unsigned FIFO_Peek_Ahead(FIFO_BUFFER const *b, uint8_t *buffer, unsigned length)
 {
     unsigned count = 0;
-    unsigned index;
-    unsigned tail;
-    unsigned i;
 
     if (b) {
         count = FIFO_Count(b);
@@ -163,12 +248,7 @@ unsigned FIFO_Peek_Ahead(FIFO_BUFFER const *b, uint8_t *buffer, unsigned length)
             /* adjust to limit the number of bytes peeked */
             count = length;
         }
-        tail = b->tail;
-        for (i = 0; i < count; i++) {
-            index = tail % b->buffer_len;
-            buffer[i] = b->buffer[index];
-            tail++;
-        }
+        FIFO_Copy_Out(b, b->tail, buffer, count);
     }
 
     return count;
@@ -190,7 +270,7 @@ uint8_t FIFO_Get(FIFO_BUFFER *b)
     unsigned index;
 
     if (!FIFO_Empty(b)) {
-        index = b->tail % b->buffer_len;
+        index = FIFO_Index(b, b->tail);
         data_byte = b->buffer[index];
         b->tail++;
     }
@@ -211,30 +291,22 @@ uint8_t FIFO_Get(FIFO_BUFFER *b)
 unsigned FIFO_Pull(FIFO_BUFFER *b, uint8_t *buffer, unsigned length)
 {
     unsigned count;
-    uint8_t data_byte;
-    unsigned index;
+    unsigned tail; /* used to avoid volatile decision */
 
     count = FIFO_Count(b);
     if (count > length) {
         /* adjust to limit the number of bytes pulled */
         count = length;
     }
-    if (length > count) {
-        /* adjust the return value */
-        length = count;
-    }
-    while (count) {
-        index = b->tail % b->buffer_len;
-        data_byte = b->buffer[index];
-        b->tail++;
+    if (count) {
+        tail = b->tail;
         if (buffer) {
-            *buffer = data_byte;
-            buffer++;
+            FIFO_Copy_Out(b, tail, buffer, count);
         }
-        count--;
+        b->tail = tail + count;
     }
 
-    return length;
+    return count;
 }
 
 /**
@@ -253,7 +325,7 @@ bool FIFO_Put(FIFO_BUFFER *b, uint8_t data_byte)
     if (b) {
         /* limit the buffer to prevent overwriting */
         if (!FIFO_Full(b)) {
-            index = b->head % b->buffer_len;
+            index = FIFO_Index(b, b->head);
             b->buffer[index] = data_byte;
             b->head++;
             status = true;
@@ -275,17 +347,113 @@ bool FIFO_Put(FIFO_BUFFER *b, uint8_t data_byte)
 bool FIFO_Add(FIFO_BUFFER *b, const uint8_t *buffer, unsigned count)
 {
     bool status = false; /* return value */
-    unsigned index;
+    unsigned head; /* used to avoid volatile decision */
 
     /* limit the buffer to prevent overwriting */
     if (FIFO_Available(b, count) && buffer) {
-        while (count) {
-            index = b->head % b->buffer_len;
-            b->buffer[index] = *buffer;
-            b->head++;
-            buffer++;
-            count--;
+        head = b->head;
+        FIFO_Copy_In(b, head, buffer, count);
+        /* the bytes are in the data store before the consumer sees them */
+        b->head = head + count;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * Gets the contiguous free space at the head of the FIFO, so that a
+ * producer such as a DMA transfer can write bytes into it directly.
+ * There may be more free space at the start of the data store after
+ * the window is committed.
+ *
+ * @param  b - pointer to FIFO_BUFFER structure
+ * @param  data [out] - first free byte of the data store
+ *
+ * @return number of bytes that can be written at data
+ */
+unsigned FIFO_Write_Window(FIFO_BUFFER *b, volatile uint8_t **data)
+{
+    unsigned count = 0;
+    unsigned index;
+
+    if (b) {
+        count = b->buffer_len - FIFO_Count(b);
+        index = FIFO_Index(b, b->head);
+        if (count > (b->buffer_len - index)) {
+            count = b->buffer_len - index;
         }
+        if (data) {
+            *data = &b->buffer[index];
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Adds the bytes written into the write window to the FIFO
+ *
+ * @param  b - pointer to FIFO_BUFFER structure
+ * @param  count [in] - number of bytes written into the window
+ *
+ * @return true if the bytes were added, false if more than the free space
+ */
+bool FIFO_Write_Commit(FIFO_BUFFER *b, unsigned count)
+{
+    bool status = false;
+
+    if (FIFO_Available(b, count)) {
+        b->head += count;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * Gets the contiguous data at the tail of the FIFO, so that a consumer
+ * can read the bytes in place.  There may be more data at the start of
+ * the data store after the window is committed.
+ *
+ * @param  b - pointer to FIFO_BUFFER structure
+ * @param  data [out] - first byte of data in the data store
+ *
+ * @return number of bytes that can be read at data
+ */
+unsigned FIFO_Read_Window(FIFO_BUFFER const *b, volatile const uint8_t **data)
+{
+    unsigned count = 0;
+    unsigned index;
+
+    if (b) {
+        count = FIFO_Count(b);
+        index = FIFO_Index(b, b->tail);
+        if (count > (b->buffer_len - index)) {
+            count = b->buffer_len - index;
+        }
+        if (data) {
+            *data = &b->buffer[index];
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Removes the bytes read from the read window from the FIFO
+ *
+ * @param  b - pointer to FIFO_BUFFER structure
+ * @param  count [in] - number of bytes read from the window
+ *
+ * @return true if the bytes were removed, false if more than the data
+ */
+bool FIFO_Read_Commit(FIFO_BUFFER *b, unsigned count)
+{
+    bool status = false;
+
+    if (b && (count <= FIFO_Count(b))) {
+        b->tail += count;
         status = true;
     }
 
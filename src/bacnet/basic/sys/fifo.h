@@ -88,6 +88,19 @@ bool FIFO_Put(FIFO_BUFFER *b, uint8_t data_byte);
 BACNET_STACK_EXPORT
 bool FIFO_Add(FIFO_BUFFER *b, const uint8_t *data_bytes, unsigned count);
 
+BACNET_STACK_EXPORT
+unsigned FIFO_Write_Window(FIFO_BUFFER *b, volatile uint8_t **data);
+
+BACNET_STACK_EXPORT
+bool FIFO_Write_Commit(FIFO_BUFFER *b, unsigned count);
+
+BACNET_STACK_EXPORT
+unsigned
+FIFO_Read_Window(FIFO_BUFFER const *b, volatile const uint8_t **data);
+
+BACNET_STACK_EXPORT
+bool FIFO_Read_Commit(FIFO_BUFFER *b, unsigned count);
+
 BACNET_STACK_EXPORT
 void FIFO_Flush(FIFO_BUFFER *b);
 
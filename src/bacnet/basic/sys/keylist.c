@@ -5,6 +5,15 @@
  * The list is sorted, indexed, and keyed. The array is much faster
  * than a linked list.  It stores a pointer to data, which you must
  * malloc and free on your own, or just use static data.
+ *
+ * When BACNET_KEYLIST_HASH is defined, the nodes are stored inline in
+ * slabs instead of one allocation per node, and an open addressing hash
+ * table finds the data for a key in constant time.  Instead of the
+ * sorted array, the ordered view used for the index based API is a tree
+ * balanced by random node priorities (a treap), where each node counts
+ * the nodes below it, so that a node is added, deleted, or found by its
+ * index in logarithmic time without moving the other nodes.  The slabs
+ * whose nodes are all unused are given back.
  * @author Steve Karg <skarg@users.sourceforge.net>
  * @date 2003
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
@@ -13,20 +22,481 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mempool.h"
 
 /******************************************************************** */
 /* Generic node routines */
 /******************************************************************** */
 
+#if defined(BACNET_KEYLIST_HASH)
+/* marks a hash table slot where a node was deleted */
+static struct Keylist_Node Deleted_Node;
+#define KEYLIST_DELETED (&Deleted_Node)
+
+/** Grab memory for another slab of nodes and add its nodes
+ * to the unused nodes of the list.
+ *
+ * @param list  Pointer to the list that will hold the nodes.
+ * @return true if the slab was added, or false when Out Of Memory.
+ */
+static bool SlabCreate(OS_Keylist list)
+{
+    struct Keylist_Slab *slab;
+    int i;
+
+    slab = BACNET_MEMPOOL_CALLOC(sizeof(struct Keylist_Slab));
+    if (!slab) {
+        return false;
+    }
+    slab->next = list->slabs;
+    list->slabs = slab;
+    /* the free nodes are chained together using the data pointer */
+    for (i = 0; i < KEYLIST_SLAB_NODES; i++) {
+        slab->nodes[i].data = list->free_nodes;
+        list->free_nodes = &slab->nodes[i];
+    }
+    list->size += KEYLIST_SLAB_NODES;
+
+    return true;
+}
+
+/** Grab memory for a node (Keylist_Node) from the slabs of the list.
+ *
+ * @param list  Pointer to the list that will hold the node.
+ * @return Pointer to the allocated memory or
+ *         NULL under an Out Of Memory situation.
+ */
+static struct Keylist_Node *NodeCreate(OS_Keylist list)
+{
+    struct Keylist_Node *node;
+    uint32_t seed;
+
+    if (!list->free_nodes && !SlabCreate(list)) {
+        return NULL;
+    }
+    node = list->free_nodes;
+    list->free_nodes = node->data;
+    node->key = 0;
+    node->data = NULL;
+    node->left = NULL;
+    node->right = NULL;
+    node->size = 1;
+    /* xorshift random numbers keep the expected tree depth logarithmic */
+    seed = list->seed ? list->seed : 0x2545F491UL;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    list->seed = seed;
+    node->priority = seed;
+    if ((list->size - list->count - 1) < list->trim_free) {
+        list->trim_free = list->size - list->count - 1;
+    }
+
+    return node;
+}
+
+/** Return the memory for a node (Keylist_Node) to the slabs of the list.
+ *
+ * @param list  Pointer to the list that holds the node.
+ * @param node  Pointer to the node to be returned.
+ */
+static void NodeFree(OS_Keylist list, struct Keylist_Node *node)
+{
+    node->left = NULL;
+    node->right = NULL;
+    node->size = 0;
+    node->data = list->free_nodes;
+    list->free_nodes = node;
+}
+
+/** Return the number of nodes in a subtree
+ *
+ * @param tree  Pointer to the subtree, or NULL
+ * @return number of nodes in the subtree
+ */
+static int TreeSize(const struct Keylist_Node *tree)
+{
+    return tree ? tree->size : 0;
+}
+
+/** Join two subtrees where every node of the left subtree comes
+ * before every node of the right subtree.
+ *
+ * @param left  Pointer to the left subtree, or NULL
+ * @param right  Pointer to the right subtree, or NULL
+ * @return Pointer to the joined tree
+ */
+static struct Keylist_Node *
+TreeMerge(struct Keylist_Node *left, struct Keylist_Node *right)
+{
+    if (!left) {
+        return right;
+    }
+    if (!right) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        left->right = TreeMerge(left->right, right);
+        left->size = 1 + TreeSize(left->left) + TreeSize(left->right);
+        return left;
+    }
+    right->left = TreeMerge(left, right->left);
+    right->size = 1 + TreeSize(right->left) + TreeSize(right->right);
+
+    return right;
+}
+
+/** Split a tree into the nodes before an index and the rest
+ *
+ * @param tree  Pointer to the tree, or NULL
+ * @param index  Number of nodes that go into the left subtree
+ * @param left  Pointer that takes the nodes before the index
+ * @param right  Pointer that takes the nodes from the index on
+ */
+static void TreeSplit(
+    struct Keylist_Node *tree,
+    int index,
+    struct Keylist_Node **left,
+    struct Keylist_Node **right)
+{
+    int size;
+
+    if (!tree) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+    size = TreeSize(tree->left);
+    if (index <= size) {
+        TreeSplit(tree->left, index, left, &tree->left);
+        *right = tree;
+    } else {
+        TreeSplit(tree->right, index - size - 1, &tree->right, right);
+        *left = tree;
+    }
+    tree->size = 1 + TreeSize(tree->left) + TreeSize(tree->right);
+}
+
+/** Find the node at an index of the ordered list
+ *
+ * @param list  Pointer to the list
+ * @param index  Index of the node
+ * @return Pointer to the node, or NULL if the index is not in the list
+ */
+static struct Keylist_Node *IndexNode(OS_Keylist list, int index)
+{
+    struct Keylist_Node *node;
+    int size;
+
+    if ((index < 0) || (index >= list->count)) {
+        return NULL;
+    }
+    node = list->root;
+    while (node) {
+        size = TreeSize(node->left);
+        if (index < size) {
+            node = node->left;
+        } else if (index > size) {
+            index -= size + 1;
+            node = node->right;
+        } else {
+            break;
+        }
+    }
+
+    return node;
+}
+
+/** Count the nodes that come before a key
+ *
+ * @param list  Pointer to the list
+ * @param key  Key to search for
+ * @param after  true to also count the nodes with the same key
+ * @return index where a node with the key goes into the list
+ */
+static int TreeRank(OS_Keylist list, KEY key, bool after)
+{
+    const struct Keylist_Node *node = list->root;
+    int index = 0;
+
+    while (node) {
+        if ((node->key < key) || (after && (node->key == key))) {
+            index += TreeSize(node->left) + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+
+    return index;
+}
+
+/** Insert a node at an index of the ordered list
+ *
+ * @param list  Pointer to the list
+ * @param node  Pointer to the node
+ * @param index  Index where the node goes
+ */
+static void TreeInsert(OS_Keylist list, struct Keylist_Node *node, int index)
+{
+    struct Keylist_Node *left, *right;
+
+    TreeSplit(list->root, index, &left, &right);
+    list->root = TreeMerge(TreeMerge(left, node), right);
+    list->count++;
+}
+
+/** Remove the node at an index of the ordered list
+ *
+ * @param list  Pointer to the list
+ * @param index  Index of the node, which must be in the list
+ * @return Pointer to the node that was removed
+ */
+static struct Keylist_Node *TreeRemove(OS_Keylist list, int index)
+{
+    struct Keylist_Node *left, *node, *right;
+
+    TreeSplit(list->root, index, &left, &right);
+    TreeSplit(right, 1, &node, &right);
+    list->root = TreeMerge(left, right);
+    list->count--;
+
+    return node;
+}
+
+/** Compute the hash table slot for a key
+ *
+ * @param list  Pointer to the list
+ * @param key  Key to compute the slot
+ *
+ * @return slot index in the hash table
+ */
+static int HashSlot(OS_Keylist list, KEY key)
+{
+    uint32_t hash = (uint32_t)key;
+
+    /* integer finalizer to spread sequential keys */
+    hash ^= hash >> 16;
+    hash *= 0x7feb352dUL;
+    hash ^= hash >> 15;
+    hash *= 0x846ca68bUL;
+    hash ^= hash >> 16;
+
+    return (int)(hash & (uint32_t)(list->table_size - 1));
+}
+
+/** Place a node into the hash table without checking the table size
+ *
+ * @param list  Pointer to the list
+ * @param node  Pointer to the node
+ */
+static void HashPlace(OS_Keylist list, struct Keylist_Node *node)
+{
+    int slot;
+
+    slot = HashSlot(list, node->key);
+    while (list->table[slot] && (list->table[slot] != KEYLIST_DELETED)) {
+        slot = (slot + 1) & (list->table_size - 1);
+    }
+    if (!list->table[slot]) {
+        list->table_used++;
+    }
+    list->table[slot] = node;
+}
+
+/** Resize the hash table to hold a number of nodes at a load below
+ * one half, which also drops the deleted markers.  The table is freed
+ * when there are no nodes.
+ *
+ * @param list  Pointer to the list
+ * @param count  Number of nodes that the table must hold
+ *
+ * @return true if the table can hold the nodes
+ */
+static bool HashResize(OS_Keylist list, int count)
+{
+    struct Keylist_Node **new_table = NULL;
+    struct Keylist_Slab *slab;
+    int new_size = 0;
+    int i;
+
+    if (count > 0) {
+        new_size = 16;
+        while (new_size < (count + 1) * 2) {
+            new_size *= 2;
+        }
+        new_table = BACNET_MEMPOOL_CALLOC(
+            (size_t)new_size * sizeof(struct Keylist_Node *));
+        if (!new_table) {
+            return false;
+        }
+    }
+    if (list->table) {
+        BACNET_MEMPOOL_FREE(
+            list->table,
+            (size_t)list->table_size * sizeof(struct Keylist_Node *));
+    }
+    list->table = new_table;
+    list->table_size = new_size;
+    list->table_used = 0;
+    if (!new_table) {
+        return true;
+    }
+    /* rehash the nodes in use */
+    for (slab = list->slabs; slab; slab = slab->next) {
+        for (i = 0; i < KEYLIST_SLAB_NODES; i++) {
+            if (slab->nodes[i].size) {
+                HashPlace(list, &slab->nodes[i]);
+            }
+        }
+    }
+
+    return true;
+}
+
+/** Resize the hash table, if needed, to keep the load below one half
+ * including the deleted markers.
+ *
+ * @param list  Pointer to the list
+ * @param count  Number of nodes that the table must hold
+ *
+ * @return true if the table can hold the nodes
+ */
+static bool HashCheckSize(OS_Keylist list, int count)
+{
+    int added = count - list->count;
+
+    if (added < 1) {
+        added = 1;
+    }
+    if (list->table &&
+        ((list->table_used + added) * 2 <= list->table_size)) {
+        return true;
+    }
+
+    return HashResize(list, count);
+}
+
+/** Find a node with the key in the hash table
+ *
+ * @param list  Pointer to the list
+ * @param key  Key to search for
+ *
+ * @return node or NULL if not found
+ */
+static struct Keylist_Node *HashFind(OS_Keylist list, KEY key)
+{
+    struct Keylist_Node *node;
+    int slot;
+
+    if (!list->table || !list->count) {
+        return NULL;
+    }
+    slot = HashSlot(list, key);
+    while ((node = list->table[slot]) != NULL) {
+        if ((node != KEYLIST_DELETED) && (node->key == key)) {
+            return node;
+        }
+        slot = (slot + 1) & (list->table_size - 1);
+    }
+
+    return NULL;
+}
+
+/** Remove a node from the hash table
+ *
+ * @param list  Pointer to the list
+ * @param node  Pointer to the node
+ */
+static void HashRemove(OS_Keylist list, const struct Keylist_Node *node)
+{
+    int slot;
+
+    if (!list->table) {
+        return;
+    }
+    slot = HashSlot(list, node->key);
+    while (list->table[slot]) {
+        if (list->table[slot] == node) {
+            list->table[slot] = KEYLIST_DELETED;
+            break;
+        }
+        slot = (slot + 1) & (list->table_size - 1);
+    }
+}
+
+/** Give back the slabs whose nodes are all unused.  The slabs are only
+ * checked once at least half of the nodes are unused, and the unused
+ * nodes have doubled since the fewest, so that the check is paid for
+ * by the deletes in between.
+ *
+ * @param list  Pointer to the list that holds the slabs.
+ */
+static void SlabTrim(OS_Keylist list)
+{
+    struct Keylist_Slab **link;
+    struct Keylist_Slab *slab;
+    int unused = list->size - list->count;
+    int i, used;
+
+    if (list->count && ((unused < KEYLIST_SLAB_NODES) ||
+                        (unused <= list->count) ||
+                        (unused < (list->trim_free * 2)))) {
+        return;
+    }
+    list->free_nodes = NULL;
+    link = &list->slabs;
+    while ((slab = *link) != NULL) {
+        used = 0;
+        for (i = 0; i < KEYLIST_SLAB_NODES; i++) {
+            if (slab->nodes[i].size) {
+                used++;
+            }
+        }
+        if (used) {
+            for (i = 0; i < KEYLIST_SLAB_NODES; i++) {
+                if (!slab->nodes[i].size) {
+                    slab->nodes[i].data = list->free_nodes;
+                    list->free_nodes = &slab->nodes[i];
+                }
+            }
+            link = &slab->next;
+        } else {
+            *link = slab->next;
+            BACNET_MEMPOOL_FREE(slab, sizeof(struct Keylist_Slab));
+            list->size -= KEYLIST_SLAB_NODES;
+        }
+    }
+    list->trim_free = list->size - list->count;
+    /* and the hash table, when it is mostly empty */
+    if ((list->count + 1) * 8 <= list->table_size) {
+        (void)HashResize(list, list->count);
+    }
+}
+#else
 /** Grab memory for a node (Keylist_Node).
  *
+ * @param list  Pointer to the list that will hold the node.
  * @return Pointer to the allocated memory or
  *         NULL under an Out Of Memory situation.
  */
-static struct Keylist_Node *NodeCreate(void)
+static struct Keylist_Node *NodeCreate(OS_Keylist list)
+{
+    (void)list;
+    return BACNET_MEMPOOL_CALLOC(sizeof(struct Keylist_Node));
+}
+
+/** Return the memory for a node (Keylist_Node).
+ *
+ * @param list  Pointer to the list that holds the node.
+ * @param node  Pointer to the node to be returned.
+ */
+static void NodeFree(OS_Keylist list, struct Keylist_Node *node)
 {
-    return calloc(1, sizeof(struct Keylist_Node));
+    (void)list;
+    BACNET_MEMPOOL_FREE(node, sizeof(struct Keylist_Node));
 }
+#endif
 
 /** Grab memory for a list (Keylist).
  *
@@ -35,9 +505,10 @@ static struct Keylist_Node *NodeCreate(void)
  */
 static struct Keylist *KeylistCreate(void)
 {
-    return calloc(1, sizeof(struct Keylist));
+    return BACNET_MEMPOOL_CALLOC(sizeof(struct Keylist));
 }
 
+#if !defined(BACNET_KEYLIST_HASH)
 /** Check to see if the array is big enough for an addition
  * or is too big when we are deleting and we can shrink.
  *
@@ -65,7 +536,8 @@ static bool CheckArraySize(OS_Keylist list)
     }
     if (new_size > 0) {
         /* Allocate more room for node pointer array */
-        new_array = calloc((size_t)new_size, sizeof(struct Keylist_Node *));
+        new_array = BACNET_MEMPOOL_CALLOC(
+            (size_t)new_size * sizeof(struct Keylist_Node *));
 
         /* See if we got the memory we wanted */
         if (!new_array) {
@@ -77,7 +549,9 @@ static bool CheckArraySize(OS_Keylist list)
             for (i = 0; i < list->count; i++) {
                 new_array[i] = list->array[i];
             }
-            free(list->array);
+            BACNET_MEMPOOL_FREE(
+                list->array,
+                (size_t)list->size * sizeof(struct Keylist_Node *));
         }
         list->array = new_array;
         list->size = new_size;
@@ -86,6 +560,62 @@ static bool CheckArraySize(OS_Keylist list)
     return true;
 }
 
+/** Grow the array, if needed, so that it holds a number of nodes.
+ * The array is never shrunk here, so that a reserved size is kept
+ * while the nodes are added.
+ *
+ * @param list  Pointer to the list
+ * @param count  Number of nodes that the array must hold
+ *
+ * @return true if the array holds the nodes, false if out of memory
+ */
+static bool ReserveArraySize(OS_Keylist list, int count)
+{
+    const int chunk = 8; /* minimum number of nodes to allocate memory for */
+    struct Keylist_Node **new_array = NULL; /* new array of nodes */
+    int new_size; /* new number of nodes in the array */
+    int i; /* counter */
+
+    if (list->size >= count) {
+        return true;
+    }
+    new_size = list->size + chunk;
+    if (new_size < count) {
+        new_size = count;
+    }
+    new_array = BACNET_MEMPOOL_CALLOC(
+        (size_t)new_size * sizeof(struct Keylist_Node *));
+    if (!new_array) {
+        return false;
+    }
+    if (list->array) {
+        for (i = 0; i < list->count; i++) {
+            new_array[i] = list->array[i];
+        }
+        BACNET_MEMPOOL_FREE(
+            list->array, (size_t)list->size * sizeof(struct Keylist_Node *));
+    }
+    list->array = new_array;
+    list->size = new_size;
+
+    return true;
+}
+
+/** Find the node at an index of the sorted array
+ *
+ * @param list  Pointer to the list
+ * @param index  Index of the node
+ * @return Pointer to the node, or NULL if the index is not in the list
+ */
+static struct Keylist_Node *IndexNode(OS_Keylist list, int index)
+{
+    if (!list->array || (index < 0) || (index >= list->count)) {
+        return NULL;
+    }
+
+    return list->array[index];
+}
+
 /** Find the index of the key that we are looking for.
  * Since it is sorted, we can optimize the search.
  * returns true if found, and false not found.
@@ -150,6 +680,32 @@ static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
     }
     return status;
 }
+#else
+/** Find the index of the key that we are looking for in the tree.
+ * Returns the index of the first node with the key, or the index
+ * where the key should go into the list when it is not found.
+ *
+ * @param list  Pointer to the list
+ * @param key  Key to search for
+ * @param pIndex  Pointer to the variable taking the index were the key
+ *                had been found.
+ *
+ * @return true if found, and false if not
+ */
+static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
+{
+    const struct Keylist_Node *node;
+
+    if (!list) {
+        *pIndex = 0;
+        return false;
+    }
+    *pIndex = TreeRank(list, key, false);
+    node = IndexNode(list, *pIndex);
+
+    return node && (node->key == key);
+}
+#endif
 
 /******************************************************************** */
 /* list data functions */
@@ -164,15 +720,42 @@ static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
  *              by retrieving the key again.
  * @return Index of the key, or -1 if not found.
  */
+#if defined(BACNET_KEYLIST_HASH)
+int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
+{
+    struct Keylist_Node *node; /* holds the new node */
+    int index; /* return value */
+
+    if (!list || !HashCheckSize(list, list->count + 1)) {
+        return -1;
+    }
+    node = NodeCreate(list);
+    if (!node) {
+        return -1;
+    }
+    node->key = key;
+    node->data = data;
+    /* in front of the nodes with the same key */
+    index = TreeRank(list, key, false);
+    TreeInsert(list, node, index);
+    HashPlace(list, node);
+    list->revision++;
+
+    return index;
+}
+#else
 int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
 {
     struct Keylist_Node *node; /* holds the new node */
     int index = -1; /* return value */
     int i; /* counts through the array */
 
-    if (list && CheckArraySize(list)) {
+    if (list && ReserveArraySize(list, list->count + 1)) {
         /* figure out where to put the new node */
-        if (list->count) {
+        if (list->count && (key > list->array[list->count - 1]->key)) {
+            /* Add to the end of the list */
+            index = list->count;
+        } else if (list->count) {
             (void)FindIndex(list, key, &index);
             if (index < 0) {
                 /* Add to the beginning of the list */
@@ -191,16 +774,236 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
         }
 
         /* create and add the node */
-        node = NodeCreate();
+        node = NodeCreate(list);
         if (node) {
             list->count++;
             node->key = key;
             node->data = data;
             list->array[index] = node;
+            list->revision++;
+        } else {
+            /* Move the items back down to close the gap */
+            for (i = index; i < list->count; i++) {
+                list->array[i] = list->array[i + 1];
+            }
+            index = -1;
         }
     }
     return index;
 }
+#endif
+
+/** Reserves room in the list for a number of nodes, so that adding
+ * that many nodes does not grow the list one step at a time.
+ *
+ * @param list  Pointer to the list
+ * @param count  Number of nodes, in total, that the list will hold
+ *
+ * @return true if the room was reserved, false if out of memory
+ */
+bool Keylist_Reserve(OS_Keylist list, int count)
+{
+    if (!list || (count < 0)) {
+        return false;
+    }
+#if defined(BACNET_KEYLIST_HASH)
+    if (!HashCheckSize(list, count)) {
+        return false;
+    }
+    while (list->size < count) {
+        if (!SlabCreate(list)) {
+            return false;
+        }
+    }
+#else
+    if (!ReserveArraySize(list, count)) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+/** Inserts many nodes into their sorted positions in one pass.
+ * The existing nodes are moved at most once, instead of once for
+ * every node that is inserted before them.
+ *
+ * @param list  Pointer to the list
+ * @param keys  Keys to be inserted, sorted in ascending order
+ * @param data  Pointers to the data hold by each of the keys
+ * @param count  Number of keys to be inserted
+ *
+ * @return Number of keys that were inserted, or -1 if out of memory
+ *  and none were inserted.
+ */
+#if defined(BACNET_KEYLIST_HASH)
+int Keylist_Data_Add_Keys(
+    OS_Keylist list, const KEY *keys, void *const *data, int count)
+{
+    struct Keylist_Node *node; /* the new node */
+    int j; /* new position */
+
+    if (!list || !keys || (count <= 0)) {
+        return 0;
+    }
+    /* the reserved slabs have a node for each of the keys */
+    if (!Keylist_Reserve(list, list->count + count)) {
+        return -1;
+    }
+    for (j = 0; j < count; j++) {
+        node = NodeCreate(list);
+        node->key = keys[j];
+        node->data = data ? data[j] : NULL;
+        /* keys that are already in the list stay in front (FIFO) */
+        TreeInsert(list, node, TreeRank(list, keys[j], true));
+        HashPlace(list, node);
+    }
+    list->revision += (unsigned)count;
+
+    return count;
+}
+#else
+int Keylist_Data_Add_Keys(
+    OS_Keylist list, const KEY *keys, void *const *data, int count)
+{
+    struct Keylist_Node **nodes = NULL; /* the new nodes */
+    int i, j, k; /* old, new, and merged positions in the array */
+
+    if (!list || !keys || (count <= 0)) {
+        return 0;
+    }
+    if (!Keylist_Reserve(list, list->count + count)) {
+        return -1;
+    }
+    nodes = BACNET_MEMPOOL_CALLOC(
+        (size_t)count * sizeof(struct Keylist_Node *));
+    if (!nodes) {
+        return -1;
+    }
+    for (j = 0; j < count; j++) {
+        nodes[j] = NodeCreate(list);
+        if (!nodes[j]) {
+            while (j > 0) {
+                j--;
+                NodeFree(list, nodes[j]);
+            }
+            BACNET_MEMPOOL_FREE(
+                nodes, (size_t)count * sizeof(struct Keylist_Node *));
+            return -1;
+        }
+        nodes[j]->key = keys[j];
+        nodes[j]->data = data ? data[j] : NULL;
+    }
+    /* merge from the end, so that each node is moved only once,
+       and keys that are already in the list stay in front (FIFO) */
+    i = list->count - 1;
+    j = count - 1;
+    k = list->count + count - 1;
+    while (j >= 0) {
+        if ((i >= 0) && (list->array[i]->key > nodes[j]->key)) {
+            list->array[k] = list->array[i];
+            i--;
+        } else {
+            list->array[k] = nodes[j];
+            j--;
+        }
+        k--;
+    }
+    list->count += count;
+    list->revision += (unsigned)count;
+    BACNET_MEMPOOL_FREE(nodes, (size_t)count * sizeof(struct Keylist_Node *));
+
+    return count;
+}
+#endif
+
+/** Deletes many nodes specified by their keys in one pass.
+ * The remaining nodes are moved at most once, instead of once for
+ * every node that is deleted before them.
+ *
+ * @param list  Pointer to the list
+ * @param keys  Keys to be deleted, sorted in ascending order
+ * @param data  Optional array that receives the data of each of the
+ *  keys, or NULL for a key that was not found
+ * @param count  Number of keys to be deleted
+ *
+ * @return Number of keys that were deleted
+ */
+#if defined(BACNET_KEYLIST_HASH)
+int Keylist_Data_Delete_Keys(
+    OS_Keylist list, const KEY *keys, void **data, int count)
+{
+    struct Keylist_Node *node; /* the current node */
+    int deleted = 0; /* return value */
+    int index, j; /* node and deleted key positions */
+
+    if (!list || !keys || (count <= 0)) {
+        return 0;
+    }
+    for (j = 0; j < count; j++) {
+        if (data) {
+            data[j] = NULL;
+        }
+        if (FindIndex(list, keys[j], &index)) {
+            node = TreeRemove(list, index);
+            if (data) {
+                data[j] = node->data;
+            }
+            HashRemove(list, node);
+            NodeFree(list, node);
+            deleted++;
+        }
+    }
+    list->revision += (unsigned)deleted;
+    SlabTrim(list);
+
+    return deleted;
+}
+#else
+int Keylist_Data_Delete_Keys(
+    OS_Keylist list, const KEY *keys, void **data, int count)
+{
+    struct Keylist_Node *node; /* the current node */
+    int deleted = 0; /* return value */
+    int i, j = 0, k = 0; /* old, deleted key, and kept positions */
+
+    if (!list || !keys || (count <= 0)) {
+        return 0;
+    }
+    if (data) {
+        for (j = 0; j < count; j++) {
+            data[j] = NULL;
+        }
+        j = 0;
+    }
+    for (i = 0; i < list->count; i++) {
+        node = list->array[i];
+        while ((j < count) && (keys[j] < node->key)) {
+            j++;
+        }
+        if ((j < count) && (keys[j] == node->key)) {
+            if (data) {
+                data[j] = node->data;
+            }
+            j++;
+            NodeFree(list, node);
+            deleted++;
+        } else {
+            list->array[k] = node;
+            k++;
+        }
+    }
+    for (i = k; i < list->count; i++) {
+        list->array[i] = NULL;
+    }
+    list->count = k;
+    list->revision += (unsigned)deleted;
+    /* potentially reduce the size of the array */
+    (void)CheckArraySize(list);
+
+    return deleted;
+}
+#endif
 
 /** Deletes a node specified by its index
  * returns the data from the node
@@ -210,6 +1013,25 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
  *
  * @returns Pointer to the data of the deleted key or NULL.
  */
+#if defined(BACNET_KEYLIST_HASH)
+void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
+{
+    struct Keylist_Node *node;
+    void *data = NULL;
+
+    if (list && (index >= 0) && (index < list->count)) {
+        node = TreeRemove(list, index);
+        data = node->data;
+        HashRemove(list, node);
+        NodeFree(list, node);
+        list->revision++;
+        /* potentially give back the memory of the nodes */
+        SlabTrim(list);
+    }
+
+    return data;
+}
+#else
 void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
 {
     struct Keylist_Node *node;
@@ -237,8 +1059,9 @@ void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
                 }
             }
             list->count--;
+            list->revision++;
             if (node) {
-                free(node);
+                NodeFree(list, node);
             }
 
             /* potentially reduce the size of the array */
@@ -247,6 +1070,7 @@ void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
     }
     return (data);
 }
+#endif
 
 /** Deletes a node specified by its key/
  * returns the data from the node
@@ -316,18 +1140,54 @@ void *Keylist_Data_Pop(OS_Keylist list)
 void *Keylist_Data(OS_Keylist list, KEY key)
 {
     struct Keylist_Node *node = NULL;
+#if !defined(BACNET_KEYLIST_HASH)
     int index = 0; /* used to look up the index of node */
+#endif
 
-    if (list) {
-        if (list->array && list->count) {
-            if (FindIndex(list, key, &index)) {
-                node = list->array[index];
-            }
+    if (list && list->count) {
+#if defined(BACNET_KEYLIST_HASH)
+        node = HashFind(list, key);
+#else
+        if (FindIndex(list, key, &index)) {
+            node = list->array[index];
         }
+#endif
     }
     return node ? node->data : NULL;
 }
 
+/** Replaces the data of the node specified by key.
+ *
+ * @param list  Pointer to the list
+ * @param key  Key of the node
+ * @param data  New data of the node, that might be NULL.
+ *
+ * @returns true if the node was found and its data replaced.
+ */
+bool Keylist_Data_Set(OS_Keylist list, KEY key, void *data)
+{
+    struct Keylist_Node *node = NULL;
+#if !defined(BACNET_KEYLIST_HASH)
+    int index = 0; /* used to look up the index of node */
+#endif
+
+    if (list && list->count) {
+#if defined(BACNET_KEYLIST_HASH)
+        node = HashFind(list, key);
+#else
+        if (FindIndex(list, key, &index)) {
+            node = list->array[index];
+        }
+#endif
+    }
+    if (node) {
+        node->data = data;
+        return true;
+    }
+
+    return false;
+}
+
 /** Returns the index from the node specified by key.
  *
  * @param list  Pointer to the list
@@ -339,11 +1199,9 @@ int Keylist_Index(OS_Keylist list, KEY key)
 {
     int index = -1; /* used to look up the index of node */
 
-    if (list) {
-        if (list->array && list->count) {
-            if (!FindIndex(list, key, &index)) {
-                index = -1;
-            }
+    if (list && list->count) {
+        if (!FindIndex(list, key, &index)) {
+            index = -1;
         }
     }
     return index;
@@ -361,10 +1219,7 @@ void *Keylist_Data_Index(OS_Keylist list, int index)
     struct Keylist_Node *node = NULL;
 
     if (list) {
-        if (list->array && list->count && (index >= 0) &&
-            (index < list->count)) {
-            node = list->array[index];
-        }
+        node = IndexNode(list, index);
     }
     return node ? node->data : NULL;
 }
@@ -383,12 +1238,9 @@ KEY Keylist_Key(OS_Keylist list, int index)
     struct Keylist_Node *node;
 
     if (list) {
-        if (list->array && list->count && (index >= 0) &&
-            (index < list->count)) {
-            node = list->array[index];
-            if (node) {
-                key = node->key;
-            }
+        node = IndexNode(list, index);
+        if (node) {
+            key = node->key;
         }
     }
     return key;
@@ -408,14 +1260,11 @@ bool Keylist_Index_Key(OS_Keylist list, int index, KEY *pKey)
     struct Keylist_Node *node;
 
     if (list) {
-        if (list->array && list->count && (index >= 0) &&
-            (index < list->count)) {
-            node = list->array[index];
-            if (node) {
-                status = true;
-                if (pKey) {
-                    *pKey = node->key;
-                }
+        node = IndexNode(list, index);
+        if (node) {
+            status = true;
+            if (pKey) {
+                *pKey = node->key;
             }
         }
     }
@@ -432,6 +1281,16 @@ bool Keylist_Index_Key(OS_Keylist list, int index, KEY *pKey)
  */
 KEY Keylist_Next_Empty_Key(OS_Keylist list, KEY key)
 {
+#if defined(BACNET_KEYLIST_HASH)
+    if (list) {
+        while (HashFind(list, key)) {
+            if (KEY_LAST(key)) {
+                break;
+            }
+            key++;
+        }
+    }
+#else
     int index;
 
     if (list) {
@@ -442,6 +1301,7 @@ KEY Keylist_Next_Empty_Key(OS_Keylist list, KEY key)
             key++;
         }
     }
+#endif
 
     return key;
 }
@@ -463,6 +1323,55 @@ int Keylist_Count(OS_Keylist list)
     return (cnt);
 }
 
+/** Return a number that changes whenever a node is added to or deleted
+ * from this list, so that a copy made from the contents of the list, such
+ * as an index of the objects, can tell that it is stale.
+ *
+ * @param list  Pointer to the list
+ *
+ * @return Number of nodes added or deleted, which wraps around.
+ */
+unsigned Keylist_Revision(OS_Keylist list)
+{
+    unsigned revision = 0;
+
+    if (list) {
+        revision = list->revision;
+    }
+
+    return revision;
+}
+
+/** Return the number of heap bytes held by this list for its nodes,
+ * arrays and tables, not counting the data stored in the nodes.
+ *
+ * @param list  Pointer to the list
+ *
+ * @return Number of heap bytes used by the list.
+ */
+size_t Keylist_Memory_Size(OS_Keylist list)
+{
+    size_t size = 0;
+#if defined(BACNET_KEYLIST_HASH)
+    const struct Keylist_Slab *slab;
+#endif
+
+    if (list) {
+        size += sizeof(struct Keylist);
+#if defined(BACNET_KEYLIST_HASH)
+        size += (size_t)list->table_size * sizeof(struct Keylist_Node *);
+        for (slab = list->slabs; slab; slab = slab->next) {
+            size += sizeof(struct Keylist_Slab);
+        }
+#else
+        size += (size_t)list->size * sizeof(struct Keylist_Node *);
+        size += (size_t)list->count * sizeof(struct Keylist_Node);
+#endif
+    }
+
+    return size;
+}
+
 /******************************************************************** */
 /* Public List functions */
 /******************************************************************** */
@@ -476,9 +1385,11 @@ OS_Keylist Keylist_Create(void)
     struct Keylist *list;
 
     list = KeylistCreate();
+#if !defined(BACNET_KEYLIST_HASH)
     if (list) {
         CheckArraySize(list);
     }
+#endif
 
     return list;
 }
@@ -489,15 +1400,35 @@ OS_Keylist Keylist_Create(void)
  */
 void Keylist_Delete(OS_Keylist list)
 { /* list number to be deleted */
+#if defined(BACNET_KEYLIST_HASH)
+    struct Keylist_Slab *slab;
+#endif
+
     if (list) {
+#if defined(BACNET_KEYLIST_HASH)
+        /* the nodes are freed along with their slabs */
+        while (list->slabs) {
+            slab = list->slabs;
+            list->slabs = slab->next;
+            BACNET_MEMPOOL_FREE(slab, sizeof(struct Keylist_Slab));
+        }
+        if (list->table) {
+            BACNET_MEMPOOL_FREE(
+                list->table,
+                (size_t)list->table_size * sizeof(struct Keylist_Node *));
+        }
+#else
         /* clean out the list */
         while (list->count) {
             (void)Keylist_Data_Delete_By_Index(list, 0);
         }
         if (list->array) {
-            free(list->array);
+            BACNET_MEMPOOL_FREE(
+                list->array,
+                (size_t)list->size * sizeof(struct Keylist_Node *));
         }
-        free(list);
+#endif
+        BACNET_MEMPOOL_FREE(list, sizeof(struct Keylist));
     }
 
     return;
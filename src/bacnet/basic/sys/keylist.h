@@ -15,18 +15,53 @@
 /* This is a key sorted linked list data library that */
 /* uses a key or index to access the data. */
 /* If the keys are duplicated, they can be added into the list like FIFO */
+/* Define BACNET_KEYLIST_HASH to use the hash table engine which stores */
+/* the nodes in slabs, finds keys in constant time, and orders the nodes */
+/* in a tree so that the index based API does not move the nodes. */
 
 /* list data and datatype */
 struct Keylist_Node {
     KEY key; /* unique number that is sorted in the list */
     void *data; /* pointer to some data that is stored */
+#if defined(BACNET_KEYLIST_HASH)
+    struct Keylist_Node *left; /* subtree of nodes before this node */
+    struct Keylist_Node *right; /* subtree of nodes after this node */
+    uint32_t priority; /* random priority that balances the tree */
+    int size; /* number of nodes in this subtree, or 0 when unused */
+#endif
 };
 
+#if defined(BACNET_KEYLIST_HASH)
+/* nodes are stored inline in slabs rather than one allocation per node */
+#ifndef KEYLIST_SLAB_NODES
+#define KEYLIST_SLAB_NODES 32
+#endif
+struct Keylist_Slab {
+    struct Keylist_Slab *next;
+    struct Keylist_Node nodes[KEYLIST_SLAB_NODES];
+};
+
+typedef struct Keylist {
+    struct Keylist_Node *root; /* tree of nodes, ordered by key */
+    int count; /* number of nodes in this list - more efficient than loop */
+    int size; /* number of nodes in the slabs - can grow or shrink */
+    struct Keylist_Node **table; /* open addressing hash table of nodes */
+    int table_size; /* number of slots in the hash table - power of two */
+    int table_used; /* number of nodes and deleted markers in the table */
+    struct Keylist_Slab *slabs; /* memory for the nodes */
+    struct Keylist_Node *free_nodes; /* unused nodes in the slabs */
+    int trim_free; /* fewest unused nodes since the slabs were trimmed */
+    uint32_t seed; /* state of the random node priorities */
+    unsigned revision; /* number of nodes added or deleted */
+} KEYLIST_TYPE;
+#else
 typedef struct Keylist {
     struct Keylist_Node **array; /* array of nodes */
     int count; /* number of nodes in this list - more efficient than loop */
     int size; /* number of available nodes on this list - can grow or shrink */
+    unsigned revision; /* number of nodes added or deleted */
 } KEYLIST_TYPE;
+#endif
 typedef KEYLIST_TYPE *OS_Keylist;
 
 #ifdef __cplusplus
@@ -47,6 +82,22 @@ void Keylist_Delete(OS_Keylist list);
 BACNET_STACK_EXPORT
 int Keylist_Data_Add(OS_Keylist list, KEY key, void *data);
 
+/* reserves room for a number of nodes in total */
+BACNET_STACK_EXPORT
+bool Keylist_Reserve(OS_Keylist list, int count);
+
+/* inserts many nodes, with keys sorted in ascending order, in one pass */
+/* returns the number of nodes added, or -1 on failure */
+BACNET_STACK_EXPORT
+int Keylist_Data_Add_Keys(
+    OS_Keylist list, const KEY *keys, void *const *data, int count);
+
+/* deletes many nodes, with keys sorted in ascending order, in one pass */
+/* returns the number of nodes deleted */
+BACNET_STACK_EXPORT
+int Keylist_Data_Delete_Keys(
+    OS_Keylist list, const KEY *keys, void **data, int count);
+
 /* deletes a node specified by its key */
 BACNET_STACK_EXPORT
 /* returns the data from the node */
@@ -69,6 +120,11 @@ void Keylist_Data_Free(OS_Keylist list);
 BACNET_STACK_EXPORT
 void *Keylist_Data(OS_Keylist list, KEY key);
 
+/* replaces the data of the node specified by key */
+/* returns true if the node was found */
+BACNET_STACK_EXPORT
+bool Keylist_Data_Set(OS_Keylist list, KEY key, void *data);
+
 /* returns the index from the node specified by key */
 BACNET_STACK_EXPORT
 int Keylist_Index(OS_Keylist list, KEY key);
@@ -94,6 +150,14 @@ KEY Keylist_Next_Empty_Key(OS_Keylist list, KEY key);
 BACNET_STACK_EXPORT
 int Keylist_Count(OS_Keylist list);
 
+/* returns a number that changes when a node is added to or deleted */
+BACNET_STACK_EXPORT
+unsigned Keylist_Revision(OS_Keylist list);
+
+/* returns the heap bytes held by the list, not counting the data */
+BACNET_STACK_EXPORT
+size_t Keylist_Memory_Size(OS_Keylist list);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -15,6 +15,155 @@
 /* me! */
 #include "lighting_command.h"
 
+/* the transitions that are active, stepped by the transition task */
+static struct lighting_command_transition *Transition_Active_Head;
+static unsigned Transition_Active_Count;
+
+/**
+ * @brief Start a transition, so that the transition task steps it
+ *  until its callback indicates it is no longer active
+ * @note A transition without a callback is not started.  The memory of
+ *  an active transition must not be freed until it is stopped.
+ * @param transition - transition to be started
+ */
+void lighting_command_transition_start(
+    struct lighting_command_transition *transition)
+{
+    if (!transition || !transition->callback || transition->active) {
+        return;
+    }
+    transition->next = Transition_Active_Head;
+    Transition_Active_Head = transition;
+    transition->active = true;
+    Transition_Active_Count++;
+}
+
+/**
+ * @brief Stop a transition, removing it from the active transitions
+ * @param transition - transition to be stopped
+ */
+void lighting_command_transition_stop(
+    struct lighting_command_transition *transition)
+{
+    struct lighting_command_transition **link;
+
+    if (!transition || !transition->active) {
+        return;
+    }
+    link = &Transition_Active_Head;
+    while (*link) {
+        if (*link == transition) {
+            *link = transition->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    transition->next = NULL;
+    transition->active = false;
+    Transition_Active_Count--;
+}
+
+/**
+ * @brief Determine if a transition is active
+ * @param transition - transition to be checked
+ * @return true if the transition task steps the transition
+ */
+bool lighting_command_transition_active(
+    const struct lighting_command_transition *transition)
+{
+    if (!transition) {
+        return false;
+    }
+
+    return transition->active;
+}
+
+/**
+ * @brief Get the number of active transitions
+ * @return the number of transitions stepped by the transition task
+ */
+unsigned lighting_command_transition_count(void)
+{
+    return Transition_Active_Count;
+}
+
+/**
+ * @brief Step all the active transitions, removing the transitions
+ *  that are no longer active.  Idle lights cost nothing here.
+ * @param milliseconds - number of milliseconds elapsed since previously
+ * called.  Suggest that this is called every 10 milliseconds.
+ */
+void lighting_command_transition_task(uint16_t milliseconds)
+{
+    struct lighting_command_transition **link;
+    struct lighting_command_transition *transition;
+    bool active;
+
+    link = &Transition_Active_Head;
+    while (*link) {
+        transition = *link;
+        active = transition->callback(transition->key, milliseconds);
+        if (!transition->active) {
+            /* stopped by the callback, and already removed */
+            continue;
+        }
+        while (*link != transition) {
+            /* started by the callback, ahead of this transition */
+            link = &(*link)->next;
+        }
+        if (active) {
+            link = &transition->next;
+        } else {
+            *link = transition->next;
+            transition->next = NULL;
+            transition->active = false;
+            Transition_Active_Count--;
+        }
+    }
+}
+
+/**
+ * @brief Convert a value to fixed-point
+ * @param value - value to convert
+ * @return the value in fixed-point
+ */
+int32_t lighting_command_fixed(float value)
+{
+    return (int32_t)(value * (float)LIGHTING_COMMAND_FIXED_ONE);
+}
+
+/**
+ * @brief Convert a fixed-point value to floating point
+ * @param value - value in fixed-point
+ * @return the value in floating point
+ */
+float lighting_command_fixed_to_float(int32_t value)
+{
+    return (float)value / (float)LIGHTING_COMMAND_FIXED_ONE;
+}
+
+/**
+ * @brief Interpolate a fixed-point value towards a target in integer math
+ * @param value - present value in fixed-point
+ * @param target - target value in fixed-point
+ * @param elapsed - time elapsed since the present value
+ * @param duration - time remaining, at the present value, until the
+ *  target is reached
+ * @return the interpolated value in fixed-point
+ */
+int32_t lighting_command_fixed_interpolate(
+    int32_t value, int32_t target, uint32_t elapsed, uint32_t duration)
+{
+    int64_t delta;
+
+    if (elapsed >= duration) {
+        return target;
+    }
+    delta = ((int64_t)target - (int64_t)value) * (int64_t)elapsed;
+    delta /= (int64_t)duration;
+
+    return value + (int32_t)delta;
+}
 /**
  * @brief call the lighting command tracking value callbacks
  * @param data - dimmer data structure
@@ -276,7 +425,7 @@ static void lighting_command_fade_handler(
     struct bacnet_lighting_command_data *data, uint16_t milliseconds)
 {
     float old_value;
-    float x1, x2, x3, y1, y3;
+    float y1;
     float target_value;
 
     old_value = data->Tracking_Value;
@@ -296,16 +445,16 @@ static void lighting_command_fade_handler(
         data->Fade_Time = 0;
     } else {
         /* fading */
-        x1 = 0.0f;
-        x2 = (float)milliseconds;
-        x3 = (float)data->Fade_Time;
         if (isless(old_value, data->Min_Actual_Value)) {
             y1 = data->Min_Actual_Value;
         } else {
             y1 = old_value;
         }
-        y3 = target_value;
-        data->Tracking_Value = linear_interpolate(x1, x2, x3, y1, y3);
+        data->Tracking_Value =
+            lighting_command_fixed_to_float(lighting_command_fixed_interpolate(
+                lighting_command_fixed(y1),
+                lighting_command_fixed(target_value), milliseconds,
+                data->Fade_Time));
         data->Fade_Time -= milliseconds;
         data->In_Progress = BACNET_LIGHTING_FADE_ACTIVE;
     }
@@ -348,14 +497,11 @@ static void lighting_command_ramp_handler(
         data->Lighting_Operation = BACNET_LIGHTS_STOP;
     } else {
         ramp_rate = lighting_command_ramp_rate_clamp(data->Ramp_Rate);
-        /* determine the number of steps */
-        if (milliseconds <= 1000) {
-            /* percent per second */
-            steps = linear_interpolate(
-                0.0f, (float)milliseconds, 1000.0f, 0.0f, ramp_rate);
-        } else {
-            steps = ((float)milliseconds * ramp_rate) / 1000.0f;
-        }
+        /* determine the number of steps, in percent per second */
+        steps = lighting_command_fixed_to_float(
+            (int32_t)(((int64_t)lighting_command_fixed(ramp_rate) *
+                       milliseconds) /
+                      1000));
         if (isless(old_value, target_value)) {
             step_value = old_value + steps;
             if (isgreater(step_value, target_value)) {
@@ -608,6 +754,7 @@ void lighting_command_override(
     old_value = data->Tracking_Value;
     data->Tracking_Value = value;
     lighting_command_tracking_value_event(data, old_value, value);
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -697,6 +844,7 @@ void lighting_command_fade_to(
     data->Fade_Time = fade_time;
     data->Lighting_Operation = BACNET_LIGHTS_FADE_TO;
     data->Target_Level = value;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -714,6 +862,7 @@ void lighting_command_ramp_to(
     data->Ramp_Rate = lighting_command_ramp_rate_clamp(ramp_rate);
     data->Lighting_Operation = BACNET_LIGHTS_RAMP_TO;
     data->Target_Level = value;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -733,6 +882,7 @@ void lighting_command_step(
     data->Lighting_Operation = operation;
     data->Fade_Time = 0;
     data->Step_Increment = step_increment;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -761,6 +911,7 @@ void lighting_command_blink_warn(
     /* configure next interval */
     data->Blink.State = false;
     data->Blink.Interval = blink->Interval;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -774,6 +925,7 @@ void lighting_command_stop(struct bacnet_lighting_command_data *data)
         return;
     }
     data->Lighting_Operation = BACNET_LIGHTS_STOP;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -787,6 +939,7 @@ void lighting_command_none(struct bacnet_lighting_command_data *data)
         return;
     }
     data->Lighting_Operation = BACNET_LIGHTS_NONE;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -803,6 +956,7 @@ void lighting_command_restore_on(
     data->Fade_Time = fade_time;
     data->Lighting_Operation = BACNET_LIGHTS_RESTORE_ON;
     data->Target_Level = data->Last_On_Value;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -819,6 +973,7 @@ void lighting_command_default_on(
     data->Fade_Time = fade_time;
     data->Lighting_Operation = BACNET_LIGHTS_DEFAULT_ON;
     data->Target_Level = data->Default_On_Value;
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -841,6 +996,7 @@ void lighting_command_toggle_restore(
         /* not OFF, write 0.0% */
         data->Target_Level = 0.0f;
     }
+    lighting_command_transition_start(&data->Transition);
 }
 
 /**
@@ -863,6 +1019,7 @@ void lighting_command_toggle_default(
         /* not OFF, write 0.0% */
         data->Target_Level = 0.0f;
     }
+    lighting_command_transition_start(&data->Transition);
 }
 
 void lighting_command_init(struct bacnet_lighting_command_data *data)
@@ -891,4 +1048,8 @@ void lighting_command_init(struct bacnet_lighting_command_data *data)
     data->Blink.State = false;
     data->Notification_Head.next = NULL;
     data->Notification_Head.callback = NULL;
+    data->Transition.next = NULL;
+    data->Transition.callback = NULL;
+    data->Transition.key = 0;
+    data->Transition.active = false;
 }
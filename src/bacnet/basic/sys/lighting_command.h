@@ -41,6 +41,26 @@ struct lighting_command_timer_notification {
     lighting_command_timer_callback callback;
 };
 
+/**
+ * @brief Callback that steps an active transition
+ * @param  key - key used to link to specific light
+ * @param  milliseconds - elapsed time in milliseconds
+ * @return true while the transition is still active
+ */
+typedef bool (*lighting_command_transition_callback)(
+    uint32_t key, uint16_t milliseconds);
+/* a transition, linked in the list of active transitions while active */
+struct lighting_command_transition {
+    struct lighting_command_transition *next;
+    lighting_command_transition_callback callback;
+    uint32_t key;
+    bool active : 1;
+};
+
+/* fixed-point values used for the transition interpolation */
+#define LIGHTING_COMMAND_FIXED_SHIFT 16
+#define LIGHTING_COMMAND_FIXED_ONE (1L << LIGHTING_COMMAND_FIXED_SHIFT)
+
 typedef struct bacnet_lighting_command_warn_data {
     /* warn */
     float On_Value;
@@ -78,6 +98,8 @@ typedef struct bacnet_lighting_command_data {
     uint32_t Key;
     struct lighting_command_notification Notification_Head;
     struct lighting_command_timer_notification Timer_Notification_Head;
+    /* commands start the transition when it has a callback */
+    struct lighting_command_transition Transition;
 } BACNET_LIGHTING_COMMAND_DATA;
 
 #ifdef __cplusplus
@@ -151,6 +173,28 @@ void lighting_command_timer_notfication_add(
     struct bacnet_lighting_command_data *data,
     struct lighting_command_timer_notification *notification);
 
+BACNET_STACK_EXPORT
+void lighting_command_transition_start(
+    struct lighting_command_transition *transition);
+BACNET_STACK_EXPORT
+void lighting_command_transition_stop(
+    struct lighting_command_transition *transition);
+BACNET_STACK_EXPORT
+bool lighting_command_transition_active(
+    const struct lighting_command_transition *transition);
+BACNET_STACK_EXPORT
+unsigned lighting_command_transition_count(void);
+BACNET_STACK_EXPORT
+void lighting_command_transition_task(uint16_t milliseconds);
+
+BACNET_STACK_EXPORT
+int32_t lighting_command_fixed(float value);
+BACNET_STACK_EXPORT
+float lighting_command_fixed_to_float(int32_t value);
+BACNET_STACK_EXPORT
+int32_t lighting_command_fixed_interpolate(
+    int32_t value, int32_t target, uint32_t elapsed, uint32_t duration);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
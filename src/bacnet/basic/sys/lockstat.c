@@ -0,0 +1,131 @@
+/**
+ * @file
+ * @brief The wait times of the locks, and the depths of the queues, that
+ *  are shared by the threads of a port
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "bacnet/basic/sys/lockstat.h"
+
+/* registered records, most recent first */
+static LOCKSTAT_LOCK *Lock_List;
+static LOCKSTAT_QUEUE *Queue_List;
+
+/**
+ * @brief Add a lock to the list of the exported locks, once
+ * @param lock - statistics of the lock
+ */
+void lockstat_lock_register(LOCKSTAT_LOCK *lock)
+{
+    if (!lock || lock->registered) {
+        return;
+    }
+    lock->next = Lock_List;
+    lock->registered = true;
+    Lock_List = lock;
+}
+
+/**
+ * @brief Record an acquisition of a lock, while it is held
+ * @param lock - statistics of the lock
+ * @param contended - true if the lock was held by another when asked for
+ * @param wait - time waited for the lock, in microseconds
+ */
+void lockstat_lock_record(LOCKSTAT_LOCK *lock, bool contended, uint32_t wait)
+{
+    unsigned bucket = 0;
+
+    if (!lock) {
+        return;
+    }
+    lock->acquisitions++;
+    if (contended) {
+        lock->contended++;
+    }
+    lock->wait_total += wait;
+    if (lock->wait_max < wait) {
+        lock->wait_max = wait;
+    }
+    while (wait && (bucket < (LOCKSTAT_BUCKETS - 1))) {
+        wait >>= 1;
+        bucket++;
+    }
+    lock->wait_histogram[bucket]++;
+}
+
+/**
+ * @brief Get the registered locks
+ * @return the first lock, linked by next to the others, or NULL
+ */
+LOCKSTAT_LOCK *lockstat_locks(void)
+{
+    return Lock_List;
+}
+
+/**
+ * @brief Add a queue to the list of the exported queues, once
+ * @param queue - statistics of the queue
+ */
+void lockstat_queue_register(LOCKSTAT_QUEUE *queue)
+{
+    if (!queue || queue->registered) {
+        return;
+    }
+    queue->next = Queue_List;
+    queue->registered = true;
+    Queue_List = queue;
+}
+
+/**
+ * @brief Record the depth of a queue
+ * @param queue - statistics of the queue
+ * @param depth - number of elements in the queue
+ */
+void lockstat_queue_sample(LOCKSTAT_QUEUE *queue, uint32_t depth)
+{
+    if (!queue) {
+        return;
+    }
+    queue->depth = depth;
+    if (queue->depth_max < depth) {
+        queue->depth_max = depth;
+    }
+    queue->samples++;
+    queue->depth_total += depth;
+}
+
+/**
+ * @brief Get the registered queues
+ * @return the first queue, linked by next to the others, or NULL
+ */
+LOCKSTAT_QUEUE *lockstat_queues(void)
+{
+    return Queue_List;
+}
+
+/**
+ * @brief Clear the statistics of the registered locks and queues, which
+ *  stay registered
+ */
+void lockstat_reset(void)
+{
+    LOCKSTAT_LOCK *lock;
+    LOCKSTAT_QUEUE *queue;
+
+    for (lock = Lock_List; lock; lock = lock->next) {
+        lock->acquisitions = 0;
+        lock->contended = 0;
+        lock->wait_total = 0;
+        lock->wait_max = 0;
+        memset(lock->wait_histogram, 0, sizeof(lock->wait_histogram));
+    }
+    for (queue = Queue_List; queue; queue = queue->next) {
+        queue->depth = 0;
+        queue->depth_max = 0;
+        queue->samples = 0;
+        queue->depth_total = 0;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @brief API for the wait times of the locks, and the depths of the
+ *  queues, that are shared by the threads of a port
+ *
+ * A port times each acquisition of an instrumented lock, and samples the
+ * depth of an instrumented queue when it adds to it, and records them
+ * here.  The records are registered on first use, and are listed by
+ * lockstat_locks() and lockstat_queues() for the metrics exporter.
+ *
+ * The statistics of a lock are recorded while the lock is held, and
+ * those of a queue by its only producer or consumer, so the recording
+ * needs no lock of its own.  The registration is serialized by the
+ * caller.  A reader on another thread may see a count that is being
+ * updated, which is good enough for monitoring.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_LOCKSTAT_H
+#define BACNET_SYS_LOCKSTAT_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of buckets in the wait time histograms.  Bucket 0 counts
+   waits under 1 microsecond, bucket N counts 2^(N-1) to 2^N-1
+   microseconds, and the last bucket also counts all of the longer waits. */
+#ifndef LOCKSTAT_BUCKETS
+#define LOCKSTAT_BUCKETS 24
+#endif
+
+/**
+ * Statistics of one lock
+ *
+ * @{
+ */
+typedef struct lockstat_lock {
+    /** name of the lock, used as the label of its metrics */
+    const char *name;
+    /** acquisitions, and those that found the lock held by another */
+    uint32_t acquisitions;
+    uint32_t contended;
+    /** total and longest wait, in microseconds */
+    uint64_t wait_total;
+    uint32_t wait_max;
+    /** waits, in power-of-two microsecond buckets */
+    uint32_t wait_histogram[LOCKSTAT_BUCKETS];
+    bool registered;
+    struct lockstat_lock *next;
+} LOCKSTAT_LOCK;
+/** @} */
+
+/**
+ * Statistics of one queue
+ *
+ * @{
+ */
+typedef struct lockstat_queue {
+    /** name of the queue, used as the label of its metrics */
+    const char *name;
+    /** number of elements when last sampled, and the most ever sampled */
+    uint32_t depth;
+    uint32_t depth_max;
+    /** number of samples, and the sum of the sampled depths */
+    uint32_t samples;
+    uint64_t depth_total;
+    bool registered;
+    struct lockstat_queue *next;
+} LOCKSTAT_QUEUE;
+/** @} */
+
+/* static initializers of the records, with their names */
+#define LOCKSTAT_LOCK_INIT(name) { (name), 0, 0, 0, 0, { 0 }, false, NULL }
+#define LOCKSTAT_QUEUE_INIT(name) { (name), 0, 0, 0, 0, false, NULL }
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void lockstat_lock_register(LOCKSTAT_LOCK *lock);
+BACNET_STACK_EXPORT
+void lockstat_lock_record(LOCKSTAT_LOCK *lock, bool contended, uint32_t wait);
+BACNET_STACK_EXPORT
+LOCKSTAT_LOCK *lockstat_locks(void);
+
+BACNET_STACK_EXPORT
+void lockstat_queue_register(LOCKSTAT_QUEUE *queue);
+BACNET_STACK_EXPORT
+void lockstat_queue_sample(LOCKSTAT_QUEUE *queue, uint32_t depth);
+BACNET_STACK_EXPORT
+LOCKSTAT_QUEUE *lockstat_queues(void);
+
+BACNET_STACK_EXPORT
+void lockstat_reset(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,389 @@
+/**
+ * @file
+ * @brief Pools of fixed size memory blocks
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/basic/sys/mempool.h"
+
+/* the strictest alignment of the data kept in a block */
+union mempool_align {
+    long long integer;
+    long double real;
+    void *pointer;
+    void (*function)(void);
+};
+#define MEMPOOL_ALIGN sizeof(union mempool_align)
+
+/* a free block holds the link to the next free block */
+struct mempool_block {
+    struct mempool_block *next;
+};
+
+struct mempool_class {
+    struct mempool_block *free_list;
+    MEMPOOL_STATS stats;
+};
+
+/* a freed block too large for a size class, kept for reuse */
+struct mempool_large {
+    struct mempool_large *next;
+    size_t size;
+};
+
+/* one more for the requests too large for a size class */
+static struct mempool_class Pool[MEMPOOL_CLASS_COUNT + 1];
+/* static backing memory that is not yet used by a size class */
+static uint8_t *Static_Memory;
+static size_t Static_Size;
+/* bytes of static backing memory given to the pools */
+static size_t Static_Total;
+/* bytes of the chunks and large blocks taken from the heap */
+static size_t Heap_Bytes;
+static mempool_failure_function Failure_Handler;
+#if defined(BACNET_MEMPOOL_STATIC)
+static union mempool_align Static_Default
+    [(MEMPOOL_STATIC_SIZE + MEMPOOL_ALIGN - 1) / MEMPOOL_ALIGN];
+static bool Static_Default_Used;
+static struct mempool_large *Large_Free_List;
+#endif
+
+/**
+ * @brief Find the size class of a request
+ * @param size - bytes requested
+ * @return index of the size class, or MEMPOOL_CLASS_COUNT if too large
+ */
+static unsigned mempool_class_index(size_t size)
+{
+    size_t block_size = MEMPOOL_CLASS_MIN;
+    unsigned index = 0;
+
+    while ((index < MEMPOOL_CLASS_COUNT) && (block_size < size)) {
+        block_size *= 2;
+        index++;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Take memory for a chunk from the static backing memory
+ * @param size - bytes of the chunk, a multiple of the alignment
+ * @return the chunk, or NULL if there is not enough static memory
+ */
+static void *mempool_static_take(size_t size)
+{
+    void *chunk;
+
+#if defined(BACNET_MEMPOOL_STATIC)
+    if (!Static_Memory && !Static_Default_Used) {
+        Static_Default_Used = true;
+        (void)mempool_init(Static_Default, sizeof(Static_Default));
+    }
+#endif
+    if (!Static_Memory || (size > Static_Size)) {
+        return NULL;
+    }
+    chunk = Static_Memory;
+    Static_Memory += size;
+    Static_Size -= size;
+
+    return chunk;
+}
+
+/**
+ * @brief Add a chunk of blocks to the free list of a size class
+ * @param pool - size class
+ * @return true if the blocks were added
+ */
+static bool mempool_grow(struct mempool_class *pool)
+{
+    size_t block_size = pool->stats.block_size;
+    size_t chunk_size = MEMPOOL_CHUNK_SIZE;
+    struct mempool_block *block;
+    uint8_t *chunk;
+    size_t offset;
+
+    if (chunk_size < block_size) {
+        chunk_size = block_size;
+    }
+    chunk = mempool_static_take(chunk_size);
+#if !defined(BACNET_MEMPOOL_STATIC)
+    if (!chunk) {
+        chunk = malloc(chunk_size);
+        if (chunk) {
+            Heap_Bytes += chunk_size;
+        }
+    }
+#endif
+    if (!chunk) {
+        return false;
+    }
+    for (offset = 0; offset + block_size <= chunk_size;
+         offset += block_size) {
+        block = (struct mempool_block *)(void *)&chunk[offset];
+        block->next = pool->free_list;
+        pool->free_list = block;
+        pool->stats.blocks++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Give static backing memory to the pools.  The chunks of the
+ *  size classes are taken from it before the heap.  Memory given
+ *  earlier, and not yet used, is replaced.
+ * @param memory - static memory that is never freed
+ * @param size - bytes of memory
+ * @return true if the memory can hold at least one block
+ */
+bool mempool_init(void *memory, size_t size)
+{
+    uintptr_t address = (uintptr_t)memory;
+    size_t skip;
+
+    if (!memory) {
+        return false;
+    }
+    skip = (MEMPOOL_ALIGN - (address % MEMPOOL_ALIGN)) % MEMPOOL_ALIGN;
+    if (size < (skip + MEMPOOL_CLASS_MIN)) {
+        return false;
+    }
+    size -= skip;
+    Static_Total -= Static_Size;
+    Static_Memory = (uint8_t *)memory + skip;
+    Static_Size = size - (size % MEMPOOL_ALIGN);
+    Static_Total += Static_Size;
+
+    return true;
+}
+
+#if defined(BACNET_MEMPOOL_STATIC)
+/**
+ * @brief Take a block too large for a size class from the freed large
+ *  blocks, or else from the static backing memory
+ * @param size - bytes requested
+ * @return the zeroed block, or NULL if there is not enough static memory
+ */
+static void *mempool_large_take(size_t size)
+{
+    struct mempool_large **link = &Large_Free_List;
+    struct mempool_large *block;
+
+    size = ((size + MEMPOOL_ALIGN - 1) / MEMPOOL_ALIGN) * MEMPOOL_ALIGN;
+    while (*link) {
+        block = *link;
+        if (block->size >= size) {
+            *link = block->next;
+            memset(block, 0, size);
+            return block;
+        }
+        link = &block->next;
+    }
+    block = mempool_static_take(size);
+    if (block) {
+        memset(block, 0, size);
+    }
+
+    return block;
+}
+
+/**
+ * @brief Keep a freed block too large for a size class for reuse
+ * @param ptr - the block
+ * @param size - bytes that were requested for the block
+ */
+static void mempool_large_give(void *ptr, size_t size)
+{
+    struct mempool_large *block = ptr;
+
+    block->size = ((size + MEMPOOL_ALIGN - 1) / MEMPOOL_ALIGN) * MEMPOOL_ALIGN;
+    block->next = Large_Free_List;
+    Large_Free_List = block;
+}
+#endif
+
+/**
+ * @brief Allocate a block of zeroed memory from the pool of its size
+ *  class, or from the heap if too large for a size class
+ * @param size - bytes requested
+ * @return the memory, or NULL if there is no memory
+ */
+void *mempool_calloc(size_t size)
+{
+    unsigned index = mempool_class_index(size);
+    struct mempool_class *pool = &Pool[index];
+    struct mempool_block *block;
+
+    if (size == 0) {
+        return NULL;
+    }
+    if (index == MEMPOOL_CLASS_COUNT) {
+#if defined(BACNET_MEMPOOL_STATIC)
+        block = mempool_large_take(size);
+#else
+        block = calloc(1, size);
+        if (block) {
+            Heap_Bytes += size;
+        }
+#endif
+        if (!block) {
+            pool->stats.failures++;
+            if (Failure_Handler) {
+                Failure_Handler(size);
+            }
+            return NULL;
+        }
+    } else {
+        if (pool->stats.block_size == 0) {
+            pool->stats.block_size = (size_t)MEMPOOL_CLASS_MIN << index;
+        }
+        if (!pool->free_list && !mempool_grow(pool)) {
+            pool->stats.failures++;
+            if (Failure_Handler) {
+                Failure_Handler(size);
+            }
+            return NULL;
+        }
+        block = pool->free_list;
+        pool->free_list = block->next;
+        memset(block, 0, pool->stats.block_size);
+    }
+    pool->stats.allocations++;
+    pool->stats.used++;
+    if (pool->stats.peak < pool->stats.used) {
+        pool->stats.peak = pool->stats.used;
+    }
+
+    return block;
+}
+
+/**
+ * @brief Return a block of memory to the pool of its size class
+ * @param ptr - memory from mempool_calloc(), or NULL
+ * @param size - bytes that were requested from mempool_calloc()
+ */
+void mempool_free(void *ptr, size_t size)
+{
+    unsigned index = mempool_class_index(size);
+    struct mempool_class *pool = &Pool[index];
+    struct mempool_block *block = ptr;
+
+    if (!block) {
+        return;
+    }
+    if (pool->stats.used) {
+        pool->stats.used--;
+    }
+    if (index == MEMPOOL_CLASS_COUNT) {
+#if defined(BACNET_MEMPOOL_STATIC)
+        mempool_large_give(block, size);
+#else
+        free(block);
+        Heap_Bytes -= size;
+#endif
+    } else {
+        block->next = pool->free_list;
+        pool->free_list = block;
+    }
+}
+
+/**
+ * @brief Change the size of a block of memory from mempool_calloc().
+ *  The block stays in place while the new size is in its size class.
+ * @param ptr - memory from mempool_calloc(), or NULL to allocate
+ * @param old_size - bytes that were requested for the block
+ * @param size - bytes requested, or 0 to free the block
+ * @return the memory, or NULL if there is no memory and the block is kept
+ */
+void *mempool_realloc(void *ptr, size_t old_size, size_t size)
+{
+    unsigned index = mempool_class_index(size);
+    void *block;
+
+    if (!ptr) {
+        return mempool_calloc(size);
+    }
+    if (size == 0) {
+        mempool_free(ptr, old_size);
+        return NULL;
+    }
+    if ((index < MEMPOOL_CLASS_COUNT) &&
+        (index == mempool_class_index(old_size))) {
+        return ptr;
+    }
+    block = mempool_calloc(size);
+    if (!block) {
+        return NULL;
+    }
+    memcpy(block, ptr, (old_size < size) ? old_size : size);
+    mempool_free(ptr, old_size);
+
+    return block;
+}
+
+/**
+ * @brief Set the function that is told of each allocation that fails
+ *  for lack of memory, for example to log it or to reset a controller
+ *  whose memory budget is exceeded
+ * @param function - failure handler, or NULL for none
+ */
+void mempool_failure_handler_set(mempool_failure_function function)
+{
+    Failure_Handler = function;
+}
+
+/**
+ * @brief Get the statistics of a size class
+ * @param class_index - 0 for the smallest size class, up to
+ *  MEMPOOL_CLASS_COUNT for the requests too large for a size class
+ * @param stats - filled with the statistics
+ * @return true if the class index is valid
+ */
+bool mempool_stats(unsigned class_index, MEMPOOL_STATS *stats)
+{
+    if (!stats || (class_index > MEMPOOL_CLASS_COUNT)) {
+        return false;
+    }
+    *stats = Pool[class_index].stats;
+    if (class_index < MEMPOOL_CLASS_COUNT) {
+        stats->block_size = (size_t)MEMPOOL_CLASS_MIN << class_index;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the static backing memory not yet used by a size class
+ * @return number of bytes
+ */
+size_t mempool_static_available(void)
+{
+    return Static_Size;
+}
+
+/**
+ * @brief Add the memory used by the pools to a report.  The static
+ *  backing memory is reported whole, since it is reserved at link time.
+ * @param usage - report to add the memory used by the pools to
+ */
+void mempool_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned index;
+
+#if defined(BACNET_MEMPOOL_STATIC)
+    if (!Static_Memory && !Static_Default_Used) {
+        usage->static_bytes += sizeof(Static_Default);
+    }
+#endif
+    usage->static_bytes += Static_Total;
+    usage->dynamic_bytes += Heap_Bytes;
+    for (index = 0; index <= MEMPOOL_CLASS_COUNT; index++) {
+        usage->count += (unsigned)Pool[index].stats.used;
+    }
+}
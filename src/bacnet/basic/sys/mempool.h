@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief API for pools of fixed size memory blocks
+ *
+ * Key list nodes and object descriptors are small allocations of a few
+ * fixed sizes that are created and deleted for the life of a device.
+ * Allocating each one from the heap fragments it, and the time to find
+ * a free block is unpredictable.  A memory pool instead rounds each
+ * request up to a size class, and keeps a free list of blocks for each
+ * class.  A class grows a chunk at a time, from static backing memory
+ * given to mempool_init() first, and then from the heap.  Blocks are
+ * returned to their free list, not to the heap.
+ *
+ * With BACNET_MEMPOOL_STATIC, the chunks only come from static backing
+ * memory - a built-in array of MEMPOOL_STATIC_SIZE bytes unless other
+ * memory is given to mempool_init() - so the pools never use the heap.
+ * The requests too large for a size class are also taken from the static
+ * memory, and a freed one is kept for a later request of its size or
+ * smaller.  This is the heap-free build profile: the object descriptors,
+ * key lists, file object strings, audit log records, discovered device
+ * data and BACnet/SC queues all come from the pools, and so do the stack
+ * contexts, the COV subscriptions, the device timers, the Device object
+ * indexes, caches and snapshot, the dense values, the pooled strings, the
+ * value buffers, the command plans and the client data stores.  The RAM
+ * used by the stack is then fixed at link time.  A request that the static
+ * memory cannot hold fails, is counted, and is passed to the failure
+ * handler set with mempool_failure_handler_set() before NULL is returned.
+ * The options that grow on the heap, or that allocate from several
+ * threads, are refused by config.h in this profile.  The file system in
+ * bramfs.c, the UCI configuration in ucix.c, the VMAC tables and the
+ * client ReadProperty and ReadPropertyMultiple acknowledgement lists still
+ * use the heap, so they are left out of a heap-free build.
+ *
+ * Static RAM of the heap-free profile, with the default sizes:
+ *
+ *   size class | block size | blocks in a chunk of MEMPOOL_CHUNK_SIZE
+ *   -----------+------------+----------------------------------------
+ *            0 |         16 | 256
+ *            1 |         32 | 128
+ *            2 |         64 |  64
+ *            3 |        128 |  32
+ *            4 |        256 |  16
+ *            5 |        512 |   8
+ *            6 |       1024 |   4
+ *            7 |       2048 |   2
+ *            8 |       4096 |   1
+ *      (large) |      exact | taken alone from the static memory
+ *
+ *   static backing memory  MEMPOOL_STATIC_SIZE         65536 bytes
+ *   pool bookkeeping       10 * sizeof(MEMPOOL_STATS)  about 600 bytes
+ *
+ * Each class takes whole chunks from the static memory as it first needs
+ * them, and never gives them back to the other classes, so the static
+ * memory must hold a chunk for each class in use plus the large blocks.
+ * Size MEMPOOL_STATIC_SIZE from the peak blocks of each class reported by
+ * mempool_stats() - or by mempool_memory_usage() in the memory report of
+ * the device - after running the application with its full object
+ * database: the sum of the peak blocks of each class, rounded up to whole
+ * chunks and multiplied by the chunk size, plus the large requests.
+ *
+ * The pools are not thread safe, like the rest of the basic stack.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_MEMPOOL_H
+#define BACNET_SYS_MEMPOOL_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+#include "bacnet/basic/sys/memusage.h"
+
+#if defined(BACNET_MEMPOOL_STATIC) && !defined(BACNET_MEMPOOL)
+#define BACNET_MEMPOOL 1
+#endif
+
+/* bytes added to a size class when its free list is empty */
+#ifndef MEMPOOL_CHUNK_SIZE
+#define MEMPOOL_CHUNK_SIZE 4096
+#endif
+
+/* bytes of the built-in static backing memory */
+#ifndef MEMPOOL_STATIC_SIZE
+#define MEMPOOL_STATIC_SIZE (64UL * 1024UL)
+#endif
+
+/* size classes are 16, 32, 64 ... 4096 bytes */
+#define MEMPOOL_CLASS_MIN 16
+#define MEMPOOL_CLASS_COUNT 9
+
+/**
+ * Statistics of one size class, or of the requests that were too
+ * large for any size class
+ *
+ * @{
+ */
+typedef struct mempool_stats {
+    /** size of each block, or 0 for the requests too large for a class */
+    size_t block_size;
+    /** number of blocks that the class owns */
+    unsigned long blocks;
+    /** number of blocks in use */
+    unsigned long used;
+    /** highest number of blocks in use at once */
+    unsigned long peak;
+    /** number of successful allocations */
+    unsigned long allocations;
+    /** number of allocations that failed for lack of memory */
+    unsigned long failures;
+} MEMPOOL_STATS;
+/** @} */
+
+/**
+ * @brief Callback for an allocation that failed for lack of memory
+ * @param size - bytes that were requested
+ */
+typedef void (*mempool_failure_function)(size_t size);
+
+/* Memory for the small fixed size data of the stack - from the pools
+   with BACNET_MEMPOOL, or from the heap otherwise.  The size given to
+   free must be the size given to calloc. */
+#if defined(BACNET_MEMPOOL)
+#define BACNET_MEMPOOL_CALLOC(size) mempool_calloc(size)
+#define BACNET_MEMPOOL_FREE(ptr, size) mempool_free((ptr), (size))
+#define BACNET_MEMPOOL_REALLOC(ptr, old_size, size) \
+    mempool_realloc((ptr), (old_size), (size))
+#else
+#define BACNET_MEMPOOL_CALLOC(size) calloc(1, (size))
+#define BACNET_MEMPOOL_FREE(ptr, size) free(ptr)
+#define BACNET_MEMPOOL_REALLOC(ptr, old_size, size) realloc((ptr), (size))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool mempool_init(void *memory, size_t size);
+
+BACNET_STACK_EXPORT
+void *mempool_calloc(size_t size);
+BACNET_STACK_EXPORT
+void mempool_free(void *ptr, size_t size);
+BACNET_STACK_EXPORT
+void *mempool_realloc(void *ptr, size_t old_size, size_t size);
+
+BACNET_STACK_EXPORT
+void mempool_failure_handler_set(mempool_failure_function function);
+
+BACNET_STACK_EXPORT
+bool mempool_stats(unsigned class_index, MEMPOOL_STATS *stats);
+BACNET_STACK_EXPORT
+size_t mempool_static_available(void);
+BACNET_STACK_EXPORT
+void mempool_memory_usage(BACNET_MEMORY_USAGE *usage);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file
+ * @brief Accounting of the memory used by the modules of the stack
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/memusage.h"
+
+struct memusage_module {
+    const char *name;
+    memusage_function function;
+};
+
+static struct memusage_module Memusage_Modules[MEMUSAGE_MODULES_MAX];
+static unsigned Memusage_Count;
+
+/**
+ * @brief Register the report function of a module.  A function that is
+ *  already registered is not added again, so modules can register each
+ *  time they are initialized.
+ * @param name - name of the module, kept as a pointer
+ * @param function - function that adds the memory used by the module
+ * @return true if the function is registered
+ */
+bool memusage_register(const char *name, memusage_function function)
+{
+    unsigned index;
+
+    if (!function) {
+        return false;
+    }
+    for (index = 0; index < Memusage_Count; index++) {
+        if (Memusage_Modules[index].function == function) {
+            Memusage_Modules[index].name = name;
+            return true;
+        }
+    }
+    if (Memusage_Count >= MEMUSAGE_MODULES_MAX) {
+        return false;
+    }
+    Memusage_Modules[Memusage_Count].name = name;
+    Memusage_Modules[Memusage_Count].function = function;
+    Memusage_Count++;
+
+    return true;
+}
+
+/**
+ * @brief Get the number of modules that report their memory usage
+ * @return number of registered modules
+ */
+unsigned memusage_module_count(void)
+{
+    return Memusage_Count;
+}
+
+/**
+ * @brief Get the memory used by one module
+ * @param index - 0..N of the registered modules
+ * @param name - name of the module, if not NULL
+ * @param usage - memory used by the module, if not NULL
+ * @return true if the module exists
+ */
+bool memusage_module(
+    unsigned index, const char **name, BACNET_MEMORY_USAGE *usage)
+{
+    if (index >= Memusage_Count) {
+        return false;
+    }
+    if (name) {
+        *name = Memusage_Modules[index].name;
+    }
+    if (usage) {
+        usage->static_bytes = 0;
+        usage->dynamic_bytes = 0;
+        usage->count = 0;
+        Memusage_Modules[index].function(usage);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the memory used by all of the registered modules
+ * @param usage - sum of the memory used by the modules
+ */
+void memusage_total(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned index;
+
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes = 0;
+    usage->dynamic_bytes = 0;
+    usage->count = 0;
+    for (index = 0; index < Memusage_Count; index++) {
+        Memusage_Modules[index].function(usage);
+    }
+}
+
+/**
+ * @brief Print the memory used by each registered module, and the total
+ */
+void memusage_debug_print(void)
+{
+    BACNET_MEMORY_USAGE usage = { 0 };
+    const char *name = NULL;
+    unsigned index;
+
+    debug_printf_stdout(
+        "%-32s %10s %10s %8s\n", "module", "static", "dynamic", "count");
+    for (index = 0; index < Memusage_Count; index++) {
+        if (memusage_module(index, &name, &usage)) {
+            debug_printf_stdout(
+                "%-32s %10lu %10lu %8u\n", name ? name : "",
+                (unsigned long)usage.static_bytes,
+                (unsigned long)usage.dynamic_bytes, usage.count);
+        }
+    }
+    memusage_total(&usage);
+    debug_printf_stdout(
+        "%-32s %10lu %10lu %8u\n", "total", (unsigned long)usage.static_bytes,
+        (unsigned long)usage.dynamic_bytes, usage.count);
+}
+
+/**
+ * @brief Forget every registered module
+ */
+void memusage_cleanup(void)
+{
+    unsigned index;
+
+    for (index = 0; index < Memusage_Count; index++) {
+        Memusage_Modules[index].name = NULL;
+        Memusage_Modules[index].function = NULL;
+    }
+    Memusage_Count = 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file
+ * @brief API for accounting the memory used by the modules of the stack
+ *
+ * Each module - an object type, the COV subscriptions, the transaction
+ * state machines, the address cache, a datalink - can report how many
+ * bytes it holds.  Static bytes are reserved at compile time by the
+ * limits of the module, and dynamic bytes are taken from the heap as
+ * objects and entries are created: counts times the size of their
+ * descriptors, plus the heap strings and lists that they own.  The
+ * reports are used to tune the compile time limits of constrained
+ * controllers, and are not meant to be exact to the byte.
+ *
+ * Modules register a report function once, usually when they are
+ * initialized, and the reports are gathered when they are asked for.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_MEMUSAGE_H
+#define BACNET_SYS_MEMUSAGE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of modules that can report their memory usage */
+#ifndef MEMUSAGE_MODULES_MAX
+#define MEMUSAGE_MODULES_MAX 64
+#endif
+
+typedef struct bacnet_memory_usage {
+    /* bytes reserved at compile time */
+    size_t static_bytes;
+    /* bytes taken from the heap */
+    size_t dynamic_bytes;
+    /* number of objects, entries, or buffers in use */
+    unsigned count;
+} BACNET_MEMORY_USAGE;
+
+/**
+ * @brief Callback to add the memory used by a module to a report
+ * @param usage - report to add the memory used by the module to
+ */
+typedef void (*memusage_function)(BACNET_MEMORY_USAGE *usage);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool memusage_register(const char *name, memusage_function function);
+BACNET_STACK_EXPORT
+unsigned memusage_module_count(void);
+BACNET_STACK_EXPORT
+bool memusage_module(
+    unsigned index, const char **name, BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+void memusage_total(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+void memusage_debug_print(void);
+BACNET_STACK_EXPORT
+void memusage_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
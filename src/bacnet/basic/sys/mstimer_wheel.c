@@ -0,0 +1,246 @@
+/**
+ * @file
+ * @brief Timed callbacks on the millisecond timer clock
+ * @details One hierarchical timer wheel, counting in milliseconds, holds
+ * every started event.  The wheel is advanced by the time since the
+ * previous mstimer_wheel_task() call, so an event that is started in
+ * between is placed that much further into the wheel.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <limits.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/mstimer_wheel.h"
+
+static struct timer_wheel Event_Wheel;
+static bool Event_Wheel_Initialized;
+/* mstimer_now() of the previous mstimer_wheel_task() call */
+static unsigned long Event_Wheel_Time;
+
+/**
+ * @brief Get the timer wheel that holds the events
+ * @return the timer wheel, counting in milliseconds
+ */
+static struct timer_wheel *mstimer_wheel(void)
+{
+    if (!Event_Wheel_Initialized) {
+        mstimer_wheel_init();
+    }
+
+    return &Event_Wheel;
+}
+
+/**
+ * @brief Get the milliseconds since the wheel was last advanced
+ * @return milliseconds that the wheel lags behind mstimer_now()
+ */
+static unsigned long mstimer_wheel_lag(void)
+{
+    return mstimer_now() - Event_Wheel_Time;
+}
+
+/**
+ * @brief Put an event into the wheel
+ * @param event - event to put into the wheel
+ * @param milliseconds - time from now until the event is due
+ */
+static void mstimer_wheel_event_add(
+    struct mstimer_wheel_event *event, unsigned long milliseconds)
+{
+    struct timer_wheel *wheel = mstimer_wheel();
+    unsigned long ticks;
+
+    ticks = milliseconds + mstimer_wheel_lag();
+    if ((ticks < milliseconds) || (ticks > UINT32_MAX)) {
+        ticks = UINT32_MAX;
+    }
+    timer_wheel_add(wheel, &event->node, (uint32_t)ticks);
+}
+
+/**
+ * @brief Initialize an event that is not started
+ * @param event - event to initialize
+ * @param callback - function called when the event is due
+ * @param context - data for the callback, kept in the event
+ */
+void mstimer_wheel_event_init(
+    struct mstimer_wheel_event *event,
+    mstimer_wheel_callback_function callback,
+    void *context)
+{
+    if (event) {
+        timer_wheel_node_init(&event->node);
+        event->callback = callback;
+        event->context = context;
+        event->interval = 0;
+        event->start = 0;
+        event->due = 0;
+    }
+}
+
+/**
+ * @brief Start a one-shot event, replacing any pending time of the event
+ * @note An event started with zero milliseconds from a callback runs in
+ *  the same mstimer_wheel_task() call.
+ * @param event - event to start
+ * @param milliseconds - time from now until the event is due
+ */
+void mstimer_wheel_event_start(
+    struct mstimer_wheel_event *event, unsigned long milliseconds)
+{
+    if (event) {
+        event->interval = 0;
+        event->start = mstimer_now();
+        mstimer_wheel_event_add(event, milliseconds);
+    }
+}
+
+/**
+ * @brief Start a periodic event, replacing any pending time of the event.
+ *  Like mstimer_reset(), each period starts when the previous one was
+ *  due, so a late callback does not delay the ones after it.
+ * @param event - event to start
+ * @param interval - milliseconds between the callbacks, or zero to stop
+ */
+void mstimer_wheel_event_periodic(
+    struct mstimer_wheel_event *event, unsigned long interval)
+{
+    if (!event) {
+        return;
+    }
+    if (interval == 0) {
+        mstimer_wheel_event_stop(event);
+        return;
+    }
+    event->interval = interval;
+    event->start = mstimer_now();
+    event->due = event->start + interval;
+    mstimer_wheel_event_add(event, interval);
+}
+
+/**
+ * @brief Stop an event so that its callback is not called
+ * @param event - event to stop
+ */
+void mstimer_wheel_event_stop(struct mstimer_wheel_event *event)
+{
+    if (event) {
+        timer_wheel_remove(mstimer_wheel(), &event->node);
+        event->interval = 0;
+    }
+}
+
+/**
+ * @brief Determine if an event is started and its callback not yet called
+ * @param event - event
+ * @return true if the event is pending
+ */
+bool mstimer_wheel_event_pending(const struct mstimer_wheel_event *event)
+{
+    return event && timer_wheel_pending(&event->node);
+}
+
+/**
+ * @brief Get the time until an event is due
+ * @param event - event
+ * @return milliseconds until the event is due, or zero if it is due or
+ *  not pending
+ */
+unsigned long
+mstimer_wheel_event_remaining(const struct mstimer_wheel_event *event)
+{
+    struct timer_wheel *wheel = mstimer_wheel();
+    unsigned long remaining, lag;
+
+    if (!mstimer_wheel_event_pending(event) ||
+        ((int32_t)(event->node.expires - timer_wheel_now(wheel)) <= 0)) {
+        return 0;
+    }
+    remaining = event->node.expires - timer_wheel_now(wheel);
+    lag = mstimer_wheel_lag();
+    if (remaining <= lag) {
+        return 0;
+    }
+
+    return remaining - lag;
+}
+
+/**
+ * @brief Run the callbacks of the events that are due.  Call once from
+ *  each pass of the main loop, or when mstimer_wheel_next() runs out.
+ * @return number of callbacks that were called
+ */
+unsigned mstimer_wheel_task(void)
+{
+    struct timer_wheel *wheel = mstimer_wheel();
+    struct timer_wheel_node *node;
+    struct mstimer_wheel_event *event;
+    unsigned long now, elapsed;
+    unsigned count = 0;
+
+    now = mstimer_now();
+    elapsed = now - Event_Wheel_Time;
+    Event_Wheel_Time = now;
+    while (elapsed > UINT32_MAX) {
+        timer_wheel_advance(wheel, UINT32_MAX);
+        elapsed -= UINT32_MAX;
+    }
+    timer_wheel_advance(wheel, (uint32_t)elapsed);
+    while ((node = timer_wheel_expired(wheel)) != NULL) {
+        event = (struct mstimer_wheel_event *)node;
+        elapsed = now - event->start;
+        event->start = now;
+        if (event->interval) {
+            event->due += event->interval;
+            if ((long)(event->due - now) <= 0) {
+                /* more than a period behind - start over from now */
+                event->due = now + event->interval;
+            }
+            mstimer_wheel_event_add(event, event->due - now);
+        }
+        if (event->callback) {
+            event->callback(event, elapsed);
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Get the time until the next event is due, for example to sleep
+ *  until then
+ * @return milliseconds until the next event, zero if one is due, or
+ *  ULONG_MAX if no event is pending
+ */
+unsigned long mstimer_wheel_next(void)
+{
+    uint32_t next;
+    unsigned long lag;
+
+    next = timer_wheel_next(mstimer_wheel());
+    if (next == UINT32_MAX) {
+        return ULONG_MAX;
+    }
+    lag = mstimer_wheel_lag();
+    if (next <= lag) {
+        return 0;
+    }
+
+    return next - lag;
+}
+
+/**
+ * @brief Initialize the wheel with no pending events
+ * @note Called automatically by the first use of the wheel.  Calling it
+ *  again forgets the pending events, which must then be initialized with
+ *  mstimer_wheel_event_init() before they are started again.
+ */
+void mstimer_wheel_init(void)
+{
+    timer_wheel_init(&Event_Wheel);
+    Event_Wheel_Time = mstimer_now();
+    Event_Wheel_Initialized = true;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief API for timed callbacks on the millisecond timer clock
+ *
+ * Modules that need to run something later register an event instead of
+ * polling their own struct mstimer.  The events are kept in one
+ * hierarchical timer wheel that counts mstimer_now() milliseconds, so
+ * starting or stopping an event takes constant time, and one call to
+ * mstimer_wheel_task() from the main loop runs the callbacks that are
+ * due and nothing else.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_MSTIMER_WHEEL_H
+#define BACNET_SYS_MSTIMER_WHEEL_H
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/sys/timer_wheel.h"
+
+struct mstimer_wheel_event;
+/**
+ * Callback for an event that is due
+ * @param event - the event, whose context is available to the callback
+ * @param elapsed - milliseconds since the event was started, or since
+ *  the previous callback of a periodic event
+ */
+typedef void (*mstimer_wheel_callback_function)(
+    struct mstimer_wheel_event *event, unsigned long elapsed);
+
+/**
+ * Timed event - embed in the data that owns it, or declare it static
+ *
+ * @{
+ */
+struct mstimer_wheel_event {
+    /** first member, so that the node is the event */
+    struct timer_wheel_node node;
+    mstimer_wheel_callback_function callback;
+    void *context;
+    /** period of a periodic event, or zero for a one-shot event */
+    unsigned long interval;
+    /** mstimer_now() when the event was started, or of the previous
+        callback of a periodic event */
+    unsigned long start;
+    /** mstimer_now() when the current period of a periodic event ends */
+    unsigned long due;
+};
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void mstimer_wheel_event_init(
+    struct mstimer_wheel_event *event,
+    mstimer_wheel_callback_function callback,
+    void *context);
+BACNET_STACK_EXPORT
+void mstimer_wheel_event_start(
+    struct mstimer_wheel_event *event, unsigned long milliseconds);
+BACNET_STACK_EXPORT
+void mstimer_wheel_event_periodic(
+    struct mstimer_wheel_event *event, unsigned long interval);
+BACNET_STACK_EXPORT
+void mstimer_wheel_event_stop(struct mstimer_wheel_event *event);
+BACNET_STACK_EXPORT
+bool mstimer_wheel_event_pending(const struct mstimer_wheel_event *event);
+BACNET_STACK_EXPORT
+unsigned long
+mstimer_wheel_event_remaining(const struct mstimer_wheel_event *event);
+
+BACNET_STACK_EXPORT
+unsigned mstimer_wheel_task(void);
+BACNET_STACK_EXPORT
+unsigned long mstimer_wheel_next(void);
+BACNET_STACK_EXPORT
+void mstimer_wheel_init(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @brief A PDU buffer with headroom for the lower layer headers
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bacnet/basic/sys/pbuf.h"
+
+/**
+ * @brief Initialize a PDU buffer with no data
+ * @param p - PDU buffer
+ * @param buffer - block of memory for the headroom and the data
+ * @param size - size of the block of memory, in bytes
+ * @param headroom - bytes kept in front of the data for headers
+ * @return true if the buffer is initialized
+ */
+bool pbuf_init(
+    BACNET_PBUF *p, uint8_t *buffer, uint16_t size, uint16_t headroom)
+{
+    if (!p || !buffer || (headroom > size)) {
+        return false;
+    }
+    p->buffer = buffer;
+    p->size = size;
+    p->offset = headroom;
+    p->length = 0;
+
+    return true;
+}
+
+/**
+ * @brief Get the data of a PDU buffer
+ * @param p - PDU buffer
+ * @return the first byte of the data, or NULL if not initialized
+ */
+uint8_t *pbuf_data(const BACNET_PBUF *p)
+{
+    if (!p || !p->buffer) {
+        return NULL;
+    }
+
+    return &p->buffer[p->offset];
+}
+
+/**
+ * @brief Get the number of bytes of data in a PDU buffer
+ * @param p - PDU buffer
+ * @return number of bytes of data
+ */
+uint16_t pbuf_length(const BACNET_PBUF *p)
+{
+    return p ? p->length : 0;
+}
+
+/**
+ * @brief Get the room in front of the data for headers
+ * @param p - PDU buffer
+ * @return number of bytes that can be prepended
+ */
+uint16_t pbuf_headroom(const BACNET_PBUF *p)
+{
+    return p ? p->offset : 0;
+}
+
+/**
+ * @brief Get the room after the data
+ * @param p - PDU buffer
+ * @return number of bytes that can be appended
+ */
+uint16_t pbuf_tailroom(const BACNET_PBUF *p)
+{
+    if (!p) {
+        return 0;
+    }
+
+    return p->size - p->offset - p->length;
+}
+
+/**
+ * @brief Get where the next appended byte goes, for encoding in place
+ *  before pbuf_append() adds the encoded bytes to the data
+ * @param p - PDU buffer
+ * @return the byte after the data, or NULL if not initialized
+ */
+uint8_t *pbuf_tail(const BACNET_PBUF *p)
+{
+    if (!p || !p->buffer) {
+        return NULL;
+    }
+
+    return &p->buffer[p->offset + p->length];
+}
+
+/**
+ * @brief Add room for a header in front of the data
+ * @param p - PDU buffer
+ * @param length - number of bytes of the header
+ * @return the first byte of the header, which is now the first byte of
+ *  the data, or NULL if there is not enough headroom
+ */
+uint8_t *pbuf_prepend(BACNET_PBUF *p, uint16_t length)
+{
+    if (!p || !p->buffer || (length > p->offset)) {
+        return NULL;
+    }
+    p->offset -= length;
+    p->length += length;
+
+    return &p->buffer[p->offset];
+}
+
+/**
+ * @brief Add bytes to the end of the data
+ * @param p - PDU buffer
+ * @param length - number of bytes to add
+ * @return the first added byte, or NULL if there is not enough tailroom
+ */
+uint8_t *pbuf_append(BACNET_PBUF *p, uint16_t length)
+{
+    uint8_t *tail;
+
+    if (length > pbuf_tailroom(p)) {
+        return NULL;
+    }
+    tail = pbuf_tail(p);
+    if (tail) {
+        p->length += length;
+    }
+
+    return tail;
+}
+
+/**
+ * @brief Remove a header from the front of the data, giving its bytes
+ *  back to the headroom
+ * @param p - PDU buffer
+ * @param length - number of bytes of the header
+ * @return true if the header was removed
+ */
+bool pbuf_remove_header(BACNET_PBUF *p, uint16_t length)
+{
+    if (!p || (length > p->length)) {
+        return false;
+    }
+    p->offset += length;
+    p->length -= length;
+
+    return true;
+}
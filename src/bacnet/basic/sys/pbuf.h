@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief API for a PDU buffer with headroom for the lower layer headers
+ *
+ * Unlike the flat buffers that each layer copies into its own larger
+ * buffer, a PDU buffer keeps unused room in front of its data.  An upper
+ * layer encodes its PDU after the headroom, and each lower layer then
+ * prepends its header in place, so the finished message is contiguous
+ * without copying the PDU again.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_PBUF_H
+#define BACNET_SYS_PBUF_H
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/**
+ * PDU buffer - the data is buffer[offset] to buffer[offset + length - 1]
+ *
+ * @{
+ */
+typedef struct bacnet_pbuf_t {
+    /** block of memory for the headroom, data, and tailroom */
+    uint8_t *buffer;
+    /** size of the block of memory, in bytes */
+    uint16_t size;
+    /** start of the data - the bytes before it are the headroom */
+    uint16_t offset;
+    /** number of bytes of data */
+    uint16_t length;
+} BACNET_PBUF;
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool pbuf_init(
+    BACNET_PBUF *p, uint8_t *buffer, uint16_t size, uint16_t headroom);
+
+BACNET_STACK_EXPORT
+uint8_t *pbuf_data(const BACNET_PBUF *p);
+BACNET_STACK_EXPORT
+uint16_t pbuf_length(const BACNET_PBUF *p);
+BACNET_STACK_EXPORT
+uint16_t pbuf_headroom(const BACNET_PBUF *p);
+BACNET_STACK_EXPORT
+uint16_t pbuf_tailroom(const BACNET_PBUF *p);
+BACNET_STACK_EXPORT
+uint8_t *pbuf_tail(const BACNET_PBUF *p);
+
+BACNET_STACK_EXPORT
+uint8_t *pbuf_prepend(BACNET_PBUF *p, uint16_t length);
+BACNET_STACK_EXPORT
+uint8_t *pbuf_append(BACNET_PBUF *p, uint16_t length);
+BACNET_STACK_EXPORT
+bool pbuf_remove_header(BACNET_PBUF *p, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
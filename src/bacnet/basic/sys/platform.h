@@ -102,4 +102,25 @@ __inline int c99_snprintf(char *outBuf, size_t size, const char *format, ...)
 #define BACNET_STACK_FALLTHROUGH() /* fall through */
 #endif
 
+/* storage class of a variable that each thread has its own copy of */
+#ifndef BACNET_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define BACNET_THREAD_LOCAL __declspec(thread)
+#elif defined(__cplusplus) && (__cplusplus >= 201103L)
+#define BACNET_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define BACNET_THREAD_LOCAL _Thread_local
+#else
+#define BACNET_THREAD_LOCAL __thread
+#endif
+#endif
+
+/* storage class of the selected stack context, so that each thread can
+   run its own stack context */
+#if defined(BACNET_STACK_CONTEXT_THREADS)
+#define BACNET_STACK_THREAD_LOCAL BACNET_THREAD_LOCAL
+#else
+#define BACNET_STACK_THREAD_LOCAL
+#endif
+
 #endif
@@ -0,0 +1,28 @@
+/**
+ * @file
+ * @brief Find the active slots of a BACnet priority array
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include "bacnet/basic/sys/bits.h"
+#include "bacnet/basic/sys/priority_array.h"
+
+/**
+ * @brief Find the highest active priority at or below a given priority
+ * @param active_bits - priority-array active slots, bit 0 is priority 1
+ * @param priority - first priority 1..16 to consider
+ * @return active priority 1..16, or 0 if no priority is active
+ */
+uint8_t Priority_Active_Next(uint16_t active_bits, unsigned priority)
+{
+    if (priority == 0) {
+        priority = 1;
+    }
+    for (; priority <= BACNET_MAX_PRIORITY; priority++) {
+        if (BIT_CHECK(active_bits, priority - 1)) {
+            return (uint8_t)priority;
+        }
+    }
+
+    return 0;
+}
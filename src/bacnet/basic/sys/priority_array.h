@@ -0,0 +1,27 @@
+/**
+ * @file
+ * @brief API for the active slots of a BACnet priority array
+ *
+ * Commandable objects keep one bit for each of the 16 slots of their
+ * Priority_Array, set while the slot holds a value, so that the active
+ * priority is found without reading the slots themselves.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_PRIORITY_ARRAY_H
+#define BACNET_SYS_PRIORITY_ARRAY_H
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+uint8_t Priority_Active_Next(uint16_t active_bits, unsigned priority);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
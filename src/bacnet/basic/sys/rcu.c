@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Read-copy-update publication of read-mostly data
+ * @details A reader takes the phase of the domain, counts itself into
+ *  that phase, and then checks that the phase did not change meanwhile,
+ *  or else it counts itself out and tries again.  So a grace period that
+ *  moves the domain to the other phase and sees the count of the old
+ *  phase at zero knows that no reader can still hold a pointer that was
+ *  replaced before the move.  All of the operations are sequentially
+ *  consistent, which keeps the argument simple; a read section costs an
+ *  atomic increment, an atomic decrement, and two loads.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "bacnet/basic/sys/rcu.h"
+
+#if defined(RCU_C11)
+#define RCU_INIT(p, v) atomic_init((p), (v))
+#define RCU_LOAD(p) atomic_load((p))
+#define RCU_STORE(p, v) atomic_store((p), (v))
+#define RCU_ADD(p, v) atomic_fetch_add((p), (v))
+#define RCU_SUB(p, v) atomic_fetch_sub((p), (v))
+#define RCU_EXCHANGE(p, v) atomic_exchange((p), (v))
+#elif defined(RCU_SUPPORTED)
+#define RCU_INIT(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define RCU_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define RCU_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define RCU_ADD(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define RCU_SUB(p, v) __atomic_fetch_sub((p), (v), __ATOMIC_SEQ_CST)
+#define RCU_EXCHANGE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#else
+#define RCU_INIT(p, v) (*(p) = (v))
+#define RCU_LOAD(p) (*(p))
+#define RCU_STORE(p, v) (*(p) = (v))
+#define RCU_ADD(p, v) (*(p) += (v))
+#define RCU_SUB(p, v) (*(p) -= (v))
+#endif
+
+/**
+ * @brief Initialize a domain with no readers
+ * @param domain - domain to initialize
+ */
+void rcu_init(RCU_DOMAIN *domain)
+{
+    if (domain) {
+        RCU_INIT(&domain->phase, 0);
+        RCU_INIT(&domain->readers[0], 0);
+        RCU_INIT(&domain->readers[1], 0);
+    }
+}
+
+/**
+ * @brief Enter a read section.  Pointers loaded with rcu_dereference()
+ *  stay valid until the matching rcu_read_unlock().
+ * @param domain - domain of the data that is read
+ * @return the phase to give to rcu_read_unlock()
+ */
+unsigned rcu_read_lock(RCU_DOMAIN *domain)
+{
+    unsigned phase;
+
+    for (;;) {
+        phase = RCU_LOAD(&domain->phase);
+        RCU_ADD(&domain->readers[phase & 1], 1);
+        if (RCU_LOAD(&domain->phase) == phase) {
+            break;
+        }
+        /* a grace period started meanwhile - join the new phase */
+        RCU_SUB(&domain->readers[phase & 1], 1);
+    }
+
+    return phase;
+}
+
+/**
+ * @brief Leave a read section
+ * @param domain - domain of the data that was read
+ * @param phase - the phase returned by rcu_read_lock()
+ */
+void rcu_read_unlock(RCU_DOMAIN *domain, unsigned phase)
+{
+    RCU_SUB(&domain->readers[phase & 1], 1);
+}
+
+/**
+ * @brief Load a published pointer inside a read section
+ * @param pointer - the published pointer
+ * @return the data, or NULL if none was published
+ */
+void *rcu_dereference(RCU_POINTER *pointer)
+{
+    return RCU_LOAD(pointer);
+}
+
+/**
+ * @brief Wait until every reader that was in a read section when this was
+ *  called has left it
+ * @param domain - domain of the readers
+ */
+void rcu_synchronize(RCU_DOMAIN *domain)
+{
+    unsigned phase;
+
+    phase = RCU_LOAD(&domain->phase);
+    RCU_STORE(&domain->phase, phase + 1);
+    while (RCU_LOAD(&domain->readers[phase & 1]) != 0) {
+        /* the read sections are short - spin */
+    }
+}
+
+/**
+ * @brief Publish new data for the readers, and wait for the grace period
+ *  of the data it replaces
+ * @param domain - domain of the readers
+ * @param pointer - the published pointer
+ * @param data - the new data, or NULL to withdraw it
+ * @return the replaced data, which no reader holds any more and which the
+ *  caller may free, or NULL
+ */
+void *rcu_publish(RCU_DOMAIN *domain, RCU_POINTER *pointer, void *data)
+{
+    void *old_data;
+
+#if defined(RCU_SUPPORTED)
+    old_data = RCU_EXCHANGE(pointer, data);
+#else
+    old_data = *pointer;
+    *pointer = data;
+#endif
+    if (old_data) {
+        rcu_synchronize(domain);
+    }
+
+    return old_data;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief API for read-copy-update publication of read-mostly data
+ *
+ * Data that is read often and changed rarely, such as the Object_List of
+ * the Device object, can be read by many threads without a lock.  A
+ * writer builds a new copy of the data and publishes a pointer to it.
+ * Readers load the pointer inside a read section and see either the old
+ * or the new copy, but always a whole one.  Once the pointer is replaced,
+ * the writer waits for a grace period - until every reader that could
+ * still hold the old copy has left its read section - and then frees it.
+ *
+ * Readers count themselves into one of two phases of a domain.  A grace
+ * period moves the domain to the other phase and waits for the count of
+ * the old phase to reach zero.  Writers of a domain must be serialized by
+ * the caller, and must not wait for a grace period from inside a read
+ * section of the same domain.
+ *
+ * Without atomic operations the domain is only for a single thread.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_RCU_H
+#define BACNET_SYS_RCU_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define RCU_C11 1
+#define RCU_SUPPORTED 1
+typedef atomic_uint RCU_ATOMIC_COUNT;
+typedef _Atomic(void *) RCU_POINTER;
+#elif defined(__GNUC__) || defined(__clang__)
+/* the __atomic builtins of GCC and clang in C99 and earlier */
+#define RCU_SUPPORTED 1
+typedef unsigned RCU_ATOMIC_COUNT;
+typedef void *RCU_POINTER;
+#else
+typedef unsigned RCU_ATOMIC_COUNT;
+typedef void *RCU_POINTER;
+#endif
+
+/**
+ * read-copy-update domain - zero initialized, or by rcu_init()
+ *
+ * @{
+ */
+typedef struct rcu_domain {
+    /** the phase that new readers count themselves into, in bit 0 */
+    RCU_ATOMIC_COUNT phase;
+    /** number of readers in each phase */
+    RCU_ATOMIC_COUNT readers[2];
+} RCU_DOMAIN;
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void rcu_init(RCU_DOMAIN *domain);
+
+/* readers */
+BACNET_STACK_EXPORT
+unsigned rcu_read_lock(RCU_DOMAIN *domain);
+BACNET_STACK_EXPORT
+void rcu_read_unlock(RCU_DOMAIN *domain, unsigned phase);
+BACNET_STACK_EXPORT
+void *rcu_dereference(RCU_POINTER *pointer);
+
+/* writers */
+BACNET_STACK_EXPORT
+void *rcu_publish(RCU_DOMAIN *domain, RCU_POINTER *pointer, void *data);
+BACNET_STACK_EXPORT
+void rcu_synchronize(RCU_DOMAIN *domain);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
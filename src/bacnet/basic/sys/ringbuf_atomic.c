@@ -0,0 +1,398 @@
+/**
+ * @file
+ * @brief Lock-free ring buffer shared between threads
+ * @details Bounded ring buffer of fixed size elements for one or more
+ * producers and one consumer.  The element_count is a power of two, and
+ * the head and tail count elements from zero without wrapping at the
+ * element_count, so that the unsigned difference between them is the
+ * number of elements reserved.  The sequence number of a cell is the
+ * head position after the element in the cell was published.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <limits.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/basic/sys/ringbuf_atomic.h"
+
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+#if defined(RINGBUF_ATOMIC_C11)
+#define RING_INIT(p, v) atomic_init((p), (v))
+#define RING_LOAD_RELAXED(p) atomic_load_explicit((p), memory_order_relaxed)
+#define RING_LOAD_ACQUIRE(p) atomic_load_explicit((p), memory_order_acquire)
+#define RING_STORE_RELAXED(p, v) \
+    atomic_store_explicit((p), (v), memory_order_relaxed)
+#define RING_STORE_RELEASE(p, v) \
+    atomic_store_explicit((p), (v), memory_order_release)
+#define RING_CAS(p, expected, desired)                    \
+    atomic_compare_exchange_weak_explicit(                \
+        (p), (expected), (desired), memory_order_relaxed, \
+        memory_order_relaxed)
+#else
+#define RING_INIT(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define RING_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RING_CAS(p, expected, desired)                      \
+    __atomic_compare_exchange_n(                            \
+        (p), (expected), (desired), true, __ATOMIC_RELAXED, \
+        __ATOMIC_RELAXED)
+#endif
+
+/**
+ * @brief Get the sequence number of the cell of a position
+ * @param b - pointer to RING_BUFFER_ATOMIC structure
+ * @param position - head or tail position
+ * @return pointer to the sequence number of the cell
+ */
+static RINGBUF_ATOMIC_INDEX *
+Ringbuf_Atomic_Sequence(const RING_BUFFER_ATOMIC *b, unsigned position)
+{
+    size_t offset;
+
+    offset = (size_t)(position & (b->element_count - 1)) * b->cell_size;
+
+    return (RINGBUF_ATOMIC_INDEX *)(void *)&b->buffer[offset];
+}
+
+/**
+ * @brief Get the element of the cell of a position
+ * @param b - pointer to RING_BUFFER_ATOMIC structure
+ * @param position - head or tail position
+ * @return pointer to the element of the cell
+ */
+static uint8_t *
+Ringbuf_Atomic_Element(const RING_BUFFER_ATOMIC *b, unsigned position)
+{
+    return (uint8_t *)Ringbuf_Atomic_Sequence(b, position) +
+        sizeof(RINGBUF_ATOMIC_INDEX);
+}
+
+/**
+ * @brief Reserve up to count cells for a producer
+ * @param b - pointer to RING_BUFFER_ATOMIC structure
+ * @param count - number of cells wanted
+ * @param position - filled with the position of the first cell reserved
+ * @return number of cells reserved, which is zero when the ring is full
+ */
+static unsigned Ringbuf_Atomic_Reserve(
+    RING_BUFFER_ATOMIC *b, unsigned count, unsigned *position)
+{
+    unsigned head, tail, space;
+
+    head = RING_LOAD_RELAXED(&b->head);
+    for (;;) {
+        /* the consumer moves the tail after it copied the element */
+        tail = RING_LOAD_ACQUIRE(&b->tail);
+        space = b->element_count - (head - tail);
+        if (space > b->element_count) {
+            /* head is older than tail - another producer moved on */
+            head = RING_LOAD_RELAXED(&b->head);
+            continue;
+        }
+        if (count > space) {
+            count = space;
+        }
+        if (count == 0) {
+            return 0;
+        }
+        if (!b->multi_producer) {
+            RING_STORE_RELAXED(&b->head, head + count);
+            break;
+        }
+        if (RING_CAS(&b->head, &head, head + count)) {
+            break;
+        }
+    }
+    *position = head;
+
+    return count;
+}
+
+/**
+ * @brief Publish a cell that a producer has filled
+ * @param b - pointer to RING_BUFFER_ATOMIC structure
+ * @param position - position of the cell
+ */
+static void Ringbuf_Atomic_Publish(RING_BUFFER_ATOMIC *b, unsigned position)
+{
+    RING_STORE_RELEASE(Ringbuf_Atomic_Sequence(b, position), position + 1);
+}
+
+/**
+ * Configures the ring buffer.  Note that the element_count parameter
+ * must be a power of two.
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  buffer - buffer of RINGBUF_ATOMIC_BUFFER_SIZE() bytes, aligned
+ *  for RINGBUF_ATOMIC_INDEX
+ * @param  buffer_size - size of the buffer
+ * @param  element_size - size of one element
+ * @param  element_count - number of elements
+ * @param  multi_producer - true if more than one thread puts elements
+ * @return  true if ring buffer was initialized
+ */
+bool Ringbuf_Atomic_Initialize(
+    RING_BUFFER_ATOMIC *b,
+    void *buffer,
+    size_t buffer_size,
+    unsigned element_size,
+    unsigned element_count,
+    bool multi_producer)
+{
+    unsigned i;
+
+    if (!b || !buffer || (element_size == 0) || (element_count == 0) ||
+        (element_count & (element_count - 1)) ||
+        (element_count > (UINT_MAX / 2)) ||
+        (((uintptr_t)buffer % sizeof(RINGBUF_ATOMIC_INDEX)) != 0) ||
+        (buffer_size <
+         RINGBUF_ATOMIC_BUFFER_SIZE(element_size, element_count))) {
+        return false;
+    }
+    b->buffer = buffer;
+    b->element_size = element_size;
+    b->cell_size = RINGBUF_ATOMIC_CELL_SIZE(element_size);
+    b->element_count = element_count;
+    b->multi_producer = multi_producer;
+    RING_INIT(&b->head, 0);
+    RING_INIT(&b->tail, 0);
+    for (i = 0; i < element_count; i++) {
+        /* as if published one lap before the first */
+        RING_INIT(Ringbuf_Atomic_Sequence(b, i), i + 1 - element_count);
+    }
+
+    return true;
+}
+
+/**
+ * Returns the number of elements reserved by producers and not yet
+ * removed by the consumer - a snapshot when other threads are running
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return Number of elements in the ring buffer
+ */
+unsigned Ringbuf_Atomic_Count(RING_BUFFER_ATOMIC *b)
+{
+    unsigned tail;
+
+    if (!b) {
+        return 0;
+    }
+    tail = RING_LOAD_ACQUIRE(&b->tail);
+
+    return RING_LOAD_ACQUIRE(&b->head) - tail;
+}
+
+/**
+ * Returns the capacity of the ring buffer
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return Number of elements that the ring buffer holds
+ */
+unsigned Ringbuf_Atomic_Size(const RING_BUFFER_ATOMIC *b)
+{
+    return b ? b->element_count : 0;
+}
+
+/**
+ * Returns true if the ring buffer is full
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return true if the ring buffer is full, false if it is not.
+ */
+bool Ringbuf_Atomic_Full(RING_BUFFER_ATOMIC *b)
+{
+    return b ? (Ringbuf_Atomic_Count(b) >= b->element_count) : true;
+}
+
+/**
+ * Returns true if the consumer has no published element to read
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return true if the ring buffer is empty, false if it is not.
+ */
+bool Ringbuf_Atomic_Empty(RING_BUFFER_ATOMIC *b)
+{
+    return Ringbuf_Atomic_Peek(b) == NULL;
+}
+
+/**
+ * Adds an element of data to the ring buffer
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  data_element - one element of element_size bytes to add
+ * @return true on successful add, false if not added
+ */
+bool Ringbuf_Atomic_Put(RING_BUFFER_ATOMIC *b, const uint8_t *data_element)
+{
+    return Ringbuf_Atomic_Put_Batch(b, data_element, 1) == 1;
+}
+
+/**
+ * Adds consecutive elements of data to the ring buffer with one
+ * reservation
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  data_elements - count elements of element_size bytes each
+ * @param  count - number of elements to add
+ * @return number of elements added, fewer than count when the ring fills
+ */
+unsigned Ringbuf_Atomic_Put_Batch(
+    RING_BUFFER_ATOMIC *b, const uint8_t *data_elements, unsigned count)
+{
+    unsigned position = 0, reserved, i;
+
+    if (!b || !data_elements) {
+        return 0;
+    }
+    reserved = Ringbuf_Atomic_Reserve(b, count, &position);
+    for (i = 0; i < reserved; i++) {
+        memcpy(
+            Ringbuf_Atomic_Element(b, position + i),
+            &data_elements[(size_t)i * b->element_size], b->element_size);
+    }
+    for (i = 0; i < reserved; i++) {
+        Ringbuf_Atomic_Publish(b, position + i);
+    }
+
+    return reserved;
+}
+
+/**
+ * Reserves the next element so that a producer can fill it in place.
+ * The element is only read by the consumer once it is passed to
+ * Ringbuf_Atomic_Data_Put(), and it must always be passed, since the
+ * elements after it are only read in order.
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return pointer to the element of element_size bytes, or NULL if full
+ */
+void *Ringbuf_Atomic_Data_Peek(RING_BUFFER_ATOMIC *b)
+{
+    unsigned position = 0;
+
+    if (!b || (Ringbuf_Atomic_Reserve(b, 1, &position) != 1)) {
+        return NULL;
+    }
+
+    return Ringbuf_Atomic_Element(b, position);
+}
+
+/**
+ * Publishes an element that was reserved with Ringbuf_Atomic_Data_Peek()
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  data_element - element returned by Ringbuf_Atomic_Data_Peek()
+ * @return true if the element was published
+ */
+bool Ringbuf_Atomic_Data_Put(RING_BUFFER_ATOMIC *b, void *data_element)
+{
+    RINGBUF_ATOMIC_INDEX *sequence;
+    size_t offset;
+    unsigned value;
+
+    if (!b || !data_element) {
+        return false;
+    }
+    offset = (size_t)((uint8_t *)data_element - b->buffer);
+    if ((offset >= ((size_t)b->cell_size * b->element_count)) ||
+        ((offset % b->cell_size) != sizeof(RINGBUF_ATOMIC_INDEX))) {
+        return false;
+    }
+    sequence = (RINGBUF_ATOMIC_INDEX *)(void *)&b->buffer
+                   [offset - sizeof(RINGBUF_ATOMIC_INDEX)];
+    /* the cell was published one lap ago, and only this producer
+       holds it until it is published again */
+    value = RING_LOAD_RELAXED(sequence);
+    RING_STORE_RELEASE(sequence, value + b->element_count);
+
+    return true;
+}
+
+/**
+ * Looks at the next element for the consumer without removing it
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @return pointer to the data, or NULL if no element is published
+ */
+void *Ringbuf_Atomic_Peek(RING_BUFFER_ATOMIC *b)
+{
+    unsigned tail;
+
+    if (!b) {
+        return NULL;
+    }
+    tail = RING_LOAD_RELAXED(&b->tail);
+    if (RING_LOAD_ACQUIRE(Ringbuf_Atomic_Sequence(b, tail)) != (tail + 1)) {
+        return NULL;
+    }
+
+    return Ringbuf_Atomic_Element(b, tail);
+}
+
+/**
+ * Copies the next element for the consumer, and removes it
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  data_element - element of data that is loaded with data from
+ *  the ring, or NULL to discard the element
+ * @return true if an element was removed, false if the list is empty
+ */
+bool Ringbuf_Atomic_Pop(RING_BUFFER_ATOMIC *b, uint8_t *data_element)
+{
+    const uint8_t *ring_data;
+    unsigned tail;
+
+    ring_data = Ringbuf_Atomic_Peek(b);
+    if (!ring_data) {
+        return false;
+    }
+    if (data_element) {
+        memcpy(data_element, ring_data, b->element_size);
+    }
+    tail = RING_LOAD_RELAXED(&b->tail);
+    RING_STORE_RELEASE(&b->tail, tail + 1);
+
+    return true;
+}
+
+/**
+ * Copies up to count published elements for the consumer, and removes
+ * them with one update of the tail
+ *
+ * @param  b - pointer to RING_BUFFER_ATOMIC structure
+ * @param  data_elements - loaded with up to count elements of
+ *  element_size bytes each, or NULL to discard them
+ * @param  count - maximum number of elements to remove
+ * @return number of elements removed
+ */
+unsigned Ringbuf_Atomic_Pop_Batch(
+    RING_BUFFER_ATOMIC *b, uint8_t *data_elements, unsigned count)
+{
+    unsigned tail, i;
+
+    if (!b) {
+        return 0;
+    }
+    tail = RING_LOAD_RELAXED(&b->tail);
+    for (i = 0; i < count; i++) {
+        if (RING_LOAD_ACQUIRE(Ringbuf_Atomic_Sequence(b, tail + i)) !=
+            (tail + i + 1)) {
+            break;
+        }
+        if (data_elements) {
+            memcpy(
+                &data_elements[(size_t)i * b->element_size],
+                Ringbuf_Atomic_Element(b, tail + i), b->element_size);
+        }
+    }
+    if (i > 0) {
+        RING_STORE_RELEASE(&b->tail, tail + i);
+    }
+
+    return i;
+}
+#endif
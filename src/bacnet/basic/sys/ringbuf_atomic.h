@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief API for a lock-free ring buffer shared between threads
+ *
+ * The element-oriented ring buffer of ringbuf.h has one producer and one
+ * consumer in the same context, so ports that share it between threads
+ * wrap it in a mutex.  This ring buffer uses atomic operations instead:
+ * any number of producers (or exactly one, which skips the
+ * compare-and-swap) and one consumer exchange elements without locks.
+ *
+ * Each element is stored in a cell with a sequence number.  A producer
+ * reserves cells by advancing the head, copies its elements into them,
+ * and then publishes each cell by setting its sequence number.  The
+ * consumer only reads a cell once it is published, so a producer that is
+ * still copying never exposes a partial element.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_RINGBUF_ATOMIC_H
+#define BACNET_SYS_RINGBUF_ATOMIC_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define RINGBUF_ATOMIC_C11 1
+#define RINGBUF_ATOMIC_SUPPORTED 1
+typedef atomic_uint RINGBUF_ATOMIC_INDEX;
+#elif defined(__GNUC__) || defined(__clang__)
+/* the __atomic builtins of GCC and clang in C99 and earlier */
+#define RINGBUF_ATOMIC_SUPPORTED 1
+typedef unsigned RINGBUF_ATOMIC_INDEX;
+#endif
+
+#if defined(RINGBUF_ATOMIC_SUPPORTED)
+/**
+ * Size of one cell: the sequence number and the element, padded so that
+ * the next sequence number is aligned
+ */
+#define RINGBUF_ATOMIC_CELL_SIZE(element_size)                         \
+    (sizeof(RINGBUF_ATOMIC_INDEX) +                                    \
+     ((((element_size) + sizeof(RINGBUF_ATOMIC_INDEX) - 1) /           \
+       sizeof(RINGBUF_ATOMIC_INDEX)) *                                 \
+      sizeof(RINGBUF_ATOMIC_INDEX)))
+
+/**
+ * Size of the buffer for element_count elements - declare the buffer
+ * as an array of uint32_t or larger so that it is aligned
+ */
+#define RINGBUF_ATOMIC_BUFFER_SIZE(element_size, element_count) \
+    (RINGBUF_ATOMIC_CELL_SIZE(element_size) * (element_count))
+
+/**
+ * lock-free ring buffer data structure
+ *
+ * @{
+ */
+typedef struct ring_buffer_atomic_t {
+    /** cells of sequence number and element */
+    uint8_t *buffer;
+    /** how many bytes for each element */
+    unsigned element_size;
+    /** how many bytes for each cell */
+    unsigned cell_size;
+    /** number of elements - a power of two */
+    unsigned element_count;
+    /** true if more than one producer puts elements */
+    bool multi_producer;
+    /** where the next producer reservation goes */
+    RINGBUF_ATOMIC_INDEX head;
+    /** where the consumer reads from */
+    RINGBUF_ATOMIC_INDEX tail;
+} RING_BUFFER_ATOMIC;
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Initialize(
+    RING_BUFFER_ATOMIC *b,
+    void *buffer,
+    size_t buffer_size,
+    unsigned element_size,
+    unsigned element_count,
+    bool multi_producer);
+
+BACNET_STACK_EXPORT
+unsigned Ringbuf_Atomic_Count(RING_BUFFER_ATOMIC *b);
+BACNET_STACK_EXPORT
+unsigned Ringbuf_Atomic_Size(const RING_BUFFER_ATOMIC *b);
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Full(RING_BUFFER_ATOMIC *b);
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Empty(RING_BUFFER_ATOMIC *b);
+
+/* producers */
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Put(RING_BUFFER_ATOMIC *b, const uint8_t *data_element);
+BACNET_STACK_EXPORT
+unsigned Ringbuf_Atomic_Put_Batch(
+    RING_BUFFER_ATOMIC *b, const uint8_t *data_elements, unsigned count);
+/* pair of functions to use the element memory directly */
+BACNET_STACK_EXPORT
+void *Ringbuf_Atomic_Data_Peek(RING_BUFFER_ATOMIC *b);
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Data_Put(RING_BUFFER_ATOMIC *b, void *data_element);
+
+/* consumer */
+BACNET_STACK_EXPORT
+void *Ringbuf_Atomic_Peek(RING_BUFFER_ATOMIC *b);
+BACNET_STACK_EXPORT
+bool Ringbuf_Atomic_Pop(RING_BUFFER_ATOMIC *b, uint8_t *data_element);
+BACNET_STACK_EXPORT
+unsigned Ringbuf_Atomic_Pop_Batch(
+    RING_BUFFER_ATOMIC *b, uint8_t *data_elements, unsigned count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
+#endif
@@ -0,0 +1,402 @@
+/**
+ * @file
+ * @brief Interned, reference counted pool of constant string lists
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacstr.h"
+#include "bacnet/basic/sys/strpool.h"
+#include "bacnet/basic/sys/mempool.h"
+
+/* number of hash buckets - a power of two */
+#ifndef STRPOOL_BUCKETS
+#define STRPOOL_BUCKETS 64
+#endif
+
+struct strpool_entry {
+    struct strpool_entry *next;
+    uint32_t hash;
+    unsigned refcount;
+    /* bytes of the list, not counting the empty string that ends it */
+    size_t length;
+    /* encoded BACnetARRAY of CharacterString, built on first use */
+    uint8_t *encoded;
+    size_t encoded_len;
+    /* the list, ended by an empty string */
+    char text[1];
+};
+
+static struct strpool_entry *Strpool_Bucket[STRPOOL_BUCKETS];
+static unsigned Strpool_Count;
+
+/**
+ * @brief Get the size of the allocation that holds a list
+ * @param length - bytes of the list, not counting the empty string
+ *  that ends it
+ * @return size of the entry in bytes
+ */
+static size_t strpool_entry_size(size_t length)
+{
+    size_t size;
+
+    size = offsetof(struct strpool_entry, text) + length + 1;
+    if (size < sizeof(struct strpool_entry)) {
+        size = sizeof(struct strpool_entry);
+    }
+
+    return size;
+}
+
+/**
+ * @brief Free an entry that is no longer linked into the pool
+ * @param entry - entry to free
+ */
+static void strpool_entry_free(struct strpool_entry *entry)
+{
+    BACNET_MEMPOOL_FREE(entry->encoded, entry->encoded_len);
+    BACNET_MEMPOOL_FREE(entry, strpool_entry_size(entry->length));
+}
+
+/**
+ * @brief Hash a block of bytes using FNV-1a
+ * @param data - bytes to hash
+ * @param length - number of bytes
+ * @return hash of the bytes
+ */
+static uint32_t strpool_hash(const char *data, size_t length)
+{
+    uint32_t hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Determine the size of a string list
+ * @param list - C strings separated by '\0' and ended by an empty string
+ * @return number of bytes in the list, including the empty string that
+ *  ends it, or 0 if the list is NULL
+ */
+size_t strpool_list_size(const char *list)
+{
+    const char *p = list;
+
+    if (!list) {
+        return 0;
+    }
+    while (*p) {
+        p += strlen(p) + 1;
+    }
+
+    return (size_t)(p - list) + 1;
+}
+
+/**
+ * @brief Find the pool entry of a block of bytes
+ * @param data - bytes of the list, not counting the empty string
+ * @param length - number of bytes
+ * @param hash - hash of the bytes
+ * @return the pool entry, or NULL if not found
+ */
+static struct strpool_entry *
+strpool_find(const char *data, size_t length, uint32_t hash)
+{
+    struct strpool_entry *entry;
+
+    entry = Strpool_Bucket[hash & (STRPOOL_BUCKETS - 1)];
+    while (entry) {
+        if ((entry->hash == hash) && (entry->length == length) &&
+            (memcmp(entry->text, data, length) == 0)) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the pool entry that owns a pooled pointer
+ * @param pooled - pointer returned by an intern function
+ * @return the pool entry, or NULL if the pointer is not pooled
+ */
+static struct strpool_entry *strpool_entry(const char *pooled)
+{
+    struct strpool_entry *entry;
+    size_t length;
+
+    if (!pooled) {
+        return NULL;
+    }
+    length = strpool_list_size(pooled) - 1;
+    entry = strpool_find(pooled, length, strpool_hash(pooled, length));
+    if (entry && (entry->text != pooled)) {
+        /* an equal list that is not the pooled copy */
+        entry = NULL;
+    }
+
+    return entry;
+}
+
+/**
+ * @brief Intern a block of bytes, adding it to the pool if needed
+ * @param data - bytes of the list, not counting the empty string
+ * @param length - number of bytes
+ * @return the pooled copy, or NULL if there was no memory for it
+ */
+static const char *strpool_add(const char *data, size_t length)
+{
+    struct strpool_entry *entry;
+    uint32_t hash;
+    unsigned bucket;
+
+    hash = strpool_hash(data, length);
+    entry = strpool_find(data, length, hash);
+    if (entry) {
+        entry->refcount++;
+        return entry->text;
+    }
+    entry = BACNET_MEMPOOL_CALLOC(strpool_entry_size(length));
+    if (!entry) {
+        return NULL;
+    }
+    memcpy(entry->text, data, length);
+    entry->text[length] = 0;
+    entry->hash = hash;
+    entry->length = length;
+    entry->refcount = 1;
+    bucket = hash & (STRPOOL_BUCKETS - 1);
+    entry->next = Strpool_Bucket[bucket];
+    Strpool_Bucket[bucket] = entry;
+    Strpool_Count++;
+
+    return entry->text;
+}
+
+/**
+ * @brief Intern a C string
+ * @param text - C string to intern
+ * @return a shared copy of the string, or NULL if text is NULL or
+ *  there was no memory for it. Release it with strpool_release().
+ */
+const char *strpool_intern(const char *text)
+{
+    if (!text) {
+        return NULL;
+    }
+    if (text[0] == 0) {
+        /* an empty string is the empty list */
+        return strpool_add(text, 0);
+    }
+
+    return strpool_add(text, strlen(text) + 1);
+}
+
+/**
+ * @brief Intern a string list, such as the State_Text of a multistate
+ *  object.  For example:
+ * {@code
+ * static const char *baud_rate_names = {
+ *     "9600\0"
+ *     "19200\0"
+ *     "38400\0"
+ * };
+ * }
+ * @param list - C strings separated by '\0' and ended by an empty string
+ * @return a shared copy of the list, or NULL if list is NULL or
+ *  there was no memory for it. Release it with strpool_release().
+ */
+const char *strpool_list_intern(const char *list)
+{
+    if (!list) {
+        return NULL;
+    }
+
+    return strpool_add(list, strpool_list_size(list) - 1);
+}
+
+/**
+ * @brief Release a pooled string or list, freeing it with its last user
+ * @param pooled - pointer returned by an intern function
+ */
+void strpool_release(const char *pooled)
+{
+    struct strpool_entry *entry;
+    struct strpool_entry **link;
+
+    entry = strpool_entry(pooled);
+    if (!entry) {
+        return;
+    }
+    if (entry->refcount > 1) {
+        entry->refcount--;
+        return;
+    }
+    link = &Strpool_Bucket[entry->hash & (STRPOOL_BUCKETS - 1)];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    strpool_entry_free(entry);
+    Strpool_Count--;
+}
+
+/**
+ * @brief Determine if a pointer is a pooled string or list
+ * @param pooled - pointer to check
+ * @return true if the pointer was returned by an intern function
+ *  and has not been released by all of its users
+ */
+bool strpool_contains(const char *pooled)
+{
+    return strpool_entry(pooled) != NULL;
+}
+
+/**
+ * @brief Get the number of users of a pooled string or list
+ * @param pooled - pointer returned by an intern function
+ * @return number of users, or 0 if the pointer is not pooled
+ */
+unsigned strpool_refcount(const char *pooled)
+{
+    const struct strpool_entry *entry;
+
+    entry = strpool_entry(pooled);
+    if (!entry) {
+        return 0;
+    }
+
+    return entry->refcount;
+}
+
+/**
+ * @brief Get the number of distinct strings and lists in the pool
+ * @return number of pool entries
+ */
+unsigned strpool_count(void)
+{
+    return Strpool_Count;
+}
+
+/**
+ * @brief Encode a string list as application tagged CharacterStrings
+ * @param list - C strings separated by '\0' and ended by an empty string
+ * @param apdu - buffer to encode into, or NULL to only get the length
+ * @return number of bytes encoded, or 0 if a string does not fit
+ *  a CharacterString
+ */
+static size_t strpool_list_encode(const char *list, uint8_t *apdu)
+{
+    BACNET_CHARACTER_STRING char_string;
+    size_t apdu_len = 0;
+    int len;
+
+    while (*list) {
+        if (!characterstring_init_ansi(&char_string, list)) {
+            return 0;
+        }
+        len = encode_application_character_string(apdu, &char_string);
+        if (len <= 0) {
+            return 0;
+        }
+        apdu_len += (size_t)len;
+        if (apdu) {
+            apdu += len;
+        }
+        list += strlen(list) + 1;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Get the BACnetARRAY encoding of a pooled list, as read with
+ *  the array index of all elements - one application tagged
+ *  CharacterString per element.
+ * @param pooled - pointer returned by an intern function
+ * @param apdu_len - number of bytes encoded
+ * @return the encoded list, or NULL if the pointer is not pooled,
+ *  the list is empty, or the list could not be encoded
+ */
+const uint8_t *strpool_list_encoded(const char *pooled, size_t *apdu_len)
+{
+    struct strpool_entry *entry;
+    size_t len;
+
+    entry = strpool_entry(pooled);
+    if (!entry) {
+        return NULL;
+    }
+    if (!entry->encoded) {
+        len = strpool_list_encode(entry->text, NULL);
+        if (len == 0) {
+            return NULL;
+        }
+        entry->encoded = BACNET_MEMPOOL_CALLOC(len);
+        if (!entry->encoded) {
+            return NULL;
+        }
+        /* the size of the allocation, which the encoding fills */
+        entry->encoded_len = len;
+        (void)strpool_list_encode(entry->text, entry->encoded);
+    }
+    if (apdu_len) {
+        *apdu_len = entry->encoded_len;
+    }
+
+    return entry->encoded;
+}
+
+/**
+ * @brief Add the memory used by the pool to a report - the pooled strings
+ *  and lists, and their encoded forms
+ * @param usage - report to add the memory used by the pool to
+ */
+void strpool_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    const struct strpool_entry *entry;
+    unsigned bucket;
+
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes += sizeof(Strpool_Bucket);
+    for (bucket = 0; bucket < STRPOOL_BUCKETS; bucket++) {
+        for (entry = Strpool_Bucket[bucket]; entry; entry = entry->next) {
+            usage->dynamic_bytes += strpool_entry_size(entry->length);
+            if (entry->encoded) {
+                usage->dynamic_bytes += entry->encoded_len;
+            }
+        }
+    }
+    usage->count += Strpool_Count;
+}
+
+/**
+ * @brief Free every string and list in the pool, pooled pointers
+ *  that are still in use become invalid
+ */
+void strpool_cleanup(void)
+{
+    struct strpool_entry *entry;
+    unsigned bucket;
+
+    for (bucket = 0; bucket < STRPOOL_BUCKETS; bucket++) {
+        while (Strpool_Bucket[bucket]) {
+            entry = Strpool_Bucket[bucket];
+            Strpool_Bucket[bucket] = entry->next;
+            strpool_entry_free(entry);
+        }
+    }
+    Strpool_Count = 0;
+}
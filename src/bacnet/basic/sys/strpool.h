@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief Interned, reference counted pool of constant string lists
+ *
+ * Objects keep pointers to their text - Object_Name, Description, and the
+ * State_Text of multistate objects - rather than copies.  When the text
+ * is built at run time, for example from a configuration database, many
+ * objects end up with identical copies of the same few state-text sets.
+ * Interning a string list returns one shared copy for every equal list,
+ * counted so that the copy is freed when its last user releases it.
+ *
+ * A string list is a set of C strings separated by '\0' and ended by an
+ * empty string, as used by the State_Text of the multistate objects.
+ * A single C string is a list of one element.  Each pooled list can also
+ * carry its BACnetARRAY encoding as application tagged CharacterStrings,
+ * built on first use, for fast reads of the whole array.
+ *
+ * The pool is not thread safe.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_STRPOOL_H
+#define BACNET_SYS_STRPOOL_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+#include "bacnet/basic/sys/memusage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+size_t strpool_list_size(const char *list);
+BACNET_STACK_EXPORT
+const char *strpool_intern(const char *text);
+BACNET_STACK_EXPORT
+const char *strpool_list_intern(const char *list);
+BACNET_STACK_EXPORT
+void strpool_release(const char *pooled);
+BACNET_STACK_EXPORT
+bool strpool_contains(const char *pooled);
+BACNET_STACK_EXPORT
+unsigned strpool_refcount(const char *pooled);
+BACNET_STACK_EXPORT
+unsigned strpool_count(void);
+BACNET_STACK_EXPORT
+const uint8_t *strpool_list_encoded(const char *pooled, size_t *apdu_len);
+BACNET_STACK_EXPORT
+void strpool_memory_usage(BACNET_MEMORY_USAGE *usage);
+BACNET_STACK_EXPORT
+void strpool_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,323 @@
+/**
+ * @file
+ * @brief Hierarchical timer wheel for scheduling many timers cheaply.
+ *
+ * Level 0 has one slot per tick.  Each higher level has one slot per
+ * whole turn of the level below it.  A timer is kept in the lowest level
+ * that spans its remaining time, and moves down a level each time the
+ * level below completes a turn, until it expires from level 0.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "bacnet/basic/sys/timer_wheel.h"
+
+/* largest number of ticks that the levels can hold */
+#define TIMER_WHEEL_SPAN \
+    ((1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+/* largest number of ticks accepted, to keep the tick compare unambiguous */
+#define TIMER_WHEEL_TICKS_MAX 0x7FFFFFFFUL
+
+/**
+ * @brief Initialize a circular list head to be empty
+ * @param head - list head
+ */
+static void timer_wheel_list_init(struct timer_wheel_node *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+/**
+ * @brief Append a node at the tail of a circular list
+ * @param head - list head
+ * @param node - node to append
+ */
+static void
+timer_wheel_list_append(struct timer_wheel_node *head, struct timer_wheel_node *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+/**
+ * @brief Unlink a node from its list
+ * @param node - node to unlink
+ */
+static void timer_wheel_list_unlink(struct timer_wheel_node *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+/**
+ * @brief Put a timer in the slot of the lowest level that spans its
+ *  remaining ticks
+ * @param wheel - timer wheel
+ * @param node - timer with its expiry set
+ */
+static void
+timer_wheel_insert(struct timer_wheel *wheel, struct timer_wheel_node *node)
+{
+    uint32_t delta = node->expires - wheel->now;
+    uint32_t expires;
+    unsigned level = 0;
+    unsigned index;
+
+    if (delta > TIMER_WHEEL_SPAN) {
+        /* parked at the end of the span, and added again from there */
+        delta = TIMER_WHEEL_SPAN;
+    }
+    expires = wheel->now + delta;
+    while ((level < (TIMER_WHEEL_LEVELS - 1)) &&
+           (delta >= (1UL << (TIMER_WHEEL_SLOT_BITS * (level + 1))))) {
+        level++;
+    }
+    index = (expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+    timer_wheel_list_append(&wheel->slot[level][index], node);
+    wheel->count++;
+}
+
+/**
+ * @brief Initialize a timer wheel with no timers at tick zero
+ * @param wheel - timer wheel
+ */
+void timer_wheel_init(struct timer_wheel *wheel)
+{
+    unsigned level, index;
+
+    if (!wheel) {
+        return;
+    }
+    wheel->now = 0;
+    wheel->count = 0;
+    timer_wheel_list_init(&wheel->expired);
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (index = 0; index < TIMER_WHEEL_SLOTS; index++) {
+            timer_wheel_list_init(&wheel->slot[level][index]);
+        }
+    }
+}
+
+/**
+ * @brief Initialize a timer node so that it is not pending
+ * @param node - timer node
+ */
+void timer_wheel_node_init(struct timer_wheel_node *node)
+{
+    if (node) {
+        node->next = NULL;
+        node->prev = NULL;
+        node->expires = 0;
+    }
+}
+
+/**
+ * @brief Determine if a timer is in the wheel or waiting as expired
+ * @param node - timer node
+ * @return true if the timer is pending
+ */
+bool timer_wheel_pending(const struct timer_wheel_node *node)
+{
+    return node && node->next;
+}
+
+/**
+ * @brief Start a timer, or restart it if it is pending
+ * @param wheel - timer wheel
+ * @param node - timer node
+ * @param ticks - number of ticks from now until the timer expires.
+ *  Zero makes the timer expired at once.
+ */
+void timer_wheel_add(
+    struct timer_wheel *wheel, struct timer_wheel_node *node, uint32_t ticks)
+{
+    if (!wheel || !node) {
+        return;
+    }
+    timer_wheel_remove(wheel, node);
+    if (ticks > TIMER_WHEEL_TICKS_MAX) {
+        ticks = TIMER_WHEEL_TICKS_MAX;
+    }
+    node->expires = wheel->now + ticks;
+    if (ticks == 0) {
+        timer_wheel_list_append(&wheel->expired, node);
+    } else {
+        timer_wheel_insert(wheel, node);
+    }
+}
+
+/**
+ * @brief Stop a timer, whether it is in the wheel or waiting as expired
+ * @param wheel - timer wheel
+ * @param node - timer node
+ */
+void timer_wheel_remove(struct timer_wheel *wheel, struct timer_wheel_node *node)
+{
+    if (!wheel || !timer_wheel_pending(node)) {
+        return;
+    }
+    /* between advances, only the timers waiting as expired are due */
+    if ((int32_t)(node->expires - wheel->now) > 0) {
+        wheel->count--;
+    }
+    timer_wheel_list_unlink(node);
+}
+
+/**
+ * @brief Move the timers of one slot to the levels below
+ * @param wheel - timer wheel
+ * @param level - level of the slot
+ * @param index - index of the slot
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *wheel, unsigned level, unsigned index)
+{
+    struct timer_wheel_node *head = &wheel->slot[level][index];
+    struct timer_wheel_node *node;
+
+    while (head->next != head) {
+        node = head->next;
+        timer_wheel_list_unlink(node);
+        wheel->count--;
+        timer_wheel_insert(wheel, node);
+    }
+}
+
+/**
+ * @brief Advance the wheel by one tick, and move the timers that expire
+ *  on this tick to the expired list
+ * @param wheel - timer wheel
+ */
+static void timer_wheel_tick(struct timer_wheel *wheel)
+{
+    struct timer_wheel_node *head;
+    struct timer_wheel_node *node;
+    unsigned level, index;
+
+    wheel->now++;
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if ((wheel->now >> (TIMER_WHEEL_SLOT_BITS * (level - 1))) &
+            TIMER_WHEEL_SLOT_MASK) {
+            break;
+        }
+        index = (wheel->now >> (TIMER_WHEEL_SLOT_BITS * level)) &
+            TIMER_WHEEL_SLOT_MASK;
+        timer_wheel_cascade(wheel, level, index);
+    }
+    head = &wheel->slot[0][wheel->now & TIMER_WHEEL_SLOT_MASK];
+    while (head->next != head) {
+        node = head->next;
+        timer_wheel_list_unlink(node);
+        wheel->count--;
+        if ((int32_t)(node->expires - wheel->now) > 0) {
+            /* parked beyond the span */
+            timer_wheel_insert(wheel, node);
+        } else {
+            timer_wheel_list_append(&wheel->expired, node);
+        }
+    }
+}
+
+/**
+ * @brief Advance the wheel, moving the timers that expire to the
+ *  expired list to be collected with timer_wheel_expired()
+ * @param wheel - timer wheel
+ * @param ticks - number of ticks elapsed
+ */
+void timer_wheel_advance(struct timer_wheel *wheel, uint32_t ticks)
+{
+    if (!wheel) {
+        return;
+    }
+    while (ticks) {
+        if (wheel->count == 0) {
+            /* nothing can expire - jump ahead */
+            wheel->now += ticks;
+            break;
+        }
+        timer_wheel_tick(wheel);
+        ticks--;
+    }
+}
+
+/**
+ * @brief Take the next expired timer from the wheel
+ * @param wheel - timer wheel
+ * @return the expired timer, which is no longer pending, or NULL if
+ *  no timers have expired
+ */
+struct timer_wheel_node *timer_wheel_expired(struct timer_wheel *wheel)
+{
+    struct timer_wheel_node *node = NULL;
+
+    if (wheel && (wheel->expired.next != &wheel->expired)) {
+        node = wheel->expired.next;
+        timer_wheel_list_unlink(node);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Get the current tick of the wheel
+ * @param wheel - timer wheel
+ * @return current tick
+ */
+uint32_t timer_wheel_now(const struct timer_wheel *wheel)
+{
+    return wheel ? wheel->now : 0;
+}
+
+/**
+ * @brief Get the number of timers in the wheel that have not expired
+ * @param wheel - timer wheel
+ * @return number of timers
+ */
+unsigned timer_wheel_count(const struct timer_wheel *wheel)
+{
+    return wheel ? wheel->count : 0;
+}
+
+/**
+ * @brief Get the number of ticks until the next timer expires, which is
+ *  how far the wheel can be advanced at once without a late timer
+ * @note This visits every timer in the wheel.
+ * @param wheel - timer wheel
+ * @return ticks until the next timer expires, zero if a timer has
+ *  expired, or UINT32_MAX if there are no timers
+ */
+uint32_t timer_wheel_next(const struct timer_wheel *wheel)
+{
+    const struct timer_wheel_node *head;
+    const struct timer_wheel_node *node;
+    uint32_t next = UINT32_MAX;
+    uint32_t delta;
+    unsigned level, index;
+
+    if (!wheel) {
+        return next;
+    }
+    if (wheel->expired.next != &wheel->expired) {
+        return 0;
+    }
+    for (level = 0; (level < TIMER_WHEEL_LEVELS) && wheel->count; level++) {
+        for (index = 0; index < TIMER_WHEEL_SLOTS; index++) {
+            head = &wheel->slot[level][index];
+            for (node = head->next; node != head; node = node->next) {
+                delta = node->expires - wheel->now;
+                if (delta < next) {
+                    next = delta;
+                }
+            }
+        }
+    }
+
+    return next;
+}
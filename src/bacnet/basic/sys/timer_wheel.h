@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Hierarchical timer wheel for scheduling many timers cheaply.
+ *
+ * Timers are intrusive nodes that are kept in slots of a few wheels of
+ * increasing span.  Adding or removing a timer takes constant time, and
+ * advancing the wheel only visits the slots that come due, so idle
+ * timers cost nothing until they expire.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_TIMER_WHEEL_H
+#define BACNET_SYS_TIMER_WHEEL_H
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of slots in each level of the wheel - 2^6 = 64 */
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1UL << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+/* number of levels - the wheel spans 2^24 ticks before timers are re-added */
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * Timer node - embed in the data that owns the timer
+ *
+ * @{
+ */
+struct timer_wheel_node {
+    struct timer_wheel_node *next;
+    struct timer_wheel_node *prev;
+    /** tick when the timer expires */
+    uint32_t expires;
+};
+/** @} */
+
+/**
+ * Timer wheel data structure
+ *
+ * @{
+ */
+struct timer_wheel {
+    /** current tick */
+    uint32_t now;
+    /** number of timers in the wheel */
+    unsigned count;
+    /** timers that expired, waiting for timer_wheel_expired() */
+    struct timer_wheel_node expired;
+    /** slots of each level - circular lists with a sentinel head */
+    struct timer_wheel_node slot[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void timer_wheel_init(struct timer_wheel *wheel);
+BACNET_STACK_EXPORT
+void timer_wheel_node_init(struct timer_wheel_node *node);
+BACNET_STACK_EXPORT
+bool timer_wheel_pending(const struct timer_wheel_node *node);
+BACNET_STACK_EXPORT
+void timer_wheel_add(
+    struct timer_wheel *wheel, struct timer_wheel_node *node, uint32_t ticks);
+BACNET_STACK_EXPORT
+void timer_wheel_remove(
+    struct timer_wheel *wheel, struct timer_wheel_node *node);
+BACNET_STACK_EXPORT
+void timer_wheel_advance(struct timer_wheel *wheel, uint32_t ticks);
+BACNET_STACK_EXPORT
+struct timer_wheel_node *timer_wheel_expired(struct timer_wheel *wheel);
+BACNET_STACK_EXPORT
+uint32_t timer_wheel_now(const struct timer_wheel *wheel);
+BACNET_STACK_EXPORT
+unsigned timer_wheel_count(const struct timer_wheel *wheel);
+BACNET_STACK_EXPORT
+uint32_t timer_wheel_next(const struct timer_wheel *wheel);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
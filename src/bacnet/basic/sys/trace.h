@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief Static tracepoints on the hot paths of the stack
+ *
+ * With BACNET_TRACE_USDT defined, each tracepoint is a USDT probe of the
+ * "bacnet" provider from <sys/sdt.h> (systemtap-sdt-dev).  A probe is a
+ * single NOP in the code until a tracer such as bpftrace or perf attaches
+ * to it, so the probes can stay in production builds.  Otherwise the
+ * tracepoints compile to nothing and their arguments are not evaluated.
+ *
+ * The probes, and their arguments:
+ *   bip_receive(mtu_len), bip_send(mtu_len)
+ *   dlmstp_receive(pdu_len), dlmstp_send(pdu_len)
+ *   bsc_receive(pdu_len), bsc_send(pdu_len)
+ *   npdu_entry(pdu_len), npdu_exit(pdu_len)
+ *   apdu_confirmed_entry(service_choice, invoke_id),
+ *   apdu_confirmed_exit(service_choice, invoke_id)
+ *   apdu_unconfirmed_entry(service_choice),
+ *   apdu_unconfirmed_exit(service_choice)
+ *   tsm_state(invoke_id, state)
+ *   cov_send(object_type, object_instance, confirmed)
+ *   bbmd_forward(mtu_len, destination_count)
+ *
+ * For example, the handler time of each confirmed service:
+ * {@code
+ * bpftrace -e '
+ *   usdt:./bacserv:bacnet:apdu_confirmed_entry { @t[tid] = nsecs; }
+ *   usdt:./bacserv:bacnet:apdu_confirmed_exit /@t[tid]/ {
+ *     @ns[arg0] = hist(nsecs - @t[tid]); delete(@t[tid]); }'
+ * }
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_TRACE_H
+#define BACNET_SYS_TRACE_H
+
+#if defined(BACNET_TRACE_USDT)
+#include <sys/sdt.h>
+#define BACNET_TRACE1(name, a) DTRACE_PROBE1(bacnet, name, a)
+#define BACNET_TRACE2(name, a, b) DTRACE_PROBE2(bacnet, name, a, b)
+#define BACNET_TRACE3(name, a, b, c) DTRACE_PROBE3(bacnet, name, a, b, c)
+#else
+#define BACNET_TRACE1(name, a) ((void)0)
+#define BACNET_TRACE2(name, a, b) ((void)0)
+#define BACNET_TRACE3(name, a, b, c) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * @file
+ * @brief Immutable, reference counted buffers of encoded BACnet
+ *  application data values
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacnet/bacapp.h"
+#include "bacnet/bacdcode.h"
+#include "bacnet/basic/sys/valbuf.h"
+#include "bacnet/basic/sys/mempool.h"
+
+struct bacnet_valbuf {
+    unsigned refcount;
+    /* decoded values, chained by next, built on first use */
+    BACNET_APPLICATION_DATA_VALUE *value;
+    unsigned value_count;
+    size_t length;
+    /* the encoded values */
+    uint8_t data[1];
+};
+
+/**
+ * @brief Allocate a value buffer with one share
+ * @param apdu_len - number of bytes of the encoded values
+ * @return the value buffer, or NULL if out of memory
+ */
+static BACNET_VALBUF *valbuf_alloc(size_t apdu_len)
+{
+    BACNET_VALBUF *buffer;
+
+    buffer = BACNET_MEMPOOL_CALLOC(sizeof(BACNET_VALBUF) + apdu_len);
+    if (buffer) {
+        buffer->refcount = 1;
+        buffer->value = NULL;
+        buffer->value_count = 0;
+        buffer->length = apdu_len;
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief Create a value buffer from encoded application data, which is
+ *  copied once
+ * @param apdu - encoded application tagged values
+ * @param apdu_len - number of bytes of the encoded values
+ * @return the value buffer with one share, or NULL if out of memory
+ */
+BACNET_VALBUF *valbuf_create(const uint8_t *apdu, size_t apdu_len)
+{
+    BACNET_VALBUF *buffer;
+
+    if (!apdu && (apdu_len > 0)) {
+        return NULL;
+    }
+    buffer = valbuf_alloc(apdu_len);
+    if (buffer && (apdu_len > 0)) {
+        memcpy(buffer->data, apdu, apdu_len);
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief Create a value buffer by encoding a value, or a list of values
+ *  chained by next
+ * @param value - value to encode
+ * @return the value buffer with one share, or NULL on failure
+ */
+BACNET_VALBUF *valbuf_encode(const BACNET_APPLICATION_DATA_VALUE *value)
+{
+    const BACNET_APPLICATION_DATA_VALUE *element;
+    BACNET_VALBUF *buffer;
+    size_t apdu_len = 0;
+    int len;
+
+    if (!value) {
+        return NULL;
+    }
+    for (element = value; element; element = element->next) {
+        len = bacapp_encode_application_data(NULL, element);
+        if (len <= 0) {
+            return NULL;
+        }
+        apdu_len += (size_t)len;
+    }
+    buffer = valbuf_alloc(apdu_len);
+    if (buffer) {
+        apdu_len = 0;
+        for (element = value; element; element = element->next) {
+            len = bacapp_encode_application_data(
+                &buffer->data[apdu_len], element);
+            apdu_len += (size_t)len;
+        }
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief Take another share of a value buffer, instead of a copy
+ * @param buffer - value buffer, or NULL
+ * @return the same value buffer
+ */
+BACNET_VALBUF *valbuf_share(BACNET_VALBUF *buffer)
+{
+    if (buffer) {
+        buffer->refcount++;
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief Move the share of a value buffer from one holder to another.
+ *  The share held by the destination is released.
+ * @param dest - [in,out] holder that takes the share
+ * @param src - [in,out] holder that gives the share, set to NULL
+ */
+void valbuf_move(BACNET_VALBUF **dest, BACNET_VALBUF **src)
+{
+    if (!dest || !src || (dest == src)) {
+        return;
+    }
+    valbuf_release(*dest);
+    *dest = *src;
+    *src = NULL;
+}
+
+/**
+ * @brief Release a share of a value buffer, which is freed with its
+ *  last share
+ * @param buffer - value buffer, or NULL
+ */
+void valbuf_release(BACNET_VALBUF *buffer)
+{
+    if (!buffer) {
+        return;
+    }
+    if (buffer->refcount > 1) {
+        buffer->refcount--;
+        return;
+    }
+    BACNET_MEMPOOL_FREE(
+        buffer->value,
+        buffer->value_count * sizeof(BACNET_APPLICATION_DATA_VALUE));
+    BACNET_MEMPOOL_FREE(buffer, sizeof(BACNET_VALBUF) + buffer->length);
+}
+
+/**
+ * @brief Get the encoded values of a value buffer
+ * @param buffer - value buffer
+ * @return the encoded values, or NULL
+ */
+const uint8_t *valbuf_data(const BACNET_VALBUF *buffer)
+{
+    return buffer ? buffer->data : NULL;
+}
+
+/**
+ * @brief Get the number of bytes of the encoded values of a value buffer
+ * @param buffer - value buffer
+ * @return number of bytes
+ */
+size_t valbuf_length(const BACNET_VALBUF *buffer)
+{
+    return buffer ? buffer->length : 0;
+}
+
+/**
+ * @brief Get the number of shares of a value buffer
+ * @param buffer - value buffer
+ * @return number of shares, or 0 for NULL
+ */
+unsigned valbuf_refcount(const BACNET_VALBUF *buffer)
+{
+    return buffer ? buffer->refcount : 0;
+}
+
+/**
+ * @brief Determine if two value buffers hold the same encoded values
+ * @param buffer1 - value buffer
+ * @param buffer2 - value buffer
+ * @return true if the encoded values are the same
+ */
+bool valbuf_same(const BACNET_VALBUF *buffer1, const BACNET_VALBUF *buffer2)
+{
+    if (buffer1 == buffer2) {
+        return true;
+    }
+    if (!buffer1 || !buffer2 || (buffer1->length != buffer2->length)) {
+        return false;
+    }
+
+    return memcmp(buffer1->data, buffer2->data, buffer1->length) == 0;
+}
+
+/**
+ * @brief Get the decoded values of a value buffer, which are decoded on
+ *  first use and kept with the buffer
+ * @param buffer - value buffer of application tagged values
+ * @return the first value, chained by next to the others, or NULL if the
+ *  buffer is empty or does not decode
+ */
+const BACNET_APPLICATION_DATA_VALUE *valbuf_value(BACNET_VALBUF *buffer)
+{
+    BACNET_APPLICATION_DATA_VALUE *value;
+    BACNET_TAG tag = { 0 };
+    size_t apdu_len = 0;
+    unsigned count = 0, i;
+    int len;
+
+    if (!buffer) {
+        return NULL;
+    }
+    if (buffer->value || (buffer->length == 0)) {
+        return buffer->value;
+    }
+    /* count the values, so that they are decoded into one allocation */
+    while (apdu_len < buffer->length) {
+        len = bacnet_tag_decode(
+            &buffer->data[apdu_len], (uint32_t)(buffer->length - apdu_len),
+            &tag);
+        if ((len <= 0) || !tag.application) {
+            return NULL;
+        }
+        apdu_len += (size_t)len +
+            (size_t)bacnet_application_data_length(
+                tag.number, tag.len_value_type);
+        count++;
+    }
+    if (apdu_len != buffer->length) {
+        return NULL;
+    }
+    value = BACNET_MEMPOOL_CALLOC(
+        count * sizeof(BACNET_APPLICATION_DATA_VALUE));
+    if (!value) {
+        return NULL;
+    }
+    apdu_len = 0;
+    for (i = 0; i < count; i++) {
+        len = bacapp_decode_application_data(
+            &buffer->data[apdu_len], (uint32_t)(buffer->length - apdu_len),
+            &value[i]);
+        if (len <= 0) {
+            BACNET_MEMPOOL_FREE(
+                value, count * sizeof(BACNET_APPLICATION_DATA_VALUE));
+            return NULL;
+        }
+        apdu_len += (size_t)len;
+        if (i > 0) {
+            value[i - 1].next = &value[i];
+        }
+    }
+    buffer->value = value;
+    buffer->value_count = count;
+
+    return value;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief API for immutable, reference counted buffers of encoded BACnet
+ *  application data values
+ *
+ * A BACNET_APPLICATION_DATA_VALUE is several kilobytes, since its union
+ * holds the longest character and octet strings, and a list of values is
+ * a chain of them.  A value that is queued or passed between layers is
+ * better kept as its encoded bytes: a value buffer holds the bytes once,
+ * and each user takes a share of it instead of a copy.  The decoded value
+ * is built on first use and kept with the bytes.
+ *
+ * The buffers are not thread safe.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_VALBUF_H
+#define BACNET_SYS_VALBUF_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacapp.h"
+
+typedef struct bacnet_valbuf BACNET_VALBUF;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+BACNET_VALBUF *valbuf_create(const uint8_t *apdu, size_t apdu_len);
+BACNET_STACK_EXPORT
+BACNET_VALBUF *valbuf_encode(const BACNET_APPLICATION_DATA_VALUE *value);
+BACNET_STACK_EXPORT
+BACNET_VALBUF *valbuf_share(BACNET_VALBUF *buffer);
+BACNET_STACK_EXPORT
+void valbuf_move(BACNET_VALBUF **dest, BACNET_VALBUF **src);
+BACNET_STACK_EXPORT
+void valbuf_release(BACNET_VALBUF *buffer);
+
+BACNET_STACK_EXPORT
+const uint8_t *valbuf_data(const BACNET_VALBUF *buffer);
+BACNET_STACK_EXPORT
+size_t valbuf_length(const BACNET_VALBUF *buffer);
+BACNET_STACK_EXPORT
+unsigned valbuf_refcount(const BACNET_VALBUF *buffer);
+BACNET_STACK_EXPORT
+bool valbuf_same(const BACNET_VALBUF *buffer1, const BACNET_VALBUF *buffer2);
+BACNET_STACK_EXPORT
+const BACNET_APPLICATION_DATA_VALUE *valbuf_value(BACNET_VALBUF *buffer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
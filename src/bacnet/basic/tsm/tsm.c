@@ -9,21 +9,31 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 #include "bacnet/bacaddr.h"
 #include "bacnet/bacdcode.h"
+#include "bacnet/abort.h"
+#include "bacnet/segmentack.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mempool.h"
+#include "bacnet/basic/sys/trace.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/binding/address.h"
 
 /** @file tsm.c  BACnet Transaction State Machine operations  */
 /* FIXME: modify basic service handlers to use TSM rather than this buffer! */
+#if defined(BACNET_APDU_WORKERS)
+BACNET_THREAD_LOCAL uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#else
 uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#endif
 
 #if (MAX_TSM_TRANSACTIONS)
 /* Really only needed for segmented messages */
@@ -31,17 +41,98 @@ uint8_t Handler_Transmit_Buffer[MAX_PDU];
 /* If we are only a server and only initiate broadcasts, */
 /* then we don't need a TSM layer. */
 
-/* FIXME: not coded for segmentation */
+/* Segmentation is coded for ComplexACKs only: segmented replies that we
+   send as a server and segmented replies to our confirmed requests.
+   Segmented confirmed requests are neither sent nor accepted. */
 
-/* declare space for the TSM transactions, and set it up in the init. */
-/* table rules: an Invoke ID = 0 is an unused spot in the table */
-static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
+#if BACNET_SEGMENTATION_ENABLED
+/* a segmented ComplexACK in progress, either sent by us as the server
+   or reassembled by us as the client */
+typedef struct BACnet_TSM_Segment_Data {
+    /* true while the buffer is in use */
+    bool in_use;
+    /* true if we are the server sending the segments */
+    bool server;
+    /* invoke ID of the transaction */
+    uint8_t InvokeID;
+    /* service choice of the ComplexACK */
+    uint8_t service_choice;
+    /* used to count segment retries */
+    uint8_t SegmentRetryCount;
+    /* sequence number of the first segment of the current window */
+    uint8_t InitialSequenceNumber;
+    /* sequence number of the last segment received in order */
+    uint8_t LastSequenceNumber;
+    /* current window size */
+    uint8_t ActualWindowSize;
+    /* window size proposed by the segment sender */
+    uint8_t ProposedWindowSize;
+    /* server: service data octets in each segment, and segment count */
+    uint16_t segment_size;
+    uint16_t segment_count;
+    /* server: segment index of the InitialSequenceNumber */
+    uint16_t initial_segment;
+    /* client: count of segments received */
+    uint16_t segments_received;
+    /* deadline of the segment timer on the TSM_Milliseconds clock */
+    uint32_t deadline;
+    /* the peer address */
+    BACNET_ADDRESS peer;
+    /* the network layer info */
+    BACNET_NPDU_DATA npdu_data;
+    /* the service data of the complete ComplexACK */
+    uint16_t data_len;
+    uint8_t data[BACNET_SEGMENTATION_BUFFER_SIZE];
+} BACNET_TSM_SEGMENT_DATA;
+#endif
 
-/* invoke ID for incrementing between subsequent calls. */
-static uint8_t Current_Invoke_ID = 1;
+/* the state of one transaction state machine, so that each stack context
+   has its own transactions and invoke IDs */
+struct tsm_context {
+    /* invoke ID for incrementing between subsequent calls, where zero
+       is the first call */
+    uint8_t Current_Invoke_ID;
+    /* table rules: an Invoke ID = 0 is an unused spot in the table */
+    BACNET_TSM_DATA List[MAX_TSM_TRANSACTIONS];
+    /* invoke ID to table index+1, or 0 when the invoke ID is not in use */
+    uint8_t Index[256];
+    /* unused table spots: a stack of table indexes on top of the spots
+       that have never been used */
+    uint8_t Free_List[MAX_TSM_TRANSACTIONS];
+    unsigned Free_Count;
+    unsigned Used_Count;
+    /* number of table spots holding an invoke ID */
+    unsigned Active_Count;
+    /* min-heap of the transactions awaiting confirmation, by deadline */
+    uint8_t Heap[MAX_TSM_TRANSACTIONS];
+    /* heap position+1 of each table spot, or 0 when not in the heap */
+    uint8_t Heap_Position[MAX_TSM_TRANSACTIONS];
+    unsigned Heap_Count;
+    /* deadline of each awaiting transaction on the Milliseconds clock */
+    uint32_t Deadline[MAX_TSM_TRANSACTIONS];
+    uint32_t Milliseconds;
+    /* completion callback and its context of each table spot */
+    tsm_completion_function Completion_Function[MAX_TSM_TRANSACTIONS];
+    void *Completion_Context[MAX_TSM_TRANSACTIONS];
+#if BACNET_SEGMENTATION_ENABLED
+    BACNET_TSM_SEGMENT_DATA Segment_List[BACNET_SEGMENTATION_BUFFERS];
+    /* segments and segment-ACKs are encoded here */
+    uint8_t Segment_Buffer[MAX_PDU];
+#endif
+};
+
+/* declare space for the TSM transactions of the default context */
+static struct tsm_context TSM_Default;
+/* the context of the calling thread */
+static BACNET_STACK_THREAD_LOCAL struct tsm_context *TSM = &TSM_Default;
 
 static tsm_timeout_function Timeout_Function;
 
+#if BACNET_SEGMENTATION_ENABLED
+/* shared buffer for encoding a reply that is too big for a single APDU */
+uint8_t Handler_Segment_Buffer[BACNET_SEGMENTATION_BUFFER_SIZE];
+#endif
+
 void tsm_set_timeout_handler(tsm_timeout_function pFunction)
 {
     Timeout_Function = pFunction;
@@ -57,84 +148,173 @@ void tsm_set_timeout_handler(tsm_timeout_function pFunction)
  */
 static uint8_t tsm_find_invokeID_index(uint8_t invokeID)
 {
-    unsigned i = 0; /* counter */
     uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
 
-    const BACNET_TSM_DATA *plist = TSM_List;
-
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == invokeID) {
-            index = (uint8_t)i;
-            break;
-        }
+    if (invokeID && TSM->Index[invokeID]) {
+        index = TSM->Index[invokeID] - 1;
     }
 
     return index;
 }
 
-/** Find the first free index in the TSM table.
+/** Take a free index from the TSM table.
  *
- * @return Index of the id or MAX_TSM_TRANSACTIONS
+ * @return Index of the spot or MAX_TSM_TRANSACTIONS
  *         if no entry is free.
  */
-static uint8_t tsm_find_first_free_index(void)
+static uint8_t tsm_free_index_take(void)
 {
-    unsigned i = 0; /* counter */
     uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
 
-    const BACNET_TSM_DATA *plist = TSM_List;
-
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            index = (uint8_t)i;
-            break;
-        }
+    if (TSM->Free_Count) {
+        TSM->Free_Count--;
+        index = TSM->Free_List[TSM->Free_Count];
+    } else if (TSM->Used_Count < MAX_TSM_TRANSACTIONS) {
+        index = (uint8_t)TSM->Used_Count;
+        TSM->Used_Count++;
     }
 
     return index;
 }
 
-/** Check if space for transactions is available.
- *
- * @return true/false
+/** Check if the deadline a is earlier than the deadline b on the
+ *  wrapping millisecond clock.
  */
-bool tsm_transaction_available(void)
+static bool tsm_deadline_before(uint32_t a, uint32_t b)
 {
-    bool status = false; /* return value */
-    unsigned i = 0; /* counter */
+    return ((int32_t)(a - b) < 0);
+}
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+static void tsm_heap_swap(unsigned a, unsigned b)
+{
+    uint8_t index = TSM->Heap[a];
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            /* one is available! */
-            status = true;
+    TSM->Heap[a] = TSM->Heap[b];
+    TSM->Heap[b] = index;
+    TSM->Heap_Position[TSM->Heap[a]] = (uint8_t)(a + 1);
+    TSM->Heap_Position[TSM->Heap[b]] = (uint8_t)(b + 1);
+}
+
+static void tsm_heap_sift(unsigned position)
+{
+    unsigned parent, child;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (!tsm_deadline_before(
+                TSM->Deadline[TSM->Heap[position]],
+                TSM->Deadline[TSM->Heap[parent]])) {
             break;
         }
+        tsm_heap_swap(position, parent);
+        position = parent;
     }
+    for (;;) {
+        child = (position * 2) + 1;
+        if (child >= TSM->Heap_Count) {
+            break;
+        }
+        if (((child + 1) < TSM->Heap_Count) &&
+            tsm_deadline_before(
+                TSM->Deadline[TSM->Heap[child + 1]],
+                TSM->Deadline[TSM->Heap[child]])) {
+            child++;
+        }
+        if (!tsm_deadline_before(
+                TSM->Deadline[TSM->Heap[child]],
+                TSM->Deadline[TSM->Heap[position]])) {
+            break;
+        }
+        tsm_heap_swap(position, child);
+        position = child;
+    }
+}
 
-    return status;
+/** Remove a table spot from the timeout heap, if it is in the heap. */
+static void tsm_heap_remove(uint8_t index)
+{
+    unsigned position;
+
+    if (TSM->Heap_Position[index] == 0) {
+        return;
+    }
+    position = TSM->Heap_Position[index] - 1;
+    TSM->Heap_Position[index] = 0;
+    TSM->Heap_Count--;
+    if (position != TSM->Heap_Count) {
+        TSM->Heap[position] = TSM->Heap[TSM->Heap_Count];
+        TSM->Heap_Position[TSM->Heap[position]] = (uint8_t)(position + 1);
+        tsm_heap_sift(position);
+    }
 }
 
-/** Return the count of idle transaction.
+/** Start or restart the request timer of a table spot. */
+static void tsm_request_timer_start(uint8_t index)
+{
+    uint16_t timeout = apdu_timeout();
+
+    TSM->List[index].RequestTimer = timeout;
+    if (timeout == 0) {
+        /* retry on the next timer tick */
+        timeout = 1;
+    }
+    TSM->Deadline[index] = TSM->Milliseconds + timeout;
+    if (TSM->Heap_Position[index] == 0) {
+        TSM->Heap[TSM->Heap_Count] = index;
+        TSM->Heap_Count++;
+        TSM->Heap_Position[index] = (uint8_t)TSM->Heap_Count;
+    }
+    tsm_heap_sift(TSM->Heap_Position[index] - 1);
+}
+
+/** Fail a transaction and tell the timeout handler about it.
  *
- * @return Count of idle transaction.
+ * @param index  Index of the table spot
  */
-uint8_t tsm_transaction_idle_count(void)
+static void tsm_transaction_fail(uint8_t index)
 {
-    uint8_t count = 0; /* return value */
-    unsigned i = 0; /* counter */
+    BACNET_TSM_DATA *plist = &TSM->List[index];
+    BACNET_TSM_COMPLETION_DATA completion = { 0 };
+    BACNET_ADDRESS dest;
 
-    const BACNET_TSM_DATA *plist = TSM_List;
-
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if ((plist->InvokeID == 0) && (plist->state == TSM_STATE_IDLE)) {
-            /* one is available! */
-            count++;
+    tsm_heap_remove(index);
+    plist->RequestTimer = 0;
+    /* note: the invoke id has not been cleared yet
+       and this indicates a failed message:
+       IDLE and a valid invoke id */
+    plist->state = TSM_STATE_IDLE;
+    BACNET_TRACE2(tsm_state, plist->InvokeID, plist->state);
+    if ((plist->InvokeID != 0) && TSM->Completion_Function[index]) {
+        /* the completion owns the transaction, so nobody polls
+           for the failed invoke ID and it is freed here */
+        completion.status = TSM_COMPLETION_TIMEOUT;
+        completion.invoke_id = plist->InvokeID;
+        bacnet_address_copy(&dest, &plist->dest);
+        tsm_completion_dispatch(&dest, &completion);
+    } else if (plist->InvokeID != 0) {
+        if (Timeout_Function) {
+            Timeout_Function(plist->InvokeID);
         }
     }
+}
 
-    return count;
+/** Check if space for transactions is available.
+ *
+ * @return true/false
+ */
+bool tsm_transaction_available(void)
+{
+    return (TSM->Active_Count < MAX_TSM_TRANSACTIONS);
+}
+
+/** Return the count of idle transaction.
+ *
+ * @return Count of idle transaction.
+ */
+uint8_t tsm_transaction_idle_count(void)
+{
+    /* unused spots are always idle */
+    return (uint8_t)(MAX_TSM_TRANSACTIONS - TSM->Active_Count);
 }
 
 /**
@@ -147,7 +327,7 @@ void tsm_invokeID_set(uint8_t invokeID)
     if (invokeID == 0) {
         invokeID = 1;
     }
-    Current_Invoke_ID = invokeID;
+    TSM->Current_Invoke_ID = invokeID;
 }
 
 /** Gets the next free invokeID,
@@ -163,35 +343,43 @@ uint8_t tsm_next_free_invokeID(void)
     bool found = false;
     BACNET_TSM_DATA *plist = NULL;
 
+    if (TSM->Current_Invoke_ID == 0) {
+        TSM->Current_Invoke_ID = 1;
+    }
     /* Is there even space available? */
     if (tsm_transaction_available()) {
         while (!found) {
-            index = tsm_find_invokeID_index(Current_Invoke_ID);
+            index = tsm_find_invokeID_index(TSM->Current_Invoke_ID);
             if (index == MAX_TSM_TRANSACTIONS) {
                 /* Not found, so this invokeID is not used */
                 found = true;
                 /* set this id into the table */
-                index = tsm_find_first_free_index();
+                index = tsm_free_index_take();
                 if (index != MAX_TSM_TRANSACTIONS) {
-                    plist = &TSM_List[index];
-                    plist->InvokeID = invokeID = Current_Invoke_ID;
+                    plist = &TSM->List[index];
+                    plist->InvokeID = invokeID = TSM->Current_Invoke_ID;
                     plist->state = TSM_STATE_IDLE;
+                    BACNET_TRACE2(tsm_state, plist->InvokeID, plist->state);
                     plist->RequestTimer = apdu_timeout();
+                    TSM->Completion_Function[index] = NULL;
+                    TSM->Completion_Context[index] = NULL;
+                    TSM->Index[invokeID] = index + 1;
+                    TSM->Active_Count++;
                     /* update for the next call or check */
-                    Current_Invoke_ID++;
+                    TSM->Current_Invoke_ID++;
                     /* skip zero - we treat that internally as invalid or no
                      * free */
-                    if (Current_Invoke_ID == 0) {
-                        Current_Invoke_ID = 1;
+                    if (TSM->Current_Invoke_ID == 0) {
+                        TSM->Current_Invoke_ID = 1;
                     }
                 }
             } else {
                 /* found! This invokeID is already used */
                 /* try next one */
-                Current_Invoke_ID++;
+                TSM->Current_Invoke_ID++;
                 /* skip zero - we treat that internally as invalid or no free */
-                if (Current_Invoke_ID == 0) {
-                    Current_Invoke_ID = 1;
+                if (TSM->Current_Invoke_ID == 0) {
+                    TSM->Current_Invoke_ID = 1;
                 }
             }
         }
@@ -223,12 +411,13 @@ void tsm_set_confirmed_unsegmented_transaction(
     if (invokeID && ndpu_data && apdu && (apdu_len > 0)) {
         index = tsm_find_invokeID_index(invokeID);
         if (index < MAX_TSM_TRANSACTIONS) {
-            plist = &TSM_List[index];
+            plist = &TSM->List[index];
             /* SendConfirmedUnsegmented */
             plist->state = TSM_STATE_AWAIT_CONFIRMATION;
+            BACNET_TRACE2(tsm_state, plist->InvokeID, plist->state);
             plist->RetryCount = 0;
             /* start the timer */
-            plist->RequestTimer = apdu_timeout();
+            tsm_request_timer_start(index);
             /* copy the data */
             for (j = 0; j < apdu_len; j++) {
                 plist->apdu[j] = apdu[j];
@@ -273,7 +462,7 @@ bool tsm_get_transaction_pdu(
             /* FIXME: we may want to free the transaction so it doesn't timeout
              */
             /* retrieve the transaction */
-            plist = &TSM_List[index];
+            plist = &TSM->List[index];
             *apdu_len = (uint16_t)plist->apdu_len;
             if (*apdu_len > MAX_PDU) {
                 *apdu_len = MAX_PDU;
@@ -290,6 +479,496 @@ bool tsm_get_transaction_pdu(
     return found;
 }
 
+#if BACNET_SEGMENTATION_ENABLED
+/** Take an unused segmentation buffer.
+ *
+ * @return the buffer, or NULL if all of them are in use
+ */
+static BACNET_TSM_SEGMENT_DATA *tsm_segment_alloc(void)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_SEGMENTATION_BUFFERS; i++) {
+        if (!TSM->Segment_List[i].in_use) {
+            TSM->Segment_List[i].in_use = true;
+            return &TSM->Segment_List[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** Find the segmentation buffer of a transaction.
+ *
+ * @param invokeID  Invoke-ID of the transaction
+ * @param server  true if we are the server sending the segments
+ * @param peer  address of the peer, or NULL to match any address
+ *
+ * @return the buffer, or NULL if not found
+ */
+static BACNET_TSM_SEGMENT_DATA *
+tsm_segment_find(uint8_t invokeID, bool server, const BACNET_ADDRESS *peer)
+{
+    unsigned i;
+    BACNET_TSM_SEGMENT_DATA *pseg;
+
+    for (i = 0; i < BACNET_SEGMENTATION_BUFFERS; i++) {
+        pseg = &TSM->Segment_List[i];
+        if (pseg->in_use && (pseg->server == server) &&
+            (pseg->InvokeID == invokeID) &&
+            (!peer || bacnet_address_same(&pseg->peer, peer))) {
+            return pseg;
+        }
+    }
+
+    return NULL;
+}
+
+/** Start or restart the segment timer of a segmentation buffer.
+ *  The segment receiver waits four times as long as the sender.
+ */
+static void tsm_segment_timer_start(BACNET_TSM_SEGMENT_DATA *pseg)
+{
+    uint32_t timeout = apdu_segment_timeout();
+
+    if (!pseg->server) {
+        timeout *= 4;
+    }
+    if (timeout == 0) {
+        timeout = 1;
+    }
+    pseg->deadline = TSM->Milliseconds + timeout;
+}
+
+/** Send one segment of a segmented ComplexACK.
+ *
+ * @param pseg  segmentation buffer
+ * @param segment  index of the segment, 0..segment_count-1
+ */
+static void tsm_segment_send(BACNET_TSM_SEGMENT_DATA *pseg, uint16_t segment)
+{
+    BACNET_ADDRESS my_address;
+    uint8_t *apdu;
+    uint16_t offset;
+    uint16_t len;
+    int pdu_len;
+    int bytes_sent;
+
+    offset = segment * pseg->segment_size;
+    len = pseg->data_len - offset;
+    if (len > pseg->segment_size) {
+        len = pseg->segment_size;
+    }
+    datalink_get_my_address(&my_address);
+    pdu_len = npdu_encode_pdu(
+        &TSM->Segment_Buffer[0], &pseg->peer, &my_address, &pseg->npdu_data);
+    apdu = &TSM->Segment_Buffer[pdu_len];
+    apdu[0] = PDU_TYPE_COMPLEX_ACK | BIT(3);
+    if ((segment + 1) < pseg->segment_count) {
+        /* more follows */
+        apdu[0] |= BIT(2);
+    }
+    apdu[1] = pseg->InvokeID;
+    apdu[2] = (uint8_t)segment;
+    apdu[3] = pseg->ProposedWindowSize;
+    apdu[4] = pseg->service_choice;
+    memcpy(&apdu[5], &pseg->data[offset], len);
+    pdu_len += 5 + len;
+    bytes_sent = datalink_send_pdu(
+        &pseg->peer, &pseg->npdu_data, &TSM->Segment_Buffer[0], pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("TSM: Failed to send segment");
+    }
+}
+
+/** Send the segments of the current window of a segmented ComplexACK. */
+static void tsm_segment_window_send(BACNET_TSM_SEGMENT_DATA *pseg)
+{
+    unsigned segment;
+    unsigned last;
+
+    last = pseg->initial_segment + pseg->ActualWindowSize;
+    if (last > pseg->segment_count) {
+        last = pseg->segment_count;
+    }
+    for (segment = pseg->initial_segment; segment < last; segment++) {
+        tsm_segment_send(pseg, (uint16_t)segment);
+    }
+}
+
+/** Send a SegmentACK for the segments received in order so far. */
+static void
+tsm_segment_ack_send(BACNET_TSM_SEGMENT_DATA *pseg, bool negative_ack)
+{
+    BACNET_ADDRESS my_address;
+    int pdu_len;
+    int bytes_sent;
+
+    datalink_get_my_address(&my_address);
+    pdu_len = npdu_encode_pdu(
+        &TSM->Segment_Buffer[0], &pseg->peer, &my_address, &pseg->npdu_data);
+    pdu_len += segmentack_encode_apdu(
+        &TSM->Segment_Buffer[pdu_len], negative_ack, false, pseg->InvokeID,
+        pseg->LastSequenceNumber, pseg->ActualWindowSize);
+    bytes_sent = datalink_send_pdu(
+        &pseg->peer, &pseg->npdu_data, &TSM->Segment_Buffer[0], pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("TSM: Failed to send SegmentACK");
+    }
+}
+
+/** Abort a segmented ComplexACK that we are receiving as the client. */
+static void tsm_segment_abort_send(
+    BACNET_ADDRESS *dest,
+    uint8_t invokeID,
+    uint8_t priority,
+    BACNET_ABORT_REASON reason)
+{
+    BACNET_ADDRESS my_address;
+    BACNET_NPDU_DATA npdu_data;
+    int pdu_len;
+
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, priority);
+    pdu_len = npdu_encode_pdu(
+        &TSM->Segment_Buffer[0], dest, &my_address, &npdu_data);
+    pdu_len += abort_encode_apdu(
+        &TSM->Segment_Buffer[pdu_len], invokeID, reason, false);
+    (void)datalink_send_pdu(
+        dest, &npdu_data, &TSM->Segment_Buffer[0], pdu_len);
+}
+
+/** Add a received segment to the reassembly buffer.
+ *
+ * @return true if the segment fits
+ */
+static bool tsm_segment_append(
+    BACNET_TSM_SEGMENT_DATA *pseg, const uint8_t *data, uint16_t data_len)
+{
+    if (pseg->segments_received >= BACNET_SEGMENTATION_SEGMENTS_MAX) {
+        return false;
+    }
+    if (data_len > (sizeof(pseg->data) - pseg->data_len)) {
+        return false;
+    }
+    if (data_len) {
+        memcpy(&pseg->data[pseg->data_len], data, data_len);
+    }
+    pseg->data_len += data_len;
+    pseg->segments_received++;
+
+    return true;
+}
+
+/** Expire the segment timers. */
+static void tsm_segment_timer(void)
+{
+    unsigned i;
+    uint8_t index;
+    BACNET_TSM_SEGMENT_DATA *pseg;
+
+    for (i = 0; i < BACNET_SEGMENTATION_BUFFERS; i++) {
+        pseg = &TSM->Segment_List[i];
+        if (!pseg->in_use ||
+            tsm_deadline_before(TSM->Milliseconds, pseg->deadline)) {
+            continue;
+        }
+        if (pseg->server) {
+            if (pseg->SegmentRetryCount < apdu_retries()) {
+                pseg->SegmentRetryCount++;
+                tsm_segment_timer_start(pseg);
+                tsm_segment_window_send(pseg);
+            } else {
+                /* the client has gone away */
+                pseg->in_use = false;
+            }
+        } else {
+            pseg->in_use = false;
+            index = tsm_find_invokeID_index(pseg->InvokeID);
+            if (index < MAX_TSM_TRANSACTIONS) {
+                tsm_transaction_fail(index);
+            }
+        }
+    }
+}
+
+/** Send a ComplexACK that is too big for the client in segments.
+ *  The segments are sent from a copy of the ComplexACK, one window of
+ *  segments for each SegmentACK from the client.
+ *
+ * @param dest  Pointer to the BACnet address of the client.
+ * @param npdu_data  Pointer to the NPDU structure of the reply.
+ * @param service_data  The header data of the confirmed request.
+ * @param apdu  The complete unsegmented ComplexACK APDU.
+ * @param apdu_len  Bytes valid in the ComplexACK APDU.
+ *
+ * @return true if the first segment was sent, false if the client can't
+ *  accept this reply, or no segmentation buffer is available.
+ */
+bool tsm_set_segmented_complex_ack(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    BACNET_TSM_SEGMENT_DATA *pseg;
+    uint16_t segment_size;
+    uint16_t data_len;
+    uint32_t segment_count;
+
+    if (!dest || !npdu_data || !service_data || !apdu || (apdu_len < 3)) {
+        return false;
+    }
+    if (!service_data->segmented_response_accepted ||
+        ((apdu[0] & 0xF0) != PDU_TYPE_COMPLEX_ACK)) {
+        return false;
+    }
+    segment_size = apdu_max_length_accepted();
+    if ((service_data->max_resp > 0) &&
+        (service_data->max_resp < segment_size)) {
+        segment_size = (uint16_t)service_data->max_resp;
+    }
+    if (segment_size <= 5) {
+        return false;
+    }
+    /* segmented ComplexACK header */
+    segment_size -= 5;
+    data_len = apdu_len - 3;
+    if (data_len > BACNET_SEGMENTATION_BUFFER_SIZE) {
+        return false;
+    }
+    segment_count = ((uint32_t)data_len + segment_size - 1) / segment_size;
+    /* max-segments-accepted of zero is unspecified, and 65 is more
+       than 64 segments */
+    if ((service_data->max_segs > 0) && (service_data->max_segs <= 64) &&
+        (segment_count > (uint32_t)service_data->max_segs)) {
+        return false;
+    }
+    pseg = tsm_segment_find(service_data->invoke_id, true, dest);
+    if (!pseg) {
+        pseg = tsm_segment_alloc();
+    }
+    if (!pseg) {
+        return false;
+    }
+    pseg->server = true;
+    pseg->InvokeID = service_data->invoke_id;
+    pseg->service_choice = apdu[2];
+    pseg->SegmentRetryCount = 0;
+    pseg->ProposedWindowSize = BACNET_SEGMENTATION_WINDOW_SIZE;
+    /* the first segment is sent alone, and the SegmentACK from the client
+       tells us its actual window size */
+    pseg->ActualWindowSize = 1;
+    pseg->InitialSequenceNumber = 0;
+    pseg->segment_size = segment_size;
+    pseg->segment_count = (uint16_t)segment_count;
+    pseg->initial_segment = 0;
+    bacnet_address_copy(&pseg->peer, dest);
+    npdu_copy_data(&pseg->npdu_data, npdu_data);
+    memcpy(&pseg->data[0], &apdu[3], data_len);
+    pseg->data_len = data_len;
+    tsm_segment_timer_start(pseg);
+    tsm_segment_window_send(pseg);
+
+    return true;
+}
+
+/** Handle a SegmentACK for a segmented ComplexACK that we are sending.
+ *
+ * @param src  Pointer to the BACnet address of the client.
+ * @param apdu  The SegmentACK APDU.
+ * @param apdu_len  Bytes valid in the APDU.
+ */
+void tsm_segment_ack_received(
+    const BACNET_ADDRESS *src, const uint8_t *apdu, uint16_t apdu_len)
+{
+    BACNET_TSM_SEGMENT_DATA *pseg;
+    bool negative_ack = false;
+    bool server = false;
+    uint8_t invoke_id = 0;
+    uint8_t sequence_number = 0;
+    uint8_t window_size = 0;
+    uint8_t delta;
+    uint16_t segment;
+
+    if (segmentack_decode_apdu(
+            apdu, apdu_len, &negative_ack, &server, &invoke_id,
+            &sequence_number, &window_size) <= 0) {
+        return;
+    }
+    if (server) {
+        /* we don't send segmented requests */
+        return;
+    }
+    pseg = tsm_segment_find(invoke_id, true, src);
+    if (!pseg) {
+        return;
+    }
+    /* the next segment to send follows the acknowledged sequence number */
+    delta = (uint8_t)(sequence_number - pseg->InitialSequenceNumber);
+    if (negative_ack && (delta == 0xFF)) {
+        /* none of the current window was received in order */
+        segment = pseg->initial_segment;
+    } else if (delta >= pseg->ActualWindowSize) {
+        /* duplicate ACK */
+        tsm_segment_timer_start(pseg);
+        return;
+    } else {
+        segment = pseg->initial_segment + delta + 1;
+        if (segment >= pseg->segment_count) {
+            /* the final segment was acknowledged */
+            pseg->in_use = false;
+            return;
+        }
+    }
+    if (window_size == 0) {
+        window_size = 1;
+    } else if (window_size > 127) {
+        window_size = 127;
+    }
+    pseg->ActualWindowSize = window_size;
+    pseg->initial_segment = segment;
+    pseg->InitialSequenceNumber = (uint8_t)segment;
+    pseg->SegmentRetryCount = 0;
+    tsm_segment_timer_start(pseg);
+    tsm_segment_window_send(pseg);
+}
+
+/** Handle an Abort from the client of a segmented ComplexACK that
+ *  we are sending, and stop sending it.
+ *
+ * @param src  Pointer to the BACnet address of the client.
+ * @param invokeID  Invoke-ID of the transaction.
+ */
+void tsm_segment_abort_received(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
+    BACNET_TSM_SEGMENT_DATA *pseg;
+
+    pseg = tsm_segment_find(invokeID, true, src);
+    if (pseg) {
+        pseg->in_use = false;
+    }
+}
+
+/** Handle a segment of a segmented ComplexACK to our confirmed request,
+ *  and acknowledge the segments to the server, one SegmentACK per window.
+ *
+ * @param src  Pointer to the BACnet address of the server.
+ * @param service_ack_data  The header data of the segment.
+ * @param service_choice  The service choice of the segment.
+ * @param service_request  The service data of the segment.
+ * @param service_request_len  Bytes valid in the service data.
+ * @param apdu  Pointer to a variable, that takes the reassembled
+ *  service data when the final segment has been received.
+ * @param apdu_len  Pointer to a variable, that takes the count of
+ *  bytes valid in the reassembled service data.
+ *
+ * @return true if the final segment was received and the reassembled
+ *  service data is complete.  The reassembly buffer is released by
+ *  tsm_free_invoke_id().
+ */
+bool tsm_segmented_complex_ack_received(
+    BACNET_ADDRESS *src,
+    const BACNET_CONFIRMED_SERVICE_ACK_DATA *service_ack_data,
+    uint8_t service_choice,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    uint8_t **apdu,
+    uint16_t *apdu_len)
+{
+    uint8_t index;
+    uint8_t sequence_number;
+    BACNET_TSM_DATA *plist;
+    BACNET_TSM_SEGMENT_DATA *pseg;
+
+    if (!src || !service_ack_data || !apdu || !apdu_len) {
+        return false;
+    }
+    index = tsm_find_invokeID_index(service_ack_data->invoke_id);
+    if (index >= MAX_TSM_TRANSACTIONS) {
+        return false;
+    }
+    plist = &TSM->List[index];
+    sequence_number = service_ack_data->sequence_number;
+    if (plist->state == TSM_STATE_AWAIT_CONFIRMATION) {
+        if (sequence_number != 0) {
+            /* the first segment is missing - wait for a retry */
+            return false;
+        }
+        pseg = tsm_segment_alloc();
+        if (!pseg) {
+            tsm_segment_abort_send(
+                src, plist->InvokeID, plist->npdu_data.priority,
+                ABORT_REASON_OUT_OF_RESOURCES);
+            tsm_transaction_fail(index);
+            return false;
+        }
+        tsm_heap_remove(index);
+        plist->state = TSM_STATE_SEGMENTED_CONFIRMATION;
+        BACNET_TRACE2(tsm_state, plist->InvokeID, plist->state);
+        pseg->server = false;
+        pseg->InvokeID = plist->InvokeID;
+        pseg->service_choice = service_choice;
+        pseg->ProposedWindowSize = service_ack_data->proposed_window_number;
+        pseg->ActualWindowSize = pseg->ProposedWindowSize;
+        if (pseg->ActualWindowSize > BACNET_SEGMENTATION_WINDOW_SIZE) {
+            pseg->ActualWindowSize = BACNET_SEGMENTATION_WINDOW_SIZE;
+        } else if (pseg->ActualWindowSize == 0) {
+            pseg->ActualWindowSize = 1;
+        }
+        pseg->InitialSequenceNumber = 0;
+        pseg->LastSequenceNumber = 0;
+        pseg->segments_received = 0;
+        pseg->data_len = 0;
+        bacnet_address_copy(&pseg->peer, src);
+        npdu_encode_npdu_data(
+            &pseg->npdu_data, false, plist->npdu_data.priority);
+    } else if (plist->state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+        pseg = tsm_segment_find(plist->InvokeID, false, NULL);
+        if (!pseg) {
+            return false;
+        }
+        if (sequence_number != (uint8_t)(pseg->LastSequenceNumber + 1)) {
+            /* segment received out of order */
+            pseg->InitialSequenceNumber = pseg->LastSequenceNumber;
+            tsm_segment_ack_send(pseg, true);
+            tsm_segment_timer_start(pseg);
+            return false;
+        }
+        if (service_choice != pseg->service_choice) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    if (!tsm_segment_append(pseg, service_request, service_request_len)) {
+        tsm_segment_abort_send(
+            src, plist->InvokeID, plist->npdu_data.priority,
+            ABORT_REASON_BUFFER_OVERFLOW);
+        pseg->in_use = false;
+        tsm_transaction_fail(index);
+        return false;
+    }
+    pseg->LastSequenceNumber = sequence_number;
+    if (!service_ack_data->more_follows) {
+        tsm_segment_ack_send(pseg, false);
+        *apdu = &pseg->data[0];
+        *apdu_len = pseg->data_len;
+        return true;
+    }
+    if ((sequence_number == 0) ||
+        (sequence_number ==
+         (uint8_t)(pseg->InitialSequenceNumber + pseg->ActualWindowSize))) {
+        tsm_segment_ack_send(pseg, false);
+        pseg->InitialSequenceNumber = sequence_number;
+    }
+    tsm_segment_timer_start(pseg);
+
+    return false;
+}
+#endif
+
 /** Called once a millisecond or slower.
  *  This function calls the handler for a
  *  timeout 'Timeout_Function', if necessary.
@@ -298,47 +977,37 @@ bool tsm_get_transaction_pdu(
  */
 void tsm_timer_milliseconds(uint16_t milliseconds)
 {
-    unsigned i = 0; /* counter */
+    uint8_t index = 0;
     int bytes_sent = 0;
+    BACNET_TSM_DATA *plist = NULL;
 
-    BACNET_TSM_DATA *plist = &TSM_List[0];
-
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->state == TSM_STATE_AWAIT_CONFIRMATION) {
-            if (plist->RequestTimer > milliseconds) {
-                plist->RequestTimer -= milliseconds;
-            } else {
-                plist->RequestTimer = 0;
-            }
-            /* AWAIT_CONFIRMATION */
-            if (plist->RequestTimer == 0) {
-                if (plist->RetryCount < apdu_retries()) {
-                    plist->RequestTimer = apdu_timeout();
-                    plist->RetryCount++;
-                    bytes_sent = datalink_send_pdu(
-                        &plist->dest, &plist->npdu_data, &plist->apdu[0],
-                        plist->apdu_len);
-                    DEBUG_PRINTF(
-                        "invoke-id[%u] Retry %u of %u after %ums\n",
-                        plist->InvokeID, plist->RetryCount, apdu_retries(),
-                        plist->RequestTimer);
-                    if (bytes_sent <= 0) {
-                        debug_perror("invoke-id[%u] Failed to Send Retry");
-                    }
-                } else {
-                    /* note: the invoke id has not been cleared yet
-                       and this indicates a failed message:
-                       IDLE and a valid invoke id */
-                    plist->state = TSM_STATE_IDLE;
-                    if (plist->InvokeID != 0) {
-                        if (Timeout_Function) {
-                            Timeout_Function(plist->InvokeID);
-                        }
-                    }
-                }
+    TSM->Milliseconds += milliseconds;
+    /* only the expired transactions are visited */
+    while ((TSM->Heap_Count > 0) &&
+           !tsm_deadline_before(
+               TSM->Milliseconds, TSM->Deadline[TSM->Heap[0]])) {
+        index = TSM->Heap[0];
+        plist = &TSM->List[index];
+        /* AWAIT_CONFIRMATION */
+        if (plist->RetryCount < apdu_retries()) {
+            tsm_request_timer_start(index);
+            plist->RetryCount++;
+            bytes_sent = datalink_send_pdu(
+                &plist->dest, &plist->npdu_data, &plist->apdu[0],
+                plist->apdu_len);
+            DEBUG_PRINTF(
+                "invoke-id[%u] Retry %u of %u after %ums\n", plist->InvokeID,
+                plist->RetryCount, apdu_retries(), plist->RequestTimer);
+            if (bytes_sent <= 0) {
+                debug_perror("invoke-id[%u] Failed to Send Retry");
             }
+        } else {
+            tsm_transaction_fail(index);
         }
     }
+#if BACNET_SEGMENTATION_ENABLED
+    tsm_segment_timer();
+#endif
 }
 
 /** Frees the invokeID and sets its state to IDLE
@@ -349,12 +1018,31 @@ void tsm_free_invoke_id(uint8_t invokeID)
 {
     uint8_t index;
     BACNET_TSM_DATA *plist;
+#if BACNET_SEGMENTATION_ENABLED
+    BACNET_TSM_SEGMENT_DATA *pseg;
+#endif
 
     index = tsm_find_invokeID_index(invokeID);
     if (index < MAX_TSM_TRANSACTIONS) {
-        plist = &TSM_List[index];
+        plist = &TSM->List[index];
+        tsm_heap_remove(index);
+#if BACNET_SEGMENTATION_ENABLED
+        if (plist->state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+            pseg = tsm_segment_find(invokeID, false, NULL);
+            if (pseg) {
+                pseg->in_use = false;
+            }
+        }
+#endif
         plist->state = TSM_STATE_IDLE;
+        BACNET_TRACE2(tsm_state, plist->InvokeID, plist->state);
         plist->InvokeID = 0;
+        TSM->Completion_Function[index] = NULL;
+        TSM->Completion_Context[index] = NULL;
+        TSM->Index[invokeID] = 0;
+        TSM->Free_List[TSM->Free_Count] = index;
+        TSM->Free_Count++;
+        TSM->Active_Count--;
     }
 }
 
@@ -392,11 +1080,142 @@ bool tsm_invoke_id_failed(uint8_t invokeID)
     if (index < MAX_TSM_TRANSACTIONS) {
         /* a valid invoke ID and the state is IDLE is a
            message that failed to confirm */
-        if (TSM_List[index].state == TSM_STATE_IDLE) {
+        if (TSM->List[index].state == TSM_STATE_IDLE) {
             status = true;
         }
     }
 
     return status;
 }
+
+/** Sets the function called once when the confirmed request of an
+ *  invoke ID completes, by an ACK, Error, Reject, Abort or timeout.
+ *  The reply is then routed to the function instead of the handlers
+ *  set with apdu_set_confirmed_ack_handler() and its kin, and the
+ *  invoke ID is freed before the function is called.
+ *
+ * @param invokeID  Invoke-ID from tsm_next_free_invokeID()
+ * @param pFunction  function called on completion, or NULL
+ * @param context  passed to the function
+ * @return true if the invoke ID is in use and the function was set
+ */
+bool tsm_completion_set(
+    uint8_t invokeID, tsm_completion_function pFunction, void *context)
+{
+    uint8_t index;
+
+    index = tsm_find_invokeID_index(invokeID);
+    if (index < MAX_TSM_TRANSACTIONS) {
+        TSM->Completion_Function[index] = pFunction;
+        TSM->Completion_Context[index] = context;
+        return true;
+    }
+
+    return false;
+}
+
+/** Removes the completion function of an invoke ID, so that its reply
+ *  goes to the service handlers again.
+ *
+ * @param invokeID  Invoke-ID
+ */
+void tsm_completion_clear(uint8_t invokeID)
+{
+    tsm_completion_set(invokeID, NULL, NULL);
+}
+
+/** Routes the completion of a confirmed request to the function set
+ *  for its invoke ID, freeing the invoke ID.
+ *
+ * @param src  address of the peer that replied
+ * @param data  the completion, with the invoke ID
+ * @return true if a completion function was called, false if the
+ *  reply is for the service handlers
+ */
+bool tsm_completion_dispatch(
+    const BACNET_ADDRESS *src, const BACNET_TSM_COMPLETION_DATA *data)
+{
+    uint8_t index;
+    tsm_completion_function pFunction;
+    void *context;
+
+    if (!data) {
+        return false;
+    }
+    index = tsm_find_invokeID_index(data->invoke_id);
+    if (index >= MAX_TSM_TRANSACTIONS) {
+        return false;
+    }
+    pFunction = TSM->Completion_Function[index];
+    if (!pFunction) {
+        return false;
+    }
+    context = TSM->Completion_Context[index];
+    /* free first, so that the function may send the next request */
+    tsm_free_invoke_id(data->invoke_id);
+    pFunction(src, data, context);
+
+    return true;
+}
+
+/** Allocates the state of a transaction state machine, with no
+ *  transactions, for a stack context.
+ *
+ * @return the new context, or NULL if out of memory
+ */
+TSM_CONTEXT *tsm_context_create(void)
+{
+    struct tsm_context *context;
+
+    context = BACNET_MEMPOOL_CALLOC(sizeof(struct tsm_context));
+
+    return context;
+}
+
+/** Frees the state of a transaction state machine. The context must not
+ *  be selected by any thread.
+ *
+ * @param context  context from tsm_context_create()
+ */
+void tsm_context_delete(TSM_CONTEXT *context)
+{
+    if (context && (context != &TSM_Default)) {
+        BACNET_MEMPOOL_FREE(context, sizeof(struct tsm_context));
+    }
+}
+
+/** Selects the transaction state machine used by the TSM functions
+ *  called from this thread. With BACNET_STACK_CONTEXT_THREADS, each
+ *  thread selects its own context; otherwise one context is selected
+ *  for the whole process.
+ *
+ * @param context  context from tsm_context_create(), or NULL for the
+ *  default context
+ * @return the context that was selected before
+ */
+TSM_CONTEXT *tsm_context_select(TSM_CONTEXT *context)
+{
+    struct tsm_context *previous = TSM;
+
+    TSM = context ? context : &TSM_Default;
+
+    return previous;
+}
+
+/** Adds the memory used by the transaction state machines of the
+ *  default context to a report.
+ *
+ * @param usage  report to add the memory used by the TSM to
+ */
+void tsm_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes += sizeof(TSM_Default);
+#if BACNET_SEGMENTATION_ENABLED
+    usage->static_bytes += sizeof(Handler_Segment_Buffer);
+#endif
+    usage->count += TSM_Default.Active_Count;
+}
 #endif
@@ -14,7 +14,9 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/apdu.h"
 #include "bacnet/npdu.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /* note: TSM functionality is optional - only needed if we are
    doing client requests */
@@ -24,14 +26,59 @@ extern "C" {
 #endif /* __cplusplus */
 
 /* FIXME: modify basic service handlers to use TSM rather than this buffer! */
+#if defined(BACNET_APDU_WORKERS)
+/* each worker thread encodes its replies in its own buffer */
+BACNET_STACK_EXPORT extern BACNET_THREAD_LOCAL uint8_t
+    Handler_Transmit_Buffer[MAX_PDU];
+#else
 BACNET_STACK_EXPORT extern uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#endif
+#if BACNET_SEGMENTATION_ENABLED
+/* shared buffer for encoding a reply that is too big for a single APDU */
+BACNET_STACK_EXPORT extern uint8_t
+    Handler_Segment_Buffer[BACNET_SEGMENTATION_BUFFER_SIZE];
+#endif
 
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
 
+/* how a confirmed request completed */
+typedef enum {
+    TSM_COMPLETION_ACK,
+    TSM_COMPLETION_ERROR,
+    TSM_COMPLETION_REJECT,
+    TSM_COMPLETION_ABORT,
+    TSM_COMPLETION_TIMEOUT
+} BACNET_TSM_COMPLETION;
+
+/* the reply that completed a confirmed request */
+typedef struct BACnet_TSM_Completion_Data {
+    BACNET_TSM_COMPLETION status;
+    uint8_t invoke_id;
+    /* service choice of the ACK or Error, otherwise zero */
+    uint8_t service_choice;
+    /* reason of the Reject or Abort, otherwise zero */
+    uint8_t reason;
+    /* error class and code of an Error that is not a complex error */
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+    /* service data of the ComplexACK or Error, otherwise NULL */
+    const uint8_t *service_data;
+    uint16_t service_data_len;
+} BACNET_TSM_COMPLETION_DATA;
+
+/* called once when the confirmed request of an invoke ID completes.
+   src is the address of the peer that replied, or the destination
+   of the request on a timeout. */
+typedef void (*tsm_completion_function)(
+    const BACNET_ADDRESS *src,
+    const BACNET_TSM_COMPLETION_DATA *data,
+    void *context);
+
 #if (!MAX_TSM_TRANSACTIONS)
 #define tsm_free_invoke_id(x) (void)x;
+#define tsm_completion_dispatch(s, d) ((void)(s), (void)(d), false)
 #else
 typedef enum {
     TSM_STATE_IDLE,
@@ -63,7 +110,8 @@ typedef struct BACnet_TSM_Data {
     /*  used to perform timeout on PDU segments */
     /*uint8_t SegmentTimer; */
     /* used to perform timeout on Confirmed Requests */
-    /* in milliseconds */
+    /* in milliseconds - the timeout that was last started; */
+    /* the deadline itself is kept in the TSM timeout heap */
     uint16_t RequestTimer;
     /* unique id */
     uint8_t InvokeID;
@@ -80,6 +128,9 @@ typedef struct BACnet_TSM_Data {
 
 typedef void (*tsm_timeout_function)(uint8_t invoke_id);
 
+/* the state of one transaction state machine */
+typedef struct tsm_context TSM_CONTEXT;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -123,6 +174,49 @@ bool tsm_invoke_id_free(uint8_t invokeID);
 BACNET_STACK_EXPORT
 bool tsm_invoke_id_failed(uint8_t invokeID);
 
+BACNET_STACK_EXPORT
+bool tsm_completion_set(
+    uint8_t invokeID, tsm_completion_function pFunction, void *context);
+BACNET_STACK_EXPORT
+void tsm_completion_clear(uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_completion_dispatch(
+    const BACNET_ADDRESS *src, const BACNET_TSM_COMPLETION_DATA *data);
+
+BACNET_STACK_EXPORT
+TSM_CONTEXT *tsm_context_create(void);
+BACNET_STACK_EXPORT
+void tsm_context_delete(TSM_CONTEXT *context);
+BACNET_STACK_EXPORT
+TSM_CONTEXT *tsm_context_select(TSM_CONTEXT *context);
+
+BACNET_STACK_EXPORT
+void tsm_memory_usage(BACNET_MEMORY_USAGE *usage);
+
+#if BACNET_SEGMENTATION_ENABLED
+BACNET_STACK_EXPORT
+bool tsm_set_segmented_complex_ack(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len);
+BACNET_STACK_EXPORT
+void tsm_segment_ack_received(
+    const BACNET_ADDRESS *src, const uint8_t *apdu, uint16_t apdu_len);
+BACNET_STACK_EXPORT
+void tsm_segment_abort_received(const BACNET_ADDRESS *src, uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_segmented_complex_ack_received(
+    BACNET_ADDRESS *src,
+    const BACNET_CONFIRMED_SERVICE_ACK_DATA *service_ack_data,
+    uint8_t service_choice,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    uint8_t **apdu,
+    uint16_t *apdu_len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -5,6 +5,7 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -247,6 +248,295 @@ void ucix_for_each_section_type(
         cb(e->name, priv);
 }
 
+/* one option of a package, found by section and option name */
+struct ucix_index_option {
+    const char *section;
+    const char *option;
+    struct uci_option *o;
+};
+
+/* one section of a package, with a hash of its type and options */
+struct ucix_index_section {
+    char *name;
+    uint32_t hash;
+};
+
+struct ucix_index {
+    struct uci_context *ctx;
+    char *package;
+    struct ucix_index_option *options;
+    size_t option_count;
+    struct ucix_index_section *sections;
+    size_t section_count;
+};
+
+static uint32_t ucix_hash(uint32_t hash, const char *str)
+{
+    if (str) {
+        while (*str) {
+            hash ^= (uint8_t)*str;
+            hash *= 16777619UL;
+            str++;
+        }
+    }
+    /* separate the strings */
+    hash ^= 0xFF;
+    hash *= 16777619UL;
+    return hash;
+}
+
+static uint32_t ucix_section_hash(struct uci_section *s)
+{
+    struct uci_element *e, *l;
+    struct uci_option *o;
+    uint32_t hash = 2166136261UL;
+
+    hash = ucix_hash(hash, s->type);
+    uci_foreach_element(&s->options, e)
+    {
+        o = uci_to_option(e);
+        hash = ucix_hash(hash, e->name);
+        if (o->type == UCI_TYPE_STRING) {
+            hash = ucix_hash(hash, o->v.string);
+        } else if (o->type == UCI_TYPE_LIST) {
+            uci_foreach_element(&o->v.list, l)
+            {
+                hash = ucix_hash(hash, l->name);
+            }
+        }
+    }
+    return hash;
+}
+
+static int ucix_index_option_compare(const void *a, const void *b)
+{
+    const struct ucix_index_option *x = a;
+    const struct ucix_index_option *y = b;
+    int diff = strcmp(x->section, y->section);
+
+    if (diff == 0) {
+        diff = strcmp(x->option, y->option);
+    }
+    return diff;
+}
+
+static int ucix_index_section_compare(const void *a, const void *b)
+{
+    const struct ucix_index_section *x = a;
+    const struct ucix_index_section *y = b;
+
+    return strcmp(x->name, y->name);
+}
+
+static void ucix_index_sections_free(
+    struct ucix_index_section *sections, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        free(sections[i].name);
+    }
+    free(sections);
+}
+
+/* walk the sections of the package once, and sort its options and
+   sections by name for the lookups */
+static int ucix_index_build(struct ucix_index *idx)
+{
+    struct uci_element *e, *oe;
+    struct uci_section *s;
+    size_t options = 0, sections = 0;
+
+    if (ucix_get_ptr(idx->ctx, idx->package, NULL, NULL, NULL)) {
+        return -1;
+    }
+    uci_foreach_element(&ptr.p->sections, e)
+    {
+        sections++;
+        uci_foreach_element(&uci_to_section(e)->options, oe)
+        {
+            options++;
+        }
+    }
+    idx->options = calloc(options + 1, sizeof(*idx->options));
+    idx->sections = calloc(sections + 1, sizeof(*idx->sections));
+    if (!idx->options || !idx->sections) {
+        return -1;
+    }
+    idx->option_count = 0;
+    idx->section_count = 0;
+    uci_foreach_element(&ptr.p->sections, e)
+    {
+        s = uci_to_section(e);
+        idx->sections[idx->section_count].name = strdup(e->name);
+        if (!idx->sections[idx->section_count].name) {
+            return -1;
+        }
+        idx->sections[idx->section_count].hash = ucix_section_hash(s);
+        idx->section_count++;
+        uci_foreach_element(&s->options, oe)
+        {
+            idx->options[idx->option_count].section = e->name;
+            idx->options[idx->option_count].option = oe->name;
+            idx->options[idx->option_count].o = uci_to_option(oe);
+            idx->option_count++;
+        }
+    }
+    qsort(
+        idx->options, idx->option_count, sizeof(*idx->options),
+        ucix_index_option_compare);
+    qsort(
+        idx->sections, idx->section_count, sizeof(*idx->sections),
+        ucix_index_section_compare);
+    return 0;
+}
+
+struct ucix_index *ucix_index_init(struct uci_context *ctx, const char *p)
+{
+    struct ucix_index *idx;
+
+    if (!ctx || !p) {
+        return NULL;
+    }
+    idx = calloc(1, sizeof(*idx));
+    if (!idx) {
+        return NULL;
+    }
+    idx->ctx = ctx;
+    idx->package = strdup(p);
+    if (!idx->package || ucix_index_build(idx)) {
+        ucix_index_cleanup(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+void ucix_index_cleanup(struct ucix_index *idx)
+{
+    if (!idx) {
+        return;
+    }
+    free(idx->options);
+    ucix_index_sections_free(idx->sections, idx->section_count);
+    free(idx->package);
+    free(idx);
+}
+
+static struct uci_option *
+ucix_index_find(struct ucix_index *idx, const char *s, const char *o)
+{
+    struct ucix_index_option key, *found;
+
+    if (!idx || !s || !o) {
+        return NULL;
+    }
+    key.section = s;
+    key.option = o;
+    found = bsearch(
+        &key, idx->options, idx->option_count, sizeof(*idx->options),
+        ucix_index_option_compare);
+    return found ? found->o : NULL;
+}
+
+const char *
+ucix_index_get_option(struct ucix_index *idx, const char *s, const char *o)
+{
+    struct uci_option *opt = ucix_index_find(idx, s, o);
+
+    if (!opt || (opt->type != UCI_TYPE_STRING)) {
+        return NULL;
+    }
+    return opt->v.string;
+}
+
+int ucix_index_get_option_int(
+    struct ucix_index *idx, const char *s, const char *o, int def)
+{
+    const char *tmp = ucix_index_get_option(idx, s, o);
+    int ret = def;
+
+    if (tmp) {
+        ret = atoi(tmp);
+    }
+    return ret;
+}
+
+int ucix_index_get_list(
+    char *value[254], struct ucix_index *idx, const char *s, const char *o)
+{
+    struct uci_option *opt = ucix_index_find(idx, s, o);
+    struct uci_element *e;
+    int n = 0;
+
+    if (!opt || (opt->type != UCI_TYPE_LIST)) {
+        return 0;
+    }
+    uci_foreach_element(&opt->v.list, e)
+    {
+        if (n >= 254) {
+            break;
+        }
+        value[n] = e->name;
+        n++;
+    }
+    return n;
+}
+
+int ucix_index_reload(
+    struct ucix_index *idx, void (*cb)(const char *, void *), void *priv)
+{
+    struct ucix_index_section *old_sections, *found;
+    size_t old_count, i;
+    int changed = 0;
+
+    if (!idx) {
+        return -1;
+    }
+    if (!ucix_get_ptr(idx->ctx, idx->package, NULL, NULL, NULL) && ptr.p) {
+        uci_unload(idx->ctx, ptr.p);
+    }
+    if (uci_load(idx->ctx, idx->package, NULL) != UCI_OK) {
+        return -1;
+    }
+    old_sections = idx->sections;
+    old_count = idx->section_count;
+    free(idx->options);
+    idx->options = NULL;
+    idx->option_count = 0;
+    idx->sections = NULL;
+    idx->section_count = 0;
+    if (ucix_index_build(idx)) {
+        ucix_index_sections_free(old_sections, old_count);
+        return -1;
+    }
+    /* added or changed sections */
+    for (i = 0; i < idx->section_count; i++) {
+        found = bsearch(
+            &idx->sections[i], old_sections, old_count,
+            sizeof(*old_sections), ucix_index_section_compare);
+        if (!found || (found->hash != idx->sections[i].hash)) {
+            changed++;
+            if (cb) {
+                cb(idx->sections[i].name, priv);
+            }
+        }
+    }
+    /* removed sections */
+    for (i = 0; i < old_count; i++) {
+        found = bsearch(
+            &old_sections[i], idx->sections, idx->section_count,
+            sizeof(*idx->sections), ucix_index_section_compare);
+        if (!found) {
+            changed++;
+            if (cb) {
+                cb(old_sections[i].name, priv);
+            }
+        }
+    }
+    ucix_index_sections_free(old_sections, old_count);
+    return changed;
+}
+
 int ucix_commit(struct uci_context *ctx, const char *p)
 {
     if (ucix_get_ptr(ctx, p, NULL, NULL, NULL)) {
@@ -10,6 +10,9 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 
+/* options of one package, indexed by section and option name */
+struct ucix_index;
+
 BACNET_STACK_EXPORT
 struct uci_context *ucix_init(const char *config_file);
 BACNET_STACK_EXPORT
@@ -77,4 +80,20 @@ void ucix_for_each_section_type(
     const char *t,
     void (*cb)(const char *, void *),
     void *priv);
+BACNET_STACK_EXPORT
+struct ucix_index *ucix_index_init(struct uci_context *ctx, const char *p);
+BACNET_STACK_EXPORT
+void ucix_index_cleanup(struct ucix_index *idx);
+BACNET_STACK_EXPORT
+const char *
+ucix_index_get_option(struct ucix_index *idx, const char *s, const char *o);
+BACNET_STACK_EXPORT
+int ucix_index_get_option_int(
+    struct ucix_index *idx, const char *s, const char *o, int def);
+BACNET_STACK_EXPORT
+int ucix_index_get_list(
+    char *value[254], struct ucix_index *idx, const char *s, const char *o);
+BACNET_STACK_EXPORT
+int ucix_index_reload(
+    struct ucix_index *idx, void (*cb)(const char *, void *), void *priv);
 #endif
@@ -88,6 +88,20 @@
 #define BACDL_SOME_DATALINK_ENABLED 1
 #endif
 
+#if defined(BACDL_LOOPBACK)
+#if defined(BACDL_SOME_DATALINK_ENABLED)
+#define BACDL_MULTIPLE 1
+#endif
+#define BACDL_SOME_DATALINK_ENABLED 1
+#endif
+
+#if defined(BACDL_SHM)
+#if defined(BACDL_SOME_DATALINK_ENABLED)
+#define BACDL_MULTIPLE 1
+#endif
+#define BACDL_SOME_DATALINK_ENABLED 1
+#endif
+
 #if defined(BACDL_CUSTOM)
 #if defined(BACDL_SOME_DATALINK_ENABLED)
 #define BACDL_MULTIPLE 1
@@ -156,7 +170,11 @@
 #define MAX_APDU 480
 #elif defined(BACDL_MSTP) && !defined(BACNET_SECURITY)
 /* note: MS/TP extended frames can be up to 1476 bytes */
+#if defined(BACNET_MSTP_EXTENDED_FRAMES) && BACNET_MSTP_EXTENDED_FRAMES
+#define MAX_APDU 1476
+#else
 #define MAX_APDU 480
+#endif
 #elif defined(BACDL_ETHERNET) && !defined(BACNET_SECURITY)
 #define MAX_APDU 1476
 #elif defined(BACDL_ETHERNET) && defined(BACNET_SECURITY)
@@ -179,6 +197,36 @@
 #if !defined(MAX_TSM_TRANSACTIONS)
 #define MAX_TSM_TRANSACTIONS 255
 #endif
+/* Segmentation of ComplexACK messages: configure to 1 to send large
+   ComplexACK replies in segments and to reassemble segmented ComplexACK
+   replies to our confirmed requests.  Requires the TSM. */
+#if !defined(BACNET_SEGMENTATION_ENABLED)
+#define BACNET_SEGMENTATION_ENABLED 0
+#endif
+#if BACNET_SEGMENTATION_ENABLED
+#if (!MAX_TSM_TRANSACTIONS)
+#error "BACNET_SEGMENTATION_ENABLED requires MAX_TSM_TRANSACTIONS"
+#endif
+/* largest window of segments sent or accepted between SegmentACKs, 1..127 */
+#if !defined(BACNET_SEGMENTATION_WINDOW_SIZE)
+#define BACNET_SEGMENTATION_WINDOW_SIZE 16
+#endif
+/* number of segments accepted in a segmented reply */
+#if !defined(BACNET_SEGMENTATION_SEGMENTS_MAX)
+#define BACNET_SEGMENTATION_SEGMENTS_MAX 32
+#endif
+/* size of each buffer holding a segmented message, up to 65535 octets */
+#if !defined(BACNET_SEGMENTATION_BUFFER_SIZE)
+#define BACNET_SEGMENTATION_BUFFER_SIZE (MAX_APDU * 16)
+#endif
+#if (BACNET_SEGMENTATION_BUFFER_SIZE > 65535)
+#error "BACNET_SEGMENTATION_BUFFER_SIZE must not exceed 65535"
+#endif
+/* number of segmented messages that can be in progress at one time */
+#if !defined(BACNET_SEGMENTATION_BUFFERS)
+#define BACNET_SEGMENTATION_BUFFERS 2
+#endif
+#endif
 /* The address cache is used for binding to BACnet devices */
 /* The number of entries corresponds to the number of */
 /* devices that might respond to an I-Am on the network. */
@@ -465,4 +513,16 @@
 #define BACNET_SVC_RD_A 0
 #endif
 
+/* the heap-free BACNET_MEMPOOL_STATIC profile takes every allocation of the
+   stack from the pools, which are not thread safe, so the options that grow
+   on the heap, or allocate from several threads, are refused */
+#if defined(BACNET_MEMPOOL_STATIC)
+#if defined(BACNET_ROUTED_DEVICES_DYNAMIC)
+#error "BACNET_ROUTED_DEVICES_DYNAMIC grows the routed devices on the heap"
+#endif
+#if defined(BACNET_STACK_CONTEXT_THREADS)
+#error "BACNET_STACK_CONTEXT_THREADS allocates from the pools on many threads"
+#endif
+#endif
+
 #endif
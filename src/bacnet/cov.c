@@ -6,6 +6,7 @@
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
 #include <stdint.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -22,20 +23,16 @@ Unconfirmed COV Notification
 */
 
 /**
- * @brief Encode APDU for COV Notification.
+ * @brief Encode the COV Notification tags ahead of the listOfValues
  * @param apdu  Pointer to the buffer, or NULL for length
  * @param data  Pointer to the data to encode.
- * @return number of bytes encoded, or zero on error.
+ * @return number of bytes encoded
  */
-int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data)
+static int cov_notify_header_encode(uint8_t *apdu, const BACNET_COV_DATA *data)
 {
     int len = 0; /* length of each encoding */
     int apdu_len = 0; /* total length of the apdu, return value */
-    const BACNET_PROPERTY_VALUE *value = NULL; /* value in list */
 
-    if (!data) {
-        return 0;
-    }
     /* tag 0 - subscriberProcessIdentifier */
     len = encode_context_unsigned(apdu, 0, data->subscriberProcessIdentifier);
     apdu_len += len;
@@ -60,9 +57,23 @@ int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data)
     /* tag 3 - timeRemaining */
     len = encode_context_unsigned(apdu, 3, data->timeRemaining);
     apdu_len += len;
-    if (apdu) {
-        apdu += len;
-    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the listOfValues of a COV Notification.
+ * @param apdu  Pointer to the buffer, or NULL for length
+ * @param value_list  Pointer to the first value in the list, or NULL
+ * @return number of bytes encoded
+ */
+int cov_notify_value_list_encode(
+    uint8_t *apdu, const BACNET_PROPERTY_VALUE *value_list)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* total length of the apdu, return value */
+    const BACNET_PROPERTY_VALUE *value = NULL; /* value in list */
+
     /* tag 4 - listOfValues */
     len = encode_opening_tag(apdu, 4);
     apdu_len += len;
@@ -70,7 +81,7 @@ int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data)
         apdu += len;
     }
     /* the first value includes a pointer to the next value, etc */
-    value = data->listOfValues;
+    value = value_list;
     while (value != NULL) {
         len = bacapp_property_value_encode(apdu, value);
         apdu_len += len;
@@ -86,6 +97,31 @@ int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data)
     return apdu_len;
 }
 
+/**
+ * @brief Encode APDU for COV Notification.
+ * @param apdu  Pointer to the buffer, or NULL for length
+ * @param data  Pointer to the data to encode.
+ * @return number of bytes encoded, or zero on error.
+ */
+int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* total length of the apdu, return value */
+
+    if (!data) {
+        return 0;
+    }
+    len = cov_notify_header_encode(apdu, data);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = cov_notify_value_list_encode(apdu, data->listOfValues);
+    apdu_len += len;
+
+    return apdu_len;
+}
+
 /**
  * @brief Encode the COVNotification service request
  * @param apdu  Pointer to the buffer for encoding into
@@ -108,6 +144,42 @@ size_t cov_notify_service_request_encode(
     return apdu_len;
 }
 
+/**
+ * @brief Encode the COVNotification service request using a listOfValues
+ *  already encoded by cov_notify_value_list_encode(), so that the values
+ *  are encoded once for every subscriber of an object.
+ * @param apdu  Pointer to the buffer for encoding into, or NULL for length
+ * @param apdu_size number of bytes available in the buffer
+ * @param data  Pointer to the service data used for encoding the header;
+ *  the listOfValues of the data is not used
+ * @param values  Pointer to the encoded listOfValues
+ * @param values_len  Number of bytes in the encoded listOfValues
+ * @return number of bytes encoded, or zero if unable to encode or too large
+ */
+size_t cov_notify_service_request_values_encode(
+    uint8_t *apdu,
+    size_t apdu_size,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    size_t values_len)
+{
+    size_t apdu_len = 0; /* total length of the apdu, return value */
+
+    if (!data || !values) {
+        return 0;
+    }
+    apdu_len = cov_notify_header_encode(NULL, data);
+    if ((apdu_len + values_len) > apdu_size) {
+        return 0;
+    }
+    if (apdu) {
+        apdu_len = cov_notify_header_encode(apdu, data);
+        memcpy(&apdu[apdu_len], values, values_len);
+    }
+
+    return apdu_len + values_len;
+}
+
 /**
  * Encode APDU for confirmed notification.
  *
@@ -148,6 +220,52 @@ int ccov_notify_encode_apdu(
     return apdu_len;
 }
 
+/**
+ * Encode APDU for confirmed notification using an encoded listOfValues.
+ *
+ * @param apdu  Pointer to the buffer, or NULL for length
+ * @param apdu_size number of bytes available in the buffer
+ * @param invoke_id  ID to invoke for notification
+ * @param data  Pointer to the data to encode, except the listOfValues
+ * @param values  Pointer to the listOfValues from
+ *  cov_notify_value_list_encode()
+ * @param values_len  Number of bytes in the encoded listOfValues
+ *
+ * @return bytes encoded or zero on error.
+ */
+int ccov_notify_values_encode_apdu(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    uint8_t invoke_id,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* return value */
+
+    if (apdu && (apdu_size > 4)) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_COV_NOTIFICATION;
+    }
+    len = 4;
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = cov_notify_service_request_values_encode(
+        apdu, apdu_size - apdu_len, data, values, values_len);
+    if (len > 0) {
+        apdu_len += len;
+    } else {
+        apdu_len = 0;
+    }
+
+    return apdu_len;
+}
+
 /**
  * @brief Encode APDU for unconfirmed notification.
  * @param apdu  Pointer to the buffer for encoding into, or NULL for length
@@ -180,6 +298,47 @@ int ucov_notify_encode_apdu(
     return apdu_len;
 }
 
+/**
+ * @brief Encode APDU for unconfirmed notification using an encoded
+ *  listOfValues.
+ * @param apdu  Pointer to the buffer for encoding into, or NULL for length
+ * @param apdu_size number of bytes available in the buffer
+ * @param data  Pointer to the data to encode, except the listOfValues
+ * @param values  Pointer to the listOfValues from
+ *  cov_notify_value_list_encode()
+ * @param values_len  Number of bytes in the encoded listOfValues
+ * @return number of bytes encoded, or zero if unable to encode or too large
+ */
+int ucov_notify_values_encode_apdu(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* return value */
+
+    if (apdu && (apdu_size > 2)) {
+        apdu[0] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+        apdu[1] = SERVICE_UNCONFIRMED_COV_NOTIFICATION;
+    }
+    len = 2;
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    len = cov_notify_service_request_values_encode(
+        apdu, apdu_size - apdu_len, data, values, values_len);
+    if (len > 0) {
+        apdu_len += len;
+    } else {
+        apdu_len = 0;
+    }
+
+    return apdu_len;
+}
+
 /**
  * @brief Decode the COV-service request only.
  *
@@ -48,6 +48,16 @@ typedef struct BACnet_COV_Notification {
     BACnet_COV_Notification_Callback callback;
 } BACNET_COV_NOTIFICATION;
 
+/* callback from an object when its change-of-value condition trips */
+typedef void (*cov_object_changed_callback)(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+
+/* bulk evaluation of the change-of-value condition of every object of one
+   type: fills a bitmap of the changed objects, indexed by slot, and returns
+   the number of slots and the slot to object instance map */
+typedef unsigned (*cov_object_bulk_function)(
+    uint32_t *bitmap, unsigned bitmap_words, const uint32_t **instances);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -56,13 +66,33 @@ BACNET_STACK_EXPORT
 size_t cov_notify_service_request_encode(
     uint8_t *apdu, size_t apdu_size, const BACNET_COV_DATA *data);
 
+BACNET_STACK_EXPORT
+size_t cov_notify_service_request_values_encode(
+    uint8_t *apdu,
+    size_t apdu_size,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    size_t values_len);
+
 BACNET_STACK_EXPORT
 int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data);
 
+BACNET_STACK_EXPORT
+int cov_notify_value_list_encode(
+    uint8_t *apdu, const BACNET_PROPERTY_VALUE *value_list);
+
 BACNET_STACK_EXPORT
 int ucov_notify_encode_apdu(
     uint8_t *apdu, unsigned max_apdu_len, const BACNET_COV_DATA *data);
 
+BACNET_STACK_EXPORT
+int ucov_notify_values_encode_apdu(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len);
+
 BACNET_STACK_EXPORT
 int ucov_notify_decode_apdu(
     const uint8_t *apdu, unsigned apdu_len, BACNET_COV_DATA *data);
@@ -78,6 +108,15 @@ int ccov_notify_encode_apdu(
     uint8_t invoke_id,
     const BACNET_COV_DATA *data);
 
+BACNET_STACK_EXPORT
+int ccov_notify_values_encode_apdu(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    uint8_t invoke_id,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len);
+
 BACNET_STACK_EXPORT
 int ccov_notify_decode_apdu(
     const uint8_t *apdu,
@@ -66,6 +66,30 @@ int bip_send_mpdu(
 BACNET_STACK_EXPORT
 uint16_t bip_receive(
     BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
+BACNET_STACK_EXPORT
+uint16_t bip_receive_npdu(
+    BACNET_ADDRESS *src,
+    uint8_t *mtu,
+    uint16_t max_mtu,
+    unsigned timeout,
+    uint16_t *npdu_offset);
+#if defined(BACNET_BIP_BATCH)
+BACNET_STACK_EXPORT
+unsigned bip_receive_many(
+    BACNET_DATALINK_PACKET *packets, unsigned max_packets, unsigned timeout);
+BACNET_STACK_EXPORT
+void bip_send_flush(void);
+BACNET_STACK_EXPORT
+void bip_send_batch_set(bool enable);
+BACNET_STACK_EXPORT
+unsigned bip_receive_buffer_set(unsigned size);
+BACNET_STACK_EXPORT
+int bip_send_mpdu_many(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len);
+#endif
 
 /* use host byte order for setting UDP port */
 BACNET_STACK_EXPORT
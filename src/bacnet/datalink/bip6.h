@@ -39,6 +39,8 @@ bool bip6_init(char *ifname);
 BACNET_STACK_EXPORT
 void bip6_cleanup(void);
 BACNET_STACK_EXPORT
+int bip6_get_socket(void);
+BACNET_STACK_EXPORT
 void bip6_join_group(void);
 BACNET_STACK_EXPORT
 void bip6_leave_group(void);
@@ -82,6 +84,18 @@ bool bip6_get_broadcast_addr(BACNET_IP6_ADDRESS *addr);
 BACNET_STACK_EXPORT
 int bip6_send_mpdu(
     const BACNET_IP6_ADDRESS *addr, const uint8_t *mtu, uint16_t mtu_len);
+#if defined(BACNET_BIP_BATCH)
+/* number of datagrams sent with one system call */
+#ifndef BIP6_BATCH_SIZE
+#define BIP6_BATCH_SIZE 16
+#endif
+BACNET_STACK_EXPORT
+int bip6_send_mpdu_many(
+    const BACNET_IP6_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len);
+#endif
 BACNET_STACK_EXPORT
 bool bip6_send_pdu_queue_empty(void);
 BACNET_STACK_EXPORT
@@ -72,6 +72,46 @@
 #define BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM 10
 #endif
 
+/* A node switch opens a direct connection on its own to a peer which
+   gets BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD unicast NPDUs through the
+   hub within BSC_CONF_NODE_SWITCH_PROMOTION_PERIOD_S. A threshold of 0
+   disables the promotion. */
+#ifndef BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD
+#define BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD 0
+#endif
+
+#ifndef BSC_CONF_NODE_SWITCH_PROMOTION_PERIOD_S
+#define BSC_CONF_NODE_SWITCH_PROMOTION_PERIOD_S 10
+#endif
+
+/* number of peers whose unicast traffic is counted for the promotion */
+#ifndef BSC_CONF_NODE_SWITCH_PROMOTION_PEERS_NUM
+#define BSC_CONF_NODE_SWITCH_PROMOTION_PEERS_NUM 8
+#endif
+
+/* A promoted direct connection is closed after it has been idle for this
+   time, and the least recently used one is closed first when the node
+   switch needs a free connection. */
+#ifndef BSC_CONF_NODE_SWITCH_IDLE_TIMEOUT_S
+#define BSC_CONF_NODE_SWITCH_IDLE_TIMEOUT_S 60
+#endif
+
+/* The hub connector doubles its reconnect timeout after each round of
+   failed connections to both hubs, up to this limit, and waits a random
+   time between half and all of it so that the nodes of a site do not
+   reconnect to a restarted hub all at once. */
+#ifndef BSC_CONF_HUB_CONNECTOR_RECONNECT_MAX_S
+#define BSC_CONF_HUB_CONNECTOR_RECONNECT_MAX_S 300
+#endif
+
+/* With a nonzero value the hub connector keeps a second, hot standby
+   connection to the hub which is not in use, so that it switches hubs at
+   once when the connection in use fails, and moves back to the primary
+   hub as soon as that one accepts a connection again. */
+#ifndef BSC_CONF_HUB_CONNECTOR_HOT_STANDBY
+#define BSC_CONF_HUB_CONNECTOR_HOT_STANDBY 0
+#endif
+
 /* Total amount of client(initiator) webosocket connections */
 #ifndef BSC_CONF_CLIENT_CONNECTIONS_NUM
 #define BSC_CONF_CLIENT_CONNECTIONS_NUM       \
@@ -89,8 +129,50 @@
     (BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM * BSC_CONF_NODE_SWITCHES_NUM)
 #endif
 
+#ifndef BSC_CONF_SOCKET_TX_BUFFERED_PACKET_NUM
 #define BSC_CONF_SOCKET_TX_BUFFERED_PACKET_NUM 2
+#endif
+#ifndef BSC_CONF_DATALINK_BUFFERED_PACKET_NUM
 #define BSC_CONF_DATALINK_BUFFERED_PACKET_NUM 10
+#endif
+
+/* The websocket events check the timers of all sockets at most once in
+   this time, so that a busy hub does not walk all of its connections for
+   every received message. */
+#ifndef BSC_CONF_SOCKET_SCAN_INTERVAL_MS
+#define BSC_CONF_SOCKET_SCAN_INTERVAL_MS 100
+#endif
+
+/* Set to 1 to let the TX queue of a socket grow from the heap beyond
+   its BSC_CONF_SOCKET_TX_BUFFERED_PACKET_NUM packets, up to the limit
+   set by bsc_socket_tx_queue_config() */
+#ifndef BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+#define BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC 0
+#endif
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC && defined(BACNET_MEMPOOL_STATIC)
+#error "the heap-free BACNET_MEMPOOL_STATIC profile needs fixed TX queues"
+#endif
+
+/* default limit of a dynamic socket TX queue, in packets */
+#ifndef BSC_CONF_SOCKET_TX_QUEUE_PACKET_NUM
+#define BSC_CONF_SOCKET_TX_QUEUE_PACKET_NUM 64
+#endif
+
+/* Once the TX queue fills up to the high watermark, bsc_send() returns
+   BSC_SC_BUSY until the queue drains to the low watermark.
+   Both are in percent of the TX queue limit. */
+#ifndef BSC_CONF_SOCKET_TX_HIGH_WATERMARK
+#define BSC_CONF_SOCKET_TX_HIGH_WATERMARK 100
+#endif
+#ifndef BSC_CONF_SOCKET_TX_LOW_WATERMARK
+#define BSC_CONF_SOCKET_TX_LOW_WATERMARK 50
+#endif
+
+/* number of BVLC messages, such as the broadcasts of a hub function, */
+/* that can be queued on several sockets at once without a copy */
+#ifndef BSC_CONF_SHARED_FRAME_NUM
+#define BSC_CONF_SHARED_FRAME_NUM 4
+#endif
 
 #define BSC_CONF_SOCK_RX_BUFFER_SIZE BVLC_SC_NPDU_SIZE_CONF
 
@@ -120,6 +202,15 @@
 #define BSC_CONF_WEBSOCKET_ERR_DESC_STR_MAX_LEN 128
 #endif
 
+/* number of libwebsockets service threads of each websocket server */
+#ifndef BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM
+#define BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM 1
+#endif
+
+#if BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM < 1
+#error "BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM must be >= 1"
+#endif
+
 #ifndef BSC_CONF_NODE_MAX_URI_SIZE_IN_ADDRESS_RESOLUTION_ACK
 #define BSC_CONF_NODE_MAX_URI_SIZE_IN_ADDRESS_RESOLUTION_ACK \
     BSC_CONF_WSURL_MAX_LEN
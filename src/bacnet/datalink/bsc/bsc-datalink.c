@@ -6,6 +6,7 @@
  * @copyright SPDX-License-Identifier: MIT
  */
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/trace.h"
 #include <bacnet/basic/sys/fifo.h>
 #include "bacnet/datalink/bsc/bsc-conf.h"
 #include "bacnet/datalink/bsc/bvlc-sc.h"
@@ -15,6 +16,7 @@
 #include "bacnet/datalink/bsc/bsc-event.h"
 #include "bacnet/datalink/bsc/bsc-hub-function.h"
 #include "bacnet/datalink/bsc/bsc-node.h"
+#include "bacnet/datalink/dlstats.h"
 #include "bacnet/bacdef.h"
 #include "bacnet/npdu.h"
 #include "bacnet/bacenum.h"
@@ -92,12 +94,12 @@ static void bsc_node_event(
                 FIFO_Add(&bsc_fifo, (uint8_t *)&pdu16_len, sizeof(pdu16_len));
                 FIFO_Add(&bsc_fifo, pdu, pdu16_len);
                 bsc_event_signal(bsc_data_event);
-            }
+            } else {
+                DLSTATS_DROP(PORT_TYPE_BSC);
 #if DEBUG_ENABLED
-            else {
                 PRINTF("pdu of size %d\n is dropped\n", pdu_len);
-            }
 #endif
+            }
         }
     }
     bws_dispatch_unlock();
@@ -189,6 +191,19 @@ bool bsc_init(char *ifname)
     return false;
 }
 
+/**
+ * @brief Add the memory used by the BACnet/SC datalink buffers to a report
+ * @param usage - report to add the memory used by the datalink to
+ */
+void bsc_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    if (!usage) {
+        return;
+    }
+    usage->static_bytes += sizeof(bsc_fifo_buf) + sizeof(bsc_fifo);
+    usage->static_bytes += sizeof(bsc_conf);
+}
+
 /**
  * @brief Blocking thread-safe bsc_cleanup() function
  *  de-initializes BACnet/SC datalink.
@@ -264,10 +279,15 @@ int bsc_send_pdu(
             pdu_len);
 
         ret = bsc_node_send(bsc_node, buf, len);
+        if (ret == BSC_SC_SUCCESS) {
+            DLSTATS_SEND(PORT_TYPE_BSC, len);
+            BACNET_TRACE1(bsc_send, len);
+        }
         len = pdu_len;
 
         if (ret != BSC_SC_SUCCESS) {
             len = -1;
+            DLSTATS_DROP(PORT_TYPE_BSC);
             PRINTF(
                 "bsc_send_pdu(): bsc_node_send() returned %s\n",
                 bsc_return_code_to_string(ret));
@@ -328,8 +348,11 @@ uint16_t bsc_receive(
             DEBUG_PRINTF("bsc_receive() processing data...\n");
             FIFO_Pull(&bsc_fifo, (uint8_t *)&npdu16_len, sizeof(npdu16_len));
 
+            DLSTATS_RECEIVE(PORT_TYPE_BSC, npdu16_len);
+            BACNET_TRACE1(bsc_receive, npdu16_len);
             if (sizeof(buf) < npdu16_len) {
                 PRINTF("bsc_receive() pdu of size %d is dropped\n", npdu16_len);
+                DLSTATS_DROP(PORT_TYPE_BSC);
                 bsc_remove_packet(npdu16_len);
             } else {
                 FIFO_Pull(&bsc_fifo, buf, npdu16_len);
@@ -340,6 +363,7 @@ uint16_t bsc_receive(
                         "bsc_receive() pdu of size %d is dropped because "
                         "of err = %d, class %d, desc = %s\n",
                         npdu16_len, error_code, error_class, err_desc);
+                    DLSTATS_DECODE_ERROR(PORT_TYPE_BSC);
                     bsc_remove_packet(npdu16_len);
                 } else {
                     if (dm.hdr.origin &&
@@ -353,16 +377,16 @@ uint16_t bsc_receive(
                             dm.payload.encapsulated_npdu.npdu_len);
                         pdu_len =
                             (uint16_t)dm.payload.encapsulated_npdu.npdu_len;
-                    }
+                    } else {
+                        DLSTATS_DROP(PORT_TYPE_BSC);
 #if DEBUG_ENABLED
-                    else {
                         PRINTF(
                             "bsc_receive() pdu of size %d is dropped "
                             "because origin addr is absent or output "
                             "buf of size %d is to small\n",
                             npdu16_len, max_pdu);
-                    }
 #endif
+                    }
                 }
             }
             DEBUG_PRINTF("bsc_receive() pdu_len = %d\n", pdu_len);
@@ -13,6 +13,7 @@
 #include "bacnet/npdu.h"
 #include "bacnet/datalink/bsc/bvlc-sc.h"
 #include "bacnet/datalink/bsc/bsc-retcodes.h"
+#include "bacnet/basic/sys/memusage.h"
 
 /**
  * @brief Blocking thread-safe bsc_init() function
@@ -49,6 +50,14 @@ bool bsc_init(char *ifname);
  */
 BACNET_STACK_EXPORT
 void bsc_cleanup(void);
+
+/**
+ * @brief Adds the memory used by the BACnet/SC datalink buffers
+ *        to a report.
+ * @param usage - report to add the memory used by the datalink to
+ */
+BACNET_STACK_EXPORT
+void bsc_memory_usage(BACNET_MEMORY_USAGE *usage);
 /**
  * @brief Function checks if all needed certificate file are present.
  * @return true if all needed certificate file are present otherwise returns
@@ -5,6 +5,7 @@
  * @date July 2022
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#include <stdlib.h>
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/datalink/bsc/bvlc-sc.h"
 #include "bacnet/datalink/bsc/bsc-socket.h"
@@ -58,6 +59,8 @@ typedef struct BSC_Hub_Connector {
     BSC_SOCKET sock[2];
     BSC_HUB_CONNECTOR_STATE state;
     unsigned int reconnect_timeout_s;
+    /* rounds of failed connections since the last connection */
+    unsigned int reconnect_attempts;
     uint8_t primary_url[BSC_WSURL_MAX_LEN + 1];
     uint8_t failover_url[BSC_WSURL_MAX_LEN + 1];
     struct mstimer t;
@@ -65,6 +68,10 @@ typedef struct BSC_Hub_Connector {
     void *user_arg;
     BACNET_SC_HUB_CONNECTION_STATUS primary_status;
     BACNET_SC_HUB_CONNECTION_STATUS failover_status;
+    /* hot standby connection to the hub which is not in use */
+    bool standby_connecting;
+    bool standby_connected;
+    struct mstimer standby_t;
 } BSC_HUB_CONNECTOR;
 
 #if BSC_CONF_HUB_CONNECTORS_NUM > 0
@@ -151,6 +158,38 @@ static void hub_conector_update_status(
     }
 }
 
+/**
+ * @brief Start the wait before the next round of connections. The wait
+ *  doubles after each failed round up to the configured limit, and is
+ *  a random time between half and all of it.
+ * @param p - pointer to the hub connector
+ */
+static void hub_connector_wait_for_reconnect(BSC_HUB_CONNECTOR *p)
+{
+    unsigned long timeout = p->reconnect_timeout_s * 1000UL;
+    unsigned long limit = BSC_CONF_HUB_CONNECTOR_RECONNECT_MAX_S * 1000UL;
+    unsigned int i;
+
+    if (limit < timeout) {
+        limit = timeout;
+    }
+    for (i = 0; (i < p->reconnect_attempts) && (timeout < limit); i++) {
+        timeout *= 2;
+    }
+    if (timeout > limit) {
+        timeout = limit;
+    }
+    if (timeout < limit) {
+        p->reconnect_attempts++;
+    }
+    timeout = timeout / 2 + (unsigned long)rand() % (timeout / 2 + 1);
+    DEBUG_PRINTF(
+        "hub_connector_wait_for_reconnect() hub = %p wait for %lu ms\n", p,
+        timeout);
+    mstimer_set(&p->t, timeout);
+    p->state = BSC_HUB_CONNECTOR_STATE_WAIT_FOR_RECONNECT;
+}
+
 /**
  * @brief Connect to a BACnet hub
  * @param p - pointer to the hub connector
@@ -170,8 +209,7 @@ static void hub_connector_connect(BSC_HUB_CONNECTOR *p, BSC_HUB_CONN_TYPE type)
         "hub_connector_connect() hub = %p connecting to url %s\n", p, url);
 
     if (url[0] == 0) {
-        mstimer_set(&p->t, p->reconnect_timeout_s * 1000);
-        p->state = BSC_HUB_CONNECTOR_STATE_WAIT_FOR_RECONNECT;
+        hub_connector_wait_for_reconnect(p);
         return;
     }
 
@@ -188,6 +226,132 @@ static void hub_connector_connect(BSC_HUB_CONNECTOR *p, BSC_HUB_CONN_TYPE type)
 #endif
 }
 
+/**
+ * @brief Get the type of the hot standby connection, which is the one
+ *  to the hub not in use
+ * @param p - pointer to the hub connector
+ * @return connection type
+ */
+static BSC_HUB_CONN_TYPE hub_connector_standby_type(BSC_HUB_CONNECTOR *p)
+{
+    return (p->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY)
+        ? BSC_HUB_CONN_FAILOVER
+        : BSC_HUB_CONN_PRIMARY;
+}
+
+/**
+ * @brief Check if a socket is the hot standby connection of a connected
+ *  hub connector
+ * @param p - pointer to the hub connector
+ * @param c - pointer to the socket
+ * @return true if the socket is the hot standby connection
+ */
+static bool hub_connector_is_standby(BSC_HUB_CONNECTOR *p, BSC_SOCKET *c)
+{
+    if (!BSC_CONF_HUB_CONNECTOR_HOT_STANDBY) {
+        return false;
+    }
+    if (p->state != BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY &&
+        p->state != BSC_HUB_CONNECTOR_STATE_CONNECTED_FAILOVER) {
+        return false;
+    }
+    return c == &p->sock[hub_connector_standby_type(p)];
+}
+
+/**
+ * @brief Start the hot standby connection to the hub not in use. If the
+ *  connection can not be started, it is tried again after the reconnect
+ *  timeout.
+ * @param p - pointer to the hub connector
+ */
+static void hub_connector_connect_standby(BSC_HUB_CONNECTOR *p)
+{
+    BSC_HUB_CONN_TYPE type = hub_connector_standby_type(p);
+    char *url = (type == BSC_HUB_CONN_PRIMARY) ? (char *)p->primary_url
+                                               : (char *)p->failover_url;
+
+    if (!BSC_CONF_HUB_CONNECTOR_HOT_STANDBY || url[0] == 0 ||
+        p->standby_connecting || p->standby_connected) {
+        return;
+    }
+    DEBUG_PRINTF(
+        "hub_connector_connect_standby() hub = %p connecting to url %s\n", p,
+        url);
+    if (bsc_connect(&p->ctx, &p->sock[type], url) == BSC_SC_SUCCESS) {
+        p->standby_connecting = true;
+    } else {
+        mstimer_set(&p->standby_t, p->reconnect_timeout_s * 1000UL);
+    }
+}
+
+/**
+ * @brief Handle a connection event of the hot standby connection
+ * @param hc - pointer to the hub connector
+ * @param ev - event
+ * @param disconnect_reason - disconnect reason
+ * @param disconnect_reason_desc - disconnect reason description
+ */
+static void hub_connector_standby_event(
+    BSC_HUB_CONNECTOR *hc,
+    BSC_SOCKET_EVENT ev,
+    BACNET_ERROR_CODE disconnect_reason,
+    const char *disconnect_reason_desc)
+{
+    BSC_HUB_CONN_TYPE type = hub_connector_standby_type(hc);
+    BACNET_SC_HUB_CONNECTION_STATUS *status = (type == BSC_HUB_CONN_PRIMARY)
+        ? &hc->primary_status
+        : &hc->failover_status;
+    BACNET_SC_CONNECTION_STATE st =
+        BACNET_SC_CONNECTION_STATE_DISCONNECTED_WITH_ERRORS;
+
+    if (ev == BSC_SOCKET_EVENT_CONNECTED) {
+        DEBUG_PRINTF(
+            "hub_connector_standby_event() hub_connector = %p standby "
+            "connection of type %d is connected\n",
+            hc, type);
+        hc->standby_connecting = false;
+        hc->standby_connected = true;
+        hub_conector_update_status(
+            status, BACNET_SC_CONNECTION_STATE_CONNECTED, ERROR_CODE_DEFAULT,
+            NULL);
+        if (type == BSC_HUB_CONN_PRIMARY) {
+            /* the primary hub is back, so use it again and keep the
+               connection to the failover hub as the standby one */
+            hc->state = BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY;
+            hc->event_func(
+                BSC_HUBC_EVENT_CONNECTED_PRIMARY, hc, hc->user_arg, NULL, 0,
+                NULL);
+        }
+    } else if (ev == BSC_SOCKET_EVENT_DISCONNECTED) {
+        if (disconnect_reason == ERROR_CODE_NODE_DUPLICATE_VMAC) {
+            DEBUG_PRINTF("hub_connector_standby_event() "
+                         "got ERROR_CODE_NODE_DUPLICATE_VMAC error\n");
+            hub_conector_update_status(
+                status, BACNET_SC_CONNECTION_STATE_FAILED_TO_CONNECT,
+                disconnect_reason, disconnect_reason_desc);
+            hc->state = BSC_HUB_CONNECTOR_STATE_DUPLICATED_VMAC;
+            hc->event_func(
+                BSC_HUBC_EVENT_ERROR_DUPLICATED_VMAC, hc, hc->user_arg, NULL, 0,
+                NULL);
+            return;
+        }
+        if (hc->standby_connecting) {
+            hub_conector_update_status(
+                status, BACNET_SC_CONNECTION_STATE_FAILED_TO_CONNECT,
+                disconnect_reason, disconnect_reason_desc);
+        } else {
+            if (disconnect_reason == ERROR_CODE_WEBSOCKET_CLOSED_BY_PEER ||
+                disconnect_reason == ERROR_CODE_SUCCESS) {
+                st = BACNET_SC_CONNECTION_STATE_NOT_CONNECTED;
+            }
+            hub_conector_update_status(status, st, ERROR_CODE_DEFAULT, NULL);
+        }
+        hc->standby_connecting = false;
+        hc->standby_connected = false;
+        mstimer_set(&hc->standby_t, hc->reconnect_timeout_s * 1000UL);
+    }
+}
+
 /**
  * @brief Process the hub connector state
  * @param c - pointer to the hub connector
@@ -198,6 +362,12 @@ static void hub_connector_process_state(BSC_HUB_CONNECTOR *c)
         if (mstimer_expired(&c->t)) {
             hub_connector_connect(c, BSC_HUB_CONN_PRIMARY);
         }
+    } else if (
+        c->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY ||
+        c->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_FAILOVER) {
+        if (mstimer_expired(&c->standby_t)) {
+            hub_connector_connect_standby(c);
+        }
     }
 }
 
@@ -250,31 +420,38 @@ static void hub_connector_socket_event(
         "pdu = %p, pdu_len = %d\n",
         hc, c, ev, disconnect_reason, disconnect_reason_desc, pdu, pdu_len);
     DEBUG_PRINTF("hub_connector_socket_event() state = %d\n", hc->state);
-    if (ev == BSC_SOCKET_EVENT_CONNECTED) {
+    if (ev != BSC_SOCKET_EVENT_RECEIVED && hub_connector_is_standby(hc, c)) {
+        hub_connector_standby_event(
+            hc, ev, disconnect_reason, disconnect_reason_desc);
+    } else if (ev == BSC_SOCKET_EVENT_CONNECTED) {
         if (hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTING_PRIMARY) {
             DEBUG_PRINTF(
                 "hub_connector_socket_event() hub_connector = %p "
                 "connected primary\n",
                 hc);
             hc->state = BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY;
+            hc->reconnect_attempts = 0;
             hub_conector_update_status(
                 &hc->primary_status, BACNET_SC_CONNECTION_STATE_CONNECTED,
                 ERROR_CODE_DEFAULT, NULL);
             hc->event_func(
                 BSC_HUBC_EVENT_CONNECTED_PRIMARY, hc, hc->user_arg, NULL, 0,
                 NULL);
+            hub_connector_connect_standby(hc);
         } else if (hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTING_FAILOVER) {
             DEBUG_PRINTF(
                 "hub_connector_socket_event() hub_connector = %p "
                 "connected failover\n",
                 hc);
             hc->state = BSC_HUB_CONNECTOR_STATE_CONNECTED_FAILOVER;
+            hc->reconnect_attempts = 0;
             hub_conector_update_status(
                 &hc->failover_status, BACNET_SC_CONNECTION_STATE_CONNECTED,
                 ERROR_CODE_DEFAULT, NULL);
             hc->event_func(
                 BSC_HUBC_EVENT_CONNECTED_FAILOVER, hc, hc->user_arg, NULL, 0,
                 NULL);
+            hub_connector_connect_standby(hc);
         }
     } else if (ev == BSC_SOCKET_EVENT_DISCONNECTED) {
         if (disconnect_reason == ERROR_CODE_NODE_DUPLICATE_VMAC &&
@@ -306,15 +483,11 @@ static void hub_connector_socket_event(
                 disconnect_reason_desc);
             hub_connector_connect(hc, BSC_HUB_CONN_FAILOVER);
         } else if (hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTING_FAILOVER) {
-            DEBUG_PRINTF(
-                "hub_connector_socket_event() wait for %d seconds\n",
-                hc->reconnect_timeout_s);
             hub_conector_update_status(
                 &hc->failover_status,
                 BACNET_SC_CONNECTION_STATE_FAILED_TO_CONNECT, disconnect_reason,
                 disconnect_reason_desc);
-            hc->state = BSC_HUB_CONNECTOR_STATE_WAIT_FOR_RECONNECT;
-            mstimer_set(&hc->t, hc->reconnect_timeout_s * 1000);
+            hub_connector_wait_for_reconnect(hc);
         } else if (
             hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY ||
             hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_FAILOVER) {
@@ -329,9 +502,45 @@ static void hub_connector_socket_event(
                 hub_conector_update_status(
                     &hc->failover_status, st, ERROR_CODE_DEFAULT, NULL);
             }
-            DEBUG_PRINTF(
-                "hub_connector_socket_event() try to connect to primary hub\n");
-            hub_connector_connect(hc, BSC_HUB_CONN_PRIMARY);
+            if (hc->standby_connected) {
+                /* the standby connection is already authenticated and
+                   has its own heartbeat, so send through it at once */
+                DEBUG_PRINTF("hub_connector_socket_event() switch to the "
+                             "standby connection\n");
+                hc->standby_connected = false;
+                mstimer_set(&hc->standby_t, hc->reconnect_timeout_s * 1000UL);
+                if (hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY) {
+                    hc->state = BSC_HUB_CONNECTOR_STATE_CONNECTED_FAILOVER;
+                    hc->event_func(
+                        BSC_HUBC_EVENT_CONNECTED_FAILOVER, hc, hc->user_arg,
+                        NULL, 0, NULL);
+                } else {
+                    hc->state = BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY;
+                    hc->event_func(
+                        BSC_HUBC_EVENT_CONNECTED_PRIMARY, hc, hc->user_arg,
+                        NULL, 0, NULL);
+                }
+            } else if (hc->standby_connecting) {
+                /* the connection to the other hub is on its way */
+                hc->standby_connecting = false;
+                hc->state = (hub_connector_standby_type(hc) ==
+                             BSC_HUB_CONN_PRIMARY)
+                    ? BSC_HUB_CONNECTOR_STATE_CONNECTING_PRIMARY
+                    : BSC_HUB_CONNECTOR_STATE_CONNECTING_FAILOVER;
+            } else if (
+                (hc->state == BSC_HUB_CONNECTOR_STATE_CONNECTED_PRIMARY) &&
+                (hc->failover_url[0] != 0)) {
+                /* the primary hub is likely still down, so switch to the
+                   failover hub at once instead of waiting for a failed
+                   connection to the primary hub */
+                DEBUG_PRINTF("hub_connector_socket_event() try to connect to "
+                             "failover hub\n");
+                hub_connector_connect(hc, BSC_HUB_CONN_FAILOVER);
+            } else {
+                DEBUG_PRINTF("hub_connector_socket_event() try to connect to "
+                             "primary hub\n");
+                hub_connector_connect(hc, BSC_HUB_CONN_PRIMARY);
+            }
         }
     } else if (ev == BSC_SOCKET_EVENT_RECEIVED) {
         DEBUG_PRINTF(
@@ -446,6 +655,7 @@ BSC_SC_RET bsc_hub_connector_start(
         return BSC_SC_NO_RESOURCES;
     }
     c->reconnect_timeout_s = reconnect_timeout_s;
+    c->reconnect_attempts = 0;
     c->primary_url[0] = 0;
     c->failover_url[0] = 0;
     c->user_arg = user_arg;
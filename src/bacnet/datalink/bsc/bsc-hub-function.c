@@ -284,6 +284,7 @@ static void hub_function_socket_event(
     int i;
     uint8_t *p_pdu;
     BSC_HUB_FUNCTION *f;
+    BSC_SHARED_FRAME *frame;
     size_t len;
 
     DEBUG_PRINTF_VERBOSE(
@@ -302,18 +303,40 @@ static void hub_function_socket_event(
         /* although such kind of check is already in bsc-socket.c */
         if (!decoded_pdu->hdr.origin && decoded_pdu->hdr.dest) {
             if (bvlc_sc_is_vmac_broadcast(decoded_pdu->hdr.dest)) {
-                if (bsc_socket_get_global_buf_size() >= pdu_len) {
+                frame = bsc_shared_frame_alloc(pdu, pdu_len);
+                if (frame) {
+                    /* change origin address if presented or add origin */
+                    /* address into pdu by extending of it's header, */
+                    /* once for all of the connections */
+                    frame->pdu_len =
+                        bvlc_sc_set_orig(&frame->pdu, frame->pdu_len, &c->vmac);
+                    for (i = 0; i < sizeof(f->sock) / sizeof(BSC_SOCKET); i++) {
+                        if ((&f->sock[i] != c) &&
+                            (f->sock[i].state == BSC_SOCK_STATE_CONNECTED)) {
+                            ret = bsc_send_shared(&f->sock[i], frame);
+                            if (ret == BSC_SC_SUCCESS) {
+                                DEBUG_PRINTF(
+                                    "BSC-HUB: "
+                                    "sent pdu of %d bytes\n",
+                                    frame->pdu_len);
+                            } else {
+                                DEBUG_PRINTF(
+                                    "BSC-HUB: "
+                                    "sending of reconstructed pdu failed, "
+                                    "err = %s\n",
+                                    bsc_return_code_to_string(ret));
+                            }
+                        }
+                    }
+                    bsc_shared_frame_release(frame);
+                } else if (bsc_socket_get_global_buf_size() >= pdu_len) {
                     p_pdu = bsc_socket_get_global_buf();
                     len = pdu_len;
                     memcpy(p_pdu, pdu, len);
+                    len = (uint16_t)bvlc_sc_set_orig(&p_pdu, len, &c->vmac);
                     for (i = 0; i < sizeof(f->sock) / sizeof(BSC_SOCKET); i++) {
                         if ((&f->sock[i] != c) &&
                             (f->sock[i].state == BSC_SOCK_STATE_CONNECTED)) {
-                            /* change origin address if presented or add origin
-                             */
-                            /* address into pdu by extending of it's header */
-                            len = (uint16_t)bvlc_sc_set_orig(
-                                &p_pdu, len, &c->vmac);
                             ret = bsc_send(&f->sock[i], p_pdu, len);
                             if (ret == BSC_SC_SUCCESS) {
                                 DEBUG_PRINTF(
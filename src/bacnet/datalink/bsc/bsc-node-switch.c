@@ -93,6 +93,16 @@ typedef struct {
     int url_elem;
 } BSC_NODE_SWITCH_URLS;
 
+#if BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD > 0
+/* unicast traffic through the hub to a peer, counted for the promotion */
+typedef struct {
+    bool used;
+    BACNET_SC_VMAC_ADDRESS vmac;
+    unsigned int count;
+    struct mstimer period;
+} BSC_NODE_SWITCH_PEER;
+#endif
+
 typedef struct BSC_Node_Switch_Initiator {
     BSC_SOCKET_CTX ctx;
     BSC_CONTEXT_CFG cfg;
@@ -102,6 +112,14 @@ typedef struct BSC_Node_Switch_Initiator {
     BACNET_SC_VMAC_ADDRESS dest_vmac[BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM];
     struct mstimer t[BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM];
     BSC_NODE_SWITCH_URLS urls[BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM];
+    /* true if the connection was opened by the promotion, which does not
+       report events to the user */
+    bool promoted[BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM];
+    /* restarted each time a PDU is sent or received on the connection */
+    struct mstimer idle[BSC_CONF_NODE_SWITCH_CONNECTIONS_NUM];
+#if BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD > 0
+    BSC_NODE_SWITCH_PEER peer[BSC_CONF_NODE_SWITCH_PROMOTION_PEERS_NUM];
+#endif
     BSC_NODE_SWITCH_STATE state;
 } BSC_NODE_SWITCH_INITIATOR;
 
@@ -591,6 +609,13 @@ static void connect_next_url(BSC_NODE_SWITCH_CTX *ctx, int index)
     while (ret != BSC_SC_SUCCESS) {
         if (ctx->initiator.urls[index].url_elem >=
             ctx->initiator.urls[index].urls_cnt) {
+            if (ctx->initiator.promoted[index]) {
+                /* the traffic keeps going through the hub, and the peer
+                   may be promoted again later */
+                ctx->initiator.sock_state[index] =
+                    BSC_NODE_SWITCH_CONNECTION_STATE_IDLE;
+                break;
+            }
             ctx->initiator.sock_state[index] =
                 BSC_NODE_SWITCH_CONNECTION_STATE_DELAYING;
             mstimer_set(
@@ -623,6 +648,12 @@ static void node_switch_connect_or_delay(
     if (ns->initiator.urls[sock_index].urls_cnt > 0) {
         connect_next_url(ns, sock_index);
     } else if (dest) {
+        /* keep the slot findable by its peer while it connects */
+        if (dest != &ns->initiator.dest_vmac[sock_index]) {
+            memcpy(
+                &ns->initiator.dest_vmac[sock_index].address[0],
+                &dest->address[0], BVLC_SC_VMAC_SIZE);
+        }
         r = bsc_node_get_address_resolution(ns->user_arg, dest);
         if (r && r->urls_num) {
             copy_urls(ns, sock_index, r);
@@ -632,9 +663,6 @@ static void node_switch_connect_or_delay(
             ns->initiator.sock_state[sock_index] =
                 BSC_NODE_SWITCH_CONNECTION_STATE_WAIT_RESOLUTION;
             ns->initiator.urls[sock_index].urls_cnt = 0;
-            memcpy(
-                &ns->initiator.dest_vmac[sock_index].address[0],
-                &dest->address[0], BVLC_SC_VMAC_SIZE);
             mstimer_set(
                 &ns->initiator.t[sock_index],
                 ns->address_resolution_timeout_s * 1000);
@@ -644,6 +672,126 @@ static void node_switch_connect_or_delay(
     }
 }
 
+/**
+ * @brief Restart the idle timer of a node switch initiator connection
+ * @param ns - pointer to the node switch context
+ * @param index - socket index
+ */
+static void node_switch_initiator_touch(BSC_NODE_SWITCH_CTX *ns, int index)
+{
+    mstimer_set(
+        &ns->initiator.idle[index],
+        BSC_CONF_NODE_SWITCH_IDLE_TIMEOUT_S * 1000UL);
+}
+
+/**
+ * @brief Close the least recently used promoted connection, so that its
+ *  slot becomes free once it is disconnected
+ * @param ns - pointer to the node switch context
+ * @param min_idle_ms - minimum time the connection must have been idle
+ * @return true if a connection is being closed
+ */
+static bool node_switch_initiator_evict_lru(
+    BSC_NODE_SWITCH_CTX *ns, unsigned long min_idle_ms)
+{
+    int i;
+    int index = -1;
+    unsigned long elapsed;
+    unsigned long max = 0;
+
+    for (i = 0; i < sizeof(ns->initiator.sock) / sizeof(BSC_SOCKET); i++) {
+        if (ns->initiator.promoted[i] &&
+            ns->initiator.sock_state[i] ==
+                BSC_NODE_SWITCH_CONNECTION_STATE_CONNECTED) {
+            elapsed = mstimer_elapsed(&ns->initiator.idle[i]);
+            if (elapsed >= min_idle_ms && (index == -1 || elapsed > max)) {
+                max = elapsed;
+                index = i;
+            }
+        }
+    }
+    if (index == -1) {
+        return false;
+    }
+    DEBUG_PRINTF(
+        "node_switch_initiator_evict_lru() close socket %d idle for %lu ms\n",
+        index, max);
+    bsc_disconnect(&ns->initiator.sock[index]);
+    ns->initiator.sock_state[index] =
+        BSC_NODE_SWITCH_CONNECTION_STATE_LOCAL_DISCONNECT;
+    return true;
+}
+
+#if BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD > 0
+/**
+ * @brief Count a unicast NPDU which was sent to a peer through the hub,
+ *  and open a direct connection to the peer once it gets enough of them.
+ * @param ns - pointer to the node switch context
+ * @param dest - pointer to the VMAC address of the peer
+ */
+static void
+node_switch_promote_peer(BSC_NODE_SWITCH_CTX *ns, BACNET_SC_VMAC_ADDRESS *dest)
+{
+    BSC_NODE_SWITCH_PEER *peer = &ns->initiator.peer[0];
+    BSC_NODE_SWITCH_PEER *p = NULL;
+    int i;
+
+    for (i = 0; i < BSC_CONF_NODE_SWITCH_PROMOTION_PEERS_NUM; i++) {
+        if (peer[i].used &&
+            !memcmp(
+                &peer[i].vmac.address[0], &dest->address[0],
+                BVLC_SC_VMAC_SIZE)) {
+            p = &peer[i];
+            break;
+        }
+    }
+    if (p && mstimer_expired(&p->period)) {
+        p->count = 0;
+        mstimer_restart(&p->period);
+    }
+    if (!p) {
+        /* take a free entry, or the one with the least traffic */
+        for (i = 0; i < BSC_CONF_NODE_SWITCH_PROMOTION_PEERS_NUM; i++) {
+            if (!peer[i].used || mstimer_expired(&peer[i].period)) {
+                p = &peer[i];
+                break;
+            }
+            if (!p || peer[i].count < p->count) {
+                p = &peer[i];
+            }
+        }
+        p->used = true;
+        p->count = 0;
+        memcpy(&p->vmac.address[0], &dest->address[0], BVLC_SC_VMAC_SIZE);
+        mstimer_set(
+            &p->period, BSC_CONF_NODE_SWITCH_PROMOTION_PERIOD_S * 1000UL);
+    }
+    p->count++;
+    if (p->count < BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD) {
+        return;
+    }
+    p->used = false;
+    if (node_switch_initiator_find_connection_index_for_vmac(dest, ns) != -1) {
+        return;
+    }
+    i = node_switch_initiator_alloc_sock(ns);
+    if (i == -1) {
+        /* the peer is promoted again when it keeps its rate after the
+           least recently used connection is gone */
+        (void)node_switch_initiator_evict_lru(
+            ns, BSC_CONF_NODE_SWITCH_PROMOTION_PERIOD_S * 1000UL);
+        return;
+    }
+    DEBUG_PRINTF(
+        "node_switch_promote_peer() open direct connection %d to %s\n", i,
+        bsc_vmac_to_string(dest));
+    ns->initiator.promoted[i] = true;
+    ns->initiator.urls[i].urls_cnt = 0;
+    node_switch_initiator_touch(ns, i);
+    node_switch_connect_or_delay(ns, dest, i);
+}
+#endif
+
 /**
  * @brief Process a node switch initiator runloop
  * @param ns - pointer to the node switch context
@@ -671,10 +819,27 @@ static void node_switch_initiator_runloop(BSC_NODE_SWITCH_CTX *ns)
             ns->initiator.sock_state[i] ==
             BSC_NODE_SWITCH_CONNECTION_STATE_WAIT_RESOLUTION) {
             if (mstimer_expired(&ns->initiator.t[i])) {
+                if (ns->initiator.promoted[i]) {
+                    ns->initiator.sock_state[i] =
+                        BSC_NODE_SWITCH_CONNECTION_STATE_IDLE;
+                } else {
+                    ns->initiator.sock_state[i] =
+                        BSC_NODE_SWITCH_CONNECTION_STATE_DELAYING;
+                    mstimer_set(
+                        &ns->initiator.t[i], ns->reconnect_timeout_s * 1000);
+                }
+            }
+        } else if (
+            ns->initiator.sock_state[i] ==
+            BSC_NODE_SWITCH_CONNECTION_STATE_CONNECTED) {
+            if (ns->initiator.promoted[i] &&
+                mstimer_expired(&ns->initiator.idle[i])) {
+                DEBUG_PRINTF(
+                    "node_switch_initiator_runloop() close idle socket %d\n",
+                    i);
+                bsc_disconnect(&ns->initiator.sock[i]);
                 ns->initiator.sock_state[i] =
-                    BSC_NODE_SWITCH_CONNECTION_STATE_DELAYING;
-                mstimer_set(
-                    &ns->initiator.t[i], ns->reconnect_timeout_s * 1000);
+                    BSC_NODE_SWITCH_CONNECTION_STATE_LOCAL_DISCONNECT;
             }
         }
     }
@@ -758,6 +923,9 @@ static void node_switch_initiator_socket_event(
         index = node_switch_initiator_get_index(ns, c);
 
         if (index > -1) {
+            if (ev == BSC_SOCKET_EVENT_RECEIVED) {
+                node_switch_initiator_touch(ns, index);
+            }
             elem = ns->initiator.urls[index].url_elem - 1;
             if (elem < 0 || elem >= ns->initiator.urls[index].urls_cnt) {
                 elem = -1;
@@ -781,9 +949,12 @@ static void node_switch_initiator_socket_event(
                                    : (const char *)&ns->initiator.urls[index]
                                          .utf8_urls[elem][0],
                         c, ev, ERROR_CODE_DEFAULT, NULL);
-                    ns->event_func(
-                        BSC_NODE_SWITCH_EVENT_CONNECTED, ns, ns->user_arg,
-                        &ns->initiator.dest_vmac[index], NULL, 0, NULL);
+                    node_switch_initiator_touch(ns, index);
+                    if (!ns->initiator.promoted[index]) {
+                        ns->event_func(
+                            BSC_NODE_SWITCH_EVENT_CONNECTED, ns, ns->user_arg,
+                            &ns->initiator.dest_vmac[index], NULL, 0, NULL);
+                    }
                 } else if (ev == BSC_SOCKET_EVENT_DISCONNECTED) {
                     node_switch_update_status(
                         ns, true, true,
@@ -803,11 +974,18 @@ static void node_switch_initiator_socket_event(
                                    : (const char *)&ns->initiator.urls[index]
                                          .utf8_urls[elem][0],
                         c, ev, disconnect_reason, disconnect_reason_desc);
-                    ns->event_func(
-                        BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns, ns->user_arg,
-                        &ns->initiator.dest_vmac[index], NULL, 0, NULL);
-                    ns->initiator.urls[index].url_elem = 0;
-                    connect_next_url(ns, index);
+                    if (ns->initiator.promoted[index]) {
+                        /* the traffic falls back to the hub */
+                        ns->initiator.sock_state[index] =
+                            BSC_NODE_SWITCH_CONNECTION_STATE_IDLE;
+                    } else {
+                        ns->event_func(
+                            BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns,
+                            ns->user_arg, &ns->initiator.dest_vmac[index],
+                            NULL, 0, NULL);
+                        ns->initiator.urls[index].url_elem = 0;
+                        connect_next_url(ns, index);
+                    }
                 }
             } else if (
                 ns->initiator.sock_state[index] ==
@@ -821,9 +999,12 @@ static void node_switch_initiator_socket_event(
                         c, ev, ERROR_CODE_SUCCESS, NULL);
                     ns->initiator.sock_state[index] =
                         BSC_NODE_SWITCH_CONNECTION_STATE_IDLE;
-                    ns->event_func(
-                        BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns, ns->user_arg,
-                        &ns->initiator.dest_vmac[index], NULL, 0, NULL);
+                    if (!ns->initiator.promoted[index]) {
+                        ns->event_func(
+                            BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns,
+                            ns->user_arg, &ns->initiator.dest_vmac[index],
+                            NULL, 0, NULL);
+                    }
                 }
             }
         }
@@ -856,9 +1037,11 @@ node_switch_initiator_context_event(BSC_SOCKET_CTX *ctx, BSC_CTX_EVENT ev)
                 BSC_NODE_SWITCH_CONNECTION_STATE_CONNECTED) {
                 ns->initiator.sock_state[i] =
                     BSC_NODE_SWITCH_CONNECTION_STATE_IDLE;
-                ns->event_func(
-                    BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns, ns->user_arg,
-                    &ns->initiator.dest_vmac[i], NULL, 0, NULL);
+                if (!ns->initiator.promoted[i]) {
+                    ns->event_func(
+                        BSC_NODE_SWITCH_EVENT_DISCONNECTED, ns, ns->user_arg,
+                        &ns->initiator.dest_vmac[i], NULL, 0, NULL);
+                }
             }
         }
         ns->initiator.state = BSC_NODE_SWITCH_STATE_IDLE;
@@ -1130,8 +1313,11 @@ BSC_SC_RET bsc_node_switch_connect(
         if (urls && urls_cnt) {
             i = node_switch_initiator_alloc_sock(ns);
             if (i == -1) {
+                /* a retry finds the slot free once it is disconnected */
+                (void)node_switch_initiator_evict_lru(ns, 0);
                 ret = BSC_SC_NO_RESOURCES;
             } else {
+                ns->initiator.promoted[i] = false;
                 copy_urls2(ns, i, urls, urls_cnt);
                 ns->initiator.urls[i].url_elem = 0;
                 node_switch_connect_or_delay(ns, NULL, i);
@@ -1140,12 +1326,26 @@ BSC_SC_RET bsc_node_switch_connect(
         } else {
             i = node_switch_initiator_find_connection_index_for_vmac(dest, ns);
             if (i != -1) {
+                if (ns->initiator.promoted[i] &&
+                    ns->initiator.sock_state[i] !=
+                        BSC_NODE_SWITCH_CONNECTION_STATE_LOCAL_DISCONNECT) {
+                    /* the user takes over the promoted connection */
+                    ns->initiator.promoted[i] = false;
+                    if (ns->initiator.sock_state[i] ==
+                        BSC_NODE_SWITCH_CONNECTION_STATE_CONNECTED) {
+                        ns->event_func(
+                            BSC_NODE_SWITCH_EVENT_CONNECTED, ns, ns->user_arg,
+                            &ns->initiator.dest_vmac[i], NULL, 0, NULL);
+                    }
+                }
                 ret = BSC_SC_SUCCESS;
             } else {
                 i = node_switch_initiator_alloc_sock(ns);
                 if (i == -1) {
+                    (void)node_switch_initiator_evict_lru(ns, 0);
                     ret = BSC_SC_NO_RESOURCES;
                 } else {
+                    ns->initiator.promoted[i] = false;
                     ns->initiator.urls[i].urls_cnt = 0;
                     node_switch_connect_or_delay(ns, dest, i);
                     ret = BSC_SC_SUCCESS;
@@ -1268,6 +1468,7 @@ bsc_node_switch_send(BSC_NODE_SWITCH_HANDLE h, uint8_t *pdu, size_t pdu_len)
                 ns->initiator.sock_state[i] ==
                     BSC_NODE_SWITCH_CONNECTION_STATE_CONNECTED) {
                 c = &ns->initiator.sock[i];
+                node_switch_initiator_touch(ns, i);
             }
             if (!c) {
                 c = node_switch_acceptor_find_connection_for_vmac(&dest, ns);
@@ -1279,6 +1480,12 @@ bsc_node_switch_send(BSC_NODE_SWITCH_HANDLE h, uint8_t *pdu, size_t pdu_len)
                 }
             } else {
                 ret = bsc_node_hub_connector_send(ns->user_arg, pdu, pdu_len);
+#if BSC_CONF_NODE_SWITCH_PROMOTION_THRESHOLD > 0
+                if (ns->direct_connect_initiate_enable &&
+                    pdu[0] == BVLC_SC_ENCAPSULATED_NPDU) {
+                    node_switch_promote_peer(ns, &dest);
+                }
+#endif
             }
         }
     }
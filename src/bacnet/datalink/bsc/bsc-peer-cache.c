@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief A bounded cache of the verified peer certificates of BACnet/SC.
+ *
+ * A hub with many reconnecting nodes verifies the same certificate chains
+ * again and again in the TLS handshakes.  The websocket layer looks up the
+ * fingerprint of the peer certificate here before the chain verification,
+ * and adds the fingerprint of each certificate that it verified, with the
+ * identity and the expiry of the certificate.  The handshake still proves
+ * that the peer holds the key of the certificate, so only the verification
+ * of the chain is skipped.
+ *
+ * The cache is emptied when the trust anchors change, which the websocket
+ * layer reports with a digest of its CA certificates, and is emptied by
+ * bsc_peer_cache_invalidate() when a certificate revocation list changes.
+ * When the cache is full, the least recently used certificate is replaced.
+ * The functions are not thread safe: the caller serializes them.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/datalink/bsc/bsc-peer-cache.h"
+
+struct bsc_peer {
+    uint8_t fingerprint[BSC_PEER_FINGERPRINT_SIZE];
+    /* time in seconds when the certificate expires */
+    uint64_t expiry;
+    /* when the certificate was last used, or 0 if the entry is free */
+    uint32_t used;
+    char identity[BSC_PEER_IDENTITY_MAX + 1];
+};
+
+static struct bsc_peer Peer_Cache[BSC_PEER_CACHE_SIZE];
+static uint8_t Trust_Digest[BSC_PEER_FINGERPRINT_SIZE];
+static uint32_t Use_Count;
+
+/**
+ * @brief Get the use count of a lookup or an add
+ * @return use count, never 0
+ */
+static uint32_t bsc_peer_cache_use(void)
+{
+    Use_Count++;
+    if (Use_Count == 0) {
+        /* the entries keep their order within one wrap, which is
+           enough to pick an old entry to replace */
+        Use_Count = 1;
+    }
+
+    return Use_Count;
+}
+
+/**
+ * @brief Find the entry of a certificate fingerprint
+ * @param fingerprint - SHA-256 fingerprint of the certificate
+ * @return the entry, or NULL if not found
+ */
+static struct bsc_peer *bsc_peer_cache_find(const uint8_t *fingerprint)
+{
+    unsigned i;
+
+    for (i = 0; i < BSC_PEER_CACHE_SIZE; i++) {
+        if (Peer_Cache[i].used &&
+            (memcmp(
+                 Peer_Cache[i].fingerprint, fingerprint,
+                 BSC_PEER_FINGERPRINT_SIZE) == 0)) {
+            return &Peer_Cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Look up a peer certificate that was verified before
+ * @param fingerprint - SHA-256 fingerprint of the certificate
+ * @param now - current time in seconds
+ * @param identity - [out] identity of the peer, or NULL
+ * @param identity_size - size of the identity buffer
+ * @return true if the certificate was verified and has not expired
+ */
+bool bsc_peer_cache_lookup(
+    const uint8_t *fingerprint,
+    uint64_t now,
+    char *identity,
+    size_t identity_size)
+{
+    struct bsc_peer *peer;
+
+    if (!fingerprint) {
+        return false;
+    }
+    peer = bsc_peer_cache_find(fingerprint);
+    if (!peer) {
+        return false;
+    }
+    if (now >= peer->expiry) {
+        /* the certificate expired: verify it again, which fails */
+        memset(peer, 0, sizeof(*peer));
+        return false;
+    }
+    peer->used = bsc_peer_cache_use();
+    if (identity && (identity_size > 0)) {
+        strncpy(identity, peer->identity, identity_size - 1);
+        identity[identity_size - 1] = 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Add a peer certificate whose chain was verified
+ * @param fingerprint - SHA-256 fingerprint of the certificate
+ * @param expiry - time in seconds when the certificate expires
+ * @param identity - identity of the peer, or NULL
+ * @param now - current time in seconds
+ */
+void bsc_peer_cache_add(
+    const uint8_t *fingerprint,
+    uint64_t expiry,
+    const char *identity,
+    uint64_t now)
+{
+    struct bsc_peer *peer;
+    unsigned i;
+
+    if (!fingerprint || (expiry <= now)) {
+        return;
+    }
+    peer = bsc_peer_cache_find(fingerprint);
+    if (!peer) {
+        /* a free or expired entry, or else the least recently used one */
+        for (i = 0; i < BSC_PEER_CACHE_SIZE; i++) {
+            if (!Peer_Cache[i].used || (Peer_Cache[i].expiry <= now)) {
+                peer = &Peer_Cache[i];
+                break;
+            }
+            if (!peer || ((int32_t)(Peer_Cache[i].used - peer->used) < 0)) {
+                peer = &Peer_Cache[i];
+            }
+        }
+        memset(peer, 0, sizeof(*peer));
+        memcpy(peer->fingerprint, fingerprint, BSC_PEER_FINGERPRINT_SIZE);
+    }
+    peer->expiry = expiry;
+    if (identity) {
+        strncpy(peer->identity, identity, BSC_PEER_IDENTITY_MAX);
+        peer->identity[BSC_PEER_IDENTITY_MAX] = 0;
+    }
+    peer->used = bsc_peer_cache_use();
+}
+
+/**
+ * @brief Set the digest of the trust anchors, and empty the cache if they
+ *  changed, since the certificates were verified with other anchors
+ * @param trust_digest - SHA-256 digest of the CA certificates
+ * @return true if the trust anchors changed
+ */
+bool bsc_peer_cache_trust_set(const uint8_t *trust_digest)
+{
+    if (!trust_digest ||
+        (memcmp(Trust_Digest, trust_digest, sizeof(Trust_Digest)) == 0)) {
+        return false;
+    }
+    memcpy(Trust_Digest, trust_digest, sizeof(Trust_Digest));
+    bsc_peer_cache_invalidate();
+
+    return true;
+}
+
+/**
+ * @brief Forget every verified peer certificate, such as when a
+ *  certificate revocation list changes
+ */
+void bsc_peer_cache_invalidate(void)
+{
+    memset(Peer_Cache, 0, sizeof(Peer_Cache));
+}
+
+/**
+ * @brief Get the number of verified peer certificates in the cache
+ * @return number of certificates, including any that expired since
+ */
+unsigned bsc_peer_cache_count(void)
+{
+    unsigned i, count = 0;
+
+    for (i = 0; i < BSC_PEER_CACHE_SIZE; i++) {
+        if (Peer_Cache[i].used) {
+            count++;
+        }
+    }
+
+    return count;
+}
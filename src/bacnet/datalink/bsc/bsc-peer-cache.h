@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief API for a bounded cache of the verified peer certificates of
+ *  BACnet/SC, so that a reconnecting peer skips the chain verification
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_DATALINK_BSC_PEER_CACHE_H
+#define BACNET_DATALINK_BSC_PEER_CACHE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* size of a SHA-256 certificate fingerprint */
+#define BSC_PEER_FINGERPRINT_SIZE 32
+
+/* number of verified peer certificates that are remembered */
+#ifndef BSC_PEER_CACHE_SIZE
+#define BSC_PEER_CACHE_SIZE 64
+#endif
+
+/* longest identity, such as the subject common name, of a peer */
+#ifndef BSC_PEER_IDENTITY_MAX
+#define BSC_PEER_IDENTITY_MAX 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool bsc_peer_cache_lookup(
+    const uint8_t *fingerprint,
+    uint64_t now,
+    char *identity,
+    size_t identity_size);
+BACNET_STACK_EXPORT
+void bsc_peer_cache_add(
+    const uint8_t *fingerprint,
+    uint64_t expiry,
+    const char *identity,
+    uint64_t now);
+BACNET_STACK_EXPORT
+bool bsc_peer_cache_trust_set(const uint8_t *trust_digest);
+BACNET_STACK_EXPORT
+void bsc_peer_cache_invalidate(void);
+BACNET_STACK_EXPORT
+unsigned bsc_peer_cache_count(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
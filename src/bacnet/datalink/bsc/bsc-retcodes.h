@@ -14,7 +14,8 @@ typedef enum {
     BSC_SC_SUCCESS = 0,
     BSC_SC_NO_RESOURCES = 1,
     BSC_SC_BAD_PARAM = 2,
-    BSC_SC_INVALID_OPERATION = 3
+    BSC_SC_INVALID_OPERATION = 3,
+    BSC_SC_BUSY = 4
 } BSC_SC_RET;
 
 #endif
@@ -41,19 +41,200 @@ static const char *s_error_no_dest =
 
 static BSC_SOCKET_CTX *bsc_socket_ctx[BSC_SOCKET_CTX_NUM] = { 0 };
 static BVLC_SC_DECODED_MESSAGE bsc_dm = { 0 };
+/* limits how often the websocket events check the socket timers */
+static struct mstimer bsc_scan_timer;
+
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+#define BSC_TX_QUEUE_DEFAULT_SIZE                     \
+    ((BVLC_SC_NPDU_SIZE_CONF + 2 + BSC_CONF_TX_PRE) * \
+     BSC_CONF_SOCKET_TX_QUEUE_PACKET_NUM)
+#else
+#define BSC_TX_QUEUE_DEFAULT_SIZE BSC_TX_BUFFER_SIZE
+#endif
+
+/* limit of the TX queue of a socket, in bytes */
+static size_t bsc_tx_queue_max_size = BSC_TX_QUEUE_DEFAULT_SIZE;
+/* watermarks of the TX queue, in percent of the limit */
+static uint8_t bsc_tx_high_watermark = BSC_CONF_SOCKET_TX_HIGH_WATERMARK;
+static uint8_t bsc_tx_low_watermark = BSC_CONF_SOCKET_TX_LOW_WATERMARK;
+
+/**
+ * @brief Get the TX queue of the socket
+ * @param c - pointer to the socket
+ * @return pointer to the first byte of the TX queue
+ */
+static uint8_t *bsc_tx_buf(BSC_SOCKET *c)
+{
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    if (c->tx_heap) {
+        return c->tx_heap;
+    }
+#endif
+    return c->tx_buf;
+}
+
+/**
+ * @brief Get the size of the TX queue of the socket
+ * @param c - pointer to the socket
+ * @return size of the TX queue in bytes
+ */
+static size_t bsc_tx_buf_capacity(const BSC_SOCKET *c)
+{
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    if (c->tx_heap) {
+        return c->tx_heap_size;
+    }
+#endif
+    return sizeof(c->tx_buf);
+}
+
+/**
+ * @brief Grow the TX queue of the socket, within its limit, so that a
+ *  message of the given length fits.  The queue may move, so any
+ *  TX_BUF_PTR() has to be taken after this call.
+ * @param c - pointer to the socket
+ * @param len - length of the BVLC message to be queued
+ */
+static void bsc_tx_buf_reserve(BSC_SOCKET *c, size_t len)
+{
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    size_t need = c->tx_buf_size + sizeof(uint16_t) + BSC_CONF_TX_PRE + len;
+    size_t size = bsc_tx_buf_capacity(c);
+    uint8_t *buf;
+
+    if ((need <= size) || (size >= bsc_tx_queue_max_size)) {
+        return;
+    }
+    while (size < need) {
+        size *= 2;
+    }
+    if (size > bsc_tx_queue_max_size) {
+        size = bsc_tx_queue_max_size;
+    }
+    if (c->tx_heap) {
+        buf = realloc(c->tx_heap, size);
+    } else {
+        buf = malloc(size);
+        if (buf) {
+            memcpy(buf, c->tx_buf, c->tx_buf_size);
+        }
+    }
+    if (buf) {
+        c->tx_heap = buf;
+        c->tx_heap_size = size;
+    }
+#else
+    (void)c;
+    (void)len;
+#endif
+}
+
+/* pool of the BVLC messages that are queued on several sockets */
+static BSC_SHARED_FRAME bsc_shared_frame[BSC_CONF_SHARED_FRAME_NUM];
+
+/**
+ * @brief Get a queued message from the TX queue.  A queued message is
+ *  its length and BSC_CONF_TX_PRE reserved bytes followed by the message,
+ *  or a zero length followed by a pointer to a shared frame.
+ * @param p - pointer to the queued message
+ * @param payload - returns the pointer to the BVLC message
+ * @param payload_len - returns the length of the BVLC message
+ * @return number of bytes the queued message takes in the TX queue
+ */
+static size_t
+bsc_tx_record_get(uint8_t *p, uint8_t **payload, size_t *payload_len)
+{
+    uint16_t len;
+    BSC_SHARED_FRAME *f;
+
+    memcpy(&len, p, sizeof(len));
+    if (len == 0) {
+        memcpy(&f, &p[sizeof(len)], sizeof(f));
+        *payload = f->pdu;
+        *payload_len = f->pdu_len;
+        return sizeof(len) + sizeof(f);
+    }
+    *payload = &p[sizeof(len) + BSC_CONF_TX_PRE];
+    *payload_len = len;
+
+    return sizeof(len) + BSC_CONF_TX_PRE + len;
+}
+
+/**
+ * @brief Drop the reference of a queued message to its shared frame
+ * @param p - pointer to the queued message
+ */
+static void bsc_tx_record_release(const uint8_t *p)
+{
+    uint16_t len;
+    BSC_SHARED_FRAME *f;
+
+    memcpy(&len, p, sizeof(len));
+    if (len == 0) {
+        memcpy(&f, &p[sizeof(len)], sizeof(f));
+        bsc_shared_frame_release(f);
+    }
+}
+
+/**
+ * @brief Remove the queued messages which were sent from the TX queue
+ * @param c - pointer to the socket
+ * @param p - pointer to the first queued message which was not sent
+ */
+static void bsc_tx_buf_sent(BSC_SOCKET *c, uint8_t *p)
+{
+    uint8_t *buf = bsc_tx_buf(c);
+
+    if ((c->tx_buf_size > 0) && (p != buf)) {
+        memmove(buf, p, c->tx_buf_size);
+    }
+}
+
+/**
+ * @brief Empty the TX queue of the socket
+ * @param c - pointer to the socket
+ */
+static void bsc_tx_buf_clear(BSC_SOCKET *c)
+{
+    uint8_t *p = bsc_tx_buf(c);
+    uint8_t *payload;
+    size_t payload_len;
+    size_t offset = 0;
+
+    while (offset < c->tx_buf_size) {
+        bsc_tx_record_release(&p[offset]);
+        offset += bsc_tx_record_get(&p[offset], &payload, &payload_len);
+    }
+    c->tx_buf_size = 0;
+    c->tx_throttled = false;
+}
+
+/**
+ * @brief Release the TX queue memory of the socket, and empty the queue
+ * @param c - pointer to the socket
+ */
+static void bsc_tx_buf_release(BSC_SOCKET *c)
+{
+    bsc_tx_buf_clear(c);
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    free(c->tx_heap);
+    c->tx_heap = NULL;
+    c->tx_heap_size = 0;
+#endif
+}
 
 #define TX_BUF_PTR(c) \
-    &c->tx_buf[c->tx_buf_size + sizeof(uint16_t) + BSC_CONF_TX_PRE]
+    &bsc_tx_buf(c)[c->tx_buf_size + sizeof(uint16_t) + BSC_CONF_TX_PRE]
 
-#define TX_BUF_UPDATE(c, len)                                   \
-    memcpy(&c->tx_buf[c->tx_buf_size], &len, sizeof(uint16_t)); \
+#define TX_BUF_UPDATE(c, len)                                        \
+    memcpy(&bsc_tx_buf(c)[c->tx_buf_size], &len, sizeof(uint16_t)); \
     c->tx_buf_size += sizeof(uint16_t) + BSC_CONF_TX_PRE + len
 
-#define TX_BUF_BYTES_AVAIL(c)                                       \
-    (((sizeof(c->tx_buf) - c->tx_buf_size) >=                       \
-      (sizeof(uint16_t) + BSC_CONF_TX_PRE))                         \
-         ? (sizeof(c->tx_buf) - c->tx_buf_size - sizeof(uint16_t) - \
-            BSC_CONF_TX_PRE)                                        \
+#define TX_BUF_BYTES_AVAIL(c)                                              \
+    (((bsc_tx_buf_capacity(c) - c->tx_buf_size) >=                         \
+      (sizeof(uint16_t) + BSC_CONF_TX_PRE))                                \
+         ? (bsc_tx_buf_capacity(c) - c->tx_buf_size - sizeof(uint16_t) - \
+            BSC_CONF_TX_PRE)                                               \
          : 0)
 
 /**
@@ -96,7 +277,7 @@ static void bsc_reset_socket(BSC_SOCKET *c)
 {
     memset(&c->vmac, 0, sizeof(c->vmac));
     memset(&c->uuid, 0, sizeof(c->uuid));
-    c->tx_buf_size = 0;
+    bsc_tx_buf_clear(c);
 }
 
 /**
@@ -294,6 +475,7 @@ static bool bsc_prepare_error_extended(
     DEBUG_PRINTF(
         "                              message_id = %04x\n", message_id);
 
+    bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
     len = bvlc_sc_encode_result(
         TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id, origin, dest,
         bvlc_function, 1, error_header_marker, &eclass, &ecode,
@@ -384,6 +566,7 @@ static void bsc_set_socket_idle(BSC_SOCKET *c)
 {
     c->state = BSC_SOCK_STATE_IDLE;
     c->wh = BSC_WEBSOCKET_INVALID_HANDLE;
+    bsc_tx_buf_release(c);
 }
 
 /**
@@ -487,6 +670,7 @@ static void bsc_process_socket_connected_state(
             "request with message id %04x\n",
             dm->hdr.message_id);
         message_id = dm->hdr.message_id;
+        bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
         len = bvlc_sc_encode_heartbeat_ack(
             TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id);
         if (len) {
@@ -505,6 +689,7 @@ static void bsc_process_socket_connected_state(
             "request with message id %04x\n",
             dm->hdr.message_id);
         message_id = dm->hdr.message_id;
+        bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
         len = bvlc_sc_encode_disconnect_ack(
             TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id);
         if (len) {
@@ -555,6 +740,51 @@ static void bsc_process_socket_connected_state(
     DEBUG_PRINTF_VERBOSE("bsc_process_socket_connected_state() <<<\n");
 }
 
+/**
+ * @brief Read only the header of a message that a hub function forwards.
+ *  The hub function needs the BVLC function, origin, and destination of a
+ *  message from a node, and rewrites the addresses in place, so the header
+ *  options and payload are left for the destination node to decode.
+ * @param c - pointer to the socket
+ * @param dm - pointer to the decoded message, only its header is filled
+ * @param buf - pointer to the buffer
+ * @param buflen - buffer size
+ * @return true if the message is forwarded without the full decode
+ */
+static bool bsc_peek_forwarded_message(
+    BSC_SOCKET *c, BVLC_SC_DECODED_MESSAGE *dm, uint8_t *buf, size_t buflen)
+{
+    if ((c->state != BSC_SOCK_STATE_CONNECTED) ||
+        (c->ctx->cfg->type != BSC_SOCKET_CTX_ACCEPTOR) ||
+        (c->ctx->cfg->proto != BSC_WEBSOCKET_HUB_PROTOCOL)) {
+        return false;
+    }
+    if (!bvlc_sc_peek_hdr(buf, buflen, &dm->hdr, NULL, NULL)) {
+        return false;
+    }
+    /* a header that the hub function would reject is fully decoded,
+       so that the error reply is the same as before */
+    if (!dm->hdr.dest || dm->hdr.origin) {
+        return false;
+    }
+    switch (dm->hdr.bvlc_function) {
+        case BVLC_SC_RESULT:
+        case BVLC_SC_ENCAPSULATED_NPDU:
+        case BVLC_SC_ADDRESS_RESOLUTION:
+        case BVLC_SC_ADDRESS_RESOLUTION_ACK:
+        case BVLC_SC_ADVERTISIMENT:
+        case BVLC_SC_ADVERTISIMENT_SOLICITATION:
+            break;
+        default:
+            return false;
+    }
+    memset(dm->data_options, 0, sizeof(dm->data_options));
+    memset(dm->dest_options, 0, sizeof(dm->dest_options));
+    memset(&dm->payload, 0, sizeof(dm->payload));
+
+    return true;
+}
+
 /**
  * @brief Process the socket state
  * @param c - pointer to the socket
@@ -585,7 +815,8 @@ static void bsc_process_socket_state(
         c->ctx, c, c->state, rx_buf, rx_buf_size);
 
     if (rx_buf) {
-        if (!bvlc_sc_decode_message(
+        if (!bsc_peek_forwarded_message(c, dm, rx_buf, rx_buf_size) &&
+            !bvlc_sc_decode_message(
                 rx_buf, rx_buf_size, dm, &error_code, &error_class,
                 &err_desc)) {
             /* we use this error code+class to indicate that the received bvlc
@@ -718,6 +949,7 @@ static void bsc_process_socket_state(
                     "BSC-Socket: heartbeat message id %04x\n",
                     c->expected_heartbeat_message_id);
 
+                bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
                 len = bvlc_sc_encode_heartbeat_request(
                     TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c),
                     c->expected_heartbeat_message_id);
@@ -747,6 +979,21 @@ static void bsc_process_socket_state(
     DEBUG_PRINTF_VERBOSE("bsc_process_socket_state() <<<\n");
 }
 
+/**
+ * @brief Set the time of the first heartbeat request of a connection to
+ *  a random time between half and all of the heartbeat timeout, so that
+ *  connections made at once do not send their heartbeats at once.
+ *  Every received message sets the time again to the full timeout.
+ * @param c - pointer to the socket
+ */
+static void bsc_set_first_heartbeat(BSC_SOCKET *c)
+{
+    unsigned long timeout = c->ctx->cfg->heartbeat_timeout_s * 1000UL;
+
+    timeout = timeout / 2 + (unsigned long)rand() % (timeout / 2 + 1);
+    mstimer_set(&c->heartbeat, timeout);
+}
+
 /**
  * @brief Run the socket loop
  * @param s - pointer to the socket
@@ -784,7 +1031,11 @@ static void bsc_runloop_socket(
 }
 
 /**
- * @brief Run the socket maintenance timer process
+ * @brief Run the socket maintenance timer process. Received messages
+ *  restart the heartbeat timeout of their socket when they are processed,
+ *  so this only checks the timers. The checks made with zero seconds from
+ *  the websocket events run at most once in
+ *  BSC_CONF_SOCKET_SCAN_INTERVAL_MS.
  * @param seconds - time in seconds
  */
 void bsc_socket_maintenance_timer(uint16_t seconds)
@@ -793,6 +1044,11 @@ void bsc_socket_maintenance_timer(uint16_t seconds)
     DEBUG_PRINTF_VERBOSE(
         "bsc_socket_maintenance_timer(%us) >>>\n", (unsigned)seconds);
     bws_dispatch_lock();
+    if ((seconds == 0) && !mstimer_expired(&bsc_scan_timer)) {
+        bws_dispatch_unlock();
+        return;
+    }
+    mstimer_set(&bsc_scan_timer, BSC_CONF_SOCKET_SCAN_INTERVAL_MS);
     for (i = 0; i < BSC_SOCKET_CTX_NUM; i++) {
         if (bsc_socket_ctx[i] != NULL) {
             if (bsc_socket_ctx[i]->state == BSC_CTX_STATE_INITIALIZED) {
@@ -870,6 +1126,7 @@ static void bsc_process_srv_awaiting_request(
             c->max_bvlc_len = dm->payload.connect_request.max_bvlc_len;
             message_id = dm->hdr.message_id;
 
+            bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_connect_accept(
                 TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id,
                 &c->ctx->cfg->local_vmac, &c->ctx->cfg->local_uuid,
@@ -899,6 +1156,7 @@ static void bsc_process_srv_awaiting_request(
             existing->expected_disconnect_message_id =
                 bsc_get_next_message_id();
 
+            bsc_tx_buf_reserve(existing, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_disconnect_request(
                 TX_BUF_PTR(existing), TX_BUF_BYTES_AVAIL(existing),
                 existing->expected_disconnect_message_id);
@@ -953,6 +1211,7 @@ static void bsc_process_srv_awaiting_request(
                     dm->payload.connect_request.uuid,
                     ERROR_CODE_NODE_DUPLICATE_VMAC, NULL);
             }
+            bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_result(
                 TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id, NULL, NULL,
                 BVLC_SC_CONNECT_REQUEST, 1, NULL, &uclass, &ucode, NULL);
@@ -1005,6 +1264,7 @@ static void bsc_process_srv_awaiting_request(
                     c->ctx, c, &c->vmac, &c->uuid,
                     ERROR_CODE_NODE_DUPLICATE_VMAC, NULL);
             }
+            bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_result(
                 TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id, NULL, NULL,
                 BVLC_SC_CONNECT_REQUEST, 1, NULL, &uclass, &ucode, NULL);
@@ -1030,6 +1290,7 @@ static void bsc_process_srv_awaiting_request(
 
         message_id = dm->hdr.message_id;
 
+        bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
         len = bvlc_sc_encode_connect_accept(
             TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c), message_id,
             &c->ctx->cfg->local_vmac, &c->ctx->cfg->local_uuid,
@@ -1095,8 +1356,10 @@ static void bsc_dispatch_srv_func(
     BSC_SOCKET *c = NULL;
     BSC_WEBSOCKET_RET wret;
     uint8_t *p;
+    uint8_t *payload;
+    size_t payload_len;
     bool failed = false;
-    uint16_t len;
+    size_t len;
     size_t i;
 
     (void)sh;
@@ -1189,17 +1452,18 @@ static void bsc_dispatch_srv_func(
                 c, bsc_socket_state_to_string(c->state), bufsize);
         }
     } else if (ev == BSC_WEBSOCKET_SENDABLE) {
-        p = c->tx_buf;
+        p = bsc_tx_buf(c);
 
         while (c->tx_buf_size > 0) {
-            memcpy(&len, p, sizeof(len));
+            len = bsc_tx_record_get(p, &payload, &payload_len);
             wret = bws_srv_dispatch_send(
-                c->ctx->sh, c->wh, &p[sizeof(len) + BSC_CONF_TX_PRE], len);
+                c->ctx->sh, c->wh, payload, payload_len);
             if (wret != BSC_WEBSOCKET_SUCCESS) {
                 DEBUG_PRINTF(
                     "bsc_dispatch_srv_func() send data failed. "
                     "Error=%s, start disconnect operation on socket %p\n",
                     bsc_websocket_return_to_string(wret), c);
+                bsc_tx_buf_sent(c, p);
                 bsc_srv_process_error(
                     c,
                     c->state != BSC_SOCK_STATE_ERROR_FLUSH_TX
@@ -1208,8 +1472,9 @@ static void bsc_dispatch_srv_func(
                 failed = true;
                 break;
             } else {
-                c->tx_buf_size -= len + sizeof(len) + BSC_CONF_TX_PRE;
-                p += len + sizeof(len) + BSC_CONF_TX_PRE;
+                bsc_tx_record_release(p);
+                c->tx_buf_size -= len;
+                p += len;
             }
         }
 
@@ -1268,7 +1533,7 @@ static void bsc_process_cli_awaiting_accept(
             bsc_copy_uuid(&c->uuid, dm->payload.connect_accept.uuid);
             c->max_bvlc_len = dm->payload.connect_accept.max_bvlc_len;
             c->max_npdu_len = dm->payload.connect_accept.max_npdu_len;
-            mstimer_set(&c->heartbeat, c->ctx->cfg->heartbeat_timeout_s * 1000);
+            bsc_set_first_heartbeat(c);
             c->state = BSC_SOCK_STATE_CONNECTED;
             c->ctx->funcs->socket_event(
                 c, BSC_SOCKET_EVENT_CONNECTED, 0, NULL, NULL, 0, NULL);
@@ -1360,9 +1625,10 @@ static void bsc_dispatch_cli_func(
     BSC_SOCKET_CTX *ctx = (BSC_SOCKET_CTX *)dispatch_func_user_param;
     BSC_SOCKET *c;
     size_t len;
-    uint16_t pdu_len;
     BSC_WEBSOCKET_RET wret;
     uint8_t *p;
+    uint8_t *payload;
+    size_t payload_len;
     size_t i;
     bool all_socket_disconnected = true;
     bool failed = false;
@@ -1441,6 +1707,7 @@ static void bsc_dispatch_cli_func(
                 bsc_uuid_to_string(&ctx->cfg->local_uuid),
                 bsc_vmac_to_string(&ctx->cfg->local_vmac));
 
+            bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_connect_request(
                 TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c),
                 c->expected_connect_accept_message_id, &ctx->cfg->local_vmac,
@@ -1455,19 +1722,20 @@ static void bsc_dispatch_cli_func(
             bws_cli_send(c->wh);
         }
     } else if (ev == BSC_WEBSOCKET_SENDABLE) {
-        p = c->tx_buf;
+        p = bsc_tx_buf(c);
 
         while (c->tx_buf_size > 0) {
-            memcpy(&pdu_len, p, sizeof(pdu_len));
+            len = bsc_tx_record_get(p, &payload, &payload_len);
             DEBUG_PRINTF(
-                "bsc_dispatch_cli_func() sending pdu of %d bytes\n", pdu_len);
-            wret = bws_cli_dispatch_send(
-                c->wh, &p[sizeof(pdu_len) + BSC_CONF_TX_PRE], pdu_len);
+                "bsc_dispatch_cli_func() sending pdu of %d bytes\n",
+                (int)payload_len);
+            wret = bws_cli_dispatch_send(c->wh, payload, payload_len);
             if (wret != BSC_WEBSOCKET_SUCCESS) {
                 DEBUG_PRINTF(
                     "bsc_dispatch_cli_func() pdu send failed, err = %d, start "
                     "disconnect operation on socket %p\n",
                     wret, c);
+                bsc_tx_buf_sent(c, p);
                 bsc_cli_process_error(
                     c,
                     c->state != BSC_SOCK_STATE_ERROR_FLUSH_TX
@@ -1476,8 +1744,9 @@ static void bsc_dispatch_cli_func(
                 failed = true;
                 break;
             } else {
-                c->tx_buf_size -= pdu_len + sizeof(pdu_len) + BSC_CONF_TX_PRE;
-                p += pdu_len + sizeof(pdu_len) + BSC_CONF_TX_PRE;
+                bsc_tx_record_release(p);
+                c->tx_buf_size -= len;
+                p += len;
             }
         }
         if (!failed) {
@@ -1563,6 +1832,11 @@ BSC_SC_RET bsc_init_ctx(
     ctx->sock_num = sockets_num;
 
     for (i = 0; i < sockets_num; i++) {
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+        /* sockets of an idle context own no TX queue memory */
+        ctx->sock[i].tx_heap = NULL;
+#endif
+        ctx->sock[i].tx_buf_size = 0;
         bsc_set_socket_idle(&ctx->sock[i]);
     }
 
@@ -1663,7 +1937,7 @@ BSC_SC_RET bsc_connect(BSC_SOCKET_CTX *ctx, BSC_SOCKET *c, char *url)
             ctx->cfg->type == BSC_SOCKET_CTX_INITIATOR) {
             c->ctx = ctx;
             c->state = BSC_SOCK_STATE_AWAITING_WEBSOCKET;
-            c->tx_buf_size = 0;
+            bsc_tx_buf_clear(c);
             wret = bws_cli_connect(
                 ctx->cfg->proto, url, ctx->cfg->ca_cert_chain,
                 ctx->cfg->ca_cert_chain_size, ctx->cfg->cert_chain,
@@ -1701,6 +1975,7 @@ void bsc_disconnect(BSC_SOCKET *c)
             c->expected_disconnect_message_id = bsc_get_next_message_id();
             c->state = BSC_SOCK_STATE_DISCONNECTING;
             mstimer_set(&c->t, c->ctx->cfg->disconnect_timeout_s * 1000);
+            bsc_tx_buf_reserve(c, BVLC_SC_NPDU_SIZE_CONF);
             len = bvlc_sc_encode_disconnect_request(
                 TX_BUF_PTR(c), TX_BUF_BYTES_AVAIL(c),
                 c->expected_disconnect_message_id);
@@ -1758,11 +2033,25 @@ BSC_SC_RET bsc_send(BSC_SOCKET *c, uint8_t *pdu, size_t pdu_len)
             c->state != BSC_SOCK_STATE_CONNECTED) {
             ret = BSC_SC_INVALID_OPERATION;
         } else {
-            if (TX_BUF_BYTES_AVAIL(c) < pdu_len) {
+            if (c->tx_throttled &&
+                (c->tx_buf_size >
+                 bsc_tx_queue_max_size * bsc_tx_low_watermark / 100)) {
+                ret = BSC_SC_BUSY;
+            } else {
+                c->tx_throttled = false;
+                bsc_tx_buf_reserve(c, pdu_len);
+            }
+            if (ret != BSC_SC_SUCCESS) {
+                /* wait for the TX queue to drain */
+            } else if (TX_BUF_BYTES_AVAIL(c) < pdu_len) {
                 ret = BSC_SC_NO_RESOURCES;
             } else {
                 memcpy(TX_BUF_PTR(c), pdu, pdu_len);
                 TX_BUF_UPDATE(c, pdu_len);
+                if (c->tx_buf_size >=
+                    bsc_tx_queue_max_size * bsc_tx_high_watermark / 100) {
+                    c->tx_throttled = true;
+                }
                 if (c->ctx->cfg->type == BSC_SOCKET_CTX_INITIATOR) {
                     bws_cli_send(c->wh);
                 } else {
@@ -1778,6 +2067,151 @@ BSC_SC_RET bsc_send(BSC_SOCKET *c, uint8_t *pdu, size_t pdu_len)
     return ret;
 }
 
+/**
+ * @brief Take a frame from the shared frame pool, and copy the pdu into it
+ * @param pdu - pointer to the PDU
+ * @param pdu_len - PDU length
+ * @return the shared frame with one reference, or NULL
+ */
+BSC_SHARED_FRAME *bsc_shared_frame_alloc(const uint8_t *pdu, size_t pdu_len)
+{
+    BSC_SHARED_FRAME *f = NULL;
+    size_t i;
+
+    if (!pdu || !pdu_len || (pdu_len > BVLC_SC_NPDU_SIZE_CONF)) {
+        return NULL;
+    }
+    bws_dispatch_lock();
+    for (i = 0; i < BSC_CONF_SHARED_FRAME_NUM; i++) {
+        if (bsc_shared_frame[i].refs == 0) {
+            f = &bsc_shared_frame[i];
+            f->refs = 1;
+            f->pdu = &f->buf[BSC_CONF_TX_PRE + BSC_PRE];
+            f->pdu_len = pdu_len;
+            memcpy(f->pdu, pdu, pdu_len);
+            break;
+        }
+    }
+    bws_dispatch_unlock();
+
+    return f;
+}
+
+/**
+ * @brief Drop a reference to a shared frame
+ * @param f - pointer to the shared frame
+ */
+void bsc_shared_frame_release(BSC_SHARED_FRAME *f)
+{
+    bws_dispatch_lock();
+    if (f && (f->refs > 0)) {
+        f->refs--;
+    }
+    bws_dispatch_unlock();
+}
+
+/**
+ * @brief Queue a reference to a shared frame on the socket
+ * @param c - pointer to the socket
+ * @param f - pointer to the shared frame
+ * @return BSC_SC_RET - status
+ */
+BSC_SC_RET bsc_send_shared(BSC_SOCKET *c, BSC_SHARED_FRAME *f)
+{
+    BSC_SC_RET ret = BSC_SC_SUCCESS;
+    uint16_t len = 0;
+    bool copy = false;
+
+    if (!c || !f || !f->refs) {
+        return BSC_SC_BAD_PARAM;
+    }
+    bws_dispatch_lock();
+    if (c->ctx->state != BSC_CTX_STATE_INITIALIZED ||
+        c->state != BSC_SOCK_STATE_CONNECTED) {
+        ret = BSC_SC_INVALID_OPERATION;
+    } else if (c->ctx->cfg->type != BSC_SOCKET_CTX_ACCEPTOR) {
+        copy = true;
+    } else if (
+        c->tx_throttled &&
+        (c->tx_buf_size >
+         bsc_tx_queue_max_size * bsc_tx_low_watermark / 100)) {
+        ret = BSC_SC_BUSY;
+    } else {
+        c->tx_throttled = false;
+        bsc_tx_buf_reserve(c, sizeof(f));
+        if (bsc_tx_buf_capacity(c) - c->tx_buf_size <
+            sizeof(len) + sizeof(f)) {
+            ret = BSC_SC_NO_RESOURCES;
+        } else {
+            /* a zero length marks a reference to a shared frame */
+            memcpy(&bsc_tx_buf(c)[c->tx_buf_size], &len, sizeof(len));
+            memcpy(
+                &bsc_tx_buf(c)[c->tx_buf_size + sizeof(len)], &f, sizeof(f));
+            c->tx_buf_size += sizeof(len) + sizeof(f);
+            f->refs++;
+            bws_srv_send(c->ctx->sh, c->wh);
+        }
+    }
+    if (copy) {
+        ret = bsc_send(c, f->pdu, f->pdu_len);
+    }
+    bws_dispatch_unlock();
+
+    return ret;
+}
+
+/**
+ * @brief Check if the TX queue of the socket reached its high watermark
+ *  and still has to drain to its low watermark
+ * @param c - pointer to the socket
+ * @return true if bsc_send() would return BSC_SC_BUSY
+ */
+bool bsc_socket_tx_throttled(BSC_SOCKET *c)
+{
+    bool ret = false;
+
+    bws_dispatch_lock();
+    if (c && c->tx_throttled &&
+        (c->tx_buf_size >
+         bsc_tx_queue_max_size * bsc_tx_low_watermark / 100)) {
+        ret = true;
+    }
+    bws_dispatch_unlock();
+
+    return ret;
+}
+
+/**
+ * @brief Set the limit and the watermarks of the socket TX queues
+ * @param max_size - TX queue limit in bytes, or 0 for the default
+ * @param high_watermark - percent of the limit which throttles bsc_send()
+ * @param low_watermark - percent of the limit which ends the throttling
+ * @return true if the watermarks are valid and were applied
+ */
+bool bsc_socket_tx_queue_config(
+    size_t max_size, uint8_t high_watermark, uint8_t low_watermark)
+{
+    if ((high_watermark == 0) || (high_watermark > 100) ||
+        (low_watermark >= high_watermark)) {
+        return false;
+    }
+    if (max_size == 0) {
+        max_size = BSC_TX_QUEUE_DEFAULT_SIZE;
+    }
+#if !BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    if (max_size > BSC_TX_BUFFER_SIZE) {
+        max_size = BSC_TX_BUFFER_SIZE;
+    }
+#endif
+    bws_dispatch_lock();
+    bsc_tx_queue_max_size = max_size;
+    bsc_tx_high_watermark = high_watermark;
+    bsc_tx_low_watermark = low_watermark;
+    bws_dispatch_unlock();
+
+    return true;
+}
+
 /**
  * @brief Get the next message ID
  * @return uint16_t - message ID
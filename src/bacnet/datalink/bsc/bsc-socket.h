@@ -79,6 +79,17 @@ typedef enum {
     BSC_SOCK_STATE_ERROR_FLUSH_TX = 7
 } BSC_SOCKET_STATE;
 
+/* A BVLC message which is encoded once and queued on several sockets.
+   The pdu has at least BSC_PRE free bytes in front of it, so that the
+   origin or dest address can be added, and BSC_CONF_TX_PRE more bytes
+   for the websocket library. */
+typedef struct BSC_SharedFrame {
+    unsigned int refs;
+    uint8_t *pdu;
+    size_t pdu_len;
+    uint8_t buf[BSC_CONF_TX_PRE + BSC_PRE + BVLC_SC_NPDU_SIZE_CONF];
+} BSC_SHARED_FRAME;
+
 struct BSC_Socket {
     BSC_SOCKET_CTX *ctx;
     BSC_WEBSOCKET_HANDLE wh;
@@ -104,6 +115,13 @@ struct BSC_Socket {
 
     uint8_t tx_buf[BSC_TX_BUFFER_SIZE];
     size_t tx_buf_size;
+#if BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC
+    /* TX queue which has outgrown tx_buf, or NULL */
+    uint8_t *tx_heap;
+    size_t tx_heap_size;
+#endif
+    /* the TX queue reached the high watermark and has to drain */
+    bool tx_throttled;
 };
 
 struct BSC_ContextCFG {
@@ -273,11 +291,68 @@ void bsc_disconnect(BSC_SOCKET *c);
  *    BSC_SC_SUCCESS - operation has succeeded.
  *    BSC_SC_NO_RESOURCES - there are not resources (memory, etc.. )
  *                          to send data
+ *    BSC_SC_BUSY - the TX queue of the socket reached its high
+ *                  watermark, and the pdu was dropped. Sending is
+ *                  possible again once the queue drains to its
+ *                  low watermark.
  */
 
 BACNET_STACK_EXPORT
 BSC_SC_RET bsc_send(BSC_SOCKET *c, uint8_t *pdu, size_t pdu_len);
 
+BACNET_STACK_EXPORT
+bool bsc_socket_tx_throttled(BSC_SOCKET *c);
+
+/**
+ * @brief  bsc_shared_frame_alloc() function takes a frame from the
+ *         shared frame pool and copies the pdu into it. The caller
+ *         holds one reference, and may change the pdu and pdu_len
+ *         of the frame within its reserved bytes.
+ *
+ * @param pdu - pointer to a data to send.
+ * @param pdu_len - size in bytes of data to send.
+ *
+ * @return the shared frame, or NULL if the pool is empty or the pdu
+ *         is too big.
+ */
+BACNET_STACK_EXPORT
+BSC_SHARED_FRAME *bsc_shared_frame_alloc(const uint8_t *pdu, size_t pdu_len);
+
+BACNET_STACK_EXPORT
+void bsc_shared_frame_release(BSC_SHARED_FRAME *f);
+
+/**
+ * @brief  bsc_send_shared() function schedules transmitting of a shared
+ *         frame like bsc_send(), but only queues a reference to the
+ *         frame. The frame goes back to the pool when the caller and
+ *         every socket released it. Only sockets of an acceptor
+ *         context can share frames, because a websocket client masks
+ *         the payload in place; for other sockets the frame is copied.
+ *
+ * @param c - BACnet socket descriptor.
+ * @param f - shared frame from bsc_shared_frame_alloc().
+ *
+ * @return error code from BSC_SC_RET enum, as for bsc_send().
+ */
+BACNET_STACK_EXPORT
+BSC_SC_RET bsc_send_shared(BSC_SOCKET *c, BSC_SHARED_FRAME *f);
+
+/**
+ * @brief  bsc_socket_tx_queue_config() function sets the limit and the
+ *         watermarks of the TX queue of every socket. Without
+ *         BSC_CONF_SOCKET_TX_QUEUE_DYNAMIC the limit can not exceed
+ *         BSC_TX_BUFFER_SIZE.
+ *
+ * @param max_size - TX queue limit in bytes, or 0 for the default.
+ * @param high_watermark - percent of the limit which throttles bsc_send().
+ * @param low_watermark - percent of the limit which ends the throttling.
+ *
+ * @return true if the watermarks are valid and were applied
+ */
+BACNET_STACK_EXPORT
+bool bsc_socket_tx_queue_config(
+    size_t max_size, uint8_t high_watermark, uint8_t low_watermark);
+
 BACNET_STACK_EXPORT
 uint16_t bsc_get_next_message_id(void);
 
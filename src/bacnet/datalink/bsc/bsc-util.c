@@ -10,6 +10,7 @@
 #include "bacnet/basic/object/netport.h"
 #include "bacnet/basic/object/sc_netport.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mempool.h"
 #include "bacnet/datalink/bsc/bsc-util.h"
 
 #define PRINTF debug_printf_stdout
@@ -118,7 +119,7 @@ static bool bsc_node_load_cert_bacfile(
         return false;
     }
 
-    buf = calloc(1, *psize);
+    buf = BACNET_MEMPOOL_CALLOC(*psize);
     if (buf == NULL) {
         return false;
     }
@@ -130,7 +131,7 @@ static bool bsc_node_load_cert_bacfile(
 #endif
     if (file_length == 0) {
         PRINTF_ERR("Can't read %s file\n", bacfile_pathname(file_instance));
-        free(buf);
+        BACNET_MEMPOOL_FREE(buf, *psize);
         return false;
     }
     *pbuf = buf;
@@ -231,18 +232,19 @@ bool bsc_node_conf_fill_from_netport(
  */
 void bsc_node_conf_cleanup(BSC_NODE_CONF *bsc_conf)
 {
-    bsc_conf->ca_cert_chain_size = 0;
     if (bsc_conf->ca_cert_chain) {
-        free(bsc_conf->ca_cert_chain);
+        BACNET_MEMPOOL_FREE(
+            bsc_conf->ca_cert_chain, bsc_conf->ca_cert_chain_size);
     }
-    bsc_conf->cert_chain_size = 0;
+    bsc_conf->ca_cert_chain_size = 0;
     if (bsc_conf->cert_chain) {
-        free(bsc_conf->cert_chain);
+        BACNET_MEMPOOL_FREE(bsc_conf->cert_chain, bsc_conf->cert_chain_size);
     }
-    bsc_conf->key_size = 0;
+    bsc_conf->cert_chain_size = 0;
     if (bsc_conf->key) {
-        free(bsc_conf->key);
+        BACNET_MEMPOOL_FREE(bsc_conf->key, bsc_conf->key_size);
     }
+    bsc_conf->key_size = 0;
 }
 
 /**
@@ -325,6 +327,8 @@ const char *bsc_return_code_to_string(BSC_SC_RET ret)
             return "BAD_PARAM";
         case BSC_SC_INVALID_OPERATION:
             return "INVALID_OPERATION";
+        case BSC_SC_BUSY:
+            return "BUSY";
         default:
             break;
     }
@@ -2330,6 +2330,60 @@ bool bvlc_sc_pdu_get_dest(
     return false;
 }
 
+/**
+ * @brief Function reads the fixed part of the header of a BACnet/SC
+ *        message without decoding its header options and payload,
+ *        for a message that is only forwarded.  The BVLC function,
+ *        message id, and the originating and destination addresses
+ *        are filled in, the other fields of the header are zeroed.
+ * @param  pdu- buffer with BACnet/SC message.
+ * @param  pdu_len- length of buffer of BACnet/SC message.
+ * @param  hdr- header to fill, origin and dest point into the pdu.
+ * @param  dest_options- set to true if the message has destination
+ *         options, may be NULL.
+ * @param  data_options- set to true if the message has data options,
+ *         may be NULL.
+ * @return true if the fixed part of the header is complete, otherwise
+ *         returns false and the message needs the full decode.
+ */
+bool bvlc_sc_peek_hdr(
+    uint8_t *pdu,
+    size_t pdu_len,
+    BVLC_SC_DECODED_HDR *hdr,
+    bool *dest_options,
+    bool *data_options)
+{
+    size_t offs = 4;
+
+    if (!pdu || !hdr || (pdu_len < 4) || (pdu[1] & 0xF0)) {
+        return false;
+    }
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->bvlc_function = pdu[0];
+    memcpy(&hdr->message_id, &pdu[2], sizeof(hdr->message_id));
+    if (pdu[1] & BVLC_SC_CONTROL_ORIG_VADDR) {
+        if ((offs + BVLC_SC_VMAC_SIZE) > pdu_len) {
+            return false;
+        }
+        hdr->origin = (BACNET_SC_VMAC_ADDRESS *)&pdu[offs];
+        offs += BVLC_SC_VMAC_SIZE;
+    }
+    if (pdu[1] & BVLC_SC_CONTROL_DEST_VADDR) {
+        if ((offs + BVLC_SC_VMAC_SIZE) > pdu_len) {
+            return false;
+        }
+        hdr->dest = (BACNET_SC_VMAC_ADDRESS *)&pdu[offs];
+    }
+    if (dest_options) {
+        *dest_options = (pdu[1] & BVLC_SC_CONTROL_DEST_OPTIONS) != 0;
+    }
+    if (data_options) {
+        *data_options = (pdu[1] & BVLC_SC_CONTROL_DATA_OPTIONS) != 0;
+    }
+
+    return true;
+}
+
 /**
  * @brief Function removes originating and destination
  *        address fields from input BACnet/SC message.
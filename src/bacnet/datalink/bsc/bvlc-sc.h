@@ -416,6 +416,14 @@ BACNET_STACK_EXPORT
 bool bvlc_sc_pdu_get_dest(
     uint8_t *pdu, size_t pdu_len, BACNET_SC_VMAC_ADDRESS *vmac);
 
+BACNET_STACK_EXPORT
+bool bvlc_sc_peek_hdr(
+    uint8_t *pdu,
+    size_t pdu_len,
+    BVLC_SC_DECODED_HDR *hdr,
+    bool *dest_options,
+    bool *data_options);
+
 BACNET_STACK_EXPORT
 size_t bvlc_sc_remove_orig_and_dest(uint8_t **ppdu, size_t pdu_len);
 
@@ -81,6 +81,20 @@
     BSC_CONF_WEBSOCKET_ERR_DESC_STR_MAX_LEN
 #endif
 
+/**
+ * Number of service threads of a websocket server. Each thread services
+ * its own share of the accepted connections, so a hub with many nodes can
+ * use more than one core. Libwebsockets must be built with LWS_MAX_SMP of
+ * at least this value, otherwise the server uses fewer threads.
+ * @{
+ */
+#ifndef BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM
+#define BSC_WEBSOCKET_SERVER_THREADS_NUM 1
+#else
+#define BSC_WEBSOCKET_SERVER_THREADS_NUM BSC_CONF_WEBSOCKET_SERVER_THREADS_NUM
+#endif
+/** @} */
+
 #define BSC_WSURL_MAX_LEN BSC_CONF_WSURL_MAX_LEN
 
 typedef int BSC_WEBSOCKET_HANDLE;
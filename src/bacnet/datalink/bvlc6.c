@@ -10,6 +10,7 @@
 #include <stdint.h> /* for standard integer types uint8_t etc. */
 #include <stdbool.h> /* for the standard bool type. */
 #include <stdio.h>
+#include <string.h>
 #include "bacnet/bacenum.h"
 #include "bacnet/bacdcode.h"
 #include "bacnet/bacint.h"
@@ -504,15 +505,10 @@ bool bvlc6_address_different(
     const BACNET_IP6_ADDRESS *dst, const BACNET_IP6_ADDRESS *src)
 {
     bool status = false;
-    unsigned int i = 0;
 
     if (src && dst) {
-        for (i = 0; i < IP6_ADDRESS_MAX; i++) {
-            if (dst->address[i] != src->address[i]) {
-                status = true;
-            }
-        }
-        if (dst->port != src->port) {
+        if ((dst->port != src->port) ||
+            (memcmp(dst->address, src->address, IP6_ADDRESS_MAX) != 0)) {
             status = true;
         }
     }
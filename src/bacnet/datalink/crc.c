@@ -12,6 +12,15 @@
 #include <stdbool.h>
 #include "crc.h"
 
+#if defined(CRC_SLICE_BY)
+#if (CRC_SLICE_BY != 4) && (CRC_SLICE_BY != 8)
+#error "CRC_SLICE_BY must be 4 or 8"
+#endif
+#ifndef CRC_USE_TABLE
+#define CRC_USE_TABLE
+#endif
+#endif
+
 #if defined(CRC_USE_TABLE)
 /* note: table is created using unit test below */
 static const uint8_t HeaderCRC[256] = {
@@ -117,3 +126,91 @@ uint16_t CRC_Calc_Data(uint8_t dataValue, uint16_t crcValue)
         (crcLow >> 4) ^ (crcLow & 0x0f) ^ ((crcLow & 0x0f) << 7);
 }
 #endif
+
+#if defined(CRC_SLICE_BY)
+/* DataCRC for the byte, followed by 1..N-1 zero bytes; built on first use */
+static uint16_t DataCRC_Slice[CRC_SLICE_BY][256];
+static bool DataCRC_Slice_Ready;
+
+/**
+ * @brief Build the slice-by-N tables from the DataCRC table
+ */
+static void CRC_Data_Slice_Init(void)
+{
+    uint16_t crc;
+    unsigned i, k;
+
+    for (i = 0; i < 256; i++) {
+        DataCRC_Slice[0][i] = DataCRC[i];
+    }
+    for (k = 1; k < CRC_SLICE_BY; k++) {
+        for (i = 0; i < 256; i++) {
+            crc = DataCRC_Slice[k - 1][i];
+            DataCRC_Slice[k][i] = (crc >> 8) ^ DataCRC[crc & 0x00FF];
+        }
+    }
+    DataCRC_Slice_Ready = true;
+}
+#endif
+
+/**
+ * @brief Accumulate the bytes of a buffer into the MS/TP header CRC
+ * @param buffer - the bytes to accumulate
+ * @param length - number of bytes in the buffer
+ * @param crcValue - the CRC accumulated so far
+ * @return the updated CRC
+ */
+uint8_t
+CRC_Calc_Header_Buffer(const uint8_t *buffer, size_t length, uint8_t crcValue)
+{
+    while (length > 0) {
+        crcValue = CRC_Calc_Header(*buffer, crcValue);
+        buffer++;
+        length--;
+    }
+
+    return crcValue;
+}
+
+/**
+ * @brief Accumulate the bytes of a buffer into the MS/TP data CRC.
+ *  With CRC_SLICE_BY defined, 4 or 8 bytes are accumulated per step.
+ * @param buffer - the bytes to accumulate
+ * @param length - number of bytes in the buffer
+ * @param crcValue - the CRC accumulated so far
+ * @return the updated CRC
+ */
+uint16_t
+CRC_Calc_Data_Buffer(const uint8_t *buffer, size_t length, uint16_t crcValue)
+{
+#if defined(CRC_SLICE_BY)
+    uint16_t crc;
+
+    if (!DataCRC_Slice_Ready) {
+        CRC_Data_Slice_Init();
+    }
+    while (length >= CRC_SLICE_BY) {
+        crc = crcValue ^ (uint16_t)(buffer[0] | ((uint16_t)buffer[1] << 8));
+#if (CRC_SLICE_BY == 8)
+        crcValue = DataCRC_Slice[7][crc & 0x00FF] ^
+            DataCRC_Slice[6][crc >> 8] ^ DataCRC_Slice[5][buffer[2]] ^
+            DataCRC_Slice[4][buffer[3]] ^ DataCRC_Slice[3][buffer[4]] ^
+            DataCRC_Slice[2][buffer[5]] ^ DataCRC_Slice[1][buffer[6]] ^
+            DataCRC_Slice[0][buffer[7]];
+#else
+        crcValue = DataCRC_Slice[3][crc & 0x00FF] ^
+            DataCRC_Slice[2][crc >> 8] ^ DataCRC_Slice[1][buffer[2]] ^
+            DataCRC_Slice[0][buffer[3]];
+#endif
+        buffer += CRC_SLICE_BY;
+        length -= CRC_SLICE_BY;
+    }
+#endif
+    while (length > 0) {
+        crcValue = CRC_Calc_Data(*buffer, crcValue);
+        buffer++;
+        length--;
+    }
+
+    return crcValue;
+}
@@ -15,6 +15,11 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 
+/* Define CRC_USE_TABLE to use 256 entry look-up tables instead of the
+   compact bit arithmetic.  Define CRC_SLICE_BY as 4 or 8 to also use
+   slice-by-N tables, built in RAM on first use, in the buffer functions
+   for the MS/TP data CRC and the COBS CRC-32K. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -23,6 +28,12 @@ BACNET_STACK_EXPORT
 uint8_t CRC_Calc_Header(uint8_t dataValue, uint8_t crcValue);
 BACNET_STACK_EXPORT
 uint16_t CRC_Calc_Data(uint8_t dataValue, uint16_t crcValue);
+BACNET_STACK_EXPORT
+uint8_t
+CRC_Calc_Header_Buffer(const uint8_t *buffer, size_t length, uint8_t crcValue);
+BACNET_STACK_EXPORT
+uint16_t
+CRC_Calc_Data_Buffer(const uint8_t *buffer, size_t length, uint16_t crcValue);
 
 #ifdef __cplusplus
 }
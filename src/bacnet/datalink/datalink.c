@@ -7,9 +7,16 @@
  * @defgroup DataLink DataLink Network Layer
  * @ingroup DataLink
  */
+#include <string.h>
 #include "bacnet/bacdef.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/bacstr.h"
+#if defined(BACNET_DATALINK_TX_SCHEDULER) && (DATALINK_TX_RATE_LIMIT > 0)
+#include "bacnet/basic/sys/mstimer.h"
+#endif
+#if defined(BACNET_APDU_STATISTICS)
+#include "bacnet/basic/service/h_apdu.h"
+#endif
 #if defined(BACDL_MULTIPLE) || defined FOR_DOXYGEN
 #if defined(BACDL_ETHERNET)
 #include "bacnet/datalink/ethernet.h"
@@ -36,8 +43,14 @@
 #if defined(BACDL_BSC)
 #include "bacnet/datalink/bsc/bsc-datalink.h"
 #endif
+#if defined(BACDL_LOOPBACK)
+#include "bacnet/datalink/loopback.h"
+#endif
+#if defined(BACDL_SHM)
+#include "bacnet/datalink/dlshm.h"
+#endif
 
-static enum {
+enum datalink_transport {
     DATALINK_NONE = 0,
     DATALINK_ARCNET,
     DATALINK_ETHERNET,
@@ -45,56 +58,101 @@ static enum {
     DATALINK_BIP6,
     DATALINK_MSTP,
     DATALINK_ZIGBEE,
-    DATALINK_BSC
-} Datalink_Transport;
+    DATALINK_BSC,
+    DATALINK_LOOPBACK,
+    DATALINK_SHM
+};
 
-void datalink_set(char *datalink_string)
+static enum datalink_transport Datalink_Transport;
+
+/* a datalink bound with its own network number; port 0 is the datalink
+   of the local device */
+struct datalink_port {
+    enum datalink_transport transport;
+    uint16_t network;
+};
+
+static struct datalink_port Datalink_Port[DATALINK_PORTS_MAX];
+static unsigned Datalink_Port_Count;
+/* port polled first by the next receive */
+static unsigned Datalink_Port_Next;
+/* an NPDU with its network header rewritten for another port */
+static uint8_t Datalink_Port_PDU[MAX_MPDU];
+
+/**
+ * @brief Find the transport named by a datalink string
+ * @param datalink_string - name of the datalink, such as "bip"
+ * @param transport - returns the transport
+ * @return true if the datalink is built into this stack
+ */
+static bool transport_find(
+    const char *datalink_string, enum datalink_transport *transport)
 {
     if (bacnet_stricmp("none", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_NONE;
+        *transport = DATALINK_NONE;
     }
 #if defined(BACDL_BIP)
     else if (bacnet_stricmp("bip", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BIP;
+        *transport = DATALINK_BIP;
     }
 #endif
 #if defined(BACDL_BIP6)
     else if (bacnet_stricmp("bip6", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BIP6;
+        *transport = DATALINK_BIP6;
     }
 #endif
 #if defined(BACDL_ETHERNET)
     else if (bacnet_stricmp("ethernet", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_ETHERNET;
+        *transport = DATALINK_ETHERNET;
     }
 #endif
 #if defined(BACDL_ARCNET)
     else if (bacnet_stricmp("arcnet", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_ARCNET;
+        *transport = DATALINK_ARCNET;
     }
 #endif
 #if defined(BACDL_MSTP)
     else if (bacnet_stricmp("mstp", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_MSTP;
+        *transport = DATALINK_MSTP;
     }
 #endif
 #if defined(BACDL_ZIGBEE)
     else if (bacnet_stricmp("zigbee", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_ARCNET;
+        *transport = DATALINK_ZIGBEE;
     }
 #endif
 #if defined(BACDL_BSC)
     else if (bacnet_stricmp("bsc", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BSC;
+        *transport = DATALINK_BSC;
+    }
+#endif
+#if defined(BACDL_LOOPBACK)
+    else if (bacnet_stricmp("loopback", datalink_string) == 0) {
+        *transport = DATALINK_LOOPBACK;
     }
 #endif
+#if defined(BACDL_SHM)
+    else if (bacnet_stricmp("shm", datalink_string) == 0) {
+        *transport = DATALINK_SHM;
+    }
+#endif
+    else {
+        return false;
+    }
+
+    return true;
 }
 
-bool datalink_init(char *ifname)
+void datalink_set(char *datalink_string)
+{
+    (void)transport_find(datalink_string, &Datalink_Transport);
+}
+
+static bool transport_init(enum datalink_transport transport, char *ifname)
 {
     bool status = false;
 
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             status = true;
             break;
@@ -132,6 +190,16 @@ bool datalink_init(char *ifname)
         case DATALINK_BSC:
             status = bsc_init(ifname);
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            status = loopback_init(ifname);
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            status = dlshm_init(ifname);
+            break;
 #endif
         default:
             break;
@@ -140,7 +208,64 @@ bool datalink_init(char *ifname)
     return status;
 }
 
-int datalink_send_pdu(
+bool datalink_init(char *ifname)
+{
+    return transport_init(Datalink_Transport, ifname);
+}
+
+/**
+ * @brief Get the largest APDU that a transport carries
+ * @param transport - the transport
+ * @return largest APDU in octets, up to MAX_APDU
+ */
+static uint16_t transport_max_apdu(enum datalink_transport transport)
+{
+    uint16_t max_apdu;
+
+    switch (transport) {
+#if defined(BACDL_ARCNET)
+        case DATALINK_ARCNET:
+            max_apdu = 480;
+            break;
+#endif
+#if defined(BACDL_MSTP)
+        case DATALINK_MSTP:
+#if defined(BACNET_MSTP_EXTENDED_FRAMES) && BACNET_MSTP_EXTENDED_FRAMES
+            max_apdu = 1476;
+#else
+            max_apdu = 480;
+#endif
+            break;
+#endif
+#if defined(BACDL_ZIGBEE)
+        case DATALINK_ZIGBEE:
+            max_apdu = 480;
+            break;
+#endif
+        default:
+            max_apdu = 1476;
+            break;
+    }
+    if (max_apdu > MAX_APDU) {
+        max_apdu = MAX_APDU;
+    }
+
+    return max_apdu;
+}
+
+/**
+ * @brief Get the largest APDU of the datalink of the local device, as
+ *  chosen with datalink_set(), which a combined build may have sized
+ *  its buffers above
+ * @return largest APDU in octets, up to MAX_APDU
+ */
+uint16_t datalink_max_apdu(void)
+{
+    return transport_max_apdu(Datalink_Transport);
+}
+
+static int transport_send_pdu(
+    enum datalink_transport transport,
     BACNET_ADDRESS *dest,
     BACNET_NPDU_DATA *npdu_data,
     uint8_t *pdu,
@@ -148,7 +273,7 @@ int datalink_send_pdu(
 {
     int bytes = 0;
 
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             bytes = pdu_len;
             break;
@@ -186,6 +311,16 @@ int datalink_send_pdu(
         case DATALINK_BSC:
             bytes = bsc_send_pdu(dest, npdu_data, pdu, pdu_len);
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            bytes = loopback_send_pdu(dest, npdu_data, pdu, pdu_len);
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            bytes = dlshm_send_pdu(dest, npdu_data, pdu, pdu_len);
+            break;
 #endif
         default:
             break;
@@ -194,12 +329,16 @@ int datalink_send_pdu(
     return bytes;
 }
 
-uint16_t datalink_receive(
-    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+static uint16_t transport_receive(
+    enum datalink_transport transport,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout)
 {
     uint16_t bytes = 0;
 
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             break;
 #if defined(BACDL_ARCNET)
@@ -236,6 +375,16 @@ uint16_t datalink_receive(
         case DATALINK_BSC:
             bytes = bsc_receive(src, pdu, max_pdu, timeout);
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            bytes = loopback_receive(src, pdu, max_pdu, timeout);
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            bytes = dlshm_receive(src, pdu, max_pdu, timeout);
+            break;
 #endif
         default:
             break;
@@ -244,9 +393,9 @@ uint16_t datalink_receive(
     return bytes;
 }
 
-void datalink_cleanup(void)
+static void transport_cleanup(enum datalink_transport transport)
 {
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             break;
 #if defined(BACDL_ARCNET)
@@ -283,15 +432,26 @@ void datalink_cleanup(void)
         case DATALINK_BSC:
             bsc_cleanup();
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            loopback_cleanup();
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            dlshm_cleanup();
+            break;
 #endif
         default:
             break;
     }
 }
 
-void datalink_get_broadcast_address(BACNET_ADDRESS *dest)
+static void transport_get_broadcast_address(
+    enum datalink_transport transport, BACNET_ADDRESS *dest)
 {
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             break;
 #if defined(BACDL_ARCNET)
@@ -328,15 +488,26 @@ void datalink_get_broadcast_address(BACNET_ADDRESS *dest)
         case DATALINK_BSC:
             bsc_get_broadcast_address(dest);
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            loopback_get_broadcast_address(dest);
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            dlshm_get_broadcast_address(dest);
+            break;
 #endif
         default:
             break;
     }
 }
 
-void datalink_get_my_address(BACNET_ADDRESS *my_address)
+static void transport_get_my_address(
+    enum datalink_transport transport, BACNET_ADDRESS *my_address)
 {
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
             break;
 #if defined(BACDL_ARCNET)
@@ -373,97 +544,937 @@ void datalink_get_my_address(BACNET_ADDRESS *my_address)
         case DATALINK_BSC:
             bsc_get_my_address(my_address);
             break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            loopback_get_my_address(my_address);
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
+            dlshm_get_my_address(my_address);
+            break;
 #endif
         default:
             break;
     }
 }
 
-void datalink_set_interface(char *ifname)
+static void transport_maintenance_timer(
+    enum datalink_transport transport, uint16_t seconds)
 {
-    switch (Datalink_Transport) {
+    switch (transport) {
         case DATALINK_NONE:
-            (void)ifname;
             break;
 #if defined(BACDL_ARCNET)
         case DATALINK_ARCNET:
-            (void)ifname;
             break;
 #endif
 #if defined(BACDL_ETHERNET)
         case DATALINK_ETHERNET:
-            (void)ifname;
             break;
 #endif
 #if defined(BACDL_BIP)
         case DATALINK_BIP:
-            (void)ifname;
+            bvlc_maintenance_timer(seconds);
             break;
 #endif
 #if defined(BACDL_BIP6)
         case DATALINK_BIP6:
-            (void)ifname;
+            bvlc6_maintenance_timer(seconds);
             break;
 #endif
 #if defined(BACDL_MSTP)
         case DATALINK_MSTP:
-            (void)ifname;
             break;
 #endif
 #if defined(BACDL_ZIGBEE)
         case DATALINK_ZIGBEE:
-            (void)ifname;
+            bzll_maintenance_timer(seconds);
             break;
 #endif
 #if defined(BACDL_BSC)
         case DATALINK_BSC:
-            (void)ifname;
+            bsc_maintenance_timer(seconds);
+            break;
+#endif
+#if defined(BACDL_LOOPBACK)
+        case DATALINK_LOOPBACK:
+            break;
+#endif
+#if defined(BACDL_SHM)
+        case DATALINK_SHM:
             break;
 #endif
         default:
             break;
     }
+    (void)seconds;
 }
 
-void datalink_maintenance_timer(uint16_t seconds)
+/**
+ * @brief Bind a datalink with its own network number, so that the stack
+ *  routes NPDUs between the bound datalinks in process.  The first port
+ *  names the datalink of the local device, chosen with datalink_set() and
+ *  started with datalink_init(), and only gives its network number.  Each
+ *  further port starts its datalink on the interface.  A datalink can be
+ *  bound to one port only.
+ * @param datalink_string - name of the datalink, such as "bip6"
+ * @param ifname - interface of a further port, or NULL for its default
+ * @param network - network number of the port, 1..65534
+ * @return true if the port was added
+ */
+bool datalink_port_add(char *datalink_string, char *ifname, uint16_t network)
 {
-    switch (Datalink_Transport) {
-        case DATALINK_NONE:
-            break;
-#if defined(BACDL_ARCNET)
-        case DATALINK_ARCNET:
+    enum datalink_transport transport;
+    unsigned i;
+
+    if ((network == 0) || (network == BACNET_BROADCAST_NETWORK) ||
+        (Datalink_Port_Count >= DATALINK_PORTS_MAX) ||
+        !transport_find(datalink_string, &transport) ||
+        (transport == DATALINK_NONE)) {
+        return false;
+    }
+    for (i = 0; i < Datalink_Port_Count; i++) {
+        if ((Datalink_Port[i].transport == transport) ||
+            (Datalink_Port[i].network == network)) {
+            return false;
+        }
+    }
+    if (Datalink_Port_Count == 0) {
+        if (transport != Datalink_Transport) {
+            return false;
+        }
+    } else if (!transport_init(transport, ifname)) {
+        return false;
+    }
+    Datalink_Port[Datalink_Port_Count].transport = transport;
+    Datalink_Port[Datalink_Port_Count].network = network;
+    Datalink_Port_Count++;
+
+    return true;
+}
+
+/**
+ * @brief Number of datalinks bound with datalink_port_add()
+ * @return number of ports
+ */
+unsigned datalink_port_count(void)
+{
+    return Datalink_Port_Count;
+}
+
+/**
+ * @brief Network number of a datalink port
+ * @param port - index of the port, where 0 is the local device port
+ * @return network number of the port, or 0 if there is no such port
+ */
+uint16_t datalink_port_network(unsigned port)
+{
+    if (port < Datalink_Port_Count) {
+        return Datalink_Port[port].network;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Largest APDU of a datalink port
+ * @param port - index of the port, where 0 is the local device port
+ * @return largest APDU in octets, or 0 if there is no such port
+ */
+uint16_t datalink_port_max_apdu(unsigned port)
+{
+    if (port < Datalink_Port_Count) {
+        return transport_max_apdu(Datalink_Port[port].transport);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Find the port that is attached to a network
+ * @param network - network number
+ * @return index of the port, or Datalink_Port_Count if none
+ */
+static unsigned datalink_port_find(uint16_t network)
+{
+    unsigned i;
+
+    for (i = 0; i < Datalink_Port_Count; i++) {
+        if (Datalink_Port[i].network == network) {
             break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Send an NPDU on a port with its network header rewritten.  A
+ *  global broadcast keeps its DNET and loses a hop, and an NPDU for the
+ *  network of the port is sent to its DADR with the DNET removed.
+ * @param port - index of the port to send on
+ * @param pdu - the NPDU as received or as encoded by the local device
+ * @param pdu_len - number of bytes in the NPDU
+ * @param offset - number of bytes of the network header in the NPDU
+ * @param dest - destination decoded from the network header
+ * @param src - source network and address for the SNET and SADR
+ * @param npdu_data - network header information of the NPDU
+ * @return number of bytes sent, zero if it was dropped, or negative on
+ *  a datalink error
+ */
+static int datalink_port_forward(
+    unsigned port,
+    const uint8_t *pdu,
+    uint16_t pdu_len,
+    int offset,
+    const BACNET_ADDRESS *dest,
+    BACNET_ADDRESS *src,
+    const BACNET_NPDU_DATA *npdu_data)
+{
+    BACNET_ADDRESS link_dest = { 0 };
+    BACNET_ADDRESS npdu_dest = { 0 };
+    BACNET_NPDU_DATA data;
+    int len;
+
+    if ((pdu_len - offset) >
+        transport_max_apdu(Datalink_Port[port].transport)) {
+        /* the APDU is too large for the datalink of the port */
+        return 0;
+    }
+    npdu_copy_data(&data, npdu_data);
+    if (dest->net == BACNET_BROADCAST_NETWORK) {
+        if (data.hop_count == 0) {
+            return 0;
+        }
+        data.hop_count--;
+        npdu_dest.net = BACNET_BROADCAST_NETWORK;
+    } else {
+        /* the destination is on the link of this port */
+        link_dest.mac_len = dest->len;
+        memcpy(link_dest.mac, dest->adr, dest->len);
+    }
+    len = bacnet_npdu_encode_pdu(
+        Datalink_Port_PDU, sizeof(Datalink_Port_PDU), &npdu_dest, src, &data);
+    if ((len <= 0) ||
+        ((len + pdu_len - offset) > (int)sizeof(Datalink_Port_PDU))) {
+        return 0;
+    }
+    memcpy(&Datalink_Port_PDU[len], &pdu[offset], pdu_len - offset);
+    len += pdu_len - offset;
+
+    return transport_send_pdu(
+        Datalink_Port[port].transport, &link_dest, &data, Datalink_Port_PDU,
+        (unsigned)len);
+}
+
+/**
+ * @brief Route an NPDU from the local device to the port of its network.
+ *  A global broadcast is sent on every port, and an NPDU for a network
+ *  beyond the ports goes to a router on the local device port.
+ * @param dest - destination address of the NPDU
+ * @param npdu_data - NPDU information, including the network priority
+ * @param pdu - the NPDU to send
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent, or negative on a datalink error
+ */
+static int datalink_port_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    BACNET_ADDRESS npdu_dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_NPDU_DATA data = { 0 };
+    BACNET_ADDRESS my_address = { 0 };
+    unsigned port;
+    int offset;
+
+    if ((Datalink_Port_Count < 2) || !dest || (dest->net == 0)) {
+        return transport_send_pdu(
+            Datalink_Transport, dest, npdu_data, pdu, pdu_len);
+    }
+    port = datalink_port_find(dest->net);
+    if ((port == 0) || ((port == Datalink_Port_Count) &&
+                        (dest->net != BACNET_BROADCAST_NETWORK))) {
+        return transport_send_pdu(
+            Datalink_Transport, dest, npdu_data, pdu, pdu_len);
+    }
+    offset = bacnet_npdu_decode(pdu, pdu_len, &npdu_dest, &src, &data);
+    if (offset <= 0) {
+        return -1;
+    }
+    /* on the other ports, the local device is reached through port 0 */
+    transport_get_my_address(Datalink_Transport, &my_address);
+    src.net = Datalink_Port[0].network;
+    src.len = my_address.mac_len;
+    memcpy(src.adr, my_address.mac, my_address.mac_len);
+    if (port < Datalink_Port_Count) {
+        return datalink_port_forward(
+            port, pdu, pdu_len, offset, &npdu_dest, &src, &data);
+    }
+    for (port = 1; port < Datalink_Port_Count; port++) {
+        (void)datalink_port_forward(
+            port, pdu, pdu_len, offset, &npdu_dest, &src, &data);
+    }
+
+    return transport_send_pdu(
+        Datalink_Transport, dest, npdu_data, pdu, pdu_len);
+}
+
+/**
+ * @brief Route an NPDU received on a port: forward it to the ports of its
+ *  destination, and keep it if it is also for the local device.  An NPDU
+ *  kept from a port other than port 0 is rewritten with that port as its
+ *  source network, so replies are routed back to it.
+ * @param port - index of the port that received the NPDU
+ * @param src - datalink source address of the NPDU
+ * @param pdu - the NPDU, rewritten in place when it is kept
+ * @param pdu_len - number of bytes in the NPDU
+ * @param max_pdu - size of the NPDU buffer
+ * @return number of bytes of the NPDU for the local device, or zero
+ */
+static uint16_t datalink_port_route(
+    unsigned port,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t pdu_len,
+    uint16_t max_pdu)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS npdu_src = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS my_address = { 0 };
+    bool local = false;
+    unsigned i, target;
+    int offset, len;
+
+    offset = bacnet_npdu_decode(pdu, pdu_len, &dest, &npdu_src, &npdu_data);
+    if (port == 0) {
+        if ((offset <= 0) || (dest.net == 0) ||
+            npdu_data.network_layer_message) {
+            return pdu_len;
+        }
+        if (npdu_src.net == 0) {
+            npdu_src.net = Datalink_Port[0].network;
+            npdu_src.len = src->mac_len;
+            memcpy(npdu_src.adr, src->mac, src->mac_len);
+        }
+        if (dest.net == BACNET_BROADCAST_NETWORK) {
+            for (i = 1; i < Datalink_Port_Count; i++) {
+                (void)datalink_port_forward(
+                    i, pdu, pdu_len, offset, &dest, &npdu_src, &npdu_data);
+            }
+            return pdu_len;
+        }
+        target = datalink_port_find(dest.net);
+        if ((target > 0) && (target < Datalink_Port_Count)) {
+            (void)datalink_port_forward(
+                target, pdu, pdu_len, offset, &dest, &npdu_src, &npdu_data);
+            return 0;
+        }
+        return pdu_len;
+    }
+    if ((offset <= 0) || npdu_data.network_layer_message) {
+        return 0;
+    }
+    /* the source is on the network of this port unless already routed */
+    if (npdu_src.net == 0) {
+        npdu_src.net = Datalink_Port[port].network;
+        npdu_src.len = src->mac_len;
+        memcpy(npdu_src.adr, src->mac, src->mac_len);
+    }
+    if (dest.net == BACNET_BROADCAST_NETWORK) {
+        for (i = 0; i < Datalink_Port_Count; i++) {
+            if (i != port) {
+                (void)datalink_port_forward(
+                    i, pdu, pdu_len, offset, &dest, &npdu_src, &npdu_data);
+            }
+        }
+        local = true;
+    } else if (dest.net == 0) {
+        local = true;
+    } else {
+        target = datalink_port_find(dest.net);
+        if ((target == Datalink_Port_Count) || (target == port)) {
+            return 0;
+        }
+        if (target == 0) {
+            transport_get_my_address(Datalink_Transport, &my_address);
+            local = (dest.len == 0) ||
+                ((dest.len == my_address.mac_len) &&
+                 (memcmp(dest.adr, my_address.mac, dest.len) == 0));
+        }
+        if (!local || (dest.len == 0)) {
+            (void)datalink_port_forward(
+                target, pdu, pdu_len, offset, &dest, &npdu_src, &npdu_data);
+        }
+    }
+    if (!local) {
+        return 0;
+    }
+    if (dest.net != BACNET_BROADCAST_NETWORK) {
+        dest.net = 0;
+        dest.len = 0;
+    }
+    len = bacnet_npdu_encode_pdu(
+        Datalink_Port_PDU, sizeof(Datalink_Port_PDU), &dest, &npdu_src,
+        &npdu_data);
+    if ((len <= 0) || ((len + pdu_len - offset) > max_pdu) ||
+        ((len + pdu_len - offset) > (int)sizeof(Datalink_Port_PDU))) {
+        return 0;
+    }
+    memcpy(&Datalink_Port_PDU[len], &pdu[offset], pdu_len - offset);
+    len += pdu_len - offset;
+    memcpy(pdu, Datalink_Port_PDU, (size_t)len);
+
+    return (uint16_t)len;
+}
+
+/**
+ * @brief Receive an NPDU for the local device from any port, polling the
+ *  ports in turn and routing what they receive
+ * @param src - returns the source address of the NPDU
+ * @param pdu - returns the NPDU
+ * @param max_pdu - size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait, shared by the ports
+ * @return number of bytes of the NPDU, or zero
+ */
+static uint16_t datalink_port_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+{
+    uint16_t pdu_len;
+    unsigned i, port;
+
+    timeout /= Datalink_Port_Count;
+    for (i = 0; i < Datalink_Port_Count; i++) {
+        port = Datalink_Port_Next;
+        Datalink_Port_Next = (port + 1) % Datalink_Port_Count;
+        pdu_len = transport_receive(
+            Datalink_Port[port].transport, src, pdu, max_pdu, timeout);
+        if (pdu_len > 0) {
+            pdu_len = datalink_port_route(port, src, pdu, pdu_len, max_pdu);
+            if (pdu_len > 0) {
+                return pdu_len;
+            }
+        }
+    }
+
+    return 0;
+}
+
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+static int datalink_transport_send_pdu(
+#else
+int datalink_send_pdu(
 #endif
-#if defined(BACDL_ETHERNET)
-        case DATALINK_ETHERNET:
-            break;
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+#if defined(BACNET_APDU_STATISTICS) && !defined(BACNET_DATALINK_TX_SCHEDULER)
+    apdu_statistics_reply(pdu, pdu_len);
+#endif
+    return datalink_port_send_pdu(dest, npdu_data, pdu, pdu_len);
+}
+
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+/* number of network priorities - normal, urgent, critical, life safety */
+#define DATALINK_TX_PRIORITIES 4
+
+/* an NPDU waiting for the datalink to accept it */
+struct datalink_tx_packet {
+    BACNET_ADDRESS dest;
+    BACNET_NPDU_DATA npdu_data;
+    unsigned pdu_len;
+    uint8_t pdu[MAX_MPDU];
+    struct datalink_tx_packet *next;
+};
+
+/* FIFO of the NPDUs of one network priority */
+struct datalink_tx_queue {
+    struct datalink_tx_packet *head;
+    struct datalink_tx_packet *tail;
+    /* NPDUs of higher priority sent while this queue was waiting */
+    unsigned skipped;
+};
+
+static struct datalink_tx_packet TX_Packet[DATALINK_TX_QUEUE_SIZE];
+static struct datalink_tx_packet *TX_Free;
+static struct datalink_tx_queue TX_Queue[DATALINK_TX_PRIORITIES];
+static unsigned TX_Pending;
+static bool TX_Initialized;
+
+#if (DATALINK_TX_RATE_LIMIT > 0)
+/* token bucket of one destination MAC, in thousandths of an NPDU */
+struct datalink_tx_rate {
+    uint8_t mac_len;
+    uint8_t mac[MAX_MAC_LEN];
+    uint32_t tokens;
+    uint32_t update_ms;
+};
+
+static struct datalink_tx_rate TX_Rate[DATALINK_TX_RATE_DESTINATIONS];
+
+/**
+ * @brief Find the token bucket of a destination, or reuse the least
+ *  recently updated bucket with a full set of tokens
+ * @param dest - destination of the NPDU
+ * @return token bucket of the destination, refilled to the current time
+ */
+static struct datalink_tx_rate *datalink_tx_rate_find(
+    const BACNET_ADDRESS *dest)
+{
+    struct datalink_tx_rate *rate = NULL;
+    uint32_t now = mstimer_now();
+    uint32_t elapsed;
+    uint8_t mac_len = dest->mac_len;
+    unsigned i;
+
+    if (mac_len > MAX_MAC_LEN) {
+        mac_len = MAX_MAC_LEN;
+    }
+    for (i = 0; i < DATALINK_TX_RATE_DESTINATIONS; i++) {
+        if ((TX_Rate[i].mac_len == mac_len) &&
+            (memcmp(TX_Rate[i].mac, dest->mac, mac_len) == 0)) {
+            rate = &TX_Rate[i];
+            break;
+        }
+        if (!rate || ((now - TX_Rate[i].update_ms) >
+                      (now - rate->update_ms))) {
+            rate = &TX_Rate[i];
+        }
+    }
+    if ((rate->mac_len != mac_len) ||
+        (memcmp(rate->mac, dest->mac, mac_len) != 0)) {
+        rate->mac_len = mac_len;
+        memcpy(rate->mac, dest->mac, mac_len);
+        rate->tokens = DATALINK_TX_RATE_LIMIT * 1000UL;
+        rate->update_ms = now;
+    }
+    elapsed = now - rate->update_ms;
+    rate->update_ms = now;
+    if (elapsed >= 1000UL) {
+        rate->tokens = DATALINK_TX_RATE_LIMIT * 1000UL;
+    } else {
+        rate->tokens += elapsed * DATALINK_TX_RATE_LIMIT;
+        if (rate->tokens > (DATALINK_TX_RATE_LIMIT * 1000UL)) {
+            rate->tokens = DATALINK_TX_RATE_LIMIT * 1000UL;
+        }
+    }
+
+    return rate;
+}
+#endif
+
+/**
+ * @brief Determine if the rate shaping lets an NPDU be sent now.
+ *  Only normal priority NPDUs are shaped.
+ * @param dest - destination of the NPDU
+ * @param priority - network priority of the NPDU
+ * @return true if the NPDU can be sent now
+ */
+static bool datalink_tx_rate_ready(
+    const BACNET_ADDRESS *dest, BACNET_MESSAGE_PRIORITY priority)
+{
+#if (DATALINK_TX_RATE_LIMIT > 0)
+    if (dest && (priority == MESSAGE_PRIORITY_NORMAL)) {
+        return datalink_tx_rate_find(dest)->tokens >= 1000UL;
+    }
+#else
+    (void)dest;
+    (void)priority;
 #endif
+
+    return true;
+}
+
+/**
+ * @brief Take one NPDU worth of tokens from a destination
+ * @param dest - destination of the NPDU that was sent
+ * @param priority - network priority of the NPDU that was sent
+ */
+static void datalink_tx_rate_take(
+    const BACNET_ADDRESS *dest, BACNET_MESSAGE_PRIORITY priority)
+{
+#if (DATALINK_TX_RATE_LIMIT > 0)
+    struct datalink_tx_rate *rate;
+
+    if (dest && (priority == MESSAGE_PRIORITY_NORMAL)) {
+        rate = datalink_tx_rate_find(dest);
+        if (rate->tokens >= 1000UL) {
+            rate->tokens -= 1000UL;
+        } else {
+            rate->tokens = 0;
+        }
+    }
+#else
+    (void)dest;
+    (void)priority;
+#endif
+}
+
+/**
+ * @brief Link the transmit packets into the free list
+ */
+static void datalink_tx_init(void)
+{
+    unsigned i;
+
+    TX_Free = NULL;
+    for (i = 0; i < DATALINK_TX_QUEUE_SIZE; i++) {
+        TX_Packet[i].next = TX_Free;
+        TX_Free = &TX_Packet[i];
+    }
+    for (i = 0; i < DATALINK_TX_PRIORITIES; i++) {
+        TX_Queue[i].head = NULL;
+        TX_Queue[i].tail = NULL;
+        TX_Queue[i].skipped = 0;
+    }
+    TX_Pending = 0;
+    TX_Initialized = true;
+}
+
+/**
+ * @brief Remove a packet from a transmit queue and free it
+ * @param queue - the queue holding the packet
+ * @param prev - the packet before it in the queue, or NULL for the head
+ * @param packet - the packet to remove
+ */
+static void datalink_tx_remove(
+    struct datalink_tx_queue *queue,
+    struct datalink_tx_packet *prev,
+    struct datalink_tx_packet *packet)
+{
+    if (prev) {
+        prev->next = packet->next;
+    } else {
+        queue->head = packet->next;
+    }
+    if (queue->tail == packet) {
+        queue->tail = prev;
+    }
+    packet->next = TX_Free;
+    TX_Free = packet;
+    TX_Pending--;
+}
+
+/**
+ * @brief Free the newest NPDU of the lowest priority queue that is below
+ *  a priority, to make room for an NPDU of that priority
+ * @param priority - network priority of the NPDU to be queued
+ * @return true if an NPDU was dropped
+ */
+static bool datalink_tx_evict(BACNET_MESSAGE_PRIORITY priority)
+{
+    struct datalink_tx_queue *queue;
+    struct datalink_tx_packet *prev;
+    unsigned i;
+
+    for (i = 0; i < (unsigned)priority; i++) {
+        queue = &TX_Queue[i];
+        if (queue->tail) {
+            prev = NULL;
+            if (queue->head != queue->tail) {
+                prev = queue->head;
+                while (prev->next != queue->tail) {
+                    prev = prev->next;
+                }
+            }
+            datalink_tx_remove(queue, prev, queue->tail);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Choose the next NPDU to hand to the datalink.  A queue that has
+ *  waited for DATALINK_TX_STARVATION_LIMIT higher priority NPDUs is served
+ *  first, otherwise the highest priority NPDU that the rate shaping allows.
+ * @param priority - returns the network priority of the chosen NPDU
+ * @param prev - returns the packet before the chosen one in its queue
+ * @return the chosen packet, or NULL if none can be sent now
+ */
+static struct datalink_tx_packet *datalink_tx_select(
+    unsigned *priority, struct datalink_tx_packet **prev)
+{
+    struct datalink_tx_packet *packet;
+    unsigned i, pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        i = DATALINK_TX_PRIORITIES;
+        while (i > 0) {
+            i--;
+            if ((pass == 0) &&
+                (TX_Queue[i].skipped < DATALINK_TX_STARVATION_LIMIT)) {
+                continue;
+            }
+            *prev = NULL;
+            packet = TX_Queue[i].head;
+            while (packet) {
+                if (datalink_tx_rate_ready(
+                        &packet->dest, packet->npdu_data.priority)) {
+                    *priority = i;
+                    return packet;
+                }
+                *prev = packet;
+                packet = packet->next;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Hand the queued NPDUs to the datalink, highest priority first,
+ *  until the datalink stops accepting them
+ */
+void datalink_tx_task(void)
+{
+    struct datalink_tx_packet *packet;
+    struct datalink_tx_packet *prev = NULL;
+    unsigned priority = 0;
+    unsigned count = DATALINK_TX_QUEUE_SIZE;
+    unsigned i;
+    int bytes;
+
+    while (TX_Pending && count--) {
+        packet = datalink_tx_select(&priority, &prev);
+        if (!packet) {
+            break;
+        }
+        bytes = datalink_transport_send_pdu(
+            &packet->dest, &packet->npdu_data, packet->pdu, packet->pdu_len);
+        if (bytes == 0) {
+            /* the datalink queue is full - try again later */
+            break;
+        }
+        if (bytes > 0) {
+            datalink_tx_rate_take(&packet->dest, packet->npdu_data.priority);
+        }
+        datalink_tx_remove(&TX_Queue[priority], prev, packet);
+        TX_Queue[priority].skipped = 0;
+        for (i = 0; i < priority; i++) {
+            if (TX_Queue[i].head) {
+                TX_Queue[i].skipped++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Number of NPDUs waiting in the transmit scheduler
+ * @return number of queued NPDUs
+ */
+unsigned datalink_tx_pending(void)
+{
+    return TX_Pending;
+}
+
+/**
+ * @brief Send an NPDU through the transmit scheduler.  The NPDU goes
+ *  straight to the datalink when nothing is queued and the datalink
+ *  accepts it, otherwise it waits in the queue of its network priority.
+ *  When the queues are full, a lower priority NPDU is dropped for it.
+ * @param dest - destination address of the NPDU
+ * @param npdu_data - NPDU information, including the network priority
+ * @param pdu - the NPDU to send
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent or queued, zero if it was dropped, or
+ *  negative on a datalink error
+ */
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    struct datalink_tx_packet *packet;
+    struct datalink_tx_queue *queue;
+    BACNET_MESSAGE_PRIORITY priority;
+    int bytes;
+
+#if defined(BACNET_APDU_STATISTICS)
+    apdu_statistics_reply(pdu, pdu_len);
+#endif
+    if (!TX_Initialized) {
+        datalink_tx_init();
+    }
+    if (!npdu_data || !dest || (pdu_len == 0) || (pdu_len > MAX_MPDU)) {
+        return datalink_transport_send_pdu(dest, npdu_data, pdu, pdu_len);
+    }
+    priority = npdu_data->priority & 0x03;
+    if ((TX_Pending == 0) && datalink_tx_rate_ready(dest, priority)) {
+        bytes = datalink_transport_send_pdu(dest, npdu_data, pdu, pdu_len);
+        if (bytes != 0) {
+            if (bytes > 0) {
+                datalink_tx_rate_take(dest, priority);
+            }
+            return bytes;
+        }
+    }
+    if (!TX_Free && !datalink_tx_evict(priority)) {
+        return 0;
+    }
+    packet = TX_Free;
+    TX_Free = packet->next;
+    packet->dest = *dest;
+    npdu_copy_data(&packet->npdu_data, npdu_data);
+    packet->npdu_data.priority = priority;
+    memcpy(packet->pdu, pdu, pdu_len);
+    packet->pdu_len = pdu_len;
+    packet->next = NULL;
+    queue = &TX_Queue[priority];
+    if (queue->tail) {
+        queue->tail->next = packet;
+    } else {
+        queue->head = packet;
+    }
+    queue->tail = packet;
+    TX_Pending++;
+    datalink_tx_task();
+
+    return pdu_len;
+}
+#endif
+
+uint16_t datalink_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+{
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+    if (TX_Pending) {
+        datalink_tx_task();
+    }
+#endif
+    if (Datalink_Port_Count > 1) {
+        return datalink_port_receive(src, pdu, max_pdu, timeout);
+    }
+
+    return transport_receive(Datalink_Transport, src, pdu, max_pdu, timeout);
+}
+
+#if defined(BACNET_BIP_BATCH)
+/**
+ * @brief Receive many NPDUs at once, where the datalink supports it.
+ *  Other datalinks return at most one NPDU from datalink_receive().
+ * @param packets - returns the source address and NPDU of each packet
+ * @param max_packets - maximum number of packets to return
+ * @param timeout - number of milliseconds to wait for a packet
+ * @return number of packets returned; valid until the next call
+ */
+unsigned datalink_receive_many(
+    BACNET_DATALINK_PACKET *packets, unsigned max_packets, unsigned timeout)
+{
+    static uint8_t pdu[MAX_MPDU];
+    uint16_t pdu_len;
+
+    if (!packets || (max_packets == 0)) {
+        return 0;
+    }
 #if defined(BACDL_BIP)
-        case DATALINK_BIP:
-            bvlc_maintenance_timer(seconds);
-            break;
+    if ((Datalink_Transport == DATALINK_BIP) && (Datalink_Port_Count < 2)) {
+        return bip_receive_many(packets, max_packets, timeout);
+    }
 #endif
-#if defined(BACDL_BIP6)
-        case DATALINK_BIP6:
-            bvlc6_maintenance_timer(seconds);
-            break;
+    pdu_len = datalink_receive(&packets[0].src, pdu, sizeof(pdu), timeout);
+    if (pdu_len == 0) {
+        return 0;
+    }
+    packets[0].pdu = pdu;
+    packets[0].pdu_len = pdu_len;
+
+    return 1;
+}
+
+/**
+ * @brief Send any datagrams queued by the datalink
+ */
+void datalink_send_flush(void)
+{
+#if defined(BACDL_BIP)
+    unsigned i;
+
+    if (Datalink_Transport == DATALINK_BIP) {
+        bip_send_flush();
+    }
+    for (i = 1; i < Datalink_Port_Count; i++) {
+        if (Datalink_Port[i].transport == DATALINK_BIP) {
+            bip_send_flush();
+        }
+    }
 #endif
-#if defined(BACDL_MSTP)
-        case DATALINK_MSTP:
-            break;
+}
 #endif
-#if defined(BACDL_ZIGBEE)
-        case DATALINK_ZIGBEE:
-            bzll_maintenance_timer(seconds);
-            break;
+
+#if defined(BACNET_PBUF_SEND)
+/**
+ * @brief Send an NPDU from a PDU buffer.  BACnet/IPv4 prepends its header
+ *  in the headroom of the buffer, and the other datalinks copy the NPDU.
+ * @param dest - destination address of the NPDU
+ * @param npdu_data - NPDU information, including the network priority
+ * @param pbuf - the NPDU, after DATALINK_HEADROOM bytes of headroom
+ * @return number of bytes sent, or negative on a datalink error
+ */
+int datalink_send_pbuf(
+    BACNET_ADDRESS *dest, BACNET_NPDU_DATA *npdu_data, BACNET_PBUF *pbuf)
+{
+#if defined(BACDL_BIP) && !defined(BACNET_DATALINK_TX_SCHEDULER)
+    if ((Datalink_Transport == DATALINK_BIP) && (Datalink_Port_Count < 2)) {
+#if defined(BACNET_APDU_STATISTICS)
+        apdu_statistics_reply(pbuf_data(pbuf), pbuf_length(pbuf));
 #endif
-#if defined(BACDL_BSC)
-        case DATALINK_BSC:
-            bsc_maintenance_timer(seconds);
-            break;
+        return bvlc_send_pbuf(dest, npdu_data, pbuf);
+    }
 #endif
-        default:
-            break;
+    return datalink_send_pdu(
+        dest, npdu_data, pbuf_data(pbuf), pbuf_length(pbuf));
+}
+#endif
+
+void datalink_cleanup(void)
+{
+    unsigned i;
+
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+    /* drop the NPDUs that are still queued */
+    datalink_tx_init();
+#endif
+    transport_cleanup(Datalink_Transport);
+    for (i = 1; i < Datalink_Port_Count; i++) {
+        transport_cleanup(Datalink_Port[i].transport);
+    }
+    Datalink_Port_Count = 0;
+    Datalink_Port_Next = 0;
+}
+
+void datalink_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    transport_get_broadcast_address(Datalink_Transport, dest);
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    transport_get_my_address(Datalink_Transport, my_address);
+}
+
+void datalink_set_interface(char *ifname)
+{
+    (void)ifname;
+}
+
+void datalink_maintenance_timer(uint16_t seconds)
+{
+    unsigned i;
+
+    transport_maintenance_timer(Datalink_Transport, seconds);
+    for (i = 1; i < Datalink_Port_Count; i++) {
+        transport_maintenance_timer(Datalink_Port[i].transport, seconds);
     }
 }
 #endif
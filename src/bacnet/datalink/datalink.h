@@ -38,6 +38,12 @@
 #include "bacnet/datalink/bsc/bsc-conf.h"
 #include "bacnet/datalink/bsc/bsc-datalink.h"
 #endif
+#if defined(BACDL_LOOPBACK)
+#include "bacnet/datalink/loopback.h"
+#endif
+#if defined(BACDL_SHM)
+#include "bacnet/datalink/dlshm.h"
+#endif
 
 #if defined(BACDL_ETHERNET) && !defined(BACDL_MULTIPLE)
 #define MAX_MPDU ETHERNET_MPDU_MAX
@@ -78,6 +84,10 @@
 #define datalink_init bip_init
 #define datalink_send_pdu bip_send_pdu
 #define datalink_receive bip_receive
+#if defined(BACNET_BIP_BATCH)
+#define datalink_receive_many bip_receive_many
+#define datalink_send_flush bip_send_flush
+#endif
 #define datalink_cleanup bip_cleanup
 #define datalink_get_broadcast_address bip_get_broadcast_address
 #ifdef BAC_ROUTING
@@ -129,12 +139,61 @@ void routed_get_my_address(BACNET_ADDRESS *my_address);
 #define datalink_get_my_address bsc_get_my_address
 #define datalink_maintenance_timer(s) bsc_maintenance_timer(s)
 
+#elif defined(BACDL_LOOPBACK) && !defined(BACDL_MULTIPLE)
+#define MAX_MPDU LOOPBACK_MPDU_MAX
+
+#define datalink_init loopback_init
+#define datalink_send_pdu loopback_send_pdu
+#define datalink_receive loopback_receive
+#define datalink_cleanup loopback_cleanup
+#define datalink_get_broadcast_address loopback_get_broadcast_address
+#define datalink_get_my_address loopback_get_my_address
+#define datalink_maintenance_timer(s)
+
+#elif defined(BACDL_SHM) && !defined(BACDL_MULTIPLE)
+#define MAX_MPDU DLSHM_MPDU_MAX
+
+#define datalink_init dlshm_init
+#define datalink_send_pdu dlshm_send_pdu
+#define datalink_receive dlshm_receive
+#define datalink_cleanup dlshm_cleanup
+#define datalink_get_broadcast_address dlshm_get_broadcast_address
+#define datalink_get_my_address dlshm_get_my_address
+#define datalink_maintenance_timer(s)
+
 #elif !defined(BACDL_TEST) /* Multiple, none or custom datalink */
 #include "bacnet/npdu.h"
 
 #define MAX_HEADER (17) /* ETHERNET_HEADER_MAX */
 #define MAX_MPDU (MAX_HEADER + MAX_PDU)
 
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+/* number of NPDUs the transmit scheduler can hold while the datalink
+   is busy */
+#ifndef DATALINK_TX_QUEUE_SIZE
+#define DATALINK_TX_QUEUE_SIZE 16
+#endif
+/* higher priority NPDUs sent before a waiting queue is served */
+#ifndef DATALINK_TX_STARVATION_LIMIT
+#define DATALINK_TX_STARVATION_LIMIT 8
+#endif
+/* normal priority NPDUs per second to each destination MAC, or 0 to
+   send them as fast as the datalink accepts them */
+#ifndef DATALINK_TX_RATE_LIMIT
+#define DATALINK_TX_RATE_LIMIT 0
+#endif
+/* number of destinations with their own rate limit */
+#ifndef DATALINK_TX_RATE_DESTINATIONS
+#define DATALINK_TX_RATE_DESTINATIONS 8
+#endif
+#endif
+
+/* number of datalinks that can be bound at once with their own network
+   numbers, to be routed in process */
+#ifndef DATALINK_PORTS_MAX
+#define DATALINK_PORTS_MAX 4
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -153,6 +212,23 @@ BACNET_STACK_EXPORT
 uint16_t datalink_receive(
     BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
 
+#if defined(BACNET_BIP_BATCH)
+BACNET_STACK_EXPORT
+unsigned datalink_receive_many(
+    BACNET_DATALINK_PACKET *packets, unsigned max_packets, unsigned timeout);
+
+BACNET_STACK_EXPORT
+void datalink_send_flush(void);
+#endif
+
+#if defined(BACNET_DATALINK_TX_SCHEDULER)
+BACNET_STACK_EXPORT
+void datalink_tx_task(void);
+
+BACNET_STACK_EXPORT
+unsigned datalink_tx_pending(void);
+#endif
+
 BACNET_STACK_EXPORT
 void datalink_cleanup(void);
 
@@ -171,9 +247,60 @@ void datalink_set(char *datalink_string);
 BACNET_STACK_EXPORT
 void datalink_maintenance_timer(uint16_t seconds);
 
+#if defined(BACDL_MULTIPLE)
+BACNET_STACK_EXPORT
+uint16_t datalink_max_apdu(void);
+
+BACNET_STACK_EXPORT
+bool datalink_port_add(char *datalink_string, char *ifname, uint16_t network);
+
+BACNET_STACK_EXPORT
+unsigned datalink_port_count(void);
+
+BACNET_STACK_EXPORT
+uint16_t datalink_port_network(unsigned port);
+
+BACNET_STACK_EXPORT
+uint16_t datalink_port_max_apdu(unsigned port);
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
+
+#if !defined(BACDL_MULTIPLE)
+/* a single datalink carries the MAX_APDU it was built for */
+#define datalink_max_apdu() MAX_APDU
+#endif
+
+#if defined(BACNET_PBUF_SEND)
+#include "bacnet/basic/sys/pbuf.h"
+/* bytes to keep in front of an NPDU for a datalink header that is
+   prepended in place */
+#ifndef DATALINK_HEADROOM
+#if defined(BACDL_BIP)
+#define DATALINK_HEADROOM BIP_HEADER_MAX
+#else
+#define DATALINK_HEADROOM 0
+#endif
+#endif
+#if defined(BACDL_MULTIPLE)
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+int datalink_send_pbuf(
+    BACNET_ADDRESS *dest, BACNET_NPDU_DATA *npdu_data, BACNET_PBUF *pbuf);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
+#else
+#define datalink_send_pbuf(dest, npdu_data, pbuf) \
+    datalink_send_pdu(dest, npdu_data, pbuf_data(pbuf), pbuf_length(pbuf))
+#endif
 #endif
 /** @defgroup DataLink The BACnet Network (DataLink) Layer
  * <b>6 THE NETWORK LAYER </b><br>
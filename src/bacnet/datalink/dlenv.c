@@ -11,12 +11,14 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/memusage.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/bbmd/h_bbmd.h"
 #include "bacnet/basic/object/netport.h"
@@ -448,7 +450,7 @@ static void dlenv_network_port_bip_init(uint32_t instance)
     Network_Port_Reliability_Set(instance, RELIABILITY_NO_FAULT_DETECTED);
     Network_Port_Out_Of_Service_Set(instance, false);
     Network_Port_Quality_Set(instance, PORT_QUALITY_UNKNOWN);
-    Network_Port_APDU_Length_Set(instance, MAX_APDU);
+    Network_Port_APDU_Length_Set(instance, apdu_max_length_accepted());
     Network_Port_Network_Number_Set(instance, 0);
     /* last thing - clear pending changes - we don't want to set these
        since they are already set */
@@ -504,6 +506,10 @@ void dlenv_network_port_mstp_init(uint32_t instance)
     dlmstp_set_max_master(max_master);
     dlmstp_set_baud_rate(baud_rate);
     dlmstp_set_mac_address(mac_address);
+#if defined(BACNET_MSTP_FAST_REPLY)
+    /* answer ReadProperty in the MS/TP thread, within Treply_delay */
+    dlmstp_set_reply_callback(handler_read_property_fast_reply);
+#endif
 #endif
 
     Network_Port_Object_Instance_Number_Set(0, instance);
@@ -518,7 +524,7 @@ void dlenv_network_port_mstp_init(uint32_t instance)
     Network_Port_Reliability_Set(instance, RELIABILITY_NO_FAULT_DETECTED);
     Network_Port_Out_Of_Service_Set(instance, false);
     Network_Port_Quality_Set(instance, PORT_QUALITY_UNKNOWN);
-    Network_Port_APDU_Length_Set(instance, MAX_APDU);
+    Network_Port_APDU_Length_Set(instance, apdu_max_length_accepted());
     Network_Port_Network_Number_Set(instance, 0);
     /* last thing - clear pending changes - we don't want to set these
        since they are already set */
@@ -577,7 +583,7 @@ void dlenv_network_port_bip6_init(uint32_t instance)
     Network_Port_Link_Speed_Set(instance, 0.0);
     Network_Port_Out_Of_Service_Set(instance, false);
     Network_Port_Quality_Set(instance, PORT_QUALITY_UNKNOWN);
-    Network_Port_APDU_Length_Set(instance, MAX_APDU);
+    Network_Port_APDU_Length_Set(instance, apdu_max_length_accepted());
     Network_Port_Network_Number_Set(instance, 0);
     /* last thing - clear pending changes - we don't want to set these
        since they are already set */
@@ -605,7 +611,7 @@ void dlenv_network_port_zigbee_init(uint32_t instance)
     Network_Port_Link_Speed_Set(instance, 0.0);
     Network_Port_Out_Of_Service_Set(instance, false);
     Network_Port_Quality_Set(instance, PORT_QUALITY_UNKNOWN);
-    Network_Port_APDU_Length_Set(instance, MAX_APDU);
+    Network_Port_APDU_Length_Set(instance, apdu_max_length_accepted());
     Network_Port_Network_Number_Set(instance, 0);
     /* last thing - clear pending changes - we don't want to set these
        since they are already set */
@@ -675,7 +681,7 @@ void dlenv_network_port_bsc_init(uint32_t instance)
     Network_Port_Reliability_Set(instance, RELIABILITY_NO_FAULT_DETECTED);
     Network_Port_Out_Of_Service_Set(instance, false);
     Network_Port_Quality_Set(instance, PORT_QUALITY_UNKNOWN);
-    Network_Port_APDU_Length_Set(instance, MAX_APDU);
+    Network_Port_APDU_Length_Set(instance, apdu_max_length_accepted());
     Network_Port_Network_Number_Set(instance, 0);
 
     /* SC parameters */
@@ -820,6 +826,7 @@ void dlenv_network_port_bsc_init(uint32_t instance)
         debug_printf_stderr("BSC Certificate files missing.\n");
         exit(1);
     }
+    memusage_register("bsc-datalink", bsc_memory_usage);
 #endif
 }
 
@@ -900,6 +907,54 @@ void dlenv_maintenance_timer(uint16_t elapsed_seconds)
     }
 }
 
+#if defined(BACDL_MULTIPLE)
+/**
+ * @brief Bind the datalink ports listed in an environment variable, as
+ *  "datalink:network[:ifname]" entries separated by commas.  The first
+ *  entry gives the network number of the datalink of the local device.
+ * @param ports - the list of ports
+ */
+static void dlenv_datalink_ports_init(const char *ports)
+{
+    char entry[128];
+    char *network, *ifname;
+    unsigned long net;
+    size_t len;
+
+    while (*ports) {
+        len = strcspn(ports, ",");
+        if (len < sizeof(entry)) {
+            memcpy(entry, ports, len);
+            entry[len] = 0;
+            ifname = NULL;
+            network = strchr(entry, ':');
+            if (network) {
+                *network++ = 0;
+                ifname = strchr(network, ':');
+                if (ifname) {
+                    *ifname++ = 0;
+                }
+                net = strtoul(network, NULL, 0);
+                if ((net <= UINT16_MAX) &&
+                    datalink_port_add(entry, ifname, (uint16_t)net)) {
+                    if (datalink_port_count() == 1) {
+                        npdu_network_number_set((uint16_t)net);
+                    }
+                } else {
+                    debug_fprintf(
+                        stderr, "BACNET_DATALINK_PORTS: unable to bind %s\n",
+                        entry);
+                }
+            }
+        }
+        ports += len;
+        if (*ports) {
+            ports++;
+        }
+    }
+}
+#endif
+
 /** Initialize the DataLink configuration from Environment variables,
  * or else to defaults.
  * @ingroup DataLink
@@ -913,12 +968,19 @@ void dlenv_maintenance_timer(uint16_t elapsed_seconds)
  * The Environment Variables, by BACDL_ type, are:
  * - BACDL_ALL: (the general-purpose solution)
  *   - BACNET_DATALINK to set which BACDL_ type we are using.
+ *   - BACNET_DATALINK_PORTS to bind several datalinks at once, routed
+ *     in process, as "datalink:network[:ifname]" entries separated by
+ *     commas, e.g. "bip:1,bip6:2:eth1".  The first entry is the
+ *     datalink of BACNET_DATALINK.
  * - (Any):
  *   - BACNET_APDU_TIMEOUT - set this value in milliseconds to change
  *     the APDU timeout.  APDU Timeout is how much time a client
  *     waits for a response from a BACnet device.
  *   - BACNET_APDU_RETRIES - indicate the maximum number of times that
  *     an APDU shall be retransmitted.
+ *   - BACNET_MAX_APDU - set this value to the largest APDU in octets,
+ *     50..MAX_APDU, that the device sends and accepts.  The default is
+ *     the limit of the datalink of BACNET_DATALINK.
  *   - BACNET_IFACE - set this value to dotted IP address (Windows) of
  *     the interface (see ipconfig command on Windows) for which you
  *     want to bind.  On Linux, set this to the /dev interface
@@ -926,6 +988,9 @@ void dlenv_maintenance_timer(uint16_t elapsed_seconds)
  *     interface on Windows.  Hence, if there is only a single network
  *     interface on Windows, the applications will choose it, and this
  *     setting will not be needed.
+ *   - BACNET_MEMORY_LOCK - on Linux, set to 1 to lock the memory of
+ *     the process, so that the datalink threads are not delayed by page
+ *     faults.
  * - BACDL_BIP: (BACnet/IP)
  *   - BACNET_IP_PORT - UDP/IP port number (0..65534) used for BACnet/IP
  *     communications.  Default is 47808 (0xBAC0).
@@ -946,6 +1011,9 @@ void dlenv_maintenance_timer(uint16_t elapsed_seconds)
  *   - BACNET_MAX_MASTER
  *   - BACNET_MSTP_BAUD
  *   - BACNET_MSTP_MAC
+ *   - BACNET_MSTP_PRIORITY - on Linux, the SCHED_FIFO priority 1..99 of
+ *     the MS/TP thread, or 0 for the default policy.  Default is 99.
+ *   - BACNET_MSTP_CPU - on Linux, the CPU to pin the MS/TP thread to.
  * - BACDL_BIP6: (BACnet/IPv6)
  *   - BACNET_BIP6_PORT - UDP/IP port number (0..65534) used for BACnet/IPv6
  *     communications.  Default is 47808 (0xBAC0).
@@ -972,6 +1040,10 @@ void dlenv_maintenance_timer(uint16_t elapsed_seconds)
  *   - BACNET_SC_DIRECT_CONNECT_ACCEPT_URLS - list of direct connect accept URLs
  *       separated by a space character, e.g.
  *       "wss://192.0.0.1:40000 wss://192.0.0.2:6666"
+ *   - BACNET_BSC_PRIORITY - on Linux, the SCHED_FIFO priority 1..99 of the
+ *       websocket service threads, or 0 for the default policy
+ *   - BACNET_BSC_CPU - on Linux, the CPU to pin the websocket service
+ *       threads to
  */
 void dlenv_init(void)
 {
@@ -999,6 +1071,10 @@ void dlenv_init(void)
             port_type = PORT_TYPE_MSTP;
         } else if (bacnet_stricmp("bsc", pEnv) == 0) {
             port_type = PORT_TYPE_BSC;
+        } else if (bacnet_stricmp("loopback", pEnv) == 0) {
+            port_type = PORT_TYPE_VIRTUAL;
+        } else if (bacnet_stricmp("shm", pEnv) == 0) {
+            port_type = PORT_TYPE_VIRTUAL;
         }
     } else {
 #if defined(BACDL_BIP)
@@ -1022,6 +1098,12 @@ void dlenv_init(void)
 #elif defined(BACDL_BSC)
         datalink_set("bsc");
         port_type = PORT_TYPE_BSC;
+#elif defined(BACDL_LOOPBACK)
+        datalink_set("loopback");
+        port_type = PORT_TYPE_VIRTUAL;
+#elif defined(BACDL_SHM)
+        datalink_set("shm");
+        port_type = PORT_TYPE_VIRTUAL;
 #else
         datalink_set("none");
         port_type = PORT_TYPE_NON_BACNET;
@@ -1044,6 +1126,8 @@ void dlenv_init(void)
     port_type = PORT_TYPE_ZIGBEE;
 #elif defined(BACDL_BSC)
     port_type = PORT_TYPE_BSC;
+#elif defined(BACDL_LOOPBACK) || defined(BACDL_SHM)
+    port_type = PORT_TYPE_VIRTUAL;
 #else
     port_type = PORT_TYPE_NON_BACNET;
 #endif
@@ -1055,6 +1139,14 @@ void dlenv_init(void)
         debug_printf_stderr("POSIX file services initialized.\n");
     }
 #endif
+    /* the largest APDU follows the datalink, not the largest datalink
+       that the buffers are sized for */
+    pEnv = getenv("BACNET_MAX_APDU");
+    if (pEnv) {
+        apdu_max_length_accepted_set((uint16_t)strtol(pEnv, NULL, 0));
+    } else {
+        apdu_max_length_accepted_set(datalink_max_apdu());
+    }
     /* === Initialize the Network Port Object Here === */
     Network_Port_Type_Set(Network_Port_Instance, port_type);
     switch (port_type) {
@@ -1096,6 +1188,12 @@ void dlenv_init(void)
     if (!datalink_init(pEnv)) {
         exit(1);
     }
+#if defined(BACDL_MULTIPLE)
+    pEnv = getenv("BACNET_DATALINK_PORTS");
+    if (pEnv) {
+        dlenv_datalink_ports_init(pEnv);
+    }
+#endif
     /* === POST INIT - After the Datalink is Initialized === */
 #if (MAX_TSM_TRANSACTIONS)
     pEnv = getenv("BACNET_INVOKE_ID");
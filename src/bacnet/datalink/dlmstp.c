@@ -52,6 +52,11 @@ int dlmstp_send_pdu(
     if (!user) {
         return 0;
     }
+    if ((pdu_len > MSTP_FRAME_NPDU_MAX) && dest && dest->mac_len &&
+        !MSTP_Extended_Frame_Peer_Allowed(MSTP_Port, dest->mac[0])) {
+        /* a legacy station would discard the extended frame */
+        return 0;
+    }
     pkt = (struct dlmstp_packet *)(void *)Ringbuf_Data_Peek(&user->PDU_Queue);
     if (pkt && (pdu_len <= DLMSTP_MPDU_MAX)) {
         if (npdu_data->data_expecting_reply) {
@@ -868,6 +873,7 @@ void dlmstp_reset_statistics(void)
         return;
     }
     memset(&user->Statistics, 0, sizeof(struct dlmstp_statistics));
+    MSTP_Statistics_Reset(MSTP_Port);
 }
 
 /**
@@ -891,6 +897,33 @@ void dlmstp_fill_statistics(struct dlmstp_statistics *statistics)
     }
 }
 
+/**
+ * @brief Copy the MSTP state machine statistics if they exist
+ * @param statistics - MSTP state machine statistics
+ * @return true if the statistics were copied
+ */
+bool dlmstp_fill_mstp_statistics(struct mstp_port_statistics *statistics)
+{
+    if (!MSTP_Port || !MSTP_Port->Statistics || !statistics) {
+        return false;
+    }
+    memmove(statistics, MSTP_Port->Statistics, sizeof(*statistics));
+
+    return true;
+}
+
+/**
+ * @brief Get the largest APDU that a station receives, as learned by the
+ *  MS/TP port from the frames of the station
+ * @param mac - MS/TP MAC address of the station
+ * @return 480 for a legacy station, 1476 for a station that receives
+ *  extended frames, or 0 when it is not known
+ */
+uint16_t dlmstp_peer_max_apdu(uint8_t mac)
+{
+    return MSTP_Extended_Frame_Peer_Max_APDU(MSTP_Port, mac);
+}
+
 /**
  * @brief Get the MSTP port Max-Info-Frames limit
  * @return Max-Info-Frames limit
@@ -96,6 +96,15 @@ typedef void (*dlmstp_hook_frame_rx_complete_cb)(
     uint8_t *pdu,
     uint16_t pdu_len);
 
+/* callback to answer a DATA_EXPECTING_REPLY frame in the MS/TP thread,
+   which returns the length of the reply NPDU, or 0 if there is none */
+typedef uint16_t (*dlmstp_hook_reply_cb)(
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t pdu_len,
+    uint8_t *reply,
+    uint16_t reply_size);
+
 /**
  * An example structure of user data for BACnet MS/TP
  */
@@ -122,6 +131,8 @@ extern "C" {
 BACNET_STACK_EXPORT
 bool dlmstp_init(char *ifname);
 BACNET_STACK_EXPORT
+uint16_t dlmstp_peer_max_apdu(uint8_t mac);
+BACNET_STACK_EXPORT
 void dlmstp_set_interface(const char *ifname);
 BACNET_STACK_EXPORT
 const char *dlmstp_get_interface(void);
@@ -253,6 +264,11 @@ void dlmstp_set_invalid_frame_rx_complete_callback(
 /* interfering with bus timing */
 BACNET_STACK_EXPORT
 void dlmstp_set_frame_rx_start_callback(dlmstp_hook_frame_rx_start_cb cb_func);
+/* Set the callback function that may answer a DATA_EXPECTING_REPLY */
+/* frame from the MS/TP thread, such as handler_read_property_fast_reply(), */
+/* so the reply is sent without waiting for the application */
+BACNET_STACK_EXPORT
+void dlmstp_set_reply_callback(dlmstp_hook_reply_cb cb_func);
 
 /* Reset the statistics counters on the MS/TP datalink */
 BACNET_STACK_EXPORT
@@ -264,6 +280,12 @@ void dlmstp_reset_statistics(void);
 BACNET_STACK_EXPORT
 void dlmstp_fill_statistics(struct dlmstp_statistics *statistics);
 
+/* Retrieve the MS/TP state machine statistics and timing histograms,
+   if the datalink keeps them */
+struct mstp_port_statistics;
+BACNET_STACK_EXPORT
+bool dlmstp_fill_mstp_statistics(struct mstp_port_statistics *statistics);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
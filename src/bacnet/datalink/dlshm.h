@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief API for a shared-memory datalink, which delivers NPDUs between
+ *  the BACnet processes of one host through queues in a named shared
+ *  memory segment that is a virtual BACnet network
+ * @copyright SPDX-License-Identifier: MIT
+ * @ingroup DataLink
+ */
+#ifndef BACNET_DATALINK_DLSHM_H
+#define BACNET_DATALINK_DLSHM_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/npdu.h"
+
+/* largest NPDU carried by the shared-memory datalink */
+#ifndef DLSHM_MPDU_MAX
+#define DLSHM_MPDU_MAX MAX_PDU
+#endif
+
+/* number of nodes, whose MAC addresses are 0..DLSHM_NODES_MAX-1 */
+#ifndef DLSHM_NODES_MAX
+#define DLSHM_NODES_MAX 16
+#endif
+
+/* number of NPDUs waiting in the queue of each node - a power of two */
+#ifndef DLSHM_QUEUE_SIZE
+#define DLSHM_QUEUE_SIZE 32
+#endif
+
+/* longest name of a virtual network */
+#ifndef DLSHM_NAME_MAX
+#define DLSHM_NAME_MAX 32
+#endif
+
+/**
+ * One attachment of a process to a virtual network.  A process may
+ * attach to several networks, such as a router with a port on each.
+ */
+typedef struct dlshm_port {
+    /* the shared memory segment, or NULL if not attached */
+    void *segment;
+    /* MAC address of this node in the virtual network */
+    uint8_t node;
+    char name[DLSHM_NAME_MAX + 2];
+} DLSHM_PORT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* the datalink API, for one attachment per process */
+BACNET_STACK_EXPORT
+bool dlshm_init(char *ifname);
+BACNET_STACK_EXPORT
+int dlshm_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len);
+BACNET_STACK_EXPORT
+uint16_t dlshm_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
+BACNET_STACK_EXPORT
+void dlshm_cleanup(void);
+BACNET_STACK_EXPORT
+void dlshm_get_broadcast_address(BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+void dlshm_get_my_address(BACNET_ADDRESS *my_address);
+
+/* the same API for any attachment */
+BACNET_STACK_EXPORT
+bool dlshm_port_open(DLSHM_PORT *port, const char *ifname);
+BACNET_STACK_EXPORT
+int dlshm_port_send_pdu(
+    DLSHM_PORT *port,
+    const BACNET_ADDRESS *dest,
+    const uint8_t *pdu,
+    unsigned pdu_len);
+BACNET_STACK_EXPORT
+uint16_t dlshm_port_receive(
+    DLSHM_PORT *port,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout);
+BACNET_STACK_EXPORT
+void dlshm_port_close(DLSHM_PORT *port);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
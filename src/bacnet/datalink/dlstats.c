@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @brief Traffic counters for each BACnet datalink, so the busy ports
+ *  can be found without a packet capture.  The counters are indexed by
+ *  the Network Port type of the datalink.
+ * @copyright SPDX-License-Identifier: MIT
+ * @ingroup DataLink
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/datalink/dlstats.h"
+
+/* one counter block for each standard port type up to BACnet/SC */
+#define DLSTATS_PORT_TYPES (PORT_TYPE_BSC + 1)
+
+static DLSTATS_COUNTERS DLStats[DLSTATS_PORT_TYPES];
+
+/* the datalinks that run a thread update their counters from it */
+#if defined(__GNUC__)
+#define DLSTATS_ADD(counter, value) \
+    __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define DLSTATS_STORE(counter, value) \
+    __atomic_store_n(&(counter), (value), __ATOMIC_RELAXED)
+#else
+#define DLSTATS_ADD(counter, value) ((counter) += (value))
+#define DLSTATS_STORE(counter, value) ((counter) = (value))
+#endif
+
+/**
+ * @brief Get the counter block of a datalink
+ * @param type - Network Port type of the datalink
+ * @return the counter block, or NULL if the type has none
+ */
+static DLSTATS_COUNTERS *dlstats_find(BACNET_PORT_TYPE type)
+{
+    if ((unsigned)type < DLSTATS_PORT_TYPES) {
+        return &DLStats[type];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Count a packet received by a datalink
+ * @param type - Network Port type of the datalink
+ * @param bytes - size of the received packet
+ */
+void dlstats_receive(BACNET_PORT_TYPE type, unsigned bytes)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+
+    if (counters) {
+        DLSTATS_ADD(counters->packets_in, 1);
+        DLSTATS_ADD(counters->bytes_in, bytes);
+    }
+}
+
+/**
+ * @brief Count a packet sent, or queued to be sent, by a datalink
+ * @param type - Network Port type of the datalink
+ * @param bytes - size of the sent packet
+ */
+void dlstats_send(BACNET_PORT_TYPE type, unsigned bytes)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+
+    if (counters) {
+        DLSTATS_ADD(counters->packets_out, 1);
+        DLSTATS_ADD(counters->bytes_out, bytes);
+    }
+}
+
+/**
+ * @brief Count a packet that a datalink could not send or queue
+ * @param type - Network Port type of the datalink
+ */
+void dlstats_drop(BACNET_PORT_TYPE type)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+
+    if (counters) {
+        DLSTATS_ADD(counters->drops, 1);
+    }
+}
+
+/**
+ * @brief Count a received packet that a datalink could not decode
+ * @param type - Network Port type of the datalink
+ */
+void dlstats_decode_error(BACNET_PORT_TYPE type)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+
+    if (counters) {
+        DLSTATS_ADD(counters->decode_errors, 1);
+    }
+}
+
+/**
+ * @brief Set the number of packets waiting to be sent by a datalink
+ * @param type - Network Port type of the datalink
+ * @param depth - number of packets in the transmit queue
+ */
+void dlstats_queue_depth_set(BACNET_PORT_TYPE type, unsigned depth)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+
+    if (counters) {
+        DLSTATS_STORE(counters->queue_depth, depth);
+    }
+}
+
+/**
+ * @brief Copy the counters of a datalink
+ * @param type - Network Port type of the datalink
+ * @param counters - returns the counters
+ * @return true if the datalink type has counters
+ */
+bool dlstats_counters(BACNET_PORT_TYPE type, DLSTATS_COUNTERS *counters)
+{
+    DLSTATS_COUNTERS *source = dlstats_find(type);
+
+    if (!source) {
+        return false;
+    }
+    if (counters) {
+        memcpy(counters, source, sizeof(DLSTATS_COUNTERS));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reset the counters of a datalink, except the queue depth
+ * @param type - Network Port type of the datalink
+ */
+void dlstats_reset(BACNET_PORT_TYPE type)
+{
+    DLSTATS_COUNTERS *counters = dlstats_find(type);
+    uint32_t queue_depth;
+
+    if (counters) {
+        queue_depth = counters->queue_depth;
+        memset(counters, 0, sizeof(DLSTATS_COUNTERS));
+        counters->queue_depth = queue_depth;
+    }
+}
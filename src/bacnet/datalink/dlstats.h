@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Traffic counters for each BACnet datalink
+ * @copyright SPDX-License-Identifier: MIT
+ * @ingroup DataLink
+ */
+#ifndef BACNET_DATALINK_DLSTATS_H
+#define BACNET_DATALINK_DLSTATS_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacenum.h"
+
+/* traffic counters of one datalink */
+typedef struct dlstats_counters {
+    uint32_t packets_in;
+    uint32_t packets_out;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+    /* packets that could not be sent or queued */
+    uint32_t drops;
+    /* received packets that could not be decoded */
+    uint32_t decode_errors;
+    /* packets waiting in the transmit queue of the datalink */
+    uint32_t queue_depth;
+} DLSTATS_COUNTERS;
+
+/* The datalinks update the counters through these macros, which compile
+   to nothing unless BACNET_DATALINK_STATISTICS is defined. */
+#if defined(BACNET_DATALINK_STATISTICS)
+#define DLSTATS_RECEIVE(type, bytes) dlstats_receive(type, bytes)
+#define DLSTATS_SEND(type, bytes) dlstats_send(type, bytes)
+#define DLSTATS_DROP(type) dlstats_drop(type)
+#define DLSTATS_DECODE_ERROR(type) dlstats_decode_error(type)
+#define DLSTATS_QUEUE_DEPTH(type, depth) dlstats_queue_depth_set(type, depth)
+#else
+#define DLSTATS_RECEIVE(type, bytes)
+#define DLSTATS_SEND(type, bytes)
+#define DLSTATS_DROP(type)
+#define DLSTATS_DECODE_ERROR(type)
+#define DLSTATS_QUEUE_DEPTH(type, depth)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void dlstats_receive(BACNET_PORT_TYPE type, unsigned bytes);
+BACNET_STACK_EXPORT
+void dlstats_send(BACNET_PORT_TYPE type, unsigned bytes);
+BACNET_STACK_EXPORT
+void dlstats_drop(BACNET_PORT_TYPE type);
+BACNET_STACK_EXPORT
+void dlstats_decode_error(BACNET_PORT_TYPE type);
+BACNET_STACK_EXPORT
+void dlstats_queue_depth_set(BACNET_PORT_TYPE type, unsigned depth);
+
+BACNET_STACK_EXPORT
+bool dlstats_counters(BACNET_PORT_TYPE type, DLSTATS_COUNTERS *counters);
+BACNET_STACK_EXPORT
+void dlstats_reset(BACNET_PORT_TYPE type);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,452 @@
+/**
+ * @file
+ * @brief In-process loopback datalink.  Each virtual node has a lock-free
+ *  queue of the NPDUs sent to it, filled by any node and emptied by the
+ *  node itself, so the devices, clients, and load generators of one
+ *  process exchange NPDUs without sockets.  The latency, loss, and MTU
+ *  of the virtual network are set by the application, and the loss is
+ *  drawn from a seeded generator so that a run can be repeated.
+ * @copyright SPDX-License-Identifier: MIT
+ * @ingroup DataLink
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/sys/ringbuf_atomic.h"
+#include "bacnet/datalink/dlstats.h"
+#include "bacnet/datalink/loopback.h"
+
+#if !defined(RINGBUF_ATOMIC_SUPPORTED)
+#error "The loopback datalink requires the atomic ring buffer"
+#endif
+
+/* an NPDU in the queue of a node */
+struct loopback_frame {
+    /* time at which the NPDU is delivered */
+    unsigned long due;
+    uint16_t pdu_len;
+    uint8_t src_node;
+    uint8_t pdu[LOOPBACK_MPDU_MAX];
+};
+
+struct loopback_node {
+    RING_BUFFER_ATOMIC queue;
+    uint32_t queue_buffer[(RINGBUF_ATOMIC_BUFFER_SIZE(
+                              sizeof(struct loopback_frame),
+                              LOOPBACK_QUEUE_SIZE) +
+                          sizeof(uint32_t) - 1) /
+                         sizeof(uint32_t)];
+    /* loss generator of the NPDUs sent by this node */
+    uint32_t random;
+    bool initialized;
+};
+
+static struct loopback_node Loopback_Node[LOOPBACK_NODES_MAX];
+/* node of the datalink API */
+static uint8_t Loopback_Node_Self;
+/* virtual network */
+static unsigned long Loopback_Latency;
+static uint32_t Loopback_Loss;
+static unsigned Loopback_MTU = LOOPBACK_MPDU_MAX;
+static uint32_t Loopback_Seed = 1;
+
+/**
+ * @brief Get a node that has a queue
+ * @param node - MAC address of the node
+ * @return the node, or NULL if the node does not exist
+ */
+static struct loopback_node *loopback_node_data(uint8_t node)
+{
+    struct loopback_node *data;
+
+    if (node >= LOOPBACK_NODES_MAX) {
+        return NULL;
+    }
+    data = &Loopback_Node[node];
+    if (!data->initialized) {
+        data->initialized = Ringbuf_Atomic_Initialize(
+            &data->queue, data->queue_buffer, sizeof(data->queue_buffer),
+            sizeof(struct loopback_frame), LOOPBACK_QUEUE_SIZE, true);
+        data->random = Loopback_Seed ^ (0x9E3779B9UL * (node + 1UL));
+    }
+
+    return data->initialized ? data : NULL;
+}
+
+/**
+ * @brief Determine if an NPDU sent by a node is lost, using the
+ *  xorshift generator of the node
+ * @param data - the sending node
+ * @return true if the NPDU is lost
+ */
+static bool loopback_lost(struct loopback_node *data)
+{
+    uint32_t x;
+
+    if (Loopback_Loss == 0) {
+        return false;
+    }
+    x = data->random;
+    if (x == 0) {
+        x = 1;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    data->random = x;
+
+    return (x % 1000000UL) < Loopback_Loss;
+}
+
+/**
+ * @brief Put an NPDU in the queue of a node
+ * @param src_node - MAC address of the sending node
+ * @param dest_node - MAC address of the receiving node
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @param due - time at which the NPDU is delivered
+ * @return true if the NPDU is queued
+ */
+static bool loopback_queue_put(
+    uint8_t src_node,
+    uint8_t dest_node,
+    const uint8_t *pdu,
+    unsigned pdu_len,
+    unsigned long due)
+{
+    struct loopback_node *data;
+    struct loopback_frame *frame;
+
+    data = loopback_node_data(dest_node);
+    if (!data) {
+        return false;
+    }
+    frame = Ringbuf_Atomic_Data_Peek(&data->queue);
+    if (!frame) {
+        return false;
+    }
+    frame->due = due;
+    frame->pdu_len = (uint16_t)pdu_len;
+    frame->src_node = src_node;
+    memcpy(frame->pdu, pdu, pdu_len);
+
+    return Ringbuf_Atomic_Data_Put(&data->queue, frame);
+}
+
+/**
+ * @brief Send an NPDU from any node.  An NPDU larger than the MTU is
+ *  not sent, and an NPDU to a node with a full queue, or that is lost,
+ *  is dropped as it would be on a network.
+ * @param node - MAC address of the sending node
+ * @param dest - destination address, or a local broadcast to every other
+ *  node when the MAC length is zero
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent, or -1 if the NPDU can not be sent
+ */
+int loopback_node_send_pdu(
+    uint8_t node,
+    const BACNET_ADDRESS *dest,
+    const uint8_t *pdu,
+    unsigned pdu_len)
+{
+    struct loopback_node *data;
+    unsigned long due;
+    uint8_t i;
+
+    data = loopback_node_data(node);
+    if (!data || !dest || !pdu || (pdu_len == 0) ||
+        (pdu_len > Loopback_MTU) || (pdu_len > LOOPBACK_MPDU_MAX)) {
+        DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+        return -1;
+    }
+    due = mstimer_now() + Loopback_Latency;
+    if (dest->mac_len == 0) {
+        for (i = 0; i < LOOPBACK_NODES_MAX; i++) {
+            if (i == node) {
+                continue;
+            }
+            if (loopback_lost(data) ||
+                !loopback_queue_put(node, i, pdu, pdu_len, due)) {
+                DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+            }
+        }
+    } else if (
+        loopback_lost(data) ||
+        !loopback_queue_put(node, dest->mac[0], pdu, pdu_len, due)) {
+        DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+    }
+    DLSTATS_SEND(PORT_TYPE_VIRTUAL, pdu_len);
+
+    return (int)pdu_len;
+}
+
+/**
+ * @brief Receive the next NPDU of any node that is due.  Each node is
+ *  emptied by one thread only.
+ * @param node - MAC address of the receiving node
+ * @param src - source address of the NPDU
+ * @param pdu - buffer for the NPDU
+ * @param max_pdu - size of the buffer
+ * @return number of bytes received, or 0 if no NPDU is due
+ */
+uint16_t loopback_node_receive(
+    uint8_t node, BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu)
+{
+    struct loopback_node *data;
+    struct loopback_frame *frame;
+    uint16_t pdu_len = 0;
+
+    data = loopback_node_data(node);
+    if (!data) {
+        return 0;
+    }
+    frame = Ringbuf_Atomic_Peek(&data->queue);
+    if (!frame) {
+        return 0;
+    }
+    if ((long)(mstimer_now() - frame->due) < 0) {
+        /* the NPDUs after this one are due later */
+        return 0;
+    }
+    if (pdu && (frame->pdu_len <= max_pdu)) {
+        pdu_len = frame->pdu_len;
+        memcpy(pdu, frame->pdu, pdu_len);
+        if (src) {
+            memset(src, 0, sizeof(*src));
+            src->mac_len = 1;
+            src->mac[0] = frame->src_node;
+        }
+        DLSTATS_RECEIVE(PORT_TYPE_VIRTUAL, pdu_len);
+    } else {
+        DLSTATS_DROP(PORT_TYPE_VIRTUAL);
+    }
+    (void)Ringbuf_Atomic_Pop(&data->queue, NULL);
+
+    return pdu_len;
+}
+
+/**
+ * @brief Get the number of NPDUs in the queue of a node
+ * @param node - MAC address of the node
+ * @return number of NPDUs queued, including those not yet due
+ */
+unsigned loopback_node_pending(uint8_t node)
+{
+    struct loopback_node *data;
+
+    data = loopback_node_data(node);
+    if (!data) {
+        return 0;
+    }
+
+    return Ringbuf_Atomic_Count(&data->queue);
+}
+
+/**
+ * @brief Select the node of the datalink API
+ * @param node - MAC address of the node, 0..LOOPBACK_NODES_MAX-1
+ * @return true if the node exists
+ */
+bool loopback_node_set(uint8_t node)
+{
+    if (node >= LOOPBACK_NODES_MAX) {
+        return false;
+    }
+    Loopback_Node_Self = node;
+
+    return true;
+}
+
+/**
+ * @brief Get the node of the datalink API
+ * @return MAC address of the node
+ */
+uint8_t loopback_node(void)
+{
+    return Loopback_Node_Self;
+}
+
+/**
+ * @brief Initialize the datalink API as one node of the virtual network,
+ *  and the queues of every node, before other threads use the network
+ * @param ifname - MAC address of the node as a decimal number, or NULL
+ *  for the node that was set before
+ * @return true if the node exists
+ */
+bool loopback_init(char *ifname)
+{
+    unsigned long node;
+    char *endptr = NULL;
+    uint8_t i;
+
+    for (i = 0; i < LOOPBACK_NODES_MAX; i++) {
+        (void)loopback_node_data(i);
+    }
+
+    if (ifname && ifname[0]) {
+        node = strtoul(ifname, &endptr, 0);
+        if ((endptr == ifname) || (node >= LOOPBACK_NODES_MAX)) {
+            return false;
+        }
+        Loopback_Node_Self = (uint8_t)node;
+    }
+
+    return loopback_node_data(Loopback_Node_Self) != NULL;
+}
+
+/**
+ * @brief Send an NPDU from the node of the datalink API
+ * @param dest - destination address
+ * @param npdu_data - network information, which is not used
+ * @param pdu - the NPDU
+ * @param pdu_len - number of bytes in the NPDU
+ * @return number of bytes sent, or -1 if the NPDU can not be sent
+ */
+int loopback_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)npdu_data;
+
+    return loopback_node_send_pdu(Loopback_Node_Self, dest, pdu, pdu_len);
+}
+
+/**
+ * @brief Receive the next NPDU of the node of the datalink API.  The
+ *  NPDUs are sent from this process, so there is nothing to wait for.
+ * @param src - source address of the NPDU
+ * @param pdu - buffer for the NPDU
+ * @param max_pdu - size of the buffer
+ * @param timeout - not used
+ * @return number of bytes received, or 0 if no NPDU is due
+ */
+uint16_t loopback_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+{
+    (void)timeout;
+
+    return loopback_node_receive(Loopback_Node_Self, src, pdu, max_pdu);
+}
+
+/**
+ * @brief Discard the NPDUs queued to the node of the datalink API
+ */
+void loopback_cleanup(void)
+{
+    struct loopback_node *data;
+
+    data = loopback_node_data(Loopback_Node_Self);
+    if (data) {
+        while (Ringbuf_Atomic_Pop(&data->queue, NULL)) {
+            /* discard */
+        }
+    }
+}
+
+/**
+ * @brief Get the local broadcast address of the virtual network
+ * @param dest - the broadcast address
+ */
+void loopback_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    if (dest) {
+        memset(dest, 0, sizeof(*dest));
+        dest->net = BACNET_BROADCAST_NETWORK;
+    }
+}
+
+/**
+ * @brief Get the address of the node of the datalink API
+ * @param my_address - the address of the node
+ */
+void loopback_get_my_address(BACNET_ADDRESS *my_address)
+{
+    if (my_address) {
+        memset(my_address, 0, sizeof(*my_address));
+        my_address->mac_len = 1;
+        my_address->mac[0] = Loopback_Node_Self;
+    }
+}
+
+/**
+ * @brief Set the time from sending an NPDU until it is received
+ * @param milliseconds - latency of the virtual network
+ */
+void loopback_latency_set(unsigned long milliseconds)
+{
+    Loopback_Latency = milliseconds;
+}
+
+/**
+ * @brief Get the time from sending an NPDU until it is received
+ * @return latency of the virtual network in milliseconds
+ */
+unsigned long loopback_latency(void)
+{
+    return Loopback_Latency;
+}
+
+/**
+ * @brief Set the share of the NPDUs that are lost
+ * @param parts_per_million - NPDUs lost for each million sent, 0..1000000
+ */
+void loopback_loss_set(uint32_t parts_per_million)
+{
+    if (parts_per_million > 1000000UL) {
+        parts_per_million = 1000000UL;
+    }
+    Loopback_Loss = parts_per_million;
+}
+
+/**
+ * @brief Get the share of the NPDUs that are lost
+ * @return NPDUs lost for each million sent
+ */
+uint32_t loopback_loss(void)
+{
+    return Loopback_Loss;
+}
+
+/**
+ * @brief Set the largest NPDU that is sent
+ * @param mtu - largest NPDU in bytes, up to LOOPBACK_MPDU_MAX
+ */
+void loopback_mtu_set(unsigned mtu)
+{
+    if ((mtu == 0) || (mtu > LOOPBACK_MPDU_MAX)) {
+        mtu = LOOPBACK_MPDU_MAX;
+    }
+    Loopback_MTU = mtu;
+}
+
+/**
+ * @brief Get the largest NPDU that is sent
+ * @return largest NPDU in bytes
+ */
+unsigned loopback_mtu(void)
+{
+    return Loopback_MTU;
+}
+
+/**
+ * @brief Restart the loss generator of every node from a seed, so that
+ *  the same NPDUs are lost when a run is repeated
+ * @param seed - seed of the loss generators
+ */
+void loopback_seed_set(uint32_t seed)
+{
+    uint8_t i;
+
+    Loopback_Seed = seed;
+    for (i = 0; i < LOOPBACK_NODES_MAX; i++) {
+        Loopback_Node[i].random = seed ^ (0x9E3779B9UL * (i + 1UL));
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief API for an in-process loopback datalink, which delivers NPDUs
+ *  between the virtual nodes of one process through lock-free queues,
+ *  with a configurable latency, loss, and MTU
+ * @copyright SPDX-License-Identifier: MIT
+ * @ingroup DataLink
+ */
+#ifndef BACNET_DATALINK_LOOPBACK_H
+#define BACNET_DATALINK_LOOPBACK_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/npdu.h"
+
+/* largest NPDU carried by the loopback datalink */
+#ifndef LOOPBACK_MPDU_MAX
+#define LOOPBACK_MPDU_MAX MAX_PDU
+#endif
+
+/* number of virtual nodes, whose MAC addresses are 0..LOOPBACK_NODES_MAX-1 */
+#ifndef LOOPBACK_NODES_MAX
+#define LOOPBACK_NODES_MAX 8
+#endif
+
+/* number of NPDUs waiting in the queue of each node - a power of two */
+#ifndef LOOPBACK_QUEUE_SIZE
+#define LOOPBACK_QUEUE_SIZE 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* the datalink API, for the node selected with loopback_init() */
+BACNET_STACK_EXPORT
+bool loopback_init(char *ifname);
+BACNET_STACK_EXPORT
+int loopback_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len);
+BACNET_STACK_EXPORT
+uint16_t loopback_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
+BACNET_STACK_EXPORT
+void loopback_cleanup(void);
+BACNET_STACK_EXPORT
+void loopback_get_broadcast_address(BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+void loopback_get_my_address(BACNET_ADDRESS *my_address);
+
+/* the same API for any node, so that each thread or simulated device
+   of the process can be its own node */
+BACNET_STACK_EXPORT
+int loopback_node_send_pdu(
+    uint8_t node,
+    const BACNET_ADDRESS *dest,
+    const uint8_t *pdu,
+    unsigned pdu_len);
+BACNET_STACK_EXPORT
+uint16_t loopback_node_receive(
+    uint8_t node, BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu);
+BACNET_STACK_EXPORT
+unsigned loopback_node_pending(uint8_t node);
+
+BACNET_STACK_EXPORT
+bool loopback_node_set(uint8_t node);
+BACNET_STACK_EXPORT
+uint8_t loopback_node(void);
+
+/* the behavior of the virtual network */
+BACNET_STACK_EXPORT
+void loopback_latency_set(unsigned long milliseconds);
+BACNET_STACK_EXPORT
+unsigned long loopback_latency(void);
+BACNET_STACK_EXPORT
+void loopback_loss_set(uint32_t parts_per_million);
+BACNET_STACK_EXPORT
+uint32_t loopback_loss(void);
+BACNET_STACK_EXPORT
+void loopback_mtu_set(unsigned mtu);
+BACNET_STACK_EXPORT
+unsigned loopback_mtu(void);
+BACNET_STACK_EXPORT
+void loopback_seed_set(uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -31,6 +31,7 @@
 #include "bacnet/datalink/mstp.h"
 #include "bacnet/datalink/crc.h"
 #include "bacnet/datalink/mstptext.h"
+#include "bacnet/bacdcode.h"
 #include "bacnet/npdu.h"
 #include "bacnet/basic/sys/debug.h"
 
@@ -218,10 +219,9 @@ uint16_t MSTP_Create_Frame(
         if ((8 + data_len + 2) > buffer_size) {
             return 0;
         }
-        for (index = 8; index < (data_len + 8); index++, data++) {
-            buffer[index] = *data;
-            crc16 = CRC_Calc_Data(buffer[index], crc16);
-        }
+        memmove(&buffer[8], data, data_len);
+        crc16 = CRC_Calc_Data_Buffer(&buffer[8], data_len, crc16);
+        index = 8 + data_len;
         crc16 = ~crc16;
         buffer[index] = crc16 & 0xFF; /* LSB first */
         buffer[index + 1] = crc16 >> 8;
@@ -229,15 +229,11 @@ uint16_t MSTP_Create_Frame(
     buffer[0] = 0x55;
     buffer[1] = 0xFF;
     buffer[2] = frame_type;
-    crc8 = CRC_Calc_Header(buffer[2], crc8);
     buffer[3] = destination;
-    crc8 = CRC_Calc_Header(buffer[3], crc8);
     buffer[4] = source;
-    crc8 = CRC_Calc_Header(buffer[4], crc8);
     buffer[5] = data_len >> 8; /* MSB first */
-    crc8 = CRC_Calc_Header(buffer[5], crc8);
     buffer[6] = data_len & 0xFF;
-    crc8 = CRC_Calc_Header(buffer[6], crc8);
+    crc8 = CRC_Calc_Header_Buffer(&buffer[2], 5, crc8);
     buffer[7] = ~crc8;
     index = 8;
     if (data_len > 0) {
@@ -256,6 +252,249 @@ uint16_t MSTP_Create_Frame(
  * @param data - any data to be sent - may be null
  * @param data_len - number of bytes of data
  */
+/**
+ * @brief Get the timing histogram bucket of a time
+ * @param milliseconds - the time
+ * @return the bucket, 0..MSTP_HISTOGRAM_BUCKETS-1
+ */
+static unsigned mstp_statistics_bucket(uint32_t milliseconds)
+{
+    unsigned bucket = 0;
+
+    while ((milliseconds > 0) && (bucket < (MSTP_HISTOGRAM_BUCKETS - 1))) {
+        milliseconds >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/**
+ * @brief Count a received token, and the time since the previous one
+ * @param mstp_port MSTP port context data
+ */
+static void mstp_statistics_token(struct mstp_port_struct_t *mstp_port)
+{
+    struct mstp_port_statistics *statistics = mstp_port->Statistics;
+    uint32_t now;
+
+    if (!statistics) {
+        return;
+    }
+    statistics->Token_Count++;
+    if (statistics->Milliseconds) {
+        now = statistics->Milliseconds();
+        if (statistics->Token_Time_Valid) {
+            statistics->Token_Rotation[mstp_statistics_bucket(
+                now - statistics->Token_Time)]++;
+        }
+        statistics->Token_Time = now;
+        statistics->Token_Time_Valid = true;
+    }
+}
+
+/**
+ * @brief Count a data frame sent while holding the token
+ * @param mstp_port MSTP port context data
+ * @param reply - true if the frame waits for a reply
+ */
+static void
+mstp_statistics_token_frame(struct mstp_port_struct_t *mstp_port, bool reply)
+{
+    struct mstp_port_statistics *statistics = mstp_port->Statistics;
+
+    if (!statistics) {
+        return;
+    }
+    statistics->Token_Frame_Count++;
+    if (mstp_port->FrameCount > statistics->Token_Frame_Max) {
+        statistics->Token_Frame_Max = mstp_port->FrameCount;
+    }
+    if (reply && statistics->Milliseconds) {
+        statistics->Request_Time = statistics->Milliseconds();
+    }
+}
+
+/**
+ * @brief Count the time from a Data Expecting Reply frame until its reply
+ * @param mstp_port MSTP port context data
+ */
+static void mstp_statistics_reply(struct mstp_port_struct_t *mstp_port)
+{
+    struct mstp_port_statistics *statistics = mstp_port->Statistics;
+
+    if (statistics && statistics->Milliseconds) {
+        statistics->Reply_Latency[mstp_statistics_bucket(
+            statistics->Milliseconds() - statistics->Request_Time)]++;
+    }
+}
+
+/**
+ * @brief Learn whether the sender of a received BACnet data frame can
+ *  receive extended frames.  An extended frame, a confirmed request that
+ *  accepts an APDU larger than 480 octets, or an I-Am with such a
+ *  Max_APDU marks the station as capable.  An I-Am with a Max_APDU of
+ *  480 or less marks it as a legacy station.  Routed messages are not
+ *  used, since they describe a device behind the router.
+ * @param mstp_port MSTP port context data
+ */
+void MSTP_Extended_Frame_Peer_Update(struct mstp_port_struct_t *mstp_port)
+{
+    struct mstp_extended_frame_peers *peers;
+    BACNET_ADDRESS src = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    BACNET_UNSIGNED_INTEGER max_apdu = 0;
+    uint32_t object_instance = 0;
+    const uint8_t *apdu;
+    uint16_t apdu_len;
+    uint8_t mask;
+    unsigned index;
+    int len;
+
+    if (!mstp_port || !mstp_port->Extended_Frame_Peers ||
+        (mstp_port->SourceAddress == MSTP_BROADCAST_ADDRESS)) {
+        return;
+    }
+    peers = mstp_port->Extended_Frame_Peers;
+    index = mstp_port->SourceAddress / 8;
+    mask = 1 << (mstp_port->SourceAddress % 8);
+    if ((mstp_port->FrameType ==
+         FRAME_TYPE_BACNET_EXTENDED_DATA_EXPECTING_REPLY) ||
+        (mstp_port->FrameType ==
+         FRAME_TYPE_BACNET_EXTENDED_DATA_NOT_EXPECTING_REPLY)) {
+        peers->Capable[index] |= mask;
+        return;
+    }
+    if ((mstp_port->FrameType != FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY) &&
+        (mstp_port->FrameType !=
+         FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY)) {
+        return;
+    }
+    len = bacnet_npdu_decode(
+        mstp_port->InputBuffer, mstp_port->DataLength, &dest, &src,
+        &npdu_data);
+    if ((len <= 0) || npdu_data.network_layer_message || (src.net != 0) ||
+        ((len + 2) > mstp_port->DataLength)) {
+        return;
+    }
+    apdu = &mstp_port->InputBuffer[len];
+    apdu_len = mstp_port->DataLength - len;
+    if ((apdu[0] & 0xF0) == PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
+        if (decode_max_apdu(apdu[1] & 0x0F) > MSTP_FRAME_APDU_MAX) {
+            peers->Capable[index] |= mask;
+        }
+    } else if (
+        (apdu[0] == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) &&
+        (apdu[1] == SERVICE_UNCONFIRMED_I_AM)) {
+        len = bacnet_object_id_application_decode(
+            &apdu[2], apdu_len - 2, &object_type, &object_instance);
+        if (len > 0) {
+            len = bacnet_unsigned_application_decode(
+                &apdu[2 + len], apdu_len - 2 - len, &max_apdu);
+        }
+        if (len <= 0) {
+            /* malformed I-Am */
+        } else if (max_apdu > MSTP_FRAME_APDU_MAX) {
+            peers->Capable[index] |= mask;
+            peers->Legacy[index] &= ~mask;
+        } else {
+            peers->Legacy[index] |= mask;
+        }
+    }
+}
+
+/**
+ * @brief Get the largest APDU that a station receives, as learned from
+ *  its frames
+ * @param mstp_port MSTP port context data
+ * @param station - MS/TP MAC address of the station
+ * @return 480 for a legacy station, 1476 for a station that receives
+ *  extended frames, or 0 when it is not known
+ */
+uint16_t MSTP_Extended_Frame_Peer_Max_APDU(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station)
+{
+    const struct mstp_extended_frame_peers *peers;
+    uint8_t mask = 1 << (station % 8);
+
+    if (!mstp_port || !mstp_port->Extended_Frame_Peers) {
+        return 0;
+    }
+    peers = mstp_port->Extended_Frame_Peers;
+    if (peers->Legacy[station / 8] & mask) {
+        return MSTP_FRAME_APDU_MAX;
+    }
+    if (peers->Capable[station / 8] & mask) {
+        return MSTP_EXTENDED_FRAME_APDU_MAX;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Determine if an extended frame may be sent to a station.  Only
+ *  a station known to be a legacy station is refused, since it would
+ *  discard the frame, so a station that was never heard from, and the
+ *  broadcast address, are allowed.
+ * @param mstp_port MSTP port context data
+ * @param station - MS/TP MAC address of the station
+ * @return true if an extended frame may be sent to the station
+ */
+bool MSTP_Extended_Frame_Peer_Allowed(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station)
+{
+    const struct mstp_extended_frame_peers *peers;
+    uint8_t mask = 1 << (station % 8);
+
+    if (!mstp_port || !mstp_port->Extended_Frame_Peers ||
+        (station == MSTP_BROADCAST_ADDRESS)) {
+        return true;
+    }
+    peers = mstp_port->Extended_Frame_Peers;
+    if (peers->Capable[station / 8] & mask) {
+        return true;
+    }
+
+    return !(peers->Legacy[station / 8] & mask);
+}
+
+/**
+ * @brief Pass a received BACnet data frame to the higher layers, after
+ *  learning the extended frame support of its sender
+ * @param mstp_port MSTP port context data
+ */
+static void mstp_put_receive(struct mstp_port_struct_t *mstp_port)
+{
+    MSTP_Extended_Frame_Peer_Update(mstp_port);
+    (void)MSTP_Put_Receive(mstp_port);
+}
+
+/**
+ * @brief Send a frame, and count it in the statistics
+ * @param mstp_port MSTP port context data
+ * @param buffer - the frame to send
+ * @param nbytes - number of bytes to send
+ */
+static void mstp_send_frame(
+    struct mstp_port_struct_t *mstp_port,
+    const uint8_t *buffer,
+    uint16_t nbytes)
+{
+    struct mstp_port_statistics *statistics = mstp_port->Statistics;
+
+    if (statistics && (nbytes > 2)) {
+        statistics->Transmit_Octets += nbytes;
+        if (buffer[2] == FRAME_TYPE_POLL_FOR_MASTER) {
+            statistics->Poll_For_Master_Count++;
+        } else if (buffer[2] == FRAME_TYPE_REPLY_POSTPONED) {
+            statistics->Reply_Postponed_Sent_Count++;
+        }
+    }
+    MSTP_Send_Frame(mstp_port, buffer, nbytes);
+}
+
 void MSTP_Create_And_Send_Frame(
     struct mstp_port_struct_t *mstp_port,
     uint8_t frame_type,
@@ -270,7 +509,7 @@ void MSTP_Create_And_Send_Frame(
         mstp_port->OutputBuffer, mstp_port->OutputBufferSize, frame_type,
         destination, source, data, data_len);
 
-    MSTP_Send_Frame(mstp_port, &mstp_port->OutputBuffer[0], len);
+    mstp_send_frame(mstp_port, &mstp_port->OutputBuffer[0], len);
     /* FIXME: be sure to reset SilenceTimer() after each octet is sent! */
 }
 
@@ -292,6 +531,7 @@ static bool MSTP_Frame_For_Us(struct mstp_port_struct_t *mstp_port)
 void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
 {
     MSTP_RECEIVE_STATE receive_state = mstp_port->receive_state;
+    bool data_available = mstp_port->DataAvailable;
 
     printf_receive(
         "MSTP Rx: State=%s Data=%02X hCRC=%02X Index=%u EC=%u DateLen=%u "
@@ -556,13 +796,15 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                     printf_receive_data(
                         "%s",
                         mstptext_frame_type((unsigned)mstp_port->FrameType));
-                    if (((mstp_port->Index + 1) < mstp_port->InputBufferSize) &&
+                    if ((mstp_port->Index < mstp_port->InputBufferSize) &&
                         (mstp_port->FrameType >= Nmin_COBS_type) &&
                         (mstp_port->FrameType <= Nmax_COBS_type)) {
+                        /* decoded in place: COBS never writes ahead of the
+                           octet it reads, and the data is then found at
+                           the start of the InputBuffer like any frame */
                         mstp_port->DataLength = cobs_frame_decode(
-                            &mstp_port->InputBuffer[mstp_port->Index + 1],
-                            mstp_port->InputBufferSize, mstp_port->InputBuffer,
-                            mstp_port->Index + 1);
+                            mstp_port->InputBuffer, mstp_port->InputBufferSize,
+                            mstp_port->InputBuffer, mstp_port->Index + 1);
                         if (mstp_port->DataLength > 0) {
                             /* GoodCRC */
                             if (mstp_port->receive_state ==
@@ -618,9 +860,62 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
         (mstp_port->receive_state == MSTP_RECEIVE_STATE_IDLE)) {
         printf_receive_data("\n");
     }
+    if (data_available && !mstp_port->DataAvailable &&
+        mstp_port->Statistics) {
+        mstp_port->Statistics->Receive_Octets++;
+    }
     return;
 }
 
+/**
+ * @brief Record whether an address answered a Poll For Master, if the port
+ *  has a poll schedule
+ * @param mstp_port MSTP port context data
+ * @param station the address that was polled
+ * @param answered true if a Reply To Poll For Master was received
+ */
+static void MSTP_Poll_Schedule_Update(
+    struct mstp_port_struct_t *mstp_port, uint8_t station, bool answered)
+{
+    struct mstp_poll_schedule *schedule = mstp_port->Poll_Schedule;
+
+    if (!schedule || (station >= sizeof(schedule->Skip))) {
+        return;
+    }
+    if (answered) {
+        schedule->Skip[station] = 0;
+        schedule->Backoff[station] = 0;
+    } else {
+        schedule->Skip[station] = schedule->Backoff[station];
+        if (schedule->Backoff[station] == 0) {
+            schedule->Backoff[station] = 1;
+        } else if (schedule->Backoff[station] < MSTP_POLL_BACKOFF_MAX) {
+            schedule->Backoff[station] *= 2;
+        }
+    }
+}
+
+/**
+ * @brief Use up one of the maintenance slots that an address is skipped for
+ * @param mstp_port MSTP port context data
+ * @param station the address due for a maintenance Poll For Master
+ * @return true if the address is not polled in this slot
+ */
+static bool
+MSTP_Poll_Schedule_Skip(struct mstp_port_struct_t *mstp_port, uint8_t station)
+{
+    struct mstp_poll_schedule *schedule = mstp_port->Poll_Schedule;
+
+    if (!schedule || mstp_port->SoleMaster ||
+        (station >= sizeof(schedule->Skip)) ||
+        (schedule->Skip[station] == 0)) {
+        return false;
+    }
+    schedule->Skip[station]--;
+
+    return true;
+}
+
 /**
  * @brief Finite State Machine for receiving an MSTP frame
  * @param mstp_port MSTP port context data
@@ -726,6 +1021,7 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                         mstp_port->ReceivedValidFrame = false;
                         mstp_port->FrameCount = 0;
                         mstp_port->SoleMaster = false;
+                        mstp_statistics_token(mstp_port);
                         mstp_port->master_state = MSTP_MASTER_STATE_USE_TOKEN;
                         transition_now = true;
                         break;
@@ -756,7 +1052,7 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                             /* ForUs */
                             /* indicate successful reception
                                 to the higher layers */
-                            (void)MSTP_Put_Receive(mstp_port);
+                            mstp_put_receive(mstp_port);
                         }
                         break;
                     case FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY:
@@ -767,7 +1063,7 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                         } else {
                             /* indicate successful reception to the higher
                              * layers  */
-                            (void)MSTP_Put_Receive(mstp_port);
+                            mstp_put_receive(mstp_port);
                             mstp_port->master_state =
                                 MSTP_MASTER_STATE_ANSWER_DATA_REQUEST;
                         }
@@ -816,9 +1112,15 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
             } else {
                 uint8_t frame_type = mstp_port->OutputBuffer[2];
                 uint8_t destination = mstp_port->OutputBuffer[3];
-                MSTP_Send_Frame(
+                mstp_send_frame(
                     mstp_port, &mstp_port->OutputBuffer[0], (uint16_t)length);
                 mstp_port->FrameCount++;
+                mstp_statistics_token_frame(
+                    mstp_port,
+                    (frame_type == FRAME_TYPE_TEST_REQUEST) ||
+                        ((frame_type ==
+                          FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY) &&
+                         (destination != MSTP_BROADCAST_ADDRESS)));
                 switch (frame_type) {
                     case FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY:
                         if (destination == MSTP_BROADCAST_ADDRESS) {
@@ -851,6 +1153,9 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                 mstp_port->Treply_timeout) {
                 /* ReplyTimeout */
                 /* assume that the request has failed */
+                if (mstp_port->Statistics) {
+                    mstp_port->Statistics->Reply_Timeout_Count++;
+                }
                 mstp_port->FrameCount = mstp_port->Nmax_info_frames;
                 mstp_port->master_state = MSTP_MASTER_STATE_DONE_WITH_TOKEN;
                 /* Any retry of the data frame shall await the next entry */
@@ -874,6 +1179,10 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                         switch (mstp_port->FrameType) {
                             case FRAME_TYPE_REPLY_POSTPONED:
                                 /* ReceivedReplyPostponed */
+                                if (mstp_port->Statistics) {
+                                    mstp_port->Statistics
+                                        ->Reply_Postponed_Received_Count++;
+                                }
                                 mstp_port->master_state =
                                     MSTP_MASTER_STATE_DONE_WITH_TOKEN;
                                 break;
@@ -897,7 +1206,8 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                                    indicates a reply */
                                 /* indicate successful reception
                                    to the higher layers */
-                                (void)MSTP_Put_Receive(mstp_port);
+                                mstp_put_receive(mstp_port);
+                                mstp_statistics_reply(mstp_port);
                                 mstp_port->master_state =
                                     MSTP_MASTER_STATE_DONE_WITH_TOKEN;
                                 break;
@@ -996,6 +1306,18 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                     mstp_port->EventCount = 0;
                     mstp_port->master_state = MSTP_MASTER_STATE_PASS_TOKEN;
                 }
+            } else if (MSTP_Poll_Schedule_Skip(mstp_port, next_poll_station)) {
+                /* SkipMaintenancePFM */
+                /* the address did not answer its recent polls,
+                   so pass the token instead of polling it again */
+                mstp_port->Poll_Station = next_poll_station;
+                MSTP_Create_And_Send_Frame(
+                    mstp_port, FRAME_TYPE_TOKEN, mstp_port->Next_Station,
+                    mstp_port->This_Station, NULL, 0);
+                mstp_port->RetryCount = 0;
+                mstp_port->TokenCount = 1;
+                mstp_port->EventCount = 0;
+                mstp_port->master_state = MSTP_MASTER_STATE_PASS_TOKEN;
             } else {
                 /* SendMaintenancePFM */
                 mstp_port->Poll_Station = next_poll_station;
@@ -1023,6 +1345,9 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                 if (mstp_port->RetryCount < Nretry_token) {
                     /* RetrySendToken */
                     mstp_port->RetryCount++;
+                    if (mstp_port->Statistics) {
+                        mstp_port->Statistics->Token_Retry_Count++;
+                    }
                     /* Transmit a Token frame to NS */
                     MSTP_Create_And_Send_Frame(
                         mstp_port, FRAME_TYPE_TOKEN, mstp_port->Next_Station,
@@ -1117,6 +1442,8 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                     (mstp_port->FrameType ==
                      FRAME_TYPE_REPLY_TO_POLL_FOR_MASTER)) {
                     /* ReceivedReplyToPFM */
+                    MSTP_Poll_Schedule_Update(
+                        mstp_port, mstp_port->SourceAddress, true);
                     mstp_port->SoleMaster = false;
                     mstp_port->Next_Station = mstp_port->SourceAddress;
                     mstp_port->EventCount = 0;
@@ -1156,6 +1483,11 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                         /* DoneWithPFM */
                         /* There was no valid reply to the maintenance  */
                         /* poll for a master at address PS.  */
+                        if (!mstp_port->ReceivedInvalidFrame &&
+                            !mstp_port->ReceivedValidFrameNotForUs) {
+                            MSTP_Poll_Schedule_Update(
+                                mstp_port, mstp_port->Poll_Station, false);
+                        }
                         mstp_port->EventCount = 0;
                         /* transmit a Token frame to NS */
                         MSTP_Create_And_Send_Frame(
@@ -1208,7 +1540,7 @@ bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port)
                 /* then call MSTP_Create_And_Send_Frame to transmit the reply
                  * frame  */
                 /* and enter the IDLE state to wait for the next frame. */
-                MSTP_Send_Frame(
+                mstp_send_frame(
                     mstp_port, &mstp_port->OutputBuffer[0], (uint16_t)length);
                 mstp_port->master_state = MSTP_MASTER_STATE_IDLE;
                 /* clear our flag we were holding for comparison */
@@ -1277,7 +1609,7 @@ void MSTP_Slave_Node_FSM(struct mstp_port_struct_t *mstp_port)
             case FRAME_TYPE_BACNET_EXTENDED_DATA_EXPECTING_REPLY:
                 if (mstp_port->DestinationAddress != MSTP_BROADCAST_ADDRESS) {
                     /* indicate successful reception to the higher layers  */
-                    (void)MSTP_Put_Receive(mstp_port);
+                    mstp_put_receive(mstp_port);
                 }
                 break;
             case FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY:
@@ -1293,7 +1625,7 @@ void MSTP_Slave_Node_FSM(struct mstp_port_struct_t *mstp_port)
                     /* ForUs */
                     /* indicate successful reception
                        to the higher layers */
-                    (void)MSTP_Put_Receive(mstp_port);
+                    mstp_put_receive(mstp_port);
                 }
                 break;
             case FRAME_TYPE_TEST_REQUEST:
@@ -1324,7 +1656,7 @@ void MSTP_Slave_Node_FSM(struct mstp_port_struct_t *mstp_port)
              * reply frame  */
             /* and enter the IDLE state to wait for the next frame.
              */
-            MSTP_Send_Frame(
+            mstp_send_frame(
                 mstp_port, &mstp_port->OutputBuffer[0], (uint16_t)length);
             /* clear our flag we were holding for comparison */
             mstp_port->ReceivedValidFrame = false;
@@ -1699,6 +2031,11 @@ void MSTP_Zero_Config_FSM(struct mstp_port_struct_t *mstp_port)
     }
 }
 
+/* baud rates tried by auto-baud, the most common on MS/TP trunks first */
+static const uint32_t TestBaudrates[MSTP_AUTO_BAUD_RATE_MAX] = {
+    38400, 76800, 19200, 9600, 115200, 57600
+};
+
 /**
  * @brief Get the baud rate for auto-baud at a given index
  * @param baud_rate_index the index of the baud rate
@@ -1708,9 +2045,6 @@ void MSTP_Zero_Config_FSM(struct mstp_port_struct_t *mstp_port)
  */
 uint32_t MSTP_Auto_Baud_Rate(unsigned baud_rate_index)
 {
-    const uint32_t TestBaudrates[6] = {
-        115200, 76800, 57600, 38400, 19200, 9600
-    };
     unsigned index;
 
     index = baud_rate_index % ARRAY_SIZE(TestBaudrates);
@@ -1718,58 +2052,119 @@ uint32_t MSTP_Auto_Baud_Rate(unsigned baud_rate_index)
     return TestBaudrates[index];
 }
 
+/**
+ * @brief Start the trial of a baud rate
+ * @param mstp_port the context of the MSTP port
+ * @param index the index of the baud rate in TestBaudrates
+ */
+static void
+MSTP_Auto_Baud_Trial(struct mstp_port_struct_t *mstp_port, unsigned index)
+{
+    mstp_port->BaudRateIndex = index;
+    mstp_port->AutoBaudTried |= (uint8_t)(1U << index);
+    mstp_port->BaudRateSet(MSTP_Auto_Baud_Rate(index));
+    mstp_port->ValidFrames = 0;
+    mstp_port->EventCount = 0;
+    mstp_port->ValidFrameTimerReset((void *)mstp_port);
+}
+
+/**
+ * @brief Choose the next baud rate to try: the untried rate at which the
+ *  most preambles were received, or the most common untried rate
+ * @param mstp_port the context of the MSTP port
+ * @return the index of the baud rate in TestBaudrates
+ */
+static unsigned MSTP_Auto_Baud_Next(struct mstp_port_struct_t *mstp_port)
+{
+    unsigned index, next = 0;
+    bool found = false;
+
+    if (mstp_port->AutoBaudTried == ((1U << MSTP_AUTO_BAUD_RATE_MAX) - 1)) {
+        /* every rate was tried: start another pass */
+        mstp_port->AutoBaudTried = 0;
+    }
+    for (index = 0; index < MSTP_AUTO_BAUD_RATE_MAX; index++) {
+        if (mstp_port->AutoBaudTried & (1U << index)) {
+            continue;
+        }
+        if (!found ||
+            (mstp_port->AutoBaudPreambles[index] >
+             mstp_port->AutoBaudPreambles[next])) {
+            next = index;
+            found = true;
+        }
+    }
+
+    return next;
+}
+
 /**
  * @brief The MSTP_AUTO_BAUD_STATE_INIT state is entered when
- *  CheckAutoBaud is TRUE
+ *  CheckAutoBaud is TRUE.  The search starts at the current baud rate,
+ *  which is the last one used, when it is one of the rates tried.
  * @param mstp_port the context of the MSTP port
  */
 static void MSTP_Auto_Baud_State_Init(struct mstp_port_struct_t *mstp_port)
 {
-    uint32_t baud;
+    uint32_t baud = 0;
+    unsigned index;
 
     if (!mstp_port) {
         return;
     }
-    mstp_port->ValidFrames = 0;
-    mstp_port->BaudRateIndex = 0;
-    mstp_port->ValidFrameTimerReset((void *)mstp_port);
-    baud = MSTP_Auto_Baud_Rate(mstp_port->BaudRateIndex);
-    mstp_port->BaudRateSet(baud);
+    mstp_port->AutoBaudTried = 0;
+    if (mstp_port->BaudRate) {
+        baud = mstp_port->BaudRate();
+    }
+    for (index = 0; index < MSTP_AUTO_BAUD_RATE_MAX; index++) {
+        if (TestBaudrates[index] == baud) {
+            break;
+        }
+    }
+    if (index == MSTP_AUTO_BAUD_RATE_MAX) {
+        index = MSTP_Auto_Baud_Next(mstp_port);
+    }
+    MSTP_Auto_Baud_Trial(mstp_port, index);
     mstp_port->Auto_Baud_State = MSTP_AUTO_BAUD_STATE_IDLE;
 }
 
 /**
  * @brief The MSTP_AUTO_BAUD_STATE_IDLE state is entered when
- *  CheckAutoBaud is TRUE and waits for good frames or timeout
+ *  CheckAutoBaud is TRUE and waits for good frames or timeout.
+ *  The time spent at a rate scales with the traffic: a busy trunk
+ *  that delivers a whole EventCount of octets without a valid frame
+ *  rejects the rate at once, while a quiet trunk waits for the timeout.
  * @param mstp_port the context of the MSTP port
  */
 static void MSTP_Auto_Baud_State_Idle(struct mstp_port_struct_t *mstp_port)
 {
-    uint32_t baud;
+    unsigned index;
 
     if (!mstp_port) {
         return;
     }
+    index = mstp_port->BaudRateIndex % MSTP_AUTO_BAUD_RATE_MAX;
     if (mstp_port->ReceivedValidFrame) {
         /* IdleValidFrame */
+        INCREMENT_AND_LIMIT_UINT8(mstp_port->AutoBaudPreambles[index]);
         mstp_port->ValidFrames++;
         if (mstp_port->ValidFrames >= 4) {
             /* GoodBaudRate */
             mstp_port->CheckAutoBaud = false;
             mstp_port->Auto_Baud_State = MSTP_AUTO_BAUD_STATE_USE;
         }
+        mstp_port->EventCount = 0;
         mstp_port->ReceivedValidFrame = false;
     } else if (mstp_port->ReceivedInvalidFrame) {
         /* IdleInvalidFrame */
+        INCREMENT_AND_LIMIT_UINT8(mstp_port->AutoBaudPreambles[index]);
         mstp_port->ValidFrames = 0;
         mstp_port->ReceivedInvalidFrame = false;
-    } else if (mstp_port->ValidFrameTimer((void *)mstp_port) >= 5000UL) {
-        /* IdleTimeout */
-        mstp_port->BaudRateIndex++;
-        baud = MSTP_Auto_Baud_Rate(mstp_port->BaudRateIndex);
-        mstp_port->BaudRateSet(baud);
-        mstp_port->ValidFrames = 0;
-        mstp_port->ValidFrameTimerReset((void *)mstp_port);
+    } else if (
+        (mstp_port->ValidFrameTimer((void *)mstp_port) >= 5000UL) ||
+        ((mstp_port->ValidFrames == 0) && (mstp_port->EventCount == 255))) {
+        /* IdleTimeout or IdleWrongRate */
+        MSTP_Auto_Baud_Trial(mstp_port, MSTP_Auto_Baud_Next(mstp_port));
     }
 }
 
@@ -1799,6 +2194,69 @@ void MSTP_Auto_Baud_FSM(struct mstp_port_struct_t *mstp_port)
     }
 }
 
+/**
+ * @brief Reset the statistics of the state machines, if enabled
+ * @param mstp_port the context of the MSTP port
+ */
+void MSTP_Statistics_Reset(struct mstp_port_struct_t *mstp_port)
+{
+    struct mstp_port_statistics *statistics;
+    uint32_t (*milliseconds)(void);
+
+    if (!mstp_port || !mstp_port->Statistics) {
+        return;
+    }
+    statistics = mstp_port->Statistics;
+    milliseconds = statistics->Milliseconds;
+    memset(statistics, 0, sizeof(struct mstp_port_statistics));
+    statistics->Milliseconds = milliseconds;
+    if (milliseconds) {
+        statistics->Start_Time = milliseconds();
+    }
+}
+
+/**
+ * @brief Get the octets sent and received per second since the reset
+ * @param mstp_port the context of the MSTP port
+ * @return octets per second, or 0 if not known
+ */
+uint32_t
+MSTP_Statistics_Octets_Per_Second(const struct mstp_port_struct_t *mstp_port)
+{
+    const struct mstp_port_statistics *statistics;
+    uint64_t octets;
+    uint32_t elapsed;
+
+    if (!mstp_port || !mstp_port->Statistics ||
+        !mstp_port->Statistics->Milliseconds) {
+        return 0;
+    }
+    statistics = mstp_port->Statistics;
+    elapsed = statistics->Milliseconds() - statistics->Start_Time;
+    if (elapsed == 0) {
+        return 0;
+    }
+    octets = (uint64_t)statistics->Transmit_Octets +
+        (uint64_t)statistics->Receive_Octets;
+
+    return (uint32_t)((octets * 1000UL) / elapsed);
+}
+
+/**
+ * @brief Get the upper limit of a timing histogram bucket
+ * @param bucket - the bucket, 0..MSTP_HISTOGRAM_BUCKETS-1
+ * @return the bucket counts times below this many milliseconds,
+ *  or UINT32_MAX for the last bucket
+ */
+uint32_t MSTP_Statistics_Histogram_Limit(unsigned bucket)
+{
+    if (bucket >= (MSTP_HISTOGRAM_BUCKETS - 1)) {
+        return UINT32_MAX;
+    }
+
+    return 1UL << bucket;
+}
+
 /* note: This_Station assumed to be set with the MAC address */
 /* note: Nmax_info_frames assumed to be set (default=1) */
 /* note: Nmax_master assumed to be set (default=127) */
@@ -1869,5 +2327,21 @@ void MSTP_Init(struct mstp_port_struct_t *mstp_port)
         mstp_port->TokenCount = 0;
         /* zero config */
         mstp_port->Zero_Config_State = MSTP_ZERO_CONFIG_STATE_INIT;
+        /* auto baud */
+        memset(
+            mstp_port->AutoBaudPreambles, 0,
+            sizeof(mstp_port->AutoBaudPreambles));
+        mstp_port->AutoBaudTried = 0;
+        MSTP_Statistics_Reset(mstp_port);
+        if (mstp_port->Extended_Frame_Peers) {
+            memset(
+                mstp_port->Extended_Frame_Peers, 0,
+                sizeof(struct mstp_extended_frame_peers));
+        }
+        if (mstp_port->Poll_Schedule) {
+            memset(
+                mstp_port->Poll_Schedule, 0,
+                sizeof(struct mstp_poll_schedule));
+        }
     }
 }
@@ -28,6 +28,74 @@
 /* size of the buffer used to send and validate a unique test request */
 #define MSTP_UUID_SIZE 16
 
+/* number of buckets in the MS/TP timing histograms.  Bucket 0 counts times
+   under 1 millisecond, bucket N counts 2^(N-1) to 2^N-1 milliseconds,
+   and the last bucket also counts all of the longer times. */
+#ifndef MSTP_HISTOGRAM_BUCKETS
+#define MSTP_HISTOGRAM_BUCKETS 16
+#endif
+
+/* optional table of the stations that receive extended frames,
+   learned from the BACnet data frames that they send */
+struct mstp_extended_frame_peers {
+    /* a bit for each station that sent an extended frame, or that
+       announced a Max_APDU that only fits in an extended frame */
+    uint8_t Capable[256 / 8];
+    /* a bit for each station that announced a Max_APDU of 480 or less */
+    uint8_t Legacy[256 / 8];
+};
+
+/* most maintenance Poll For Master slots that an empty address is
+   skipped for, after it has not answered several polls in a row */
+#ifndef MSTP_POLL_BACKOFF_MAX
+#define MSTP_POLL_BACKOFF_MAX 8
+#endif
+
+/* optional schedule of the maintenance Poll For Master frames.
+   An address that does not answer is skipped for its backoff number
+   of maintenance slots, and its backoff doubles each time up to
+   MSTP_POLL_BACKOFF_MAX.  A skipped slot passes the token instead. */
+struct mstp_poll_schedule {
+    /* maintenance slots left to skip at each address */
+    uint8_t Skip[128];
+    /* slots to skip after the next poll that is not answered */
+    uint8_t Backoff[128];
+};
+
+/* optional instrumentation of the master node state machine,
+   used to tune Nmax_info_frames and Nmax_master from measured data */
+struct mstp_port_statistics {
+    /* free running millisecond clock for the timing histograms,
+       or NULL to only keep the counters */
+    uint32_t (*Milliseconds)(void);
+    /* time from receiving the token until receiving it again */
+    uint32_t Token_Rotation[MSTP_HISTOGRAM_BUCKETS];
+    /* time from sending a Data Expecting Reply frame until the reply */
+    uint32_t Reply_Latency[MSTP_HISTOGRAM_BUCKETS];
+    /* tokens received, and data frames sent while holding them */
+    uint32_t Token_Count;
+    uint32_t Token_Frame_Count;
+    /* the most data frames sent during one token hold */
+    uint8_t Token_Frame_Max;
+    /* Token frames sent again because the next station did not use it */
+    uint32_t Token_Retry_Count;
+    /* Poll For Master frames sent */
+    uint32_t Poll_For_Master_Count;
+    /* Reply Postponed frames sent, and received as an answer */
+    uint32_t Reply_Postponed_Sent_Count;
+    uint32_t Reply_Postponed_Received_Count;
+    /* requests that were not answered within Treply_timeout */
+    uint32_t Reply_Timeout_Count;
+    /* octets sent and received, for the octets per second */
+    uint32_t Transmit_Octets;
+    uint32_t Receive_Octets;
+    /* time stamps used by the state machines */
+    uint32_t Start_Time;
+    uint32_t Token_Time;
+    uint32_t Request_Time;
+    bool Token_Time_Valid;
+};
+
 struct mstp_port_struct_t {
     MSTP_RECEIVE_STATE receive_state;
     /* When a master node is powered up or reset, */
@@ -237,6 +305,26 @@ struct mstp_port_struct_t {
     void (*BaudRateSet)(uint32_t baud);
     /* The zero-based index in TestBaudrates of the next baudrate to try. */
     unsigned BaudRateIndex;
+    /* The number of frames with a preamble received at each trial
+       baudrate since initialization, used to try the likely rates first */
+    uint8_t AutoBaudPreambles[MSTP_AUTO_BAUD_RATE_MAX];
+    /* One bit for each trial baudrate already tried in this pass */
+    uint8_t AutoBaudTried;
+
+    /* Optional statistics of the state machines, or NULL for none.
+       Point this to a structure before calling MSTP_Init(),
+       which resets the statistics. */
+    struct mstp_port_statistics *Statistics;
+
+    /* Optional table of the stations that receive extended frames, or
+       NULL to send extended frames to any station. Point this to a
+       structure before calling MSTP_Init(), which clears the table. */
+    struct mstp_extended_frame_peers *Extended_Frame_Peers;
+
+    /* Optional schedule that polls the empty addresses less often, or
+       NULL to poll every address in turn. Point this to a structure
+       before calling MSTP_Init(), which clears the schedule. */
+    struct mstp_poll_schedule *Poll_Schedule;
 
     /*Platform-specific port data */
     void *UserData;
@@ -251,6 +339,14 @@ void MSTP_Init(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
 void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
+void MSTP_Extended_Frame_Peer_Update(struct mstp_port_struct_t *mstp_port);
+BACNET_STACK_EXPORT
+uint16_t MSTP_Extended_Frame_Peer_Max_APDU(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station);
+BACNET_STACK_EXPORT
+bool MSTP_Extended_Frame_Peer_Allowed(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station);
+BACNET_STACK_EXPORT
 bool MSTP_Master_Node_FSM(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
 void MSTP_Slave_Node_FSM(struct mstp_port_struct_t *mstp_port);
@@ -293,6 +389,14 @@ void MSTP_Zero_Config_FSM(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
 uint32_t MSTP_Auto_Baud_Rate(unsigned baud_rate_index);
 
+BACNET_STACK_EXPORT
+void MSTP_Statistics_Reset(struct mstp_port_struct_t *mstp_port);
+BACNET_STACK_EXPORT
+uint32_t
+MSTP_Statistics_Octets_Per_Second(const struct mstp_port_struct_t *mstp_port);
+BACNET_STACK_EXPORT
+uint32_t MSTP_Statistics_Histogram_Limit(unsigned bucket);
+
 BACNET_STACK_EXPORT
 void MSTP_Auto_Baud_FSM(struct mstp_port_struct_t *mstp_port);
 
@@ -57,6 +57,10 @@
 /* COBS-encoded frames data parameter length is between
    502 and 1497 octets, inclusive */
 #define MSTP_EXTENDED_FRAME_NPDU_MAX 1497
+/* largest APDU of a station that does, or does not, receive
+   COBS-encoded extended frames */
+#define MSTP_FRAME_APDU_MAX 480
+#define MSTP_EXTENDED_FRAME_APDU_MAX 1476
 
 /* receive FSM states */
 typedef enum {
@@ -97,6 +101,9 @@ typedef enum MSTP_Auto_Baud_State {
     MSTP_AUTO_BAUD_STATE_USE = 2
 } MSTP_AUTO_BAUD_STATE;
 
+/* The number of baud rates tried by the auto-baud FSM */
+#define MSTP_AUTO_BAUD_RATE_MAX 6
+
 /* The time without a DataAvailable or ReceiveError event before declaration */
 /* of loss of token: 500 milliseconds. */
 #define Tno_token 500
@@ -83,13 +83,9 @@ bool datetime_date_is_valid(const BACNET_DATE *bdate)
 uint32_t datetime_ymd_day_of_year(uint16_t year, uint8_t month, uint8_t day)
 {
     uint32_t days = 0; /* return value */
-    uint8_t months = 0; /* loop counter for months */
 
     if (datetime_ymd_is_valid(year, month, day)) {
-        for (months = 1; months < month; months++) {
-            days += days_per_month(year, months);
-        }
-        days += day;
+        days = days_of_year(year, month, day);
     }
 
     return (days);
@@ -178,39 +174,8 @@ uint32_t datetime_days_since_epoch(const BACNET_DATE *bdate)
 void datetime_ymd_from_days_since_epoch(
     uint32_t days, uint16_t *pYear, uint8_t *pMonth, uint8_t *pDay)
 {
-    uint16_t year = BACNET_DATE_YEAR_EPOCH;
-    uint8_t month = 1;
-    uint8_t day = 1;
-
-    while (days >= 365) {
-        if ((days_is_leap_year(year)) && (days == 365)) {
-            break;
-        }
-        days -= 365;
-        if (days_is_leap_year(year)) {
-            --days;
-        }
-        year++;
-    }
-
-    while (days >= (uint32_t)days_per_month(year, month)) {
-        days -= days_per_month(year, month);
-        month++;
-    }
-
-    day = (uint8_t)(day + days);
-
-    if (pYear) {
-        *pYear = year;
-    }
-    if (pMonth) {
-        *pMonth = month;
-    }
-    if (pDay) {
-        *pDay = day;
-    }
-
-    return;
+    days_since_epoch_to_date(
+        BACNET_DATE_YEAR_EPOCH, days, pYear, pMonth, pDay);
 }
 
 /**
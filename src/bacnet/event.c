@@ -7,6 +7,7 @@
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
 #include <assert.h>
+#include <string.h>
 #include "bacnet/event.h"
 #include "bacnet/bacdcode.h"
 #include "bacnet/npdu.h"
@@ -84,6 +85,88 @@ int cevent_notify_encode_apdu(
     return apdu_len;
 }
 
+/**
+ * @brief Encode the unconfirmed EventNotification service request from
+ *  a notification body encoded with event_notification_body_encode()
+ * @param apdu  Pointer to the buffer for encoding into, or NULL for length
+ * @param process_identifier  process-identifier of the recipient
+ * @param body  Pointer to the encoded notification body
+ * @param body_len  Number of bytes in the notification body
+ * @return number of bytes encoded
+ */
+int uevent_notify_body_encode_apdu(
+    uint8_t *apdu,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* total length of the apdu, return value */
+
+    if (apdu) {
+        apdu[0] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+        apdu[1] = SERVICE_UNCONFIRMED_EVENT_NOTIFICATION; /* service choice */
+    }
+    len = 2;
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    /* tag 0 - processIdentifier */
+    len = encode_context_unsigned(apdu, 0, process_identifier);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+        memcpy(apdu, body, body_len);
+    }
+    apdu_len += (int)body_len;
+
+    return apdu_len;
+}
+
+/**
+ * @brief Encode the ConfirmedEventNotification service request from
+ *  a notification body encoded with event_notification_body_encode()
+ * @param apdu  Pointer to the buffer for encoding into, or NULL for length
+ * @param invoke_id  ID to invoke for notification
+ * @param process_identifier  process-identifier of the recipient
+ * @param body  Pointer to the encoded notification body
+ * @param body_len  Number of bytes in the notification body
+ * @return number of bytes encoded
+ */
+int cevent_notify_body_encode_apdu(
+    uint8_t *apdu,
+    uint8_t invoke_id,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len)
+{
+    int len = 0; /* length of each encoding */
+    int apdu_len = 0; /* total length of the apdu, return value */
+
+    if (apdu) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_EVENT_NOTIFICATION; /* service choice */
+    }
+    len = 4;
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+    }
+    /* tag 0 - processIdentifier */
+    len = encode_context_unsigned(apdu, 0, process_identifier);
+    apdu_len += len;
+    if (apdu) {
+        apdu += len;
+        memcpy(apdu, body, body_len);
+    }
+    apdu_len += (int)body_len;
+
+    return apdu_len;
+}
+
 #if BACNET_EVENT_CHANGE_OF_STATUS_FLAGS_ENABLED
 /**
  * @brief Encode the EXTENDED event parameter
@@ -1574,46 +1657,58 @@ size_t event_notification_service_request_encode(
 }
 
 /**
- * @brief Decode the EventNotification service request only.
- * @details Confirmed and Unconfirmed are the same encoding
- *  UnconfirmedEventNotification-Request ::= SEQUENCE {
- *  ConfirmedEventNotification-Request ::= SEQUENCE {
- *      process-identifier[0] Unsigned32,
- *      initiating-device-identifier[1] BACnetObjectIdentifier,
- *      event-object-identifier[2] BACnetObjectIdentifier,
- *      timestamp[3] BACnetTimeStamp,
- *      notification-class[4] Unsigned,
- *      priority[5] Unsigned8,
- *      event-type[6] BACnetEventType,
- *      message-text[7] CharacterString OPTIONAL,
- *      notify-type[8] BACnetNotifyType,
- *      ack-required[9] Boolean OPTIONAL,
- *      from-state[10] BACnetEventState OPTIONAL,
- *      to-state[11] BACnetEventState,
- *      event-values[12] BACnetNotificationParameters OPTIONAL
- *  }
+ * @brief Encode the EventNotification service request without its
+ *  process-identifier.  The body is the same for every recipient of a
+ *  notification, and is sent with uevent_notify_body_encode_apdu() or
+ *  cevent_notify_body_encode_apdu().
+ * @param apdu  Pointer to the buffer for encoding into
+ * @param apdu_size number of bytes available in the buffer
+ * @param data  Pointer to the service data used for encoding values
+ * @return number of bytes encoded, or zero if unable to encode or too large
+ */
+size_t event_notification_body_encode(
+    uint8_t *apdu, size_t apdu_size, const BACNET_EVENT_NOTIFICATION_DATA *data)
+{
+    size_t apdu_len = 0; /* total length of the apdu, return value */
+    size_t len = 0;
+
+    if (!apdu) {
+        return 0;
+    }
+    apdu_len = event_notification_service_request_encode(apdu, apdu_size, data);
+    if (apdu_len > 0) {
+        len = encode_context_unsigned(NULL, 0, data->processIdentifier);
+        apdu_len -= len;
+        memmove(apdu, &apdu[len], apdu_len);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the event-values of an EventNotification service request
  *
- * @param apdu  Pointer to the buffer.
- * @param apdu_size  Number of valid bytes in the buffer.
- * @param data  Pointer to the data to store the decoded values, or NULL
+ *      event-values[12] BACnetNotificationParameters OPTIONAL
  *
+ * @param apdu  Pointer to the opening tag [12]
+ * @param apdu_size  Number of valid bytes in the buffer
+ * @param event_type  event-type of the notification
+ * @param data  Pointer to the data to store the decoded values
  * @return Bytes decoded or BACNET_STATUS_ERROR on error.
  */
-int event_notify_decode_service_request(
+static int event_notification_values_decode(
     const uint8_t *apdu,
     unsigned apdu_size,
+    BACNET_EVENT_TYPE event_type,
     BACNET_EVENT_NOTIFICATION_DATA *data)
 {
     int apdu_len = 0; /* return value */
     int len = 0, tag_len = 0;
     BACNET_UNSIGNED_INTEGER unsigned_value = 0;
-    BACNET_OBJECT_ID object_id = { 0 };
     BACNET_TIMESTAMP timestamp_value = { 0 };
     BACNET_CHARACTER_STRING *cstring = NULL;
     BACNET_BIT_STRING *bstring = NULL;
     BACNET_PROPERTY_STATE *property_state = NULL;
-    BACNET_NOTIFY_TYPE notify_type = NOTIFY_MAX;
-    BACNET_EVENT_TYPE event_type = EVENT_NONE;
     BACNET_DEVICE_OBJECT_REFERENCE *dev_obj_ref = NULL;
     BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *dev_obj_prop_ref = NULL;
     BACNET_AUTHENTICATION_FACTOR *auth_factor = NULL;
@@ -1621,1497 +1716,1627 @@ int event_notify_decode_service_request(
     BACNET_EVENT_EXTENDED_PARAMETER *parameter_value = NULL;
     BACNET_EVENT_DISCRETE_VALUE *discrete_value = NULL;
     BACNET_DATE_TIME *datetime_value = NULL;
-    bool boolean_value = false;
     float real_value = 0.0f;
     double double_value = 0.0;
     int32_t signed_value = 0;
     uint32_t enum_value = 0;
 
-    if (apdu_size) {
-        /* process-identifier[0] Unsigned32 */
-        len = bacnet_unsigned_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 0, &unsigned_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (unsigned_value <= UINT32_MAX) {
-                if (data) {
-                    data->processIdentifier = (uint32_t)unsigned_value;
-                }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* initiating-device-identifier[1] BACnetObjectIdentifier */
-        len = bacnet_object_id_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 1, &object_id.type,
-            &object_id.instance);
-        if (len > 0) {
-            apdu_len += len;
-            if (data) {
-                data->initiatingObjectIdentifier.type = object_id.type;
-                data->initiatingObjectIdentifier.instance = object_id.instance;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* event-object-identifier[2] BACnetObjectIdentifier */
-        len = bacnet_object_id_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 2, &object_id.type,
-            &object_id.instance);
-        if (len > 0) {
-            apdu_len += len;
-            if (data) {
-                data->eventObjectIdentifier.type = object_id.type;
-                data->eventObjectIdentifier.instance = object_id.instance;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* timestamp[3] BACnetTimeStamp */
-        len = bacnet_timestamp_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 3, &timestamp_value);
-        if (len > 0) {
+    /* event-values[12] BACnetNotificationParameters OPTIONAL */
+    if (bacnet_is_opening_tag_number(
+            &apdu[apdu_len], apdu_size - apdu_len, 12, &len)) {
+        apdu_len += len;
+    } else {
+        return BACNET_STATUS_ERROR;
+    }
+    if (event_type >= EVENT_PROPRIETARY_MIN) {
+        /* complex-event-type [6] SEQUENCE OF BACnetPropertyValue */
+        if (bacnet_is_opening_tag_number(
+                &apdu[apdu_len], apdu_size - apdu_len,
+                EVENT_COMPLEX_EVENT_TYPE, &len)) {
             apdu_len += len;
             if (data) {
-                bacapp_timestamp_copy(&data->timeStamp, &timestamp_value);
+#if BACNET_DECODE_COMPLEX_EVENT_TYPE_PARAMETERS
+                property_value =
+                    data->notificationParams.complexEventType.values;
+#endif
             }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* notification-class[4] Unsigned */
-        len = bacnet_unsigned_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 4, &unsigned_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (unsigned_value <= UINT32_MAX) {
-                if (data) {
-                    data->notificationClass = (uint32_t)unsigned_value;
+            bacapp_property_value_list_init(
+                property_value, BACNET_COMPLEX_EVENT_TYPE_MAX_PARAMETERS);
+            while (apdu_len < apdu_size) {
+                len = bacapp_property_value_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, property_value);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* priority[5] Unsigned8 */
-        len = bacnet_unsigned_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 5, &unsigned_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (unsigned_value <= UINT8_MAX) {
-                if (data) {
-                    data->priority = (uint8_t)unsigned_value;
+                /* end of list? */
+                if (bacnet_is_closing_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        EVENT_COMPLEX_EVENT_TYPE, &len)) {
+                    apdu_len += len;
+                    if (property_value) {
+                        /* mark the end of the list */
+                        property_value->next = NULL;
+                    }
+                    break;
+                }
+                /* is there another slot in the data store? */
+                if (property_value) {
+                    property_value = property_value->next;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
             }
         } else {
             return BACNET_STATUS_ERROR;
         }
-        /* event-type[6] BACnetEventType */
-        len = bacnet_enumerated_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 6, &enum_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (enum_value <= EVENT_PROPRIETARY_MAX) {
-                event_type = (BACNET_EVENT_TYPE)enum_value;
+    } else if (bacnet_is_opening_tag_number(
+                   &apdu[apdu_len], apdu_size - apdu_len,
+                   (uint8_t)event_type, &len)) {
+        /* BACnetNotificationParameters */
+        apdu_len += len;
+        switch (event_type) {
+            case EVENT_CHANGE_OF_BITSTRING:
+                /* change-of-bitstring [0] SEQUENCE */
+                /* referenced-bitstring[0] BitString */
                 if (data) {
-                    data->eventType = event_type;
+                    bstring = &data->notificationParams.changeOfBitstring
+                                   .referencedBitString;
+                } else {
+                    bstring = NULL;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* message-text[7] CharacterString OPTIONAL */
-        if (data) {
-            cstring = data->messageText;
-        } else {
-            cstring = NULL;
-        }
-        len = bacnet_character_string_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 7, cstring);
-        if (len > 0) {
-            apdu_len += len;
-        } else if (len == 0) {
-            /* OPTIONAL - set default */
-            characterstring_init_ansi(cstring, "");
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        /* notify-type[8] BACnetNotifyType */
-        len = bacnet_enumerated_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 8, &enum_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (data) {
-                data->notifyType = (BACNET_NOTIFY_TYPE)enum_value;
-                if (enum_value >= NOTIFY_MAX) {
-                    enum_value = NOTIFY_MAX;
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
                 }
-                notify_type = enum_value;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        if ((notify_type == NOTIFY_ALARM) || (notify_type == NOTIFY_EVENT)) {
-            /* ack-required[9] Boolean OPTIONAL */
-            len = bacnet_boolean_context_decode(
-                &apdu[apdu_len], apdu_size - apdu_len, 9, &boolean_value);
-            if (len > 0) {
-                apdu_len += len;
+                /* status-flags[1] BACnetStatusFlags */
                 if (data) {
-                    data->ackRequired = boolean_value;
+                    bstring = &data->notificationParams.changeOfBitstring
+                                   .statusFlags;
+                } else {
+                    bstring = NULL;
                 }
-            } else if (len == 0) {
-                /* OPTIONAL - set default */
-                if (data) {
-                    data->ackRequired = false;
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-            /* from-state[10] BACnetEventState OPTIONAL */
-            len = bacnet_enumerated_context_decode(
-                &apdu[apdu_len], apdu_size - apdu_len, 10, &enum_value);
-            if (len > 0) {
-                apdu_len += len;
+                break;
+            case EVENT_CHANGE_OF_STATE:
+                /* change-of-state [1] SEQUENCE */
+                /* new-state[0] BACnetEventState */
                 if (data) {
-                    data->fromState = (BACNET_EVENT_STATE)enum_value;
+                    property_state =
+                        &data->notificationParams.changeOfState.newState;
+                } else {
+                    property_state = NULL;
                 }
-            } else if (len == 0) {
-                /* OPTIONAL - set default out of range */
-                if (data) {
-                    data->fromState = EVENT_STATE_MAX;
+                len = bacapp_decode_context_property_state(
+                    &apdu[apdu_len], 0, property_state);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-        }
-        /* to-state[11] BACnetEventState */
-        len = bacnet_enumerated_context_decode(
-            &apdu[apdu_len], apdu_size - apdu_len, 11, &enum_value);
-        if (len > 0) {
-            apdu_len += len;
-            if (data) {
-                data->toState = (BACNET_EVENT_STATE)enum_value;
-            }
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-    }
-    if ((notify_type == NOTIFY_ALARM) || (notify_type == NOTIFY_EVENT)) {
-        /* event-values[12] BACnetNotificationParameters OPTIONAL */
-        if (bacnet_is_opening_tag_number(
-                &apdu[apdu_len], apdu_size - apdu_len, 12, &len)) {
-            apdu_len += len;
-        } else {
-            return BACNET_STATUS_ERROR;
-        }
-        if (event_type >= EVENT_PROPRIETARY_MIN) {
-            /* complex-event-type [6] SEQUENCE OF BACnetPropertyValue */
-            if (bacnet_is_opening_tag_number(
-                    &apdu[apdu_len], apdu_size - apdu_len,
-                    EVENT_COMPLEX_EVENT_TYPE, &len)) {
-                apdu_len += len;
+                /* status-flags[1] BACnetStatusFlags */
                 if (data) {
-#if BACNET_DECODE_COMPLEX_EVENT_TYPE_PARAMETERS
-                    property_value =
-                        data->notificationParams.complexEventType.values;
-#endif
+                    bstring =
+                        &data->notificationParams.changeOfState.statusFlags;
+                } else {
+                    bstring = NULL;
                 }
-                bacapp_property_value_list_init(
-                    property_value, BACNET_COMPLEX_EVENT_TYPE_MAX_PARAMETERS);
-                while (apdu_len < apdu_size) {
-                    len = bacapp_property_value_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, property_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* end of list? */
-                    if (bacnet_is_closing_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            EVENT_COMPLEX_EVENT_TYPE, &len)) {
-                        apdu_len += len;
-                        if (property_value) {
-                            /* mark the end of the list */
-                            property_value->next = NULL;
-                        }
-                        break;
-                    }
-                    /* is there another slot in the data store? */
-                    if (property_value) {
-                        property_value = property_value->next;
-                    }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
                 }
-            } else {
-                return BACNET_STATUS_ERROR;
-            }
-        } else if (bacnet_is_opening_tag_number(
-                       &apdu[apdu_len], apdu_size - apdu_len,
-                       (uint8_t)event_type, &len)) {
-            /* BACnetNotificationParameters */
-            apdu_len += len;
-            switch (event_type) {
-                case EVENT_CHANGE_OF_BITSTRING:
-                    /* change-of-bitstring [0] SEQUENCE */
-                    /* referenced-bitstring[0] BitString */
+                break;
+            case EVENT_CHANGE_OF_VALUE:
+                /* change-of-value [2] SEQUENCE */
+                /* new-value [0] CHOICE */
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* changed-bits[0] BitString */
+                if (data) {
+                    bstring = &data->notificationParams.changeOfValue
+                                   .newValue.changedBits;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, bstring);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        bstring = &data->notificationParams.changeOfBitstring
-                                       .referencedBitString;
-                    } else {
-                        bstring = NULL;
+                        data->notificationParams.changeOfValue.tag =
+                            CHANGE_OF_VALUE_BITS;
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, bstring);
+                } else if (len < 0) {
+                    return BACNET_STATUS_ERROR;
+                } else {
+                    /* changed-value[1] Real */
+                    len = bacnet_real_context_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len, 1,
+                        &real_value);
                     if (len > 0) {
                         apdu_len += len;
+                        if (data) {
+                            data->notificationParams.changeOfValue.newValue
+                                .changeValue = real_value;
+                            data->notificationParams.changeOfValue.tag =
+                                CHANGE_OF_VALUE_REAL;
+                        }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
-                    if (data) {
-                        bstring = &data->notificationParams.changeOfBitstring
-                                       .statusFlags;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-                case EVENT_CHANGE_OF_STATE:
-                    /* change-of-state [1] SEQUENCE */
-                    /* new-state[0] BACnetEventState */
-                    if (data) {
-                        property_state =
-                            &data->notificationParams.changeOfState.newState;
-                    } else {
-                        property_state = NULL;
-                    }
-                    len = bacapp_decode_context_property_state(
-                        &apdu[apdu_len], 0, property_state);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* status-flags[1] BACnetStatusFlags */
+                }
+                if (bacnet_is_closing_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags [1] BACnetStatusFlags*/
+                if (data) {
+                    bstring =
+                        &data->notificationParams.changeOfValue.statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_COMMAND_FAILURE:
+                /* command-failure [3] SEQUENCE */
+                /* command-value [0] ABSTRACT-SYNTAX.&Type
+                   -- depends on ref property */
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                len = bacnet_enumerated_application_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        bstring =
-                            &data->notificationParams.changeOfState.statusFlags;
-                    } else {
-                        bstring = NULL;
+                        data->notificationParams.commandFailure.commandValue
+                            .binaryValue = enum_value;
+                        data->notificationParams.commandFailure.tag =
+                            COMMAND_FAILURE_BINARY_PV;
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                } else if (len < 0) {
+                    return BACNET_STATUS_ERROR;
+                }
+                if (len == 0) {
+                    len = bacnet_unsigned_application_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        &unsigned_value);
                     if (len > 0) {
                         apdu_len += len;
+                        if (data) {
+                            data->notificationParams.commandFailure
+                                .commandValue.unsignedValue =
+                                unsigned_value;
+                            data->notificationParams.commandFailure.tag =
+                                COMMAND_FAILURE_UNSIGNED;
+                        }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_CHANGE_OF_VALUE:
-                    /* change-of-value [2] SEQUENCE */
-                    /* new-value [0] CHOICE */
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* changed-bits[0] BitString */
-                    if (data) {
-                        bstring = &data->notificationParams.changeOfValue
-                                       .newValue.changedBits;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, bstring);
+                }
+                if (bacnet_is_closing_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
+                if (data) {
+                    bstring = &data->notificationParams.commandFailure
+                                   .statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /*  feedback-value[2] ABSTRACT-SYNTAX.&Type
+                    -- depends on ref property */
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                if (data->notificationParams.commandFailure.tag ==
+                    COMMAND_FAILURE_BINARY_PV) {
+                    len = bacnet_enumerated_application_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len, &enum_value);
                     if (len > 0) {
                         apdu_len += len;
                         if (data) {
-                            data->notificationParams.changeOfValue.tag =
-                                CHANGE_OF_VALUE_BITS;
+                            data->notificationParams.commandFailure
+                                .feedbackValue.binaryValue = enum_value;
                         }
                     } else if (len < 0) {
                         return BACNET_STATUS_ERROR;
-                    } else {
-                        /* changed-value[1] Real */
-                        len = bacnet_real_context_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len, 1,
-                            &real_value);
-                        if (len > 0) {
-                            apdu_len += len;
-                            if (data) {
-                                data->notificationParams.changeOfValue.newValue
-                                    .changeValue = real_value;
-                                data->notificationParams.changeOfValue.tag =
-                                    CHANGE_OF_VALUE_REAL;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
                     }
-                    if (bacnet_is_closing_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                } else {
+                    len = bacnet_unsigned_application_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        &unsigned_value);
+                    if (len > 0) {
                         apdu_len += len;
+                        if (data) {
+                            data->notificationParams.commandFailure
+                                .feedbackValue.unsignedValue =
+                                unsigned_value;
+                        }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags [1] BACnetStatusFlags*/
+                }
+                if (bacnet_is_closing_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_FLOATING_LIMIT:
+                /* floating-limit [4] SEQUENCE*/
+                /* reference-value[0] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        bstring =
-                            &data->notificationParams.changeOfValue.statusFlags;
-                    } else {
-                        bstring = NULL;
+                        data->notificationParams.floatingLimit
+                            .referenceValue = real_value;
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
+                if (data) {
+                    bstring =
+                        &data->notificationParams.floatingLimit.statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* setpoint-value[2] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
+                        data->notificationParams.floatingLimit
+                            .setPointValue = real_value;
                     }
-                    break;
-                case EVENT_COMMAND_FAILURE:
-                    /* command-failure [3] SEQUENCE */
-                    /* command-value [0] ABSTRACT-SYNTAX.&Type
-                       -- depends on ref property */
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* error-limit[3] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
+                        data->notificationParams.floatingLimit.errorLimit =
+                            real_value;
                     }
-                    len = bacnet_enumerated_application_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.commandFailure.commandValue
-                                .binaryValue = enum_value;
-                            data->notificationParams.commandFailure.tag =
-                                COMMAND_FAILURE_BINARY_PV;
-                        }
-                    } else if (len < 0) {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_OUT_OF_RANGE:
+                /* out-of-range [5] SEQUENCE */
+                /* exceeding-value[0] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
+                        data->notificationParams.outOfRange.exceedingValue =
+                            real_value;
                     }
-                    if (len == 0) {
-                        len = bacnet_unsigned_application_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            &unsigned_value);
-                        if (len > 0) {
-                            apdu_len += len;
-                            if (data) {
-                                data->notificationParams.commandFailure
-                                    .commandValue.unsignedValue =
-                                    unsigned_value;
-                                data->notificationParams.commandFailure.tag =
-                                    COMMAND_FAILURE_UNSIGNED;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
+                if (data) {
+                    bstring =
+                        &data->notificationParams.outOfRange.statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* deadband[2] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
+                        data->notificationParams.outOfRange.deadband =
+                            real_value;
                     }
-                    if (bacnet_is_closing_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* exceeded-limit[3] Real */
+                len = bacnet_real_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3, &real_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
+                        data->notificationParams.outOfRange.exceededLimit =
+                            real_value;
+                    }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+
+            case EVENT_CHANGE_OF_LIFE_SAFETY:
+                /* change-of-life-safety [8] SEQUENCE */
+                /* new-state[0] BACnetLifeSafetyState */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > LIFE_SAFETY_STATE_PROPRIETARY_MAX) {
+                        enum_value = LIFE_SAFETY_STATE_PROPRIETARY_MAX;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
                     if (data) {
-                        bstring = &data->notificationParams.commandFailure
-                                       .statusFlags;
-                    } else {
-                        bstring = NULL;
+                        data->notificationParams.changeOfLifeSafety
+                            .newState =
+                            (BACNET_LIFE_SAFETY_STATE)enum_value;
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* new-mode[1] BACnetLifeSafetyMode */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > LIFE_SAFETY_MODE_PROPRIETARY_MAX) {
+                        enum_value = LIFE_SAFETY_MODE_PROPRIETARY_MAX;
                     }
-                    /*  feedback-value[2] ABSTRACT-SYNTAX.&Type
-                        -- depends on ref property */
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                    if (data) {
+                        data->notificationParams.changeOfLifeSafety
+                            .newMode = (BACNET_LIFE_SAFETY_MODE)enum_value;
                     }
-                    if (data->notificationParams.commandFailure.tag ==
-                        COMMAND_FAILURE_BINARY_PV) {
-                        len = bacnet_enumerated_application_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len, &enum_value);
-                        if (len > 0) {
-                            apdu_len += len;
-                            if (data) {
-                                data->notificationParams.commandFailure
-                                    .feedbackValue.binaryValue = enum_value;
-                            }
-                        } else if (len < 0) {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        len = bacnet_unsigned_application_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            &unsigned_value);
-                        if (len > 0) {
-                            apdu_len += len;
-                            if (data) {
-                                data->notificationParams.commandFailure
-                                    .feedbackValue.unsignedValue =
-                                    unsigned_value;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[2] BACnetStatusFlags */
+                if (data) {
+                    bstring = &data->notificationParams.changeOfLifeSafety
+                                   .statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* operation-expected[3] BACnetLifeSafetyOperation */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > LIFE_SAFETY_OP_PROPRIETARY_MAX) {
+                        enum_value = LIFE_SAFETY_OP_PROPRIETARY_MAX;
                     }
-                    if (bacnet_is_closing_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                    if (data) {
+                        data->notificationParams.changeOfLifeSafety
+                            .operationExpected =
+                            (BACNET_LIFE_SAFETY_OPERATION)enum_value;
                     }
-                    break;
-                case EVENT_FLOATING_LIMIT:
-                    /* floating-limit [4] SEQUENCE*/
-                    /* reference-value[0] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &real_value);
-                    if (len > 0) {
-                        apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_EXTENDED:
+                /* extended [9] SEQUENCE */
+                /* vendor-id[0] Unsigned16 */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (unsigned_value <= UINT16_MAX) {
+#if BACNET_EVENT_EXTENDED_ENABLED
                         if (data) {
-                            data->notificationParams.floatingLimit
-                                .referenceValue = real_value;
+                            data->notificationParams.extended.vendorID =
+                                (uint16_t)unsigned_value;
                         }
+#endif
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* extended-event-type[1] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        bstring =
-                            &data->notificationParams.floatingLimit.statusFlags;
-                    } else {
-                        bstring = NULL;
+#if BACNET_EVENT_EXTENDED_ENABLED
+                        data->notificationParams.extended
+                            .extendedEventType = unsigned_value;
+#endif
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* parameters[2] SEQUENCE OF CHOICE */
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
+                    apdu_len += len;
+#if BACNET_EVENT_EXTENDED_ENABLED
+                    if (data) {
+                        parameter_value =
+                            &data->notificationParams.extended.parameters;
+                    } else
+#endif
+                    {
+                        parameter_value = NULL;
                     }
-                    /* setpoint-value[2] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2, &real_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.floatingLimit
-                                .setPointValue = real_value;
-                        }
-                    } else {
+                    len = event_extended_parameter_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        parameter_value);
+                    if (len < 0) {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* error-limit[3] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3, &real_value);
-                    if (len > 0) {
+                    apdu_len += len;
+                    if (bacnet_is_closing_tag_number(
+                            &apdu[apdu_len], apdu_size - apdu_len, 2,
+                            &len)) {
                         apdu_len += len;
-                        if (data) {
-                            data->notificationParams.floatingLimit.errorLimit =
-                                real_value;
-                        }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_OUT_OF_RANGE:
-                    /* out-of-range [5] SEQUENCE */
-                    /* exceeding-value[0] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &real_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.outOfRange.exceedingValue =
-                                real_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* status-flags[1] BACnetStatusFlags */
-                    if (data) {
-                        bstring =
-                            &data->notificationParams.outOfRange.statusFlags;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* deadband[2] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2, &real_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.outOfRange.deadband =
-                                real_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* exceeded-limit[3] Real */
-                    len = bacnet_real_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3, &real_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.outOfRange.exceededLimit =
-                                real_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-
-                case EVENT_CHANGE_OF_LIFE_SAFETY:
-                    /* change-of-life-safety [8] SEQUENCE */
-                    /* new-state[0] BACnetLifeSafetyState */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > LIFE_SAFETY_STATE_PROPRIETARY_MAX) {
-                            enum_value = LIFE_SAFETY_STATE_PROPRIETARY_MAX;
-                        }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_BUFFER_READY:
+                /* buffer-ready [10] SEQUENCE */
+                /* buffer-property[0] BACnetDeviceObjectPropertyReference */
+                if (data) {
+                    dev_obj_prop_ref = &data->notificationParams.bufferReady
+                                            .bufferProperty;
+                } else {
+                    dev_obj_prop_ref = NULL;
+                }
+                len =
+                    bacnet_device_object_property_reference_context_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0,
+                        dev_obj_prop_ref);
+                if (len <= 0) {
+                    return BACNET_STATUS_ERROR;
+                }
+                apdu_len += len;
+                /* previous-notification[1] Unsigned32 */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (unsigned_value <= UINT32_MAX) {
                         if (data) {
-                            data->notificationParams.changeOfLifeSafety
-                                .newState =
-                                (BACNET_LIFE_SAFETY_STATE)enum_value;
+                            data->notificationParams.bufferReady
+                                .previousNotification =
+                                (uint32_t)unsigned_value;
                         }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* new-mode[1] BACnetLifeSafetyMode */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > LIFE_SAFETY_MODE_PROPRIETARY_MAX) {
-                            enum_value = LIFE_SAFETY_MODE_PROPRIETARY_MAX;
-                        }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* current-notification[2] Unsigned32 */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (unsigned_value <= UINT32_MAX) {
                         if (data) {
-                            data->notificationParams.changeOfLifeSafety
-                                .newMode = (BACNET_LIFE_SAFETY_MODE)enum_value;
+                            data->notificationParams.bufferReady
+                                .currentNotification =
+                                (uint32_t)unsigned_value;
                         }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[2] BACnetStatusFlags */
-                    if (data) {
-                        bstring = &data->notificationParams.changeOfLifeSafety
-                                       .statusFlags;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* operation-expected[3] BACnetLifeSafetyOperation */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > LIFE_SAFETY_OP_PROPRIETARY_MAX) {
-                            enum_value = LIFE_SAFETY_OP_PROPRIETARY_MAX;
-                        }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_UNSIGNED_RANGE:
+                /* unsigned-range[11] SEQUENCE*/
+                /* exceeding-value[0] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (unsigned_value <= UINT32_MAX) {
                         if (data) {
-                            data->notificationParams.changeOfLifeSafety
-                                .operationExpected =
-                                (BACNET_LIFE_SAFETY_OPERATION)enum_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-                case EVENT_EXTENDED:
-                    /* extended [9] SEQUENCE */
-                    /* vendor-id[0] Unsigned16 */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (unsigned_value <= UINT16_MAX) {
-#if BACNET_EVENT_EXTENDED_ENABLED
-                            if (data) {
-                                data->notificationParams.extended.vendorID =
-                                    (uint16_t)unsigned_value;
-                            }
-#endif
-                        } else {
-                            return BACNET_STATUS_ERROR;
+                            data->notificationParams.unsignedRange
+                                .exceedingValue = (uint32_t)unsigned_value;
                         }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* extended-event-type[1] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
+                if (data) {
+                    bstring =
+                        &data->notificationParams.unsignedRange.statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* exceeded-limit[2] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (unsigned_value <= UINT32_MAX) {
                         if (data) {
-#if BACNET_EVENT_EXTENDED_ENABLED
-                            data->notificationParams.extended
-                                .extendedEventType = unsigned_value;
-#endif
+                            data->notificationParams.unsignedRange
+                                .exceededLimit = (uint32_t)unsigned_value;
                         }
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* parameters[2] SEQUENCE OF CHOICE */
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
-                        apdu_len += len;
-#if BACNET_EVENT_EXTENDED_ENABLED
-                        if (data) {
-                            parameter_value =
-                                &data->notificationParams.extended.parameters;
-                        } else
-#endif
-                        {
-                            parameter_value = NULL;
-                        }
-                        len = event_extended_parameter_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            parameter_value);
-                        if (len < 0) {
-                            return BACNET_STATUS_ERROR;
-                        }
-                        apdu_len += len;
-                        if (bacnet_is_closing_tag_number(
-                                &apdu[apdu_len], apdu_size - apdu_len, 2,
-                                &len)) {
-                            apdu_len += len;
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+
+            case EVENT_ACCESS_EVENT:
+                /* access-event[13] SEQUENCE */
+                /* access-event[0] BACnetAccessEvent */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > ACCESS_EVENT_PROPRIETARY_MAX) {
+                        enum_value = ACCESS_EVENT_PROPRIETARY_MAX;
                     }
-                    break;
-                case EVENT_BUFFER_READY:
-                    /* buffer-ready [10] SEQUENCE */
-                    /* buffer-property[0] BACnetDeviceObjectPropertyReference */
                     if (data) {
-                        dev_obj_prop_ref = &data->notificationParams.bufferReady
-                                                .bufferProperty;
-                    } else {
-                        dev_obj_prop_ref = NULL;
-                    }
-                    len =
-                        bacnet_device_object_property_reference_context_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0,
-                            dev_obj_prop_ref);
-                    if (len <= 0) {
-                        return BACNET_STATUS_ERROR;
+                        data->notificationParams.accessEvent.accessEvent =
+                            (BACNET_ACCESS_EVENT)enum_value;
                     }
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
+                if (data) {
+                    bstring =
+                        &data->notificationParams.accessEvent.statusFlags;
+                } else {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* access-event-tag[2] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &unsigned_value);
+                if (len > 0) {
                     apdu_len += len;
-                    /* previous-notification[1] Unsigned32 */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (unsigned_value <= UINT32_MAX) {
-                            if (data) {
-                                data->notificationParams.bufferReady
-                                    .previousNotification =
-                                    (uint32_t)unsigned_value;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* current-notification[2] Unsigned32 */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (unsigned_value <= UINT32_MAX) {
-                            if (data) {
-                                data->notificationParams.bufferReady
-                                    .currentNotification =
-                                    (uint32_t)unsigned_value;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-                case EVENT_UNSIGNED_RANGE:
-                    /* unsigned-range[11] SEQUENCE*/
-                    /* exceeding-value[0] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (unsigned_value <= UINT32_MAX) {
-                            if (data) {
-                                data->notificationParams.unsignedRange
-                                    .exceedingValue = (uint32_t)unsigned_value;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* status-flags[1] BACnetStatusFlags */
                     if (data) {
-                        bstring =
-                            &data->notificationParams.unsignedRange.statusFlags;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                        data->notificationParams.accessEvent
+                            .accessEventTag = unsigned_value;
                     }
-                    /* exceeded-limit[2] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (unsigned_value <= UINT32_MAX) {
-                            if (data) {
-                                data->notificationParams.unsignedRange
-                                    .exceededLimit = (uint32_t)unsigned_value;
-                            }
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-
-                case EVENT_ACCESS_EVENT:
-                    /* access-event[13] SEQUENCE */
-                    /* access-event[0] BACnetAccessEvent */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > ACCESS_EVENT_PROPRIETARY_MAX) {
-                            enum_value = ACCESS_EVENT_PROPRIETARY_MAX;
-                        }
-                        if (data) {
-                            data->notificationParams.accessEvent.accessEvent =
-                                (BACNET_ACCESS_EVENT)enum_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* status-flags[1] BACnetStatusFlags */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* access-event-time[3] BACnetTimeStamp */
+                len = bacnet_timestamp_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3,
+                    &timestamp_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        bstring =
-                            &data->notificationParams.accessEvent.statusFlags;
-                    } else {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* access-event-tag[2] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            data->notificationParams.accessEvent
-                                .accessEventTag = unsigned_value;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* access-event-time[3] BACnetTimeStamp */
-                    len = bacnet_timestamp_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3,
-                        &timestamp_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            bacapp_timestamp_copy(
-                                &data->notificationParams.accessEvent
-                                     .accessEventTime,
-                                &timestamp_value);
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                        bacapp_timestamp_copy(
+                            &data->notificationParams.accessEvent
+                                 .accessEventTime,
+                            &timestamp_value);
                     }
-                    /* access-credential[4] BACnetDeviceObjectReference */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* access-credential[4] BACnetDeviceObjectReference */
+                if (data) {
+                    dev_obj_ref = &data->notificationParams.accessEvent
+                                       .accessCredential;
+                } else {
+                    dev_obj_ref = NULL;
+                }
+                len = bacnet_device_object_reference_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 4, dev_obj_ref);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* authentication-factor[5] BACnetAuthenticationFactor
+                 * OPTIONAL */
+                if (data) {
+                    auth_factor = &data->notificationParams.accessEvent
+                                       .authenticationFactor;
+                } else {
+                    auth_factor = NULL;
+                }
+                len = bacnet_authentication_factor_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 5, auth_factor);
+                if (len > 0) {
+                    apdu_len += len;
+                } else if (len == 0) {
+                    /* OPTIONAL - set default */
                     if (data) {
-                        dev_obj_ref = &data->notificationParams.accessEvent
-                                           .accessCredential;
-                    } else {
-                        dev_obj_ref = NULL;
+                        data->notificationParams.accessEvent
+                            .authenticationFactor.format_type =
+                            AUTHENTICATION_FACTOR_MAX;
                     }
-                    len = bacnet_device_object_reference_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 4, dev_obj_ref);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* authentication-factor[5] BACnetAuthenticationFactor
-                     * OPTIONAL */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_DOUBLE_OUT_OF_RANGE:
+                /* double-out-of-range[14] SEQUENCE */
+                /* exceeding-value[0] Double */
+                len = bacnet_double_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0,
+                    &double_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        auth_factor = &data->notificationParams.accessEvent
-                                           .authenticationFactor;
-                    } else {
-                        auth_factor = NULL;
-                    }
-                    len = bacnet_authentication_factor_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 5, auth_factor);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else if (len == 0) {
-                        /* OPTIONAL - set default */
-                        if (data) {
-                            data->notificationParams.accessEvent
-                                .authenticationFactor.format_type =
-                                AUTHENTICATION_FACTOR_MAX;
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-                case EVENT_DOUBLE_OUT_OF_RANGE:
-                    /* double-out-of-range[14] SEQUENCE */
-                    /* exceeding-value[0] Double */
-                    len = bacnet_double_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0,
-                        &double_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
 #if BACNET_EVENT_DOUBLE_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.doubleOutOfRange
-                                .exceedingValue = double_value;
+                        data->notificationParams.doubleOutOfRange
+                            .exceedingValue = double_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_DOUBLE_OUT_OF_RANGE_ENABLED
-                    if (data) {
-                        bstring = &data->notificationParams.doubleOutOfRange
-                                       .statusFlags;
+                if (data) {
+                    bstring = &data->notificationParams.doubleOutOfRange
+                                   .statusFlags;
 
-                    } else
+                } else
 #endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* deadband[2] Double */
-                    len = bacnet_double_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &double_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* deadband[2] Double */
+                len = bacnet_double_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &double_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_DOUBLE_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.doubleOutOfRange.deadband =
-                                double_value;
+                        data->notificationParams.doubleOutOfRange.deadband =
+                            double_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* exceeded-limit[3] Double */
-                    len = bacnet_double_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3,
-                        &double_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* exceeded-limit[3] Double */
+                len = bacnet_double_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3,
+                    &double_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_DOUBLE_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.doubleOutOfRange
-                                .exceededLimit = double_value;
+                        data->notificationParams.doubleOutOfRange
+                            .exceededLimit = double_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_SIGNED_OUT_OF_RANGE:
-                    /* signed-out-of-range[15] SEQUENCE */
-                    /* exceeding-value[0] Integer */
-                    len = bacnet_signed_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0,
-                        &signed_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_SIGNED_OUT_OF_RANGE:
+                /* signed-out-of-range[15] SEQUENCE */
+                /* exceeding-value[0] Integer */
+                len = bacnet_signed_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0,
+                    &signed_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_SIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.signedOutOfRange
-                                .exceedingValue = signed_value;
+                        data->notificationParams.signedOutOfRange
+                            .exceedingValue = signed_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_SIGNED_OUT_OF_RANGE_ENABLED
-                    if (data) {
-                        bstring = &data->notificationParams.signedOutOfRange
-                                       .statusFlags;
-                    } else
-#endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* deadband[2] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                if (data) {
+                    bstring = &data->notificationParams.signedOutOfRange
+                                   .statusFlags;
+                } else
+#endif
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* deadband[2] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_SIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.signedOutOfRange.deadband =
-                                unsigned_value;
+                        data->notificationParams.signedOutOfRange.deadband =
+                            unsigned_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* exceeded-limit[3] Integer */
-                    len = bacnet_signed_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3,
-                        &signed_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* exceeded-limit[3] Integer */
+                len = bacnet_signed_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3,
+                    &signed_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_SIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.signedOutOfRange
-                                .exceededLimit = signed_value;
+                        data->notificationParams.signedOutOfRange
+                            .exceededLimit = signed_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_UNSIGNED_OUT_OF_RANGE:
-                    /* unsigned-out-of-range[16] SEQUENCE */
-                    /* exceeding-value[0] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_UNSIGNED_OUT_OF_RANGE:
+                /* unsigned-out-of-range[16] SEQUENCE */
+                /* exceeding-value[0] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_UNSIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.unsignedOutOfRange
-                                .exceedingValue = unsigned_value;
+                        data->notificationParams.unsignedOutOfRange
+                            .exceedingValue = unsigned_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_UNSIGNED_OUT_OF_RANGE_ENABLED
-                    if (data) {
-                        bstring = &data->notificationParams.unsignedOutOfRange
-                                       .statusFlags;
-                    } else
+                if (data) {
+                    bstring = &data->notificationParams.unsignedOutOfRange
+                                   .statusFlags;
+                } else
 #endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* deadband[2] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* deadband[2] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_UNSIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.unsignedOutOfRange
-                                .deadband = unsigned_value;
+                        data->notificationParams.unsignedOutOfRange
+                            .deadband = unsigned_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* exceeded-limit[3] Unsigned */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* exceeded-limit[3] Unsigned */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (data) {
 #if BACNET_EVENT_UNSIGNED_OUT_OF_RANGE_ENABLED
-                            data->notificationParams.unsignedOutOfRange
-                                .exceededLimit = unsigned_value;
+                        data->notificationParams.unsignedOutOfRange
+                            .exceededLimit = unsigned_value;
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_CHANGE_OF_CHARACTERSTRING:
-                    /* change-of-characterstring [17] SEQUENCE */
-                    /* changed-value[0] CharacterString */
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_CHANGE_OF_CHARACTERSTRING:
+                /* change-of-characterstring [17] SEQUENCE */
+                /* changed-value[0] CharacterString */
 #if BACNET_EVENT_CHANGE_OF_CHARACTERSTRING_ENABLED
-                    if (data) {
-                        cstring = data->notificationParams
-                                      .changeOfCharacterstring.changedValue;
-                    } else
+                if (data) {
+                    cstring = data->notificationParams
+                                  .changeOfCharacterstring.changedValue;
+                } else
 #endif
-                    {
-                        cstring = NULL;
-                    }
-                    len = bacnet_character_string_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, cstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* status-flags[1] BACnetStatusFlags */
+                {
+                    cstring = NULL;
+                }
+                len = bacnet_character_string_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, cstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_CHANGE_OF_CHARACTERSTRING_ENABLED
-                    if (data) {
-                        bstring = &data->notificationParams
-                                       .changeOfCharacterstring.statusFlags;
-                    } else
+                if (data) {
+                    bstring = &data->notificationParams
+                                   .changeOfCharacterstring.statusFlags;
+                } else
 #endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* alarm-value[2] CharacterString */
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* alarm-value[2] CharacterString */
 #if BACNET_EVENT_CHANGE_OF_CHARACTERSTRING_ENABLED
-                    if (data) {
-                        cstring = data->notificationParams
-                                      .changeOfCharacterstring.alarmValue;
-                    } else
+                if (data) {
+                    cstring = data->notificationParams
+                                  .changeOfCharacterstring.alarmValue;
+                } else
 #endif
-                    {
-                        cstring = NULL;
-                    }
-                    len = bacnet_character_string_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2, cstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    break;
-                case EVENT_CHANGE_OF_STATUS_FLAGS:
-                    /* change-of-status-flags[18] SEQUENCE */
-                    /* present-value[0] ABSTRACT-SYNTAX.&Type OPTIONAL,
-                        -- depends on referenced property */
+                {
+                    cstring = NULL;
+                }
+                len = bacnet_character_string_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2, cstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_CHANGE_OF_STATUS_FLAGS:
+                /* change-of-status-flags[18] SEQUENCE */
+                /* present-value[0] ABSTRACT-SYNTAX.&Type OPTIONAL,
+                    -- depends on referenced property */
 #if BACNET_EVENT_CHANGE_OF_STATUS_FLAGS_ENABLED
-                    if (data) {
-                        parameter_value =
-                            &data->notificationParams.changeOfStatusFlags
-                                 .presentValue;
-                    } else
+                if (data) {
+                    parameter_value =
+                        &data->notificationParams.changeOfStatusFlags
+                             .presentValue;
+                } else
 #endif
-                    {
-                        parameter_value = NULL;
+                {
+                    parameter_value = NULL;
+                }
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
+                    len = event_extended_parameter_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        parameter_value);
+                    if (len < 0) {
+                        return BACNET_STATUS_ERROR;
                     }
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
-                        apdu_len += len;
-                        len = event_extended_parameter_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            parameter_value);
-                        if (len < 0) {
-                            return BACNET_STATUS_ERROR;
-                        }
+                    apdu_len += len;
+                    if (bacnet_is_closing_tag_number(
+                            &apdu[apdu_len], apdu_size - apdu_len, 0,
+                            &len)) {
                         apdu_len += len;
-                        if (bacnet_is_closing_tag_number(
-                                &apdu[apdu_len], apdu_size - apdu_len, 0,
-                                &len)) {
-                            apdu_len += len;
-                        } else {
-                            return BACNET_STATUS_ERROR;
-                        }
                     } else {
-                        /* OPTIONAL */
-                        if (parameter_value) {
-#if BACNET_EVENT_CHANGE_OF_STATUS_FLAGS_ENABLED
-                            parameter_value->tag =
-                                BACNET_APPLICATION_TAG_EMPTYLIST;
-#endif
-                        }
+                        return BACNET_STATUS_ERROR;
                     }
-                    /* referenced-flags[1] BACnetStatusFlags*/
+                } else {
+                    /* OPTIONAL */
+                    if (parameter_value) {
 #if BACNET_EVENT_CHANGE_OF_STATUS_FLAGS_ENABLED
-                    if (data) {
-                        bstring = &data->notificationParams.changeOfStatusFlags
-                                       .referencedFlags;
-                    } else
+                        parameter_value->tag =
+                            BACNET_APPLICATION_TAG_EMPTYLIST;
 #endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_CHANGE_OF_RELIABILITY:
-                    /* change-of-reliability[19] SEQUENCE */
-                    /* reliability[0] BACnetReliability */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > RELIABILITY_PROPRIETARY_MAX) {
-                            enum_value = RELIABILITY_PROPRIETARY_MAX;
-                        }
-#if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
-                        if (data) {
-                            data->notificationParams.changeOfReliability
-                                .reliability = enum_value;
-                        }
+                }
+                /* referenced-flags[1] BACnetStatusFlags*/
+#if BACNET_EVENT_CHANGE_OF_STATUS_FLAGS_ENABLED
+                if (data) {
+                    bstring = &data->notificationParams.changeOfStatusFlags
+                                   .referencedFlags;
+                } else
 #endif
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_CHANGE_OF_RELIABILITY:
+                /* change-of-reliability[19] SEQUENCE */
+                /* reliability[0] BACnetReliability */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > RELIABILITY_PROPRIETARY_MAX) {
+                        enum_value = RELIABILITY_PROPRIETARY_MAX;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
                     if (data) {
-                        bstring = &data->notificationParams.changeOfReliability
-                                       .statusFlags;
-                    } else
-#endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                        data->notificationParams.changeOfReliability
+                            .reliability = enum_value;
                     }
-                    /* property-values[2] SEQUENCE OF BACnetPropertyValue */
+#endif
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
-                    if (data) {
-                        property_value =
-                            data->notificationParams.changeOfReliability
-                                .propertyValues;
-                    } else
+                if (data) {
+                    bstring = &data->notificationParams.changeOfReliability
+                                   .statusFlags;
+                } else
 #endif
-                    {
-                        property_value = NULL;
-                    }
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
-                        apdu_len += len;
-                        while (apdu_len < apdu_size) {
-                            len = bacapp_property_value_decode(
-                                &apdu[apdu_len], apdu_size - apdu_len,
-                                property_value);
-                            if (len >= 0) {
-                                apdu_len += len;
-                            } else {
-                                return BACNET_STATUS_ERROR;
-                            }
-                            /* end of list? */
-                            if (bacnet_is_closing_tag_number(
-                                    &apdu[apdu_len], apdu_size - apdu_len, 2,
-                                    &len)) {
-                                apdu_len += len;
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* property-values[2] SEQUENCE OF BACnetPropertyValue */
 #if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
-                                if (property_value) {
-                                    /* mark the end of the list */
-                                    property_value->next = NULL;
-                                }
+                if (data) {
+                    property_value =
+                        data->notificationParams.changeOfReliability
+                            .propertyValues;
+                } else
 #endif
-                                break;
-                            }
+                {
+                    property_value = NULL;
+                }
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 2, &len)) {
+                    apdu_len += len;
+                    while (apdu_len < apdu_size) {
+                        len = bacapp_property_value_decode(
+                            &apdu[apdu_len], apdu_size - apdu_len,
+                            property_value);
+                        if (len >= 0) {
+                            apdu_len += len;
+                        } else {
+                            return BACNET_STATUS_ERROR;
+                        }
+                        /* end of list? */
+                        if (bacnet_is_closing_tag_number(
+                                &apdu[apdu_len], apdu_size - apdu_len, 2,
+                                &len)) {
+                            apdu_len += len;
 #if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
                             if (property_value) {
-                                /* load the next value store */
-                                property_value = property_value->next;
+                                /* mark the end of the list */
+                                property_value->next = NULL;
                             }
 #endif
+                            break;
                         }
-                    }
-                    break;
-                case EVENT_NONE:
-                    /* -- CHOICE [20] has been intentionally omitted.
-                       It parallels the 'none' event type CHOICE[20] of
-                       the BACnetEventParameter production which was
-                       introduced for the case an object does not apply
-                       an event algorithm */
-                    break;
-                case EVENT_CHANGE_OF_DISCRETE_VALUE:
-                    /* change-of-discrete-value [21] SEQUENCE */
-                    /* new-value [0] CHOICE */
-                    if (bacnet_is_opening_tag_number(
-                            &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
-                        apdu_len += len;
-#if BACNET_EVENT_CHANGE_OF_DISCRETE_VALUE_ENABLED
-                        if (data) {
-                            discrete_value =
-                                &data->notificationParams.changeOfDiscreteValue
-                                     .newValue;
-                        } else
-#endif
-                        {
-                            discrete_value = NULL;
-                        }
-                        len = event_discrete_value_decode(
-                            &apdu[apdu_len], apdu_size - apdu_len,
-                            discrete_value);
-                        if (len < 0) {
-                            return BACNET_STATUS_ERROR;
-                        }
-                        apdu_len += len;
-                        if (bacnet_is_closing_tag_number(
-                                &apdu[apdu_len], apdu_size - apdu_len, 0,
-                                &tag_len)) {
-                            apdu_len += tag_len;
-                        } else {
-                            return BACNET_STATUS_ERROR;
+#if BACNET_EVENT_CHANGE_OF_RELIABILITY_ENABLED
+                        if (property_value) {
+                            /* load the next value store */
+                            property_value = property_value->next;
                         }
-                    } else {
-                        return BACNET_STATUS_ERROR;
+#endif
                     }
-                    /* status-flags[1] BACnetStatusFlags*/
+                }
+                break;
+            case EVENT_NONE:
+                /* -- CHOICE [20] has been intentionally omitted.
+                   It parallels the 'none' event type CHOICE[20] of
+                   the BACnetEventParameter production which was
+                   introduced for the case an object does not apply
+                   an event algorithm */
+                break;
+            case EVENT_CHANGE_OF_DISCRETE_VALUE:
+                /* change-of-discrete-value [21] SEQUENCE */
+                /* new-value [0] CHOICE */
+                if (bacnet_is_opening_tag_number(
+                        &apdu[apdu_len], apdu_size - apdu_len, 0, &len)) {
+                    apdu_len += len;
 #if BACNET_EVENT_CHANGE_OF_DISCRETE_VALUE_ENABLED
                     if (data) {
-                        bstring = &data->notificationParams
-                                       .changeOfDiscreteValue.statusFlags;
+                        discrete_value =
+                            &data->notificationParams.changeOfDiscreteValue
+                                 .newValue;
                     } else
 #endif
                     {
-                        bstring = NULL;
+                        discrete_value = NULL;
                     }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
+                    len = event_discrete_value_decode(
+                        &apdu[apdu_len], apdu_size - apdu_len,
+                        discrete_value);
+                    if (len < 0) {
                         return BACNET_STATUS_ERROR;
                     }
-                    break;
-                case EVENT_CHANGE_OF_TIMER:
-                    /* change-of-timer [22] SEQUENCE */
-                    /* new-state[0] BACnetTimerState */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
-                            if (enum_value > TIMER_STATE_MAX) {
-                                enum_value = TIMER_STATE_MAX;
-                            }
-#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                            data->notificationParams.changeOfTimer.newState =
-                                enum_value;
-#endif
-                        }
+                    apdu_len += len;
+                    if (bacnet_is_closing_tag_number(
+                            &apdu[apdu_len], apdu_size - apdu_len, 0,
+                            &tag_len)) {
+                        apdu_len += tag_len;
                     } else {
                         return BACNET_STATUS_ERROR;
                     }
-                    /* status-flags[1] BACnetStatusFlags */
-#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                    if (data) {
-                        bstring =
-                            &data->notificationParams.changeOfTimer.statusFlags;
-                    } else
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags*/
+#if BACNET_EVENT_CHANGE_OF_DISCRETE_VALUE_ENABLED
+                if (data) {
+                    bstring = &data->notificationParams
+                                   .changeOfDiscreteValue.statusFlags;
+                } else
 #endif
-                    {
-                        bstring = NULL;
-                    }
-                    len = bacnet_bitstring_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* update-time[2] BACnetDateTime */
-#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            case EVENT_CHANGE_OF_TIMER:
+                /* change-of-timer [22] SEQUENCE */
+                /* new-state[0] BACnetTimerState */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 0, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        datetime_value =
-                            &data->notificationParams.changeOfTimer.updateTime;
-                    } else
-#endif
-                    {
-                        datetime_value = NULL;
-                    }
-                    len = bacnet_datetime_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 2,
-                        datetime_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else {
-                        return BACNET_STATUS_ERROR;
-                    }
-                    /* last-state-change[3] BACnetTimerTransition OPTIONAL */
-                    len = bacnet_enumerated_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 3, &enum_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (enum_value > TIMER_TRANSITION_MAX) {
-                            enum_value = TIMER_TRANSITION_MAX;
+                        if (enum_value > TIMER_STATE_MAX) {
+                            enum_value = TIMER_STATE_MAX;
                         }
 #if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                        data->notificationParams.changeOfTimer.lastStateChange =
+                        data->notificationParams.changeOfTimer.newState =
                             enum_value;
 #endif
-                    } else if (len == 0) {
-                        /* OPTIONAL - set default */
-#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                        data->notificationParams.changeOfTimer.lastStateChange =
-                            TIMER_TRANSITION_MAX;
-#endif
-                    } else {
-                        return BACNET_STATUS_ERROR;
                     }
-                    /* initial-timeout[4] Unsigned OPTIONAL */
-                    len = bacnet_unsigned_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 4,
-                        &unsigned_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                        if (data) {
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* status-flags[1] BACnetStatusFlags */
 #if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                            data->notificationParams.changeOfTimer
-                                .initialTimeout = unsigned_value;
+                if (data) {
+                    bstring =
+                        &data->notificationParams.changeOfTimer.statusFlags;
+                } else
 #endif
-                        }
-                    } else if (len == 0) {
-                        /* OPTIONAL - set default */
-                        if (data) {
+                {
+                    bstring = NULL;
+                }
+                len = bacnet_bitstring_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 1, bstring);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* update-time[2] BACnetDateTime */
 #if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
-                            data->notificationParams.changeOfTimer
-                                .initialTimeout = 0;
+                if (data) {
+                    datetime_value =
+                        &data->notificationParams.changeOfTimer.updateTime;
+                } else
 #endif
-                        }
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                {
+                    datetime_value = NULL;
+                }
+                len = bacnet_datetime_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 2,
+                    datetime_value);
+                if (len > 0) {
+                    apdu_len += len;
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* last-state-change[3] BACnetTimerTransition OPTIONAL */
+                len = bacnet_enumerated_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 3, &enum_value);
+                if (len > 0) {
+                    apdu_len += len;
+                    if (enum_value > TIMER_TRANSITION_MAX) {
+                        enum_value = TIMER_TRANSITION_MAX;
                     }
-                    /* expiration-time[5] BACnetDateTime OPTIONAL */
 #if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                    data->notificationParams.changeOfTimer.lastStateChange =
+                        enum_value;
+#endif
+                } else if (len == 0) {
+                    /* OPTIONAL - set default */
+#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                    data->notificationParams.changeOfTimer.lastStateChange =
+                        TIMER_TRANSITION_MAX;
+#endif
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                /* initial-timeout[4] Unsigned OPTIONAL */
+                len = bacnet_unsigned_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 4,
+                    &unsigned_value);
+                if (len > 0) {
+                    apdu_len += len;
                     if (data) {
-                        datetime_value = &data->notificationParams.changeOfTimer
-                                              .expirationTime;
-                    } else
+#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                        data->notificationParams.changeOfTimer
+                            .initialTimeout = unsigned_value;
 #endif
-                    {
-                        datetime_value = NULL;
                     }
-                    len = bacnet_datetime_context_decode(
-                        &apdu[apdu_len], apdu_size - apdu_len, 5,
-                        datetime_value);
-                    if (len > 0) {
-                        apdu_len += len;
-                    } else if (len == 0) {
-                        /* OPTIONAL - set default */
-                        datetime_wildcard_set(datetime_value);
-                    } else {
-                        return BACNET_STATUS_ERROR;
+                } else if (len == 0) {
+                    /* OPTIONAL - set default */
+                    if (data) {
+#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                        data->notificationParams.changeOfTimer
+                            .initialTimeout = 0;
+#endif
                     }
-                    break;
-                default:
+                } else {
                     return BACNET_STATUS_ERROR;
-            }
-            if (bacnet_is_closing_tag_number(
-                    &apdu[apdu_len], apdu_size - apdu_len, (uint8_t)event_type,
-                    &len)) {
-                apdu_len += len;
-            } else {
+                }
+                /* expiration-time[5] BACnetDateTime OPTIONAL */
+#if BACNET_EVENT_CHANGE_OF_TIMER_ENABLED
+                if (data) {
+                    datetime_value = &data->notificationParams.changeOfTimer
+                                          .expirationTime;
+                } else
+#endif
+                {
+                    datetime_value = NULL;
+                }
+                len = bacnet_datetime_context_decode(
+                    &apdu[apdu_len], apdu_size - apdu_len, 5,
+                    datetime_value);
+                if (len > 0) {
+                    apdu_len += len;
+                } else if (len == 0) {
+                    /* OPTIONAL - set default */
+                    datetime_wildcard_set(datetime_value);
+                } else {
+                    return BACNET_STATUS_ERROR;
+                }
+                break;
+            default:
                 return BACNET_STATUS_ERROR;
-            }
         }
         if (bacnet_is_closing_tag_number(
-                &apdu[apdu_len], apdu_size - apdu_len, 12, &len)) {
+                &apdu[apdu_len], apdu_size - apdu_len, (uint8_t)event_type,
+                &len)) {
             apdu_len += len;
         } else {
             return BACNET_STATUS_ERROR;
         }
     }
+    if (bacnet_is_closing_tag_number(
+            &apdu[apdu_len], apdu_size - apdu_len, 12, &len)) {
+        apdu_len += len;
+    } else {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode an EventNotification service request into a view that
+ *  references the receive buffer.  The message-text and the event-values
+ *  are not copied; the event-values are decoded on demand with
+ *  event_notification_view_values_decode().
+ *
+ * @param apdu  Pointer to the buffer.
+ * @param apdu_size  Number of valid bytes in the buffer.
+ * @param view  Pointer to the view, which is valid as long as the buffer
+ * @return Bytes decoded or BACNET_STATUS_ERROR on error.
+ */
+int event_notification_view_decode(
+    const uint8_t *apdu,
+    unsigned apdu_size,
+    BACNET_EVENT_NOTIFICATION_VIEW *view)
+{
+    int apdu_len = 0; /* return value */
+    int len = 0, values_len = 0;
+    BACNET_UNSIGNED_INTEGER unsigned_value = 0;
+    BACNET_TAG tag = { 0 };
+    bool boolean_value = false;
+    uint32_t enum_value = 0;
+
+    if (!apdu || !view) {
+        return BACNET_STATUS_ERROR;
+    }
+    /* process-identifier[0] Unsigned32 */
+    len = bacnet_unsigned_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 0, &unsigned_value);
+    if ((len <= 0) || (unsigned_value > UINT32_MAX)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->processIdentifier = (uint32_t)unsigned_value;
+    /* initiating-device-identifier[1] BACnetObjectIdentifier */
+    len = bacnet_object_id_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 1,
+        &view->initiatingObjectIdentifier.type,
+        &view->initiatingObjectIdentifier.instance);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    /* event-object-identifier[2] BACnetObjectIdentifier */
+    len = bacnet_object_id_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 2,
+        &view->eventObjectIdentifier.type,
+        &view->eventObjectIdentifier.instance);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    /* timestamp[3] BACnetTimeStamp */
+    len = bacnet_timestamp_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 3, &view->timeStamp);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    /* notification-class[4] Unsigned */
+    len = bacnet_unsigned_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 4, &unsigned_value);
+    if ((len <= 0) || (unsigned_value > UINT32_MAX)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->notificationClass = (uint32_t)unsigned_value;
+    /* priority[5] Unsigned8 */
+    len = bacnet_unsigned_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 5, &unsigned_value);
+    if ((len <= 0) || (unsigned_value > UINT8_MAX)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->priority = (uint8_t)unsigned_value;
+    /* event-type[6] BACnetEventType */
+    len = bacnet_enumerated_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 6, &enum_value);
+    if ((len <= 0) || (enum_value > EVENT_PROPRIETARY_MAX)) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->eventType = (BACNET_EVENT_TYPE)enum_value;
+    /* message-text[7] CharacterString OPTIONAL - referenced, not copied */
+    view->messageText = NULL;
+    view->messageTextLength = 0;
+    view->messageTextEncoding = CHARACTER_ANSI_X34;
+    len = bacnet_tag_decode(&apdu[apdu_len], apdu_size - apdu_len, &tag);
+    if ((len > 0) && tag.context && (tag.number == 7)) {
+        if ((tag.len_value_type == 0) ||
+            (tag.len_value_type > (apdu_size - apdu_len - len))) {
+            return BACNET_STATUS_ERROR;
+        }
+        apdu_len += len;
+        view->messageTextEncoding = apdu[apdu_len];
+        view->messageText = &apdu[apdu_len + 1];
+        view->messageTextLength = tag.len_value_type - 1;
+        apdu_len += tag.len_value_type;
+    }
+    /* notify-type[8] BACnetNotifyType */
+    len = bacnet_enumerated_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 8, &enum_value);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->notifyType = (BACNET_NOTIFY_TYPE)enum_value;
+    view->ackRequired = false;
+    view->fromState = EVENT_STATE_MAX;
+    if ((enum_value == NOTIFY_ALARM) || (enum_value == NOTIFY_EVENT)) {
+        /* ack-required[9] Boolean OPTIONAL */
+        len = bacnet_boolean_context_decode(
+            &apdu[apdu_len], apdu_size - apdu_len, 9, &boolean_value);
+        if (len < 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        apdu_len += len;
+        view->ackRequired = boolean_value;
+        /* from-state[10] BACnetEventState OPTIONAL */
+        len = bacnet_enumerated_context_decode(
+            &apdu[apdu_len], apdu_size - apdu_len, 10, &enum_value);
+        if (len < 0) {
+            return BACNET_STATUS_ERROR;
+        } else if (len > 0) {
+            apdu_len += len;
+            view->fromState = (BACNET_EVENT_STATE)enum_value;
+        }
+    }
+    /* to-state[11] BACnetEventState */
+    len = bacnet_enumerated_context_decode(
+        &apdu[apdu_len], apdu_size - apdu_len, 11, &enum_value);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    apdu_len += len;
+    view->toState = (BACNET_EVENT_STATE)enum_value;
+    /* event-values[12] BACnetNotificationParameters OPTIONAL
+       - only the extent is found here */
+    view->eventValues = NULL;
+    view->eventValuesLength = 0;
+    if ((view->notifyType == NOTIFY_ALARM) ||
+        (view->notifyType == NOTIFY_EVENT)) {
+        if (!bacnet_is_opening_tag_number(
+                &apdu[apdu_len], apdu_size - apdu_len, 12, &len)) {
+            return BACNET_STATUS_ERROR;
+        }
+        values_len =
+            bacnet_enclosed_data_length(&apdu[apdu_len], apdu_size - apdu_len);
+        if (values_len < 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        values_len += len;
+        if (!bacnet_is_closing_tag_number(
+                &apdu[apdu_len + values_len], apdu_size - apdu_len - values_len,
+                12, &len)) {
+            return BACNET_STATUS_ERROR;
+        }
+        values_len += len;
+        view->eventValues = &apdu[apdu_len];
+        view->eventValuesLength = (unsigned)values_len;
+        apdu_len += values_len;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Decode the event-values of a decoded view on demand
+ * @param view  Pointer to a view from event_notification_view_decode()
+ * @param data  Pointer to the data to store the event-type and the
+ *  notificationParams; the other members are not changed
+ * @return true if there were event-values and they were decoded
+ */
+bool event_notification_view_values_decode(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_EVENT_NOTIFICATION_DATA *data)
+{
+    int len;
+
+    if (!view || !data || !view->eventValues) {
+        return false;
+    }
+    data->eventType = view->eventType;
+    len = event_notification_values_decode(
+        view->eventValues, view->eventValuesLength, view->eventType, data);
+
+    return len == (int)view->eventValuesLength;
+}
+
+/**
+ * @brief Copy the message-text of a decoded view
+ * @param view  Pointer to a view from event_notification_view_decode()
+ * @param char_string  Pointer to the string to hold the message-text,
+ *  which is empty if the notification did not have one
+ * @return true if the message-text fit in the string
+ */
+bool event_notification_view_message_text(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_CHARACTER_STRING *char_string)
+{
+    if (!view || !view->messageText) {
+        return characterstring_init_ansi(char_string, "");
+    }
+
+    return characterstring_init(
+        char_string, view->messageTextEncoding,
+        (const char *)view->messageText, view->messageTextLength);
+}
+
+/**
+ * @brief Normalize a decoded view into a compact record for queueing,
+ *  which holds no references to the receive buffer
+ * @param view  Pointer to a view from event_notification_view_decode()
+ * @param record  Pointer to the record to fill
+ */
+void event_notification_view_record(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_EVENT_NOTIFICATION_RECORD *record)
+{
+    if (!view || !record) {
+        return;
+    }
+    bacapp_timestamp_copy(&record->timeStamp, &view->timeStamp);
+    record->processIdentifier = view->processIdentifier;
+    record->initiatingDeviceInstance =
+        view->initiatingObjectIdentifier.instance;
+    record->eventObjectType = (uint16_t)view->eventObjectIdentifier.type;
+    record->eventObjectInstance = view->eventObjectIdentifier.instance;
+    record->notificationClass = view->notificationClass;
+    record->eventType = (uint16_t)view->eventType;
+    record->priority = view->priority;
+    record->notifyType = (uint8_t)view->notifyType;
+    record->fromState = (uint8_t)view->fromState;
+    record->toState = (uint8_t)view->toState;
+    record->ackRequired = view->ackRequired;
+    record->messageText = view->messageText != NULL;
+}
+
+/**
+ * @brief Decode the EventNotification service request only.
+ * @details Confirmed and Unconfirmed are the same encoding
+ *  UnconfirmedEventNotification-Request ::= SEQUENCE {
+ *  ConfirmedEventNotification-Request ::= SEQUENCE {
+ *      process-identifier[0] Unsigned32,
+ *      initiating-device-identifier[1] BACnetObjectIdentifier,
+ *      event-object-identifier[2] BACnetObjectIdentifier,
+ *      timestamp[3] BACnetTimeStamp,
+ *      notification-class[4] Unsigned,
+ *      priority[5] Unsigned8,
+ *      event-type[6] BACnetEventType,
+ *      message-text[7] CharacterString OPTIONAL,
+ *      notify-type[8] BACnetNotifyType,
+ *      ack-required[9] Boolean OPTIONAL,
+ *      from-state[10] BACnetEventState OPTIONAL,
+ *      to-state[11] BACnetEventState,
+ *      event-values[12] BACnetNotificationParameters OPTIONAL
+ *  }
+ *
+ * @param apdu  Pointer to the buffer.
+ * @param apdu_size  Number of valid bytes in the buffer.
+ * @param data  Pointer to the data to store the decoded values, or NULL
+ *
+ * @return Bytes decoded or BACNET_STATUS_ERROR on error.
+ */
+int event_notify_decode_service_request(
+    const uint8_t *apdu,
+    unsigned apdu_size,
+    BACNET_EVENT_NOTIFICATION_DATA *data)
+{
+    BACNET_EVENT_NOTIFICATION_VIEW view = { 0 };
+    int apdu_len = 0; /* return value */
+    int len = 0;
+
+    if (apdu_size == 0) {
+        return 0;
+    }
+    apdu_len = event_notification_view_decode(apdu, apdu_size, &view);
+    if (apdu_len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    if (data) {
+        data->processIdentifier = view.processIdentifier;
+        data->initiatingObjectIdentifier = view.initiatingObjectIdentifier;
+        data->eventObjectIdentifier = view.eventObjectIdentifier;
+        bacapp_timestamp_copy(&data->timeStamp, &view.timeStamp);
+        data->notificationClass = view.notificationClass;
+        data->priority = view.priority;
+        data->eventType = view.eventType;
+        (void)event_notification_view_message_text(&view, data->messageText);
+        data->notifyType = view.notifyType;
+        if ((view.notifyType == NOTIFY_ALARM) ||
+            (view.notifyType == NOTIFY_EVENT)) {
+            data->ackRequired = view.ackRequired;
+            data->fromState = view.fromState;
+        }
+        data->toState = view.toState;
+        if (view.eventValues) {
+            len = event_notification_values_decode(
+                view.eventValues, view.eventValuesLength, view.eventType,
+                data);
+            if (len != (int)view.eventValuesLength) {
+                return BACNET_STATUS_ERROR;
+            }
+        }
+    }
 
     return apdu_len;
 }
@@ -414,6 +414,54 @@ typedef struct BACnet_Event_Notification_Data {
     } notificationParams;
 } BACNET_EVENT_NOTIFICATION_DATA;
 
+/**
+ * A decoded EventNotification that references the receive buffer.
+ * The message-text and the event-values are not copied, and are
+ * valid as long as the buffer.
+ */
+typedef struct BACnet_Event_Notification_View {
+    uint32_t processIdentifier;
+    BACNET_OBJECT_ID initiatingObjectIdentifier;
+    BACNET_OBJECT_ID eventObjectIdentifier;
+    BACNET_TIMESTAMP timeStamp;
+    uint32_t notificationClass;
+    uint8_t priority;
+    BACNET_EVENT_TYPE eventType;
+    /* OPTIONAL - the characters in the buffer, or NULL if not present */
+    const uint8_t *messageText;
+    unsigned messageTextLength;
+    uint8_t messageTextEncoding;
+    BACNET_NOTIFY_TYPE notifyType;
+    bool ackRequired;
+    BACNET_EVENT_STATE fromState;
+    BACNET_EVENT_STATE toState;
+    /* OPTIONAL - event-values[12] in the buffer, including its context
+       tags, or NULL if not present */
+    const uint8_t *eventValues;
+    unsigned eventValuesLength;
+} BACNET_EVENT_NOTIFICATION_VIEW;
+
+/**
+ * A compact EventNotification, normalized for queueing, that holds
+ * no references to the receive buffer.
+ */
+typedef struct BACnet_Event_Notification_Record {
+    BACNET_TIMESTAMP timeStamp;
+    uint32_t processIdentifier;
+    uint32_t initiatingDeviceInstance;
+    uint32_t eventObjectInstance;
+    uint32_t notificationClass;
+    uint16_t eventObjectType;
+    uint16_t eventType;
+    uint8_t priority;
+    uint8_t notifyType;
+    uint8_t fromState;
+    uint8_t toState;
+    bool ackRequired : 1;
+    /* true if the notification had message-text */
+    bool messageText : 1;
+} BACNET_EVENT_NOTIFICATION_RECORD;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -438,6 +486,20 @@ BACNET_STACK_EXPORT
 int uevent_notify_encode_apdu(
     uint8_t *apdu, const BACNET_EVENT_NOTIFICATION_DATA *data);
 
+BACNET_STACK_EXPORT
+int cevent_notify_body_encode_apdu(
+    uint8_t *apdu,
+    uint8_t invoke_id,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len);
+BACNET_STACK_EXPORT
+int uevent_notify_body_encode_apdu(
+    uint8_t *apdu,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len);
+
 /***************************************************
 **
 ** Encodes the service data part of Event Notification
@@ -452,6 +514,11 @@ size_t event_notification_service_request_encode(
     uint8_t *apdu,
     size_t apdu_size,
     const BACNET_EVENT_NOTIFICATION_DATA *data);
+BACNET_STACK_EXPORT
+size_t event_notification_body_encode(
+    uint8_t *apdu,
+    size_t apdu_size,
+    const BACNET_EVENT_NOTIFICATION_DATA *data);
 
 /***************************************************
 **
@@ -464,6 +531,24 @@ int event_notify_decode_service_request(
     unsigned apdu_len,
     BACNET_EVENT_NOTIFICATION_DATA *data);
 
+BACNET_STACK_EXPORT
+int event_notification_view_decode(
+    const uint8_t *apdu,
+    unsigned apdu_size,
+    BACNET_EVENT_NOTIFICATION_VIEW *view);
+BACNET_STACK_EXPORT
+bool event_notification_view_values_decode(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_EVENT_NOTIFICATION_DATA *data);
+BACNET_STACK_EXPORT
+bool event_notification_view_message_text(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_CHARACTER_STRING *char_string);
+BACNET_STACK_EXPORT
+void event_notification_view_record(
+    const BACNET_EVENT_NOTIFICATION_VIEW *view,
+    BACNET_EVENT_NOTIFICATION_RECORD *record);
+
 /***************************************************
 **
 ** Sends an Unconfirmed Event Notification to a dest
@@ -34,6 +34,10 @@ typedef struct BACnet_Get_Event_Information_Data {
 typedef int (*get_event_info_function)(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
 
+/* return the index of the object for its get_event_info_function,
+   or a value past the end of the list if not found */
+typedef unsigned (*get_event_index_function)(uint32_t object_instance);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
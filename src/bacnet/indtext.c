@@ -6,6 +6,7 @@
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include "bacnet/bacdef.h"
@@ -190,3 +191,258 @@ uint32_t indtext_count(INDTEXT_DATA *data_list)
     }
     return count;
 }
+
+/**
+ * @brief Compare two pairs for sorting, case insensitive, and keep the
+ *  pairs with the same text in their list order
+ * @param a - pointer to the first pair pointer
+ * @param b - pointer to the second pair pointer
+ * @return negative, zero, or positive as a sorts before, same, or after b
+ */
+static int indtext_index_compare(const void *a, const void *b)
+{
+    INDTEXT_DATA *pair_a = *(INDTEXT_DATA *const *)a;
+    INDTEXT_DATA *pair_b = *(INDTEXT_DATA *const *)b;
+    int compare;
+
+    compare = bacnet_stricmp(pair_a->pString, pair_b->pString);
+    if (compare == 0) {
+        if (pair_a < pair_b) {
+            compare = -1;
+        } else if (pair_a > pair_b) {
+            compare = 1;
+        }
+    }
+
+    return compare;
+}
+
+/**
+ * @brief Sort a list of strings into an index for a binary search
+ * @param index - index to initialize
+ * @param data_list - list of strings and indices
+ * @param sorted - storage for one pointer per string in the list
+ * @param size - number of pointers in the storage
+ * @return true if the index was sorted, false if the storage is too small
+ *  and the index searches the list instead
+ */
+bool indtext_index_init(
+    INDTEXT_INDEX *index,
+    INDTEXT_DATA *data_list,
+    INDTEXT_DATA **sorted,
+    uint32_t size)
+{
+    uint32_t count;
+    uint32_t i;
+
+    if (!index) {
+        return false;
+    }
+    index->data_list = data_list;
+    index->sorted = sorted;
+    index->size = size;
+    index->count = 0;
+    index->valid = false;
+    count = indtext_count(data_list);
+    if (!sorted || (count > size)) {
+        return false;
+    }
+    for (i = 0; i < count; i++) {
+        sorted[i] = &data_list[i];
+    }
+    if (count > 1) {
+        qsort(sorted, count, sizeof(sorted[0]), indtext_index_compare);
+    }
+    index->count = count;
+    index->valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Find the first sorted pair that matches a string, case insensitive
+ * @param index - sorted index, which is sorted on first use
+ * @param search_name - string to search for
+ * @param found - position of the first matching pair in the sorted storage
+ * @return true if a matching string is found
+ */
+static bool indtext_index_search(
+    INDTEXT_INDEX *index, const char *search_name, uint32_t *found)
+{
+    uint32_t low = 0;
+    uint32_t high;
+    uint32_t middle;
+
+    if (!index->valid) {
+        if (!index->size ||
+            !indtext_index_init(
+                index, index->data_list, index->sorted, index->size)) {
+            return false;
+        }
+    }
+    /* lower bound: the first pair that does not sort before the string */
+    high = index->count;
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        if (bacnet_stricmp(index->sorted[middle]->pString, search_name) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if ((low < index->count) &&
+        (bacnet_stricmp(index->sorted[low]->pString, search_name) == 0)) {
+        *found = low;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Search a sorted index to find a matching string
+ * @param index - sorted index of strings and indices
+ * @param search_name - string to search for
+ * @param found_index - index of the first string found in list order
+ * @return true if the matching string is found
+ */
+bool indtext_index_by_string(
+    INDTEXT_INDEX *index, const char *search_name, uint32_t *found_index)
+{
+    INDTEXT_DATA *pair;
+    uint32_t i = 0;
+
+    if (!index || !search_name) {
+        return false;
+    }
+    if (!indtext_index_search(index, search_name, &i)) {
+        if (index->valid) {
+            return false;
+        }
+        return indtext_by_string(index->data_list, search_name, found_index);
+    }
+    /* the case insensitive matches are adjacent and in list order */
+    for (; i < index->count; i++) {
+        pair = index->sorted[i];
+        if (bacnet_stricmp(pair->pString, search_name) != 0) {
+            break;
+        }
+        if (bacnet_strcmp(pair->pString, search_name) == 0) {
+            if (found_index) {
+                *found_index = pair->index;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Search a sorted index to find a matching string, case insensitive
+ * @param index - sorted index of strings and indices
+ * @param search_name - string to search for
+ * @param found_index - index of the first string found in list order
+ * @return true if the matching string is found
+ */
+bool indtext_index_by_istring(
+    INDTEXT_INDEX *index, const char *search_name, uint32_t *found_index)
+{
+    uint32_t i = 0;
+
+    if (!index || !search_name) {
+        return false;
+    }
+    if (!indtext_index_search(index, search_name, &i)) {
+        if (index->valid) {
+            return false;
+        }
+        return indtext_by_istring(index->data_list, search_name, found_index);
+    }
+    if (found_index) {
+        *found_index = index->sorted[i]->index;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Fill a table with the string of each index below its size
+ * @param table - table to initialize
+ * @param data_list - list of strings and indices
+ * @param text - storage for one string pointer per index below the size
+ * @param size - number of pointers in the storage
+ * @return true if the table was filled, false if there is no storage
+ *  and the table searches the list instead
+ */
+bool indtext_table_init(
+    INDTEXT_TABLE *table,
+    INDTEXT_DATA *data_list,
+    const char **text,
+    uint32_t size)
+{
+    uint32_t i;
+
+    if (!table) {
+        return false;
+    }
+    table->data_list = data_list;
+    table->text = text;
+    table->size = size;
+    table->sparse = 0;
+    table->valid = false;
+    if (!text || (size == 0)) {
+        return false;
+    }
+    for (i = 0; i < size; i++) {
+        text[i] = NULL;
+    }
+    if (data_list) {
+        while (data_list->pString) {
+            if (data_list->index >= size) {
+                table->sparse++;
+            } else if (!text[data_list->index]) {
+                /* the first string in list order, as in the search */
+                text[data_list->index] = data_list->pString;
+            }
+            data_list++;
+        }
+    }
+    table->valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Return the string for a given index, or a default string,
+ *  from the table, which is filled on first use
+ * @param table - table of strings by index
+ * @param index - index to search for
+ * @param default_name - string to return if the index is not found
+ * @return the string found, or the default string
+ */
+const char *indtext_table_by_index_default(
+    INDTEXT_TABLE *table, uint32_t index, const char *default_name)
+{
+    const char *pString;
+
+    if (!table) {
+        return default_name;
+    }
+    if (!table->valid) {
+        if (!indtext_table_init(
+                table, table->data_list, table->text, table->size)) {
+            return indtext_by_index_default(
+                table->data_list, index, default_name);
+        }
+    }
+    if (index < table->size) {
+        pString = table->text[index];
+        return pString ? pString : default_name;
+    }
+    if (table->sparse == 0) {
+        return default_name;
+    }
+
+    return indtext_by_index_default(table->data_list, index, default_name);
+}
@@ -20,6 +20,29 @@ typedef const struct {
     const char *pString; /* text pair - use NULL to end the list */
 } INDTEXT_DATA;
 
+/* a sorted index over a list of index and text pairs, for a binary
+   search by string instead of a linear search.  The caller provides
+   the storage for one pointer per pair in the list. */
+typedef struct indtext_index {
+    INDTEXT_DATA *data_list;
+    INDTEXT_DATA **sorted;
+    uint32_t size; /* number of pointers in the sorted storage */
+    uint32_t count; /* number of pairs sorted */
+    bool valid; /* true after the index is sorted */
+} INDTEXT_INDEX;
+
+/* a table of the text for each index below its size, for a lookup
+   by index instead of a linear search.  The caller provides the storage
+   for one pointer per index below the size.  The pairs with an index
+   at or above the size are searched in the list. */
+typedef struct indtext_table {
+    INDTEXT_DATA *data_list;
+    const char **text;
+    uint32_t size; /* number of pointers in the text storage */
+    uint32_t sparse; /* number of pairs with an index at or above size */
+    bool valid; /* true after the table is filled */
+} INDTEXT_TABLE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -70,6 +93,36 @@ const char *indtext_by_index_split_default(
 BACNET_STACK_EXPORT
 uint32_t indtext_count(INDTEXT_DATA *data_list);
 
+/* sort the list into the index storage - returns false if the
+   storage is too small, and the searches then fall back to the list */
+BACNET_STACK_EXPORT
+bool indtext_index_init(
+    INDTEXT_INDEX *index,
+    INDTEXT_DATA *data_list,
+    INDTEXT_DATA **sorted,
+    uint32_t size);
+/* same results as indtext_by_string() using the sorted index */
+BACNET_STACK_EXPORT
+bool indtext_index_by_string(
+    INDTEXT_INDEX *index, const char *search_name, uint32_t *found_index);
+/* same results as indtext_by_istring() using the sorted index */
+BACNET_STACK_EXPORT
+bool indtext_index_by_istring(
+    INDTEXT_INDEX *index, const char *search_name, uint32_t *found_index);
+
+/* fill the table from the list - returns false if there is no storage,
+   and the lookups then fall back to the list */
+BACNET_STACK_EXPORT
+bool indtext_table_init(
+    INDTEXT_TABLE *table,
+    INDTEXT_DATA *data_list,
+    const char **text,
+    uint32_t size);
+/* same results as indtext_by_index_default() using the table */
+BACNET_STACK_EXPORT
+const char *indtext_table_by_index_default(
+    INDTEXT_TABLE *table, uint32_t index, const char *default_name);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -16,6 +16,21 @@
 #include "bacnet/npdu.h"
 #include "bacnet/apdu.h"
 
+/* finds the router to a remote network for npdu_encode_pdu() */
+static npdu_route_function Route_Function;
+
+/**
+ * @brief Set the function that npdu_encode_pdu() uses to find the MAC
+ *  address of the router to a remote destination network, so that
+ *  messages to the remote network are sent to that router rather than
+ *  broadcast on the local network.
+ * @param pFunction  Pointer to the function, or NULL for none
+ */
+void npdu_route_function_set(npdu_route_function pFunction)
+{
+    Route_Function = pFunction;
+}
+
 /** Copy the npdu_data structure information from src to dest.
  * @param dest [out] The 'to' structure
  * @param src   [in] The 'from' structure
@@ -84,9 +99,12 @@ ABORT.indication               Yes         Yes         Yes        No
  *  case, and should always be at least 24 bytes to accommodate the maximal
  *  case (all fields loaded). If the buffer is NULL, the number of bytes
  *  the buffer would have held is returned.
- * @param dest [in] The routing destination information if the message must
- *  be routed to reach its destination. If dest->net and dest->len are 0,
- *  there is no routing destination information.
+ * @param dest [in,out] The routing destination information if the message
+ *  must be routed to reach its destination. If dest->net and dest->len are 0,
+ *  there is no routing destination information. When dest is on a remote
+ *  network and has no MAC address, the MAC address of the router to that
+ *  network is filled in by the function set with npdu_route_function_set(),
+ *  if the router is known.
  * @param src  [in] The routing source information if the message was routed
  *  from another BACnet network. If src->net and src->len are 0, there is no
  *  routing source information. This src describes the original source of the
@@ -105,6 +123,11 @@ int npdu_encode_pdu(
     int len = 0; /* return value - number of octets loaded in this function */
     uint8_t i = 0; /* counter  */
 
+    if (npdu && dest && Route_Function && (dest->mac_len == 0) &&
+        (dest->net != 0) && (dest->net != BACNET_BROADCAST_NETWORK)) {
+        /* unicast to the router rather than broadcast locally */
+        (void)Route_Function(dest);
+    }
     if (npdu_data) {
         /* protocol version */
         if (npdu) {
@@ -588,6 +611,48 @@ int bacnet_npdu_decode(
     return len;
 }
 
+/**
+ * @brief Decode only the APDU offset and network priority of a received
+ *  NPDU.  A local NPDU, with no DNET, SNET or network layer message, is
+ *  handled from the control octet without filling any address structures.
+ *  Any other NPDU falls back to bacnet_npdu_decode().
+ * @param npdu [in] Buffer holding the received NPDU header bytes
+ * @param pdu_len [in] Length of the received data to prevent overruns.
+ * @param priority [out] Returns the network priority, if not NULL
+ * @return offset of the APDU in the buffer, or 0 if the NPDU conveys a
+ *  network layer message, has no APDU, or is malformed.
+ */
+int bacnet_npdu_decode_apdu_offset(
+    const uint8_t *npdu, uint16_t pdu_len, BACNET_MESSAGE_PRIORITY *priority)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int len = 0;
+
+    if (!npdu || (pdu_len < 2)) {
+        return 0;
+    }
+    if ((npdu[1] & (BIT(7) | BIT(5) | BIT(3))) == 0) {
+        /* local APDU - no DNET, SNET, hop count or message type */
+        len = 2;
+        if (priority) {
+            *priority = (BACNET_MESSAGE_PRIORITY)(npdu[1] & 0x03);
+        }
+    } else {
+        len = bacnet_npdu_decode(npdu, pdu_len, NULL, NULL, &npdu_data);
+        if (npdu_data.network_layer_message) {
+            return 0;
+        }
+        if (priority) {
+            *priority = npdu_data.priority;
+        }
+    }
+    if ((len <= 0) || (len >= pdu_len)) {
+        return 0;
+    }
+
+    return len;
+}
+
 /**
  * @brief Helper for datalink detecting an application confirmed service
  * @param pdu [in]  Buffer containing the NPDU and APDU of the received packet.
@@ -598,15 +663,12 @@ bool npdu_confirmed_service(const uint8_t *pdu, uint16_t pdu_len)
 {
     bool status = false;
     int apdu_offset = 0;
-    BACNET_NPDU_DATA npdu_data = { 0 };
 
     if (pdu_len > 0) {
         if (pdu[0] == BACNET_PROTOCOL_VERSION) {
             /* only handle the version that we know how to handle */
-            apdu_offset =
-                bacnet_npdu_decode(&pdu[0], pdu_len, NULL, NULL, &npdu_data);
-            if ((!npdu_data.network_layer_message) && (apdu_offset > 0) &&
-                (apdu_offset < pdu_len)) {
+            apdu_offset = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, NULL);
+            if (apdu_offset > 0) {
                 if ((pdu[apdu_offset] & 0xF0) ==
                     PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
                     status = true;
@@ -628,15 +690,12 @@ bool npdu_is_segmented_complex_ack_reply(const uint8_t *pdu, uint16_t pdu_len)
 {
     bool status = false;
     int apdu_offset = 0;
-    BACNET_NPDU_DATA npdu_data = { 0 };
 
     if (pdu_len > 0) {
         if (pdu[0] == BACNET_PROTOCOL_VERSION) {
             /* only handle the version that we know how to handle */
-            apdu_offset =
-                bacnet_npdu_decode(pdu, pdu_len, NULL, NULL, &npdu_data);
-            if ((!npdu_data.network_layer_message) && (apdu_offset > 0) &&
-                (apdu_offset < pdu_len)) {
+            apdu_offset = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, NULL);
+            if (apdu_offset > 0) {
                 if ((pdu[apdu_offset] & 0xF0) == PDU_TYPE_COMPLEX_ACK) {
                     /* segmented message? */
                     if (pdu[apdu_offset] & BIT(3)) {
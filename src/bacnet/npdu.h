@@ -54,6 +54,14 @@ typedef struct router_port_t {
     struct router_port_t *next; /**< Point to next in linked list */
 } BACNET_ROUTER_PORT;
 
+/**
+ * Finds the router to the remote network of a destination address.
+ * @param dest [in,out] destination on a remote network, which gets the
+ *  MAC address of the router to that network if the router is known
+ * @return true if the MAC address of the router was filled in
+ */
+typedef bool (*npdu_route_function)(BACNET_ADDRESS *dest);
+
 #define NETWORK_NUMBER_LEARNED 0
 #define NETWORK_NUMBER_CONFIGURED 1
 
@@ -64,6 +72,9 @@ extern "C" {
 BACNET_STACK_EXPORT
 uint8_t npdu_encode_max_seg_max_apdu(int max_segs, int max_apdu);
 
+BACNET_STACK_EXPORT
+void npdu_route_function_set(npdu_route_function pFunction);
+
 BACNET_STACK_EXPORT
 int npdu_encode_pdu(
     uint8_t *npdu,
@@ -111,6 +122,10 @@ int bacnet_npdu_decode(
     BACNET_ADDRESS *src,
     BACNET_NPDU_DATA *npdu_data);
 
+BACNET_STACK_EXPORT
+int bacnet_npdu_decode_apdu_offset(
+    const uint8_t *npdu, uint16_t pdu_len, BACNET_MESSAGE_PRIORITY *priority);
+
 BACNET_STACK_EXPORT
 bool npdu_confirmed_service(const uint8_t *pdu, uint16_t pdu_len);
 BACNET_STACK_EXPORT
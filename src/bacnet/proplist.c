@@ -59,6 +59,68 @@ bool property_list_member(const int32_t *pList, int32_t object_property)
     return status;
 }
 
+/**
+ * @brief Fill in the membership bitset of a property list
+ * @param bitset - the bitset to fill in
+ * @param pList - array of type 'int32_t' that is a list of BACnet object
+ * properties, terminated by a '-1' value.  The list is kept for the
+ * members that are above the standard range.
+ */
+void property_list_bitset_init(
+    struct property_list_bitset_t *bitset, const int32_t *pList)
+{
+    unsigned i;
+
+    if (!bitset) {
+        return;
+    }
+    for (i = 0; i < PROPERTY_LIST_BITSET_WORDS; i++) {
+        bitset->bits[i] = 0;
+    }
+    bitset->pList = pList;
+    bitset->extended = false;
+    if (pList) {
+        while (*pList != -1) {
+            if ((*pList >= 0) && (*pList <= PROP_RESERVED_RANGE_MAX)) {
+                bitset->bits[*pList / 32] |= (1UL << (*pList % 32));
+            } else {
+                bitset->extended = true;
+            }
+            pList++;
+        }
+    }
+    bitset->valid = true;
+}
+
+/**
+ * @brief For a given object property, returns the true if in the property
+ *  list of the bitset.  A bitset that is not yet valid is filled in from
+ *  its list first.
+ * @param bitset - the bitset of a property list
+ * @param object_property - property enumeration or propritary value
+ * @return true if object_property is a member of the property list
+ */
+bool property_list_bitset_member(
+    struct property_list_bitset_t *bitset, int32_t object_property)
+{
+    if (!bitset) {
+        return false;
+    }
+    if (!bitset->valid) {
+        property_list_bitset_init(bitset, bitset->pList);
+    }
+    if ((object_property >= 0) &&
+        (object_property <= PROP_RESERVED_RANGE_MAX)) {
+        return (bitset->bits[object_property / 32] &
+                (1UL << (object_property % 32))) != 0;
+    }
+    if (bitset->extended) {
+        return property_list_member(bitset->pList, object_property);
+    }
+
+    return false;
+}
+
 /**
  * @brief Determine if the object property is a member of any of the lists
  * @param pRequired - array of type 'int32_t' that is a list of BACnet
@@ -387,6 +449,9 @@ static const int32_t Properties_BACnetARRAY[] = {
 #endif
     -1
 };
+static struct property_list_bitset_t Properties_BACnetARRAY_Bitset = {
+    Properties_BACnetARRAY, false, false, { 0 }
+};
 
 /**
  * Function that returns the list of Required properties
@@ -447,7 +512,8 @@ bool property_list_bacnet_array_member(
         return true;
     }
 
-    return property_list_member(Properties_BACnetARRAY, object_property);
+    return property_list_bitset_member(
+        &Properties_BACnetARRAY_Bitset, object_property);
 }
 
 /* standard properties that are BACnetLIST */
@@ -496,6 +562,9 @@ static const int32_t Properties_BACnetLIST[] = {
     PROP_ADDITIONAL_REFERENCE_PORTS,
     -1
 };
+static struct property_list_bitset_t Properties_BACnetLIST_Bitset = {
+    Properties_BACnetLIST, false, false, { 0 }
+};
 
 /**
  * Returns the list of BACnetLIST properties of known standard objects.
@@ -546,7 +615,8 @@ bool property_list_bacnet_list_member(
         return true;
     }
 
-    return property_list_member(Properties_BACnetLIST, object_property);
+    return property_list_bitset_member(
+        &Properties_BACnetLIST_Bitset, object_property);
 }
 
 /**
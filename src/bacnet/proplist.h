@@ -20,10 +20,29 @@ struct property_list_t {
     uint32_t count;
 };
 
+/* one bit for each standard property identifier 0..511 */
+#define PROPERTY_LIST_BITSET_WORDS ((PROP_RESERVED_RANGE_MAX + 1) / 32)
+
+/**
+ * @brief Membership bitset of a '-1' terminated property list, so that
+ *  a membership test of a standard property is O(1).  The bitset is
+ *  filled in from the list on its first use.
+ */
+struct property_list_bitset_t {
+    const int32_t *pList;
+    bool valid : 1;
+    /* the list has members above the standard range */
+    bool extended : 1;
+    uint32_t bits[PROPERTY_LIST_BITSET_WORDS];
+};
+
 struct special_property_list_t {
     struct property_list_t Required;
     struct property_list_t Optional;
     struct property_list_t Proprietary;
+    /* Required, Optional, and Proprietary in one contiguous list,
+       or NULL if the device does not cache it */
+    struct property_list_t All;
 };
 
 #ifdef __cplusplus
@@ -35,6 +54,12 @@ uint32_t property_list_count(const int32_t *pList);
 BACNET_STACK_EXPORT
 bool property_list_member(const int32_t *pList, int32_t object_property);
 BACNET_STACK_EXPORT
+void property_list_bitset_init(
+    struct property_list_bitset_t *bitset, const int32_t *pList);
+BACNET_STACK_EXPORT
+bool property_list_bitset_member(
+    struct property_list_bitset_t *bitset, int32_t object_property);
+BACNET_STACK_EXPORT
 bool property_lists_member(
     const int32_t *pRequired,
     const int32_t *pOptional,
@@ -10,6 +10,7 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/apdu.h"
 #include "bacnet/bacdcode.h"
 #include "bacnet/readrange.h"
 
@@ -186,8 +187,10 @@ int rr_encode_apdu(
     int apdu_len = 0; /* total length of the apdu, return value */
 
     if (apdu) {
-        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
-        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST |
+            APDU_SEGMENTED_RESPONSE_ACCEPTED;
+        apdu[1] =
+            encode_max_segs_max_apdu(APDU_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_RANGE; /* service choice */
     }
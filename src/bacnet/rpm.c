@@ -12,6 +12,7 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/bacerror.h"
+#include "bacnet/apdu.h"
 #include "bacnet/bacdcode.h"
 #include "bacnet/bacapp.h"
 #include "bacnet/memcopy.h"
@@ -30,8 +31,10 @@
 int rpm_encode_apdu_init(uint8_t *apdu, uint8_t invoke_id)
 {
     if (apdu) {
-        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
-        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST |
+            APDU_SEGMENTED_RESPONSE_ACCEPTED;
+        apdu[1] =
+            encode_max_segs_max_apdu(APDU_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE; /* service choice */
     }
@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @brief BACnet SegmentACK PDU encoding and decoding
+ * @author Steve Karg <skarg@users.sourceforge.net>
+ * @date 2024
+ * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
+ */
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacenum.h"
+#include "bacnet/segmentack.h"
+
+/**
+ * @brief Encode the BACnet-SegmentACK-PDU, acknowledging the segments
+ *        received so far during a segmented transaction. See 20.1.6.
+ *
+ * @param apdu  Transmit buffer, or NULL for the length only
+ * @param negative_ack  True, if a segment was received out of order
+ * @param server  True, if the segment-ACK is sent by a server
+ * @param invoke_id  Original invoke ID of the transaction
+ * @param sequence_number  Sequence number of the last segment received
+ *        in order
+ * @param actual_window_size  Window size that the receiver requests for
+ *        the next segments, 1..127
+ *
+ * @return Total length of the apdu, typically 4
+ */
+int segmentack_encode_apdu(
+    uint8_t *apdu,
+    bool negative_ack,
+    bool server,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size)
+{
+    if (apdu) {
+        apdu[0] = PDU_TYPE_SEGMENT_ACK;
+        if (negative_ack) {
+            apdu[0] |= BIT(1);
+        }
+        if (server) {
+            apdu[0] |= BIT(0);
+        }
+        apdu[1] = invoke_id;
+        apdu[2] = sequence_number;
+        apdu[3] = actual_window_size;
+    }
+
+    return 4;
+}
+
+/**
+ * @brief Decode the BACnet-SegmentACK-PDU. See 20.1.6.
+ *
+ * @param apdu  Receive buffer, starting with the PDU type
+ * @param apdu_len  Count of bytes valid in the received buffer.
+ * @param negative_ack  Pointer to a variable, taking the NAK flag
+ * @param server  Pointer to a variable, taking the SRV flag
+ * @param invoke_id  Pointer to a variable, taking the original invoke ID
+ * @param sequence_number  Pointer to a variable, taking the sequence number
+ * @param actual_window_size  Pointer to a variable, taking the window size
+ *
+ * @return Total length of the apdu, 4 on success, zero otherwise.
+ */
+int segmentack_decode_apdu(
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    bool *negative_ack,
+    bool *server,
+    uint8_t *invoke_id,
+    uint8_t *sequence_number,
+    uint8_t *actual_window_size)
+{
+    if (!apdu || (apdu_len < 4)) {
+        return 0;
+    }
+    if ((apdu[0] & 0xF0) != PDU_TYPE_SEGMENT_ACK) {
+        return 0;
+    }
+    if (negative_ack) {
+        *negative_ack = (apdu[0] & BIT(1)) ? true : false;
+    }
+    if (server) {
+        *server = (apdu[0] & BIT(0)) ? true : false;
+    }
+    if (invoke_id) {
+        *invoke_id = apdu[1];
+    }
+    if (sequence_number) {
+        *sequence_number = apdu[2];
+    }
+    if (actual_window_size) {
+        *actual_window_size = apdu[3];
+    }
+
+    return 4;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief BACnet SegmentACK PDU encoding and decoding
+ * @author Steve Karg <skarg@users.sourceforge.net>
+ * @date 2024
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SEGMENTACK_H
+#define BACNET_SEGMENTACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+int segmentack_encode_apdu(
+    uint8_t *apdu,
+    bool negative_ack,
+    bool server,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size);
+
+BACNET_STACK_EXPORT
+int segmentack_decode_apdu(
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    bool *negative_ack,
+    bool *server,
+    uint8_t *invoke_id,
+    uint8_t *sequence_number,
+    uint8_t *actual_window_size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
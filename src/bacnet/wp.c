@@ -488,6 +488,60 @@ bool write_property_unsigned_decode(
     return status;
 }
 
+/**
+ * @brief Decode the value of a WriteProperty request when it is one
+ *  Boolean, Unsigned, Signed, Real, or Enumerated application value, without
+ *  decoding it into a BACNET_APPLICATION_DATA_VALUE
+ * @param wp_data - #BACNET_WRITE_PROPERTY_DATA data with the value
+ * @param value - the decoded value and its tag
+ * @return true if the whole value is one of those primitives
+ */
+bool write_property_primitive_decode(
+    const BACNET_WRITE_PROPERTY_DATA *wp_data,
+    BACNET_WRITE_PROPERTY_PRIMITIVE *value)
+{
+    const uint8_t *apdu;
+    uint32_t apdu_size;
+    int len = 0;
+
+    if (!wp_data || !value || (wp_data->application_data_len <= 0)) {
+        return false;
+    }
+    apdu = wp_data->application_data;
+    apdu_size = (uint32_t)wp_data->application_data_len;
+    if (IS_CONTEXT_SPECIFIC(apdu[0])) {
+        /* context tag, or an opening or closing tag */
+        return false;
+    }
+    value->tag = apdu[0] >> 4;
+    switch (value->tag) {
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            len = bacnet_boolean_application_decode(
+                apdu, apdu_size, &value->type.Boolean);
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            len = bacnet_unsigned_application_decode(
+                apdu, apdu_size, &value->type.Unsigned_Int);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            len = bacnet_signed_application_decode(
+                apdu, apdu_size, &value->type.Signed_Int);
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            len = bacnet_real_application_decode(
+                apdu, apdu_size, &value->type.Real);
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            len = bacnet_enumerated_application_decode(
+                apdu, apdu_size, &value->type.Enumerated);
+            break;
+        default:
+            break;
+    }
+
+    return (len > 0) && ((uint32_t)len == apdu_size);
+}
+
 /**
  * @brief Handler for a WriteProperty Service request when the
  *  property is a NULL type and the property is not commandable
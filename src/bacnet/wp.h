@@ -46,6 +46,36 @@ typedef struct BACnet_Write_Property_Data {
  */
 typedef bool (*write_property_function)(BACNET_WRITE_PROPERTY_DATA *wp_data);
 
+/**
+ * @brief One primitive value of a WriteProperty request, decoded straight
+ *  from its application tag without a BACNET_APPLICATION_DATA_VALUE
+ */
+typedef struct BACnet_Write_Property_Primitive {
+    uint8_t tag;
+    union {
+        bool Boolean;
+        BACNET_UNSIGNED_INTEGER Unsigned_Int;
+        int32_t Signed_Int;
+        float Real;
+        uint32_t Enumerated;
+    } type;
+} BACNET_WRITE_PROPERTY_PRIMITIVE;
+
+/**
+ * @brief Attempts to write a primitive value to one property of an object
+ *  instance, without the generic decode of a write_property_function
+ * @param wp_data [in] WriteProperty request, with space for the error
+ * @param value [in] the value of the request, decoded by
+ *  write_property_primitive_decode()
+ * @return 1 if the value was written, BACNET_STATUS_ERROR if the write
+ *  failed with the error in wp_data, or 0 if the property has no typed
+ *  setter or the value is not of its datatype, so the write_property_function
+ *  of the object does the write
+ */
+typedef int (*write_property_typed_function)(
+    BACNET_WRITE_PROPERTY_DATA *wp_data,
+    const BACNET_WRITE_PROPERTY_PRIMITIVE *value);
+
 /**
  * @brief API for setting a BACnet Unsigned Integer property value
  * @param object_instance [in] Object instance number
@@ -116,6 +146,11 @@ bool write_property_unsigned_decode(
     bacnet_property_unsigned_setter setter,
     BACNET_UNSIGNED_INTEGER maximum);
 
+BACNET_STACK_EXPORT
+bool write_property_primitive_decode(
+    const BACNET_WRITE_PROPERTY_DATA *wp_data,
+    BACNET_WRITE_PROPERTY_PRIMITIVE *value);
+
 BACNET_STACK_EXPORT
 bool write_property_relinquish_bypass(
     BACNET_WRITE_PROPERTY_DATA *wp_data,
@@ -154,6 +154,84 @@ static void test_bacnet_audit_log_notification(void)
     zassert_equal(test_len, apdu_len, NULL);
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacnet_audit_tests, test_bacnet_audit_notification_service)
+#else
+static void test_bacnet_audit_notification_service(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_AUDIT_NOTIFICATION value[3] = { 0 }, test_value[3] = { 0 };
+    int apdu_len = 0, null_len = 0, test_len = 0;
+    unsigned index = 0, count = 0;
+
+    for (index = 0; index < 3; index++) {
+        value[index].source_device.tag = BACNET_RECIPIENT_TAG_DEVICE;
+        value[index].source_device.type.device.type = OBJECT_DEVICE;
+        value[index].source_device.type.device.instance = 1234;
+        value[index].operation = AUDIT_OPERATION_WRITE;
+        value[index].target_device.tag = BACNET_RECIPIENT_TAG_DEVICE;
+        value[index].target_device.type.device.type = OBJECT_DEVICE;
+        value[index].target_device.type.device.instance = 5678 + index;
+    }
+    null_len = bacnet_audit_notification_service_encode(NULL, value, 3);
+    apdu_len = bacnet_audit_notification_service_encode(apdu, value, 3);
+    zassert_true(apdu_len > 0, NULL);
+    zassert_equal(apdu_len, null_len, NULL);
+    test_len = bacnet_audit_notification_service_decode(
+        apdu, apdu_len, test_value, 3, &count);
+    zassert_equal(apdu_len, test_len, NULL);
+    zassert_equal(count, 3, NULL);
+    for (index = 0; index < 3; index++) {
+        zassert_true(
+            bacnet_audit_log_notification_same(
+                &value[index], &test_value[index]),
+            NULL);
+    }
+    /* notifications beyond the array are counted only */
+    memset(test_value, 0, sizeof(test_value));
+    test_len = bacnet_audit_notification_service_decode(
+        apdu, apdu_len, test_value, 1, &count);
+    zassert_equal(apdu_len, test_len, NULL);
+    zassert_equal(count, 3, NULL);
+    zassert_true(
+        bacnet_audit_log_notification_same(&value[0], &test_value[0]), NULL);
+    zassert_equal(test_value[1].target_device.type.device.instance, 0, NULL);
+    test_len = bacnet_audit_notification_service_decode(
+        apdu, apdu_len, NULL, 0, &count);
+    zassert_equal(apdu_len, test_len, NULL);
+    /* decoding, some negative tests */
+    test_len = bacnet_audit_notification_service_decode(
+        apdu, apdu_len - 1, test_value, 3, &count);
+    zassert_equal(test_len, BACNET_STATUS_ERROR, NULL);
+    test_len = bacnet_audit_notification_service_decode(
+        NULL, apdu_len, test_value, 3, &count);
+    zassert_equal(test_len, BACNET_STATUS_ERROR, NULL);
+    apdu_len = bacnet_audit_notification_service_encode(apdu, value, 0);
+    zassert_equal(apdu_len, 0, NULL);
+    /* the service APDU headers */
+    null_len =
+        bacnet_audit_notification_confirmed_encode_apdu(NULL, 1, value, 3);
+    apdu_len =
+        bacnet_audit_notification_confirmed_encode_apdu(apdu, 1, value, 3);
+    zassert_equal(apdu_len, null_len, NULL);
+    zassert_equal(apdu[0], PDU_TYPE_CONFIRMED_SERVICE_REQUEST, NULL);
+    zassert_equal(apdu[3], SERVICE_CONFIRMED_AUDIT_NOTIFICATION, NULL);
+    test_len = bacnet_audit_notification_service_decode(
+        &apdu[4], apdu_len - 4, test_value, 3, &count);
+    zassert_equal(apdu_len - 4, test_len, NULL);
+    null_len =
+        bacnet_audit_notification_unconfirmed_encode_apdu(NULL, value, 3);
+    apdu_len =
+        bacnet_audit_notification_unconfirmed_encode_apdu(apdu, value, 3);
+    zassert_equal(apdu_len, null_len, NULL);
+    zassert_equal(apdu[0], PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST, NULL);
+    zassert_equal(apdu[1], SERVICE_UNCONFIRMED_AUDIT_NOTIFICATION, NULL);
+    test_len = bacnet_audit_notification_service_decode(
+        &apdu[2], apdu_len - 2, test_value, 3, &count);
+    zassert_equal(apdu_len - 2, test_len, NULL);
+}
+
 uint8_t Test_APDU[MAX_APDU];
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(bacnet_audit_tests, test_bacnet_audit_log_record)
@@ -252,6 +330,7 @@ void test_main(void)
     ztest_test_suite(
         bacnet_audit_tests, ztest_unit_test(test_bacnet_audit_log_record),
         ztest_unit_test(test_bacnet_audit_log_notification),
+        ztest_unit_test(test_bacnet_audit_notification_service),
         ztest_unit_test(test_bacnet_audit_value));
 
     ztest_run_test_suite(bacnet_audit_tests);
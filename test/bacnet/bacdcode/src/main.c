@@ -1996,6 +1996,232 @@ static void test_bacnet_array_encode(void)
     zassert_true(apdu_len == BACNET_STATUS_ABORT, NULL);
 }
 
+/**
+ * @brief Encode one of ten BACnetARRAY elements for the stream test
+ * @param object_instance [in] object instance number
+ * @param index [in] element index, 0 to 9
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ * @return The length of the apdu encoded or BACNET_STATUS_ERROR
+ */
+static int bacnet_stream_element_encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX index, uint8_t *apdu)
+{
+    if (index >= 10) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_object_id(
+        apdu, OBJECT_ANALOG_INPUT, object_instance + index);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacdcode_tests, test_bacnet_array_stream)
+#else
+static void test_bacnet_array_stream(void)
+#endif
+{
+    BACNET_ARRAY_STREAM stream = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t instance = 0;
+    uint8_t apdu[64] = { 0 };
+    BACNET_ARRAY_INDEX index;
+    int apdu_len, len;
+
+    /* every element fits */
+    bacnet_array_stream_begin(&stream, apdu, sizeof(apdu));
+    for (index = 0; index < 10; index++) {
+        zassert_true(
+            bacnet_array_stream_next(
+                &stream, bacnet_stream_element_encode, 100, index),
+            NULL);
+    }
+    apdu_len = bacnet_array_stream_end(&stream);
+    zassert_equal(apdu_len, 50, NULL);
+    zassert_equal(stream.count, 10, NULL);
+    len = bacnet_object_id_application_decode(
+        &apdu[45], apdu_len - 45, &object_type, &instance);
+    zassert_equal(len, 5, NULL);
+    zassert_equal(object_type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(instance, 109, NULL);
+    /* a size query stops at the first element that does not fit */
+    bacnet_array_stream_begin(&stream, NULL, 12);
+    for (index = 0; index < 10; index++) {
+        if (!bacnet_array_stream_next(
+                &stream, bacnet_stream_element_encode, 100, index)) {
+            break;
+        }
+    }
+    zassert_equal(index, 2, NULL);
+    zassert_equal(stream.count, 2, NULL);
+    zassert_equal(stream.apdu_len, 10, NULL);
+    zassert_equal(bacnet_array_stream_end(&stream), BACNET_STATUS_ABORT, NULL);
+    /* the stream stays stopped */
+    zassert_false(
+        bacnet_array_stream_next(&stream, bacnet_stream_element_encode, 100, 0),
+        NULL);
+    /* an element that fails to encode */
+    bacnet_array_stream_begin(&stream, apdu, sizeof(apdu));
+    zassert_false(
+        bacnet_array_stream_next(
+            &stream, bacnet_stream_element_encode, 100, 10),
+        NULL);
+    zassert_equal(bacnet_array_stream_end(&stream), BACNET_STATUS_ERROR, NULL);
+    zassert_equal(bacnet_array_stream_end(NULL), BACNET_STATUS_ERROR, NULL);
+    /* the array encoder streams the whole array */
+    apdu_len = bacnet_array_encode(
+        100, BACNET_ARRAY_ALL, bacnet_stream_element_encode, 10, apdu,
+        sizeof(apdu));
+    zassert_equal(apdu_len, 50, NULL);
+    apdu_len = bacnet_array_encode(
+        100, BACNET_ARRAY_ALL, bacnet_stream_element_encode, 10, apdu, 49);
+    zassert_equal(apdu_len, BACNET_STATUS_ABORT, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacdcode_tests, test_bacnet_decode_cursor)
+#else
+static void test_bacnet_decode_cursor(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_DECODE_CURSOR cursor = { 0 };
+    BACNET_APPLICATION_DATA_VIEW value = { 0 };
+    BACNET_CHARACTER_STRING char_string = { 0 };
+    int apdu_len = 0;
+    int len = 0;
+
+    apdu_len += encode_application_real(&apdu[apdu_len], 3.14159F);
+    apdu_len += encode_application_unsigned(&apdu[apdu_len], 0x12345678);
+    apdu_len += encode_application_boolean(&apdu[apdu_len], true);
+    zassert_true(characterstring_init_ansi(&char_string, "Bob"), NULL);
+    apdu_len +=
+        encode_application_character_string(&apdu[apdu_len], &char_string);
+    apdu_len += encode_opening_tag(&apdu[apdu_len], 3);
+    apdu_len += encode_context_enumerated(&apdu[apdu_len], 1, 42);
+    apdu_len += encode_closing_tag(&apdu[apdu_len], 3);
+    apdu_len += encode_application_object_id(&apdu[apdu_len], OBJECT_DEVICE, 7);
+    bacnet_decode_cursor_init(&cursor, apdu, apdu_len);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 5, NULL);
+    zassert_true(value.tag.application, NULL);
+    zassert_equal(value.tag.number, BACNET_APPLICATION_TAG_REAL, NULL);
+    zassert_false(islessgreater(value.type.Real, 3.14159F), NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 5, NULL);
+    zassert_equal(value.tag.number, BACNET_APPLICATION_TAG_UNSIGNED_INT, NULL);
+    zassert_equal(value.type.Unsigned_Int, 0x12345678, NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 1, NULL);
+    zassert_equal(value.tag.number, BACNET_APPLICATION_TAG_BOOLEAN, NULL);
+    zassert_true(value.type.Boolean, NULL);
+    zassert_equal(value.data_len, 0, NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 5, NULL);
+    zassert_equal(
+        value.tag.number, BACNET_APPLICATION_TAG_CHARACTER_STRING, NULL);
+    zassert_equal(value.type.Character_Set, CHARACTER_ANSI_X34, NULL);
+    zassert_equal(value.data_len, 3, NULL);
+    zassert_equal(memcmp(value.data, "Bob", 3), 0, NULL);
+    /* the string is a view into the buffer, not a copy */
+    zassert_true(value.data > apdu, NULL);
+    zassert_true(value.data < &apdu[apdu_len], NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 1, NULL);
+    zassert_true(value.tag.opening, NULL);
+    zassert_equal(value.tag.number, 3, NULL);
+    zassert_equal(value.data, NULL, NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 2, NULL);
+    zassert_true(value.tag.context, NULL);
+    zassert_equal(value.tag.number, 1, NULL);
+    zassert_equal(value.data_len, 1, NULL);
+    zassert_equal(value.data[0], 42, NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 1, NULL);
+    zassert_true(value.tag.closing, NULL);
+    zassert_false(bacnet_decode_cursor_end(&cursor), NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 5, NULL);
+    zassert_equal(value.tag.number, BACNET_APPLICATION_TAG_OBJECT_ID, NULL);
+    zassert_equal(value.type.Object_Id.type, OBJECT_DEVICE, NULL);
+    zassert_equal(value.type.Object_Id.instance, 7, NULL);
+    zassert_true(bacnet_decode_cursor_end(&cursor), NULL);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, 0, NULL);
+    /* truncated value */
+    bacnet_decode_cursor_init(&cursor, apdu, 3);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+    /* malformed length for the type */
+    apdu[0] = 0x43; /* application REAL with length 3 */
+    bacnet_decode_cursor_init(&cursor, apdu, 4);
+    len = bacnet_decode_cursor_next(&cursor, &value);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+    len = bacnet_decode_cursor_next(NULL, &value);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacdcode_tests, test_bacnet_tag_decode_octets)
+#else
+static void test_bacnet_tag_decode_octets(void)
+#endif
+{
+    static const uint8_t second_octets[] = { 0, 1, 4, 5, 253, 254, 255 };
+    static const uint32_t apdu_sizes[] = { 1, 2, 3, 7 };
+    uint8_t apdu[7] = { 0, 0, 0, 0, 1, 0, 0 };
+    BACNET_TAG tag = { 0 };
+    uint8_t tag_number = 0;
+    uint32_t value = 0;
+    unsigned octet, i, j;
+    int len, test_len;
+
+    /* every initial octet against the deprecated decoder and the macros */
+    for (octet = 0; octet <= 255; octet++) {
+        for (i = 0; i < ARRAY_SIZE(second_octets); i++) {
+            apdu[0] = (uint8_t)octet;
+            apdu[1] = second_octets[i];
+            test_len = decode_tag_number_and_value(apdu, &tag_number, &value);
+            for (j = 0; j < ARRAY_SIZE(apdu_sizes); j++) {
+                len = bacnet_tag_decode(apdu, apdu_sizes[j], &tag);
+                if ((uint32_t)test_len > apdu_sizes[j]) {
+                    zassert_equal(len, 0, "octet=0x%02X", octet);
+                    continue;
+                }
+                zassert_equal(len, test_len, "octet=0x%02X", octet);
+                zassert_equal(tag.number, tag_number, "octet=0x%02X", octet);
+                zassert_equal(
+                    tag.len_value_type, value, "octet=0x%02X", octet);
+                zassert_equal(
+                    tag.application, !IS_CONTEXT_SPECIFIC(octet), NULL);
+                zassert_equal(
+                    tag.opening,
+                    IS_CONTEXT_SPECIFIC(octet) && IS_OPENING_TAG(octet), NULL);
+                zassert_equal(
+                    tag.closing,
+                    IS_CONTEXT_SPECIFIC(octet) && IS_CLOSING_TAG(octet), NULL);
+                zassert_equal(
+                    tag.context,
+                    IS_CONTEXT_SPECIFIC(octet) && !IS_OPENING_TAG(octet) &&
+                        !IS_CLOSING_TAG(octet),
+                    NULL);
+            }
+        }
+    }
+    len = bacnet_tag_decode(NULL, sizeof(apdu), &tag);
+    zassert_equal(len, 0, NULL);
+    len = bacnet_tag_decode(apdu, 0, &tag);
+    zassert_equal(len, 0, NULL);
+    /* the tag number is returned by the deprecated wrapper */
+    apdu[0] = 0x29; /* context tag 2, length 1 */
+    tag_number = 0;
+    len = bacnet_tag_number_and_value_decode(
+        apdu, sizeof(apdu), &tag_number, &value);
+    zassert_equal(len, 1, NULL);
+    zassert_equal(tag_number, 2, NULL);
+    zassert_equal(value, 1, NULL);
+}
+
 /**
  * @}
  */
@@ -2035,7 +2261,10 @@ void test_main(void)
         ztest_unit_test(testDateRangeContextDecodes),
         ztest_unit_test(testOctetStringContextDecodes),
         ztest_unit_test(testBACDCodeDouble),
-        ztest_unit_test(test_bacnet_array_encode));
+        ztest_unit_test(test_bacnet_array_encode),
+        ztest_unit_test(test_bacnet_array_stream),
+        ztest_unit_test(test_bacnet_decode_cursor),
+        ztest_unit_test(test_bacnet_tag_decode_octets));
 
     ztest_run_test_suite(bacdcode_tests);
 }
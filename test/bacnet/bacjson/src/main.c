@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief test streaming JSON writer of BACnet values
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <math.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/bacjson.h>
+#include <bacnet/datetime.h>
+#include <bacnet/rpm.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static char Test_Text[512];
+static BACNET_JSON_BUFFER Test_Buffer;
+static BACNET_JSON_WRITER Test_Writer;
+
+/**
+ * @brief Start a new JSON text in the test buffer
+ * @return the writer of the test buffer
+ */
+static BACNET_JSON_WRITER *test_writer(void)
+{
+    Test_Buffer.buffer = Test_Text;
+    Test_Buffer.size = sizeof(Test_Text);
+    Test_Buffer.length = 0;
+    Test_Text[0] = 0;
+    bacjson_writer_init(&Test_Writer, bacjson_buffer_sink, &Test_Buffer);
+
+    return &Test_Writer;
+}
+
+/**
+ * @brief Write a value in a new JSON text, and compare it
+ * @param property - property of the value
+ * @param value - value to write
+ * @param json - expected JSON text
+ */
+static void test_value(
+    BACNET_PROPERTY_ID property,
+    const BACNET_APPLICATION_DATA_VALUE *value,
+    const char *json)
+{
+    BACNET_JSON_WRITER *writer = test_writer();
+
+    zassert_true(
+        bacjson_write_value(writer, OBJECT_ANALOG_INPUT, property, value),
+        NULL);
+    zassert_equal(strcmp(Test_Text, json), 0, "%s", Test_Text);
+    zassert_equal(Test_Writer.length, strlen(json), NULL);
+}
+
+/**
+ * @brief Test the JSON form of the application data values
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacjson_tests, testJsonValue)
+#else
+static void testJsonValue(void)
+#endif
+{
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_APPLICATION_DATA_VALUE next = { 0 };
+    const uint8_t octets[] = { 0x01, 0xAB };
+
+    value.tag = BACNET_APPLICATION_TAG_NULL;
+    test_value(PROP_PRESENT_VALUE, &value, "null");
+    value.tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    value.type.Boolean = true;
+    test_value(PROP_OUT_OF_SERVICE, &value, "true");
+    value.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    value.type.Unsigned_Int = 4294967295UL;
+    test_value(PROP_PRESENT_VALUE, &value, "4294967295");
+    value.type.Unsigned_Int = 0;
+    test_value(PROP_PRESENT_VALUE, &value, "0");
+    value.tag = BACNET_APPLICATION_TAG_SIGNED_INT;
+    value.type.Signed_Int = INT32_MIN;
+    test_value(PROP_PRESENT_VALUE, &value, "-2147483648");
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    value.type.Real = 72.5f;
+    test_value(PROP_PRESENT_VALUE, &value, "72.5");
+    value.type.Real = nanf("");
+    test_value(PROP_PRESENT_VALUE, &value, "null");
+    value.tag = BACNET_APPLICATION_TAG_CHARACTER_STRING;
+    characterstring_init_ansi(&value.type.Character_String, "a\"b\\c\n");
+    test_value(PROP_OBJECT_NAME, &value, "\"a\\\"b\\\\c\\u000a\"");
+    value.tag = BACNET_APPLICATION_TAG_OCTET_STRING;
+    octetstring_init(&value.type.Octet_String, octets, sizeof(octets));
+    test_value(PROP_PRESENT_VALUE, &value, "\"01ab\"");
+    value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value.type.Bit_String);
+    bitstring_set_bit(&value.type.Bit_String, 0, true);
+    bitstring_set_bit(&value.type.Bit_String, 2, true);
+    test_value(PROP_STATUS_FLAGS, &value, "[true,false,true]");
+    value.tag = BACNET_APPLICATION_TAG_ENUMERATED;
+    value.type.Enumerated = UNITS_DEGREES_FAHRENHEIT;
+    test_value(PROP_UNITS, &value, "\"degrees-fahrenheit\"");
+    test_value(PROP_NOTIFY_TYPE, &value, "64");
+    value.tag = BACNET_APPLICATION_TAG_OBJECT_ID;
+    value.type.Object_Id.type = OBJECT_ANALOG_INPUT;
+    value.type.Object_Id.instance = 1;
+    test_value(
+        PROP_OBJECT_IDENTIFIER, &value,
+        "{\"type\":\"analog-input\",\"instance\":1}");
+    value.tag = BACNET_APPLICATION_TAG_DATE;
+    datetime_set_date(&value.type.Date, 2024, 5, 1);
+    test_value(PROP_LOCAL_DATE, &value, "\"2024-05-01\"");
+    datetime_wildcard_year_set(&value.type.Date);
+    test_value(PROP_LOCAL_DATE, &value, "\"*-05-01\"");
+    value.tag = BACNET_APPLICATION_TAG_TIME;
+    datetime_set_time(&value.type.Time, 13, 5, 9, 7);
+    test_value(PROP_LOCAL_TIME, &value, "\"13:05:09.07\"");
+    /* a list of values is an array */
+    value.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    value.type.Unsigned_Int = 1;
+    value.next = &next;
+    next.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    next.type.Unsigned_Int = 2;
+    test_value(PROP_PRESENT_VALUE, &value, "[1,2]");
+    test_value(PROP_PRESENT_VALUE, NULL, "null");
+}
+
+/**
+ * @brief Test writing encoded property values, and a full sink
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacjson_tests, testJsonPropertyValue)
+#else
+static void testJsonPropertyValue(void)
+#endif
+{
+    BACNET_JSON_WRITER *writer;
+    BACNET_JSON_BUFFER buffer = { 0 };
+    BACNET_JSON_WRITER small = { 0 };
+    uint8_t apdu[32];
+    char text[4];
+    int len;
+
+    len = encode_application_unsigned(&apdu[0], 1);
+    writer = test_writer();
+    zassert_true(
+        bacjson_write_property_value(
+            writer, OBJECT_DEVICE, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL, apdu,
+            len),
+        NULL);
+    zassert_equal(strcmp(Test_Text, "1"), 0, "%s", Test_Text);
+    len += encode_application_unsigned(&apdu[len], 2);
+    writer = test_writer();
+    zassert_true(
+        bacjson_write_property_value(
+            writer, OBJECT_DEVICE, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL, apdu,
+            len),
+        NULL);
+    zassert_equal(strcmp(Test_Text, "[1,2]"), 0, "%s", Test_Text);
+    writer = test_writer();
+    zassert_true(
+        bacjson_write_property_value(
+            writer, OBJECT_DEVICE, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL, apdu,
+            0),
+        NULL);
+    zassert_equal(strcmp(Test_Text, "[]"), 0, "%s", Test_Text);
+    /* a full sink stops the writer */
+    buffer.buffer = text;
+    buffer.size = sizeof(text);
+    bacjson_writer_init(&small, bacjson_buffer_sink, &buffer);
+    zassert_true(bacjson_write(&small, "[1"), NULL);
+    zassert_false(bacjson_write(&small, ",2]"), NULL);
+    zassert_true(small.error, NULL);
+    zassert_false(bacjson_write(&small, "]"), NULL);
+    zassert_equal(strcmp(text, "[1"), 0, NULL);
+    zassert_equal(small.length, 2, NULL);
+}
+
+/**
+ * @brief Test writing a ReadPropertyMultiple-ACK
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacjson_tests, testJsonRpmAck)
+#else
+static void testJsonRpmAck(void)
+#endif
+{
+    BACNET_RPM_DATA rpmdata = { 0 };
+    uint8_t apdu[128];
+    uint8_t value[16];
+    int apdu_len = 0, len;
+    const char *json =
+        "[{\"object-type\":\"analog-input\",\"object-instance\":1,"
+        "\"properties\":["
+        "{\"property\":\"present-value\",\"value\":72.5},"
+        "{\"property\":\"units\",\"value\":\"degrees-fahrenheit\"},"
+        "{\"property\":\"priority-array\",\"index\":1,"
+        "\"error-class\":\"property\",\"error-code\":\"unknown-property\"}"
+        "]},"
+        "{\"object-type\":\"device\",\"object-instance\":2,"
+        "\"properties\":[]}]";
+
+    rpmdata.object_type = OBJECT_ANALOG_INPUT;
+    rpmdata.object_instance = 1;
+    apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
+    apdu_len += rpm_ack_encode_apdu_object_property(
+        &apdu[apdu_len], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    len = encode_application_real(value, 72.5f);
+    apdu_len +=
+        rpm_ack_encode_apdu_object_property_value(&apdu[apdu_len], value, len);
+    apdu_len += rpm_ack_encode_apdu_object_property(
+        &apdu[apdu_len], PROP_UNITS, BACNET_ARRAY_ALL);
+    len = encode_application_enumerated(value, UNITS_DEGREES_FAHRENHEIT);
+    apdu_len +=
+        rpm_ack_encode_apdu_object_property_value(&apdu[apdu_len], value, len);
+    apdu_len += rpm_ack_encode_apdu_object_property(
+        &apdu[apdu_len], PROP_PRIORITY_ARRAY, 1);
+    apdu_len += rpm_ack_encode_apdu_object_property_error(
+        &apdu[apdu_len], ERROR_CLASS_PROPERTY, ERROR_CODE_UNKNOWN_PROPERTY);
+    apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+    rpmdata.object_type = OBJECT_DEVICE;
+    rpmdata.object_instance = 2;
+    apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
+    apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+    zassert_true(
+        bacjson_write_rpm_ack(test_writer(), apdu, apdu_len), "%s", Test_Text);
+    zassert_equal(strcmp(Test_Text, json), 0, "%s", Test_Text);
+    /* a truncated ACK is malformed */
+    zassert_false(
+        bacjson_write_rpm_ack(test_writer(), apdu, apdu_len - 8), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(bacjson_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        bacjson_tests, ztest_unit_test(testJsonValue),
+        ztest_unit_test(testJsonPropertyValue),
+        ztest_unit_test(testJsonRpmAck));
+
+    ztest_run_test_suite(bacjson_tests);
+}
+#endif
@@ -828,6 +828,62 @@ static void test_bacnet_snprintf(void)
     zassert_equal(null_len, test_null_len, "null_len=%d", null_len);
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacstr_tests, test_utf8_isvalid)
+#else
+static void test_utf8_isvalid(void)
+#endif
+{
+    /* long enough for the word at a time checks on each side */
+    char str[64] = { 0 };
+    BACNET_CHARACTER_STRING name1 = { 0 }, name2 = { 0 };
+    size_t i, length = 40;
+
+    memset(str, 'A', length);
+    zassert_true(utf8_isvalid(str, length), NULL);
+    zassert_true(utf8_isvalid(str, 0), NULL);
+    zassert_false(utf8_isvalid(NULL, 1), NULL);
+    for (i = 0; i < length; i++) {
+        /* null in the middle of the string, at each position */
+        str[i] = 0;
+        zassert_false(utf8_isvalid(str, length), "i=%u", (unsigned)i);
+        /* a lone continuation byte */
+        str[i] = (char)0x80;
+        zassert_false(utf8_isvalid(str, length), "i=%u", (unsigned)i);
+        /* a two byte sequence, without its trailing byte */
+        str[i] = (char)0xC3;
+        zassert_false(utf8_isvalid(str, length), "i=%u", (unsigned)i);
+        if ((i + 1) < length) {
+            str[i + 1] = (char)0xA9;
+            zassert_true(utf8_isvalid(str, length), "i=%u", (unsigned)i);
+            str[i + 1] = 'A';
+        }
+        /* an overlong two byte sequence */
+        str[i] = (char)0xC0;
+        zassert_false(utf8_isvalid(str, length), "i=%u", (unsigned)i);
+        str[i] = 'A';
+    }
+    /* a three byte sequence with a truncated last byte */
+    str[length - 2] = (char)0xE2;
+    str[length - 1] = (char)0x82;
+    zassert_false(utf8_isvalid(str, length), NULL);
+    zassert_true(utf8_isvalid(str, length - 2), NULL);
+    /* comparison of names that differ in the first and last bytes */
+    zassert_true(characterstring_init_ansi(&name1, "ANALOG INPUT 0001"), NULL);
+    zassert_true(characterstring_init_ansi(&name2, "ANALOG INPUT 0001"), NULL);
+    zassert_true(characterstring_same(&name1, &name2), NULL);
+    zassert_true(characterstring_ansi_same(&name1, "ANALOG INPUT 0001"), NULL);
+    zassert_false(characterstring_ansi_same(&name1, "ANALOG INPUT 0002"), NULL);
+    name2.value[name2.length - 1] = '2';
+    zassert_false(characterstring_same(&name1, &name2), NULL);
+    name2.value[name2.length - 1] = '1';
+    name2.value[0] = 'B';
+    zassert_false(characterstring_same(&name1, &name2), NULL);
+    zassert_true(characterstring_init_ansi(&name1, ""), NULL);
+    zassert_true(characterstring_init_ansi(&name2, ""), NULL);
+    zassert_true(characterstring_same(&name1, &name2), NULL);
+}
+
 /**
  * @}
  */
@@ -847,7 +903,8 @@ void test_main(void)
         ztest_unit_test(test_bacnet_string_to_x),
         ztest_unit_test(test_bacnet_string_trim),
         ztest_unit_test(test_bacnet_stptok),
-        ztest_unit_test(test_bacnet_snprintf));
+        ztest_unit_test(test_bacnet_snprintf),
+        ztest_unit_test(test_utf8_isvalid));
     ztest_run_test_suite(bacstr_tests);
 }
 #endif
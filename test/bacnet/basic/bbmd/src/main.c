@@ -36,6 +36,7 @@ static uint8_t Test_Sent_Message_Length;
 static uint8_t Test_Sent_Message_Buffer[MAX_APDU];
 static uint16_t Test_Sent_Message_Buffer_Length;
 static BACNET_IP_ADDRESS Test_Sent_Message_Dest;
+static unsigned Test_Sent_Message_Count;
 
 /* network stub functions */
 /**
@@ -82,6 +83,7 @@ int bip_send_mpdu(
     Test_Sent_Message_Type = message_type;
     Test_Sent_Message_Length = message_length;
     bvlc_address_copy(&Test_Sent_Message_Dest, dest);
+    Test_Sent_Message_Count++;
     if ((header_len == 4) && (mtu_len >= 4)) {
         memcpy(&Test_Sent_Message_Buffer[0], &mtu[4], mtu_len - 4);
         Test_Sent_Message_Buffer_Length = mtu_len - 4;
@@ -123,6 +125,18 @@ bool bip_get_broadcast_addr(BACNET_IP_ADDRESS *addr)
     return bvlc_address_copy(addr, &IUT.BIP_Broadcast_Addr);
 }
 
+/* milliseconds of the test clock */
+static unsigned long Test_Milliseconds;
+
+/**
+ * @brief Get the time of the test clock
+ * @return milliseconds of the test clock
+ */
+unsigned long mstimer_now(void)
+{
+    return Test_Milliseconds;
+}
+
 static void test_setup(void)
 {
     bvlc_init();
@@ -227,11 +241,171 @@ static void test_BBMD_Result(void)
     }
 }
 
+/**
+ * @brief Test the Forwarded-NPDU fan-out to the FDT and BDT
+ */
+static void test_BBMD_Forward_List(void)
+{
+    BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY bdt_entry = { 0 };
+    BACNET_IP_BROADCAST_DISTRIBUTION_MASK mask = { 0 };
+    BACNET_IP_ADDRESS fd_addr[2] = { 0 };
+    BACNET_IP_ADDRESS peer_addr = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t npdu[4] = { 0x01, 0x00, 0x10, 0x08 };
+    uint8_t mtu[MAX_APDU] = { 0 };
+    uint16_t mtu_len = 0;
+    unsigned i = 0;
+
+    test_setup();
+    bvlc_bdt_list_clear();
+    /* the BDT has the IUT and one peer BBMD */
+    bvlc_broadcast_distribution_mask_from_host(&mask, 0xFFFFFFFFL);
+    bvlc_broadcast_distribution_table_entry_set(
+        &bdt_entry, &IUT.BIP_Addr, &mask);
+    bvlc_broadcast_distribution_table_entry_append(bvlc_bdt_list(), &bdt_entry);
+    bvlc_address_set(&peer_addr, 10, 0, 0, 1);
+    peer_addr.port = 0xBAC0;
+    bvlc_broadcast_distribution_table_entry_set(&bdt_entry, &peer_addr, &mask);
+    bvlc_broadcast_distribution_table_entry_append(bvlc_bdt_list(), &bdt_entry);
+    /* two foreign devices register */
+    for (i = 0; i < 2; i++) {
+        bvlc_address_set(&fd_addr[i], 192, 168, 2 + i, 1);
+        fd_addr[i].port = 0xBAC0;
+        mtu_len = bvlc_encode_register_foreign_device(mtu, sizeof(mtu), 60);
+        bvlc_bbmd_enabled_handler(&fd_addr[i], &src, mtu, mtu_len);
+        assert(Test_Sent_Message_Type == BVLC_RESULT);
+    }
+    /* the first foreign device asks for a broadcast */
+    mtu_len = bvlc_encode_distribute_broadcast_to_network(
+        mtu, sizeof(mtu), npdu, sizeof(npdu));
+    Test_Sent_Message_Count = 0;
+    bvlc_bbmd_enabled_handler(&fd_addr[0], &src, mtu, mtu_len);
+    /* local broadcast, the other foreign device, and the peer BBMD */
+    assert(Test_Sent_Message_Count == 3);
+    assert(Test_Sent_Message_Type == BVLC_FORWARDED_NPDU);
+    assert(!bvlc_address_different(&Test_Sent_Message_Dest, &peer_addr));
+    /* the second foreign device is deleted from the FDT */
+    mtu_len =
+        bvlc_encode_delete_foreign_device(mtu, sizeof(mtu), &fd_addr[1]);
+    bvlc_bbmd_enabled_handler(&peer_addr, &src, mtu, mtu_len);
+    mtu_len = bvlc_encode_distribute_broadcast_to_network(
+        mtu, sizeof(mtu), npdu, sizeof(npdu));
+    Test_Sent_Message_Count = 0;
+    bvlc_bbmd_enabled_handler(&fd_addr[0], &src, mtu, mtu_len);
+    assert(Test_Sent_Message_Count == 2);
+    /* the BDT is cleared */
+    bvlc_bdt_list_clear();
+    Test_Sent_Message_Count = 0;
+    bvlc_bbmd_enabled_handler(&fd_addr[0], &src, mtu, mtu_len);
+    assert(Test_Sent_Message_Count == 1);
+    test_cleanup();
+}
+
+/**
+ * @brief Test the Foreign-Device-Table registration and expiry
+ */
+static void test_BBMD_FDT_Expiry(void)
+{
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_list = NULL;
+    BACNET_IP_ADDRESS fd_addr[3] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t mtu[MAX_APDU] = { 0 };
+    uint16_t mtu_len = 0;
+    unsigned i = 0;
+
+    bvlc_foreign_device_table_valid_clear(bvlc_fdt_list());
+    test_setup();
+    /* register foreign devices with different TTL */
+    for (i = 0; i < 3; i++) {
+        bvlc_address_set(&fd_addr[i], 192, 168, 4, 1 + i);
+        fd_addr[i].port = 0xBAC0;
+        mtu_len = bvlc_encode_register_foreign_device(
+            mtu, sizeof(mtu), 10 + (i * 100));
+        bvlc_bbmd_enabled_handler(&fd_addr[i], &src, mtu, mtu_len);
+    }
+    fdt_list = bvlc_fdt_list();
+    assert(bvlc_foreign_device_table_valid_count(fdt_list) == 3);
+    /* TTL plus the 30 second grace period */
+    bvlc_maintenance_timer(39);
+    fdt_list = bvlc_fdt_list();
+    assert(bvlc_foreign_device_table_valid_count(fdt_list) == 3);
+    for (i = 0; i < 3; i++) {
+        if (!bvlc_address_different(&fdt_list[i].dest_address, &fd_addr[0])) {
+            assert(fdt_list[i].ttl_seconds_remaining == 1);
+        }
+    }
+    bvlc_maintenance_timer(1);
+    fdt_list = bvlc_fdt_list();
+    assert(bvlc_foreign_device_table_valid_count(fdt_list) == 2);
+    /* re-registration restarts the timer */
+    mtu_len = bvlc_encode_register_foreign_device(mtu, sizeof(mtu), 10);
+    bvlc_bbmd_enabled_handler(&fd_addr[1], &src, mtu, mtu_len);
+    for (i = 0; i < 100; i++) {
+        bvlc_maintenance_timer(1);
+    }
+    fdt_list = bvlc_fdt_list();
+    assert(bvlc_foreign_device_table_valid_count(fdt_list) == 1);
+    /* elapsed time longer than the timing wheel */
+    bvlc_maintenance_timer(1000);
+    fdt_list = bvlc_fdt_list();
+    assert(bvlc_foreign_device_table_valid_count(fdt_list) == 0);
+    test_cleanup();
+}
+
+/**
+ * @brief Test that a broadcast that reaches the BBMD twice is given to
+ *  the network layer once
+ */
+static void test_BBMD_Duplicate_Filter(void)
+{
+    BACNET_IP_ADDRESS device_addr = { 0 };
+    BACNET_IP_ADDRESS peer_addr = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t npdu[4] = { 0x01, 0x00, 0x10, 0x08 };
+    uint8_t mtu[MAX_APDU] = { 0 };
+    uint16_t mtu_len = 0;
+    int offset = 0;
+
+    test_setup();
+    bvlc_bdt_list_clear();
+    bvlc_address_set(&device_addr, 192, 168, 0, 10);
+    device_addr.port = 0xBAC0;
+    bvlc_address_set(&peer_addr, 10, 0, 0, 1);
+    peer_addr.port = 0xBAC0;
+    Test_Milliseconds = 100000;
+    mtu_len =
+        bvlc_encode_original_broadcast(mtu, sizeof(mtu), npdu, sizeof(npdu));
+    offset = bvlc_bbmd_enabled_handler(&device_addr, &src, mtu, mtu_len);
+    assert(offset > 0);
+    /* the same broadcast forwarded back by a peer BBMD */
+    Test_Milliseconds += 10;
+    mtu_len = bvlc_encode_forwarded_npdu(
+        mtu, sizeof(mtu), &device_addr, npdu, sizeof(npdu));
+    offset = bvlc_bbmd_enabled_handler(&peer_addr, &src, mtu, mtu_len);
+    assert(offset == 0);
+    /* another broadcast of the same device */
+    npdu[3] = 0x09;
+    offset = bvlc_bbmd_enabled_handler(
+        &device_addr, &src, mtu,
+        bvlc_encode_original_broadcast(mtu, sizeof(mtu), npdu, sizeof(npdu)));
+    assert(offset > 0);
+    /* the same broadcast again, after the window */
+    Test_Milliseconds += 2000;
+    mtu_len = bvlc_encode_forwarded_npdu(
+        mtu, sizeof(mtu), &device_addr, npdu, sizeof(npdu));
+    offset = bvlc_bbmd_enabled_handler(&peer_addr, &src, mtu, mtu_len);
+    assert(offset > 0);
+    test_cleanup();
+}
+
 int main(void)
 {
     /* individual tests */
     test_BBMD_Result();
     test_Initiate_Original_Broadcast_NPDU();
+    test_BBMD_Forward_List();
+    test_BBMD_FDT_Expiry();
+    test_BBMD_Duplicate_Filter();
 
     return 0;
 }
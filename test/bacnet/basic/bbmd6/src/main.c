@@ -41,6 +41,7 @@ static uint8_t Test_Sent_Message_Length;
 static uint8_t Test_Sent_Message_Buffer[MAX_MPDU];
 static uint16_t Test_Sent_Message_Buffer_Length;
 static BACNET_IP6_ADDRESS Test_Sent_Message_Dest;
+static unsigned Test_Sent_Message_Count;
 
 /* network stub functions */
 /**
@@ -84,6 +85,7 @@ int bip6_send_mpdu(
 
     header_len =
         bvlc6_decode_header(mtu, mtu_len, &message_type, &message_length);
+    Test_Sent_Message_Count++;
     Test_Sent_Message_Type = message_type;
     Test_Sent_Message_Length = message_length;
     bvlc6_address_copy(&Test_Sent_Message_Dest, dest);
@@ -285,6 +287,62 @@ static void test_Execute_Virtual_Address_Resolution(void)
     test_cleanup();
 }
 
+/**
+ * @brief Test the VMAC table lookup by VMAC address
+ */
+static void test_VMAC_Find_By_Data(void)
+{
+    struct vmac_data vmac = { 0 };
+    uint32_t device_id = 0;
+    uint32_t test_device_id = 0;
+    unsigned int i = 0;
+    bool status = false;
+
+    VMAC_Init();
+    vmac.mac_len = VMAC_MAC_MAX;
+    for (device_id = 1; device_id <= 1500; device_id++) {
+        for (i = 0; i < 4; i++) {
+            vmac.mac[VMAC_MAC_MAX - 1 - i] = (uint8_t)(device_id >> (i * 8));
+        }
+        status = VMAC_Add(device_id, &vmac);
+        assert(status);
+    }
+    assert(VMAC_Count() == 1500);
+    for (device_id = 1; device_id <= 1500; device_id++) {
+        for (i = 0; i < 4; i++) {
+            vmac.mac[VMAC_MAC_MAX - 1 - i] = (uint8_t)(device_id >> (i * 8));
+        }
+        status = VMAC_Find_By_Data(&vmac, &test_device_id);
+        assert(status);
+        assert(test_device_id == device_id);
+        if ((device_id % 2) == 0) {
+            status = VMAC_Delete(device_id);
+            assert(status);
+        }
+    }
+    for (device_id = 1; device_id <= 1500; device_id++) {
+        for (i = 0; i < 4; i++) {
+            vmac.mac[VMAC_MAC_MAX - 1 - i] = (uint8_t)(device_id >> (i * 8));
+        }
+        status = VMAC_Find_By_Data(&vmac, &test_device_id);
+        if (device_id % 2) {
+            assert(status);
+            assert(test_device_id == device_id);
+        } else {
+            assert(!status);
+        }
+    }
+    /* an empty VMAC address never matches */
+    vmac.mac_len = 0;
+    status = VMAC_Find_By_Data(&vmac, &test_device_id);
+    assert(!status);
+    VMAC_Cleanup();
+    assert(VMAC_Count() == 0);
+    vmac.mac_len = VMAC_MAC_MAX;
+    status = VMAC_Find_By_Data(&vmac, &test_device_id);
+    assert(!status);
+}
+
 static void test_BBMD_Result(void)
 {
     int result = 0;
@@ -323,9 +381,152 @@ static void test_BBMD_Result(void)
     }
 }
 
+/**
+ * @brief Test foreign device registration, renewal, expiry and deletion
+ */
+static void test_BBMD_Foreign_Device(void)
+{
+    uint8_t mtu[MAX_MPDU] = { 0 };
+    uint16_t mtu_len = 0;
+    uint16_t result_code = 0;
+    uint32_t vmac_src = 0;
+    int function_len = 0;
+    int result = 0;
+
+    test_setup();
+    mtu_len = bvlc6_encode_register_foreign_device(
+        &mtu[0], sizeof(mtu), TD.Device_ID, 60);
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(result == 0);
+    assert(Test_Sent_Message_Type == BVLC6_RESULT);
+    function_len = bvlc6_decode_result(
+        Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length, &vmac_src,
+        &result_code);
+    assert(function_len > 0);
+    assert(result_code == BVLC6_RESULT_SUCCESSFUL_COMPLETION);
+    assert(bvlc6_fdt_count() == 1);
+    /* renewal keeps one entry */
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(bvlc6_fdt_count() == 1);
+    /* the entry lives for the TTL plus 30 seconds */
+    bvlc6_maintenance_timer(60);
+    assert(bvlc6_fdt_count() == 1);
+    bvlc6_maintenance_timer(30);
+    assert(bvlc6_fdt_count() == 0);
+    /* delete */
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(bvlc6_fdt_count() == 1);
+    mtu_len = bvlc6_encode_delete_foreign_device(
+        &mtu[0], sizeof(mtu), TD.Device_ID, &TD.BIP6_Addr);
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(result == 0);
+    function_len = bvlc6_decode_result(
+        Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length, &vmac_src,
+        &result_code);
+    assert(function_len > 0);
+    assert(result_code == BVLC6_RESULT_SUCCESSFUL_COMPLETION);
+    assert(bvlc6_fdt_count() == 0);
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    function_len = bvlc6_decode_result(
+        Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length, &vmac_src,
+        &result_code);
+    assert(function_len > 0);
+    assert(result_code == BVLC6_RESULT_DELETE_FOREIGN_DEVICE_NAK);
+    test_cleanup();
+}
+
+/**
+ * @brief Test the Forwarded-NPDU destinations of a broadcast from a
+ *  foreign device
+ */
+static void test_BBMD_Distribute_Broadcast(void)
+{
+    uint8_t mtu[MAX_MPDU] = { 0 };
+    uint8_t pdu[MAX_MPDU] = { 0 };
+    uint16_t mtu_len = 0;
+    uint16_t result_code = 0;
+    uint32_t vmac_src = 0;
+    BACNET_IP6_ADDRESS addr = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int pdu_len = 0;
+    int result = 0;
+    uint16_t i = 0;
+
+    test_setup();
+    dest.net = BACNET_BROADCAST_NETWORK;
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(&pdu[0], &dest, NULL, &npdu_data);
+    pdu_len += iam_encode_apdu(
+        &pdu[pdu_len], TD.Device_ID, MAX_APDU, SEGMENTATION_NONE,
+        BACNET_VENDOR_ID);
+    mtu_len = bvlc6_encode_distribute_broadcast_to_network(
+        &mtu[0], sizeof(mtu), TD.Device_ID, &pdu[0], pdu_len);
+    /* only registered foreign devices may distribute */
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(result == 0);
+    assert(Test_Sent_Message_Type == BVLC6_RESULT);
+    bvlc6_decode_result(
+        Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length, &vmac_src,
+        &result_code);
+    assert(result_code == BVLC6_RESULT_DISTRIBUTE_BROADCAST_TO_NETWORK_NAK);
+    /* three peer BBMDs, and my own entry which is never sent to */
+    for (i = 1; i <= 3; i++) {
+        bvlc6_address_set(
+            &addr, 0x2001, 0x0DBB, 0xAC20, i, 0, 0, 1,
+            BIP6_MULTICAST_GROUP_ID);
+        assert(bvlc6_bdt_entry_add(&addr));
+    }
+    assert(bvlc6_bdt_entry_add(&IUT.BIP6_Addr));
+    assert(bvlc6_bdt_entry_add(&addr));
+    /* three foreign devices, one of them the originator */
+    mtu_len = bvlc6_encode_register_foreign_device(
+        &mtu[0], sizeof(mtu), TD.Device_ID, 60);
+    bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    for (i = 1; i <= 2; i++) {
+        bvlc6_address_set(
+            &addr, 0x2001, 0x0DBB, 0xAC30, i, 0, 0, 1,
+            BIP6_MULTICAST_GROUP_ID);
+        bvlc6_bbmd_enabled_handler(
+            &addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    }
+    assert(bvlc6_fdt_count() == 3);
+    mtu_len = bvlc6_encode_distribute_broadcast_to_network(
+        &mtu[0], sizeof(mtu), TD.Device_ID, &pdu[0], pdu_len);
+    Test_Sent_Message_Count = 0;
+    result = bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    /* the broadcast is also for me */
+    assert(result > 0);
+    assert(Test_Sent_Message_Type == BVLC6_FORWARDED_NPDU);
+    /* multicast, three peer BBMDs, and two other foreign devices */
+    assert(Test_Sent_Message_Count == 6);
+    /* a foreign device is not in the BDT */
+    assert(bvlc6_bdt_entry_delete(&addr) == false);
+    /* a deleted peer BBMD is no longer sent to */
+    bvlc6_address_set(
+        &addr, 0x2001, 0x0DBB, 0xAC20, 3, 0, 0, 1, BIP6_MULTICAST_GROUP_ID);
+    assert(bvlc6_bdt_entry_delete(&addr));
+    Test_Sent_Message_Count = 0;
+    bvlc6_bbmd_enabled_handler(
+        &TD.BIP6_Addr, &TD.BACnet_Address, &mtu[0], mtu_len);
+    assert(Test_Sent_Message_Count == 5);
+    test_cleanup();
+}
+
 int main(void)
 {
     test_BBMD_Result();
+    test_BBMD_Foreign_Device();
+    test_BBMD_Distribute_Broadcast();
+    test_VMAC_Find_By_Data();
     test_Execute_Virtual_Address_Resolution();
     test_Initiate_Original_Broadcast_NPDU();
 
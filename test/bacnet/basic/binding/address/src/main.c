@@ -155,6 +155,7 @@ static void testAddress(void)
     BACNET_ADDRESS test_address;
     uint32_t test_device_id = 0;
     unsigned test_max_apdu = 0;
+    unsigned long hits = 0, misses = 0, test_hits = 0, test_misses = 0;
 
     /* create a fake address database */
     for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
@@ -164,6 +165,7 @@ static void testAddress(void)
         count = address_count();
         zassert_equal(count, (i + 1), NULL);
     }
+    address_cache_lookups(&hits, &misses);
 
     for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
         device_id = i * 255;
@@ -186,6 +188,10 @@ static void testAddress(void)
         zassert_true(address_get_device_id(&src, &test_device_id), NULL);
         zassert_equal(test_device_id, device_id, NULL);
     }
+    /* every lookup by device id and by MAC was a hit */
+    address_cache_lookups(&test_hits, &test_misses);
+    zassert_equal(test_hits - hits, 2 * MAX_ADDRESS_CACHE, NULL);
+    zassert_equal(test_misses, misses, NULL);
 
     for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
         device_id = i * 255;
@@ -196,7 +202,196 @@ static void testAddress(void)
         count = address_count();
         zassert_equal(count, (MAX_ADDRESS_CACHE - i - 1), NULL);
     }
+    address_cache_lookups(NULL, &test_misses);
+    zassert_equal(test_misses - misses, MAX_ADDRESS_CACHE, NULL);
 }
+/**
+ * @brief Test the expiry of the address cache entries
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressTTL)
+#else
+static void testAddressTTL(void)
+#endif
+{
+    unsigned i, count, base;
+    BACNET_ADDRESS src;
+    uint32_t device_id = 0;
+    uint32_t device_ttl = 0;
+    unsigned max_apdu = 480;
+    BACNET_ADDRESS test_address;
+    unsigned test_max_apdu = 0;
+    bool status;
+
+    address_init();
+    /* the address cache file may have added static entries */
+    base = address_count();
+    for (i = 0; i < 10; i++) {
+        set_address(i, &src);
+        device_id = 1000 + i;
+        address_add(device_id, max_apdu, &src);
+        /* each entry expires one second after the previous entry */
+        address_set_device_TTL(device_id, 10 + i, false);
+    }
+    /* a static entry never expires */
+    address_set_device_TTL(1009, 0, true);
+    zassert_equal(address_count(), base + 10, NULL);
+    status = address_device_bind_request(
+        1009, &device_ttl, &test_max_apdu, &test_address);
+    zassert_true(status, NULL);
+    zassert_equal(device_ttl, UINT32_MAX, NULL);
+    address_cache_timer(5);
+    zassert_equal(address_count(), base + 10, NULL);
+    status = address_device_bind_request(
+        1003, &device_ttl, &test_max_apdu, &test_address);
+    zassert_true(status, NULL);
+    zassert_equal(device_ttl, 8, NULL);
+    /* an entry expires when the time elapsed is more than its TTL */
+    address_cache_timer(5);
+    zassert_equal(address_count(), base + 10, NULL);
+    address_cache_timer(1);
+    zassert_equal(address_count(), base + 9, NULL);
+    zassert_false(
+        address_get_by_device(1000, &test_max_apdu, &test_address), NULL);
+    set_address(0, &src);
+    zassert_false(address_get_device_id(&src, &device_id), NULL);
+    zassert_true(
+        address_get_by_device(1001, &test_max_apdu, &test_address), NULL);
+    address_cache_timer(4);
+    count = address_count();
+    zassert_equal(count, base + 5, "count=%u", count);
+    /* renew an entry */
+    set_address(5, &src);
+    address_add(1005, max_apdu, &src);
+    address_cache_timer(60);
+    zassert_equal(address_count(), base + 2, NULL);
+    zassert_true(
+        address_get_by_device(1005, &test_max_apdu, &test_address), NULL);
+    zassert_true(
+        address_get_by_device(1009, &test_max_apdu, &test_address), NULL);
+    /* renewed entries have a long time to live */
+    address_cache_timer(UINT16_MAX);
+    zassert_equal(address_count(), base + 2, NULL);
+    address_cache_timer(UINT16_MAX);
+    zassert_equal(address_count(), base + 1, NULL);
+    address_remove_device(1009);
+    zassert_equal(address_count(), base, NULL);
+}
+
+/**
+ * @brief Test that each address context has its own bindings
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressContext)
+#else
+static void testAddressContext(void)
+#endif
+{
+    ADDRESS_CONTEXT *context, *previous;
+    BACNET_ADDRESS src, test_address;
+    unsigned max_apdu = 480, test_max_apdu = 0, base;
+
+    address_init();
+    base = address_count();
+    set_address(1, &src);
+    address_add(2001, max_apdu, &src);
+    context = address_context_create();
+    zassert_not_null(context, NULL);
+    previous = address_context_select(context);
+    zassert_equal(address_count(), 0, NULL);
+    zassert_false(
+        address_get_by_device(2001, &test_max_apdu, &test_address), NULL);
+    set_address(2, &src);
+    address_add(2002, max_apdu, &src);
+    zassert_equal(address_count(), 1, NULL);
+    zassert_equal(address_context_select(previous), context, NULL);
+    zassert_equal(address_count(), base + 1, NULL);
+    zassert_false(
+        address_get_by_device(2002, &test_max_apdu, &test_address), NULL);
+    zassert_true(
+        address_get_by_device(2001, &test_max_apdu, &test_address), NULL);
+    address_context_delete(context);
+    address_remove_device(2001);
+    zassert_equal(address_count(), base, NULL);
+}
+
+#ifdef BACNET_ADDRESS_CACHE_FILE
+/**
+ * @brief Test the binary snapshot of the bound entries
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressSnapshot)
+#else
+static void testAddressSnapshot(void)
+#endif
+{
+    const char *pathname = "address_cache.bin";
+    BACNET_ADDRESS src, test_address;
+    unsigned max_apdu = 480, test_max_apdu = 0, i, base;
+    uint32_t device_ttl = 0;
+    bool status;
+
+    address_init();
+    base = address_count();
+    for (i = 0; i < 4; i++) {
+        set_address(i, &src);
+        address_add(3000 + i, max_apdu + i, &src);
+    }
+    address_set_device_TTL(3000, 100, false);
+    address_set_device_TTL(3001, 0, true);
+    /* unbound entries are not saved */
+    zassert_false(
+        address_bind_request(3100, &test_max_apdu, &test_address), NULL);
+    zassert_true(address_cache_save(pathname), NULL);
+    address_init();
+    zassert_equal(address_count(), base, NULL);
+    zassert_true(address_cache_restore(pathname), NULL);
+    zassert_equal(address_count(), base + 4, NULL);
+    for (i = 0; i < 4; i++) {
+        set_address(i, &src);
+        zassert_true(
+            address_get_by_device(3000 + i, &test_max_apdu, &test_address),
+            NULL);
+        zassert_equal(test_max_apdu, max_apdu + i, NULL);
+        zassert_true(bacnet_address_same(&test_address, &src), NULL);
+    }
+    /* the restored entries keep their time to live */
+    status = address_device_bind_request(
+        3000, &device_ttl, &test_max_apdu, &test_address);
+    zassert_true(status, NULL);
+    zassert_true(device_ttl <= 100, NULL);
+    zassert_true(device_ttl >= 90, NULL);
+    status = address_device_bind_request(
+        3001, &device_ttl, &test_max_apdu, &test_address);
+    zassert_true(status, NULL);
+    zassert_equal(device_ttl, UINT32_MAX, NULL);
+    zassert_false(
+        address_get_by_device(3100, &test_max_apdu, &test_address), NULL);
+    /* bound entries are kept when restoring */
+    set_address(9, &src);
+    address_add(3002, max_apdu, &src);
+    zassert_true(address_cache_restore(pathname), NULL);
+    zassert_equal(address_count(), base + 4, NULL);
+    zassert_true(
+        address_get_by_device(3002, &test_max_apdu, &test_address), NULL);
+    zassert_true(bacnet_address_same(&test_address, &src), NULL);
+    /* saved by the timer after a change */
+    remove(pathname);
+    address_cache_snapshot_set(pathname, 10);
+    address_cache_timer(10);
+    zassert_true(address_cache_restore(pathname), NULL);
+    address_cache_snapshot_set(NULL, 0);
+    /* a missing or invalid file is not restored */
+    remove(pathname);
+    zassert_false(address_cache_restore(pathname), NULL);
+    zassert_false(address_cache_restore(Address_Cache_Filename), NULL);
+    for (i = 0; i < 4; i++) {
+        address_remove_device(3000 + i);
+    }
+    zassert_equal(address_count(), base, NULL);
+}
+#endif
+
 /**
  * @}
  */
@@ -209,11 +404,15 @@ void test_main(void)
 #ifdef BACNET_ADDRESS_CACHE_FILE
     ztest_test_suite(
         address_tests, ztest_unit_test(testAddressFile),
-        ztest_unit_test(testAddress));
+        ztest_unit_test(testAddress), ztest_unit_test(testAddressTTL),
+        ztest_unit_test(testAddressContext),
+        ztest_unit_test(testAddressSnapshot));
 
     ztest_run_test_suite(address_tests);
 #else
-    ztest_test_suite(address_tests, ztest_unit_test(testAddress));
+    ztest_test_suite(
+        address_tests, ztest_unit_test(testAddress),
+        ztest_unit_test(testAddressTTL), ztest_unit_test(testAddressContext));
 
     ztest_run_test_suite(address_tests);
 #endif
@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief test BACnet device capability cache API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/bacstr.h>
+#include <bacnet/basic/binding/capability.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test the capabilities learned from I-Am and aborts
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(capability_tests, testCapabilityIAm)
+#else
+static void testCapabilityIAm(void)
+#endif
+{
+    int segmentation = 0;
+    uint16_t vendor_id = 0;
+
+    capability_init();
+    zassert_equal(capability_count(), 0, NULL);
+    zassert_equal(capability_max_apdu(1234), 0, NULL);
+    zassert_false(capability_segmentation(1234, &segmentation), NULL);
+    zassert_true(
+        capability_service_supported(
+            1234, SERVICE_SUPPORTED_READ_PROP_MULTIPLE),
+        NULL);
+    capability_iam_set(1234, 480, SEGMENTATION_BOTH, 260);
+    zassert_equal(capability_count(), 1, NULL);
+    zassert_equal(capability_max_apdu(1234), 480, NULL);
+    zassert_true(capability_segmentation(1234, &segmentation), NULL);
+    zassert_equal(segmentation, SEGMENTATION_BOTH, NULL);
+    zassert_true(capability_vendor_id(1234, &vendor_id), NULL);
+    zassert_equal(vendor_id, 260, NULL);
+    /* a reply that does not fit halves the limit of the device */
+    capability_abort(
+        1234, SERVICE_SUPPORTED_READ_PROP_MULTIPLE,
+        ABORT_REASON_SEGMENTATION_NOT_SUPPORTED);
+    zassert_equal(capability_max_apdu(1234), 240, NULL);
+    zassert_true(capability_segmentation(1234, &segmentation), NULL);
+    zassert_equal(segmentation, SEGMENTATION_NONE, NULL);
+    capability_abort(
+        1234, SERVICE_SUPPORTED_READ_PROP_MULTIPLE,
+        ABORT_REASON_BUFFER_OVERFLOW);
+    zassert_equal(capability_max_apdu(1234), 120, NULL);
+    capability_abort(
+        1234, SERVICE_SUPPORTED_READ_PROP_MULTIPLE,
+        ABORT_REASON_APDU_TOO_LONG);
+    capability_abort(
+        1234, SERVICE_SUPPORTED_READ_PROP_MULTIPLE,
+        ABORT_REASON_APDU_TOO_LONG);
+    zassert_equal(capability_max_apdu(1234), 50, NULL);
+    /* other aborts say nothing about the size */
+    capability_abort(
+        1234, SERVICE_SUPPORTED_READ_PROPERTY, ABORT_REASON_OTHER);
+    zassert_equal(capability_max_apdu(1234), 50, NULL);
+    /* a new I-Am with another max APDU is learned again */
+    capability_iam_set(1234, 1476, SEGMENTATION_NONE, 260);
+    zassert_equal(capability_max_apdu(1234), 1476, NULL);
+    capability_remove_device(1234);
+    zassert_equal(capability_count(), 0, NULL);
+    zassert_equal(capability_max_apdu(1234), 0, NULL);
+}
+
+/**
+ * @brief Test the services learned from Protocol_Services_Supported
+ *  and rejects
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(capability_tests, testCapabilityServices)
+#else
+static void testCapabilityServices(void)
+#endif
+{
+    BACNET_BIT_STRING services = { 0 };
+
+    capability_init();
+    /* a rejected service is not requested again */
+    capability_reject(
+        100, SERVICE_SUPPORTED_SUBSCRIBE_COV, REJECT_REASON_OTHER);
+    zassert_true(
+        capability_service_supported(100, SERVICE_SUPPORTED_SUBSCRIBE_COV),
+        NULL);
+    capability_reject(
+        100, SERVICE_SUPPORTED_SUBSCRIBE_COV,
+        REJECT_REASON_UNRECOGNIZED_SERVICE);
+    zassert_false(
+        capability_service_supported(100, SERVICE_SUPPORTED_SUBSCRIBE_COV),
+        NULL);
+    zassert_true(
+        capability_service_supported(100, SERVICE_SUPPORTED_READ_PROPERTY),
+        NULL);
+    /* the services list names what the device executes */
+    bitstring_init(&services);
+    bitstring_set_bit(&services, SERVICE_SUPPORTED_READ_PROPERTY, true);
+    bitstring_set_bit(&services, SERVICE_SUPPORTED_SUBSCRIBE_COV, true);
+    bitstring_set_bit(&services, SERVICE_SUPPORTED_WRITE_PROPERTY, false);
+    bitstring_set_bit(&services, SERVICE_SUPPORTED_READ_PROP_MULTIPLE, false);
+    capability_services_set(100, &services);
+    zassert_true(
+        capability_service_supported(100, SERVICE_SUPPORTED_SUBSCRIBE_COV),
+        NULL);
+    zassert_false(
+        capability_service_supported(
+            100, SERVICE_SUPPORTED_READ_PROP_MULTIPLE),
+        NULL);
+    zassert_false(
+        capability_service_supported(100, SERVICE_SUPPORTED_WRITE_PROPERTY),
+        NULL);
+    zassert_true(
+        capability_service_supported(100, SERVICE_SUPPORTED_READ_PROPERTY),
+        NULL);
+    /* other devices are not affected */
+    zassert_true(
+        capability_service_supported(
+            101, SERVICE_SUPPORTED_READ_PROP_MULTIPLE),
+        NULL);
+    capability_service_denied(101, SERVICE_SUPPORTED_READ_PROP_MULTIPLE);
+    zassert_false(
+        capability_service_supported(
+            101, SERVICE_SUPPORTED_READ_PROP_MULTIPLE),
+        NULL);
+    zassert_equal(capability_count(), 2, NULL);
+}
+
+/**
+ * @brief Test that a full cache replaces the device learned longest ago
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(capability_tests, testCapabilityFull)
+#else
+static void testCapabilityFull(void)
+#endif
+{
+    uint32_t device_id;
+
+    capability_init();
+    for (device_id = 0; device_id < MAX_CAPABILITY_CACHE; device_id++) {
+        capability_iam_set(device_id, 480, SEGMENTATION_NONE, 1);
+    }
+    zassert_equal(capability_count(), MAX_CAPABILITY_CACHE, NULL);
+    /* learning the first device again makes it the newest */
+    capability_iam_set(0, 1476, SEGMENTATION_NONE, 1);
+    capability_iam_set(MAX_CAPABILITY_CACHE, 206, SEGMENTATION_NONE, 1);
+    zassert_equal(capability_count(), MAX_CAPABILITY_CACHE, NULL);
+    zassert_equal(capability_max_apdu(0), 1476, NULL);
+    zassert_equal(capability_max_apdu(1), 0, NULL);
+    zassert_equal(capability_max_apdu(2), 480, NULL);
+    zassert_equal(capability_max_apdu(MAX_CAPABILITY_CACHE), 206, NULL);
+    capability_init();
+    zassert_equal(capability_count(), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(capability_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        capability_tests, ztest_unit_test(testCapabilityIAm),
+        ztest_unit_test(testCapabilityServices),
+        ztest_unit_test(testCapabilityFull));
+
+    ztest_run_test_suite(capability_tests);
+}
+#endif
@@ -151,8 +151,30 @@ static void test_Execute_Virtual_Address_Resolution(void)
     assert(test_device_id == TD.Device_ID);
     status = BZLL_VMAC_Same(&TD.VMAC_Data, &test_vmac_data);
     assert(status == true);
+    status = BZLL_VMAC_Entry_To_Device_ID(&TD.VMAC_Data, &test_device_id);
+    assert(status == true);
+    assert(test_device_id == TD.Device_ID);
     status = BZLL_VMAC_Add(IUT.Device_ID, &IUT.VMAC_Data);
     assert(status == true);
+    status = BZLL_VMAC_Entry_To_Device_ID(&IUT.VMAC_Data, &test_device_id);
+    assert(status == true);
+    assert(test_device_id == IUT.Device_ID);
+    /* change the MAC of a Device ID */
+    status = BZLL_VMAC_Add(IUT.Device_ID, &TD.VMAC_Data);
+    assert(status == true);
+    count = BZLL_VMAC_Count();
+    assert(count == 1);
+    status = BZLL_VMAC_Entry_To_Device_ID(&IUT.VMAC_Data, &test_device_id);
+    assert(status == false);
+    status = BZLL_VMAC_Entry_To_Device_ID(&TD.VMAC_Data, &test_device_id);
+    assert(status == true);
+    assert(test_device_id == IUT.Device_ID);
+    status = BZLL_VMAC_Add(IUT.Device_ID, &IUT.VMAC_Data);
+    assert(status == true);
+    status = BZLL_VMAC_Add(TD.Device_ID, &TD.VMAC_Data);
+    assert(status == true);
+    count = BZLL_VMAC_Count();
+    assert(count == 2);
     count = BZLL_VMAC_Count();
     for (index = 0; index < count; index++) {
         status = BZLL_VMAC_Entry_By_Index(index, &test_vmac_src, NULL);
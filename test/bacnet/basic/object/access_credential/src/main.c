@@ -5,6 +5,7 @@
  * @date 2015
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <limits.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/access_credential.h>
 
@@ -70,6 +71,260 @@ static void testAccessCredential(void)
 
     return;
 }
+
+/**
+ * @brief Test the authentication factor index
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(access_credential_tests, testAccessCredentialFactorFind)
+#else
+static void testAccessCredentialFactorFind(void)
+#endif
+{
+    BACNET_CREDENTIAL_AUTHENTICATION_FACTOR factor = { 0 };
+    BACNET_AUTHENTICATION_FACTOR presented = { 0 };
+    uint8_t badge[2] = { 0 };
+    uint32_t instance = 0, test_instance = 0;
+    unsigned i = 0, index = 0;
+    bool status = false;
+
+    Access_Credential_Init();
+    factor.disable = ACCESS_AUTHENTICATION_FACTOR_DISABLE_NONE;
+    factor.authentication_factor.format_type =
+        AUTHENTICATION_FACTOR_SIMPLE_NUMBER16;
+    /* give every credential two badge numbers */
+    for (i = 0; i < MAX_ACCESS_CREDENTIALS; i++) {
+        instance = Access_Credential_Index_To_Instance(i);
+        badge[0] = 0x10;
+        badge[1] = (uint8_t)i;
+        octetstring_init(
+            &factor.authentication_factor.value, badge, sizeof(badge));
+        status =
+            Access_Credential_Authentication_Factor_Set(instance, 0, &factor);
+        zassert_true(status, NULL);
+        factor.authentication_factor.value.value[0] = 0x20;
+        status =
+            Access_Credential_Authentication_Factor_Set(instance, 1, &factor);
+        zassert_true(status, NULL);
+    }
+    /* only the next free element may be appended */
+    status = Access_Credential_Authentication_Factor_Set(instance, 3, &factor);
+    zassert_false(status, NULL);
+    presented = factor.authentication_factor;
+    presented.value.value[0] = 0x20;
+    presented.value.value[1] = 1;
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, &test_instance, &index);
+    zassert_true(status, NULL);
+    zassert_equal(test_instance, Access_Credential_Index_To_Instance(1), NULL);
+    zassert_equal(index, 1, NULL);
+    /* the format is part of the key */
+    presented.format_type = AUTHENTICATION_FACTOR_SIMPLE_NUMBER32;
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, &test_instance, &index);
+    zassert_false(status, NULL);
+    presented.format_type = AUTHENTICATION_FACTOR_SIMPLE_NUMBER16;
+    /* removing the first element moves the second one down */
+    instance = Access_Credential_Index_To_Instance(1);
+    status = Access_Credential_Authentication_Factor_Remove(instance, 0);
+    zassert_true(status, NULL);
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, &test_instance, &index);
+    zassert_true(status, NULL);
+    zassert_equal(test_instance, instance, NULL);
+    zassert_equal(index, 0, NULL);
+    presented.value.value[0] = 0x10;
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, &test_instance, &index);
+    zassert_false(status, NULL);
+    /* replacing an element drops the old value from the index */
+    factor.authentication_factor.value.value[0] = 0x30;
+    factor.authentication_factor.value.value[1] = 1;
+    status = Access_Credential_Authentication_Factor_Set(instance, 0, &factor);
+    zassert_true(status, NULL);
+    presented.value.value[0] = 0x20;
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, NULL, NULL);
+    zassert_false(status, NULL);
+    presented.value.value[0] = 0x30;
+    status = Access_Credential_Authentication_Factor_Find(
+        &presented, &test_instance, NULL);
+    zassert_true(status, NULL);
+    zassert_equal(test_instance, instance, NULL);
+    status = Access_Credential_Authentication_Factor_Remove(instance, 1);
+    zassert_false(status, NULL);
+}
+/**
+ * @brief Make a distinct badge number authentication factor
+ * @param factor [out] credential authentication factor
+ * @param high [in] first octet of the badge number
+ * @param low [in] second octet of the badge number
+ */
+static void test_factor_init(
+    BACNET_CREDENTIAL_AUTHENTICATION_FACTOR *factor,
+    uint8_t high,
+    uint8_t low)
+{
+    uint8_t badge[2];
+
+    badge[0] = high;
+    badge[1] = low;
+    factor->disable = ACCESS_AUTHENTICATION_FACTOR_DISABLE_NONE;
+    factor->authentication_factor.format_type =
+        AUTHENTICATION_FACTOR_SIMPLE_NUMBER16;
+    factor->authentication_factor.format_class = 0;
+    octetstring_init(
+        &factor->authentication_factor.value, badge, sizeof(badge));
+}
+
+/**
+ * @brief Check that a factor is found in the given credential and element
+ */
+static void test_factor_found(
+    uint8_t high, uint8_t low, uint32_t instance, unsigned index)
+{
+    BACNET_CREDENTIAL_AUTHENTICATION_FACTOR factor = { 0 };
+    uint32_t test_instance = UINT32_MAX;
+    unsigned test_index = UINT_MAX;
+    bool status;
+
+    test_factor_init(&factor, high, low);
+    status = Access_Credential_Authentication_Factor_Find(
+        &factor.authentication_factor, &test_instance, &test_index);
+    zassert_true(status, "%02X%02X", high, low);
+    zassert_equal(test_instance, instance, "%02X%02X", high, low);
+    zassert_equal(test_index, index, "%02X%02X", high, low);
+}
+
+/**
+ * @brief Check that no credential holds a factor
+ */
+static void test_factor_not_found(uint8_t high, uint8_t low)
+{
+    BACNET_CREDENTIAL_AUTHENTICATION_FACTOR factor = { 0 };
+
+    test_factor_init(&factor, high, low);
+    zassert_false(
+        Access_Credential_Authentication_Factor_Find(
+            &factor.authentication_factor, NULL, NULL),
+        "%02X%02X", high, low);
+}
+
+/**
+ * @brief Test set, replace, remove from the middle, and find with every
+ *  factor slot in use, so that the factors share the hash chains, and
+ *  with the same factor held by two credentials
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(access_credential_tests, testAccessCredentialFactorChains)
+#else
+static void testAccessCredentialFactorChains(void)
+#endif
+{
+    BACNET_CREDENTIAL_AUTHENTICATION_FACTOR factor = { 0 };
+    uint32_t instance = 0, test_instance = 0;
+    unsigned i = 0, j = 0, index = 0;
+    bool status = false;
+
+    Access_Credential_Init();
+    /* start from credentials without factors */
+    for (i = 0; i < MAX_ACCESS_CREDENTIALS; i++) {
+        instance = Access_Credential_Index_To_Instance(i);
+        while (Access_Credential_Authentication_Factor_Remove(instance, 0)) {
+        }
+    }
+    /* fill every factor slot, badge number i:j */
+    for (i = 0; i < MAX_ACCESS_CREDENTIALS; i++) {
+        instance = Access_Credential_Index_To_Instance(i);
+        for (j = 0; j < MAX_AUTHENTICATION_FACTORS; j++) {
+            test_factor_init(&factor, (uint8_t)i, (uint8_t)j);
+            status = Access_Credential_Authentication_Factor_Set(
+                instance, j, &factor);
+            zassert_true(status, NULL);
+        }
+        status =
+            Access_Credential_Authentication_Factor_Set(instance, j, &factor);
+        zassert_false(status, NULL);
+    }
+    for (i = 0; i < MAX_ACCESS_CREDENTIALS; i++) {
+        for (j = 0; j < MAX_AUTHENTICATION_FACTORS; j++) {
+            test_factor_found(
+                (uint8_t)i, (uint8_t)j, Access_Credential_Index_To_Instance(i),
+                j);
+        }
+    }
+    /* remove from the middle: the later factors move down and are found
+       at their new elements, and the other credentials are untouched */
+    instance = Access_Credential_Index_To_Instance(2);
+    status = Access_Credential_Authentication_Factor_Remove(instance, 1);
+    zassert_true(status, NULL);
+    test_factor_not_found(2, 1);
+    test_factor_found(2, 0, instance, 0);
+    for (j = 2; j < MAX_AUTHENTICATION_FACTORS; j++) {
+        test_factor_found(2, (uint8_t)j, instance, j - 1);
+    }
+    for (i = 0; i < MAX_ACCESS_CREDENTIALS; i++) {
+        if (i == 2) {
+            continue;
+        }
+        for (j = 0; j < MAX_AUTHENTICATION_FACTORS; j++) {
+            test_factor_found(
+                (uint8_t)i, (uint8_t)j, Access_Credential_Index_To_Instance(i),
+                j);
+        }
+    }
+    /* the freed last element can be appended again */
+    test_factor_init(&factor, 2, 0x99);
+    status = Access_Credential_Authentication_Factor_Set(
+        instance, MAX_AUTHENTICATION_FACTORS - 1, &factor);
+    zassert_true(status, NULL);
+    test_factor_found(2, 0x99, instance, MAX_AUTHENTICATION_FACTORS - 1);
+    /* replace an element */
+    instance = Access_Credential_Index_To_Instance(0);
+    test_factor_init(&factor, 0x40, 0x40);
+    status = Access_Credential_Authentication_Factor_Set(instance, 2, &factor);
+    zassert_true(status, NULL);
+    test_factor_not_found(0, 2);
+    test_factor_found(0x40, 0x40, instance, 2);
+    test_factor_found(0, 1, instance, 1);
+    test_factor_found(0, 3, instance, 3);
+    /* the same factor, with the same hash, held by two credentials */
+    test_factor_init(&factor, 0x55, 0xAA);
+    status = Access_Credential_Authentication_Factor_Set(
+        Access_Credential_Index_To_Instance(1), 3, &factor);
+    zassert_true(status, NULL);
+    status = Access_Credential_Authentication_Factor_Set(
+        Access_Credential_Index_To_Instance(3), 0, &factor);
+    zassert_true(status, NULL);
+    status = Access_Credential_Authentication_Factor_Find(
+        &factor.authentication_factor, &test_instance, &index);
+    zassert_true(status, NULL);
+    zassert_true(
+        ((test_instance == Access_Credential_Index_To_Instance(1)) &&
+         (index == 3)) ||
+            ((test_instance == Access_Credential_Index_To_Instance(3)) &&
+             (index == 0)),
+        NULL);
+    /* removing it from one credential leaves it found in the other */
+    status =
+        Access_Credential_Authentication_Factor_Remove(test_instance, index);
+    zassert_true(status, NULL);
+    if (test_instance == Access_Credential_Index_To_Instance(1)) {
+        instance = Access_Credential_Index_To_Instance(3);
+        index = 0;
+    } else {
+        instance = Access_Credential_Index_To_Instance(1);
+        index = 3;
+    }
+    test_factor_found(0x55, 0xAA, instance, index);
+    status = Access_Credential_Authentication_Factor_Remove(instance, index);
+    zassert_true(status, NULL);
+    test_factor_not_found(0x55, 0xAA);
+    /* the neighbours of the removed factors moved down */
+    test_factor_found(1, 2, Access_Credential_Index_To_Instance(1), 2);
+    test_factor_found(3, 1, Access_Credential_Index_To_Instance(3), 0);
+    test_factor_found(3, 3, Access_Credential_Index_To_Instance(3), 2);
+}
 /**
  * @}
  */
@@ -80,7 +335,9 @@ ZTEST_SUITE(access_credential_tests, NULL, NULL, NULL, NULL, NULL);
 void test_main(void)
 {
     ztest_test_suite(
-        access_credential_tests, ztest_unit_test(testAccessCredential));
+        access_credential_tests, ztest_unit_test(testAccessCredential),
+        ztest_unit_test(testAccessCredentialFactorFind),
+        ztest_unit_test(testAccessCredentialFactorChains));
 
     ztest_run_test_suite(access_credential_tests);
 }
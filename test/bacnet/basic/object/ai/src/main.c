@@ -45,6 +45,55 @@ static void testAnalogInput(void)
     status = Analog_Input_Delete(object_instance);
     zassert_true(status, NULL);
 }
+
+static BACNET_OBJECT_TYPE Test_COV_Object_Type = MAX_BACNET_OBJECT_TYPE;
+static uint32_t Test_COV_Object_Instance = BACNET_MAX_INSTANCE;
+static unsigned Test_COV_Count = 0;
+
+static void test_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    Test_COV_Object_Type = object_type;
+    Test_COV_Object_Instance = object_instance;
+    Test_COV_Count++;
+}
+
+/**
+ * @brief Test the change-of-value callback
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ai_tests, testAnalogInputCOV)
+#else
+static void testAnalogInputCOV(void)
+#endif
+{
+    uint32_t object_instance = 0;
+
+    Analog_Input_Init();
+    object_instance = Analog_Input_Create(1);
+    Analog_Input_Change_Of_Value_Callback_Set(test_cov_object_changed);
+    Analog_Input_COV_Increment_Set(object_instance, 1.0f);
+    Analog_Input_Change_Of_Value_Clear(object_instance);
+    Test_COV_Count = 0;
+    /* below the COV increment - no change */
+    Analog_Input_Present_Value_Set(object_instance, 0.5f);
+    zassert_equal(Test_COV_Count, 0, NULL);
+    zassert_false(Analog_Input_Change_Of_Value(object_instance), NULL);
+    /* at the COV increment - changed */
+    Analog_Input_Present_Value_Set(object_instance, 1.0f);
+    zassert_equal(Test_COV_Count, 1, NULL);
+    zassert_equal(Test_COV_Object_Type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(Test_COV_Object_Instance, object_instance, NULL);
+    zassert_true(Analog_Input_Change_Of_Value(object_instance), NULL);
+    Analog_Input_Change_Of_Value_Clear(object_instance);
+    /* out-of-service changes are reported */
+    Analog_Input_Out_Of_Service_Set(object_instance, true);
+    zassert_equal(Test_COV_Count, 2, NULL);
+    Analog_Input_Out_Of_Service_Set(object_instance, true);
+    zassert_equal(Test_COV_Count, 2, NULL);
+    Analog_Input_Change_Of_Value_Callback_Set(NULL);
+    Analog_Input_Delete(object_instance);
+}
 /**
  * @}
  */
@@ -54,7 +103,9 @@ ZTEST_SUITE(ai_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(ai_tests, ztest_unit_test(testAnalogInput));
+    ztest_test_suite(
+        ai_tests, ztest_unit_test(testAnalogInput),
+        ztest_unit_test(testAnalogInputCOV));
 
     ztest_run_test_suite(ai_tests);
 }
@@ -7,6 +7,7 @@
  *
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <math.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/ao.h>
 #include <property_test.h>
@@ -45,6 +46,78 @@ static void testAnalogOutput(void)
     status = Analog_Output_Delete(object_instance);
     zassert_true(status, NULL);
 }
+
+/**
+ * @brief Test the present-value tracking of the priority array
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ao_tests, testAnalogOutputPriority)
+#else
+static void testAnalogOutputPriority(void)
+#endif
+{
+    bool status = false;
+    unsigned priority = 0;
+    uint32_t object_instance = BACNET_MAX_INSTANCE;
+
+    Analog_Output_Init();
+    object_instance = Analog_Output_Create(object_instance);
+    status = Analog_Output_Relinquish_Default_Set(object_instance, 10.0f);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 0, NULL);
+    zassert_false(
+        islessgreater(Analog_Output_Present_Value(object_instance), 10.0f),
+        NULL);
+    status = Analog_Output_Present_Value_Set(object_instance, 50.0f, 8);
+    zassert_true(status, NULL);
+    status = Analog_Output_Present_Value_Set(object_instance, 75.0f, 12);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    zassert_false(
+        islessgreater(Analog_Output_Present_Value(object_instance), 50.0f),
+        NULL);
+    /* relinquish a lower priority keeps the active priority */
+    status = Analog_Output_Present_Value_Relinquish(object_instance, 12);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    zassert_true(
+        Analog_Output_Priority_Array_Relinquished(object_instance, 12), NULL);
+    status = Analog_Output_Present_Value_Set(object_instance, 75.0f, 12);
+    zassert_true(status, NULL);
+    status = Analog_Output_Present_Value_Set(object_instance, 10.0f, 1);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 1, NULL);
+    zassert_false(
+        islessgreater(Analog_Output_Present_Value(object_instance), 10.0f),
+        NULL);
+    /* relinquish the active priority falls back to the next one */
+    status = Analog_Output_Present_Value_Relinquish(object_instance, 1);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    status = Analog_Output_Present_Value_Relinquish(object_instance, 8);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 12, NULL);
+    zassert_false(
+        islessgreater(Analog_Output_Present_Value(object_instance), 75.0f),
+        NULL);
+    zassert_false(
+        Analog_Output_Priority_Array_Relinquished(object_instance, 12), NULL);
+    status = Analog_Output_Present_Value_Relinquish(object_instance, 12);
+    zassert_true(status, NULL);
+    priority = Analog_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 0, NULL);
+    zassert_false(
+        islessgreater(Analog_Output_Present_Value(object_instance), 10.0f),
+        NULL);
+    status = Analog_Output_Delete(object_instance);
+    zassert_true(status, NULL);
+}
 /**
  * @}
  */
@@ -54,7 +127,8 @@ ZTEST_SUITE(ao_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(ao_tests, ztest_unit_test(testAnalogOutput));
+    ztest_test_suite(ao_tests, ztest_unit_test(testAnalogOutput),
+        ztest_unit_test(testAnalogOutputPriority));
 
     ztest_run_test_suite(ao_tests);
 }
@@ -184,6 +184,103 @@ static void testLogs(void)
 
     Audit_Log_Cleanup();
 }
+
+/**
+ * @brief Test the oldest records are replaced when the log buffer is full
+ */
+static void testLogsFull(void)
+{
+    const uint32_t instance = 1;
+    BACNET_AUDIT_LOG_RECORD value = { 0 };
+    BACNET_AUDIT_LOG_RECORD *record;
+    uint8_t i;
+    bool status = false;
+
+    Audit_Log_Init();
+    zassert_equal(Audit_Log_Create(instance), instance, NULL);
+    status = Audit_Log_Buffer_Size_Set(instance, 3);
+    zassert_true(status, NULL);
+    value.tag = AUDIT_LOG_DATUM_TAG_STATUS;
+    for (i = 1; i <= 5; i++) {
+        value.log_datum.log_status = i;
+        status = Audit_Log_Record_Entry_Add(instance, &value);
+        zassert_true(status, NULL);
+    }
+    zassert_equal(Audit_Log_Record_Count(instance), 3, NULL);
+    zassert_equal(Audit_Log_Total_Record_Count(instance), 5, NULL);
+    for (i = 0; i < 3; i++) {
+        record = Audit_Log_Record_Entry(instance, i);
+        zassert_not_null(record, NULL);
+        zassert_equal(record->log_datum.log_status, i + 3, NULL);
+    }
+    zassert_is_null(Audit_Log_Record_Entry(instance, 3), NULL);
+    /* deleting a record keeps the others in order */
+    Audit_Log_Record_Entry_Delete(instance, 1);
+    zassert_equal(Audit_Log_Record_Count(instance), 2, NULL);
+    record = Audit_Log_Record_Entry(instance, 1);
+    zassert_not_null(record, NULL);
+    zassert_equal(record->log_datum.log_status, 5, NULL);
+    value.log_datum.log_status = 6;
+    status = Audit_Log_Record_Entry_Add(instance, &value);
+    zassert_true(status, NULL);
+    /* shrinking the log buffer keeps the oldest records */
+    status = Audit_Log_Buffer_Size_Set(instance, 1);
+    zassert_true(status, NULL);
+    zassert_equal(Audit_Log_Record_Count(instance), 1, NULL);
+    record = Audit_Log_Record_Entry(instance, 0);
+    zassert_not_null(record, NULL);
+    zassert_equal(record->log_datum.log_status, 3, NULL);
+    Audit_Log_Cleanup();
+}
+/**
+ * @brief Test the insert of a list of notifications
+ */
+static void testLogsNotificationList(void)
+{
+    const uint32_t instance = 1;
+    BACNET_AUDIT_NOTIFICATION notification[3] = { 0 };
+    BACNET_AUDIT_LOG_RECORD *record;
+    unsigned i;
+
+    Audit_Log_Init();
+    zassert_equal(Audit_Log_Create(instance), instance, NULL);
+    for (i = 0; i < 3; i++) {
+        notification[i].source_device.tag = BACNET_RECIPIENT_TAG_DEVICE;
+        notification[i].source_device.type.device.type = OBJECT_DEVICE;
+        notification[i].source_device.type.device.instance = 1234;
+        notification[i].operation = AUDIT_OPERATION_WRITE + i;
+        notification[i].target_device.tag = BACNET_RECIPIENT_TAG_DEVICE;
+        notification[i].target_device.type.device.type = OBJECT_DEVICE;
+        notification[i].target_device.type.device.instance = 5678;
+    }
+    /* the last notification repeats the first */
+    notification[2].operation = AUDIT_OPERATION_WRITE;
+    /* not logged while disabled */
+    Audit_Log_Record_Notification_Insert_List(instance, notification, 3);
+    zassert_equal(Audit_Log_Record_Count(instance), 0, NULL);
+    zassert_true(Audit_Log_Enable_Set(instance, true), NULL);
+    zassert_equal(Audit_Log_Record_Count(instance), 1, NULL);
+    Audit_Log_Record_Notification_Insert_List(instance, notification, 3);
+    /* the repeated record is moved to the end of the list */
+    zassert_equal(Audit_Log_Record_Count(instance), 3, NULL);
+    record = Audit_Log_Record_Entry(instance, 1);
+    zassert_not_null(record, NULL);
+    zassert_equal(record->tag, AUDIT_LOG_DATUM_TAG_NOTIFICATION, NULL);
+    zassert_true(
+        bacnet_audit_log_notification_same(
+            &record->log_datum.notification, &notification[1]),
+        NULL);
+    record = Audit_Log_Record_Entry(instance, 2);
+    zassert_not_null(record, NULL);
+    zassert_true(
+        bacnet_audit_log_notification_same(
+            &record->log_datum.notification, &notification[0]),
+        NULL);
+    Audit_Log_Record_Notification_Insert_List(instance, NULL, 3);
+    Audit_Log_Record_Notification_Insert_List(instance, notification, 0);
+    zassert_equal(Audit_Log_Record_Count(instance), 3, NULL);
+    Audit_Log_Cleanup();
+}
 /**
  * @}
  */
@@ -192,7 +289,8 @@ void test_main(void)
 {
     ztest_test_suite(
         auditlog_tests, ztest_unit_test(testAuditlog),
-        ztest_unit_test(testLogs));
+        ztest_unit_test(testLogs), ztest_unit_test(testLogsFull),
+        ztest_unit_test(testLogsNotificationList));
 
     ztest_run_test_suite(auditlog_tests);
 }
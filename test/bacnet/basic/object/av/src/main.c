@@ -7,6 +7,7 @@
  *
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <math.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/av.h>
 #include <property_test.h>
@@ -45,6 +46,136 @@ static void testAnalog_Value(void)
     status = Analog_Value_Delete(object_instance);
     zassert_true(status, NULL);
 }
+
+/**
+ * @brief Test the bulk create and delete
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(av_tests, testAnalog_Value_Bulk)
+#else
+static void testAnalog_Value_Bulk(void)
+#endif
+{
+    uint32_t object_instances[] = { 9, 3, 7, 3, 1, BACNET_MAX_INSTANCE };
+    uint32_t delete_instances[] = { 7, 2, 1 };
+    unsigned count = 0;
+
+    Analog_Value_Init();
+    zassert_equal(Analog_Value_Create(5), 5, NULL);
+    count = Analog_Value_Create_Bulk(
+        object_instances, ARRAY_SIZE(object_instances));
+    zassert_equal(count, 4, NULL);
+    zassert_equal(Analog_Value_Count(), 5, NULL);
+    zassert_equal(Analog_Value_Index_To_Instance(0), 1, NULL);
+    zassert_equal(Analog_Value_Index_To_Instance(2), 5, NULL);
+    zassert_equal(Analog_Value_Index_To_Instance(4), 9, NULL);
+    zassert_true(Analog_Value_Valid_Instance(3), NULL);
+    /* existing instances are skipped */
+    object_instances[0] = 5;
+    zassert_equal(Analog_Value_Create_Bulk(object_instances, 1), 0, NULL);
+    count = Analog_Value_Delete_Bulk(
+        delete_instances, ARRAY_SIZE(delete_instances));
+    zassert_equal(count, 2, NULL);
+    zassert_equal(Analog_Value_Count(), 3, NULL);
+    zassert_false(Analog_Value_Valid_Instance(7), NULL);
+    zassert_false(Analog_Value_Valid_Instance(1), NULL);
+    zassert_equal(Analog_Value_Index_To_Instance(0), 3, NULL);
+    Analog_Value_Cleanup();
+}
+
+/**
+ * @brief Test the lazy create, with objects built on first access
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(av_tests, testAnalog_Value_Lazy)
+#else
+static void testAnalog_Value_Lazy(void)
+#endif
+{
+    uint32_t delete_instances[] = { 103, 104 };
+    unsigned count = 0;
+
+    Analog_Value_Init();
+    zassert_equal(Analog_Value_Create(1), 1, NULL);
+    Analog_Value_Units_Set(1, UNITS_DEGREES_CELSIUS);
+    Analog_Value_Present_Value_Set(1, 21.0f, BACNET_MAX_PRIORITY);
+    zassert_equal(Analog_Value_Create(102), 102, NULL);
+    /* existing instances are skipped */
+    count = Analog_Value_Create_Lazy(100, 5, 1);
+    zassert_equal(count, 4, NULL);
+    zassert_equal(Analog_Value_Count(), 6, NULL);
+    zassert_true(Analog_Value_Valid_Instance(104), NULL);
+    zassert_false(Analog_Value_Valid_Instance(105), NULL);
+    zassert_equal(Analog_Value_Index_To_Instance(5), 104, NULL);
+    zassert_false(Analog_Value_Change_Of_Value(100), NULL);
+    /* built from the template on first access */
+    zassert_equal(Analog_Value_Units(100), UNITS_DEGREES_CELSIUS, NULL);
+    zassert_false(
+        islessgreater(
+            Analog_Value_Present_Value(101), Analog_Value_Present_Value(1)),
+        NULL);
+    zassert_equal(Analog_Value_Units(102), UNITS_PERCENT, NULL);
+    zassert_equal(Analog_Value_Create(103), 103, NULL);
+    zassert_equal(Analog_Value_Count(), 6, NULL);
+    /* built and not built objects are deleted */
+    count = Analog_Value_Delete_Bulk(
+        delete_instances, ARRAY_SIZE(delete_instances));
+    zassert_equal(count, 2, NULL);
+    zassert_true(Analog_Value_Delete(100), NULL);
+    zassert_false(Analog_Value_Delete(100), NULL);
+    zassert_equal(Analog_Value_Count(), 3, NULL);
+    Analog_Value_Cleanup();
+    zassert_equal(Analog_Value_Count(), 0, NULL);
+}
+
+/**
+ * @brief Test the WriteProperty of primitive values
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(av_tests, testAnalog_Value_Write_Typed)
+#else
+static void testAnalog_Value_Write_Typed(void)
+#endif
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_WRITE_PROPERTY_PRIMITIVE value = { 0 };
+
+    Analog_Value_Init();
+    zassert_equal(Analog_Value_Create(1), 1, NULL);
+    wp_data.object_type = OBJECT_ANALOG_VALUE;
+    wp_data.object_instance = 1;
+    wp_data.object_property = PROP_PRESENT_VALUE;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.priority = BACNET_MAX_PRIORITY;
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    value.type.Real = 42.0f;
+    zassert_equal(Analog_Value_Write_Property_Typed(&wp_data, &value), 1, NULL);
+    zassert_false(
+        islessgreater(Analog_Value_Present_Value(1), 42.0f), NULL);
+    wp_data.object_property = PROP_COV_INCREMENT;
+    value.type.Real = -1.0f;
+    zassert_equal(
+        Analog_Value_Write_Property_Typed(&wp_data, &value),
+        BACNET_STATUS_ERROR, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_VALUE_OUT_OF_RANGE, NULL);
+    wp_data.object_property = PROP_UNITS;
+    value.tag = BACNET_APPLICATION_TAG_ENUMERATED;
+    value.type.Enumerated = UNITS_DEGREES_FAHRENHEIT;
+    zassert_equal(Analog_Value_Write_Property_Typed(&wp_data, &value), 1, NULL);
+    zassert_equal(Analog_Value_Units(1), UNITS_DEGREES_FAHRENHEIT, NULL);
+    /* other tags and properties take the generic WriteProperty */
+    wp_data.object_property = PROP_PRESENT_VALUE;
+    zassert_equal(Analog_Value_Write_Property_Typed(&wp_data, &value), 0, NULL);
+    wp_data.object_property = PROP_OUT_OF_SERVICE;
+    value.tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    value.type.Boolean = true;
+    zassert_equal(Analog_Value_Write_Property_Typed(&wp_data, &value), 0, NULL);
+    wp_data.object_instance = 2;
+    wp_data.object_property = PROP_PRESENT_VALUE;
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    zassert_equal(Analog_Value_Write_Property_Typed(&wp_data, &value), 0, NULL);
+    Analog_Value_Cleanup();
+}
 /**
  * @}
  */
@@ -54,7 +185,11 @@ ZTEST_SUITE(av_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(av_tests, ztest_unit_test(testAnalog_Value));
+    ztest_test_suite(
+        av_tests, ztest_unit_test(testAnalog_Value),
+        ztest_unit_test(testAnalog_Value_Bulk),
+        ztest_unit_test(testAnalog_Value_Lazy),
+        ztest_unit_test(testAnalog_Value_Write_Typed));
 
     ztest_run_test_suite(av_tests);
 }
@@ -250,6 +250,67 @@ static void testPresentValue(void)
     zassert_true(Calendar_Delete(instance), NULL);
 }
 
+static unsigned Change_Count;
+static bool Change_Value;
+
+static void testPresentValueChange(
+    uint32_t object_instance, bool old_value, bool value)
+{
+    (void)object_instance;
+    zassert_not_equal(old_value, value, NULL);
+    Change_Count++;
+    Change_Value = value;
+}
+
+#ifdef CONFIG_ZTEST_NEW_API
+ZTEST(bacnet_calendar, testPresentValueCache)
+#else
+static void testPresentValueCache(void)
+#endif
+{
+    const uint32_t instance = 1;
+    BACNET_DATE date;
+    BACNET_TIME time;
+    BACNET_CALENDAR_ENTRY entry = { 0 };
+    BACNET_CALENDAR_ENTRY *value;
+    unsigned i;
+
+    Calendar_Init();
+    zassert_equal(Calendar_Create(instance), instance, NULL);
+    Calendar_Present_Value_Change_Callback_Set(testPresentValueChange);
+    Change_Count = 0;
+    datetime_local(&date, &time, NULL, NULL);
+    /* the timer enables the cache */
+    Calendar_Timer(instance, 1000);
+    zassert_false(Calendar_Present_Value(instance), NULL);
+    zassert_equal(Change_Count, 0, NULL);
+    entry.tag = BACNET_CALENDAR_DATE;
+    entry.type.Date = date;
+    zassert_true(Calendar_Date_List_Add(instance, &entry), NULL);
+    zassert_true(Calendar_Present_Value(instance), NULL);
+    zassert_equal(Change_Count, 1, NULL);
+    zassert_true(Change_Value, NULL);
+    /* cached reads do not indicate a change */
+    zassert_true(Calendar_Present_Value(instance), NULL);
+    zassert_equal(Change_Count, 1, NULL);
+    /* the timer indicates the change */
+    value = Calendar_Date_List_Get(instance, 0);
+    value->type.Date.day++;
+    Calendar_Timer(instance, 1000);
+    zassert_equal(Change_Count, 2, NULL);
+    zassert_false(Change_Value, NULL);
+    /* a full day of timer keeps the value */
+    for (i = 0; i < (24 * 60); i++) {
+        Calendar_Timer(instance, 60000);
+    }
+    zassert_false(Calendar_Present_Value(instance), NULL);
+    zassert_equal(Change_Count, 2, NULL);
+    zassert_true(Calendar_Date_List_Delete_All(instance), NULL);
+    zassert_false(Calendar_Present_Value(instance), NULL);
+    Calendar_Present_Value_Change_Callback_Set(NULL);
+    zassert_true(Calendar_Delete(instance), NULL);
+}
+
 /**
  * @}
  */
@@ -261,7 +322,8 @@ void test_main(void)
 {
     ztest_test_suite(
         calendar_tests, ztest_unit_test(testCalendar),
-        ztest_unit_test(testPresentValue));
+        ztest_unit_test(testPresentValue),
+        ztest_unit_test(testPresentValueCache));
 
     ztest_run_test_suite(calendar_tests);
 }
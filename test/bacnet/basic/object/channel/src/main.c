@@ -17,8 +17,15 @@
  * @{
  */
 static BACNET_WRITE_PROPERTY_DATA Write_Property_Internal_Data;
+static BACNET_OBJECT_TYPE Write_Property_Internal_Types[16];
+static unsigned Write_Property_Internal_Count;
 static bool Write_Property_Internal(BACNET_WRITE_PROPERTY_DATA *wp_data)
 {
+    if (Write_Property_Internal_Count < 16) {
+        Write_Property_Internal_Types[Write_Property_Internal_Count] =
+            wp_data->object_type;
+    }
+    Write_Property_Internal_Count++;
     memcpy(
         &Write_Property_Internal_Data, wp_data,
         sizeof(BACNET_WRITE_PROPERTY_DATA));
@@ -290,6 +297,67 @@ static void test_Channel_Property_Read_Write(void)
     zassert_true(status, NULL);
     Channel_Cleanup();
 }
+/**
+ * @brief Test the batched member writes
+ */
+static void test_Channel_Write_Members_Batch(void)
+{
+    const uint32_t instance = 123;
+    unsigned index = 0;
+    bool status = false;
+    BACNET_CHANNEL_VALUE channel_value = { 0 };
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE member = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    int len = 0;
+
+    Channel_Write_Property_Internal_Callback_Set(Write_Property_Internal);
+    Channel_Init();
+    Channel_Create(instance);
+    member.deviceIdentifier.type = OBJECT_DEVICE;
+    member.deviceIdentifier.instance = 0;
+    member.arrayIndex = BACNET_ARRAY_ALL;
+    member.propertyIdentifier = PROP_PRESENT_VALUE;
+    /* members with mixed datatypes, and a duplicate */
+    member.objectIdentifier.type = OBJECT_BINARY_VALUE;
+    member.objectIdentifier.instance = 1;
+    index = Channel_Reference_List_Member_Element_Add(instance, &member);
+    zassert_not_equal(index, 0, NULL);
+    member.objectIdentifier.type = OBJECT_ANALOG_VALUE;
+    member.objectIdentifier.instance = 2;
+    index = Channel_Reference_List_Member_Element_Add(instance, &member);
+    zassert_not_equal(index, 0, NULL);
+    member.objectIdentifier.instance = 1;
+    index = Channel_Reference_List_Member_Element_Add(instance, &member);
+    zassert_not_equal(index, 0, NULL);
+    status =
+        Channel_Reference_List_Member_Element_Set(instance, 4, &member);
+    zassert_true(status, NULL);
+    Write_Property_Internal_Count = 0;
+    channel_value.tag = BACNET_APPLICATION_TAG_REAL;
+    channel_value.type.Real = 1.0f;
+    status = Channel_Present_Value_Set(instance, 1, &channel_value);
+    zassert_true(status, NULL);
+    /* duplicate written once, grouped by datatype */
+    zassert_equal(Write_Property_Internal_Count, 3, NULL);
+    zassert_equal(
+        Write_Property_Internal_Types[0], OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(
+        Write_Property_Internal_Types[1], OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(
+        Write_Property_Internal_Types[2], OBJECT_BINARY_VALUE, NULL);
+    /* the last write carries the coerced datatype of its member */
+    zassert_equal(
+        Write_Property_Internal_Data.object_type, OBJECT_BINARY_VALUE, NULL);
+    len = bacapp_decode_application_data(
+        Write_Property_Internal_Data.application_data,
+        Write_Property_Internal_Data.application_data_len, &value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_ENUMERATED, NULL);
+    zassert_equal(value.type.Enumerated, BINARY_ACTIVE, NULL);
+    status = Channel_Delete(instance);
+    zassert_true(status, NULL);
+    Channel_Cleanup();
+}
 /**
  * @}
  */
@@ -297,7 +365,8 @@ static void test_Channel_Property_Read_Write(void)
 void test_main(void)
 {
     ztest_test_suite(
-        channel_tests, ztest_unit_test(test_Channel_Property_Read_Write));
+        channel_tests, ztest_unit_test(test_Channel_Property_Read_Write),
+        ztest_unit_test(test_Channel_Write_Members_Batch));
 
     ztest_run_test_suite(channel_tests);
 }
@@ -6,6 +6,7 @@
  *
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <math.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/command.h>
 #include <property_test.h>
@@ -61,6 +62,206 @@ static void test_object_command(void)
         OBJECT_COMMAND, object_instance, Command_Property_Lists,
         Command_Read_Property, Command_Write_Property, skip_fail_property_list);
 }
+
+static float Test_Real_Value;
+static unsigned Test_Real_Writes;
+static unsigned Test_Accessor_Lookups;
+static unsigned Test_WP_Writes;
+static unsigned Test_WPM_Writes;
+static unsigned Test_WPM_Objects;
+static bool Test_WPM_Status;
+
+static bool test_real_valid(uint32_t object_instance)
+{
+    return object_instance == 1;
+}
+
+static float test_real_read(uint32_t object_instance)
+{
+    (void)object_instance;
+    return Test_Real_Value;
+}
+
+static bool test_real_write(
+    uint32_t object_instance,
+    float value,
+    uint8_t priority,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code)
+{
+    (void)object_instance;
+    (void)priority;
+    (void)error_class;
+    (void)error_code;
+    Test_Real_Value = value;
+    Test_Real_Writes++;
+    return true;
+}
+
+static const LOOP_REAL_ACCESSOR Test_Real_Accessor = { test_real_valid,
+                                                       test_real_read,
+                                                       test_real_write };
+
+static const LOOP_REAL_ACCESSOR *
+test_real_accessor(const BACNET_OBJECT_PROPERTY_REFERENCE *reference)
+{
+    Test_Accessor_Lookups++;
+    if (reference->object_identifier.type == OBJECT_ANALOG_VALUE) {
+        return &Test_Real_Accessor;
+    }
+
+    return NULL;
+}
+
+static bool test_write_property(BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    (void)wp_data;
+    Test_WP_Writes++;
+    return true;
+}
+
+static bool test_write_property_multiple(
+    uint32_t device_instance, BACNET_WRITE_ACCESS_DATA *write_access_data)
+{
+    zassert_equal(device_instance, 1234, NULL);
+    Test_WPM_Writes++;
+    while (write_access_data) {
+        zassert_equal(
+            write_access_data->object_type, OBJECT_ANALOG_OUTPUT, NULL);
+        zassert_equal(
+            write_access_data->listOfProperties->value.tag,
+            BACNET_APPLICATION_TAG_REAL, NULL);
+        Test_WPM_Objects++;
+        write_access_data = write_access_data->next;
+    }
+
+    return Test_WPM_Status;
+}
+
+static void test_action_set(
+    BACNET_ACTION_LIST *entry,
+    uint32_t device_instance,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    float value)
+{
+    entry->Device_Id.type = OBJECT_DEVICE;
+    entry->Device_Id.instance = device_instance;
+    entry->Object_Id.type = object_type;
+    entry->Object_Id.instance = object_instance;
+    entry->Property_Identifier = PROP_PRESENT_VALUE;
+    entry->Property_Array_Index = BACNET_ARRAY_ALL;
+    entry->Priority = 8;
+    entry->Value.tag = BACNET_APPLICATION_TAG_REAL;
+    entry->Value.type.Real = value;
+    entry->Post_Delay = 0;
+    entry->Quit_On_Failure = false;
+    entry->Write_Successful = false;
+    entry->next = NULL;
+}
+
+/**
+ * @brief Test the execution of an action list
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tests_object_command, test_object_command_action)
+#else
+static void test_object_command_action(void)
+#endif
+{
+    static BACNET_ACTION_LIST entry[4];
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_ACTION_LIST *pAction;
+    uint32_t object_instance;
+    bool status;
+
+    Command_Init();
+    Command_Write_Property_Internal_Callback_Set(test_write_property);
+    Command_Real_Accessor_Callback_Set(test_real_accessor);
+    Command_Write_Property_Multiple_Callback_Set(test_write_property_multiple);
+    object_instance = Command_Index_To_Instance(0);
+    /* local REAL with an accessor, then a post delay of one second */
+    pAction = Command_Action_List_Entry(object_instance, 0);
+    test_action_set(pAction, BACNET_MAX_INSTANCE, OBJECT_ANALOG_VALUE, 1, 42);
+    pAction->Post_Delay = 1;
+    pAction->next = &entry[0];
+    /* local object without an accessor */
+    test_action_set(&entry[0], 0, OBJECT_ANALOG_OUTPUT, 2, 1.0f);
+    entry[0].next = &entry[1];
+    /* two objects of another device in one WritePropertyMultiple */
+    test_action_set(&entry[1], 1234, OBJECT_ANALOG_OUTPUT, 3, 1.5f);
+    entry[1].next = &entry[2];
+    test_action_set(&entry[2], 1234, OBJECT_ANALOG_OUTPUT, 4, 2.5f);
+    entry[2].Quit_On_Failure = true;
+    entry[2].next = &entry[3];
+    test_action_set(&entry[3], BACNET_MAX_INSTANCE, OBJECT_ANALOG_INPUT, 5, 0);
+    /* action list 1 */
+    Test_WPM_Status = true;
+    status = Command_Action_Execute(object_instance, 1);
+    zassert_true(status, NULL);
+    zassert_equal(Command_Present_Value(object_instance), 1, NULL);
+    zassert_true(Command_In_Process(object_instance), NULL);
+    zassert_equal(Test_Real_Writes, 1, NULL);
+    zassert_false(islessgreater(Test_Real_Value, 42.0f), NULL);
+    zassert_equal(Test_WP_Writes, 0, NULL);
+    zassert_equal(Test_Accessor_Lookups, 3, NULL);
+    /* a write while in process is rejected */
+    wp_data.object_type = OBJECT_COMMAND;
+    wp_data.object_instance = object_instance;
+    wp_data.object_property = PROP_PRESENT_VALUE;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.application_data_len =
+        encode_application_unsigned(wp_data.application_data, 2);
+    status = Command_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_BUSY, NULL);
+    Command_Timer(object_instance, 999);
+    zassert_true(Command_In_Process(object_instance), NULL);
+    zassert_equal(Test_WP_Writes, 0, NULL);
+    Command_Timer(object_instance, 1);
+    zassert_false(Command_In_Process(object_instance), NULL);
+    zassert_true(Command_All_Writes_Successful(object_instance), NULL);
+    zassert_equal(Test_WP_Writes, 2, NULL);
+    zassert_equal(Test_WPM_Writes, 1, NULL);
+    zassert_equal(Test_WPM_Objects, 2, NULL);
+    zassert_true(entry[3].Write_Successful, NULL);
+    /* the plan is reused, and the failed batch quits the list */
+    Test_WPM_Status = false;
+    status = Command_Action_Execute(object_instance, 1);
+    zassert_true(status, NULL);
+    Command_Timer(object_instance, 1000);
+    zassert_false(Command_In_Process(object_instance), NULL);
+    zassert_false(Command_All_Writes_Successful(object_instance), NULL);
+    zassert_equal(Test_Accessor_Lookups, 3, NULL);
+    zassert_equal(Test_Real_Writes, 2, NULL);
+    zassert_equal(Test_WP_Writes, 3, NULL);
+    zassert_equal(Test_WPM_Writes, 2, NULL);
+    zassert_true(entry[0].Write_Successful, NULL);
+    zassert_false(entry[1].Write_Successful, NULL);
+    zassert_false(entry[2].Write_Successful, NULL);
+    /* a changed list is precompiled again */
+    pAction = Command_Action_List_Entry(object_instance, 0);
+    pAction->Post_Delay = 0;
+    Test_WPM_Status = true;
+    status = Command_Action_Execute(object_instance, 1);
+    zassert_true(status, NULL);
+    zassert_false(Command_In_Process(object_instance), NULL);
+    zassert_true(Command_All_Writes_Successful(object_instance), NULL);
+    zassert_equal(Test_Accessor_Lookups, 6, NULL);
+    zassert_equal(Test_WP_Writes, 5, NULL);
+    /* no action, and out of range */
+    status = Command_Action_Execute(object_instance, 0);
+    zassert_true(status, NULL);
+    zassert_equal(Test_WP_Writes, 5, NULL);
+    wp_data.application_data_len = encode_application_unsigned(
+        wp_data.application_data, MAX_COMMAND_ACTIONS + 1);
+    status = Command_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_VALUE_OUT_OF_RANGE, NULL);
+    Command_Write_Property_Internal_Callback_Set(NULL);
+    Command_Real_Accessor_Callback_Set(NULL);
+    Command_Write_Property_Multiple_Callback_Set(NULL);
+}
 /**
  * @}
  */
@@ -71,7 +272,8 @@ ZTEST_SUITE(tests_object_command, NULL, NULL, NULL, NULL, NULL);
 void test_main(void)
 {
     ztest_test_suite(
-        tests_object_command, ztest_unit_test(test_object_command));
+        tests_object_command, ztest_unit_test(test_object_command),
+        ztest_unit_test(test_object_command_action));
 
     ztest_run_test_suite(tests_object_command);
 }
@@ -5,8 +5,13 @@
  * @date 2004
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <math.h>
+#include <string.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/av.h>
+#include <bacnet/basic/object/timer.h>
+#include <bacnet/basic/service/h_apdu.h>
 #include <bacnet/bactext.h>
 
 /**
@@ -114,9 +119,561 @@ static void test_Device_Data_Sharing(void)
     }
 }
 
+/**
+ * @brief Test Object_List index stays consistent with the objects
+ */
+static void test_Device_Object_List(void)
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    BACNET_DELETE_OBJECT_DATA delete_data = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t object_instance = 0;
+    unsigned count = 0, test_count = 0, i = 0;
+    bool status = false, found = false;
+
+    Device_Init(NULL);
+    count = Device_Object_List_Count();
+    zassert_true(count > 0, NULL);
+    status = Device_Object_List_Identifier(0, &object_type, &object_instance);
+    zassert_false(status, NULL);
+    status = Device_Object_List_Identifier(
+        count + 1, &object_type, &object_instance);
+    zassert_false(status, NULL);
+    for (i = 1; i <= count; i++) {
+        status =
+            Device_Object_List_Identifier(i, &object_type, &object_instance);
+        zassert_true(status, NULL);
+        status = Device_Valid_Object_Id(object_type, object_instance);
+        zassert_true(status, "object-list[%u] is not valid", i);
+    }
+    /* created through the Device object */
+    create_data.object_type = OBJECT_ANALOG_VALUE;
+    create_data.object_instance = 4194302;
+    status = Device_Create_Object(&create_data);
+    zassert_true(status, NULL);
+    test_count = Device_Object_List_Count();
+    zassert_equal(test_count, count + 1, NULL);
+    found = false;
+    for (i = 1; i <= test_count; i++) {
+        status =
+            Device_Object_List_Identifier(i, &object_type, &object_instance);
+        zassert_true(status, NULL);
+        if ((object_type == OBJECT_ANALOG_VALUE) &&
+            (object_instance == 4194302)) {
+            found = true;
+        }
+    }
+    zassert_true(found, NULL);
+    delete_data.object_type = OBJECT_ANALOG_VALUE;
+    delete_data.object_instance = 4194302;
+    status = Device_Delete_Object(&delete_data);
+    zassert_true(status, NULL);
+    test_count = Device_Object_List_Count();
+    zassert_equal(test_count, count, NULL);
+    /* created directly by the application */
+    object_instance = Analog_Value_Create(4194301);
+    zassert_equal(object_instance, 4194301, NULL);
+    test_count = Device_Object_List_Count();
+    zassert_equal(test_count, count + 1, NULL);
+    status = Device_Object_List_Identifier(
+        test_count, &object_type, &object_instance);
+    zassert_true(status, NULL);
+    /* deleted and created directly, so the count stays the same */
+    status = Analog_Value_Delete(4194301);
+    zassert_true(status, NULL);
+    object_instance = Analog_Value_Create(4194300);
+    zassert_equal(object_instance, 4194300, NULL);
+    zassert_equal(Device_Object_List_Count(), test_count, NULL);
+    found = false;
+    for (i = 1; i <= test_count; i++) {
+        status =
+            Device_Object_List_Identifier(i, &object_type, &object_instance);
+        zassert_true(status, NULL);
+        zassert_false(
+            (object_type == OBJECT_ANALOG_VALUE) &&
+                (object_instance == 4194301),
+            NULL);
+        if ((object_type == OBJECT_ANALOG_VALUE) &&
+            (object_instance == 4194300)) {
+            found = true;
+        }
+    }
+    zassert_true(found, NULL);
+    status = Analog_Value_Delete(4194300);
+    zassert_true(status, NULL);
+    test_count = Device_Object_List_Count();
+    zassert_equal(test_count, count, NULL);
+}
+
+/* instances evaluated by Device_local_reporting(), for the unit test */
+static uint32_t Test_Reporting_Instance[8];
+static unsigned Test_Reporting_Count;
+/* instance deleted by the reporting of another instance, if any */
+static uint32_t Test_Reporting_Delete = BACNET_MAX_INSTANCE;
+
+/**
+ * @brief Record the intrinsic reporting of an Analog Value object
+ * @param object_instance [in] the object instance evaluated
+ */
+static void test_reporting_record(uint32_t object_instance)
+{
+    if (Test_Reporting_Count < ARRAY_SIZE(Test_Reporting_Instance)) {
+        Test_Reporting_Instance[Test_Reporting_Count] = object_instance;
+        Test_Reporting_Count++;
+    }
+    if (Test_Reporting_Delete != BACNET_MAX_INSTANCE) {
+        (void)Analog_Value_Delete(Test_Reporting_Delete);
+        Test_Reporting_Delete = BACNET_MAX_INSTANCE;
+    }
+}
+
+/**
+ * @brief Determine if an instance was evaluated by Device_local_reporting()
+ * @param object_instance [in] the object instance
+ * @return true if the instance was evaluated
+ */
+static bool test_reporting_evaluated(uint32_t object_instance)
+{
+    unsigned i;
+
+    for (i = 0; i < Test_Reporting_Count; i++) {
+        if (Test_Reporting_Instance[i] == object_instance) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Test that the objects created or deleted directly by the
+ *  application are evaluated by the intrinsic reporting
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, test_Device_Local_Reporting)
+#else
+static void test_Device_Local_Reporting(void)
+#endif
+{
+    static object_functions_t object_table[2];
+    const struct object_functions *pObject;
+    uint32_t object_instance;
+
+    pObject = Device_Object_Functions_Find(OBJECT_ANALOG_VALUE);
+    zassert_not_null(pObject, NULL);
+    object_table[0] = *pObject;
+    object_table[0].Object_Intrinsic_Reporting = test_reporting_record;
+    object_table[1].Object_Type = MAX_BACNET_OBJECT_TYPE;
+    Device_Init(object_table);
+    object_instance = Analog_Value_Create(1);
+    zassert_equal(object_instance, 1, NULL);
+    object_instance = Analog_Value_Create(2);
+    zassert_equal(object_instance, 2, NULL);
+    Test_Reporting_Count = 0;
+    Device_local_reporting();
+    zassert_equal(Test_Reporting_Count, 2, NULL);
+    zassert_true(test_reporting_evaluated(1), NULL);
+    zassert_true(test_reporting_evaluated(2), NULL);
+    /* deleted and created directly, so the count stays the same */
+    zassert_true(Analog_Value_Delete(2), NULL);
+    object_instance = Analog_Value_Create(3);
+    zassert_equal(object_instance, 3, NULL);
+    Test_Reporting_Count = 0;
+    Device_local_reporting();
+    zassert_equal(Test_Reporting_Count, 2, NULL);
+    zassert_true(test_reporting_evaluated(1), NULL);
+    zassert_false(test_reporting_evaluated(2), NULL);
+    zassert_true(test_reporting_evaluated(3), NULL);
+    /* an object deleted by the reporting of another is skipped */
+    Test_Reporting_Count = 0;
+    Test_Reporting_Delete = 3;
+    Device_local_reporting();
+    zassert_equal(Test_Reporting_Count, 1, NULL);
+    zassert_true(test_reporting_evaluated(1), NULL);
+    Test_Reporting_Count = 0;
+    Device_local_reporting();
+    zassert_equal(Test_Reporting_Count, 1, NULL);
+    zassert_true(Analog_Value_Delete(1), NULL);
+    Device_Init(NULL);
+}
+
+/**
+ * @brief Test the bulk create and delete of objects through the Device
+ */
+static void test_Device_Objects_Bulk(void)
+{
+    uint32_t av_instances[] = { 4194300, 4194298, 4194299 };
+    uint32_t bv_instances[] = { 4194299, 4194298 };
+    unsigned count = 0, test_count = 0;
+    uint32_t revision = 0;
+
+    Device_Init(NULL);
+    count = Device_Object_List_Count();
+    revision = Device_Database_Revision();
+    test_count = Device_Create_Objects(
+        OBJECT_ANALOG_VALUE, av_instances, ARRAY_SIZE(av_instances));
+    zassert_equal(test_count, ARRAY_SIZE(av_instances), NULL);
+    zassert_equal(av_instances[0], 4194298, NULL);
+    zassert_equal(Device_Database_Revision(), revision + 1, NULL);
+    /* object types without a bulk create, one at a time */
+    test_count = Device_Create_Objects(
+        OBJECT_BINARY_VALUE, bv_instances, ARRAY_SIZE(bv_instances));
+    zassert_equal(test_count, ARRAY_SIZE(bv_instances), NULL);
+    zassert_equal(Device_Database_Revision(), revision + 2, NULL);
+    zassert_equal(
+        Device_Object_List_Count(),
+        count + ARRAY_SIZE(av_instances) + ARRAY_SIZE(bv_instances), NULL);
+    zassert_true(Device_Valid_Object_Id(OBJECT_ANALOG_VALUE, 4194299), NULL);
+    zassert_true(Device_Valid_Object_Id(OBJECT_BINARY_VALUE, 4194299), NULL);
+    test_count = Device_Delete_Objects(
+        OBJECT_ANALOG_VALUE, av_instances, ARRAY_SIZE(av_instances));
+    zassert_equal(test_count, ARRAY_SIZE(av_instances), NULL);
+    test_count = Device_Delete_Objects(
+        OBJECT_BINARY_VALUE, bv_instances, ARRAY_SIZE(bv_instances));
+    zassert_equal(test_count, ARRAY_SIZE(bv_instances), NULL);
+    zassert_equal(Device_Database_Revision(), revision + 4, NULL);
+    zassert_equal(Device_Object_List_Count(), count, NULL);
+}
+
+/**
+ * @brief Test Object_Name lookup stays consistent with the objects
+ */
+static void test_Device_Object_Name(void)
+{
+    BACNET_CHARACTER_STRING object_name = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE, test_type = OBJECT_NONE;
+    uint32_t object_instance = 0, test_instance = 0;
+    unsigned count = 0, i = 0;
+    bool status = false;
+    /* the object keeps a pointer to its name */
+    static const char *names[] = { "Renamed AV 0", "Renamed AV 1",
+                                   "Renamed AV 2", "Renamed AV 3" };
+
+    Device_Init(NULL);
+    count = Device_Object_List_Count();
+    for (i = 1; i <= count; i++) {
+        status =
+            Device_Object_List_Identifier(i, &object_type, &object_instance);
+        zassert_true(status, NULL);
+        status = Device_Object_Name_Copy(
+            object_type, object_instance, &object_name);
+        zassert_true(status, NULL);
+        status =
+            Device_Valid_Object_Name(&object_name, &test_type, &test_instance);
+        zassert_true(status, NULL);
+        zassert_equal(test_type, object_type, NULL);
+        zassert_equal(test_instance, object_instance, NULL);
+    }
+    characterstring_init_ansi(&object_name, "No Such Object Name");
+    status = Device_Valid_Object_Name(&object_name, NULL, NULL);
+    zassert_false(status, NULL);
+    /* renamed by the application */
+    object_instance = Analog_Value_Create(4194301);
+    zassert_equal(object_instance, 4194301, NULL);
+    status = Analog_Value_Name_Set(object_instance, "No Such Object Name");
+    zassert_true(status, NULL);
+    Device_Object_Name_Index_Update(OBJECT_ANALOG_VALUE, object_instance);
+    status =
+        Device_Valid_Object_Name(&object_name, &test_type, &test_instance);
+    zassert_true(status, NULL);
+    zassert_equal(test_type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(test_instance, object_instance, NULL);
+    status = Analog_Value_Name_Set(object_instance, "Renamed Object Name");
+    zassert_true(status, NULL);
+    Device_Object_Name_Index_Update(OBJECT_ANALOG_VALUE, object_instance);
+    status = Device_Valid_Object_Name(&object_name, NULL, NULL);
+    zassert_false(status, NULL);
+    characterstring_init_ansi(&object_name, "Renamed Object Name");
+    status = Device_Valid_Object_Name(&object_name, NULL, NULL);
+    zassert_true(status, NULL);
+    status = Analog_Value_Delete(object_instance);
+    zassert_true(status, NULL);
+    status = Device_Valid_Object_Name(&object_name, NULL, NULL);
+    zassert_false(status, NULL);
+    /* many objects renamed by the application */
+    for (i = 0; i < ARRAY_SIZE(names); i++) {
+        object_instance = Analog_Value_Create(4194290 + i);
+        zassert_equal(object_instance, 4194290 + i, NULL);
+    }
+    /* build the name index, so that each rename relinks one entry */
+    (void)Device_Valid_Object_Name(&object_name, NULL, NULL);
+    for (i = 0; i < ARRAY_SIZE(names); i++) {
+        status = Analog_Value_Name_Set(4194290 + i, names[i]);
+        zassert_true(status, NULL);
+        Device_Object_Name_Index_Update(OBJECT_ANALOG_VALUE, 4194290 + i);
+    }
+    for (i = 0; i < ARRAY_SIZE(names); i++) {
+        characterstring_init_ansi(&object_name, names[i]);
+        status =
+            Device_Valid_Object_Name(&object_name, &test_type, &test_instance);
+        zassert_true(status, NULL);
+        zassert_equal(test_type, OBJECT_ANALOG_VALUE, NULL);
+        zassert_equal(test_instance, 4194290 + i, NULL);
+        status = Analog_Value_Delete(4194290 + i);
+        zassert_true(status, NULL);
+    }
+}
+
+/**
+ * @brief Test the Object_List changes kept for ReadRange by sequence number
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, test_Device_Object_Journal)
+#else
+static void test_Device_Object_Journal(void)
+#endif
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    BACNET_DELETE_OBJECT_DATA delete_data = { 0 };
+    BACNET_READ_RANGE_DATA rr_data = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    RR_PROP_INFO info = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t object_instance = 0, change = 0, revision = 0;
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int len = 0, apdu_len = 0;
+    bool status = false;
+
+    Device_Init(NULL);
+    revision = Device_Database_Revision();
+    create_data.object_type = OBJECT_ANALOG_VALUE;
+    create_data.object_instance = 4194302;
+    status = Device_Create_Object(&create_data);
+    zassert_true(status, NULL);
+    delete_data.object_type = OBJECT_ANALOG_VALUE;
+    delete_data.object_instance = 4194302;
+    status = Device_Delete_Object(&delete_data);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Database_Revision(), revision + 2, NULL);
+    /* the changes after the revision, by sequence number */
+    rr_data.object_type = OBJECT_DEVICE;
+    rr_data.object_instance = Device_Object_Instance_Number();
+    rr_data.object_property = PROP_DEVICE_OBJECT_JOURNAL;
+    rr_data.array_index = BACNET_ARRAY_ALL;
+    rr_data.RequestType = RR_BY_SEQUENCE;
+    rr_data.Range.RefSeqNum = revision + 1;
+    rr_data.Count = 10;
+    status = DeviceGetRRInfo(&rr_data, &info);
+    zassert_true(status, NULL);
+    zassert_true(info.RequestTypes & RR_BY_SEQUENCE, NULL);
+    zassert_not_null(info.Handler, NULL);
+    apdu_len = info.Handler(apdu, &rr_data);
+    zassert_true(apdu_len > 0, NULL);
+    zassert_equal(rr_data.ItemCount, 2, NULL);
+    zassert_equal(rr_data.FirstSequence, revision + 1, NULL);
+    len = bacnet_object_id_application_decode(
+        apdu, apdu_len, &object_type, &object_instance);
+    zassert_true(len > 0, NULL);
+    zassert_equal(object_type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(object_instance, 4194302, NULL);
+    len += bacnet_enumerated_application_decode(
+        &apdu[len], apdu_len - len, &change);
+    zassert_equal(change, DEVICE_OBJECT_CHANGE_CREATED, NULL);
+    len += bacnet_object_id_application_decode(
+        &apdu[len], apdu_len - len, &object_type, &object_instance);
+    zassert_equal(object_instance, 4194302, NULL);
+    len += bacnet_enumerated_application_decode(
+        &apdu[len], apdu_len - len, &change);
+    zassert_equal(change, DEVICE_OBJECT_CHANGE_DELETED, NULL);
+    zassert_equal(len, apdu_len, NULL);
+    /* no changes after the current revision */
+    rr_data.Range.RefSeqNum = Device_Database_Revision() + 1;
+    apdu_len = info.Handler(apdu, &rr_data);
+    zassert_equal(rr_data.ItemCount, 0, NULL);
+    /* not readable with ReadProperty */
+    rpdata.application_data = &apdu[0];
+    rpdata.application_data_len = sizeof(apdu);
+    rpdata.object_type = OBJECT_DEVICE;
+    rpdata.object_instance = Device_Object_Instance_Number();
+    rpdata.object_property = PROP_DEVICE_OBJECT_JOURNAL;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    len = Device_Read_Property(&rpdata);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+    zassert_equal(rpdata.error_code, ERROR_CODE_READ_ACCESS_DENIED, NULL);
+}
+
+/**
+ * @brief Test cached property values follow changes to the objects
+ */
+static void test_Device_Property_Value_Cache(void)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_CHARACTER_STRING char_string = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint8_t test_apdu[MAX_APDU] = { 0 };
+    uint32_t object_instance = 0;
+    int len = 0, test_len = 0;
+    bool status = false;
+
+    Device_Init(NULL);
+    object_instance = Analog_Value_Create(4194301);
+    zassert_equal(object_instance, 4194301, NULL);
+    status = Analog_Value_Description_Set(object_instance, "Cached");
+    zassert_true(status, NULL);
+    rpdata.object_type = OBJECT_ANALOG_VALUE;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = PROP_DESCRIPTION;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    /* read again, which may come from the cache */
+    rpdata.application_data = test_apdu;
+    test_len = Device_Read_Property(&rpdata);
+    zassert_equal(test_len, len, NULL);
+    zassert_mem_equal(test_apdu, apdu, len, NULL);
+    /* changed by the application */
+    status = Analog_Value_Description_Set(object_instance, "Changed");
+    zassert_true(status, NULL);
+    Device_Property_Value_Cache_Invalidate(
+        OBJECT_ANALOG_VALUE, object_instance);
+    test_len = Device_Read_Property(&rpdata);
+    zassert_true(test_len > 0, NULL);
+    len = bacnet_character_string_application_decode(
+        test_apdu, test_len, &char_string);
+    zassert_true(len > 0, NULL);
+    zassert_true(characterstring_ansi_same(&char_string, "Changed"), NULL);
+    status = Analog_Value_Delete(object_instance);
+    zassert_true(status, NULL);
+}
+
+/**
+ * @brief Test Max_APDU_Length_Accepted follows the limit of the datalink
+ */
+static void test_Device_Max_APDU_Length_Accepted(void)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_UNSIGNED_INTEGER value = 0;
+    int len = 0;
+
+    Device_Init(NULL);
+    rpdata.object_type = OBJECT_DEVICE;
+    rpdata.object_instance = Device_Object_Instance_Number();
+    rpdata.object_property = PROP_MAX_APDU_LENGTH_ACCEPTED;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    apdu_max_length_accepted_set(50);
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacnet_unsigned_application_decode(apdu, len, &value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(value, 50, NULL);
+    apdu_max_length_accepted_set(MAX_APDU);
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacnet_unsigned_application_decode(apdu, len, &value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(value, MAX_APDU, NULL);
+}
+
 /**
  * @brief Test basic API
  */
+/**
+ * @brief Find each object type in an Object_Table by searching it
+ */
+static struct object_functions *test_object_functions_search(
+    struct object_functions *pObject, BACNET_OBJECT_TYPE object_type)
+{
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Type == object_type) {
+            return pObject;
+        }
+        pObject++;
+    }
+
+    return NULL;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, test_Device_Object_Functions_Find)
+#else
+static void test_Device_Object_Functions_Find(void)
+#endif
+{
+    static object_functions_t object_table[] = {
+        { .Object_Type = OBJECT_DEVICE },
+        { .Object_Type = (BACNET_OBJECT_TYPE)600 },
+        { .Object_Type = OBJECT_ANALOG_INPUT },
+        { .Object_Type = (BACNET_OBJECT_TYPE)130 },
+        { .Object_Type = OBJECT_ANALOG_INPUT },
+        { .Object_Type = (BACNET_OBJECT_TYPE)600 },
+        { .Object_Type = MAX_BACNET_OBJECT_TYPE },
+    };
+    struct object_functions *pObject;
+    unsigned type;
+
+    Device_Init(object_table);
+    for (type = 0; type <= MAX_BACNET_OBJECT_TYPE; type++) {
+        pObject = Device_Object_Functions_Find((BACNET_OBJECT_TYPE)type);
+        zassert_equal(
+            pObject,
+            test_object_functions_search(
+                object_table, (BACNET_OBJECT_TYPE)type),
+            "type=%u", type);
+    }
+    zassert_equal(
+        Device_Object_Functions_Find((BACNET_OBJECT_TYPE)600),
+        &object_table[1], NULL);
+    zassert_equal(
+        Device_Object_Functions_Find(OBJECT_ANALOG_INPUT), &object_table[2],
+        NULL);
+    Device_Init(NULL);
+    for (type = 0; type <= MAX_BACNET_OBJECT_TYPE; type++) {
+        pObject = Device_Object_Functions_Find((BACNET_OBJECT_TYPE)type);
+        zassert_equal(
+            pObject,
+            test_object_functions_search(
+                Device_Object_Functions(), (BACNET_OBJECT_TYPE)type),
+            "type=%u", type);
+    }
+}
+
+/**
+ * @brief Test the memory reports registered by the Device object
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, test_Device_Memory_Usage)
+#else
+static void test_Device_Memory_Usage(void)
+#endif
+{
+    BACNET_MEMORY_USAGE before = { 0 }, after = { 0 };
+    const char *name = NULL;
+    unsigned index;
+    bool found = false;
+    uint32_t instance;
+
+    memusage_cleanup();
+    Device_Init(NULL);
+    zassert_true(memusage_module_count() > 0, NULL);
+    for (index = 0; index < memusage_module_count(); index++) {
+        zassert_true(memusage_module(index, &name, NULL), NULL);
+        zassert_not_null(name, NULL);
+        if (strcmp(name, "analog-value") == 0) {
+            found = true;
+        }
+    }
+    zassert_true(found, NULL);
+    zassert_false(memusage_module(index, &name, NULL), NULL);
+    /* registering again does not add the modules twice */
+    Device_Init(NULL);
+    zassert_equal(memusage_module_count(), index, NULL);
+    memusage_total(&before);
+    zassert_true(before.static_bytes > 0, NULL);
+    instance = Analog_Value_Create(BACNET_MAX_INSTANCE);
+    zassert_true(Analog_Value_Valid_Instance(instance), NULL);
+    memusage_total(&after);
+    zassert_true(after.dynamic_bytes > before.dynamic_bytes, NULL);
+    zassert_equal(after.count, before.count + 1, NULL);
+    zassert_true(Analog_Value_Delete(instance), NULL);
+    memusage_cleanup();
+    zassert_equal(memusage_module_count(), 0, NULL);
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(device_tests, testDevice)
 #else
@@ -217,6 +774,73 @@ static void testDevice(void)
 
     return;
 }
+/**
+ * @brief Test the Timer object expiry at its deadline, and the writes
+ *  of its references to local objects
+ */
+static void test_Device_Timer_Deadline(void)
+{
+    const uint32_t timer_instance = 1, av_instance = 4194302;
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE member = { 0 };
+    BACNET_TIMER_STATE_CHANGE_VALUE *value = NULL;
+    unsigned i = 0;
+    bool status = false;
+
+    Device_Init(NULL);
+    zassert_equal(Timer_Create(timer_instance), timer_instance, NULL);
+    zassert_equal(Analog_Value_Create(av_instance), av_instance, NULL);
+    member.deviceIdentifier.type = OBJECT_DEVICE;
+    member.deviceIdentifier.instance = Device_Object_Instance_Number();
+    member.objectIdentifier.type = OBJECT_ANALOG_VALUE;
+    member.objectIdentifier.instance = av_instance;
+    member.propertyIdentifier = PROP_PRESENT_VALUE;
+    member.arrayIndex = BACNET_ARRAY_ALL;
+    status =
+        Timer_Reference_List_Member_Element_Set(timer_instance, 0, &member);
+    zassert_true(status, NULL);
+    value = Timer_State_Change_Value(
+        timer_instance, TIMER_TRANSITION_RUNNING_TO_EXPIRED);
+    value->tag = BACNET_APPLICATION_TAG_REAL;
+    value->type.Real = 42.0f;
+    /* an idle timer has no wake-up */
+    zassert_equal(Device_Timer_Next(), UINT32_MAX, NULL);
+    status = Timer_Present_Value_Set(timer_instance, 10000);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Timer_Next(), 10000, NULL);
+    for (i = 0; i < 9; i++) {
+        Device_Timer(1000);
+    }
+    zassert_equal(Timer_Present_Value(timer_instance), 1000, NULL);
+    /* a restart moves the deadline out by a full timeout */
+    status = Timer_Present_Value_Set(timer_instance, 10000);
+    zassert_true(status, NULL);
+    zassert_equal(Timer_Present_Value(timer_instance), 10000, NULL);
+    for (i = 0; i < 9; i++) {
+        Device_Timer(1000);
+        zassert_true(Timer_Running(timer_instance), NULL);
+    }
+    zassert_true(
+        islessgreater(Analog_Value_Present_Value(av_instance), 42.0f), NULL);
+    /* one late call expires the timer, whatever the interval */
+    Device_Timer(5000);
+    zassert_equal(Timer_State(timer_instance), TIMER_STATE_EXPIRED, NULL);
+    zassert_equal(
+        Timer_Last_State_Change(timer_instance),
+        TIMER_TRANSITION_RUNNING_TO_EXPIRED, NULL);
+    zassert_equal(Timer_Present_Value(timer_instance), 0, NULL);
+    zassert_false(
+        islessgreater(Analog_Value_Present_Value(av_instance), 42.0f), NULL);
+    zassert_equal(Device_Timer_Next(), UINT32_MAX, NULL);
+    /* a stopped timer is not called again */
+    status = Timer_Running_Set(timer_instance, true);
+    zassert_true(status, NULL);
+    zassert_true(Device_Timer_Next() != UINT32_MAX, NULL);
+    status = Timer_State_Set(timer_instance, TIMER_STATE_IDLE);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Timer_Next(), UINT32_MAX, NULL);
+    zassert_true(Timer_Delete(timer_instance), NULL);
+    zassert_true(Analog_Value_Delete(av_instance), NULL);
+}
 /**
  * @}
  */
@@ -228,7 +852,17 @@ void test_main(void)
 {
     ztest_test_suite(
         device_tests, ztest_unit_test(testDevice),
-        ztest_unit_test(test_Device_Data_Sharing));
+        ztest_unit_test(test_Device_Data_Sharing),
+        ztest_unit_test(test_Device_Object_List),
+        ztest_unit_test(test_Device_Local_Reporting),
+        ztest_unit_test(test_Device_Objects_Bulk),
+        ztest_unit_test(test_Device_Object_Name),
+        ztest_unit_test(test_Device_Property_Value_Cache),
+        ztest_unit_test(test_Device_Max_APDU_Length_Accepted),
+        ztest_unit_test(test_Device_Timer_Deadline),
+        ztest_unit_test(test_Device_Object_Functions_Find),
+        ztest_unit_test(test_Device_Memory_Usage),
+        ztest_unit_test(test_Device_Object_Journal));
 
     ztest_run_test_suite(device_tests);
 }
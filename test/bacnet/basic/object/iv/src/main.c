@@ -52,13 +52,71 @@ static void testInteger_Value(void)
     status = Integer_Value_Delete(object_instance);
     zassert_true(status, NULL);
 }
+
+/**
+ * @brief Test the WriteProperty and COV of the value object engine
+ */
+static void testInteger_Value_Write(void)
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    uint32_t object_instance = 0;
+    bool status = false;
+
+    Integer_Value_Init();
+    object_instance = Integer_Value_Create(7);
+    zassert_equal(object_instance, 7, NULL);
+    Integer_Value_COV_Increment_Set(object_instance, 5);
+    Integer_Value_Change_Of_Value_Clear(object_instance);
+    wp_data.object_type = OBJECT_INTEGER_VALUE;
+    wp_data.object_instance = object_instance;
+    wp_data.object_property = PROP_PRESENT_VALUE;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.priority = BACNET_MAX_PRIORITY;
+    wp_data.application_data_len =
+        encode_application_signed(wp_data.application_data, -4);
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    zassert_equal(Integer_Value_Present_Value(object_instance), -4, NULL);
+    zassert_false(Integer_Value_Change_Of_Value(object_instance), NULL);
+    wp_data.application_data_len =
+        encode_application_signed(wp_data.application_data, -5);
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    zassert_true(Integer_Value_Change_Of_Value(object_instance), NULL);
+    /* wrong datatype */
+    wp_data.application_data_len =
+        encode_application_real(wp_data.application_data, 1.0f);
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_INVALID_DATA_TYPE, NULL);
+    zassert_equal(Integer_Value_Present_Value(object_instance), -5, NULL);
+    /* property that is not writable, and property that is unknown */
+    wp_data.object_property = PROP_OBJECT_TYPE;
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_WRITE_ACCESS_DENIED, NULL);
+    wp_data.object_property = PROP_PRIORITY_ARRAY;
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_UNKNOWN_PROPERTY, NULL);
+    wp_data.object_property = PROP_UNITS;
+    wp_data.application_data_len = encode_application_enumerated(
+        wp_data.application_data, UNITS_AMPERES);
+    status = Integer_Value_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    zassert_equal(Integer_Value_Units(object_instance), UNITS_AMPERES, NULL);
+    Integer_Value_Cleanup();
+    zassert_equal(Integer_Value_Count(), 0, NULL);
+}
 /**
  * @}
  */
 
 void test_main(void)
 {
-    ztest_test_suite(piv_tests, ztest_unit_test(testInteger_Value));
+    ztest_test_suite(
+        piv_tests, ztest_unit_test(testInteger_Value),
+        ztest_unit_test(testInteger_Value_Write));
 
     ztest_run_test_suite(piv_tests);
 }
@@ -5,6 +5,7 @@
  * @date October 2025
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <math.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/loop.h>
 #include <bacnet/bactext.h>
@@ -35,6 +36,63 @@ static int Read_Property_Internal(BACNET_READ_PROPERTY_DATA *data)
     return Read_Property_Internal_Length;
 }
 
+/* local objects reached through the direct accessors */
+static float Accessor_Input_Value;
+static float Accessor_Output_Value;
+static uint32_t Accessor_Output_Instance;
+static uint8_t Accessor_Output_Priority;
+static unsigned Accessor_Write_Count;
+
+static bool Accessor_Valid(uint32_t object_instance)
+{
+    return object_instance == 1;
+}
+
+static float Accessor_Read(uint32_t object_instance)
+{
+    (void)object_instance;
+    return Accessor_Input_Value;
+}
+
+static bool Accessor_Write(
+    uint32_t object_instance,
+    float value,
+    uint8_t priority,
+    BACNET_ERROR_CLASS *error_class,
+    BACNET_ERROR_CODE *error_code)
+{
+    (void)error_class;
+    (void)error_code;
+    Accessor_Output_Instance = object_instance;
+    Accessor_Output_Value = value;
+    Accessor_Output_Priority = priority;
+    Accessor_Write_Count++;
+
+    return true;
+}
+
+static const LOOP_REAL_ACCESSOR Input_Accessor = { Accessor_Valid,
+                                                   Accessor_Read, NULL };
+static const LOOP_REAL_ACCESSOR Output_Accessor = { Accessor_Valid,
+                                                    Accessor_Read,
+                                                    Accessor_Write };
+
+static const LOOP_REAL_ACCESSOR *
+Real_Accessor(const BACNET_OBJECT_PROPERTY_REFERENCE *reference)
+{
+    if (reference->property_identifier != PROP_PRESENT_VALUE) {
+        return NULL;
+    }
+    if (reference->object_identifier.type == OBJECT_ANALOG_INPUT) {
+        return &Input_Accessor;
+    }
+    if (reference->object_identifier.type == OBJECT_ANALOG_OUTPUT) {
+        return &Output_Accessor;
+    }
+
+    return NULL;
+}
+
 static int Proprietary_Properties[] = { 512, 513, -1 };
 static uint8_t Proprietary_Serial_Number[16];
 
@@ -415,6 +473,74 @@ static void test_Loop_Operation(void)
     /* cleanup all */
     Loop_Cleanup();
 }
+/**
+ * @brief Test the batch timer with references bound to direct accessors
+ */
+static void test_Loop_Batch_Accessors(void)
+{
+    const uint32_t instance = 7;
+    BACNET_OBJECT_PROPERTY_REFERENCE reference = { 0 };
+    uint32_t other_instance;
+    bool status;
+
+    Loop_Init();
+    Loop_Create(instance);
+    other_instance = Loop_Create(BACNET_MAX_INSTANCE);
+    zassert_not_equal(other_instance, BACNET_MAX_INSTANCE, NULL);
+    Loop_Write_Property_Internal_Callback_Set(Write_Property_Internal);
+    Loop_Read_Property_Internal_Callback_Set(Read_Property_Internal);
+    Loop_Real_Accessor_Callback_Set(Real_Accessor);
+    Loop_Update_Interval_Set(instance, 1000);
+    status = Loop_Priority_For_Writing_Set(instance, 9);
+    zassert_true(status, NULL);
+    reference.object_identifier.type = OBJECT_ANALOG_INPUT;
+    reference.object_identifier.instance = 1;
+    reference.property_identifier = PROP_PRESENT_VALUE;
+    reference.property_array_index = BACNET_ARRAY_ALL;
+    Loop_Controlled_Variable_Reference_Set(instance, &reference);
+    reference.object_identifier.type = OBJECT_ANALOG_OUTPUT;
+    Loop_Manipulated_Variable_Reference_Set(instance, &reference);
+    /* every loop runs, and the local references skip ReadProperty
+       and WriteProperty */
+    memset(
+        &Read_Property_Internal_Data, 0, sizeof(Read_Property_Internal_Data));
+    memset(
+        &Write_Property_Internal_Data, 0, sizeof(Write_Property_Internal_Data));
+    Accessor_Input_Value = 42.0f;
+    Accessor_Write_Count = 0;
+    Loop_Timer_Batch(1000);
+    zassert_false(
+        islessgreater(
+            Loop_Controlled_Variable_Value(instance), Accessor_Input_Value),
+        NULL);
+    zassert_equal(Accessor_Write_Count, 1, NULL);
+    zassert_equal(Accessor_Output_Instance, 1, NULL);
+    zassert_equal(Accessor_Output_Priority, 9, NULL);
+    zassert_false(
+        islessgreater(Accessor_Output_Value, Loop_Present_Value(instance)),
+        NULL);
+    zassert_equal(Read_Property_Internal_Data.object_type, 0, NULL);
+    zassert_equal(Write_Property_Internal_Data.object_type, 0, NULL);
+    /* a missing local object is not read */
+    reference.object_identifier.type = OBJECT_ANALOG_INPUT;
+    reference.object_identifier.instance = 2;
+    Loop_Controlled_Variable_Reference_Set(instance, &reference);
+    Accessor_Input_Value = 10.0f;
+    Loop_Timer_Batch(100);
+    zassert_false(
+        islessgreater(Loop_Controlled_Variable_Value(instance), 42.0f), NULL);
+    /* references without an accessor use ReadProperty */
+    reference.object_identifier.type = OBJECT_ANALOG_VALUE;
+    reference.object_identifier.instance = 1;
+    Loop_Setpoint_Reference_Set(instance, &reference);
+    Read_Property_Internal_Length = 0;
+    Loop_Timer(instance, 100);
+    zassert_equal(
+        Read_Property_Internal_Data.object_type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(Read_Property_Internal_Data.object_instance, 1, NULL);
+    Loop_Real_Accessor_Callback_Set(NULL);
+    Loop_Cleanup();
+}
 /**
  * @}
  */
@@ -423,7 +549,8 @@ void test_main(void)
 {
     ztest_test_suite(
         loop_tests, ztest_unit_test(test_Loop_Read_Write),
-        ztest_unit_test(test_Loop_Operation));
+        ztest_unit_test(test_Loop_Operation),
+        ztest_unit_test(test_Loop_Batch_Accessors));
 
     ztest_run_test_suite(loop_tests);
 }
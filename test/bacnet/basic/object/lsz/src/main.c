@@ -7,6 +7,7 @@
  */
 #include <zephyr/ztest.h>
 #include <bacnet/bactext.h>
+#include <bacnet/basic/object/lsp.h>
 #include <bacnet/basic/object/lsz.h>
 #include <property_test.h>
 
@@ -53,6 +54,123 @@ static void testLifeSafetyZone(void)
     /* cleanup */
     status = Life_Safety_Zone_Delete(object_instance);
 }
+
+/**
+ * @brief Test the member state and mode counts of a zone, kept by the
+ *  changes of its member Life Safety Points
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(testsLifeSafetyZone, testLifeSafetyZoneMemberCounts)
+#else
+static void testLifeSafetyZoneMemberCounts(void)
+#endif
+{
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE member = { 0 };
+    uint32_t zone_instance, point_instance;
+    const uint32_t point_count = 10;
+    uint32_t i;
+
+    Life_Safety_Point_Init();
+    Life_Safety_Zone_Init();
+    /* points that exist before the callback are reported at once */
+    for (i = 1; i <= point_count / 2; i++) {
+        zassert_equal(Life_Safety_Point_Create(i), i, NULL);
+    }
+    Life_Safety_Point_Change_Callback_Set(Life_Safety_Zone_Point_Change);
+    for (; i <= point_count; i++) {
+        zassert_equal(Life_Safety_Point_Create(i), i, NULL);
+    }
+    zone_instance = Life_Safety_Zone_Create(1);
+    zassert_equal(zone_instance, 1, NULL);
+    member.objectIdentifier.type = OBJECT_LIFE_SAFETY_POINT;
+    member.propertyIdentifier = PROP_PRESENT_VALUE;
+    member.arrayIndex = BACNET_ARRAY_ALL;
+    member.deviceIdentifier.type = BACNET_NO_DEV_TYPE;
+    member.deviceIdentifier.instance = BACNET_NO_DEV_ID;
+    for (i = 1; i <= point_count; i++) {
+        member.objectIdentifier.instance = i;
+        zassert_true(
+            Life_Safety_Zone_Members_Add(zone_instance, &member), NULL);
+    }
+    /* a point that does not exist yet, and a point in another device */
+    member.objectIdentifier.instance = point_count + 1;
+    zassert_true(Life_Safety_Zone_Members_Add(zone_instance, &member), NULL);
+    member.objectIdentifier.instance = 1;
+    member.deviceIdentifier.type = OBJECT_DEVICE;
+    member.deviceIdentifier.instance = 1234;
+    zassert_true(Life_Safety_Zone_Members_Add(zone_instance, &member), NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_Point_Count(zone_instance), point_count, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_QUIET),
+        point_count, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_Mode_Count(
+            zone_instance, LIFE_SAFETY_MODE_DEFAULT),
+        point_count, NULL);
+    /* the changes of the points update the counts */
+    point_instance = 3;
+    zassert_true(
+        Life_Safety_Point_Present_Value_Set(
+            point_instance, LIFE_SAFETY_STATE_ALARM),
+        NULL);
+    zassert_true(
+        Life_Safety_Point_Mode_Set(point_instance, LIFE_SAFETY_MODE_TEST),
+        NULL);
+    zassert_true(
+        Life_Safety_Point_Present_Value_Set(
+            4, LIFE_SAFETY_STATE_PROPRIETARY_MIN + 1),
+        NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_QUIET),
+        point_count - 2, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_ALARM),
+        1, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_PROPRIETARY_MIN),
+        1, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_Mode_Count(
+            zone_instance, LIFE_SAFETY_MODE_TEST),
+        1, NULL);
+    /* a point created later is counted, and a deleted point is not */
+    zassert_equal(
+        Life_Safety_Point_Create(point_count + 1), point_count + 1, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_Point_Count(zone_instance), point_count + 1,
+        NULL);
+    zassert_true(Life_Safety_Point_Delete(point_instance), NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_ALARM),
+        0, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_Point_Count(zone_instance), point_count, NULL);
+    /* a member that is listed twice is counted twice */
+    member.objectIdentifier.instance = 5;
+    member.deviceIdentifier.type = BACNET_NO_DEV_TYPE;
+    zassert_true(Life_Safety_Zone_Members_Add(zone_instance, &member), NULL);
+    zassert_true(
+        Life_Safety_Point_Present_Value_Set(5, LIFE_SAFETY_STATE_FAULT), NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_FAULT),
+        2, NULL);
+    Life_Safety_Zone_Members_Clear(zone_instance);
+    zassert_equal(Life_Safety_Zone_Member_Point_Count(zone_instance), 0, NULL);
+    zassert_equal(
+        Life_Safety_Zone_Member_State_Count(
+            zone_instance, LIFE_SAFETY_STATE_FAULT),
+        0, NULL);
+    Life_Safety_Point_Change_Callback_Set(NULL);
+    Life_Safety_Point_Cleanup();
+    Life_Safety_Zone_Cleanup();
+}
 /**
  * @}
  */
@@ -62,7 +180,9 @@ ZTEST_SUITE(testsLifeSafetyZone, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(testsLifeSafetyZone, ztest_unit_test(testLifeSafetyZone));
+    ztest_test_suite(
+        testsLifeSafetyZone, ztest_unit_test(testLifeSafetyZone),
+        ztest_unit_test(testLifeSafetyZoneMemberCounts));
 
     ztest_run_test_suite(testsLifeSafetyZone);
 }
@@ -46,6 +46,70 @@ static void testMultistateOutput(void)
     status = Multistate_Output_Delete(object_instance);
     zassert_true(status, NULL);
 }
+
+/**
+ * @brief Test the present-value tracking of the priority array
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mso_tests, testMultistateOutputPriority)
+#else
+static void testMultistateOutputPriority(void)
+#endif
+{
+    bool status = false;
+    unsigned priority = 0;
+    uint32_t object_instance = BACNET_MAX_INSTANCE;
+
+    Multistate_Output_Init();
+    object_instance = Multistate_Output_Create(object_instance);
+    status = Multistate_Output_Relinquish_Default_Set(object_instance, 1);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 0, NULL);
+    zassert_equal(Multistate_Output_Present_Value(object_instance), 1, NULL);
+    status = Multistate_Output_Present_Value_Set(object_instance, 2, 8);
+    zassert_true(status, NULL);
+    status = Multistate_Output_Present_Value_Set(object_instance, 3, 12);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    zassert_equal(Multistate_Output_Present_Value(object_instance), 2, NULL);
+    /* relinquish a lower priority keeps the active priority */
+    status = Multistate_Output_Present_Value_Relinquish(object_instance, 12);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    zassert_true(
+        Multistate_Output_Priority_Array_Relinquished(object_instance, 12),
+        NULL);
+    status = Multistate_Output_Present_Value_Set(object_instance, 3, 12);
+    zassert_true(status, NULL);
+    status = Multistate_Output_Present_Value_Set(object_instance, 1, 1);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 1, NULL);
+    zassert_equal(Multistate_Output_Present_Value(object_instance), 1, NULL);
+    /* relinquish the active priority falls back to the next one */
+    status = Multistate_Output_Present_Value_Relinquish(object_instance, 1);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 8, NULL);
+    status = Multistate_Output_Present_Value_Relinquish(object_instance, 8);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 12, NULL);
+    zassert_equal(Multistate_Output_Present_Value(object_instance), 3, NULL);
+    zassert_false(
+        Multistate_Output_Priority_Array_Relinquished(object_instance, 12),
+        NULL);
+    status = Multistate_Output_Present_Value_Relinquish(object_instance, 12);
+    zassert_true(status, NULL);
+    priority = Multistate_Output_Present_Value_Priority(object_instance);
+    zassert_equal(priority, 0, NULL);
+    zassert_equal(Multistate_Output_Present_Value(object_instance), 1, NULL);
+    status = Multistate_Output_Delete(object_instance);
+    zassert_true(status, NULL);
+}
 /**
  * @}
  */
@@ -55,7 +119,8 @@ ZTEST_SUITE(mso_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(mso_tests, ztest_unit_test(testMultistateOutput));
+    ztest_test_suite(mso_tests, ztest_unit_test(testMultistateOutput),
+        ztest_unit_test(testMultistateOutputPriority));
 
     ztest_run_test_suite(mso_tests);
 }
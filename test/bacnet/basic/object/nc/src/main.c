@@ -13,6 +13,9 @@
 #include <bacnet/list_element.h>
 #include <bacnet/basic/object/nc.h>
 
+/* number of notifications sent by the stubs */
+extern unsigned Send_Event_Notify_Count;
+
 /**
  * @addtogroup bacnet_tests
  * @{
@@ -395,11 +398,56 @@ static void test_Notification_Class_Common_Reporting(void)
     bool status = false;
     BACNET_EVENT_NOTIFICATION_DATA event_data = { 0 };
 
+    BACNET_DESTINATION recipient_list[NC_MAX_RECIPIENTS] = { 0 };
+    BACNET_DESTINATION *destination;
+    BACNET_MAC_ADDRESS mac = { 0 };
+    unsigned i;
+
     Notification_Class_Init();
     status = Notification_Class_Valid_Instance(instance);
     zassert_true(status, NULL);
 
     Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Send_Event_Notify_Count, 0, NULL);
+    /* recipients by address, active all day, every day */
+    status =
+        Notification_Class_Get_Recipient_List(instance, &recipient_list[0]);
+    zassert_true(status, NULL);
+    for (i = 0; i < 3; i++) {
+        destination = &recipient_list[i];
+        bacnet_destination_default_init(destination);
+        destination->Recipient.tag = BACNET_RECIPIENT_TAG_ADDRESS;
+        mac.len = 1;
+        mac.adr[0] = 1 + i;
+        bacnet_address_init(
+            &destination->Recipient.type.address, &mac, 0, NULL);
+        destination->ProcessIdentifier = 1 + i;
+        bitstring_set_bit(
+            &destination->Transitions, TRANSITION_TO_OFFNORMAL, true);
+    }
+    /* the third recipient is only active early in the morning */
+    datetime_set_time(&recipient_list[2].ToTime, 1, 0, 0, 0);
+    status =
+        Notification_Class_Set_Recipient_List(instance, &recipient_list[0]);
+    zassert_true(status, NULL);
+    event_data.notificationClass = instance;
+    event_data.toState = EVENT_STATE_OFFNORMAL;
+    event_data.eventType = EVENT_CHANGE_OF_STATE;
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Send_Event_Notify_Count, 2, NULL);
+    /* the cache is used again for the next notification */
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Send_Event_Notify_Count, 4, NULL);
+    /* the recipients no longer want offnormal transitions */
+    for (i = 0; i < 3; i++) {
+        bitstring_set_bit(
+            &recipient_list[i].Transitions, TRANSITION_TO_OFFNORMAL, false);
+    }
+    status =
+        Notification_Class_Set_Recipient_List(instance, &recipient_list[0]);
+    zassert_true(status, NULL);
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Send_Event_Notify_Count, 4, NULL);
 }
 
 /**
@@ -18,22 +18,43 @@ uint32_t Device_Object_Instance_Number(void)
     return 0;
 }
 
-int Send_UEvent_Notify(
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* number of notifications sent, for the unit test */
+unsigned Send_Event_Notify_Count;
+
+int Send_UEvent_Notify_Body(
     uint8_t *buffer,
-    const BACNET_EVENT_NOTIFICATION_DATA *data,
+    size_t buffer_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
     BACNET_ADDRESS *dest)
 {
     (void)buffer;
-    (void)data;
+    (void)buffer_size;
+    (void)process_identifier;
+    (void)body;
+    (void)body_len;
     (void)dest;
+    Send_Event_Notify_Count++;
     return 0;
 }
 
-uint8_t
-Send_CEvent_Notify(uint32_t device_id, BACNET_EVENT_NOTIFICATION_DATA *data)
+uint8_t Send_CEvent_Notify_Body(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest)
 {
-    (void)device_id;
-    (void)data;
+    (void)pdu;
+    (void)pdu_size;
+    (void)process_identifier;
+    (void)body;
+    (void)body_len;
+    (void)dest;
+    Send_Event_Notify_Count++;
     return 0;
 }
 
@@ -49,9 +70,10 @@ bool datetime_local(
     int16_t *utc_offset_minutes,
     bool *dst_active)
 {
-    (void)bdate;
-    (void)btime;
     (void)utc_offset_minutes;
     (void)dst_active;
+    /* Monday at noon */
+    datetime_set_date(bdate, 2024, 1, 1);
+    datetime_set_time(btime, 12, 0, 0, 0);
     return true;
 }
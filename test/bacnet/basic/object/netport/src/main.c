@@ -1051,6 +1051,65 @@ static void test_network_port_sc_status_encode_decode(void)
     return;
 }
 
+static void test_network_port_sc_status_cache(void)
+{
+#ifdef BACDL_BSC
+    uint32_t instance = 1234;
+    bool status = false;
+    BACNET_DATE_TIME ts = { { 2202, 5, 7, 3 }, { 12, 34, 22, 10 } };
+    BACNET_HOST_N_PORT_DATA peer_address = { 1, "\xef\x00\x00\x10", 50001 };
+    uint8_t peer_VMAC[BACNET_PEER_VMAC_LENGTH] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t peer_UUID[16] = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    uint8_t apdu[MAX_APDU];
+    uint8_t apdu2[MAX_APDU];
+    int len;
+    int len2;
+
+    Network_Port_Init();
+    status = Network_Port_Object_Instance_Number_Set(0, instance);
+    zassert_true(status, NULL);
+    rpdata.application_data = &apdu[0];
+    rpdata.application_data_len = sizeof(apdu);
+    rpdata.object_type = OBJECT_NETWORK_PORT;
+    rpdata.object_instance = instance;
+    rpdata.object_property = PROP_SC_FAILED_CONNECTION_REQUESTS;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+
+    Network_Port_SC_Failed_Connection_Requests_Delete_All(instance);
+    status = Network_Port_SC_Failed_Connection_Requests_Add(
+        instance, &ts, &peer_address, peer_VMAC, peer_UUID,
+        ERROR_CODE_VT_SESSION_ALREADY_CLOSED, "error details");
+    zassert_true(status, NULL);
+    len = Network_Port_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    memcpy(apdu2, apdu, len);
+    /* the list rebuilt with the same entry reads the same */
+    Network_Port_SC_Failed_Connection_Requests_Delete_All(instance);
+    status = Network_Port_SC_Failed_Connection_Requests_Add(
+        instance, &ts, &peer_address, peer_VMAC, peer_UUID,
+        ERROR_CODE_VT_SESSION_ALREADY_CLOSED, "error details");
+    zassert_true(status, NULL);
+    memset(apdu, 0, sizeof(apdu));
+    len2 = Network_Port_Read_Property(&rpdata);
+    zassert_equal(len2, len, NULL);
+    zassert_mem_equal(apdu, apdu2, len, NULL);
+    /* a changed entry is encoded again */
+    Network_Port_SC_Failed_Connection_Requests_Delete_All(instance);
+    status = Network_Port_SC_Failed_Connection_Requests_Add(
+        instance, &ts, &peer_address, peer_VMAC, peer_UUID,
+        ERROR_CODE_VT_SESSION_ALREADY_CLOSED, "other details");
+    zassert_true(status, NULL);
+    len2 = Network_Port_Read_Property(&rpdata);
+    zassert_equal(len2, len, NULL);
+    zassert_true(memcmp(apdu, apdu2, len) != 0, NULL);
+    /* as is a list with fewer entries */
+    Network_Port_SC_Failed_Connection_Requests_Delete_All(instance);
+    len2 = Network_Port_Read_Property(&rpdata);
+    zassert_equal(len2, 0, NULL);
+#endif /* BACDL_BSC */
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST_SUITE(netport_tests, NULL, NULL, NULL, NULL, NULL);
 #else
@@ -1061,7 +1120,8 @@ void test_main(void)
         ztest_unit_test(test_network_port_pending_param),
         ztest_unit_test(test_network_port_sc_direct_connect_accept_uri),
         ztest_unit_test(test_network_port_sc_certificates),
-        ztest_unit_test(test_network_port_sc_status_encode_decode));
+        ztest_unit_test(test_network_port_sc_status_encode_decode),
+        ztest_unit_test(test_network_port_sc_status_cache));
 
     ztest_run_test_suite(netport_tests);
 }
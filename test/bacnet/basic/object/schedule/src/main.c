@@ -123,6 +123,71 @@ static void testSchedule(void)
     Schedule_Recalculate_PV(
         Schedule_Object(object_instance), BACNET_WEEKDAY_SUNDAY, &time_of_day);
 }
+
+/**
+ * @brief Test the Present_Value transitions of the Weekly_Schedule
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(schedule_tests, testScheduleTransition)
+#else
+static void testScheduleTransition(void)
+#endif
+{
+    uint32_t object_instance = 0;
+    BACNET_DAILY_SCHEDULE daily_schedule = { 0 };
+    BACNET_TIME time_of_day = { 0 };
+    SCHEDULE_DESCR *pObject;
+
+    Schedule_Init();
+    object_instance = Schedule_Index_To_Instance(0);
+    pObject = Schedule_Object(object_instance);
+    zassert_not_null(pObject, NULL);
+    daily_schedule.TV_Count = 1;
+    datetime_set_time(&daily_schedule.Time_Values[0].Time, 8, 0, 0, 0);
+    daily_schedule.Time_Values[0].Value.tag = BACNET_APPLICATION_TAG_REAL;
+    daily_schedule.Time_Values[0].Value.type.Real = 1.0f;
+    zassert_true(
+        Schedule_Weekly_Schedule_Set(object_instance, 0, &daily_schedule),
+        NULL);
+    /* before the first transition is the Schedule_Default */
+    datetime_set_time(&time_of_day, 7, 0, 0, 0);
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_MONDAY, &time_of_day);
+    zassert_true(pObject->Transition_Valid, NULL);
+    zassert_true(pObject->Next_Transition_Valid, NULL);
+    zassert_equal(pObject->Next_Transition_Time.hour, 8, NULL);
+    zassert_equal(
+        pObject->Present_Value.tag, pObject->Schedule_Default.tag, NULL);
+    zassert_false(
+        islessgreater(
+            pObject->Present_Value.type.Real,
+            pObject->Schedule_Default.type.Real),
+        NULL);
+    datetime_set_time(&time_of_day, 7, 59, 59, 99);
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_MONDAY, &time_of_day);
+    zassert_equal(pObject->Transition_Index, -1, NULL);
+    /* at the transition */
+    datetime_set_time(&time_of_day, 8, 0, 0, 0);
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_MONDAY, &time_of_day);
+    zassert_equal(pObject->Transition_Index, 0, NULL);
+    zassert_false(pObject->Next_Transition_Valid, NULL);
+    zassert_false(islessgreater(pObject->Present_Value.type.Real, 1.0f), NULL);
+    /* a change of the schedule is evaluated again */
+    daily_schedule.Time_Values[0].Value.type.Real = 2.0f;
+    datetime_set_time(&daily_schedule.Time_Values[0].Time, 9, 0, 0, 0);
+    zassert_true(
+        Schedule_Weekly_Schedule_Set(object_instance, 0, &daily_schedule),
+        NULL);
+    zassert_false(pObject->Transition_Valid, NULL);
+    datetime_set_time(&time_of_day, 8, 30, 0, 0);
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_MONDAY, &time_of_day);
+    zassert_equal(pObject->Transition_Index, -1, NULL);
+    datetime_set_time(&time_of_day, 9, 30, 0, 0);
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_MONDAY, &time_of_day);
+    zassert_false(islessgreater(pObject->Present_Value.type.Real, 2.0f), NULL);
+    /* a change of the day is evaluated again */
+    Schedule_Recalculate_PV(pObject, BACNET_WEEKDAY_TUESDAY, &time_of_day);
+    zassert_equal(pObject->Transition_Index, -1, NULL);
+}
 /**
  * @}
  */
@@ -132,7 +197,9 @@ ZTEST_SUITE(schedule_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(schedule_tests, ztest_unit_test(testSchedule));
+    ztest_test_suite(
+        schedule_tests, ztest_unit_test(testSchedule),
+        ztest_unit_test(testScheduleTransition));
 
     ztest_run_test_suite(schedule_tests);
 }
@@ -100,6 +100,109 @@ static void test_object_structured_view(void)
         sizeof(test_subordinate_data));
     zassert_equal(diff, 0, NULL);
 }
+/**
+ * @brief Test the cached hierarchy below a view
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tests_object_structured_view, test_object_structured_view_hierarchy)
+#else
+static void test_object_structured_view_hierarchy(void)
+#endif
+{
+    /* view 1 holds an input and view 2, which holds a value, view 1
+       again, and a view of another device */
+    BACNET_SUBORDINATE_DATA view_1[2] = { 0 }, view_2[3] = { 0 };
+    const BACNET_STRUCTURED_VIEW_NODE *hierarchy;
+    unsigned count = 0;
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+    BACNET_READ_RANGE_DATA rrdata = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int len = 0;
+#endif
+
+    Structured_View_Init();
+    zassert_equal(Structured_View_Create(1), 1, NULL);
+    zassert_equal(Structured_View_Create(2), 2, NULL);
+    view_1[0].Object_Type = OBJECT_ANALOG_INPUT;
+    view_1[0].Object_Instance = 10;
+    view_1[0].next = &view_1[1];
+    view_1[1].Object_Type = OBJECT_STRUCTURED_VIEW;
+    view_1[1].Object_Instance = 2;
+    view_2[0].Object_Type = OBJECT_BINARY_VALUE;
+    view_2[0].Object_Instance = 20;
+    view_2[0].next = &view_2[1];
+    view_2[1].Object_Type = OBJECT_STRUCTURED_VIEW;
+    view_2[1].Object_Instance = 1;
+    view_2[1].next = &view_2[2];
+    view_2[2].Device_Instance = 99;
+    view_2[2].Object_Type = OBJECT_STRUCTURED_VIEW;
+    view_2[2].Object_Instance = 2;
+    Structured_View_Subordinate_List_Set(1, &view_1[0]);
+    Structured_View_Subordinate_List_Set(2, &view_2[0]);
+    hierarchy = Structured_View_Hierarchy(1, &count);
+    zassert_not_null(hierarchy, NULL);
+    zassert_equal(count, 6, NULL);
+    zassert_equal(hierarchy[0].Object_Type, OBJECT_STRUCTURED_VIEW, NULL);
+    zassert_equal(hierarchy[0].Object_Instance, 1, NULL);
+    zassert_equal(hierarchy[0].Parent, 0, NULL);
+    zassert_equal(hierarchy[0].Depth, 0, NULL);
+    zassert_equal(hierarchy[1].Object_Instance, 10, NULL);
+    zassert_equal(hierarchy[1].Parent, 1, NULL);
+    zassert_equal(hierarchy[2].Object_Instance, 2, NULL);
+    zassert_equal(hierarchy[2].Depth, 1, NULL);
+    zassert_equal(hierarchy[3].Object_Instance, 20, NULL);
+    zassert_equal(hierarchy[3].Parent, 3, NULL);
+    zassert_equal(hierarchy[3].Depth, 2, NULL);
+    /* the loop back to view 1 and the remote view are not descended */
+    zassert_equal(hierarchy[4].Object_Instance, 1, NULL);
+    zassert_equal(hierarchy[5].Device_Instance, 99, NULL);
+    zassert_equal(hierarchy[5].Parent, 3, NULL);
+    /* cached until a Subordinate_List changes */
+    zassert_true(Structured_View_Hierarchy(1, &count) == hierarchy, NULL);
+    Structured_View_Subordinate_List_Set(2, &view_2[2]);
+    hierarchy = Structured_View_Hierarchy(1, &count);
+    zassert_equal(count, 4, NULL);
+    hierarchy = Structured_View_Hierarchy(2, &count);
+    zassert_equal(count, 2, NULL);
+    zassert_is_null(Structured_View_Hierarchy(3, &count), NULL);
+    zassert_equal(count, 0, NULL);
+#if defined(BACNET_STRUCTURED_VIEW_HIERARCHY)
+    /* fetch the tree two nodes at a time */
+    Structured_View_Subordinate_List_Set(2, &view_2[0]);
+    rrdata.object_type = OBJECT_STRUCTURED_VIEW;
+    rrdata.object_instance = 1;
+    rrdata.object_property = PROP_STRUCTURED_VIEW_HIERARCHY;
+    rrdata.array_index = BACNET_ARRAY_ALL;
+    rrdata.RequestType = RR_BY_POSITION;
+    rrdata.Range.RefIndex = 1;
+    rrdata.Count = 2;
+    len = Structured_View_Read_Range_Hierarchy(apdu, &rrdata);
+    zassert_true(len > 0, NULL);
+    zassert_equal(rrdata.ItemCount, 2, NULL);
+    zassert_true(
+        bitstring_bit(&rrdata.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+    zassert_false(
+        bitstring_bit(&rrdata.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+    zassert_equal(
+        len,
+        Structured_View_Hierarchy_Node_Encode(NULL, &hierarchy[0]) +
+            Structured_View_Hierarchy_Node_Encode(NULL, &hierarchy[1]),
+        NULL);
+    rrdata.Range.RefIndex = 6;
+    rrdata.Count = -2;
+    len = Structured_View_Read_Range_Hierarchy(apdu, &rrdata);
+    zassert_true(len > 0, NULL);
+    zassert_equal(rrdata.ItemCount, 2, NULL);
+    zassert_true(
+        bitstring_bit(&rrdata.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+    rrdata.Range.RefIndex = 7;
+    rrdata.Count = 1;
+    len = Structured_View_Read_Range_Hierarchy(apdu, &rrdata);
+    zassert_equal(len, 0, NULL);
+    zassert_equal(rrdata.ItemCount, 0, NULL);
+#endif
+    Structured_View_Cleanup();
+}
 /**
  * @}
  */
@@ -111,7 +214,8 @@ void test_main(void)
 {
     ztest_test_suite(
         tests_object_structured_view,
-        ztest_unit_test(test_object_structured_view));
+        ztest_unit_test(test_object_structured_view),
+        ztest_unit_test(test_object_structured_view_hierarchy));
 
     ztest_run_test_suite(tests_object_structured_view);
 }
@@ -15,6 +15,11 @@ bool apdu_service_supported(BACNET_SERVICES_SUPPORTED service_supported)
     return true;
 }
 
+unsigned apdu_service_handler_revision(void)
+{
+    return 0;
+}
+
 static uint16_t Timeout_Milliseconds = 1000;
 uint16_t apdu_timeout(void)
 {
@@ -37,6 +42,17 @@ void apdu_retries_set(uint8_t value)
     Number_Of_Retries = value;
 }
 
+static uint16_t Max_APDU_Length_Accepted = MAX_APDU;
+uint16_t apdu_max_length_accepted(void)
+{
+    return Max_APDU_Length_Accepted;
+}
+
+void apdu_max_length_accepted_set(uint16_t value)
+{
+    Max_APDU_Length_Accepted = value;
+}
+
 uint16_t apdu_decode_confirmed_service_request(
     uint8_t *apdu,
     uint16_t apdu_len,
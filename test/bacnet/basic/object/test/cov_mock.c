@@ -15,3 +15,16 @@ int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
     (void)max_apdu;
     return 0;
 }
+
+bool handler_cov_bulk_function_set(
+    BACNET_OBJECT_TYPE object_type, cov_object_bulk_function function)
+{
+    (void)object_type;
+    (void)function;
+    return true;
+}
+
+void handler_cov_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    (void)usage;
+}
@@ -46,3 +46,61 @@ int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
     (void)rpdata;
     return 0;
 }
+
+bool Device_Value_List_Supported(BACNET_OBJECT_TYPE object_type)
+{
+    (void)object_type;
+    return false;
+}
+
+bool Device_Encode_Value_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE *value_list)
+{
+    (void)object_type;
+    (void)object_instance;
+    (void)value_list;
+    return false;
+}
+
+void Device_Timer_Scheduled_Set(BACNET_OBJECT_TYPE object_type, bool scheduled)
+{
+    (void)object_type;
+    (void)scheduled;
+}
+
+void Device_Timer_Wakeup(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds)
+{
+    (void)object_type;
+    (void)object_instance;
+    (void)milliseconds;
+}
+
+void Device_Timer_Deadline(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    uint32_t milliseconds)
+{
+    (void)object_type;
+    (void)object_instance;
+    (void)milliseconds;
+}
+
+void Device_Timer_Cancel(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    (void)object_type;
+    (void)object_instance;
+}
+
+uint32_t Device_Timer_Remaining(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    (void)object_type;
+    (void)object_instance;
+    return UINT32_MAX;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief mock for the event notification and alarm service functions
+ *  used by the objects with intrinsic reporting
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/bacdef.h>
+#include <bacnet/alarm_ack.h>
+#include <bacnet/event.h>
+#include <bacnet/getevent.h>
+#include <bacnet/get_alarm_sum.h>
+#include <bacnet/npdu.h>
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+
+int Send_UEvent_Notify_Body(
+    uint8_t *buffer,
+    size_t buffer_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest)
+{
+    (void)buffer;
+    (void)buffer_size;
+    (void)process_identifier;
+    (void)body;
+    (void)body_len;
+    (void)dest;
+    return 0;
+}
+
+uint8_t Send_CEvent_Notify_Body(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    uint32_t process_identifier,
+    const uint8_t *body,
+    size_t body_len,
+    BACNET_ADDRESS *dest)
+{
+    (void)pdu;
+    (void)pdu_size;
+    (void)process_identifier;
+    (void)body;
+    (void)body_len;
+    (void)dest;
+    return 0;
+}
+
+void Send_WhoIs(int32_t low_limit, int32_t high_limit)
+{
+    (void)low_limit;
+    (void)high_limit;
+}
+
+void handler_get_event_information_set(
+    BACNET_OBJECT_TYPE object_type, get_event_info_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_event_information_index_set(
+    BACNET_OBJECT_TYPE object_type, get_event_index_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance, bool active)
+{
+    (void)object_type;
+    (void)object_instance;
+    (void)active;
+}
+
+void handler_alarm_ack_set(
+    BACNET_OBJECT_TYPE object_type, alarm_ack_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_alarm_summary_set(
+    BACNET_OBJECT_TYPE object_type, get_alarm_summary_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
@@ -24,3 +24,8 @@ bool tsm_get_transaction_pdu(
 
     return false;
 }
+
+void tsm_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    (void)usage;
+}
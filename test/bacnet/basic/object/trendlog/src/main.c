@@ -37,6 +37,173 @@ static void test_Trend_Log_ReadProperty(void)
         Trend_Log_Read_Property, Trend_Log_Write_Property,
         known_fail_property_list);
 }
+
+/**
+ * @brief Test ReadRange by time finds the same records as a scan
+ */
+static void test_Trend_Log_Read_Range_By_Time(void)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_RANGE_DATA request = { 0 };
+    int len = 0;
+
+    Trend_Log_Init();
+    request.object_instance = Trend_Log_Index_To_Instance(0);
+    request.RequestType = RR_BY_TIME;
+    request.Overhead = RR_OVERHEAD;
+    /* the test records are 15 minutes apart from the first of January */
+    datetime_set_values(&request.Range.RefTime, 2009, 1, 1, 2, 30, 0, 0);
+    request.Count = 5;
+    len = TL_encode_by_time(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9012, NULL);
+    request.ItemCount = 0;
+    request.Count = -5;
+    len = TL_encode_by_time(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9006, NULL);
+    /* before the first record */
+    bitstring_init(&request.ResultFlags);
+    request.ItemCount = 0;
+    request.Count = 1;
+    datetime_set_values(&request.Range.RefTime, 2008, 1, 1, 0, 0, 0, 0);
+    len = TL_encode_by_time(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.FirstSequence, 9001, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+    request.Count = -1;
+    len = TL_encode_by_time(apdu, &request);
+    zassert_equal(len, 0, NULL);
+    /* after the last record */
+    request.Count = 1;
+    datetime_set_values(&request.Range.RefTime, 2010, 1, 1, 0, 0, 0, 0);
+    len = TL_encode_by_time(apdu, &request);
+    zassert_equal(len, 0, NULL);
+}
+
+/**
+ * @brief Test a log buffer supplied by the application
+ */
+static void test_Trend_Log_Buffer(void)
+{
+    static TL_DATA_REC records[5];
+    TL_LOG_BUFFER_STATE state = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_UNSIGNED_INTEGER unsigned_value = 0;
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint32_t object_instance = 0;
+    unsigned i = 0;
+    int len = 0;
+    bool status = false;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(1);
+    status = Trend_Log_Buffer_Set(
+        object_instance, records, ARRAY_SIZE(records), &state);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 5, NULL);
+    zassert_equal(state.ulBufferSize, 5, NULL);
+    zassert_equal(state.ulRecordCount, 0, NULL);
+    rpdata.object_type = OBJECT_TRENDLOG;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = PROP_BUFFER_SIZE;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    len = Trend_Log_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacnet_unsigned_application_decode(apdu, len, &unsigned_value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(unsigned_value, 5, NULL);
+    /* the ring wraps, and the state follows it */
+    for (i = 0; i < 7; i++) {
+        TL_Insert_Status_Rec(1, LOG_STATUS_LOG_INTERRUPTED, true);
+    }
+    zassert_equal(state.ulRecordCount, 5, NULL);
+    zassert_equal(state.ulTotalRecordCount, 7, NULL);
+    zassert_equal(state.ulIndex, 2, NULL);
+    /* the records are kept when the buffer is set again */
+    status = Trend_Log_Buffer_Set(
+        object_instance, records, ARRAY_SIZE(records), &state);
+    zassert_true(status, NULL);
+    zassert_equal(state.ulTotalRecordCount, 7, NULL);
+    /* but not with another size */
+    status = Trend_Log_Buffer_Set(object_instance, records, 4, &state);
+    zassert_true(status, NULL);
+    zassert_equal(state.ulRecordCount, 0, NULL);
+    zassert_equal(state.ulBufferSize, 4, NULL);
+    /* back to the built-in buffer */
+    status = Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+}
+
+/**
+ * @brief Test a COV log reads the object only when it reports a change
+ */
+static void test_Trend_Log_COV(void)
+{
+    static TL_DATA_REC records[5];
+    TL_LOG_BUFFER_STATE state = { 0 };
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_DATE_TIME bdatetime = { 0 };
+    uint32_t object_instance = 0;
+    bool status = false;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(2);
+    wp_data.object_type = OBJECT_TRENDLOG;
+    wp_data.object_instance = object_instance;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.priority = BACNET_NO_PRIORITY;
+    /* log at any time */
+    datetime_wildcard_set(&bdatetime);
+    wp_data.application_data_len =
+        encode_application_date(wp_data.application_data, &bdatetime.date);
+    wp_data.application_data_len += encode_application_time(
+        &wp_data.application_data[wp_data.application_data_len],
+        &bdatetime.time);
+    wp_data.object_property = PROP_START_TIME;
+    status = Trend_Log_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    wp_data.object_property = PROP_STOP_TIME;
+    status = Trend_Log_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    wp_data.object_property = PROP_LOGGING_TYPE;
+    wp_data.application_data_len = encode_application_enumerated(
+        wp_data.application_data, LOGGING_TYPE_COV);
+    status = Trend_Log_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+    status = Trend_Log_Buffer_Set(
+        object_instance, records, ARRAY_SIZE(records), &state);
+    zassert_true(status, NULL);
+    /* a first reading, then none until the object changes */
+    trend_log_timer(1);
+    zassert_equal(state.ulRecordCount, 1, NULL);
+    trend_log_timer(1);
+    trend_log_timer(1);
+    zassert_equal(state.ulRecordCount, 1, NULL);
+    /* another object changed */
+    Trend_Log_Object_Changed(OBJECT_ANALOG_INPUT, 3);
+    trend_log_timer(1);
+    zassert_equal(state.ulRecordCount, 1, NULL);
+    Trend_Log_Object_Changed(OBJECT_ANALOG_INPUT, 2);
+    Trend_Log_Object_Changed(OBJECT_ANALOG_INPUT, 2);
+    trend_log_timer(1);
+    zassert_equal(state.ulRecordCount, 2, NULL);
+    trend_log_timer(1);
+    zassert_equal(state.ulRecordCount, 2, NULL);
+    /* not a logging type */
+    wp_data.application_data_len =
+        encode_application_enumerated(wp_data.application_data, 3);
+    status = Trend_Log_Write_Property(&wp_data);
+    zassert_false(status, NULL);
+    zassert_equal(wp_data.error_code, ERROR_CODE_VALUE_OUT_OF_RANGE, NULL);
+    Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+}
 /**
  * @}
  */
@@ -44,7 +211,10 @@ static void test_Trend_Log_ReadProperty(void)
 void test_main(void)
 {
     ztest_test_suite(
-        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadProperty));
+        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadProperty),
+        ztest_unit_test(test_Trend_Log_Read_Range_By_Time),
+        ztest_unit_test(test_Trend_Log_Buffer),
+        ztest_unit_test(test_Trend_Log_COV));
 
     ztest_run_test_suite(trendlog_tests);
 }
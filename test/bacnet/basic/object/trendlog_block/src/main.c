@@ -0,0 +1,319 @@
+/**
+ * @file
+ * @brief Unit test for compressed Trend Log record blocks
+ * @copyright SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/object/trendlog.h>
+#include <bacnet/basic/object/trendlog_block.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Compare a decoded record with the record that was appended
+ */
+static void test_record_same(const TL_DATA_REC *pIn, const TL_DATA_REC *pOut)
+{
+    zassert_equal(pIn->tTimeStamp, pOut->tTimeStamp, NULL);
+    zassert_equal(pIn->ucRecType, pOut->ucRecType, NULL);
+    if (pIn->ucStatus & 0x80) {
+        zassert_equal(pOut->ucStatus, 0x80 | (pIn->ucStatus & 0x0F), NULL);
+    } else {
+        zassert_equal(pOut->ucStatus, 0, NULL);
+    }
+    switch (pIn->ucRecType) {
+        case TL_TYPE_REAL:
+            zassert_true(
+                memcmp(
+                    &pIn->Datum.fReal, &pOut->Datum.fReal,
+                    sizeof(pIn->Datum.fReal)) == 0,
+                NULL);
+            break;
+        case TL_TYPE_BOOL:
+            zassert_equal(pIn->Datum.ucBoolean, pOut->Datum.ucBoolean, NULL);
+            break;
+        case TL_TYPE_STATUS:
+            zassert_equal(
+                pIn->Datum.ucLogStatus, pOut->Datum.ucLogStatus, NULL);
+            break;
+        case TL_TYPE_SIGN:
+            zassert_equal(pIn->Datum.lSValue, pOut->Datum.lSValue, NULL);
+            break;
+        case TL_TYPE_UNSIGN:
+            zassert_equal(pIn->Datum.ulUValue, pOut->Datum.ulUValue, NULL);
+            break;
+        case TL_TYPE_ERROR:
+            zassert_equal(
+                pIn->Datum.Error.usClass, pOut->Datum.Error.usClass, NULL);
+            zassert_equal(
+                pIn->Datum.Error.usCode, pOut->Datum.Error.usCode, NULL);
+            break;
+        case TL_TYPE_BITS:
+            zassert_equal(
+                pIn->Datum.Bits.ucLen, pOut->Datum.Bits.ucLen, NULL);
+            zassert_true(
+                memcmp(
+                    pIn->Datum.Bits.ucStore, pOut->Datum.Bits.ucStore,
+                    (pIn->Datum.Bits.ucLen >> 4) & 0x0F) == 0,
+                NULL);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Test a steady series of REAL values packs tightly
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(trendlog_block_tests, test_TL_Block_Real)
+#else
+static void test_TL_Block_Real(void)
+#endif
+{
+    static TL_BLOCK block;
+    static TL_DATA_REC records[TL_BLOCK_BYTES * 8];
+    TL_BLOCK_STATE state = { 0 };
+    TL_DATA_REC record = { 0 };
+    uint16_t count = 0;
+    uint16_t i = 0;
+
+    TL_Block_Init(&block);
+    zassert_equal(TL_Block_Count(&block), 0, NULL);
+    zassert_false(TL_Block_Full(&block), NULL);
+    for (i = 0; i < ARRAY_SIZE(records); i++) {
+        records[i].tTimeStamp = 1230768000 + (bacnet_time_t)i * 900;
+        records[i].ucRecType = TL_TYPE_REAL;
+        records[i].ucStatus = 0;
+        records[i].Datum.fReal = 20.0f + (float)(i % 8) * 0.5f;
+        if (!TL_Block_Append(&block, &records[i])) {
+            break;
+        }
+    }
+    count = TL_Block_Count(&block);
+    zassert_equal(count, i, NULL);
+    /* at least four times as many records as uncompressed */
+    zassert_true(
+        (count * sizeof(TL_DATA_REC)) > (4 * sizeof(TL_BLOCK)), NULL);
+    zassert_true(TL_Block_Full(&block), NULL);
+    TL_Block_Start(&block, &state);
+    for (i = 0; i < count; i++) {
+        zassert_true(TL_Block_Next(&block, &state, &record), NULL);
+        test_record_same(&records[i], &record);
+    }
+    zassert_false(TL_Block_Next(&block, &state, &record), NULL);
+}
+
+/**
+ * @brief Test irregular time stamps and changes of type and status
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(trendlog_block_tests, test_TL_Block_Mixed)
+#else
+static void test_TL_Block_Mixed(void)
+#endif
+{
+    static const int32_t deltas[] = { 0,      900,     900,  901,   5,
+                                      -30,    4000,    3,    86400, 900,
+                                      600000, -600000, 1,    900,   900,
+                                      90000000, 2,     900 };
+    static TL_BLOCK block;
+    TL_DATA_REC records[ARRAY_SIZE(deltas)] = { 0 };
+    TL_BLOCK_STATE state = { 0 };
+    TL_DATA_REC record = { 0 };
+    bacnet_time_t tClock = 1230768000;
+    unsigned i = 0;
+
+    for (i = 0; i < ARRAY_SIZE(records); i++) {
+        tClock += deltas[i];
+        records[i].tTimeStamp = tClock;
+        switch (i % 9) {
+            case 0:
+                records[i].ucRecType = TL_TYPE_REAL;
+                records[i].Datum.fReal = -1.5f * (float)i;
+                break;
+            case 1:
+                records[i].ucRecType = TL_TYPE_BOOL;
+                records[i].Datum.ucBoolean = i & 1;
+                break;
+            case 2:
+                records[i].ucRecType = TL_TYPE_STATUS;
+                records[i].Datum.ucLogStatus = 1 << (i % 3);
+                break;
+            case 3:
+                records[i].ucRecType = TL_TYPE_SIGN;
+                records[i].Datum.lSValue = -100000 * (int32_t)i;
+                break;
+            case 4:
+                records[i].ucRecType = TL_TYPE_UNSIGN;
+                records[i].Datum.ulUValue = 0xFFFFFFF0UL + i;
+                break;
+            case 5:
+                records[i].ucRecType = TL_TYPE_ERROR;
+                records[i].Datum.Error.usClass = ERROR_CLASS_PROPERTY;
+                records[i].Datum.Error.usCode = ERROR_CODE_UNKNOWN_PROPERTY;
+                break;
+            case 6:
+                records[i].ucRecType = TL_TYPE_BITS;
+                records[i].Datum.Bits.ucLen = (3 << 4) | 5;
+                records[i].Datum.Bits.ucStore[0] = 0xA5;
+                records[i].Datum.Bits.ucStore[1] = 0x0F;
+                records[i].Datum.Bits.ucStore[2] = (uint8_t)i;
+                break;
+            case 7:
+                records[i].ucRecType = TL_TYPE_NULL;
+                break;
+            default:
+                records[i].ucRecType = TL_TYPE_REAL;
+                records[i].Datum.fReal = 1.0e30f;
+                break;
+        }
+        records[i].ucStatus = (i & 2) ? (0x80 | (uint8_t)(i & 0x0F)) : 0;
+    }
+    TL_Block_Init(&block);
+    for (i = 0; i < ARRAY_SIZE(records); i++) {
+        zassert_true(TL_Block_Append(&block, &records[i]), NULL);
+    }
+    zassert_equal(TL_Block_Count(&block), ARRAY_SIZE(records), NULL);
+    TL_Block_Start(&block, &state);
+    for (i = 0; i < ARRAY_SIZE(records); i++) {
+        zassert_true(TL_Block_Next(&block, &state, &record), NULL);
+        test_record_same(&records[i], &record);
+    }
+    zassert_false(TL_Block_Next(&block, &state, &record), NULL);
+    /* a record that does not fit leaves the block as it was */
+    record = records[0];
+    while (TL_Block_Append(&block, &record)) {
+        record.tTimeStamp += 7919 * (bacnet_time_t)TL_Block_Count(&block);
+        record.Datum.fReal = (float)record.tTimeStamp;
+    }
+    i = TL_Block_Count(&block);
+    zassert_false(TL_Block_Append(&block, &record), NULL);
+    zassert_equal(TL_Block_Count(&block), i, NULL);
+    TL_Block_Start(&block, &state);
+    while (TL_Block_Next(&block, &state, &record)) {
+    }
+    zassert_equal(state.usRecord, i, NULL);
+    zassert_equal(state.usBit, block.Last.usBit, NULL);
+}
+
+/**
+ * @brief Read the Record_Count of a Trend Log
+ */
+static uint32_t test_record_count(uint32_t object_instance)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_UNSIGNED_INTEGER unsigned_value = 0;
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int len = 0;
+
+    rpdata.object_type = OBJECT_TRENDLOG;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = PROP_RECORD_COUNT;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    len = Trend_Log_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacnet_unsigned_application_decode(apdu, len, &unsigned_value);
+    zassert_true(len > 0, NULL);
+
+    return (uint32_t)unsigned_value;
+}
+
+/**
+ * @brief Test ReadRange of a Trend Log in compressed blocks
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(trendlog_block_tests, test_Trend_Log_Compressed)
+#else
+static void test_Trend_Log_Compressed(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_RANGE_DATA request = { 0 };
+    uint32_t object_instance = 0;
+    uint32_t count = 0;
+    uint32_t total = 0;
+    unsigned i = 0;
+    int len = 0;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(0);
+    /* the test records all fit in the memory of the raw records */
+    zassert_equal(test_record_count(object_instance), TL_MAX_ENTRIES, NULL);
+    zassert_true(
+        Trend_Log_Buffer_Size(object_instance) > TL_MAX_ENTRIES, NULL);
+    request.object_instance = object_instance;
+    request.RequestType = RR_BY_TIME;
+    request.Overhead = RR_OVERHEAD;
+    datetime_set_values(&request.Range.RefTime, 2009, 1, 1, 2, 30, 0, 0);
+    request.Count = 5;
+    len = TL_encode_by_time(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9012, NULL);
+    request.ItemCount = 0;
+    request.Count = -5;
+    len = TL_encode_by_time(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9006, NULL);
+    /* sequential reads walk the blocks from the cursor */
+    request.RequestType = RR_BY_POSITION;
+    request.Range.RefIndex = 1;
+    request.Count = (int32_t)TL_MAX_ENTRIES;
+    while (request.Range.RefIndex <= TL_MAX_ENTRIES) {
+        request.ItemCount = 0;
+        len = TL_encode_by_position(apdu, &request);
+        zassert_true(len > 0, NULL);
+        zassert_true(request.ItemCount > 0, NULL);
+        request.Range.RefIndex += request.ItemCount;
+        request.Count -= (int32_t)request.ItemCount;
+    }
+    zassert_equal(request.Count, 0, NULL);
+    /* the oldest block is dropped when the blocks are full */
+    total = 10000;
+    for (i = 0; i < (TL_MAX_ENTRIES * 20); i++) {
+        TL_Insert_Status_Rec(0, LOG_STATUS_LOG_DISABLED, i & 1);
+        total++;
+        count = test_record_count(object_instance);
+        zassert_true(count > 0, NULL);
+        zassert_true(count <= Trend_Log_Buffer_Size(object_instance), NULL);
+    }
+    zassert_true(count < (TL_MAX_ENTRIES * 20), NULL);
+    request.RequestType = RR_BY_SEQUENCE;
+    request.Range.RefSeqNum = total;
+    request.Count = -1;
+    request.ItemCount = 0;
+    len = TL_encode_by_sequence(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 1, NULL);
+    zassert_equal(request.FirstSequence, total, NULL);
+    /* back to the built-in buffer, which starts out empty */
+    zassert_true(Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL), NULL);
+    zassert_equal(test_record_count(object_instance), 0, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(trendlog_block_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        trendlog_block_tests, ztest_unit_test(test_TL_Block_Real),
+        ztest_unit_test(test_TL_Block_Mixed),
+        ztest_unit_test(test_Trend_Log_Compressed));
+
+    ztest_run_test_suite(trendlog_block_tests);
+}
+#endif
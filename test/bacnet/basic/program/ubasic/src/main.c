@@ -428,6 +428,50 @@ static void test_ubasic(void)
 
     return;
 }
+/**
+ * @brief Test goto and gosub to labels
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ubasic_tests, test_ubasic_labels)
+#else
+static void test_ubasic_labels(void)
+#endif
+{
+    struct ubasic_data data = { 0 };
+    const char *program =
+        "n = 0;"
+        "m = 0;"
+        ":_loop "
+        "  n = n + 1;"
+        "  gosub _add;"
+        "  if n < 5 then goto _loop;"
+        "goto _done;"
+        "m = 100;"
+        ":_add "
+        "  m = m + n;"
+        "return;"
+        ":_done "
+        "end;";
+    UBASIC_VARIABLE_TYPE value = 0;
+    int32_t value_int = 0;
+
+    ubasic_load_program(&data, program);
+    zassert_equal(data.status.bit.isRunning, 1, NULL);
+#if UBASIC_LABEL_TABLE_SIZE > 0
+    zassert_equal(data.label_count, 3, NULL);
+#endif
+    while (!ubasic_finished(&data)) {
+        ubasic_run_program(&data);
+    }
+    zassert_equal(data.status.bit.Error, 0, NULL);
+    value = ubasic_get_variable(&data, 'n');
+    value_int = fixedpt_toint(value);
+    zassert_equal(value_int, 5, NULL);
+    value = ubasic_get_variable(&data, 'm');
+    value_int = fixedpt_toint(value);
+    zassert_equal(value_int, 15, NULL);
+}
+
 /**
  * @}
  */
@@ -440,7 +484,8 @@ void test_main(void)
     ztest_test_suite(
         ubasic_tests, ztest_unit_test(test_ubasic),
         ztest_unit_test(test_ubasic_math), ztest_unit_test(test_ubasic_bacnet),
-        ztest_unit_test(test_ubasic_gpio));
+        ztest_unit_test(test_ubasic_gpio),
+        ztest_unit_test(test_ubasic_labels));
 
     ztest_run_test_suite(ubasic_tests);
 }
@@ -0,0 +1,194 @@
+/**
+ * @file
+ * @brief Unit test for the export of the BACnet stack counters
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/binding/address.h>
+#include <bacnet/basic/server/bacnet_basic.h>
+#include <bacnet/basic/server/bacnet_metrics.h>
+#include <bacnet/basic/service/h_cov.h>
+#include <bacnet/basic/sys/lockstat.h>
+#include <bacnet/basic/tsm/tsm.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static LOCKSTAT_LOCK Test_Lock = LOCKSTAT_LOCK_INIT("test-lock");
+static LOCKSTAT_QUEUE Test_Queue = LOCKSTAT_QUEUE_INIT("test-queue");
+
+/* the counters of the stack, with known values */
+unsigned long bacnet_basic_uptime_seconds(void)
+{
+    return 42;
+}
+
+unsigned long bacnet_basic_packet_count(void)
+{
+    return 1234;
+}
+
+uint8_t tsm_transaction_idle_count(void)
+{
+    return MAX_TSM_TRANSACTIONS - 5;
+}
+
+unsigned address_count(void)
+{
+    return 3;
+}
+
+void address_cache_lookups(unsigned long *hits, unsigned long *misses)
+{
+    *hits = 10;
+    *misses = 2;
+}
+
+unsigned handler_cov_subscription_count(void)
+{
+    return 4;
+}
+
+unsigned handler_cov_changed_count(void)
+{
+    return 1;
+}
+
+/**
+ * @brief Set the statistics of the instrumented lock and queue
+ */
+static void test_setup_lockstat(void)
+{
+    lockstat_lock_register(&Test_Lock);
+    lockstat_queue_register(&Test_Queue);
+    lockstat_reset();
+    lockstat_lock_record(&Test_Lock, false, 0);
+    lockstat_lock_record(&Test_Lock, true, 1);
+    lockstat_lock_record(&Test_Lock, true, 5);
+    lockstat_queue_sample(&Test_Queue, 6);
+    lockstat_queue_sample(&Test_Queue, 2);
+}
+
+/**
+ * @brief Test the Prometheus text of a known set of counters
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacnet_metrics_tests, testMetricsPrometheus)
+#else
+static void testMetricsPrometheus(void)
+#endif
+{
+    static const char *expected[] = {
+        "# HELP bacnet_uptime_seconds Seconds since the BACnet task started.\n"
+        "# TYPE bacnet_uptime_seconds counter\n"
+        "bacnet_uptime_seconds 42\n",
+        "# TYPE bacnet_packets_received_total counter\n"
+        "bacnet_packets_received_total 1234\n",
+        "bacnet_tsm_active_transactions 5\n",
+        "# TYPE bacnet_address_cache_entries gauge\n"
+        "bacnet_address_cache_entries 3\n",
+        "bacnet_address_cache_lookups_total{result=\"hit\"} 10\n"
+        "bacnet_address_cache_lookups_total{result=\"miss\"} 2\n",
+        "bacnet_cov_subscriptions 4\n",
+        "bacnet_cov_changed_queue_depth 1\n",
+        "bacnet_lock_acquisitions_total{lock=\"test-lock\"} 3\n",
+        "bacnet_lock_contended_total{lock=\"test-lock\"} 2\n",
+        "bacnet_lock_wait_microseconds_max{lock=\"test-lock\"} 5\n",
+        "# TYPE bacnet_lock_wait_microseconds histogram\n"
+        "bacnet_lock_wait_microseconds_bucket{lock=\"test-lock\",le=\"0\"} 1\n"
+        "bacnet_lock_wait_microseconds_bucket{lock=\"test-lock\",le=\"1\"} 2\n"
+        "bacnet_lock_wait_microseconds_bucket{lock=\"test-lock\",le=\"3\"} 2\n"
+        "bacnet_lock_wait_microseconds_bucket{lock=\"test-lock\",le=\"7\"} 3\n",
+        "bacnet_lock_wait_microseconds_bucket"
+        "{lock=\"test-lock\",le=\"+Inf\"} 3\n"
+        "bacnet_lock_wait_microseconds_sum{lock=\"test-lock\"} 6\n"
+        "bacnet_lock_wait_microseconds_count{lock=\"test-lock\"} 3\n",
+        "bacnet_queue_depth{queue=\"test-queue\"} 2\n",
+        "bacnet_queue_depth_max{queue=\"test-queue\"} 6\n",
+    };
+    static char buffer[8192];
+    size_t len, i;
+
+    test_setup_lockstat();
+    len = bacnet_metrics_prometheus(NULL, 0);
+    zassert_true(len > 0, NULL);
+    zassert_true(len < sizeof(buffer), NULL);
+    zassert_equal(bacnet_metrics_prometheus(buffer, sizeof(buffer)), len, NULL);
+    zassert_equal(strlen(buffer), len, NULL);
+    for (i = 0; i < ARRAY_SIZE(expected); i++) {
+        zassert_not_null(strstr(buffer, expected[i]), "%s", expected[i]);
+    }
+    /* the families are written in order, with the stack first */
+    zassert_equal(
+        strncmp(buffer, expected[0], strlen(expected[0])), 0, NULL);
+    i = ARRAY_SIZE(expected) - 1;
+    zassert_true(
+        strstr(buffer, expected[0]) < strstr(buffer, expected[i]), NULL);
+    /* a short buffer is truncated, and the full length is returned */
+    memset(buffer, 'x', sizeof(buffer));
+    zassert_equal(bacnet_metrics_prometheus(buffer, 16), len, NULL);
+    zassert_equal(strlen(buffer), 15, NULL);
+    zassert_equal(buffer[16], 'x', NULL);
+}
+
+/**
+ * @brief Test the JSON snapshot of a known set of counters
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacnet_metrics_tests, testMetricsJSON)
+#else
+static void testMetricsJSON(void)
+#endif
+{
+    static const char *expected[] = {
+        "\n    {\"name\": \"bacnet_uptime_seconds\", \"type\": \"counter\", "
+        "\"value\": 42},",
+        "{\"name\": \"bacnet_address_cache_lookups_total\", "
+        "\"type\": \"counter\", \"labels\": {\"result\": \"miss\"}, "
+        "\"value\": 2}",
+        "{\"name\": \"bacnet_lock_wait_microseconds_bucket\", "
+        "\"type\": \"histogram\", "
+        "\"labels\": {\"lock\": \"test-lock\", \"le\": \"+Inf\"}, "
+        "\"value\": 3}",
+    };
+    static const char head[] = "{\n  \"timestamp\": 1700000000,\n"
+                               "  \"metrics\": [\n";
+    static const char tail[] = "\"value\": 6}\n  ]\n}\n";
+    static char buffer[16384];
+    size_t len, i;
+
+    test_setup_lockstat();
+    len = bacnet_metrics_json(NULL, 0, 1700000000);
+    zassert_true(len < sizeof(buffer), NULL);
+    zassert_equal(
+        bacnet_metrics_json(buffer, sizeof(buffer), 1700000000), len, NULL);
+    zassert_equal(strlen(buffer), len, NULL);
+    zassert_equal(strncmp(buffer, head, strlen(head)), 0, NULL);
+    /* the last sample is the high-water mark of the queue */
+    zassert_equal(
+        strcmp(&buffer[len - strlen(tail)], tail), 0, "%s", buffer);
+    for (i = 0; i < ARRAY_SIZE(expected); i++) {
+        zassert_not_null(strstr(buffer, expected[i]), "%s", expected[i]);
+    }
+    /* the Prometheus comments are not in the snapshot */
+    zassert_is_null(strstr(buffer, "# HELP"), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(bacnet_metrics_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        bacnet_metrics_tests, ztest_unit_test(testMetricsPrometheus),
+        ztest_unit_test(testMetricsJSON));
+
+    ztest_run_test_suite(bacnet_metrics_tests);
+}
+#endif
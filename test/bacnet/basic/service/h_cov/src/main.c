@@ -0,0 +1,418 @@
+/**
+ * @file
+ * @brief Unit test for the subscription hash chains and the reference
+ *  counted addresses of the COV handler
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include "bacnet/basic/service/h_cov.c"
+
+#include <zephyr/ztest.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the largest valid object instance of the test device */
+#define TEST_INSTANCE_MAX 1000
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+
+bool Device_Valid_Object_Id(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    (void)object_type;
+    return (object_instance < TEST_INSTANCE_MAX);
+}
+
+bool Device_Value_List_Supported(BACNET_OBJECT_TYPE object_type)
+{
+    (void)object_type;
+    return true;
+}
+
+bool Device_COV(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    (void)object_type;
+    (void)object_instance;
+    return false;
+}
+
+void Device_COV_Clear(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    (void)object_type;
+    (void)object_instance;
+}
+
+bool Device_Encode_Value_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE *value_list)
+{
+    (void)object_type;
+    (void)object_instance;
+    (void)value_list;
+    return false;
+}
+
+int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    (void)rpdata;
+    return BACNET_STATUS_ERROR;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+bool tsm_transaction_available(void)
+{
+    return false;
+}
+
+uint8_t tsm_next_free_invokeID(void)
+{
+    return 0;
+}
+
+void tsm_set_confirmed_unsegmented_transaction(
+    uint8_t invokeID,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *ndpu_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    (void)invokeID;
+    (void)dest;
+    (void)ndpu_data;
+    (void)apdu;
+    (void)apdu_len;
+}
+
+void tsm_free_invoke_id(uint8_t invokeID)
+{
+    (void)invokeID;
+}
+
+bool tsm_invoke_id_free(uint8_t invokeID)
+{
+    (void)invokeID;
+    return true;
+}
+
+bool tsm_invoke_id_failed(uint8_t invokeID)
+{
+    (void)invokeID;
+    return false;
+}
+
+/**
+ * @brief Check that every valid subscription and address is linked once,
+ *  in the chain of its own hash, that every unused entry is on its free
+ *  list, and that the reference count of each address is the number of
+ *  subscriptions that use it
+ */
+static void test_cov_chains_check(void)
+{
+    unsigned linked[MAX_COV_SUBCRIPTIONS] = { 0 };
+    unsigned references[MAX_COV_ADDRESSES] = { 0 };
+    unsigned bucket, link, index, steps;
+    unsigned valid = 0, free_count = 0;
+    BACNET_COV_SUBSCRIPTION *cov_subscription;
+
+    zassert_true(COV->Subscriptions_Used <= MAX_COV_SUBCRIPTIONS, NULL);
+    zassert_true(COV->Addresses_Used <= MAX_COV_ADDRESSES, NULL);
+    for (bucket = 0; bucket < MAX_COV_SUBCRIPTIONS; bucket++) {
+        steps = 0;
+        for (link = COV->Object_Bucket[bucket]; link;
+             link = COV->Subscriptions[link - 1].next) {
+            zassert_true(link <= COV->Subscriptions_Used, NULL);
+            zassert_true(++steps <= COV->Subscriptions_Used, "loop");
+            cov_subscription = &COV->Subscriptions[link - 1];
+            zassert_true(cov_subscription->flag.valid, NULL);
+            zassert_equal(
+                cov_object_bucket(
+                    (BACNET_OBJECT_TYPE)
+                        cov_subscription->monitoredObjectIdentifier.type,
+                    cov_subscription->monitoredObjectIdentifier.instance),
+                bucket, NULL);
+            linked[link - 1]++;
+        }
+    }
+    for (index = 0; index < COV->Subscriptions_Used; index++) {
+        cov_subscription = &COV->Subscriptions[index];
+        if (cov_subscription->flag.valid) {
+            valid++;
+            zassert_equal(linked[index], 1, "index=%u", index);
+            zassert_true(
+                cov_subscription->dest_index < COV->Addresses_Used, NULL);
+            zassert_true(
+                COV->Addresses[cov_subscription->dest_index].valid, NULL);
+            references[cov_subscription->dest_index]++;
+        } else {
+            zassert_equal(linked[index], 0, NULL);
+        }
+    }
+    for (link = COV->Subscriptions_Free; link;
+         link = COV->Subscriptions[link - 1].next) {
+        zassert_true(link <= COV->Subscriptions_Used, NULL);
+        zassert_false(COV->Subscriptions[link - 1].flag.valid, NULL);
+        zassert_true(++free_count <= COV->Subscriptions_Used, "loop");
+    }
+    zassert_equal(valid + free_count, COV->Subscriptions_Used, NULL);
+    zassert_equal(handler_cov_subscription_count(), valid, NULL);
+    /* the addresses */
+    memset(linked, 0, sizeof(linked));
+    valid = 0;
+    free_count = 0;
+    for (bucket = 0; bucket < MAX_COV_ADDRESSES; bucket++) {
+        steps = 0;
+        for (link = COV->Address_Bucket[bucket]; link;
+             link = COV->Addresses[link - 1].next) {
+            zassert_true(link <= COV->Addresses_Used, NULL);
+            zassert_true(++steps <= COV->Addresses_Used, "loop");
+            zassert_true(COV->Addresses[link - 1].valid, NULL);
+            zassert_equal(
+                cov_address_bucket(&COV->Addresses[link - 1].dest), bucket,
+                NULL);
+            linked[link - 1]++;
+        }
+    }
+    for (index = 0; index < COV->Addresses_Used; index++) {
+        if (COV->Addresses[index].valid) {
+            valid++;
+            zassert_equal(linked[index], 1, NULL);
+            zassert_equal(
+                COV->Addresses[index].ref_count, references[index],
+                "index=%u", index);
+            zassert_not_equal(references[index], 0, NULL);
+        } else {
+            zassert_equal(linked[index], 0, NULL);
+        }
+    }
+    for (link = COV->Addresses_Free; link;
+         link = COV->Addresses[link - 1].next) {
+        zassert_true(link <= COV->Addresses_Used, NULL);
+        zassert_false(COV->Addresses[link - 1].valid, NULL);
+        zassert_true(++free_count <= COV->Addresses_Used, "loop");
+    }
+    zassert_equal(valid + free_count, COV->Addresses_Used, NULL);
+}
+
+/**
+ * @brief Make the address of a subscriber
+ * @param dest - address to set
+ * @param mac - last octet of the subscriber MAC address
+ */
+static void test_cov_address(BACNET_ADDRESS *dest, uint8_t mac)
+{
+    memset(dest, 0, sizeof(*dest));
+    dest->mac_len = 6;
+    dest->mac[0] = 192;
+    dest->mac[1] = 168;
+    dest->mac[3] = mac;
+    dest->mac[4] = 0xBA;
+    dest->mac[5] = 0xC0;
+}
+
+/**
+ * @brief Subscribe, resubscribe, or cancel a subscription
+ * @param mac - last octet of the subscriber MAC address
+ * @param pid - subscriber process identifier
+ * @param instance - monitored Analog Input instance
+ * @param lifetime - lifetime in seconds, zero for an indefinite one
+ * @param cancel - true to cancel the subscription
+ * @return true if the request succeeded
+ */
+static bool test_cov_subscribe(
+    uint8_t mac,
+    uint32_t pid,
+    uint32_t instance,
+    uint32_t lifetime,
+    bool cancel)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    BACNET_ADDRESS src;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_SUCCESS;
+    bool status;
+
+    test_cov_address(&src, mac);
+    cov_data.subscriberProcessIdentifier = pid;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = instance;
+    cov_data.cancellationRequest = cancel;
+    cov_data.lifetime = lifetime;
+    status = cov_subscribe(&src, &cov_data, &error_class, &error_code);
+    if (!status) {
+        zassert_equal(error_class, ERROR_CLASS_RESOURCES, NULL);
+        zassert_equal(
+            error_code, ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT, NULL);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Find the subscription of a subscriber to an object
+ * @return the subscription, or NULL if not found
+ */
+static BACNET_COV_SUBSCRIPTION *
+test_cov_find(uint8_t mac, uint32_t pid, uint32_t instance)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    BACNET_ADDRESS src;
+    int index;
+
+    test_cov_address(&src, mac);
+    cov_data.subscriberProcessIdentifier = pid;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = instance;
+    index = cov_subscription_find(&src, &cov_data);
+    if (index < 0) {
+        return NULL;
+    }
+
+    return &COV->Subscriptions[index];
+}
+
+/**
+ * @brief Test subscribe, resubscribe, and cancel
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_cov_tests, testCOVSubscribeCancel)
+#else
+static void testCOVSubscribeCancel(void)
+#endif
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription;
+    unsigned i;
+
+    handler_cov_init();
+    test_cov_chains_check();
+    /* fill the table: more subscriptions than buckets share chains, and
+       four subscribers share the addresses */
+    for (i = 0; i < MAX_COV_SUBCRIPTIONS; i++) {
+        zassert_true(
+            test_cov_subscribe((uint8_t)(i % 4), 1, i / 2, 0, false), NULL);
+        test_cov_chains_check();
+    }
+    zassert_equal(handler_cov_subscription_count(), MAX_COV_SUBCRIPTIONS, NULL);
+    zassert_equal(COV->Addresses_Used, 4, NULL);
+    zassert_equal(COV->Addresses[0].ref_count, 4, NULL);
+    /* no room for another subscription, or another subscriber */
+    zassert_false(test_cov_subscribe(0, 2, 0, 0, false), NULL);
+    zassert_false(test_cov_subscribe(9, 1, 0, 0, false), NULL);
+    test_cov_chains_check();
+    /* a resubscription updates the subscription in place */
+    zassert_true(test_cov_subscribe(2, 1, 1, 300, false), NULL);
+    zassert_equal(handler_cov_subscription_count(), MAX_COV_SUBCRIPTIONS, NULL);
+    cov_subscription = test_cov_find(2, 1, 1);
+    zassert_not_null(cov_subscription, NULL);
+    zassert_equal(cov_subscription->lifetime, 300, NULL);
+    test_cov_chains_check();
+    /* another process of the same subscriber is another subscription */
+    zassert_is_null(test_cov_find(2, 7, 1), NULL);
+    /* cancel from the middle of the chains */
+    for (i = 1; i < MAX_COV_SUBCRIPTIONS; i += 3) {
+        zassert_true(
+            test_cov_subscribe((uint8_t)(i % 4), 1, i / 2, 0, true), NULL);
+        zassert_is_null(test_cov_find((uint8_t)(i % 4), 1, i / 2), NULL);
+        test_cov_chains_check();
+    }
+    zassert_equal(handler_cov_subscription_count(), 11, NULL);
+    /* a cancellation with no subscription succeeds */
+    zassert_true(test_cov_subscribe(1, 1, 1, 0, true), NULL);
+    zassert_true(test_cov_subscribe(3, 9, 999, 0, true), NULL);
+    zassert_true(test_cov_subscribe(3, 9, TEST_INSTANCE_MAX, 0, true), NULL);
+    test_cov_chains_check();
+    /* the last subscription of an address releases the address, and the
+       released entries are used again */
+    for (i = 0; i < MAX_COV_SUBCRIPTIONS; i++) {
+        if ((i % 4) == 3) {
+            test_cov_subscribe(3, 1, i / 2, 0, true);
+        }
+    }
+    test_cov_chains_check();
+    zassert_equal(COV->Addresses_Free, 4, NULL);
+    for (i = 0; i < 5; i++) {
+        zassert_true(test_cov_subscribe(8, 5, 100 + i, 0, false), NULL);
+        test_cov_chains_check();
+    }
+    zassert_equal(COV->Subscriptions_Used, MAX_COV_SUBCRIPTIONS, NULL);
+    zassert_equal(COV->Addresses_Used, 4, NULL);
+    zassert_equal(COV->Addresses[3].ref_count, 5, NULL);
+    zassert_equal(handler_cov_subscription_count(), 13, NULL);
+}
+
+/**
+ * @brief Test that the subscriptions with a lifetime expire, and leave the
+ *  chains of the others intact
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_cov_tests, testCOVExpiry)
+#else
+static void testCOVExpiry(void)
+#endif
+{
+    uint32_t lifetime;
+    unsigned i;
+
+    handler_cov_init();
+    for (i = 0; i < 12; i++) {
+        /* lifetimes of 10 and 20 seconds, and indefinite ones */
+        lifetime = ((i % 3) == 2) ? 0 : (10 * (1 + (i % 2)));
+        zassert_true(
+            test_cov_subscribe((uint8_t)(i % 3), 1, i % 5, lifetime, false),
+            NULL);
+    }
+    test_cov_chains_check();
+    handler_cov_timer_seconds(9);
+    zassert_equal(handler_cov_subscription_count(), 12, NULL);
+    test_cov_chains_check();
+    /* a subscription expires when its lifetime runs out */
+    handler_cov_timer_seconds(1);
+    test_cov_chains_check();
+    for (i = 0; i < 12; i++) {
+        if (((i % 3) != 2) && ((i % 2) == 0)) {
+            zassert_is_null(test_cov_find((uint8_t)(i % 3), 1, i % 5), NULL);
+        } else {
+            zassert_not_null(
+                test_cov_find((uint8_t)(i % 3), 1, i % 5), "i=%u", i);
+        }
+    }
+    /* a resubscription restarts the lifetime */
+    zassert_true(test_cov_subscribe(1, 1, 1, 30, false), NULL);
+    handler_cov_timer_seconds(25);
+    test_cov_chains_check();
+    zassert_not_null(test_cov_find(1, 1, 1), NULL);
+    zassert_equal(handler_cov_subscription_count(), 5, NULL);
+    handler_cov_timer_seconds(5);
+    test_cov_chains_check();
+    zassert_is_null(test_cov_find(1, 1, 1), NULL);
+    /* only the indefinite subscriptions are left, with their address */
+    zassert_equal(handler_cov_subscription_count(), 4, NULL);
+    handler_cov_timer_seconds(UINT32_MAX);
+    zassert_equal(handler_cov_subscription_count(), 4, NULL);
+    test_cov_chains_check();
+    zassert_false(COV->Addresses[0].valid, NULL);
+    zassert_false(COV->Addresses[1].valid, NULL);
+    zassert_equal(COV->Addresses[2].ref_count, 4, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_cov_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_cov_tests, ztest_unit_test(testCOVSubscribeCancel),
+        ztest_unit_test(testCOVExpiry));
+
+    ztest_run_test_suite(h_cov_tests);
+}
+#endif
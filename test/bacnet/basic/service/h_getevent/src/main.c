@@ -0,0 +1,462 @@
+/**
+ * @file
+ * @brief Unit test for the active event set of the GetEventInformation
+ *  handler
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/getevent.h"
+#include "bacnet/npdu.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/datalink/datalink.h"
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* objects of each test object type, with instances 100, 110, 120, ... */
+#define TEST_OBJECT_COUNT 8
+#define TEST_INSTANCE(index) (100 + ((uint32_t)(index) * 10))
+
+struct test_object_type {
+    BACNET_OBJECT_TYPE type;
+    BACNET_EVENT_STATE event_state[TEST_OBJECT_COUNT];
+    /* count of calls of the get_event_info_function */
+    unsigned info_count;
+};
+
+/* the active events of the Analog Inputs are tracked by the active event
+   set, and the Binary Inputs are scanned */
+static struct test_object_type Test_AI = { OBJECT_ANALOG_INPUT,
+                                           { EVENT_STATE_NORMAL }, 0 };
+static struct test_object_type Test_BI = { OBJECT_BINARY_INPUT,
+                                           { EVENT_STATE_NORMAL }, 0 };
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+static uint8_t Test_PDU[MAX_PDU];
+static unsigned Test_PDU_Len;
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (pdu_len > sizeof(Test_PDU)) {
+        pdu_len = sizeof(Test_PDU);
+    }
+    memcpy(Test_PDU, pdu, pdu_len);
+    Test_PDU_Len = pdu_len;
+
+    return (int)pdu_len;
+}
+
+static int test_event_info(
+    struct test_object_type *object_type,
+    unsigned index,
+    BACNET_GET_EVENT_INFORMATION_DATA *getevent_data)
+{
+    unsigned i;
+
+    object_type->info_count++;
+    if (index >= TEST_OBJECT_COUNT) {
+        return -1;
+    }
+    if (object_type->event_state[index] == EVENT_STATE_NORMAL) {
+        return 0;
+    }
+    getevent_data->objectIdentifier.type = object_type->type;
+    getevent_data->objectIdentifier.instance = TEST_INSTANCE(index);
+    getevent_data->eventState = object_type->event_state[index];
+    bitstring_init(&getevent_data->acknowledgedTransitions);
+    bitstring_init(&getevent_data->eventEnable);
+    for (i = 0; i < 3; i++) {
+        bitstring_set_bit(&getevent_data->acknowledgedTransitions, i, true);
+        bitstring_set_bit(&getevent_data->eventEnable, i, true);
+        getevent_data->eventTimeStamps[i].tag = TIME_STAMP_SEQUENCE;
+        getevent_data->eventTimeStamps[i].value.sequenceNum = i;
+        getevent_data->eventPriorities[i] = 100;
+    }
+    getevent_data->notifyType = NOTIFY_ALARM;
+
+    return 1;
+}
+
+static int
+test_ai_event_info(unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *data)
+{
+    return test_event_info(&Test_AI, index, data);
+}
+
+static int
+test_bi_event_info(unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *data)
+{
+    return test_event_info(&Test_BI, index, data);
+}
+
+static unsigned test_ai_index(uint32_t object_instance)
+{
+    if ((object_instance < TEST_INSTANCE(0)) ||
+        ((object_instance - TEST_INSTANCE(0)) % 10)) {
+        return TEST_OBJECT_COUNT;
+    }
+
+    return (object_instance - TEST_INSTANCE(0)) / 10;
+}
+
+/**
+ * @brief Change the event state of a test object, and report an Analog
+ *  Input to the active event set the way the basic objects do
+ */
+static void test_event_state_set(
+    struct test_object_type *object_type,
+    unsigned index,
+    BACNET_EVENT_STATE event_state)
+{
+    object_type->event_state[index] = event_state;
+    if (object_type == &Test_AI) {
+        handler_get_event_information_active_set(
+            object_type->type, TEST_INSTANCE(index),
+            event_state != EVENT_STATE_NORMAL);
+    }
+}
+
+/**
+ * @brief Register the test object types with all of their objects
+ *  in the NORMAL event state
+ */
+static void test_setup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < TEST_OBJECT_COUNT; i++) {
+        test_event_state_set(&Test_AI, i, EVENT_STATE_NORMAL);
+        test_event_state_set(&Test_BI, i, EVENT_STATE_NORMAL);
+    }
+    handler_get_event_information_set(OBJECT_ANALOG_INPUT, test_ai_event_info);
+    handler_get_event_information_index_set(
+        OBJECT_ANALOG_INPUT, test_ai_index);
+    handler_get_event_information_set(OBJECT_BINARY_INPUT, test_bi_event_info);
+}
+
+/**
+ * @brief Send a GetEventInformation request to the handler, and decode
+ *  the objects of its ACK
+ * @param last - the 'Last Received Object Identifier', or NULL
+ * @param object_id - the objects listed by the ACK
+ * @param object_id_size - number of elements in object_id
+ * @param more_events - the 'More Events' of the ACK
+ * @return number of objects listed by the ACK
+ */
+static unsigned test_get_event_information(
+    const BACNET_OBJECT_ID *last,
+    BACNET_OBJECT_ID *object_id,
+    unsigned object_id_size,
+    bool *more_events)
+{
+    BACNET_GET_EVENT_INFORMATION_DATA data[TEST_OBJECT_COUNT * 2];
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t request[16];
+    const uint8_t *apdu;
+    int request_len = 0;
+    int offset;
+    int len;
+    unsigned i, count = 0;
+
+    if (last) {
+        request_len = (int)getevent_service_request_encode(
+            request, sizeof(request), last);
+        zassert_true(request_len > 0, NULL);
+    }
+    service_data.invoke_id = 1;
+    service_data.max_resp = MAX_APDU;
+    service_data.priority = MESSAGE_PRIORITY_NORMAL;
+    Test_PDU_Len = 0;
+    Test_AI.info_count = 0;
+    Test_BI.info_count = 0;
+    handler_get_event_information(
+        request, (uint16_t)request_len, &src, &service_data);
+    offset = bacnet_npdu_decode_apdu_offset(Test_PDU, Test_PDU_Len, NULL);
+    zassert_true(offset > 0, NULL);
+    apdu = &Test_PDU[offset];
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+    zassert_equal(apdu[2], SERVICE_CONFIRMED_GET_EVENT_INFORMATION, NULL);
+    memset(data, 0, sizeof(data));
+    getevent_information_link_array(data, ARRAY_SIZE(data));
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        data[i].objectIdentifier.type = MAX_BACNET_OBJECT_TYPE;
+    }
+    len = getevent_ack_decode_service_request(
+        &apdu[3], (int)Test_PDU_Len - offset - 3, data, more_events);
+    zassert_true(len > 0, NULL);
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        if (data[i].objectIdentifier.type == MAX_BACNET_OBJECT_TYPE) {
+            break;
+        }
+        if (count < object_id_size) {
+            object_id[count] = data[i].objectIdentifier;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Test the objects added to and removed from the active event set
+ *  as their event state changes, in object identifier order
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, test_Active_Event_Set)
+#else
+static void test_Active_Event_Set(void)
+#endif
+{
+    BACNET_OBJECT_ID object_id[TEST_OBJECT_COUNT] = { 0 };
+    bool more_events = true;
+    unsigned index = 0;
+
+    test_setup();
+    zassert_true(
+        handler_get_event_information_active(OBJECT_ANALOG_INPUT), NULL);
+    zassert_false(
+        handler_get_event_information_active(OBJECT_BINARY_INPUT), NULL);
+    zassert_false(
+        handler_get_event_information_active_object(
+            0, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    /* added in any order, and only once */
+    test_event_state_set(&Test_AI, 5, EVENT_STATE_HIGH_LIMIT);
+    test_event_state_set(&Test_AI, 1, EVENT_STATE_FAULT);
+    test_event_state_set(&Test_AI, 3, EVENT_STATE_LOW_LIMIT);
+    test_event_state_set(&Test_AI, 5, EVENT_STATE_OFFNORMAL);
+    zassert_true(
+        handler_get_event_information_active_object(
+            0, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_equal(index, 1, NULL);
+    zassert_true(
+        handler_get_event_information_active_object(
+            1, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_equal(index, 3, NULL);
+    zassert_true(
+        handler_get_event_information_active_object(
+            2, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_equal(index, 5, NULL);
+    zassert_false(
+        handler_get_event_information_active_object(
+            3, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_false(
+        handler_get_event_information_active_object(
+            0, OBJECT_BINARY_INPUT, &index),
+        NULL);
+    /* only the active objects are visited, and the scanned type after */
+    test_event_state_set(&Test_BI, 2, EVENT_STATE_OFFNORMAL);
+    zassert_equal(
+        test_get_event_information(
+            NULL, object_id, ARRAY_SIZE(object_id), &more_events),
+        4, NULL);
+    zassert_false(more_events, NULL);
+    zassert_equal(object_id[0].type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(1), NULL);
+    zassert_equal(object_id[1].instance, TEST_INSTANCE(3), NULL);
+    zassert_equal(object_id[2].instance, TEST_INSTANCE(5), NULL);
+    zassert_equal(object_id[3].type, OBJECT_BINARY_INPUT, NULL);
+    zassert_equal(object_id[3].instance, TEST_INSTANCE(2), NULL);
+    zassert_equal(Test_AI.info_count, 3, NULL);
+    zassert_equal(Test_BI.info_count, TEST_OBJECT_COUNT + 1, NULL);
+    /* removed when back to NORMAL, and only once */
+    test_event_state_set(&Test_AI, 3, EVENT_STATE_NORMAL);
+    test_event_state_set(&Test_AI, 3, EVENT_STATE_NORMAL);
+    test_event_state_set(&Test_AI, 7, EVENT_STATE_NORMAL);
+    zassert_true(
+        handler_get_event_information_active_object(
+            1, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_equal(index, 5, NULL);
+    zassert_false(
+        handler_get_event_information_active_object(
+            2, OBJECT_ANALOG_INPUT, &index),
+        NULL);
+    zassert_equal(
+        test_get_event_information(
+            NULL, object_id, ARRAY_SIZE(object_id), &more_events),
+        3, NULL);
+    zassert_equal(object_id[1].instance, TEST_INSTANCE(5), NULL);
+    zassert_equal(Test_AI.info_count, 2, NULL);
+}
+
+/**
+ * @brief Test the resume of a request right after the 'Last Received
+ *  Object Identifier', found by binary search in the active event set
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, test_Active_Event_Resume)
+#else
+static void test_Active_Event_Resume(void)
+#endif
+{
+    BACNET_OBJECT_ID object_id[TEST_OBJECT_COUNT] = { 0 };
+    BACNET_OBJECT_ID last = { 0 };
+    bool more_events = true;
+
+    test_setup();
+    test_event_state_set(&Test_AI, 0, EVENT_STATE_FAULT);
+    test_event_state_set(&Test_AI, 2, EVENT_STATE_FAULT);
+    test_event_state_set(&Test_AI, 6, EVENT_STATE_FAULT);
+    test_event_state_set(&Test_BI, 4, EVENT_STATE_OFFNORMAL);
+    zassert_equal(
+        handler_get_event_information_active_position(
+            OBJECT_ANALOG_INPUT, 0),
+        0, NULL);
+    zassert_equal(
+        handler_get_event_information_active_position(
+            OBJECT_ANALOG_INPUT, TEST_INSTANCE(2)),
+        1, NULL);
+    zassert_equal(
+        handler_get_event_information_active_position(
+            OBJECT_ANALOG_INPUT, TEST_INSTANCE(2) + 1),
+        2, NULL);
+    zassert_equal(
+        handler_get_event_information_active_position(
+            OBJECT_ANALOG_INPUT, TEST_INSTANCE(7)),
+        3, NULL);
+    zassert_equal(
+        handler_get_event_information_active_position(
+            OBJECT_BINARY_INPUT, 0),
+        3, NULL);
+    /* resume after an active object, without visiting the ones before */
+    last.type = OBJECT_ANALOG_INPUT;
+    last.instance = TEST_INSTANCE(2);
+    zassert_equal(
+        test_get_event_information(
+            &last, object_id, ARRAY_SIZE(object_id), &more_events),
+        2, NULL);
+    zassert_equal(object_id[0].type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(6), NULL);
+    zassert_equal(object_id[1].type, OBJECT_BINARY_INPUT, NULL);
+    zassert_equal(object_id[1].instance, TEST_INSTANCE(4), NULL);
+    zassert_equal(Test_AI.info_count, 1, NULL);
+    /* resume after an object that is no longer active */
+    test_event_state_set(&Test_AI, 2, EVENT_STATE_NORMAL);
+    zassert_equal(
+        test_get_event_information(
+            &last, object_id, ARRAY_SIZE(object_id), &more_events),
+        2, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(6), NULL);
+    zassert_equal(Test_AI.info_count, 1, NULL);
+    /* resume after the last active object of the type */
+    last.instance = TEST_INSTANCE(6);
+    zassert_equal(
+        test_get_event_information(
+            &last, object_id, ARRAY_SIZE(object_id), &more_events),
+        1, NULL);
+    zassert_equal(object_id[0].type, OBJECT_BINARY_INPUT, NULL);
+    zassert_equal(Test_AI.info_count, 0, NULL);
+    /* resume in a later object type skips the active event set */
+    test_event_state_set(&Test_BI, 2, EVENT_STATE_OFFNORMAL);
+    last.type = OBJECT_BINARY_INPUT;
+    last.instance = TEST_INSTANCE(2);
+    zassert_equal(
+        test_get_event_information(
+            &last, object_id, ARRAY_SIZE(object_id), &more_events),
+        1, NULL);
+    zassert_false(more_events, NULL);
+    zassert_equal(object_id[0].type, OBJECT_BINARY_INPUT, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(4), NULL);
+    zassert_equal(Test_AI.info_count, 0, NULL);
+}
+
+/**
+ * @brief Test the scan of the object types, once an active event did not
+ *  fit into the active event set
+ * @note The overflow of the active event set is sticky, so this test
+ *  runs last.
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, test_Active_Event_Overflow)
+#else
+static void test_Active_Event_Overflow(void)
+#endif
+{
+    BACNET_OBJECT_ID object_id[TEST_OBJECT_COUNT] = { 0 };
+    BACNET_OBJECT_ID last = { 0 };
+    bool more_events = true;
+    unsigned i;
+
+    test_setup();
+    for (i = 0; i < MAX_GET_EVENT_ACTIVE_OBJECTS; i++) {
+        test_event_state_set(&Test_AI, i, EVENT_STATE_FAULT);
+    }
+    zassert_true(
+        handler_get_event_information_active(OBJECT_ANALOG_INPUT), NULL);
+    test_get_event_information(
+        NULL, object_id, ARRAY_SIZE(object_id), &more_events);
+    zassert_equal(Test_AI.info_count, MAX_GET_EVENT_ACTIVE_OBJECTS, NULL);
+    /* one more active event than fits */
+    test_event_state_set(
+        &Test_AI, MAX_GET_EVENT_ACTIVE_OBJECTS, EVENT_STATE_FAULT);
+    zassert_false(
+        handler_get_event_information_active(OBJECT_ANALOG_INPUT), NULL);
+    zassert_equal(
+        test_get_event_information(
+            NULL, object_id, ARRAY_SIZE(object_id), &more_events),
+        MAX_GET_EVENT_ACTIVE_OBJECTS + 1, NULL);
+    for (i = 0; i <= MAX_GET_EVENT_ACTIVE_OBJECTS; i++) {
+        zassert_equal(object_id[i].type, OBJECT_ANALOG_INPUT, NULL);
+        zassert_equal(object_id[i].instance, TEST_INSTANCE(i), NULL);
+    }
+    zassert_equal(Test_AI.info_count, TEST_OBJECT_COUNT + 1, NULL);
+    /* the scan resumes after the 'Last Received Object Identifier' */
+    last.type = OBJECT_ANALOG_INPUT;
+    last.instance = TEST_INSTANCE(2);
+    zassert_equal(
+        test_get_event_information(
+            &last, object_id, ARRAY_SIZE(object_id), &more_events),
+        MAX_GET_EVENT_ACTIVE_OBJECTS - 2, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(3), NULL);
+    /* the scan continues when the active events fit again */
+    for (i = 0; i <= MAX_GET_EVENT_ACTIVE_OBJECTS; i++) {
+        test_event_state_set(&Test_AI, i, EVENT_STATE_NORMAL);
+    }
+    zassert_false(
+        handler_get_event_information_active(OBJECT_ANALOG_INPUT), NULL);
+    test_event_state_set(&Test_AI, 6, EVENT_STATE_FAULT);
+    zassert_equal(
+        test_get_event_information(
+            NULL, object_id, ARRAY_SIZE(object_id), &more_events),
+        1, NULL);
+    zassert_equal(object_id[0].instance, TEST_INSTANCE(6), NULL);
+    zassert_equal(Test_AI.info_count, TEST_OBJECT_COUNT + 1, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_getevent_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_getevent_tests, ztest_unit_test(test_Active_Event_Set),
+        ztest_unit_test(test_Active_Event_Resume),
+        ztest_unit_test(test_Active_Event_Overflow));
+
+    ztest_run_test_suite(h_getevent_tests);
+}
+#endif
@@ -0,0 +1,372 @@
+/**
+ * @file
+ * @brief Unit test for the ReadProperty handler, which encodes the
+ *  property value in place in the reply, compared with the same reply
+ *  encoded by copying the value from a separate buffer
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/bacerror.h>
+#include <bacnet/abort.h>
+#include <bacnet/rp.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/netport.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/basic/tsm/tsm.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the Analog Value objects of the test device are 1..TEST_INSTANCE_MAX */
+#define TEST_INSTANCE_MAX 2
+#define TEST_INVOKE_ID 1
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+
+/* the object-name of the objects is Test_Name_Length octets long */
+static char Test_Name[MAX_APDU];
+static size_t Test_Name_Length;
+/* the priority-array of the objects has Test_Array_Size relinquished
+   slots of one octet each, which may be longer than the transmit buffer */
+static unsigned Test_Array_Size;
+/* the PDU of the last reply */
+static uint8_t Test_PDU[MAX_PDU];
+static unsigned Test_PDU_Len;
+
+uint16_t apdu_max_length_accepted(void)
+{
+    return MAX_APDU;
+}
+
+uint16_t apdu_decode_confirmed_service_request(
+    uint8_t *apdu,
+    uint16_t apdu_len,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    uint8_t *service_choice,
+    uint8_t **service_request,
+    uint16_t *service_request_len)
+{
+    (void)apdu;
+    (void)apdu_len;
+    (void)service_data;
+    (void)service_choice;
+    (void)service_request;
+    (void)service_request_len;
+    return 0;
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    zassert_true(pdu_len <= sizeof(Test_PDU), NULL);
+    memcpy(Test_PDU, pdu, pdu_len);
+    Test_PDU_Len = pdu_len;
+
+    return (int)pdu_len;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+uint32_t Network_Port_Index_To_Instance(unsigned find_index)
+{
+    (void)find_index;
+    return 1;
+}
+
+/**
+ * @brief Encode a property value of the test device
+ * @param apdu - buffer for the value, or NULL for the length
+ * @param rpdata - the property to read, and the error if any
+ * @return number of bytes encoded, or BACNET_STATUS_ERROR
+ */
+static int test_value_encode(uint8_t *apdu, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    BACNET_CHARACTER_STRING char_string;
+    unsigned i;
+    int len = 0;
+
+    if ((rpdata->object_type != OBJECT_ANALOG_VALUE) ||
+        (rpdata->object_instance < 1) ||
+        (rpdata->object_instance > TEST_INSTANCE_MAX)) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    switch (rpdata->object_property) {
+        case PROP_OBJECT_NAME:
+            characterstring_init(
+                &char_string, CHARACTER_ANSI_X34, Test_Name,
+                Test_Name_Length);
+            return encode_application_character_string(apdu, &char_string);
+        case PROP_PRESENT_VALUE:
+            return encode_application_real(
+                apdu, (float)rpdata->object_instance);
+        case PROP_PRIORITY_ARRAY:
+            for (i = 0; i < Test_Array_Size; i++) {
+                len += encode_application_null(apdu ? &apdu[len] : NULL);
+            }
+            return len;
+        default:
+            break;
+    }
+    rpdata->error_class = ERROR_CLASS_PROPERTY;
+    rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+
+    return BACNET_STATUS_ERROR;
+}
+
+int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int len;
+
+    len = test_value_encode(NULL, rpdata);
+    if (len < 0) {
+        return len;
+    }
+    if (len > rpdata->application_data_len) {
+        rpdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+        return BACNET_STATUS_ABORT;
+    }
+
+    return test_value_encode(rpdata->application_data, rpdata);
+}
+
+/**
+ * @brief Encode the reply to a ReadProperty request with the encoder that
+ *  copies the value from a separate buffer: the Complex-ACK, or the Error
+ *  of the property
+ * @param apdu - buffer for the reply
+ * @param data - the request
+ * @return number of bytes encoded
+ */
+static int
+test_rp_reply_baseline(uint8_t *apdu, const BACNET_READ_PROPERTY_DATA *data)
+{
+    static uint8_t value[MAX_PDU * 2];
+    BACNET_READ_PROPERTY_DATA rpdata = *data;
+    int len;
+
+    rpdata.application_data = value;
+    rpdata.application_data_len = sizeof(value);
+    if (read_property_bacnet_array_valid(&rpdata)) {
+        len = Device_Read_Property(&rpdata);
+    } else {
+        len = BACNET_STATUS_ERROR;
+    }
+    if (len < 0) {
+        return bacerror_encode_apdu(
+            apdu, TEST_INVOKE_ID, SERVICE_CONFIRMED_READ_PROPERTY,
+            rpdata.error_class, rpdata.error_code);
+    }
+    rpdata.application_data_len = len;
+
+    return rp_ack_encode_apdu(apdu, TEST_INVOKE_ID, &rpdata);
+}
+
+/**
+ * @brief Send a ReadProperty request to the handler
+ * @param data - the request
+ * @param max_resp - the largest reply accepted by the client
+ * @param apdu_max - set to the largest reply that fits the transmit buffer
+ * @param apdu - set to the APDU of the reply
+ * @return number of bytes of the APDU of the reply
+ */
+static int test_rp_handler(
+    const BACNET_READ_PROPERTY_DATA *data,
+    int max_resp,
+    int *apdu_max,
+    uint8_t **apdu)
+{
+    uint8_t service_request[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    size_t service_len;
+    int offset;
+
+    service_len = read_property_request_service_encode(
+        service_request, sizeof(service_request), data);
+    zassert_true(service_len > 0, NULL);
+    service_data.invoke_id = TEST_INVOKE_ID;
+    service_data.max_resp = max_resp;
+    Test_PDU_Len = 0;
+    handler_read_property(
+        service_request, (uint16_t)service_len, &src, &service_data);
+    offset = bacnet_npdu_decode_apdu_offset(
+        Test_PDU, (uint16_t)Test_PDU_Len, NULL);
+    zassert_true(offset > 0, NULL);
+    zassert_true((unsigned)offset < Test_PDU_Len, NULL);
+    *apdu_max = (int)sizeof(Handler_Transmit_Buffer) - offset;
+    *apdu = &Test_PDU[offset];
+
+    return (int)Test_PDU_Len - offset;
+}
+
+/**
+ * @brief Start a request for a property of an object
+ * @param data - the request
+ * @param object_instance - the Analog Value instance
+ * @param property - the property
+ * @param array_index - the array index, or BACNET_ARRAY_ALL
+ */
+static void test_rp_request(
+    BACNET_READ_PROPERTY_DATA *data,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index)
+{
+    memset(data, 0, sizeof(*data));
+    data->object_type = OBJECT_ANALOG_VALUE;
+    data->object_instance = object_instance;
+    data->object_property = property;
+    data->array_index = array_index;
+}
+
+/**
+ * @brief Test the reply to a priority-array of each size: the Complex-ACK
+ *  of the baseline while it fits the transmit buffer, including a reply
+ *  that exactly fits, and then an Abort
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rp_tests, test_RP_Reply_Fits)
+#else
+static void test_RP_Reply_Fits(void)
+#endif
+{
+    static uint8_t ack[MAX_PDU * 2];
+    BACNET_READ_PROPERTY_DATA data;
+    uint8_t abort_apdu[MAX_APDU] = { 0 };
+    uint8_t *apdu = NULL;
+    int ack_len, abort_len, len, apdu_max = 0;
+    bool fits = false;
+    bool exact = false;
+    bool overflow = false;
+
+    test_rp_request(&data, 1, PROP_PRIORITY_ARRAY, BACNET_ARRAY_ALL);
+    abort_len = abort_encode_apdu(
+        abort_apdu, TEST_INVOKE_ID, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+        true);
+    for (Test_Array_Size = 0; Test_Array_Size < MAX_PDU; Test_Array_Size++) {
+        ack_len = test_rp_reply_baseline(ack, &data);
+        /* the client accepts any reply that fits the transmit buffer */
+        len = test_rp_handler(&data, MAX_PDU, &apdu_max, &apdu);
+        if (ack_len <= apdu_max) {
+            zassert_equal(len, ack_len, "size=%u", Test_Array_Size);
+            zassert_mem_equal(apdu, ack, ack_len, NULL);
+            fits = true;
+            if (ack_len == apdu_max) {
+                exact = true;
+            }
+        } else {
+            zassert_equal(len, abort_len, "size=%u", Test_Array_Size);
+            zassert_mem_equal(apdu, abort_apdu, abort_len, NULL);
+            overflow = true;
+        }
+    }
+    zassert_true(fits, NULL);
+    zassert_true(exact, NULL);
+    zassert_true(overflow, NULL);
+}
+
+/**
+ * @brief Test a reply that fits the transmit buffer, but is too large for
+ *  the client, which is an Abort
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rp_tests, test_RP_Reply_Overflow)
+#else
+static void test_RP_Reply_Overflow(void)
+#endif
+{
+    uint8_t ack[MAX_PDU] = { 0 };
+    uint8_t abort_apdu[MAX_APDU] = { 0 };
+    BACNET_READ_PROPERTY_DATA data;
+    uint8_t *apdu = NULL;
+    int ack_len, abort_len, len, apdu_max = 0;
+
+    memset(Test_Name, 'B', sizeof(Test_Name));
+    /* a value longer than 253 octets has a 3 octet extended length */
+    Test_Name_Length = 300;
+    test_rp_request(&data, 2, PROP_OBJECT_NAME, BACNET_ARRAY_ALL);
+    ack_len = test_rp_reply_baseline(ack, &data);
+    abort_len = abort_encode_apdu(
+        abort_apdu, TEST_INVOKE_ID, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+        true);
+    len = test_rp_handler(&data, ack_len, &apdu_max, &apdu);
+    zassert_true(ack_len < apdu_max, NULL);
+    zassert_equal(len, ack_len, NULL);
+    zassert_mem_equal(apdu, ack, ack_len, NULL);
+    len = test_rp_handler(&data, ack_len - 1, &apdu_max, &apdu);
+    zassert_equal(len, abort_len, NULL);
+    zassert_mem_equal(apdu, abort_apdu, abort_len, NULL);
+}
+
+/**
+ * @brief Test the Error of an unknown property, of an array index of a
+ *  property that is not an array, and of an unknown object
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rp_tests, test_RP_Property_Error)
+#else
+static void test_RP_Property_Error(void)
+#endif
+{
+    uint8_t reply[MAX_APDU] = { 0 };
+    BACNET_READ_PROPERTY_DATA data[4];
+    uint8_t *apdu = NULL;
+    int reply_len, len, apdu_max = 0;
+    unsigned i;
+
+    test_rp_request(&data[0], 1, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    test_rp_request(&data[1], 1, PROP_DESCRIPTION, BACNET_ARRAY_ALL);
+    test_rp_request(&data[2], 1, PROP_PRESENT_VALUE, 1);
+    test_rp_request(
+        &data[3], TEST_INSTANCE_MAX + 1, PROP_PRESENT_VALUE,
+        BACNET_ARRAY_ALL);
+    for (i = 0; i < 4; i++) {
+        reply_len = test_rp_reply_baseline(reply, &data[i]);
+        len = test_rp_handler(&data[i], MAX_APDU, &apdu_max, &apdu);
+        zassert_equal(len, reply_len, "request=%u", i);
+        zassert_mem_equal(apdu, reply, reply_len, NULL);
+        if (i == 0) {
+            zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+        } else {
+            zassert_equal(apdu[0], PDU_TYPE_ERROR, NULL);
+        }
+    }
+}
+
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_rp_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_rp_tests, ztest_unit_test(test_RP_Reply_Fits),
+        ztest_unit_test(test_RP_Reply_Overflow),
+        ztest_unit_test(test_RP_Property_Error));
+
+    ztest_run_test_suite(h_rp_tests);
+}
+#endif
@@ -0,0 +1,446 @@
+/**
+ * @file
+ * @brief Unit test for the ReadPropertyMultiple handler, which encodes
+ *  each property value in place in the reply, compared with the same
+ *  reply encoded by copying each value from a separate buffer
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/abort.h>
+#include <bacnet/rp.h>
+#include <bacnet/rpm.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/netport.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/basic/tsm/tsm.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the Analog Value objects of the test device are 1..TEST_INSTANCE_MAX */
+#define TEST_INSTANCE_MAX 2
+#define TEST_INVOKE_ID 1
+/* the octets of the transmit buffer after the largest reply */
+#define TEST_GUARD 0xA5
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+
+/* the object-name of the objects is Test_Name_Length octets long */
+static char Test_Name[MAX_APDU];
+static size_t Test_Name_Length;
+/* the largest reply accepted by the handler */
+static uint16_t Test_APDU_Max = MAX_APDU;
+/* the PDU of the last reply */
+static uint8_t Test_PDU[MAX_PDU];
+static unsigned Test_PDU_Len;
+
+uint16_t apdu_max_length_accepted(void)
+{
+    return Test_APDU_Max;
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    zassert_true(pdu_len <= sizeof(Test_PDU), NULL);
+    memcpy(Test_PDU, pdu, pdu_len);
+    Test_PDU_Len = pdu_len;
+
+    return (int)pdu_len;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+uint32_t Network_Port_Index_To_Instance(unsigned find_index)
+{
+    (void)find_index;
+    return 1;
+}
+
+bool Device_Valid_Object_Id(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    return (object_type == OBJECT_ANALOG_VALUE) && (object_instance >= 1) &&
+        (object_instance <= TEST_INSTANCE_MAX);
+}
+
+void Device_Objects_Property_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    struct special_property_list_t *pPropertyList)
+{
+    (void)object_type;
+    (void)object_instance;
+    memset(pPropertyList, 0, sizeof(*pPropertyList));
+}
+
+/**
+ * @brief Encode a property value of the test device
+ * @param apdu - buffer for the value, or NULL for the length
+ * @param rpdata - the property to read, and the error if any
+ * @return number of bytes encoded, or BACNET_STATUS_ERROR
+ */
+static int test_value_encode(uint8_t *apdu, BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    BACNET_CHARACTER_STRING char_string;
+
+    if (!Device_Valid_Object_Id(rpdata->object_type, rpdata->object_instance)) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    switch (rpdata->object_property) {
+        case PROP_OBJECT_IDENTIFIER:
+            return encode_application_object_id(
+                apdu, rpdata->object_type, rpdata->object_instance);
+        case PROP_OBJECT_NAME:
+            characterstring_init(
+                &char_string, CHARACTER_ANSI_X34, Test_Name,
+                Test_Name_Length);
+            return encode_application_character_string(apdu, &char_string);
+        case PROP_PRESENT_VALUE:
+            return encode_application_real(
+                apdu, (float)rpdata->object_instance);
+        default:
+            break;
+    }
+    rpdata->error_class = ERROR_CLASS_PROPERTY;
+    rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+
+    return BACNET_STATUS_ERROR;
+}
+
+int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int len;
+
+    len = test_value_encode(NULL, rpdata);
+    if (len < 0) {
+        return len;
+    }
+    if (len > rpdata->application_data_len) {
+        rpdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+        return BACNET_STATUS_ABORT;
+    }
+
+    return test_value_encode(rpdata->application_data, rpdata);
+}
+
+/**
+ * @brief Encode the Complex-ACK of a ReadPropertyMultiple request the way
+ *  the handler did before it encoded in place: each value is read into a
+ *  separate buffer, and then copied into the reply.
+ * @param apdu - buffer for the Complex-ACK
+ * @param data - the request
+ * @return number of bytes encoded
+ */
+static int test_rpm_ack_baseline(uint8_t *apdu, BACNET_READ_ACCESS_DATA *data)
+{
+    uint8_t value[MAX_APDU] = { 0 };
+    BACNET_RPM_DATA rpmdata = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_PROPERTY_REFERENCE *property;
+    int apdu_len;
+    int len;
+
+    apdu_len = rpm_ack_encode_apdu_init(apdu, TEST_INVOKE_ID);
+    for (; data; data = data->next) {
+        rpmdata.object_type = data->object_type;
+        rpmdata.object_instance = data->object_instance;
+        apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
+        for (property = data->listOfProperties; property;
+             property = property->next) {
+            apdu_len += rpm_ack_encode_apdu_object_property(
+                &apdu[apdu_len], property->propertyIdentifier,
+                property->propertyArrayIndex);
+            rpdata.object_type = data->object_type;
+            rpdata.object_instance = data->object_instance;
+            rpdata.object_property = property->propertyIdentifier;
+            rpdata.array_index = property->propertyArrayIndex;
+            rpdata.application_data = value;
+            rpdata.application_data_len = sizeof(value);
+            if (read_property_bacnet_array_valid(&rpdata)) {
+                len = Device_Read_Property(&rpdata);
+            } else {
+                len = BACNET_STATUS_ERROR;
+            }
+            if (len >= 0) {
+                apdu_len += rpm_ack_encode_apdu_object_property_value(
+                    &apdu[apdu_len], value, (unsigned)len);
+            } else {
+                apdu_len += rpm_ack_encode_apdu_object_property_error(
+                    &apdu[apdu_len], rpdata.error_class, rpdata.error_code);
+            }
+        }
+        apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Send a ReadPropertyMultiple request to the handler, and check that
+ *  the reply was encoded without writing past the largest reply
+ * @param data - the request
+ * @param max_resp - the largest reply accepted by the client
+ * @param apdu - set to the APDU of the reply
+ * @return number of bytes of the APDU of the reply
+ */
+static int test_rpm_handler(
+    BACNET_READ_ACCESS_DATA *data, int max_resp, uint8_t **apdu)
+{
+    uint8_t service_request[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    size_t service_len;
+    size_t i;
+    int offset;
+
+    service_len = read_property_multiple_request_service_encode(
+        service_request, sizeof(service_request), data);
+    zassert_true(service_len > 0, NULL);
+    service_data.invoke_id = TEST_INVOKE_ID;
+    service_data.max_resp = max_resp;
+    Test_PDU_Len = 0;
+    memset(
+        Handler_Transmit_Buffer, TEST_GUARD, sizeof(Handler_Transmit_Buffer));
+    handler_read_property_multiple(
+        service_request, (uint16_t)service_len, &src, &service_data);
+    offset = bacnet_npdu_decode_apdu_offset(
+        Test_PDU, (uint16_t)Test_PDU_Len, NULL);
+    zassert_true(offset > 0, NULL);
+    zassert_true((unsigned)offset < Test_PDU_Len, NULL);
+    for (i = offset + Test_APDU_Max; i < sizeof(Handler_Transmit_Buffer);
+         i++) {
+        zassert_equal(
+            Handler_Transmit_Buffer[i], TEST_GUARD, "apdu_max=%u",
+            Test_APDU_Max);
+    }
+    *apdu = &Test_PDU[offset];
+
+    return (int)Test_PDU_Len - offset;
+}
+
+/**
+ * @brief Check the reply of the handler to a request with each size of
+ *  reply the handler accepts: the Complex-ACK of the baseline when it fits,
+ *  otherwise an Abort
+ * @param data - the request
+ * @return number of bytes of the Complex-ACK of the baseline
+ */
+static int test_rpm_reply_sizes(BACNET_READ_ACCESS_DATA *data)
+{
+    uint8_t ack[MAX_APDU] = { 0 };
+    uint8_t abort_apdu[MAX_APDU] = { 0 };
+    uint8_t *apdu = NULL;
+    int ack_len, abort_len, len;
+
+    ack_len = test_rpm_ack_baseline(ack, data);
+    zassert_true(ack_len < MAX_APDU, NULL);
+    abort_len = abort_encode_apdu(
+        abort_apdu, TEST_INVOKE_ID, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+        true);
+    /* every reply has room for at least an Abort */
+    for (Test_APDU_Max = (uint16_t)abort_len; Test_APDU_Max <= MAX_APDU;
+         Test_APDU_Max++) {
+        len = test_rpm_handler(data, MAX_APDU, &apdu);
+        if (Test_APDU_Max >= ack_len) {
+            zassert_equal(len, ack_len, "apdu_max=%u", Test_APDU_Max);
+            zassert_mem_equal(apdu, ack, ack_len, NULL);
+        } else {
+            zassert_equal(len, abort_len, "apdu_max=%u", Test_APDU_Max);
+            zassert_mem_equal(apdu, abort_apdu, abort_len, NULL);
+        }
+    }
+    Test_APDU_Max = MAX_APDU;
+
+    return ack_len;
+}
+
+/**
+ * @brief Link a property to the list of properties of an object
+ * @param object - the object of the request
+ * @param property - the property reference to link at the end of the list
+ * @param property_id - the property
+ * @param array_index - the array index, or BACNET_ARRAY_ALL
+ */
+static void test_rpm_property(
+    BACNET_READ_ACCESS_DATA *object,
+    BACNET_PROPERTY_REFERENCE *property,
+    BACNET_PROPERTY_ID property_id,
+    BACNET_ARRAY_INDEX array_index)
+{
+    BACNET_PROPERTY_REFERENCE **next = &object->listOfProperties;
+
+    while (*next) {
+        next = &(*next)->next;
+    }
+    memset(property, 0, sizeof(*property));
+    property->propertyIdentifier = property_id;
+    property->propertyArrayIndex = array_index;
+    *next = property;
+}
+
+/**
+ * @brief Start a request for an object
+ * @param object - the object of the request
+ * @param object_instance - the Analog Value instance
+ * @param next - the next object of the request, or NULL
+ */
+static void test_rpm_object(
+    BACNET_READ_ACCESS_DATA *object,
+    uint32_t object_instance,
+    BACNET_READ_ACCESS_DATA *next)
+{
+    memset(object, 0, sizeof(*object));
+    object->object_type = OBJECT_ANALOG_VALUE;
+    object->object_instance = object_instance;
+    object->next = next;
+}
+
+/**
+ * @brief Test a reply that exactly fits the largest reply the handler
+ *  accepts, and each smaller and larger size of reply
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rpm_tests, test_RPM_Reply_Fits)
+#else
+static void test_RPM_Reply_Fits(void)
+#endif
+{
+    BACNET_READ_ACCESS_DATA object[2];
+    BACNET_PROPERTY_REFERENCE property[4];
+    uint8_t *apdu = NULL;
+    int ack_len, len;
+
+    memset(Test_Name, 'A', sizeof(Test_Name));
+    Test_Name_Length = 8;
+    test_rpm_object(&object[0], 1, &object[1]);
+    test_rpm_property(
+        &object[0], &property[0], PROP_OBJECT_IDENTIFIER, BACNET_ARRAY_ALL);
+    test_rpm_property(
+        &object[0], &property[1], PROP_OBJECT_NAME, BACNET_ARRAY_ALL);
+    test_rpm_property(
+        &object[0], &property[2], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    test_rpm_object(&object[1], 2, NULL);
+    test_rpm_property(
+        &object[1], &property[3], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    ack_len = test_rpm_reply_sizes(&object[0]);
+    /* the last octet of the reply is the closing tag of the object */
+    Test_APDU_Max = (uint16_t)ack_len;
+    len = test_rpm_handler(&object[0], MAX_APDU, &apdu);
+    zassert_equal(len, ack_len, NULL);
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+    zassert_true(
+        bacnet_is_closing_tag_number(&apdu[len - 1], 1, 1, NULL), NULL);
+    Test_APDU_Max = MAX_APDU;
+}
+
+/**
+ * @brief Test a property value too large for the reply, and a reply too
+ *  large for the client, which are both an Abort
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rpm_tests, test_RPM_Reply_Overflow)
+#else
+static void test_RPM_Reply_Overflow(void)
+#endif
+{
+    BACNET_READ_ACCESS_DATA object[1];
+    BACNET_PROPERTY_REFERENCE property[2];
+    uint8_t abort_apdu[MAX_APDU] = { 0 };
+    uint8_t *apdu = NULL;
+    int ack_len, abort_len, len;
+
+    /* a value longer than 253 octets has a 3 octet extended length */
+    memset(Test_Name, 'B', sizeof(Test_Name));
+    Test_Name_Length = 300;
+    test_rpm_object(&object[0], 1, NULL);
+    test_rpm_property(
+        &object[0], &property[0], PROP_OBJECT_NAME, BACNET_ARRAY_ALL);
+    test_rpm_property(
+        &object[0], &property[1], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    ack_len = test_rpm_reply_sizes(&object[0]);
+    abort_len = abort_encode_apdu(
+        abort_apdu, TEST_INVOKE_ID, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+        true);
+    /* the reply fits the handler, but not the client */
+    len = test_rpm_handler(&object[0], ack_len - 1, &apdu);
+    zassert_equal(len, abort_len, NULL);
+    zassert_mem_equal(apdu, abort_apdu, abort_len, NULL);
+    len = test_rpm_handler(&object[0], ack_len, &apdu);
+    zassert_equal(len, ack_len, NULL);
+}
+
+/**
+ * @brief Test the errors of properties in the middle of an object, and of
+ *  an unknown object between two known objects
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rpm_tests, test_RPM_Property_Error)
+#else
+static void test_RPM_Property_Error(void)
+#endif
+{
+    BACNET_READ_ACCESS_DATA object[3];
+    BACNET_PROPERTY_REFERENCE property[6];
+    uint8_t *apdu = NULL;
+    int ack_len, len;
+
+    memset(Test_Name, 'C', sizeof(Test_Name));
+    Test_Name_Length = 20;
+    test_rpm_object(&object[0], 1, &object[1]);
+    test_rpm_property(
+        &object[0], &property[0], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    test_rpm_property(
+        &object[0], &property[1], PROP_DESCRIPTION, BACNET_ARRAY_ALL);
+    test_rpm_property(&object[0], &property[2], PROP_PRESENT_VALUE, 1);
+    test_rpm_property(
+        &object[0], &property[3], PROP_OBJECT_NAME, BACNET_ARRAY_ALL);
+    test_rpm_object(&object[1], TEST_INSTANCE_MAX + 1, &object[2]);
+    test_rpm_property(
+        &object[1], &property[4], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    test_rpm_object(&object[2], 2, NULL);
+    test_rpm_property(
+        &object[2], &property[5], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    ack_len = test_rpm_reply_sizes(&object[0]);
+    len = test_rpm_handler(&object[0], MAX_APDU, &apdu);
+    zassert_equal(len, ack_len, NULL);
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+}
+
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_rpm_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_rpm_tests, ztest_unit_test(test_RPM_Reply_Fits),
+        ztest_unit_test(test_RPM_Reply_Overflow),
+        ztest_unit_test(test_RPM_Property_Error));
+
+    ztest_run_test_suite(h_rpm_tests);
+}
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief Unit test for the delayed broadcast I-Am response of the Who-Is
+ *  handler
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/whois.h"
+#include "bacnet/basic/services.h"
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#define TEST_DEVICE_INSTANCE 1234
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+static unsigned I_Am_Broadcast_Count;
+static unsigned I_Am_Unicast_Count;
+
+void Send_I_Am_Broadcast(uint8_t *buffer)
+{
+    (void)buffer;
+    I_Am_Broadcast_Count++;
+}
+
+void Send_I_Am_Unicast(uint8_t *buffer, const BACNET_ADDRESS *src)
+{
+    (void)buffer;
+    (void)src;
+    I_Am_Unicast_Count++;
+}
+
+int Send_Who_Am_I_To_Network(
+    BACNET_ADDRESS *target_address,
+    uint16_t vendor_id,
+    const BACNET_CHARACTER_STRING *model_name,
+    const BACNET_CHARACTER_STRING *serial_number)
+{
+    (void)target_address;
+    (void)vendor_id;
+    (void)model_name;
+    (void)serial_number;
+    return 0;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return TEST_DEVICE_INSTANCE;
+}
+
+const char *Device_Model_Name(void)
+{
+    return "model";
+}
+
+const char *Device_Serial_Number(void)
+{
+    return "serial";
+}
+
+uint16_t Device_Vendor_Identifier(void)
+{
+    return BACNET_VENDOR_ID;
+}
+
+/**
+ * @brief Find a seed of rand() that gives the handler a delay of at least
+ *  two milliseconds, and seed rand() with it again
+ * @param delay_max - longest delay of the I-Am response
+ * @return the delay that the handler picks next
+ */
+static uint16_t test_who_is_delay_seed(uint16_t delay_max)
+{
+    unsigned seed;
+    uint16_t delay = 0;
+
+    for (seed = 1; seed < 100; seed++) {
+        srand(seed);
+        delay = (uint16_t)(rand() % ((unsigned)delay_max + 1U));
+        if (delay >= 2) {
+            break;
+        }
+    }
+    srand(seed);
+
+    return delay;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, test_Who_Is_Response_Immediate)
+#else
+static void test_Who_Is_Response_Immediate(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    int len;
+
+    handler_who_is_response_delay_set(0);
+    zassert_equal(handler_who_is_response_delay(), 0, NULL);
+    I_Am_Broadcast_Count = 0;
+    /* a global Who-Is */
+    handler_who_is(apdu, 0, &src);
+    zassert_equal(I_Am_Broadcast_Count, 1, NULL);
+    /* a Who-Is for a range with the device */
+    len = whois_request_encode(
+        apdu, TEST_DEVICE_INSTANCE - 1, TEST_DEVICE_INSTANCE + 1);
+    zassert_true(len > 0, NULL);
+    handler_who_is(apdu, (uint16_t)len, &src);
+    zassert_equal(I_Am_Broadcast_Count, 2, NULL);
+    /* a Who-Is for a range without the device */
+    len = whois_request_encode(
+        apdu, TEST_DEVICE_INSTANCE + 1, TEST_DEVICE_INSTANCE + 10);
+    handler_who_is(apdu, (uint16_t)len, &src);
+    zassert_equal(I_Am_Broadcast_Count, 2, NULL);
+    /* the timer has nothing to send */
+    handler_who_is_timer_milliseconds(UINT16_MAX);
+    zassert_equal(I_Am_Broadcast_Count, 2, NULL);
+    zassert_equal(I_Am_Unicast_Count, 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, test_Who_Is_Response_Delay)
+#else
+static void test_Who_Is_Response_Delay(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint16_t delay_max = 1000;
+    uint16_t delay;
+    int len;
+
+    handler_who_is_response_delay_set(delay_max);
+    zassert_equal(handler_who_is_response_delay(), delay_max, NULL);
+    I_Am_Broadcast_Count = 0;
+    delay = test_who_is_delay_seed(delay_max);
+    zassert_true(delay >= 2, NULL);
+    handler_who_is(apdu, 0, &src);
+    zassert_equal(I_Am_Broadcast_Count, 0, NULL);
+    /* held until the delay elapses */
+    handler_who_is_timer_milliseconds(delay - 2);
+    zassert_equal(I_Am_Broadcast_Count, 0, NULL);
+    /* another Who-Is is answered by the pending I-Am */
+    len = whois_request_encode(
+        apdu, TEST_DEVICE_INSTANCE, TEST_DEVICE_INSTANCE);
+    handler_who_is(apdu, (uint16_t)len, &src);
+    handler_who_is_timer_milliseconds(1);
+    zassert_equal(I_Am_Broadcast_Count, 0, NULL);
+    handler_who_is_timer_milliseconds(1);
+    zassert_equal(I_Am_Broadcast_Count, 1, NULL);
+    /* sent once */
+    handler_who_is_timer_milliseconds(delay_max);
+    zassert_equal(I_Am_Broadcast_Count, 1, NULL);
+    /* the next Who-Is starts another delay */
+    handler_who_is(apdu, (uint16_t)len, &src);
+    zassert_equal(I_Am_Broadcast_Count, 1, NULL);
+    handler_who_is_timer_milliseconds(delay_max);
+    zassert_equal(I_Am_Broadcast_Count, 2, NULL);
+    /* turning the delay off sends the pending I-Am on the next tick */
+    handler_who_is(apdu, 0, &src);
+    handler_who_is_response_delay_set(0);
+    zassert_equal(I_Am_Broadcast_Count, 2, NULL);
+    handler_who_is_timer_milliseconds(0);
+    zassert_equal(I_Am_Broadcast_Count, 3, NULL);
+    zassert_equal(I_Am_Unicast_Count, 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_whois_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_whois_tests, ztest_unit_test(test_Who_Is_Response_Immediate),
+        ztest_unit_test(test_Who_Is_Response_Delay));
+
+    ztest_run_test_suite(h_whois_tests);
+}
+#endif
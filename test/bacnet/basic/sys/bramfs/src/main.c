@@ -207,6 +207,112 @@ static void test_BRAMFS_records(void)
     bacfile_ramfs_deinit();
 }
 
+/**
+ * @brief Unit Test for the extents and the record index of the BRAMFS
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bramfs_tests, test_BRAMFS_extents)
+#else
+static void test_BRAMFS_extents(void)
+#endif
+{
+    const char *pathname = "logfile.txt";
+    char record[64] = { 0 };
+    char test_record[64] = { 0 };
+    uint8_t file_data[256] = { 0 };
+    const char *data;
+    size_t file_size = 0;
+    size_t len;
+    unsigned i;
+    bool status;
+
+    bacfile_ramfs_init();
+    /* append records that span several extents */
+    for (i = 0; i < 100; i++) {
+        len = snprintf(record, sizeof(record), "record %u", i);
+        status = bacfile_ramfs_write_record_data(
+            pathname, -1, 0, (const uint8_t *)record, len);
+        zassert_true(status, NULL);
+        file_size += len + 1;
+    }
+    zassert_equal(bacfile_ramfs_record_count(pathname), 100, NULL);
+    zassert_equal(bacfile_ramfs_file_size(pathname), file_size, NULL);
+    for (i = 0; i < 100; i++) {
+        len = snprintf(record, sizeof(record), "record %u", i);
+        memset(test_record, 0, sizeof(test_record));
+        status = bacfile_ramfs_read_record_data(
+            pathname, 0, i, (uint8_t *)test_record, sizeof(test_record));
+        zassert_true(status, NULL);
+        zassert_mem_equal(test_record, record, len + 1, NULL);
+    }
+    status = bacfile_ramfs_read_record_data(
+        pathname, 0, 100, (uint8_t *)test_record, sizeof(test_record));
+    zassert_false(status, NULL);
+    /* replace a record with a longer one, then with a shorter one */
+    len = snprintf(record, sizeof(record), "a much longer record 50");
+    status = bacfile_ramfs_write_record_data(
+        pathname, 50, 0, (const uint8_t *)record, len);
+    zassert_true(status, NULL);
+    file_size += len - strlen("record 50");
+    zassert_equal(bacfile_ramfs_file_size(pathname), file_size, NULL);
+    len = snprintf(record, sizeof(record), "r49");
+    status = bacfile_ramfs_write_record_data(
+        pathname, 49, 0, (const uint8_t *)record, len);
+    zassert_true(status, NULL);
+    file_size -= strlen("record 49") - len;
+    zassert_equal(bacfile_ramfs_file_size(pathname), file_size, NULL);
+    zassert_equal(bacfile_ramfs_record_count(pathname), 100, NULL);
+    memset(test_record, 0, sizeof(test_record));
+    status = bacfile_ramfs_read_record_data(
+        pathname, 0, 50, (uint8_t *)test_record, sizeof(test_record));
+    zassert_true(status, NULL);
+    zassert_mem_equal(test_record, "a much longer record 50", 24, NULL);
+    memset(test_record, 0, sizeof(test_record));
+    status = bacfile_ramfs_read_record_data(
+        pathname, 0, 99, (uint8_t *)test_record, sizeof(test_record));
+    zassert_true(status, NULL);
+    zassert_mem_equal(test_record, "record 99", 10, NULL);
+    /* the contiguous data matches the records */
+    data = bacfile_ramfs_file_data(pathname);
+    zassert_not_null(data, NULL);
+    zassert_mem_equal(data, "record 0", 9, NULL);
+    zassert_mem_equal(&data[file_size - 10], "record 99", 10, NULL);
+    /* a stream write changes the records */
+    len = bacfile_ramfs_write_stream_data(
+        pathname, 0, (const uint8_t *)"one\0two\0", 8);
+    zassert_equal(len, 8, NULL);
+    zassert_equal(bacfile_ramfs_record_count(pathname), 2, NULL);
+    memset(test_record, 0, sizeof(test_record));
+    status = bacfile_ramfs_read_record_data(
+        pathname, 1, 0, (uint8_t *)test_record, sizeof(test_record));
+    zassert_true(status, NULL);
+    zassert_mem_equal(test_record, "two", 4, NULL);
+    /* stream data across the extents */
+    for (i = 0; i < sizeof(file_data); i++) {
+        file_data[i] = (uint8_t)i;
+    }
+    len = bacfile_ramfs_write_stream_data(
+        pathname, 0, file_data, sizeof(file_data));
+    zassert_equal(len, sizeof(file_data), NULL);
+    memset(file_data, 0, sizeof(file_data));
+    len = bacfile_ramfs_read_stream_data(pathname, 100, file_data, 100);
+    zassert_equal(len, 100, NULL);
+    for (i = 0; i < len; i++) {
+        zassert_equal(file_data[i], (uint8_t)(i + 100), NULL);
+    }
+    len = bacfile_ramfs_read_stream_data(pathname, 256, file_data, 100);
+    zassert_equal(len, 0, NULL);
+    /* a shrunk and regrown file is zeroed */
+    zassert_true(bacfile_ramfs_file_size_set(pathname, 20), NULL);
+    zassert_true(bacfile_ramfs_file_size_set(pathname, 40), NULL);
+    len = bacfile_ramfs_read_stream_data(pathname, 20, file_data, 20);
+    zassert_equal(len, 20, NULL);
+    for (i = 0; i < len; i++) {
+        zassert_equal(file_data[i], 0, NULL);
+    }
+    bacfile_ramfs_deinit();
+}
+
 /**
  * @}
  */
@@ -218,7 +324,8 @@ void test_main(void)
 {
     ztest_test_suite(
         bramfs_tests, ztest_unit_test(test_BRAMFS_stream),
-        ztest_unit_test(test_BRAMFS_records));
+        ztest_unit_test(test_BRAMFS_records),
+        ztest_unit_test(test_BRAMFS_extents));
 
     ztest_run_test_suite(bramfs_tests);
 }
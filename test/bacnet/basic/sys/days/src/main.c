@@ -219,6 +219,22 @@ static void test_days_since_epoch(void)
             }
         }
     }
+    /* across the century and 400 year leap rules */
+    zassert_equal(days_since_epoch(1900, 1900, 3, 1), 59, NULL);
+    zassert_equal(days_since_epoch(1970, 2000, 3, 1), 11017, NULL);
+    zassert_equal(days_since_epoch(1970, 2100, 3, 1), 47541, NULL);
+    zassert_equal(days_since_epoch(0, 1, 1, 1), 366, NULL);
+    zassert_equal(days_since_epoch(1, 9999, 12, 31), 3652058, NULL);
+    days_since_epoch_to_date(1970, 47540, &year, &month, &day);
+    zassert_equal(year, 2100, NULL);
+    zassert_equal(month, 2, NULL);
+    zassert_equal(day, 28, NULL);
+    days_since_epoch_to_date(1, 3652058, &year, &month, &day);
+    zassert_equal(year, 9999, NULL);
+    zassert_equal(month, 12, NULL);
+    zassert_equal(day, 31, NULL);
+    zassert_equal(days_of_year(2000, 12, 31), 366, NULL);
+    zassert_equal(days_of_year(2100, 3, 1), 60, NULL);
 }
 
 /**
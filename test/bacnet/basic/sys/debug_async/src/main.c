@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief test deferred debug printing
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdarg.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/debug.h>
+#include <bacnet/basic/sys/debug_async.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#define TEST_RECORDS 8
+
+static uint32_t Test_Buffer
+    [DEBUG_ASYNC_BUFFER_SIZE(TEST_RECORDS) / sizeof(uint32_t)];
+
+/**
+ * @brief Read back what was printed to a temporary file
+ * @param stream - temporary file
+ * @param text - loaded with the contents of the file
+ * @param size - size of the text buffer
+ */
+static void test_stream_text(FILE *stream, char *text, size_t size)
+{
+    size_t length;
+
+    fflush(stream);
+    rewind(stream);
+    length = fread(text, 1, size - 1, stream);
+    text[length] = 0;
+    rewind(stream);
+}
+
+/**
+ * @brief Record a message and hex dump with variable arguments
+ */
+static bool test_fprintf_hex(
+    FILE *stream,
+    uint32_t offset,
+    const uint8_t *buffer,
+    size_t length,
+    const char *format,
+    ...)
+{
+    va_list ap;
+    bool status;
+
+    va_start(ap, format);
+    status = debug_async_vfprintf_hex(
+        stream, offset, buffer, length, format, ap);
+    va_end(ap);
+
+    return status;
+}
+
+/**
+ * @brief Test that recorded messages print like fprintf
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(debug_async_tests, testDebugAsyncFormat)
+#else
+static void testDebugAsyncFormat(void)
+#endif
+{
+    FILE *stream = tmpfile();
+    char text[512], expected[512];
+    char name[16] = "network";
+    int value = 7;
+    uint8_t data[20];
+    unsigned i;
+    bool status;
+
+    zassert_not_null(stream, NULL);
+    status = debug_async_init(Test_Buffer, sizeof(Test_Buffer), TEST_RECORDS);
+    zassert_true(status, NULL);
+    zassert_true(debug_async_enabled(), NULL);
+    debug_fprintf(
+        stream, "a=%d b=%05.1f c=%s d=%-4x|%c %lu %% %.*s %hhu %zu %p\n", -3,
+        2.25, name, 0xab, 'z', 123456789UL, 3, name, 0x1ff, sizeof(data),
+        (void *)&value);
+    /* the string was copied, and nothing is printed yet */
+    strcpy(name, "changed");
+    test_stream_text(stream, text, sizeof(text));
+    zassert_equal(strlen(text), 0, NULL);
+    zassert_equal(debug_async_task(0), 1, NULL);
+    test_stream_text(stream, text, sizeof(text));
+    snprintf(
+        expected, sizeof(expected),
+        "a=%d b=%05.1f c=%s d=%-4x|%c %lu %% %.*s %u %zu %p\n", -3, 2.25,
+        "network", 0xab, 'z', 123456789UL, 3, "network", 0xffU,
+        sizeof(data), (void *)&value);
+    zassert_equal(strcmp(text, expected), 0, "%s", text);
+    /* more arguments than a record holds are formatted right away */
+    rewind(stream);
+    debug_fprintf(
+        stream, "%d %d %d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8, 9,
+        10);
+    zassert_equal(debug_async_task(0), 1, NULL);
+    test_stream_text(stream, text, sizeof(text));
+    zassert_equal(strncmp(text, "1 2 3 4 5 6 7 8 9 10\n", 21), 0, NULL);
+    fclose(stream);
+    /* the hex dump matches the one that is printed directly */
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)('A' + i);
+    }
+    stream = tmpfile();
+    zassert_not_null(stream, NULL);
+    status = test_fprintf_hex(stream, 0x10, data, sizeof(data), "%s:\n", "hex");
+    zassert_true(status, NULL);
+    zassert_equal(debug_async_task(0), 1, NULL);
+    test_stream_text(stream, text, sizeof(text));
+    fclose(stream);
+    stream = tmpfile();
+    zassert_not_null(stream, NULL);
+    fprintf(stream, "hex:\n");
+    debug_hex_dump(stream, 0x10, data, sizeof(data));
+    test_stream_text(stream, expected, sizeof(expected));
+    zassert_equal(strcmp(text, expected), 0, "%s", text);
+    fclose(stream);
+}
+
+/**
+ * @brief Test a full ring, turning recording off, and the level filters
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(debug_async_tests, testDebugAsyncRing)
+#else
+static void testDebugAsyncRing(void)
+#endif
+{
+    FILE *stream = tmpfile();
+    char text[256];
+    unsigned i;
+
+    zassert_not_null(stream, NULL);
+    zassert_true(
+        debug_async_init(Test_Buffer, sizeof(Test_Buffer), TEST_RECORDS),
+        NULL);
+    for (i = 0; i < TEST_RECORDS + 2; i++) {
+        debug_fprintf(stream, "%u,", i);
+    }
+    zassert_equal(debug_async_dropped(), 2, NULL);
+    zassert_equal(debug_async_task(3), 3, NULL);
+    zassert_equal(debug_async_task(0), TEST_RECORDS - 3, NULL);
+    test_stream_text(stream, text, sizeof(text));
+    zassert_equal(strcmp(text, "0,1,2,3,4,5,6,7,"), 0, "%s", text);
+    /* printed directly while recording is off */
+    rewind(stream);
+    debug_async_enable(false);
+    zassert_false(debug_async_enabled(), NULL);
+    debug_fprintf(stream, "direct\n");
+    test_stream_text(stream, text, sizeof(text));
+    zassert_equal(strncmp(text, "direct\n", 7), 0, NULL);
+    zassert_equal(debug_async_task(0), 0, NULL);
+    debug_async_enable(true);
+    fclose(stream);
+    /* filtered messages are not even recorded */
+    zassert_equal(
+        debug_level(DEBUG_CATEGORY_BVLC), DEBUG_LEVEL_DEBUG, NULL);
+    debug_level_set(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_WARNING);
+    zassert_equal(
+        debug_level(DEBUG_CATEGORY_BVLC), DEBUG_LEVEL_WARNING, NULL);
+    zassert_true(
+        debug_level_enabled(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_ERROR), NULL);
+    zassert_true(
+        debug_level_enabled(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_WARNING), NULL);
+    zassert_false(
+        debug_level_enabled(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_INFO), NULL);
+    zassert_true(
+        debug_level_enabled(DEBUG_CATEGORY_DATALINK, DEBUG_LEVEL_DEBUG), NULL);
+    zassert_false(
+        debug_level_enabled(DEBUG_CATEGORY_DATALINK, DEBUG_LEVEL_NONE), NULL);
+    zassert_false(
+        debug_level_enabled(DEBUG_CATEGORY_MAX, DEBUG_LEVEL_ERROR), NULL);
+    debug_log(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG, "BVLC: %u\n", 1U);
+    zassert_equal(debug_async_task(0), 0, NULL);
+    debug_log(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_ERROR, "BVLC: %u\n", 2U);
+    zassert_equal(debug_async_task(0), 1, NULL);
+    debug_level_set(DEBUG_CATEGORY_BVLC, DEBUG_LEVEL_DEBUG);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(debug_async_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        debug_async_tests, ztest_unit_test(testDebugAsyncFormat),
+        ztest_unit_test(testDebugAsyncRing));
+
+    ztest_run_test_suite(debug_async_tests);
+}
+#endif
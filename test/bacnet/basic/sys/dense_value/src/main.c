@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief test dense struct-of-arrays value table API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <math.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/dense_value.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Scan callback that sums the instances of the visited slots
+ */
+static bool
+scan_instance_sum(const DENSE_VALUE_TABLE *table, uint32_t slot, void *context)
+{
+    uint32_t *sum = context;
+
+    *sum += table->Instance[slot];
+
+    return true;
+}
+
+/**
+ * @brief Scan callback that stops after the first slot
+ */
+static bool
+scan_first(const DENSE_VALUE_TABLE *table, uint32_t slot, void *context)
+{
+    (void)table;
+    *(uint32_t *)context = slot;
+
+    return false;
+}
+
+/**
+ * @brief Test slot allocation, reuse and growth
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dense_value_tests, testDenseValueSlots)
+#else
+static void testDenseValueSlots(void)
+#endif
+{
+    DENSE_VALUE_TABLE table;
+    uint32_t slot, i;
+
+    dense_value_table_init(&table);
+    zassert_equal(dense_value_table_count(&table), 0, NULL);
+    zassert_equal(dense_value_table_limit(&table), 0, NULL);
+    /* grow past the first allocation */
+    for (i = 0; i < 100; i++) {
+        slot = dense_value_slot_alloc(&table, 1000 + i);
+        zassert_equal(slot, i, NULL);
+        table.Present_Value[slot] = (float)i;
+    }
+    zassert_equal(dense_value_table_count(&table), 100, NULL);
+    zassert_equal(dense_value_table_limit(&table), 100, NULL);
+    for (i = 0; i < 100; i++) {
+        zassert_equal(table.Instance[i], 1000 + i, NULL);
+        zassert_false(islessgreater(table.Present_Value[i], (float)i), NULL);
+        zassert_true(dense_value_slot_in_use(&table, i), NULL);
+    }
+    /* freed slots are reused lowest first, with cleared values */
+    dense_value_slot_free(&table, 50);
+    dense_value_slot_free(&table, 10);
+    zassert_false(dense_value_slot_in_use(&table, 10), NULL);
+    zassert_equal(dense_value_table_count(&table), 98, NULL);
+    slot = dense_value_slot_alloc(&table, 1);
+    zassert_equal(slot, 10, NULL);
+    zassert_false(islessgreater(table.Present_Value[slot], 0.0f), NULL);
+    zassert_equal(table.Flags[slot], DENSE_VALUE_FLAG_IN_USE, NULL);
+    slot = dense_value_slot_alloc(&table, 2);
+    zassert_equal(slot, 50, NULL);
+    slot = dense_value_slot_alloc(&table, 3);
+    zassert_equal(slot, 100, NULL);
+    /* freeing the top slots lowers the scan limit */
+    dense_value_slot_free(&table, 99);
+    zassert_equal(dense_value_table_limit(&table), 101, NULL);
+    dense_value_slot_free(&table, 100);
+    zassert_equal(dense_value_table_limit(&table), 99, NULL);
+    /* freeing twice or out of range is ignored */
+    dense_value_slot_free(&table, 100);
+    dense_value_slot_free(&table, DENSE_VALUE_SLOT_NONE);
+    zassert_equal(dense_value_table_count(&table), 99, NULL);
+    dense_value_table_cleanup(&table);
+    zassert_equal(dense_value_table_count(&table), 0, NULL);
+    zassert_is_null(table.Present_Value, NULL);
+}
+
+/**
+ * @brief Test scanning the slots by flags
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dense_value_tests, testDenseValueScan)
+#else
+static void testDenseValueScan(void)
+#endif
+{
+    DENSE_VALUE_TABLE table;
+    uint32_t slot, i, sum = 0;
+    unsigned visited;
+
+    dense_value_table_init(&table);
+    visited = dense_value_table_scan(&table, 0, scan_instance_sum, &sum);
+    zassert_equal(visited, 0, NULL);
+    for (i = 1; i <= 10; i++) {
+        slot = dense_value_slot_alloc(&table, i);
+        if (i & 1) {
+            table.Flags[slot] |= DENSE_VALUE_FLAG_CHANGED;
+        }
+    }
+    dense_value_slot_free(&table, 4);
+    visited = dense_value_table_scan(&table, 0, scan_instance_sum, &sum);
+    zassert_equal(visited, 9, NULL);
+    zassert_equal(sum, 55 - 5, NULL);
+    sum = 0;
+    visited = dense_value_table_scan(
+        &table, DENSE_VALUE_FLAG_CHANGED, scan_instance_sum, &sum);
+    zassert_equal(visited, 4, NULL);
+    zassert_equal(sum, 1 + 3 + 7 + 9, NULL);
+    visited = dense_value_table_scan(&table, 0, scan_first, &slot);
+    zassert_equal(visited, 1, NULL);
+    zassert_equal(slot, 0, NULL);
+    dense_value_table_cleanup(&table);
+}
+
+/**
+ * @brief Test the bulk COV increment evaluation
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dense_value_tests, testDenseValueCOV)
+#else
+static void testDenseValueCOV(void)
+#endif
+{
+    DENSE_VALUE_TABLE table;
+    uint32_t bitmap[3] = { 0 };
+    uint32_t slot, i, limit;
+
+    dense_value_table_init(&table);
+    limit = dense_value_cov_evaluate(&table, bitmap, 3);
+    zassert_equal(limit, 0, NULL);
+    for (i = 0; i < 70; i++) {
+        slot = dense_value_slot_alloc(&table, i);
+        table.COV_Increment[slot] = 1.0f;
+    }
+    /* below, at, and above the increment, in both directions */
+    table.Present_Value[1] = 0.5f;
+    table.Present_Value[2] = 1.0f;
+    table.Present_Value[33] = -2.0f;
+    table.Present_Value[65] = 1.5f;
+    /* a freed slot never trips */
+    table.Present_Value[40] = 10.0f;
+    dense_value_slot_free(&table, 40);
+    limit = dense_value_cov_evaluate(&table, bitmap, 3);
+    zassert_equal(limit, 70, NULL);
+    zassert_equal(bitmap[0], 1U << 2, NULL);
+    zassert_equal(bitmap[1], 1U << 1, NULL);
+    zassert_equal(bitmap[2], 1U << 1, NULL);
+    zassert_true(table.Flags[2] & DENSE_VALUE_FLAG_CHANGED, NULL);
+    zassert_false(table.Flags[1] & DENSE_VALUE_FLAG_CHANGED, NULL);
+    zassert_false(islessgreater(table.Prior_Value[33], -2.0f), NULL);
+    zassert_false(islessgreater(table.Prior_Value[1], 0.0f), NULL);
+    /* slots already flagged are reported until their flag is cleared */
+    table.Flags[2] &= ~DENSE_VALUE_FLAG_CHANGED;
+    table.Flags[33] &= ~DENSE_VALUE_FLAG_CHANGED;
+    table.Flags[5] |= DENSE_VALUE_FLAG_CHANGED;
+    limit = dense_value_cov_evaluate(&table, bitmap, 3);
+    zassert_equal(bitmap[0], 1U << 5, NULL);
+    zassert_equal(bitmap[1], 0, NULL);
+    zassert_equal(bitmap[2], 1U << 1, NULL);
+    /* a short bitmap evaluates only the slots it can hold */
+    table.Present_Value[65] = 5.0f;
+    table.Flags[65] &= ~DENSE_VALUE_FLAG_CHANGED;
+    limit = dense_value_cov_evaluate(&table, bitmap, 1);
+    zassert_equal(limit, 70, NULL);
+    zassert_false(table.Flags[65] & DENSE_VALUE_FLAG_CHANGED, NULL);
+    dense_value_table_cleanup(&table);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(dense_value_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        dense_value_tests, ztest_unit_test(testDenseValueSlots),
+        ztest_unit_test(testDenseValueScan),
+        ztest_unit_test(testDenseValueCOV));
+
+    ztest_run_test_suite(dense_value_tests);
+}
+#endif
@@ -119,6 +119,31 @@ static void dst_test_valid(void)
     zassert_true(active == false, NULL);
     active = dst_active(&data, 2013, 10, 1, hour, minute, second);
     zassert_true(active == false, NULL);
+    /* the same day ends at midnight */
+    dst_init(&data, false, 4, 1, 0, 4, 1, 0, epoch_day, epoch_year);
+    active = dst_active(&data, 2013, 4, 1, 1, 59, 59);
+    zassert_true(active == false, NULL);
+    active = dst_active(&data, 2013, 4, 1, 23, 59, 59);
+    zassert_true(active == true, NULL);
+    active = dst_active(&data, 2013, 4, 2, 0, 0, 0);
+    zassert_true(active == false, NULL);
+    /* members changed directly are used after dst_changed() */
+    data.End_Month = 5;
+    dst_changed(&data);
+    active = dst_active(&data, 2013, 4, 2, 0, 0, 0);
+    zassert_true(active == true, NULL);
+    /* the instants of the ordinal days are computed for each year */
+    dst_init_defaults(&data);
+    active = dst_active(&data, 2013, 3, 10, 1, 59, 59);
+    zassert_true(active == false, NULL);
+    active = dst_active(&data, 2013, 3, 10, 2, 0, 0);
+    zassert_true(active == true, NULL);
+    active = dst_active(&data, 2014, 3, 9, 2, 0, 0);
+    zassert_true(active == true, NULL);
+    active = dst_active(&data, 2014, 11, 2, 0, 59, 59);
+    zassert_true(active == true, NULL);
+    active = dst_active(&data, 2014, 11, 2, 1, 0, 0);
+    zassert_true(active == false, NULL);
 }
 
 /**
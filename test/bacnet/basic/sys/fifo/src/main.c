@@ -6,6 +6,7 @@
  * @copyright SPDX-License-Identifier: MIT
  */
 #include <limits.h>
+#include <string.h>
 #include <zephyr/ztest.h>
 #include <bacnet/basic/sys/fifo.h>
 
@@ -163,6 +164,75 @@ static void testFIFOBuffer(void)
 
     return;
 }
+
+/**
+ * @brief Unit Test for the FIFO bulk copies and the contiguous windows
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(fifo_tests, testFIFOWindow)
+#else
+static void testFIFOWindow(void)
+#endif
+{
+    FIFO_BUFFER test_buffer = { 0 };
+    volatile uint8_t data_store[16] = { 0 };
+    volatile uint8_t odd_store[10] = { 0 };
+    uint8_t add_data[12] = { 0 };
+    uint8_t test_data[12] = { 0 };
+    volatile uint8_t *write_data = NULL;
+    volatile const uint8_t *read_data = NULL;
+    unsigned count, i;
+
+    for (i = 0; i < sizeof(add_data); i++) {
+        add_data[i] = (uint8_t)(i + 1);
+    }
+    FIFO_Init(&test_buffer, data_store, sizeof(data_store));
+    /* move the head and tail near the end of the data store */
+    zassert_true(FIFO_Add(&test_buffer, add_data, 10), NULL);
+    zassert_equal(FIFO_Pull(&test_buffer, NULL, 10), 10, NULL);
+    /* the block is split at the end of the data store */
+    zassert_true(FIFO_Add(&test_buffer, add_data, 12), NULL);
+    zassert_equal(data_store[15], 6, NULL);
+    zassert_equal(data_store[0], 7, NULL);
+    zassert_equal(FIFO_Peek_Ahead(&test_buffer, test_data, 12), 12, NULL);
+    zassert_equal(memcmp(test_data, add_data, 12), 0, NULL);
+    /* the read window ends at the end of the data store */
+    count = FIFO_Read_Window(&test_buffer, &read_data);
+    zassert_equal(count, 6, NULL);
+    zassert_equal(read_data, &data_store[10], NULL);
+    zassert_true(FIFO_Read_Commit(&test_buffer, count), NULL);
+    zassert_false(FIFO_Read_Commit(&test_buffer, 7), NULL);
+    count = FIFO_Read_Window(&test_buffer, &read_data);
+    zassert_equal(count, 6, NULL);
+    zassert_equal(read_data, &data_store[0], NULL);
+    zassert_equal(read_data[0], 7, NULL);
+    /* the write window is the free space up to the tail */
+    count = FIFO_Write_Window(&test_buffer, &write_data);
+    zassert_equal(count, 10, NULL);
+    zassert_equal(write_data, &data_store[6], NULL);
+    for (i = 0; i < count; i++) {
+        write_data[i] = (uint8_t)(0x80 + i);
+    }
+    zassert_false(FIFO_Write_Commit(&test_buffer, count + 1), NULL);
+    zassert_true(FIFO_Write_Commit(&test_buffer, count), NULL);
+    zassert_true(FIFO_Full(&test_buffer), NULL);
+    zassert_equal(FIFO_Write_Window(&test_buffer, &write_data), 0, NULL);
+    zassert_equal(FIFO_Pull(&test_buffer, test_data, 8), 8, NULL);
+    zassert_equal(test_data[5], 12, NULL);
+    zassert_equal(test_data[6], 0x80, NULL);
+    zassert_equal(test_data[7], 0x81, NULL);
+    zassert_equal(FIFO_Count(&test_buffer), 8, NULL);
+    /* a data store whose size is not a power of two */
+    FIFO_Init(&test_buffer, odd_store, sizeof(odd_store));
+    zassert_true(FIFO_Add(&test_buffer, add_data, 7), NULL);
+    zassert_equal(FIFO_Pull(&test_buffer, NULL, 7), 7, NULL);
+    zassert_true(FIFO_Add(&test_buffer, add_data, 10), NULL);
+    zassert_false(FIFO_Add(&test_buffer, add_data, 1), NULL);
+    zassert_equal(FIFO_Pull(&test_buffer, test_data, 12), 10, NULL);
+    zassert_equal(memcmp(test_data, add_data, 10), 0, NULL);
+    zassert_equal(FIFO_Write_Window(NULL, &write_data), 0, NULL);
+    zassert_equal(FIFO_Read_Window(NULL, &read_data), 0, NULL);
+}
 /**
  * @}
  */
@@ -172,7 +242,9 @@ ZTEST_SUITE(fifo_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(fifo_tests, ztest_unit_test(testFIFOBuffer));
+    ztest_test_suite(
+        fifo_tests, ztest_unit_test(testFIFOBuffer),
+        ztest_unit_test(testFIFOWindow));
 
     ztest_run_test_suite(fifo_tests);
 }
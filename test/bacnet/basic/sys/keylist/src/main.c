@@ -128,9 +128,13 @@ static void testKeyListDataKey(void)
     char *data2 = "Anna";
     char *data3 = "Mary";
     char *data;
+    OS_Keylist other;
 
     list = Keylist_Create();
     zassert_not_null(list, NULL);
+    other = Keylist_Create();
+    zassert_not_null(other, NULL);
+    zassert_equal(Keylist_Revision(list), 0, NULL);
 
     key = 1;
     index = Keylist_Data_Add(list, key, data1);
@@ -154,6 +158,9 @@ static void testKeyListDataKey(void)
     zassert_equal(test_key, key, NULL);
 
     zassert_equal(Keylist_Count(list), 3, NULL);
+    /* the revision counts the changes of this list only */
+    zassert_equal(Keylist_Revision(list), 3, NULL);
+    zassert_equal(Keylist_Revision(other), 0, NULL);
 
     /* look at the data */
     key = 2;
@@ -179,6 +186,9 @@ static void testKeyListDataKey(void)
     data = Keylist_Data_Delete(list, key);
     zassert_equal(data, NULL, NULL);
     zassert_equal(Keylist_Count(list), 2, NULL);
+    zassert_equal(Keylist_Revision(list), 4, NULL);
+    zassert_equal(Keylist_Revision(other), 0, NULL);
+    Keylist_Delete(other);
 
     key = 1;
     data = Keylist_Data(list, key);
@@ -311,6 +321,269 @@ static void testKeyListLarge(void)
     return;
 }
 
+/* test adding and deleting entries out of key order */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListRandom)
+#else
+static void testKeyListRandom(void)
+#endif
+{
+    static int data_list[1024] = { 0 };
+    const unsigned num_keys = 1024;
+    OS_Keylist list;
+    KEY key, test_key;
+    int index, count;
+    int *data;
+    bool status;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    /* 389 is relatively prime to 1024, so every key is visited once */
+    for (index = 0; index < num_keys; index++) {
+        key = ((KEY)index * 389) % num_keys;
+        data_list[key] = 42 + key;
+        zassert_true(Keylist_Data_Add(list, key, &data_list[key]) >= 0, NULL);
+    }
+    zassert_equal(Keylist_Count(list), num_keys, NULL);
+    for (index = 0; index < num_keys; index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key, index, NULL);
+        zassert_equal(Keylist_Index(list, key), index, NULL);
+    }
+    /* delete the odd keys */
+    for (key = 1; key < num_keys; key += 2) {
+        data = Keylist_Data_Delete(list, key);
+        zassert_not_null(data, NULL);
+        zassert_equal(*data, data_list[key], NULL);
+    }
+    zassert_equal(Keylist_Count(list), num_keys / 2, NULL);
+    for (key = 0; key < num_keys; key++) {
+        data = Keylist_Data(list, key);
+        if (key % 2) {
+            zassert_is_null(data, NULL);
+        } else {
+            zassert_not_null(data, NULL);
+            zassert_equal(*data, data_list[key], NULL);
+        }
+    }
+    zassert_equal(Keylist_Next_Empty_Key(list, 0), 1, NULL);
+    /* add the odd keys back */
+    for (key = 1; key < num_keys; key += 2) {
+        zassert_true(Keylist_Data_Add(list, key, &data_list[key]) >= 0, NULL);
+    }
+    zassert_equal(Keylist_Next_Empty_Key(list, 0), num_keys, NULL);
+    count = Keylist_Count(list);
+    zassert_equal(count, num_keys, NULL);
+    test_key = 0;
+    for (index = 0; index < count; index++) {
+        data = Keylist_Data_Index(list, index);
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key, test_key, NULL);
+        zassert_equal(*data, data_list[key], NULL);
+        test_key++;
+    }
+    Keylist_Delete(list);
+
+    return;
+}
+
+/* test adding and deleting many entries in one pass */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListBulk)
+#else
+static void testKeyListBulk(void)
+#endif
+{
+    static int data_list[1024] = { 0 };
+    static void *data_array[512] = { 0 };
+    static KEY key_array[512] = { 0 };
+    const unsigned num_keys = 1024;
+    OS_Keylist list;
+    KEY key;
+    int index, count;
+    int *data;
+    bool status;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    zassert_true(Keylist_Reserve(list, num_keys), NULL);
+    /* the even keys one at a time */
+    for (key = 0; key < num_keys; key += 2) {
+        data_list[key] = 42 + key;
+        zassert_true(Keylist_Data_Add(list, key, &data_list[key]) >= 0, NULL);
+    }
+    /* the odd keys in one pass */
+    for (index = 0; index < num_keys / 2; index++) {
+        key = (KEY)index * 2 + 1;
+        data_list[key] = 42 + key;
+        key_array[index] = key;
+        data_array[index] = &data_list[key];
+    }
+    count = Keylist_Data_Add_Keys(list, key_array, data_array, num_keys / 2);
+    zassert_equal(count, num_keys / 2, NULL);
+    zassert_equal(Keylist_Count(list), num_keys, NULL);
+    for (index = 0; index < num_keys; index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key, index, NULL);
+        data = Keylist_Data(list, key);
+        zassert_not_null(data, NULL);
+        zassert_equal(*data, data_list[key], NULL);
+    }
+    /* delete the odd keys in one pass, with one key that is not there */
+    key_array[num_keys / 2 - 1] = num_keys + 1;
+    count = Keylist_Data_Delete_Keys(list, key_array, data_array, num_keys / 2);
+    zassert_equal(count, num_keys / 2 - 1, NULL);
+    zassert_is_null(data_array[num_keys / 2 - 1], NULL);
+    zassert_equal(data_array[0], &data_list[1], NULL);
+    zassert_equal(Keylist_Count(list), num_keys / 2 + 1, NULL);
+    for (key = 0; key < num_keys - 1; key++) {
+        data = Keylist_Data(list, key);
+        if (key % 2) {
+            zassert_is_null(data, NULL);
+        } else {
+            zassert_not_null(data, NULL);
+            zassert_equal(*data, data_list[key], NULL);
+        }
+    }
+    zassert_not_null(Keylist_Data(list, num_keys - 1), NULL);
+    /* keys without data, with the data set later */
+    key_array[0] = num_keys + 1;
+    key_array[1] = num_keys + 3;
+    count = Keylist_Data_Add_Keys(list, key_array, NULL, 2);
+    zassert_equal(count, 2, NULL);
+    zassert_true(Keylist_Index(list, num_keys + 3) >= 0, NULL);
+    zassert_is_null(Keylist_Data(list, num_keys + 3), NULL);
+    status = Keylist_Data_Set(list, num_keys + 3, &data_list[0]);
+    zassert_true(status, NULL);
+    zassert_equal(Keylist_Data(list, num_keys + 3), &data_list[0], NULL);
+    status = Keylist_Data_Set(list, num_keys + 2, &data_list[0]);
+    zassert_false(status, NULL);
+    zassert_is_null(Keylist_Data(list, num_keys + 2), NULL);
+    Keylist_Delete(list);
+
+    return;
+}
+
+/**
+ * @brief Make a random looking key, which is unique for each number
+ * @param number [in] number from 0 to UINT32_MAX
+ * @return the key
+ */
+static KEY test_random_key(uint32_t number)
+{
+    uint32_t key = number;
+
+    /* each of the steps can be undone, so no two numbers share a key */
+    key *= 0x9E3779B1UL;
+    key ^= key >> 15;
+    key *= 0x85EBCA77UL;
+    key ^= key >> 13;
+
+    return (KEY)key;
+}
+
+/**
+ * @brief Check the order of the list, and find each key in it
+ * @param list [in] list under test
+ * @param keys [in] keys that were added, or 0 when deleted
+ * @param count [in] number of keys
+ */
+static void
+test_random_keys_check(OS_Keylist list, const KEY *keys, unsigned count)
+{
+    KEY key = 0, last_key = 0;
+    unsigned i, found = 0;
+    int index;
+    KEY *data;
+    bool status;
+
+    for (index = 0; index < Keylist_Count(list); index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        if (index > 0) {
+            zassert_true(key > last_key, "index=%d", index);
+        }
+        zassert_equal(Keylist_Index(list, key), index, NULL);
+        data = Keylist_Data_Index(list, index);
+        zassert_not_null(data, NULL);
+        zassert_equal(*data, key, NULL);
+        last_key = key;
+    }
+    for (i = 0; i < count; i++) {
+        if (keys[i]) {
+            data = Keylist_Data(list, keys[i]);
+            zassert_equal(data, &keys[i], "i=%u", i);
+            found++;
+        } else {
+            zassert_is_null(Keylist_Data(list, test_random_key(i)), NULL);
+        }
+    }
+    zassert_equal(Keylist_Count(list), found, NULL);
+}
+
+/* test adding many random keys, then deleting them in any order */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListRandomKeys)
+#else
+static void testKeyListRandomKeys(void)
+#endif
+{
+    static KEY key_list[4096] = { 0 };
+    const unsigned num_keys = 4096;
+    OS_Keylist list;
+    size_t full_size;
+    unsigned i;
+    int index;
+    KEY *data;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    /* number 0 is skipped, so that a key of 0 marks a deleted key */
+    for (i = 1; i < num_keys; i++) {
+        key_list[i] = test_random_key(i);
+        index = Keylist_Data_Add(list, key_list[i], &key_list[i]);
+        zassert_true(index >= 0, NULL);
+        zassert_equal(Keylist_Index(list, key_list[i]), index, NULL);
+    }
+    test_random_keys_check(list, key_list, num_keys);
+    full_size = Keylist_Memory_Size(list);
+    /* delete every third key, by key */
+    for (i = 3; i < num_keys; i += 3) {
+        data = Keylist_Data_Delete(list, key_list[i]);
+        zassert_equal(data, &key_list[i], NULL);
+        key_list[i] = 0;
+    }
+    test_random_keys_check(list, key_list, num_keys);
+    /* add them back */
+    for (i = 3; i < num_keys; i += 3) {
+        key_list[i] = test_random_key(i);
+        index = Keylist_Data_Add(list, key_list[i], &key_list[i]);
+        zassert_true(index >= 0, NULL);
+    }
+    test_random_keys_check(list, key_list, num_keys);
+    /* delete the rest from the middle of the list, by index */
+    while (Keylist_Count(list) > 0) {
+        index = Keylist_Count(list) / 2;
+        data = Keylist_Data_Index(list, index);
+        zassert_not_null(data, NULL);
+        zassert_equal(Keylist_Data_Delete_By_Index(list, index), data, NULL);
+        i = (unsigned)(data - key_list);
+        key_list[i] = 0;
+        if ((i % 256) == 0) {
+            test_random_keys_check(list, key_list, num_keys);
+        }
+    }
+    test_random_keys_check(list, key_list, num_keys);
+    /* the memory of the deleted nodes is given back */
+    zassert_true(Keylist_Memory_Size(list) < full_size, NULL);
+    Keylist_Delete(list);
+
+    return;
+}
+
 /* test the encode and decode macros */
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(keylist_tests, testKeySample)
@@ -356,7 +629,9 @@ void test_main(void)
         keylist_tests, ztest_unit_test(testKeyListFIFO),
         ztest_unit_test(testKeyListFILO), ztest_unit_test(testKeyListDataKey),
         ztest_unit_test(testKeyListDataIndex),
-        ztest_unit_test(testKeyListLarge), ztest_unit_test(testKeySample));
+        ztest_unit_test(testKeyListLarge),
+        ztest_unit_test(testKeyListRandom), ztest_unit_test(testKeyListBulk),
+        ztest_unit_test(testKeyListRandomKeys), ztest_unit_test(testKeySample));
 
     ztest_run_test_suite(keylist_tests);
 }
@@ -554,6 +554,91 @@ static void test_lighting_command_command_unit(void)
     lighting_command_init(NULL);
 }
 
+static BACNET_LIGHTING_COMMAND_DATA Transition_Data[2];
+
+/**
+ * @brief Steps the lighting command used by the transition test
+ * @param key - index of the lighting command
+ * @param milliseconds - elapsed time in milliseconds
+ * @return true while the lighting command is in progress
+ */
+static bool dimmer_transition(uint32_t key, uint16_t milliseconds)
+{
+    BACNET_LIGHTING_COMMAND_DATA *data = &Transition_Data[key];
+
+    lighting_command_timer(data, milliseconds);
+
+    return (data->Lighting_Operation != BACNET_LIGHTS_NONE) &&
+        (data->Lighting_Operation != BACNET_LIGHTS_STOP);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(lighting_command_tests, test_lighting_command_transition)
+#else
+static void test_lighting_command_transition(void)
+#endif
+{
+    BACNET_LIGHTING_COMMAND_DATA *data;
+    unsigned i;
+    int32_t value;
+
+    /* fixed-point interpolation */
+    value = lighting_command_fixed_interpolate(
+        lighting_command_fixed(1.0f), lighting_command_fixed(100.0f), 500,
+        1000);
+    zassert_true(
+        is_float_equal(lighting_command_fixed_to_float(value), 50.5f), NULL);
+    value = lighting_command_fixed_interpolate(
+        lighting_command_fixed(100.0f), lighting_command_fixed(0.0f), 250,
+        1000);
+    zassert_true(
+        is_float_equal(lighting_command_fixed_to_float(value), 75.0f), NULL);
+    value = lighting_command_fixed_interpolate(0, 100, 2000, 1000);
+    zassert_equal(value, 100, NULL);
+    /* commands without a transition callback are not started */
+    for (i = 0; i < 2; i++) {
+        data = &Transition_Data[i];
+        lighting_command_init(data);
+        lighting_command_fade_to(data, 100.0f, 1000);
+        zassert_false(
+            lighting_command_transition_active(&data->Transition), NULL);
+        data->Transition.key = i;
+        data->Transition.callback = dimmer_transition;
+    }
+    zassert_equal(lighting_command_transition_count(), 0, NULL);
+    /* only the active transitions are stepped */
+    lighting_command_fade_to(&Transition_Data[0], 100.0f, 1000);
+    lighting_command_ramp_to(&Transition_Data[1], 100.0f, 100.0f);
+    zassert_equal(lighting_command_transition_count(), 2, NULL);
+    lighting_command_fade_to(&Transition_Data[0], 100.0f, 1000);
+    zassert_equal(lighting_command_transition_count(), 2, NULL);
+    lighting_command_transition_task(500);
+    zassert_true(
+        is_float_equal(Transition_Data[0].Tracking_Value, 50.5f), NULL);
+    zassert_equal(
+        Transition_Data[0].In_Progress, BACNET_LIGHTING_FADE_ACTIVE, NULL);
+    zassert_equal(
+        Transition_Data[1].In_Progress, BACNET_LIGHTING_RAMP_ACTIVE, NULL);
+    lighting_command_transition_task(500);
+    zassert_equal(Transition_Data[0].In_Progress, BACNET_LIGHTING_IDLE, NULL);
+    zassert_false(
+        lighting_command_transition_active(&Transition_Data[0].Transition),
+        NULL);
+    zassert_equal(lighting_command_transition_count(), 1, NULL);
+    /* stopping removes the transition */
+    lighting_command_transition_stop(&Transition_Data[1].Transition);
+    zassert_equal(lighting_command_transition_count(), 0, NULL);
+    lighting_command_transition_stop(&Transition_Data[1].Transition);
+    lighting_command_transition_task(500);
+    zassert_equal(lighting_command_transition_count(), 0, NULL);
+    /* a STOP is performed once */
+    lighting_command_stop(&Transition_Data[1]);
+    zassert_equal(lighting_command_transition_count(), 1, NULL);
+    lighting_command_transition_task(10);
+    zassert_equal(Transition_Data[1].In_Progress, BACNET_LIGHTING_IDLE, NULL);
+    zassert_equal(lighting_command_transition_count(), 0, NULL);
+}
+
 /**
  * @}
  */
@@ -565,7 +650,8 @@ void test_main(void)
 {
     ztest_test_suite(
         lighting_command_tests,
-        ztest_unit_test(test_lighting_command_command_unit));
+        ztest_unit_test(test_lighting_command_command_unit),
+        ztest_unit_test(test_lighting_command_transition));
 
     ztest_run_test_suite(lighting_command_tests);
 }
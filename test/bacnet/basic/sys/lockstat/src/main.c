@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Unit test for the lock wait and queue depth statistics
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/lockstat.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static LOCKSTAT_LOCK Test_Lock_A = LOCKSTAT_LOCK_INIT("lock-a");
+static LOCKSTAT_LOCK Test_Lock_B = LOCKSTAT_LOCK_INIT("lock-b");
+static LOCKSTAT_QUEUE Test_Queue = LOCKSTAT_QUEUE_INIT("queue");
+
+/**
+ * @brief Test the acquisitions and the wait histogram of a lock
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(lockstat_tests, testLockStatistics)
+#else
+static void testLockStatistics(void)
+#endif
+{
+    const LOCKSTAT_LOCK *lock;
+    unsigned count = 0;
+
+    lockstat_lock_register(&Test_Lock_A);
+    lockstat_lock_register(&Test_Lock_B);
+    /* a lock is registered once */
+    lockstat_lock_register(&Test_Lock_A);
+    lockstat_lock_register(NULL);
+    for (lock = lockstat_locks(); lock; lock = lock->next) {
+        count++;
+    }
+    zassert_equal(count, 2, NULL);
+    zassert_equal(lockstat_locks(), &Test_Lock_B, NULL);
+    lockstat_lock_record(&Test_Lock_A, false, 0);
+    lockstat_lock_record(&Test_Lock_A, true, 1);
+    lockstat_lock_record(&Test_Lock_A, true, 5);
+    lockstat_lock_record(&Test_Lock_A, true, UINT32_MAX);
+    lockstat_lock_record(NULL, true, 5);
+    zassert_equal(Test_Lock_A.acquisitions, 4, NULL);
+    zassert_equal(Test_Lock_A.contended, 3, NULL);
+    zassert_equal(Test_Lock_A.wait_total, 6ULL + UINT32_MAX, NULL);
+    zassert_equal(Test_Lock_A.wait_max, UINT32_MAX, NULL);
+    /* bucket N counts 2^(N-1) to 2^N-1, and the last all longer waits */
+    zassert_equal(Test_Lock_A.wait_histogram[0], 1, NULL);
+    zassert_equal(Test_Lock_A.wait_histogram[1], 1, NULL);
+    zassert_equal(Test_Lock_A.wait_histogram[3], 1, NULL);
+    zassert_equal(Test_Lock_A.wait_histogram[LOCKSTAT_BUCKETS - 1], 1, NULL);
+    zassert_equal(Test_Lock_B.acquisitions, 0, NULL);
+    lockstat_reset();
+    zassert_equal(Test_Lock_A.acquisitions, 0, NULL);
+    zassert_equal(Test_Lock_A.wait_histogram[3], 0, NULL);
+    zassert_true(Test_Lock_A.registered, NULL);
+}
+
+/**
+ * @brief Test the depth samples of a queue
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(lockstat_tests, testQueueStatistics)
+#else
+static void testQueueStatistics(void)
+#endif
+{
+    lockstat_queue_register(&Test_Queue);
+    lockstat_queue_register(&Test_Queue);
+    zassert_equal(lockstat_queues(), &Test_Queue, NULL);
+    zassert_is_null(Test_Queue.next, NULL);
+    lockstat_queue_sample(&Test_Queue, 3);
+    lockstat_queue_sample(&Test_Queue, 7);
+    lockstat_queue_sample(&Test_Queue, 2);
+    lockstat_queue_sample(NULL, 9);
+    zassert_equal(Test_Queue.depth, 2, NULL);
+    zassert_equal(Test_Queue.depth_max, 7, NULL);
+    zassert_equal(Test_Queue.samples, 3, NULL);
+    zassert_equal(Test_Queue.depth_total, 12, NULL);
+    lockstat_reset();
+    zassert_equal(Test_Queue.depth_max, 0, NULL);
+    zassert_equal(Test_Queue.samples, 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(lockstat_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        lockstat_tests, ztest_unit_test(testLockStatistics),
+        ztest_unit_test(testQueueStatistics));
+
+    ztest_run_test_suite(lockstat_tests);
+}
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file
+ * @brief test pools of fixed size memory blocks
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/mempool.h>
+#include <bacnet/basic/sys/keylist.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static uint64_t Test_Memory[512 / sizeof(uint64_t)];
+
+/**
+ * @brief Count the blocks in use in all of the pools
+ * @return number of blocks in use
+ */
+static unsigned long test_mempool_used(void)
+{
+    MEMPOOL_STATS stats;
+    unsigned long used = 0;
+    unsigned i;
+
+    for (i = 0; i <= MEMPOOL_CLASS_COUNT; i++) {
+        zassert_true(mempool_stats(i, &stats), NULL);
+        used += stats.used;
+    }
+
+    return used;
+}
+
+/**
+ * @brief Test the size classes, the static memory, and the statistics
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mempool_tests, testMemPool)
+#else
+static void testMemPool(void)
+#endif
+{
+    MEMPOOL_STATS stats;
+    uint8_t *block[20];
+    uint8_t *big;
+    uintptr_t first, last;
+    unsigned i;
+
+    zassert_false(mempool_init(NULL, sizeof(Test_Memory)), NULL);
+    zassert_false(mempool_init(Test_Memory, 8), NULL);
+    zassert_true(mempool_init(Test_Memory, sizeof(Test_Memory)), NULL);
+    zassert_equal(mempool_static_available(), sizeof(Test_Memory), NULL);
+    zassert_is_null(mempool_calloc(0), NULL);
+    /* 24 bytes are taken from the 32 byte class, 8 blocks per chunk */
+    first = (uintptr_t)&Test_Memory[0];
+    last = first + sizeof(Test_Memory);
+    for (i = 0; i < 16; i++) {
+        block[i] = mempool_calloc(24);
+        zassert_not_null(block[i], NULL);
+        zassert_true((uintptr_t)block[i] >= first, NULL);
+        zassert_true((uintptr_t)block[i] < last, NULL);
+        memset(block[i], 0xa5, 24);
+    }
+    zassert_equal(mempool_static_available(), 0, NULL);
+    /* then from the heap, once the static memory is used */
+    for (i = 16; i < 20; i++) {
+        block[i] = mempool_calloc(32);
+        zassert_not_null(block[i], NULL);
+        zassert_true(
+            ((uintptr_t)block[i] < first) || ((uintptr_t)block[i] >= last),
+            NULL);
+    }
+    zassert_true(mempool_stats(1, &stats), NULL);
+    zassert_equal(stats.block_size, 32, NULL);
+    zassert_equal(stats.blocks, 24, NULL);
+    zassert_equal(stats.used, 20, NULL);
+    zassert_equal(stats.peak, 20, NULL);
+    zassert_equal(stats.allocations, 20, NULL);
+    zassert_equal(stats.failures, 0, NULL);
+    /* a freed block is reused, and is zeroed again */
+    mempool_free(block[3], 24);
+    zassert_equal(mempool_calloc(17), block[3], NULL);
+    for (i = 0; i < 24; i++) {
+        zassert_equal(block[3][i], 0, NULL);
+    }
+    for (i = 0; i < 20; i++) {
+        mempool_free(block[i], 32);
+    }
+    mempool_free(NULL, 32);
+    zassert_true(mempool_stats(1, &stats), NULL);
+    zassert_equal(stats.used, 0, NULL);
+    zassert_equal(stats.peak, 20, NULL);
+    zassert_equal(stats.blocks, 24, NULL);
+    /* too large for a size class */
+    big = mempool_calloc(5000);
+    zassert_not_null(big, NULL);
+    zassert_true(mempool_stats(MEMPOOL_CLASS_COUNT, &stats), NULL);
+    zassert_equal(stats.block_size, 0, NULL);
+    zassert_equal(stats.used, 1, NULL);
+    mempool_free(big, 5000);
+    zassert_true(mempool_stats(MEMPOOL_CLASS_COUNT, &stats), NULL);
+    zassert_equal(stats.used, 0, NULL);
+    zassert_false(mempool_stats(MEMPOOL_CLASS_COUNT + 1, &stats), NULL);
+    zassert_false(mempool_stats(0, NULL), NULL);
+}
+
+/**
+ * @brief Test that a key list returns all of its blocks
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mempool_tests, testMemPoolKeylist)
+#else
+static void testMemPoolKeylist(void)
+#endif
+{
+    static int data[100];
+    OS_Keylist list;
+    unsigned long used;
+    KEY key;
+
+    used = test_mempool_used();
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    for (key = 0; key < 100; key++) {
+        zassert_true(Keylist_Data_Add(list, key, &data[key]) >= 0, NULL);
+    }
+    zassert_true(test_mempool_used() > used, NULL);
+    for (key = 0; key < 100; key += 2) {
+        zassert_equal(Keylist_Data_Delete(list, key), &data[key], NULL);
+    }
+    zassert_equal(Keylist_Data(list, 51), &data[51], NULL);
+    zassert_equal(Keylist_Count(list), 50, NULL);
+    Keylist_Delete(list);
+    zassert_equal(test_mempool_used(), used, NULL);
+}
+
+static size_t Test_Failure_Size;
+
+static void test_failure_handler(size_t size)
+{
+    Test_Failure_Size = size;
+}
+
+/**
+ * @brief Test resizing blocks, the failure handler, and the memory report
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mempool_tests, testMemPoolRealloc)
+#else
+static void testMemPoolRealloc(void)
+#endif
+{
+    BACNET_MEMORY_USAGE usage = { 0 };
+    MEMPOOL_STATS stats;
+    unsigned long failures;
+    uint8_t *block, *bigger;
+    size_t huge = ((size_t)-1) / 2;
+    unsigned i;
+
+    block = mempool_realloc(NULL, 0, 20);
+    zassert_not_null(block, NULL);
+    for (i = 0; i < 20; i++) {
+        block[i] = (uint8_t)i;
+    }
+    /* the block stays in place within its size class */
+    zassert_equal(mempool_realloc(block, 20, 30), block, NULL);
+    bigger = mempool_realloc(block, 30, 100);
+    zassert_not_null(bigger, NULL);
+    zassert_not_equal(bigger, block, NULL);
+    for (i = 0; i < 20; i++) {
+        zassert_equal(bigger[i], i, NULL);
+    }
+    zassert_is_null(mempool_realloc(bigger, 100, 0), NULL);
+    /* a failed request is counted and given to the failure handler */
+    zassert_true(mempool_stats(MEMPOOL_CLASS_COUNT, &stats), NULL);
+    failures = stats.failures;
+    mempool_failure_handler_set(test_failure_handler);
+    zassert_is_null(mempool_calloc(huge), NULL);
+    zassert_equal(Test_Failure_Size, huge, NULL);
+    zassert_true(mempool_stats(MEMPOOL_CLASS_COUNT, &stats), NULL);
+    zassert_equal(stats.failures, failures + 1, NULL);
+    mempool_failure_handler_set(NULL);
+    /* the static memory is reported whole, and the heap chunks */
+    block = mempool_calloc(24);
+    mempool_memory_usage(&usage);
+    zassert_true((usage.static_bytes + usage.dynamic_bytes) > 0, NULL);
+    zassert_true(usage.count > 0, NULL);
+    mempool_free(block, 24);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(mempool_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        mempool_tests, ztest_unit_test(testMemPool),
+        ztest_unit_test(testMemPoolKeylist),
+        ztest_unit_test(testMemPoolRealloc));
+
+    ztest_run_test_suite(mempool_tests);
+}
+#endif
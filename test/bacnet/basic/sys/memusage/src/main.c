@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief test memory accounting API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/keylist.h>
+#include <bacnet/basic/sys/memusage.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static OS_Keylist Test_List;
+static uint32_t Test_Table[16];
+
+static void test_list_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    unsigned count;
+
+    count = (unsigned)Keylist_Count(Test_List);
+    usage->dynamic_bytes += Keylist_Memory_Size(Test_List);
+    usage->dynamic_bytes += count * sizeof(uint32_t);
+    usage->count += count;
+}
+
+static void test_table_memory_usage(BACNET_MEMORY_USAGE *usage)
+{
+    usage->static_bytes += sizeof(Test_Table);
+}
+
+/**
+ * @brief Test registering modules and gathering their reports
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(memusage_tests, testMemoryUsage)
+#else
+static void testMemoryUsage(void)
+#endif
+{
+    BACNET_MEMORY_USAGE usage = { 0 };
+    BACNET_MEMORY_USAGE total = { 0 };
+    static uint32_t data[3];
+    const char *name = NULL;
+    size_t list_size;
+    unsigned i;
+
+    zassert_equal(memusage_module_count(), 0, NULL);
+    zassert_false(memusage_register("none", NULL), NULL);
+    zassert_true(memusage_register("table", test_table_memory_usage), NULL);
+    zassert_true(memusage_register("list", test_list_memory_usage), NULL);
+    /* a function is registered once */
+    zassert_true(memusage_register("list", test_list_memory_usage), NULL);
+    zassert_equal(memusage_module_count(), 2, NULL);
+    zassert_true(memusage_module(0, &name, &usage), NULL);
+    zassert_equal(strcmp(name, "table"), 0, NULL);
+    zassert_equal(usage.static_bytes, sizeof(Test_Table), NULL);
+    zassert_equal(usage.dynamic_bytes, 0, NULL);
+    zassert_false(memusage_module(2, &name, &usage), NULL);
+    /* the heap used by a list grows with its nodes */
+    zassert_equal(Keylist_Memory_Size(NULL), 0, NULL);
+    Test_List = Keylist_Create();
+    list_size = Keylist_Memory_Size(Test_List);
+    zassert_true(list_size > 0, NULL);
+    for (i = 0; i < 3; i++) {
+        zassert_true(Keylist_Data_Add(Test_List, i, &data[i]) >= 0, NULL);
+    }
+    zassert_true(Keylist_Memory_Size(Test_List) > list_size, NULL);
+    zassert_true(memusage_module(1, &name, &usage), NULL);
+    zassert_equal(strcmp(name, "list"), 0, NULL);
+    zassert_equal(usage.static_bytes, 0, NULL);
+    zassert_equal(
+        usage.dynamic_bytes,
+        Keylist_Memory_Size(Test_List) + (3 * sizeof(uint32_t)), NULL);
+    zassert_equal(usage.count, 3, NULL);
+    memusage_total(&total);
+    zassert_equal(total.static_bytes, sizeof(Test_Table), NULL);
+    zassert_equal(total.dynamic_bytes, usage.dynamic_bytes, NULL);
+    zassert_equal(total.count, 3, NULL);
+    memusage_debug_print();
+    Keylist_Delete(Test_List);
+    Test_List = NULL;
+    memusage_cleanup();
+    zassert_equal(memusage_module_count(), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(memusage_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(memusage_tests, ztest_unit_test(testMemoryUsage));
+
+    ztest_run_test_suite(memusage_tests);
+}
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief test timed callbacks on the millisecond timer clock
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <limits.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/mstimer.h>
+#include <bacnet/basic/sys/mstimer_wheel.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static unsigned long Test_Now;
+
+unsigned long mstimer_now(void)
+{
+    return Test_Now;
+}
+
+struct test_event_data {
+    unsigned count;
+    unsigned long elapsed;
+    struct mstimer_wheel_event *stop;
+};
+
+static void
+test_event_callback(struct mstimer_wheel_event *event, unsigned long elapsed)
+{
+    struct test_event_data *data = event->context;
+
+    data->count++;
+    data->elapsed = elapsed;
+    if (data->stop) {
+        mstimer_wheel_event_stop(data->stop);
+    }
+}
+
+/**
+ * @brief Test one-shot events
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mstimer_wheel_tests, testMstimerWheelOneShot)
+#else
+static void testMstimerWheelOneShot(void)
+#endif
+{
+    struct mstimer_wheel_event event[2];
+    struct test_event_data data[2] = { 0 };
+    unsigned count;
+
+    Test_Now = ULONG_MAX - 10;
+    mstimer_wheel_init();
+    zassert_equal(mstimer_wheel_next(), ULONG_MAX, NULL);
+    mstimer_wheel_event_init(&event[0], test_event_callback, &data[0]);
+    mstimer_wheel_event_init(&event[1], test_event_callback, &data[1]);
+    zassert_false(mstimer_wheel_event_pending(&event[0]), NULL);
+    mstimer_wheel_event_start(&event[0], 100);
+    /* started between two task calls, across the clock wrap */
+    Test_Now += 30;
+    mstimer_wheel_event_start(&event[1], 50);
+    zassert_equal(mstimer_wheel_event_remaining(&event[0]), 70, NULL);
+    zassert_equal(mstimer_wheel_event_remaining(&event[1]), 50, NULL);
+    zassert_equal(mstimer_wheel_next(), 50, NULL);
+    Test_Now += 49;
+    count = mstimer_wheel_task();
+    zassert_equal(count, 0, NULL);
+    Test_Now += 1;
+    count = mstimer_wheel_task();
+    zassert_equal(count, 1, NULL);
+    zassert_equal(data[1].count, 1, NULL);
+    zassert_equal(data[1].elapsed, 50, NULL);
+    zassert_false(mstimer_wheel_event_pending(&event[1]), NULL);
+    zassert_equal(mstimer_wheel_next(), 20, NULL);
+    /* late by 5 ms */
+    Test_Now += 25;
+    count = mstimer_wheel_task();
+    zassert_equal(count, 1, NULL);
+    zassert_equal(data[0].elapsed, 105, NULL);
+    zassert_equal(mstimer_wheel_next(), ULONG_MAX, NULL);
+    /* restarting replaces the due time, and a stopped event never runs */
+    mstimer_wheel_event_start(&event[0], 10);
+    mstimer_wheel_event_start(&event[0], 1000);
+    mstimer_wheel_event_start(&event[1], 10);
+    mstimer_wheel_event_stop(&event[1]);
+    Test_Now += 500;
+    count = mstimer_wheel_task();
+    zassert_equal(count, 0, NULL);
+    zassert_equal(mstimer_wheel_event_remaining(&event[0]), 500, NULL);
+    /* a callback that stops an event that is also due, one tick later */
+    mstimer_wheel_event_start(&event[1], 501);
+    data[0].stop = &event[1];
+    Test_Now += 501;
+    count = mstimer_wheel_task();
+    zassert_equal(count, 1, NULL);
+    zassert_equal(data[0].count, 2, NULL);
+    zassert_equal(data[1].count, 1, NULL);
+}
+
+/**
+ * @brief Test periodic events
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(mstimer_wheel_tests, testMstimerWheelPeriodic)
+#else
+static void testMstimerWheelPeriodic(void)
+#endif
+{
+    struct mstimer_wheel_event event;
+    struct test_event_data data = { 0 };
+    unsigned i;
+
+    Test_Now = 0;
+    mstimer_wheel_init();
+    mstimer_wheel_event_init(&event, test_event_callback, &data);
+    mstimer_wheel_event_periodic(&event, 1000);
+    /* a late callback does not delay the ones after it */
+    Test_Now = 1100;
+    mstimer_wheel_task();
+    zassert_equal(data.count, 1, NULL);
+    zassert_equal(data.elapsed, 1100, NULL);
+    zassert_true(mstimer_wheel_event_pending(&event), NULL);
+    zassert_equal(mstimer_wheel_event_remaining(&event), 900, NULL);
+    Test_Now = 2000;
+    mstimer_wheel_task();
+    zassert_equal(data.count, 2, NULL);
+    zassert_equal(data.elapsed, 900, NULL);
+    /* more than a period behind starts over */
+    Test_Now = 5500;
+    mstimer_wheel_task();
+    zassert_equal(data.count, 3, NULL);
+    zassert_equal(mstimer_wheel_event_remaining(&event), 1000, NULL);
+    for (i = 0; i < 10; i++) {
+        Test_Now += 100;
+        mstimer_wheel_task();
+    }
+    zassert_equal(data.count, 4, NULL);
+    mstimer_wheel_event_periodic(&event, 0);
+    zassert_false(mstimer_wheel_event_pending(&event), NULL);
+    Test_Now += 5000;
+    zassert_equal(mstimer_wheel_task(), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(mstimer_wheel_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        mstimer_wheel_tests, ztest_unit_test(testMstimerWheelOneShot),
+        ztest_unit_test(testMstimerWheelPeriodic));
+
+    ztest_run_test_suite(mstimer_wheel_tests);
+}
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief test PDU buffers with headroom
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/pbuf.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test encoding after the headroom and prepending a header in place
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(pbuf_tests, testPbufPrepend)
+#else
+static void testPbufPrepend(void)
+#endif
+{
+    uint8_t buffer[32] = { 0 };
+    const uint8_t npdu[] = { 0x01, 0x00, 0x30, 0x01 };
+    const uint8_t header[] = { 0x81, 0x0a, 0x00, 0x08 };
+    BACNET_PBUF pbuf;
+    uint8_t *tail;
+    uint8_t *head;
+
+    zassert_false(pbuf_init(NULL, buffer, sizeof(buffer), 4), NULL);
+    zassert_false(pbuf_init(&pbuf, NULL, sizeof(buffer), 4), NULL);
+    zassert_false(pbuf_init(&pbuf, buffer, sizeof(buffer), 33), NULL);
+    zassert_true(pbuf_init(&pbuf, buffer, sizeof(buffer), 4), NULL);
+    zassert_equal(pbuf_headroom(&pbuf), 4, NULL);
+    zassert_equal(pbuf_tailroom(&pbuf), 28, NULL);
+    zassert_equal(pbuf_length(&pbuf), 0, NULL);
+    zassert_equal(pbuf_data(&pbuf), &buffer[4], NULL);
+    /* encode in place, then append the encoded bytes */
+    tail = pbuf_tail(&pbuf);
+    zassert_equal(tail, &buffer[4], NULL);
+    memcpy(tail, npdu, sizeof(npdu));
+    zassert_equal(pbuf_append(&pbuf, sizeof(npdu)), tail, NULL);
+    zassert_equal(pbuf_length(&pbuf), sizeof(npdu), NULL);
+    zassert_equal(pbuf_tailroom(&pbuf), 24, NULL);
+    /* prepend the header - the message is contiguous */
+    zassert_is_null(pbuf_prepend(&pbuf, 5), NULL);
+    head = pbuf_prepend(&pbuf, sizeof(header));
+    zassert_equal(head, &buffer[0], NULL);
+    memcpy(head, header, sizeof(header));
+    zassert_equal(pbuf_headroom(&pbuf), 0, NULL);
+    zassert_equal(pbuf_length(&pbuf), 8, NULL);
+    zassert_equal(memcmp(pbuf_data(&pbuf), header, sizeof(header)), 0, NULL);
+    zassert_equal(memcmp(&buffer[4], npdu, sizeof(npdu)), 0, NULL);
+    /* strip the header on the way back up */
+    zassert_false(pbuf_remove_header(&pbuf, 9), NULL);
+    zassert_true(pbuf_remove_header(&pbuf, sizeof(header)), NULL);
+    zassert_equal(pbuf_data(&pbuf), &buffer[4], NULL);
+    zassert_equal(pbuf_length(&pbuf), sizeof(npdu), NULL);
+    zassert_equal(pbuf_headroom(&pbuf), 4, NULL);
+}
+
+/**
+ * @brief Test appending until the buffer is full
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(pbuf_tests, testPbufAppend)
+#else
+static void testPbufAppend(void)
+#endif
+{
+    uint8_t buffer[16] = { 0 };
+    BACNET_PBUF pbuf;
+
+    zassert_true(pbuf_init(&pbuf, buffer, sizeof(buffer), 0), NULL);
+    zassert_equal(pbuf_append(&pbuf, 10), &buffer[0], NULL);
+    zassert_equal(pbuf_append(&pbuf, 6), &buffer[10], NULL);
+    zassert_equal(pbuf_tailroom(&pbuf), 0, NULL);
+    zassert_is_null(pbuf_append(&pbuf, 1), NULL);
+    zassert_is_null(pbuf_tail(NULL), NULL);
+    zassert_is_null(pbuf_data(NULL), NULL);
+    zassert_equal(pbuf_length(NULL), 0, NULL);
+    zassert_equal(pbuf_tailroom(NULL), 0, NULL);
+    zassert_is_null(pbuf_append(NULL, 0), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(pbuf_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        pbuf_tests, ztest_unit_test(testPbufPrepend),
+        ztest_unit_test(testPbufAppend));
+
+    ztest_run_test_suite(pbuf_tests);
+}
+#endif
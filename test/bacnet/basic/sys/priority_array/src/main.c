@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief test the active slots of a BACnet priority array
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/bits.h>
+#include <bacnet/basic/sys/priority_array.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test finding the highest active priority of a priority array
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(priority_array_tests, testPriorityActiveNext)
+#else
+static void testPriorityActiveNext(void)
+#endif
+{
+    uint16_t active_bits = 0;
+    unsigned priority = 0;
+
+    for (priority = 1; priority <= BACNET_MAX_PRIORITY; priority++) {
+        zassert_equal(Priority_Active_Next(active_bits, priority), 0, NULL);
+    }
+    BIT_SET(active_bits, 8 - 1);
+    BIT_SET(active_bits, BACNET_MAX_PRIORITY - 1);
+    zassert_equal(Priority_Active_Next(active_bits, 0), 8, NULL);
+    zassert_equal(Priority_Active_Next(active_bits, 1), 8, NULL);
+    zassert_equal(Priority_Active_Next(active_bits, 8), 8, NULL);
+    zassert_equal(Priority_Active_Next(active_bits, 9), 16, NULL);
+    zassert_equal(
+        Priority_Active_Next(active_bits, BACNET_MAX_PRIORITY), 16, NULL);
+    zassert_equal(
+        Priority_Active_Next(active_bits, BACNET_MAX_PRIORITY + 1), 0, NULL);
+    BIT_SET(active_bits, 1 - 1);
+    zassert_equal(Priority_Active_Next(active_bits, 1), 1, NULL);
+    zassert_equal(Priority_Active_Next(active_bits, 2), 8, NULL);
+}
+
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(priority_array_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        priority_array_tests, ztest_unit_test(testPriorityActiveNext));
+
+    ztest_run_test_suite(priority_array_tests);
+}
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @brief test read-copy-update publication API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/rcu.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test the read sections and the grace periods of a domain
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(rcu_tests, testRcuReadSection)
+#else
+static void testRcuReadSection(void)
+#endif
+{
+    RCU_DOMAIN domain;
+    unsigned phase, phase2;
+
+    rcu_init(&domain);
+    phase = rcu_read_lock(&domain);
+    zassert_equal(domain.readers[phase & 1], 1, NULL);
+    /* nested read sections join the same phase */
+    phase2 = rcu_read_lock(&domain);
+    zassert_equal(phase, phase2, NULL);
+    zassert_equal(domain.readers[phase & 1], 2, NULL);
+    rcu_read_unlock(&domain, phase2);
+    rcu_read_unlock(&domain, phase);
+    zassert_equal(domain.readers[phase & 1], 0, NULL);
+    /* a grace period moves new readers to the other phase */
+    rcu_synchronize(&domain);
+    phase2 = rcu_read_lock(&domain);
+    zassert_not_equal(phase & 1, phase2 & 1, NULL);
+    zassert_equal(domain.readers[phase & 1], 0, NULL);
+    zassert_equal(domain.readers[phase2 & 1], 1, NULL);
+    rcu_read_unlock(&domain, phase2);
+    zassert_equal(domain.readers[phase2 & 1], 0, NULL);
+}
+
+/**
+ * @brief Test publishing, replacing, and withdrawing data
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(rcu_tests, testRcuPublish)
+#else
+static void testRcuPublish(void)
+#endif
+{
+    RCU_DOMAIN domain = { 0 };
+    RCU_POINTER pointer = NULL;
+    int data[2] = { 1, 2 };
+    unsigned phase, phase2;
+    void *old_data;
+
+    phase = rcu_read_lock(&domain);
+    zassert_is_null(rcu_dereference(&pointer), NULL);
+    rcu_read_unlock(&domain, phase);
+    /* nothing is replaced, so there is no grace period */
+    old_data = rcu_publish(&domain, &pointer, &data[0]);
+    zassert_is_null(old_data, NULL);
+    phase2 = rcu_read_lock(&domain);
+    zassert_equal(phase, phase2, NULL);
+    zassert_equal(rcu_dereference(&pointer), &data[0], NULL);
+    rcu_read_unlock(&domain, phase2);
+    /* the replaced data is returned after a grace period */
+    old_data = rcu_publish(&domain, &pointer, &data[1]);
+    zassert_equal(old_data, &data[0], NULL);
+    phase2 = rcu_read_lock(&domain);
+    zassert_not_equal(phase & 1, phase2 & 1, NULL);
+    zassert_equal(rcu_dereference(&pointer), &data[1], NULL);
+    rcu_read_unlock(&domain, phase2);
+    /* withdraw the data */
+    old_data = rcu_publish(&domain, &pointer, NULL);
+    zassert_equal(old_data, &data[1], NULL);
+    zassert_is_null(rcu_dereference(&pointer), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(rcu_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        rcu_tests, ztest_unit_test(testRcuReadSection),
+        ztest_unit_test(testRcuPublish));
+
+    ztest_run_test_suite(rcu_tests);
+}
+#endif
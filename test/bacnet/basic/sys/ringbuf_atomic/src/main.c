@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @brief test lock-free ring buffer API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/ringbuf_atomic.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#define TEST_ELEMENT_SIZE 5
+#define TEST_ELEMENT_COUNT 8
+
+/**
+ * @brief Test putting and popping single elements and batches
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ringbuf_atomic_tests, testRingbufAtomicPutPop)
+#else
+static void testRingbufAtomicPutPop(void)
+#endif
+{
+    RING_BUFFER_ATOMIC ring;
+    uint32_t buffer[RINGBUF_ATOMIC_BUFFER_SIZE(
+        TEST_ELEMENT_SIZE, TEST_ELEMENT_COUNT) / sizeof(uint32_t)];
+    uint8_t data[TEST_ELEMENT_SIZE * TEST_ELEMENT_COUNT * 2];
+    uint8_t element[TEST_ELEMENT_SIZE];
+    const uint8_t *peek;
+    unsigned i, count, lap;
+    bool status;
+
+    /* not a power of two, or too small a buffer */
+    status = Ringbuf_Atomic_Initialize(
+        &ring, buffer, sizeof(buffer), TEST_ELEMENT_SIZE, 6, false);
+    zassert_false(status, NULL);
+    status = Ringbuf_Atomic_Initialize(
+        &ring, buffer, sizeof(buffer) - 1, TEST_ELEMENT_SIZE,
+        TEST_ELEMENT_COUNT, false);
+    zassert_false(status, NULL);
+    status = Ringbuf_Atomic_Initialize(
+        &ring, buffer, sizeof(buffer), TEST_ELEMENT_SIZE, TEST_ELEMENT_COUNT,
+        false);
+    zassert_true(status, NULL);
+    zassert_equal(Ringbuf_Atomic_Size(&ring), TEST_ELEMENT_COUNT, NULL);
+    zassert_true(Ringbuf_Atomic_Empty(&ring), NULL);
+    zassert_false(Ringbuf_Atomic_Pop(&ring, element), NULL);
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    /* several laps, so that the cells are reused */
+    for (lap = 0; lap < 3; lap++) {
+        for (i = 0; i < TEST_ELEMENT_COUNT; i++) {
+            status =
+                Ringbuf_Atomic_Put(&ring, &data[i * TEST_ELEMENT_SIZE]);
+            zassert_true(status, NULL);
+        }
+        zassert_true(Ringbuf_Atomic_Full(&ring), NULL);
+        zassert_false(Ringbuf_Atomic_Put(&ring, data), NULL);
+        zassert_equal(
+            Ringbuf_Atomic_Count(&ring), TEST_ELEMENT_COUNT, NULL);
+        peek = Ringbuf_Atomic_Peek(&ring);
+        zassert_not_null(peek, NULL);
+        zassert_mem_equal(peek, data, TEST_ELEMENT_SIZE, NULL);
+        for (i = 0; i < TEST_ELEMENT_COUNT; i++) {
+            status = Ringbuf_Atomic_Pop(&ring, element);
+            zassert_true(status, NULL);
+            zassert_mem_equal(
+                element, &data[i * TEST_ELEMENT_SIZE], TEST_ELEMENT_SIZE,
+                NULL);
+        }
+        zassert_true(Ringbuf_Atomic_Empty(&ring), NULL);
+    }
+    /* a batch is cut short when the ring fills */
+    zassert_true(Ringbuf_Atomic_Put(&ring, data), NULL);
+    count = Ringbuf_Atomic_Put_Batch(&ring, data, TEST_ELEMENT_COUNT * 2);
+    zassert_equal(count, TEST_ELEMENT_COUNT - 1, NULL);
+    count = Ringbuf_Atomic_Pop_Batch(&ring, NULL, 1);
+    zassert_equal(count, 1, NULL);
+    count = Ringbuf_Atomic_Pop_Batch(&ring, &data[TEST_ELEMENT_SIZE], 3);
+    zassert_equal(count, 3, NULL);
+    count = Ringbuf_Atomic_Pop_Batch(
+        &ring, &data[TEST_ELEMENT_SIZE * 4], TEST_ELEMENT_COUNT);
+    zassert_equal(count, TEST_ELEMENT_COUNT - 4, NULL);
+    zassert_true(Ringbuf_Atomic_Empty(&ring), NULL);
+    zassert_equal(Ringbuf_Atomic_Count(&ring), 0, NULL);
+}
+
+/**
+ * @brief Test elements that multiple producers fill in place
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ringbuf_atomic_tests, testRingbufAtomicDataPut)
+#else
+static void testRingbufAtomicDataPut(void)
+#endif
+{
+    RING_BUFFER_ATOMIC ring;
+    uint32_t buffer[RINGBUF_ATOMIC_BUFFER_SIZE(
+        TEST_ELEMENT_SIZE, TEST_ELEMENT_COUNT) / sizeof(uint32_t)];
+    uint8_t element[TEST_ELEMENT_SIZE];
+    uint8_t *first, *second;
+    unsigned i, lap;
+    bool status;
+
+    status = Ringbuf_Atomic_Initialize(
+        &ring, buffer, sizeof(buffer), TEST_ELEMENT_SIZE, TEST_ELEMENT_COUNT,
+        true);
+    zassert_true(status, NULL);
+    for (lap = 0; lap < 3; lap++) {
+        /* two producers reserve, and the second one finishes first */
+        first = Ringbuf_Atomic_Data_Peek(&ring);
+        second = Ringbuf_Atomic_Data_Peek(&ring);
+        zassert_not_null(first, NULL);
+        zassert_not_null(second, NULL);
+        zassert_not_equal(first, second, NULL);
+        memset(second, 2, TEST_ELEMENT_SIZE);
+        zassert_true(Ringbuf_Atomic_Data_Put(&ring, second), NULL);
+        /* the consumer waits for the first element */
+        zassert_equal(Ringbuf_Atomic_Count(&ring), 2, NULL);
+        zassert_true(Ringbuf_Atomic_Empty(&ring), NULL);
+        memset(first, 1, TEST_ELEMENT_SIZE);
+        zassert_true(Ringbuf_Atomic_Data_Put(&ring, first), NULL);
+        zassert_true(Ringbuf_Atomic_Pop(&ring, element), NULL);
+        zassert_equal(element[0], 1, NULL);
+        zassert_true(Ringbuf_Atomic_Pop(&ring, element), NULL);
+        zassert_equal(element[TEST_ELEMENT_SIZE - 1], 2, NULL);
+        zassert_true(Ringbuf_Atomic_Empty(&ring), NULL);
+        /* fill the rest of the lap */
+        for (i = 2; i < TEST_ELEMENT_COUNT; i++) {
+            zassert_true(Ringbuf_Atomic_Put(&ring, element), NULL);
+        }
+        zassert_equal(
+            Ringbuf_Atomic_Pop_Batch(&ring, NULL, TEST_ELEMENT_COUNT),
+            TEST_ELEMENT_COUNT - 2, NULL);
+    }
+    /* full, and pointers that are not elements */
+    for (i = 0; i < TEST_ELEMENT_COUNT; i++) {
+        first = Ringbuf_Atomic_Data_Peek(&ring);
+        zassert_not_null(first, NULL);
+        zassert_true(Ringbuf_Atomic_Data_Put(&ring, first), NULL);
+    }
+    zassert_is_null(Ringbuf_Atomic_Data_Peek(&ring), NULL);
+    zassert_false(Ringbuf_Atomic_Data_Put(&ring, first + 1), NULL);
+    zassert_false(Ringbuf_Atomic_Data_Put(&ring, NULL), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(ringbuf_atomic_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        ringbuf_atomic_tests, ztest_unit_test(testRingbufAtomicPutPop),
+        ztest_unit_test(testRingbufAtomicDataPut));
+
+    ztest_run_test_suite(ringbuf_atomic_tests);
+}
+#endif
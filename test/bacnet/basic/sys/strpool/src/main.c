@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief test interned string list pool API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/basic/sys/strpool.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static const char *Test_State_Text = "Off\0"
+                                     "Low\0"
+                                     "High\0";
+
+/**
+ * @brief Test interning, sharing and releasing
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(strpool_tests, testStrpoolIntern)
+#else
+static void testStrpoolIntern(void)
+#endif
+{
+    char list[32] = { 0 };
+    const char *pooled_a, *pooled_b, *pooled_c;
+
+    zassert_equal(strpool_list_size(Test_State_Text), 14, NULL);
+    zassert_equal(strpool_list_size(""), 1, NULL);
+    zassert_equal(strpool_list_size(NULL), 0, NULL);
+    zassert_equal(strpool_count(), 0, NULL);
+    pooled_a = strpool_list_intern(Test_State_Text);
+    zassert_not_null(pooled_a, NULL);
+    zassert_not_equal(pooled_a, Test_State_Text, NULL);
+    zassert_mem_equal(pooled_a, Test_State_Text, 14, NULL);
+    /* an equal list built at run time shares the pooled copy */
+    memcpy(list, Test_State_Text, 14);
+    pooled_b = strpool_list_intern(list);
+    zassert_equal(pooled_a, pooled_b, NULL);
+    zassert_equal(strpool_refcount(pooled_a), 2, NULL);
+    zassert_equal(strpool_count(), 1, NULL);
+    zassert_true(strpool_contains(pooled_a), NULL);
+    zassert_false(strpool_contains(list), NULL);
+    zassert_equal(strpool_refcount(list), 0, NULL);
+    /* a single string is a list of one element */
+    pooled_c = strpool_intern("Off");
+    zassert_not_null(pooled_c, NULL);
+    zassert_not_equal(pooled_a, pooled_c, NULL);
+    zassert_equal(strcmp(pooled_c, "Off"), 0, NULL);
+    zassert_equal(strpool_list_intern("Off\0"), pooled_c, NULL);
+    zassert_equal(strpool_refcount(pooled_c), 2, NULL);
+    zassert_equal(strpool_count(), 2, NULL);
+    zassert_equal(strpool_intern(""), strpool_list_intern(""), NULL);
+    zassert_equal(strpool_count(), 3, NULL);
+    /* freed with the last user */
+    strpool_release(pooled_b);
+    zassert_equal(strpool_refcount(pooled_a), 1, NULL);
+    strpool_release(pooled_a);
+    zassert_equal(strpool_count(), 2, NULL);
+    strpool_release(pooled_c);
+    strpool_release(pooled_c);
+    zassert_equal(strpool_count(), 1, NULL);
+    /* releasing a pointer that is not pooled is ignored */
+    strpool_release(list);
+    strpool_release(NULL);
+    zassert_equal(strpool_count(), 1, NULL);
+    strpool_cleanup();
+    zassert_equal(strpool_count(), 0, NULL);
+}
+
+/**
+ * @brief Test the pre-encoded form of a pooled list
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(strpool_tests, testStrpoolEncoded)
+#else
+static void testStrpoolEncoded(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_CHARACTER_STRING char_string = { 0 };
+    const uint8_t *encoded;
+    const char *pooled;
+    const char *name;
+    size_t encoded_len = 0;
+    int apdu_len = 0, len;
+
+    encoded = strpool_list_encoded(Test_State_Text, &encoded_len);
+    zassert_is_null(encoded, NULL);
+    pooled = strpool_list_intern(Test_State_Text);
+    encoded = strpool_list_encoded(pooled, &encoded_len);
+    zassert_not_null(encoded, NULL);
+    name = Test_State_Text;
+    while (*name) {
+        characterstring_init_ansi(&char_string, name);
+        len = encode_application_character_string(
+            &apdu[apdu_len], &char_string);
+        zassert_true(len > 0, NULL);
+        apdu_len += len;
+        name += strlen(name) + 1;
+    }
+    zassert_equal(encoded_len, apdu_len, NULL);
+    zassert_mem_equal(encoded, apdu, apdu_len, NULL);
+    /* built once, then reused */
+    zassert_equal(strpool_list_encoded(pooled, NULL), encoded, NULL);
+    zassert_is_null(strpool_list_encoded(strpool_list_intern(""), NULL), NULL);
+    strpool_cleanup();
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(strpool_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        strpool_tests, ztest_unit_test(testStrpoolIntern),
+        ztest_unit_test(testStrpoolEncoded));
+
+    ztest_run_test_suite(strpool_tests);
+}
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief test hierarchical timer wheel API
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/timer_wheel.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Advance the wheel one tick at a time until a timer expires
+ * @param wheel - timer wheel
+ * @param limit - largest number of ticks to advance
+ * @return number of ticks advanced, or limit+1 if nothing expired
+ */
+static uint32_t advance_until_expired(struct timer_wheel *wheel, uint32_t limit)
+{
+    uint32_t ticks = 0;
+
+    while (ticks <= limit) {
+        ticks++;
+        timer_wheel_advance(wheel, 1);
+        if (timer_wheel_next(wheel) == 0) {
+            break;
+        }
+    }
+
+    return ticks;
+}
+
+/**
+ * @brief Test timers that expire from each level of the wheel
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelExpire)
+#else
+static void testTimerWheelExpire(void)
+#endif
+{
+    static struct timer_wheel wheel;
+    struct timer_wheel_node node;
+    const uint32_t test_ticks[] = { 1, 5, 63, 64, 65, 100, 4095, 4096, 4097,
+                                    70000 };
+    unsigned i;
+
+    timer_wheel_init(&wheel);
+    timer_wheel_node_init(&node);
+    zassert_false(timer_wheel_pending(&node), NULL);
+    zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+    zassert_equal(timer_wheel_next(&wheel), UINT32_MAX, NULL);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    for (i = 0; i < sizeof(test_ticks) / sizeof(test_ticks[0]); i++) {
+        /* start from a tick that is not on a level boundary */
+        timer_wheel_advance(&wheel, 7);
+        timer_wheel_add(&wheel, &node, test_ticks[i]);
+        zassert_true(timer_wheel_pending(&node), NULL);
+        zassert_equal(timer_wheel_count(&wheel), 1, NULL);
+        zassert_equal(timer_wheel_next(&wheel), test_ticks[i], NULL);
+        zassert_equal(
+            advance_until_expired(&wheel, test_ticks[i]), test_ticks[i], NULL);
+        zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+        zassert_equal(timer_wheel_expired(&wheel), &node, NULL);
+        zassert_false(timer_wheel_pending(&node), NULL);
+        zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    }
+}
+
+/**
+ * @brief Test restarting, removing, and expiring timers at once
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelRemove)
+#else
+static void testTimerWheelRemove(void)
+#endif
+{
+    static struct timer_wheel wheel;
+    struct timer_wheel_node node[3];
+    unsigned i;
+
+    timer_wheel_init(&wheel);
+    for (i = 0; i < 3; i++) {
+        timer_wheel_node_init(&node[i]);
+    }
+    timer_wheel_add(&wheel, &node[0], 10);
+    timer_wheel_add(&wheel, &node[1], 200);
+    timer_wheel_add(&wheel, &node[2], 5000);
+    zassert_equal(timer_wheel_count(&wheel), 3, NULL);
+    zassert_equal(timer_wheel_next(&wheel), 10, NULL);
+    /* restart moves the timer */
+    timer_wheel_add(&wheel, &node[0], 300);
+    zassert_equal(timer_wheel_count(&wheel), 3, NULL);
+    zassert_equal(timer_wheel_next(&wheel), 200, NULL);
+    timer_wheel_remove(&wheel, &node[1]);
+    zassert_false(timer_wheel_pending(&node[1]), NULL);
+    zassert_equal(timer_wheel_count(&wheel), 2, NULL);
+    zassert_equal(timer_wheel_next(&wheel), 300, NULL);
+    /* removing a timer that is not pending does nothing */
+    timer_wheel_remove(&wheel, &node[1]);
+    zassert_equal(timer_wheel_count(&wheel), 2, NULL);
+    timer_wheel_advance(&wheel, 299);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    timer_wheel_advance(&wheel, 1);
+    zassert_equal(timer_wheel_expired(&wheel), &node[0], NULL);
+    zassert_equal(timer_wheel_count(&wheel), 1, NULL);
+    timer_wheel_remove(&wheel, &node[2]);
+    zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+    /* zero ticks is expired at once */
+    timer_wheel_add(&wheel, &node[1], 0);
+    zassert_true(timer_wheel_pending(&node[1]), NULL);
+    zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+    zassert_equal(timer_wheel_next(&wheel), 0, NULL);
+    timer_wheel_remove(&wheel, &node[1]);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    /* an expired timer that is removed is not counted twice */
+    timer_wheel_add(&wheel, &node[2], 1);
+    timer_wheel_advance(&wheel, 1);
+    zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+    timer_wheel_remove(&wheel, &node[2]);
+    zassert_equal(timer_wheel_count(&wheel), 0, NULL);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+}
+
+/**
+ * @brief Test timers beyond the span of the wheel, and the tick wrap
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelSpan)
+#else
+static void testTimerWheelSpan(void)
+#endif
+{
+    static struct timer_wheel wheel;
+    struct timer_wheel_node node;
+    const uint32_t span = 1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+    uint32_t ticks = span + 1000;
+
+    timer_wheel_init(&wheel);
+    timer_wheel_node_init(&node);
+    timer_wheel_add(&wheel, &node, ticks);
+    zassert_equal(timer_wheel_next(&wheel), ticks, NULL);
+    timer_wheel_advance(&wheel, span);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    zassert_equal(timer_wheel_count(&wheel), 1, NULL);
+    zassert_equal(timer_wheel_next(&wheel), 1000, NULL);
+    timer_wheel_advance(&wheel, 999);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    timer_wheel_advance(&wheel, 1);
+    zassert_equal(timer_wheel_expired(&wheel), &node, NULL);
+    /* the tick counter wraps */
+    timer_wheel_advance(&wheel, UINT32_MAX - timer_wheel_now(&wheel) - 10);
+    timer_wheel_add(&wheel, &node, 100);
+    timer_wheel_advance(&wheel, 99);
+    zassert_is_null(timer_wheel_expired(&wheel), NULL);
+    timer_wheel_advance(&wheel, 1);
+    zassert_equal(timer_wheel_expired(&wheel), &node, NULL);
+    zassert_equal(timer_wheel_now(&wheel), 89, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(timer_wheel_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        timer_wheel_tests, ztest_unit_test(testTimerWheelExpire),
+        ztest_unit_test(testTimerWheelRemove),
+        ztest_unit_test(testTimerWheelSpan));
+
+    ztest_run_test_suite(timer_wheel_tests);
+}
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Unit test for the reference counted value buffers
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/basic/sys/valbuf.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test the shares of a value buffer
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(valbuf_tests, testValueBufferShare)
+#else
+static void testValueBufferShare(void)
+#endif
+{
+    uint8_t apdu[16] = { 0 };
+    BACNET_VALBUF *buffer, *other = NULL, *moved = NULL;
+    int apdu_len;
+
+    apdu_len = encode_application_unsigned(apdu, 1234);
+    buffer = valbuf_create(apdu, apdu_len);
+    zassert_not_null(buffer, NULL);
+    zassert_equal(valbuf_refcount(buffer), 1, NULL);
+    zassert_equal(valbuf_length(buffer), apdu_len, NULL);
+    zassert_equal(memcmp(valbuf_data(buffer), apdu, apdu_len), 0, NULL);
+    /* the bytes are copied once */
+    apdu[1] = 0;
+    zassert_not_equal(valbuf_data(buffer)[1], 0, NULL);
+    other = valbuf_share(buffer);
+    zassert_equal(other, buffer, NULL);
+    zassert_equal(valbuf_refcount(buffer), 2, NULL);
+    /* a move keeps the count */
+    valbuf_move(&moved, &other);
+    zassert_is_null(other, NULL);
+    zassert_equal(moved, buffer, NULL);
+    zassert_equal(valbuf_refcount(buffer), 2, NULL);
+    valbuf_release(moved);
+    zassert_equal(valbuf_refcount(buffer), 1, NULL);
+    valbuf_release(buffer);
+    /* NULL is accepted */
+    zassert_is_null(valbuf_share(NULL), NULL);
+    valbuf_release(NULL);
+    zassert_equal(valbuf_refcount(NULL), 0, NULL);
+    zassert_equal(valbuf_length(NULL), 0, NULL);
+    zassert_is_null(valbuf_data(NULL), NULL);
+    zassert_is_null(valbuf_create(NULL, 1), NULL);
+}
+
+/**
+ * @brief Test the encode, the compare, and the decode of a list of values
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(valbuf_tests, testValueBufferList)
+#else
+static void testValueBufferList(void)
+#endif
+{
+    BACNET_APPLICATION_DATA_VALUE value[3] = { 0 };
+    const BACNET_APPLICATION_DATA_VALUE *decoded;
+    BACNET_VALBUF *buffer, *other;
+    uint8_t apdu[64] = { 0 };
+    int apdu_len = 0;
+
+    value[0].tag = BACNET_APPLICATION_TAG_REAL;
+    value[0].type.Real = 3.5f;
+    value[0].next = &value[1];
+    value[1].tag = BACNET_APPLICATION_TAG_CHARACTER_STRING;
+    characterstring_init_ansi(&value[1].type.Character_String, "zone");
+    value[1].next = &value[2];
+    value[2].tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    value[2].type.Boolean = true;
+    buffer = valbuf_encode(&value[0]);
+    zassert_not_null(buffer, NULL);
+    apdu_len += bacapp_encode_application_data(&apdu[apdu_len], &value[0]);
+    apdu_len += bacapp_encode_application_data(&apdu[apdu_len], &value[1]);
+    apdu_len += bacapp_encode_application_data(&apdu[apdu_len], &value[2]);
+    zassert_equal(valbuf_length(buffer), apdu_len, NULL);
+    other = valbuf_create(apdu, apdu_len);
+    zassert_true(valbuf_same(buffer, other), NULL);
+    zassert_false(valbuf_same(buffer, NULL), NULL);
+    valbuf_release(other);
+    /* the list without its boolean, and a part of its string */
+    other = valbuf_create(apdu, apdu_len - 2);
+    zassert_false(valbuf_same(buffer, other), NULL);
+    /* the truncated list does not decode */
+    zassert_is_null(valbuf_value(other), NULL);
+    valbuf_release(other);
+    /* the decoded values are built once */
+    decoded = valbuf_value(buffer);
+    zassert_not_null(decoded, NULL);
+    zassert_equal(valbuf_value(buffer), decoded, NULL);
+    zassert_true(bacapp_same_value(decoded, &value[0]), NULL);
+    zassert_not_null(decoded->next, NULL);
+    zassert_true(bacapp_same_value(decoded->next, &value[1]), NULL);
+    zassert_not_null(decoded->next->next, NULL);
+    zassert_true(bacapp_same_value(decoded->next->next, &value[2]), NULL);
+    zassert_is_null(decoded->next->next->next, NULL);
+    valbuf_release(buffer);
+    zassert_is_null(valbuf_encode(NULL), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(valbuf_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        valbuf_tests, ztest_unit_test(testValueBufferShare),
+        ztest_unit_test(testValueBufferList));
+
+    ztest_run_test_suite(valbuf_tests);
+}
+#endif
@@ -0,0 +1,781 @@
+/**
+ * @file
+ * @brief Unit test for the transaction state machine: the invoke ID map,
+ *  the free list of table spots, the heap of request timeouts, and the
+ *  segmented ComplexACKs
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/npdu.h>
+#include <bacnet/segmentack.h>
+#include <bacnet/basic/service/h_apdu.h>
+#include <bacnet/basic/tsm/tsm.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static uint16_t Test_Timeout = 1000;
+static uint8_t Test_Retries = 0;
+static uint16_t Test_Segment_Timeout = 100;
+static uint16_t Test_Max_APDU = MAX_APDU;
+static unsigned Test_Send_Count;
+/* the leading octets of the APDU of each PDU sent */
+#define TEST_SEND_MAX 32
+#define TEST_SEND_APDU_SIZE 8
+static uint8_t Test_Send_APDU[TEST_SEND_MAX][TEST_SEND_APDU_SIZE];
+/* invoke IDs in the order that their requests timed out */
+static uint8_t Test_Timeout_IDs[MAX_TSM_TRANSACTIONS];
+static unsigned Test_Timeout_Count;
+/* invoke ID and status of the last completion */
+static uint8_t Test_Completion_ID;
+static BACNET_TSM_COMPLETION Test_Completion_Status;
+static unsigned Test_Completion_Count;
+
+uint16_t apdu_timeout(void)
+{
+    return Test_Timeout;
+}
+
+uint8_t apdu_retries(void)
+{
+    return Test_Retries;
+}
+
+uint16_t apdu_segment_timeout(void)
+{
+    return Test_Segment_Timeout;
+}
+
+uint16_t apdu_max_length_accepted(void)
+{
+    return Test_Max_APDU;
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    int offset;
+    unsigned len;
+
+    (void)dest;
+    (void)npdu_data;
+    if (Test_Send_Count < TEST_SEND_MAX) {
+        memset(Test_Send_APDU[Test_Send_Count], 0, TEST_SEND_APDU_SIZE);
+        offset = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, NULL);
+        if ((offset > 0) && ((unsigned)offset < pdu_len)) {
+            len = pdu_len - (unsigned)offset;
+            if (len > TEST_SEND_APDU_SIZE) {
+                len = TEST_SEND_APDU_SIZE;
+            }
+            memcpy(Test_Send_APDU[Test_Send_Count], &pdu[offset], len);
+        }
+    }
+    Test_Send_Count++;
+
+    return (int)pdu_len;
+}
+
+static void test_timeout_handler(uint8_t invoke_id)
+{
+    if (Test_Timeout_Count < MAX_TSM_TRANSACTIONS) {
+        Test_Timeout_IDs[Test_Timeout_Count] = invoke_id;
+    }
+    Test_Timeout_Count++;
+}
+
+static void test_completion_handler(
+    const BACNET_ADDRESS *src,
+    const BACNET_TSM_COMPLETION_DATA *data,
+    void *context)
+{
+    (void)src;
+    (void)context;
+    Test_Completion_ID = data->invoke_id;
+    Test_Completion_Status = data->status;
+    Test_Completion_Count++;
+}
+
+/**
+ * @brief Select a new transaction state machine, with the test handlers
+ * @return the context selected before
+ */
+static TSM_CONTEXT *test_tsm_setup(void)
+{
+    TSM_CONTEXT *context;
+
+    Test_Timeout = 1000;
+    Test_Retries = 0;
+    Test_Segment_Timeout = 100;
+    Test_Max_APDU = MAX_APDU;
+    Test_Send_Count = 0;
+    Test_Timeout_Count = 0;
+    Test_Completion_Count = 0;
+    tsm_set_timeout_handler(test_timeout_handler);
+    context = tsm_context_create();
+    zassert_not_null(context, NULL);
+
+    return tsm_context_select(context);
+}
+
+/**
+ * @brief Restore the context selected before the test, and free the
+ *  test context
+ * @param previous - the context selected before
+ */
+static void test_tsm_teardown(TSM_CONTEXT *previous)
+{
+    tsm_context_delete(tsm_context_select(previous));
+    tsm_set_timeout_handler(NULL);
+}
+
+/**
+ * @brief Send a confirmed request with the given timeout
+ * @param timeout - request timeout in milliseconds
+ * @return the invoke ID of the request
+ */
+static uint8_t test_tsm_request(uint16_t timeout)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[4] = { 0x00, 0x05, 0x00, 0x0C };
+    uint8_t invoke_id;
+
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    apdu[2] = invoke_id;
+    dest.mac_len = 1;
+    dest.mac[0] = invoke_id;
+    Test_Timeout = timeout;
+    tsm_set_confirmed_unsegmented_transaction(
+        invoke_id, &dest, &npdu_data, apdu, sizeof(apdu));
+
+    return invoke_id;
+}
+
+/**
+ * @brief Test the allocation, reuse, and wraparound of the invoke IDs
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testInvokeIDs)
+#else
+static void testInvokeIDs(void)
+#endif
+{
+    TSM_CONTEXT *previous;
+    uint8_t invoke_id;
+    unsigned i;
+
+    previous = test_tsm_setup();
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+    /* invoke IDs start at one, and count up */
+    for (i = 1; i <= MAX_TSM_TRANSACTIONS; i++) {
+        zassert_true(tsm_transaction_available(), NULL);
+        invoke_id = tsm_next_free_invokeID();
+        zassert_equal(invoke_id, i, NULL);
+        zassert_false(tsm_invoke_id_free(invoke_id), NULL);
+    }
+    zassert_equal(tsm_transaction_idle_count(), 0, NULL);
+    zassert_false(tsm_transaction_available(), NULL);
+    zassert_equal(tsm_next_free_invokeID(), 0, NULL);
+    /* a freed spot takes the next invoke ID, not the freed one */
+    tsm_free_invoke_id(3);
+    zassert_true(tsm_invoke_id_free(3), NULL);
+    zassert_equal(tsm_transaction_idle_count(), 1, NULL);
+    invoke_id = tsm_next_free_invokeID();
+    zassert_equal(invoke_id, MAX_TSM_TRANSACTIONS + 1, NULL);
+    zassert_equal(tsm_next_free_invokeID(), 0, NULL);
+    /* freeing an unused invoke ID changes nothing */
+    tsm_free_invoke_id(3);
+    tsm_free_invoke_id(0);
+    zassert_equal(tsm_transaction_idle_count(), 0, NULL);
+    /* a freed invoke ID is reused, and the used ones are skipped */
+    tsm_free_invoke_id(2);
+    tsm_free_invoke_id(5);
+    tsm_invokeID_set(4);
+    zassert_equal(tsm_next_free_invokeID(), 5, NULL);
+    tsm_invokeID_set(1);
+    zassert_equal(tsm_next_free_invokeID(), 2, NULL);
+    zassert_equal(tsm_transaction_idle_count(), 0, NULL);
+    for (i = 1; i <= 255; i++) {
+        tsm_free_invoke_id((uint8_t)i);
+    }
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+    /* the invoke ID wraps past 255 to 1, skipping zero */
+    tsm_invokeID_set(254);
+    zassert_equal(tsm_next_free_invokeID(), 254, NULL);
+    zassert_equal(tsm_next_free_invokeID(), 255, NULL);
+    zassert_equal(tsm_next_free_invokeID(), 1, NULL);
+    /* wrapping onto used invoke IDs skips them */
+    tsm_invokeID_set(254);
+    zassert_equal(tsm_next_free_invokeID(), 2, NULL);
+    tsm_invokeID_set(0);
+    zassert_equal(tsm_next_free_invokeID(), 3, NULL);
+    /* every freed spot is used again */
+    for (i = 1; i <= 255; i++) {
+        tsm_free_invoke_id((uint8_t)i);
+    }
+    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++) {
+        zassert_not_equal(tsm_next_free_invokeID(), 0, NULL);
+    }
+    zassert_equal(tsm_next_free_invokeID(), 0, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test that the requests time out in the order of their deadlines,
+ *  and that a freed request is removed from the timeouts
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testTimeoutOrder)
+#else
+static void testTimeoutOrder(void)
+#endif
+{
+    static const uint16_t timeouts[] = { 500, 100, 300, 400, 200, 600, 700 };
+    uint8_t invoke_id[ARRAY_SIZE(timeouts)];
+    TSM_CONTEXT *previous;
+    unsigned i;
+
+    previous = test_tsm_setup();
+    for (i = 0; i < ARRAY_SIZE(timeouts); i++) {
+        invoke_id[i] = test_tsm_request(timeouts[i]);
+    }
+    /* remove one from the middle of the heap, and one from the top */
+    tsm_free_invoke_id(invoke_id[2]);
+    tsm_free_invoke_id(invoke_id[1]);
+    /* a completion takes the timeout instead of the timeout handler */
+    zassert_true(
+        tsm_completion_set(invoke_id[5], test_completion_handler, NULL),
+        NULL);
+    tsm_timer_milliseconds(199);
+    zassert_equal(Test_Timeout_Count, 0, NULL);
+    /* a request times out when its deadline is reached */
+    tsm_timer_milliseconds(1);
+    zassert_equal(Test_Timeout_Count, 1, NULL);
+    zassert_equal(Test_Timeout_IDs[0], invoke_id[4], NULL);
+    zassert_true(tsm_invoke_id_failed(invoke_id[4]), NULL);
+    zassert_false(tsm_invoke_id_failed(invoke_id[3]), NULL);
+    /* a late tick expires all of the passed deadlines, in order */
+    tsm_timer_milliseconds(350);
+    zassert_equal(Test_Timeout_Count, 3, NULL);
+    zassert_equal(Test_Timeout_IDs[1], invoke_id[3], NULL);
+    zassert_equal(Test_Timeout_IDs[2], invoke_id[0], NULL);
+    zassert_equal(Test_Completion_Count, 0, NULL);
+    tsm_timer_milliseconds(100);
+    zassert_equal(Test_Completion_Count, 1, NULL);
+    zassert_equal(Test_Completion_ID, invoke_id[5], NULL);
+    zassert_equal(Test_Completion_Status, TSM_COMPLETION_TIMEOUT, NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id[5]), NULL);
+    tsm_timer_milliseconds(100);
+    zassert_equal(Test_Timeout_Count, 4, NULL);
+    zassert_equal(Test_Timeout_IDs[3], invoke_id[6], NULL);
+    /* the freed requests never time out */
+    tsm_timer_milliseconds(1000);
+    zassert_equal(Test_Timeout_Count, 4, NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id[1]), NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id[2]), NULL);
+    /* the failed requests hold their invoke IDs until freed */
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS - 4, NULL);
+    zassert_equal(Test_Send_Count, 0, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test the retries of a request, which restart its timeout
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testTimeoutRetries)
+#else
+static void testTimeoutRetries(void)
+#endif
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[MAX_PDU] = { 0 };
+    uint16_t apdu_len = 0;
+    TSM_CONTEXT *previous;
+    uint8_t first, second;
+
+    previous = test_tsm_setup();
+    Test_Retries = 2;
+    first = test_tsm_request(100);
+    tsm_timer_milliseconds(50);
+    second = test_tsm_request(100);
+    zassert_true(
+        tsm_get_transaction_pdu(first, &dest, &npdu_data, apdu, &apdu_len),
+        NULL);
+    zassert_equal(apdu_len, 4, NULL);
+    zassert_equal(apdu[2], first, NULL);
+    zassert_equal(dest.mac[0], first, NULL);
+    /* the retries of the two requests take turns */
+    tsm_timer_milliseconds(50);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    tsm_timer_milliseconds(50);
+    zassert_equal(Test_Send_Count, 2, NULL);
+    tsm_timer_milliseconds(50);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    zassert_false(tsm_invoke_id_failed(first), NULL);
+    tsm_timer_milliseconds(50);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Timeout_Count, 0, NULL);
+    /* the first request fails after its last retry */
+    tsm_timer_milliseconds(50);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Timeout_Count, 1, NULL);
+    zassert_equal(Test_Timeout_IDs[0], first, NULL);
+    zassert_true(tsm_invoke_id_failed(first), NULL);
+    zassert_false(tsm_invoke_id_failed(second), NULL);
+    tsm_free_invoke_id(second);
+    tsm_timer_milliseconds(1000);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Timeout_Count, 1, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test the deadlines that wrap around the millisecond clock
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testTimeoutClockWrap)
+#else
+static void testTimeoutClockWrap(void)
+#endif
+{
+    TSM_CONTEXT *previous;
+    uint8_t early, late;
+    unsigned i;
+
+    previous = test_tsm_setup();
+    /* run the clock to 536 milliseconds before it wraps */
+    for (i = 0; i < 65536; i++) {
+        tsm_timer_milliseconds(UINT16_MAX);
+    }
+    tsm_timer_milliseconds(65000);
+    /* the late deadline wraps to a small number */
+    late = test_tsm_request(1000);
+    early = test_tsm_request(300);
+    tsm_timer_milliseconds(299);
+    zassert_equal(Test_Timeout_Count, 0, NULL);
+    tsm_timer_milliseconds(1);
+    zassert_equal(Test_Timeout_Count, 1, NULL);
+    zassert_equal(Test_Timeout_IDs[0], early, NULL);
+    tsm_timer_milliseconds(699);
+    zassert_equal(Test_Timeout_Count, 1, NULL);
+    tsm_timer_milliseconds(1);
+    zassert_equal(Test_Timeout_Count, 2, NULL);
+    zassert_equal(Test_Timeout_IDs[1], late, NULL);
+    test_tsm_teardown(previous);
+}
+
+/* service data octets of the test ComplexACK: 5 segments when the client
+   accepts 50 octet APDUs, of which 5 are the segment header */
+#define TEST_SEGMENT_MAX_RESP 50
+#define TEST_SEGMENT_SIZE (TEST_SEGMENT_MAX_RESP - 5)
+#define TEST_SEGMENT_DATA_LEN 200
+
+/**
+ * @brief Start sending a segmented ComplexACK to the test client
+ * @param invoke_id - invoke ID of the confirmed request
+ * @param dest - address of the client
+ */
+static void test_segment_reply(uint8_t invoke_id, BACNET_ADDRESS *dest)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    uint8_t apdu[3 + TEST_SEGMENT_DATA_LEN];
+    unsigned i;
+
+    memset(dest, 0, sizeof(*dest));
+    dest->mac_len = 1;
+    dest->mac[0] = 0x42;
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    service_data.invoke_id = invoke_id;
+    service_data.segmented_response_accepted = true;
+    service_data.max_resp = TEST_SEGMENT_MAX_RESP;
+    apdu[0] = PDU_TYPE_COMPLEX_ACK;
+    apdu[1] = invoke_id;
+    apdu[2] = SERVICE_CONFIRMED_READ_PROPERTY;
+    for (i = 0; i < TEST_SEGMENT_DATA_LEN; i++) {
+        apdu[3 + i] = (uint8_t)i;
+    }
+    zassert_true(
+        tsm_set_segmented_complex_ack(
+            dest, &npdu_data, &service_data, apdu, sizeof(apdu)),
+        NULL);
+}
+
+/**
+ * @brief Receive a SegmentACK from the test client
+ */
+static void test_segment_ack(
+    BACNET_ADDRESS *src,
+    bool negative_ack,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t window_size)
+{
+    uint8_t apdu[4];
+    int len;
+
+    len = segmentack_encode_apdu(
+        apdu, negative_ack, false, invoke_id, sequence_number, window_size);
+    tsm_segment_ack_received(src, apdu, (uint16_t)len);
+}
+
+/**
+ * @brief Check a segment of the test ComplexACK that was sent
+ * @param index - index of the PDU sent
+ * @param sequence_number - expected sequence number of the segment
+ */
+static void test_segment_check(unsigned index, uint8_t sequence_number)
+{
+    const uint8_t *apdu = Test_Send_APDU[index];
+    uint8_t header = PDU_TYPE_COMPLEX_ACK | BIT(3);
+
+    zassert_true(index < Test_Send_Count, NULL);
+    if ((unsigned)(sequence_number + 1) * TEST_SEGMENT_SIZE <
+        TEST_SEGMENT_DATA_LEN) {
+        /* more follows */
+        header |= BIT(2);
+    }
+    zassert_equal(apdu[0], header, NULL);
+    zassert_equal(apdu[2], sequence_number, NULL);
+    zassert_equal(apdu[3], BACNET_SEGMENTATION_WINDOW_SIZE, NULL);
+    zassert_equal(apdu[4], SERVICE_CONFIRMED_READ_PROPERTY, NULL);
+    zassert_equal(
+        apdu[5], (uint8_t)(sequence_number * TEST_SEGMENT_SIZE), NULL);
+}
+
+/**
+ * @brief Test the windows of segments sent for each SegmentACK, and the
+ *  SegmentACK of the final segment that ends the transfer
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentWindows)
+#else
+static void testSegmentWindows(void)
+#endif
+{
+    BACNET_ADDRESS client = { 0 };
+    BACNET_ADDRESS other = { 0 };
+    TSM_CONTEXT *previous;
+
+    previous = test_tsm_setup();
+    /* the first segment is sent alone */
+    test_segment_reply(7, &client);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    test_segment_check(0, 0);
+    /* a SegmentACK from another client, or for another invoke ID,
+       is ignored */
+    other.mac_len = 1;
+    other.mac[0] = 0x43;
+    test_segment_ack(&other, false, 7, 0, 2);
+    test_segment_ack(&client, false, 8, 0, 2);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    /* the SegmentACK sets the window size of the following windows */
+    test_segment_ack(&client, false, 7, 0, 2);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    test_segment_check(1, 1);
+    test_segment_check(2, 2);
+    /* a SegmentACK within the window moves the window */
+    test_segment_ack(&client, false, 7, 1, 2);
+    zassert_equal(Test_Send_Count, 5, NULL);
+    test_segment_check(3, 2);
+    test_segment_check(4, 3);
+    /* a duplicate SegmentACK only restarts the segment timer */
+    test_segment_ack(&client, false, 7, 1, 2);
+    zassert_equal(Test_Send_Count, 5, NULL);
+    test_segment_ack(&client, false, 7, 3, 2);
+    zassert_equal(Test_Send_Count, 6, NULL);
+    test_segment_check(5, 4);
+    /* the SegmentACK of the final segment ends the transfer */
+    test_segment_ack(&client, false, 7, 4, 2);
+    zassert_equal(Test_Send_Count, 6, NULL);
+    tsm_timer_milliseconds(1000);
+    test_segment_ack(&client, false, 7, 3, 2);
+    zassert_equal(Test_Send_Count, 6, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test the resend of the segments that follow the sequence number
+ *  of a negative SegmentACK
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentNegativeAck)
+#else
+static void testSegmentNegativeAck(void)
+#endif
+{
+    BACNET_ADDRESS client = { 0 };
+    TSM_CONTEXT *previous;
+
+    previous = test_tsm_setup();
+    test_segment_reply(9, &client);
+    test_segment_ack(&client, false, 9, 0, 2);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    /* none of the window was received: the whole window is sent again */
+    test_segment_ack(&client, true, 9, 0, 2);
+    zassert_equal(Test_Send_Count, 5, NULL);
+    test_segment_check(3, 1);
+    test_segment_check(4, 2);
+    /* the first segment of the window was received */
+    test_segment_ack(&client, true, 9, 1, 3);
+    zassert_equal(Test_Send_Count, 8, NULL);
+    test_segment_check(5, 2);
+    test_segment_check(6, 3);
+    test_segment_check(7, 4);
+    test_segment_ack(&client, false, 9, 4, 3);
+    tsm_timer_milliseconds(1000);
+    zassert_equal(Test_Send_Count, 8, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test the resend of a window when the segment timer expires, and
+ *  the end of the transfer when the retries are used up
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentRetries)
+#else
+static void testSegmentRetries(void)
+#endif
+{
+    BACNET_ADDRESS client = { 0 };
+    TSM_CONTEXT *previous;
+
+    previous = test_tsm_setup();
+    Test_Retries = 2;
+    test_segment_reply(11, &client);
+    test_segment_ack(&client, false, 11, 0, 2);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    tsm_timer_milliseconds(Test_Segment_Timeout - 1);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    tsm_timer_milliseconds(1);
+    zassert_equal(Test_Send_Count, 5, NULL);
+    test_segment_check(3, 1);
+    test_segment_check(4, 2);
+    /* a SegmentACK restarts the count of retries */
+    test_segment_ack(&client, false, 11, 2, 2);
+    zassert_equal(Test_Send_Count, 7, NULL);
+    tsm_timer_milliseconds(Test_Segment_Timeout);
+    tsm_timer_milliseconds(Test_Segment_Timeout);
+    zassert_equal(Test_Send_Count, 11, NULL);
+    test_segment_check(9, 3);
+    test_segment_check(10, 4);
+    /* the client has gone away */
+    tsm_timer_milliseconds(Test_Segment_Timeout);
+    zassert_equal(Test_Send_Count, 11, NULL);
+    test_segment_ack(&client, false, 11, 2, 2);
+    tsm_timer_milliseconds(1000);
+    zassert_equal(Test_Send_Count, 11, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Receive a segment of a segmented ComplexACK from the test server
+ * @return true if the reply is complete
+ */
+static bool test_segment_receive(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    bool more_follows,
+    uint8_t **apdu,
+    uint16_t *apdu_len)
+{
+    BACNET_CONFIRMED_SERVICE_ACK_DATA ack_data = { 0 };
+    uint8_t data[TEST_SEGMENT_SIZE];
+
+    ack_data.segmented_message = true;
+    ack_data.more_follows = more_follows;
+    ack_data.invoke_id = invoke_id;
+    ack_data.sequence_number = sequence_number;
+    ack_data.proposed_window_number = 2;
+    memset(data, sequence_number, sizeof(data));
+
+    return tsm_segmented_complex_ack_received(
+        src, &ack_data, SERVICE_CONFIRMED_READ_PROPERTY, data, sizeof(data),
+        apdu, apdu_len);
+}
+
+/**
+ * @brief Check a SegmentACK that was sent
+ * @param index - index of the PDU sent
+ */
+static void test_segment_ack_check(
+    unsigned index,
+    bool negative_ack,
+    uint8_t invoke_id,
+    uint8_t sequence_number)
+{
+    bool nak = false, server = true;
+    uint8_t id = 0, sequence = 0, window = 0;
+
+    zassert_true(index < Test_Send_Count, NULL);
+    zassert_equal(
+        segmentack_decode_apdu(
+            Test_Send_APDU[index], TEST_SEND_APDU_SIZE, &nak, &server, &id,
+            &sequence, &window),
+        4, NULL);
+    zassert_equal(nak, negative_ack, NULL);
+    zassert_false(server, NULL);
+    zassert_equal(id, invoke_id, NULL);
+    zassert_equal(sequence, sequence_number, NULL);
+    zassert_equal(window, 2, NULL);
+}
+
+/**
+ * @brief Test the reassembly of a segmented ComplexACK to our request,
+ *  with one SegmentACK for each window, and a negative SegmentACK for a
+ *  segment received out of order
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentReassembly)
+#else
+static void testSegmentReassembly(void)
+#endif
+{
+    BACNET_ADDRESS server = { 0 };
+    TSM_CONTEXT *previous;
+    uint8_t *apdu = NULL;
+    uint16_t apdu_len = 0;
+    uint8_t invoke_id;
+    unsigned i;
+
+    previous = test_tsm_setup();
+    invoke_id = test_tsm_request(1000);
+    server.mac_len = 1;
+    server.mac[0] = invoke_id;
+    /* the first segment is acknowledged */
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, 0, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    test_segment_ack_check(0, false, invoke_id, 0);
+    /* then the last segment of each window */
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, 1, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, 2, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 2, NULL);
+    test_segment_ack_check(1, false, invoke_id, 2);
+    /* a missing segment is reported with the last one received in order */
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, 4, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    test_segment_ack_check(2, true, invoke_id, 2);
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, 3, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 3, NULL);
+    /* the final segment completes the reply */
+    zassert_true(
+        test_segment_receive(
+            &server, invoke_id, 4, false, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    test_segment_ack_check(3, false, invoke_id, 4);
+    zassert_not_null(apdu, NULL);
+    zassert_equal(apdu_len, 5 * TEST_SEGMENT_SIZE, NULL);
+    for (i = 0; i < apdu_len; i++) {
+        zassert_equal(apdu[i], i / TEST_SEGMENT_SIZE, NULL);
+    }
+    tsm_free_invoke_id(invoke_id);
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+    test_tsm_teardown(previous);
+}
+
+/**
+ * @brief Test the Abort of a segmented ComplexACK with more segments than
+ *  the reassembly buffer accepts
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentReassemblyOverflow)
+#else
+static void testSegmentReassemblyOverflow(void)
+#endif
+{
+    BACNET_ADDRESS server = { 0 };
+    TSM_CONTEXT *previous;
+    const uint8_t *abort_apdu;
+    uint8_t *apdu = NULL;
+    uint16_t apdu_len = 0;
+    uint8_t invoke_id;
+    unsigned sent;
+    uint8_t i;
+
+    previous = test_tsm_setup();
+    invoke_id = test_tsm_request(1000);
+    server.mac_len = 1;
+    server.mac[0] = invoke_id;
+    for (i = 0; i < BACNET_SEGMENTATION_SEGMENTS_MAX; i++) {
+        zassert_false(
+            test_segment_receive(
+                &server, invoke_id, i, true, &apdu, &apdu_len),
+            NULL);
+    }
+    zassert_false(tsm_invoke_id_failed(invoke_id), NULL);
+    sent = Test_Send_Count;
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, i, true, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, sent + 1, NULL);
+    abort_apdu = Test_Send_APDU[sent];
+    zassert_equal(abort_apdu[0], PDU_TYPE_ABORT, NULL);
+    zassert_equal(abort_apdu[1], invoke_id, NULL);
+    zassert_equal(abort_apdu[2], ABORT_REASON_BUFFER_OVERFLOW, NULL);
+    zassert_true(tsm_invoke_id_failed(invoke_id), NULL);
+    /* the following segments are ignored */
+    zassert_false(
+        test_segment_receive(
+            &server, invoke_id, i + 1, false, &apdu, &apdu_len),
+        NULL);
+    zassert_equal(Test_Send_Count, sent + 1, NULL);
+    tsm_free_invoke_id(invoke_id);
+    test_tsm_teardown(previous);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(tsm_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        tsm_tests, ztest_unit_test(testInvokeIDs),
+        ztest_unit_test(testTimeoutOrder), ztest_unit_test(testTimeoutRetries),
+        ztest_unit_test(testTimeoutClockWrap),
+        ztest_unit_test(testSegmentWindows),
+        ztest_unit_test(testSegmentNegativeAck),
+        ztest_unit_test(testSegmentRetries),
+        ztest_unit_test(testSegmentReassembly),
+        ztest_unit_test(testSegmentReassemblyOverflow));
+
+    ztest_run_test_suite(tsm_tests);
+}
+#endif
@@ -299,6 +299,64 @@ static void testCOVNotify(void)
     testCCOVNotifyData(invoke_id, &data);
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(cov_tests, testCOVNotifyValues)
+#else
+static void testCOVNotifyValues(void)
+#endif
+{
+    uint8_t invoke_id = 12;
+    uint8_t apdu[480] = { 0 };
+    uint8_t test_apdu[480] = { 0 };
+    uint8_t values[64] = { 0 };
+    int len = 0, test_len = 0, values_len = 0;
+    BACNET_COV_DATA data = { 0 };
+    BACNET_PROPERTY_VALUE value_list[2] = { { 0 } };
+
+    data.subscriberProcessIdentifier = 1;
+    data.initiatingDeviceIdentifier = 123;
+    data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    data.monitoredObjectIdentifier.instance = 321;
+    data.timeRemaining = 456;
+    cov_data_value_list_link(&data, &value_list[0], 2);
+    value_list[0].propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list[0].propertyArrayIndex = BACNET_ARRAY_ALL;
+    bacapp_parse_application_data(
+        BACNET_APPLICATION_TAG_REAL, "21.0", &value_list[0].value);
+    value_list[1].propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list[1].propertyArrayIndex = BACNET_ARRAY_ALL;
+    bacapp_parse_application_data(
+        BACNET_APPLICATION_TAG_BIT_STRING, "0000", &value_list[1].value);
+    values_len = cov_notify_value_list_encode(NULL, &value_list[0]);
+    zassert_true(values_len > 0, NULL);
+    zassert_true(values_len <= (int)sizeof(values), NULL);
+    len = cov_notify_value_list_encode(&values[0], &value_list[0]);
+    zassert_equal(len, values_len, NULL);
+    /* the same listOfValues is shared by different subscribers */
+    data.subscriberProcessIdentifier = 123456;
+    data.timeRemaining = 0;
+    len = ucov_notify_encode_apdu(&apdu[0], sizeof(apdu), &data);
+    zassert_true(len > 0, NULL);
+    test_len = ucov_notify_values_encode_apdu(
+        NULL, sizeof(test_apdu), &data, &values[0], values_len);
+    zassert_equal(len, test_len, NULL);
+    test_len = ucov_notify_values_encode_apdu(
+        &test_apdu[0], sizeof(test_apdu), &data, &values[0], values_len);
+    zassert_equal(len, test_len, NULL);
+    zassert_mem_equal(apdu, test_apdu, len, NULL);
+    len = ccov_notify_encode_apdu(&apdu[0], sizeof(apdu), invoke_id, &data);
+    zassert_true(len > 0, NULL);
+    test_len = ccov_notify_values_encode_apdu(
+        &test_apdu[0], sizeof(test_apdu), invoke_id, &data, &values[0],
+        values_len);
+    zassert_equal(len, test_len, NULL);
+    zassert_mem_equal(apdu, test_apdu, len, NULL);
+    /* too small */
+    test_len = ccov_notify_values_encode_apdu(
+        &test_apdu[0], len - 1, invoke_id, &data, &values[0], values_len);
+    zassert_equal(test_len, 0, NULL);
+}
+
 static void testCOVSubscribeData(
     const BACNET_SUBSCRIBE_COV_DATA *data,
     const BACNET_SUBSCRIBE_COV_DATA *test_data)
@@ -604,6 +662,7 @@ void test_main(void)
 {
     ztest_test_suite(
         cov_tests, ztest_unit_test(testCOVNotify),
+        ztest_unit_test(testCOVNotifyValues),
         ztest_unit_test(testCOVSubscribe),
         ztest_unit_test(testCOVSubscribeProperty),
         ztest_unit_test(test_COV_Value_List_Encode));
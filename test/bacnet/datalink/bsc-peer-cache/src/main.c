@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @brief Unit test for the verified peer certificate cache of BACnet/SC
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/datalink/bsc/bsc-peer-cache.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Make the fingerprint of a test certificate
+ * @param fingerprint - [out] the fingerprint
+ * @param id - number of the test certificate
+ */
+static void test_fingerprint(uint8_t *fingerprint, uint8_t id)
+{
+    memset(fingerprint, id, BSC_PEER_FINGERPRINT_SIZE);
+}
+
+/**
+ * @brief Test the lookup, the update, and the expiry of a certificate
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bsc_peer_cache_tests, testPeerCacheLookup)
+#else
+static void testPeerCacheLookup(void)
+#endif
+{
+    uint8_t fingerprint[BSC_PEER_FINGERPRINT_SIZE];
+    char identity[8] = { 0 };
+
+    bsc_peer_cache_invalidate();
+    test_fingerprint(fingerprint, 1);
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 100, NULL, 0), NULL);
+    zassert_false(bsc_peer_cache_lookup(NULL, 100, NULL, 0), NULL);
+    /* an expired certificate is not added */
+    bsc_peer_cache_add(fingerprint, 100, "expired", 100);
+    zassert_equal(bsc_peer_cache_count(), 0, NULL);
+    bsc_peer_cache_add(fingerprint, 200, "node-with-long-name", 100);
+    zassert_equal(bsc_peer_cache_count(), 1, NULL);
+    zassert_true(
+        bsc_peer_cache_lookup(fingerprint, 150, identity, sizeof(identity)),
+        NULL);
+    zassert_equal(strcmp(identity, "node-wi"), 0, NULL);
+    /* adding again updates the entry */
+    bsc_peer_cache_add(fingerprint, 300, "node", 150);
+    zassert_equal(bsc_peer_cache_count(), 1, NULL);
+    zassert_true(
+        bsc_peer_cache_lookup(fingerprint, 250, identity, sizeof(identity)),
+        NULL);
+    zassert_equal(strcmp(identity, "node"), 0, NULL);
+    /* the certificate expired */
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 300, NULL, 0), NULL);
+    zassert_equal(bsc_peer_cache_count(), 0, NULL);
+}
+
+/**
+ * @brief Test the replacement of the certificates when the cache is full
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bsc_peer_cache_tests, testPeerCacheReplace)
+#else
+static void testPeerCacheReplace(void)
+#endif
+{
+    uint8_t fingerprint[BSC_PEER_FINGERPRINT_SIZE];
+    uint8_t id;
+
+    bsc_peer_cache_invalidate();
+    for (id = 1; id <= BSC_PEER_CACHE_SIZE; id++) {
+        test_fingerprint(fingerprint, id);
+        bsc_peer_cache_add(fingerprint, 1000, NULL, 0);
+    }
+    zassert_equal(bsc_peer_cache_count(), BSC_PEER_CACHE_SIZE, NULL);
+    /* use the first certificate, so that the second one is the oldest */
+    test_fingerprint(fingerprint, 1);
+    zassert_true(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    test_fingerprint(fingerprint, BSC_PEER_CACHE_SIZE + 1);
+    bsc_peer_cache_add(fingerprint, 1000, NULL, 10);
+    zassert_equal(bsc_peer_cache_count(), BSC_PEER_CACHE_SIZE, NULL);
+    test_fingerprint(fingerprint, 2);
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    test_fingerprint(fingerprint, 1);
+    zassert_true(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    test_fingerprint(fingerprint, BSC_PEER_CACHE_SIZE + 1);
+    zassert_true(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    /* an expired certificate is replaced before the oldest one */
+    test_fingerprint(fingerprint, 3);
+    bsc_peer_cache_add(fingerprint, 20, NULL, 10);
+    test_fingerprint(fingerprint, BSC_PEER_CACHE_SIZE + 2);
+    bsc_peer_cache_add(fingerprint, 1000, NULL, 30);
+    test_fingerprint(fingerprint, 3);
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 30, NULL, 0), NULL);
+    test_fingerprint(fingerprint, 1);
+    zassert_true(bsc_peer_cache_lookup(fingerprint, 30, NULL, 0), NULL);
+}
+
+/**
+ * @brief Test the flush of the certificates when the trust changes
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bsc_peer_cache_tests, testPeerCacheTrust)
+#else
+static void testPeerCacheTrust(void)
+#endif
+{
+    uint8_t fingerprint[BSC_PEER_FINGERPRINT_SIZE];
+    uint8_t digest[BSC_PEER_FINGERPRINT_SIZE];
+
+    bsc_peer_cache_invalidate();
+    test_fingerprint(digest, 0xA5);
+    (void)bsc_peer_cache_trust_set(digest);
+    test_fingerprint(fingerprint, 1);
+    bsc_peer_cache_add(fingerprint, 1000, NULL, 0);
+    /* the same trust anchors keep the certificates */
+    zassert_false(bsc_peer_cache_trust_set(digest), NULL);
+    zassert_false(bsc_peer_cache_trust_set(NULL), NULL);
+    zassert_true(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    /* other trust anchors flush the certificates */
+    test_fingerprint(digest, 0x5A);
+    zassert_true(bsc_peer_cache_trust_set(digest), NULL);
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+    zassert_equal(bsc_peer_cache_count(), 0, NULL);
+    /* a revocation list change flushes the certificates */
+    bsc_peer_cache_add(fingerprint, 1000, NULL, 0);
+    zassert_equal(bsc_peer_cache_count(), 1, NULL);
+    bsc_peer_cache_invalidate();
+    zassert_false(bsc_peer_cache_lookup(fingerprint, 10, NULL, 0), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(bsc_peer_cache_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        bsc_peer_cache_tests, ztest_unit_test(testPeerCacheLookup),
+        ztest_unit_test(testPeerCacheReplace),
+        ztest_unit_test(testPeerCacheTrust));
+
+    ztest_run_test_suite(bsc_peer_cache_tests);
+}
+#endif
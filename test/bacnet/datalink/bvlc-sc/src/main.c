@@ -4551,6 +4551,60 @@ static void test_BROADCAST(void)
     zassert_equal(ret, true, NULL);
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bvlc_sc_tests, test_PEEK_HEADER)
+#else
+static void test_PEEK_HEADER(void)
+#endif
+{
+    uint8_t buf[256];
+    uint8_t npdu[] = { 0x01, 0x00, 0x10, 0x08 };
+    size_t len;
+    BACNET_SC_VMAC_ADDRESS dest;
+    BACNET_SC_VMAC_ADDRESS orig;
+    BVLC_SC_DECODED_HDR hdr;
+    BVLC_SC_DECODED_MESSAGE message;
+    uint16_t error_code;
+    uint16_t error_class;
+    const char *err_desc = NULL;
+    bool dest_options = true, data_options = true;
+    bool ret;
+
+    memset(&dest.address, 0x34, sizeof(dest.address));
+    memset(&orig.address, 0x12, sizeof(orig.address));
+    len = bvlc_sc_encode_encapsulated_npdu(
+        buf, sizeof(buf), 0xF00D, NULL, &dest, npdu, sizeof(npdu));
+    zassert_not_equal(len, 0, NULL);
+    ret = bvlc_sc_peek_hdr(buf, len, &hdr, &dest_options, &data_options);
+    zassert_true(ret, NULL);
+    zassert_false(dest_options, NULL);
+    zassert_false(data_options, NULL);
+    ret = bvlc_sc_decode_message(
+        buf, len, &message, &error_code, &error_class, &err_desc);
+    zassert_true(ret, NULL);
+    zassert_equal(hdr.bvlc_function, message.hdr.bvlc_function, NULL);
+    zassert_equal(hdr.message_id, message.hdr.message_id, NULL);
+    zassert_is_null(hdr.origin, NULL);
+    zassert_equal_ptr(hdr.dest, message.hdr.dest, NULL);
+    zassert_is_null(hdr.payload, NULL);
+    /* the forwarded header is rewritten in place */
+    bvlc_sc_remove_dest_set_orig(buf, len, &orig);
+    ret = bvlc_sc_peek_hdr(buf, len, &hdr, NULL, NULL);
+    zassert_true(ret, NULL);
+    zassert_is_null(hdr.dest, NULL);
+    zassert_equal(
+        memcmp(hdr.origin->address, orig.address, sizeof(orig.address)), 0,
+        NULL);
+    /* truncated addresses and reserved control bits need a full decode */
+    ret = bvlc_sc_peek_hdr(buf, 4 + BVLC_SC_VMAC_SIZE - 1, &hdr, NULL, NULL);
+    zassert_false(ret, NULL);
+    ret = bvlc_sc_peek_hdr(buf, 3, &hdr, NULL, NULL);
+    zassert_false(ret, NULL);
+    buf[1] |= 0x80;
+    ret = bvlc_sc_peek_hdr(buf, len, &hdr, NULL, NULL);
+    zassert_false(ret, NULL);
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST_SUITE(bvlc_sc_tests, NULL, NULL, NULL, NULL, NULL);
 #else
@@ -4573,7 +4627,8 @@ void test_main(void)
         ztest_unit_test(test_BAD_HEADER_OPTIONS),
         ztest_unit_test(test_BAD_ENCODE_PARAMS),
         ztest_unit_test(test_BAD_DECODE_PARAMS),
-        ztest_unit_test(test_BROADCAST));
+        ztest_unit_test(test_BROADCAST),
+        ztest_unit_test(test_PEEK_HEADER));
 
     ztest_run_test_suite(bvlc_sc_tests);
 }
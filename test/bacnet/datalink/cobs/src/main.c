@@ -7,6 +7,7 @@
  */
 #include <zephyr/ztest.h>
 #include <stdlib.h>
+#include <bacnet/datalink/mstpdef.h>
 #include <bacnet/datalink/cobs.h>
 #include <bacnet/basic/sys/bytes.h>
 
@@ -49,6 +50,62 @@ static void test_COBS_Encode_Decode(void)
     zassert_true(
         test_buffer_length == sizeof(buffer), "COBS encode/decode length fail");
 }
+
+/**
+ * @brief Reference CRC-32K from Clause G.3.1 of the BACnet Standard
+ */
+static uint32_t test_crc32k(uint8_t dataValue, uint32_t crc32kValue)
+{
+    uint8_t data, b;
+    uint32_t crc;
+
+    data = dataValue;
+    crc = crc32kValue;
+    for (b = 0; b < 8; b++) {
+        if ((data & 1) ^ (crc & 1)) {
+            crc >>= 1;
+            crc ^= 0xEB31D82E;
+        } else {
+            crc >>= 1;
+        }
+        data >>= 1;
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Test the CRC-32K table and buffer functions against the
+ *  reference, for every length and alignment around the slice size
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(cobs_tests, test_COBS_CRC32K)
+#else
+static void test_COBS_CRC32K(void)
+#endif
+{
+    uint8_t buffer[64];
+    uint32_t crc, test_crc;
+    size_t offset, length, i;
+
+    for (i = 0; i < 256; i++) {
+        zassert_equal(cobs_crc32k(i, 0), test_crc32k(i, 0), NULL);
+    }
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)((i * 37) + 11);
+    }
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length <= (sizeof(buffer) - offset); length++) {
+            crc = CRC32K_INITIAL_VALUE;
+            for (i = 0; i < length; i++) {
+                crc = test_crc32k(buffer[offset + i], crc);
+            }
+            test_crc = cobs_crc32k_buffer(
+                &buffer[offset], length, CRC32K_INITIAL_VALUE);
+            zassert_equal(crc, test_crc, NULL);
+        }
+    }
+}
 /**
  * @}
  */
@@ -58,7 +115,9 @@ ZTEST_SUITE(cobs_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(cobs_tests, ztest_unit_test(test_COBS_Encode_Decode));
+    ztest_test_suite(
+        cobs_tests, ztest_unit_test(test_COBS_Encode_Decode),
+        ztest_unit_test(test_COBS_CRC32K));
 
     ztest_run_test_suite(cobs_tests);
 }
@@ -73,6 +73,40 @@ static void testCRC16(void)
     zassert_equal(crc, 0xF0B8, NULL);
 }
 
+/**
+ * @brief Test the buffer CRC functions against the per-octet functions,
+ *  for every length and alignment around the slice size
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(crc_tests, testCRCBuffer)
+#else
+static void testCRCBuffer(void)
+#endif
+{
+    uint8_t buffer[64];
+    uint16_t crc16, test_crc16;
+    uint8_t crc8, test_crc8;
+    size_t offset, length, i;
+
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)((i * 37) + 11);
+    }
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length <= (sizeof(buffer) - offset); length++) {
+            crc16 = 0xffff;
+            crc8 = 0xff;
+            for (i = 0; i < length; i++) {
+                crc16 = CRC_Calc_Data(buffer[offset + i], crc16);
+                crc8 = CRC_Calc_Header(buffer[offset + i], crc8);
+            }
+            test_crc16 = CRC_Calc_Data_Buffer(&buffer[offset], length, 0xffff);
+            zassert_equal(crc16, test_crc16, NULL);
+            test_crc8 = CRC_Calc_Header_Buffer(&buffer[offset], length, 0xff);
+            zassert_equal(crc8, test_crc8, NULL);
+        }
+    }
+}
+
 /**
  * @brief "Test" to create/log generated CRC8 table
  */
@@ -139,7 +173,7 @@ void test_main(void)
 {
     ztest_test_suite(
         crc_tests, ztest_unit_test(testCRC8), ztest_unit_test(testCRC16),
-        ztest_unit_test(testCRC8CreateTable),
+        ztest_unit_test(testCRCBuffer), ztest_unit_test(testCRC8CreateTable),
         ztest_unit_test(testCRC16CreateTable));
 
     ztest_run_test_suite(crc_tests);
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Unit test for the datalink traffic counters
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/datalink/dlstats.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/**
+ * @brief Test the counters of each datalink
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dlstats_tests, testDatalinkStatistics)
+#else
+static void testDatalinkStatistics(void)
+#endif
+{
+    DLSTATS_COUNTERS counters = { 0 };
+    bool status;
+
+    DLSTATS_RECEIVE(PORT_TYPE_BIP, 100);
+    DLSTATS_RECEIVE(PORT_TYPE_BIP, 20);
+    DLSTATS_SEND(PORT_TYPE_BIP, 50);
+    DLSTATS_DROP(PORT_TYPE_BIP);
+    DLSTATS_DECODE_ERROR(PORT_TYPE_BIP);
+    DLSTATS_QUEUE_DEPTH(PORT_TYPE_BIP, 3);
+    DLSTATS_SEND(PORT_TYPE_MSTP, 9);
+    status = dlstats_counters(PORT_TYPE_BIP, &counters);
+    zassert_true(status, NULL);
+    zassert_equal(counters.packets_in, 2, NULL);
+    zassert_equal(counters.bytes_in, 120, NULL);
+    zassert_equal(counters.packets_out, 1, NULL);
+    zassert_equal(counters.bytes_out, 50, NULL);
+    zassert_equal(counters.drops, 1, NULL);
+    zassert_equal(counters.decode_errors, 1, NULL);
+    zassert_equal(counters.queue_depth, 3, NULL);
+    status = dlstats_counters(PORT_TYPE_MSTP, &counters);
+    zassert_true(status, NULL);
+    zassert_equal(counters.packets_in, 0, NULL);
+    zassert_equal(counters.packets_out, 1, NULL);
+    zassert_equal(counters.bytes_out, 9, NULL);
+    /* the queue depth is a gauge, and is not reset */
+    dlstats_reset(PORT_TYPE_BIP);
+    status = dlstats_counters(PORT_TYPE_BIP, &counters);
+    zassert_true(status, NULL);
+    zassert_equal(counters.packets_in, 0, NULL);
+    zassert_equal(counters.drops, 0, NULL);
+    zassert_equal(counters.queue_depth, 3, NULL);
+    /* no counters for proprietary port types */
+    DLSTATS_SEND(PORT_TYPE_PROPRIETARY_MIN, 1);
+    status = dlstats_counters(PORT_TYPE_PROPRIETARY_MIN, &counters);
+    zassert_false(status, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(dlstats_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(dlstats_tests, ztest_unit_test(testDatalinkStatistics));
+
+    ztest_run_test_suite(dlstats_tests);
+}
+#endif
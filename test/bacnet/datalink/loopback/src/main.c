@@ -0,0 +1,214 @@
+/**
+ * @file
+ * @brief Unit test for the in-process loopback datalink
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/mstimer.h>
+#include <bacnet/datalink/dlstats.h>
+#include <bacnet/datalink/loopback.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static unsigned long Milliseconds;
+
+/**
+ * @brief Get the current time in milliseconds
+ * @return milliseconds
+ */
+unsigned long mstimer_now(void)
+{
+    return Milliseconds;
+}
+
+/**
+ * @brief Empty the queue of every node
+ */
+static void loopback_test_flush(void)
+{
+    uint8_t node;
+
+    for (node = 0; node < LOOPBACK_NODES_MAX; node++) {
+        while (loopback_node_pending(node)) {
+            (void)loopback_node_receive(node, NULL, NULL, 0);
+        }
+    }
+}
+
+/**
+ * @brief Test unicast and broadcast delivery between the nodes
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(loopback_tests, testLoopbackDelivery)
+#else
+static void testLoopbackDelivery(void)
+#endif
+{
+    BACNET_ADDRESS dest = { 0 }, src = { 0 };
+    uint8_t pdu[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t rx_pdu[LOOPBACK_MPDU_MAX] = { 0 };
+    uint16_t pdu_len;
+    unsigned i;
+    bool status;
+    int bytes;
+
+    status = loopback_init("1");
+    zassert_true(status, NULL);
+    zassert_equal(loopback_node(), 1, NULL);
+    status = loopback_init("99");
+    zassert_false(status, NULL);
+    zassert_equal(loopback_node(), 1, NULL);
+    loopback_get_my_address(&src);
+    zassert_equal(src.mac_len, 1, NULL);
+    zassert_equal(src.mac[0], 1, NULL);
+    /* unicast from node 1 to node 2 */
+    dest.mac_len = 1;
+    dest.mac[0] = 2;
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    zassert_equal(loopback_node_pending(0), 0, NULL);
+    zassert_equal(loopback_node_pending(1), 0, NULL);
+    zassert_equal(loopback_node_pending(2), 1, NULL);
+    pdu_len = loopback_node_receive(2, &src, rx_pdu, sizeof(rx_pdu));
+    zassert_equal(pdu_len, sizeof(pdu), NULL);
+    zassert_mem_equal(rx_pdu, pdu, sizeof(pdu), NULL);
+    zassert_equal(src.mac_len, 1, NULL);
+    zassert_equal(src.mac[0], 1, NULL);
+    pdu_len = loopback_node_receive(2, &src, rx_pdu, sizeof(rx_pdu));
+    zassert_equal(pdu_len, 0, NULL);
+    /* reply from node 2 to node 1 using the datalink API */
+    bytes = loopback_node_send_pdu(2, &src, pdu, 4);
+    zassert_equal(bytes, 4, NULL);
+    pdu_len = loopback_receive(&src, rx_pdu, sizeof(rx_pdu), 0);
+    zassert_equal(pdu_len, 4, NULL);
+    zassert_equal(src.mac[0], 2, NULL);
+    /* broadcast reaches every node except the sender */
+    loopback_get_broadcast_address(&dest);
+    zassert_equal(dest.mac_len, 0, NULL);
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    zassert_equal(loopback_node_pending(0), 1, NULL);
+    zassert_equal(loopback_node_pending(1), 0, NULL);
+    zassert_equal(loopback_node_pending(2), 1, NULL);
+    loopback_test_flush();
+    /* a full queue drops the NPDU */
+    dest.mac_len = 1;
+    dest.mac[0] = 0;
+    for (i = 0; i < LOOPBACK_QUEUE_SIZE; i++) {
+        (void)loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    }
+    zassert_equal(loopback_node_pending(0), LOOPBACK_QUEUE_SIZE, NULL);
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    zassert_equal(loopback_node_pending(0), LOOPBACK_QUEUE_SIZE, NULL);
+    loopback_test_flush();
+    /* a node that does not exist */
+    dest.mac[0] = LOOPBACK_NODES_MAX;
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    bytes = loopback_node_send_pdu(LOOPBACK_NODES_MAX, &dest, pdu, 1);
+    zassert_equal(bytes, -1, NULL);
+    status = loopback_node_set(LOOPBACK_NODES_MAX);
+    zassert_false(status, NULL);
+    status = loopback_node_set(0);
+    zassert_true(status, NULL);
+    zassert_equal(loopback_node(), 0, NULL);
+    loopback_cleanup();
+}
+
+/**
+ * @brief Test the latency, loss, and MTU of the virtual network
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(loopback_tests, testLoopbackNetwork)
+#else
+static void testLoopbackNetwork(void)
+#endif
+{
+    BACNET_ADDRESS dest = { 0 }, src = { 0 };
+    uint8_t pdu[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t rx_pdu[LOOPBACK_MPDU_MAX] = { 0 };
+    DLSTATS_COUNTERS counters = { 0 };
+    uint16_t pdu_len;
+    unsigned i, received;
+    int bytes;
+
+    (void)loopback_init("0");
+    loopback_test_flush();
+    dlstats_reset(PORT_TYPE_VIRTUAL);
+    dest.mac_len = 1;
+    dest.mac[0] = 1;
+    /* an NPDU is due after the latency */
+    loopback_latency_set(50);
+    zassert_equal(loopback_latency(), 50, NULL);
+    Milliseconds = 1000;
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    Milliseconds = 1049;
+    pdu_len = loopback_node_receive(1, &src, rx_pdu, sizeof(rx_pdu));
+    zassert_equal(pdu_len, 0, NULL);
+    zassert_equal(loopback_node_pending(1), 1, NULL);
+    Milliseconds = 1050;
+    pdu_len = loopback_node_receive(1, &src, rx_pdu, sizeof(rx_pdu));
+    zassert_equal(pdu_len, sizeof(pdu), NULL);
+    loopback_latency_set(0);
+    /* an NPDU larger than the MTU is not sent */
+    loopback_mtu_set(4);
+    zassert_equal(loopback_mtu(), 4, NULL);
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, -1, NULL);
+    bytes = loopback_send_pdu(&dest, NULL, pdu, 4);
+    zassert_equal(bytes, 4, NULL);
+    loopback_mtu_set(LOOPBACK_MPDU_MAX + 1);
+    zassert_equal(loopback_mtu(), LOOPBACK_MPDU_MAX, NULL);
+    loopback_test_flush();
+    /* every NPDU is lost */
+    loopback_loss_set(1000000);
+    zassert_equal(loopback_loss(), 1000000, NULL);
+    bytes = loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+    zassert_equal(bytes, sizeof(pdu), NULL);
+    zassert_equal(loopback_node_pending(1), 0, NULL);
+    /* about half of the NPDUs are lost, the same ones for the same seed */
+    loopback_loss_set(500000);
+    loopback_seed_set(12345);
+    received = 0;
+    for (i = 0; i < 100; i++) {
+        (void)loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+        received += loopback_node_receive(1, NULL, rx_pdu, sizeof(rx_pdu)) ?
+            1 : 0;
+    }
+    zassert_true(received > 25, NULL);
+    zassert_true(received < 75, NULL);
+    loopback_seed_set(12345);
+    for (i = 0; i < 100; i++) {
+        (void)loopback_send_pdu(&dest, NULL, pdu, sizeof(pdu));
+        if (loopback_node_receive(1, NULL, rx_pdu, sizeof(rx_pdu))) {
+            received--;
+        }
+    }
+    zassert_equal(received, 0, NULL);
+    loopback_loss_set(0);
+    zassert_true(dlstats_counters(PORT_TYPE_VIRTUAL, &counters), NULL);
+    zassert_true(counters.drops > 0, NULL);
+    zassert_true(counters.packets_in > 0, NULL);
+    zassert_true(counters.packets_out > 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(loopback_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        loopback_tests, ztest_unit_test(testLoopbackDelivery),
+        ztest_unit_test(testLoopbackNetwork));
+
+    ztest_run_test_suite(loopback_tests);
+}
+#endif
@@ -214,7 +214,7 @@ void MSTP_Send_Frame(
 
 static void testReceiveNodeFSM(void)
 {
-    struct mstp_port_struct_t mstp_port; /* port data */
+    struct mstp_port_struct_t mstp_port = { 0 }; /* port data */
     unsigned EventCount = 0; /* local counter */
     uint8_t my_mac = 0x05; /* local MAC address */
     uint8_t HeaderCRC = 0; /* for local CRC calculation */
@@ -621,7 +621,7 @@ static void testReceiveNodeFSM(void)
 
 static void testMasterNodeFSM(void)
 {
-    struct mstp_port_struct_t MSTP_Port; /* port data */
+    struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
     uint8_t my_mac = 0x05; /* local MAC address */
     MSTP_Port.InputBuffer = &RxBuffer[0];
     MSTP_Port.InputBufferSize = sizeof(RxBuffer);
@@ -646,6 +646,279 @@ static void testMasterNodeFSM(void)
     /* FIXME: write a unit test for the Master Node State Machine */
 }
 
+/* free running millisecond clock for the statistics */
+static uint32_t Test_Milliseconds;
+static uint32_t Test_Milliseconds_Now(void)
+{
+    return Test_Milliseconds;
+}
+
+static void testMasterNodeStatistics(void)
+{
+    struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
+    struct mstp_port_statistics statistics = { 0 };
+    uint8_t buffer[MAX_MPDU] = { 0 };
+    unsigned len, i;
+
+    MSTP_Port.InputBuffer = &RxBuffer[0];
+    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
+    MSTP_Port.OutputBuffer = &TxBuffer[0];
+    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
+    MSTP_Port.Nmax_info_frames = 1;
+    MSTP_Port.Nmax_master = 127;
+    MSTP_Port.SilenceTimer = Timer_Silence;
+    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    MSTP_Port.This_Station = 0x05;
+    statistics.Milliseconds = Test_Milliseconds_Now;
+    statistics.Token_Count = 99;
+    MSTP_Port.Statistics = &statistics;
+    Test_Milliseconds = 1000;
+    MSTP_Init(&MSTP_Port);
+    zassert_equal(statistics.Token_Count, 0, NULL);
+    zassert_equal(statistics.Start_Time, 1000, NULL);
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_true(MSTP_Port.master_state == MSTP_MASTER_STATE_IDLE, NULL);
+    /* receive octets of a token frame */
+    len = MSTP_Create_Frame(
+        buffer, sizeof(buffer), FRAME_TYPE_TOKEN, 0x05, 0x03, NULL, 0);
+    Load_Input_Buffer(buffer, len);
+    for (i = 0; i < len; i++) {
+        RS485_Check_UART_Data(&MSTP_Port);
+        MSTP_Receive_Frame_FSM(&MSTP_Port);
+    }
+    zassert_true(MSTP_Port.ReceivedValidFrame, NULL);
+    zassert_equal(statistics.Receive_Octets, len, NULL);
+    /* first token has no rotation time */
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_true(MSTP_Port.master_state == MSTP_MASTER_STATE_USE_TOKEN, NULL);
+    zassert_equal(statistics.Token_Count, 1, NULL);
+    for (i = 0; i < MSTP_HISTOGRAM_BUCKETS; i++) {
+        zassert_equal(statistics.Token_Rotation[i], 0, NULL);
+    }
+    /* nothing to send, so the first token starts a poll for master */
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_true(
+        MSTP_Port.master_state == MSTP_MASTER_STATE_POLL_FOR_MASTER, NULL);
+    zassert_equal(statistics.Poll_For_Master_Count, 1, NULL);
+    zassert_equal(statistics.Transmit_Octets, 8, NULL);
+    /* the second token 100ms later */
+    MSTP_Port.master_state = MSTP_MASTER_STATE_IDLE;
+    Test_Milliseconds += 100;
+    MSTP_Port.SourceAddress = 0x03;
+    MSTP_Port.DestinationAddress = 0x05;
+    MSTP_Port.FrameType = FRAME_TYPE_TOKEN;
+    MSTP_Port.ReceivedValidFrame = true;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(statistics.Token_Count, 2, NULL);
+    zassert_equal(statistics.Token_Rotation[7], 1, NULL);
+    /* reply timeout */
+    MSTP_Port.master_state = MSTP_MASTER_STATE_WAIT_FOR_REPLY;
+    SilenceTime = MSTP_Port.Treply_timeout;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(statistics.Reply_Timeout_Count, 1, NULL);
+    /* reply postponed */
+    MSTP_Port.master_state = MSTP_MASTER_STATE_WAIT_FOR_REPLY;
+    SilenceTime = 0;
+    MSTP_Port.FrameType = FRAME_TYPE_REPLY_POSTPONED;
+    MSTP_Port.ReceivedValidFrame = true;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(statistics.Reply_Postponed_Received_Count, 1, NULL);
+    /* reply 10ms after the request */
+    MSTP_Port.master_state = MSTP_MASTER_STATE_WAIT_FOR_REPLY;
+    statistics.Request_Time = Test_Milliseconds;
+    Test_Milliseconds += 10;
+    MSTP_Port.FrameType = FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY;
+    MSTP_Port.DataLength = 0;
+    MSTP_Port.ReceivedValidFrame = true;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(statistics.Reply_Latency[4], 1, NULL);
+    /* octets per second over the 110ms */
+    zassert_equal(
+        MSTP_Statistics_Octets_Per_Second(&MSTP_Port),
+        ((statistics.Transmit_Octets + statistics.Receive_Octets) * 1000) /
+            110,
+        NULL);
+    zassert_equal(MSTP_Statistics_Histogram_Limit(0), 1, NULL);
+    zassert_equal(MSTP_Statistics_Histogram_Limit(4), 16, NULL);
+    zassert_equal(
+        MSTP_Statistics_Histogram_Limit(MSTP_HISTOGRAM_BUCKETS - 1),
+        UINT32_MAX, NULL);
+    MSTP_Statistics_Reset(&MSTP_Port);
+    zassert_equal(statistics.Token_Count, 0, NULL);
+    zassert_true(statistics.Milliseconds == Test_Milliseconds_Now, NULL);
+}
+
+/**
+ * @brief Run the maintenance slot of a token held by station 5, whose
+ *  successor is station 3, and let any Poll For Master go unanswered
+ * @param mstp_port port specific context data
+ * @param poll_station the station that was polled last
+ */
+static void Poll_Schedule_Maintenance_Slot(
+    struct mstp_port_struct_t *mstp_port, uint8_t poll_station)
+{
+    mstp_port->master_state = MSTP_MASTER_STATE_DONE_WITH_TOKEN;
+    mstp_port->FrameCount = mstp_port->Nmax_info_frames;
+    mstp_port->SoleMaster = false;
+    mstp_port->Next_Station = 0x03;
+    mstp_port->Poll_Station = poll_station;
+    mstp_port->TokenCount = Npoll - 1;
+    SilenceTime = 0;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    if (mstp_port->master_state == MSTP_MASTER_STATE_POLL_FOR_MASTER) {
+        SilenceTime = mstp_port->Tusage_timeout + 1;
+        (void)MSTP_Master_Node_FSM(mstp_port);
+    }
+}
+
+static void testMasterNodePollSchedule(void)
+{
+    struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
+    struct mstp_poll_schedule schedule = { 0 };
+
+    MSTP_Port.InputBuffer = &RxBuffer[0];
+    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
+    MSTP_Port.OutputBuffer = &TxBuffer[0];
+    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
+    MSTP_Port.Nmax_info_frames = 1;
+    MSTP_Port.Nmax_master = 127;
+    MSTP_Port.Tusage_timeout = DEFAULT_Tusage_timeout;
+    MSTP_Port.SilenceTimer = Timer_Silence;
+    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    MSTP_Port.This_Station = 0x05;
+    schedule.Skip[6] = 3;
+    MSTP_Port.Poll_Schedule = &schedule;
+    MSTP_Init(&MSTP_Port);
+    zassert_equal(schedule.Skip[6], 0, NULL);
+    /* the first poll that is not answered is repeated next time */
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    zassert_equal(MSTP_Port.Poll_Station, 0x06, NULL);
+    zassert_true(MSTP_Port.master_state == MSTP_MASTER_STATE_PASS_TOKEN, NULL);
+    zassert_equal(schedule.Skip[6], 0, NULL);
+    zassert_equal(schedule.Backoff[6], 1, NULL);
+    /* the second one skips a slot, the third one two slots */
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    zassert_equal(schedule.Skip[6], 1, NULL);
+    zassert_equal(schedule.Backoff[6], 2, NULL);
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    zassert_equal(MSTP_Port.Poll_Station, 0x06, NULL);
+    zassert_true(MSTP_Port.master_state == MSTP_MASTER_STATE_PASS_TOKEN, NULL);
+    zassert_equal(MSTP_Port.TokenCount, 1, NULL);
+    zassert_equal(schedule.Skip[6], 0, NULL);
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    zassert_equal(schedule.Skip[6], 2, NULL);
+    zassert_equal(schedule.Backoff[6], 4, NULL);
+    /* the backoff is limited */
+    schedule.Skip[6] = 0;
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    schedule.Skip[6] = 0;
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x05);
+    zassert_equal(schedule.Backoff[6], MSTP_POLL_BACKOFF_MAX, NULL);
+    /* the other addresses are polled in turn */
+    Poll_Schedule_Maintenance_Slot(&MSTP_Port, 0x06);
+    zassert_equal(MSTP_Port.Poll_Station, 0x07, NULL);
+    zassert_equal(schedule.Backoff[7], 1, NULL);
+    /* an address that answers is polled again at every slot */
+    schedule.Skip[6] = 0;
+    MSTP_Port.master_state = MSTP_MASTER_STATE_DONE_WITH_TOKEN;
+    MSTP_Port.Poll_Station = 0x05;
+    MSTP_Port.TokenCount = Npoll - 1;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_true(
+        MSTP_Port.master_state == MSTP_MASTER_STATE_POLL_FOR_MASTER, NULL);
+    MSTP_Port.SourceAddress = 0x06;
+    MSTP_Port.DestinationAddress = 0x05;
+    MSTP_Port.FrameType = FRAME_TYPE_REPLY_TO_POLL_FOR_MASTER;
+    MSTP_Port.ReceivedValidFrame = true;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(MSTP_Port.Next_Station, 0x06, NULL);
+    zassert_equal(schedule.Skip[6], 0, NULL);
+    zassert_equal(schedule.Backoff[6], 0, NULL);
+}
+
+static void testExtendedFramePeers(void)
+{
+    struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
+    struct mstp_extended_frame_peers peers = { 0 };
+    /* I-Am from device 1 with Max_APDU 1476, and with Max_APDU 480 */
+    const uint8_t i_am_1476[] = { 0x01, 0x00, 0x10, 0x00, 0xC4, 0x02,
+                                  0x00, 0x00, 0x01, 0x22, 0x05, 0xC4,
+                                  0x91, 0x03, 0x21, 0x00 };
+    const uint8_t i_am_480[] = { 0x01, 0x00, 0x10, 0x00, 0xC4, 0x02,
+                                 0x00, 0x00, 0x01, 0x22, 0x01, 0xE0,
+                                 0x91, 0x03, 0x21, 0x00 };
+    /* ReadProperty that accepts a 1476 octet reply */
+    const uint8_t request_1476[] = { 0x01, 0x04, 0x00, 0x05, 0x01, 0x0C,
+                                     0x0C, 0x02, 0x00, 0x00, 0x01, 0x19,
+                                     0x4D };
+    /* the I-Am routed from a device on network 2 */
+    const uint8_t routed_i_am[] = { 0x01, 0x08, 0x00, 0x02, 0x01, 0x07,
+                                    0x10, 0x00, 0xC4, 0x02, 0x00, 0x00,
+                                    0x01, 0x22, 0x05, 0xC4, 0x91, 0x03,
+                                    0x21, 0x00 };
+
+    MSTP_Port.InputBuffer = &RxBuffer[0];
+    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
+    MSTP_Port.OutputBuffer = &TxBuffer[0];
+    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
+    MSTP_Port.SilenceTimer = Timer_Silence;
+    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    MSTP_Port.This_Station = 0x05;
+    /* without a table, any station may receive extended frames */
+    zassert_true(MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, 0x03), NULL);
+    zassert_equal(MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x03), 0, NULL);
+    peers.Capable[0] = 0xFF;
+    MSTP_Port.Extended_Frame_Peers = &peers;
+    MSTP_Init(&MSTP_Port);
+    zassert_equal(peers.Capable[0], 0, NULL);
+    /* a station that was never heard from is allowed */
+    zassert_true(MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, 0x03), NULL);
+    zassert_equal(MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x03), 0, NULL);
+    /* I-Am with a Max_APDU of 480 is a legacy station */
+    MSTP_Port.SourceAddress = 0x03;
+    MSTP_Port.FrameType = FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY;
+    memcpy(RxBuffer, i_am_480, sizeof(i_am_480));
+    MSTP_Port.DataLength = sizeof(i_am_480);
+    MSTP_Extended_Frame_Peer_Update(&MSTP_Port);
+    zassert_false(MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, 0x03), NULL);
+    zassert_equal(
+        MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x03), 480, NULL);
+    zassert_true(
+        MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, MSTP_BROADCAST_ADDRESS),
+        NULL);
+    /* I-Am with a Max_APDU of 1476 is a capable station */
+    memcpy(RxBuffer, i_am_1476, sizeof(i_am_1476));
+    MSTP_Port.DataLength = sizeof(i_am_1476);
+    MSTP_Extended_Frame_Peer_Update(&MSTP_Port);
+    zassert_true(MSTP_Extended_Frame_Peer_Allowed(&MSTP_Port, 0x03), NULL);
+    zassert_equal(
+        MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x03), 1476, NULL);
+    /* a routed I-Am describes a device behind the router */
+    MSTP_Port.SourceAddress = 0x04;
+    memcpy(RxBuffer, routed_i_am, sizeof(routed_i_am));
+    MSTP_Port.DataLength = sizeof(routed_i_am);
+    MSTP_Extended_Frame_Peer_Update(&MSTP_Port);
+    zassert_equal(MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x04), 0, NULL);
+    /* a confirmed request that accepts 1476 octets */
+    MSTP_Port.SourceAddress = 0x06;
+    MSTP_Port.FrameType = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
+    memcpy(RxBuffer, request_1476, sizeof(request_1476));
+    MSTP_Port.DataLength = sizeof(request_1476);
+    MSTP_Extended_Frame_Peer_Update(&MSTP_Port);
+    zassert_equal(
+        MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x06), 1476, NULL);
+    /* an extended frame received through the master node state machine */
+    MSTP_Port.SourceAddress = 0x07;
+    MSTP_Port.DestinationAddress = 0x05;
+    MSTP_Port.FrameType = FRAME_TYPE_BACNET_EXTENDED_DATA_NOT_EXPECTING_REPLY;
+    MSTP_Port.master_state = MSTP_MASTER_STATE_IDLE;
+    MSTP_Port.ReceivedValidFrame = true;
+    (void)MSTP_Master_Node_FSM(&MSTP_Port);
+    zassert_equal(
+        MSTP_Extended_Frame_Peer_Max_APDU(&MSTP_Port, 0x07), 1476, NULL);
+}
+
 static void testSlaveNodeFSM(void)
 {
     struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
@@ -1332,6 +1605,53 @@ static void testAutoBaudNode_Idle_Timeout(struct mstp_port_struct_t *mstp_port)
     zassert_true(mstp_port->ValidFrameTimer(NULL) == 0, NULL);
 }
 
+static void testAutoBaudNode_Search(struct mstp_port_struct_t *mstp_port)
+{
+    unsigned index;
+
+    /* without a rate last used, the search starts at the most common */
+    Baud_Rate_Set(0);
+    testAutoBaudNode_Init(mstp_port);
+    /* the search starts at the rate last used */
+    Baud_Rate_Set(MSTP_Auto_Baud_Rate(3));
+    mstp_port->Auto_Baud_State = MSTP_AUTO_BAUD_STATE_INIT;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->BaudRateIndex, 3, NULL);
+    zassert_equal(Baud_Rate(), MSTP_Auto_Baud_Rate(3), NULL);
+    /* a busy trunk without a valid frame rejects the rate before
+       the timeout, and the most common untried rate is next */
+    Good_Header_Time = 100;
+    mstp_port->EventCount = 255;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->BaudRateIndex, 0, NULL);
+    zassert_equal(mstp_port->EventCount, 0, NULL);
+    zassert_equal(Good_Header_Time, 0, NULL);
+    /* preambles seen at a rate move it ahead of the other rates */
+    mstp_port->AutoBaudPreambles[4] = 2;
+    mstp_port->AutoBaudPreambles[2] = 1;
+    mstp_port->EventCount = 255;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->BaudRateIndex, 4, NULL);
+    mstp_port->EventCount = 255;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->BaudRateIndex, 2, NULL);
+    /* a received preamble is counted for the rate */
+    mstp_port->ReceivedInvalidFrame = true;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->AutoBaudPreambles[2], 2, NULL);
+    /* every rate is tried before the search starts over */
+    for (index = 0; index < MSTP_AUTO_BAUD_RATE_MAX - 4; index++) {
+        mstp_port->EventCount = 255;
+        (void)MSTP_Master_Node_FSM(mstp_port);
+    }
+    zassert_equal(
+        mstp_port->AutoBaudTried, (1U << MSTP_AUTO_BAUD_RATE_MAX) - 1, NULL);
+    mstp_port->EventCount = 255;
+    (void)MSTP_Master_Node_FSM(mstp_port);
+    zassert_equal(mstp_port->BaudRateIndex, 2, NULL);
+    zassert_true(mstp_port->CheckAutoBaud, NULL);
+}
+
 static void testAutoBaudNodeFSM(void)
 {
     struct mstp_port_struct_t MSTP_Port = { 0 }; /* port data */
@@ -1357,6 +1677,9 @@ static void testAutoBaudNodeFSM(void)
     testAutoBaudNode_Idle_Timeout(&MSTP_Port);
     testAutoBaudNode_Idle_Timeout(&MSTP_Port);
     testAutoBaudNode_Idle_Timeout(&MSTP_Port);
+
+    /* test case: search order */
+    testAutoBaudNode_Search(&MSTP_Port);
 }
 
 /**
@@ -1367,7 +1690,11 @@ void test_main(void)
 {
     ztest_test_suite(
         crc_tests, ztest_unit_test(testReceiveNodeFSM),
-        ztest_unit_test(testMasterNodeFSM), ztest_unit_test(testSlaveNodeFSM),
+        ztest_unit_test(testMasterNodeFSM),
+        ztest_unit_test(testMasterNodeStatistics),
+        ztest_unit_test(testMasterNodePollSchedule),
+        ztest_unit_test(testExtendedFramePeers),
+        ztest_unit_test(testSlaveNodeFSM),
         ztest_unit_test(testZeroConfigNodeFSM),
         ztest_unit_test(testAutoBaudNodeFSM));
 
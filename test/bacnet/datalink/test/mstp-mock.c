@@ -96,3 +96,29 @@ void MSTP_Auto_Baud_FSM(struct mstp_port_struct_t *mstp_port)
 {
     ztest_check_expected_value(mstp_port);
 }
+
+void MSTP_Statistics_Reset(struct mstp_port_struct_t *mstp_port)
+{
+    (void)mstp_port;
+}
+
+void MSTP_Extended_Frame_Peer_Update(struct mstp_port_struct_t *mstp_port)
+{
+    (void)mstp_port;
+}
+
+uint16_t MSTP_Extended_Frame_Peer_Max_APDU(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station)
+{
+    (void)mstp_port;
+    (void)station;
+    return 0;
+}
+
+bool MSTP_Extended_Frame_Peer_Allowed(
+    const struct mstp_port_struct_t *mstp_port, uint8_t station)
+{
+    (void)mstp_port;
+    (void)station;
+    return true;
+}
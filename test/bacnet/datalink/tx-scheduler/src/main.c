@@ -0,0 +1,293 @@
+/**
+ * @file
+ * @brief Unit test for the transmit scheduler of the datalink: the network
+ *  priority queues, the starvation limit, the eviction of NPDUs when the
+ *  queues are full, and the rate limit of each destination
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/datalink/datalink.h>
+#include <bacnet/datalink/arcnet.h>
+#include <bacnet/basic/sys/mstimer.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the NPDUs accepted by the ARCNET datalink of the test, which are
+   told apart by their first octet */
+#define TEST_SEND_MAX 16
+static uint8_t Test_Send_ID[TEST_SEND_MAX];
+static unsigned Test_Send_Count;
+/* while busy, the datalink accepts no NPDUs */
+static bool Test_Busy;
+static unsigned long Test_Milliseconds;
+
+unsigned long mstimer_now(void)
+{
+    return Test_Milliseconds;
+}
+
+bool arcnet_valid(void)
+{
+    return true;
+}
+
+void arcnet_cleanup(void)
+{
+}
+
+bool arcnet_init(char *interface_name)
+{
+    (void)interface_name;
+    return true;
+}
+
+int arcnet_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (Test_Busy) {
+        return 0;
+    }
+    if (Test_Send_Count < TEST_SEND_MAX) {
+        Test_Send_ID[Test_Send_Count] = pdu[0];
+    }
+    Test_Send_Count++;
+
+    return (int)pdu_len;
+}
+
+uint16_t arcnet_receive(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
+{
+    (void)src;
+    (void)pdu;
+    (void)max_pdu;
+    (void)timeout;
+    return 0;
+}
+
+void arcnet_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+}
+
+void arcnet_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    memset(dest, 0, sizeof(*dest));
+    dest->mac_len = 1;
+    dest->mac[0] = 0;
+}
+
+/**
+ * @brief Send an NPDU through the transmit scheduler
+ * @param id - the first octet of the NPDU, to tell it apart
+ * @param priority - network priority of the NPDU
+ * @param mac - MAC address of the destination
+ * @return the return value of datalink_send_pdu()
+ */
+static int
+test_send(uint8_t id, BACNET_MESSAGE_PRIORITY priority, uint8_t mac)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t pdu[4] = { 0 };
+
+    dest.mac_len = 1;
+    dest.mac[0] = mac;
+    npdu_encode_npdu_data(&npdu_data, false, priority);
+    pdu[0] = id;
+
+    return datalink_send_pdu(&dest, &npdu_data, pdu, sizeof(pdu));
+}
+
+/**
+ * @brief Start a test with an idle datalink, the token buckets refilled,
+ *  and nothing queued
+ */
+static void test_setup(void)
+{
+    datalink_set("arcnet");
+    Test_Busy = false;
+    Test_Milliseconds += 1000;
+    datalink_tx_task();
+    zassert_equal(datalink_tx_pending(), 0, NULL);
+    Test_Send_Count = 0;
+}
+
+/**
+ * @brief Test that the queued NPDUs are sent highest network priority
+ *  first
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(datalink_tx_tests, test_datalink_tx_priority)
+#else
+static void test_datalink_tx_priority(void)
+#endif
+{
+    test_setup();
+    /* nothing is queued while the datalink accepts the NPDUs */
+    zassert_equal(test_send(1, MESSAGE_PRIORITY_NORMAL, 1), 4, NULL);
+    zassert_equal(datalink_tx_pending(), 0, NULL);
+    zassert_equal(Test_Send_Count, 1, NULL);
+    Test_Send_Count = 0;
+    Test_Busy = true;
+    zassert_equal(test_send(2, MESSAGE_PRIORITY_NORMAL, 1), 4, NULL);
+    zassert_equal(test_send(3, MESSAGE_PRIORITY_URGENT, 1), 4, NULL);
+    zassert_equal(test_send(4, MESSAGE_PRIORITY_LIFE_SAFETY, 1), 4, NULL);
+    zassert_equal(
+        test_send(5, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, 1), 4, NULL);
+    zassert_equal(datalink_tx_pending(), 4, NULL);
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 0, NULL);
+    Test_Busy = false;
+    datalink_tx_task();
+    zassert_equal(datalink_tx_pending(), 0, NULL);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Send_ID[0], 4, NULL);
+    zassert_equal(Test_Send_ID[1], 5, NULL);
+    zassert_equal(Test_Send_ID[2], 3, NULL);
+    zassert_equal(Test_Send_ID[3], 2, NULL);
+}
+
+/**
+ * @brief Test that a waiting Normal NPDU is sent once
+ *  DATALINK_TX_STARVATION_LIMIT higher priority NPDUs went before it
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(datalink_tx_tests, test_datalink_tx_starvation)
+#else
+static void test_datalink_tx_starvation(void)
+#endif
+{
+    test_setup();
+    Test_Busy = true;
+    test_send(10, MESSAGE_PRIORITY_NORMAL, 1);
+    test_send(11, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, 1);
+    test_send(12, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, 1);
+    test_send(13, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, 1);
+    Test_Busy = false;
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Send_ID[0], 11, NULL);
+    zassert_equal(Test_Send_ID[1], 12, NULL);
+    zassert_equal(Test_Send_ID[2], 10, NULL);
+    zassert_equal(Test_Send_ID[3], 13, NULL);
+}
+
+/**
+ * @brief Test that a full queue drops the newest NPDU of the lowest
+ *  network priority for a higher priority NPDU, and drops an NPDU that
+ *  has no lower priority NPDU to replace
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(datalink_tx_tests, test_datalink_tx_evict)
+#else
+static void test_datalink_tx_evict(void)
+#endif
+{
+    test_setup();
+    Test_Busy = true;
+    test_send(20, MESSAGE_PRIORITY_NORMAL, 1);
+    test_send(21, MESSAGE_PRIORITY_NORMAL, 1);
+    test_send(22, MESSAGE_PRIORITY_URGENT, 1);
+    test_send(23, MESSAGE_PRIORITY_URGENT, 1);
+    zassert_equal(datalink_tx_pending(), DATALINK_TX_QUEUE_SIZE, NULL);
+    /* the newest Normal NPDU makes room */
+    zassert_equal(
+        test_send(24, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, 1), 4, NULL);
+    zassert_equal(datalink_tx_pending(), DATALINK_TX_QUEUE_SIZE, NULL);
+    /* nothing of lower priority to drop */
+    zassert_equal(test_send(25, MESSAGE_PRIORITY_NORMAL, 1), 0, NULL);
+    zassert_equal(test_send(26, MESSAGE_PRIORITY_URGENT, 1), 4, NULL);
+    zassert_equal(test_send(27, MESSAGE_PRIORITY_URGENT, 1), 0, NULL);
+    /* then the newest Urgent NPDU */
+    zassert_equal(test_send(28, MESSAGE_PRIORITY_LIFE_SAFETY, 1), 4, NULL);
+    zassert_equal(datalink_tx_pending(), DATALINK_TX_QUEUE_SIZE, NULL);
+    Test_Busy = false;
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Send_ID[0], 28, NULL);
+    zassert_equal(Test_Send_ID[1], 24, NULL);
+    zassert_equal(Test_Send_ID[2], 22, NULL);
+    zassert_equal(Test_Send_ID[3], 23, NULL);
+}
+
+/**
+ * @brief Test the token bucket of each destination, that limits the Normal
+ *  NPDUs to DATALINK_TX_RATE_LIMIT per second, and the reuse of the least
+ *  recently used token bucket for a new destination
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(datalink_tx_tests, test_datalink_tx_rate)
+#else
+static void test_datalink_tx_rate(void)
+#endif
+{
+    test_setup();
+    /* a full bucket holds DATALINK_TX_RATE_LIMIT NPDUs */
+    zassert_equal(test_send(30, MESSAGE_PRIORITY_NORMAL, 1), 4, NULL);
+    zassert_equal(test_send(31, MESSAGE_PRIORITY_NORMAL, 1), 4, NULL);
+    zassert_equal(Test_Send_Count, 2, NULL);
+    zassert_equal(test_send(32, MESSAGE_PRIORITY_NORMAL, 1), 4, NULL);
+    zassert_equal(Test_Send_Count, 2, NULL);
+    zassert_equal(datalink_tx_pending(), 1, NULL);
+    /* another destination, and the higher priorities, are not held up */
+    Test_Milliseconds += 10;
+    test_send(33, MESSAGE_PRIORITY_NORMAL, 2);
+    test_send(34, MESSAGE_PRIORITY_URGENT, 1);
+    zassert_equal(Test_Send_Count, 4, NULL);
+    zassert_equal(Test_Send_ID[2], 33, NULL);
+    zassert_equal(Test_Send_ID[3], 34, NULL);
+    zassert_equal(datalink_tx_pending(), 1, NULL);
+    /* the bucket refills at DATALINK_TX_RATE_LIMIT NPDUs per second */
+    Test_Milliseconds += (1000 / DATALINK_TX_RATE_LIMIT) - 11;
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 4, NULL);
+    Test_Milliseconds += 1;
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 5, NULL);
+    zassert_equal(Test_Send_ID[4], 32, NULL);
+    zassert_equal(datalink_tx_pending(), 0, NULL);
+    /* a new destination takes the least recently used bucket, which is
+       the bucket of destination 2 */
+    Test_Milliseconds += 10;
+    test_send(35, MESSAGE_PRIORITY_NORMAL, 3);
+    test_send(36, MESSAGE_PRIORITY_NORMAL, 3);
+    zassert_equal(Test_Send_Count, 7, NULL);
+    test_send(37, MESSAGE_PRIORITY_NORMAL, 3);
+    test_send(38, MESSAGE_PRIORITY_NORMAL, 1);
+    zassert_equal(Test_Send_Count, 7, NULL);
+    /* destination 1 kept its empty bucket */
+    zassert_equal(datalink_tx_pending(), 2, NULL);
+    Test_Milliseconds += 1000;
+    datalink_tx_task();
+    zassert_equal(Test_Send_Count, 9, NULL);
+    zassert_equal(Test_Send_ID[7], 37, NULL);
+    zassert_equal(Test_Send_ID[8], 38, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(datalink_tx_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        datalink_tx_tests, ztest_unit_test(test_datalink_tx_priority),
+        ztest_unit_test(test_datalink_tx_starvation),
+        ztest_unit_test(test_datalink_tx_evict),
+        ztest_unit_test(test_datalink_tx_rate));
+
+    ztest_run_test_suite(datalink_tx_tests);
+}
+#endif
@@ -1661,8 +1661,9 @@ ZTEST(event_tests, testEventNotification)
 static void testEventNotification(void)
 #endif
 {
-    uint8_t apdu[MAX_APDU];
+    uint8_t apdu[MAX_APDU], test_apdu[MAX_APDU], body[MAX_APDU];
     int apdu_len, test_len, null_len;
+    size_t body_len;
     uint8_t invoke_id = 2;
 
     /* common to all the notification types */
@@ -1793,6 +1794,154 @@ static void testEventNotification(void)
             event_notification_service_request_encode(apdu, apdu_len, &Data);
         zassert_equal(test_len, 0, NULL);
     }
+    /* notification body, encoded once for all recipients */
+    body_len = event_notification_body_encode(body, sizeof(body), &Data);
+    zassert_true(body_len > 0, NULL);
+    apdu_len = uevent_notify_encode_apdu(apdu, &Data);
+    test_len = uevent_notify_body_encode_apdu(
+        NULL, Data.processIdentifier, body, body_len);
+    zassert_equal(test_len, apdu_len, NULL);
+    test_len = uevent_notify_body_encode_apdu(
+        test_apdu, Data.processIdentifier, body, body_len);
+    zassert_equal(test_len, apdu_len, NULL);
+    zassert_equal(memcmp(apdu, test_apdu, apdu_len), 0, NULL);
+    apdu_len = cevent_notify_encode_apdu(apdu, invoke_id, &Data);
+    test_len = cevent_notify_body_encode_apdu(
+        test_apdu, invoke_id, Data.processIdentifier, body, body_len);
+    zassert_equal(test_len, apdu_len, NULL);
+    zassert_equal(memcmp(apdu, test_apdu, apdu_len), 0, NULL);
+}
+
+/**
+ * @brief Test the view decoder, which references the receive buffer
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(event_tests, testEventNotificationView)
+#else
+static void testEventNotificationView(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_EVENT_NOTIFICATION_DATA data = { 0 };
+    BACNET_EVENT_NOTIFICATION_DATA test_data = { 0 };
+    BACNET_EVENT_NOTIFICATION_VIEW view = { 0 };
+    BACNET_EVENT_NOTIFICATION_RECORD record = { 0 };
+    BACNET_CHARACTER_STRING message_text = { 0 };
+    BACNET_CHARACTER_STRING test_message_text = { 0 };
+    int apdu_len, test_len;
+
+    characterstring_init_ansi(&message_text, "High temperature");
+    data.messageText = &message_text;
+    data.processIdentifier = 42;
+    data.initiatingObjectIdentifier.type = OBJECT_DEVICE;
+    data.initiatingObjectIdentifier.instance = 260001;
+    data.eventObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    data.eventObjectIdentifier.instance = 7;
+    data.timeStamp.tag = TIME_STAMP_SEQUENCE;
+    data.timeStamp.value.sequenceNum = 99;
+    data.notificationClass = 3;
+    data.priority = 120;
+    data.notifyType = NOTIFY_ALARM;
+    data.ackRequired = true;
+    data.fromState = EVENT_STATE_NORMAL;
+    data.toState = EVENT_STATE_HIGH_LIMIT;
+    data.eventType = EVENT_OUT_OF_RANGE;
+    data.notificationParams.outOfRange.exceedingValue = 81.5f;
+    data.notificationParams.outOfRange.deadband = 1.0f;
+    data.notificationParams.outOfRange.exceededLimit = 80.0f;
+    bitstring_init(&data.notificationParams.outOfRange.statusFlags);
+    bitstring_set_bit(
+        &data.notificationParams.outOfRange.statusFlags, STATUS_FLAG_IN_ALARM,
+        true);
+    bitstring_set_bit(
+        &data.notificationParams.outOfRange.statusFlags, STATUS_FLAG_FAULT,
+        false);
+    bitstring_set_bit(
+        &data.notificationParams.outOfRange.statusFlags, STATUS_FLAG_OVERRIDDEN,
+        false);
+    bitstring_set_bit(
+        &data.notificationParams.outOfRange.statusFlags,
+        STATUS_FLAG_OUT_OF_SERVICE, false);
+    apdu_len = event_notify_encode_service_request(apdu, &data);
+    zassert_true(apdu_len > 0, NULL);
+    test_len = event_notification_view_decode(apdu, apdu_len, &view);
+    zassert_equal(test_len, apdu_len, NULL);
+    zassert_equal(view.processIdentifier, 42, NULL);
+    zassert_equal(view.initiatingObjectIdentifier.instance, 260001, NULL);
+    zassert_equal(view.eventObjectIdentifier.type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(view.eventObjectIdentifier.instance, 7, NULL);
+    zassert_equal(view.timeStamp.value.sequenceNum, 99, NULL);
+    zassert_equal(view.notificationClass, 3, NULL);
+    zassert_equal(view.priority, 120, NULL);
+    zassert_equal(view.eventType, EVENT_OUT_OF_RANGE, NULL);
+    zassert_equal(view.notifyType, NOTIFY_ALARM, NULL);
+    zassert_true(view.ackRequired, NULL);
+    zassert_equal(view.fromState, EVENT_STATE_NORMAL, NULL);
+    zassert_equal(view.toState, EVENT_STATE_HIGH_LIMIT, NULL);
+    /* the message text is referenced in the buffer */
+    zassert_true(view.messageText > apdu, NULL);
+    zassert_true(view.messageText < &apdu[apdu_len], NULL);
+    zassert_equal(view.messageTextLength, strlen("High temperature"), NULL);
+    zassert_equal(
+        memcmp(view.messageText, "High temperature", view.messageTextLength),
+        0, NULL);
+    zassert_true(
+        event_notification_view_message_text(&view, &test_message_text), NULL);
+    zassert_true(
+        characterstring_same(&message_text, &test_message_text), NULL);
+    /* the event values are decoded on demand */
+    zassert_not_null(view.eventValues, NULL);
+    zassert_true(
+        event_notification_view_values_decode(&view, &test_data), NULL);
+    zassert_equal(test_data.eventType, EVENT_OUT_OF_RANGE, NULL);
+    zassert_false(
+        islessgreater(
+            test_data.notificationParams.outOfRange.exceedingValue, 81.5f),
+        NULL);
+    zassert_false(
+        islessgreater(
+            test_data.notificationParams.outOfRange.exceededLimit, 80.0f),
+        NULL);
+    zassert_true(
+        bitstring_same(
+            &data.notificationParams.outOfRange.statusFlags,
+            &test_data.notificationParams.outOfRange.statusFlags),
+        NULL);
+    /* the compact record for queueing */
+    event_notification_view_record(&view, &record);
+    zassert_equal(record.processIdentifier, 42, NULL);
+    zassert_equal(record.initiatingDeviceInstance, 260001, NULL);
+    zassert_equal(record.eventObjectType, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(record.eventObjectInstance, 7, NULL);
+    zassert_equal(record.notificationClass, 3, NULL);
+    zassert_equal(record.eventType, EVENT_OUT_OF_RANGE, NULL);
+    zassert_equal(record.priority, 120, NULL);
+    zassert_equal(record.notifyType, NOTIFY_ALARM, NULL);
+    zassert_equal(record.fromState, EVENT_STATE_NORMAL, NULL);
+    zassert_equal(record.toState, EVENT_STATE_HIGH_LIMIT, NULL);
+    zassert_true(record.ackRequired, NULL);
+    zassert_true(record.messageText, NULL);
+    zassert_equal(record.timeStamp.tag, TIME_STAMP_SEQUENCE, NULL);
+    zassert_equal(record.timeStamp.value.sequenceNum, 99, NULL);
+    /* truncated */
+    while (apdu_len > 0) {
+        apdu_len--;
+        test_len = event_notification_view_decode(apdu, apdu_len, &view);
+        zassert_equal(test_len, BACNET_STATUS_ERROR, NULL);
+    }
+    /* no message text and no event values */
+    data.messageText = NULL;
+    data.notifyType = NOTIFY_ACK_NOTIFICATION;
+    apdu_len = event_notify_encode_service_request(apdu, &data);
+    test_len = event_notification_view_decode(apdu, apdu_len, &view);
+    zassert_equal(test_len, apdu_len, NULL);
+    zassert_is_null(view.messageText, NULL);
+    zassert_is_null(view.eventValues, NULL);
+    zassert_false(
+        event_notification_view_values_decode(&view, &test_data), NULL);
+    event_notification_view_record(&view, &record);
+    zassert_false(record.messageText, NULL);
+    zassert_equal(record.notifyType, NOTIFY_ACK_NOTIFICATION, NULL);
 }
 /**
  * @}
@@ -1803,7 +1952,9 @@ ZTEST_SUITE(event_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(event_tests, ztest_unit_test(testEventNotification));
+    ztest_test_suite(
+        event_tests, ztest_unit_test(testEventNotification),
+        ztest_unit_test(testEventNotificationView));
 
     ztest_run_test_suite(event_tests);
 }
@@ -7,6 +7,7 @@
  */
 #include <zephyr/ztest.h>
 #include <bacnet/indtext.h>
+#include <bacnet/basic/sys/platform.h>
 
 /**
  * @addtogroup bacnet_tests
@@ -61,6 +62,104 @@ static void testIndexText(void)
     zassert_equal(
         index, indtext_by_istring_default(data_list, "ANNA", index), NULL);
 }
+
+/**
+ * @brief Test the sorted index against the linear search
+ */
+static INDTEXT_DATA sorted_list[] = {
+    { 10, "zulu" },  { 11, "Alpha" }, { 12, "mike" },    { 13, "alpha" },
+    { 14, "ALPHA" }, { 15, "bravo" }, { 16, "alphabet" }, { 0, NULL }
+};
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(indtext_tests, testIndexTextSorted)
+#else
+static void testIndexTextSorted(void)
+#endif
+{
+    static const char *names[] = { "zulu",  "Alpha", "alpha",    "ALPHA",
+                                   "aLpHa", "mike",  "alphabet", "bravo",
+                                   "alph",  "zz",    "",         "a" };
+    INDTEXT_DATA *sorted[ARRAY_SIZE(sorted_list)] = { 0 };
+    INDTEXT_INDEX index = { 0 };
+    uint32_t expected, found;
+    bool status;
+    unsigned i;
+
+    /* storage too small: the index falls back to the list */
+    zassert_false(indtext_index_init(&index, sorted_list, sorted, 2), NULL);
+    zassert_true(indtext_index_by_istring(&index, "MIKE", &found), NULL);
+    zassert_equal(found, 12, NULL);
+    zassert_true(
+        indtext_index_init(
+            &index, sorted_list, sorted, ARRAY_SIZE(sorted_list)),
+        NULL);
+    zassert_equal(index.count, indtext_count(sorted_list), NULL);
+    for (i = 0; i < ARRAY_SIZE(names); i++) {
+        expected = found = 0;
+        status = indtext_by_istring(sorted_list, names[i], &expected);
+        zassert_equal(
+            indtext_index_by_istring(&index, names[i], &found), status,
+            "%s", names[i]);
+        zassert_equal(found, expected, "%s", names[i]);
+        expected = found = 0;
+        status = indtext_by_string(sorted_list, names[i], &expected);
+        zassert_equal(
+            indtext_index_by_string(&index, names[i], &found), status,
+            "%s", names[i]);
+        zassert_equal(found, expected, "%s", names[i]);
+    }
+    zassert_false(indtext_index_by_istring(&index, NULL, NULL), NULL);
+    zassert_false(indtext_index_by_istring(NULL, "zulu", NULL), NULL);
+    /* an index that is not initialized sorts itself on first use */
+    index.valid = false;
+    zassert_true(indtext_index_by_istring(&index, "BRAVO", &found), NULL);
+    zassert_equal(found, 15, NULL);
+    zassert_true(index.valid, NULL);
+}
+
+/**
+ * @brief Test the table by index against the linear search
+ */
+static INDTEXT_DATA table_list[] = { { 2, "two" },   { 0, "zero" },
+                                     { 2, "deux" },  { 5, "five" },
+                                     { 900, "far" }, { 0, NULL } };
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(indtext_tests, testIndexTextTable)
+#else
+static void testIndexTextTable(void)
+#endif
+{
+    static const uint32_t values[] = { 0, 1, 2, 5, 6, 899, 900, 901 };
+    const char *text[8] = { 0 };
+    INDTEXT_TABLE table = { 0 };
+    const char *expected;
+    unsigned i;
+
+    /* no storage: the table falls back to the list */
+    zassert_false(indtext_table_init(&table, table_list, NULL, 0), NULL);
+    zassert_equal(
+        indtext_table_by_index_default(&table, 5, NULL), table_list[3].pString,
+        NULL);
+    zassert_true(
+        indtext_table_init(&table, table_list, text, ARRAY_SIZE(text)), NULL);
+    zassert_equal(table.sparse, 1, NULL);
+    for (i = 0; i < ARRAY_SIZE(values); i++) {
+        expected = indtext_by_index_default(table_list, values[i], "none");
+        zassert_equal(
+            indtext_table_by_index_default(&table, values[i], "none"),
+            expected, "%u", (unsigned)values[i]);
+    }
+    zassert_equal(
+        indtext_table_by_index_default(NULL, 2, "none"), "none", NULL);
+    /* a table that is not initialized fills itself on first use */
+    table.valid = false;
+    zassert_equal(
+        indtext_table_by_index_default(&table, 2, NULL), table_list[0].pString,
+        NULL);
+    zassert_true(table.valid, NULL);
+}
 /**
  * @}
  */
@@ -70,7 +169,10 @@ ZTEST_SUITE(indtext_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(indtext_tests, ztest_unit_test(testIndexText));
+    ztest_test_suite(
+        indtext_tests, ztest_unit_test(testIndexText),
+        ztest_unit_test(testIndexTextSorted),
+        ztest_unit_test(testIndexTextTable));
 
     ztest_run_test_suite(indtext_tests);
 }
@@ -5,14 +5,20 @@
  * @date 2012
  * @copyright SPDX-License-Identifier: MIT
  */
+#include <stdio.h>
+#include <time.h>
 #include <zephyr/ztest.h>
 #include <bacnet/abort.h>
+#include <bacnet/bacaddr.h>
 #include <bacnet/bacerror.h>
 #include <bacnet/bacdcode.h>
 #include <bacnet/npdu.h>
 #include <bacnet/reject.h>
 #include <bacnet/rp.h>
 #include <bacnet/whois.h>
+#include <bacnet/basic/npdu/h_npdu.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/basic/tsm/tsm.h>
 
 /**
  * @addtogroup bacnet_tests
@@ -538,6 +544,335 @@ static void test_NPDU_Data_Expecting_Reply(void)
         reply_pdu, reply_pdu_len, &test_address, npdu_len + 3);
 }
 
+/**
+ * @brief Test the APDU offset decoder against the full NPDU decoder
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(npdu_tests, test_NPDU_Decode_APDU_Offset)
+#else
+static void test_NPDU_Decode_APDU_Offset(void)
+#endif
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_NPDU_DATA test_npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_MESSAGE_PRIORITY priority = MESSAGE_PRIORITY_NORMAL;
+    uint8_t pdu[MAX_NPDU + MAX_APDU] = { 0 };
+    int pdu_len = 0, npdu_len = 0, apdu_len = 0, len = 0;
+    unsigned i;
+    clock_t start;
+    double fast_seconds, full_seconds;
+
+    /* local, no routing information */
+    npdu_encode_npdu_data(
+        &npdu_data, true, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT);
+    npdu_len = npdu_encode_pdu(&pdu[0], NULL, NULL, &npdu_data);
+    zassert_equal(npdu_len, 2, NULL);
+    apdu_len = whois_encode_apdu(&pdu[npdu_len], -1, -1);
+    pdu_len = npdu_len + apdu_len;
+    len = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, &priority);
+    zassert_equal(len, npdu_len, NULL);
+    zassert_equal(priority, MESSAGE_PRIORITY_CRITICAL_EQUIPMENT, NULL);
+    /* no APDU */
+    len = bacnet_npdu_decode_apdu_offset(pdu, npdu_len, &priority);
+    zassert_equal(len, 0, NULL);
+    len = bacnet_npdu_decode_apdu_offset(pdu, 1, NULL);
+    zassert_equal(len, 0, NULL);
+    /* routed, with DNET and SNET */
+    dest.net = 1234;
+    dest.len = 1;
+    dest.adr[0] = 5;
+    src.net = 4321;
+    src.len = 2;
+    src.adr[0] = 6;
+    src.adr[1] = 7;
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_LIFE_SAFETY);
+    npdu_len = npdu_encode_pdu(&pdu[0], &dest, &src, &npdu_data);
+    apdu_len = whois_encode_apdu(&pdu[npdu_len], -1, -1);
+    pdu_len = npdu_len + apdu_len;
+    len = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, &priority);
+    zassert_equal(
+        len, bacnet_npdu_decode(pdu, pdu_len, NULL, NULL, &test_npdu_data),
+        NULL);
+    zassert_equal(len, npdu_len, NULL);
+    zassert_equal(priority, MESSAGE_PRIORITY_LIFE_SAFETY, NULL);
+    /* network layer message */
+    npdu_encode_npdu_network(
+        &npdu_data, NETWORK_MESSAGE_WHO_IS_ROUTER_TO_NETWORK, false,
+        MESSAGE_PRIORITY_NORMAL);
+    npdu_len = npdu_encode_pdu(&pdu[0], NULL, NULL, &npdu_data);
+    pdu_len = npdu_len + encode_unsigned16(&pdu[npdu_len], 1234);
+    len = bacnet_npdu_decode_apdu_offset(pdu, pdu_len, &priority);
+    zassert_equal(len, 0, NULL);
+
+    /* microbenchmark of the local case against the full decoder */
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    npdu_len = npdu_encode_pdu(&pdu[0], NULL, NULL, &npdu_data);
+    apdu_len = whois_encode_apdu(&pdu[npdu_len], -1, -1);
+    pdu_len = npdu_len + apdu_len;
+    len = 0;
+    start = clock();
+    for (i = 0; i < 1000000; i++) {
+        pdu[1] ^= (i & 0x03);
+        len += bacnet_npdu_decode_apdu_offset(pdu, pdu_len, &priority);
+    }
+    fast_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    zassert_equal(len, 1000000 * npdu_len, NULL);
+    len = 0;
+    start = clock();
+    for (i = 0; i < 1000000; i++) {
+        pdu[1] ^= (i & 0x03);
+        len += bacnet_npdu_decode(pdu, pdu_len, &dest, &src, &test_npdu_data);
+    }
+    full_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    zassert_equal(len, 1000000 * npdu_len, NULL);
+    printf(
+        "NPDU decode x1000000: APDU offset %.3fs, full %.3fs\n", fast_seconds,
+        full_seconds);
+}
+
+/**
+ * @brief Encode a network layer message with a list of DNETs
+ * @param pdu - buffer for the message
+ * @param message_type - network message type
+ * @param dnet - list of network numbers
+ * @param count - number of network numbers
+ * @return length of the message
+ */
+static uint16_t route_message_encode(
+    uint8_t *pdu,
+    BACNET_NETWORK_MESSAGE_TYPE message_type,
+    const uint16_t *dnet,
+    unsigned count)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int len;
+    unsigned i;
+
+    npdu_encode_npdu_network(
+        &npdu_data, message_type, false, MESSAGE_PRIORITY_NORMAL);
+    len = npdu_encode_pdu(pdu, NULL, NULL, &npdu_data);
+    for (i = 0; i < count; i++) {
+        len += encode_unsigned16(&pdu[len], dnet[i]);
+    }
+
+    return (uint16_t)len;
+}
+
+/**
+ * @brief Test the router-to-network cache used for remote destinations
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(npdu_tests, test_NPDU_Route_Cache)
+#else
+static void test_NPDU_Route_Cache(void)
+#endif
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS router_a = { 0 }, router_b = { 0 };
+    BACNET_ADDRESS dest = { 0 }, test_router = { 0 };
+    uint8_t pdu[MAX_NPDU] = { 0 };
+    const uint16_t dnets[] = { 100, 200 };
+    uint16_t pdu_len;
+
+    npdu_route_cache_init();
+    router_a.mac_len = 1;
+    router_a.mac[0] = 10;
+    router_b.mac_len = 1;
+    router_b.mac[0] = 20;
+    /* a remote destination is broadcast while no route is known */
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    dest.net = 100;
+    (void)npdu_encode_pdu(pdu, &dest, NULL, &npdu_data);
+    zassert_equal(dest.mac_len, 0, NULL);
+    /* learned from I-Am-Router-To-Network */
+    pdu_len = route_message_encode(
+        pdu, NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, dnets, 2);
+    npdu_handler(&router_a, pdu, pdu_len);
+    zassert_equal(npdu_route_cache_count(), 2, NULL);
+    zassert_true(npdu_route_cache_lookup(200, &test_router), NULL);
+    zassert_true(bacnet_address_same(&test_router, &router_a), NULL);
+    zassert_false(npdu_route_cache_lookup(300, &test_router), NULL);
+    /* a remote destination is sent to its router */
+    (void)npdu_encode_pdu(pdu, &dest, NULL, &npdu_data);
+    zassert_equal(dest.net, 100, NULL);
+    zassert_equal(dest.mac_len, 1, NULL);
+    zassert_equal(dest.mac[0], 10, NULL);
+    /* but not a global broadcast */
+    dest.mac_len = 0;
+    dest.net = BACNET_BROADCAST_NETWORK;
+    (void)npdu_encode_pdu(pdu, &dest, NULL, &npdu_data);
+    zassert_equal(dest.mac_len, 0, NULL);
+    /* a route through another router replaces the old one */
+    zassert_true(npdu_route_cache_add(200, &router_b), NULL);
+    zassert_true(npdu_route_cache_lookup(200, &test_router), NULL);
+    zassert_true(bacnet_address_same(&test_router, &router_b), NULL);
+    zassert_false(npdu_route_cache_add(0, &router_b), NULL);
+    zassert_false(
+        npdu_route_cache_add(BACNET_BROADCAST_NETWORK, &router_b), NULL);
+    /* a busy router is not used until it is available */
+    pdu_len = route_message_encode(
+        pdu, NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK, NULL, 0);
+    npdu_handler(&router_a, pdu, pdu_len);
+    zassert_false(npdu_route_cache_lookup(100, NULL), NULL);
+    zassert_true(npdu_route_cache_lookup(200, NULL), NULL);
+    pdu_len = route_message_encode(
+        pdu, NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK, &dnets[0], 1);
+    npdu_handler(&router_a, pdu, pdu_len);
+    zassert_true(npdu_route_cache_lookup(100, NULL), NULL);
+    /* or until the busy time has passed */
+    npdu_route_cache_busy_set(&router_a, 100, true);
+    zassert_false(npdu_route_cache_lookup(100, NULL), NULL);
+    npdu_route_cache_timer(30);
+    zassert_true(npdu_route_cache_lookup(100, NULL), NULL);
+    /* forgotten when the router has no route */
+    npdu_encode_npdu_network(
+        &npdu_data, NETWORK_MESSAGE_REJECT_MESSAGE_TO_NETWORK, false,
+        MESSAGE_PRIORITY_NORMAL);
+    pdu_len = (uint16_t)npdu_encode_pdu(pdu, NULL, NULL, &npdu_data);
+    pdu[pdu_len++] = NETWORK_REJECT_NO_ROUTE;
+    pdu_len += (uint16_t)encode_unsigned16(&pdu[pdu_len], 100);
+    npdu_handler(&router_a, pdu, pdu_len);
+    zassert_false(npdu_route_cache_lookup(100, NULL), NULL);
+    zassert_equal(npdu_route_cache_count(), 1, NULL);
+    /* and when the route has aged */
+    npdu_route_cache_timer(UINT16_MAX);
+    zassert_equal(npdu_route_cache_count(), 0, NULL);
+    dest.net = 200;
+    dest.mac_len = 0;
+    zassert_false(npdu_route_cache_resolve(&dest), NULL);
+    npdu_route_function_set(NULL);
+}
+
+static BACNET_TSM_COMPLETION_DATA Test_Completion;
+static unsigned Test_Completion_Count;
+static unsigned Test_Simple_Ack_Count;
+
+static void test_completion_callback(
+    const BACNET_ADDRESS *src,
+    const BACNET_TSM_COMPLETION_DATA *data,
+    void *context)
+{
+    (void)src;
+    zassert_equal(context, &Test_Completion_Count, NULL);
+    Test_Completion = *data;
+    Test_Completion_Count++;
+}
+
+static void test_simple_ack_handler(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    (void)src;
+    (void)invoke_id;
+    Test_Simple_Ack_Count++;
+}
+
+static uint8_t test_completion_request(const BACNET_ADDRESS *dest)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[4] = { 0 };
+    uint8_t invoke_id;
+
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+    apdu[2] = invoke_id;
+    apdu[3] = SERVICE_CONFIRMED_WRITE_PROPERTY;
+    tsm_set_confirmed_unsegmented_transaction(
+        invoke_id, dest, &npdu_data, apdu, sizeof(apdu));
+    zassert_true(
+        tsm_completion_set(
+            invoke_id, test_completion_callback, &Test_Completion_Count),
+        NULL);
+
+    return invoke_id;
+}
+
+/**
+ * @brief Test the routing of confirmed request completions by invoke ID
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(npdu_tests, test_NPDU_TSM_Completion)
+#else
+static void test_NPDU_TSM_Completion(void)
+#endif
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint8_t invoke_id;
+    int apdu_len;
+    unsigned i;
+
+    src.mac_len = 1;
+    src.mac[0] = 2;
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_WRITE_PROPERTY, test_simple_ack_handler);
+    zassert_false(tsm_completion_set(0, test_completion_callback, NULL), NULL);
+    /* an ACK goes to the completion instead of the service handler */
+    invoke_id = test_completion_request(&src);
+    apdu_len = encode_simple_ack(
+        apdu, invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY);
+    apdu_handler(&src, apdu, apdu_len);
+    zassert_equal(Test_Completion_Count, 1, NULL);
+    zassert_equal(Test_Simple_Ack_Count, 0, NULL);
+    zassert_equal(Test_Completion.status, TSM_COMPLETION_ACK, NULL);
+    zassert_equal(Test_Completion.invoke_id, invoke_id, NULL);
+    zassert_equal(
+        Test_Completion.service_choice, SERVICE_CONFIRMED_WRITE_PROPERTY,
+        NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id), NULL);
+    /* an Error, with its class and code */
+    invoke_id = test_completion_request(&src);
+    apdu_len = bacerror_encode_apdu(
+        apdu, invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY,
+        ERROR_CLASS_PROPERTY, ERROR_CODE_WRITE_ACCESS_DENIED);
+    apdu_handler(&src, apdu, apdu_len);
+    zassert_equal(Test_Completion_Count, 2, NULL);
+    zassert_equal(Test_Completion.status, TSM_COMPLETION_ERROR, NULL);
+    zassert_equal(Test_Completion.error_class, ERROR_CLASS_PROPERTY, NULL);
+    zassert_equal(
+        Test_Completion.error_code, ERROR_CODE_WRITE_ACCESS_DENIED, NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id), NULL);
+    /* a Reject */
+    invoke_id = test_completion_request(&src);
+    apdu_len = reject_encode_apdu(
+        apdu, invoke_id, REJECT_REASON_UNRECOGNIZED_SERVICE);
+    apdu_handler(&src, apdu, apdu_len);
+    zassert_equal(Test_Completion_Count, 3, NULL);
+    zassert_equal(Test_Completion.status, TSM_COMPLETION_REJECT, NULL);
+    zassert_equal(
+        Test_Completion.reason, REJECT_REASON_UNRECOGNIZED_SERVICE, NULL);
+    /* an Abort from the server */
+    invoke_id = test_completion_request(&src);
+    apdu_len = abort_encode_apdu(
+        apdu, invoke_id, ABORT_REASON_BUFFER_OVERFLOW, true);
+    apdu_handler(&src, apdu, apdu_len);
+    zassert_equal(Test_Completion_Count, 4, NULL);
+    zassert_equal(Test_Completion.status, TSM_COMPLETION_ABORT, NULL);
+    zassert_equal(Test_Completion.reason, ABORT_REASON_BUFFER_OVERFLOW, NULL);
+    /* no reply at all */
+    invoke_id = test_completion_request(&src);
+    for (i = 0; i <= apdu_retries(); i++) {
+        tsm_timer_milliseconds(apdu_timeout());
+    }
+    zassert_equal(Test_Completion_Count, 5, NULL);
+    zassert_equal(Test_Completion.status, TSM_COMPLETION_TIMEOUT, NULL);
+    zassert_equal(Test_Completion.invoke_id, invoke_id, NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id), NULL);
+    /* without a completion, the service handler gets the reply */
+    invoke_id = test_completion_request(&src);
+    tsm_completion_clear(invoke_id);
+    apdu_len = encode_simple_ack(
+        apdu, invoke_id, SERVICE_CONFIRMED_WRITE_PROPERTY);
+    apdu_handler(&src, apdu, apdu_len);
+    zassert_equal(Test_Completion_Count, 5, NULL);
+    zassert_equal(Test_Simple_Ack_Count, 1, NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id), NULL);
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_WRITE_PROPERTY, NULL);
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST_SUITE(npdu_tests, NULL, NULL, NULL, NULL, NULL);
 #else
@@ -548,7 +883,10 @@ void test_main(void)
         ztest_unit_test(test_NPDU_Network), ztest_unit_test(test_NPDU_Copy),
         ztest_unit_test(test_NPDU_Confirmed_Service),
         ztest_unit_test(test_NPDU_Segmented_Complex_Ack_Reply),
-        ztest_unit_test(test_NPDU_Data_Expecting_Reply));
+        ztest_unit_test(test_NPDU_Data_Expecting_Reply),
+        ztest_unit_test(test_NPDU_Decode_APDU_Offset),
+        ztest_unit_test(test_NPDU_Route_Cache),
+        ztest_unit_test(test_NPDU_TSM_Completion));
 
     ztest_run_test_suite(npdu_tests);
 }
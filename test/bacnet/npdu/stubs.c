@@ -26,3 +26,22 @@ int bip_send_pdu(
 
     return 0;
 }
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    if (my_address) {
+        my_address->mac_len = 1;
+        my_address->mac[0] = 1;
+        my_address->net = 0;
+        my_address->len = 0;
+    }
+}
+
+void bip_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    if (dest) {
+        dest->mac_len = 0;
+        dest->net = BACNET_BROADCAST_NETWORK;
+        dest->len = 0;
+    }
+}
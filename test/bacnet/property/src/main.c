@@ -108,6 +108,56 @@ static void testPropList(void)
     zassert_true(count > 0, NULL);
 }
 
+/**
+ * @brief Test the property list bitsets against the linear lists
+ */
+static void testPropListBitsetMatch(const int32_t *pList)
+{
+    struct property_list_bitset_t bitset = { 0 };
+    int32_t property;
+
+    property_list_bitset_init(&bitset, pList);
+    for (property = 0; property < 1024; property++) {
+        zassert_equal(
+            property_list_bitset_member(&bitset, property),
+            property_list_member(pList, property), "property=%d", property);
+    }
+    for (property = PROP_RESERVED_RANGE_MIN2;
+         property <= PROP_RESERVED_RANGE_LAST; property++) {
+        zassert_equal(
+            property_list_bitset_member(&bitset, property),
+            property_list_member(pList, property), "property=%d", property);
+    }
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(property_tests, testPropListBitset)
+#else
+static void testPropListBitset(void)
+#endif
+{
+    struct property_list_bitset_t bitset = { 0 };
+    unsigned i = 0;
+
+    for (i = 0; i < OBJECT_PROPRIETARY_MIN; i++) {
+        testPropListBitsetMatch(property_list_required((BACNET_OBJECT_TYPE)i));
+        testPropListBitsetMatch(property_list_optional((BACNET_OBJECT_TYPE)i));
+    }
+    testPropListBitsetMatch(property_list_bacnet_array());
+    testPropListBitsetMatch(property_list_bacnet_list());
+    /* filled in on first use */
+    bitset.pList = property_list_bacnet_array();
+    zassert_true(
+        property_list_bitset_member(&bitset, PROP_PRIORITY_ARRAY), NULL);
+    zassert_false(
+        property_list_bitset_member(&bitset, PROP_PRESENT_VALUE), NULL);
+    zassert_false(property_list_bitset_member(&bitset, -1), NULL);
+    zassert_false(property_list_bitset_member(NULL, PROP_PRESENT_VALUE), NULL);
+    property_list_bitset_init(&bitset, NULL);
+    zassert_false(
+        property_list_bitset_member(&bitset, PROP_PRIORITY_ARRAY), NULL);
+}
+
 /**
  * @}
  */
@@ -117,7 +167,9 @@ ZTEST_SUITE(property_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(property_tests, ztest_unit_test(testPropList));
+    ztest_test_suite(
+        property_tests, ztest_unit_test(testPropList),
+        ztest_unit_test(testPropListBitset));
 
     ztest_run_test_suite(property_tests);
 }
@@ -0,0 +1,96 @@
+/* @file
+ * @brief test BACnet SegmentACK message encode/decode APIs
+ * @date 2024
+ * @author Steve Karg <skarg@users.sourceforge.net>
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/segmentack.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static void testSegmentAckAPDU(
+    bool negative_ack,
+    bool server,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size)
+{
+    uint8_t apdu[8] = { 0 };
+    int len = 0;
+    int null_len = 0;
+    bool test_negative_ack = false;
+    bool test_server = false;
+    uint8_t test_invoke_id = 0;
+    uint8_t test_sequence_number = 0;
+    uint8_t test_actual_window_size = 0;
+
+    null_len = segmentack_encode_apdu(
+        NULL, negative_ack, server, invoke_id, sequence_number,
+        actual_window_size);
+    len = segmentack_encode_apdu(
+        apdu, negative_ack, server, invoke_id, sequence_number,
+        actual_window_size);
+    zassert_equal(len, 4, NULL);
+    zassert_equal(null_len, len, NULL);
+    zassert_equal(apdu[0] & 0xF0, PDU_TYPE_SEGMENT_ACK, NULL);
+    len = segmentack_decode_apdu(
+        apdu, len, &test_negative_ack, &test_server, &test_invoke_id,
+        &test_sequence_number, &test_actual_window_size);
+    zassert_equal(len, 4, NULL);
+    zassert_equal(test_negative_ack, negative_ack, NULL);
+    zassert_equal(test_server, server, NULL);
+    zassert_equal(test_invoke_id, invoke_id, NULL);
+    zassert_equal(test_sequence_number, sequence_number, NULL);
+    zassert_equal(test_actual_window_size, actual_window_size, NULL);
+}
+
+/**
+ * @brief Test encode/decode API for SegmentACK
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(segmentack_tests, testSegmentAckEncodeDecode)
+#else
+static void testSegmentAckEncodeDecode(void)
+#endif
+{
+    uint8_t apdu[8] = { 0 };
+    int len = 0;
+    unsigned i = 0;
+
+    for (i = 0; i < 256; i++) {
+        testSegmentAckAPDU(false, false, (uint8_t)i, (uint8_t)(255 - i), 1);
+        testSegmentAckAPDU(true, false, (uint8_t)i, (uint8_t)i, 16);
+        testSegmentAckAPDU(false, true, 1, (uint8_t)i, 127);
+        testSegmentAckAPDU(true, true, 255, (uint8_t)i, 64);
+    }
+    len = segmentack_encode_apdu(apdu, false, false, 1, 2, 3);
+    /* too short */
+    len = segmentack_decode_apdu(apdu, len - 1, NULL, NULL, NULL, NULL, NULL);
+    zassert_equal(len, 0, NULL);
+    /* NULL buffer */
+    len = segmentack_decode_apdu(NULL, 4, NULL, NULL, NULL, NULL, NULL);
+    zassert_equal(len, 0, NULL);
+    /* wrong PDU type */
+    apdu[0] = PDU_TYPE_ABORT;
+    len = segmentack_decode_apdu(apdu, 4, NULL, NULL, NULL, NULL, NULL);
+    zassert_equal(len, 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(segmentack_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        segmentack_tests, ztest_unit_test(testSegmentAckEncodeDecode));
+
+    ztest_run_test_suite(segmentack_tests);
+}
+#endif
@@ -331,6 +331,62 @@ static void testWritePropertyNull(void)
     zassert_equal(bypass, false, NULL);
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(wp_tests, testWritePropertyPrimitive)
+#else
+static void testWritePropertyPrimitive(void)
+#endif
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    BACNET_WRITE_PROPERTY_PRIMITIVE value = { 0 };
+    bool status = false;
+    int len = 0;
+
+    status = write_property_primitive_decode(NULL, &value);
+    zassert_false(status, NULL);
+    wp_data.application_data_len =
+        encode_application_real(&wp_data.application_data[0], 12.5f);
+    status = write_property_primitive_decode(&wp_data, NULL);
+    zassert_false(status, NULL);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_true(status, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_REAL, NULL);
+    zassert_false(islessgreater(value.type.Real, 12.5f), NULL);
+    wp_data.application_data_len =
+        encode_application_enumerated(&wp_data.application_data[0], 98);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_true(status, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_ENUMERATED, NULL);
+    zassert_equal(value.type.Enumerated, 98, NULL);
+    wp_data.application_data_len =
+        encode_application_boolean(&wp_data.application_data[0], true);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_true(status, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_BOOLEAN, NULL);
+    zassert_true(value.type.Boolean, NULL);
+    wp_data.application_data_len =
+        encode_application_unsigned(&wp_data.application_data[0], 1234);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_true(status, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_UNSIGNED_INT, NULL);
+    zassert_equal(value.type.Unsigned_Int, 1234, NULL);
+    /* other types take the generic decode */
+    wp_data.application_data_len =
+        encode_application_null(&wp_data.application_data[0]);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_false(status, NULL);
+    wp_data.application_data_len =
+        encode_context_real(&wp_data.application_data[0], 0, 12.5f);
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_false(status, NULL);
+    /* a list of values is not a primitive value */
+    len = encode_application_real(&wp_data.application_data[0], 1.0f);
+    len += encode_application_real(&wp_data.application_data[len], 2.0f);
+    wp_data.application_data_len = len;
+    status = write_property_primitive_decode(&wp_data, &value);
+    zassert_false(status, NULL);
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST_SUITE(wp_tests, NULL, NULL, NULL, NULL, NULL);
 #else
@@ -338,7 +394,8 @@ void test_main(void)
 {
     ztest_test_suite(
         wp_tests, ztest_unit_test(testWriteProperty),
-        ztest_unit_test(testWritePropertyNull));
+        ztest_unit_test(testWritePropertyNull),
+        ztest_unit_test(testWritePropertyPrimitive));
     ztest_run_test_suite(wp_tests);
 }
 #endif